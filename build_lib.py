@@ -119,13 +119,18 @@ try:
         "native/warp.cpp",
         "native/crt.cpp",
         "native/cuda_util.cpp",
+        "native/memory_stats.cpp",
         "native/mesh.cpp",
+        "native/tlas.cpp",
         "native/hashgrid.cpp",
+        "native/neighbor_list.cpp",
         "native/reduce.cpp",
         "native/runlength_encode.cpp",
         "native/sort.cpp",
+        "native/segmented.cpp",
         "native/sparse.cpp",
         "native/volume.cpp",
+        "native/texture.cpp",
         "native/marching.cpp",
         "native/cutlass_gemm.cpp",
     ]
@@ -0,0 +1,378 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+###########################################################################
+# Benchmarks for the native primitives
+#
+# Measures the throughput of the sorting, scan and reduction utilities,
+# the BVH, mesh, hash grid, sparse matrix, marching cubes and volume
+# primitives across problem sizes and devices. Results are written as
+# JSON and can be compared against the results of a previous run to
+# spot performance regressions between Warp versions, e.g.:
+#
+#   python benchmark_primitives.py --output baseline.json
+#   python benchmark_primitives.py --baseline baseline.json
+#
+###########################################################################
+
+import argparse
+import json
+import math
+import sys
+
+import numpy as np
+
+import warp as wp
+import warp.sparse
+
+wp.init()
+
+
+@wp.kernel
+def mesh_query_point_kernel(
+    mesh: wp.uint64, points: wp.array(dtype=wp.vec3), max_dist: float, faces: wp.array(dtype=int)
+):
+    tid = wp.tid()
+    face = int(-1)
+    u = float(0.0)
+    v = float(0.0)
+    wp.mesh_query_point_no_sign(mesh, points[tid], max_dist, face, u, v)
+    faces[tid] = face
+
+
+@wp.kernel
+def mesh_query_ray_kernel(mesh: wp.uint64, starts: wp.array(dtype=wp.vec3), max_t: float, faces: wp.array(dtype=int)):
+    tid = wp.tid()
+    t = float(0.0)
+    u = float(0.0)
+    v = float(0.0)
+    sign = float(0.0)
+    n = wp.vec3()
+    face = int(-1)
+    wp.mesh_query_ray(mesh, starts[tid], wp.vec3(0.0, -1.0, 0.0), max_t, t, u, v, sign, n, face)
+    faces[tid] = face
+
+
+@wp.kernel
+def volume_sample_kernel(volume: wp.uint64, points: wp.array(dtype=wp.vec3), values: wp.array(dtype=float)):
+    tid = wp.tid()
+    values[tid] = wp.volume_sample_f(volume, points[tid], wp.Volume.LINEAR)
+
+
+# benchmark name -> setup function
+BENCHMARKS = {}
+
+
+def benchmark(name):
+    def register(setup):
+        BENCHMARKS[name] = setup
+        return setup
+
+    return register
+
+
+# Each setup function allocates the inputs of a problem of size ``n`` and returns the function to time, the
+# number of items it processes and the number of bytes it reads and writes at least once.
+
+
+@benchmark("radix_sort_pairs")
+def setup_radix_sort_pairs(n, device, rng):
+    keys = wp.array(rng.integers(0, 2**30, 2 * n, dtype=np.int32), dtype=int, device=device)
+    values = wp.array(np.arange(2 * n, dtype=np.int32), dtype=int, device=device)
+
+    def run():
+        wp.utils.radix_sort_pairs(keys, values, n)
+
+    return run, n, 16 * n
+
+
+@benchmark("array_scan")
+def setup_array_scan(n, device, rng):
+    values = wp.array(rng.integers(0, 16, n, dtype=np.int32), dtype=int, device=device)
+    result = wp.empty_like(values)
+
+    def run():
+        wp.utils.array_scan(values, result, inclusive=False)
+
+    return run, n, 8 * n
+
+
+@benchmark("array_sum")
+def setup_array_sum(n, device, rng):
+    values = wp.array(rng.random(n, dtype=np.float32), dtype=float, device=device)
+    result = wp.empty(1, dtype=float, device=device)
+
+    def run():
+        wp.utils.array_sum(values, out=result)
+
+    return run, n, 4 * n
+
+
+@benchmark("runlength_encode")
+def setup_runlength_encode(n, device, rng):
+    # runs of 8 elements on average
+    values = wp.array(np.sort(rng.integers(0, max(n // 8, 1), n, dtype=np.int32)), dtype=int, device=device)
+    run_values = wp.empty_like(values)
+    run_lengths = wp.empty_like(values)
+    run_count = wp.empty(1, dtype=int, device=device)
+
+    def run():
+        wp.utils.runlength_encode(values, run_values, run_lengths, run_count=run_count)
+
+    return run, n, 4 * n + 8 * (n // 8)
+
+
+def random_bounds(n, device, rng):
+    lowers = rng.random((n, 3), dtype=np.float32)
+    uppers = lowers + 0.01
+    return wp.array(lowers, dtype=wp.vec3, device=device), wp.array(uppers, dtype=wp.vec3, device=device)
+
+
+@benchmark("bvh_create")
+def setup_bvh_create(n, device, rng):
+    lowers, uppers = random_bounds(n, device, rng)
+
+    def run():
+        wp.Bvh(lowers, uppers)
+
+    return run, n, 24 * n
+
+
+@benchmark("bvh_refit")
+def setup_bvh_refit(n, device, rng):
+    lowers, uppers = random_bounds(n, device, rng)
+    bvh = wp.Bvh(lowers, uppers)
+
+    def run():
+        bvh.refit()
+
+    return run, n, 24 * n
+
+
+def grid_mesh(device, res=256):
+    # a wavy height field over the unit square
+    x, z = np.meshgrid(np.linspace(0.0, 1.0, res), np.linspace(0.0, 1.0, res))
+    y = 0.05 * np.sin(8.0 * x) * np.cos(8.0 * z)
+    points = np.stack((x, y, z), axis=-1).reshape(-1, 3)
+
+    i = np.arange(res - 1)
+    corners = (i[:, None] * res + i[None, :]).flatten()
+    tris = np.concatenate(
+        (
+            np.stack((corners, corners + res, corners + 1), axis=-1),
+            np.stack((corners + 1, corners + res, corners + res + 1), axis=-1),
+        )
+    )
+    return wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(tris.flatten(), dtype=int, device=device),
+    )
+
+
+@benchmark("mesh_query_point")
+def setup_mesh_query_point(n, device, rng):
+    mesh = grid_mesh(device)
+    points = wp.array(rng.random((n, 3), dtype=np.float32), dtype=wp.vec3, device=device)
+    faces = wp.empty(n, dtype=int, device=device)
+
+    def run():
+        wp.launch(mesh_query_point_kernel, dim=n, inputs=[mesh.id, points, 1.0e6, faces], device=device)
+
+    return run, n, 16 * n
+
+
+@benchmark("mesh_query_ray")
+def setup_mesh_query_ray(n, device, rng):
+    mesh = grid_mesh(device)
+    starts = rng.random((n, 3), dtype=np.float32)
+    starts[:, 1] = 1.0
+    starts = wp.array(starts, dtype=wp.vec3, device=device)
+    faces = wp.empty(n, dtype=int, device=device)
+
+    def run():
+        wp.launch(mesh_query_ray_kernel, dim=n, inputs=[mesh.id, starts, 1.0e6, faces], device=device)
+
+    return run, n, 16 * n
+
+
+@benchmark("hash_grid_update")
+def setup_hash_grid_update(n, device, rng):
+    points = wp.array(rng.random((n, 3), dtype=np.float32), dtype=wp.vec3, device=device)
+    grid = wp.HashGrid(128, 128, 128, device=device)
+
+    def run():
+        grid.build(points, 0.01)
+
+    return run, n, 12 * n
+
+
+def stencil_matrix(n, device):
+    # 3x3 blocks on a 7-point stencil of a periodic grid with n nodes
+    rows = np.repeat(np.arange(n, dtype=np.int32), 7)
+    res = max(int(round(n ** (1.0 / 3.0))), 1)
+    offsets = np.array([0, 1, -1, res, -res, res * res, -res * res], dtype=np.int32)
+    columns = (rows + np.tile(offsets, n)) % n
+    values = np.tile(np.eye(3, dtype=np.float32), (7 * n, 1, 1))
+
+    A = wp.sparse.bsr_zeros(n, n, block_type=wp.mat33, device=device)
+    wp.sparse.bsr_set_from_triplets(
+        A,
+        wp.array(rows, dtype=int, device=device),
+        wp.array(columns, dtype=int, device=device),
+        wp.array(values, dtype=wp.mat33, device=device),
+    )
+    return A
+
+
+@benchmark("bsr_mv")
+def setup_bsr_mv(n, device, rng):
+    n = max(n // 8, 1)
+    A = stencil_matrix(n, device)
+    x = wp.array(rng.random((n, 3), dtype=np.float32), dtype=wp.vec3, device=device)
+    y = wp.empty_like(x)
+    nnz = A.nnz
+
+    def run():
+        wp.sparse.bsr_mv(A, x, y)
+
+    return run, nnz, nnz * (36 + 4) + n * 24
+
+
+@benchmark("bsr_mm")
+def setup_bsr_mm(n, device, rng):
+    n = max(n // 64, 1)
+    A = stencil_matrix(n, device)
+    C = wp.sparse.bsr_mm(A, A)
+    nnz = C.nnz
+
+    def run():
+        # only recompute the block values of the product, the sparsity pattern building is not timed
+        wp.sparse.bsr_mm(A, A, C, reuse_topology=True)
+
+    return run, nnz, 2 * A.nnz * 36 + nnz * 36
+
+
+def sphere_field(n):
+    res = max(int(round(n ** (1.0 / 3.0))), 2)
+    x = np.linspace(-1.0, 1.0, res, dtype=np.float32)
+    X, Y, Z = np.meshgrid(x, x, x, indexing="ij")
+    return np.sqrt(X * X + Y * Y + Z * Z) - 0.8, res
+
+
+@benchmark("marching_cubes")
+def setup_marching_cubes(n, device, rng):
+    field, res = sphere_field(n)
+    field = wp.array(field, dtype=float, device=device)
+    max_verts = 16 * res * res
+    mc = wp.MarchingCubes(res, res, res, max_verts, 2 * max_verts, device=device)
+
+    def run():
+        mc.surface(field, 0.0)
+
+    return run, res**3, 4 * res**3
+
+
+@benchmark("volume_sample")
+def setup_volume_sample(n, device, rng):
+    field, res = sphere_field(min(n, 256**3))
+    volume = wp.Volume.load_from_numpy(field, bg_value=1.0, device=device)
+    points = wp.array(rng.random((n, 3), dtype=np.float32) * (res - 1), dtype=wp.vec3, device=device)
+    values = wp.empty(n, dtype=float, device=device)
+
+    def run():
+        wp.launch(volume_sample_kernel, dim=n, inputs=[volume.id, points, values], device=device)
+
+    return run, n, 16 * n
+
+
+def run_benchmark(name, n, device, iters, warmup):
+    rng = np.random.default_rng(42)
+    with wp.ScopedDevice(device):
+        run, items, num_bytes = BENCHMARKS[name](n, device, rng)
+
+    with wp.ScopedDevice(device):
+        for _ in range(warmup):
+            run()
+        wp.synchronize_device(device)
+
+        times = []
+        for _ in range(iters):
+            with wp.ScopedTimer(name, print=False, synchronize=True) as timer:
+                run()
+            times.append(timer.elapsed)
+
+    times = np.array(times)
+    p50 = float(np.percentile(times, 50))
+    return {
+        "benchmark": name,
+        "device": str(device),
+        "size": n,
+        "items": int(items),
+        "bytes": int(num_bytes),
+        "mean_ms": float(np.mean(times)),
+        "p50_ms": p50,
+        "p99_ms": float(np.percentile(times, 99)),
+        "items_per_s": items / (p50 * 1.0e-3) if p50 > 0.0 else math.inf,
+        "gb_per_s": num_bytes / (p50 * 1.0e6) if p50 > 0.0 else math.inf,
+    }
+
+
+def compare(results, baseline, threshold):
+    """Returns the results whose median time grew by more than ``threshold`` relative to the baseline"""
+    reference = {(r["benchmark"], r["device"], r["size"]): r for r in baseline["results"]}
+    regressions = []
+    for r in results:
+        ref = reference.get((r["benchmark"], r["device"], r["size"]))
+        if ref is not None and r["p50_ms"] > ref["p50_ms"] * (1.0 + threshold):
+            regressions.append((r, ref))
+    return regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmarks for the Warp native primitives")
+    parser.add_argument("--benchmarks", nargs="*", default=list(BENCHMARKS.keys()), choices=list(BENCHMARKS.keys()))
+    parser.add_argument("--devices", nargs="*", default=None, help="Devices to run on, defaults to all devices")
+    parser.add_argument("--sizes", nargs="*", type=int, default=[2**14, 2**18, 2**22])
+    parser.add_argument("--iters", type=int, default=20)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--output", default=None, help="JSON file the results are written to")
+    parser.add_argument("--baseline", default=None, help="JSON file of a previous run to compare against")
+    parser.add_argument("--threshold", type=float, default=0.1, help="Relative slowdown reported as regression")
+    args = parser.parse_args()
+
+    devices = args.devices if args.devices is not None else wp.get_devices()
+
+    results = []
+    print(f"{'benchmark':<20} {'device':<8} {'size':>9} {'p50 ms':>10} {'p99 ms':>10} {'Mitems/s':>10} {'GB/s':>8}")
+    for device in devices:
+        device = wp.get_device(device)
+        for name in args.benchmarks:
+            for n in args.sizes:
+                r = run_benchmark(name, n, device, args.iters, args.warmup)
+                results.append(r)
+                print(
+                    f"{name:<20} {r['device']:<8} {n:>9} {r['p50_ms']:>10.3f} {r['p99_ms']:>10.3f} "
+                    f"{r['items_per_s'] * 1.0e-6:>10.1f} {r['gb_per_s']:>8.1f}"
+                )
+
+    report = {"warp_version": wp.config.version, "results": results}
+    if args.output is not None:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2)
+
+    if args.baseline is not None:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+        regressions = compare(results, baseline, args.threshold)
+        for r, ref in regressions:
+            print(
+                f"Regression: {r['benchmark']} on {r['device']} with size {r['size']}: "
+                f"{ref['p50_ms']:.3f} ms ({baseline.get('warp_version')}) -> {r['p50_ms']:.3f} ms"
+            )
+        if regressions:
+            sys.exit(1)
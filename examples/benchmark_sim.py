@@ -0,0 +1,321 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+###########################################################################
+# Benchmarks for warp.sim
+#
+# Runs the canonical scenes of the quadruped, granular and cloth examples
+# replicated over a number of environments, and reports the simulation
+# throughput, the GPU time spent in each phase of a step (collision
+# detection, force evaluation, constraint solve and integration) broken
+# down per kernel, and the memory pool high-water mark, e.g.:
+#
+#   python benchmark_sim.py --scenes quadruped --num_envs 1 64 1024
+#   python benchmark_sim.py --scenes cloth --integrator xpbd --output cloth.json
+#
+###########################################################################
+
+import argparse
+import json
+import math
+import os
+
+import warp as wp
+import warp.sim
+from env.environment import compute_env_offsets
+
+wp.init()
+
+
+def create_integrator(name):
+    if name == "euler":
+        return wp.sim.SemiImplicitIntegrator()
+    elif name == "xpbd":
+        return wp.sim.XPBDIntegrator()
+    elif name == "featherstone":
+        return wp.sim.SemiImplicitArticulationIntegrator()
+    raise ValueError(f"Unknown integrator {name}")
+
+
+def replicate(env_builder, num_envs, env_offset=(5.0, 0.0, 5.0)):
+    builder = wp.sim.ModelBuilder()
+    for offset in compute_env_offsets(num_envs, env_offset):
+        builder.add_builder(env_builder, xform=wp.transform(offset, wp.quat_identity()))
+    return builder
+
+
+class Scene:
+    """A model stepped with a fixed time step, ``collide`` is called once every ``collide_every`` substeps and
+    either rebuilds the particle grid or finds the contacts with the collision shapes"""
+
+    def __init__(self, model, integrator, dt, substeps, collide_every=1, build_grid=False, eval_fk=False):
+        self.model = model
+        self.integrator = integrator
+        self.dt = dt
+        self.substeps = substeps
+        self.collide_every = collide_every
+        self.build_grid = build_grid
+
+        self.state_0 = model.state()
+        self.state_1 = model.state()
+        if eval_fk:
+            wp.sim.eval_fk(model, model.joint_q, model.joint_qd, None, self.state_0)
+
+    def collide(self):
+        if self.build_grid:
+            self.model.particle_grid.build(self.state_0.particle_q, self.model.particle_max_radius * 2.0)
+        else:
+            wp.sim.collide(self.model, self.state_0)
+
+    def integrate(self):
+        self.state_0.clear_forces()
+        self.integrator.simulate(self.model, self.state_0, self.state_1, self.dt)
+        self.state_0, self.state_1 = self.state_1, self.state_0
+
+    def frame(self, phase=None):
+        """Runs the substeps of one frame, ``phase`` wraps the calls of each phase in a context manager"""
+        for i in range(self.substeps):
+            if i % self.collide_every == 0:
+                with phase("collide") if phase else _null_scope():
+                    self.collide()
+            with phase("integrate") if phase else _null_scope():
+                self.integrate()
+
+
+class _null_scope:
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+
+def build_quadruped(num_envs, integrator):
+    env = wp.sim.ModelBuilder()
+    wp.sim.parse_urdf(
+        os.path.join(os.path.dirname(__file__), "assets/quadruped.urdf"),
+        env,
+        xform=wp.transform([0.0, 0.7, 0.0], wp.quat_from_axis_angle((1.0, 0.0, 0.0), -math.pi * 0.5)),
+        floating=True,
+        density=1000,
+        armature=0.01,
+        stiffness=120,
+        damping=1,
+        shape_ke=1.0e4,
+        shape_kd=1.0e2,
+        shape_kf=1.0e2,
+        shape_mu=0.0,
+        limit_ke=1.0e4,
+        limit_kd=1.0e1,
+    )
+    env.joint_q[-12:] = [0.2, 0.4, -0.6, -0.2, -0.4, 0.6, -0.2, 0.4, -0.6, 0.2, -0.4, 0.6]
+    env.joint_target[-12:] = [0.2, 0.4, -0.6, -0.2, -0.4, 0.6, -0.2, 0.4, -0.6, 0.2, -0.4, 0.6]
+
+    model = replicate(env, num_envs).finalize()
+    model.ground = True
+    model.joint_attach_ke = 16000.0
+    model.joint_attach_kd = 200.0
+
+    return Scene(model, create_integrator(integrator or "xpbd"), 1.0 / 500.0, 5, eval_fk=True)
+
+
+def build_granular(num_envs, integrator):
+    radius = 0.1
+    env = wp.sim.ModelBuilder()
+    env.default_particle_radius = radius
+    env.add_particle_grid(
+        dim_x=16,
+        dim_y=32,
+        dim_z=16,
+        cell_x=radius * 2.0,
+        cell_y=radius * 2.0,
+        cell_z=radius * 2.0,
+        pos=(0.0, 1.0, 0.0),
+        rot=wp.quat_identity(),
+        vel=(5.0, 0.0, 0.0),
+        mass=0.1,
+        jitter=radius * 0.1,
+    )
+
+    model = replicate(env, num_envs, env_offset=(8.0, 0.0, 8.0)).finalize()
+    model.particle_kf = 25.0
+    model.soft_contact_kd = 100.0
+    model.soft_contact_kf *= 2.0
+
+    # the particle grid is rebuilt once per frame as in the granular example
+    substeps = 64
+    dt = 1.0 / (60.0 * substeps)
+    return Scene(model, create_integrator(integrator or "euler"), dt, substeps, substeps, build_grid=True)
+
+
+def build_cloth(num_envs, integrator):
+    integrator = integrator or "euler"
+    env = wp.sim.ModelBuilder()
+    cloth_args = dict(
+        pos=(0.0, 4.0, 0.0),
+        rot=wp.quat_from_axis_angle((1.0, 0.0, 0.0), math.pi * 0.5),
+        vel=(0.0, 0.0, 0.0),
+        dim_x=64,
+        dim_y=32,
+        cell_x=0.1,
+        cell_y=0.1,
+        mass=0.1,
+        fix_left=True,
+    )
+    if integrator == "euler":
+        env.add_cloth_grid(**cloth_args, tri_ke=1.0e3, tri_ka=1.0e3, tri_kd=1.0e1)
+    else:
+        env.add_cloth_grid(**cloth_args, edge_ke=1.0e2, add_springs=True, spring_ke=1.0e3, spring_kd=0.0)
+    env.add_shape_sphere(body=-1, pos=(1.0, 1.0, 1.0), radius=1.0, ke=1.0e2, kd=1.0e2, kf=1.0e1)
+
+    model = replicate(env, num_envs, env_offset=(10.0, 0.0, 10.0)).finalize()
+    model.ground = True
+    model.soft_contact_ke = 1.0e4
+    model.soft_contact_kd = 1.0e2
+
+    # contacts are found once per frame as in the cloth example
+    substeps = 32
+    return Scene(model, create_integrator(integrator), 1.0 / (60.0 * substeps), substeps, substeps)
+
+
+SCENES = {"quadruped": build_quadruped, "granular": build_granular, "cloth": build_cloth}
+
+
+def kernel_category(phase, name):
+    """Groups the kernels of the integration phase into force terms, constraint solves and integration"""
+    if phase != "integrate":
+        return phase
+    if name.startswith("eval_"):
+        return "forces"
+    if name.startswith("solve_") or name.startswith("apply_"):
+        return "constraints"
+    if name.startswith("integrate_"):
+        return "integrate"
+    return "other"
+
+
+class PhaseProfiler:
+    """Collects the GPU time of the kernels launched in each phase of a step with a ScopedKernelProfiler"""
+
+    def __init__(self):
+        # phase -> kernel name -> [launch count, total ms]
+        self.kernels = {}
+
+    def __call__(self, phase):
+        return _PhaseScope(self, phase)
+
+
+class _PhaseScope(wp.ScopedKernelProfiler):
+    def __init__(self, owner, phase):
+        super().__init__(print=False)
+        self.owner = owner
+        self.phase = phase
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        super().__exit__(exc_type, exc_value, traceback)
+        kernels = self.owner.kernels.setdefault(self.phase, {})
+        for stats in self.results.values():
+            entry = kernels.setdefault(stats.name, [0, 0.0])
+            entry[0] += stats.count
+            entry[1] += stats.total
+
+
+def run_scene(name, num_envs, integrator, device, frames, warmup, use_graph):
+    with wp.ScopedDevice(device):
+        scene = SCENES[name](num_envs, integrator)
+
+        for _ in range(warmup):
+            scene.frame()
+
+        graph = None
+        if use_graph and device.is_cuda:
+            wp.capture_begin()
+            try:
+                scene.frame()
+            finally:
+                graph = wp.capture_end()
+
+        wp.synchronize_device()
+        with wp.ScopedTimer(name, print=False, synchronize=True) as timer:
+            for _ in range(frames):
+                if graph is not None:
+                    wp.capture_launch(graph)
+                else:
+                    scene.frame()
+
+        steps = frames * scene.substeps
+        result = {
+            "scene": name,
+            "integrator": type(scene.integrator).__name__,
+            "device": str(device),
+            "num_envs": num_envs,
+            "graph": graph is not None,
+            "frame_ms": timer.elapsed / frames,
+            "steps_per_s": 1000.0 * steps / timer.elapsed,
+            "env_steps_per_s": 1000.0 * steps * num_envs / timer.elapsed,
+        }
+
+        # per-phase GPU times of one frame, launches are timed with events so this only runs on CUDA devices
+        if device.is_cuda:
+            profiler = PhaseProfiler()
+            scene.frame(profiler)
+
+            phases = {}
+            for phase, kernels in profiler.kernels.items():
+                for kernel, (count, total) in kernels.items():
+                    category = phases.setdefault(kernel_category(phase, kernel), {"ms": 0.0, "kernels": {}})
+                    category["ms"] += total
+                    category["kernels"][kernel] = {"launches": count, "ms": total}
+            result["phases"] = phases
+
+            if device.is_mempool_supported:
+                result["mempool_used_high"] = wp.get_mempool_stats(device)["used_high"]
+
+    return result
+
+
+def print_result(r):
+    print(
+        f"{r['scene']:<10} {r['integrator']:<36} {r['device']:<8} {r['num_envs']:>6} "
+        f"{r['frame_ms']:>10.3f} {r['env_steps_per_s']:>14.0f}"
+    )
+    for category, phase in r.get("phases", {}).items():
+        print(f"    {category:<14} {phase['ms']:>10.3f} ms")
+        kernels = sorted(phase["kernels"].items(), key=lambda k: k[1]["ms"], reverse=True)
+        for kernel, stats in kernels:
+            print(f"        {kernel:<48} {stats['launches']:>6} {stats['ms']:>10.3f} ms")
+    if "mempool_used_high" in r:
+        print(f"    memory high-water mark {r['mempool_used_high'] / 2**20:.1f} MiB")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmarks for warp.sim scenes")
+    parser.add_argument("--scenes", nargs="*", default=list(SCENES.keys()), choices=list(SCENES.keys()))
+    parser.add_argument("--num_envs", nargs="*", type=int, default=[1, 16, 256])
+    parser.add_argument("--integrator", default=None, choices=["euler", "xpbd", "featherstone"])
+    parser.add_argument("--devices", nargs="*", default=None, help="Devices to run on, defaults to all devices")
+    parser.add_argument("--frames", type=int, default=20)
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--no_graph", action="store_true", help="Do not capture the frames in a CUDA graph")
+    parser.add_argument("--output", default=None, help="JSON file the results are written to")
+    args = parser.parse_args()
+
+    devices = args.devices if args.devices is not None else wp.get_devices()
+
+    results = []
+    print(f"{'scene':<10} {'integrator':<36} {'device':<8} {'envs':>6} {'frame ms':>10} {'env steps/s':>14}")
+    for device in devices:
+        device = wp.get_device(device)
+        for name in args.scenes:
+            for num_envs in args.num_envs:
+                r = run_scene(name, num_envs, args.integrator, device, args.frames, args.warmup, not args.no_graph)
+                results.append(r)
+                print_result(r)
+
+    if args.output is not None:
+        with open(args.output, "w") as f:
+            json.dump({"warp_version": wp.config.version, "results": results}, f, indent=2)
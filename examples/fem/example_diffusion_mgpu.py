@@ -7,8 +7,8 @@ from typing import Tuple
 import warp as wp
 
 from warp.fem.types import *
-from warp.fem.geometry import Grid2D, LinearGeometryPartition
-from warp.fem.space import make_polynomial_space, make_space_partition
+from warp.fem.geometry import Grid2D
+from warp.fem.space import make_polynomial_space, make_space_partitions
 from warp.fem.field import make_test, make_trial
 from warp.fem.domain import Cells, BoundarySides
 from warp.fem.integrate import integrate
@@ -114,12 +114,13 @@ if __name__ == "__main__":
 
     main_device = devices[0]
 
+    # Construct the partition corresponding to each device
+    space_partitions = make_space_partitions(scalar_space, devices)
+
     # Build local system for each device
-    for k, device in enumerate(devices):
+    for space_partition, device in zip(space_partitions, devices):
         with wp.ScopedDevice(device):
-            # Construct the partition corresponding to the k'th device
-            geo_partition = LinearGeometryPartition(geo, k, len(devices))
-            space_partition = make_space_partition(scalar_space, geo_partition)
+            geo_partition = space_partition.geo_partition
 
             domain = Cells(geometry=geo_partition)
 
@@ -8,7 +8,9 @@
 """Public Python API exposed by the omni.warp.nodes package."""
 
 __all__ = [
+    "AttrArrayViews",
     "AttrTracking",
+    "NodeLaunch",
     "NodeTimer",
     "basis_curves_copy_bundle",
     "basis_curves_create_bundle",
@@ -60,6 +62,7 @@ __all__ = [
 ]
 
 from omni.warp.nodes._impl.attributes import (
+    AttrArrayViews,
     AttrTracking,
     from_omni_graph,
 )
@@ -72,6 +75,7 @@ from omni.warp.nodes._impl.bundles import (
     bundle_have_attrs_changed,
 )
 from omni.warp.nodes._impl.common import (
+    NodeLaunch,
     NodeTimer,
     type_convert_og_to_warp,
     type_convert_sdf_name_to_warp,
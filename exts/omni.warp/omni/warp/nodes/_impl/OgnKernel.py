@@ -23,10 +23,12 @@ from omni.warp.nodes._impl.kernel import (
     gather_attribute_infos,
     get_kernel_args,
     initialize_kernel_module,
+    is_kernel_module_loaded,
     validate_input_arrays,
     write_output_attrs,
 )
 from omni.warp.nodes._impl.attributes import attr_join_name
+from omni.warp.nodes._impl.common import NodeLaunch
 from omni.warp.nodes.ogn.OgnKernelDatabase import OgnKernelDatabase
 
 
@@ -52,6 +54,14 @@ class InternalState(InternalStateBase):
             ),
         )
 
+        # Kernel being launched, which lags behind the latest one in the base
+        # class members while that one is compiling in the background.
+        self.active_attr_infos = None
+        self.active_kernel_module = None
+
+        self.kernel_device = None
+        self.kernel_load = None
+
     def needs_initialization(
         self,
         db: OgnKernelDatabase,
@@ -67,6 +77,9 @@ class InternalState(InternalStateBase):
         if self.attr_tracking.have_attrs_changed(db):
             return True
 
+        if self.kernel_device != wp.get_device():
+            return True
+
         return False
 
     def initialize(
@@ -107,8 +120,47 @@ class InternalState(InternalStateBase):
 
         self.attr_tracking.update_state(db)
 
+        # Compile the kernel on a background thread to not block the UI. The
+        # previous kernel keeps running in the meantime, as long as it reads
+        # the same attributes.
+        device = wp.get_device()
+        if device != self.kernel_device or attr_infos != self.active_attr_infos:
+            self.active_attr_infos = None
+            self.active_kernel_module = None
+
+        self.kernel_device = device
+        if is_kernel_module_loaded(kernel_module, device):
+            self.kernel_load = None
+            self.activate_kernel()
+        else:
+            self.kernel_load = wp.load_module(module=kernel_module, device=device, asynchronous=True)
+
         return True
 
+    def activate_kernel(self) -> None:
+        """Makes the latest kernel the one being launched."""
+        self.active_attr_infos = self.attr_infos
+        self.active_kernel_module = self.kernel_module
+        self.launch = None
+
+    def update_kernel(self) -> bool:
+        """Swaps in the latest kernel once compiled, returns whether a kernel is ready to launch."""
+        if self.kernel_load is not None and self.kernel_load.done():
+            kernel_load = self.kernel_load
+            self.kernel_load = None
+
+            # Re-raise any compilation error, nothing runs until the code is edited again.
+            self.active_attr_infos = None
+            self.active_kernel_module = None
+            kernel_load.result()
+
+            if not is_kernel_module_loaded(self.kernel_module, self.kernel_device):
+                raise RuntimeError("Failed to compile the kernel.")
+
+            self.activate_kernel()
+
+        return self.active_kernel_module is not None
+
 
 #   Compute
 # ------------------------------------------------------------------------------
@@ -153,39 +205,51 @@ def compute(db: OgnKernelDatabase, device: wp.context.Device) -> None:
     kernel_shape = infer_kernel_shape(db)
 
     # Ensure that our internal state is correctly initialized.
+    state = db.internal_state
     timeline = omni.timeline.get_timeline_interface()
-    if db.internal_state.needs_initialization(db, timeline.is_stopped()):
-        if not db.internal_state.initialize(db, len(kernel_shape)):
+    if state.needs_initialization(db, timeline.is_stopped()):
+        if not state.initialize(db, len(kernel_shape)):
             return
 
-        db.internal_state.is_valid = True
+        state.is_valid = True
+
+    # Skip the evaluation if no kernel finished compiling yet.
+    if not state.update_kernel():
+        return
+
+    attr_infos = state.active_attr_infos
 
     # Exit early if there are no outputs defined.
-    if not db.internal_state.attr_infos[ATTR_PORT_TYPE_OUTPUT]:
+    if not attr_infos[ATTR_PORT_TYPE_OUTPUT]:
         return
 
     # Retrieve the inputs and outputs argument values to pass to the kernel.
     inputs, outputs = get_kernel_args(
         db.inputs,
         db.outputs,
-        db.internal_state.attr_infos,
-        db.internal_state.kernel_module,
+        attr_infos,
+        state.active_kernel_module,
         kernel_shape,
+        array_views=state.array_views,
     )
 
     # Ensure that all array input values are valid.
-    validate_input_arrays(db.node, db.internal_state.attr_infos, inputs)
+    validate_input_arrays(db.node, attr_infos, inputs)
 
-    # Launch the kernel.
-    wp.launch(
-        db.internal_state.kernel_module.compute,
-        dim=kernel_shape,
+    # Launch the kernel. The launch is recorded on the first evaluation
+    # following a kernel change and replayed afterwards.
+    if state.launch is None:
+        state.launch = NodeLaunch(state.active_kernel_module.compute)
+
+    state.launch.launch(
+        kernel_shape,
         inputs=[inputs],
         outputs=[outputs],
+        device=device,
     )
 
     # Write the output values to the node's attributes.
-    write_output_attrs(db.outputs, db.internal_state.attr_infos, outputs)
+    write_output_attrs(db.outputs, attr_infos, outputs)
 
 
 #   Node Entry Point
@@ -120,6 +120,11 @@ class InternalState:
         self.collider_points_1 = None
         self.graph = None
 
+        # Launches run on every tick, recorded once to lower the overhead.
+        self.transform_points_launch = omni.warp.nodes.NodeLaunch(transform_points_kernel)
+        self.update_collider_launch = omni.warp.nodes.NodeLaunch(update_collider_kernel)
+        self.update_particles_launch = omni.warp.nodes.NodeLaunch(update_particles_kernel)
+
         self.sim_enabled = True
         self.time = 0.0
 
@@ -372,9 +377,8 @@ def update_collider(
     xform_1 = xform
 
     # Update the internal point positions and velocities.
-    wp.launch(
-        kernel=update_collider_kernel,
-        dim=len(state.collider_mesh.vertices),
+    state.update_collider_launch.launch(
+        len(state.collider_mesh.vertices),
         inputs=[
             state.collider_points_0,
             state.collider_points_1,
@@ -408,9 +412,8 @@ def update_particles(
     xform_1 = xform
 
     # Update the internal point positions and velocities.
-    wp.launch(
-        kernel=update_particles_kernel,
-        dim=len(state.state_0.particle_q),
+    state.update_particles_launch.launch(
+        len(state.state_0.particle_q),
         inputs=[
             state.state_0.particle_q,
             np.matmul(np.linalg.inv(xform_0), xform_1).T,
@@ -515,9 +518,8 @@ def compute(db: OgnParticlesSimulateDatabase, device: wp.context.Device) -> None
             # Transform the particles point positions back into local space
             # and store them into the bundle.
             out_points = omni.warp.nodes.points_get_points(db.outputs.particles)
-            wp.launch(
-                kernel=transform_points_kernel,
-                dim=len(out_points),
+            state.transform_points_launch.launch(
+                len(out_points),
                 inputs=[
                     state.state_0.particle_q,
                     np.linalg.inv(xform).T,
@@ -158,6 +158,45 @@ def attr_cast_array_to_warp(
     assert False, "Unexpected device '{}'.".format(device.alias)
 
 
+class AttrArrayViews:
+    """Warp views of attribute arrays that persist across evaluations.
+
+    The view of an attribute is only recreated when its memory, shape, or type
+    changes, which spares the cost of wrapping the same memory into a new array
+    on every tick.
+    """
+
+    def __init__(self) -> None:
+        self._views = {}
+
+    def clear(self) -> None:
+        """Discards all the views."""
+        self._views.clear()
+
+    def get(
+        self,
+        name: str,
+        value: Union[np.array, og.DataWrapper],
+        dtype: type,
+        shape: Sequence[int],
+        device: wp.context.Device,
+    ) -> wp.array:
+        """Retrieves the view of an attribute array value."""
+        if device.is_cpu:
+            # CPU values are NumPy arrays that aren't guaranteed to be backed
+            # by the same memory from one evaluation to the next.
+            return attr_cast_array_to_warp(value, dtype, shape, device)
+
+        key = (value.memory, dtype, tuple(shape), device.alias)
+        cached = self._views.get(name)
+        if cached is not None and cached[0] == key:
+            return cached[1]
+
+        view = attr_cast_array_to_warp(value, dtype, shape, device)
+        self._views[name] = (key, view)
+        return view
+
+
 #   Tracking
 # ------------------------------------------------------------------------------
 
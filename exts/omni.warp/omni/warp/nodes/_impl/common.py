@@ -11,6 +11,7 @@ from enum import Enum
 from typing import (
     Any,
     Optional,
+    Sequence,
     Union,
 )
 
@@ -51,6 +52,58 @@ class NodeTimer(object):
         self.timer.__exit__(type, value, traceback)
 
 
+#   Launch
+# ------------------------------------------------------------------------------
+
+
+class NodeLaunch(object):
+    """Kernel launch recorded on the first evaluation and replayed on the next ones.
+
+    Replaying a recorded launch only repacks the arguments, which skips the
+    validation and module lookups done by `wp.launch()` on every tick. The
+    kernel must not be generic since its overload is resolved once.
+    """
+
+    def __init__(self, kernel: Any) -> None:
+        self.kernel = kernel
+        self.reset()
+
+    def reset(self) -> None:
+        """Discards the recorded launch, e.g.: after the kernel got recompiled."""
+        self._cmd = None
+        self._dim = None
+        self._device = None
+
+    def launch(
+        self,
+        dim: Any,
+        inputs: Sequence[Any] = (),
+        outputs: Sequence[Any] = (),
+        device: Optional[wp.context.Device] = None,
+    ) -> None:
+        """Launches the kernel with the given arguments."""
+        device = wp.get_device(device)
+        args = tuple(inputs) + tuple(outputs)
+
+        if self._cmd is None or self._device != device:
+            self._cmd = wp.launch(self.kernel, dim=dim, inputs=args, device=device, record_cmd=True)
+            if self._cmd is None:
+                # Empty launches aren't recorded.
+                return
+
+            self._dim = dim
+            self._device = device
+        else:
+            if dim != self._dim:
+                self._cmd.set_dim(dim)
+                self._dim = dim
+
+            self._cmd.set_params(args)
+
+        if self._cmd.bounds.size > 0:
+            self._cmd.launch()
+
+
 #   Types
 # ------------------------------------------------------------------------------
 
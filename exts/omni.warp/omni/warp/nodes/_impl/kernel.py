@@ -9,6 +9,7 @@
 
 from __future__ import annotations
 
+from collections import OrderedDict
 from enum import IntFlag
 import functools
 import hashlib
@@ -38,6 +39,7 @@ from omni.warp.nodes._impl.common import (
 )
 from omni.warp.nodes._impl.attributes import (
     ATTR_BUNDLE_TYPE,
+    AttrArrayViews,
     attr_cast_array_to_warp,
     attr_get_base_name,
     attr_get_name,
@@ -50,6 +52,12 @@ _ATTR_PORT_TYPE_OUTPUT = og.AttributePortType.ATTRIBUTE_PORT_TYPE_OUTPUT
 
 EXPLICIT_SOURCE = "explicit"
 
+# Number of kernel modules kept in memory, which makes reverting an edit to
+# any recent version of a kernel's code instant.
+_KERNEL_MODULE_CACHE_SIZE = 32
+
+_kernel_module_cache = OrderedDict()
+
 
 #   Enumerators
 # ------------------------------------------------------------------------------
@@ -544,6 +552,14 @@ def initialize_kernel_module(
     # other kernel modules from the same session.
     uid = hashlib.blake2b(bytes(code, encoding="utf-8"), digest_size=8)
     module_name = "warp-kernelnode-{}".format(uid.hexdigest())
+
+    # The names are derived from the whole code, including the attribute
+    # declarations, so modules seen before can be reused as they are.
+    kernel_module = _kernel_module_cache.get(module_name)
+    if kernel_module is not None:
+        _kernel_module_cache.move_to_end(module_name)
+        return kernel_module
+
     kernel_module = _load_code_as_module(code, module_name)
 
     # Validate the module's contents.
@@ -555,9 +571,25 @@ def initialize_kernel_module(
     # Configure warp to only compute the forward pass.
     wp.set_module_options({"enable_backward": False}, module=kernel_module)
 
+    _kernel_module_cache[module_name] = kernel_module
+    if len(_kernel_module_cache) > _KERNEL_MODULE_CACHE_SIZE:
+        _kernel_module_cache.popitem(last=False)
+
     return kernel_module
 
 
+def is_kernel_module_loaded(
+    kernel_module: Any,
+    device: wp.context.Device,
+) -> bool:
+    """Checks whether a kernel module is compiled and loaded on a device."""
+    module = kernel_module.compute.module
+    if device.is_cpu:
+        return module.cpu_module is not None
+
+    return device.context in module.cuda_modules
+
+
 #   Data I/O
 # ------------------------------------------------------------------------------
 
@@ -603,14 +635,25 @@ def get_kernel_args(
     kernel_shape: Sequence[int],
     device: Optional[wp.context.Device] = None,
     config: Optional[KernelArgsConfig] = None,
+    array_views: Optional[AttrArrayViews] = None,
 ) -> Tuple[Any, Any]:
-    """Retrieves the in/out argument values to pass to the kernel."""
+    """Retrieves the in/out argument values to pass to the kernel.
+
+    When `array_views` is set, the array views of the attributes are reused
+    across evaluations for as long as their memory doesn't change.
+    """
     if device is None:
         device = wp.get_device()
 
     if config is None:
         config = KernelArgsConfig()
 
+    def cast_array(info: AttributeInfo, value: Any, shape: Sequence[int]) -> wp.array:
+        if array_views is None:
+            return attr_cast_array_to_warp(value, info.warp_data_type, shape, device)
+
+        return array_views.get(info.name, value, info.warp_data_type, shape, device)
+
     # Initialize the kernel's input data.
     inputs = kernel_module.Inputs()
     for info in attr_infos[_ATTR_PORT_TYPE_INPUT]:
@@ -625,12 +668,7 @@ def get_kernel_args(
             # supports 1D arrays anyways.
             shape = value.shape[:1]
 
-            value = attr_cast_array_to_warp(
-                value,
-                info.warp_data_type,
-                shape,
-                device,
-            )
+            value = cast_array(info, value, shape)
         elif info.is_bundle:
             raise NotImplementedError("Bundle attributes are not yet supported.")
         else:
@@ -657,12 +695,7 @@ def get_kernel_args(
             setattr(db_outputs, "{}_size".format(info.base_name), size)
 
             value = getattr(db_outputs, info.base_name)
-            value = attr_cast_array_to_warp(
-                value,
-                info.warp_data_type,
-                shape,
-                device,
-            )
+            value = cast_array(info, value, shape)
         elif info.is_bundle:
             raise NotImplementedError("Bundle attributes are not yet supported.")
         else:
@@ -731,6 +764,10 @@ class InternalStateBase:
         self.attr_infos = None
         self.kernel_module = None
 
+        # Per-tick state reused across evaluations.
+        self.array_views = AttrArrayViews()
+        self.launch = None
+
         self.is_valid = False
 
     def needs_initialization(
@@ -779,4 +816,8 @@ class InternalStateBase:
         self._code_str = db.inputs.codeStr
         self._code_file = db.inputs.codeFile
 
+        # The attributes and the kernel might be redefined.
+        self.array_views.clear()
+        self.launch = None
+
         return True
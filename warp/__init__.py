@@ -10,6 +10,7 @@
 
 from warp.types import array, array1d, array2d, array3d, array4d, constant
 from warp.types import indexedarray, indexedarray1d, indexedarray2d, indexedarray3d, indexedarray4d
+from warp.types import soaarray
 from warp.fabric import fabricarray, fabricarrayarray, indexedfabricarray, indexedfabricarrayarray
 
 from warp.types import bool, int8, uint8, int16, uint16, int32, uint32, int64, uint64, float16, float32, float64
@@ -25,8 +26,10 @@ from warp.types import spatial_vector, spatial_vectorh, spatial_vectorf, spatial
 from warp.types import spatial_matrix, spatial_matrixh, spatial_matrixf, spatial_matrixd
 
 # geometry types
-from warp.types import Bvh, Mesh, HashGrid, Volume, MarchingCubes
-from warp.types import bvh_query_t, mesh_query_aabb_t, hash_grid_query_t
+from warp.types import Bvh, Mesh, Tlas, HashGrid, Volume, VolumeAtlas, VolumePrefetch, Texture3D, MarchingCubes
+from warp.types import SparseHashGrid, MultiLevelHashGrid, NeighborList, knn_graph
+from warp.types import bvh_query_t, mesh_query_aabb_t, hash_grid_query_t, volume_accessor_t, tile_t
+from warp.types import neighbor_list_query_t, topk_heap_t
 
 # device-wide gemms
 from warp.types import matmul, adj_matmul, batched_matmul, adj_batched_matmul, from_ptr
@@ -40,6 +43,19 @@ from warp.context import is_cpu_available, is_cuda_available, is_device_availabl
 from warp.context import get_devices, get_preferred_device
 from warp.context import get_cuda_devices, get_cuda_device_count, get_cuda_device, map_cuda_device, unmap_cuda_device
 from warp.context import get_device, set_device, synchronize_device
+from warp.context import (
+    set_mempool_enabled,
+    set_allocator,
+    get_allocator,
+    is_mempool_enabled,
+    set_mempool_release_threshold,
+    get_mempool_release_threshold,
+    get_mempool_stats,
+    get_pinned_pool_stats,
+    release_pinned_pool,
+    get_memory_stats,
+    reset_memory_peak,
+)
 from warp.context import (
     zeros,
     zeros_like,
@@ -51,20 +67,30 @@ from warp.context import (
     copy,
     from_numpy,
     launch,
+    jvp,
+    launch_multi,
     synchronize,
     force_load,
+    force_load_async,
     load_module,
+    save_module_bundle,
+    load_module_bundle,
 )
 from warp.context import set_module_options, get_module_options, get_module
-from warp.context import capture_begin, capture_end, capture_launch
+from warp.context import capture_begin, capture_end, capture_update, capture_launch
+from warp.context import capture_if, capture_while, is_conditional_graph_supported
 from warp.context import print_builtins, export_builtins, export_stubs
-from warp.context import Kernel, Function, Launch
+from warp.context import Kernel, Function, Launch, CommandList
 from warp.context import Stream, get_stream, set_stream, synchronize_stream
-from warp.context import Event, record_event, wait_event, wait_stream
-from warp.context import RegisteredGLBuffer
+from warp.context import Event, record_event, wait_event, wait_stream, get_event_elapsed_time
+from warp.context import ReadbackRing, ReadbackFuture
+from warp.context import RegisteredGLBuffer, RegisteredGLTexture
 
-from warp.tape import Tape
-from warp.utils import ScopedTimer, ScopedDevice, ScopedStream
+from warp.tape import Tape, CheckpointTape
+from warp.expression import ArrayExpression, where
+from warp.checkpoint import save_checkpoint, load_checkpoint
+from warp.autotune import autotune
+from warp.utils import ScopedTimer, ScopedKernelProfiler, ScopedDevice, ScopedStream, ScopedAutoStreams, ScopedMemoryTag
 from warp.utils import transform_expand, quat_between_vectors
 
 from warp.torch import from_torch, to_torch
@@ -0,0 +1,241 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import hashlib
+import json
+import os
+import threading
+import time
+
+import warp
+import warp.build
+
+# tuning results are stored next to the kernel cache, one entry per (key, device architecture, size bucket)
+DATABASE_NAME = "autotune.json"
+VERSION = 1
+
+_database = None
+_database_path = None
+_database_lock = threading.Lock()
+
+
+def size_bucket(size) -> int:
+    """Power of two bucket of a problem size, sizes of a bucket share their tuning results"""
+
+    if isinstance(size, (tuple, list)):
+        n = 1
+        for d in size:
+            n *= int(d)
+    else:
+        n = int(size)
+
+    return 1 << max(n - 1, 0).bit_length()
+
+
+def device_key(device) -> str:
+    """Architecture of a device in tuning database keys, e.g.: ``"sm_86"`` or ``"cpu"``"""
+
+    device = warp.get_device(device)
+    return "cpu" if device.is_cpu else f"sm_{device.arch}"
+
+
+def kernel_key(kernels) -> str:
+    """Key of a list of kernel variants, changes whenever the code or options of one of them do"""
+
+    h = hashlib.sha256()
+    for kernel in kernels:
+        h.update(f"{kernel.module.name}.{kernel.key}:{sorted(kernel.options.items())}".encode("utf-8"))
+        h.update(kernel.module.hash_module())
+
+    return f"{kernels[0].key}:{h.hexdigest()[:16]}"
+
+
+def _entry_name(key, device, size):
+    return f"{key}|{device_key(device)}|{size_bucket(size)}"
+
+
+def _get_database_path():
+    if warp.config.kernel_cache_dir is None:
+        return None
+    return os.path.join(warp.config.kernel_cache_dir, DATABASE_NAME)
+
+
+def _read_database(path):
+    try:
+        with open(path) as f:
+            data = json.load(f)
+    except (OSError, ValueError):
+        return {}
+
+    if data.get("version") != VERSION:
+        return {}
+
+    return data.get("entries", {})
+
+
+def _get_database():
+    # reloaded when the kernel cache moves, e.g.: after warp.build.init_kernel_cache()
+    global _database, _database_path
+
+    path = _get_database_path()
+    if _database is None or path != _database_path:
+        _database = _read_database(path) if path is not None else {}
+        _database_path = path
+
+    return _database
+
+
+def lookup(key: str, device, size):
+    """Returns the index of the fastest variant recorded for ``key`` on the architecture of ``device`` and the
+    size bucket of ``size``, or None if it wasn't tuned yet"""
+
+    with _database_lock:
+        entry = _get_database().get(_entry_name(key, device, size))
+
+    return None if entry is None else entry["choice"]
+
+
+def record(key: str, device, size, choice: int, times=None):
+    """Records the index of the fastest variant for ``key``, ``device`` and ``size``, see :func:`lookup`
+
+    The database file is updated under a lock of the kernel cache, merging the entries recorded concurrently by
+    other processes sharing it.
+    """
+
+    entry = {"choice": int(choice)}
+    if times is not None:
+        entry["times"] = [float(t) for t in times]
+
+    name = _entry_name(key, device, size)
+
+    with _database_lock:
+        database = _get_database()
+        database[name] = entry
+
+        path = _database_path
+        if path is None:
+            return
+
+        with warp.build.kernel_cache_lock("autotune"):
+            entries = _read_database(path)
+            entries[name] = entry
+            database.update(entries)
+            warp.build.write_cache_file(path, json.dumps({"version": VERSION, "entries": entries}, indent=1))
+
+
+def clear():
+    """Removes all the tuning results, e.g.: after a driver upgrade"""
+
+    global _database
+
+    with _database_lock:
+        _database = {}
+        path = _get_database_path()
+        if path is not None:
+            with warp.build.kernel_cache_lock("autotune"):
+                if os.path.isfile(path):
+                    os.remove(path)
+
+
+def _benchmark(run, device, iterations):
+    # the first run loads modules and warms up caches, it isn't timed
+    run()
+
+    if device.is_cuda:
+        stream = warp.get_stream(device)
+        start = warp.Event(device, enable_timing=True)
+        end = warp.Event(device, enable_timing=True)
+
+        stream.record_event(start)
+        for _ in range(iterations):
+            run()
+        stream.record_event(end)
+
+        return warp.get_event_elapsed_time(start, end) / iterations
+
+    warp.synchronize_device(device)
+    begin = time.perf_counter()
+    for _ in range(iterations):
+        run()
+    warp.synchronize_device(device)
+
+    return (time.perf_counter() - begin) * 1000.0 / iterations
+
+
+def autotune(
+    variants,
+    dim=None,
+    inputs=None,
+    outputs=None,
+    device=None,
+    key: str = None,
+    size=None,
+    iterations: int = 10,
+    force: bool = False,
+):
+    """Returns the fastest of several interchangeable variants of a computation for the current problem.
+
+    Each variant is either a :class:`warp.Kernel`, launched over ``dim`` with ``inputs`` and ``outputs`` as with
+    :func:`warp.launch`, or a callable taking no arguments, e.g.: a native primitive with one of its algorithm
+    choices. The variants are timed with CUDA events on the current stream of ``device`` (with a host timer on
+    the CPU) after a first untimed run, so they should have no side effect that changes the timing of the next
+    runs. Kernel variants typically differ in their options, e.g.: ``block_dim``, or in their algorithm.
+
+    The winner is recorded in a database next to the kernel cache under ``key``, the architecture of the device
+    and the power of two bucket of ``size``, and returned directly on later calls with the same key, including
+    from other processes. Native primitives of Warp consult the same database, see ``warp.config.autotune``.
+
+    Args:
+        variants: List of kernels or callables computing the same result
+        dim: Launch dimensions of the kernel variants
+        inputs: Inputs of the kernel variants
+        outputs: Outputs of the kernel variants
+        device: Device to run the variants on, the default device if None
+        key: Name of the tuned computation, defaults to a hash of the code and options of kernel variants and must
+            be given for callables
+        size: Problem size selecting the size bucket of the results, defaults to the number of threads of ``dim``
+        iterations: Number of timed runs of each variant
+        force: Benchmark the variants even if a result is recorded already
+
+    Returns:
+        The fastest variant
+    """
+
+    variants = list(variants)
+    if not variants:
+        raise ValueError("autotune() requires at least one variant")
+
+    device = warp.get_device(device)
+
+    is_kernel = [isinstance(v, warp.context.Kernel) for v in variants]
+    if key is None:
+        if not all(is_kernel):
+            raise ValueError("autotune() requires a key when some variants aren't kernels")
+        key = kernel_key(variants)
+
+    if size is None:
+        if dim is None:
+            raise ValueError("autotune() requires a size or launch dimensions")
+        size = dim
+
+    if not force:
+        choice = lookup(key, device, size)
+        if choice is not None and choice < len(variants):
+            return variants[choice]
+
+    def runner(variant, kernel):
+        if kernel:
+            return lambda: warp.launch(variant, dim=dim, inputs=inputs or [], outputs=outputs or [], device=device)
+
+        return variant
+
+    times = [_benchmark(runner(v, k), device, max(iterations, 1)) for v, k in zip(variants, is_kernel)]
+    choice = min(range(len(variants)), key=lambda i: times[i])
+
+    record(key, device, size, choice, times)
+
+    return variants[choice]
@@ -5,13 +5,20 @@
 # distribution of this software and related documentation without an express
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
+import contextlib
+import ctypes
+import hashlib
 import os
+import shutil
+import threading
 
 import warp.config
 from warp.thirdparty import appdirs
 
 
-# builds cuda source to PTX or CUBIN using NVRTC (output type determined by output_path extension)
+# builds cuda source to PTX, CUBIN, or fatbin using NVRTC (output type determined by output_path extension),
+# outputs ending in .lto.cubin are compiled to LTO-IR and linked with nvJitLink
+# for fatbin output, arch is the sequence of architectures to include
 def build_cuda(cu_path, arch, output_path, config="release", verify_fp=False, fast_math=False):
     with open(cu_path, "rb") as src_file:
         src = src_file.read()
@@ -23,14 +30,67 @@ def build_cuda(cu_path, arch, output_path, config="release", verify_fp=False, fa
             warp.context.runtime.llvm.compile_cuda(src, cu_path, inc_path, output_path, False)
 
         else:
-            err = warp.context.runtime.core.cuda_compile_program(
-                src, arch, inc_path, config == "debug", warp.config.verbose, verify_fp, fast_math, output_path
-            )
+            pch_dir = kernel_pch_dir.encode("utf-8") if is_nvrtc_pch_enabled() else None
+
+            if output_path.endswith(b".fatbin"):
+                # SASS for each architecture plus PTX for the lowest one as a fallback
+                archs = (ctypes.c_int * len(arch))(*arch)
+                ptx_arch = min(min(arch), warp.config.ptx_target_arch)
+                err = warp.context.runtime.core.cuda_compile_fatbin(
+                    src,
+                    archs,
+                    len(arch),
+                    ptx_arch,
+                    inc_path,
+                    config == "debug",
+                    warp.config.verbose,
+                    verify_fp,
+                    fast_math,
+                    output_path,
+                    pch_dir,
+                )
+            elif output_path.endswith(b".lto.cubin"):
+                # LTO-IR linked into SASS by nvJitLink
+                err = warp.context.runtime.core.cuda_compile_lto(
+                    src, arch, inc_path, config == "debug", warp.config.verbose, verify_fp, fast_math, output_path, pch_dir
+                )
+            else:
+                err = warp.context.runtime.core.cuda_compile_program(
+                    src, arch, inc_path, config == "debug", warp.config.verbose, verify_fp, fast_math, output_path, pch_dir
+                )
             if err:
                 raise Exception("CUDA build failed")
 
 
-# load PTX or CUBIN as a CUDA runtime module (input type determined by input_path extension)
+# returns the sorted architectures to bundle into fat binaries, or None if fatbin output is disabled
+def get_fatbin_archs():
+    archs = warp.config.cuda_fatbin_archs
+    if not archs or warp.config.llvm_cuda:
+        return None
+
+    runtime = warp.context.runtime
+    if runtime.toolkit_version < 12040:
+        raise RuntimeError("wp.config.cuda_fatbin_archs requires Warp to be built with CUDA Toolkit 12.4 or higher")
+
+    archs = tuple(sorted(set(int(arch) for arch in archs)))
+    for arch in archs:
+        if arch not in runtime.nvrtc_supported_archs:
+            raise RuntimeError(f"Architecture sm_{arch} in wp.config.cuda_fatbin_archs is not supported by NVRTC")
+
+    return archs
+
+
+# NVRTC can reuse a precompiled builtin.h across modules starting with CUDA 12.8
+def is_nvrtc_pch_enabled():
+    return (
+        warp.config.enable_nvrtc_pch
+        and not warp.config.llvm_cuda
+        and kernel_pch_dir is not None
+        and warp.context.runtime.toolkit_version >= 12080
+    )
+
+
+# load PTX, CUBIN, or fatbin as a CUDA runtime module (input type determined by input_path extension)
 def load_cuda(input_path, device):
     if not device.is_cuda:
         raise ("Not a CUDA device")
@@ -41,15 +101,215 @@ def load_cuda(input_path, device):
 def build_cpu(obj_path, cpp_path, mode="release", verify_fp=False, fast_math=False):
     with open(cpp_path, "rb") as cpp:
         src = cpp.read()
+        pch_header = get_cpu_pch_header(src, mode)
         cpp_path = cpp_path.encode("utf-8")
         inc_path = os.path.join(os.path.dirname(os.path.realpath(__file__)), "native").encode("utf-8")
         obj_path = obj_path.encode("utf-8")
 
-        warp.context.runtime.llvm.compile_cpp(src, cpp_path, inc_path, obj_path, mode == "debug")
+        err = warp.context.runtime.llvm.compile_cpp(
+            src,
+            cpp_path,
+            inc_path,
+            obj_path,
+            mode == "debug",
+            warp.config.cpu_native_isa,
+            pch_header.encode("utf-8") if pch_header else None,
+        )
+        if err:
+            raise Exception("CPU build failed")
+
+
+# the host CPU target CPU modules are compiled for, part of their cache key, or an empty string for generic code
+def get_cpu_target():
+    if not warp.config.cpu_native_isa:
+        return ""
+
+    global cpu_host_target
+    if cpu_host_target is None:
+        warp.context.runtime.llvm.cpu_host_target.restype = ctypes.c_char_p
+        cpu_host_target = warp.context.runtime.llvm.cpu_host_target().decode("utf-8")
+    return cpu_host_target
+
+
+# modification stamp of the native headers, precompiled headers are rebuilt when they change
+def get_native_headers_stamp():
+    global native_headers_stamp
+    if native_headers_stamp is None:
+        native_dir = os.path.join(os.path.dirname(os.path.realpath(__file__)), "native")
+        stamps = [os.path.getmtime(os.path.join(native_dir, f)) for f in os.listdir(native_dir) if f.endswith(".h")]
+        native_headers_stamp = repr(max(stamps, default=0.0))
+    return native_headers_stamp
+
+
+# CPU modules start with the macros of their options followed by the include of builtin.h, this preamble is written
+# to a header in the kernel cache that the compiler turns into a precompiled header shared by all modules using it
+def get_cpu_pch_header(src, mode):
+    if not warp.config.enable_cpu_pch or kernel_pch_dir is None:
+        return None
+
+    include = src.find(b'#include "builtin.h"')
+    if include < 0:
+        return None
+
+    preamble = src[: src.index(b"\n", include) + 1]
+
+    key = hashlib.sha256(preamble)
+    key.update(bytes(f"{mode},{get_cpu_target()},{get_native_headers_stamp()},{warp.config.version}", "utf-8"))
+
+    header_path = os.path.join(kernel_pch_dir, f"wp_cpu_{key.hexdigest()[:16]}.h")
+    if not os.path.isfile(header_path):
+        write_cache_file(header_path, preamble)
+
+    return header_path
+
+
+# temporary path of a kernel cache file while it is written, in the same directory so that os.replace() is atomic
+# and with the same extension since the compilers infer the output type from it
+def get_cache_temp_path(path):
+    head, tail = os.path.split(path)
+    return os.path.join(head, f"tmp{os.getpid()}_{threading.get_ident()}_{tail}")
+
+
+def write_cache_file(path, data):
+    """Writes a kernel cache file under a temporary name and renames it, concurrent readers never see a partial file"""
+
+    tmp_path = get_cache_temp_path(path)
+    with open(tmp_path, "wb" if isinstance(data, bytes) else "w") as f:
+        f.write(data)
+    os.replace(tmp_path, path)
+
+
+@contextlib.contextmanager
+def kernel_cache_lock(name):
+    """Holds an exclusive lock on the kernel cache entry ``name`` across all processes sharing the cache.
+
+    Processes that miss the cache at the same time wait for the first one to finish building the entry
+    and can then load it instead of building it again.
+    """
+
+    if kernel_lock_dir is None:
+        yield
+        return
+
+    with open(os.path.join(kernel_lock_dir, name + ".lock"), "a+b") as f:
+        if os.name == "nt":
+            import msvcrt
+
+            # LK_LOCK gives up after 10 seconds, builds can take longer than that
+            while True:
+                try:
+                    msvcrt.locking(f.fileno(), msvcrt.LK_LOCK, 1)
+                    break
+                except OSError:
+                    pass
+            try:
+                yield
+            finally:
+                f.seek(0)
+                msvcrt.locking(f.fileno(), msvcrt.LK_UNLCK, 1)
+        else:
+            import fcntl
+
+            fcntl.flock(f.fileno(), fcntl.LOCK_EX)
+            try:
+                yield
+            finally:
+                fcntl.flock(f.fileno(), fcntl.LOCK_UN)
+
+
+def fetch_shared_cache_entry(output_path, hash_path, expected_hash, meta_path):
+    """Copies a binary and its metadata from ``warp.config.kernel_cache_shared_dir`` into the local kernel cache.
+
+    Returns whether the shared cache holds the binary for ``expected_hash``. The shared cache is only read, it is
+    laid out like a local cache, e.g.: one populated by a job that set ``warp.config.kernel_cache_dir`` to it.
+    """
+
+    shared_dir = warp.config.kernel_cache_shared_dir
+    if not warp.config.cache_kernels or shared_dir is None or kernel_bin_dir is None:
+        return False
+
+    def shared_path(path):
+        return os.path.join(shared_dir, "bin", os.path.basename(path))
+
+    try:
+        with open(shared_path(hash_path), "rb") as f:
+            if f.read() != expected_hash:
+                return False
+
+        for path in (output_path, meta_path):
+            if path == output_path or os.path.isfile(shared_path(path)):
+                tmp_path = get_cache_temp_path(path)
+                shutil.copyfile(shared_path(path), tmp_path)
+                os.replace(tmp_path, path)
+
+        # written last, the local entry is only valid once the binary is in place
+        write_cache_file(hash_path, expected_hash)
+    except OSError:
+        return False
+
+    return True
+
+
+def touch_kernel_cache(paths):
+    """Marks cached files as recently used for the eviction of :func:`evict_kernel_cache`"""
+
+    if not warp.config.kernel_cache_max_size:
+        return
+
+    for path in paths:
+        try:
+            os.utime(path)
+        except OSError:
+            pass
+
+
+def evict_kernel_cache(keep=()):
+    """Removes the least recently used files of the kernel cache until it fits ``warp.config.kernel_cache_max_size``.
+
+    Files are ranked by their modification time, which is refreshed when they are loaded from the cache. The files in
+    ``keep`` are never removed. A binary that loses its hash file, or the other way around, is simply rebuilt.
+    """
+
+    max_size = warp.config.kernel_cache_max_size
+    if not max_size:
+        return
+
+    keep = set(keep)
+
+    files = []
+    for cache_dir in (kernel_bin_dir, kernel_gen_dir):
+        if cache_dir is None or not os.path.isdir(cache_dir):
+            continue
+        for entry in os.scandir(cache_dir):
+            try:
+                if entry.is_file() and entry.name.startswith("wp_"):
+                    stat = entry.stat()
+                    files.append((stat.st_mtime, stat.st_size, entry.path))
+            except OSError:
+                pass
+
+    total_size = sum(size for _, size, _ in files)
+
+    for _, size, path in sorted(files):
+        if total_size <= max_size:
+            break
+        if path in keep:
+            continue
+        try:
+            os.remove(path)
+            total_size -= size
+        except OSError:
+            # removed by another process, or still open on Windows
+            pass
 
 
 kernel_bin_dir = None
 kernel_gen_dir = None
+kernel_pch_dir = None
+kernel_lock_dir = None
+
+cpu_host_target = None
+native_headers_stamp = None
 
 
 def init_kernel_cache(path=None):
@@ -70,6 +330,8 @@ def init_kernel_cache(path=None):
 
     cache_bin_dir = os.path.join(cache_root_dir, "bin")
     cache_gen_dir = os.path.join(cache_root_dir, "gen")
+    cache_pch_dir = os.path.join(cache_root_dir, "pch")
+    cache_lock_dir = os.path.join(cache_root_dir, "lock")
 
     if not os.path.isdir(cache_root_dir):
         # print("Creating cache directory '%s'" % cache_root_dir)
@@ -83,11 +345,20 @@ def init_kernel_cache(path=None):
         # print("Creating binary directory '%s'" % cache_bin_dir)
         os.makedirs(cache_bin_dir, exist_ok=True)
 
+    if not os.path.isdir(cache_pch_dir):
+        os.makedirs(cache_pch_dir, exist_ok=True)
+
+    # lock files are kept apart from the entries, clearing the cache must not remove locks held by other processes
+    if not os.path.isdir(cache_lock_dir):
+        os.makedirs(cache_lock_dir, exist_ok=True)
+
     warp.config.kernel_cache_dir = cache_root_dir
 
-    global kernel_bin_dir, kernel_gen_dir
+    global kernel_bin_dir, kernel_gen_dir, kernel_pch_dir, kernel_lock_dir
     kernel_bin_dir = cache_bin_dir
     kernel_gen_dir = cache_gen_dir
+    kernel_pch_dir = cache_pch_dir
+    kernel_lock_dir = cache_lock_dir
 
 
 def clear_kernel_cache():
@@ -105,6 +376,11 @@ def clear_kernel_cache():
         pattern = os.path.join(kernel_gen_dir, "wp_*")
         paths += glob.glob(pattern)
 
+    # precompiled headers are managed by NVRTC and use their own naming
+    if kernel_pch_dir is not None and os.path.isdir(kernel_pch_dir):
+        pattern = os.path.join(kernel_pch_dir, "*")
+        paths += glob.glob(pattern)
+
     for p in paths:
         if os.path.isfile(p):
             os.remove(p)
@@ -273,6 +273,9 @@ def build_dll_for_arch(dll_path, cpp_paths, cu_path, libs, mode, arch, verify_fp
                 linkopts.append(
                     f'cudart_static.lib nvrtc_static.lib nvrtc-builtins_static.lib nvptxcompiler_static.lib ws2_32.lib user32.lib /LIBPATH:"{cuda_home}/lib/x64"'
                 )
+                # nvFatbin is used to bundle kernels for multiple architectures, nvJitLink for link-time optimization
+                if ctk_version >= (12, 4):
+                    linkopts.append("nvfatbin_static.lib nvJitLink_static.lib")
 
         with ScopedTimer("link", active=warp.config.verbose):
             link_cmd = f'"{host_linker}" {" ".join(linkopts + libs)} /out:"{dll_path}"'
@@ -327,6 +330,9 @@ def build_dll_for_arch(dll_path, cpp_paths, cu_path, libs, mode, arch, verify_fp
                 ld_inputs.append(
                     f'-L"{cuda_home}/lib64" -lcudart_static -lnvrtc_static -lnvrtc-builtins_static -lnvptxcompiler_static -lpthread -ldl -lrt'
                 )
+                # nvFatbin is used to bundle kernels for multiple architectures, nvJitLink for link-time optimization
+                if ctk_version >= (12, 4):
+                    ld_inputs.append("-lnvfatbin_static -lnvJitLink_static")
 
         if sys.platform == "darwin":
             opt_no_undefined = "-Wl,-undefined,error"
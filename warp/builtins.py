@@ -201,6 +201,36 @@ add_builtin(
     doc="Return base-e exponential, e^x.",
     group="Scalar Math",
 )
+add_builtin(
+    "sin_approx",
+    input_types={"x": Float},
+    value_func=sametype_value_func(Float),
+    doc="""Return an approximation of the sine of x in radians, faster than :func:`sin` with an absolute error
+    around 1e-6 for small arguments that grows with the magnitude of x.""",
+    group="Scalar Math",
+)
+add_builtin(
+    "cos_approx",
+    input_types={"x": Float},
+    value_func=sametype_value_func(Float),
+    doc="""Return an approximation of the cosine of x in radians, faster than :func:`cos` with an absolute error
+    around 1e-6 for small arguments that grows with the magnitude of x.""",
+    group="Scalar Math",
+)
+add_builtin(
+    "exp_approx",
+    input_types={"x": Float},
+    value_func=sametype_value_func(Float),
+    doc="Return an approximation of e^x, faster than :func:`exp` with a relative error of a few ulps.",
+    group="Scalar Math",
+)
+add_builtin(
+    "rsqrt",
+    input_types={"x": Float},
+    value_func=sametype_value_func(Float),
+    doc="Return the reciprocal square root of x, where x is positive, using the approximate hardware instruction on CUDA devices.",
+    group="Scalar Math",
+)
 add_builtin(
     "pow",
     input_types={"x": Float, "y": Float},
@@ -869,12 +899,26 @@ add_builtin(
         "U": matrix(shape=(3, 3), dtype=Float),
         "sigma": vector(length=3, dtype=Float),
         "V": matrix(shape=(3, 3), dtype=Scalar),
+        "sweeps": int,
     },
+    defaults={"sweeps": 4},
     value_type=None,
     group="Vector Math",
     export=False,
     doc="""Compute the SVD of a 3x3 matrix. The singular values are returned in sigma, 
-   while the left and right basis vectors are returned in U and V.""",
+   while the left and right basis vectors are returned in U and V.
+
+   The decomposition runs a fixed number of Jacobi ``sweeps`` without data-dependent branches, fewer sweeps trade accuracy for throughput.""",
+)
+
+add_builtin(
+    "polar3",
+    input_types={"A": matrix(shape=(3, 3), dtype=Float), "sweeps": int},
+    defaults={"sweeps": 4},
+    value_func=lambda args, kwds, _: args[0].type,
+    group="Vector Math",
+    doc="""Compute the rotation R of the polar decomposition A = R*S of a 3x3 matrix, where S is symmetric.
+   R is found from the SVD of A using ``sweeps`` Jacobi sweeps, see :func:`svd3`.""",
 )
 
 add_builtin(
@@ -896,11 +940,83 @@ add_builtin(
         "A": matrix(shape=(3, 3), dtype=Float),
         "Q": matrix(shape=(3, 3), dtype=Float),
         "d": vector(length=3, dtype=Float),
+        "sweeps": int,
+    },
+    defaults={"sweeps": 4},
+    value_type=None,
+    group="Vector Math",
+    export=False,
+    doc="""Compute the eigendecomposition of a 3x3 matrix. The eigenvectors are returned as the columns of Q, while the corresponding eigenvalues are returned in d.
+   The number of Jacobi ``sweeps`` is fixed, fewer sweeps trade accuracy for throughput.""",
+)
+
+
+def value_func_mat_factor(args, kwds, _):
+    if args is None:
+        return matrix(shape=(Any, Any), dtype=Float)
+    if args[0].type._shape_[0] != args[0].type._shape_[1]:
+        raise RuntimeError(f"Matrix shape is {args[0].type._shape_}. Cannot factorize non square matrices")
+    return args[0].type
+
+
+def value_func_mat_solve(args, kwds, _):
+    if args is None:
+        return vector(length=Any, dtype=Float)
+    m, b = args[0].type, args[-1].type
+    if m._shape_[0] != m._shape_[1] or m._shape_[0] != b._length_:
+        raise RuntimeError(f"Matrix shape is {m._shape_} and vector length is {b._length_}. Cannot solve the system")
+    return b
+
+
+add_builtin(
+    "cholesky",
+    input_types={"A": matrix(shape=(Any, Any), dtype=Float)},
+    value_func=value_func_mat_factor,
+    group="Vector Math",
+    doc="""Compute the Cholesky factor L of a symmetric positive definite matrix A = L*L^T, only the lower triangle of A is read.
+   The factorization is fully unrolled for the size of A, columns with a non-positive pivot are returned as zero.""",
+)
+
+add_builtin(
+    "cholesky_solve",
+    input_types={"L": matrix(shape=(Any, Any), dtype=Float), "b": vector(length=Any, dtype=Float)},
+    value_func=value_func_mat_solve,
+    group="Vector Math",
+    doc="""Solve L*L^T*x = b for x given the Cholesky factor L returned by :func:`cholesky`.""",
+)
+
+add_builtin(
+    "ldlt",
+    input_types={
+        "A": matrix(shape=(Any, Any), dtype=Float),
+        "L": matrix(shape=(Any, Any), dtype=Float),
+        "d": vector(length=Any, dtype=Float),
     },
     value_type=None,
     group="Vector Math",
     export=False,
-    doc="""Compute the eigendecomposition of a 3x3 matrix. The eigenvectors are returned as the columns of Q, while the corresponding eigenvalues are returned in d.""",
+    doc="""Compute the LDL^T factorization A = L*diag(d)*L^T of a symmetric matrix without square roots, only the lower triangle of A is read.
+   L is unit lower triangular, and the factorization is not pivoted so A should be definite (positive or negative).""",
+)
+
+add_builtin(
+    "ldlt_solve",
+    input_types={
+        "L": matrix(shape=(Any, Any), dtype=Float),
+        "d": vector(length=Any, dtype=Float),
+        "b": vector(length=Any, dtype=Float),
+    },
+    value_func=value_func_mat_solve,
+    group="Vector Math",
+    doc="""Solve L*diag(d)*L^T*x = b for x given the factors returned by :func:`ldlt`, components with a zero pivot are returned as zero.""",
+)
+
+add_builtin(
+    "solve",
+    input_types={"A": matrix(shape=(Any, Any), dtype=Float), "b": vector(length=Any, dtype=Float)},
+    value_func=value_func_mat_solve,
+    group="Vector Math",
+    doc="""Solve A*x = b for x with a fully unrolled LU factorization with partial pivoting of the square matrix A.""",
 )
 
 # ---------------------------------
@@ -1333,6 +1449,20 @@ add_builtin(
     group="Utility",
 )
 
+add_builtin(
+    "dense_chol_batched_warp",
+    input_types={
+        "A_start": array(dtype=int),
+        "A_dim": array(dtype=int),
+        "A": array(dtype=float),
+        "regularization": array(dtype=float),
+        "L": array(dtype=float),
+    },
+    value_type=None,
+    doc="Same as ``dense_chol_batched()`` but cooperatively computed by a warp of 32 threads per matrix on CUDA devices.",
+    group="Utility",
+)
+
 add_builtin(
     "dense_subs",
     input_types={"n": int, "L": array(dtype=float), "b": array(dtype=float), "x": array(dtype=float)},
@@ -1373,6 +1503,23 @@ add_builtin(
     group="Utility",
 )
 
+add_builtin(
+    "dense_solve_batched_warp",
+    input_types={
+        "b_start": array(dtype=int),
+        "A_start": array(dtype=int),
+        "A_dim": array(dtype=int),
+        "A": array(dtype=float),
+        "L": array(dtype=float),
+        "b": array(dtype=float),
+        "tmp": array(dtype=float),
+        "x": array(dtype=float),
+    },
+    value_type=None,
+    doc="Same as ``dense_solve_batched()`` but cooperatively computed by a warp of 32 threads per matrix on CUDA devices.",
+    group="Utility",
+)
+
 
 add_builtin(
     "mlp",
@@ -1542,6 +1689,7 @@ add_builtin(
    but also the most expensive.
      
     Note that the Mesh object must be constructed with ``suport_winding_number=True`` for this method to return correct results.
+    The solid angle data is computed before launching kernels that call this method, after the mesh was created or refit.
 
    :param id: The mesh identifier
    :param point: The point in space to query
@@ -1606,6 +1754,68 @@ add_builtin(
    if there are no more overlapping triangles.""",
 )
 
+add_builtin(
+    "tlas_query_ray",
+    input_types={
+        "id": uint64,
+        "start": vec3,
+        "dir": vec3,
+        "max_t": float,
+        "t": float,
+        "bary_u": float,
+        "bary_v": float,
+        "sign": float,
+        "normal": vec3,
+        "face": int,
+        "instance": int,
+    },
+    value_type=builtins.bool,
+    group="Geometry",
+    doc="""Computes the closest ray hit over all mesh instances of the TLAS with identifier `id`, returns ``True`` if a point < ``max_t`` is found.
+   The ray is given in world space and transformed into the space of each instance's mesh.
+
+   :param id: The TLAS identifier
+   :param start: The start point of the ray
+   :param dir: The ray direction (should be normalized)
+   :param max_t: The maximum distance along the ray to check for intersections
+   :param t: Returns the distance of the closest hit along the ray
+   :param bary_u: Returns the barycentric u coordinate of the closest hit
+   :param bary_v: Returns the barycentric v coordinate of the closest hit
+   :param sign: Returns a value > 0 if the hit ray hit front of the face, returns < 0 otherwise
+   :param normal: Returns the world space face normal
+   :param face: Returns the index of the hit face in the instance's mesh
+   :param instance: Returns the index of the hit instance""",
+)
+
+add_builtin(
+    "tlas_query_aabb",
+    input_types={"id": uint64, "lower": vec3, "upper": vec3},
+    value_type=bvh_query_t,
+    group="Geometry",
+    doc="""Construct an axis-aligned bounding box query against the instances of a TLAS object. Iterate it with
+   `wp.bvh_query_next()` to visit the indices of all instances whose world space bounds overlap the box.
+
+   :param id: The TLAS identifier
+   :param lower: The lower bound of the bounding box in world space
+   :param upper: The upper bound of the bounding box in world space""",
+)
+
+add_builtin(
+    "mesh_query_knn_points",
+    input_types={"id": uint64, "point": vec3, "max_dist": float, "heap": topk_heap_t(Any)},
+    value_type=int,
+    group="Geometry",
+    export=False,
+    doc="""Find the nearest vertices of a mesh within ``max_dist`` of a point, see :func:`topk_heap`. The indices of the
+   vertices are pushed to the heap with their distance as key, and the BVH traversal skips the nodes further than
+   :func:`topk_bound` once the heap is full. Returns the number of entries of the heap.
+
+   :param id: The mesh identifier
+   :param point: The query point
+   :param max_dist: The search radius
+   :param heap: The top-k heap receiving the vertices""",
+)
+
 add_builtin(
     "mesh_eval_position",
     input_types={"id": uint64, "face": int, "bary_u": float, "bary_v": float},
@@ -1622,6 +1832,125 @@ add_builtin(
     doc="""Evaluates the velocity on the mesh given a face index, and barycentric coordinates.""",
 )
 
+
+def topk_heap_value_func(args, kwds, templates):
+    if args is None:
+        return topk_heap_t(Any)
+
+    if len(args):
+        raise RuntimeError("topk_heap() function does not accept positional arguments")
+
+    k = kwds.get("k")
+    if k is None:
+        raise RuntimeError("'k' must be a constant when calling topk_heap() function")
+    if k < 1:
+        raise RuntimeError(f"topk_heap() capacity must be positive, got k={k}")
+
+    templates.append(k)
+
+    return topk_heap_t(k)
+
+
+add_builtin(
+    "topk_heap",
+    input_types={"k": int},
+    value_func=topk_heap_value_func,
+    variadic=True,
+    group="Utility",
+    export=False,
+    doc="""Construct an empty heap keeping the ``k`` smallest float keys pushed to it with an int value each, e.g.: the
+   distances and indices of the k nearest neighbors of a point. ``k`` is a compile-time constant so the heap is held in
+   registers or thread local memory.""",
+)
+
+add_builtin(
+    "topk_push",
+    input_types={"heap": topk_heap_t(Any), "key": float, "value": int},
+    value_type=builtins.bool,
+    group="Utility",
+    export=False,
+    doc="""Insert a key and its value in a top-k heap, once the heap is full the entry with the largest key is evicted.
+   Returns ``False`` if the key is not smaller than those of a full heap, in which case the heap is unchanged.""",
+)
+
+add_builtin(
+    "topk_count",
+    input_types={"heap": topk_heap_t(Any)},
+    value_type=int,
+    group="Utility",
+    export=False,
+    doc="""Return the number of entries of a top-k heap, at most its capacity.""",
+)
+
+add_builtin(
+    "topk_bound",
+    input_types={"heap": topk_heap_t(Any)},
+    value_type=float,
+    group="Utility",
+    export=False,
+    doc="""Return the largest key of a full top-k heap, or the largest float value if the heap is not full. Pushed keys
+   must be smaller than the bound to be kept, so searches can skip candidates further than it.""",
+)
+
+add_builtin(
+    "topk_sort",
+    input_types={"heap": topk_heap_t(Any)},
+    value_type=None,
+    group="Utility",
+    export=False,
+    doc="""Sort the entries of a top-k heap so that :func:`topk_key` and :func:`topk_value` return them by increasing
+   key. Entries pushed after sorting are kept, but the order is lost until the heap is sorted again.""",
+)
+
+add_builtin(
+    "topk_key",
+    input_types={"heap": topk_heap_t(Any), "i": int},
+    value_type=float,
+    group="Utility",
+    export=False,
+    doc="""Return the key of the i-th entry of a top-k heap, 0 <= i < :func:`topk_count`.""",
+)
+
+add_builtin(
+    "topk_value",
+    input_types={"heap": topk_heap_t(Any), "i": int},
+    value_type=int,
+    group="Utility",
+    export=False,
+    doc="""Return the value of the i-th entry of a top-k heap, 0 <= i < :func:`topk_count`.""",
+)
+
+
+def local_array_value_func(args, kwds, templates):
+    if args is None:
+        return vector(length=Any, dtype=Scalar)
+
+    if len(args):
+        raise RuntimeError("local_array() function does not accept positional arguments")
+
+    n, dtype = kwds.get("n"), kwds.get("dtype")
+    if n is None:
+        raise RuntimeError("'n' must be a constant when calling local_array() function")
+    if dtype is None:
+        raise RuntimeError("'dtype' keyword argument must be specified when calling local_array() function")
+
+    templates.append(n)
+    templates.append(dtype)
+
+    return vector(length=n, dtype=dtype)
+
+
+add_builtin(
+    "local_array",
+    input_types={"n": int, "dtype": Scalar},
+    value_func=local_array_value_func,
+    variadic=True,
+    group="Utility",
+    export=False,
+    doc="""Construct a zero-initialized thread local array of ``n`` scalars of type ``dtype``, ``n`` a compile-time
+   constant. The array is a vector, so it can be read and written with dynamic indices, e.g.: ``a[i] = a[i] + 1.0``.""",
+)
+
 add_builtin(
     "hash_grid_query",
     input_types={"id": uint64, "point": vec3, "max_dist": float},
@@ -1649,6 +1978,63 @@ add_builtin(
    traversal occurs in a spatially coherent order.""",
 )
 
+add_builtin(
+    "hash_grid_query_knn",
+    input_types={
+        "id": uint64,
+        "points": array(dtype=vec3),
+        "point": vec3,
+        "max_dist": float,
+        "heap": topk_heap_t(Any),
+    },
+    value_type=int,
+    group="Geometry",
+    export=False,
+    doc="""Find the nearest points of a hash grid within ``max_dist`` of a point, see :func:`topk_heap`. The indices of
+   the points are pushed to the heap with their distance as key, so it holds the ``k`` nearest points afterwards.
+   Returns the number of entries of the heap, entries pushed before the query are kept. The query point itself is
+   found if it belongs to the grid.
+
+   :param id: The hash grid identifier
+   :param points: The positions of the points the grid was built from
+   :param point: The query point
+   :param max_dist: The search radius, which bounds the number of grid cells visited
+   :param heap: The top-k heap receiving the neighbors""",
+)
+
+add_builtin(
+    "neighbor_list_query",
+    input_types={"id": uint64, "point": int},
+    value_type=neighbor_list_query_t,
+    group="Geometry",
+    export=False,
+    doc="""Construct a query over the precomputed neighbors of a point in a neighbor list. Returns an object that is
+   used to track state during neighbor traversal, the neighbors may lie up to the radius plus the skin of the list
+   away from the point and include the point itself.
+
+   :param id: The neighbor list identifier
+   :param point: The index of the point whose neighbors are visited""",
+)
+
+add_builtin(
+    "neighbor_list_query_next",
+    input_types={"query": neighbor_list_query_t, "index": int},
+    value_type=builtins.bool,
+    group="Geometry",
+    export=False,
+    doc="""Move to the next neighbor in the neighbor list query. The index of the current neighbor is stored in
+   ``index``, returns ``False`` if there are no more neighbors.""",
+)
+
+add_builtin(
+    "neighbor_list_count",
+    input_types={"id": uint64, "point": int},
+    value_type=int,
+    group="Geometry",
+    export=False,
+    doc="""Return the number of neighbors of a point in a neighbor list.""",
+)
+
 add_builtin(
     "intersect_tri_tri",
     input_types={"v0": vec3, "v1": vec3, "v2": vec3, "u0": vec3, "u1": vec3, "u2": vec3},
@@ -1736,6 +2122,9 @@ add_builtin(
 add_builtin("iter_next", input_types={"range": range_t}, value_type=int, group="Utility", hidden=True)
 add_builtin("iter_next", input_types={"query": hash_grid_query_t}, value_type=int, group="Utility", hidden=True)
 add_builtin("iter_next", input_types={"query": mesh_query_aabb_t}, value_type=int, group="Utility", hidden=True)
+add_builtin(
+    "iter_next", input_types={"query": neighbor_list_query_t}, value_type=int, group="Utility", export=False, hidden=True
+)
 
 # ---------------------------------
 # Volumes
@@ -1817,6 +2206,166 @@ add_builtin(
     doc="""Store the value at voxel with coordinates ``i``, ``j``, ``k``.""",
 )
 
+add_builtin(
+    "volume_query_ray",
+    input_types={"id": uint64, "origin": vec3, "dir": vec3, "tmin": float, "tmax": float, "t": float, "value": float},
+    value_type=builtins.bool,
+    group="Volumes",
+    doc="""Find the first zero crossing of the float volume given by ``id`` along the volume local-space ray ``origin + t * dir``
+   with ``t`` in [``tmin``, ``tmax``], returns ``True`` if one is found. The traversal uses a hierarchical DDA over the tree,
+   stepping across inactive tiles and nodes without reading them and visiting only the active voxels of the leaf nodes on the ray.
+
+   :param id: The volume identifier
+   :param origin: The ray origin in index space
+   :param dir: The ray direction in index space
+   :param tmin: The minimum ray parameter to consider
+   :param tmax: The maximum ray parameter to consider
+   :param t: Returns the ray parameter of the crossing, interpolated linearly between the voxels on either side
+   :param value: Returns the value of the first voxel past the crossing""",
+)
+
+add_builtin(
+    "volume_query_ray_span",
+    input_types={"id": uint64, "origin": vec3, "dir": vec3, "tmin": float, "tmax": float, "t0": float, "t1": float},
+    value_type=builtins.bool,
+    group="Volumes",
+    doc="""Find the first span of the volume local-space ray ``origin + t * dir`` with ``t`` in [``tmin``, ``tmax``] that lies in
+   active voxels or active tiles of the volume given by ``id``, returns ``True`` if one is found. Inactive regions are skipped one
+   tree node at a time, a rendering loop can march each span with :func:`volume_sample_f` and continue the query from ``t1``.
+
+   :param id: The volume identifier
+   :param origin: The ray origin in index space
+   :param dir: The ray direction in index space
+   :param tmin: The minimum ray parameter to consider
+   :param tmax: The maximum ray parameter to consider
+   :param t0: Returns the ray parameter at which the span starts
+   :param t1: Returns the ray parameter at which the span ends""",
+)
+
+add_builtin(
+    "volume_accessor",
+    input_types={"id": uint64},
+    value_type=volume_accessor_t,
+    group="Volumes",
+    doc="""Construct a read accessor for the volume given by ``id``. The accessor caches the tree nodes visited by its last query,
+    so that consecutive ``volume_sample_*()`` and ``volume_lookup_*()`` calls on it close to each other skip the descent from the root.""",
+)
+
+add_builtin(
+    "volume_sample_f",
+    input_types={"accessor": volume_accessor_t, "uvw": vec3, "sampling_mode": int},
+    value_type=float,
+    group="Volumes",
+    doc="""Sample the volume of the ``accessor`` at the volume local-space point ``uvw``. Interpolation should be ``wp.Volume.CLOSEST``, or ``wp.Volume.LINEAR.``""",
+)
+
+add_builtin(
+    "volume_sample_grad_f",
+    input_types={"accessor": volume_accessor_t, "uvw": vec3, "sampling_mode": int, "grad": vec3},
+    value_type=float,
+    group="Volumes",
+    doc="""Sample the volume of the ``accessor`` and its gradient at the volume local-space point ``uvw``. Interpolation should be ``wp.Volume.CLOSEST``, or ``wp.Volume.LINEAR.``""",
+)
+
+add_builtin(
+    "volume_lookup_f",
+    input_types={"accessor": volume_accessor_t, "i": int, "j": int, "k": int},
+    value_type=float,
+    group="Volumes",
+    doc="""Returns the value of voxel with coordinates ``i``, ``j``, ``k`` in the volume of the ``accessor``, if the voxel at this index does not exist this function returns the background value""",
+)
+
+add_builtin(
+    "volume_lookup_stencil2_f",
+    input_types={"accessor": volume_accessor_t, "i": int, "j": int, "k": int},
+    value_type=vector(length=8, dtype=float32),
+    group="Volumes",
+    doc="""Returns the values of the 2x2x2 voxels with coordinates ``i + di``, ``j + dj``, ``k + dk``, for ``di``, ``dj``, ``dk`` in {0, 1},
+    at index ``(di * 2 + dj) * 2 + dk``. Neighborhoods contained in a single leaf node are read after a single descent of the tree.""",
+)
+
+add_builtin(
+    "volume_lookup_stencil3_f",
+    input_types={"accessor": volume_accessor_t, "i": int, "j": int, "k": int},
+    value_type=vector(length=27, dtype=float32),
+    group="Volumes",
+    doc="""Returns the values of the 3x3x3 voxels with coordinates ``i + di``, ``j + dj``, ``k + dk``, for ``di``, ``dj``, ``dk`` in {-1, 0, 1},
+    at index ``((di + 1) * 3 + dj + 1) * 3 + dk + 1``. Neighborhoods contained in a single leaf node are read after a single descent of the tree.""",
+)
+
+add_builtin(
+    "volume_sample_v",
+    input_types={"accessor": volume_accessor_t, "uvw": vec3, "sampling_mode": int},
+    value_type=vec3,
+    group="Volumes",
+    doc="""Sample the vector volume of the ``accessor`` at the volume local-space point ``uvw``. Interpolation should be ``wp.Volume.CLOSEST``, or ``wp.Volume.LINEAR.``""",
+)
+
+add_builtin(
+    "volume_lookup_v",
+    input_types={"accessor": volume_accessor_t, "i": int, "j": int, "k": int},
+    value_type=vec3,
+    group="Volumes",
+    doc="""Returns the vector value of voxel with coordinates ``i``, ``j``, ``k`` in the volume of the ``accessor``, if the voxel at this index does not exist this function returns the background value""",
+)
+
+add_builtin(
+    "volume_sample_i",
+    input_types={"accessor": volume_accessor_t, "uvw": vec3},
+    value_type=int,
+    group="Volumes",
+    doc="""Sample the int32 volume of the ``accessor`` at the volume local-space point ``uvw``. """,
+)
+
+add_builtin(
+    "volume_lookup_i",
+    input_types={"accessor": volume_accessor_t, "i": int, "j": int, "k": int},
+    value_type=int,
+    group="Volumes",
+    doc="""Returns the int32 value of voxel with coordinates ``i``, ``j``, ``k`` in the volume of the ``accessor``, if the voxel at this index does not exist this function returns the background value""",
+)
+
+add_builtin(
+    "volume_atlas_get",
+    input_types={"atlas": uint64, "index": int},
+    value_type=uint64,
+    group="Volumes",
+    doc="""Returns the id of the volume at ``index`` in the ``wp.VolumeAtlas`` given by ``atlas``, which can be passed to any of the volume functions.""",
+)
+
+add_builtin(
+    "volume_sample_f",
+    input_types={"atlas": uint64, "index": int, "uvw": vec3, "sampling_mode": int},
+    value_type=float,
+    group="Volumes",
+    doc="""Sample the volume at ``index`` in the ``wp.VolumeAtlas`` given by ``atlas`` at the volume local-space point ``uvw``. Interpolation should be ``wp.Volume.CLOSEST``, or ``wp.Volume.LINEAR.``""",
+)
+
+add_builtin(
+    "volume_sample_grad_f",
+    input_types={"atlas": uint64, "index": int, "uvw": vec3, "sampling_mode": int, "grad": vec3},
+    value_type=float,
+    group="Volumes",
+    doc="""Sample the volume at ``index`` in the ``wp.VolumeAtlas`` given by ``atlas`` and its gradient at the volume local-space point ``uvw``. Interpolation should be ``wp.Volume.CLOSEST``, or ``wp.Volume.LINEAR.``""",
+)
+
+add_builtin(
+    "volume_lookup_f",
+    input_types={"atlas": uint64, "index": int, "i": int, "j": int, "k": int},
+    value_type=float,
+    group="Volumes",
+    doc="""Returns the value of voxel with coordinates ``i``, ``j``, ``k`` in the volume at ``index`` in the ``wp.VolumeAtlas`` given by ``atlas``, if the voxel at this index does not exist this function returns the background value""",
+)
+
+add_builtin(
+    "texture_sample_f",
+    input_types={"id": uint64, "uvw": vec3},
+    value_type=float,
+    group="Volumes",
+    doc="""Sample the ``wp.Texture3D`` given by ``id`` at the normalized coordinates ``uvw``, the center of texel ``(i, j, k)`` lying at
+    ``((i + 0.5) / nx, (j + 0.5) / ny, (k + 0.5) / nz)``. CUDA textures are filtered by the texture hardware, whose linear interpolation weights have an 8-bit precision.""",
+)
+
 add_builtin(
     "volume_index_to_world",
     input_types={"id": uint64, "uvw": vec3},
@@ -1847,6 +2396,104 @@ add_builtin(
 )
 
 
+# ---------------------------------
+# Tiles
+
+add_builtin(
+    "tile_load",
+    input_types={"a": array(dtype=float), "halo": int},
+    value_type=tile_t,
+    group="Tiles",
+    export=False,
+    doc="""Load the block-wide tile of the 1D array ``a`` covering the elements indexed by the thread ids of the calling block,
+    extended by ``halo`` elements on each side (at most 32), elements past the ends of the array are clamped to the edge.
+
+    On CUDA devices the threads of the block load the tile cooperatively into shared memory, each call site owning its own
+    storage, so every thread of the block must reach the call and the kernel must be launched with a size that is a multiple
+    of its ``block_dim``. On the CPU the tile reads the array directly. Gradients are not propagated through tiles.""",
+)
+
+add_builtin(
+    "tile_read",
+    input_types={"tile": tile_t, "offset": int},
+    value_type=float,
+    group="Tiles",
+    export=False,
+    doc="""Read the element of the ``tile`` that lies ``offset`` elements away from the element of the calling thread,
+    the offset is clamped to the halo of the tile.""",
+)
+
+add_builtin(
+    "tile_sync",
+    input_types={},
+    value_type=None,
+    group="Tiles",
+    export=False,
+    doc="""Synchronize the threads of the calling block, e.g.: before loading a tile again inside of a loop,
+    once all threads are done reading its previous contents. No-op on the CPU.""",
+)
+
+
+# ---------------------------------
+# Warp Intrinsics
+
+add_builtin(
+    "lane_id",
+    input_types={},
+    value_type=int,
+    group="Warp Intrinsics",
+    export=False,
+    doc="""Return the index of the calling thread within its warp of 32 threads. CPU launches behave as warps of a single lane.""",
+)
+
+for u in [bool, builtins.bool]:
+    add_builtin(
+        "warp_ballot",
+        input_types={"predicate": u},
+        value_type=uint32,
+        group="Warp Intrinsics",
+        export=False,
+        doc="""Return a bit mask of the active lanes of the warp for which ``predicate`` is true, bit ``i`` standing for lane ``i``.""",
+    )
+
+for t in [int32, uint32, int64, uint64, float32, float64]:
+    add_builtin(
+        "warp_shuffle",
+        input_types={"value": t, "lane": int},
+        value_type=t,
+        group="Warp Intrinsics",
+        export=False,
+        doc="""Return the ``value`` passed by the given ``lane`` of the warp, which must be active.""",
+    )
+
+    add_builtin(
+        "warp_reduce_sum",
+        input_types={"value": t},
+        value_type=t,
+        group="Warp Intrinsics",
+        export=False,
+        doc="""Return the sum of the ``value`` passed by each active lane of the warp to all of them.""",
+    )
+
+    add_builtin(
+        "warp_reduce_min",
+        input_types={"value": t},
+        value_type=t,
+        group="Warp Intrinsics",
+        export=False,
+        doc="""Return the minimum of the ``value`` passed by each active lane of the warp to all of them.""",
+    )
+
+    add_builtin(
+        "warp_reduce_max",
+        input_types={"value": t},
+        value_type=t,
+        group="Warp Intrinsics",
+        export=False,
+        doc="""Return the maximum of the ``value`` passed by each active lane of the warp to all of them.""",
+    )
+
+
 # ---------------------------------
 # Random
 
@@ -1899,6 +2546,48 @@ add_builtin(
 add_builtin(
     "randn", input_types={"state": uint32}, value_type=float, group="Random", doc="Sample a normal distribution"
 )
+add_builtin(
+    "randn2",
+    input_types={"state": uint32},
+    value_type=vec2,
+    group="Random",
+    doc="Sample two independent values from a normal distribution, using both outputs of a single Box-Muller transform",
+)
+
+add_builtin(
+    "philox",
+    input_types={"key": vec2ui, "counter": vec4ui},
+    value_type=vec4ui,
+    group="Random",
+    doc="""Evaluate the Philox4x32-10 counter-based generator, returning four random 32-bit integers.
+   The result depends only on ``key`` and ``counter``, so any element of a stream can be computed directly
+   and results are identical on every device and for any launch configuration.""",
+)
+add_builtin(
+    "philox",
+    input_types={"seed": int, "index": int, "offset": int},
+    value_type=vec4ui,
+    group="Random",
+    doc="""Evaluate the Philox4x32-10 generator for block ``offset`` of stream ``index`` under ``seed``, returning four random 32-bit integers.
+   Each call consumes one block, skipping ahead by ``n`` blocks is done by adding ``n`` to ``offset``.
+   Typical usage is ``r = philox(seed, tid, i)`` for the ``i``-th batch of values in thread ``tid``.""",
+)
+add_builtin(
+    "philox_randf4",
+    input_types={"seed": int, "index": int, "offset": int},
+    value_type=vec4,
+    group="Random",
+    doc="""Return four random floats between [0.0, 1.0) from block ``offset`` of the Philox stream ``index``, see :func:`philox`.
+   The values are bitwise identical across CPU and CUDA devices.""",
+)
+add_builtin(
+    "philox_randn4",
+    input_types={"seed": int, "index": int, "offset": int},
+    value_type=vec4,
+    group="Random",
+    doc="""Return four samples of a normal distribution from block ``offset`` of the Philox stream ``index``, see :func:`philox`.
+   The four uniforms of the block drive two Box-Muller transforms whose cosine and sine outputs are both used.""",
+)
 
 add_builtin(
     "sample_cdf",
@@ -2040,6 +2729,44 @@ add_builtin(
     doc="Periodic Perlin-style noise in 4d.",
 )
 
+add_builtin(
+    "tnoise",
+    input_types={"state": uint32, "xy": vec2},
+    value_type=float,
+    group="Random",
+    doc="""Table-driven Perlin-style gradient noise in 2d.
+   Uses a fixed permutation and gradient table in constant memory instead of hashing each lattice corner,
+   which is considerably cheaper than :func:`noise`. The pattern repeats every 256 lattice units.""",
+)
+add_builtin(
+    "tnoise",
+    input_types={"state": uint32, "xyz": vec3},
+    value_type=float,
+    group="Random",
+    doc="""Table-driven Perlin-style gradient noise in 3d.
+   Uses a fixed permutation and gradient table in constant memory instead of hashing each lattice corner,
+   which is considerably cheaper than :func:`noise`. The pattern repeats every 256 lattice units.""",
+)
+
+add_builtin(
+    "fbm",
+    input_types={"state": uint32, "xy": vec2, "octaves": int, "lacunarity": float, "gain": float},
+    value_type=float,
+    group="Random",
+    doc="""Fractal Brownian motion in 2d, the sum of ``octaves`` layers of :func:`tnoise`.
+   The frequency of each layer is multiplied by ``lacunarity`` and its amplitude by ``gain``, starting from one.
+   The value and its gradients are evaluated in a single pass over the octaves.""",
+)
+add_builtin(
+    "fbm",
+    input_types={"state": uint32, "xyz": vec3, "octaves": int, "lacunarity": float, "gain": float},
+    value_type=float,
+    group="Random",
+    doc="""Fractal Brownian motion in 3d, the sum of ``octaves`` layers of :func:`tnoise`.
+   The frequency of each layer is multiplied by ``lacunarity`` and its amplitude by ``gain``, starting from one.
+   The value and its gradients are evaluated in a single pass over the octaves.""",
+)
+
 add_builtin(
     "curlnoise",
     input_types={"state": uint32, "xy": vec2},
@@ -2278,8 +3005,8 @@ def atomic_op_value_func(args, kwds, _):
 
 
 for array_type in array_types:
-    # don't list indexed array operations explicitly in docs
-    hidden = array_type == indexedarray
+    # don't list indexed and structure of arrays operations explicitly in docs
+    hidden = array_type in (indexedarray, soaarray)
 
     add_builtin(
         "atomic_add",
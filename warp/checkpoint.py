@@ -0,0 +1,242 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import concurrent.futures
+import ctypes
+import json
+import struct
+import threading
+
+import warp
+import warp.types
+
+# file layout: the magic, the size of the JSON header, the header, then the data of each array in a chunk aligned to
+# CHUNK_ALIGNMENT bytes, at the offset from the first chunk given by the header, stored contiguously
+MAGIC = b"WARPCKPT"
+VERSION = 1
+CHUNK_ALIGNMENT = 4096
+
+# writes run in order on a single thread, so that successive checkpoints of a job complete in order
+_save_executor = None
+
+# pinned staging buffers of completed saves, reused by the next ones
+_staging_pool = []
+_staging_lock = threading.Lock()
+
+
+def _align(offset):
+    return (offset + CHUNK_ALIGNMENT - 1) // CHUNK_ALIGNMENT * CHUNK_ALIGNMENT
+
+
+def _acquire_staging(size):
+    with _staging_lock:
+        fits = [b for b in _staging_pool if b.capacity >= size]
+        if fits:
+            buffer = min(fits, key=lambda b: b.capacity)
+            _staging_pool.remove(buffer)
+            return buffer
+    return warp.empty(max(size, 1), dtype=warp.uint8, device="cpu", pinned=warp.is_cuda_available())
+
+
+def _release_staging(buffers):
+    with _staging_lock:
+        _staging_pool.extend(buffers)
+
+
+def _host_buffer(ptr, size):
+    return (ctypes.c_char * size).from_address(ptr)
+
+
+def _read_into(f, ptr, size, path):
+    if f.readinto(_host_buffer(ptr, size)) != size:
+        raise RuntimeError(f"Checkpoint '{path}' is truncated")
+
+
+def _collect_arrays(arrays):
+    # arrays by name from a dictionary or from the attributes of an object, e.g.: a warp.sim.State
+    if not isinstance(arrays, dict):
+        arrays = vars(arrays)
+    return {name: a for name, a in arrays.items() if isinstance(a, warp.array)}
+
+
+def _dtype_desc(dtype):
+    if isinstance(dtype, warp.codegen.Struct):
+        return {"struct": dtype.key}
+
+    scalar = getattr(dtype, "_wp_scalar_type_", dtype)
+    return {
+        "type": dtype.__name__,
+        "generic": getattr(dtype, "_wp_generic_type_str_", None),
+        "scalar": scalar.__name__,
+        "shape": list(getattr(dtype, "_shape_", ())),
+    }
+
+
+def _dtype_from_desc(desc, name, dtypes):
+    if name in dtypes:
+        return dtypes[name]
+    if "struct" in desc:
+        raise RuntimeError(f"Array '{name}' holds structs of type {desc['struct']}, pass its type in `dtypes`")
+
+    scalar = getattr(warp.types, desc["scalar"])
+    shape = tuple(desc["shape"])
+
+    # named types like vec3f or transformf, anything else is rebuilt from its scalar type and shape
+    dtype = getattr(warp.types, desc["type"], None)
+    if dtype is not None and getattr(dtype, "_wp_scalar_type_", dtype) is scalar:
+        if tuple(getattr(dtype, "_shape_", ())) == shape:
+            return dtype
+
+    generic = desc["generic"]
+    if generic == "vec_t":
+        return warp.types.vector(length=shape[0], dtype=scalar)
+    elif generic == "mat_t":
+        return warp.types.matrix(shape=shape, dtype=scalar)
+    elif generic == "quat_t":
+        return warp.types.quaternion(dtype=scalar)
+    elif generic == "transform_t":
+        return warp.types.transformation(dtype=scalar)
+    return scalar
+
+
+def _write_checkpoint(path, header, chunks):
+    data_start = _align(len(MAGIC) + 8 + len(header))
+    try:
+        with open(path, "wb") as f:
+            f.write(MAGIC)
+            f.write(struct.pack("<Q", len(header)))
+            f.write(header)
+            for offset, nbytes, staging, event in chunks:
+                if event is not None:
+                    event.synchronize()
+                f.seek(data_start + offset)
+                f.write(_host_buffer(staging.ptr, nbytes))
+    finally:
+        _release_staging([c[2] for c in chunks])
+
+
+def save_checkpoint(path, arrays) -> concurrent.futures.Future:
+    """Writes a checkpoint of arrays to a binary file without waiting for the devices
+
+    The arrays are copied on the current stream of their devices to pinned staging buffers, which are written to
+    the file by a background thread once the copies complete, so the simulation continues meanwhile. CPU arrays are
+    copied right away. The arrays may be modified as soon as the function returns. The file holds a header with the
+    name, type and shape of each array, followed by the data of each array in a chunk aligned to 4 KB.
+
+    Args:
+        path: Path of the file to write
+        arrays: A dictionary of arrays by name, or an object whose array attributes are saved, e.g. a ``warp.sim.State``
+
+    Returns:
+        A ``concurrent.futures.Future`` that completes when the file is written, re-raising errors of the write
+    """
+    global _save_executor
+
+    entries = []
+    chunks = []
+    offset = 0
+
+    for name, a in _collect_arrays(arrays).items():
+        nbytes = a.size * warp.types.type_size_in_bytes(a.dtype)
+        staging = _acquire_staging(nbytes)
+        event = None
+
+        if nbytes:
+            src = a if a.is_contiguous else a.contiguous()
+            if src.device.is_cpu:
+                ctypes.memmove(staging.ptr, src.ptr, nbytes)
+            else:
+                view = warp.array(ptr=staging.ptr, dtype=a.dtype, shape=a.shape, device="cpu", owner=False)
+                warp.copy(view, src)
+                event = warp.get_stream(src.device).record_event()
+
+        entries.append({"name": name, "dtype": _dtype_desc(a.dtype), "shape": list(a.shape), "offset": offset})
+        chunks.append((offset, nbytes, staging, event))
+        offset = _align(offset + nbytes)
+
+    header = json.dumps({"version": VERSION, "arrays": entries}).encode("utf-8")
+
+    if _save_executor is None:
+        _save_executor = concurrent.futures.ThreadPoolExecutor(max_workers=1, thread_name_prefix="warp_save")
+    return _save_executor.submit(_write_checkpoint, path, header, chunks)
+
+
+def load_checkpoint(path, device=None, into=None, dtypes=None):
+    """Reads the arrays of a checkpoint written by :func:`save_checkpoint`
+
+    The data read from the file is copied to the devices asynchronously on their current stream, through two pinned
+    staging buffers so that reading the next array overlaps with the copy of the previous one.
+
+    Args:
+        path: Path of the file to read
+        device: Device of the new arrays (optional)
+        into: A dictionary of arrays by name, or an object with array attributes, e.g.: a ``warp.sim.State``, the
+            arrays with the names of those of the checkpoint receive their data and must have the same type and shape,
+            the others are created (optional)
+        dtypes: Types of the arrays by name, required for arrays of structs that are not loaded into existing arrays
+
+    Returns:
+        A dictionary of the arrays by name, including those of ``into``
+    """
+    device = warp.get_device(device)
+    dtypes = dtypes or {}
+    targets = _collect_arrays(into) if into is not None else {}
+
+    arrays = {}
+    staging = [None, None]
+    events = [None, None]
+
+    with open(path, "rb") as f:
+        if f.read(len(MAGIC)) != MAGIC:
+            raise RuntimeError(f"File '{path}' is not a Warp checkpoint")
+        (header_size,) = struct.unpack("<Q", f.read(8))
+        header = json.loads(f.read(header_size).decode("utf-8"))
+        if header["version"] > VERSION:
+            raise RuntimeError(f"Checkpoint '{path}' has version {header['version']}, expected at most {VERSION}")
+        data_start = _align(len(MAGIC) + 8 + header_size)
+
+        for i, entry in enumerate(header["arrays"]):
+            name = entry["name"]
+            shape = tuple(entry["shape"])
+            target = targets.get(name)
+
+            if target is not None:
+                dtype = target.dtype
+                saved, expected = entry["dtype"], _dtype_desc(dtype)
+                if target.shape != shape or any(saved.get(k) != expected[k] for k in expected if k != "type"):
+                    raise RuntimeError(f"Array '{name}' of the checkpoint doesn't match the shape or type of `into`")
+                dst = target
+            else:
+                dtype = _dtype_from_desc(entry["dtype"], name, dtypes)
+                dst = warp.empty(shape, dtype=dtype, device=device)
+
+            arrays[name] = dst
+            nbytes = dst.size * warp.types.type_size_in_bytes(dtype)
+            if not nbytes:
+                continue
+
+            f.seek(data_start + entry["offset"])
+
+            if dst.device.is_cpu and dst.is_contiguous:
+                _read_into(f, dst.ptr, nbytes, path)
+                continue
+
+            # alternate between the staging buffers, waiting for the copy that last used the buffer
+            slot = i % 2
+            if events[slot] is not None:
+                events[slot].synchronize()
+            if staging[slot] is None or staging[slot].capacity < nbytes:
+                staging[slot] = warp.empty(nbytes, dtype=warp.uint8, device="cpu", pinned=warp.is_cuda_available())
+
+            _read_into(f, staging[slot].ptr, nbytes, path)
+            view = warp.array(ptr=staging[slot].ptr, dtype=dtype, shape=shape, device="cpu", owner=False)
+            warp.copy(dst, view)
+            events[slot] = warp.get_stream(dst.device).record_event() if dst.device.is_cuda else None
+
+    for name, a in targets.items():
+        arrays.setdefault(name, a)
+    return arrays
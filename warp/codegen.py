@@ -11,6 +11,7 @@ import ast
 import builtins
 import ctypes
 import inspect
+import itertools
 import re
 import sys
 import textwrap
@@ -181,6 +182,32 @@ class StructInstance:
     def __ctype__(self):
         return self._ctype
 
+    def _param_buffer(self, device):
+        # pointer to a copy of the struct in device memory, for CUDA kernels that take it through a parameter buffer,
+        # see select_param_buffer_args(), a new version is uploaded when the struct has changed since its last launch
+        data = ctypes.string_at(ctypes.addressof(self._ctype), ctypes.sizeof(self._ctype))
+
+        buffers = self.__dict__.setdefault("_param_buffers", {})
+        version = buffers.get(device.alias)
+        if version is None or version[0] != data:
+            # versions are never written again, so launches still reading the previous one are unaffected, the pinned
+            # staging copy also lets captured graphs replay the upload
+            host = warp.empty(len(data), dtype=warp.uint8, device="cpu", pinned=device.is_cuda)
+            ctypes.memmove(host.ptr, data, len(data))
+            buf = warp.empty(len(data), dtype=warp.uint8, device=device)
+            warp.copy(buf, host)
+            version = (data, buf, host)
+            buffers[device.alias] = version
+
+        # graphs keep the pointers of the versions used during their capture
+        if device.is_capturing:
+            self.__dict__.setdefault("_captured_param_buffers", []).append(version)
+
+        # recorded launches upload the struct again when it has changed, see Launch.update_param_buffers()
+        param = ctypes.c_uint64(version[1].ptr)
+        param.struct = self
+        return param
+
     def __repr__(self):
         return struct_instance_repr_recursive(self, 0)
 
@@ -224,6 +251,9 @@ class Struct:
         self.module = module
         self.key = key
 
+        # digest of the field declarations, computed on demand by Module.hash_module()
+        self.content_hash = None
+
         self.vars = {}
         annotations = get_annotations(self.cls)
         for label, type in annotations.items():
@@ -418,6 +448,66 @@ class Var:
             return self.label
 
 
+# builtins free of side effects whose result only depends on their arguments, so that repeated calls
+# with the same arguments can share a single evaluation and calls with unused results can be removed
+pure_builtin_groups = {"Scalar Math", "Vector Math", "Quaternion Math", "Transformations", "Spatial Math", "Operators"}
+pure_builtins = {"select", "lerp", "smoothstep", "index"}
+
+# builtins that do not modify the variables passed to them, other calls are assumed to modify their arguments
+readonly_builtins = {
+    "load",
+    "address",
+    "view",
+    "store",
+    "atomic_add",
+    "atomic_sub",
+    "atomic_min",
+    "atomic_max",
+    "range",
+    "print",
+    "printf",
+    "expect_eq",
+    "expect_neq",
+    "expect_near",
+}
+
+# builtins that read the arrays passed to them, the other calls are assumed to write to them, see Adjoint.written_args,
+# the results of the ones returning arrays alias their array arguments
+array_read_builtins = {"load", "view", "select", "len", "tile_load"}
+
+# approximations evaluated instead of the builtins by functions and kernels compiled with fast_math
+approx_builtins = {"sin": "sin_approx", "cos": "cos_approx", "exp": "exp_approx"}
+
+# builtins apart from pure ones that a thread can evaluate in a SIMD lane next to its neighbors, see cpu_simd_width
+lane_builtins = {"tid", "load", "address", "view", "store", "array_store", "copy", "assign", "extract", "indexref"}
+
+# builtins apart from pure ones that the forward-mode entry points of kernels evaluate on dual numbers, see dual.h,
+# the other builtins are only supported when none of their arguments carry tangents, see carries_tangent()
+tangent_builtins = lane_builtins | {"atomic_add", "atomic_sub", "print", "len"}
+
+# builtins reading the thread index of the launch grid, which only the tid() calls of kernels map to the threads of
+# the tasks of persistent kernels, see is_persistent_task()
+grid_index_builtins = {
+    "dense_gemm_batched",
+    "dense_chol_batched",
+    "dense_chol_batched_warp",
+    "dense_solve_batched",
+    "dense_solve_batched_warp",
+}
+
+
+def carries_tangent(t):
+    # whether values of type t hold float32 components, which forward-mode code replaces by dual numbers
+    if is_array(t):
+        t = t.dtype
+    return type_scalar_type(t) is float32
+
+
+def intermediate_size(t):
+    # size of a value stored by kernels storing their intermediates, 0 for types that can't be stored, e.g.: iterators
+    return warp.types.type_size_in_bytes(warp.types.bool if t is builtins.bool else t)
+
+
 class Block:
     # Represents a basic block of instructions, e.g.: list
     # of straight line instructions inside a for-loop or conditional
@@ -431,6 +521,9 @@ class Block:
         # list of vars declared in this block
         self.vars = []
 
+        # label prefix of the loop starting with this block, for break and continue
+        self.loop_kind = "for"
+
 
 class Adjoint:
     # Source code transformer, this class takes a Python function and
@@ -468,6 +561,9 @@ class Adjoint:
         # ensures that indented class methods can be parsed as kernels
         adj.source = textwrap.dedent(adj.source)
 
+        # digest of the source, computed on demand by Module.hash_module()
+        adj.source_hash = None
+
         # extract name of source file
         adj.filename = inspect.getsourcefile(func) or "unknown source file"
 
@@ -513,8 +609,11 @@ class Adjoint:
             arg = Var(name, type, False)
             adj.args.append(arg)
 
+        # values of the arguments a kernel is specialized on, evaluated as constants in its body
+        adj.specialized_args = {}
+
     # generate function ssa form and adjoint
-    def build(adj, builder):
+    def build(adj, builder, is_kernel=False, store_intermediates=False, fast_math=None):
         adj.builder = builder
 
         adj.symbols = {}  # map from symbols to adjoint variables
@@ -533,10 +632,71 @@ class Adjoint:
         # used to generate new label indices
         adj.label_count = 0
 
+        # whether the function loads block-wide tiles, directly or through the functions it calls
+        adj.uses_tiles = False
+
+        # whether the function queries mesh winding numbers, whose solid angle data is computed before launches
+        adj.uses_winding_number = False
+
+        # whether the function reads the thread index of the launch grid other than through the tid() of a kernel,
+        # e.g.: in user functions calling tid(), directly or through the functions it calls
+        adj.uses_grid_index = False
+
+        # whether the forward pass is straight-line code only calling builtins that can run in SIMD lanes,
+        # in which case CPU kernels can process consecutive threads in a vectorized loop
+        adj.lane_safe = True
+        adj.is_kernel = is_kernel
+
+        # why the function can't be evaluated on dual numbers by forward-mode code, or None, see codegen_tangent()
+        adj.tangent_error = None
+        # variables computed without tangents whose values are lifted to dual numbers
+        adj.tangent_lifted = set()
+        # attributes of builtin types, whose float32 values don't carry tangents
+        adj.tangent_primal = set()
+        if store_intermediates and is_kernel:
+            adj.tangent_error = "stores intermediates"
+        for a in adj.args:
+            if isinstance(a.type, Struct) or is_array(a.type) and isinstance(a.type.dtype, Struct):
+                adj.tangent_error = f"argument '{a.label}' is a struct"
+            elif is_kernel and is_array(a.type) and type(a.type) is not array and carries_tangent(a.type):
+                adj.tangent_error = f"argument '{a.label}' is a {type(a.type).__name__} of float32 values"
+
+        # variables known to hold the same value in all threads, e.g.: kernel arguments and builtins evaluated on them
+        adj.uniform_vars = set(adj.args) if is_kernel else set()
+
+        # common subexpressions available in each nested scope (conditionals and loops) and variables modified
+        # in place since their definition, plus the pure calls emitted so far as candidates for dead code elimination
+        adj.optimize = builder is not None and builder.options.get("optimize_codegen", True)
+        adj.cse_scopes = [({}, False)]
+        adj.cse_mutated = set()
+        adj.pure_calls = []
+
+        # whether the forward pass of the kernel stores intermediates for its backward pass to reload instead of
+        # recomputing them, and the number of bytes stored per thread
+        adj.store_intermediates = is_kernel and store_intermediates
+        adj.intermediates_size = 0
+
+        # whether transcendental builtins are replaced by their approximations, see approx_builtins
+        if fast_math is None:
+            fast_math = builder is not None and builder.options.get("fast_math", False)
+        adj.fast_math = fast_math
+
+        # array arguments that the function may write to by index, and the arguments that each variable
+        # holding an array may alias, which lets launches on automatic streams order only conflicting kernels
+        adj.written_args = set()
+        adj.array_roots = {a: frozenset((i,)) for i, a in enumerate(adj.args) if is_array(a.type)}
+
         # update symbol map for each argument
         for a in adj.args:
             adj.symbols[a.label] = a
 
+        # specialized arguments are still passed to the kernel, but their uses refer to compile-time constants
+        adj.specialized_vars = {}
+        for name, value in adj.specialized_args.items():
+            arg_type = adj.arg_types[name]
+            const = adj.add_constant(value if arg_type in (int, float, builtins.bool) else arg_type(value))
+            adj.symbols[name] = adj.specialized_vars[name] = const
+
         # recursively evaluate function body
         try:
             adj.eval(adj.tree.body[0])
@@ -550,6 +710,15 @@ class Adjoint:
             finally:
                 raise e
 
+        if adj.optimize:
+            adj.eliminate_dead_code()
+
+        if adj.uses_tiles:
+            adj.tangent_error = "uses tiles"
+        for var in adj.variables:
+            if isinstance(var.type, Struct):
+                adj.tangent_error = f"uses struct {var.type.key}"
+
         if builder is not None:
             for a in adj.args:
                 if isinstance(a.type, Struct):
@@ -673,6 +842,107 @@ class Adjoint:
         output = adj.add_var(type=type(n), constant=n)
         return output
 
+    def is_uniform(adj, var):
+        # whether a variable holds the same value in all threads of the launch
+        return isinstance(var, Var) and (var.constant is not None or var in adj.uniform_vars)
+
+    def is_pure(adj, func):
+        return (
+            func.is_builtin()
+            and (func.group in pure_builtin_groups or func.key in pure_builtins)
+            and not func.skip_replay
+            and func.custom_replay_func is None
+        )
+
+    def add_pure_call(adj, output, num_reverse):
+        # record the statements of a pure call just emitted, for eliminate_dead_code(), num_reverse is
+        # the length of the reverse body before the call so that calls without an adjoint are handled
+        block = adj.blocks[-1]
+        statements = {block.body_forward[-1], block.body_replay[-1]}
+        statements.update(block.body_reverse[num_reverse:])
+        adj.pure_calls.append((output, statements))
+
+    def get_intermediates(adj, func, args, output):
+        # the values stored by kernels storing their intermediates are the results of calls other than arithmetic and
+        # array accesses, together with the arguments these calls may write to, e.g.: the outputs of mesh queries,
+        # dynamic loops are excluded since their bodies are replayed for each iteration in the backward pass
+        if not adj.store_intermediates or len(adj.blocks) > 1 or not len(args):
+            return None
+
+        if adj.is_pure(func) or (func.is_builtin() and func.key in readonly_builtins):
+            return None
+
+        if func.skip_replay or func.custom_replay_func is not None:
+            return None
+
+        stored = [output]
+        if func.is_builtin():
+            stored += [a for a in args if isinstance(a, Var) and a.constant is None and a.label.isdigit()]
+        stored = list(dict.fromkeys(stored))
+
+        if any(intermediate_size(v.type) == 0 for v in stored):
+            return None
+
+        return stored
+
+    def add_intermediate(adj, var):
+        # slots are 8-byte aligned so that the values of all threads in a slot are aligned too
+        offset = adj.intermediates_size
+        adj.intermediates_size += (intermediate_size(var.type) + 7) // 8 * 8
+        return offset
+
+    def begin_scope(adj, loop=False):
+        adj.cse_scopes.append(({}, loop))
+
+    def end_scope(adj):
+        adj.cse_scopes.pop()
+
+    def cse_lookup(adj, key):
+        # find an earlier evaluation of a pure call in the enclosing scopes, loop-carried variables are
+        # overwritten at the end of each iteration so evaluations from outside of a loop are not visible in it
+        if any(a in adj.cse_mutated for a in key[-1]):
+            return None
+
+        for scope, loop in reversed(adj.cse_scopes):
+            var = scope.get(key)
+            if var is not None:
+                return None if var in adj.cse_mutated else var
+            if loop:
+                break
+
+        return None
+
+    def eliminate_dead_code(adj):
+        # remove the pure calls whose results are not referenced outside of their own statements,
+        # including their replay and adjoint, the variables they read may become dead in turn
+        block = adj.blocks[0]
+        pattern = re.compile(r"\bvar_(\w+)")
+
+        users = {}
+        for s in itertools.chain(block.body_forward, block.body_replay, block.body_reverse):
+            for label in pattern.findall(s):
+                users.setdefault(label, set()).add(s)
+
+        dead = set()
+        changed = True
+        while changed:
+            changed = False
+            for output, statements in adj.pure_calls:
+                if output in dead or not users.get(output.label, set()) <= statements:
+                    continue
+
+                dead.add(output)
+                changed = True
+                for s in statements:
+                    for label in pattern.findall(s):
+                        users[label].discard(s)
+
+        if dead:
+            removed = set().union(*(statements for output, statements in adj.pure_calls if output in dead))
+            block.body_forward = [s for s in block.body_forward if s not in removed]
+            block.body_replay = [s for s in block.body_replay if s not in removed]
+            block.body_reverse = [s for s in block.body_reverse if s not in removed]
+
     def add_comp(adj, op_strings, left, comps):
         output = adj.add_var(builtins.bool)
 
@@ -695,7 +965,36 @@ class Adjoint:
 
         return output
 
+    def add_array_uses(adj, func, args, value_type):
+        # records the array arguments that a call may write to, and returns the ones its array result aliases
+        roots = [adj.array_roots.get(a, frozenset()) if isinstance(a, Var) else frozenset() for a in args]
+        used = frozenset().union(*roots)
+        if not used:
+            return frozenset()
+
+        if func.is_builtin() and func.key == "copy":
+            # assignment to a loop-carried variable, which may then alias either array
+            adj.array_roots[args[0]] = roots[0] | roots[1]
+            return frozenset()
+
+        if func.is_builtin() and func.key in array_read_builtins:
+            return used if is_array(value_type) else frozenset()
+
+        value_types = value_type if isinstance(value_type, list) else [value_type]
+        if not func.is_builtin() and not any(is_array(t) for t in value_types):
+            for i, r in enumerate(roots):
+                if i in func.adj.written_args:
+                    adj.written_args.update(r)
+            return frozenset()
+
+        # other builtins store to their arrays, and the arrays returned by functions are written through conservatively
+        adj.written_args.update(used)
+        return frozenset()
+
     def add_call(adj, func, args, min_outputs=None, templates=[], kwds=None):
+        if adj.fast_math and func.is_builtin() and func.key in approx_builtins:
+            func = warp.context.builtin_functions[approx_builtins[func.key]]
+
         # if func is overloaded then perform overload resolution here
         # we validate argument types before they go to generated native code
         resolved_func = None
@@ -796,14 +1095,87 @@ class Adjoint:
         # if it is a user-function then build it recursively
         if not func.is_builtin():
             adj.builder.build_function(func)
+            adj.uses_tiles = adj.uses_tiles or func.adj.uses_tiles
+            adj.uses_winding_number = adj.uses_winding_number or func.adj.uses_winding_number
+            adj.uses_grid_index = adj.uses_grid_index or func.adj.uses_grid_index
+            adj.lane_safe = adj.lane_safe and func.adj.lane_safe
+            if func.adj.tangent_error and not adj.tangent_error:
+                adj.tangent_error = f"calls {func.key}, which {func.adj.tangent_error}"
+        elif not adj.is_pure(func) and func.key not in lane_builtins:
+            adj.lane_safe = False
+
+        # arguments holding dual numbers in forward-mode code, attributes of builtin types like meshes hold float32
+        tangent_args = [
+            a for a in args if isinstance(a, Var) and carries_tangent(a.type) and a.label not in adj.tangent_primal
+        ]
+
+        if func.is_builtin() and not adj.is_pure(func) and func.key not in tangent_builtins and tangent_args:
+            if not adj.tangent_error:
+                adj.tangent_error = f"calls {func.key} on float32 values"
+
+        if tangent_args and any(isinstance(a, Var) and a.label in adj.tangent_primal for a in args):
+            if not adj.tangent_error:
+                adj.tangent_error = f"calls {func.key} on attributes of builtin types and float32 values"
+
+        # function arguments of builtins, e.g.: activations of mlp(), are only compiled for regular values
+        if func.is_builtin() and any(isinstance(a, warp.context.Function) for a in args):
+            if not adj.tangent_error:
+                adj.tangent_error = f"passes a function to {func.key}"
+            if adj.builder:
+                adj.builder.function_values.update(a for a in args if isinstance(a, warp.context.Function))
+
+        # each tile_load() call site gets its own shared memory tile, numbered across the module
+        if func.is_builtin() and func.key == "tile_load":
+            templates = [adj.builder.tile_count if adj.builder else 0]
+            if adj.builder:
+                adj.builder.tile_count += 1
+            adj.uses_tiles = True
+
+        if func.is_builtin() and func.key == "mesh_query_point_sign_winding_number":
+            adj.uses_winding_number = True
+
+        if func.is_builtin() and (func.key in grid_index_builtins or (func.key == "tid" and not adj.is_kernel)):
+            adj.uses_grid_index = True
 
         # evaluate the function type based on inputs
         value_type = func.value_func(args, kwds, templates)
 
+        array_aliases = adj.add_array_uses(func, args, value_type)
+
         func_name = compute_type_str(func.native_func, templates)
 
+        # atomic adds to a uniform location of an array are first summed across the warp, leaving one atomic per warp
+        if (
+            func.is_builtin()
+            and func.key == "atomic_add"
+            and type(args[0].type) in (warp.types.array, warp.types.indexedarray)
+            and args[0].type.dtype in (int32, uint32, int64, uint64, float32, float64)
+            and all(adj.is_uniform(a) for a in args[1:-1])
+        ):
+            func_name = "atomic_add_aggregate"
+
+        # likewise for the gradients accumulated by the adjoint of loads at uniform indices, e.g.: shared parameters
+        adj_func_name = func.native_func
+        if (
+            func.is_builtin()
+            and func.key == "load"
+            and type(args[0].type) is warp.types.array
+            and type_scalar_type(args[0].type.dtype) in (float32, float64)
+            and all(adj.is_uniform(a) for a in args[1:])
+        ):
+            adj_func_name = "load_aggregate"
+
         use_initializer_list = func.initializer_list_func(args, templates)
 
+        num_reverse = len(adj.blocks[-1].body_reverse)
+
+        # calls that may write to their arguments invalidate the earlier evaluations that read them
+        if adj.optimize:
+            if func.is_builtin() and func.key in ("copy", "indexset"):
+                adj.cse_mutated.add(args[0])
+            elif not adj.is_pure(func) and not (func.is_builtin() and func.key in readonly_builtins):
+                adj.cse_mutated.update(a for a in args if isinstance(a, Var))
+
         if value_type is None:
             # handles expression (zero output) functions, e.g.: void do_something();
 
@@ -823,9 +1195,13 @@ class Adjoint:
             if not func.missing_grad and len(args):
                 arg_str = adj.format_reverse_call_args(args, [], {}, {}, use_initializer_list)
                 if arg_str is not None:
-                    reverse_call = "{}adj_{}({});".format(func.namespace, func.native_func, arg_str)
+                    reverse_call = "{}adj_{}({});".format(func.namespace, adj_func_name, arg_str)
                     adj.add_reverse(reverse_call)
 
+            # copies to temporaries are removed along with their destination when it is not read
+            if adj.optimize and func.is_builtin() and func.key == "copy" and args[0].label.isdigit():
+                adj.add_pure_call(args[0], num_reverse)
+
             return None
 
         elif not isinstance(value_type, list) or len(value_type) == 1:
@@ -833,7 +1209,39 @@ class Adjoint:
 
             if isinstance(value_type, list):
                 value_type = value_type[0]
+
+            # reuse an earlier evaluation of the same pure call, through a temporary that can be written to
+            pure = adj.optimize and adj.is_pure(func)
+            if pure:
+                cse_key = (func.namespace, func_name, tuple(args))
+                cached = adj.cse_lookup(cse_key)
+                if cached is not None:
+                    output = adj.add_var(value_type)
+                    if array_aliases:
+                        adj.array_roots[output] = array_aliases
+                    adj.add_forward(f"var_{output} = var_{cached};")
+                    adj.add_reverse(f"adj_{cached} += adj_{output};")
+                    adj.add_pure_call(output, num_reverse)
+                    if cached in adj.uniform_vars:
+                        adj.uniform_vars.add(output)
+                    return output
+
             output = adj.add_var(value_type)
+            if array_aliases:
+                adj.array_roots[output] = array_aliases
+
+            if not is_array(value_type) and carries_tangent(value_type) and not tangent_args:
+                adj.tangent_lifted.add(output.label)
+
+            # builtins evaluated on uniform values are uniform too, apart from the ones returning per-thread values
+            if (
+                func.is_builtin()
+                and len(args)
+                and not func.key.startswith(("atomic_", "warp_", "tile_"))
+                and all(adj.is_uniform(a) for a in args)
+            ):
+                adj.uniform_vars.add(output)
+
             forward_call = "var_{} = {}{}({});".format(
                 output, func.namespace, func_name, adj.format_forward_call_args(args, use_initializer_list)
             )
@@ -843,17 +1251,32 @@ class Adjoint:
                     output, func.namespace, func_name, adj.format_forward_call_args(args, use_initializer_list)
                 )
 
+            # the backward pass reloads stored intermediates when the forward launch was given a buffer for them
+            stored = adj.get_intermediates(func, args, output)
+            if stored:
+                offsets = [adj.add_intermediate(v) for v in stored]
+                loads = " ".join(f"wp::load_intermediate(_intermediates, {o}, var_{v});" for o, v in zip(offsets, stored))
+                replay_call = f"if (_intermediates) {{ {loads} }} else {{ {replay_call} }}"
+
             if func.skip_replay:
                 adj.add_forward(forward_call, replay="// " + replay_call)
             else:
                 adj.add_forward(forward_call, replay=replay_call)
 
+            if stored:
+                for o, v in zip(offsets, stored):
+                    adj.add_forward(f"wp::store_intermediate(_intermediates, {o}, var_{v});", skip_replay=True)
+
             if not func.missing_grad and len(args):
                 arg_str = adj.format_reverse_call_args(args, [output], {}, {}, use_initializer_list)
                 if arg_str is not None:
-                    reverse_call = "{}adj_{}({});".format(func.namespace, func.native_func, arg_str)
+                    reverse_call = "{}adj_{}({});".format(func.namespace, adj_func_name, arg_str)
                     adj.add_reverse(reverse_call)
 
+            if pure:
+                adj.cse_scopes[-1][0][cse_key] = output
+                adj.add_pure_call(output, num_reverse)
+
             return output
 
         else:
@@ -870,7 +1293,7 @@ class Adjoint:
                     args, output, {}, {}, use_initializer_list, has_output_args=func.custom_grad_func is None
                 )
                 if arg_str is not None:
-                    reverse_call = "{}adj_{}({});".format(func.namespace, func.native_func, arg_str)
+                    reverse_call = "{}adj_{}({});".format(func.namespace, adj_func_name, arg_str)
                     adj.add_reverse(reverse_call)
 
             if len(output) == 1:
@@ -879,6 +1302,9 @@ class Adjoint:
             return output
 
     def add_return(adj, var):
+        if adj.is_kernel:
+            adj.lane_safe = False
+
         if var is None or len(var) == 0:
             adj.add_forward("return;", "goto label{};".format(adj.label_count))
         elif len(var) == 1:
@@ -900,8 +1326,10 @@ class Adjoint:
         adj.add_reverse("}")
 
         adj.indent()
+        adj.begin_scope()
 
     def end_if(adj, cond):
+        adj.end_scope()
         adj.dedent()
 
         adj.add_forward("}")
@@ -912,8 +1340,10 @@ class Adjoint:
         adj.add_reverse("}")
 
         adj.indent()
+        adj.begin_scope()
 
     def end_else(adj, cond):
+        adj.end_scope()
         adj.dedent()
 
         adj.add_forward("}")
@@ -921,6 +1351,8 @@ class Adjoint:
 
     # define a for-loop
     def begin_for(adj, iter):
+        adj.lane_safe = False
+        adj.begin_scope(loop=True)
         cond_block = adj.begin_block()
         adj.loop_blocks.append(cond_block)
         adj.add_forward(f"for_start_{cond_block.label}:;")
@@ -940,6 +1372,7 @@ class Adjoint:
         body_block = adj.end_block()
         cond_block = adj.end_block()
         adj.loop_blocks.pop()
+        adj.end_scope()
 
         ####################
         # forward pass
@@ -990,7 +1423,10 @@ class Adjoint:
     def begin_while(adj, cond):
         # evaulate condition in its own block
         # so we can control replay
+        adj.lane_safe = False
+        adj.begin_scope(loop=True)
         cond_block = adj.begin_block()
+        cond_block.loop_kind = "while"
         adj.loop_blocks.append(cond_block)
         cond_block.body_forward.append(f"while_start_{cond_block.label}:;")
 
@@ -1007,6 +1443,7 @@ class Adjoint:
         body_block = adj.end_block()
         cond_block = adj.end_block()
         adj.loop_blocks.pop()
+        adj.end_scope()
 
         ####################
         # forward pass
@@ -1174,7 +1611,13 @@ class Adjoint:
             attr_name = val.label + "." + node.attr
             attr_type = val.type.vars[node.attr].type
 
-            return Var(attr_name, attr_type)
+            attr = Var(attr_name, attr_type)
+            if adj.is_uniform(val):
+                adj.uniform_vars.add(attr)
+            if not isinstance(val.type, Struct) and carries_tangent(attr_type):
+                adj.tangent_primal.add(attr_name)
+
+            return attr
 
         except KeyError:
             raise RuntimeError(f"Error, `{node.attr}` is not an attribute of '{val.label}' ({val.type})")
@@ -1271,10 +1714,20 @@ class Adjoint:
 
         adj.end_while()
 
+    def get_specialized_value(adj, a):
+        # value of a specialized kernel argument unless its symbol has been reassigned
+        if isinstance(a, ast.Name) and a.id in adj.specialized_vars:
+            if adj.symbols.get(a.id) is adj.specialized_vars[a.id]:
+                return adj.specialized_args[a.id]
+        return None
+
     def is_num(adj, a):
         # simple constant
         if isinstance(a, ast.Num):
             return True
+        # integer kernel argument specialized on its value
+        elif warp.types.is_int(adj.get_specialized_value(a)):
+            return True
         # expression of form -constant
         elif isinstance(a, ast.UnaryOp) and isinstance(a.op, ast.USub) and isinstance(a.operand, ast.Num):
             return True
@@ -1290,6 +1743,8 @@ class Adjoint:
     def eval_num(adj, a):
         if isinstance(a, ast.Num):
             return a.n
+        elif warp.types.is_int(adj.get_specialized_value(a)):
+            return adj.get_specialized_value(a)
         elif isinstance(a, ast.UnaryOp) and isinstance(a.op, ast.USub) and isinstance(a.operand, ast.Num):
             return -a.operand.n
         else:
@@ -1405,12 +1860,14 @@ class Adjoint:
     def emit_Break(adj, node):
         adj.materialize_redefinitions(adj.loop_symbols[-1])
 
-        adj.add_forward(f"goto for_end_{adj.loop_blocks[-1].label};")
+        block = adj.loop_blocks[-1]
+        adj.add_forward(f"goto {block.loop_kind}_end_{block.label};")
 
     def emit_Continue(adj, node):
         adj.materialize_redefinitions(adj.loop_symbols[-1])
 
-        adj.add_forward(f"goto for_start_{adj.loop_blocks[-1].label};")
+        block = adj.loop_blocks[-1]
+        adj.add_forward(f"goto {block.loop_kind}_start_{block.label};")
 
     def emit_Expr(adj, node):
         return adj.eval(node.value)
@@ -1943,7 +2400,7 @@ extern "C" __global__ void {name}_cuda_kernel_forward(
     {forward_args})
 {{
     size_t _idx = grid_index();
-    if (_idx >= dim.size)
+    if (_idx >= launch_size(dim))
         return;
 
     set_launch_bounds(dim);
@@ -1954,7 +2411,7 @@ extern "C" __global__ void {name}_cuda_kernel_backward(
     {reverse_args})
 {{
     size_t _idx = grid_index();
-    if (_idx >= dim.size)
+    if (_idx >= launch_size(dim))
         return;
 
     set_launch_bounds(dim);
@@ -1963,6 +2420,82 @@ extern "C" __global__ void {name}_cuda_kernel_backward(
 
 """
 
+cuda_kernel_tangent_template = """
+
+extern "C" __global__ void {name}_cuda_kernel_jvp(
+    {forward_args})
+{{
+    size_t _idx = grid_index();
+    if (_idx >= launch_size(dim))
+        return;
+
+    set_launch_bounds(dim);
+
+{forward_body}}}
+
+"""
+
+cuda_persistent_task_template = """
+
+static __device__ void {name}_cuda_task_forward(
+    size_t _idx,
+    {forward_args})
+{{
+{forward_body}}}
+
+// runs one thread of a launch of {name} from the packed launch parameters
+static __device__ void {name}_cuda_task(const char* _params, size_t _idx)
+{{
+    size_t _offset = 0;
+{unpack_params}
+    {name}_cuda_task_forward(
+        {forward_params});
+}}
+
+"""
+
+cuda_persistent_kernel_template = """
+
+// runs the launches of a command list back to back, see CommandList(persistent=True) in context.py,
+// they are distributed over the threads of the grid and separated by grid-wide barriers
+extern "C" __global__ void wp_cuda_persistent_kernel(
+    const persistent_task_t* _tasks,
+    int _num_tasks,
+    unsigned int* _barrier)
+{{
+    for (int _t = 0; _t < _num_tasks; ++_t)
+    {{
+        const persistent_task_t _task = _tasks[_t];
+        const char* _params = reinterpret_cast<const char*>(_task.params);
+
+#if WP_CHECKED
+        // out-of-bounds accesses are recorded in the buffer of the launch bounds of the task
+        set_launch_bounds(*reinterpret_cast<const launch_bounds_t*>(_params));
+#endif
+
+        const size_t _n = launch_size(*reinterpret_cast<const launch_bounds_t*>(_params));
+        const size_t _stride = size_t(blockDim.x)*size_t(gridDim.x);
+
+        for (size_t _base = size_t(blockIdx.x)*size_t(blockDim.x); _base < _n; _base += _stride)
+        {{
+            const size_t _idx = _base + threadIdx.x;
+            if (_idx >= _n)
+                continue;
+
+            switch (_task.kernel)
+            {{
+{cases}            default:
+                break;
+            }}
+        }}
+
+        // later launches may read what this one wrote
+        persistent_grid_sync(_barrier, _t + 1);
+    }}
+}}
+
+"""
+
 cpu_kernel_template = """
 
 void {name}_cpu_kernel_forward(
@@ -1977,6 +2510,44 @@ void {name}_cpu_kernel_backward(
 
 """
 
+cpu_kernel_lanes_template = """
+
+void {name}_cpu_kernel_forward_lanes(
+    size_t _begin,
+    size_t _end,
+    {forward_args})
+{{
+    #pragma clang loop vectorize(enable) vectorize_width({width})
+    for (size_t _idx = _begin; _idx < _end; ++_idx)
+    {{
+{forward_body}    }}
+}}
+
+"""
+
+cpu_kernel_tangent_template = """
+
+void {name}_cpu_kernel_jvp(
+    {forward_args})
+{{
+{forward_body}}}
+
+"""
+
+cpu_module_forward_template = """cpu_launch(launch_size(dim), [&]()
+    {{
+        {name}_cpu_kernel_forward(
+            {forward_params});
+    }});"""
+
+cpu_module_lanes_forward_template = """cpu_launch_lanes(launch_size(dim), [&](size_t _begin, size_t _end)
+    {{
+        {name}_cpu_kernel_forward_lanes(
+            _begin,
+            _end,
+            {forward_params});
+    }});"""
+
 cpu_module_template = """
 
 extern "C" {{
@@ -1987,13 +2558,7 @@ WP_API void {name}_cpu_forward(
 {{
     set_launch_bounds(dim);
 
-    for (size_t i=0; i < dim.size; ++i)
-    {{
-        s_threadIdx = i;
-
-        {name}_cpu_kernel_forward(
-            {forward_params});
-    }}
+    {forward_launch}
 }}
 
 WP_API void {name}_cpu_backward(
@@ -2001,13 +2566,32 @@ WP_API void {name}_cpu_backward(
 {{
     set_launch_bounds(dim);
 
-    for (size_t i=0; i < dim.size; ++i)
+    cpu_launch(launch_size(dim), [&]()
     {{
-        s_threadIdx = i;
-
         {name}_cpu_kernel_backward(
             {reverse_params});
-    }}
+    }});
+}}
+
+}} // extern C
+
+"""
+
+cpu_module_tangent_template = """
+
+extern "C" {{
+
+// Python CPU entry point of the forward-mode derivatives, see jvp() in context.py
+WP_API void {name}_cpu_jvp(
+    {forward_args})
+{{
+    set_launch_bounds(dim);
+
+    cpu_launch(launch_size(dim), [&]()
+    {{
+        {name}_cpu_kernel_jvp(
+            {forward_params});
+    }});
 }}
 
 }} // extern C
@@ -2345,10 +2929,22 @@ def codegen_kernel(kernel, device, options):
     forward_args = ["launch_bounds_t dim"]
     reverse_args = ["launch_bounds_t dim"]
 
+    # large structs are passed to CUDA kernels by pointer and copied into the thread's variables, which the
+    # compiler reduces to loads of the members the kernel uses
+    buffer_args = adj.param_buffer_args if device == "cuda" else []
+    forward_copies = ""
+    reverse_copies = ""
+
     # forward args
     for arg in adj.args:
-        forward_args.append(arg.ctype() + " var_" + arg.label)
-        reverse_args.append(arg.ctype() + " var_" + arg.label)
+        if arg.label in buffer_args:
+            forward_args.append(f"const {arg.ctype()}* _buffer_var_{arg.label}")
+            reverse_args.append(f"const {arg.ctype()}* _buffer_var_{arg.label}")
+            forward_copies += f"    {arg.ctype()} var_{arg.label} = *_buffer_var_{arg.label};\n"
+            reverse_copies += f"    {arg.ctype()} var_{arg.label} = *_buffer_var_{arg.label};\n"
+        else:
+            forward_args.append(arg.ctype() + " var_" + arg.label)
+            reverse_args.append(arg.ctype() + " var_" + arg.label)
 
     # reverse args
     for arg in adj.args:
@@ -2356,9 +2952,17 @@ def codegen_kernel(kernel, device, options):
         if isinstance(arg.type, indexedarray):
             _arg = Var(arg.label, array(dtype=arg.type.dtype, ndim=arg.type.ndim))
             reverse_args.append(_arg.ctype() + " adj_" + arg.label)
+        elif arg.label in buffer_args:
+            reverse_args.append(f"const {arg.ctype()}* _buffer_adj_{arg.label}")
+            reverse_copies += f"    {arg.ctype()} adj_{arg.label} = *_buffer_adj_{arg.label};\n"
         else:
             reverse_args.append(arg.ctype() + " adj_" + arg.label)
 
+    # buffer of the intermediates stored by the forward pass, or 0
+    if adj.store_intermediates:
+        forward_args.append("uint64 _intermediates")
+        reverse_args.append("uint64 _intermediates")
+
     # codegen body
     forward_body = codegen_func_forward(adj, func_type="kernel", device=device)
 
@@ -2378,14 +2982,209 @@ def codegen_kernel(kernel, device, options):
         name=kernel.get_mangled_name(),
         forward_args=indent(forward_args),
         reverse_args=indent(reverse_args),
-        forward_body=forward_body,
-        reverse_body=reverse_body,
+        forward_body=forward_copies + forward_body,
+        reverse_body=reverse_copies + reverse_body,
     )
 
+    # vectorized forward pass running consecutive threads in the SIMD lanes of the CPU, the thread index
+    # is the loop counter rather than the thread-local index set by cpu_launch()
+    width = cpu_simd_width(kernel, options) if device == "cpu" else 0
+    if width:
+        lanes_body = forward_body.replace("wp::tid()", "wp::lane_tid(_idx, dim)")
+        lanes_body = lanes_body.replace("wp::tid(", "wp::lane_tid(_idx, dim, ")
+        s += cpu_kernel_lanes_template.format(
+            name=kernel.get_mangled_name(),
+            forward_args=indent(forward_args),
+            forward_body="".join("    " + line for line in lanes_body.splitlines(keepends=True)),
+            width=width,
+        )
+
     return s
 
 
-def codegen_module(kernel, device="cpu"):
+def tangent_width(kernel, options):
+    # number of tangent directions propagated by the forward-mode entry point of a kernel, or 0 if it has none
+    width = kernel.options.get("forward_mode_width", options.get("forward_mode_width", 0))
+    if not width or kernel.adj.tangent_error:
+        return 0
+    return width
+
+
+def codegen_tangent(source, width, lifted=()):
+    # evaluates the code on dual numbers carrying `width` tangents of each float32 value, see dual.h, the templated
+    # builtins propagate the tangents through vectors, matrices and arrays of float32, warp-aggregated atomics are
+    # replaced by the per-thread ones that sum the tangents too
+    source = source.replace("atomic_add_aggregate(", "atomic_add(")
+    source = re.sub(r"\bfloat32\b", f"dual_t<{width}>", source)
+
+    # the results of calls that don't take any tangents, e.g.: of functions of integers, get zero tangents
+    def lift(m):
+        if m.group(2) not in lifted:
+            return m.group(0)
+        return f"{m.group(1)}var_{m.group(2)} = wp::dual_lift<{width}>({m.group(3)});"
+
+    return re.sub(r"^([ \t]*)var_(\w+) = (.*);$", lift, source, flags=re.M) if lifted else source
+
+
+def codegen_func_tangent(adj, c_func_name: str, device="cpu", width=1):
+    # overload of a function on dual numbers called by forward-mode code, none for functions that can't be evaluated
+    # on dual numbers or don't take float32 values, whose regular overload is called instead
+    if adj.tangent_error or adj.skip_forward_codegen:
+        return ""
+
+    if adj.return_var is not None and len(adj.return_var) == 1:
+        return_type = adj.return_var[0].ctype()
+    else:
+        return_type = "void"
+
+    forward_args = [f"{arg.ctype()} {arg.emit()}" for arg in adj.args]
+    if adj.return_var is not None and len(adj.return_var) != 1:
+        forward_args += [f"{arg.ctype()} & ret_{i}" for i, arg in enumerate(adj.return_var)]
+
+    if [codegen_tangent(a, width) for a in forward_args] == forward_args:
+        return ""
+
+    if device == "cpu":
+        forward_template = cpu_forward_function_template
+    elif device == "cuda":
+        forward_template = cuda_forward_function_template
+    else:
+        raise ValueError("Device {} is not supported".format(device))
+
+    s = forward_template.format(
+        name=c_func_name,
+        return_type=return_type,
+        forward_args=indent(forward_args),
+        forward_body=codegen_func_forward(adj, func_type="function", device=device),
+        filename=adj.filename,
+        lineno=adj.fun_lineno,
+    )
+
+    return codegen_tangent(s, width, adj.tangent_lifted)
+
+
+def codegen_kernel_tangent(kernel, device, options):
+    # forward-mode entry point evaluating the forward pass of the kernel on dual numbers, see jvp() in context.py
+    width = tangent_width(kernel, options)
+    if not width:
+        return ""
+
+    adj = kernel.adj
+
+    forward_args = ["launch_bounds_t dim"]
+    for arg in adj.args:
+        forward_args.append(arg.ctype() + " var_" + arg.label)
+
+    if device == "cpu":
+        template = cpu_kernel_tangent_template
+    elif device == "cuda":
+        template = cuda_kernel_tangent_template
+    else:
+        raise ValueError("Device {} is not supported".format(device))
+
+    s = template.format(
+        name=kernel.get_mangled_name(),
+        forward_args=indent(forward_args),
+        forward_body=codegen_func_forward(adj, func_type="kernel", device=device),
+    )
+
+    return codegen_tangent(s, width, adj.tangent_lifted)
+
+
+def kernel_param_size(t):
+    # bytes taken by a kernel argument of type t in the parameters of a launch, values are padded to 8 bytes
+    if isinstance(t, Struct):
+        size = ctypes.sizeof(t.ctype)
+    elif isinstance(t, indexedarray):
+        size = ctypes.sizeof(indexedarray_t)
+    elif is_array(t):
+        size = ctypes.sizeof(array_t)
+    else:
+        size = type_size_in_bytes(t)
+    return (size + 7) & ~7
+
+
+def select_param_buffer_args(adj, enable_backward, max_param_size):
+    # names of the struct arguments that CUDA kernels read from a copy in device memory instead of their parameters,
+    # the largest ones first until the parameters of the backward kernel fit in max_param_size bytes
+    copies = 2 if enable_backward else 1
+    sizes = {a.label: kernel_param_size(a.type) for a in adj.args}
+    total = ctypes.sizeof(launch_bounds_t) + copies * sum(sizes.values()) + 8
+
+    selected = []
+    for a in sorted((a for a in adj.args if isinstance(a.type, Struct)), key=lambda a: -sizes[a.label]):
+        if total <= max_param_size:
+            break
+        selected.append(a.label)
+        total -= copies * (sizes[a.label] - 8)
+    return selected
+
+
+def is_persistent_task(kernel):
+    # kernels that can run as tasks of a persistent kernel, whose threads must not cooperate across a block,
+    # and which only read their thread index through tid() since the tasks don't run at their position in the grid
+    return not kernel.adj.uses_tiles and not kernel.adj.store_intermediates and not kernel.adj.uses_grid_index
+
+
+def codegen_persistent_task(kernel):
+    adj = kernel.adj
+
+    forward_args = ["launch_bounds_t dim"]
+    forward_params = ["_idx", "dim"]
+    unpack_params = ["    const launch_bounds_t dim = persistent_param<launch_bounds_t>(_params, _offset);\n"]
+
+    for arg in adj.args:
+        forward_args.append(f"{arg.ctype()} var_{arg.label}")
+        if arg.label in adj.param_buffer_args:
+            forward_params.append(f"*_buffer_var_{arg.label}")
+            pointer = f"const {arg.ctype()}*"
+            unpack_params.append(
+                f"    {pointer} _buffer_var_{arg.label} = persistent_param<{pointer}>(_params, _offset);\n"
+            )
+        else:
+            forward_params.append(f"var_{arg.label}")
+            unpack_params.append(
+                f"    const {arg.ctype()} var_{arg.label} = persistent_param<{arg.ctype()}>(_params, _offset);\n"
+            )
+
+    # the threads of the task are indexed by the persistent kernel rather than by their position in the grid
+    forward_body = codegen_func_forward(adj, func_type="kernel", device="cuda")
+    forward_body = forward_body.replace("wp::tid()", "wp::lane_tid(_idx, dim)")
+    forward_body = forward_body.replace("wp::tid(", "wp::lane_tid(_idx, dim, ")
+
+    return cuda_persistent_task_template.format(
+        name=kernel.get_mangled_name(),
+        forward_args=indent(forward_args),
+        forward_body=forward_body,
+        unpack_params="".join(unpack_params),
+        forward_params=indent(forward_params, 2),
+    )
+
+
+def codegen_persistent_kernel(kernels):
+    # kernels are identified by their index in the list, which includes the ones that can't run as tasks
+    cases = ""
+    for i, kernel in enumerate(kernels):
+        if is_persistent_task(kernel):
+            cases += f"            case {i}:\n"
+            cases += f"                {kernel.get_mangled_name()}_cuda_task(_params, _idx);\n"
+            cases += "                break;\n"
+
+    return cuda_persistent_kernel_template.format(cases=cases)
+
+
+def cpu_simd_width(kernel, options):
+    # number of threads processed together by the CPU forward pass of a kernel, or 0 to run them one at a time
+    width = kernel.options.get("cpu_simd_width", options.get("cpu_simd_width", 0))
+    if not width or not kernel.adj.lane_safe or kernel.adj.store_intermediates:
+        return 0
+    # lanes don't set the thread index that checked builds record with out-of-bounds accesses
+    if options.get("mode") == "checked":
+        return 0
+    return width
+
+
+def codegen_module(kernel, device="cpu", options=None):
     if device != "cpu":
         return ""
 
@@ -2422,11 +3221,47 @@ def codegen_module(kernel, device="cpu"):
             reverse_args.append(f"{arg.ctype()} adj_{arg.label}")
             reverse_params.append(f"adj_{arg.label}")
 
+    if adj.store_intermediates:
+        for signature, params in ((forward_args, forward_params), (reverse_args, reverse_params)):
+            signature.append("uint64 _intermediates")
+            params.append("_intermediates")
+
+    if cpu_simd_width(kernel, options or {}):
+        forward_launch = cpu_module_lanes_forward_template
+    else:
+        forward_launch = cpu_module_forward_template
+
     s = cpu_module_template.format(
         name=kernel.get_mangled_name(),
         forward_args=indent(forward_args),
         reverse_args=indent(reverse_args),
-        forward_params=indent(forward_params, 3),
+        forward_launch=forward_launch.format(
+            name=kernel.get_mangled_name(), forward_params=indent(forward_params, 3)
+        ),
         reverse_params=indent(reverse_params, 3),
     )
+
+    # the forward-mode entry point also takes dual float32 scalars by pointer, since they are structs
+    width = tangent_width(kernel, options or {})
+    if width:
+        tangent_args = ["launch_bounds_t dim"]
+        tangent_params = ["dim"]
+
+        for arg in adj.args:
+            if hasattr(arg.type, "_wp_generic_type_str_") or arg.type is float32:
+                tangent_args.append(f"const {arg.ctype()}* var_{arg.label}")
+                tangent_params.append(f"*var_{arg.label}")
+            else:
+                tangent_args.append(f"{arg.ctype()} var_{arg.label}")
+                tangent_params.append("var_" + arg.label)
+
+        s += codegen_tangent(
+            cpu_module_tangent_template.format(
+                name=kernel.get_mangled_name(),
+                forward_args=indent(tangent_args),
+                forward_params=indent(tangent_params, 3),
+            ),
+            width,
+        )
+
     return s
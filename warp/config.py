@@ -15,7 +15,7 @@ verify_fp = False  # verify inputs and outputs are finite after each launch
 verify_cuda = False  # if true will check CUDA errors after each kernel launch / memory operation
 print_launches = False  # if true will print out launch information
 
-mode = "release"
+mode = "release"  # "release", "debug", or "checked" for release builds that report out-of-bounds array accesses
 verbose = False  # print extra informative messages
 quiet = False  # suppress all output except errors and warnings
 
@@ -23,13 +23,42 @@ host_compiler = None  # user can specify host compiler here, otherwise will atte
 
 cache_kernels = True
 kernel_cache_dir = None  # path to kernel cache directory, if None a default path will be used
+kernel_cache_max_size = 0  # size limit of the kernel cache in bytes, the least recently used files are evicted after builds that exceed it, 0 for no limit
+kernel_cache_shared_dir = None  # read-only kernel cache, e.g.: on a shared file system, whose binaries are copied into the local cache instead of compiling modules missing from it
 
 cuda_output = (
     None  # preferred CUDA output format for kernels ("ptx" or "cubin"), determined automatically if unspecified
 )
 
+cuda_fatbin_archs = None  # list of architectures (e.g. [80, 86, 90]) to bundle into one cached fatbin per module, with PTX as a fallback for others (requires CUDA 12.4+)
+
+cuda_lto = False  # compile CUDA modules to LTO-IR and link them into CUBINs with nvJitLink link-time optimization (requires CUDA 12.4+), overridden by the "lto" module option
+
 ptx_target_arch = 70  # target architecture for PTX generation, defaults to the lowest architecture that supports all of Warp's features
 
 enable_backward = True  # whether to compiler the backward passes of the kernels
+lazy_grad = False  # allocate the gradients of arrays created with requires_grad=True when first used, e.g.: by a backward launch of a Tape, rather than up front
+
+deterministic = False  # make warp.sim contact generation and force accumulation bitwise reproducible with fixed-order reductions instead of float atomics, at extra cost
+
+optimize_codegen = True  # share repeated evaluations of pure builtins and remove unused ones from the generated code
+
+block_dim = 256  # default number of CUDA threads per block for kernel launches, or "auto" to maximize occupancy
+
+max_kernel_param_size = 4096  # bytes of parameters passed to CUDA kernels, larger struct arguments are read from device memory, 0 passes all structs through device memory
+
+enable_cpu_parallel = False  # run CPU kernel launches on a thread pool, makes CPU atomics thread-safe
+cpu_max_threads = 0  # number of threads used by parallel CPU launches and host BVH builds, 0 uses all hardware threads (set before wp.init())
+
+cuda_visible_devices = None  # ordinals of the CUDA devices Warp registers, e.g.: [local_rank], if None the WARP_CUDA_DEVICES environment variable or all devices (set before wp.init())
+
+enable_mempool = False  # allocate arrays from stream-ordered memory pools on CUDA devices that support them (set before wp.init())
+
+max_compile_threads = 0  # number of threads used by wp.force_load() to compile CUDA modules concurrently, 0 uses the CPU count, 1 compiles serially
+enable_nvrtc_pch = True  # let NVRTC cache a precompiled builtin.h in the kernel cache (requires CUDA 12.8+)
+enable_cpu_pch = True  # compile builtin.h once into a precompiled header in the kernel cache for CPU modules
+cpu_native_isa = True  # compile CPU modules for the instruction set of the host CPU (e.g.: AVX2, AVX-512, NEON) rather than a generic one
+
+autotune = False  # let native primitives benchmark their variants on problem sizes missing from the tuning database, see warp.autotune()
 
 llvm_cuda = False  # use Clang/LLVM instead of NVRTC to compile CUDA
@@ -6,12 +6,15 @@
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
 import ast
+import builtins
+import concurrent.futures
 import ctypes
 import hashlib
 import inspect
 import os
 import platform
 import sys
+import threading
 import types
 from copy import copy as shallowcopy
 from types import ModuleType
@@ -169,6 +172,11 @@ class Function:
         # within the CPython interpreter rather than
         # from within a kernel (experimental).
 
+        # elementwise builtins called on arrays build lazy expressions evaluated by fused kernels
+        if self.is_builtin() and self.key in warp.expression.elementwise_builtins | warp.expression.reducing_builtins:
+            if any(warp.types.is_array(a) or isinstance(a, warp.expression.ArrayExpression) for a in args):
+                return warp.expression.ArrayExpression.call(self.key, args)
+
         if self.is_builtin() and self.mangled_name:
             # store last error during overload resolution
             error = None
@@ -432,14 +440,21 @@ class Function:
 
 
 class KernelHooks:
-    def __init__(self, forward, backward):
+    def __init__(self, forward, backward, forward_block_dim=0, backward_block_dim=0):
         self.forward = forward
         self.backward = backward
 
+        # CUDA launch block sizes, 0 selects the default
+        self.forward_block_dim = forward_block_dim
+        self.backward_block_dim = backward_block_dim
+
+        # forward-mode entry point of kernels compiled with forward_mode_width, see jvp()
+        self.jvp = None
+
 
 # caches source and compiled entry points for a kernel (will be populated after module loads)
 class Kernel:
-    def __init__(self, func, key, module, options=None, code_transformers=[]):
+    def __init__(self, func, key, module, options=None, code_transformers=[], specialize=None):
         self.func = func
         self.module = module
         self.key = key
@@ -447,6 +462,17 @@ class Kernel:
 
         self.adj = warp.codegen.Adjoint(func, transformers=code_transformers)
 
+        # names of the scalar arguments whose values the kernel is compiled for, and the specializations by value
+        self.specialize = list(specialize or [])
+        self.specializations = {}
+
+        for name in self.specialize:
+            arg_type = self.adj.arg_types.get(name)
+            if arg_type is None:
+                raise ValueError(f"Kernel {key} has no argument '{name}' to specialize on")
+            if arg_type not in (int, float, builtins.bool) and arg_type not in warp.types.scalar_types:
+                raise TypeError(f"Kernel {key} can only specialize on scalar arguments, '{name}' is of type {arg_type}")
+
         # check if generic
         self.is_generic = False
         for arg_type in self.adj.arg_types.values():
@@ -509,6 +535,7 @@ class Kernel:
         ovl.adj = warp.codegen.Adjoint(self.func, overload_annotations)
         ovl.is_generic = False
         ovl.overloads = {}
+        ovl.specializations = {}
         ovl.sig = sig
 
         self.overloads[sig] = ovl
@@ -526,6 +553,51 @@ class Kernel:
         else:
             return self.add_overload(arg_types)
 
+    def get_instances(self):
+        # the kernels compiled into the module, i.e.: the overloads of generic kernels, and the specializations
+        # of the kernels specialized on argument values in place of the kernels themselves
+        for k in self.overloads.values() if self.is_generic else [self]:
+            if k.specialize:
+                yield from k.specializations.values()
+            else:
+                yield k
+
+    def get_specialization(self, args):
+        # values of the specialized arguments as Python numbers, e.g.: from warp.int32 instances
+        values = []
+        for name in self.specialize:
+            arg_type = self.adj.arg_types[name]
+            value = args[self.arg_indices[name]]
+            value = getattr(value, "value", value)
+            if arg_type is builtins.bool or arg_type is warp.types.bool:
+                values.append(builtins.bool(value))
+            elif warp.types.type_is_int(arg_type):
+                values.append(int(value))
+            else:
+                values.append(float(value))
+
+        key = tuple(values)
+
+        spec = self.specializations.get(key)
+        if spec is not None:
+            return spec
+
+        # instantiate this kernel with the values baked in, under a name derived from them
+        digest = hashlib.sha256(bytes(repr(key), "utf-8")).hexdigest()[:8]
+
+        spec = shallowcopy(self)
+        spec.adj = warp.codegen.Adjoint(self.func, self.adj.arg_types)
+        spec.adj.specialized_args = dict(zip(self.specialize, values))
+        spec.specialize = []
+        spec.specializations = {}
+        spec.sig = f"{self.sig}_{digest}" if self.sig else digest
+
+        self.specializations[key] = spec
+
+        self.module.unload()
+
+        return spec
+
     def get_mangled_name(self):
         if self.sig:
             return f"{self.key}_{self.sig}"
@@ -694,19 +766,45 @@ def func_replay(forward_fn):
 
 # decorator to register kernel, @kernel, custom_name may be a string
 # that creates a kernel with a different name from the actual function
-def kernel(f=None, *, enable_backward=None):
+def kernel(
+    f=None,
+    *,
+    enable_backward=None,
+    block_dim=None,
+    store_intermediates=None,
+    specialize=None,
+    cpu_simd_width=None,
+    fast_math=None,
+    forward_mode_width=None,
+):
     def wrapper(f, *args, **kwargs):
         options = {}
 
         if enable_backward is not None:
             options["enable_backward"] = enable_backward
 
+        if block_dim is not None:
+            options["block_dim"] = block_dim
+
+        if store_intermediates is not None:
+            options["store_intermediates"] = store_intermediates
+
+        if cpu_simd_width is not None:
+            options["cpu_simd_width"] = cpu_simd_width
+
+        if fast_math is not None:
+            options["fast_math"] = fast_math
+
+        if forward_mode_width is not None:
+            options["forward_mode_width"] = forward_mode_width
+
         m = get_module(f.__module__)
         k = Kernel(
             func=f,
             key=warp.codegen.make_full_qualified_name(f),
             module=m,
             options=options,
+            specialize=specialize,
         )
         return k
 
@@ -1035,6 +1133,12 @@ class ModuleBuilder:
         self.options = options
         self.module = module
 
+        # number of wp.tile_load() call sites, each one owns a shared memory tile
+        self.tile_count = 0
+
+        # functions passed as arguments to builtins, e.g.: mlp() activations, which can't be overloaded on dual numbers
+        self.function_values = set()
+
         # build all functions declared in the module
         for func in module.functions.values():
             for f in func.user_overloads.values():
@@ -1044,11 +1148,8 @@ class ModuleBuilder:
 
         # build all kernel entry points
         for kernel in module.kernels.values():
-            if not kernel.is_generic:
-                self.build_kernel(kernel)
-            else:
-                for k in kernel.overloads.values():
-                    self.build_kernel(k)
+            for k in kernel.get_instances():
+                self.build_kernel(k)
 
     def build_struct_recursive(self, struct: warp.codegen.Struct):
         structs = []
@@ -1074,7 +1175,15 @@ class ModuleBuilder:
         self.structs[struct] = None
 
     def build_kernel(self, kernel):
-        kernel.adj.build(self)
+        store_intermediates = kernel.options.get("store_intermediates", self.options.get("store_intermediates", False))
+        fast_math = kernel.options.get("fast_math", self.options.get("fast_math", False))
+        kernel.adj.build(self, is_kernel=True, store_intermediates=store_intermediates, fast_math=fast_math)
+
+        enable_backward = kernel.options.get("enable_backward", self.options.get("enable_backward", True))
+        max_param_size = kernel.options.get("max_param_size", self.options.get("max_param_size", 4096))
+        kernel.adj.param_buffer_args = warp.codegen.select_param_buffer_args(
+            kernel.adj, enable_backward, max_param_size
+        )
 
         if kernel.adj.return_var is not None:
             if kernel.adj.return_var.ctype() != "void":
@@ -1118,22 +1227,53 @@ class ModuleBuilder:
                 func.adj, c_func_name=func.native_func, device=device, options=self.options
             )
 
+        # overloads of the functions on the dual numbers of the forward-mode entry points, for each number of tangents
+        widths = set()
+        for kernel in self.module.kernels.values():
+            for k in kernel.get_instances():
+                widths.add(warp.codegen.tangent_width(k, self.options))
+        for width in sorted(widths - {0}):
+            for func in self.functions.keys():
+                if func in self.function_values:
+                    continue
+                source += warp.codegen.codegen_func_tangent(
+                    func.adj, c_func_name=func.native_func, device=device, width=width
+                )
+
         for kernel in self.module.kernels.values():
             # each kernel gets an entry point in the module
-            if not kernel.is_generic:
-                source += warp.codegen.codegen_kernel(kernel, device=device, options=self.options)
-                source += warp.codegen.codegen_module(kernel, device=device)
-            else:
-                for k in kernel.overloads.values():
-                    source += warp.codegen.codegen_kernel(k, device=device, options=self.options)
-                    source += warp.codegen.codegen_module(k, device=device)
+            for k in kernel.get_instances():
+                source += warp.codegen.codegen_kernel(k, device=device, options=self.options)
+                source += warp.codegen.codegen_kernel_tangent(k, device=device, options=self.options)
+                source += warp.codegen.codegen_module(k, device=device, options=self.options)
+
+        # the kernels may also be run as the tasks of a single persistent kernel, see CommandList
+        if device == "cuda" and self.options.get("persistent"):
+            kernels = self.module.get_persistent_kernels()
+            for k in kernels:
+                if warp.codegen.is_persistent_task(k):
+                    source += warp.codegen.codegen_persistent_task(k)
+            source += warp.codegen.codegen_persistent_kernel(kernels)
 
         # add headers
         if device == "cpu":
             source = warp.codegen.cpu_module_header + source
+
+            if self.options.get("enable_cpu_parallel"):
+                source = "#define WP_ENABLE_CPU_PARALLEL 1\n" + source
         else:
             source = warp.codegen.cuda_module_header + source
 
+        # BVH traversal settings, see bvh.h
+        if self.options.get("bvh_stack_size"):
+            source = f"#define BVH_QUERY_STACK_SIZE ({int(self.options['bvh_stack_size'])})\n" + source
+        if self.options.get("bvh_stackless"):
+            source = "#define BVH_QUERY_STACKLESS 1\n" + source
+
+        # out-of-bounds array accesses are recorded instead of asserted, see BoundsChecker
+        if self.options.get("mode") == "checked":
+            source = "#define WP_CHECKED 1\n" + source
+
         return source
 
 
@@ -1159,18 +1299,33 @@ class Module:
         self.cpu_build_failed = False
         self.cuda_build_failed = False
 
+        # future of a pending background load started by force_load_async()
+        self.pending_load = None
+
         self.options = {
             "max_unroll": 16,
             "enable_backward": warp.config.enable_backward,
+            "enable_cpu_parallel": warp.config.enable_cpu_parallel,
+            "bvh_stack_size": None,  # traversal stack depth of BVH and mesh queries, or None for the default of 64
+            "bvh_stackless": False,
+            "block_dim": warp.config.block_dim,  # CUDA threads per block, or "auto" to maximize occupancy
+            "max_param_size": warp.config.max_kernel_param_size,  # larger struct arguments are read from device memory
             "fast_math": False,
             "cuda_output": None,  # supported values: "ptx", "cubin", or None (automatic)
+            "lto": None,  # link-time optimization with nvJitLink, or None to use warp.config.cuda_lto
             "mode": warp.config.mode,
+            "optimize_codegen": warp.config.optimize_codegen,
+            "store_intermediates": False,
+            "cpu_simd_width": 0,
+            "persistent": False,  # generate a persistent CUDA kernel for submitting command lists with persistent=True
+            "forward_mode_width": 0,  # tangent directions of the forward-mode entry points of kernels, see jvp()
         }
 
         # kernel hook lookup per device
         # hooks are stored with the module so they can be easily cleared when the module is reloaded.
         # -> See ``Module.get_kernel_hooks()``
         self.kernel_hooks = {}
+        self.persistent_kernel_hooks = {}
 
         # Module dependencies are determined by scanning each function
         # and kernel for references to external functions and structs.
@@ -1196,6 +1351,9 @@ class Module:
 
         self.content_hash = None
 
+        # the last module hash and the contents and configuration it was computed from
+        self.module_hash = None
+
     def register_struct(self, struct):
         self.structs[struct.key] = struct
 
@@ -1282,39 +1440,71 @@ class Module:
                 return get_type_name(type_hint.cls)
             return type_hint
 
-        def hash_recursive(module, visited):
-            # Hash this module, including all referenced modules recursively.
-            # The visited set tracks modules already visited to avoid circular references.
+        def get_source_hash(adj):
+            # sources never change after a function or kernel is defined, so their digests are computed only once
+            if adj.source_hash is None:
+                adj.source_hash = hashlib.sha256(bytes(adj.source, "utf-8")).digest()
+            return adj.source_hash
+
+        def get_struct_hash(struct):
+            if struct.content_hash is None:
+                s = ",".join(
+                    "{}: {}".format(name, get_type_name(type_hint))
+                    for name, type_hint in get_annotations(struct.cls).items()
+                )
+                struct.content_hash = hashlib.sha256(bytes(s, "utf-8")).digest()
+            return struct.content_hash
 
-            # check if we need to update the content hash
+        def update_content_hash(module):
+            # the content hash combines the cached digests of the module's structs, functions, and kernels,
+            # registering a new one only re-hashes that one
             if not module.content_hash:
-                # recompute content hash
                 ch = hashlib.sha256()
 
+                # the keys name the generated symbols, they distinguish definitions sharing their source,
+                # e.g.: kernels generated from the same function for different argument types
+
                 # struct source
                 for struct in module.structs.values():
-                    s = ",".join(
-                        "{}: {}".format(name, get_type_name(type_hint))
-                        for name, type_hint in get_annotations(struct.cls).items()
-                    )
-                    ch.update(bytes(s, "utf-8"))
+                    ch.update(bytes(struct.key, "utf-8"))
+                    ch.update(get_struct_hash(struct))
 
                 # functions source
                 for func in module.functions.values():
-                    s = func.adj.source
-                    ch.update(bytes(s, "utf-8"))
+                    ch.update(bytes(func.key, "utf-8"))
+                    ch.update(get_source_hash(func.adj))
 
                 # kernel source
                 for kernel in module.kernels.values():
-                    ch.update(bytes(kernel.adj.source, "utf-8"))
+                    ch.update(bytes(kernel.key, "utf-8"))
+                    ch.update(get_source_hash(kernel.adj))
                     # for generic kernels the Python source is always the same,
                     # but we hash the type signatures of all the overloads
                     if kernel.is_generic:
                         for sig in sorted(kernel.overloads.keys()):
                             ch.update(bytes(sig, "utf-8"))
+                    # likewise for the value signatures of specialized kernels
+                    if kernel.specialize or kernel.is_generic:
+                        for sig in sorted(k.sig for k in kernel.get_instances()):
+                            ch.update(bytes(sig, "utf-8"))
 
                 module.content_hash = ch.digest()
 
+            return module.content_hash
+
+        def get_hash_key(module, visited):
+            # everything the module hash depends on, in traversal order, to reuse the previous hash when unchanged
+            visited.add(module)
+            key = [(module.name, update_content_hash(module), tuple(sorted(module.options.items())))]
+            for dep in sorted(module.references, key=lambda m: m.name):
+                if dep not in visited:
+                    key.extend(get_hash_key(dep, visited))
+            return key
+
+        def hash_recursive(module, visited):
+            # Hash this module, including all referenced modules recursively.
+            # The visited set tracks modules already visited to avoid circular references.
+
             h = hashlib.sha256()
 
             # content hash
@@ -1346,13 +1536,202 @@ class Module:
 
             return h.digest()
 
-        return hash_recursive(self, visited=set())
+        hash_key = get_hash_key(self, visited=set())
+        hash_key.append((warp.config.verify_fp, warp.config.mode))
+        if warp.types._constant_hash:
+            hash_key.append(warp.types._constant_hash.digest())
+
+        if self.module_hash is None or self.module_hash[0] != hash_key:
+            self.module_hash = (hash_key, hash_recursive(self, visited=set()))
+
+        return self.module_hash[1]
+
+    def get_kernel_metadata(self):
+        """Returns the launch properties of the module kernels that are determined by code generation"""
+        metadata = {}
+        for kernel in self.kernels.values():
+            for k in kernel.get_instances():
+                metadata[k.get_mangled_name()] = [
+                    k.adj.store_intermediates,
+                    k.adj.intermediates_size,
+                    k.adj.uses_tiles,
+                    k.adj.uses_winding_number,
+                    k.adj.uses_grid_index,
+                    sorted(k.adj.written_args),
+                    k.adj.param_buffer_args,
+                ]
+        return metadata
+
+    def set_kernel_metadata(self, metadata):
+        """Restores the launch properties of the module kernels, returns False if some of them are missing"""
+        instances = [k for kernel in self.kernels.values() for k in kernel.get_instances()]
+        if any(len(metadata.get(k.get_mangled_name(), [])) != 7 for k in instances):
+            return False
+
+        for k in instances:
+            (
+                k.adj.store_intermediates,
+                k.adj.intermediates_size,
+                k.adj.uses_tiles,
+                k.adj.uses_winding_number,
+                k.adj.uses_grid_index,
+                written_args,
+                k.adj.param_buffer_args,
+            ) = metadata[k.get_mangled_name()]
+            k.adj.written_args = set(written_args)
+        return True
+
+    def get_metadata_path(self):
+        return os.path.join(warp.build.kernel_bin_dir, "wp_" + self.name + ".meta")
+
+    def save_kernel_metadata(self, module_hash):
+        """Writes the launch properties of the module kernels next to the cached binaries built from ``module_hash``"""
+        import json
+
+        meta = {"hash": module_hash.hex(), "kernels": self.get_kernel_metadata()}
+        warp.build.write_cache_file(self.get_metadata_path(), json.dumps(meta))
+
+    def restore_kernel_metadata(self, module_hash):
+        """Prepares the kernels for launching from cached binaries built from ``module_hash``
+
+        The launch properties saved with the binaries are read back, so that a new process skips code generation
+        entirely. The module is only generated again when they are missing or stale.
+        """
+        import json
+
+        try:
+            with open(self.get_metadata_path(), "r") as f:
+                meta = json.load(f)
+            if meta.get("hash") == module_hash.hex() and self.set_kernel_metadata(meta.get("kernels", {})):
+                return
+        except (OSError, ValueError):
+            pass
+
+        ModuleBuilder(self, self.options)
+        self.save_kernel_metadata(module_hash)
+
+    def get_cuda_output(self, device):
+        """Returns the target architecture and the cached PTX, CUBIN, or fatbin path of this module for a CUDA device.
+
+        For fat binaries, the target architecture is the tuple of architectures bundled in the binary.
+        """
+
+        module_path = os.path.join(warp.build.kernel_bin_dir, "wp_" + self.name)
+
+        # a single fat binary for all configured architectures can be shared between devices
+        fatbin_archs = warp.build.get_fatbin_archs()
+        if fatbin_archs:
+            output_arch = fatbin_archs
+            output_path = module_path + ".sm" + "_".join(str(arch) for arch in fatbin_archs) + ".fatbin"
+            return output_arch, output_path
+
+        # determine whether to use PTX or CUBIN
+        if device.is_cubin_supported:
+            # get user preference specified either per module or globally
+            preferred_cuda_output = self.options.get("cuda_output") or warp.config.cuda_output
+            if preferred_cuda_output is not None:
+                use_ptx = preferred_cuda_output == "ptx"
+            else:
+                # determine automatically: older drivers may not be able to handle PTX generated using newer
+                # CUDA Toolkits, in which case we fall back on generating CUBIN modules
+                use_ptx = runtime.driver_version >= runtime.toolkit_version
+        else:
+            # CUBIN not an option, must use PTX (e.g. CUDA Toolkit too old)
+            use_ptx = True
+
+        # link-time optimized modules are linked into SASS for the device architecture
+        lto = self.options.get("lto")
+        if lto is None:
+            lto = warp.config.cuda_lto
+        if lto and not warp.config.llvm_cuda:
+            if runtime.toolkit_version < 12040:
+                raise RuntimeError("Link-time optimization requires Warp to be built with CUDA Toolkit 12.4 or higher")
+            output_arch = device.arch
+            output_path = module_path + f".sm{output_arch}.lto.cubin"
+            return output_arch, output_path
+
+        if use_ptx:
+            output_arch = min(device.arch, warp.config.ptx_target_arch)
+            output_path = module_path + f".sm{output_arch}.ptx"
+        else:
+            output_arch = device.arch
+            output_path = module_path + f".sm{output_arch}.cubin"
+
+        return output_arch, output_path
+
+    def is_cuda_output_cached(self, output_path, module_hash):
+        if not warp.config.cache_kernels:
+            return False
+
+        cuda_hash_path = os.path.splitext(output_path)[0] + ".hash"
+        if os.path.isfile(cuda_hash_path) and os.path.isfile(output_path):
+            with open(cuda_hash_path, "rb") as f:
+                return f.read() == module_hash
+
+        return False
+
+    def is_cpu_output_cached(self, obj_path, cpu_hash):
+        if not warp.config.cache_kernels:
+            return False
+
+        cpu_hash_path = os.path.splitext(obj_path)[0] + ".cpu.hash"
+        if os.path.isfile(cpu_hash_path) and os.path.isfile(obj_path):
+            with open(cpu_hash_path, "rb") as f:
+                return f.read() == cpu_hash
+
+        return False
+
+    def compile_cuda(self, cu_source, output_arch, output_path, module_hash):
+        """Compile generated CUDA source to PTX or CUBIN and record the module hash.
+
+        This does not touch any CUDA context and only releases the GIL while NVRTC runs,
+        so it can be called concurrently for different modules or architectures.
+        Processes sharing the kernel cache compile each output once, the others wait for it.
+        """
+
+        from warp.utils import ScopedTimer
+
+        output_name = os.path.splitext(os.path.basename(output_path))[0]
+        cuda_hash_path = os.path.splitext(output_path)[0] + ".hash"
+
+        with warp.build.kernel_cache_lock(os.path.basename(output_path)):
+            # built by another process while this one was waiting
+            if self.is_cuda_output_cached(output_path, module_hash):
+                return
+
+            # write cuda sources, one file per output so concurrent builds don't collide
+            cu_path = os.path.join(warp.build.kernel_gen_dir, output_name + ".cu")
+            warp.build.write_cache_file(cu_path, cu_source)
+
+            # generate PTX, CUBIN, or fatbin
+            tmp_path = warp.build.get_cache_temp_path(output_path)
+            with ScopedTimer(f"Compile CUDA {output_name}", active=warp.config.verbose):
+                warp.build.build_cuda(
+                    cu_path,
+                    output_arch,
+                    tmp_path,
+                    config=self.options["mode"],
+                    fast_math=self.options["fast_math"],
+                    verify_fp=warp.config.verify_fp,
+                )
+            os.replace(tmp_path, output_path)
+
+            # update cuda hash
+            warp.build.write_cache_file(cuda_hash_path, module_hash)
+
+        warp.build.evict_kernel_cache(keep=(output_path, cuda_hash_path, self.get_metadata_path()))
 
     def load(self, device):
         from warp.utils import ScopedTimer
 
         device = get_device(device)
 
+        # wait for a background load of this module instead of building it a second time,
+        # a failed build is reported through the build failure flags below
+        pending = self.pending_load
+        if pending is not None and not getattr(_async_load_state, "active", False):
+            concurrent.futures.wait([pending])
+
         if device.is_cpu:
             # check if already loaded
             if self.cpu_module:
@@ -1385,47 +1764,55 @@ class Module:
             module_path = os.path.join(build_path, module_name)
             module_hash = self.hash_module()
 
-            builder = ModuleBuilder(self, self.options)
-
+            # code is only generated on a cache miss, cached binaries are loaded with the saved kernel metadata
             if device.is_cpu:
                 obj_path = os.path.join(build_path, module_name)
                 obj_path = obj_path + ".o"
                 cpu_hash_path = module_path + ".cpu.hash"
 
-                # check cache
-                if warp.config.cache_kernels and os.path.isfile(cpu_hash_path) and os.path.isfile(obj_path):
-                    with open(cpu_hash_path, "rb") as f:
-                        cache_hash = f.read()
+                # objects compiled for the host's instruction set are only reused on CPUs with the same target
+                cpu_hash = module_hash + warp.build.get_cpu_target().encode("utf-8")
 
-                    if cache_hash == module_hash:
-                        runtime.llvm.load_obj(obj_path.encode("utf-8"), module_name.encode("utf-8"))
-                        self.cpu_module = module_name
-                        return True
+                # check cache, or the shared cache in front of a build
+                if self.is_cpu_output_cached(obj_path, cpu_hash) or warp.build.fetch_shared_cache_entry(
+                    obj_path, cpu_hash_path, cpu_hash, self.get_metadata_path()
+                ):
+                    self.restore_kernel_metadata(module_hash)
+                    warp.build.touch_kernel_cache((obj_path, cpu_hash_path, self.get_metadata_path()))
+                    runtime.llvm.load_obj(obj_path.encode("utf-8"), module_name.encode("utf-8"))
+                    self.cpu_module = module_name
+                    return True
 
                 # build
                 try:
-                    cpp_path = os.path.join(gen_path, module_name + ".cpp")
-
-                    # write cpp sources
-                    cpp_source = builder.codegen("cpu")
-
-                    cpp_file = open(cpp_path, "w")
-                    cpp_file.write(cpp_source)
-                    cpp_file.close()
-
-                    # build object code
-                    with ScopedTimer("Compile x86", active=warp.config.verbose):
-                        warp.build.build_cpu(
-                            obj_path,
-                            cpp_path,
-                            mode=self.options["mode"],
-                            fast_math=self.options["fast_math"],
-                            verify_fp=warp.config.verify_fp,
-                        )
+                    # processes sharing the kernel cache build each module once, the others wait for it
+                    with warp.build.kernel_cache_lock(module_name + ".o"):
+                        if self.is_cpu_output_cached(obj_path, cpu_hash):
+                            self.restore_kernel_metadata(module_hash)
+                        else:
+                            cpp_path = os.path.join(gen_path, module_name + ".cpp")
+
+                            # write cpp sources
+                            cpp_source = ModuleBuilder(self, self.options).codegen("cpu")
+                            self.save_kernel_metadata(module_hash)
+                            warp.build.write_cache_file(cpp_path, cpp_source)
+
+                            # build object code
+                            tmp_path = warp.build.get_cache_temp_path(obj_path)
+                            with ScopedTimer("Compile x86", active=warp.config.verbose):
+                                warp.build.build_cpu(
+                                    tmp_path,
+                                    cpp_path,
+                                    mode=self.options["mode"],
+                                    fast_math=self.options["fast_math"],
+                                    verify_fp=warp.config.verify_fp,
+                                )
+                            os.replace(tmp_path, obj_path)
 
-                    # update cpu hash
-                    with open(cpu_hash_path, "wb") as f:
-                        f.write(module_hash)
+                            # update cpu hash
+                            warp.build.write_cache_file(cpu_hash_path, cpu_hash)
+
+                    warp.build.evict_kernel_cache(keep=(obj_path, cpu_hash_path, self.get_metadata_path()))
 
                     # load the object code
                     runtime.llvm.load_obj(obj_path.encode("utf-8"), module_name.encode("utf-8"))
@@ -1436,65 +1823,25 @@ class Module:
                     raise (e)
 
             elif device.is_cuda:
-                # determine whether to use PTX or CUBIN
-                if device.is_cubin_supported:
-                    # get user preference specified either per module or globally
-                    preferred_cuda_output = self.options.get("cuda_output") or warp.config.cuda_output
-                    if preferred_cuda_output is not None:
-                        use_ptx = preferred_cuda_output == "ptx"
-                    else:
-                        # determine automatically: older drivers may not be able to handle PTX generated using newer
-                        # CUDA Toolkits, in which case we fall back on generating CUBIN modules
-                        use_ptx = runtime.driver_version >= runtime.toolkit_version
-                else:
-                    # CUBIN not an option, must use PTX (e.g. CUDA Toolkit too old)
-                    use_ptx = True
-
-                if use_ptx:
-                    output_arch = min(device.arch, warp.config.ptx_target_arch)
-                    output_path = module_path + f".sm{output_arch}.ptx"
-                else:
-                    output_arch = device.arch
-                    output_path = module_path + f".sm{output_arch}.cubin"
-
-                cuda_hash_path = module_path + f".sm{output_arch}.hash"
-
-                # check cache
-                if warp.config.cache_kernels and os.path.isfile(cuda_hash_path) and os.path.isfile(output_path):
-                    with open(cuda_hash_path, "rb") as f:
-                        cache_hash = f.read()
-
-                    if cache_hash == module_hash:
-                        cuda_module = warp.build.load_cuda(output_path, device)
-                        if cuda_module is not None:
-                            self.cuda_modules[device.context] = cuda_module
-                            return True
+                output_arch, output_path = self.get_cuda_output(device)
+
+                # check cache, or the shared cache in front of a build
+                cuda_hash_path = os.path.splitext(output_path)[0] + ".hash"
+                if self.is_cuda_output_cached(output_path, module_hash) or warp.build.fetch_shared_cache_entry(
+                    output_path, cuda_hash_path, module_hash, self.get_metadata_path()
+                ):
+                    self.restore_kernel_metadata(module_hash)
+                    warp.build.touch_kernel_cache((output_path, cuda_hash_path, self.get_metadata_path()))
+                    cuda_module = warp.build.load_cuda(output_path, device)
+                    if cuda_module is not None:
+                        self.cuda_modules[device.context] = cuda_module
+                        return True
 
                 # build
                 try:
-                    cu_path = os.path.join(gen_path, module_name + ".cu")
-
-                    # write cuda sources
-                    cu_source = builder.codegen("cuda")
-
-                    cu_file = open(cu_path, "w")
-                    cu_file.write(cu_source)
-                    cu_file.close()
-
-                    # generate PTX or CUBIN
-                    with ScopedTimer("Compile CUDA", active=warp.config.verbose):
-                        warp.build.build_cuda(
-                            cu_path,
-                            output_arch,
-                            output_path,
-                            config=self.options["mode"],
-                            fast_math=self.options["fast_math"],
-                            verify_fp=warp.config.verify_fp,
-                        )
-
-                    # update cuda hash
-                    with open(cuda_hash_path, "wb") as f:
-                        f.write(module_hash)
+                    cu_source = ModuleBuilder(self, self.options).codegen("cuda")
+                    self.save_kernel_metadata(module_hash)
+                    self.compile_cuda(cu_source, output_arch, output_path, module_hash)
 
                     # load the module
                     cuda_module = warp.build.load_cuda(output_path, device)
@@ -1525,11 +1872,32 @@ class Module:
 
         # clear kernel hooks
         self.kernel_hooks = {}
+        self.persistent_kernel_hooks = {}
 
         # clear content hash
         self.content_hash = None
 
     # lookup and cache kernel entry points based on name, called after compilation / module load
+    # kernel instances in the order of their task index in the persistent kernel
+    def get_persistent_kernels(self):
+        kernels = [k for kernel in self.kernels.values() for k in kernel.get_instances()]
+        return sorted(kernels, key=lambda k: k.get_mangled_name())
+
+    def get_persistent_kernel(self, device):
+        if not self.options.get("persistent"):
+            raise RuntimeError(
+                f"Module '{self.name}' has no persistent kernel, "
+                "enable it with wp.set_module_options({'persistent': True})"
+            )
+
+        kernel = self.persistent_kernel_hooks.get(device.context)
+        if kernel is None:
+            cu_module = self.cuda_modules[device.context]
+            kernel = runtime.core.cuda_get_kernel(device.context, cu_module, b"wp_cuda_persistent_kernel")
+            self.persistent_kernel_hooks[device.context] = kernel
+
+        return kernel
+
     def get_kernel_hooks(self, kernel, device):
         # get all hooks for this device
         device_hooks = self.kernel_hooks.get(device.context)
@@ -1560,10 +1928,44 @@ class Module:
                 device.context, cu_module, (name + "_cuda_kernel_backward").encode("utf-8")
             )
 
-        hooks = KernelHooks(forward, backward)
+        if device.is_cpu:
+            hooks = KernelHooks(forward, backward)
+        else:
+            block_dim = kernel.options.get("block_dim", self.options["block_dim"])
+            hooks = KernelHooks(
+                forward,
+                backward,
+                self.get_kernel_block_dim(kernel, device, forward, block_dim),
+                self.get_kernel_block_dim(kernel, device, backward, block_dim),
+            )
+
+        if warp.codegen.tangent_width(kernel, self.options):
+            if device.is_cpu:
+                jvp = runtime.llvm.lookup(self.cpu_module.encode("utf-8"), (name + "_cpu_jvp").encode("utf-8"))
+                hooks.jvp = ctypes.CFUNCTYPE(None)(jvp) if jvp else None
+            else:
+                hooks.jvp = runtime.core.cuda_get_kernel(
+                    device.context, self.cuda_modules[device.context], (name + "_cuda_kernel_jvp").encode("utf-8")
+                )
+
         device_hooks[kernel] = hooks
         return hooks
 
+    # resolve the launch block size of a CUDA kernel function, queried once when the hooks are created
+    def get_kernel_block_dim(self, kernel, device, func, block_dim):
+        if func is None:
+            return 0
+
+        if block_dim == "auto":
+            return runtime.core.cuda_get_kernel_occupancy_block_dim(device.context, func)
+
+        if not isinstance(block_dim, int) or block_dim < 1 or block_dim > 1024:
+            raise ValueError(
+                f"Invalid block_dim {block_dim} for kernel '{kernel.key}', expected an integer in [1, 1024] or 'auto'"
+            )
+
+        return block_dim
+
 
 # -------------------------------------------
 # execution context
@@ -1575,10 +1977,17 @@ class Allocator:
     def __init__(self, device):
         self.device = device
 
-    def alloc(self, size_in_bytes, pinned=False):
+    def alloc(self, size_in_bytes, pinned=False, managed=False):
         if self.device.is_cuda:
-            if self.device.is_capturing:
+            if managed:
+                if self.device.is_capturing:
+                    raise RuntimeError(f"Cannot allocate managed memory on device {self} while graph capture is active")
+                return runtime.core.alloc_managed(self.device.context, size_in_bytes)
+            # stream-ordered pool allocations can be recorded in graphs
+            if self.device.is_capturing and not self.device.is_mempool_enabled:
                 raise RuntimeError(f"Cannot allocate memory on device {self} while graph capture is active")
+            if self.device.auto_streams is not None:
+                self.device.auto_streams.memory_allocated = True
             return runtime.core.alloc_device(self.device.context, size_in_bytes)
         elif self.device.is_cpu:
             if pinned:
@@ -1586,9 +1995,13 @@ class Allocator:
             else:
                 return runtime.core.alloc_host(size_in_bytes)
 
-    def free(self, ptr, size_in_bytes, pinned=False):
+    def free(self, ptr, size_in_bytes, pinned=False, managed=False):
         if self.device.is_cuda:
-            if self.device.is_capturing:
+            if managed:
+                if self.device.is_capturing:
+                    raise RuntimeError(f"Cannot free managed memory on device {self} while graph capture is active")
+                return runtime.core.free_managed(self.device.context, ptr)
+            if self.device.is_capturing and not self.device.is_mempool_enabled:
                 raise RuntimeError(f"Cannot free memory on device {self} while graph capture is active")
             return runtime.core.free_device(self.device.context, ptr)
         elif self.device.is_cpu:
@@ -1685,6 +2098,9 @@ class Event:
 
         self.device = device
 
+        # external events are assumed to be created with timing enabled
+        self.enable_timing = enable_timing or cuda_event is not None
+
         if cuda_event is not None:
             self.cuda_event = cuda_event
         else:
@@ -1700,6 +2116,92 @@ class Event:
         if self.owner:
             runtime.core.cuda_event_destroy(self.device.context, self.cuda_event)
 
+    def query(self):
+        """Returns True if the work recorded by the event has completed, without blocking."""
+        return bool(runtime.core.cuda_event_query(self.cuda_event))
+
+    def synchronize(self):
+        """Block the calling thread until the work recorded by the event has completed."""
+        runtime.core.cuda_event_synchronize(self.cuda_event)
+
+
+class ReadbackFuture:
+    """Result of an asynchronous device-to-host readback started with :meth:`warp.array.numpy_async`.
+
+    The result may be waited for from a different thread than the one that started the readback.
+    """
+
+    def __init__(self, slot=None, view=None, result=None):
+        self._slot = slot
+        self._view = view
+        self._result = result
+        # the ring may resolve the readback when reusing its slot while a consumer thread waits for the result
+        self._lock = threading.Lock()
+
+    def done(self):
+        """Returns True if the readback has completed and :meth:`result` will not block."""
+        return self._slot is None or self._slot.event.query()
+
+    def result(self):
+        """Wait for the readback to complete and return the data as a NumPy array."""
+        self._resolve()
+        return self._result
+
+    def _resolve(self):
+        with self._lock:
+            if self._slot is not None:
+                self._slot.event.synchronize()
+
+                # copy out of the staging buffer so that its slot can be reused
+                self._result = self._view.numpy().copy()
+
+                self._slot.future = None
+                self._slot = None
+                self._view = None
+
+
+class ReadbackRing:
+    """Ring of pinned host staging buffers for asynchronous device-to-host readbacks.
+
+    Each readback copies into the next slot on the current stream and records the slot's event, so the
+    host keeps enqueuing work while up to ``num_slots`` readbacks are in flight.  When a slot comes around
+    again while its previous readback is still pending, that readback is waited for and its result is kept.
+
+    Args:
+        device: The CUDA device to read back from.  If None, the current CUDA device is used.
+        num_slots: The number of staging buffers.
+    """
+
+    class Slot:
+        def __init__(self, device):
+            self.buffer = None
+            self.event = Event(device)
+            self.future = None
+
+    def __init__(self, device: "Devicelike" = None, num_slots: int = 3):
+        device = get_device(device)
+        if not device.is_cuda:
+            raise RuntimeError(f"Readback rings are only supported on CUDA devices, got {device}")
+        if num_slots < 1:
+            raise ValueError(f"Readback ring needs at least one slot, got {num_slots}")
+
+        self.device = device
+        self.slots = [ReadbackRing.Slot(device) for _ in range(num_slots)]
+        self.next_slot = 0
+
+    def acquire(self, size_in_bytes):
+        slot = self.slots[self.next_slot]
+        self.next_slot = (self.next_slot + 1) % len(self.slots)
+
+        if slot.future is not None:
+            slot.future._resolve()
+
+        # staging buffers only grow, so steady-state readbacks do not allocate
+        if slot.buffer is None or slot.buffer.capacity < size_in_bytes:
+            slot.buffer = warp.empty(size_in_bytes, dtype=warp.uint8, device="cpu", pinned=True)
+
+        return slot
+
 
 class Device:
     def __init__(self, runtime, alias, ordinal=-1, is_primary=False, context=None):
@@ -1722,9 +2224,23 @@ class Device:
         # indicates whether CUDA graph capture is active for this device
         self.is_capturing = False
 
+        # streams of other devices joined to the capture started on this device, with the events that join them back
+        self.capture_peers = []
+
+        # dependency tracker of the launches in the scope of warp.ScopedAutoStreams
+        self.auto_streams = None
+
         self.allocator = Allocator(self)
         self.context_guard = ContextGuard(self)
 
+        # user-provided allocator set with wp.set_allocator() and the native callbacks of all allocators used so far,
+        # which are kept alive because the memory they allocated is freed through them
+        self.custom_allocator = None
+        self._allocator_callbacks = []
+
+        # default ring used by array.numpy_async(), created on first use
+        self._readback_ring = None
+
         if self.ordinal == -1:
             # CPU device
             self.name = platform.processor() or "CPU"
@@ -1821,6 +2337,19 @@ class Device:
     def has_stream(self):
         return self._stream is not None
 
+    @property
+    def readback_ring(self):
+        if self._readback_ring is None:
+            self._readback_ring = ReadbackRing(self)
+        return self._readback_ring
+
+    @property
+    def is_mempool_enabled(self):
+        if self.is_cuda:
+            return bool(self.runtime.core.cuda_device_is_mempool_enabled(self.ordinal))
+        else:
+            return False
+
     def __str__(self):
         return self.alias
 
@@ -1853,6 +2382,13 @@ class Device:
         else:
             return False
 
+    def enable_peer_access(self, other) -> bool:
+        """Enables direct access from this device to the memory of `other`, returns whether it succeeded"""
+        other = self.runtime.get_device(other)
+        if self.context is None or other.context is None:
+            return False
+        return bool(self.runtime.core.cuda_context_enable_peer_access(self.context, other.context))
+
 
 """ Meta-type for arguments that can be resolved to a concrete Device.
 """
@@ -1870,6 +2406,28 @@ class Graph:
             runtime.core.cuda_graph_destroy(self.device.context, self.exec)
 
 
+def get_visible_cuda_ordinals(cuda_device_count):
+    """Returns the ordinals of the CUDA devices Warp registers, from ``warp.config.cuda_visible_devices`` or the
+    comma-separated ``WARP_CUDA_DEVICES`` environment variable, or all devices if neither is set"""
+
+    ordinals = warp.config.cuda_visible_devices
+    if ordinals is None:
+        env = os.environ.get("WARP_CUDA_DEVICES")
+        if env is None:
+            return list(range(cuda_device_count))
+        try:
+            ordinals = [int(s) for s in env.split(",") if s.strip()]
+        except ValueError:
+            raise RuntimeError(f"WARP_CUDA_DEVICES must be a comma-separated list of device ordinals, got '{env}'")
+
+    ordinals = sorted(set(int(i) for i in ordinals))
+    for i in ordinals:
+        if i < 0 or i >= cuda_device_count:
+            raise RuntimeError(f"Visible CUDA device {i} does not exist, {cuda_device_count} devices are available")
+
+    return ordinals
+
+
 class Runtime:
     def __init__(self):
         bin_path = os.path.join(os.path.dirname(os.path.realpath(__file__)), "bin")
@@ -1900,16 +2458,27 @@ class Runtime:
             self.llvm = self.load_dll(llvm_lib)
             # setup c-types for warp-clang.dll
             self.llvm.lookup.restype = ctypes.c_uint64
+
+            self.llvm.cpu_set_max_threads.argtypes = [ctypes.c_int]
+            self.llvm.cpu_set_max_threads.restype = None
+            self.llvm.cpu_set_max_threads(warp.config.cpu_max_threads)
         else:
             self.llvm = None
 
         # setup c-types for warp.dll
+        # host BVH builds run on the runtime's own thread pool
+        self.core.cpu_set_max_threads.argtypes = [ctypes.c_int]
+        self.core.cpu_set_max_threads.restype = None
+        self.core.cpu_set_max_threads(warp.config.cpu_max_threads)
+
         self.core.alloc_host.argtypes = [ctypes.c_size_t]
         self.core.alloc_host.restype = ctypes.c_void_p
         self.core.alloc_pinned.argtypes = [ctypes.c_size_t]
         self.core.alloc_pinned.restype = ctypes.c_void_p
         self.core.alloc_device.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
         self.core.alloc_device.restype = ctypes.c_void_p
+        self.core.alloc_managed.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+        self.core.alloc_managed.restype = ctypes.c_void_p
 
         self.core.float_to_half_bits.argtypes = [ctypes.c_float]
         self.core.float_to_half_bits.restype = ctypes.c_uint16
@@ -1920,8 +2489,37 @@ class Runtime:
         self.core.free_host.restype = None
         self.core.free_pinned.argtypes = [ctypes.c_void_p]
         self.core.free_pinned.restype = None
+        self.core.pinned_pool_release.argtypes = []
+        self.core.pinned_pool_release.restype = None
+        self.core.pinned_pool_get_stats.argtypes = [ctypes.POINTER(ctypes.c_uint64)] * 4
+        self.core.pinned_pool_get_stats.restype = None
+        self.core.memory_tag_register.argtypes = [ctypes.c_char_p]
+        self.core.memory_tag_register.restype = ctypes.c_int
+        self.core.memory_tag_name.argtypes = [ctypes.c_int]
+        self.core.memory_tag_name.restype = ctypes.c_char_p
+        self.core.memory_tag_count.argtypes = []
+        self.core.memory_tag_count.restype = ctypes.c_int
+        self.core.memory_tag_set.argtypes = [ctypes.c_int]
+        self.core.memory_tag_set.restype = ctypes.c_int
+        self.core.memory_stats_get.argtypes = [ctypes.c_int, ctypes.c_int] + [ctypes.POINTER(ctypes.c_uint64)] * 4
+        self.core.memory_stats_get.restype = ctypes.c_int
+        self.core.memory_stats_reset_peak.argtypes = [ctypes.c_int]
+        self.core.memory_stats_reset_peak.restype = None
         self.core.free_device.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.free_device.restype = None
+        self.core.free_managed.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.core.free_managed.restype = None
+
+        self.core.memprefetch_managed.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_int]
+        self.core.memprefetch_managed.restype = ctypes.c_int
+        self.core.memadvise_managed.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_size_t,
+            ctypes.c_int,
+            ctypes.c_int,
+        ]
+        self.core.memadvise_managed.restype = ctypes.c_int
 
         self.core.memset_host.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_size_t]
         self.core.memset_host.restype = None
@@ -2045,13 +2643,75 @@ class Runtime:
             ctypes.c_int,
         ]
 
+        array_stats_argtypes = [
+            ctypes.c_uint64,  # values
+            ctypes.c_int,  # count
+            ctypes.c_int,  # stride
+            ctypes.c_int,  # type_len
+            ctypes.c_uint64,  # out_sum
+            ctypes.c_uint64,  # out_min
+            ctypes.c_uint64,  # out_max
+            ctypes.c_uint64,  # out_argmin
+            ctypes.c_uint64,  # out_argmax
+        ]
+        self.core.array_stats_float_host.argtypes = array_stats_argtypes
+        self.core.array_stats_double_host.argtypes = array_stats_argtypes
+        self.core.array_stats_float_device.argtypes = array_stats_argtypes
+        self.core.array_stats_double_device.argtypes = array_stats_argtypes
+
         self.core.array_scan_int_host.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int, ctypes.c_bool]
         self.core.array_scan_float_host.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int, ctypes.c_bool]
         self.core.array_scan_int_device.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int, ctypes.c_bool]
         self.core.array_scan_float_device.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int, ctypes.c_bool]
 
-        self.core.radix_sort_pairs_int_host.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int]
-        self.core.radix_sort_pairs_int_device.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int]
+        array_scan_vec_argtypes = [
+            ctypes.c_uint64,  # in
+            ctypes.c_uint64,  # out
+            ctypes.c_int,  # len
+            ctypes.c_int,  # type_len
+            ctypes.c_bool,  # inclusive
+            ctypes.c_uint64,  # segment_offsets
+            ctypes.c_int,  # num_segments
+        ]
+        self.core.array_scan_vec_int_host.argtypes = array_scan_vec_argtypes
+        self.core.array_scan_vec_float_host.argtypes = array_scan_vec_argtypes
+        self.core.array_scan_vec_double_host.argtypes = array_scan_vec_argtypes
+        self.core.array_scan_vec_int_device.argtypes = array_scan_vec_argtypes
+        self.core.array_scan_vec_float_device.argtypes = array_scan_vec_argtypes
+        self.core.array_scan_vec_double_device.argtypes = array_scan_vec_argtypes
+
+        # keys, values, count, begin_bit, end_bit
+        radix_sort_argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+        self.core.radix_sort_pairs_int_host.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_int_device.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_int64_host.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_int64_device.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_uint64_host.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_uint64_device.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_float_host.argtypes = radix_sort_argtypes
+        self.core.radix_sort_pairs_float_device.argtypes = radix_sort_argtypes
+
+        self.core.segmented_sort_pairs_int_host.argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_int,
+            ctypes.c_uint64,
+            ctypes.c_int,
+        ]
+        self.core.segmented_sort_pairs_int_device.argtypes = self.core.segmented_sort_pairs_int_host.argtypes
+        self.core.segmented_sort_pairs_float_host.argtypes = self.core.segmented_sort_pairs_int_host.argtypes
+        self.core.segmented_sort_pairs_float_device.argtypes = self.core.segmented_sort_pairs_int_host.argtypes
+
+        self.core.segmented_reduce_int_host.argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_int,
+            ctypes.c_int,
+        ]
+        self.core.segmented_reduce_int_device.argtypes = self.core.segmented_reduce_int_host.argtypes
+        self.core.segmented_reduce_float_host.argtypes = self.core.segmented_reduce_int_host.argtypes
+        self.core.segmented_reduce_float_device.argtypes = self.core.segmented_reduce_int_host.argtypes
 
         self.core.runlength_encode_int_host.argtypes = [
             ctypes.c_uint64,
@@ -2074,11 +2734,39 @@ class Runtime:
         self.core.bvh_create_device.restype = ctypes.c_uint64
         self.core.bvh_create_device.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
 
+        self.core.bvh_clone_to_device.restype = ctypes.c_uint64
+        self.core.bvh_clone_to_device.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_void_p, ctypes.c_void_p]
+
         self.core.bvh_destroy_host.argtypes = [ctypes.c_uint64]
         self.core.bvh_destroy_device.argtypes = [ctypes.c_uint64]
 
         self.core.bvh_refit_host.argtypes = [ctypes.c_uint64]
         self.core.bvh_refit_device.argtypes = [ctypes.c_uint64]
+        self.core.bvh_build_wide_host.argtypes = [ctypes.c_uint64]
+        self.core.bvh_build_wide_device.argtypes = [ctypes.c_uint64]
+        self.core.bvh_build_refit_levels_device.argtypes = [ctypes.c_uint64]
+
+        overlap_argtypes = [
+            ctypes.c_uint64,  # id_a
+            ctypes.c_uint64,  # id_b
+            ctypes.POINTER(ctypes.c_float),  # xform
+            ctypes.c_float,  # margin
+            ctypes.c_void_p,  # pairs
+            ctypes.c_int,  # max_pairs
+            ctypes.c_void_p,  # pair_count
+        ]
+        self.core.bvh_query_bvh_overlap_host.argtypes = overlap_argtypes
+        self.core.bvh_query_bvh_overlap_device.argtypes = overlap_argtypes
+
+        self_overlap_argtypes = [
+            ctypes.c_uint64,  # id
+            ctypes.c_float,  # margin
+            ctypes.c_void_p,  # pairs
+            ctypes.c_int,  # max_pairs
+            ctypes.c_void_p,  # pair_count
+        ]
+        self.core.bvh_query_self_overlap_host.argtypes = self_overlap_argtypes
+        self.core.bvh_query_self_overlap_device.argtypes = self_overlap_argtypes
 
         self.core.mesh_create_host.restype = ctypes.c_uint64
         self.core.mesh_create_host.argtypes = [
@@ -2101,56 +2789,254 @@ class Runtime:
             ctypes.c_int,
         ]
 
+        self.core.mesh_create_batch_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_void_p,  # points
+            ctypes.c_void_p,  # velocities
+            ctypes.c_void_p,  # indices
+            ctypes.POINTER(ctypes.c_int),  # point_offsets
+            ctypes.POINTER(ctypes.c_int),  # tri_offsets
+            ctypes.c_int,  # num_meshes
+            ctypes.c_int,  # support_winding_number
+            ctypes.POINTER(ctypes.c_uint64),  # ids
+        ]
+        self.core.mesh_create_batch_device.restype = None
+
+        self.core.mesh_clone_to_device.restype = ctypes.c_uint64
+        self.core.mesh_clone_to_device.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_uint64,
+            warp.types.array_t,
+            warp.types.array_t,
+            warp.types.array_t,
+        ]
+
         self.core.mesh_destroy_host.argtypes = [ctypes.c_uint64]
         self.core.mesh_destroy_device.argtypes = [ctypes.c_uint64]
 
         self.core.mesh_refit_host.argtypes = [ctypes.c_uint64]
         self.core.mesh_refit_device.argtypes = [ctypes.c_uint64]
 
-        self.core.hash_grid_create_host.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int]
-        self.core.hash_grid_create_host.restype = ctypes.c_uint64
-        self.core.hash_grid_destroy_host.argtypes = [ctypes.c_uint64]
-        self.core.hash_grid_update_host.argtypes = [ctypes.c_uint64, ctypes.c_float, ctypes.c_void_p, ctypes.c_int]
-        self.core.hash_grid_reserve_host.argtypes = [ctypes.c_uint64, ctypes.c_int]
-
-        self.core.hash_grid_create_device.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
-        self.core.hash_grid_create_device.restype = ctypes.c_uint64
-        self.core.hash_grid_destroy_device.argtypes = [ctypes.c_uint64]
-        self.core.hash_grid_update_device.argtypes = [ctypes.c_uint64, ctypes.c_float, ctypes.c_void_p, ctypes.c_int]
-        self.core.hash_grid_reserve_device.argtypes = [ctypes.c_uint64, ctypes.c_int]
-
-        self.core.cutlass_gemm.argtypes = [
-            ctypes.c_int,
-            ctypes.c_int,
-            ctypes.c_int,
+        mesh_skin_argtypes = [
+            ctypes.c_uint64,  # id
+            ctypes.c_void_p,  # rest_points
+            ctypes.c_void_p,  # bones
+            ctypes.c_void_p,  # bone_indices
+            ctypes.c_void_p,  # bone_weights
+            ctypes.c_int,  # bones_per_point
+            ctypes.POINTER(ctypes.c_float),  # xform
+        ]
+        self.core.mesh_skin_host.argtypes = mesh_skin_argtypes
+        self.core.mesh_skin_device.argtypes = mesh_skin_argtypes
+        self.core.mesh_refit_partial_host.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_int]
+        self.core.mesh_refit_partial_device.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_int]
+        self.core.mesh_refit_solid_angle_host.argtypes = [ctypes.c_uint64]
+        self.core.mesh_refit_solid_angle_device.argtypes = [ctypes.c_uint64]
+        self.core.mesh_build_wide_host.argtypes = [ctypes.c_uint64]
+        self.core.mesh_build_wide_device.argtypes = [ctypes.c_uint64]
+        self.core.mesh_quantize_host.argtypes = [ctypes.c_uint64]
+        self.core.mesh_quantize_device.argtypes = [ctypes.c_uint64]
+        self.core.mesh_reorder_host.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_void_p]
+        self.core.mesh_reorder_device.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_void_p]
+        self.core.mesh_build_refit_levels_device.argtypes = [ctypes.c_uint64]
+
+        mesh_raycast_batch_argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
             ctypes.c_int,
-            ctypes.c_char_p,
+            ctypes.c_float,
             ctypes.c_void_p,
             ctypes.c_void_p,
             ctypes.c_void_p,
             ctypes.c_void_p,
-            ctypes.c_float,
-            ctypes.c_float,
-            ctypes.c_bool,
-            ctypes.c_bool,
-            ctypes.c_bool,
             ctypes.c_int,
         ]
-        self.core.cutlass_gemm.restypes = ctypes.c_bool
+        self.core.mesh_raycast_batch_host.argtypes = mesh_raycast_batch_argtypes
+        self.core.mesh_raycast_batch_device.argtypes = mesh_raycast_batch_argtypes
 
-        self.core.volume_create_host.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
-        self.core.volume_create_host.restype = ctypes.c_uint64
-        self.core.volume_get_buffer_info_host.argtypes = [
+        mesh_query_point_batch_argtypes = [
             ctypes.c_uint64,
-            ctypes.POINTER(ctypes.c_void_p),
-            ctypes.POINTER(ctypes.c_uint64),
-        ]
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_float,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_int,
+        ]
+        self.core.mesh_query_point_batch_host.argtypes = mesh_query_point_batch_argtypes
+        self.core.mesh_query_point_batch_device.argtypes = mesh_query_point_batch_argtypes
+        self.core.mesh_query_mesh_overlap_host.argtypes = overlap_argtypes
+        self.core.mesh_query_mesh_overlap_device.argtypes = overlap_argtypes
+        self.core.mesh_query_bvh_overlap_host.argtypes = overlap_argtypes
+        self.core.mesh_query_bvh_overlap_device.argtypes = overlap_argtypes
+        self.core.mesh_query_self_overlap_host.argtypes = self_overlap_argtypes
+        self.core.mesh_query_self_overlap_device.argtypes = self_overlap_argtypes
+
+        mesh_intersections_argtypes = [
+            ctypes.c_uint64,  # id_a
+            ctypes.c_uint64,  # id_b
+            ctypes.POINTER(ctypes.c_float),  # xform
+            ctypes.c_void_p,  # pairs
+            ctypes.c_void_p,  # segments
+            ctypes.c_int,  # max_pairs
+            ctypes.c_void_p,  # pair_count
+        ]
+        self.core.mesh_query_mesh_intersections_host.argtypes = mesh_intersections_argtypes
+        self.core.mesh_query_mesh_intersections_device.argtypes = mesh_intersections_argtypes
+
+        self.core.tlas_create_host.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+        self.core.tlas_create_host.restype = ctypes.c_uint64
+        self.core.tlas_create_device.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+        self.core.tlas_create_device.restype = ctypes.c_uint64
+
+        self.core.tlas_destroy_host.argtypes = [ctypes.c_uint64]
+        self.core.tlas_destroy_device.argtypes = [ctypes.c_uint64]
+
+        self.core.tlas_refit_host.argtypes = [ctypes.c_uint64]
+        self.core.tlas_refit_device.argtypes = [ctypes.c_uint64]
+
+        self.core.hash_grid_create_host.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+        self.core.hash_grid_create_host.restype = ctypes.c_uint64
+        self.core.hash_grid_create_sparse_host.argtypes = []
+        self.core.hash_grid_create_sparse_host.restype = ctypes.c_uint64
+        self.core.hash_grid_create_levels_host.argtypes = [ctypes.c_float, ctypes.c_int]
+        self.core.hash_grid_create_levels_host.restype = ctypes.c_uint64
+        self.core.hash_grid_destroy_host.argtypes = [ctypes.c_uint64]
+        self.core.hash_grid_update_host.argtypes = [ctypes.c_uint64, ctypes.c_float, ctypes.c_void_p, ctypes.c_int]
+        self.core.hash_grid_update_levels_host.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+        self.core.hash_grid_reserve_host.argtypes = [ctypes.c_uint64, ctypes.c_int]
+        self.core.hash_grid_get_point_ids_host.argtypes = [ctypes.c_uint64]
+        self.core.hash_grid_get_point_ids_host.restype = ctypes.c_uint64
+        self.core.hash_grid_permute_host.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+        self.core.hash_grid_reset_order_host.argtypes = [ctypes.c_uint64]
+
+        self.core.hash_grid_create_device.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_int,
+        ]
+        self.core.hash_grid_create_device.restype = ctypes.c_uint64
+        self.core.hash_grid_create_sparse_device.argtypes = [ctypes.c_void_p]
+        self.core.hash_grid_create_sparse_device.restype = ctypes.c_uint64
+        self.core.hash_grid_create_levels_device.argtypes = [ctypes.c_void_p, ctypes.c_float, ctypes.c_int]
+        self.core.hash_grid_create_levels_device.restype = ctypes.c_uint64
+        self.core.hash_grid_destroy_device.argtypes = [ctypes.c_uint64]
+        self.core.hash_grid_update_device.argtypes = [ctypes.c_uint64, ctypes.c_float, ctypes.c_void_p, ctypes.c_int]
+        self.core.hash_grid_update_levels_device.argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_int,
+        ]
+        self.core.hash_grid_reserve_device.argtypes = [ctypes.c_uint64, ctypes.c_int]
+        self.core.hash_grid_get_point_ids_device.argtypes = [ctypes.c_uint64]
+        self.core.hash_grid_get_point_ids_device.restype = ctypes.c_uint64
+        self.core.hash_grid_permute_device.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+        self.core.hash_grid_reset_order_device.argtypes = [ctypes.c_uint64]
+
+        self.core.neighbor_list_create_host.argtypes = []
+        self.core.neighbor_list_create_host.restype = ctypes.c_uint64
+        self.core.neighbor_list_destroy_host.argtypes = [ctypes.c_uint64]
+        self.core.neighbor_list_build_host.argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_float,
+        ]
+        self.core.neighbor_list_build_host.restype = ctypes.c_int
+        self.core.neighbor_list_check_host.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_int, ctypes.c_float]
+        self.core.neighbor_list_check_host.restype = ctypes.c_int
+        self.core.neighbor_list_get_offsets_host.argtypes = [ctypes.c_uint64]
+        self.core.neighbor_list_get_offsets_host.restype = ctypes.c_uint64
+        self.core.neighbor_list_get_neighbors_host.argtypes = [ctypes.c_uint64]
+        self.core.neighbor_list_get_neighbors_host.restype = ctypes.c_uint64
+
+        self.core.neighbor_list_create_device.argtypes = [ctypes.c_void_p]
+        self.core.neighbor_list_create_device.restype = ctypes.c_uint64
+        self.core.neighbor_list_destroy_device.argtypes = [ctypes.c_uint64]
+        self.core.neighbor_list_build_device.argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_float,
+        ]
+        self.core.neighbor_list_build_device.restype = ctypes.c_int
+        self.core.neighbor_list_check_device.argtypes = [ctypes.c_uint64, ctypes.c_void_p, ctypes.c_int, ctypes.c_float]
+        self.core.neighbor_list_check_device.restype = ctypes.c_int
+        self.core.neighbor_list_get_offsets_device.argtypes = [ctypes.c_uint64]
+        self.core.neighbor_list_get_offsets_device.restype = ctypes.c_uint64
+        self.core.neighbor_list_get_neighbors_device.argtypes = [ctypes.c_uint64]
+        self.core.neighbor_list_get_neighbors_device.restype = ctypes.c_uint64
+
+        self.core.knn_graph_host.argtypes = [
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_float,
+            ctypes.c_float,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+        ]
+        self.core.knn_graph_host.restype = ctypes.c_int
+        self.core.knn_graph_device.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_float,
+            ctypes.c_float,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+        ]
+        self.core.knn_graph_device.restype = ctypes.c_int
+
+        self.core.cutlass_gemm.argtypes = [
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_char_p,
+            ctypes.c_char_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_float,
+            ctypes.c_float,
+            ctypes.c_bool,
+            ctypes.c_bool,
+            ctypes.c_bool,
+            ctypes.c_int,
+        ]
+        self.core.cutlass_gemm.restypes = ctypes.c_bool
+
+        self.core.volume_create_host.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+        self.core.volume_create_host.restype = ctypes.c_uint64
+        self.core.volume_get_buffer_info_host.argtypes = [
+            ctypes.c_uint64,
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_uint64),
+        ]
         self.core.volume_get_tiles_host.argtypes = [
             ctypes.c_uint64,
             ctypes.POINTER(ctypes.c_void_p),
             ctypes.POINTER(ctypes.c_uint64),
         ]
         self.core.volume_destroy_host.argtypes = [ctypes.c_uint64]
+        self.core.volume_load_nvdb_host.argtypes = [ctypes.c_char_p]
+        self.core.volume_load_nvdb_host.restype = ctypes.c_uint64
+        self.core.volume_prefetch_nvdb_host.argtypes = [ctypes.c_char_p]
+        self.core.volume_prefetch_nvdb_host.restype = ctypes.c_void_p
 
         self.core.volume_create_device.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint64]
         self.core.volume_create_device.restype = ctypes.c_uint64
@@ -2192,6 +3078,91 @@ class Runtime:
             ctypes.c_bool,
         ]
         self.core.volume_i_from_tiles_device.restype = ctypes.c_uint64
+        self.core.volume_f_from_dense_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_void_p,  # values
+            ctypes.c_int,  # nx
+            ctypes.c_int,  # ny
+            ctypes.c_int,  # nz
+            ctypes.c_float,  # voxel_size
+            ctypes.c_float,  # bg_value
+            ctypes.c_float,  # tolerance
+            ctypes.c_float,  # tx
+            ctypes.c_float,  # ty
+            ctypes.c_float,  # tz
+        ]
+        self.core.volume_f_from_dense_device.restype = ctypes.c_uint64
+        self.core.volume_v_from_dense_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_void_p,  # values
+            ctypes.c_int,  # nx
+            ctypes.c_int,  # ny
+            ctypes.c_int,  # nz
+            ctypes.c_float,  # voxel_size
+            ctypes.c_float,  # bg_value_x
+            ctypes.c_float,  # bg_value_y
+            ctypes.c_float,  # bg_value_z
+            ctypes.c_float,  # tolerance
+            ctypes.c_float,  # tx
+            ctypes.c_float,  # ty
+            ctypes.c_float,  # tz
+        ]
+        self.core.volume_v_from_dense_device.restype = ctypes.c_uint64
+        self.core.volume_i_from_dense_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_void_p,  # values
+            ctypes.c_int,  # nx
+            ctypes.c_int,  # ny
+            ctypes.c_int,  # nz
+            ctypes.c_float,  # voxel_size
+            ctypes.c_int,  # bg_value
+            ctypes.c_float,  # tolerance
+            ctypes.c_float,  # tx
+            ctypes.c_float,  # ty
+            ctypes.c_float,  # tz
+        ]
+        self.core.volume_i_from_dense_device.restype = ctypes.c_uint64
+        self.core.volume_sdf_from_mesh_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_uint64,  # mesh
+            ctypes.c_float,  # voxel_size
+            ctypes.c_float,  # narrow_band
+            ctypes.c_float,  # tx
+            ctypes.c_float,  # ty
+            ctypes.c_float,  # tz
+        ]
+        self.core.volume_sdf_from_mesh_device.restype = ctypes.c_uint64
+        self.core.volume_quantize_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_uint64,  # id
+            ctypes.c_int,  # bits
+        ]
+        self.core.volume_quantize_device.restype = ctypes.c_uint64
+        self.core.volume_clone_to_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_uint64,  # id
+        ]
+        self.core.volume_clone_to_device.restype = ctypes.c_uint64
+        self.core.volume_activate_tiles_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_uint64,  # id
+            ctypes.c_void_p,  # points
+            ctypes.c_int,  # num_points
+            ctypes.c_bool,  # points_in_world_space
+        ]
+        self.core.volume_activate_tiles_device.restype = ctypes.c_uint64
+        self.core.volume_dilate_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_uint64,  # id
+            ctypes.c_int,  # voxels
+        ]
+        self.core.volume_dilate_device.restype = ctypes.c_uint64
+        self.core.volume_prune_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_uint64,  # id
+            ctypes.c_float,  # tolerance
+        ]
+        self.core.volume_prune_device.restype = ctypes.c_uint64
         self.core.volume_get_buffer_info_device.argtypes = [
             ctypes.c_uint64,
             ctypes.POINTER(ctypes.c_void_p),
@@ -2203,6 +3174,12 @@ class Runtime:
             ctypes.POINTER(ctypes.c_uint64),
         ]
         self.core.volume_destroy_device.argtypes = [ctypes.c_uint64]
+        self.core.volume_load_nvdb_device.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        self.core.volume_load_nvdb_device.restype = ctypes.c_uint64
+        self.core.volume_prefetch_nvdb_device.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        self.core.volume_prefetch_nvdb_device.restype = ctypes.c_void_p
+        self.core.volume_prefetch_wait.argtypes = [ctypes.c_void_p]
+        self.core.volume_prefetch_wait.restype = ctypes.c_uint64
 
         self.core.volume_get_voxel_size.argtypes = [
             ctypes.c_uint64,
@@ -2211,6 +3188,41 @@ class Runtime:
             ctypes.POINTER(ctypes.c_float),
         ]
 
+        self.core.volume_atlas_create_host.argtypes = [ctypes.POINTER(ctypes.c_uint64), ctypes.c_int]
+        self.core.volume_atlas_create_host.restype = ctypes.c_uint64
+        self.core.volume_atlas_create_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.POINTER(ctypes.c_uint64),  # ids
+            ctypes.c_int,  # count
+        ]
+        self.core.volume_atlas_create_device.restype = ctypes.c_uint64
+        self.core.volume_atlas_destroy_host.argtypes = [ctypes.c_uint64]
+        self.core.volume_atlas_destroy_device.argtypes = [ctypes.c_uint64]
+
+        self.core.texture3d_create_host.argtypes = [
+            ctypes.c_void_p,  # data
+            ctypes.c_int,  # nx
+            ctypes.c_int,  # ny
+            ctypes.c_int,  # nz
+            ctypes.c_bool,  # half_storage
+            ctypes.c_int,  # filter_mode
+            ctypes.c_int,  # address_mode
+        ]
+        self.core.texture3d_create_host.restype = ctypes.c_uint64
+        self.core.texture3d_destroy_host.argtypes = [ctypes.c_uint64]
+        self.core.texture3d_create_device.argtypes = [
+            ctypes.c_void_p,  # context
+            ctypes.c_void_p,  # data
+            ctypes.c_int,  # nx
+            ctypes.c_int,  # ny
+            ctypes.c_int,  # nz
+            ctypes.c_bool,  # half_storage
+            ctypes.c_int,  # filter_mode
+            ctypes.c_int,  # address_mode
+        ]
+        self.core.texture3d_create_device.restype = ctypes.c_uint64
+        self.core.texture3d_destroy_device.argtypes = [ctypes.c_uint64]
+
         bsr_matrix_from_triplets_argtypes = [
             ctypes.c_int,
             ctypes.c_int,
@@ -2222,6 +3234,8 @@ class Runtime:
             ctypes.c_uint64,
             ctypes.c_uint64,
             ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
         ]
         self.core.bsr_matrix_from_triplets_float_host.argtypes = bsr_matrix_from_triplets_argtypes
         self.core.bsr_matrix_from_triplets_double_host.argtypes = bsr_matrix_from_triplets_argtypes
@@ -2233,6 +3247,21 @@ class Runtime:
         self.core.bsr_matrix_from_triplets_float_device.restype = ctypes.c_int
         self.core.bsr_matrix_from_triplets_double_device.restype = ctypes.c_int
 
+        bsr_set_triplet_values_argtypes = [
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+        ]
+        self.core.bsr_set_triplet_values_float_host.argtypes = bsr_set_triplet_values_argtypes
+        self.core.bsr_set_triplet_values_double_host.argtypes = bsr_set_triplet_values_argtypes
+        self.core.bsr_set_triplet_values_float_device.argtypes = bsr_set_triplet_values_argtypes
+        self.core.bsr_set_triplet_values_double_device.argtypes = bsr_set_triplet_values_argtypes
+        self.core.bsr_set_triplet_values_half_host.argtypes = bsr_set_triplet_values_argtypes
+        self.core.bsr_set_triplet_values_half_device.argtypes = bsr_set_triplet_values_argtypes
+
         bsr_transpose_argtypes = [
             ctypes.c_int,
             ctypes.c_int,
@@ -2250,6 +3279,95 @@ class Runtime:
         self.core.bsr_transpose_double_host.argtypes = bsr_transpose_argtypes
         self.core.bsr_transpose_float_device.argtypes = bsr_transpose_argtypes
         self.core.bsr_transpose_double_device.argtypes = bsr_transpose_argtypes
+        self.core.bsr_transpose_half_host.argtypes = bsr_transpose_argtypes
+        self.core.bsr_transpose_half_device.argtypes = bsr_transpose_argtypes
+
+        bsr_mv_argtypes = [
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_int,
+        ]
+        self.core.bsr_mv_float_host.argtypes = bsr_mv_argtypes + [ctypes.c_float, ctypes.c_float]
+        self.core.bsr_mv_double_host.argtypes = bsr_mv_argtypes + [ctypes.c_double, ctypes.c_double]
+        self.core.bsr_mv_float_device.argtypes = bsr_mv_argtypes + [ctypes.c_float, ctypes.c_float]
+        self.core.bsr_mv_double_device.argtypes = bsr_mv_argtypes + [ctypes.c_double, ctypes.c_double]
+        self.core.bsr_mv_half_host.argtypes = bsr_mv_argtypes + [ctypes.c_float, ctypes.c_float]
+        self.core.bsr_mv_half_device.argtypes = bsr_mv_argtypes + [ctypes.c_float, ctypes.c_float]
+
+        bsr_mm_count_argtypes = [
+            ctypes.c_int,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+            ctypes.c_uint64,
+        ]
+        self.core.bsr_mm_count_host.argtypes = bsr_mm_count_argtypes
+        self.core.bsr_mm_count_device.argtypes = bsr_mm_count_argtypes
+        self.core.bsr_mm_count_host.restype = ctypes.c_int
+        self.core.bsr_mm_count_device.restype = ctypes.c_int
+        self.core.bsr_mm_list_columns_host.argtypes = bsr_mm_count_argtypes + [ctypes.c_uint64]
+        self.core.bsr_mm_list_columns_device.argtypes = bsr_mm_count_argtypes + [ctypes.c_uint64]
+
+        bsr_mm_compute_values_argtypes = [ctypes.c_int] * 4 + [ctypes.c_uint64] * 12
+        self.core.bsr_mm_compute_values_float_host.argtypes = bsr_mm_compute_values_argtypes + [
+            ctypes.c_float,
+            ctypes.c_float,
+        ]
+        self.core.bsr_mm_compute_values_double_host.argtypes = bsr_mm_compute_values_argtypes + [
+            ctypes.c_double,
+            ctypes.c_double,
+        ]
+        self.core.bsr_mm_compute_values_float_device.argtypes = bsr_mm_compute_values_argtypes + [
+            ctypes.c_float,
+            ctypes.c_float,
+        ]
+        self.core.bsr_mm_compute_values_double_device.argtypes = bsr_mm_compute_values_argtypes + [
+            ctypes.c_double,
+            ctypes.c_double,
+        ]
+
+        bsr_axpy_blocks_argtypes = [ctypes.c_int, ctypes.c_int] + [ctypes.c_uint64] * 6
+        self.core.bsr_axpy_blocks_float_host.argtypes = bsr_axpy_blocks_argtypes + [ctypes.c_float]
+        self.core.bsr_axpy_blocks_double_host.argtypes = bsr_axpy_blocks_argtypes + [ctypes.c_double]
+        self.core.bsr_axpy_blocks_float_device.argtypes = bsr_axpy_blocks_argtypes + [ctypes.c_float]
+        self.core.bsr_axpy_blocks_double_device.argtypes = bsr_axpy_blocks_argtypes + [ctypes.c_double]
+
+        bsr_block_diag_inverse_argtypes = [ctypes.c_int, ctypes.c_int] + [ctypes.c_uint64] * 4
+        self.core.bsr_block_diag_inverse_float_host.argtypes = bsr_block_diag_inverse_argtypes
+        self.core.bsr_block_diag_inverse_double_host.argtypes = bsr_block_diag_inverse_argtypes
+        self.core.bsr_block_diag_inverse_float_device.argtypes = bsr_block_diag_inverse_argtypes
+        self.core.bsr_block_diag_inverse_double_device.argtypes = bsr_block_diag_inverse_argtypes
+
+        self.core.bsr_ilu_levels_host.argtypes = [ctypes.c_int] + [ctypes.c_uint64] * 4
+
+        bsr_ilu_factor_argtypes = [ctypes.c_int, ctypes.c_int] + [ctypes.c_uint64] * 6 + [ctypes.c_int]
+        self.core.bsr_ilu_factor_float_host.argtypes = bsr_ilu_factor_argtypes
+        self.core.bsr_ilu_factor_double_host.argtypes = bsr_ilu_factor_argtypes
+        self.core.bsr_ilu_factor_float_device.argtypes = bsr_ilu_factor_argtypes
+        self.core.bsr_ilu_factor_double_device.argtypes = bsr_ilu_factor_argtypes
+
+        bsr_ilu_solve_argtypes = (
+            [ctypes.c_int, ctypes.c_int]
+            + [ctypes.c_uint64] * 6
+            + [ctypes.c_int]
+            + [ctypes.c_uint64] * 2
+            + [ctypes.c_int]
+            + [ctypes.c_uint64] * 2
+        )
+        self.core.bsr_ilu_solve_float_host.argtypes = bsr_ilu_solve_argtypes
+        self.core.bsr_ilu_solve_double_host.argtypes = bsr_ilu_solve_argtypes
+        self.core.bsr_ilu_solve_float_device.argtypes = bsr_ilu_solve_argtypes
+        self.core.bsr_ilu_solve_double_device.argtypes = bsr_ilu_solve_argtypes
 
         self.core.is_cuda_enabled.argtypes = None
         self.core.is_cuda_enabled.restype = ctypes.c_int
@@ -2278,6 +3396,22 @@ class Runtime:
         self.core.cuda_device_get_arch.restype = ctypes.c_int
         self.core.cuda_device_is_uva.argtypes = [ctypes.c_int]
         self.core.cuda_device_is_uva.restype = ctypes.c_int
+        self.core.cuda_device_is_mempool_enabled.argtypes = [ctypes.c_int]
+        self.core.cuda_device_is_mempool_enabled.restype = ctypes.c_int
+        self.core.cuda_device_set_mempool_enabled.argtypes = [ctypes.c_int, ctypes.c_int]
+        self.core.cuda_device_set_mempool_enabled.restype = ctypes.c_int
+        self.core.cuda_device_set_mempool_release_threshold.argtypes = [ctypes.c_int, ctypes.c_uint64]
+        self.core.cuda_device_set_mempool_release_threshold.restype = ctypes.c_int
+        self.core.cuda_device_get_mempool_release_threshold.argtypes = [ctypes.c_int]
+        self.core.cuda_device_get_mempool_release_threshold.restype = ctypes.c_uint64
+        self.core.cuda_device_get_mempool_stats.argtypes = [
+            ctypes.c_int,
+            ctypes.POINTER(ctypes.c_uint64),
+            ctypes.POINTER(ctypes.c_uint64),
+            ctypes.POINTER(ctypes.c_uint64),
+            ctypes.POINTER(ctypes.c_uint64),
+        ]
+        self.core.cuda_device_get_mempool_stats.restype = ctypes.c_int
 
         self.core.cuda_context_get_current.argtypes = None
         self.core.cuda_context_get_current.restype = ctypes.c_void_p
@@ -2304,8 +3438,12 @@ class Runtime:
         self.core.cuda_context_get_stream.restype = ctypes.c_void_p
         self.core.cuda_context_set_stream.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_context_set_stream.restype = None
+        self.core.cuda_context_set_allocator.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+        self.core.cuda_context_set_allocator.restype = None
         self.core.cuda_context_can_access_peer.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_context_can_access_peer.restype = ctypes.c_int
+        self.core.cuda_context_enable_peer_access.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.core.cuda_context_enable_peer_access.restype = ctypes.c_int
 
         self.core.cuda_stream_create.argtypes = [ctypes.c_void_p]
         self.core.cuda_stream_create.restype = ctypes.c_void_p
@@ -2329,11 +3467,47 @@ class Runtime:
         self.core.cuda_event_destroy.restype = None
         self.core.cuda_event_record.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_event_record.restype = None
+        self.core.cuda_event_query.argtypes = [ctypes.c_void_p]
+        self.core.cuda_event_query.restype = ctypes.c_int
+        self.core.cuda_event_synchronize.argtypes = [ctypes.c_void_p]
+        self.core.cuda_event_synchronize.restype = None
+        self.core.cuda_event_elapsed_time.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.core.cuda_event_elapsed_time.restype = ctypes.c_float
+        self.core.cuda_nvtx_range_push.argtypes = [ctypes.c_char_p]
+        self.core.cuda_nvtx_range_push.restype = None
+        self.core.cuda_nvtx_range_pop.argtypes = None
+        self.core.cuda_nvtx_range_pop.restype = None
 
         self.core.cuda_graph_begin_capture.argtypes = [ctypes.c_void_p]
         self.core.cuda_graph_begin_capture.restype = None
         self.core.cuda_graph_end_capture.argtypes = [ctypes.c_void_p]
         self.core.cuda_graph_end_capture.restype = ctypes.c_void_p
+        self.core.cuda_graph_end_capture_update.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.core.cuda_graph_end_capture_update.restype = ctypes.c_void_p
+        self.core.cuda_graph_create_conditional.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_bool,
+            ctypes.POINTER(ctypes.c_uint64),
+        ]
+        self.core.cuda_graph_create_conditional.restype = ctypes.c_bool
+        self.core.cuda_graph_begin_conditional.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_uint64,
+            ctypes.c_bool,
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_void_p),
+        ]
+        self.core.cuda_graph_begin_conditional.restype = ctypes.c_bool
+        self.core.cuda_graph_end_conditional.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_uint64,
+            ctypes.c_void_p,
+            ctypes.c_bool,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+        ]
+        self.core.cuda_graph_end_conditional.restype = ctypes.c_bool
         self.core.cuda_graph_launch.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_graph_launch.restype = None
         self.core.cuda_graph_destroy.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
@@ -2348,11 +3522,31 @@ class Runtime:
             ctypes.c_bool,
             ctypes.c_bool,
             ctypes.c_char_p,
+            ctypes.c_char_p,
         ]
         self.core.cuda_compile_program.restype = ctypes.c_size_t
+        self.core.cuda_compile_lto.argtypes = self.core.cuda_compile_program.argtypes
+        self.core.cuda_compile_lto.restype = ctypes.c_size_t
+
+        self.core.cuda_compile_fatbin.argtypes = [
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_int),
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_char_p,
+            ctypes.c_bool,
+            ctypes.c_bool,
+            ctypes.c_bool,
+            ctypes.c_bool,
+            ctypes.c_char_p,
+            ctypes.c_char_p,
+        ]
+        self.core.cuda_compile_fatbin.restype = ctypes.c_size_t
 
         self.core.cuda_load_module.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
         self.core.cuda_load_module.restype = ctypes.c_void_p
+        self.core.cuda_load_module_data.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_bool]
+        self.core.cuda_load_module_data.restype = ctypes.c_void_p
 
         self.core.cuda_unload_module.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_unload_module.restype = None
@@ -2360,14 +3554,45 @@ class Runtime:
         self.core.cuda_get_kernel.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_char_p]
         self.core.cuda_get_kernel.restype = ctypes.c_void_p
 
+        self.core.cuda_get_kernel_occupancy_block_dim.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self.core.cuda_get_kernel_occupancy_block_dim.restype = ctypes.c_int
+
         self.core.cuda_launch_kernel.argtypes = [
             ctypes.c_void_p,
             ctypes.c_void_p,
             ctypes.c_size_t,
+            ctypes.c_int,
             ctypes.POINTER(ctypes.c_void_p),
         ]
         self.core.cuda_launch_kernel.restype = ctypes.c_size_t
 
+        self.core.cuda_launch_kernels.argtypes = [
+            ctypes.c_void_p,
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_int),
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.c_int,
+        ]
+        self.core.cuda_launch_kernels.restype = ctypes.c_size_t
+        self.core.cuda_launch_persistent_kernel.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.c_void_p,
+            ctypes.c_size_t,
+        ]
+        self.core.cuda_launch_persistent_kernel.restype = ctypes.c_size_t
+        self.core.cuda_launch_kernels_multi.argtypes = [
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_int),
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.c_int,
+        ]
+        self.core.cuda_launch_kernels_multi.restype = ctypes.c_size_t
+
         self.core.cuda_graphics_map.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_graphics_map.restype = None
         self.core.cuda_graphics_unmap.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
@@ -2381,6 +3606,22 @@ class Runtime:
         self.core.cuda_graphics_device_ptr_and_size.restype = None
         self.core.cuda_graphics_register_gl_buffer.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint]
         self.core.cuda_graphics_register_gl_buffer.restype = ctypes.c_void_p
+        self.core.cuda_graphics_register_gl_image.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_uint32,
+            ctypes.c_uint32,
+            ctypes.c_uint,
+        ]
+        self.core.cuda_graphics_register_gl_image.restype = ctypes.c_void_p
+        self.core.cuda_graphics_copy_image.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_void_p,
+            ctypes.c_uint64,
+            ctypes.c_size_t,
+            ctypes.c_size_t,
+            ctypes.c_size_t,
+        ]
+        self.core.cuda_graphics_copy_image.restype = None
         self.core.cuda_graphics_unregister_resource.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
         self.core.cuda_graphics_unregister_resource.restype = None
 
@@ -2418,22 +3659,30 @@ class Runtime:
             else:
                 self.nvrtc_supported_archs = []
 
-        # register CUDA devices
+        # register CUDA devices, their primary contexts are only retained once they are used
         self.cuda_devices = []
-        self.cuda_primary_devices = []
-        for i in range(cuda_device_count):
+        self.cuda_primary_devices = {}  # by ordinal
+        for i in get_visible_cuda_ordinals(cuda_device_count):
             alias = f"cuda:{i}"
             device = Device(self, alias, ordinal=i, is_primary=True)
             self.cuda_devices.append(device)
-            self.cuda_primary_devices.append(device)
+            self.cuda_primary_devices[i] = device
             self.device_map[alias] = device
 
+            # opt-in stream-ordered allocations for all arrays
+            if warp.config.enable_mempool and device.is_mempool_supported:
+                self.core.cuda_device_set_mempool_enabled(i, 1)
+
         # set default device
-        if cuda_device_count > 0:
-            if self.core.cuda_context_get_current() is not None:
+        if self.cuda_devices:
+            current_context = self.core.cuda_context_get_current()
+            if current_context is not None and (
+                not self.core.cuda_context_is_primary(current_context)
+                or self.core.cuda_context_get_device_ordinal(current_context) in self.cuda_primary_devices
+            ):
                 self.set_default_device("cuda")
             else:
-                self.set_default_device("cuda:0")
+                self.set_default_device(self.cuda_devices[0])
         else:
             # CUDA not available
             self.set_default_device("cpu")
@@ -2478,6 +3727,12 @@ class Runtime:
         # global tape
         self.tape = None
 
+        # active ScopedKernelProfiler timing CUDA launches, if any
+        self.kernel_profiler = None
+
+        # out-of-bounds accesses of the kernels compiled in "checked" mode
+        self.bounds_checker = BoundsChecker()
+
     def load_dll(self, dll_path):
         try:
             if sys.version_info[0] > 3 or sys.version_info[0] == 3 and sys.version_info[1] >= 8:
@@ -2504,6 +3759,14 @@ class Runtime:
     def set_default_device(self, ident: Devicelike):
         self.default_device = self.get_device(ident)
 
+    def get_primary_cuda_device(self, ordinal):
+        device = self.cuda_primary_devices.get(ordinal)
+        if device is None:
+            raise RuntimeError(
+                f"CUDA device {ordinal} is excluded by wp.config.cuda_visible_devices or WARP_CUDA_DEVICES"
+            )
+        return device
+
     def get_current_cuda_device(self):
         current_context = self.core.cuda_context_get_current()
         if current_context is not None:
@@ -2514,7 +3777,7 @@ class Runtime:
             elif self.core.cuda_context_is_primary(current_context):
                 # this is a primary context that we haven't used yet
                 ordinal = self.core.cuda_context_get_device_ordinal(current_context)
-                device = self.cuda_devices[ordinal]
+                device = self.get_primary_cuda_device(ordinal)
                 self.context_map[current_context] = device
                 return device
             else:
@@ -2563,7 +3826,7 @@ class Runtime:
             # check if this is a primary context (we could get here if it's a device that hasn't been used yet)
             if self.core.cuda_context_is_primary(context):
                 # rename the device
-                device = self.cuda_primary_devices[ordinal]
+                device = self.get_primary_cuda_device(ordinal)
                 return self.rename_device(device, alias)
             else:
                 # create a new Warp device for this context
@@ -2643,7 +3906,7 @@ def get_cuda_device(ordinal: Union[int, None] = None) -> Device:
     if ordinal is None:
         return runtime.get_current_cuda_device()
     else:
-        return runtime.cuda_devices[ordinal]
+        return runtime.get_primary_cuda_device(ordinal)
 
 
 def get_cuda_devices() -> List[Device]:
@@ -2761,6 +4024,34 @@ def wait_stream(stream: Stream, event: Event = None):
     get_stream().wait_stream(stream, event=event)
 
 
+def get_event_elapsed_time(start_event: Event, end_event: Event, synchronize: bool = True) -> float:
+    """Return the GPU time in milliseconds between the recordings of two events.
+
+    Both events must be created with ``enable_timing=True`` on the same device and recorded, ``end_event`` after
+    ``start_event`` in stream order.  The time is measured by the device, so the work between the events doesn't
+    have to be synchronized with the host.
+
+    Args:
+        start_event: Event recorded before the measured work.
+        end_event: Event recorded after the measured work.
+        synchronize: Wait for ``end_event`` to complete, otherwise an error is raised if it hasn't completed yet.
+    """
+
+    if start_event.device != end_event.device:
+        raise RuntimeError(
+            f"Cannot measure the time between events of devices {start_event.device} and {end_event.device}"
+        )
+    if not start_event.enable_timing or not end_event.enable_timing:
+        raise RuntimeError("Events measuring elapsed time must be created with enable_timing=True")
+
+    if synchronize:
+        end_event.synchronize()
+    elif not end_event.query():
+        raise RuntimeError("The end event has not completed yet, the elapsed time is not available")
+
+    return runtime.core.cuda_event_elapsed_time(start_event.cuda_event, end_event.cuda_event)
+
+
 class RegisteredGLBuffer:
     """
     Helper object to register a GL buffer with CUDA so that it can be mapped to a Warp array.
@@ -2819,30 +4110,91 @@ class RegisteredGLBuffer:
         runtime.core.cuda_graphics_unmap(self.context, self.resource)
 
 
-def zeros(
-    shape: Tuple = None,
-    dtype=float,
-    device: Devicelike = None,
-    requires_grad: bool = False,
-    pinned: bool = False,
-    **kwargs,
-) -> warp.array:
-    """Return a zero-initialized array
-
-    Args:
-        shape: Array dimensions
-        dtype: Type of each element, e.g.: warp.vec3, warp.mat33, etc
-        device: Device that array will live on
-        requires_grad: Whether the array will be tracked for back propagation
-        pinned: Whether the array uses pinned host memory (only applicable to CPU arrays)
-
-    Returns:
-        A warp.array object representing the allocation
+class RegisteredGLTexture:
     """
+    Helper object to register a GL texture with CUDA so that its content can be copied to a Warp array
+    without a round trip through host memory or a pixel buffer object.
 
-    arr = empty(shape=shape, dtype=dtype, device=device, requires_grad=requires_grad, pinned=pinned, **kwargs)
+    The texture must have a format that CUDA can map, e.g. ``GL_RGBA8`` or ``GL_R32F``, but not ``GL_RGB8``
+    or depth formats.
+    """
 
-    # use the CUDA default stream for synchronous behaviour with other streams
+    # Same semantics as the RegisteredGLBuffer flags
+    NONE = 0x00
+    READ_ONLY = 0x01
+    WRITE_DISCARD = 0x02
+
+    # GL_TEXTURE_2D
+    TEXTURE_2D = 0x0DE1
+
+    def __init__(
+        self, gl_texture_id: int, device: Devicelike = None, flags: int = READ_ONLY, target: int = TEXTURE_2D
+    ):
+        """Create a new RegisteredGLTexture object.
+
+        Args:
+            gl_texture_id: The OpenGL texture id (GLuint). The texture must be re-registered whenever its storage
+              is reallocated, e.g. after resizing.
+            device: The device to register the texture with.  If None, the current device will be used.
+            flags: A combination of the flags constants.
+            target: The OpenGL texture target (GLenum).
+        """
+        self.gl_texture_id = gl_texture_id
+        self.device = get_device(device)
+        self.context = self.device.context
+        self.resource = runtime.core.cuda_graphics_register_gl_image(self.context, gl_texture_id, target, flags)
+
+    def __del__(self):
+        runtime.core.cuda_graphics_unregister_resource(self.context, self.resource)
+
+    def copy_to(self, dest: warp.array):
+        """Copy the base level of the OpenGL texture to a Warp array on the registration device.
+
+        The first dimension of ``dest`` indexes texture rows, starting at the bottom of the image,
+        and the remaining dimensions must exactly cover one row of texels.
+        The copy is asynchronous with respect to the host and ordered on the current stream.
+
+        Args:
+            dest: Contiguous destination array, e.g. of shape ``(height, width, 4)`` and type ``wp.uint8``
+              for a ``GL_RGBA8`` texture.
+        """
+        if dest.device != self.device:
+            raise RuntimeError(f"Destination array must be on the texture registration device {self.device}")
+        if not dest.is_contiguous:
+            raise RuntimeError("Destination array must be contiguous")
+
+        row_bytes = dest.strides[0]
+        runtime.core.cuda_graphics_map(self.context, self.resource)
+        runtime.core.cuda_graphics_copy_image(
+            self.context, self.resource, dest.ptr, row_bytes, row_bytes, dest.shape[0]
+        )
+        runtime.core.cuda_graphics_unmap(self.context, self.resource)
+
+
+def zeros(
+    shape: Tuple = None,
+    dtype=float,
+    device: Devicelike = None,
+    requires_grad: bool = False,
+    pinned: bool = False,
+    **kwargs,
+) -> warp.array:
+    """Return a zero-initialized array
+
+    Args:
+        shape: Array dimensions
+        dtype: Type of each element, e.g.: warp.vec3, warp.mat33, etc
+        device: Device that array will live on
+        requires_grad: Whether the array will be tracked for back propagation
+        pinned: Whether the array uses pinned host memory (only applicable to CPU arrays)
+
+    Returns:
+        A warp.array object representing the allocation
+    """
+
+    arr = empty(shape=shape, dtype=dtype, device=device, requires_grad=requires_grad, pinned=pinned, **kwargs)
+
+    # use the CUDA default stream for synchronous behaviour with other streams
     with warp.ScopedStream(arr.device.null_stream):
         arr.zero_()
 
@@ -3053,7 +4405,13 @@ def from_numpy(
     shape: Optional[Sequence[int]] = None,
     device: Optional[Devicelike] = None,
     requires_grad: bool = False,
+    copy: bool = True,
 ) -> warp.array:
+    """Creates an array from a NumPy array
+
+    With ``copy=False``, arrays on the CPU refer to the memory of ``arr`` instead of copying it, when its type and
+    layout allow it, and keep ``arr`` alive. Changes made on either side are then visible on the other.
+    """
     if dtype is None:
         base_type = warp.types.np_dtype_to_warp_type.get(arr.dtype)
         if base_type is None:
@@ -3074,6 +4432,7 @@ def from_numpy(
         owner=False,
         device=device,
         requires_grad=requires_grad,
+        copy=copy,
     )
 
 
@@ -3089,7 +4448,8 @@ def pack_arg(kernel, arg_type, arg_name, value, device, adjoint=False):
             # check for array type
             # - in forward passes, array types have to match
             # - in backward passes, indexed array gradients are regular arrays
-            if adjoint:
+            #   and structure of arrays gradients use the same layout
+            if adjoint and not isinstance(arg_type, warp.types.soaarray):
                 array_matches = type(value) == warp.array
             else:
                 array_matches = type(value) == type(arg_type)
@@ -3114,9 +4474,9 @@ def pack_arg(kernel, arg_type, arg_name, value, device, adjoint=False):
                     f"Error launching kernel '{kernel.key}', {adj}argument '{arg_name}' expects an array with {arg_type.ndim} dimension(s) but the passed array has {value.ndim} dimension(s)."
                 )
 
-            # check device
+            # check device, managed arrays are accessible from the host and from all devices
             # if a.device != device and not device.can_access(a.device):
-            if value.device != device:
+            if value.device != device and not getattr(value, "managed", False):
                 raise RuntimeError(
                     f"Error launching kernel '{kernel.key}', trying to launch on device='{device}', but input array for argument '{arg_name}' is on device={value.device}."
                 )
@@ -3125,6 +4485,9 @@ def pack_arg(kernel, arg_type, arg_name, value, device, adjoint=False):
 
     elif isinstance(arg_type, warp.codegen.Struct):
         assert value is not None
+        # CUDA kernels read large structs from device memory, see select_param_buffer_args() in codegen.py
+        if device.is_cuda and arg_name in kernel.adj.param_buffer_args:
+            return value._param_buffer(device)
         return value.__ctype__()
 
     # try to convert to a value type (vec3, mat33, etc)
@@ -3171,8 +4534,119 @@ def pack_arg(kernel, arg_type, arg_name, value, device, adjoint=False):
 
 # represents all data required for a kernel launch
 # so that launches can be replayed quickly, use `wp.launch(..., record_cmd=True)`
+# adjoint launches run the backward kernel, their adjoint params follow the forward ones
+def _launch_bounds(dim, max_dim, device):
+    # an array dimension holds the thread count of an indirect launch, read on the device when the kernel runs
+    if not warp.types.is_array(dim):
+        return warp.types.launch_bounds_t(dim)
+
+    if dim.dtype != warp.types.int32 or dim.size < 1:
+        raise RuntimeError("The dimension of an indirect launch must be an int32 array holding the thread count")
+
+    if dim.device != device:
+        raise RuntimeError(
+            f"The dimension of an indirect launch is on device {dim.device} but the launch targets {device}"
+        )
+
+    if max_dim is None:
+        raise RuntimeError("Indirect launches must specify their maximum number of threads with max_dim")
+
+    return warp.types.launch_bounds_t(int(max_dim), size_ptr=dim.ptr)
+
+
+class BoundsChecker:
+    """Reports the out-of-bounds array accesses of the kernels of modules compiled in ``"checked"`` mode.
+
+    Checked kernels record their first out-of-bounds access in a buffer of their device passed with the launch
+    bounds, along with the index of the launch, and replace the index by zero to keep running. The buffer is read
+    back when the device is synchronized, and the launch index traces the access back to its kernel and arguments.
+    """
+
+    # launches remembered per device, the accesses of older launches are reported without their kernel
+    max_launches = 4096
+
+    def __init__(self):
+        self.records = {}
+        self.launches = {}
+        self.launch_count = 0
+
+    def begin_launch(self, kernel, bounds, args, adjoint, device):
+        record = self.records.get(device)
+        if record is None:
+            # layout of bounds_check_t in builtin.h
+            record = zeros(8, dtype=warp.types.uint64, device=device)
+            self.records[device] = record
+
+        self.launch_count += 1
+        bounds.check = record.ptr
+        bounds.launch = self.launch_count
+
+        arrays = []
+        for arg, value in zip(kernel.adj.args, args):
+            BoundsChecker._collect_arrays(arg.label, value, arrays)
+
+        launches = self.launches.setdefault(device, {})
+        launches[self.launch_count] = (kernel.key, adjoint, arrays)
+        if len(launches) > BoundsChecker.max_launches:
+            del launches[next(iter(launches))]
+
+    @staticmethod
+    def _collect_arrays(name, value, arrays):
+        # memory ranges of the arrays held by an argument, only their addresses are kept
+        if isinstance(value, warp.codegen.StructInstance):
+            for field in value._cls.vars:
+                BoundsChecker._collect_arrays(f"{name}.{field}", getattr(value, field), arrays)
+        elif isinstance(value, warp.types.indexedarray):
+            BoundsChecker._collect_arrays(name, value.data, arrays)
+        elif isinstance(value, warp.types.array) and value.ptr:
+            arrays.append((name, value.ptr, value.ptr + max(value.capacity or 0, 1)))
+            if value.grad is not None and value.grad.ptr:
+                arrays.append((f"{name}.grad", value.grad.ptr, value.grad.ptr + max(value.grad.capacity or 0, 1)))
+
+    def report(self, device=None):
+        """Raises an error describing the first out-of-bounds access recorded on a device, or on any device if None,
+        since the last report. The device must be synchronized."""
+
+        for d in list(self.records.keys()) if device is None else [device]:
+            record = self.records.get(d)
+            if record is None:
+                continue
+
+            values = [int(v) for v in record.numpy()]
+            if values[0] == 0:
+                continue
+
+            record.zero_()
+            raise RuntimeError(self._describe(d, values))
+
+    def _describe(self, device, values):
+        count, launch, tid, data = values[:4]
+        # signed fields of the record
+        dim, index, shape = (v - (1 << 64) if v >= (1 << 63) else v for v in values[4:7])
+
+        kernel = "an unknown kernel"
+        arrays = []
+        info = self.launches.get(device, {}).get(launch)
+        if info is not None:
+            key, adjoint, arrays = info
+            kernel = f"the backward pass of kernel '{key}'" if adjoint else f"kernel '{key}'"
+
+        if data == 0:
+            target = f"hash grid cell coordinate {index} along axis {dim} past the guard region of {shape} cells"
+        else:
+            name = next((n for n, begin, end in arrays if begin <= data < end), None)
+            array = f"array '{name}'" if name is not None else f"the array at 0x{data:x}"
+            target = f"index {index} of dimension {dim} of size {shape} of {array}"
+
+        message = f"Out-of-bounds access in {kernel} on device {device}, thread {tid}: {target}"
+        if count > 1:
+            message += f" ({count - 1} more out-of-bounds accesses since the last report)"
+
+        return message
+
+
 class Launch:
-    def __init__(self, kernel, device, hooks=None, params=None, params_addr=None, bounds=None):
+    def __init__(self, kernel, device, hooks=None, params=None, params_addr=None, bounds=None, adjoint=False):
         # if not specified look up hooks
         if not hooks:
             module = kernel.module
@@ -3185,6 +4659,9 @@ class Launch:
         if not bounds:
             bounds = warp.types.launch_bounds_t(0)
 
+            if kernel.module.options["mode"] == "checked":
+                runtime.bounds_checker.begin_launch(kernel, bounds, [], adjoint, device)
+
         # if not specified then build a list of default value params for args
         if not params:
             params = []
@@ -3194,10 +4671,23 @@ class Launch:
                 if isinstance(a.type, warp.types.array):
                     params.append(a.type.__ctype__())
                 elif isinstance(a.type, warp.codegen.Struct):
-                    params.append(a.type().__ctype__())
+                    params.append(pack_arg(kernel, a.type, a.label, a.type(), device, False))
                 else:
                     params.append(pack_arg(kernel, a.type, a.label, 0, device, False))
 
+            if adjoint:
+                # indexed array gradients are regular arrays
+                for a in kernel.adj.args:
+                    if warp.types.is_array(a.type):
+                        params.append(warp.types.array_t())
+                    elif isinstance(a.type, warp.codegen.Struct):
+                        params.append(pack_arg(kernel, a.type, a.label, a.type(), device, True))
+                    else:
+                        params.append(pack_arg(kernel, a.type, a.label, 0, device, True))
+
+            if kernel.adj.store_intermediates:
+                params.append(ctypes.c_uint64(0))
+
             kernel_args = [ctypes.c_void_p(ctypes.addressof(x)) for x in params]
             kernel_params = (ctypes.c_void_p * len(kernel_args))(*kernel_args)
 
@@ -3209,9 +4699,15 @@ class Launch:
         self.params_addr = params_addr
         self.device = device
         self.bounds = bounds
+        self.adjoint = adjoint
 
-    def set_dim(self, dim):
-        self.bounds = warp.types.launch_bounds_t(dim)
+    def set_dim(self, dim, max_dim=None):
+        bounds = _launch_bounds(dim, max_dim, self.device)
+
+        # checked launches keep their out-of-bounds access record
+        bounds.check = self.bounds.check
+        bounds.launch = self.bounds.launch
+        self.bounds = bounds
 
         # launch bounds always at index 0
         self.params[0] = self.bounds
@@ -3221,11 +4717,13 @@ class Launch:
             self.params_addr[0] = ctypes.c_void_p(ctypes.addressof(self.bounds))
 
     # set kernel param at an index, will convert to ctype as necessary
+    # the adjoint params of adjoint launches follow at indices offset by the number of kernel args
     def set_param_at_index(self, index, value):
-        arg_type = self.kernel.adj.args[index].type
-        arg_name = self.kernel.adj.args[index].label
+        num_args = len(self.kernel.adj.args)
+        arg_type = self.kernel.adj.args[index % num_args].type
+        arg_name = self.kernel.adj.args[index % num_args].label
 
-        carg = pack_arg(self.kernel, arg_type, arg_name, value, self.device, False)
+        carg = pack_arg(self.kernel, arg_type, arg_name, value, self.device, index >= num_args)
 
         self.params[index + 1] = carg
 
@@ -3270,11 +4768,218 @@ class Launch:
         for i, v in enumerate(values):
             self.set_param_at_index_from_ctype(i, v)
 
+    # the native kernel entry point and its block dimension
+    @property
+    def kernel_hook(self):
+        return self.hooks.backward if self.adjoint else self.hooks.forward
+
+    @property
+    def block_dim(self):
+        return self.hooks.backward_block_dim if self.adjoint else self.hooks.forward_block_dim
+
+    def update_param_buffers(self):
+        """Uploads the struct arguments read from device memory that have changed since they were last passed"""
+        for param in self.params:
+            struct = getattr(param, "struct", None)
+            if struct is not None:
+                param.value = struct._param_buffer(self.device).value
+
     def launch(self) -> Any:
+        # recorded launches refresh the solid angle data of meshes just like launch()
+        if self.kernel.adj.uses_winding_number:
+            warp.types.Mesh._update_winding_numbers(self.device)
+
+        if self.device.is_cpu:
+            self.kernel_hook(*self.params)
+        else:
+            self.update_param_buffers()
+            runtime.core.cuda_launch_kernel(
+                self.device.context, self.kernel_hook, self.bounds.size, self.block_dim, self.params_addr
+            )
+
+
+class CommandList:
+    """A sequence of recorded kernel launches that are submitted together.
+
+    On CUDA devices all launches of the list are issued by a single call into the native library, which avoids
+    the argument packing and the per-launch call overhead of :func:`launch`. The parameters and dimensions of the
+    recorded :class:`Launch` objects may be changed in place between submissions with their ``set_param_*`` and
+    ``set_dim`` methods.
+
+    Example
+    -------
+
+    .. code-block:: python
+
+        cmds = wp.CommandList()
+        for i in range(100):
+            cmds.append(wp.launch(kernel, dim=n, inputs=[a, b], record_cmd=True))
+
+        for step in range(1000):
+            cmds.submit()
+
+    Lists of many small launches may instead be submitted as a single launch of a persistent kernel with
+    ``persistent=True``. The kernel runs the launches one after the other, spreading the threads of each one over
+    all the resident blocks of the device and waiting for every block to finish it before starting the next one,
+    which removes the launch gaps between them. All launches must be forward launches of kernels from one module
+    compiled with ``wp.set_module_options({"persistent": True})``, and kernels using tiles, storing
+    intermediates or reading their thread index other than through their own ``wp.tid()`` calls, e.g.: in user
+    functions calling ``wp.tid()``, are not supported.
+    """
+
+    def __init__(self, launches=None, persistent=False):
+        self.launches = []
+        self.device = None
+        self.persistent = persistent
+
+        # native arrays of kernels, block sizes and parameter address arrays, rebuilt when launches are added
+        self.kernels = None
+        self.block_dims = None
+        self.args = None
+
+        # task table and packed launch parameters of the persistent kernel in device memory, the pinned
+        # staging buffer they are uploaded from, and the event of the last upload guarding the staging buffer
+        self.task_data = None
+        self.task_staging = None
+        self.task_upload = None
+        self.task_packed = None
+        self.task_barrier = None
+        self.captured_task_data = []
+
+        for launch in launches or []:
+            self.append(launch)
+
+    def __len__(self):
+        return len(self.launches)
+
+    def append(self, launch: Launch):
+        if self.device is None:
+            self.device = launch.device
+        elif launch.device != self.device:
+            raise RuntimeError("All launches of a command list must target the same device")
+
+        if self.persistent:
+            if not launch.device.is_cuda or launch.adjoint:
+                raise RuntimeError("Persistent command lists only run forward launches on CUDA devices")
+            if self.launches and launch.kernel.module is not self.launches[0].kernel.module:
+                raise RuntimeError("All launches of a persistent command list must use kernels of the same module")
+            if not warp.codegen.is_persistent_task(launch.kernel):
+                raise RuntimeError(
+                    f"Kernel '{launch.kernel.key}' uses tiles, intermediates or the thread index of the launch grid "
+                    "outside of its tid() calls and can't run in a persistent kernel"
+                )
+
+        self.launches.append(launch)
+        self.kernels = None
+        self.task_data = None
+
+    def submit(self, stream: Stream = None):
+        """Issues the recorded launches in order on ``stream``, or on the current stream of the device."""
+
+        if not self.launches:
+            return
+
+        if any(launch.kernel.adj.uses_winding_number for launch in self.launches):
+            warp.types.Mesh._update_winding_numbers(self.device)
+
         if self.device.is_cpu:
-            self.hooks.forward(*self.params)
+            for launch in self.launches:
+                launch.launch()
+            return
+
+        for launch in self.launches:
+            launch.update_param_buffers()
+
+        if self.persistent:
+            if stream is not None:
+                with warp.ScopedStream(stream):
+                    self._submit_persistent()
+            else:
+                self._submit_persistent()
+            return
+
+        if self.kernels is None:
+            count = len(self.launches)
+            self.kernels = (ctypes.c_void_p * count)(*[launch.kernel_hook for launch in self.launches])
+            self.block_dims = (ctypes.c_int * count)(*[launch.block_dim or 0 for launch in self.launches])
+            self.args = (ctypes.c_void_p * count)(
+                *[ctypes.cast(launch.params_addr, ctypes.c_void_p) for launch in self.launches]
+            )
+
+        count = len(self.launches)
+        if stream is not None:
+            with warp.ScopedStream(stream):
+                runtime.core.cuda_launch_kernels(self.device.context, self.kernels, self.block_dims, self.args, count)
+        else:
+            runtime.core.cuda_launch_kernels(self.device.context, self.kernels, self.block_dims, self.args, count)
+
+    def _pack_tasks(self, data_ptr):
+        # a task table entry (kernel index, padding, parameters address) per launch, followed by the launch bounds and
+        # arguments of each launch padded to 8 bytes like persistent_param() in builtin.h expects
+        module = self.launches[0].kernel.module
+        indices = {k.get_mangled_name(): i for i, k in enumerate(module.get_persistent_kernels())}
+
+        table = bytearray()
+        params = bytearray()
+        offset = 16 * len(self.launches)
+
+        for launch in self.launches:
+            table += bytes(ctypes.c_int32(indices[launch.kernel.get_mangled_name()])) + bytes(4)
+            table += bytes(ctypes.c_uint64(data_ptr + offset + len(params)))
+            for p in launch.params:
+                size = ctypes.sizeof(p)
+                params += ctypes.string_at(ctypes.addressof(p), size)
+                params += bytes((8 - size % 8) % 8)
+
+        return bytes(table + params)
+
+    def _submit_persistent(self):
+        device = self.device
+        module = self.launches[0].kernel.module
+        kernel = module.get_persistent_kernel(device)
+
+        if self.task_barrier is None:
+            self.task_barrier = warp.empty(1, dtype=warp.uint32, device=device)
+
+        # the parameters are read at submission, the upload is skipped when none of them changed
+        if device.is_capturing or self.task_data is None:
+            size = len(self._pack_tasks(0))
         else:
-            runtime.core.cuda_launch_kernel(self.device.context, self.hooks.forward, self.bounds.size, self.params_addr)
+            size = self.task_data.size
+
+        if device.is_capturing:
+            # captured graphs keep reading the buffers they were captured with
+            task_data = warp.empty(size, dtype=warp.uint8, device=device)
+            staging = warp.empty(size, dtype=warp.uint8, device="cpu", pinned=True)
+            packed = self._pack_tasks(task_data.ptr)
+            ctypes.memmove(staging.ptr, packed, size)
+            warp.copy(task_data, staging)
+            self.captured_task_data.append((task_data, staging))
+
+        else:
+            if self.task_data is None:
+                self.task_data = warp.empty(size, dtype=warp.uint8, device=device)
+                self.task_staging = warp.empty(size, dtype=warp.uint8, device="cpu", pinned=True)
+                self.task_packed = None
+
+            task_data = self.task_data
+            packed = self._pack_tasks(task_data.ptr)
+            if packed != self.task_packed:
+                # the previous upload may still be reading the staging buffer
+                if self.task_upload is not None:
+                    self.task_upload.synchronize()
+
+                ctypes.memmove(self.task_staging.ptr, packed, size)
+                warp.copy(task_data, self.task_staging)
+                self.task_upload = warp.record_event(self.task_upload)
+                self.task_packed = packed
+
+        max_dim = max(launch.bounds.size for launch in self.launches)
+        res = runtime.core.cuda_launch_persistent_kernel(
+            device.context, kernel, task_data.ptr, len(self.launches), self.task_barrier.ptr, max_dim
+        )
+        if res:
+            raise RuntimeError(f"Failed to launch the persistent kernel of module '{module.name}' (CUDA error {res})")
 
 
 def launch(
@@ -3289,11 +4994,18 @@ def launch(
     adjoint=False,
     record_tape=True,
     record_cmd=False,
+    intermediates=None,
+    max_dim: int = None,
 ):
     """Launch a Warp kernel on the target device
 
     Kernel launches are asynchronous with respect to the calling Python thread.
 
+    The number of threads of a 1D launch may also be determined on the device: when ``dim`` is an int32 array the
+    kernel is launched for ``max_dim`` threads and those past the count stored in ``dim[0]`` return immediately.
+    The count is read when the kernel runs, so it may be written by a previous kernel of the same stream or graph
+    without synchronizing with the host.
+
     Args:
         kernel: The name of a Warp kernel function, decorated with the ``@wp.kernel`` decorator
         dim: The number of threads to launch the kernel, can be an integer, or a Tuple of ints with max of 4 dimensions
@@ -3306,6 +5018,9 @@ def launch(
         adjoint: Whether to run forward or backward pass (typically use False)
         record_tape: When true the launch will be recorded the global wp.Tape() object when present
         record_cmd: When True the launch will be returned as a ``Launch`` command object, the launch will not occur until the user calls ``cmd.launch()``
+        intermediates: The buffer of intermediates stored by the forward launch of a kernel compiled with ``store_intermediates``,
+            allocated by the launch when recording on a tape, and passed to the backward launch so that it reloads them (optional)
+        max_dim: The maximum number of threads of an indirect launch, required when ``dim`` is an array (optional)
     """
 
     assert_initialized()
@@ -3320,12 +5035,17 @@ def launch(
     if isinstance(kernel, Kernel) is False:
         raise RuntimeError("Error launching kernel, can only launch functions decorated with @wp.kernel.")
 
+    # array expressions are evaluated into temporary arrays by their fused kernels
+    if any(isinstance(a, warp.expression.ArrayExpression) for a in list(inputs) + list(outputs)):
+        inputs = [a.eval() if isinstance(a, warp.expression.ArrayExpression) else a for a in inputs]
+        outputs = [a.eval() if isinstance(a, warp.expression.ArrayExpression) else a for a in outputs]
+
     # debugging aid
     if warp.config.print_launches:
         print(f"kernel: {kernel.key} dim: {dim} inputs: {inputs} outputs: {outputs} device: {device}")
 
     # construct launch bounds
-    bounds = warp.types.launch_bounds_t(dim)
+    bounds = _launch_bounds(dim, max_dim, device)
 
     if bounds.size > 0:
         # first param is the number of threads
@@ -3353,6 +5073,10 @@ def launch(
             fwd_types = kernel.infer_argument_types(fwd_args)
             kernel = kernel.get_overload(fwd_types)
 
+        # kernels specialized on argument values are compiled for each combination of values they are launched with
+        if kernel.specialize:
+            kernel = kernel.get_specialization(fwd_args)
+
         # delay load modules, including new overload if needed
         module = kernel.module
         if not module.load(device):
@@ -3361,8 +5085,29 @@ def launch(
         # late bind
         hooks = module.get_kernel_hooks(kernel, device)
 
-        pack_args(fwd_args, params)
-        pack_args(adj_args, params, adjoint=True)
+        # the solid angle data of meshes is only computed once a kernel queries winding numbers
+        if kernel.adj.uses_winding_number:
+            warp.types.Mesh._update_winding_numbers(device)
+
+        if module.options["mode"] == "checked":
+            runtime.bounds_checker.begin_launch(kernel, bounds, fwd_args, adjoint, device)
+
+        # struct arguments uploaded to device memory are copied on the stream of the launch
+        with warp.ScopedStream(stream):
+            pack_args(fwd_args, params)
+            pack_args(adj_args, params, adjoint=True)
+
+        if kernel.adj.store_intermediates:
+            size = kernel.adj.intermediates_size * bounds.size
+            if intermediates is None and size and not adjoint and runtime.tape and record_tape and not record_cmd:
+                intermediates = empty(size, dtype=warp.types.uint8, device=device)
+
+            if intermediates is not None and intermediates.size < size:
+                raise RuntimeError(
+                    f"Error launching kernel '{kernel.key}', the buffer of intermediates holds {intermediates.size} bytes but the launch stores {size}"
+                )
+
+            params.append(ctypes.c_uint64(intermediates.ptr if intermediates is not None else 0))
 
         # run kernel
         if device.is_cpu:
@@ -3392,6 +5137,22 @@ def launch(
             kernel_args = [ctypes.c_void_p(ctypes.addressof(x)) for x in params]
             kernel_params = (ctypes.c_void_p * len(kernel_args))(*kernel_args)
 
+            # the threads of a block load tiles together, so tile kernels must be launched on whole blocks
+            if kernel.adj.uses_tiles:
+                if bounds.size_ptr:
+                    raise RuntimeError(f"Kernel '{kernel.key}' uses tiles and does not support indirect launches")
+
+                block_dim = hooks.backward_block_dim if adjoint else hooks.forward_block_dim
+                if block_dim and bounds.size % block_dim:
+                    raise RuntimeError(
+                        f"Kernel '{kernel.key}' uses tiles and must be launched with a size that is a multiple of its block_dim ({block_dim}), got {bounds.size}"
+                    )
+
+            # launches on automatic streams are ordered by the arrays they use
+            auto_streams = device.auto_streams if stream is None and not record_cmd else None
+            if auto_streams is not None:
+                stream = auto_streams.begin_launch(kernel, fwd_args, adj_args, adjoint, bounds, intermediates)
+
             with warp.ScopedStream(stream):
                 if adjoint:
                     if hooks.backward is None:
@@ -3399,7 +5160,16 @@ def launch(
                             f"Failed to find backward kernel '{kernel.key}' from module '{kernel.module.name}' for device '{device}'"
                         )
 
-                    runtime.core.cuda_launch_kernel(device.context, hooks.backward, bounds.size, kernel_params)
+                    profiler = runtime.kernel_profiler
+                    if profiler is not None:
+                        record = profiler.begin(kernel, device, dim, fwd_args, adjoint=True)
+
+                    runtime.core.cuda_launch_kernel(
+                        device.context, hooks.backward, bounds.size, hooks.backward_block_dim, kernel_params
+                    )
+
+                    if profiler is not None:
+                        profiler.end(record)
 
                 else:
                     if hooks.forward is None:
@@ -3419,8 +5189,20 @@ def launch(
                         return launch
 
                     else:
+                        profiler = runtime.kernel_profiler
+                        if profiler is not None:
+                            record = profiler.begin(kernel, device, dim, fwd_args, adjoint=False)
+
                         # launch
-                        runtime.core.cuda_launch_kernel(device.context, hooks.forward, bounds.size, kernel_params)
+                        runtime.core.cuda_launch_kernel(
+                            device.context, hooks.forward, bounds.size, hooks.forward_block_dim, kernel_params
+                        )
+
+                        if profiler is not None:
+                            profiler.end(record)
+
+                if auto_streams is not None:
+                    auto_streams.end_launch(stream)
 
                 try:
                     runtime.verify_cuda_device(device)
@@ -3430,7 +5212,304 @@ def launch(
 
     # record on tape if one is active
     if runtime.tape and record_tape:
-        runtime.tape.record_launch(kernel, dim, inputs, outputs, device)
+        runtime.tape.record_launch(kernel, dim, inputs, outputs, device, intermediates, max_dim)
+
+
+def _jvp_components(value):
+    # float32 components of a scalar, vector or matrix value, row by row
+    if hasattr(value, "__len__"):
+        return [c for v in value for c in _jvp_components(v)]
+    return [float(value)]
+
+
+def jvp(
+    kernel,
+    dim: Tuple[int],
+    inputs: List,
+    outputs: List = [],
+    tangents: Dict[str, Any] = None,
+    device: Devicelike = None,
+    stream: Stream = None,
+):
+    """Launch a Warp kernel in forward mode, propagating tangents of its float32 arguments to its outputs
+
+    The kernel is evaluated on dual numbers that carry ``forward_mode_width`` tangents of each float32 value, so that
+    a single launch computes the Jacobian-vector products for that many directions. The kernel, or its module, must
+    be compiled with a nonzero ``forward_mode_width`` option, more directions are evaluated by successive launches.
+    It is much cheaper than the reverse mode when a kernel has few inputs and many outputs, and does not require
+    storing intermediate values anywhere.
+
+    Only the float32 values, including the components of vectors and matrices and the elements of arrays, carry
+    tangents. Kernels taking or using structs, using tiles, or calling builtins that don't support dual numbers
+    can't be launched in forward mode, the launch raises an error with the reason. The launch is not recorded on
+    tapes.
+
+    Args:
+        kernel: The Warp kernel to launch, decorated with ``@wp.kernel``
+        dim: The number of threads to launch the kernel, an integer or a tuple of ints
+        inputs: The input parameters to the kernel
+        outputs: The output parameters (optional)
+        tangents: Maps argument names to the tangents of their values, each holding a leading dimension with one
+            entry per direction. Arrays take tangents of shape ``(directions,) + array.shape`` and the same dtype,
+            values take sequences of ``directions`` values. Missing arguments have zero tangents (optional)
+        device: The device to launch on (optional)
+        stream: The stream to launch on (optional)
+
+    Returns:
+        A dictionary mapping the names of the float32 output arrays to arrays of shape
+        ``(directions,) + array.shape`` holding their tangents. The outputs also receive the values of the launch.
+    """
+
+    assert_initialized()
+
+    from warp.utils import _jvp_float_view, _jvp_pack_kernel, _jvp_unpack_kernel
+
+    if stream is not None:
+        device = stream.device
+    else:
+        device = runtime.get_device(device)
+
+    if isinstance(kernel, Kernel) is False:
+        raise RuntimeError("Error launching kernel, can only launch functions decorated with @wp.kernel.")
+
+    fwd_args = list(inputs) + list(outputs)
+    if len(fwd_args) != len(kernel.adj.args):
+        raise RuntimeError(
+            f"Error launching kernel '{kernel.key}', passed {len(fwd_args)} arguments but kernel requires {len(kernel.adj.args)}."
+        )
+
+    if kernel.is_generic:
+        kernel = kernel.get_overload(kernel.infer_argument_types(fwd_args))
+
+    if kernel.specialize:
+        kernel = kernel.get_specialization(fwd_args)
+
+    module = kernel.module
+    if not module.load(device):
+        return
+
+    width = warp.codegen.tangent_width(kernel, module.options)
+    if not width:
+        if kernel.adj.tangent_error:
+            raise RuntimeError(f"Kernel '{kernel.key}' can't be launched in forward mode, it {kernel.adj.tangent_error}")
+        raise RuntimeError(
+            f"Kernel '{kernel.key}' has no forward-mode entry point, compile it with the forward_mode_width option"
+        )
+
+    hooks = module.get_kernel_hooks(kernel, device)
+    if hooks.jvp is None:
+        raise RuntimeError(f"Failed to find forward-mode kernel '{kernel.key}' for device '{device}'")
+
+    tangents = tangents or {}
+    names = [a.label for a in kernel.adj.args]
+    for name in tangents:
+        if name not in names:
+            raise RuntimeError(f"Error launching kernel '{kernel.key}', it has no argument named '{name}'")
+
+    # number of directions, from the leading dimension of the tangents
+    directions = None
+    for name, t in tangents.items():
+        count = t.shape[0] if warp.types.is_array(t) else len(t)
+        if directions is not None and count != directions:
+            raise RuntimeError(
+                f"Error launching kernel '{kernel.key}', the tangents of '{name}' hold {count} directions but others hold {directions}"
+            )
+        directions = count
+
+    if not directions:
+        return {}
+
+    bounds = warp.types.launch_bounds_t(dim)
+    output_names = set(names[len(inputs) :])
+
+    # float32 arrays are copied to dual buffers that kernels access through views with strides scaled accordingly
+    duals = {}
+    results = {}
+    for i, arg in enumerate(kernel.adj.args):
+        value = fwd_args[i]
+        if not warp.types.is_array(arg.type) or value is None or not warp.codegen.carries_tangent(arg.type):
+            continue
+
+        if not value.is_contiguous:
+            value = clone(value)
+
+        flat = _jvp_float_view(value) if value.size else None
+        dual = empty(value.size * warp.types.type_length(value.dtype) * (width + 1), dtype=float, device=device)
+
+        tangent = tangents.get(arg.label)
+        if tangent is not None:
+            if tangent.shape != (directions,) + value.shape or not warp.types.types_equal(tangent.dtype, value.dtype):
+                raise RuntimeError(
+                    f"Error launching kernel '{kernel.key}', the tangents of argument '{arg.label}' must be an array of shape {(directions,) + value.shape} and dtype {type_str(value.dtype)}"
+                )
+            if not tangent.is_contiguous:
+                tangent = clone(tangent)
+
+        view = warp.array(
+            ptr=dual.ptr,
+            dtype=value.dtype,
+            shape=value.shape,
+            strides=tuple(s * (width + 1) for s in value.strides),
+            capacity=dual.capacity,
+            device=device,
+            owner=False,
+        )
+
+        duals[i] = (value, flat, tangent, dual, view)
+
+        if arg.label in output_names:
+            results[arg.label] = zeros((directions,) + value.shape, dtype=value.dtype, device=device)
+
+    def pack_values(first, count):
+        params = [bounds]
+        for i, arg in enumerate(kernel.adj.args):
+            value = fwd_args[i]
+
+            if i in duals:
+                params.append(pack_arg(kernel, arg.type, arg.label, duals[i][4], device))
+
+            elif arg.type is warp.types.float32 or (
+                hasattr(arg.type, "_wp_generic_type_str_") and warp.codegen.carries_tangent(arg.type)
+            ):
+                # interleave the components of value types with their tangents
+                components = _jvp_components(value)
+                tangent = tangents.get(arg.label)
+                packed = (ctypes.c_float * (len(components) * (width + 1)))()
+                for k in range(count if tangent is not None else 0):
+                    direction = _jvp_components(tangent[first + k])
+                    if len(direction) != len(components):
+                        raise RuntimeError(
+                            f"Error launching kernel '{kernel.key}', the tangents of argument '{arg.label}' must hold {len(components)} values per direction"
+                        )
+                    for c, t in enumerate(direction):
+                        packed[c * (width + 1) + 1 + k] = t
+                for c, v in enumerate(components):
+                    packed[c * (width + 1)] = v
+                params.append(packed)
+
+            else:
+                params.append(pack_arg(kernel, arg.type, arg.label, value, device))
+
+        return params
+
+    first = 0
+    while first < directions:
+        count = min(width, directions - first)
+
+        for value, flat, tangent, dual, _view in duals.values():
+            if flat is not None:
+                tangent_flat = _jvp_float_view(tangent) if tangent is not None else empty(0, dtype=float, device=device)
+                launch(
+                    _jvp_pack_kernel,
+                    dim=flat.size,
+                    inputs=[flat, tangent_flat, first, count, width],
+                    outputs=[dual],
+                    device=device,
+                    stream=stream,
+                    record_tape=False,
+                )
+
+        params = pack_values(first, count)
+
+        if bounds.size > 0:
+            if device.is_cpu:
+                # value types are passed to the CPU entry point by pointer
+                hooks.jvp(*[ctypes.byref(p) if isinstance(p, ctypes.Array) else p for p in params])
+            else:
+                kernel_args = [ctypes.c_void_p(ctypes.addressof(x)) for x in params]
+                kernel_params = (ctypes.c_void_p * len(kernel_args))(*kernel_args)
+
+                with warp.ScopedStream(stream):
+                    runtime.core.cuda_launch_kernel(
+                        device.context, hooks.jvp, bounds.size, hooks.forward_block_dim, kernel_params
+                    )
+
+        # read back the values and the tangents of the outputs
+        for i, (value, flat, tangent, dual, _view) in duals.items():
+            name = kernel.adj.args[i].label
+            if name in results and flat is not None:
+                launch(
+                    _jvp_unpack_kernel,
+                    dim=flat.size,
+                    inputs=[dual, first, count, width],
+                    outputs=[flat, _jvp_float_view(results[name])],
+                    device=device,
+                    stream=stream,
+                    record_tape=False,
+                )
+
+        first += count
+
+    # outputs that were cloned to be contiguous receive their values back
+    for i, (value, flat, tangent, dual, _view) in duals.items():
+        if kernel.adj.args[i].label in results and value is not fwd_args[i]:
+            copy(fwd_args[i], value, stream=stream)
+
+    return results
+
+
+def launch_multi(
+    kernel,
+    dims: List,
+    inputs: List[List],
+    devices: List[Devicelike],
+    outputs: List[List] = None,
+    record_tape=True,
+):
+    """Launch a Warp kernel on several devices at once, e.g. the shards of a data-parallel step
+
+    The launches for all CUDA devices are enqueued by a single native call on each device's current stream,
+    so the devices run concurrently without a round-trip through Python per device.
+
+    Args:
+        kernel: The Warp kernel to launch
+        dims: The launch dimensions for each device
+        inputs: The input parameters for each device, arrays must reside on their launch's device
+        devices: The devices to launch on
+        outputs: The output parameters for each device (optional)
+        record_tape: When true the launches will be recorded the global wp.Tape() object when present
+    """
+
+    assert_initialized()
+
+    if outputs is None:
+        outputs = [[]] * len(devices)
+
+    if not (len(dims) == len(inputs) == len(outputs) == len(devices)):
+        raise RuntimeError(
+            f"Error launching kernel '{kernel.key}' on multiple devices, expected the dims, inputs and outputs of {len(devices)} devices"
+        )
+
+    devices = [runtime.get_device(d) for d in devices]
+
+    # validate and pack the parameters of every device before any launch is made
+    launches = []
+    for dim, device_inputs, device_outputs, device in zip(dims, inputs, outputs, devices):
+        cmd = launch(kernel, dim, device_inputs, device_outputs, device=device, record_tape=False, record_cmd=True)
+        if cmd is not None:
+            launches.append(cmd)
+
+    cpu_launches = [cmd for cmd in launches if cmd.device.is_cpu]
+    cuda_launches = [cmd for cmd in launches if cmd.device.is_cuda]
+
+    if cuda_launches:
+        count = len(cuda_launches)
+        contexts = (ctypes.c_void_p * count)(*[cmd.device.context for cmd in cuda_launches])
+        streams = (ctypes.c_void_p * count)(*[cmd.device.stream.cuda_stream for cmd in cuda_launches])
+        kernels = (ctypes.c_void_p * count)(*[cmd.kernel_hook for cmd in cuda_launches])
+        block_dims = (ctypes.c_int * count)(*[cmd.block_dim or 0 for cmd in cuda_launches])
+        args = (ctypes.c_void_p * count)(*[ctypes.cast(cmd.params_addr, ctypes.c_void_p) for cmd in cuda_launches])
+
+        if runtime.core.cuda_launch_kernels_multi(contexts, streams, kernels, block_dims, args, count):
+            raise RuntimeError(f"Error launching kernel '{kernel.key}' on multiple devices")
+
+    for cmd in cpu_launches:
+        cmd.launch()
+
+    # record on tape if one is active
+    if runtime.tape and record_tape:
+        for dim, device_inputs, device_outputs, device in zip(dims, inputs, outputs, devices):
+            runtime.tape.record_launch(kernel, dim, device_inputs, device_outputs, device)
 
 
 def synchronize():
@@ -3456,6 +5535,8 @@ def synchronize():
         # restore the original context to avoid side effects
         runtime.core.cuda_context_set_current(saved_context)
 
+    runtime.bounds_checker.report()
+
 
 def synchronize_device(device: Devicelike = None):
     """Manually synchronize the calling CPU thread with any outstanding CUDA work on the specified device
@@ -3474,6 +5555,231 @@ def synchronize_device(device: Devicelike = None):
 
         runtime.core.cuda_context_synchronize(device.context)
 
+    runtime.bounds_checker.report(device)
+
+
+def set_mempool_enabled(device: Devicelike, enable: bool):
+    """Enable or disable stream-ordered pool allocations for all arrays on a CUDA device.
+
+    Pool allocations are made from the device's default ``cudaMemPool_t`` on the current stream.
+    They do not synchronize the device and are permitted during graph capture.
+    Memory that was allocated before the mode changed is still freed correctly.
+
+    Args:
+        device: The CUDA device.  If None, the current CUDA device is used.
+        enable: True to allocate arrays from the memory pool, False to use ``cudaMalloc()``.
+    """
+
+    device = runtime.get_device(device)
+    if not device.is_cuda:
+        raise RuntimeError(f"Memory pools are only supported on CUDA devices, got {device}")
+
+    if enable and not device.is_mempool_supported:
+        raise RuntimeError(f"Device {device} does not support stream-ordered memory pools")
+
+    if not runtime.core.cuda_device_set_mempool_enabled(device.ordinal, int(enable)):
+        raise RuntimeError(f"Failed to configure the memory pool on device {device}")
+
+
+# native callback signatures of custom device allocators
+DeviceAllocFunc = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p)
+DeviceFreeFunc = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p)
+
+
+def set_allocator(device: Devicelike, allocator):
+    """Allocate the memory of arrays and other Warp objects on a CUDA device with a custom allocator.
+
+    This lets Warp share the memory of another framework, e.g. the PyTorch caching allocator
+    through :class:`warp.torch.TorchAllocator`, instead of reserving its own.
+    The allocator must provide the following methods, where ``stream`` is the handle of the CUDA stream
+    the memory is allocated or freed on:
+
+    - ``alloc(size_in_bytes, stream)`` returns the address of a new allocation, or 0 on failure.
+    - ``free(ptr, stream)`` releases an allocation.
+
+    Memory that was allocated before the allocator changed is still freed by the allocator that made it.
+    Temporary buffers used internally by some operations are not allocated through the custom allocator.
+
+    Args:
+        device: The CUDA device.  If None, the current CUDA device is used.
+        allocator: The allocator object, or None to restore the default allocator.
+    """
+
+    device = runtime.get_device(device)
+    if not device.is_cuda:
+        raise RuntimeError(f"Custom allocators are only supported on CUDA devices, got {device}")
+
+    if allocator is None:
+        runtime.core.cuda_context_set_allocator(device.context, None, None)
+        device.custom_allocator = None
+        return
+
+    def alloc_func(size, stream):
+        try:
+            return allocator.alloc(size, stream or 0) or None
+        except Exception as e:
+            print(f"Warp error: Custom allocator failed on device {device}: {e}")
+            return None
+
+    def free_func(ptr, stream):
+        try:
+            allocator.free(ptr, stream or 0)
+        except Exception as e:
+            print(f"Warp error: Custom allocator failed on device {device}: {e}")
+
+    callbacks = (DeviceAllocFunc(alloc_func), DeviceFreeFunc(free_func))
+    device._allocator_callbacks.append(callbacks)
+
+    runtime.core.cuda_context_set_allocator(device.context, *callbacks)
+    device.custom_allocator = allocator
+
+
+def get_allocator(device: Devicelike):
+    """Returns the custom allocator set with :func:`set_allocator` on a device, or None if it uses the default allocator."""
+
+    return runtime.get_device(device).custom_allocator
+
+
+def is_mempool_enabled(device: Devicelike) -> bool:
+    """Returns True if arrays on the given CUDA device are allocated from a stream-ordered memory pool."""
+
+    return runtime.get_device(device).is_mempool_enabled
+
+
+def set_mempool_release_threshold(device: Devicelike, threshold: int):
+    """Set the amount of reserved memory in bytes the device's memory pool holds on to before releasing it to the OS.
+
+    Freed memory above the threshold is released at the next synchronization point.
+    A large threshold avoids repeatedly returning and re-acquiring memory for transient arrays.
+
+    Args:
+        device: The CUDA device.  If None, the current CUDA device is used.
+        threshold: The release threshold in bytes.
+    """
+
+    device = runtime.get_device(device)
+    if not device.is_cuda or not device.is_mempool_supported:
+        raise RuntimeError(f"Device {device} does not support stream-ordered memory pools")
+
+    if not runtime.core.cuda_device_set_mempool_release_threshold(device.ordinal, threshold):
+        raise RuntimeError(f"Failed to set the memory pool release threshold on device {device}")
+
+
+def get_mempool_release_threshold(device: Devicelike) -> int:
+    """Returns the release threshold in bytes of the device's memory pool."""
+
+    device = runtime.get_device(device)
+    if not device.is_cuda or not device.is_mempool_supported:
+        raise RuntimeError(f"Device {device} does not support stream-ordered memory pools")
+
+    return runtime.core.cuda_device_get_mempool_release_threshold(device.ordinal)
+
+
+def get_mempool_stats(device: Devicelike) -> dict:
+    """Returns the memory usage of the device's memory pool in bytes.
+
+    The result contains the ``used_current``, ``used_high``, ``reserved_current``, and ``reserved_high`` entries,
+    where the ``high`` entries are the peak values since the pool was created.
+    """
+
+    device = runtime.get_device(device)
+    if not device.is_cuda or not device.is_mempool_supported:
+        raise RuntimeError(f"Device {device} does not support stream-ordered memory pools")
+
+    stats = [ctypes.c_uint64(0) for _ in range(4)]
+    if not runtime.core.cuda_device_get_mempool_stats(device.ordinal, *[ctypes.byref(s) for s in stats]):
+        raise RuntimeError(f"Failed to query the memory pool on device {device}")
+
+    keys = ("used_current", "used_high", "reserved_current", "reserved_high")
+    return {k: s.value for k, s in zip(keys, stats)}
+
+
+def get_pinned_pool_stats() -> dict:
+    """Returns the memory usage of the pinned host memory pool in bytes.
+
+    Pinned allocations are rounded up to size classes and freed blocks are kept for reuse instead of being
+    returned with ``cudaFreeHost()``.  The result contains the ``used_current``, ``used_high``, ``reserved_current``,
+    and ``reserved_high`` entries, where the ``high`` entries are the peak values since Warp was initialized.
+    """
+
+    stats = [ctypes.c_uint64(0) for _ in range(4)]
+    runtime.core.pinned_pool_get_stats(*[ctypes.byref(s) for s in stats])
+
+    keys = ("used_current", "used_high", "reserved_current", "reserved_high")
+    return {k: s.value for k, s in zip(keys, stats)}
+
+
+def release_pinned_pool():
+    """Return the free blocks of the pinned host memory pool to the OS, waiting for transfers that still use them."""
+
+    runtime.core.pinned_pool_release()
+
+
+# memory spaces of the native allocation accounting, CUDA devices use their ordinal
+MEMORY_SPACE_HOST = -1
+MEMORY_SPACE_PINNED = -2
+MEMORY_HISTOGRAM_BINS = 48
+
+
+def _memory_space(device, pinned):
+    if pinned:
+        return MEMORY_SPACE_PINNED
+
+    device = get_device(device)
+    return device.ordinal if device.is_cuda else MEMORY_SPACE_HOST
+
+
+def _memory_counters(space, tag):
+    current = ctypes.c_uint64(0)
+    peak = ctypes.c_uint64(0)
+    count = ctypes.c_uint64(0)
+    histogram = (ctypes.c_uint64 * MEMORY_HISTOGRAM_BINS)()
+    counters = [ctypes.byref(current), ctypes.byref(peak), ctypes.byref(count), histogram]
+    if not runtime.core.memory_stats_get(space, tag, *counters):
+        return None
+
+    # live allocations by the upper bound of their size class
+    sizes = {1 << b: n for b, n in enumerate(histogram) if n > 0}
+    return {
+        "current": current.value,
+        "peak": peak.value,
+        "count": count.value,
+        "live": sum(sizes.values()),
+        "histogram": sizes,
+    }
+
+
+def get_memory_stats(device: Devicelike = None, pinned: bool = False) -> dict:
+    """Returns the accounting of the memory allocated by Warp on a device, in bytes.
+
+    Every allocation of the native allocators is counted, including the temporary buffers of sorts, sparse matrix
+    operations, and volume builds.  The result contains the ``current`` and ``peak`` bytes in use, the ``count`` of
+    allocations made, the number of ``live`` allocations, and a ``histogram`` of the live allocations by the upper
+    bound of their power-of-two size class.  The ``tags`` entry holds the same statistics for each
+    :class:`ScopedMemoryTag` name that allocated on the device, the untagged memory is listed under ``""``.
+
+    Args:
+        device: The device to query, CPU devices report the system memory allocated by Warp.
+        pinned: Query the pinned host memory instead of ``device``.
+    """
+
+    space = _memory_space(device, pinned)
+
+    stats = _memory_counters(space, -1) or {"current": 0, "peak": 0, "count": 0, "live": 0, "histogram": {}}
+    stats["tags"] = {}
+    for tag in range(runtime.core.memory_tag_count()):
+        counters = _memory_counters(space, tag)
+        if counters is not None:
+            stats["tags"][runtime.core.memory_tag_name(tag).decode("utf-8")] = counters
+
+    return stats
+
+
+def reset_memory_peak(device: Devicelike = None, pinned: bool = False):
+    """Resets the ``peak`` values reported by :func:`get_memory_stats` to the memory currently in use."""
+
+    runtime.core.memory_stats_reset_peak(_memory_space(device, pinned))
+
 
 def synchronize_stream(stream_or_device=None):
     """Manually synchronize the calling CPU thread with any outstanding CUDA work on the specified stream.
@@ -3489,12 +5795,105 @@ def synchronize_stream(stream_or_device=None):
 
     runtime.core.cuda_stream_synchronize(stream.device.context, stream.cuda_stream)
 
+    runtime.bounds_checker.report(stream.device)
+
+
+def compile_cuda_modules(modules: List[Module], devices: List[Device]):
+    """Compile the CUDA binaries of the given modules for the given devices on a pool of worker threads.
+
+    Code generation runs serially on the calling thread, while NVRTC compilation of independent
+    modules and architectures runs concurrently.  Binaries that are already in the kernel cache are skipped.
+    The compiled modules are not loaded, this is left to :meth:`Module.load`.
+    """
+
+    from concurrent.futures import ThreadPoolExecutor
+
+    if not devices or warp.config.llvm_cuda:
+        return
+
+    max_threads = warp.config.max_compile_threads or os.cpu_count() or 1
+    if max_threads <= 1:
+        return
+
+    # gather unique outputs that need to be built, several devices may share the same architecture
+    jobs = {}
+    for m in modules:
+        if m.cuda_build_failed:
+            continue
+
+        module_hash = None
+        cu_source = None
+        for d in devices:
+            if d.context in m.cuda_modules:
+                continue
+
+            output_arch, output_path = m.get_cuda_output(d)
+            if output_path in jobs:
+                continue
+
+            if module_hash is None:
+                module_hash = m.hash_module()
+            cuda_hash_path = os.path.splitext(output_path)[0] + ".hash"
+            if m.is_cuda_output_cached(output_path, module_hash) or warp.build.fetch_shared_cache_entry(
+                output_path, cuda_hash_path, module_hash, m.get_metadata_path()
+            ):
+                continue
+
+            if cu_source is None:
+                cu_source = ModuleBuilder(m, m.options).codegen("cuda")
+                m.save_kernel_metadata(module_hash)
+            jobs[output_path] = (m, cu_source, output_arch, module_hash)
+
+    if len(jobs) < 2:
+        return
+
+    from warp.utils import ScopedTimer
+
+    # with precompiled headers, compile one module per configuration first so that
+    # the remaining modules reuse its header instead of racing to create it
+    waves = [list(jobs.items())]
+    if warp.build.is_nvrtc_pch_enabled():
+        seen = set()
+        first, rest = [], []
+        for job in jobs.items():
+            m, _, output_arch, _ = job[1]
+            key = (output_arch, m.options["mode"], m.options["fast_math"])
+            (rest if key in seen else first).append(job)
+            seen.add(key)
+        waves = [first, rest]
+
+    futures = {}
+    with ScopedTimer(f"Compile {len(jobs)} CUDA modules", active=not warp.config.quiet):
+        with ThreadPoolExecutor(max_workers=min(max_threads, len(jobs))) as executor:
+            for wave in waves:
+                wave_futures = {
+                    executor.submit(m.compile_cuda, cu_source, output_arch, output_path, module_hash): m
+                    for output_path, (m, cu_source, output_arch, module_hash) in wave
+                }
+                # wait for the wave to finish
+                for future in wave_futures:
+                    future.exception()
+                futures.update(wave_futures)
+
+        # report the first failure, the modules are not retried on load
+        error = None
+        for future, m in futures.items():
+            e = future.exception()
+            if e is not None:
+                m.cuda_build_failed = True
+                if error is None:
+                    error = e
+
+        if error is not None:
+            raise error
+
 
 def force_load(device: Union[Device, str] = None, modules: List[Module] = None):
     """Force user-defined kernels to be compiled and loaded
 
     Args:
-        device: The device or list of devices to load the modules on.  If None, load on all devices.
+        device: The device or list of devices to load the modules on.  If None, load on the CPU, the default device
+            and the CUDA devices that are already in use, other devices load modules on their first launch.
         modules: List of modules to load.  If None, load all imported modules.
     """
 
@@ -3503,13 +5902,17 @@ def force_load(device: Union[Device, str] = None, modules: List[Module] = None):
         saved_context = runtime.core.cuda_context_get_current()
 
     if device is None:
-        devices = get_devices()
+        # loading on an unused device would retain its primary context
+        devices = [d for d in get_devices() if d.is_cpu or d.has_context or d == runtime.default_device]
     else:
         devices = [get_device(device)]
 
     if modules is None:
         modules = user_modules.values()
 
+    # build missing CUDA binaries concurrently before loading them
+    compile_cuda_modules(modules, [d for d in devices if d.is_cuda])
+
     for d in devices:
         for m in modules:
             m.load(d)
@@ -3519,8 +5922,62 @@ def force_load(device: Union[Device, str] = None, modules: List[Module] = None):
         runtime.core.cuda_context_set_current(saved_context)
 
 
+# worker thread of force_load_async() and a flag telling Module.load() it runs on that worker
+_async_load_executor = None
+_async_load_state = threading.local()
+
+
+def _force_load_worker(device, modules):
+    _async_load_state.active = True
+    try:
+        force_load(device=device, modules=modules)
+    finally:
+        _async_load_state.active = False
+
+
+def force_load_async(device: Union[Device, str] = None, modules: List[Module] = None) -> concurrent.futures.Future:
+    """Compile and load user-defined kernels on a background thread
+
+    Returns immediately with a future that completes once the modules are loaded, and re-raises any compilation error
+    from its ``result()``. Launching a kernel of a module that is still loading waits for the background load to finish
+    rather than compiling the module again, so applications that must not block can poll ``future.done()`` first.
+    Modules must not be modified, e.g. by defining new kernels, while they are loading.
+
+    Args:
+        device: The device or list of devices to load the modules on.  If None, load on the same devices as
+            :func:`force_load`.
+        modules: List of modules to load.  If None, load all imported modules.
+    """
+
+    global _async_load_executor
+
+    if modules is None:
+        modules = list(user_modules.values())
+
+    # loads are serialized on a single worker, each one compiles its CUDA modules concurrently
+    if _async_load_executor is None:
+        _async_load_executor = concurrent.futures.ThreadPoolExecutor(max_workers=1, thread_name_prefix="warp_load")
+
+    future = _async_load_executor.submit(_force_load_worker, device, modules)
+
+    for m in modules:
+        m.pending_load = future
+
+    def clear_pending(f):
+        for m in modules:
+            if m.pending_load is f:
+                m.pending_load = None
+
+    future.add_done_callback(clear_pending)
+
+    return future
+
+
 def load_module(
-    module: Union[Module, ModuleType, str] = None, device: Union[Device, str] = None, recursive: bool = False
+    module: Union[Module, ModuleType, str] = None,
+    device: Union[Device, str] = None,
+    recursive: bool = False,
+    asynchronous: bool = False,
 ):
     """Force user-defined module to be compiled and loaded
 
@@ -3528,6 +5985,10 @@ def load_module(
         module: The module to load.  If None, load the current module.
         device: The device to load the modules on.  If None, load on all devices.
         recursive: Whether to load submodules.  E.g., if the given module is `warp.sim`, this will also load `warp.sim.model`, `warp.sim.articulation`, etc.
+        asynchronous: Whether to load the modules on a background thread, see :func:`force_load_async()`.
+
+    Returns:
+        A future of the background load if ``asynchronous`` is True, otherwise None
 
     Note: A module must be imported before it can be loaded by this function.
     """
@@ -3559,8 +6020,144 @@ def load_module(
             if name.startswith(prefix):
                 modules.append(mod)
 
+    if asynchronous:
+        return force_load_async(device=device, modules=modules)
+
+    force_load(device=device, modules=modules)
+
+
+_BUNDLE_MAGIC = b"WPBUNDLE1\n"
+
+
+def _bundle_kernel_layouts(module: Module):
+    # argument layouts of all concrete kernels, generic and specialized kernels contribute their instances
+    layouts = {}
+    for kernel in module.kernels.values():
+        for k in kernel.get_instances():
+            layouts[k.get_mangled_name()] = [[arg.label, arg.ctype()] for arg in k.adj.args]
+    return layouts
+
+
+def save_module_bundle(path: str, modules: List[Module] = None, device: Devicelike = None):
+    """Write the compiled CUDA binaries of modules to a single bundle file for ahead-of-time deployment
+
+    The modules are compiled for ``device`` if needed. The bundle stores the PTX, CUBIN, or fatbin of each module along
+    with the argument layouts of its kernels, and can be loaded with :func:`load_module_bundle()` without code
+    generation, hashing, or compilation.
+
+    Args:
+        path: The bundle file to write
+        modules: The modules to bundle. If None, bundle all imported modules with kernels.
+        device: The CUDA device to compile for, defaults to the current CUDA device. Use fat binaries
+            (see ``warp.config.cuda_fatbin_archs``) to bundle binaries that load on several architectures.
+    """
+
+    import json
+
+    device = runtime.get_device(device)
+    if not device.is_cuda:
+        raise RuntimeError("Module bundles contain CUDA binaries and must be built for a CUDA device")
+
+    if modules is None:
+        modules = [m for m in user_modules.values() if m.kernels]
+
     force_load(device=device, modules=modules)
 
+    header = []
+    blobs = []
+    offset = 0
+    for m in modules:
+        _, output_path = m.get_cuda_output(device)
+        with open(output_path, "rb") as f:
+            blob = f.read()
+
+        header.append(
+            {
+                "name": m.name,
+                "ptx": output_path.endswith(".ptx"),
+                "offset": offset,
+                "size": len(blob),
+                "kernels": _bundle_kernel_layouts(m),
+                "launch": m.get_kernel_metadata(),
+            }
+        )
+        blobs.append(blob)
+        offset += len(blob)
+
+    header_bytes = json.dumps({"arch": device.arch, "modules": header}).encode("utf-8")
+
+    with open(path, "wb") as f:
+        f.write(_BUNDLE_MAGIC)
+        f.write(len(header_bytes).to_bytes(8, "little"))
+        f.write(header_bytes)
+        for blob in blobs:
+            f.write(blob)
+
+
+def load_module_bundle(path: str, device: Devicelike = None):
+    """Load the CUDA binaries of a bundle written by :func:`save_module_bundle()`
+
+    Each bundled module is loaded directly into the matching imported module, whose kernels then launch without
+    code generation, hashing, or compilation. The kernels must still be defined (imported), and their argument
+    layouts are checked against the ones recorded in the bundle to reject stale bundles.
+
+    Args:
+        path: The bundle file to load
+        device: The CUDA device to load the modules on, defaults to the current CUDA device
+
+    Returns:
+        The list of modules loaded from the bundle
+    """
+
+    import json
+
+    device = runtime.get_device(device)
+    if not device.is_cuda:
+        raise RuntimeError("Module bundles contain CUDA binaries and can only be loaded on a CUDA device")
+
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if not data.startswith(_BUNDLE_MAGIC):
+        raise RuntimeError(f"File '{path}' is not a Warp module bundle")
+
+    start = len(_BUNDLE_MAGIC)
+    header_size = int.from_bytes(data[start : start + 8], "little")
+    header = json.loads(data[start + 8 : start + 8 + header_size].decode("utf-8"))
+    data_start = start + 8 + header_size
+
+    loaded = []
+    for entry in header["modules"]:
+        m = user_modules.get(entry["name"])
+        if m is None:
+            raise RuntimeError(f"Bundled module '{entry['name']}' has not been imported")
+
+        # the bundle must contain every imported kernel with the layout it is launched with,
+        # overloads of generic kernels that are only instantiated later are looked up by name on their first launch
+        for name, layout in _bundle_kernel_layouts(m).items():
+            if entry["kernels"].get(name) != layout:
+                raise RuntimeError(
+                    f"Bundled module '{entry['name']}' does not match kernel '{name}' of the imported module"
+                )
+
+        if device.context in m.cuda_modules:
+            continue
+
+        # bundles written before the launch properties were recorded need the kernels to be generated again
+        if not m.set_kernel_metadata(entry.get("launch", {})):
+            ModuleBuilder(m, m.options)
+
+        begin = data_start + entry["offset"]
+        blob = data[begin : begin + entry["size"]]
+        cuda_module = runtime.core.cuda_load_module_data(device.context, blob, len(blob), entry["ptx"])
+        if cuda_module is None:
+            raise RuntimeError(f"Failed to load bundled module '{entry['name']}' on device {device}")
+
+        m.cuda_modules[device.context] = cuda_module
+        loaded.append(m)
+
+    return loaded
+
 
 def set_module_options(options: Dict[str, Any], module: Optional[Any] = None):
     """Set options for the current module.
@@ -3568,8 +6165,30 @@ def set_module_options(options: Dict[str, Any], module: Optional[Any] = None):
     Options can be used to control runtime compilation and code-generation
     for the current module individually. Available options are listed below.
 
-    * **mode**: The compilation mode to use, can be "debug", or "release", defaults to the value of ``warp.config.mode``.
+    * **mode**: The compilation mode to use, can be "debug", "release", or "checked" for release builds reporting
+      out-of-bounds array accesses when the device is synchronized, defaults to the value of ``warp.config.mode``.
     * **max_unroll**: The maximum fixed-size loop to unroll (default 16)
+    * **fast_math**: Compile CUDA code with ``--use_fast_math`` and evaluate ``sin()``, ``cos()``, and ``exp()`` with their approximations
+      ``sin_approx()``, ``cos_approx()``, and ``exp_approx()`` on all devices (default False). Kernels can override the latter with
+      ``@wp.kernel(fast_math=...)``, e.g.: to only approximate the math of hot kernels.
+    * **block_dim**: The number of CUDA threads per block, or "auto" to use the block size that maximizes occupancy as reported by the driver (default 256).
+      Kernels can override it with ``@wp.kernel(block_dim=...)``. Kernels calling ``wp.dense_gemm_batched()`` rely on the default of 256.
+    * **enable_cpu_parallel**: Run CPU launches of this module's kernels on a thread pool, defaults to the value of ``warp.config.enable_cpu_parallel``.
+      Atomics become thread-safe in this mode, but the order in which threads accumulate (e.g.: adjoints in the backward pass) is not deterministic.
+    * **bvh_stack_size**: The traversal stack depth used by BVH and mesh queries (default 64). Queries on trees deeper than the stack
+      fall back to a slower traversal that follows parent links, so smaller stacks trade speed on deep trees for lower register usage.
+    * **bvh_stackless**: Traverse BVHs by following parent links instead of using a stack (default False).
+    * **lto**: Compile the module to LTO-IR and link it into a CUBIN with nvJitLink link-time optimization (requires CUDA 12.4+),
+      defaults to the value of ``warp.config.cuda_lto``. Fat binaries (``warp.config.cuda_fatbin_archs``) take precedence.
+    * **optimize_codegen**: Share repeated evaluations of pure builtins (e.g.: math functions and operators) with the same
+      arguments and remove the ones whose results are unused from the generated code, defaults to the value of ``warp.config.optimize_codegen``.
+    * **store_intermediates**: Store the results of the function calls, other than arithmetic and array accesses, made by the forward
+      launches of kernels recorded on a :class:`Tape` so that their backward launches reload them instead of evaluating the calls
+      again (default False). Kernels can override it with ``@wp.kernel(store_intermediates=...)``.
+    * **cpu_simd_width**: Run the forward pass of CPU kernels on this many consecutive threads at once, e.g.: 4 or 8, in a
+      loop vectorized across the SIMD lanes of the CPU (default 0, one thread at a time). Only kernels free of dynamic loops, early
+      returns, and builtins other than math and array accesses are vectorized, the others run unchanged.
+      Kernels can override it with ``@wp.kernel(cpu_simd_width=...)``.
 
     Args:
 
@@ -3595,17 +6214,23 @@ def get_module_options(module: Optional[Any] = None) -> Dict[str, Any]:
     return get_module(m.__name__).options
 
 
-def capture_begin(device: Devicelike = None, stream=None, force_module_load=True):
+def capture_begin(device: Devicelike = None, stream=None, force_module_load=True, peers=None):
     """Begin capture of a CUDA graph
 
     Captures all subsequent kernel launches and memory operations on CUDA devices.
     This can be used to record large numbers of kernels and replay them with low-overhead.
 
+    The capture may span several devices: the current streams of the ``peers`` devices, or the given streams, wait
+    for the capturing stream and their work is captured into the same graph until :func:`~warp.capture_end()`.
+    The order between streams is expressed with events as outside of captures, e.g.: with :func:`~warp.wait_stream()`
+    before a peer copy, and becomes dependencies between the nodes of the graph, which is launched with one call.
+
     Args:
 
         device: The device to capture on, if None the current CUDA device will be used
         stream: The CUDA stream to capture on
         force_module_load: Whether or not to force loading of all kernels before capture, in general it is better to use :func:`~warp.load_module()` to selectively load kernels.
+        peers: Other CUDA devices or streams whose work is captured into the same graph (optional)
 
     """
 
@@ -3619,14 +6244,50 @@ def capture_begin(device: Devicelike = None, stream=None, force_module_load=True
         if not device.is_cuda:
             raise RuntimeError("Must be a CUDA device")
 
+    origin = stream if stream is not None else device.stream
+
+    peer_streams = []
+    for peer in peers or []:
+        peer_stream = peer if isinstance(peer, Stream) else runtime.get_device(peer).stream
+        if peer_stream.cuda_stream == origin.cuda_stream:
+            raise RuntimeError(f"The capturing stream of device {device} cannot also be a peer of the capture")
+        if peer_stream.device.is_capturing:
+            raise RuntimeError(f"Cannot join device {peer_stream.device} to a capture, it is already capturing")
+        peer_streams.append(peer_stream)
+
     if force_module_load:
         force_load(device)
+        for peer_stream in peer_streams:
+            force_load(peer_stream.device)
+
+    # events are created before the capture, which records them as dependencies between streams
+    device.capture_peers = [(s, Event(s.device)) for s in peer_streams]
+    fork = Event(device)
 
     device.is_capturing = True
 
     with warp.ScopedStream(stream):
         runtime.core.cuda_graph_begin_capture(device.context)
 
+    # streams waiting for an event recorded during a capture join it
+    origin.record_event(fork)
+    for peer_stream, _ in device.capture_peers:
+        peer_stream.wait_event(fork)
+        peer_stream.device.is_capturing = True
+
+
+def _capture_join_peers(device: Device, stream):
+    # the capture only ends once every stream that joined it has been joined back by the capturing stream
+    origin = stream if stream is not None else device.stream
+    for peer_stream, join in device.capture_peers:
+        origin.wait_event(peer_stream.record_event(join))
+
+
+def _capture_release_peers(device: Device):
+    for peer_stream, _ in device.capture_peers:
+        peer_stream.device.is_capturing = False
+    device.capture_peers = []
+
 
 def capture_end(device: Devicelike = None, stream=None) -> Graph:
     """Ends the capture of a CUDA graph
@@ -3642,10 +6303,13 @@ def capture_end(device: Devicelike = None, stream=None) -> Graph:
         if not device.is_cuda:
             raise RuntimeError("Must be a CUDA device")
 
+    _capture_join_peers(device, stream)
+
     with warp.ScopedStream(stream):
         graph = runtime.core.cuda_graph_end_capture(device.context)
 
     device.is_capturing = False
+    _capture_release_peers(device)
 
     if graph is None:
         raise RuntimeError(
@@ -3655,6 +6319,156 @@ def capture_end(device: Devicelike = None, stream=None) -> Graph:
         return Graph(device, graph)
 
 
+def capture_update(graph: Graph, stream: Stream = None) -> Graph:
+    """Ends a capture started with :func:`~warp.capture_begin()` and uses it to update an existing CUDA graph
+
+    When the new capture has the same topology as ``graph`` and only differs in kernel arguments, launch dimensions
+    or memory operation parameters, the executable graph is patched in place, which is much cheaper than
+    instantiating a new graph. Otherwise ``graph`` is transparently re-instantiated from the new capture.
+
+    Args:
+        graph: A Graph as returned by :func:`~warp.capture_end()`, updated in place
+        stream: The CUDA stream the capture was started on (optional)
+
+    Returns:
+        The updated graph
+    """
+
+    if stream is not None:
+        if stream.device != graph.device:
+            raise RuntimeError(f"Cannot update graph from device {graph.device} with a capture on device {stream.device}")
+
+    device = graph.device
+
+    _capture_join_peers(device, stream)
+
+    with warp.ScopedStream(stream):
+        exec = runtime.core.cuda_graph_end_capture_update(device.context, graph.exec)
+
+    device.is_capturing = False
+    _capture_release_peers(device)
+
+    if exec is None:
+        raise RuntimeError(
+            "Error occurred during CUDA graph capture. This could be due to an unintended allocation or CPU/GPU synchronization event."
+        )
+
+    graph.exec = exec
+    return graph
+
+
+def is_conditional_graph_supported() -> bool:
+    """Returns whether captured graphs can contain conditional nodes, which requires CUDA 12.4 or newer"""
+
+    return is_cuda_available() and runtime.toolkit_version >= 12040 and runtime.driver_version >= 12040
+
+
+def _check_condition(condition: warp.array):
+    if condition.dtype != warp.int32 or condition.size < 1:
+        raise RuntimeError("The condition must be an int32 array with at least one element")
+
+
+def _capture_conditional(device: Device, handle, condition: warp.array, loop: bool, body, kwargs):
+    graph = ctypes.c_void_p()
+    node = ctypes.c_void_p()
+    if not runtime.core.cuda_graph_begin_conditional(
+        device.context, handle, loop, ctypes.byref(graph), ctypes.byref(node)
+    ):
+        raise RuntimeError("Failed to insert a conditional node into the captured graph")
+
+    # work recorded by the body lands in the body graph of the conditional node
+    if body is not None:
+        body(**kwargs)
+
+    if not runtime.core.cuda_graph_end_conditional(device.context, handle, condition.ptr, loop, graph, node):
+        raise RuntimeError("Failed to resume the graph capture after a conditional node")
+
+
+def capture_if(condition: warp.array, on_true=None, on_false=None, **kwargs):
+    """Runs ``on_true`` or ``on_false`` depending on the device-side value of ``condition[0]``
+
+    During a CUDA graph capture the branches are inserted as conditional nodes whose condition is read on the device
+    each time the graph is launched, the host never synchronizes with the device. Outside of a capture the condition is
+    read back to the host and the selected branch is called directly.
+
+    Args:
+        condition: An int32 array, the first element selects ``on_true`` when non-zero and ``on_false`` otherwise
+        on_true: Callable recording the work of the true branch (optional)
+        on_false: Callable recording the work of the false branch (optional)
+        kwargs: Keyword arguments forwarded to the branches
+    """
+
+    _check_condition(condition)
+
+    device = condition.device
+
+    if not device.is_capturing:
+        branch = on_true if condition.numpy()[0] else on_false
+        if branch is not None:
+            branch(**kwargs)
+        return
+
+    if not is_conditional_graph_supported():
+        raise RuntimeError("Conditional graph nodes require CUDA 12.4 or newer")
+
+    # both handles are set before either branch runs, so a branch may modify the condition
+    branches = []
+    for body, invert in ((on_true, False), (on_false, True)):
+        if body is not None:
+            handle = ctypes.c_uint64()
+            if not runtime.core.cuda_graph_create_conditional(
+                device.context, condition.ptr, invert, ctypes.byref(handle)
+            ):
+                raise RuntimeError("Failed to create a conditional handle in the captured graph")
+            branches.append((handle, body))
+
+    for handle, body in branches:
+        _capture_conditional(device, handle, condition, False, body, kwargs)
+
+
+def capture_while(condition: warp.array, while_body, max_iterations: int = None, **kwargs):
+    """Repeats ``while_body`` as long as the device-side value of ``condition[0]`` is non-zero
+
+    The body is expected to update ``condition``, e.g. from a convergence test in a kernel. During a CUDA graph capture
+    the loop is inserted as a conditional while node that is evaluated on the device, so iterative solvers can terminate
+    without host round trips. Outside of a capture the condition is read back to the host after each iteration.
+
+    When conditional nodes are not supported (CUDA < 12.4) and ``max_iterations`` is given, the capture falls back to
+    ``max_iterations`` copies of the body, whose kernels should then early-exit once ``condition[0]`` is zero.
+
+    Args:
+        condition: An int32 array, the loop continues while its first element is non-zero
+        while_body: Callable recording the work of one iteration
+        max_iterations: Iteration count of the unrolled fallback for captures without conditional node support
+        kwargs: Keyword arguments forwarded to ``while_body``
+    """
+
+    _check_condition(condition)
+
+    device = condition.device
+
+    if not device.is_capturing:
+        while condition.numpy()[0]:
+            while_body(**kwargs)
+        return
+
+    if not is_conditional_graph_supported():
+        if max_iterations is None:
+            raise RuntimeError(
+                "Conditional graph nodes require CUDA 12.4 or newer, pass max_iterations to unroll the loop"
+            )
+
+        for _ in range(max_iterations):
+            while_body(**kwargs)
+        return
+
+    handle = ctypes.c_uint64()
+    if not runtime.core.cuda_graph_create_conditional(device.context, condition.ptr, False, ctypes.byref(handle)):
+        raise RuntimeError("Failed to create a conditional handle in the captured graph")
+
+    _capture_conditional(device, handle, condition, True, while_body, kwargs)
+
+
 def capture_launch(graph: Graph, stream: Stream = None):
     """Launch a previously captured CUDA graph
 
@@ -3692,6 +6506,18 @@ def copy(
     if not warp.types.is_array(src) or not warp.types.is_array(dest):
         raise RuntimeError("Copy source and destination must be arrays")
 
+    # arrays of vectors stored as component planes are copied through strided views of their components
+    if isinstance(src, warp.types.soaarray) or isinstance(dest, warp.types.soaarray):
+        if dest_offset or src_offset or count not in (0, src.size):
+            raise RuntimeError("Copies to or from structure of arrays must copy the whole array")
+        if src.shape != dest.shape:
+            raise RuntimeError("Incompatible array shapes")
+        if not warp.types.types_equal(src.dtype, dest.dtype):
+            raise RuntimeError("Incompatible array data types")
+
+        copy(warp.types.array_components(dest), warp.types.array_components(src), stream=stream)
+        return
+
     # backwards compatibility, if count is zero then copy entire src array
     if count <= 0:
         count = src.size
@@ -3811,6 +6637,8 @@ def type_str(t):
         return f"Array[{type_str(t.dtype)}]"
     elif isinstance(t, warp.indexedarray):
         return f"IndexedArray[{type_str(t.dtype)}]"
+    elif isinstance(t, warp.soaarray):
+        return f"SoaArray[{type_str(t.dtype)}]"
     elif isinstance(t, warp.fabricarray):
         return f"FabricArray[{type_str(t.dtype)}]"
     elif isinstance(t, warp.indexedfabricarray):
@@ -3835,6 +6663,8 @@ def type_str(t):
         elif generic_type == "transform_t":
             # return f"Transformation"
             return f"Transformation[{type_str(t._wp_scalar_type_)}]"
+        elif generic_type == "topk_heap_t":
+            return f"TopkHeap[{type_str(t._wp_type_params_[0])}]"
         else:
             raise TypeError("Invalid vector or matrix dimensions")
     else:
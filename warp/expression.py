@@ -0,0 +1,339 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import hashlib
+import linecache
+
+import warp
+import warp.types
+
+# builtins evaluated elementwise on arrays, returning values of the type of their arguments
+elementwise_builtins = {
+    "abs",
+    "sign",
+    "sin",
+    "cos",
+    "tan",
+    "asin",
+    "acos",
+    "atan",
+    "atan2",
+    "sinh",
+    "cosh",
+    "tanh",
+    "sqrt",
+    "exp",
+    "log",
+    "log2",
+    "log10",
+    "pow",
+    "floor",
+    "ceil",
+    "round",
+    "rint",
+    "trunc",
+    "frac",
+    "min",
+    "max",
+    "clamp",
+    "lerp",
+    "normalize",
+    "add",
+    "sub",
+    "mul",
+    "div",
+    "neg",
+}
+
+# builtins reducing vectors to their scalar type
+reducing_builtins = {"length", "length_sq", "dot"}
+
+binary_operators = {"add": "+", "sub": "-", "mul": "*", "div": "/", "lt": "<", "le": "<=", "gt": ">", "ge": ">="}
+
+# fused kernels by the source of their expression and the types of their arguments
+_fused_kernels = {}
+
+
+class ArrayExpression:
+    """Lazy elementwise expression on arrays, built by the arithmetic operators of :class:`warp.array` and by
+    calling the elementwise builtins, e.g.: ``wp.sin()``, ``wp.clamp()``, on arrays and expressions.
+
+    Expressions are evaluated by a single kernel generated for the whole expression when they are materialized:
+    by :meth:`eval`, by :meth:`warp.array.assign`, by :meth:`numpy` or when passed to :func:`warp.launch`,
+    without allocating arrays for the intermediate values. The operands must have the same shape and device, Python
+    scalars take the scalar type of the other operand. The fused kernels are recorded on tapes like any other launch.
+    """
+
+    def __init__(self, op, args, dtype, shape=None, device=None):
+        self.op = op
+        self.args = args
+        self.dtype = dtype
+        self.shape = shape
+        self.device = device
+
+    @property
+    def ndim(self):
+        return len(self.shape)
+
+    @staticmethod
+    def wrap(value):
+        # expression node of an operand, constants get their type once combined with the other operands
+        if isinstance(value, ArrayExpression):
+            return value
+        if isinstance(value, warp.types.array):
+            return ArrayExpression("array", [value], value.dtype, value.shape, value.device)
+        if warp.types.is_array(value):
+            raise TypeError(f"Array expressions only support operands of type wp.array, got {type(value)}")
+        if isinstance(value, (bool, int, float)):
+            return ArrayExpression("constant", [value], None)
+        if warp.types.is_value(value):
+            return ArrayExpression("constant", [value], type(value))
+        raise TypeError(f"Unsupported operand of type {type(value)} in an array expression")
+
+    @staticmethod
+    def combine(op, operands, dtype_func):
+        # builds the expression of `op` on the operands, whose shapes and devices must match
+        nodes = [ArrayExpression.wrap(o) for o in operands]
+
+        shape = None
+        device = None
+        for n in nodes:
+            if n.shape is None:
+                continue
+            if shape is not None and n.shape != shape:
+                raise RuntimeError(f"Array expression operands have different shapes {shape} and {n.shape}")
+            if device is not None and n.device != device:
+                raise RuntimeError(f"Array expression operands are on different devices {device} and {n.device}")
+            shape, device = n.shape, n.device
+
+        # Python scalars take the scalar type of the typed operands, or default to float32 and int32
+        typed = [n.dtype for n in nodes if n.dtype is not None]
+        if typed:
+            scalar_type = warp.types.type_scalar_type(typed[0])
+        elif all(isinstance(n.args[0], int) for n in nodes):
+            scalar_type = warp.types.int32
+        else:
+            scalar_type = warp.types.float32
+        nodes = [ArrayExpression("constant", n.args, scalar_type) if n.dtype is None else n for n in nodes]
+
+        dtype = dtype_func([n.dtype for n in nodes])
+        return ArrayExpression(op, nodes, dtype, shape, device)
+
+    @staticmethod
+    def same_dtype(op):
+        def dtype_func(dtypes):
+            for t in dtypes[1:]:
+                if not warp.types.types_equal(t, dtypes[0]):
+                    raise RuntimeError(
+                        f"Array expression '{op}' has operands of types {warp.context.type_str(dtypes[0])} and "
+                        f"{warp.context.type_str(t)}"
+                    )
+            return dtypes[0]
+
+        return dtype_func
+
+    @staticmethod
+    def scaling_dtype(op):
+        # products and quotients of vectors or matrices by scalars
+        def dtype_func(dtypes):
+            a, b = dtypes
+            if warp.types.type_is_vector(a) or warp.types.type_is_matrix(a):
+                if warp.types.types_equal(b, warp.types.type_scalar_type(a)):
+                    return a
+            if op == "mul" and (warp.types.type_is_vector(b) or warp.types.type_is_matrix(b)):
+                if warp.types.types_equal(a, warp.types.type_scalar_type(b)):
+                    return b
+            return ArrayExpression.same_dtype(op)(dtypes)
+
+        return dtype_func
+
+    @staticmethod
+    def comparison_dtype(op):
+        def dtype_func(dtypes):
+            ArrayExpression.same_dtype(op)(dtypes)
+            return warp.types.bool
+
+        return dtype_func
+
+    @staticmethod
+    def reducing_dtype(op):
+        def dtype_func(dtypes):
+            return warp.types.type_scalar_type(ArrayExpression.same_dtype(op)(dtypes))
+
+        return dtype_func
+
+    @staticmethod
+    def lerp_dtype(dtypes):
+        # lerp(a, b, t) interpolates values of the same type by a scalar
+        a, b, t = dtypes
+        ArrayExpression.same_dtype("lerp")([a, b])
+        ArrayExpression.same_dtype("lerp")([warp.types.type_scalar_type(a), t])
+        return a
+
+    @staticmethod
+    def binary(op, a, b):
+        if op in ("mul", "div"):
+            return ArrayExpression.combine(op, [a, b], ArrayExpression.scaling_dtype(op))
+        if op in ("lt", "le", "gt", "ge"):
+            return ArrayExpression.combine(op, [a, b], ArrayExpression.comparison_dtype(op))
+        return ArrayExpression.combine(op, [a, b], ArrayExpression.same_dtype(op))
+
+    @staticmethod
+    def call(key, args):
+        # elementwise builtin called on arrays or expressions
+        if key in binary_operators:
+            return ArrayExpression.binary(key, *args)
+        if key in reducing_builtins:
+            return ArrayExpression.combine(key, args, ArrayExpression.reducing_dtype(key))
+        if key == "lerp":
+            return ArrayExpression.combine(key, args, ArrayExpression.lerp_dtype)
+        if key == "neg":
+            return -ArrayExpression.wrap(args[0])
+        return ArrayExpression.combine(key, args, ArrayExpression.same_dtype(key))
+
+    def __add__(self, y):
+        return ArrayExpression.binary("add", self, y)
+
+    def __radd__(self, x):
+        return ArrayExpression.binary("add", x, self)
+
+    def __sub__(self, y):
+        return ArrayExpression.binary("sub", self, y)
+
+    def __rsub__(self, x):
+        return ArrayExpression.binary("sub", x, self)
+
+    def __mul__(self, y):
+        return ArrayExpression.binary("mul", self, y)
+
+    def __rmul__(self, x):
+        return ArrayExpression.binary("mul", x, self)
+
+    def __truediv__(self, y):
+        return ArrayExpression.binary("div", self, y)
+
+    def __rtruediv__(self, x):
+        return ArrayExpression.binary("div", x, self)
+
+    def __neg__(self):
+        return ArrayExpression("neg", [self], self.dtype, self.shape, self.device)
+
+    def __lt__(self, y):
+        return ArrayExpression.binary("lt", self, y)
+
+    def __le__(self, y):
+        return ArrayExpression.binary("le", self, y)
+
+    def __gt__(self, y):
+        return ArrayExpression.binary("gt", self, y)
+
+    def __ge__(self, y):
+        return ArrayExpression.binary("ge", self, y)
+
+    def codegen(self, params, leaves, index):
+        # Python source of the expression, appending its leaves and the annotations of their kernel parameters
+        if self.op in ("array", "constant"):
+            value = self.args[0]
+            key = id(value) if self.op == "array" else None
+            for i, leaf in enumerate(leaves):
+                if key is not None and id(leaf) == key:
+                    return f"a{i}[{index}]"
+
+            i = len(leaves)
+            leaves.append(value)
+            params.append((f"a{i}", self.dtype, self.op == "array" and self.ndim))
+            return f"a{i}[{index}]" if self.op == "array" else f"a{i}"
+
+        args = [a.codegen(params, leaves, index) for a in self.args]
+        if self.op in binary_operators:
+            return f"({args[0]} {binary_operators[self.op]} {args[1]})"
+        if self.op == "neg":
+            return f"(-{args[0]})"
+        if self.op == "where":
+            return f"wp.select({args[0]}, {args[2]}, {args[1]})"
+        return f"wp.{self.op}({', '.join(args)})"
+
+    def kernel(self):
+        # kernel evaluating the expression into its last argument
+        params = []
+        leaves = []
+        index = ", ".join(f"i{d}" for d in range(self.ndim))
+        body = self.codegen(params, leaves, index)
+
+        types = {}
+        annotations = []
+        for name, dtype, ndim in params:
+            types[f"t_{name}"] = dtype
+            annotations.append(f"{name}: wp.array(dtype=t_{name}, ndim={ndim})" if ndim else f"{name}: t_{name}")
+        types["t_out"] = self.dtype
+        annotations.append(f"out: wp.array(dtype=t_out, ndim={self.ndim})")
+
+        signature = ", ".join(annotations)
+        type_key = ",".join(f"{k}={warp.context.type_str(t)}" for k, t in types.items())
+        digest = hashlib.sha256(f"{signature}|{body}|{type_key}".encode()).hexdigest()[:16]
+
+        kernel = _fused_kernels.get(digest)
+        if kernel is None:
+            name = f"fused_{digest}"
+            source = f"def {name}({signature}):\n    {index} = wp.tid()\n    out[{index}] = {body}\n"
+
+            # the source is registered with linecache so that the code generation can parse it like any other
+            filename = f"<warp.expression {name}>"
+            linecache.cache[filename] = (len(source), None, source.splitlines(True), filename)
+
+            scope = {"wp": warp, "__name__": f"warp.expression.{name}", **types}
+            exec(compile(source, filename, "exec"), scope)
+
+            module = warp.context.get_module(scope["__name__"])
+            kernel = warp.context.Kernel(func=scope[name], key=name, module=module)
+            _fused_kernels[digest] = kernel
+
+        return kernel, leaves
+
+    def eval(self, out=None):
+        """Evaluates the expression with a single kernel launch.
+
+        Args:
+            out: Array receiving the values, with the shape, dtype and device of the expression, allocated if None
+
+        Returns:
+            The array holding the values of the expression
+        """
+        kernel, leaves = self.kernel()
+
+        if out is None:
+            # gradients flow through the result when a tape records the launch
+            requires_grad = any(getattr(a, "requires_grad", False) for a in leaves)
+            out = warp.context.empty(self.shape, dtype=self.dtype, device=self.device, requires_grad=requires_grad)
+        elif out.shape != self.shape or not warp.types.types_equal(out.dtype, self.dtype) or out.device != self.device:
+            raise RuntimeError(
+                f"Array expression of shape {self.shape} and dtype {warp.context.type_str(self.dtype)} on "
+                f"{self.device} can't be assigned to an array of shape {out.shape} and dtype "
+                f"{warp.context.type_str(out.dtype)} on {out.device}"
+            )
+
+        warp.context.launch(kernel, dim=self.shape, inputs=leaves, outputs=[out], device=self.device)
+        return out
+
+    def numpy(self):
+        """Evaluates the expression and returns its values as a NumPy array."""
+        return self.eval().numpy()
+
+    def __repr__(self):
+        return f"ArrayExpression({self.op}, shape={self.shape}, dtype={warp.context.type_str(self.dtype)})"
+
+
+def where(cond, x, y):
+    """Elementwise selection of the values of ``x`` where ``cond`` is true and of ``y`` elsewhere, returning an
+    :class:`ArrayExpression`. In kernels use :func:`warp.select`, which takes its arguments in the reverse order."""
+    expr = ArrayExpression.combine("where", [x, y], ArrayExpression.same_dtype("where"))
+    c = ArrayExpression.wrap(cond)
+    if c.shape is not None and expr.shape is not None and c.shape != expr.shape:
+        raise RuntimeError(f"Array expression operands have different shapes {c.shape} and {expr.shape}")
+    if c.dtype is None:
+        c = ArrayExpression("constant", c.args, warp.types.bool)
+    return ArrayExpression("where", [c] + expr.args, expr.dtype, expr.shape or c.shape, expr.device or c.device)
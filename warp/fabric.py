@@ -26,12 +26,35 @@ class fabricarray_t(ctypes.Structure):
         ("buckets", ctypes.c_void_p),  # array of fabricbucket_t on the correct device
         ("nbuckets", ctypes.c_size_t),
         ("size", ctypes.c_size_t),
+        ("bucket_table", ctypes.c_void_p),  # first bucket of each page of elements, see fabric.h
+        ("table_shift", ctypes.c_size_t),
     ]
 
-    def __init__(self, buckets=None, nbuckets=0, size=0):
+    def __init__(self, buckets=None, nbuckets=0, size=0, bucket_table=None, table_shift=0):
         self.buckets = ctypes.c_void_p(buckets)
         self.nbuckets = nbuckets
         self.size = size
+        self.bucket_table = ctypes.c_void_p(bucket_table)
+        self.table_shift = table_shift
+
+
+def fabric_bucket_table(buckets, size):
+    """Build the page lookup table of fabricarray_t, pages hold about as many elements as an average bucket"""
+
+    num_buckets = len(buckets)
+    table_shift = max(size // num_buckets, 1).bit_length() - 1
+    num_pages = ((size - 1) >> table_shift) + 1
+
+    table = (ctypes.c_uint32 * (num_pages + 1))()
+    b = 0
+    for p in range(num_pages):
+        page_start = p << table_shift
+        while buckets[b].index_end <= page_start:
+            b += 1
+        table[p] = b
+    table[num_pages] = num_buckets - 1
+
+    return table, table_shift
 
 
 class indexedfabricarray_t(ctypes.Structure):
@@ -184,20 +207,35 @@ class fabricarray(noncontiguous_array_base[T]):
                     buckets[i].lengths = array_lengths[i]
                 size += counts[i]
 
+            # arrays with a single bucket need no lookup
+            if num_buckets > 1 and size > 0:
+                bucket_table, table_shift = fabric_bucket_table(buckets, size)
+            else:
+                bucket_table, table_shift = None, 0
+
             if self.device.is_cuda:
                 # copy bucket info to device
                 with warp.ScopedStream(self.device.null_stream):
                     buckets_size = ctypes.sizeof(buckets)
                     buckets_ptr = self.device.allocator.alloc(buckets_size)
                     runtime.core.memcpy_h2d(self.device.context, buckets_ptr, ctypes.addressof(buckets), buckets_size)
+
+                    if bucket_table is not None:
+                        table_size = ctypes.sizeof(bucket_table)
+                        table_ptr = self.device.allocator.alloc(table_size)
+                        runtime.core.memcpy_h2d(self.device.context, table_ptr, ctypes.addressof(bucket_table), table_size)
+                    else:
+                        table_ptr = None
             else:
                 buckets_ptr = ctypes.addressof(buckets)
+                table_ptr = None if bucket_table is None else ctypes.addressof(bucket_table)
 
             self.buckets = buckets
+            self.bucket_table = bucket_table
             self.size = size
             self.shape = (size,)
 
-            self.ctype = fabricarray_t(buckets_ptr, num_buckets, size)
+            self.ctype = fabricarray_t(buckets_ptr, num_buckets, size, table_ptr, table_shift)
 
         else:
             # empty array or type annotation
@@ -206,6 +244,7 @@ class fabricarray(noncontiguous_array_base[T]):
             self.device = None
             self.access = None
             self.buckets = None
+            self.bucket_table = None
             self.size = 0
             self.shape = (0,)
             self.ctype = fabricarray_t()
@@ -216,6 +255,8 @@ class fabricarray(noncontiguous_array_base[T]):
             buckets_size = ctypes.sizeof(self.buckets)
             with self.device.context_guard:
                 self.device.allocator.free(self.ctype.buckets, buckets_size)
+                if self.bucket_table is not None:
+                    self.device.allocator.free(self.ctype.bucket_table, ctypes.sizeof(self.bucket_table))
 
     def __ctype__(self):
         return self.ctype
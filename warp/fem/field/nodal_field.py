@@ -107,6 +107,10 @@ class NodalField(DiscreteField):
     ):
         NODES_PER_ELEMENT = space.NODES_PER_ELEMENT
 
+        factorized_eval_inner = space.make_factorized_eval_inner(EvalArg, read_node_value)
+        if factorized_eval_inner is not None:
+            return factorized_eval_inner
+
         def eval_inner(args: EvalArg, s: Sample):
             res = space.element_inner_weight(args.space_arg, s.element_index, s.element_coords, 0) * read_node_value(
                 args, s.element_index, 0
@@ -131,6 +135,10 @@ class NodalField(DiscreteField):
             # There is no Warp high-order tensor type to represent matrix gradients
             return None
 
+        factorized_eval_grad_inner = space.make_factorized_eval_grad_inner(EvalArg, read_node_value)
+        if factorized_eval_grad_inner is not None:
+            return factorized_eval_grad_inner
+
         def eval_grad_inner(args: EvalArg, s: Sample):
             res = utils.generalized_outer(
                 space.element_inner_weight_gradient(args.space_arg, s.element_index, s.element_coords, 0),
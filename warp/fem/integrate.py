@@ -1,4 +1,4 @@
-from typing import List, Dict, Set, Optional, Any, Union
+from typing import List, Dict, Set, Optional, Any, Union, Tuple
 
 import warp as wp
 
@@ -6,12 +6,12 @@ import re
 import ast
 
 from warp.sparse import BsrMatrix, bsr_zeros, bsr_set_from_triplets, bsr_copy, bsr_diag
-from warp.types import type_length
+from warp.types import type_length, type_scalar_type
 from warp.utils import array_cast
 from warp.codegen import get_annotations
 
 from warp.fem.domain import GeometryDomain
-from warp.fem.space import SpaceRestriction
+from warp.fem.space import SpaceRestriction, NodalFunctionSpace, SideConnectivity, make_side_connectivity
 from warp.fem.field import (
     TestField,
     TrialField,
@@ -23,7 +23,17 @@ from warp.fem.field import (
 from warp.fem.quadrature import Quadrature, RegularQuadrature
 from warp.fem.operator import Operator, Integrand
 from warp.fem import cache
-from warp.fem.types import Domain, Field, Sample, DofIndex, NULL_DOF_INDEX, OUTSIDE
+from warp.fem.types import (
+    Domain,
+    Field,
+    Sample,
+    DofIndex,
+    ElementIndex,
+    Coords,
+    NULL_DOF_INDEX,
+    NULL_NODE_INDEX,
+    OUTSIDE,
+)
 
 
 def _resolve_path(func, node):
@@ -431,6 +441,25 @@ def get_integrate_null_kernel(
     return integrate_kernel_fn
 
 
+def _make_point_measure(domain: GeometryDomain, quadrature: Quadrature) -> wp.Function:
+    """Returns a function evaluating the measure of the domain element at a quadrature point,
+    read from the quadrature if it caches it"""
+
+    if hasattr(quadrature, "point_measure"):
+        return quadrature.point_measure
+
+    def point_measure(
+        qp_arg: quadrature.Arg,
+        domain_arg: domain.ElementArg,
+        element_index: ElementIndex,
+        qp_index: int,
+        coords: Coords,
+    ):
+        return domain.element_measure(domain_arg, element_index, coords)
+
+    return cache.get_func(point_measure, f"{domain.name}_{quadrature.name}")
+
+
 def get_integrate_constant_kernel(
     integrand_func: wp.Function,
     domain: GeometryDomain,
@@ -439,6 +468,8 @@ def get_integrate_constant_kernel(
     ValueStruct: wp.codegen.Struct,
     accumulate_dtype,
 ):
+    point_measure = _make_point_measure(domain, quadrature)
+
     def integrate_kernel_fn(
         qp_arg: quadrature.Arg,
         domain_arg: domain.ElementArg,
@@ -458,7 +489,7 @@ def get_integrate_constant_kernel(
             qp_index = quadrature.point_index(qp_arg, element_index, k)
             coords = quadrature.point_coords(qp_arg, element_index, k)
             qp_weight = quadrature.point_weight(qp_arg, element_index, k)
-            vol = domain.element_measure(domain_arg, element_index, coords)
+            vol = point_measure(qp_arg, domain_arg, element_index, qp_index, coords)
 
             sample = Sample(element_index, coords, qp_index, qp_weight, test_dof_index, trial_dof_index)
             val = integrand_func(sample, fields, values)
@@ -479,6 +510,8 @@ def get_integrate_linear_kernel(
     test_space: SpaceRestriction,
     accumulate_dtype,
 ):
+    point_measure = _make_point_measure(domain, quadrature)
+
     def integrate_kernel_fn(
         qp_arg: quadrature.Arg,
         domain_arg: domain.ElementArg,
@@ -488,15 +521,20 @@ def get_integrate_linear_kernel(
         values: ValueStruct,
         result: wp.array2d(dtype=accumulate_dtype),
     ):
-        local_node_index = wp.tid()
+        # each thread gathers the contributions of all elements around its node,
+        # so that results are written once without atomics or coloring
+        local_node_index, dof = wp.tid()
         node_index = test_space.node_partition_index(test_arg, local_node_index)
         element_count = test_space.node_element_count(test_arg, local_node_index)
 
         trial_dof_index = NULL_DOF_INDEX
 
+        val_sum = accumulate_dtype(0.0)
+
         for n in range(element_count):
             node_element_index = test_space.node_element_index(test_arg, local_node_index, n)
             element_index = domain.element_index(domain_index_arg, node_element_index.domain_element_index)
+            test_dof_index = DofIndex(node_element_index.node_index_in_element, dof)
 
             qp_point_count = quadrature.point_count(qp_arg, element_index)
             for k in range(qp_point_count):
@@ -504,14 +542,14 @@ def get_integrate_linear_kernel(
                 coords = quadrature.point_coords(qp_arg, element_index, k)
 
                 qp_weight = quadrature.point_weight(qp_arg, element_index, k)
-                vol = domain.element_measure(domain_arg, element_index, coords)
+                vol = point_measure(qp_arg, domain_arg, element_index, qp_index, coords)
 
-                for i in range(test_space.space.VALUE_DOF_COUNT):
-                    test_dof_index = DofIndex(node_element_index.node_index_in_element, i)
-                    sample = Sample(element_index, coords, qp_index, qp_weight, test_dof_index, trial_dof_index)
-                    val = integrand_func(sample, fields, values)
+                sample = Sample(element_index, coords, qp_index, qp_weight, test_dof_index, trial_dof_index)
+                val = integrand_func(sample, fields, values)
+
+                val_sum += accumulate_dtype(qp_weight * vol * val)
 
-                    result[node_index, i] = result[node_index, i] + accumulate_dtype(qp_weight * vol * val)
+        result[node_index, dof] = val_sum
 
     return integrate_kernel_fn
 
@@ -590,6 +628,8 @@ def get_integrate_bilinear_kernel(
 ):
     NODES_PER_ELEMENT = trial.space.NODES_PER_ELEMENT
 
+    point_measure = _make_point_measure(domain, quadrature)
+
     def integrate_kernel_fn(
         qp_arg: quadrature.Arg,
         domain_arg: domain.ElementArg,
@@ -620,7 +660,7 @@ def get_integrate_bilinear_kernel(
                 coords = quadrature.point_coords(qp_arg, element_index, k)
 
                 qp_weight = quadrature.point_weight(qp_arg, element_index, k)
-                vol = domain.element_measure(domain_arg, element_index, coords)
+                vol = point_measure(qp_arg, domain_arg, element_index, qp_index, coords)
 
                 offset_cur = start_offset
 
@@ -662,6 +702,90 @@ def get_integrate_bilinear_kernel(
     return integrate_kernel_fn
 
 
+def get_integrate_residual_and_jacobian_kernel(
+    residual_func: wp.Function,
+    jacobian_func: wp.Function,
+    domain: GeometryDomain,
+    quadrature: Quadrature,
+    FieldStruct: wp.codegen.Struct,
+    ValueStruct: wp.codegen.Struct,
+    test_space: SpaceRestriction,
+    trial: TrialField,
+    accumulate_dtype,
+):
+    NODES_PER_ELEMENT = trial.space.NODES_PER_ELEMENT
+
+    point_measure = _make_point_measure(domain, quadrature)
+
+    def integrate_kernel_fn(
+        qp_arg: quadrature.Arg,
+        domain_arg: domain.ElementArg,
+        domain_index_arg: domain.ElementIndexArg,
+        test_arg: test_space.NodeArg,
+        trial_partition_arg: trial.space_partition.PartitionArg,
+        fields: FieldStruct,
+        values: ValueStruct,
+        residual: wp.array2d(dtype=accumulate_dtype),
+        row_offsets: wp.array(dtype=int),
+        triplet_rows: wp.array(dtype=int),
+        triplet_cols: wp.array(dtype=int),
+        triplet_values: wp.array3d(dtype=accumulate_dtype),
+    ):
+        # Same traversal as the bilinear kernel, also accumulating the residual at each quadrature point
+        # into the row owned by this thread
+        test_local_node_index = wp.tid()
+
+        element_count = test_space.node_element_count(test_arg, test_local_node_index)
+        test_node_index = test_space.node_partition_index(test_arg, test_local_node_index)
+
+        for element in range(element_count):
+            test_element_index = test_space.node_element_index(test_arg, test_local_node_index, element)
+            element_index = domain.element_index(domain_index_arg, test_element_index.domain_element_index)
+            qp_point_count = quadrature.point_count(qp_arg, element_index)
+
+            start_offset = (row_offsets[test_node_index] + element) * NODES_PER_ELEMENT
+
+            for k in range(qp_point_count):
+                qp_index = quadrature.point_index(qp_arg, element_index, k)
+                coords = quadrature.point_coords(qp_arg, element_index, k)
+
+                qp_weight = quadrature.point_weight(qp_arg, element_index, k)
+                vol = point_measure(qp_arg, domain_arg, element_index, qp_index, coords)
+
+                for i in range(test_space.space.VALUE_DOF_COUNT):
+                    test_dof_index = DofIndex(test_element_index.node_index_in_element, i)
+
+                    sample = Sample(element_index, coords, qp_index, qp_weight, test_dof_index, NULL_DOF_INDEX)
+                    val = residual_func(sample, fields, values)
+                    residual[test_node_index, i] = residual[test_node_index, i] + accumulate_dtype(
+                        qp_weight * vol * val
+                    )
+
+                    for trial_n in range(NODES_PER_ELEMENT):
+                        for j in range(trial.space.VALUE_DOF_COUNT):
+                            trial_dof_index = DofIndex(trial_n, j)
+                            sample = Sample(element_index, coords, qp_index, qp_weight, test_dof_index, trial_dof_index)
+                            val = jacobian_func(sample, fields, values)
+                            offset_cur = start_offset + trial_n
+                            triplet_values[offset_cur, i, j] = triplet_values[offset_cur, i, j] + accumulate_dtype(
+                                qp_weight * vol * val
+                            )
+
+            # Set column indices
+            offset_cur = start_offset
+            for trial_n in range(NODES_PER_ELEMENT):
+                trial_node_index = trial.space_partition.partition_node_index(
+                    trial_partition_arg,
+                    trial.space.element_node_index(_get_trial_arg(), element_index, trial_n),
+                )
+
+                triplet_rows[offset_cur] = test_node_index
+                triplet_cols[offset_cur] = trial_node_index
+                offset_cur += 1
+
+    return integrate_kernel_fn
+
+
 def get_integrate_bilinear_nodal_kernel(
     integrand_func: wp.Function,
     domain: GeometryDomain,
@@ -728,6 +852,148 @@ def get_integrate_bilinear_nodal_kernel(
     return integrate_kernel_fn
 
 
+def get_integrate_bilinear_apply_kernel(
+    integrand_func: wp.Function,
+    domain: GeometryDomain,
+    quadrature: Quadrature,
+    FieldStruct: wp.codegen.Struct,
+    ValueStruct: wp.codegen.Struct,
+    test_space: SpaceRestriction,
+    trial: TrialField,
+    accumulate_dtype,
+    apply_dtype,
+):
+    NODES_PER_ELEMENT = trial.space.NODES_PER_ELEMENT
+
+    point_measure = _make_point_measure(domain, quadrature)
+
+    def integrate_kernel_fn(
+        qp_arg: quadrature.Arg,
+        domain_arg: domain.ElementArg,
+        domain_index_arg: domain.ElementIndexArg,
+        test_arg: test_space.NodeArg,
+        trial_partition_arg: trial.space_partition.PartitionArg,
+        fields: FieldStruct,
+        values: ValueStruct,
+        trial_values: wp.array2d(dtype=apply_dtype),
+        result: wp.array2d(dtype=accumulate_dtype),
+    ):
+        test_local_node_index, i = wp.tid()
+
+        element_count = test_space.node_element_count(test_arg, test_local_node_index)
+        test_node_index = test_space.node_partition_index(test_arg, test_local_node_index)
+
+        val_sum = accumulate_dtype(0.0)
+
+        for element in range(element_count):
+            test_element_index = test_space.node_element_index(test_arg, test_local_node_index, element)
+            element_index = domain.element_index(domain_index_arg, test_element_index.domain_element_index)
+            qp_point_count = quadrature.point_count(qp_arg, element_index)
+            test_dof_index = DofIndex(test_element_index.node_index_in_element, i)
+
+            for trial_n in range(NODES_PER_ELEMENT):
+                trial_node_index = trial.space_partition.partition_node_index(
+                    trial_partition_arg,
+                    trial.space.element_node_index(_get_trial_arg(), element_index, trial_n),
+                )
+
+                if trial_node_index != NULL_NODE_INDEX:
+                    for k in range(qp_point_count):
+                        qp_index = quadrature.point_index(qp_arg, element_index, k)
+                        coords = quadrature.point_coords(qp_arg, element_index, k)
+
+                        qp_weight = quadrature.point_weight(qp_arg, element_index, k)
+                        vol = point_measure(qp_arg, domain_arg, element_index, qp_index, coords)
+
+                        for j in range(trial.space.VALUE_DOF_COUNT):
+                            trial_dof_index = DofIndex(trial_n, j)
+                            sample = Sample(
+                                element_index,
+                                coords,
+                                qp_index,
+                                qp_weight,
+                                test_dof_index,
+                                trial_dof_index,
+                            )
+                            val = integrand_func(sample, fields, values)
+                            val_sum += accumulate_dtype(qp_weight * vol * val) * accumulate_dtype(
+                                trial_values[trial_node_index, j]
+                            )
+
+        result[test_node_index, i] = val_sum
+
+    return integrate_kernel_fn
+
+
+def get_integrate_bilinear_apply_nodal_kernel(
+    integrand_func: wp.Function,
+    domain: GeometryDomain,
+    FieldStruct: wp.codegen.Struct,
+    ValueStruct: wp.codegen.Struct,
+    test: TestField,
+    trial: TrialField,
+    accumulate_dtype,
+    apply_dtype,
+):
+    def integrate_kernel_fn(
+        domain_arg: domain.ElementArg,
+        domain_index_arg: domain.ElementIndexArg,
+        test_restriction_arg: test.space_restriction.NodeArg,
+        fields: FieldStruct,
+        values: ValueStruct,
+        trial_values: wp.array2d(dtype=apply_dtype),
+        result: wp.array2d(dtype=accumulate_dtype),
+    ):
+        local_node_index, test_dof = wp.tid()
+
+        element_count = test.space_restriction.node_element_count(test_restriction_arg, local_node_index)
+        node_index = test.space_restriction.node_partition_index(test_restriction_arg, local_node_index)
+
+        val_sum = accumulate_dtype(0.0)
+
+        for n in range(element_count):
+            node_element_index = test.space_restriction.node_element_index(test_restriction_arg, local_node_index, n)
+            element_index = domain.element_index(domain_index_arg, node_element_index.domain_element_index)
+
+            coords = test.space.node_coords_in_element(
+                _get_test_arg(),
+                element_index,
+                node_element_index.node_index_in_element,
+            )
+
+            if coords[0] != OUTSIDE:
+                node_weight = test.space.node_quadrature_weight(
+                    _get_test_arg(),
+                    element_index,
+                    node_element_index.node_index_in_element,
+                )
+
+                vol = domain.element_measure(domain_arg, element_index, coords)
+
+                test_dof_index = DofIndex(node_element_index.node_index_in_element, test_dof)
+
+                for trial_dof in range(trial.space.VALUE_DOF_COUNT):
+                    trial_dof_index = DofIndex(node_element_index.node_index_in_element, trial_dof)
+
+                    sample = Sample(
+                        element_index,
+                        coords,
+                        node_index,
+                        node_weight,
+                        test_dof_index,
+                        trial_dof_index,
+                    )
+                    val = integrand_func(sample, fields, values)
+
+                    val_sum += accumulate_dtype(node_weight * vol * val) * accumulate_dtype(
+                        trial_values[node_index, trial_dof]
+                    )
+
+        result[node_index, test_dof] = val_sum
+
+    return integrate_kernel_fn
+
+
 def _generate_integrate_kernel(
     integrand: Integrand,
     domain: GeometryDomain,
@@ -739,6 +1005,7 @@ def _generate_integrate_kernel(
     trial_name: str,
     fields: Dict[str, FieldLike],
     accumulate_dtype: type,
+    apply_dtype: Optional[type] = None,
 ) -> wp.Kernel:
     # Extract field arguments from integrand
     field_args, value_args, domain_name, sample_name = _get_integrand_field_arguments(
@@ -759,6 +1026,8 @@ def _generate_integrate_kernel(
         kernel_suffix += f"_test_{test.space_partition.name}_{test.space.name}"
     if trial:
         kernel_suffix += f"_trial_{trial.space_partition.name}_{trial.space.name}"
+    if apply_dtype is not None:
+        kernel_suffix += f"_apply_{apply_dtype.__name__}"
 
     kernel = cache.get_integrand_kernel(
         integrand=integrand,
@@ -803,6 +1072,30 @@ def _generate_integrate_kernel(
                 test_space=test.space_restriction,
                 accumulate_dtype=accumulate_dtype,
             )
+    elif apply_dtype is not None:
+        if nodal:
+            integrate_kernel_fn = get_integrate_bilinear_apply_nodal_kernel(
+                integrand_func,
+                domain,
+                FieldStruct,
+                ValueStruct,
+                test=test,
+                trial=trial,
+                accumulate_dtype=accumulate_dtype,
+                apply_dtype=apply_dtype,
+            )
+        else:
+            integrate_kernel_fn = get_integrate_bilinear_apply_kernel(
+                integrand_func,
+                domain,
+                quadrature,
+                FieldStruct,
+                ValueStruct,
+                test_space=test.space_restriction,
+                trial=trial,
+                accumulate_dtype=accumulate_dtype,
+                apply_dtype=apply_dtype,
+            )
     else:
         if nodal:
             integrate_kernel_fn = get_integrate_bilinear_nodal_kernel(
@@ -860,6 +1153,7 @@ def _launch_integrate_kernel(
     output_dtype: type,
     output: Optional[Union[wp.array, BsrMatrix]],
     device,
+    apply_to: Optional[wp.array] = None,
 ) -> wp.Kernel:
     if output_dtype is None:
         if output is not None:
@@ -913,18 +1207,28 @@ def _launch_integrate_kernel(
 
     test_arg = test.space_restriction.node_arg(device=device)
 
-    # Linear form
-    if trial is None:
+    # Linear form, or action of a bilinear form on the trial values
+    if trial is None or apply_to is not None:
         if test.space.VALUE_DOF_COUNT == 1:
             result_dtype = accumulate_dtype
         else:
             result_dtype = wp.vec(length=test.space.VALUE_DOF_COUNT, dtype=accumulate_dtype)
 
-        result_array = wp.zeros(
-            shape=test.space_partition.node_count(),
-            dtype=result_dtype,
-            device=device,
-        )
+        if (
+            isinstance(output, wp.array)
+            and output.is_contiguous
+            and output.dtype == result_dtype
+            and output.shape == (test.space_partition.node_count(),)
+        ):
+            # accumulate directly into the output array, e.g. when applying an operator at each solver iteration
+            result_array = output
+            result_array.zero_()
+        else:
+            result_array = wp.zeros(
+                shape=test.space_partition.node_count(),
+                dtype=result_dtype,
+                device=device,
+            )
 
         # Launch the integration on the kernel on a 2d scalar view of the actual array
         result_2d_view = wp.array(
@@ -937,7 +1241,51 @@ def _launch_integrate_kernel(
             dtype=accumulate_dtype,
         )
 
-        if nodal:
+        if trial is not None:
+            trial_values_2d_view = wp.array(
+                data=None,
+                ptr=apply_to.ptr,
+                capacity=apply_to.capacity,
+                owner=False,
+                device=apply_to.device,
+                shape=(trial.space_partition.node_count(), trial.space.VALUE_DOF_COUNT),
+                dtype=type_scalar_type(apply_to.dtype),
+            )
+
+            if nodal:
+                wp.launch(
+                    kernel=kernel,
+                    dim=(test.space_restriction.node_count(), test.space.VALUE_DOF_COUNT),
+                    inputs=[
+                        domain_elt_arg,
+                        domain_elt_index_arg,
+                        test_arg,
+                        field_arg_values,
+                        value_struct_values,
+                        trial_values_2d_view,
+                        result_2d_view,
+                    ],
+                    device=device,
+                )
+            else:
+                trial_partition_arg = trial.space_partition.partition_arg_value(device)
+                wp.launch(
+                    kernel=kernel,
+                    dim=(test.space_restriction.node_count(), test.space.VALUE_DOF_COUNT),
+                    inputs=[
+                        qp_arg,
+                        domain_elt_arg,
+                        domain_elt_index_arg,
+                        test_arg,
+                        trial_partition_arg,
+                        field_arg_values,
+                        value_struct_values,
+                        trial_values_2d_view,
+                        result_2d_view,
+                    ],
+                    device=device,
+                )
+        elif nodal:
             wp.launch(
                 kernel=kernel,
                 dim=(test.space_restriction.node_count(), test.space.VALUE_DOF_COUNT),
@@ -954,7 +1302,7 @@ def _launch_integrate_kernel(
         else:
             wp.launch(
                 kernel=kernel,
-                dim=test.space_restriction.node_count(),
+                dim=(test.space_restriction.node_count(), test.space.VALUE_DOF_COUNT),
                 inputs=[
                     qp_arg,
                     domain_elt_arg,
@@ -1067,9 +1415,11 @@ def integrate(
     accumulate_dtype=wp.float64,
     output_dtype=None,
     output=None,
+    apply_to: Optional[wp.array] = None,
 ):
     """
     Integrates a constant, linear or bilinear form, and returns a scalar, array, or sparse matrix, respectively.
+    If `apply_to` is provided, the action of the bilinear form on these trial values is returned as an array instead of the assembled matrix.
 
     Args:
         integrand: Form to be integrated, must have `wp.integrand` decorator
@@ -1081,12 +1431,31 @@ def integrate(
         device: Device on which to perform the integration
         accumulate_dtype: Scalar type to be used for accumulating integration samples
         output_dtype: Scalar type for returned results. If None, defaults to accumulate_dtype
+        output: Array in which to store the result of constant forms, as well as linear forms and bilinear form applications if its type and shape match the result
+        apply_to: For bilinear forms only, values of the trial field (one entry per trial node) to which the form is applied without assembling the matrix
     """
     if not isinstance(integrand, Integrand):
         raise ValueError("integrand must be tagged with @integrand decorator")
 
     test, test_name, trial, trial_name = _get_test_and_trial_fields(fields)
 
+    apply_dtype = None
+    if apply_to is not None:
+        if trial is None:
+            raise ValueError("Applying a form to trial values requires specifying a trial function")
+
+        if not apply_to.is_contiguous:
+            raise ValueError("Trial values must be a contiguous array")
+
+        if type_length(apply_to.dtype) != trial.space.VALUE_DOF_COUNT or apply_to.shape != (
+            trial.space_partition.node_count(),
+        ):
+            raise ValueError(
+                f"Trial values must be an array of {trial.space_partition.node_count()} elements with {trial.space.VALUE_DOF_COUNT} components"
+            )
+
+        apply_dtype = type_scalar_type(apply_to.dtype)
+
     if domain is None:
         if quadrature is not None:
             domain = quadrature.domain
@@ -1131,6 +1500,7 @@ def integrate(
         trial_name=trial_name,
         fields=fields,
         accumulate_dtype=accumulate_dtype,
+        apply_dtype=apply_dtype,
     )
 
     return _launch_integrate_kernel(
@@ -1148,8 +1518,414 @@ def integrate(
         output_dtype=output_dtype,
         output=output,
         device=device,
+        apply_to=apply_to,
+    )
+
+
+def _generate_residual_and_jacobian_kernel(
+    residual: Integrand,
+    jacobian: Integrand,
+    domain: GeometryDomain,
+    quadrature: Quadrature,
+    test: TestField,
+    test_name: str,
+    trial: TrialField,
+    trial_name: str,
+    fields: Dict[str, FieldLike],
+    accumulate_dtype: type,
+) -> wp.Kernel:
+    # Extract field arguments from both integrands, which share the same field and value structs
+    residual_field_args, residual_value_args, residual_domain_name, residual_sample_name = (
+        _get_integrand_field_arguments(residual, fields=fields, domain=domain)
+    )
+    jacobian_field_args, jacobian_value_args, jacobian_domain_name, jacobian_sample_name = (
+        _get_integrand_field_arguments(jacobian, fields=fields, domain=domain)
+    )
+
+    if trial_name in residual_field_args:
+        raise ValueError("The residual integrand cannot take a trial field argument")
+
+    FieldStruct = _gen_field_struct({**residual_field_args, **jacobian_field_args})
+    ValueStruct = _gen_value_struct({**residual_value_args, **jacobian_value_args})
+
+    # Check if kernel exist in cache
+    kernel_suffix = (
+        f"_itg_res_{residual.name}_{domain.name}_{FieldStruct.key}{quadrature.name}"
+        f"_test_{test.space_partition.name}_{test.space.name}"
+        f"_trial_{trial.space_partition.name}_{trial.space.name}"
+    )
+
+    kernel = cache.get_integrand_kernel(
+        integrand=jacobian,
+        suffix=kernel_suffix,
+    )
+    if kernel is not None:
+        return kernel, FieldStruct, ValueStruct
+
+    residual_func = _translate_integrand(residual, residual_field_args)
+    jacobian_func = _translate_integrand(jacobian, jacobian_field_args)
+
+    integrate_kernel_fn = get_integrate_residual_and_jacobian_kernel(
+        residual_func,
+        jacobian_func,
+        domain,
+        quadrature,
+        FieldStruct,
+        ValueStruct,
+        test_space=test.space_restriction,
+        trial=trial,
+        accumulate_dtype=accumulate_dtype,
+    )
+
+    kernel = cache.get_integrand_kernel(
+        integrand=jacobian,
+        kernel_fn=integrate_kernel_fn,
+        suffix=kernel_suffix,
+        code_transformers=[
+            PassFieldArgsToIntegrand(
+                arg_names=residual.argspec.args,
+                field_args=residual_field_args.keys(),
+                value_args=residual_value_args.keys(),
+                sample_name=residual_sample_name,
+                domain_name=residual_domain_name,
+                test_name=test_name,
+                trial_name=trial_name,
+                func_name="residual_func",
+            ),
+            PassFieldArgsToIntegrand(
+                arg_names=jacobian.argspec.args,
+                field_args=jacobian_field_args.keys(),
+                value_args=jacobian_value_args.keys(),
+                sample_name=jacobian_sample_name,
+                domain_name=jacobian_domain_name,
+                test_name=test_name,
+                trial_name=trial_name,
+                func_name="jacobian_func",
+            ),
+        ],
+    )
+
+    return kernel, FieldStruct, ValueStruct
+
+
+def integrate_residual_and_jacobian(
+    residual: Integrand,
+    jacobian: Integrand,
+    domain: GeometryDomain = None,
+    quadrature: Quadrature = None,
+    fields={},
+    values={},
+    device=None,
+    accumulate_dtype=wp.float64,
+    output_dtype=None,
+) -> Tuple[wp.array, BsrMatrix]:
+    """
+    Integrates the residual linear form and the jacobian bilinear form of a nonlinear problem in a single pass over the domain elements,
+    and returns the residual array and the assembled tangent matrix. This is typically called once per Newton iteration,
+    with the current solution passed to both integrands as a :class:`DiscreteField`.
+
+    Both integrands are evaluated at the same quadrature points, so that element traversal and geometric quantities are shared.
+    The residual integrand may take the test field but not the trial field.
+
+    Args:
+        residual: Linear form to be integrated, must have `wp.integrand` decorator
+        jacobian: Bilinear form to be integrated, must have `wp.integrand` decorator
+        domain: Integration domain. If None, deduced from fields
+        quadrature: Quadrature formula. If None, deduced from domain and fields degree.
+        fields: Discrete, test, and trial fields to be passed to the integrands. Keys in the dictionary must match integrand parameter names.
+        values: Additional variable values to be passed to the integrands. Keys in the dictionary must match integrand parameter names.
+        device: Device on which to perform the integration
+        accumulate_dtype: Scalar type to be used for accumulating integration samples
+        output_dtype: Scalar type for returned results. If None, defaults to accumulate_dtype
+    """
+    if not isinstance(residual, Integrand) or not isinstance(jacobian, Integrand):
+        raise ValueError("residual and jacobian must be tagged with @integrand decorator")
+
+    test, test_name, trial, trial_name = _get_test_and_trial_fields(fields)
+    if trial is None:
+        raise ValueError("Integrating a jacobian requires specifying test and trial functions")
+
+    if domain is None:
+        domain = quadrature.domain if quadrature is not None else test.domain
+    if domain != test.domain:
+        raise NotImplementedError("Mixing integration and test domain is not supported yet")
+
+    if quadrature is None:
+        quadrature = RegularQuadrature(domain=domain, order=test.space.degree + trial.space.degree)
+    elif domain != quadrature.domain:
+        raise ValueError("Incompatible integration and quadrature domain")
+
+    kernel, FieldStruct, ValueStruct = _generate_residual_and_jacobian_kernel(
+        residual=residual,
+        jacobian=jacobian,
+        domain=domain,
+        quadrature=quadrature,
+        test=test,
+        test_name=test_name,
+        trial=trial,
+        trial_name=trial_name,
+        fields=fields,
+        accumulate_dtype=accumulate_dtype,
     )
 
+    if output_dtype is None:
+        output_dtype = accumulate_dtype
+
+    field_arg_values = FieldStruct()
+    for k, v in fields.items():
+        setattr(field_arg_values, k, v.eval_arg_value(device=device))
+
+    value_struct_values = ValueStruct()
+    for k, v in values.items():
+        setattr(value_struct_values, k, v)
+
+    test_dof_count = test.space.VALUE_DOF_COUNT
+    trial_dof_count = trial.space.VALUE_DOF_COUNT
+
+    if test_dof_count == 1:
+        residual_dtype = accumulate_dtype
+    else:
+        residual_dtype = wp.vec(length=test_dof_count, dtype=accumulate_dtype)
+
+    residual_array = wp.zeros(shape=test.space_partition.node_count(), dtype=residual_dtype, device=device)
+    residual_2d_view = wp.array(
+        data=None,
+        ptr=residual_array.ptr,
+        capacity=residual_array.capacity,
+        owner=False,
+        device=residual_array.device,
+        shape=(test.space_partition.node_count(), test_dof_count),
+        dtype=accumulate_dtype,
+    )
+
+    nnz = test.space_restriction.total_node_element_count() * trial.space.NODES_PER_ELEMENT
+    triplet_rows = wp.empty(n=nnz, dtype=int, device=device)
+    triplet_cols = wp.empty(n=nnz, dtype=int, device=device)
+    triplet_values = wp.zeros(shape=(nnz, test_dof_count, trial_dof_count), dtype=accumulate_dtype, device=device)
+
+    wp.launch(
+        kernel=kernel,
+        dim=test.space_restriction.node_count(),
+        inputs=[
+            quadrature.arg_value(device=device),
+            domain.element_arg_value(device=device),
+            domain.element_index_arg_value(device=device),
+            test.space_restriction.node_arg(device=device),
+            trial.space_partition.partition_arg_value(device),
+            field_arg_values,
+            value_struct_values,
+            residual_2d_view,
+            test.space_restriction.partition_element_offsets(),
+            triplet_rows,
+            triplet_cols,
+            triplet_values,
+        ],
+        device=device,
+    )
+
+    if test_dof_count == 1 and trial_dof_count == 1:
+        block_type = accumulate_dtype
+    else:
+        block_type = wp.types.matrix(shape=(test_dof_count, trial_dof_count), dtype=accumulate_dtype)
+
+    bsr_matrix = bsr_zeros(
+        rows_of_blocks=test.space_partition.node_count(),
+        cols_of_blocks=trial.space_partition.node_count(),
+        block_type=block_type,
+        device=device,
+    )
+    bsr_set_from_triplets(bsr_matrix, triplet_rows, triplet_cols, triplet_values)
+
+    if output_dtype == accumulate_dtype:
+        return residual_array, bsr_matrix
+
+    if test_dof_count == 1:
+        cast_residual = wp.empty(dtype=output_dtype, shape=residual_array.shape, device=device)
+    else:
+        cast_residual = wp.empty(
+            dtype=wp.vec(length=test_dof_count, dtype=output_dtype), shape=residual_array.shape, device=device
+        )
+    array_cast(in_array=residual_array, out_array=cast_residual)
+
+    return cast_residual, bsr_copy(bsr_matrix, scalar_type=output_dtype)
+
+
+def get_integrate_interior_penalty_kernel(
+    space: NodalFunctionSpace,
+    quadrature: Quadrature,
+    accumulate_dtype,
+):
+    NODES_PER_ELEMENT = space.NODES_PER_ELEMENT
+    geometry = space.geometry
+
+    def side_cell_weight(
+        space_arg: space.SpaceArg, cell_index: ElementIndex, coords: Coords, node_index_in_elt: int, outer: int
+    ):
+        if outer == 0:
+            return space.element_inner_weight(space_arg, cell_index, coords, node_index_in_elt)
+        return space.element_outer_weight(space_arg, cell_index, coords, node_index_in_elt)
+
+    def side_cell_weight_gradient(
+        space_arg: space.SpaceArg, cell_index: ElementIndex, coords: Coords, node_index_in_elt: int, outer: int
+    ):
+        if outer == 0:
+            return space.element_inner_weight_gradient(space_arg, cell_index, coords, node_index_in_elt)
+        return space.element_outer_weight_gradient(space_arg, cell_index, coords, node_index_in_elt)
+
+    cell_weight = cache.get_func(side_cell_weight, space.name)
+    cell_weight_gradient = cache.get_func(side_cell_weight_gradient, space.name)
+
+    def integrate_kernel_fn(
+        qp_arg: quadrature.Arg,
+        side_arg: geometry.SideArg,
+        space_arg: space.SpaceArg,
+        connectivity_arg: SideConnectivity.Arg,
+        interior_sides: wp.array(dtype=int),
+        penalty: float,
+        triplet_rows: wp.array(dtype=int),
+        triplet_cols: wp.array(dtype=int),
+        triplet_values: wp.array(dtype=accumulate_dtype),
+    ):
+        # one thread per block of a side, nodes of the outer cell follow those of the inner cell as in traces
+        side_local_index, test_n, trial_n = wp.tid()
+        side_index = interior_sides[side_local_index]
+
+        test_outer = test_n // NODES_PER_ELEMENT
+        trial_outer = trial_n // NODES_PER_ELEMENT
+        test_node = test_n - test_outer * NODES_PER_ELEMENT
+        trial_node = trial_n - trial_outer * NODES_PER_ELEMENT
+
+        test_cell = SideConnectivity.cell_index(connectivity_arg, side_index, test_outer)
+        trial_cell = SideConnectivity.cell_index(connectivity_arg, side_index, trial_outer)
+
+        # jumps are inner minus outer values
+        test_sign = 1.0 - 2.0 * float(test_outer)
+        trial_sign = 1.0 - 2.0 * float(trial_outer)
+
+        val = accumulate_dtype(0.0)
+
+        qp_point_count = quadrature.point_count(qp_arg, side_index)
+        for k in range(qp_point_count):
+            qp_index = quadrature.point_index(qp_arg, side_index, k)
+            coords = quadrature.point_coords(qp_arg, side_index, k)
+            qp_weight = quadrature.point_weight(qp_arg, side_index, k)
+
+            sample = Sample(side_index, coords, qp_index, qp_weight, NULL_DOF_INDEX, NULL_DOF_INDEX)
+            nor = geometry.side_normal(side_arg, sample)
+            ratio = geometry.side_measure_ratio(side_arg, sample)
+            vol = geometry.side_measure(side_arg, side_index, coords)
+
+            test_coords = SideConnectivity.cell_coords(connectivity_arg, side_index, test_outer, coords)
+            trial_coords = SideConnectivity.cell_coords(connectivity_arg, side_index, trial_outer, coords)
+
+            test_jump = test_sign * cell_weight(space_arg, test_cell, test_coords, test_node, test_outer)
+            trial_jump = trial_sign * cell_weight(space_arg, trial_cell, trial_coords, trial_node, trial_outer)
+
+            test_flux = 0.5 * wp.dot(
+                cell_weight_gradient(space_arg, test_cell, test_coords, test_node, test_outer), nor
+            )
+            trial_flux = 0.5 * wp.dot(
+                cell_weight_gradient(space_arg, trial_cell, trial_coords, trial_node, trial_outer), nor
+            )
+
+            form = penalty * ratio * trial_jump * test_jump - (trial_flux * test_jump + test_flux * trial_jump)
+            val += accumulate_dtype(qp_weight * vol * form)
+
+        offset = (side_local_index * 2 * NODES_PER_ELEMENT + test_n) * 2 * NODES_PER_ELEMENT + trial_n
+        triplet_rows[offset] = space.element_node_index(space_arg, test_cell, test_node)
+        triplet_cols[offset] = space.element_node_index(space_arg, trial_cell, trial_node)
+        triplet_values[offset] = val
+
+    return cache.get_kernel(integrate_kernel_fn, suffix=f"{space.name}_{quadrature.name}_{accumulate_dtype.__name__}")
+
+
+def integrate_interior_penalty(
+    space: NodalFunctionSpace,
+    quadrature: Optional[Quadrature] = None,
+    penalty: Optional[float] = None,
+    device=None,
+    accumulate_dtype=wp.float64,
+    output_dtype=None,
+) -> BsrMatrix:
+    """
+    Assembles the face terms of the Symmetric Interior Penalty discretization of the Laplacian for a scalar
+    discontinuous space, i.e. the integral over the interior sides of its geometry of::
+
+        penalty * measure_ratio * jump(u) * jump(v)
+            - (dot(grad_average(u), n) * jump(v) + dot(grad_average(v), n) * jump(u))
+
+    This is equivalent to integrating that form with :func:`integrate` over the :class:`Sides` of the geometry
+    with test and trial fields of ``space``, but the neighbour cells of each side and the maps from side to cell
+    coordinates are read from the :class:`SideConnectivity` of the geometry, built once, and each block of a side is
+    assembled by its own thread instead of looking them up for each test node, quadrature point and trial node.
+
+    Args:
+        space: Scalar nodal function space, typically discontinuous, defining both the test and trial functions
+        quadrature: Quadrature formula over the sides of the space geometry. If None, deduced from the space degree
+        penalty: Penalty coefficient, defaults to the squared degree of the space
+        device: Device on which to perform the assembly
+        accumulate_dtype: Scalar type to be used for accumulating integration samples
+        output_dtype: Scalar type for the returned matrix. If None, defaults to accumulate_dtype
+
+    Returns:
+        The face terms as a square BSR matrix with one row and column per node of ``space``
+    """
+
+    from warp.fem.domain import Sides
+
+    if space.VALUE_DOF_COUNT != 1 or space.dtype != wp.float32:
+        raise ValueError("Interior penalty assembly requires a scalar function space")
+
+    if quadrature is None:
+        quadrature = RegularQuadrature(domain=Sides(space.geometry), order=2 * space.degree)
+    elif not isinstance(quadrature.domain, Sides) or quadrature.domain.geometry != space.geometry:
+        raise ValueError("Interior penalty assembly requires a quadrature over the sides of the space geometry")
+
+    if penalty is None:
+        penalty = float(space.degree * space.degree)
+
+    if output_dtype is None:
+        output_dtype = accumulate_dtype
+
+    device = wp.get_device(device)
+    connectivity = make_side_connectivity(space, device=device)
+
+    node_count = space.node_count()
+    bsr_matrix = bsr_zeros(
+        rows_of_blocks=node_count,
+        cols_of_blocks=node_count,
+        block_type=accumulate_dtype,
+        device=device,
+    )
+
+    block_count = 2 * space.NODES_PER_ELEMENT
+    nnz = connectivity.interior_side_count() * block_count * block_count
+
+    triplet_rows = wp.empty(n=nnz, dtype=int, device=device)
+    triplet_cols = wp.empty(n=nnz, dtype=int, device=device)
+    triplet_values = wp.empty(n=nnz, dtype=accumulate_dtype, device=device)
+
+    if nnz > 0:
+        wp.launch(
+            kernel=get_integrate_interior_penalty_kernel(space, quadrature, accumulate_dtype),
+            dim=(connectivity.interior_side_count(), block_count, block_count),
+            inputs=[
+                quadrature.arg_value(device),
+                space.geometry.side_arg_value(device),
+                space.space_arg_value(device),
+                connectivity.arg_value(device),
+                connectivity.interior_sides,
+                penalty,
+                triplet_rows,
+                triplet_cols,
+                triplet_values,
+            ],
+            device=device,
+        )
+
+    bsr_set_from_triplets(bsr_matrix, triplet_rows, triplet_cols, triplet_values)
+    return bsr_matrix if output_dtype == accumulate_dtype else bsr_copy(bsr_matrix, scalar_type=output_dtype)
+
 
 def get_interpolate_kernel(
     integrand_func: wp.Function,
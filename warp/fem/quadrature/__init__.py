@@ -1,2 +1,3 @@
 from .quadrature import Quadrature, RegularQuadrature
 from .pic_quadrature import PicQuadrature
+from .cached_quadrature import CachedQuadrature
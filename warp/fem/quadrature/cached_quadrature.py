@@ -0,0 +1,147 @@
+import warp as wp
+
+from warp.fem.types import ElementIndex, Coords
+from warp.fem import cache
+
+from .quadrature import Quadrature
+
+
+class CachedQuadrature(Quadrature):
+    """Quadrature formula storing the measure of the domain elements at each of its points in a device array.
+
+    Repeated integrations over a static geometry then read the precomputed measures instead of evaluating them
+    from the element vertices, e.g. when assembling the same forms at each step of a simulation.
+    Values at the quadrature points are forwarded to the wrapped quadrature.
+
+    The cache is filled at construction and must be refreshed with :meth:`update` whenever the geometry is modified.
+    """
+
+    def __init__(self, quadrature: Quadrature, device=None):
+        """
+        Args:
+            quadrature: Quadrature formula whose points and weights are used
+            device: Device on which to store the cached geometric quantities
+        """
+        super().__init__(quadrature.domain)
+
+        self._quadrature = quadrature
+        self._device = wp.get_device(device)
+
+        self.Arg = self._make_arg()
+        self.point_count = self._make_point_count()
+        self.point_index = self._make_point_index()
+        self.point_coords = self._make_point_coords()
+        self.point_weight = self._make_point_weight()
+        self.point_measure = self._make_point_measure()
+
+        self._measures = wp.empty(shape=quadrature.total_point_count(), dtype=float, device=self._device)
+        self.update()
+
+    @property
+    def name(self):
+        return f"{self.__class__.__name__}_{self._quadrature.name}"
+
+    @property
+    def quadrature(self) -> Quadrature:
+        """Wrapped quadrature formula"""
+        return self._quadrature
+
+    @property
+    def measures(self) -> wp.array:
+        """Measure of the domain element at each quadrature point, indexed by quadrature point index"""
+        return self._measures
+
+    def total_point_count(self):
+        return self._quadrature.total_point_count()
+
+    def arg_value(self, device):
+        arg = self.Arg()
+        arg.base_arg = self._quadrature.arg_value(device)
+        arg.measures = self._measures.to(device)
+        return arg
+
+    def update(self):
+        """Recomputes the cached element measures, e.g. after the geometry positions have been modified"""
+
+        domain = self.domain
+        quadrature = self._quadrature
+
+        def fill_measures_fn(
+            qp_arg: quadrature.Arg,
+            domain_arg: domain.ElementArg,
+            domain_index_arg: domain.ElementIndexArg,
+            measures: wp.array(dtype=float),
+        ):
+            element_index = domain.element_index(domain_index_arg, wp.tid())
+
+            qp_point_count = quadrature.point_count(qp_arg, element_index)
+            for k in range(qp_point_count):
+                qp_index = quadrature.point_index(qp_arg, element_index, k)
+                coords = quadrature.point_coords(qp_arg, element_index, k)
+                measures[qp_index] = domain.element_measure(domain_arg, element_index, coords)
+
+        fill_measures = cache.get_kernel(fill_measures_fn, suffix=f"{domain.name}_{quadrature.name}")
+
+        wp.launch(
+            kernel=fill_measures,
+            dim=domain.element_count(),
+            inputs=[
+                quadrature.arg_value(self._device),
+                domain.element_arg_value(self._device),
+                domain.element_index_arg_value(self._device),
+                self._measures,
+            ],
+            device=self._device,
+        )
+
+    def _make_arg(self):
+        class Arg:
+            base_arg: self._quadrature.Arg
+            measures: wp.array(dtype=float)
+
+        Arg.__qualname__ = f"{self.name}_Arg"
+        return cache.get_struct(Arg)
+
+    def _make_point_count(self):
+        quadrature = self._quadrature
+
+        def point_count(arg: self.Arg, element_index: ElementIndex):
+            return quadrature.point_count(arg.base_arg, element_index)
+
+        return cache.get_func(point_count, self.name)
+
+    def _make_point_index(self):
+        quadrature = self._quadrature
+
+        def point_index(arg: self.Arg, element_index: ElementIndex, index: int):
+            return quadrature.point_index(arg.base_arg, element_index, index)
+
+        return cache.get_func(point_index, self.name)
+
+    def _make_point_coords(self):
+        quadrature = self._quadrature
+
+        def point_coords(arg: self.Arg, element_index: ElementIndex, index: int):
+            return quadrature.point_coords(arg.base_arg, element_index, index)
+
+        return cache.get_func(point_coords, self.name)
+
+    def _make_point_weight(self):
+        quadrature = self._quadrature
+
+        def point_weight(arg: self.Arg, element_index: ElementIndex, index: int):
+            return quadrature.point_weight(arg.base_arg, element_index, index)
+
+        return cache.get_func(point_weight, self.name)
+
+    def _make_point_measure(self):
+        def point_measure(
+            arg: self.Arg,
+            domain_arg: self.domain.ElementArg,
+            element_index: ElementIndex,
+            qp_index: int,
+            coords: Coords,
+        ):
+            return arg.measures[qp_index]
+
+        return cache.get_func(point_measure, self.name)
@@ -1,7 +1,7 @@
 import warp as wp
 
 from warp.fem.domain import GeometryDomain
-from warp.fem.types import ElementIndex, Coords
+from warp.fem.types import ElementIndex, Coords, Sample, NULL_QP_INDEX, NULL_DOF_INDEX
 from warp.fem.utils import compress_node_indices
 
 from .quadrature import Quadrature
@@ -14,6 +14,8 @@ class PicQuadrature(Quadrature):
     """Particle-based quadrature formula, using a global set of points irregularely spread out over geometry elements.
 
     Useful for Particle-In-Cell and derived methods.
+    Particles are binned into cells on device without synchronizing with the host,
+    and can be re-binned incrementally with :meth:`update` after they have moved.
     """
 
     def __init__(
@@ -27,7 +29,28 @@ class PicQuadrature(Quadrature):
         self.positions = positions
         self.measures = measures
 
-        self._bin_particles()
+        self._bin_particles(use_guess=False)
+
+    def update(self, positions: "wp.array()" = None, measures: "wp.array(dtype=float)" = None):
+        """Bins the particles again after they have moved, e.g. at each step of a Material Point Method simulation.
+
+        The cells containing the particles at the previous binning are used as guesses for the lookup, which is cheap
+        on geometries that search locally when particles only move a little. Particle arrays are reused when the number
+        of particles does not change.
+
+        Args:
+            positions: New particle positions. If None, the previous array, possibly modified in place, is used
+            measures: New particle measures. If None, the previous measures array is used
+        """
+
+        use_guess = positions is None or positions.shape == self.positions.shape
+
+        if positions is not None:
+            self.positions = positions
+        if measures is not None:
+            self.measures = measures
+
+        self._bin_particles(use_guess=use_guess)
 
     @property
     def name(self):
@@ -104,11 +127,13 @@ class PicQuadrature(Quadrature):
         i = wp.tid()
         element_mask[i] = wp.select(element_particle_offsets[i] == element_particle_offsets[i + 1], 1, 0)
 
-    def _bin_particles(self):
+    def _bin_particles(self, use_guess: bool):
         from warp.fem import cache
 
+        domain = self.domain
+
         def bin_particles_fn(
-            cell_arg_value: self.domain.ElementArg,
+            cell_arg_value: domain.ElementArg,
             positions: wp.array(dtype=self.positions.dtype),
             measures: wp.array(dtype=float),
             cell_index: wp.array(dtype=ElementIndex),
@@ -116,38 +141,56 @@ class PicQuadrature(Quadrature):
             cell_fraction: wp.array(dtype=float),
         ):
             p = wp.tid()
-            sample = self.domain.element_lookup(cell_arg_value, positions[p])
+            sample = domain.element_lookup(cell_arg_value, positions[p])
 
             cell_index[p] = sample.element_index
 
             cell_coords[p] = sample.element_coords
-            cell_fraction[p] = measures[p] / self.domain.element_measure(cell_arg_value, sample)
+            cell_fraction[p] = measures[p] / domain.element_measure(cell_arg_value, sample)
 
-        bin_particles = cache.get_kernel(
-            bin_particles_fn,
-            suffix=f"{self.domain.name}",
-        )
+        def rebin_particles_fn(
+            cell_arg_value: domain.ElementArg,
+            positions: wp.array(dtype=self.positions.dtype),
+            measures: wp.array(dtype=float),
+            cell_index: wp.array(dtype=ElementIndex),
+            cell_coords: wp.array(dtype=Coords),
+            cell_fraction: wp.array(dtype=float),
+        ):
+            p = wp.tid()
+            guess = Sample(cell_index[p], cell_coords[p], NULL_QP_INDEX, 0.0, NULL_DOF_INDEX, NULL_DOF_INDEX)
+            sample = domain.element_lookup(cell_arg_value, positions[p], guess)
+
+            cell_index[p] = sample.element_index
+
+            cell_coords[p] = sample.element_coords
+            cell_fraction[p] = measures[p] / domain.element_measure(cell_arg_value, sample)
 
         device = self.positions.device
 
-        cell_index = wp.empty(shape=self.positions.shape, dtype=int, device=device)
-        self._particle_coords = wp.empty(shape=self.positions.shape, dtype=Coords, device=device)
-        self._particle_fraction = wp.empty(shape=self.positions.shape, dtype=float, device=device)
+        if use_guess:
+            bin_particles = cache.get_kernel(rebin_particles_fn, suffix=f"{domain.name}")
+        else:
+            bin_particles = cache.get_kernel(bin_particles_fn, suffix=f"{domain.name}")
+
+            self._particle_cell_index = wp.empty(shape=self.positions.shape, dtype=int, device=device)
+            self._particle_coords = wp.empty(shape=self.positions.shape, dtype=Coords, device=device)
+            self._particle_fraction = wp.empty(shape=self.positions.shape, dtype=float, device=device)
 
         wp.launch(
             dim=self.positions.shape[0],
             kernel=bin_particles,
             inputs=[
-                self.domain.element_arg_value(device),
+                domain.element_arg_value(device),
                 self.positions,
                 self.measures,
-                cell_index,
+                self._particle_cell_index,
                 self._particle_coords,
                 self._particle_fraction,
             ],
             device=device,
         )
 
-        self._cell_particle_offsets, self._cell_particle_indices, self._cell_count, _ = compress_node_indices(
-            self.domain.geometry_element_count(), cell_index
+        # Sort-based binning that keeps the cell counts on device
+        self._cell_particle_offsets, self._cell_particle_indices, _, __ = compress_node_indices(
+            domain.geometry_element_count(), self._particle_cell_index, return_unique_nodes=False
         )
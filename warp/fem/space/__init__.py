@@ -24,8 +24,10 @@ from .trimesh_2d_function_space import (
 )
 from .tetmesh_function_space import TetmeshPiecewiseConstantSpace, TetmeshPolynomialSpace, TetmeshDGPolynomialSpace
 
-from .partition import SpacePartition, make_space_partition
+from .partition import SpacePartition, make_space_partition, make_space_partitions
+from .side_connectivity import SideConnectivity, make_side_connectivity
 from .restriction import SpaceRestriction
+from .prolongation import make_prolongation
 
 
 from .dof_mapper import DofMapper, IdentityMapper, SymmetricTensorMapper
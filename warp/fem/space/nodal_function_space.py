@@ -57,6 +57,16 @@ class NodalFunctionSpace(FunctionSpace):
 
         return cache.get_func(unit_dof_value, str(dof_mapper))
 
+    # Optional interface for evaluating fields faster than by summing element_inner_weight over nodes
+
+    def make_factorized_eval_inner(self, EvalArg, read_node_value: wp.Function):
+        """Returns a function evaluating a field from the values at the element nodes, or None"""
+        return None
+
+    def make_factorized_eval_grad_inner(self, EvalArg, read_node_value: wp.Function):
+        """Returns a function evaluating the gradient of a field from the values at the element nodes, or None"""
+        return None
+
     # Interface for generating Trace space
 
     def _inner_cell_index(args: Any, side_index: ElementIndex):
@@ -1,9 +1,10 @@
-from typing import Any, Optional
+from typing import Any, List, Optional
 
 import warp as wp
 
-from warp.fem.geometry import GeometryPartition, WholeGeometryPartition
-from warp.fem.utils import compress_node_indices, _iota_kernel
+from warp.fem.geometry import GeometryPartition, WholeGeometryPartition, LinearGeometryPartition
+from warp.fem.utils import _iota_kernel
+from warp.utils import array_scan
 from warp.fem.types import NULL_NODE_INDEX
 
 from .function_space import FunctionSpace
@@ -242,32 +243,64 @@ class NodePartition(SpacePartition):
         self._finalize_node_indices(node_category)
 
     def _finalize_node_indices(self, node_category: wp.array(dtype=int)):
-        category_offsets, node_indices, _, __ = compress_node_indices(NodeCategory.COUNT, node_category)
-        self._category_offsets = category_offsets.numpy()
+        space_node_count = self.space.node_count()
+        device = node_category.device
 
-        # Compute globla to local indices
+        # Rank of each node within each of the categories preceding EXTERIOR, from a single scan of masks
+        category_ranks = wp.empty(shape=(space_node_count,), dtype=wp.vec4i, device=device)
+        wp.launch(
+            kernel=NodePartition._category_masks,
+            dim=space_node_count,
+            device=device,
+            inputs=[node_category, category_ranks],
+        )
+        if space_node_count > 0:
+            array_scan(category_ranks, category_ranks, inclusive=True)
+            category_counts = category_ranks[space_node_count - 1 :].numpy()[0]
+        else:
+            category_counts = [0] * NodeCategory.EXTERIOR
+
+        self._category_offsets = [0] * NodeCategory.COUNT
+        for c in range(NodeCategory.EXTERIOR):
+            self._category_offsets[c + 1] = self._category_offsets[c] + int(category_counts[c])
+
+        # Compute global to local indices
         self._space_to_partition = node_category  # Reuse array storage
+        self._node_indices = wp.empty(shape=(self.node_count(),), dtype=int, device=device)
         wp.launch(
             kernel=NodePartition._scatter_partition_indices,
-            dim=self.space.node_count(),
-            device=self._space_to_partition.device,
-            inputs=[self.node_count(), node_indices, self._space_to_partition],
+            dim=space_node_count,
+            device=device,
+            inputs=[category_ranks, self._node_indices, self._space_to_partition],
         )
 
-        # Copy to shrinked-to-fit array, save on memory
-        self._node_indices = wp.empty(shape=(self.node_count()), dtype=int, device=node_indices.device)
-        wp.copy(dest=self._node_indices, src=node_indices, count=self.node_count())
+    @wp.kernel
+    def _category_masks(node_category: wp.array(dtype=int), category_masks: wp.array(dtype=wp.vec4i)):
+        space_idx = wp.tid()
+        category = node_category[space_idx]
+
+        mask = wp.vec4i(0)
+        if category < NodeCategory.EXTERIOR:
+            mask[category] = 1
+        category_masks[space_idx] = mask
 
     @wp.kernel
     def _scatter_partition_indices(
-        local_node_count: int,
+        category_ranks: wp.array(dtype=wp.vec4i),
         node_indices: wp.array(dtype=int),
         space_to_partition_indices: wp.array(dtype=int),
     ):
-        local_idx = wp.tid()
-        space_idx = node_indices[local_idx]
+        space_idx = wp.tid()
+        category = space_to_partition_indices[space_idx]
+
+        if category < NodeCategory.EXTERIOR:
+            # Categories are stored contiguously, in increasing order
+            category_counts = category_ranks[category_ranks.shape[0] - 1]
+            local_idx = category_ranks[space_idx][category] - 1
+            for c in range(category):
+                local_idx += category_counts[c]
 
-        if local_idx < local_node_count:
+            node_indices[local_idx] = space_idx
             space_to_partition_indices[space_idx] = local_idx
         else:
             space_to_partition_indices[space_idx] = NULL_NODE_INDEX
@@ -295,3 +328,40 @@ def make_space_partition(
         return NodePartition(space, geometry_partition, with_halo=with_halo, device=device)
 
     return WholeSpacePartition(space)
+
+
+def make_space_partitions(
+    space: FunctionSpace,
+    devices: Optional[List] = None,
+    with_halo: bool = True,
+) -> List[SpacePartition]:
+    """Splits the nodes of a function space into one partition per device, e.g. for distributed assembly
+
+    Each partition is built from a contiguous range of the space geometry cells
+    (see :class:`warp.fem.geometry.LinearGeometryPartition`), and its node indices are computed and stored on the
+    associated device.
+    Nodes on the frontier between two partitions are owned by both of them.
+
+    Args:
+        space: the function space to consider
+        devices: Warp devices onto which to distribute the partitions.
+          If not provided, use all CUDA devices, or the CPU if there are none.
+        with_halo: if True, include the halo nodes (nodes from exterior frontier cells to each partition)
+
+    Returns:
+        the list of space partitions, in the same order as `devices`
+    """
+
+    if devices is None:
+        devices = wp.get_cuda_devices() or ["cpu"]
+
+    devices = [wp.get_device(device) for device in devices]
+    if len(devices) == 1:
+        return [WholeSpacePartition(space)]
+
+    partitions = []
+    for rank, device in enumerate(devices):
+        geo_partition = LinearGeometryPartition(space.geometry, rank, len(devices), device=device)
+        partitions.append(NodePartition(space, geo_partition, with_halo=with_halo, device=device))
+
+    return partitions
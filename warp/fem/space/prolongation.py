@@ -0,0 +1,129 @@
+import warp as wp
+import numpy as np
+
+from warp.sparse import BsrMatrix, bsr_zeros, bsr_set_from_triplets
+from warp.fem.types import Sample, NULL_QP_INDEX, NULL_DOF_INDEX
+
+from .function_space import FunctionSpace
+
+
+def make_prolongation(
+    coarse_space: FunctionSpace,
+    fine_space: FunctionSpace,
+    scalar_type: type = wp.float32,
+    device=None,
+) -> BsrMatrix:
+    """Assembles the prolongation matrix interpolating functions of a coarse space at the nodes of a fine space
+
+    Rows correspond to fine nodes and columns to coarse nodes, the transposed matrix is the associated restriction.
+    Typically used to build the hierarchy of a geometric multigrid preconditioner from nested grids,
+    see :func:`warp.optim.linear.multigrid_preconditioner`.
+
+    Args:
+        coarse_space: Nodal function space on the coarse geometry, which must support cell lookups from world positions
+          (e.g. :class:`warp.fem.geometry.Grid2D` or :class:`warp.fem.geometry.Grid3D`)
+        fine_space: Nodal function space with the same number of degrees of freedom per node, on a geometry covering
+          the same region
+        scalar_type: Scalar type of the matrix blocks
+        device: Device on which to assemble the matrix
+    """
+
+    from warp.fem import cache
+
+    if coarse_space.VALUE_DOF_COUNT != fine_space.VALUE_DOF_COUNT:
+        raise ValueError("Coarse and fine spaces must have the same number of degrees of freedom per node")
+
+    coarse_geo = coarse_space.geometry
+    fine_geo = fine_space.geometry
+
+    if coarse_geo.dimension != fine_geo.dimension:
+        raise ValueError("Coarse and fine geometries must have the same dimension")
+
+    device = wp.get_device(device)
+
+    dof_count = fine_space.VALUE_DOF_COUNT
+    if dof_count == 1:
+        block_type = scalar_type
+        unit_block = 1.0
+    else:
+        block_type = wp.types.matrix(shape=(dof_count, dof_count), dtype=scalar_type)
+        unit_block = block_type(np.eye(dof_count))
+
+    pos_type = wp.vec2 if fine_geo.dimension == 2 else wp.vec3
+    COARSE_NODES_PER_ELEMENT = coarse_space.NODES_PER_ELEMENT
+
+    def fill_node_positions_fn(
+        cell_arg: fine_geo.CellArg,
+        space_arg: fine_space.SpaceArg,
+        positions: wp.array(dtype=pos_type),
+    ):
+        element_index, k = wp.tid()
+
+        node_index = fine_space.element_node_index(space_arg, element_index, k)
+        coords = fine_space.node_coords_in_element(space_arg, element_index, k)
+        sample = Sample(element_index, coords, NULL_QP_INDEX, 0.0, NULL_DOF_INDEX, NULL_DOF_INDEX)
+
+        positions[node_index] = fine_geo.cell_position(cell_arg, sample)
+
+    def fill_prolongation_fn(
+        cell_arg: coarse_geo.CellArg,
+        space_arg: coarse_space.SpaceArg,
+        positions: wp.array(dtype=pos_type),
+        unit_block: block_type,
+        rows: wp.array(dtype=int),
+        columns: wp.array(dtype=int),
+        values: wp.array(dtype=block_type),
+    ):
+        fine_node, k = wp.tid()
+
+        sample = coarse_geo.cell_lookup(cell_arg, positions[fine_node])
+        weight = coarse_space.element_inner_weight(space_arg, sample.element_index, sample.element_coords, k)
+
+        # Drop round-off weights of coarse nodes the fine node is not interpolated from,
+        # zero blocks are discarded when building the matrix
+        if wp.abs(weight) < 1.0e-6:
+            weight = 0.0
+
+        i = fine_node * COARSE_NODES_PER_ELEMENT + k
+        rows[i] = fine_node
+        columns[i] = coarse_space.element_node_index(space_arg, sample.element_index, k)
+        values[i] = scalar_type(weight) * unit_block
+
+    suffix = f"{coarse_geo.name}{coarse_space.name}_{fine_geo.name}{fine_space.name}_{scalar_type.__name__}"
+    fill_node_positions = cache.get_kernel(fill_node_positions_fn, suffix=f"{fine_geo.name}{fine_space.name}")
+    fill_prolongation = cache.get_kernel(fill_prolongation_fn, suffix=suffix)
+
+    fine_node_count = fine_space.node_count()
+    positions = wp.empty(shape=fine_node_count, dtype=pos_type, device=device)
+
+    wp.launch(
+        kernel=fill_node_positions,
+        dim=(fine_geo.cell_count(), fine_space.NODES_PER_ELEMENT),
+        inputs=[fine_geo.cell_arg_value(device), fine_space.space_arg_value(device), positions],
+        device=device,
+    )
+
+    triplet_count = fine_node_count * COARSE_NODES_PER_ELEMENT
+    rows = wp.empty(shape=triplet_count, dtype=int, device=device)
+    columns = wp.empty(shape=triplet_count, dtype=int, device=device)
+    values = wp.empty(shape=triplet_count, dtype=block_type, device=device)
+
+    wp.launch(
+        kernel=fill_prolongation,
+        dim=(fine_node_count, COARSE_NODES_PER_ELEMENT),
+        inputs=[
+            coarse_geo.cell_arg_value(device),
+            coarse_space.space_arg_value(device),
+            positions,
+            unit_block,
+            rows,
+            columns,
+            values,
+        ],
+        device=device,
+    )
+
+    P = bsr_zeros(fine_node_count, coarse_space.node_count(), block_type=block_type, device=device)
+    bsr_set_from_triplets(P, rows, columns, values)
+
+    return P
@@ -0,0 +1,130 @@
+import weakref
+
+import warp as wp
+
+from warp.fem.types import ElementIndex, Coords, vec2i
+from warp.fem import cache
+
+from .nodal_function_space import NodalFunctionSpace
+
+
+class SideConnectivity:
+    """Inner and outer cells of each side of a geometry, with the maps from side coordinates to cell coordinates.
+
+    Traces of function spaces look up the neighbour cells of a side and decode its orientation, i.e. the local
+    index of the side in each cell and how its vertices are permuted, for each evaluated weight. The connectivity
+    stores them once per geometry instead, as the affine map from side to cell coordinates that they define,
+    so that face forms, e.g. DG fluxes, can be assembled without recomputing them.
+    """
+
+    @wp.struct
+    class Arg:
+        side_cells: wp.array(dtype=vec2i)
+        cell_transforms: wp.array2d(dtype=wp.mat33)
+        cell_offsets: wp.array2d(dtype=wp.vec3)
+
+    def __init__(self, space: NodalFunctionSpace, device=None):
+        from warp.fem.utils import masked_indices
+
+        geometry = space.geometry
+        side_count = geometry.side_count()
+
+        self.side_cells = wp.empty(shape=(side_count,), dtype=vec2i, device=device)
+        self.cell_transforms = wp.empty(shape=(side_count, 2), dtype=wp.mat33, device=device)
+        self.cell_offsets = wp.empty(shape=(side_count, 2), dtype=wp.vec3, device=device)
+
+        interior_mask = wp.empty(shape=(side_count,), dtype=int, device=device)
+
+        wp.launch(
+            kernel=SideConnectivity._make_build_kernel(space),
+            dim=side_count,
+            inputs=[
+                space.space_arg_value(self.side_cells.device),
+                self.side_cells,
+                self.cell_transforms,
+                self.cell_offsets,
+                interior_mask,
+            ],
+            device=self.side_cells.device,
+        )
+
+        self.interior_sides, _ = masked_indices(interior_mask)
+
+    def arg_value(self, device=None) -> Arg:
+        arg = SideConnectivity.Arg()
+        arg.side_cells = self.side_cells.to(device)
+        arg.cell_transforms = self.cell_transforms.to(device)
+        arg.cell_offsets = self.cell_offsets.to(device)
+        return arg
+
+    def interior_side_count(self) -> int:
+        return self.interior_sides.shape[0]
+
+    @wp.func
+    def cell_index(arg: Arg, side_index: ElementIndex, outer: int):
+        """Index of the inner (``outer == 0``) or outer cell of a side"""
+        return arg.side_cells[side_index][outer]
+
+    @wp.func
+    def cell_coords(arg: Arg, side_index: ElementIndex, outer: int, side_coords: Coords):
+        """Coordinates in the inner (``outer == 0``) or outer cell of a side of a point given in side coordinates"""
+        return arg.cell_transforms[side_index, outer] * side_coords + arg.cell_offsets[side_index, outer]
+
+    @staticmethod
+    def _make_build_kernel(space: NodalFunctionSpace):
+        def build_side_connectivity(
+            space_arg: space.SpaceArg,
+            side_cells: wp.array(dtype=vec2i),
+            cell_transforms: wp.array2d(dtype=wp.mat33),
+            cell_offsets: wp.array2d(dtype=wp.vec3),
+            interior_mask: wp.array(dtype=int),
+        ):
+            side = wp.tid()
+
+            inner = space._inner_cell_index(space_arg, side)
+            outer = space._outer_cell_index(space_arg, side)
+            side_cells[side] = vec2i(inner, outer)
+            interior_mask[side] = wp.select(inner == outer, 1, 0)
+
+            # side to cell coordinates maps are affine, recover them from their values at the unit side coordinates
+            zero = Coords(0.0)
+            x = Coords(1.0, 0.0, 0.0)
+            y = Coords(0.0, 1.0, 0.0)
+            z = Coords(0.0, 0.0, 1.0)
+
+            inner_offset = space._inner_cell_coords(space_arg, side, zero)
+            cell_offsets[side, 0] = inner_offset
+            cell_transforms[side, 0] = wp.mat33(
+                space._inner_cell_coords(space_arg, side, x) - inner_offset,
+                space._inner_cell_coords(space_arg, side, y) - inner_offset,
+                space._inner_cell_coords(space_arg, side, z) - inner_offset,
+            )
+
+            outer_offset = space._outer_cell_coords(space_arg, side, zero)
+            cell_offsets[side, 1] = outer_offset
+            cell_transforms[side, 1] = wp.mat33(
+                space._outer_cell_coords(space_arg, side, x) - outer_offset,
+                space._outer_cell_coords(space_arg, side, y) - outer_offset,
+                space._outer_cell_coords(space_arg, side, z) - outer_offset,
+            )
+
+        return cache.get_kernel(build_side_connectivity, space.name)
+
+
+_side_connectivities = weakref.WeakKeyDictionary()
+
+
+def make_side_connectivity(space: NodalFunctionSpace, device=None) -> SideConnectivity:
+    """Returns the side connectivity of the geometry of a space on a device, built on its first request
+
+    The connectivity only depends on the topology of the geometry, so it is shared by all the nodal spaces defined
+    on it and stays valid when its positions are modified.
+    """
+
+    device = wp.get_device(device)
+
+    connectivities = _side_connectivities.setdefault(space.geometry, {})
+    if device.alias not in connectivities:
+        connectivities[device.alias] = SideConnectivity(space, device=device)
+
+    return connectivities[device.alias]
@@ -76,7 +76,7 @@ def symmetric_part(x: wp.mat33):
 
 
 def compress_node_indices(
-    node_count: int, node_indices: wp.array(dtype=int)
+    node_count: int, node_indices: wp.array(dtype=int), return_unique_nodes: bool = True
 ) -> Tuple[wp.array, wp.array, int, wp.array]:
     """
     Compress an unsorted list of node indices into:
@@ -84,6 +84,8 @@ def compress_node_indices(
      - a sorted_array_indices array, listing the indices in the input array corresponding to each node
      - the number of unique node indices
      - a unique_node_indices array containg the sorted list of unique node indices (i.e. the list of indices i for which node_offsets[i] < node_offsets[i+1])
+
+    If `return_unique_nodes` is False, the last two are returned as None and the compression runs without synchronizing with the host.
     """
 
     index_count = node_indices.size
@@ -106,22 +108,44 @@ def compress_node_indices(
     # Build prefix sum of number of elements per node
     unique_node_indices = wp.empty(n=index_count, dtype=int, device=node_indices.device)
     node_element_counts = wp.empty(n=index_count, dtype=int, device=node_indices.device)
-    unique_node_count = runlength_encode(
-        sorted_node_indices, unique_node_indices, node_element_counts, value_count=index_count
-    )
-
-    # Scatter seen run counts to global array of element count per node
     node_offsets = wp.zeros(shape=(node_count + 1), device=node_element_counts.device, dtype=int)
-    wp.launch(
-        kernel=_scatter_node_counts,
-        dim=unique_node_count,
-        inputs=[node_element_counts, unique_node_indices, node_offsets],
-        device=node_offsets.device,
-    )
+
+    if return_unique_nodes:
+        unique_node_count = runlength_encode(
+            sorted_node_indices, unique_node_indices, node_element_counts, value_count=index_count
+        )
+
+        # Scatter seen run counts to global array of element count per node
+        wp.launch(
+            kernel=_scatter_node_counts,
+            dim=unique_node_count,
+            inputs=[node_element_counts, unique_node_indices, node_offsets],
+            device=node_offsets.device,
+        )
+    else:
+        # Keep the number of runs on device, runs past it are skipped when scattering
+        unique_node_count = wp.empty(shape=(1,), dtype=int, device=node_indices.device)
+        runlength_encode(
+            sorted_node_indices,
+            unique_node_indices,
+            node_element_counts,
+            run_count=unique_node_count,
+            value_count=index_count,
+        )
+
+        wp.launch(
+            kernel=_scatter_node_counts_device_count,
+            dim=index_count,
+            inputs=[unique_node_count, node_element_counts, unique_node_indices, node_offsets],
+            device=node_offsets.device,
+        )
 
     # Prefix sum of number of elements per node
     array_scan(node_offsets, node_offsets, inclusive=True)
 
+    if not return_unique_nodes:
+        return node_offsets, sorted_array_indices, None, None
+
     return node_offsets, sorted_array_indices, unique_node_count, unique_node_indices
 
 
@@ -196,6 +220,18 @@ def _scatter_node_counts(
     node_counts[1 + unique_node_indices[i]] = unique_counts[i]
 
 
+@wp.kernel
+def _scatter_node_counts_device_count(
+    unique_node_count: wp.array(dtype=int),
+    unique_counts: wp.array(dtype=int),
+    unique_node_indices: wp.array(dtype=int),
+    node_counts: wp.array(dtype=int),
+):
+    i = wp.tid()
+    if i < unique_node_count[0]:
+        node_counts[1 + unique_node_indices[i]] = unique_counts[i]
+
+
 @wp.kernel
 def _masked_indices_kernel(
     missing_index: int,
@@ -5,6 +5,9 @@
 # distribution of this software and related documentation without an express
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
+import ctypes
+import struct
+
 import warp
 
 
@@ -44,3 +47,229 @@ def from_jax(jax_array, dtype=None):
     import jax.dlpack
 
     return warp.from_dlpack(jax.dlpack.to_dlpack(jax_array), dtype=dtype)
+
+
+def dtype_to_jax(warp_dtype):
+    """Return the JAX dtype corresponding to a Warp scalar type."""
+    import jax.numpy as jp
+
+    warp_to_jax_dict = {
+        warp.float16: jp.float16,
+        warp.float32: jp.float32,
+        warp.float64: jp.float64,
+        warp.int8: jp.int8,
+        warp.int16: jp.int16,
+        warp.int32: jp.int32,
+        warp.int64: jp.int64,
+        warp.uint8: jp.uint8,
+        warp.uint16: jp.uint16,
+        warp.uint32: jp.uint32,
+        warp.uint64: jp.uint64,
+        warp.bool: jp.bool_,
+    }
+    jax_dtype = warp_to_jax_dict.get(warp_dtype)
+    if jax_dtype is None:
+        raise TypeError(f"Invalid or unsupported data type: {warp_dtype}")
+    return jax_dtype
+
+
+# name of the XLA custom call target that launches Warp kernels
+_custom_call_target = b"warp_call"
+_custom_call_registered = False
+
+_jax_kernel_p = None
+
+
+def _register_custom_call():
+    global _custom_call_registered
+
+    if _custom_call_registered:
+        return
+
+    import jax
+
+    warp.context.assert_initialized()
+
+    capsule_new = ctypes.pythonapi.PyCapsule_New
+    capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+    capsule_new.restype = ctypes.py_object
+
+    target = ctypes.cast(warp.context.runtime.core.cuda_jax_custom_call, ctypes.c_void_p).value
+    capsule = capsule_new(target, b"xla._CUSTOM_CALL_TARGET", None)
+
+    if hasattr(jax, "ffi"):
+        # api_version 0 selects the original custom call ABI
+        jax.ffi.register_ffi_target(_custom_call_target.decode(), capsule, platform="CUDA", api_version=0)
+    else:
+        jax.lib.xla_client.register_custom_call_target(_custom_call_target, capsule, platform="gpu")
+
+    _custom_call_registered = True
+
+
+def _element_info(arg_type):
+    # scalar type and inner shape of an array argument's elements
+    dtype = arg_type.dtype
+    inner_shape = tuple(getattr(dtype, "_shape_", ()))
+    scalar_type = getattr(dtype, "_wp_scalar_type_", dtype)
+    return scalar_type, inner_shape
+
+
+def _launch_descriptor(kernel, launch_dims, shapes):
+    # the launch, the kernel of every JAX GPU device and the packed parameters, read by cuda_jax_custom_call()
+    import jax
+
+    bounds = warp.types.launch_bounds_t(launch_dims)
+
+    entries = []
+    block_dim = 0
+    for jax_device in jax.devices("gpu"):
+        device = device_from_jax(jax_device)
+        if not kernel.module.load(device):
+            raise RuntimeError(f"Failed to load module '{kernel.module.name}' on device {device}")
+
+        hooks = kernel.module.get_kernel_hooks(kernel, device)
+        if hooks.forward is None:
+            raise RuntimeError(f"Failed to find forward kernel '{kernel.key}' on device {device}")
+
+        context = device.context
+        if isinstance(context, ctypes.c_void_p):
+            context = context.value
+        entries.append(struct.pack("<QQ", context, hooks.forward))
+        block_dim = hooks.forward_block_dim
+
+    params = [struct.pack("<ii", ctypes.sizeof(bounds), -1) + _padded(bytes(bounds))]
+    for i, (arg, shape) in enumerate(zip(kernel.adj.args, shapes)):
+        dtype = arg.type.dtype
+        ndim = arg.type.ndim
+        strides = warp.types.strides_from_shape(shape[:ndim], dtype)
+        value = warp.types.array_t(data=0, grad=0, ndim=ndim, shape=shape[:ndim], strides=strides)
+        params.append(struct.pack("<ii", ctypes.sizeof(value), i) + _padded(bytes(value)))
+
+    # JAX launches have no backward pass to store intermediates for
+    if kernel.adj.store_intermediates:
+        params.append(struct.pack("<iiQ", 8, -1, 0))
+
+    header = struct.pack("<Qiiii", bounds.size, block_dim, len(entries), len(params), 0)
+    return header + b"".join(entries) + b"".join(params)
+
+
+def _padded(value):
+    return value + bytes(-len(value) % 8)
+
+
+def _create_jax_kernel_primitive():
+    global _jax_kernel_p
+
+    if _jax_kernel_p is not None:
+        return _jax_kernel_p
+
+    import jax
+    from jax.interpreters import mlir
+
+    if hasattr(mlir, "custom_call"):
+        custom_call = mlir.custom_call
+    else:
+        from jaxlib.hlo_helpers import custom_call
+
+    try:
+        from jax.extend.core import Primitive
+    except ImportError:
+        from jax.core import Primitive
+
+    _jax_kernel_p = Primitive("warp_kernel")
+    _jax_kernel_p.multiple_results = True
+
+    def abstract_eval(*args, kernel, launch_dims, output_shapes):
+        outputs = []
+        for arg, shape in zip(kernel.adj.args[len(args) :], output_shapes):
+            scalar_type, _ = _element_info(arg.type)
+            outputs.append(jax.core.ShapedArray(shape, dtype_to_jax(scalar_type)))
+        return outputs
+
+    def lowering(ctx, *args, kernel, launch_dims, output_shapes):
+        input_shapes = [aval.shape for aval in ctx.avals_in]
+        opaque = _launch_descriptor(kernel, launch_dims, input_shapes + list(output_shapes))
+
+        result_types = [mlir.aval_to_ir_type(aval) for aval in ctx.avals_out]
+
+        # buffers are dense and row-major, which matches the strides in the descriptor
+        def row_major(shape):
+            return list(reversed(range(len(shape))))
+
+        op = custom_call(
+            _custom_call_target,
+            result_types=result_types,
+            operands=list(args),
+            backend_config=opaque,
+            operand_layouts=[row_major(s) for s in input_shapes],
+            result_layouts=[row_major(s) for s in output_shapes],
+        )
+        return op.results if hasattr(op, "results") else op
+
+    _jax_kernel_p.def_abstract_eval(abstract_eval)
+    mlir.register_lowering(_jax_kernel_p, lowering, platform="gpu")
+
+    return _jax_kernel_p
+
+
+def jax_kernel(kernel, launch_dims=None):
+    """Wrap a Warp kernel as a JAX function that can be used inside ``jax.jit``.
+
+    The kernel is launched on XLA's stream through a custom call, with the JAX buffers passed directly to the kernel,
+    so it is ordered with the surrounding operations without host callbacks or synchronization.
+
+    All kernel arguments must be arrays, the function is called with JAX arrays for the leading arguments and returns
+    new arrays for the remaining ones.  The launch dimensions default to the shape of the first input, and each output
+    has the launch shape followed by the inner shape of its data type, e.g. ``(n, 3)`` for an array of ``wp.vec3``.
+    The wrapped kernel runs on CUDA devices only and is not differentiable by JAX.
+
+    Args:
+        kernel: The Warp kernel.
+        launch_dims: The launch dimensions, or None to use the shape of the first input.
+    """
+
+    import jax
+
+    if kernel.is_generic:
+        raise RuntimeError(f"Generic kernel '{kernel.key}' must be specialized with wp.overload() before use with JAX")
+
+    for arg in kernel.adj.args:
+        if not isinstance(arg.type, warp.types.array):
+            raise RuntimeError(f"Argument '{arg.label}' of kernel '{kernel.key}' must be an array to be used with JAX")
+
+    _register_custom_call()
+    primitive = _create_jax_kernel_primitive()
+
+    def wrapper(*args):
+        num_outputs = len(kernel.adj.args) - len(args)
+        if num_outputs < 1:
+            raise RuntimeError(f"Kernel '{kernel.key}' with {len(kernel.adj.args)} arguments has no outputs left")
+
+        for arg, value in zip(kernel.adj.args, args):
+            scalar_type, inner_shape = _element_info(arg.type)
+            if value.dtype != jax.numpy.dtype(dtype_to_jax(scalar_type)) or value.ndim != arg.type.ndim + len(inner_shape):
+                raise RuntimeError(
+                    f"Argument '{arg.label}' of kernel '{kernel.key}' expects a {arg.type.ndim}D array of {arg.type.dtype}, got shape {value.shape} and dtype {value.dtype}"
+                )
+
+        if launch_dims is None:
+            if not args:
+                raise RuntimeError(f"Launch dimensions of kernel '{kernel.key}' are required when there are no inputs")
+            arg = kernel.adj.args[0]
+            dims = tuple(args[0].shape[: arg.type.ndim])
+        else:
+            dims = (launch_dims,) if isinstance(launch_dims, int) else tuple(launch_dims)
+
+        output_shapes = []
+        for arg in kernel.adj.args[len(args) :]:
+            _, inner_shape = _element_info(arg.type)
+            if len(dims) != arg.type.ndim:
+                raise RuntimeError(
+                    f"Output '{arg.label}' of kernel '{kernel.key}' has {arg.type.ndim} dimension(s) but the launch has {len(dims)}"
+                )
+            output_shapes.append(dims + inner_shape)
+
+        outputs = primitive.bind(*args, kernel=kernel, launch_dims=dims, output_shapes=tuple(output_shapes))
+        return outputs[0] if num_outputs == 1 else tuple(outputs)
+
+    return jax.jit(wrapper)
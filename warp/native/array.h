@@ -86,6 +86,17 @@ namespace wp
 
 #endif  // WP_FP_CHECK
 
+#if WP_CHECKED
+
+// modules built in "checked" mode record out-of-bounds indices instead of asserting, see check_index()
+#define WP_CHECK_INDEX(data, dim, i, n) i = check_index(data, dim, i, n)
+
+#else
+
+#define WP_CHECK_INDEX(data, dim, i, n) assert(i >= 0 && i < n)
+
+#endif // WP_CHECKED
+
 const int ARRAY_MAX_DIMS = 4;       // must match constant in types.py
 
 // must match constants in types.py
@@ -213,6 +224,23 @@ struct indexedarray_t
     shape_t shape;  // element count per dimension (num. indices if indexed, array dim if not)
 };
 
+// 1D array of vectors stored as one plane per component (structure of arrays), component c of element i is planes[c, i]
+// so that consecutive threads accessing the same component of their elements access consecutive addresses
+template <typename T>
+struct soaarray_t;
+
+template <unsigned Length, typename Type>
+struct soaarray_t<vec_t<Length, Type>>
+{
+    CUDA_CALLABLE inline soaarray_t() {}
+    CUDA_CALLABLE inline soaarray_t(int) {} // for backward a = 0 initialization syntax
+
+    CUDA_CALLABLE inline bool empty() const { return !planes.data; }
+
+    array_t<Type> planes;  // 2D array of shape (Length, shape[0]), gradients are stored in the planes of planes.grad
+    shape_t shape;
+};
+
 
 // return stride (in bytes) of the given index
 template <typename T>
@@ -236,7 +264,7 @@ CUDA_CALLABLE inline T* grad_at_byte_offset(const array_t<T>& a, size_t byte_off
 template <typename T>
 CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i)
 {
-    assert(i >= 0 && i < arr.shape[0]);
+    WP_CHECK_INDEX(arr.data, 0, i, arr.shape[0]);
     
     return i*stride(arr, 0);
 }
@@ -244,8 +272,8 @@ CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i)
 template <typename T>
 CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i, int j)
 {
-    assert(i >= 0 && i < arr.shape[0]);
-    assert(j >= 0 && j < arr.shape[1]);
+    WP_CHECK_INDEX(arr.data, 0, i, arr.shape[0]);
+    WP_CHECK_INDEX(arr.data, 1, j, arr.shape[1]);
     
     return i*stride(arr, 0) + j*stride(arr, 1);
 }
@@ -253,9 +281,9 @@ CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i, int j)
 template <typename T>
 CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i, int j, int k)
 {
-    assert(i >= 0 && i < arr.shape[0]);
-    assert(j >= 0 && j < arr.shape[1]);
-    assert(k >= 0 && k < arr.shape[2]);
+    WP_CHECK_INDEX(arr.data, 0, i, arr.shape[0]);
+    WP_CHECK_INDEX(arr.data, 1, j, arr.shape[1]);
+    WP_CHECK_INDEX(arr.data, 2, k, arr.shape[2]);
 
     return i*stride(arr, 0) + j*stride(arr, 1) + k*stride(arr, 2);
 }
@@ -263,10 +291,10 @@ CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i, int j, int
 template <typename T>
 CUDA_CALLABLE inline size_t byte_offset(const array_t<T>& arr, int i, int j, int k, int l)
 {
-    assert(i >= 0 && i < arr.shape[0]);
-    assert(j >= 0 && j < arr.shape[1]);
-    assert(k >= 0 && k < arr.shape[2]);
-    assert(l >= 0 && l < arr.shape[3]);
+    WP_CHECK_INDEX(arr.data, 0, i, arr.shape[0]);
+    WP_CHECK_INDEX(arr.data, 1, j, arr.shape[1]);
+    WP_CHECK_INDEX(arr.data, 2, k, arr.shape[2]);
+    WP_CHECK_INDEX(arr.data, 3, l, arr.shape[3]);
 
     return i*stride(arr, 0) + j*stride(arr, 1) + k*stride(arr, 2) + l*stride(arr, 3);
 }
@@ -352,12 +380,12 @@ template <typename T>
 CUDA_CALLABLE inline T& index(const indexedarray_t<T>& iarr, int i)
 {
     assert(iarr.arr.ndim == 1);
-    assert(i >= 0 && i < iarr.shape[0]);
+    WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.shape[0]);
 
     if (iarr.indices[0])
     {
         i = iarr.indices[0][i];
-        assert(i >= 0 && i < iarr.arr.shape[0]);
+        WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.arr.shape[0]);
     }
 
     T& result = *data_at_byte_offset(iarr.arr, byte_offset(iarr.arr, i));
@@ -370,18 +398,18 @@ template <typename T>
 CUDA_CALLABLE inline T& index(const indexedarray_t<T>& iarr, int i, int j)
 {
     assert(iarr.arr.ndim == 2);
-    assert(i >= 0 && i < iarr.shape[0]);
-    assert(j >= 0 && j < iarr.shape[1]);
+    WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.shape[0]);
+    WP_CHECK_INDEX(iarr.arr.data, 1, j, iarr.shape[1]);
 
     if (iarr.indices[0])
     {
         i = iarr.indices[0][i];
-        assert(i >= 0 && i < iarr.arr.shape[0]);
+        WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.arr.shape[0]);
     }
     if (iarr.indices[1])
     {
         j = iarr.indices[1][j];
-        assert(j >= 0 && j < iarr.arr.shape[1]);
+        WP_CHECK_INDEX(iarr.arr.data, 1, j, iarr.arr.shape[1]);
     }
 
     T& result = *data_at_byte_offset(iarr.arr, byte_offset(iarr.arr, i, j));
@@ -394,24 +422,24 @@ template <typename T>
 CUDA_CALLABLE inline T& index(const indexedarray_t<T>& iarr, int i, int j, int k)
 {
     assert(iarr.arr.ndim == 3);
-    assert(i >= 0 && i < iarr.shape[0]);
-    assert(j >= 0 && j < iarr.shape[1]);
-    assert(k >= 0 && k < iarr.shape[2]);
+    WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.shape[0]);
+    WP_CHECK_INDEX(iarr.arr.data, 1, j, iarr.shape[1]);
+    WP_CHECK_INDEX(iarr.arr.data, 2, k, iarr.shape[2]);
 
     if (iarr.indices[0])
     {
         i = iarr.indices[0][i];
-        assert(i >= 0 && i < iarr.arr.shape[0]);
+        WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.arr.shape[0]);
     }
     if (iarr.indices[1])
     {
         j = iarr.indices[1][j];
-        assert(j >= 0 && j < iarr.arr.shape[1]);
+        WP_CHECK_INDEX(iarr.arr.data, 1, j, iarr.arr.shape[1]);
     }
     if (iarr.indices[2])
     {
         k = iarr.indices[2][k];
-        assert(k >= 0 && k < iarr.arr.shape[2]);
+        WP_CHECK_INDEX(iarr.arr.data, 2, k, iarr.arr.shape[2]);
     }
 
     T& result = *data_at_byte_offset(iarr.arr, byte_offset(iarr.arr, i, j, k));
@@ -424,30 +452,30 @@ template <typename T>
 CUDA_CALLABLE inline T& index(const indexedarray_t<T>& iarr, int i, int j, int k, int l)
 {
     assert(iarr.arr.ndim == 4);
-    assert(i >= 0 && i < iarr.shape[0]);
-    assert(j >= 0 && j < iarr.shape[1]);
-    assert(k >= 0 && k < iarr.shape[2]);
-    assert(l >= 0 && l < iarr.shape[3]);
+    WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.shape[0]);
+    WP_CHECK_INDEX(iarr.arr.data, 1, j, iarr.shape[1]);
+    WP_CHECK_INDEX(iarr.arr.data, 2, k, iarr.shape[2]);
+    WP_CHECK_INDEX(iarr.arr.data, 3, l, iarr.shape[3]);
 
     if (iarr.indices[0])
     {
         i = iarr.indices[0][i];
-        assert(i >= 0 && i < iarr.arr.shape[0]);
+        WP_CHECK_INDEX(iarr.arr.data, 0, i, iarr.arr.shape[0]);
     }
     if (iarr.indices[1])
     {
         j = iarr.indices[1][j];
-        assert(j >= 0 && j < iarr.arr.shape[1]);
+        WP_CHECK_INDEX(iarr.arr.data, 1, j, iarr.arr.shape[1]);
     }
     if (iarr.indices[2])
     {
         k = iarr.indices[2][k];
-        assert(k >= 0 && k < iarr.arr.shape[2]);
+        WP_CHECK_INDEX(iarr.arr.data, 2, k, iarr.arr.shape[2]);
     }
     if (iarr.indices[3])
     {
         l = iarr.indices[3][l];
-        assert(l >= 0 && l < iarr.arr.shape[3]);
+        WP_CHECK_INDEX(iarr.arr.data, 3, l, iarr.arr.shape[3]);
     }
 
     T& result = *data_at_byte_offset(iarr.arr, byte_offset(iarr.arr, i, j, k, l));
@@ -461,7 +489,7 @@ template <typename T>
 CUDA_CALLABLE inline array_t<T> view(array_t<T>& src, int i)
 {
     assert(src.ndim > 1);
-    assert(i >= 0 && i < src.shape[0]);
+    WP_CHECK_INDEX(src.data, 0, i, src.shape[0]);
 
     array_t<T> a;
     a.data = data_at_byte_offset(src, byte_offset(src, i));
@@ -480,8 +508,8 @@ template <typename T>
 CUDA_CALLABLE inline array_t<T> view(array_t<T>& src, int i, int j)
 {
     assert(src.ndim > 2);
-    assert(i >= 0 && i < src.shape[0]);
-    assert(j >= 0 && j < src.shape[1]);
+    WP_CHECK_INDEX(src.data, 0, i, src.shape[0]);
+    WP_CHECK_INDEX(src.data, 1, j, src.shape[1]);
 
     array_t<T> a;
     a.data = data_at_byte_offset(src, byte_offset(src, i, j));
@@ -498,9 +526,9 @@ template <typename T>
 CUDA_CALLABLE inline array_t<T> view(array_t<T>& src, int i, int j, int k)
 {
     assert(src.ndim > 3);
-    assert(i >= 0 && i < src.shape[0]);
-    assert(j >= 0 && j < src.shape[1]);
-    assert(k >= 0 && k < src.shape[2]);
+    WP_CHECK_INDEX(src.data, 0, i, src.shape[0]);
+    WP_CHECK_INDEX(src.data, 1, j, src.shape[1]);
+    WP_CHECK_INDEX(src.data, 2, k, src.shape[2]);
 
     array_t<T> a;
     a.data = data_at_byte_offset(src, byte_offset(src, i, j, k));
@@ -519,7 +547,7 @@ CUDA_CALLABLE inline indexedarray_t<T> view(indexedarray_t<T>& src, int i)
 
     if (src.indices[0])
     {
-        assert(i >= 0 && i < src.shape[0]);
+        WP_CHECK_INDEX(src.arr.data, 0, i, src.shape[0]);
         i = src.indices[0][i];
     }
 
@@ -542,12 +570,12 @@ CUDA_CALLABLE inline indexedarray_t<T> view(indexedarray_t<T>& src, int i, int j
 
     if (src.indices[0])
     {
-        assert(i >= 0 && i < src.shape[0]);
+        WP_CHECK_INDEX(src.arr.data, 0, i, src.shape[0]);
         i = src.indices[0][i];
     }
     if (src.indices[1])
     {
-        assert(j >= 0 && j < src.shape[1]);
+        WP_CHECK_INDEX(src.arr.data, 1, j, src.shape[1]);
         j = src.indices[1][j];
     }
 
@@ -568,17 +596,17 @@ CUDA_CALLABLE inline indexedarray_t<T> view(indexedarray_t<T>& src, int i, int j
 
     if (src.indices[0])
     {
-        assert(i >= 0 && i < src.shape[0]);
+        WP_CHECK_INDEX(src.arr.data, 0, i, src.shape[0]);
         i = src.indices[0][i];
     }
     if (src.indices[1])
     {
-        assert(j >= 0 && j < src.shape[1]);
+        WP_CHECK_INDEX(src.arr.data, 1, j, src.shape[1]);
         j = src.indices[1][j];
     }
     if (src.indices[2])
     {
-        assert(k >= 0 && k < src.shape[2]);
+        WP_CHECK_INDEX(src.arr.data, 2, k, src.shape[2]);
         k = src.indices[2][k];
     }
 
@@ -642,6 +670,16 @@ inline CUDA_CALLABLE T atomic_add(const A<T>& buf, int i, int j, int k, T value)
 template<template<typename> class A, typename T>
 inline CUDA_CALLABLE T atomic_add(const A<T>& buf, int i, int j, int k, int l, T value) { return atomic_add(&index(buf, i, j, k, l), value); }
 
+// emitted by codegen in place of atomic_add() for constant indices, see atomic_add_aggregate() in builtin.h
+template<template<typename> class A, typename T>
+inline CUDA_CALLABLE T atomic_add_aggregate(const A<T>& buf, int i, T value) { return atomic_add_aggregate(&index(buf, i), value); }
+template<template<typename> class A, typename T>
+inline CUDA_CALLABLE T atomic_add_aggregate(const A<T>& buf, int i, int j, T value) { return atomic_add_aggregate(&index(buf, i, j), value); }
+template<template<typename> class A, typename T>
+inline CUDA_CALLABLE T atomic_add_aggregate(const A<T>& buf, int i, int j, int k, T value) { return atomic_add_aggregate(&index(buf, i, j, k), value); }
+template<template<typename> class A, typename T>
+inline CUDA_CALLABLE T atomic_add_aggregate(const A<T>& buf, int i, int j, int k, int l, T value) { return atomic_add_aggregate(&index(buf, i, j, k, l), value); }
+
 template<template<typename> class A, typename T>
 inline CUDA_CALLABLE T atomic_sub(const A<T>& buf, int i, T value) { return atomic_add(&index(buf, i), -value); }
 template<template<typename> class A, typename T>
@@ -708,6 +746,66 @@ inline CUDA_CALLABLE void store(const A<T>& buf, int i, int j, int k, int l, T v
 }
 
 // select operator to check for array being null
+// structure of arrays accesses gather and scatter the components of an element across the planes
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE vec_t<Length, Type> load(const soaarray_t<vec_t<Length, Type>>& buf, int i)
+{
+    vec_t<Length, Type> value;
+    for (unsigned c=0; c < Length; ++c)
+        value.c[c] = index(buf.planes, c, i);
+
+    return value;
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE void store(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value)
+{
+    FP_VERIFY_FWD_1(value)
+
+    for (unsigned c=0; c < Length; ++c)
+        index(buf.planes, c, i) = value.c[c];
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE vec_t<Length, Type> atomic_add(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value)
+{
+    vec_t<Length, Type> old;
+    for (unsigned c=0; c < Length; ++c)
+        old.c[c] = atomic_add(&index(buf.planes, c, i), value.c[c]);
+
+    return old;
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE vec_t<Length, Type> atomic_sub(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value)
+{
+    vec_t<Length, Type> old;
+    for (unsigned c=0; c < Length; ++c)
+        old.c[c] = atomic_add(&index(buf.planes, c, i), -value.c[c]);
+
+    return old;
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE vec_t<Length, Type> atomic_min(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value)
+{
+    vec_t<Length, Type> old;
+    for (unsigned c=0; c < Length; ++c)
+        old.c[c] = atomic_min(&index(buf.planes, c, i), value.c[c]);
+
+    return old;
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE vec_t<Length, Type> atomic_max(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value)
+{
+    vec_t<Length, Type> old;
+    for (unsigned c=0; c < Length; ++c)
+        old.c[c] = atomic_max(&index(buf.planes, c, i), value.c[c]);
+
+    return old;
+}
+
 template <typename T1, typename T2>
 CUDA_CALLABLE inline T2 select(const array_t<T1>& arr, const T2& a, const T2& b) { return arr.data?b:a; }
 
@@ -742,6 +840,50 @@ CUDA_CALLABLE inline void adj_atomic_add(uint64* buf, uint64 value) { }
 
 CUDA_CALLABLE inline void adj_atomic_add(bool* buf, bool value) { }
 
+// gradient accumulation aggregated across the active lanes of the warp, emitted by codegen for loads at uniform indices,
+// the first lane issues a single atomic for the warp's sum when all lanes target the same address
+template <typename T>
+CUDA_CALLABLE inline void adj_atomic_add_aggregate(T* buf, T value)
+{
+#if defined(__CUDA_ARCH__)
+    const unsigned int mask = __activemask();
+    const int leader = __ffs(mask) - 1;
+    const int lane = lane_id();
+
+    const unsigned long long address = reinterpret_cast<unsigned long long>(buf);
+    if (sizeof(T) % 4 != 0 || !__all_sync(mask, __shfl_sync(mask, address, leader) == address))
+    {
+        adj_atomic_add(buf, value);
+        return;
+    }
+
+    T sum = value;
+    if (mask == warp::FULL_MASK)
+    {
+        for (int offset = warp::SIZE / 2; offset > 0; offset /= 2)
+            sum = add(sum, warp::shuffle_words(mask, sum, lane ^ offset));
+    }
+    else
+    {
+        // partial warps, the leader combines the values of the other active lanes
+        for (int i = leader + 1; i < warp::SIZE; ++i)
+        {
+            if (mask & (1u << i))
+            {
+                const T x = warp::shuffle_words(mask, value, i);
+                if (lane == leader)
+                    sum = add(sum, x);
+            }
+        }
+    }
+
+    if (lane == leader)
+        adj_atomic_add(buf, sum);
+#else
+    adj_atomic_add(buf, value);
+#endif
+}
+
 // only generate gradients for T types
 template<typename T>
 inline CUDA_CALLABLE void adj_load(const array_t<T>& buf, int i, const array_t<T>& adj_buf, int& adj_i, const T& adj_output)
@@ -768,6 +910,68 @@ inline CUDA_CALLABLE void adj_load(const array_t<T>& buf, int i, int j, int k, i
         adj_atomic_add(&index_grad(buf, i, j, k, l), adj_output);
 }
 
+// emitted by codegen in place of adj_load() for uniform indices, see adj_atomic_add_aggregate()
+template<typename T>
+inline CUDA_CALLABLE void adj_load_aggregate(const array_t<T>& buf, int i, const array_t<T>& adj_buf, int& adj_i, const T& adj_output)
+{
+    if (buf.grad)
+        adj_atomic_add_aggregate(&index_grad(buf, i), adj_output);
+}
+template<typename T>
+inline CUDA_CALLABLE void adj_load_aggregate(const array_t<T>& buf, int i, int j, const array_t<T>& adj_buf, int& adj_i, int& adj_j, const T& adj_output)
+{
+    if (buf.grad)
+        adj_atomic_add_aggregate(&index_grad(buf, i, j), adj_output);
+}
+template<typename T>
+inline CUDA_CALLABLE void adj_load_aggregate(const array_t<T>& buf, int i, int j, int k, const array_t<T>& adj_buf, int& adj_i, int& adj_j, int& adj_k, const T& adj_output)
+{
+    if (buf.grad)
+        adj_atomic_add_aggregate(&index_grad(buf, i, j, k), adj_output);
+}
+template<typename T>
+inline CUDA_CALLABLE void adj_load_aggregate(const array_t<T>& buf, int i, int j, int k, int l, const array_t<T>& adj_buf, int& adj_i, int& adj_j, int& adj_k, int& adj_l, const T& adj_output)
+{
+    if (buf.grad)
+        adj_atomic_add_aggregate(&index_grad(buf, i, j, k, l), adj_output);
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE void adj_load(const soaarray_t<vec_t<Length, Type>>& buf, int i, const soaarray_t<vec_t<Length, Type>>& adj_buf, int& adj_i, const vec_t<Length, Type>& adj_output)
+{
+    if (buf.planes.grad)
+    {
+        for (unsigned c=0; c < Length; ++c)
+            adj_atomic_add(&index_grad(buf.planes, c, i), adj_output.c[c]);
+    }
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE void adj_store(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value, const soaarray_t<vec_t<Length, Type>>& adj_buf, int& adj_i, vec_t<Length, Type>& adj_value)
+{
+    if (buf.planes.grad)
+    {
+        for (unsigned c=0; c < Length; ++c)
+            adj_value.c[c] += index_grad(buf.planes, c, i);
+    }
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE void adj_atomic_add(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value, const soaarray_t<vec_t<Length, Type>>& adj_buf, int& adj_i, vec_t<Length, Type>& adj_value, const vec_t<Length, Type>& adj_ret)
+{
+    adj_store(buf, i, value, adj_buf, adj_i, adj_value);
+}
+
+template <unsigned Length, typename Type>
+inline CUDA_CALLABLE void adj_atomic_sub(const soaarray_t<vec_t<Length, Type>>& buf, int i, vec_t<Length, Type> value, const soaarray_t<vec_t<Length, Type>>& adj_buf, int& adj_i, vec_t<Length, Type>& adj_value, const vec_t<Length, Type>& adj_ret)
+{
+    if (buf.planes.grad)
+    {
+        for (unsigned c=0; c < Length; ++c)
+            adj_value.c[c] -= index_grad(buf.planes, c, i);
+    }
+}
+
 template<typename T>
 inline CUDA_CALLABLE void adj_store(const array_t<T>& buf, int i, T value, const array_t<T>& adj_buf, int& adj_i, T& adj_value)
 {
@@ -799,6 +799,97 @@ inline CUDA_CALLABLE float tanh(float x) { return ::tanhf(x);}
 inline CUDA_CALLABLE float degrees(float x) { return x * RAD_TO_DEG;}
 inline CUDA_CALLABLE float radians(float x) { return x * DEG_TO_RAD;}
 
+// Approximate versions of transcendental functions for kernels trading accuracy for speed, e.g.: noise or shading,
+// mapped to the hardware intrinsics on device and to polynomials accurate to a few ulps over the usual range on host
+namespace approx
+{
+
+// x reduced to [-pi, pi], subtracting multiples of 2pi in two parts to keep the low bits of large arguments
+inline CUDA_CALLABLE float reduce_angle(float x)
+{
+    const float k = ::rintf(x*0.159154943f);
+    return (x - k*6.28125f) - k*1.93530718e-3f;
+}
+
+// odd Taylor polynomial of degree 11 of the sine over [-pi/2, pi/2]
+inline CUDA_CALLABLE float sin_poly(float x)
+{
+    const float x2 = x*x;
+    return x*(1.0f + x2*(-1.0f/6.0f + x2*(1.0f/120.0f + x2*(-1.0f/5040.0f + x2*(1.0f/362880.0f + x2*(-1.0f/39916800.0f))))));
+}
+
+} // namespace approx
+
+inline CUDA_CALLABLE float sin_approx(float x)
+{
+#if defined(__CUDA_ARCH__)
+    return __sinf(x);
+#else
+    // sin(x) = sin(pi - x) brings [-pi, pi] to [-pi/2, pi/2]
+    const float pi = 3.14159265f;
+    x = approx::reduce_angle(x);
+    if (x > 0.5f*pi)
+        x = pi - x;
+    else if (x < -0.5f*pi)
+        x = -pi - x;
+
+    return approx::sin_poly(x);
+#endif
+}
+
+inline CUDA_CALLABLE float cos_approx(float x)
+{
+#if defined(__CUDA_ARCH__)
+    return __cosf(x);
+#else
+    // cos(x) = sin(pi/2 - |x|)
+    x = approx::reduce_angle(x);
+    return approx::sin_poly(1.57079633f - ::fabsf(x));
+#endif
+}
+
+inline CUDA_CALLABLE float exp_approx(float x)
+{
+#if defined(__CUDA_ARCH__)
+    return __expf(x);
+#else
+    // 2^n e^f with n = round(x/ln(2)) in the exponent bits and a polynomial in the remainder |f| <= ln(2)/2,
+    // subtracting n ln(2) in two parts to keep the low bits of large arguments
+    const float n = ::rintf(x*1.44269504f);
+    if (n < -126.0f)
+        return 0.0f;
+    if (n > 127.0f)
+        return INFINITY;
+
+    const float f = (x - n*0.693145752f) - n*1.42860677e-6f;
+    const float p = 1.0f + f*(1.0f + f*(1.0f/2.0f + f*(1.0f/6.0f + f*(1.0f/24.0f + f*(1.0f/120.0f + f*(1.0f/720.0f))))));
+
+    union { float f; int i; } scale;
+    scale.i = (int(n) + 127) << 23;
+    return p*scale.f;
+#endif
+}
+
+inline CUDA_CALLABLE float rsqrt(float x)
+{
+#if defined(__CUDA_ARCH__)
+    return ::rsqrtf(x);
+#else
+    return 1.0f/::sqrtf(x);
+#endif
+}
+
+// double precision callers get the exact functions, half precision ones the single precision approximations
+inline CUDA_CALLABLE double sin_approx(double x) { return ::sin(x); }
+inline CUDA_CALLABLE double cos_approx(double x) { return ::cos(x); }
+inline CUDA_CALLABLE double exp_approx(double x) { return ::exp(x); }
+inline CUDA_CALLABLE double rsqrt(double x) { return 1.0/::sqrt(x); }
+
+inline CUDA_CALLABLE half sin_approx(half x) { return sin_approx(float(x)); }
+inline CUDA_CALLABLE half cos_approx(half x) { return cos_approx(float(x)); }
+inline CUDA_CALLABLE half exp_approx(half x) { return exp_approx(float(x)); }
+inline CUDA_CALLABLE half rsqrt(half x) { return rsqrt(float(x)); }
+
 inline CUDA_CALLABLE double tan(double x) { return ::tan(x); }
 inline CUDA_CALLABLE double sinh(double x) { return ::sinh(x);}
 inline CUDA_CALLABLE double cosh(double x) { return ::cosh(x);}
@@ -964,6 +1055,23 @@ inline CUDA_CALLABLE void adj_sqrt(T x, T& adj_x, T adj_ret)\
         assert(0);\
     })\
 }\
+inline CUDA_CALLABLE void adj_sin_approx(T x, T& adj_x, T adj_ret)\
+{\
+    adj_x += cos_approx(x)*adj_ret;\
+}\
+inline CUDA_CALLABLE void adj_cos_approx(T x, T& adj_x, T adj_ret)\
+{\
+    adj_x -= sin_approx(x)*adj_ret;\
+}\
+inline CUDA_CALLABLE void adj_exp_approx(T x, T& adj_x, T adj_ret)\
+{\
+    adj_x += exp_approx(x)*adj_ret;\
+}\
+inline CUDA_CALLABLE void adj_rsqrt(T x, T& adj_x, T adj_ret)\
+{\
+    T r = rsqrt(x);\
+    adj_x -= T(0.5)*r*r*r*adj_ret;\
+}\
 inline CUDA_CALLABLE void adj_degrees(T x, T& adj_x, T adj_ret)\
 {\
     adj_x += RAD_TO_DEG * adj_ret;\
@@ -1043,13 +1151,42 @@ CUDA_CALLABLE inline void adj_unot(const T& b, T& adj_b, const bool& adj_ret) {
 
 const int LAUNCH_MAX_DIMS = 4;   // should match types.py
 
+// first out-of-bounds access of the kernels of modules built in "checked" mode, must match BoundsChecker in context.py
+struct bounds_check_t
+{
+    uint64 count;   // number of out-of-bounds accesses since the record was cleared
+    uint64 launch;  // launch index of the first one, assigned by the Python runtime
+    uint64 tid;     // thread index of the first one
+    uint64 data;    // data pointer of the array accessed, null for hash grid cells
+    int64 dim;      // dimension of the out-of-bounds index
+    int64 index;
+    int64 shape;    // size of that dimension
+    int64 padding;
+};
+
 struct launch_bounds_t
 {
     int shape[LAUNCH_MAX_DIMS]; // size of each dimension
     int ndim;                   // number of valid dimension
     size_t size;                // total number of threads
+    const int* size_ptr;        // thread count read from memory at launch time for indirect launches, may be null
+    bounds_check_t* check;      // out-of-bounds access record of checked builds, may be null
+    uint64 launch;              // launch index written to the record
 };
 
+// number of threads that execute a launch, indirect launches are issued
+// for their maximum size and the threads past the count in memory exit early
+inline CUDA_CALLABLE size_t launch_size(const launch_bounds_t& b)
+{
+    if (b.size_ptr)
+    {
+        const int n = *b.size_ptr;
+        return n <= 0 ? 0 : (size_t(n) < b.size ? size_t(n) : b.size);
+    }
+
+    return b.size;
+}
+
 #ifdef __CUDACC__
 
 // store launch bounds in shared memory so
@@ -1069,28 +1206,138 @@ __device__ inline void set_launch_bounds(const launch_bounds_t& b)
 
 #else
 
-// for single-threaded CPU we store launch
-// bounds in static memory to share globally
+// for CPU we store launch bounds in
+// static memory to share globally
 static launch_bounds_t s_launchBounds;
-static size_t s_threadIdx;
 
 inline void set_launch_bounds(const launch_bounds_t& b)
 {
     s_launchBounds = b;
 }
+
+#if WP_ENABLE_CPU_PARALLEL
+
+// multithreaded CPU launches execute chunks of the launch on the
+// thread pool, each thread tracks its current index in thread-local
+// storage provided by the runtime
+template <typename F>
+inline void cpu_launch_range(void* context, size_t begin, size_t end)
+{
+    F& kernel = *static_cast<F*>(context);
+    size_t& index = *_wp_thread_index();
+
+    for (size_t i=begin; i < end; ++i)
+    {
+        index = i;
+        kernel();
+    }
+}
+
+template <typename F>
+inline void cpu_launch(size_t n, F kernel)
+{
+    _wp_parallel_for(&cpu_launch_range<F>, &kernel, n);
+}
+
+// kernels compiled with cpu_simd_width process a whole range of
+// threads per call, passing their index to lane_tid() explicitly
+template <typename F>
+inline void cpu_launch_lanes_range(void* context, size_t begin, size_t end)
+{
+    (*static_cast<F*>(context))(begin, end);
+}
+
+template <typename F>
+inline void cpu_launch_lanes(size_t n, F kernel)
+{
+    _wp_parallel_for(&cpu_launch_lanes_range<F>, &kernel, n);
+}
+
+inline size_t cpu_thread_index()
+{
+    return *_wp_thread_index();
+}
+
+#else
+
+static size_t s_threadIdx;
+
+template <typename F>
+inline void cpu_launch(size_t n, F kernel)
+{
+    for (size_t i=0; i < n; ++i)
+    {
+        s_threadIdx = i;
+        kernel();
+    }
+}
+
+template <typename F>
+inline void cpu_launch_lanes(size_t n, F kernel)
+{
+    kernel(size_t(0), n);
+}
+
+inline size_t cpu_thread_index()
+{
+    return s_threadIdx;
+}
+
+#endif // WP_ENABLE_CPU_PARALLEL
+
 #endif
 
 inline CUDA_CALLABLE size_t grid_index()
 {
 #ifdef __CUDACC__
-    // Need to cast at least one of the variables being multiplied so that type promotion happens before the multiplication
-    size_t grid_index = static_cast<size_t>(blockDim.x) * static_cast<size_t>(blockIdx.x) + static_cast<size_t>(threadIdx.x);
+    // Need to cast at least one of the variables being multiplied so that type promotion happens before the multiplication,
+    // launches with more blocks than the x-dim grid limit continue along the grid's y-dim (see cuda_launch_kernel())
+    const size_t block_index = static_cast<size_t>(blockIdx.y) * static_cast<size_t>(gridDim.x) + static_cast<size_t>(blockIdx.x);
+    size_t grid_index = static_cast<size_t>(blockDim.x) * block_index + static_cast<size_t>(threadIdx.x);
     return grid_index;
 #else
-    return s_threadIdx;
+    return cpu_thread_index();
 #endif
 }
 
+#if WP_CHECKED
+
+// records the first out-of-bounds access of checked builds, the later ones are only counted
+inline CUDA_CALLABLE_DEVICE void record_bounds_error(const void* data, int dim, int index, int shape)
+{
+    bounds_check_t* check = s_launchBounds.check;
+    if (!check)
+        return;
+
+#ifdef __CUDA_ARCH__
+    const uint64 count = atomicAdd((unsigned long long*)&check->count, 1ull);
+#else
+    const uint64 count = __atomic_fetch_add(&check->count, uint64(1), __ATOMIC_RELAXED);
+#endif
+
+    if (count == 0)
+    {
+        check->launch = s_launchBounds.launch;
+        check->tid = grid_index();
+        check->data = (uint64)data;
+        check->dim = dim;
+        check->index = index;
+        check->shape = shape;
+    }
+}
+
+// out-of-bounds indices are replaced by 0 after being recorded so that kernels run until the error is reported
+inline CUDA_CALLABLE_DEVICE int check_index(const void* data, int dim, int i, int n)
+{
+    if (i >= 0 && i < n)
+        return i;
+
+    record_bounds_error(data, dim, i, n);
+    return 0;
+}
+
+#endif // WP_CHECKED
+
 inline CUDA_CALLABLE int tid()
 {
     const size_t index = grid_index();
@@ -1144,10 +1391,129 @@ inline CUDA_CALLABLE_DEVICE void tid(int& i, int& j, int& k, int& l)
     l = index%p;
 }
 
+// Thread indices of the given thread of a launch, used by CPU kernels processing consecutive threads in SIMD lanes
+// where the bounds are passed by value so that the compiler knows they are not modified by the stores of the kernel,
+// and by the tasks of persistent CUDA kernels which run the threads of many launches
+inline CUDA_CALLABLE int lane_tid(size_t index, launch_bounds_t bounds)
+{
+    return static_cast<int>(index);
+}
+
+inline CUDA_CALLABLE void lane_tid(size_t index, launch_bounds_t bounds, int& i, int& j)
+{
+    const size_t n = bounds.shape[1];
+
+    i = index/n;
+    j = index%n;
+}
+
+inline CUDA_CALLABLE void lane_tid(size_t index, launch_bounds_t bounds, int& i, int& j, int& k)
+{
+    const size_t n = bounds.shape[1];
+    const size_t o = bounds.shape[2];
+
+    i = index/(n*o);
+    j = index%(n*o)/o;
+    k = index%o;
+}
+
+inline CUDA_CALLABLE void lane_tid(size_t index, launch_bounds_t bounds, int& i, int& j, int& k, int& l)
+{
+    const size_t n = bounds.shape[1];
+    const size_t o = bounds.shape[2];
+    const size_t p = bounds.shape[3];
+
+    i = index/(n*o*p);
+    j = index%(n*o*p)/(o*p);
+    k = index%(o*p)/p;
+    l = index%p;
+}
+
+// Intermediates stored by the forward pass of kernels compiled with store_intermediates and reloaded by their backward pass,
+// the value at byte offset o of each thread lives in a slot at o * size holding the values of all threads contiguously
+template <typename T>
+inline CUDA_CALLABLE void store_intermediate(uint64 buffer, size_t offset, const T& value)
+{
+    if (buffer)
+        reinterpret_cast<T*>(buffer + offset * s_launchBounds.size)[grid_index()] = value;
+}
+
+template <typename T>
+inline CUDA_CALLABLE void load_intermediate(uint64 buffer, size_t offset, T& value)
+{
+    value = reinterpret_cast<const T*>(buffer + offset * s_launchBounds.size)[grid_index()];
+}
+
+// A launch run by the persistent kernel of a module, see CommandList(persistent=True) in context.py, the parameters
+// are the launch bounds followed by the kernel arguments, each one padded to a multiple of 8 bytes
+struct persistent_task_t
+{
+    int kernel;     // index of the kernel in the module's persistent kernel
+    int padding;
+    uint64 params;  // device address of the packed parameters
+};
+
+template <typename T>
+inline CUDA_CALLABLE T persistent_param(const char* params, size_t& offset)
+{
+    const T value = *reinterpret_cast<const T*>(params + offset);
+    offset += (sizeof(T) + 7) & ~size_t(7);
+    return value;
+}
+
+#if defined(__CUDA_ARCH__)
+
+// barrier between the tasks of a persistent kernel, all blocks of its grid are resident at once so they
+// can wait for each other, the counter is zeroed before the launch and reaches gridDim.x at each barrier
+inline __device__ void persistent_grid_sync(unsigned int* counter, unsigned int generation)
+{
+    __syncthreads();
+
+    if (threadIdx.x == 0)
+    {
+        // publish the writes of the block before arriving
+        __threadfence();
+        atomicAdd(counter, 1u);
+
+        const unsigned int expected = generation*gridDim.x;
+        while (*(volatile unsigned int*)counter < expected)
+        {
+        }
+
+        __threadfence();
+    }
+
+    __syncthreads();
+}
+
+#endif
+
+#if !defined(__CUDA_ARCH__) && WP_ENABLE_CPU_PARALLEL
+
+// atomics used by multithreaded CPU launches, implemented as a
+// compare-and-swap loop so they work for any scalar type,
+// relaxed ordering matches the semantics of CUDA atomics
+template <typename T, typename Op>
+inline T cpu_atomic_update(T* buf, Op op)
+{
+    T old;
+    __atomic_load(buf, &old, __ATOMIC_RELAXED);
+
+    T desired = op(old);
+    while (!__atomic_compare_exchange(buf, &old, &desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        desired = op(old);
+
+    return old;
+}
+
+#endif
+
 template<typename T>
 inline CUDA_CALLABLE T atomic_add(T* buf, T value)
 {
-#if !defined(__CUDA_ARCH__)
+#if !defined(__CUDA_ARCH__) && WP_ENABLE_CPU_PARALLEL
+    return cpu_atomic_update(buf, [value](T old) { old += value; return old; });
+#elif !defined(__CUDA_ARCH__)
     T old = buf[0];
     buf[0] += value;
     return old;
@@ -1159,7 +1525,9 @@ inline CUDA_CALLABLE T atomic_add(T* buf, T value)
 template<>
 inline CUDA_CALLABLE float16 atomic_add(float16* buf, float16 value)
 {
-#if !defined(__CUDA_ARCH__)
+#if !defined(__CUDA_ARCH__) && WP_ENABLE_CPU_PARALLEL
+    return cpu_atomic_update(buf, [value](float16 old) { old += value; return old; });
+#elif !defined(__CUDA_ARCH__)
     float16 old = buf[0];
     buf[0] += value;
     return old;
@@ -1210,6 +1578,9 @@ inline CUDA_CALLABLE float atomic_max(float* address, float val)
 
     return __int_as_float(old);
 
+#elif WP_ENABLE_CPU_PARALLEL
+    return cpu_atomic_update(address, [val](float old) { return max(old, val); });
+
 #else
     float old = *address;
     *address = max(old, val);
@@ -1233,6 +1604,9 @@ inline CUDA_CALLABLE float atomic_min(float* address, float val)
 
     return __int_as_float(old);
 
+#elif WP_ENABLE_CPU_PARALLEL
+    return cpu_atomic_update(address, [val](float old) { return min(old, val); });
+
 #else
     float old = *address;
     *address = min(old, val);
@@ -1245,6 +1619,9 @@ inline CUDA_CALLABLE int atomic_max(int* address, int val)
 #if defined(__CUDA_ARCH__)
     return atomicMax(address, val);
 
+#elif WP_ENABLE_CPU_PARALLEL
+    return cpu_atomic_update(address, [val](int old) { return max(old, val); });
+
 #else
     int old = *address;
     *address = max(old, val);
@@ -1258,6 +1635,9 @@ inline CUDA_CALLABLE int atomic_min(int* address, int val)
 #if defined(__CUDA_ARCH__)
     return atomicMin(address, val);
 
+#elif WP_ENABLE_CPU_PARALLEL
+    return cpu_atomic_update(address, [val](int old) { return min(old, val); });
+
 #else
     int old = *address;
     *address = min(old, val);
@@ -1266,8 +1646,224 @@ inline CUDA_CALLABLE int atomic_min(int* address, int val)
 }
 
 
+// warp-level primitives, operating on the active lanes of the calling warp,
+// CPU launches run one thread at a time and behave as warps of a single lane
+namespace warp
+{
+    static constexpr int SIZE = 32;
+    static constexpr unsigned int FULL_MASK = 0xffffffff;
+}
+
+inline CUDA_CALLABLE int lane_id()
+{
+#if defined(__CUDA_ARCH__)
+    return int(threadIdx.x) & (warp::SIZE - 1);
+#else
+    return 0;
+#endif
+}
+
+inline CUDA_CALLABLE uint32 warp_ballot(bool predicate)
+{
+#if defined(__CUDA_ARCH__)
+    return __ballot_sync(__activemask(), predicate);
+#else
+    return predicate ? 1 : 0;
+#endif
+}
+
+inline CUDA_CALLABLE void adj_warp_ballot(bool predicate, bool& adj_predicate, uint32 adj_ret) {}
+
+// value of the given lane, which must be active
+template <typename T>
+inline CUDA_CALLABLE T warp_shuffle(T value, int lane)
+{
+#if defined(__CUDA_ARCH__)
+    return __shfl_sync(__activemask(), value, lane);
+#else
+    return value;
+#endif
+}
+
+// every lane accumulates the adjoints of the lanes that read its value
+template <typename T>
+inline CUDA_CALLABLE void adj_warp_shuffle(T value, int lane, T& adj_value, int& adj_lane, const T& adj_ret)
+{
+#if defined(__CUDA_ARCH__)
+    const unsigned int mask = __activemask();
+    const int self = lane_id();
+
+    for (int i = 0; i < warp::SIZE; ++i)
+    {
+        if (mask & (1u << i))
+        {
+            const int src = __shfl_sync(mask, lane, i);
+            const T adj = __shfl_sync(mask, adj_ret, i);
+            if (src == self)
+                adj_value += adj;
+        }
+    }
+#else
+    adj_value += adj_ret;
+#endif
+}
+
+namespace warp
+{
+
+struct sum_op { template <typename T> CUDA_CALLABLE T operator()(T a, T b) const { return a + b; } };
+struct min_op { template <typename T> CUDA_CALLABLE T operator()(T a, T b) const { return min(a, b); } };
+struct max_op { template <typename T> CUDA_CALLABLE T operator()(T a, T b) const { return max(a, b); } };
+
+// reduction of the values of the active lanes, the result is returned to all of them
+template <typename T, typename Op>
+inline CUDA_CALLABLE T reduce(T value, Op op)
+{
+#if defined(__CUDA_ARCH__)
+    const unsigned int mask = __activemask();
+
+    if (mask == warp::FULL_MASK)
+    {
+        for (int offset = warp::SIZE / 2; offset > 0; offset /= 2)
+            value = op(value, __shfl_xor_sync(mask, value, offset));
+
+        return value;
+    }
+
+    // partial warps, e.g.: at the end of a launch, combine the values of the active lanes in order
+    const int first = __ffs(mask) - 1;
+    T result = __shfl_sync(mask, value, first);
+    for (int i = first + 1; i < warp::SIZE; ++i)
+    {
+        if (mask & (1u << i))
+            result = op(result, __shfl_sync(mask, value, i));
+    }
+
+    return result;
+#else
+    return value;
+#endif
+}
+
+// value of the given lane for types made of 32-bit words, e.g.: vectors and matrices
+template <typename T>
+inline CUDA_CALLABLE T shuffle_words(unsigned int mask, const T& value, int lane)
+{
+#if defined(__CUDA_ARCH__)
+    T result;
+    const unsigned int* src = reinterpret_cast<const unsigned int*>(&value);
+    unsigned int* dst = reinterpret_cast<unsigned int*>(&result);
+
+    for (int w = 0; w < int(sizeof(T) / 4); ++w)
+        dst[w] = __shfl_sync(mask, src[w], lane);
+
+    return result;
+#else
+    return value;
+#endif
+}
+
+// sum of the values of the active lanes below the calling lane
+template <typename T>
+inline CUDA_CALLABLE T exclusive_sum(T value)
+{
+#if defined(__CUDA_ARCH__)
+    const unsigned int mask = __activemask();
+    const int lane = lane_id();
+
+    if (mask == warp::FULL_MASK)
+    {
+        T sum = value;
+        for (int offset = 1; offset < warp::SIZE; offset *= 2)
+        {
+            const T x = __shfl_up_sync(mask, sum, offset);
+            if (lane >= offset)
+                sum += x;
+        }
+
+        return sum - value;
+    }
+
+    T sum = T(0);
+    for (int i = 0; i < warp::SIZE; ++i)
+    {
+        if (mask & (1u << i))
+        {
+            const T x = __shfl_sync(mask, value, i);
+            if (i < lane)
+                sum += x;
+        }
+    }
+
+    return sum;
+#else
+    return T(0);
+#endif
+}
+
+} // namespace warp
+
+template <typename T>
+inline CUDA_CALLABLE T warp_reduce_sum(T value) { return warp::reduce(value, warp::sum_op()); }
+template <typename T>
+inline CUDA_CALLABLE T warp_reduce_min(T value) { return warp::reduce(value, warp::min_op()); }
+template <typename T>
+inline CUDA_CALLABLE T warp_reduce_max(T value) { return warp::reduce(value, warp::max_op()); }
+
+// every lane contributes to the sum returned to all lanes
+template <typename T>
+inline CUDA_CALLABLE void adj_warp_reduce_sum(T value, T& adj_value, const T& adj_ret)
+{
+    adj_value += warp_reduce_sum(adj_ret);
+}
+
+// the lanes holding the extremum receive the adjoints of all lanes
+template <typename T>
+inline CUDA_CALLABLE void adj_warp_reduce_min(T value, T& adj_value, const T& adj_ret)
+{
+    const T total = warp_reduce_sum(adj_ret);
+    if (value == warp_reduce_min(value))
+        adj_value += total;
+}
+
+template <typename T>
+inline CUDA_CALLABLE void adj_warp_reduce_max(T value, T& adj_value, const T& adj_ret)
+{
+    const T total = warp_reduce_sum(adj_ret);
+    if (value == warp_reduce_max(value))
+        adj_value += total;
+}
+
+// atomic add aggregated across the active lanes of the warp, the first lane issues a single atomic for the warp's sum
+// when all lanes target the same address, otherwise every lane issues its own, returns the same values as atomic_add()
+template <typename T>
+inline CUDA_CALLABLE T atomic_add_aggregate(T* buf, T value)
+{
+#if defined(__CUDA_ARCH__)
+    const unsigned int mask = __activemask();
+    const int leader = __ffs(mask) - 1;
+
+    const unsigned long long address = reinterpret_cast<unsigned long long>(buf);
+    if (!__all_sync(mask, __shfl_sync(mask, address, leader) == address))
+        return atomic_add(buf, value);
+
+    const T prefix = warp::exclusive_sum(value);
+    const T total = warp_reduce_sum(value);
+
+    T old = T(0);
+    if (lane_id() == leader)
+        old = atomic_add(buf, total);
+
+    return __shfl_sync(mask, old, leader) + prefix;
+#else
+    return atomic_add(buf, value);
+#endif
+}
+
+
 } // namespace wp
 
+#include "dual.h"
 #include "vec.h"
 #include "mat.h"
 #include "quat.h"
@@ -1508,12 +2104,16 @@ inline CUDA_CALLABLE void adj_expect_near(const vec3& actual, const vec3& expect
 
 // include array.h so we have the print, isfinite functions for the inner array types defined
 #include "array.h"
+#include "topk.h"
 #include "mesh.h"
 #include "bvh.h" 
 #include "svd.h"
 #include "hashgrid.h"
+#include "neighbor_list.h"
 #include "volume.h"
+#include "texture.h"
 #include "range.h"
 #include "rand.h"
 #include "noise.h"
 #include "matnn.h"
+#include "tile.h"
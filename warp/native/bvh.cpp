@@ -37,7 +37,19 @@ private:
     int partition_midpoint(const bounds3* bounds, int* indices, int start, int end, bounds3 range_bounds);
     int partition_sah(const bounds3* bounds, int* indices, int start, int end, bounds3 range_bounds);
 
-    int build_recursive(BVH& bvh, const bounds3* bounds, int* indices, int start, int end, int depth, int parent);
+    // pending subtree, node indices follow the depth-first order of a serial build:
+    // a range of m items always occupies 2m-1 consecutive nodes
+    struct Task
+    {
+        int start;
+        int end;
+        int depth;
+        int parent;
+        int node_index;
+    };
+
+    int build_node(BVH& bvh, const bounds3* bounds, int* indices, const Task& task);
+    int build_recursive(BVH& bvh, const bounds3* bounds, int* indices, const Task& task);
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -63,7 +75,63 @@ void MedianBVHBuilder::build(BVH& bvh, const bounds3* items, int n)
     for (int i=0; i < n; ++i)
         indices[i] = i;
 
-    build_recursive(bvh, items, &indices[0], 0, n, 0, -1);
+    // the top of the tree is split breadth-first with one task per range, once there
+    // are enough ranges each remaining subtree is built depth-first by a single task,
+    // the ranges are disjoint so the result does not depend on the number of threads
+    const int kSerialItems = 4096;
+    const size_t kMaxTasks = 1024;
+
+    std::vector<Task> tasks(1, Task{0, n, 0, -1, 0});
+    std::vector<Task> children;
+
+    while (tasks.size() < kMaxTasks)
+    {
+        bool split_any = false;
+        for (const Task& t : tasks)
+            split_any |= t.end - t.start > kSerialItems;
+
+        if (!split_any)
+            break;
+
+        children.resize(2*tasks.size());
+
+        auto split_task = [&](size_t i)
+        {
+            const Task& t = tasks[i];
+
+            // small ranges are carried over to the depth-first stage unchanged
+            if (t.end - t.start <= kSerialItems)
+            {
+                children[2*i] = t;
+                children[2*i+1].start = -1;
+                return;
+            }
+
+            const int split = build_node(bvh, items, &indices[0], t);
+
+            children[2*i] = Task{t.start, split, t.depth+1, t.node_index, t.node_index+1};
+            children[2*i+1] = Task{split, t.end, t.depth+1, t.node_index, t.node_index + 2*(split-t.start)};
+        };
+
+        _wp_parallel_for_each(tasks.size(), split_task);
+
+        tasks.clear();
+        for (const Task& t : children)
+            if (t.start >= 0)
+                tasks.push_back(t);
+    }
+
+    std::vector<int> depths(tasks.size());
+
+    auto build_task = [&](size_t i)
+    {
+        depths[i] = build_recursive(bvh, items, &indices[0], tasks[i]);
+    };
+
+    _wp_parallel_for_each(tasks.size(), build_task);
+
+    bvh.num_nodes = bvh.max_nodes;
+    bvh.max_depth = *std::max_element(depths.begin(), depths.end());
 }
 
 
@@ -199,17 +267,17 @@ int MedianBVHBuilder::partition_sah(const bounds3* bounds, int* indices, int sta
 }
 #endif
 
-int MedianBVHBuilder::build_recursive(BVH& bvh, const bounds3* bounds, int* indices, int start, int end, int depth, int parent)
+// writes the node of a task and returns the split point of its range, or -1 for leaves
+int MedianBVHBuilder::build_node(BVH& bvh, const bounds3* bounds, int* indices, const Task& task)
 {
-    assert(start < end);
-
-    const int n = end-start;
-    const int node_index = bvh.num_nodes++;
+    const int start = task.start;
+    const int end = task.end;
+    const int node_index = task.node_index;
 
+    assert(start < end);
     assert(node_index < bvh.max_nodes);
 
-    if (depth > bvh.max_depth)
-        bvh.max_depth = depth;
+    const int n = end-start;
 
     bounds3 b = calc_bounds(bounds, indices, start, end);
     
@@ -219,7 +287,9 @@ int MedianBVHBuilder::build_recursive(BVH& bvh, const bounds3* bounds, int* indi
     {
         bvh.node_lowers[node_index] = make_node(b.lower, indices[start], true);
         bvh.node_uppers[node_index] = make_node(b.upper, indices[start], false);
-        bvh.node_parents[node_index] = parent;
+        bvh.node_parents[node_index] = task.parent;
+
+        return -1;
     }
     else    
     {
@@ -232,16 +302,31 @@ int MedianBVHBuilder::build_recursive(BVH& bvh, const bounds3* bounds, int* indi
             // partitioning failed, split down the middle
             split = (start+end)/2;
         }
-    
-        int left_child = build_recursive(bvh, bounds, indices, start, split, depth+1, node_index);
-        int right_child = build_recursive(bvh, bounds, indices, split, end, depth+1, node_index);
+
+        // the left subtree directly follows its parent
+        const int left_child = node_index + 1;
+        const int right_child = node_index + 2*(split-start);
         
         bvh.node_lowers[node_index] = make_node(b.lower, left_child, false);
         bvh.node_uppers[node_index] = make_node(b.upper, right_child, false);
-        bvh.node_parents[node_index] = parent;
+        bvh.node_parents[node_index] = task.parent;
+
+        return split;
     }
+}
+
+// builds the subtree of a task depth-first and returns its maximum depth
+int MedianBVHBuilder::build_recursive(BVH& bvh, const bounds3* bounds, int* indices, const Task& task)
+{
+    const int split = build_node(bvh, bounds, indices, task);
 
-    return node_index;
+    if (split < 0)
+        return task.depth;
+
+    const int left_depth = build_recursive(bvh, bounds, indices, Task{task.start, split, task.depth+1, task.node_index, task.node_index+1});
+    const int right_depth = build_recursive(bvh, bounds, indices, Task{split, task.end, task.depth+1, task.node_index, task.node_index + 2*(split-task.start)});
+
+    return max(left_depth, right_depth);
 }
 
 class LinearBVHBuilderCPU
@@ -394,7 +479,7 @@ int LinearBVHBuilderCPU::build_recursive(BVH& bvh, const KeyIndexPair* keys, con
 
 
 
-// create only happens on host currently, use bvh_clone() to transfer BVH To device
+// builds on the host, use bvh_clone() to transfer a host BVH to device or bvh_create_device() to build directly on the device
 BVH bvh_create(const bounds3* bounds, int num_bounds)
 {
     BVH bvh;
@@ -413,9 +498,13 @@ void bvh_destroy_host(BVH& bvh)
     delete[] bvh.node_uppers;
     delete[] bvh.node_parents;
 	delete[] bvh.bounds;
+    delete[] bvh.wide_nodes;
+    delete[] bvh.wide_sources;
 
     bvh.node_lowers = NULL;
     bvh.node_uppers = NULL;
+    bvh.wide_nodes = NULL;
+    bvh.wide_sources = NULL;
     bvh.max_nodes = 0;
     bvh.num_nodes = 0;
     bvh.num_bounds = 0;
@@ -430,6 +519,12 @@ void bvh_destroy_device(BVH& bvh)
     free_device(WP_CURRENT_CONTEXT, bvh.node_parents); bvh.node_parents = NULL;
     free_device(WP_CURRENT_CONTEXT, bvh.node_counts); bvh.node_counts = NULL;
     free_device(WP_CURRENT_CONTEXT, bvh.bounds); bvh.bounds = NULL;
+    free_device(WP_CURRENT_CONTEXT, bvh.wide_nodes); bvh.wide_nodes = NULL;
+    free_device(WP_CURRENT_CONTEXT, bvh.wide_sources); bvh.wide_sources = NULL;
+    free_device(WP_CURRENT_CONTEXT, bvh.level_nodes); bvh.level_nodes = NULL;
+
+    delete[] bvh.level_offsets; bvh.level_offsets = NULL;
+    bvh.num_levels = 0;
 }
 
 BVH bvh_clone(void* context, const BVH& bvh_host)
@@ -452,9 +547,68 @@ BVH bvh_clone(void* context, const BVH& bvh_host)
     memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device.node_parents, bvh_host.node_parents, sizeof(int)*bvh_host.max_nodes);
 	memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device.bounds, bvh_host.bounds, sizeof(bounds3)*bvh_host.num_bounds);
 
+    if (bvh_host.wide_nodes)
+    {
+        bvh_device.wide_nodes = (BVHWideNode*)alloc_device(WP_CURRENT_CONTEXT, sizeof(BVHWideNode)*bvh_host.num_wide_nodes);
+        bvh_device.wide_sources = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*BVH_WIDE_WIDTH*bvh_host.num_wide_nodes);
+
+        memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device.wide_nodes, bvh_host.wide_nodes, sizeof(BVHWideNode)*bvh_host.num_wide_nodes);
+        memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device.wide_sources, bvh_host.wide_sources, sizeof(int)*BVH_WIDE_WIDTH*bvh_host.num_wide_nodes);
+    }
+
     return bvh_device;
 }
 
+void* clone_buffer_device(void* context, const void* src, size_t size)
+{
+    if (!src || !size)
+        return NULL;
+
+    void* dest = alloc_device(context, size);
+
+    // cudaMemcpyDefault resolves the source device through UVA, the copy is direct when peer access is enabled
+    memcpy_peer(context, dest, (void*)src, size);
+
+    return dest;
+}
+
+BVH bvh_clone_device(void* context, const BVH& bvh_src)
+{
+    ContextGuard guard(context);
+
+    BVH bvh = bvh_src;
+
+    bvh.context = context ? context : cuda_context_get_current();
+
+    bvh.node_lowers = (BVHPackedNodeHalf*)clone_buffer_device(WP_CURRENT_CONTEXT, bvh_src.node_lowers, sizeof(BVHPackedNodeHalf)*bvh_src.max_nodes);
+    bvh.node_uppers = (BVHPackedNodeHalf*)clone_buffer_device(WP_CURRENT_CONTEXT, bvh_src.node_uppers, sizeof(BVHPackedNodeHalf)*bvh_src.max_nodes);
+    bvh.node_parents = (int*)clone_buffer_device(WP_CURRENT_CONTEXT, bvh_src.node_parents, sizeof(int)*bvh_src.max_nodes);
+    bvh.bounds = (bounds3*)clone_buffer_device(WP_CURRENT_CONTEXT, bvh_src.bounds, sizeof(bounds3)*bvh_src.num_bounds);
+
+    // child counters are scratch space of the refits, they are cleared before use
+    bvh.node_counts = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*bvh_src.max_nodes);
+
+    if (bvh_src.wide_nodes)
+    {
+        bvh.wide_nodes = (BVHWideNode*)clone_buffer_device(WP_CURRENT_CONTEXT, bvh_src.wide_nodes, sizeof(BVHWideNode)*bvh_src.num_wide_nodes);
+        bvh.wide_sources = (int*)clone_buffer_device(WP_CURRENT_CONTEXT, bvh_src.wide_sources, sizeof(int)*BVH_WIDE_WIDTH*bvh_src.num_wide_nodes);
+    }
+
+    if (bvh_src.level_nodes)
+    {
+        const int num_level_nodes = bvh_src.level_offsets[bvh_src.num_levels];
+
+        // keep a non-NULL schedule for single leaf roots, see bvh_build_refit_levels_device()
+        bvh.level_nodes = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*std::max(1, num_level_nodes));
+        memcpy_peer(WP_CURRENT_CONTEXT, bvh.level_nodes, bvh_src.level_nodes, sizeof(int)*num_level_nodes);
+
+        bvh.level_offsets = new int[bvh_src.num_levels+1];
+        std::copy(bvh_src.level_offsets, bvh_src.level_offsets + bvh_src.num_levels + 1, bvh.level_offsets);
+    }
+
+    return bvh;
+}
+
 void bvh_refit_recursive(BVH& bvh, int index, const bounds3* bounds)
 {
     BVHPackedNodeHalf& lower = bvh.node_lowers[index];
@@ -495,6 +649,207 @@ void bvh_refit_recursive(BVH& bvh, int index, const bounds3* bounds)
 void bvh_refit_host(BVH& bvh, const bounds3* b)
 {
     bvh_refit_recursive(bvh, 0, b);
+
+    if (bvh.wide_nodes)
+        bvh_refit_wide_host(bvh);
+}
+
+// collapses the binary subtree at node_index into wide nodes, each node adopts
+// up to four descendants by repeatedly opening its largest internal child
+static int bvh_collapse_wide_recursive(const BVHPackedNodeHalf* lowers, const BVHPackedNodeHalf* uppers, int node_index, int depth,
+                                       std::vector<BVHWideNode>& nodes, std::vector<int>& sources, int& max_depth)
+{
+    const int wide_index = int(nodes.size());
+
+    nodes.push_back(BVHWideNode());
+    sources.resize(sources.size() + BVH_WIDE_WIDTH, -1);
+
+    max_depth = std::max(max_depth, depth);
+
+    int children[BVH_WIDE_WIDTH];
+    int num_children = 0;
+
+    if (lowers[node_index].b)
+    {
+        // single leaf tree
+        children[num_children++] = node_index;
+    }
+    else
+    {
+        children[num_children++] = lowers[node_index].i;
+        children[num_children++] = uppers[node_index].i;
+    }
+
+    while (num_children < BVH_WIDE_WIDTH)
+    {
+        int best = -1;
+        float best_area = -1.0f;
+
+        for (int k=0; k < num_children; ++k)
+        {
+            const int c = children[k];
+            if (lowers[c].b)
+                continue;
+
+            const float area = bounds3(vec3(lowers[c].x, lowers[c].y, lowers[c].z), vec3(uppers[c].x, uppers[c].y, uppers[c].z)).area();
+            if (area > best_area)
+            {
+                best = k;
+                best_area = area;
+            }
+        }
+
+        if (best < 0)
+            break;
+
+        const int c = children[best];
+        children[best] = lowers[c].i;
+        children[num_children++] = uppers[c].i;
+    }
+
+    for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+    {
+        int ref = BVH_WIDE_EMPTY;
+
+        if (k < num_children)
+        {
+            const int c = children[k];
+            sources[wide_index*BVH_WIDE_WIDTH + k] = c;
+
+            if (lowers[c].b)
+                ref = ~int(lowers[c].i);
+            else
+                ref = bvh_collapse_wide_recursive(lowers, uppers, c, depth+1, nodes, sources, max_depth);
+        }
+
+        // nodes may have been reallocated by the recursion
+        nodes[wide_index].children[k] = ref;
+    }
+
+    return wide_index;
+}
+
+void bvh_collapse_wide(const BVHPackedNodeHalf* lowers, const BVHPackedNodeHalf* uppers, int root, std::vector<BVHWideNode>& nodes, std::vector<int>& sources, int& depth)
+{
+    nodes.clear();
+    sources.clear();
+    depth = 0;
+
+    bvh_collapse_wide_recursive(lowers, uppers, root, 1, nodes, sources, depth);
+}
+
+void bvh_refit_wide_host(BVH& bvh)
+{
+    for (int i=0; i < bvh.num_wide_nodes; ++i)
+        bvh_refit_wide_node(bvh, i);
+}
+
+// breadth-first grouping of the internal nodes by depth, each level is sorted by node index
+void bvh_compute_refit_levels(const BVHPackedNodeHalf* lowers, const BVHPackedNodeHalf* uppers, int root, std::vector<int>& nodes, std::vector<int>& offsets)
+{
+    nodes.clear();
+    offsets.clear();
+
+    std::vector<int> level;
+    std::vector<int> next;
+
+    if (!lowers[root].b)
+        level.push_back(root);
+
+    while (!level.empty())
+    {
+        std::sort(level.begin(), level.end());
+
+        offsets.push_back(int(nodes.size()));
+        nodes.insert(nodes.end(), level.begin(), level.end());
+
+        next.clear();
+        for (int n : level)
+        {
+            const int left = lowers[n].i;
+            const int right = uppers[n].i;
+
+            if (!lowers[left].b)
+                next.push_back(left);
+            if (!lowers[right].b)
+                next.push_back(right);
+        }
+
+        level.swap(next);
+    }
+
+    offsets.push_back(int(nodes.size()));
+}
+
+void bvh_build_wide_host(BVH& bvh)
+{
+    delete[] bvh.wide_nodes;
+    delete[] bvh.wide_sources;
+
+    bvh.wide_nodes = NULL;
+    bvh.wide_sources = NULL;
+    bvh.num_wide_nodes = 0;
+    bvh.wide_depth = 0;
+
+    if (bvh.num_nodes == 0)
+        return;
+
+    std::vector<BVHWideNode> nodes;
+    std::vector<int> sources;
+    bvh_collapse_wide(bvh.node_lowers, bvh.node_uppers, bvh.root, nodes, sources, bvh.wide_depth);
+
+    bvh.num_wide_nodes = int(nodes.size());
+    bvh.wide_nodes = new BVHWideNode[nodes.size()];
+    bvh.wide_sources = new int[sources.size()];
+
+    std::copy(nodes.begin(), nodes.end(), bvh.wide_nodes);
+    std::copy(sources.begin(), sources.end(), bvh.wide_sources);
+
+    bvh_refit_wide_host(bvh);
+}
+
+// depth-first dual traversal, self overlaps expand the node pairs with bvh_overlap_expand_self()
+static void bvh_query_overlap_host(const BVH& a, const BVH& b, const transform& xform, float margin, bool self_overlap, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    int count = 0;
+
+    if (a.num_nodes && b.num_nodes)
+    {
+        std::vector<vec2i> stack(1, vec2i(a.root, b.root));
+
+        while (!stack.empty())
+        {
+            const vec2i pair = stack.back();
+            stack.pop_back();
+
+            vec2i children[3];
+            bool leaf;
+            const int n = self_overlap ? bvh_overlap_expand_self(a, margin, pair, children, leaf) : bvh_overlap_expand(a, b, xform, margin, pair, children, leaf);
+
+            if (leaf)
+            {
+                if (count < max_pairs)
+                    pairs[count] = bvh_overlap_items(a, b, pair, self_overlap);
+
+                ++count;
+            }
+
+            for (int i=n-1; i >= 0; --i)
+                stack.push_back(children[i]);
+        }
+    }
+
+    *pair_count = count;
+}
+
+void bvh_query_bvh_overlap_host(const BVH& a, const BVH& b, const transform& xform, float margin, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_overlap_host(a, b, xform, margin, false, pairs, max_pairs, pair_count);
+}
+
+void bvh_query_self_overlap_host(const BVH& a, float margin, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_overlap_host(a, a, transform_identity<float>(), margin, true, pairs, max_pairs, pair_count);
 }
 
 
@@ -564,48 +919,6 @@ uint64_t bvh_create_host(vec3* lowers, vec3* uppers, int num_bounds)
     return (uint64_t)bvh;
 }
 
-uint64_t bvh_create_device(void* context, vec3* lowers, vec3* uppers, int num_bounds)
-{
-    ContextGuard guard(context);
-
-    // todo: BVH creation only on CPU at the moment so temporarily bring all the data back to host
-    vec3* lowers_host = (vec3*)alloc_host(sizeof(vec3)*num_bounds);
-    vec3* uppers_host = (vec3*)alloc_host(sizeof(vec3)*num_bounds);
-    bounds3* bounds_host = (bounds3*)alloc_host(sizeof(bounds3)*num_bounds);
-
-    memcpy_d2h(WP_CURRENT_CONTEXT, lowers_host, lowers, sizeof(vec3)*num_bounds);
-    memcpy_d2h(WP_CURRENT_CONTEXT, uppers_host, uppers, sizeof(vec3)*num_bounds);
-    cuda_context_synchronize(WP_CURRENT_CONTEXT);
-
-    for (int i=0; i < num_bounds; ++i)
-    {
-        bounds_host[i] = bounds3();
-        bounds_host[i].lower = lowers_host[i];
-        bounds_host[i].upper = uppers_host[i];
-    }
-
-    BVH bvh_host = bvh_create(bounds_host, num_bounds);
-    bvh_host.context = context ? context : cuda_context_get_current();
-	bvh_host.bounds = bounds_host;
-    bvh_host.num_bounds = num_bounds;        
-    BVH bvh_device_clone = bvh_clone(WP_CURRENT_CONTEXT, bvh_host);
-
-	bvh_device_clone.lowers = lowers;		// managed by the user
-	bvh_device_clone.uppers = uppers;		// managed by the user
-
-    BVH* bvh_device = (BVH*)alloc_device(WP_CURRENT_CONTEXT, sizeof(BVH));
-    memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device, &bvh_device_clone, sizeof(BVH));
-
-    bvh_destroy_host(bvh_host);
-    free_host(lowers_host);
-    free_host(uppers_host);
-
-    uint64_t bvh_id = (uint64_t)bvh_device;
-    bvh_add_descriptor(bvh_id, bvh_device_clone);
-
-    return bvh_id;
-}
-
 void bvh_refit_host(uint64_t id)
 {
     BVH* bvh = (BVH*)(id);
@@ -620,6 +933,22 @@ void bvh_refit_host(uint64_t id)
     bvh_refit_host(*bvh, bvh->bounds);
 }
 
+void bvh_build_wide_host(uint64_t id)
+{
+    BVH* bvh = (BVH*)(id);
+    bvh_build_wide_host(*bvh);
+}
+
+void bvh_query_bvh_overlap_host(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_bvh_overlap_host(*(BVH*)id_a, *(BVH*)id_b, *xform, margin, pairs, max_pairs, pair_count);
+}
+
+void bvh_query_self_overlap_host(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_self_overlap_host(*(BVH*)id, margin, pairs, max_pairs, pair_count);
+}
+
 void bvh_destroy_host(uint64_t id)
 {
     BVH* bvh = (BVH*)(id);
@@ -634,17 +963,76 @@ void bvh_destroy_device(uint64_t id)
     if (bvh_get_descriptor(id, bvh))
     {
         bvh_destroy_device(bvh);
-        mesh_rem_descriptor(id);
+
+        ContextGuard guard(bvh.context);
+        free_device(WP_CURRENT_CONTEXT, (BVH*)id);
+
+        bvh_rem_descriptor(id);
     }
 }
 
+uint64_t bvh_clone_to_device(void* context, uint64_t id, wp::vec3* lowers, wp::vec3* uppers)
+{
+    BVH bvh_src;
+    if (!bvh_get_descriptor(id, bvh_src))
+        return 0;
+
+    ContextGuard guard(context);
+
+    BVH bvh = bvh_clone_device(WP_CURRENT_CONTEXT, bvh_src);
+
+    bvh.lowers = lowers;		// managed by the user
+    bvh.uppers = uppers;		// managed by the user
+
+    BVH* bvh_device = (BVH*)alloc_device(WP_CURRENT_CONTEXT, sizeof(BVH));
+    memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device, &bvh, sizeof(BVH));
+
+    uint64_t bvh_id = (uint64_t)bvh_device;
+    bvh_add_descriptor(bvh_id, bvh);
+
+    return bvh_id;
+}
+
 // stubs for non-CUDA platforms
 #if !WP_ENABLE_CUDA
 
+namespace wp
+{
+
+BVH bvh_create_device(void* context, const bounds3* bounds, int num_bounds)
+{
+    BVH bvh;
+    memset(&bvh, 0, sizeof(bvh));
+    return bvh;
+}
+
+} // namespace wp
+
+uint64_t bvh_create_device(void* context, wp::vec3* lowers, wp::vec3* uppers, int num_bounds)
+{
+    return 0;
+}
+
 void bvh_refit_device(uint64_t id)
 {
 }
 
+void bvh_build_wide_device(uint64_t id)
+{
+}
+
+void bvh_build_refit_levels_device(uint64_t id)
+{
+}
+
+void bvh_query_bvh_overlap_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+}
+
+void bvh_query_self_overlap_device(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+}
+
 
 
 #endif // !WP_ENABLE_CUDA
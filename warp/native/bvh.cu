@@ -9,6 +9,7 @@
 #include "warp.h"
 #include "cuda_util.h"
 #include "bvh.h"
+#include "sort.h"
 
 #include <vector>
 #include <algorithm>
@@ -16,99 +17,252 @@
 #include <cuda.h>
 #include <cuda_runtime_api.h>
 
+#define THRUST_IGNORE_CUB_VERSION_CHECK
+
+#include <cub/cub.cuh>
+
 namespace wp
 {
 
-__global__ void bvh_refit_kernel(int n, const int* __restrict__ parents, int* __restrict__ child_count, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const bounds3* bounds)
+// walks up from a leaf, the last child to arrive at a node computes its bounds
+__device__ inline void bvh_refit_node(int index, const int* __restrict__ parents, int* __restrict__ child_count, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const bounds3* bounds)
 {
-    int index = blockDim.x*blockIdx.x + threadIdx.x;
+    bool leaf = lowers[index].b;
 
-    if (index < n)
+    if (leaf)
     {
-        bool leaf = lowers[index].b;
+        // update the leaf node
+        const int leaf_index = lowers[index].i;
+        const bounds3& b = bounds[leaf_index];
 
-        if (leaf)
+        make_node(lowers+index, b.lower, leaf_index, true);
+        make_node(uppers+index, b.upper, 0, false);
+    }
+    else
+    {
+        // only keep leaf threads
+        return;
+    }
+
+    // update hierarchy
+    for (;;)
+    {
+        int parent = parents[index];
+        
+        // reached root
+        if (parent == -1)
+            return;
+
+        // ensure all writes are visible
+        __threadfence();
+     
+        int finished = atomicAdd(&child_count[parent], 1);
+
+        // if we have are the last thread (such that the parent node is now complete)
+        // then update its bounds and move onto the the next parent in the hierarchy
+        if (finished == 1)
         {
-            // update the leaf node
-            const int leaf_index = lowers[index].i;
-            const bounds3& b = bounds[leaf_index];
+            const int left_child = lowers[parent].i;
+            const int right_child = uppers[parent].i;
+
+            vec3 left_lower = vec3(lowers[left_child].x,
+                                   lowers[left_child].y, 
+                                   lowers[left_child].z);
 
-            make_node(lowers+index, b.lower, leaf_index, true);
-            make_node(uppers+index, b.upper, 0, false);
+            vec3 left_upper = vec3(uppers[left_child].x,
+                                   uppers[left_child].y, 
+                                   uppers[left_child].z);
+
+            vec3 right_lower = vec3(lowers[right_child].x,
+                                   lowers[right_child].y,
+                                   lowers[right_child].z);
+
+
+            vec3 right_upper = vec3(uppers[right_child].x, 
+                                   uppers[right_child].y, 
+                                   uppers[right_child].z);
+
+            // union of child bounds
+            vec3 lower = min(left_lower, right_lower);
+            vec3 upper = max(left_upper, right_upper);
+            
+            // write new BVH nodes
+            make_node(lowers+parent, lower, left_child, false);
+            make_node(uppers+parent, upper, right_child, false);
+
+            // move onto processing the parent
+            index = parent;
         }
         else
         {
-            // only keep leaf threads
-            return;
+            // parent not ready (we are the first child), terminate thread
+            break;
         }
+    }		
+}
 
-        // update hierarchy
-        for (;;)
-        {
-            int parent = parents[index];
-            
-            // reached root
-            if (parent == -1)
-                return;
+__global__ void bvh_refit_kernel(int n, const int* __restrict__ parents, int* __restrict__ child_count, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const bounds3* bounds)
+{
+    int index = blockDim.x*blockIdx.x + threadIdx.x;
 
-            // ensure all writes are visible
-            __threadfence();
-         
-            int finished = atomicAdd(&child_count[parent], 1);
+    if (index < n)
+        bvh_refit_node(index, parents, child_count, lowers, uppers, bounds);
+}
 
-            // if we have are the last thread (such that the parent node is now complete)
-            // then update its bounds and move onto the the next parent in the hierarchy
-            if (finished == 1)
-            {
-                const int left_child = lowers[parent].i;
-                const int right_child = uppers[parent].i;
 
-                vec3 left_lower = vec3(lowers[left_child].x,
-                                       lowers[left_child].y, 
-                                       lowers[left_child].z);
+__global__ void bvh_refit_leaves_kernel(int n, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const bounds3* bounds)
+{
+    int index = blockDim.x*blockIdx.x + threadIdx.x;
 
-                vec3 left_upper = vec3(uppers[left_child].x,
-                                       uppers[left_child].y, 
-                                       uppers[left_child].z);
+    if (index < n && lowers[index].b)
+    {
+        const int leaf_index = lowers[index].i;
+        const bounds3& b = bounds[leaf_index];
 
-                vec3 right_lower = vec3(lowers[right_child].x,
-                                       lowers[right_child].y,
-                                       lowers[right_child].z);
+        make_node(lowers+index, b.lower, leaf_index, true);
+        make_node(uppers+index, b.upper, 0, false);
+    }
+}
 
+// one thread per internal node of a single level, children were written by the previous launch
+__global__ void bvh_refit_level_kernel(int n, const int* __restrict__ nodes, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    int index = blockDim.x*blockIdx.x + threadIdx.x;
 
-                vec3 right_upper = vec3(uppers[right_child].x, 
-                                       uppers[right_child].y, 
-                                       uppers[right_child].z);
+    if (index < n)
+    {
+        const int node = nodes[index];
 
-                // union of child bounds
-                vec3 lower = min(left_lower, right_lower);
-                vec3 upper = max(left_upper, right_upper);
-                
-                // write new BVH nodes
-                make_node(lowers+parent, lower, left_child, false);
-                make_node(uppers+parent, upper, right_child, false);
+        const int left_child = lowers[node].i;
+        const int right_child = uppers[node].i;
 
-                // move onto processing the parent
-                index = parent;
-            }
-            else
-            {
-                // parent not ready (we are the first child), terminate thread
-                break;
-            }
-        }		
+        const BVHPackedNodeHalf left_lower = lowers[left_child];
+        const BVHPackedNodeHalf left_upper = uppers[left_child];
+        const BVHPackedNodeHalf right_lower = lowers[right_child];
+        const BVHPackedNodeHalf right_upper = uppers[right_child];
+
+        vec3 lower = min(vec3(left_lower.x, left_lower.y, left_lower.z), vec3(right_lower.x, right_lower.y, right_lower.z));
+        vec3 upper = max(vec3(left_upper.x, left_upper.y, left_upper.z), vec3(right_upper.x, right_upper.y, right_upper.z));
+
+        make_node(lowers+node, lower, left_child, false);
+        make_node(uppers+node, upper, right_child, false);
     }
 }
 
-
 void bvh_refit_device(BVH& bvh, const bounds3* b)
 {
     ContextGuard guard(bvh.context);
 
-    // clear child counters
-    memset_device(WP_CURRENT_CONTEXT, bvh.node_counts, 0, sizeof(int)*bvh.max_nodes);
+    if (bvh.level_nodes)
+    {
+        // leaves first, then internal nodes from the deepest level up to the root
+        wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_leaves_kernel, bvh.num_nodes, (bvh.num_nodes, bvh.node_lowers, bvh.node_uppers, b));
+
+        for (int level=bvh.num_levels-1; level >= 0; --level)
+        {
+            const int start = bvh.level_offsets[level];
+            const int count = bvh.level_offsets[level+1] - start;
+
+            wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_level_kernel, count, (count, bvh.level_nodes + start, bvh.node_lowers, bvh.node_uppers));
+        }
+    }
+    else
+    {
+        // clear child counters
+        memset_device(WP_CURRENT_CONTEXT, bvh.node_counts, 0, sizeof(int)*bvh.max_nodes);
+
+        wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_kernel, bvh.max_nodes, (bvh.max_nodes, bvh.node_parents, bvh.node_counts, bvh.node_lowers, bvh.node_uppers, b));
+    }
+
+    if (bvh.wide_nodes)
+        bvh_refit_wide_device(bvh);
+}
+
+__global__ void bvh_refit_wide_kernel(BVH bvh)
+{
+    const int tid = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (tid < bvh.num_wide_nodes)
+        bvh_refit_wide_node(bvh, tid);
+}
+
+void bvh_refit_wide_device(BVH& bvh)
+{
+    ContextGuard guard(bvh.context);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_wide_kernel, bvh.num_wide_nodes, (bvh));
+}
+
+// defined in bvh.cpp
+void bvh_collapse_wide(const BVHPackedNodeHalf* lowers, const BVHPackedNodeHalf* uppers, int root, std::vector<BVHWideNode>& nodes, std::vector<int>& sources, int& depth);
+void bvh_compute_refit_levels(const BVHPackedNodeHalf* lowers, const BVHPackedNodeHalf* uppers, int root, std::vector<int>& nodes, std::vector<int>& offsets);
+
+void bvh_build_refit_levels_device(BVH& bvh)
+{
+    ContextGuard guard(bvh.context);
+
+    free_device(WP_CURRENT_CONTEXT, bvh.level_nodes); bvh.level_nodes = NULL;
+    delete[] bvh.level_offsets; bvh.level_offsets = NULL;
+
+    bvh.num_levels = 0;
+
+    if (bvh.num_nodes == 0)
+        return;
+
+    // the schedule only depends on the topology, which refits never change
+    std::vector<BVHPackedNodeHalf> lowers(bvh.num_nodes);
+    std::vector<BVHPackedNodeHalf> uppers(bvh.num_nodes);
+
+    memcpy_d2h(WP_CURRENT_CONTEXT, lowers.data(), bvh.node_lowers, sizeof(BVHPackedNodeHalf)*bvh.num_nodes);
+    memcpy_d2h(WP_CURRENT_CONTEXT, uppers.data(), bvh.node_uppers, sizeof(BVHPackedNodeHalf)*bvh.num_nodes);
+    cuda_context_synchronize(WP_CURRENT_CONTEXT);
+
+    std::vector<int> nodes;
+    std::vector<int> offsets;
+    bvh_compute_refit_levels(lowers.data(), uppers.data(), bvh.root, nodes, offsets);
+
+    bvh.num_levels = int(offsets.size()) - 1;
+    bvh.level_offsets = new int[offsets.size()];
+    std::copy(offsets.begin(), offsets.end(), bvh.level_offsets);
+
+    // a single leaf root has no internal nodes, non-NULL still selects the leaf-only refit path
+    bvh.level_nodes = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*std::max(size_t(1), nodes.size()));
+    memcpy_h2d(WP_CURRENT_CONTEXT, bvh.level_nodes, nodes.data(), sizeof(int)*nodes.size());
+}
+
+void bvh_build_wide_device(BVH& bvh)
+{
+    ContextGuard guard(bvh.context);
+
+    free_device(WP_CURRENT_CONTEXT, bvh.wide_nodes); bvh.wide_nodes = NULL;
+    free_device(WP_CURRENT_CONTEXT, bvh.wide_sources); bvh.wide_sources = NULL;
+
+    bvh.num_wide_nodes = 0;
+    bvh.wide_depth = 0;
+
+    if (bvh.num_nodes == 0)
+        return;
+
+    // the topology is collapsed on the host, quantization runs on the device
+    std::vector<BVHPackedNodeHalf> lowers(bvh.num_nodes);
+    std::vector<BVHPackedNodeHalf> uppers(bvh.num_nodes);
 
-    wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_kernel, bvh.max_nodes, (bvh.max_nodes, bvh.node_parents, bvh.node_counts, bvh.node_lowers, bvh.node_uppers, b));
+    memcpy_d2h(WP_CURRENT_CONTEXT, lowers.data(), bvh.node_lowers, sizeof(BVHPackedNodeHalf)*bvh.num_nodes);
+    memcpy_d2h(WP_CURRENT_CONTEXT, uppers.data(), bvh.node_uppers, sizeof(BVHPackedNodeHalf)*bvh.num_nodes);
+    cuda_context_synchronize(WP_CURRENT_CONTEXT);
+
+    std::vector<BVHWideNode> nodes;
+    std::vector<int> sources;
+    bvh_collapse_wide(lowers.data(), uppers.data(), bvh.root, nodes, sources, bvh.wide_depth);
+
+    bvh.num_wide_nodes = int(nodes.size());
+    bvh.wide_nodes = (BVHWideNode*)alloc_device(WP_CURRENT_CONTEXT, sizeof(BVHWideNode)*nodes.size());
+    bvh.wide_sources = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*sources.size());
+
+    memcpy_h2d(WP_CURRENT_CONTEXT, bvh.wide_nodes, nodes.data(), sizeof(BVHWideNode)*nodes.size());
+    memcpy_h2d(WP_CURRENT_CONTEXT, bvh.wide_sources, sources.data(), sizeof(int)*sources.size());
+
+    bvh_refit_wide_device(bvh);
 }
 
 __global__ void set_bounds_from_lowers_and_uppers(int n, bounds3* b, const vec3* lowers, const vec3* uppers)
@@ -121,8 +275,477 @@ __global__ void set_bounds_from_lowers_and_uppers(int n, bounds3* b, const vec3*
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Linear BVH builder that runs entirely on the device, based on
+// "Maximizing Parallelism in the Construction of BVHs, Octrees, and k-d Trees" (Karras 2012).
+//
+// Node layout for n items:
+//   [0, n-1)      internal nodes, the root is always node 0
+//   [n-1, 2n-1)   leaf nodes, in Morton order
+//
+// Hierarchy emission only writes the topology (child and parent indices), node
+// bounds are computed afterwards by the regular bottom-up refit kernel.
+
+class LinearBVHBuilderGPU
+{
+public:
+
+    void build(BVH& bvh, const bounds3* items, int n);
+};
+
+struct BoundsUnion
+{
+    CUDA_CALLABLE inline bounds3 operator()(const bounds3& a, const bounds3& b) const
+    {
+        return bounds_union(a, b);
+    }
+};
+
+__device__ inline int lbvh_morton_code(const bounds3& item, const bounds3& total)
+{
+    vec3 edges = total.edges();
+    vec3 local = item.center() - total.lower;
+
+    // map to the unit cube, flat dimensions collapse to the mid-plane
+    float x = edges[0] > 0.0f ? local[0]/edges[0] : 0.5f;
+    float y = edges[1] > 0.0f ? local[1]/edges[1] : 0.5f;
+    float z = edges[2] > 0.0f ? local[2]/edges[2] : 0.5f;
+
+    return int(morton3<1024>(x, y, z));
+}
+
+__global__ void compute_morton_codes(int n, const bounds3* __restrict__ items, const bounds3* __restrict__ total_bounds, int* __restrict__ keys, int* __restrict__ indices)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        keys[index] = lbvh_morton_code(items[index], *total_bounds);
+        indices[index] = index;
+    }
+}
+
+// length of the common prefix between keys i and j, duplicate keys
+// are disambiguated by falling back on the (unique) key positions
+__device__ inline int lbvh_delta(const int* __restrict__ keys, int n, int i, int j)
+{
+    if (j < 0 || j >= n)
+        return -1;
+
+    const int key_i = keys[i];
+    const int key_j = keys[j];
+
+    if (key_i == key_j)
+        return 32 + __clz(i ^ j);
+    else
+        return __clz(key_i ^ key_j);
+}
+
+__device__ inline void lbvh_build_leaf(int n, int index, int item, int* __restrict__ parents, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    const int node = n - 1 + index;
+
+    // leaf bounds are filled in by the refit
+    lowers[node] = make_node(vec3(0.0f), item, true);
+    uppers[node] = make_node(vec3(0.0f), 0, false);
+
+    // single item trees consist of one root leaf
+    if (n == 1)
+        parents[node] = -1;
+}
+
+__global__ void build_leaves(int n, const int* __restrict__ indices, int* __restrict__ parents, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+        lbvh_build_leaf(n, index, indices[index], parents, lowers, uppers);
+}
+
+// emits internal node i of the tree over the n sorted keys
+__device__ inline void lbvh_build_node(int n, int i, const int* __restrict__ keys, int* __restrict__ parents, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    // determine direction of the range covered by this node
+    const int d = (lbvh_delta(keys, n, i, i + 1) - lbvh_delta(keys, n, i, i - 1)) >= 0 ? 1 : -1;
+
+    // compute an upper bound for the length of the range
+    const int delta_min = lbvh_delta(keys, n, i, i - d);
+
+    int l_max = 2;
+    while (lbvh_delta(keys, n, i, i + l_max*d) > delta_min)
+        l_max *= 2;
+
+    // find the other end using binary search
+    int l = 0;
+    for (int t = l_max/2; t >= 1; t /= 2)
+    {
+        if (lbvh_delta(keys, n, i, i + (l + t)*d) > delta_min)
+            l += t;
+    }
+
+    const int j = i + l*d;
+
+    // find the split position using binary search
+    const int delta_node = lbvh_delta(keys, n, i, j);
+
+    int s = 0;
+    int t = l;
+    do
+    {
+        t = (t + 1) >> 1;
+
+        if (lbvh_delta(keys, n, i, i + (s + t)*d) > delta_node)
+            s += t;
+    }
+    while (t > 1);
+
+    const int split = i + s*d + min(d, 0);
+
+    const int first = min(i, j);
+    const int last = max(i, j);
+
+    const int leaf_offset = n - 1;
+
+    const int left = (first == split) ? leaf_offset + split : split;
+    const int right = (last == split + 1) ? leaf_offset + split + 1 : split + 1;
+
+    lowers[i] = make_node(vec3(0.0f), left, false);
+    uppers[i] = make_node(vec3(0.0f), right, false);
+
+    parents[left] = i;
+    parents[right] = i;
+
+    if (i == 0)
+        parents[0] = -1;
+}
+
+__global__ void build_hierarchy(int n, const int* __restrict__ keys, int* __restrict__ parents, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    // one thread per internal node
+    const int i = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (i < n - 1)
+        lbvh_build_node(n, i, keys, parents, lowers, uppers);
+}
+
+void LinearBVHBuilderGPU::build(BVH& bvh, const bounds3* items, int n)
+{
+    bvh.max_depth = 0;
+    bvh.max_nodes = 2*n-1;
+    bvh.num_nodes = n > 0 ? 2*n-1 : 0;
+
+    // root is always in the first slot (internal node 0, or the only leaf)
+    bvh.root = 0;
+
+    bvh.node_lowers = (BVHPackedNodeHalf*)alloc_device(WP_CURRENT_CONTEXT, sizeof(BVHPackedNodeHalf)*bvh.max_nodes);
+    bvh.node_uppers = (BVHPackedNodeHalf*)alloc_device(WP_CURRENT_CONTEXT, sizeof(BVHPackedNodeHalf)*bvh.max_nodes);
+    bvh.node_parents = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*bvh.max_nodes);
+    bvh.node_counts = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*bvh.max_nodes);
+
+    if (n == 0)
+        return;
+
+    cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+
+    // total bounds of all items, stays on the device
+    bounds3* total_bounds = (bounds3*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(bounds3));
+
+    size_t reduce_temp_size = 0;
+    check_cuda(cub::DeviceReduce::Reduce(NULL, reduce_temp_size, items, total_bounds, n, BoundsUnion(), bounds3(), stream));
+
+    void* reduce_temp = alloc_temp_device(WP_CURRENT_CONTEXT, reduce_temp_size);
+    check_cuda(cub::DeviceReduce::Reduce(reduce_temp, reduce_temp_size, items, total_bounds, n, BoundsUnion(), bounds3(), stream));
+    free_temp_device(WP_CURRENT_CONTEXT, reduce_temp);
+
+    // radix sort requires double-sized buffers
+    int* keys = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*n*2);
+    int* indices = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*n*2);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, compute_morton_codes, n, (n, items, total_bounds, keys, indices));
+
+    // Morton codes have 10 bits per axis
+    radix_sort_pairs_device(WP_CURRENT_CONTEXT, keys, indices, n, 0, 30);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, build_leaves, n, (n, indices, bvh.node_parents, bvh.node_lowers, bvh.node_uppers));
+    wp_launch_device(WP_CURRENT_CONTEXT, build_hierarchy, n-1, (n, keys, bvh.node_parents, bvh.node_lowers, bvh.node_uppers));
+
+    free_temp_device(WP_CURRENT_CONTEXT, keys);
+    free_temp_device(WP_CURRENT_CONTEXT, indices);
+    free_temp_device(WP_CURRENT_CONTEXT, total_bounds);
+
+    // compute node bounds bottom-up
+    bvh_refit_device(bvh, items);
+}
+
+// segmented build over the items of several BVHs, the Morton codes are prefixed with the index of their BVH so
+// that a single sort orders the items of every BVH, the hierarchy of each BVH is then emitted from its own keys
+
+__global__ void compute_batch_morton_codes(int n, int num_bvhs, const int* __restrict__ offsets, const bounds3* __restrict__ items, const bounds3* __restrict__ total_bounds, int64_t* __restrict__ keys, int* __restrict__ indices)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        const int bvh = bvh_batch_find(offsets, num_bvhs, 1, 0, index);
+
+        keys[index] = (int64_t(bvh) << 30) | int64_t(lbvh_morton_code(items[index], total_bounds[bvh]));
+        indices[index] = index;
+    }
+}
+
+__global__ void build_batch_leaves(int n, int num_bvhs, const int* __restrict__ offsets, const int64_t* __restrict__ sorted_keys, const int* __restrict__ indices, int* __restrict__ keys, int* __restrict__ parents, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        const int bvh = bvh_batch_find(offsets, num_bvhs, 1, 0, index);
+        const int start = offsets[bvh];
+        const int nodes = 2*start - bvh;
+
+        // the hierarchy only compares the Morton codes of the same BVH
+        keys[index] = int(sorted_keys[index] & 0x3fffffff);
+
+        lbvh_build_leaf(offsets[bvh+1] - start, index - start, indices[index] - start, parents + nodes, lowers + nodes, uppers + nodes);
+    }
+}
+
+__global__ void build_batch_hierarchy(int n, int num_bvhs, const int* __restrict__ offsets, const int* __restrict__ keys, int* __restrict__ parents, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers)
+{
+    // one thread per internal node of all BVHs
+    const int i = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (i < n)
+    {
+        const int bvh = bvh_batch_find(offsets, num_bvhs, 1, 1, i);
+        const int start = offsets[bvh];
+        const int nodes = 2*start - bvh;
+
+        lbvh_build_node(offsets[bvh+1] - start, i - (start - bvh), keys + start, parents + nodes, lowers + nodes, uppers + nodes);
+    }
+}
+
+__global__ void bvh_refit_batch_kernel(int n, int num_bvhs, const int* __restrict__ offsets, const int* __restrict__ parents, int* __restrict__ child_count, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const bounds3* bounds)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        const int bvh = bvh_batch_find(offsets, num_bvhs, 2, 1, index);
+        const int start = offsets[bvh];
+        const int nodes = 2*start - bvh;
+
+        bvh_refit_node(index - nodes, parents + nodes, child_count + nodes, lowers + nodes, uppers + nodes, bounds + start);
+    }
+}
+
+void* bvh_create_batch_device(void* context, const bounds3* items, const int* offsets, const int* offsets_host, int num_bvhs, BVH* bvhs)
+{
+    ContextGuard guard(context);
+
+    const int num_items = offsets_host[num_bvhs];
+    const int num_nodes = 2*num_items - num_bvhs;
+
+    // the nodes of BVH i start at 2*offsets[i] - i in a single allocation
+    char* pool = (char*)alloc_device(WP_CURRENT_CONTEXT, (2*sizeof(BVHPackedNodeHalf) + 2*sizeof(int))*num_nodes);
+
+    BVHPackedNodeHalf* lowers = (BVHPackedNodeHalf*)pool;
+    BVHPackedNodeHalf* uppers = lowers + num_nodes;
+    int* parents = (int*)(uppers + num_nodes);
+    int* counts = parents + num_nodes;
+
+    cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+
+    // total bounds of the items of each BVH
+    bounds3* total_bounds = (bounds3*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(bounds3)*num_bvhs);
+
+    size_t reduce_temp_size = 0;
+    check_cuda(cub::DeviceSegmentedReduce::Reduce(NULL, reduce_temp_size, items, total_bounds, num_bvhs, offsets, offsets + 1, BoundsUnion(), bounds3(), stream));
+
+    void* reduce_temp = alloc_temp_device(WP_CURRENT_CONTEXT, reduce_temp_size);
+    check_cuda(cub::DeviceSegmentedReduce::Reduce(reduce_temp, reduce_temp_size, items, total_bounds, num_bvhs, offsets, offsets + 1, BoundsUnion(), bounds3(), stream));
+    free_temp_device(WP_CURRENT_CONTEXT, reduce_temp);
+
+    // radix sort requires double-sized buffers
+    int64_t* sorted_keys = (int64_t*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int64_t)*num_items*2);
+    int* indices = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_items*2);
+    int* keys = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_items);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, compute_batch_morton_codes, num_items, (num_items, num_bvhs, offsets, items, total_bounds, sorted_keys, indices));
+
+    // Morton codes have 10 bits per axis, the BVH index is sorted above them
+    int end_bit = 30;
+    while ((int64_t(1) << (end_bit - 30)) < num_bvhs)
+        ++end_bit;
+
+    radix_sort_pairs_device(WP_CURRENT_CONTEXT, sorted_keys, indices, num_items, 0, end_bit);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, build_batch_leaves, num_items, (num_items, num_bvhs, offsets, sorted_keys, indices, keys, parents, lowers, uppers));
+    wp_launch_device(WP_CURRENT_CONTEXT, build_batch_hierarchy, num_items - num_bvhs, (num_items - num_bvhs, num_bvhs, offsets, keys, parents, lowers, uppers));
+
+    free_temp_device(WP_CURRENT_CONTEXT, keys);
+    free_temp_device(WP_CURRENT_CONTEXT, indices);
+    free_temp_device(WP_CURRENT_CONTEXT, sorted_keys);
+    free_temp_device(WP_CURRENT_CONTEXT, total_bounds);
+
+    // compute node bounds bottom-up
+    memset_device(WP_CURRENT_CONTEXT, counts, 0, sizeof(int)*num_nodes);
+    wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_batch_kernel, num_nodes, (num_nodes, num_bvhs, offsets, parents, counts, lowers, uppers, items));
+
+    for (int i=0; i < num_bvhs; ++i)
+    {
+        const int n = offsets_host[i+1] - offsets_host[i];
+        const int nodes = 2*offsets_host[i] - i;
+
+        BVH& bvh = bvhs[i];
+        memset(&bvh, 0, sizeof(BVH));
+
+        bvh.context = context ? context : cuda_context_get_current();
+        bvh.max_nodes = 2*n-1;
+        bvh.num_nodes = 2*n-1;
+        bvh.root = 0;
+
+        bvh.node_lowers = lowers + nodes;
+        bvh.node_uppers = uppers + nodes;
+        bvh.node_parents = parents + nodes;
+        bvh.node_counts = counts + nodes;
+    }
+
+    return pool;
+}
+
+// expands every node pair of the current frontier, children go to the next frontier which must
+// have room for three pairs per frontier entry, the outputs of a warp are reserved with a single
+// atomic per counter so that dense overlaps don't serialize on the counters
+__global__ void bvh_overlap_level_kernel(BVH a, BVH b, transform xform, float margin, int self_overlap, const vec2i* frontier, int n,
+                                         vec2i* next, int* next_count, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    const int tid = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        const vec2i pair = frontier[tid];
+
+        vec2i children[3];
+        bool leaf;
+        const int num_children = self_overlap ? bvh_overlap_expand_self(a, margin, pair, children, leaf) : bvh_overlap_expand(a, b, xform, margin, pair, children, leaf);
+
+        if (leaf)
+        {
+            const int index = atomic_add_aggregate(pair_count, 1);
+            if (index < max_pairs)
+                pairs[index] = bvh_overlap_items(a, b, pair, self_overlap);
+        }
+        else if (num_children)
+        {
+            const int index = atomic_add_aggregate(next_count, num_children);
+            for (int i=0; i < num_children; ++i)
+                next[index + i] = children[i];
+        }
+    }
+}
+
+// breadth-first dual traversal, each launch expands the whole frontier of node pairs
+// so that the upper levels of both trees are culled once for all of their leaf pairs
+static void bvh_query_overlap_device(const BVH& a, const BVH& b, const transform& xform, float margin, bool self_overlap, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    memset_device(WP_CURRENT_CONTEXT, pair_count, 0, sizeof(int));
+
+    if (a.num_nodes == 0 || b.num_nodes == 0)
+        return;
+
+    int capacity[2] = { 1024, 1024 };
+    vec2i* frontier[2];
+    frontier[0] = (vec2i*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(vec2i)*capacity[0]);
+    frontier[1] = (vec2i*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(vec2i)*capacity[1]);
+
+    int* next_count = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int));
+
+    const vec2i root(a.root, b.root);
+    memcpy_h2d(WP_CURRENT_CONTEXT, frontier[0], (void*)&root, sizeof(vec2i));
+
+    int n = 1;
+    int current = 0;
+
+    while (n > 0)
+    {
+        const int next = current ^ 1;
+
+        if (capacity[next] < 3*n)
+        {
+            free_temp_device(WP_CURRENT_CONTEXT, frontier[next]);
+            capacity[next] = 3*n;
+            frontier[next] = (vec2i*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(vec2i)*capacity[next]);
+        }
+
+        memset_device(WP_CURRENT_CONTEXT, next_count, 0, sizeof(int));
+
+        wp_launch_device(WP_CURRENT_CONTEXT, bvh_overlap_level_kernel, n,
+            (a, b, xform, margin, int(self_overlap), frontier[current], n, frontier[next], next_count, pairs, max_pairs, pair_count));
+
+        memcpy_d2h(WP_CURRENT_CONTEXT, &n, next_count, sizeof(int));
+        cuda_context_synchronize(WP_CURRENT_CONTEXT);
+
+        current = next;
+    }
+
+    free_temp_device(WP_CURRENT_CONTEXT, next_count);
+    free_temp_device(WP_CURRENT_CONTEXT, frontier[0]);
+    free_temp_device(WP_CURRENT_CONTEXT, frontier[1]);
+}
+
+void bvh_query_bvh_overlap_device(const BVH& a, const BVH& b, const transform& xform, float margin, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_overlap_device(a, b, xform, margin, false, pairs, max_pairs, pair_count);
+}
+
+void bvh_query_self_overlap_device(const BVH& a, float margin, vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_overlap_device(a, a, transform_identity<float>(), margin, true, pairs, max_pairs, pair_count);
+}
+
+BVH bvh_create_device(void* context, const bounds3* bounds, int num_bounds)
+{
+    ContextGuard guard(context);
+
+    BVH bvh;
+    memset(&bvh, 0, sizeof(bvh));
+
+    bvh.context = context ? context : cuda_context_get_current();
+
+    LinearBVHBuilderGPU builder;
+    builder.build(bvh, bounds, num_bounds);
+
+    return bvh;
+}
+
 } // namespace wp
 
+uint64_t bvh_create_device(void* context, wp::vec3* lowers, wp::vec3* uppers, int num_bounds)
+{
+    ContextGuard guard(context);
+
+    // item bounds are owned by the BVH so that they can be reused for refits
+    wp::bounds3* bounds = (wp::bounds3*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::bounds3)*num_bounds);
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::set_bounds_from_lowers_and_uppers, num_bounds, (num_bounds, bounds, lowers, uppers));
+
+    wp::BVH bvh_device_clone = wp::bvh_create_device(WP_CURRENT_CONTEXT, bounds, num_bounds);
+
+    bvh_device_clone.bounds = bounds;
+    bvh_device_clone.num_bounds = num_bounds;
+    bvh_device_clone.lowers = lowers;		// managed by the user
+    bvh_device_clone.uppers = uppers;		// managed by the user
+
+    wp::BVH* bvh_device = (wp::BVH*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::BVH));
+    memcpy_h2d(WP_CURRENT_CONTEXT, bvh_device, &bvh_device_clone, sizeof(wp::BVH));
+
+    uint64_t bvh_id = (uint64_t)bvh_device;
+    wp::bvh_add_descriptor(bvh_id, bvh_device_clone);
+
+    return bvh_id;
+}
+
 // refit to data stored in the bvh
 
 void bvh_refit_device(uint64_t id)
@@ -138,5 +761,54 @@ void bvh_refit_device(uint64_t id)
 
 }
 
+void bvh_build_wide_device(uint64_t id)
+{
+    wp::BVH bvh;
+    if (bvh_get_descriptor(id, bvh))
+    {
+        ContextGuard guard(bvh.context);
+
+        wp::bvh_build_wide_device(bvh);
+
+        // update the descriptor and the device copy
+        wp::bvh_add_descriptor(id, bvh);
+        memcpy_h2d(WP_CURRENT_CONTEXT, (wp::BVH*)id, &bvh, sizeof(wp::BVH));
+    }
+}
+
+void bvh_build_refit_levels_device(uint64_t id)
+{
+    wp::BVH bvh;
+    if (bvh_get_descriptor(id, bvh))
+    {
+        ContextGuard guard(bvh.context);
+
+        wp::bvh_build_refit_levels_device(bvh);
+
+        // update the descriptor and the device copy
+        wp::bvh_add_descriptor(id, bvh);
+        memcpy_h2d(WP_CURRENT_CONTEXT, (wp::BVH*)id, &bvh, sizeof(wp::BVH));
+    }
+}
+
+void bvh_query_bvh_overlap_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    wp::BVH a, b;
+    if (bvh_get_descriptor(id_a, a) && bvh_get_descriptor(id_b, b))
+    {
+        ContextGuard guard(a.context);
 
+        wp::bvh_query_bvh_overlap_device(a, b, *xform, margin, pairs, max_pairs, pair_count);
+    }
+}
 
+void bvh_query_self_overlap_device(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    wp::BVH bvh;
+    if (bvh_get_descriptor(id, bvh))
+    {
+        ContextGuard guard(bvh.context);
+
+        wp::bvh_query_self_overlap_device(bvh, margin, pairs, max_pairs, pair_count);
+    }
+}
@@ -11,6 +11,32 @@
 #include "builtin.h"
 #include "intersect.h"
 
+// traversal stack depth used by BVH and mesh queries, the LBVH builder
+// generates deeper trees than the median builder so leave some headroom,
+// modules can override it through the "bvh_stack_size" option
+#ifndef BVH_QUERY_STACK_SIZE
+#define BVH_QUERY_STACK_SIZE (64)
+#endif
+
+// when enabled queries walk the tree through parent links instead of
+// keeping a stack, set per module through the "bvh_stackless" option
+#ifndef BVH_QUERY_STACKLESS
+#define BVH_QUERY_STACKLESS 0
+#endif
+
+// host code tests the four children of a wide node with 4-lane vector
+// arithmetic, uses the GCC/Clang vector extensions rather than intrinsics
+// so that kernel modules built without system headers can use it too
+#ifndef BVH_WIDE_SIMD
+#define BVH_WIDE_SIMD 1
+#endif
+
+#if BVH_WIDE_SIMD && !defined(__CUDA_ARCH__) && (defined(__GNUC__) || defined(__clang__))
+#define BVH_WIDE_SIMD_VECTOR 1
+#else
+#define BVH_WIDE_SIMD_VECTOR 0
+#endif
+
 namespace wp
 {
 
@@ -112,6 +138,24 @@ struct BVHPackedNodeHalf
 	unsigned int b : 1;
 };
 
+// optional 4-wide node layout collapsed from the binary tree, child boxes are
+// quantized to 8 bits per axis relative to the node bounds so that one node
+// (a 64 byte cache line) tests all four children
+#define BVH_WIDE_WIDTH 4
+#define BVH_WIDE_EMPTY (-0x7fffffff-1)
+
+struct BVHWideNode
+{
+	vec3 origin;
+	vec3 scale;
+
+	uint8_t qlower[3][BVH_WIDE_WIDTH];
+	uint8_t qupper[3][BVH_WIDE_WIDTH];
+
+	// >= 0 for wide nodes, ~item for leaves, BVH_WIDE_EMPTY for unused slots
+	int children[BVH_WIDE_WIDTH];
+};
+
 struct BVH
 {
     BVHPackedNodeHalf* node_lowers;
@@ -132,6 +176,17 @@ struct BVH
 	bounds3* bounds;
 	int num_bounds;
 
+	// wide layout, NULL unless built with bvh_build_wide_host/device()
+	BVHWideNode* wide_nodes;
+	int* wide_sources;		// binary node of each child slot, used for refits
+	int num_wide_nodes;
+	int wide_depth;
+
+	// level-synchronous refit schedule, NULL unless built with bvh_build_refit_levels_device()
+	int* level_nodes;		// internal nodes grouped by depth (device memory)
+	int* level_offsets;		// start of each depth in level_nodes, num_levels+1 entries (host memory)
+	int num_levels;
+
 	void* context;
 };
 
@@ -139,6 +194,10 @@ struct BVH
 
 BVH bvh_create(const bounds3* bounds, int num_bounds);
 
+// build a BVH directly on the device from device-side bounds (LBVH),
+// the returned BVH does not take ownership of the bounds array
+BVH bvh_create_device(void* context, const bounds3* bounds, int num_bounds);
+
 void bvh_destroy_host(BVH& bvh);
 void bvh_destroy_device(BVH& bvh);
 
@@ -148,6 +207,30 @@ void bvh_refit_device(BVH& bvh, const bounds3* bounds);
 // copy host BVH to device
 BVH bvh_clone(void* context, const BVH& bvh_host);
 
+// allocates size bytes on the device of context and copies a buffer that may live on any device into it,
+// returns NULL for empty buffers
+void* clone_buffer_device(void* context, const void* src, size_t size);
+
+// copy a device BVH to the device of context, the source may live on another device,
+// user-owned lowers and uppers are shared with the source and must be replaced by the caller
+BVH bvh_clone_device(void* context, const BVH& bvh_src);
+
+// collapse the binary tree into the wide layout, refits keep it up to date
+void bvh_build_wide_host(BVH& bvh);
+void bvh_build_wide_device(BVH& bvh);
+
+void bvh_refit_wide_host(BVH& bvh);
+void bvh_refit_wide_device(BVH& bvh);
+
+// groups internal nodes by depth so that device refits can process one level per launch
+// without atomics, only affects bvh_refit_device() and the mesh refits built on it
+void bvh_build_refit_levels_device(BVH& bvh);
+
+// builds the BVHs of num_bvhs item ranges in a single sequence of launches (segmented LBVH), the items of BVH i
+// are items[offsets[i]:offsets[i+1]] and every range must be non-empty, offsets are given on the device and
+// on the host, the nodes of all BVHs share the returned allocation, which must be freed with free_device()
+void* bvh_create_batch_device(void* context, const bounds3* items, const int* offsets, const int* offsets_host, int num_bvhs, BVH* bvhs);
+
 #endif  // !__CUDA_ARCH__
 
 CUDA_CALLABLE inline BVHPackedNodeHalf make_node(const vec3& bound, int child, bool leaf)
@@ -172,6 +255,25 @@ CUDA_CALLABLE inline void make_node(volatile BVHPackedNodeHalf* n, const vec3& b
     n->b = (unsigned int)(leaf?1:0);
 }
 
+// index of the BVH of a batch that element index belongs to, the elements of BVH i start at
+// scale*offsets[i] - shift*i, e.g.: scale=2, shift=1 for the nodes of BVHs over offsets[i+1]-offsets[i] items
+CUDA_CALLABLE inline int bvh_batch_find(const int* offsets, int num_bvhs, int scale, int shift, int index)
+{
+    int lo = 0;
+    int hi = num_bvhs;
+
+    while (hi - lo > 1)
+    {
+        const int mid = (lo + hi)/2;
+        if (scale*offsets[mid] - shift*mid <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
 CUDA_CALLABLE inline int clz(int x)
 {
     int n;
@@ -214,6 +316,356 @@ CUDA_CALLABLE inline int bvh_get_num_bounds(uint64_t id)
 	return bvh.num_bounds;
 }
 
+CUDA_CALLABLE inline bounds3 bvh_get_node_bounds(const BVH& bvh, int node_index)
+{
+	BVHPackedNodeHalf lower = bvh.node_lowers[node_index];
+	BVHPackedNodeHalf upper = bvh.node_uppers[node_index];
+
+	return bounds3(vec3(lower.x, lower.y, lower.z), vec3(upper.x, upper.y, upper.z));
+}
+
+// wide traversal pushes at most three more entries per level than it pops,
+// fall back to the binary layout when the stack can't hold a full descent
+CUDA_CALLABLE inline bool bvh_use_wide(const BVH& bvh)
+{
+#if BVH_QUERY_STACKLESS
+	return false;
+#else
+	return bvh.wide_nodes && (BVH_WIDE_WIDTH-1)*bvh.wide_depth + 1 <= BVH_QUERY_STACK_SIZE;
+#endif
+}
+
+// encodes child bounds conservatively, slack covers rounding differences
+// between the host and device when decoding
+CUDA_CALLABLE inline void bvh_quantize_wide_node(BVHWideNode& node, const bounds3* child_bounds, int num_children)
+{
+	bounds3 b;
+	for (int k=0; k < num_children; ++k)
+		b = bounds_union(b, child_bounds[k]);
+
+	for (int a=0; a < 3; ++a)
+	{
+		const float slack = 1.e-6f*max(fabsf(b.lower[a]), fabsf(b.upper[a]));
+		const float origin = b.lower[a] - slack;
+		const float extent = b.upper[a] - b.lower[a] + 2.0f*slack;
+		const float scale = extent > 0.0f ? extent/255.0f : 1.0f;
+
+		node.origin[a] = origin;
+		node.scale[a] = scale;
+
+		for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+		{
+			if (k < num_children)
+			{
+				const float lo = floorf((child_bounds[k].lower[a] - slack - origin)/scale);
+				const float hi = ceilf((child_bounds[k].upper[a] + slack - origin)/scale);
+
+				node.qlower[a][k] = (uint8_t)clamp(int(lo), 0, 255);
+				node.qupper[a][k] = (uint8_t)clamp(int(hi), 0, 255);
+			}
+			else
+			{
+				// empty slots decode to inverted bounds
+				node.qlower[a][k] = 255;
+				node.qupper[a][k] = 0;
+			}
+		}
+	}
+}
+
+// requantizes a wide node from the current bounds of its binary sources
+CUDA_CALLABLE inline void bvh_refit_wide_node(const BVH& bvh, int wide_index)
+{
+	bounds3 child_bounds[BVH_WIDE_WIDTH];
+	int num_children = 0;
+
+	for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+	{
+		const int source = bvh.wide_sources[wide_index*BVH_WIDE_WIDTH + k];
+		if (source >= 0)
+			child_bounds[num_children++] = bvh_get_node_bounds(bvh, source);
+	}
+
+	bvh_quantize_wide_node(bvh.wide_nodes[wide_index], child_bounds, num_children);
+}
+
+CUDA_CALLABLE inline bounds3 bvh_get_wide_child_bounds(const BVHWideNode& node, int k)
+{
+	vec3 lower, upper;
+	for (int a=0; a < 3; ++a)
+	{
+		lower[a] = node.origin[a] + node.scale[a]*float(node.qlower[a][k]);
+		upper[a] = node.origin[a] + node.scale[a]*float(node.qupper[a][k]);
+	}
+
+	return bounds3(lower, upper);
+}
+
+#if BVH_WIDE_SIMD_VECTOR
+
+typedef float bvh_float4 __attribute__((vector_size(16)));
+typedef int bvh_int4 __attribute__((vector_size(16)));
+
+inline bvh_float4 bvh_splat4(float x)
+{
+	const bvh_float4 v = { x, x, x, x };
+	return v;
+}
+
+// lane-wise a<b?a:b and a>b?a:b, matching min() and max() for NaNs
+inline bvh_float4 bvh_min4(bvh_float4 a, bvh_float4 b)
+{
+	const bvh_int4 m = a < b;
+	return (bvh_float4)((m & (bvh_int4)a) | (~m & (bvh_int4)b));
+}
+
+inline bvh_float4 bvh_max4(bvh_float4 a, bvh_float4 b)
+{
+	const bvh_int4 m = a > b;
+	return (bvh_float4)((m & (bvh_int4)a) | (~m & (bvh_int4)b));
+}
+
+// decodes one axis of all four child boxes, same arithmetic as bvh_get_wide_child_bounds()
+inline void bvh_decode_wide_axis(const BVHWideNode& node, int a, bvh_float4& lower, bvh_float4& upper)
+{
+	const bvh_float4 ql = { float(node.qlower[a][0]), float(node.qlower[a][1]), float(node.qlower[a][2]), float(node.qlower[a][3]) };
+	const bvh_float4 qu = { float(node.qupper[a][0]), float(node.qupper[a][1]), float(node.qupper[a][2]), float(node.qupper[a][3]) };
+
+	const bvh_float4 origin = bvh_splat4(node.origin[a]);
+	const bvh_float4 scale = bvh_splat4(node.scale[a]);
+
+	lower = origin + scale*ql;
+	upper = origin + scale*qu;
+}
+
+#endif // BVH_WIDE_SIMD_VECTOR
+
+// ray test against the child boxes of a wide node expanded by eps, returns a bit
+// mask of the hit children and writes their entry distances to t
+CUDA_CALLABLE inline int bvh_intersect_wide_ray(const BVHWideNode& node, const vec3& start, const vec3& rcp_dir, float eps, float* t)
+{
+	int mask = 0;
+
+#if BVH_WIDE_SIMD_VECTOR
+
+	bvh_float4 lmin, lmax;
+
+	for (int a=0; a < 3; ++a)
+	{
+		bvh_float4 lower, upper;
+		bvh_decode_wide_axis(node, a, lower, upper);
+
+		const bvh_float4 p = bvh_splat4(start[a]);
+		const bvh_float4 r = bvh_splat4(rcp_dir[a]);
+
+		const bvh_float4 l1 = (lower - bvh_splat4(eps) - p)*r;
+		const bvh_float4 l2 = (upper + bvh_splat4(eps) - p)*r;
+
+		if (a == 0)
+		{
+			lmin = bvh_min4(l1, l2);
+			lmax = bvh_max4(l1, l2);
+		}
+		else
+		{
+			lmin = bvh_max4(bvh_min4(l1, l2), lmin);
+			lmax = bvh_min4(bvh_max4(l1, l2), lmax);
+		}
+	}
+
+	const bvh_int4 hit = (lmax >= bvh_splat4(0.0f)) & (lmax >= lmin);
+
+	for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+	{
+		if (hit[k] && node.children[k] != BVH_WIDE_EMPTY)
+		{
+			mask |= 1 << k;
+			t[k] = lmin[k];
+		}
+	}
+
+#else
+
+	for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+	{
+		if (node.children[k] == BVH_WIDE_EMPTY)
+			continue;
+
+		bounds3 b = bvh_get_wide_child_bounds(node, k);
+
+		if (intersect_ray_aabb(start, rcp_dir, b.lower - vec3(eps), b.upper + vec3(eps), t[k]))
+			mask |= 1 << k;
+	}
+
+#endif
+
+	return mask;
+}
+
+// overlap test of a box against the child boxes of a wide node, returns a bit mask of the overlapping children
+CUDA_CALLABLE inline int bvh_overlap_wide_aabb(const BVHWideNode& node, const bounds3& b)
+{
+	int mask = 0;
+
+#if BVH_WIDE_SIMD_VECTOR
+
+	bvh_int4 reject = { 0, 0, 0, 0 };
+
+	for (int a=0; a < 3; ++a)
+	{
+		bvh_float4 lower, upper;
+		bvh_decode_wide_axis(node, a, lower, upper);
+
+		reject |= (bvh_splat4(b.lower[a]) > upper) | (bvh_splat4(b.upper[a]) < lower);
+	}
+
+	for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+	{
+		if (!reject[k] && node.children[k] != BVH_WIDE_EMPTY)
+			mask |= 1 << k;
+	}
+
+#else
+
+	for (int k=0; k < BVH_WIDE_WIDTH; ++k)
+	{
+		if (node.children[k] != BVH_WIDE_EMPTY && b.overlaps(bvh_get_wide_child_bounds(node, k)))
+			mask |= 1 << k;
+	}
+
+#endif
+
+	return mask;
+}
+
+
+// returns the node following the subtree rooted at node_index in a traversal
+// that visits right children before left ones, or -1 once the tree is done
+CUDA_CALLABLE inline int bvh_next_stackless(const BVH& bvh, int node_index)
+{
+	while (node_index != bvh.root)
+	{
+		const int parent = bvh.node_parents[node_index];
+		const int left = bvh.node_lowers[parent].i;
+
+		if (node_index != left)
+			return left;
+
+		node_index = parent;
+	}
+
+	return -1;
+}
+
+// fixed size traversal stack shared by BVH and mesh queries, if pushing would
+// overflow it the remaining traversal continues without a stack by walking
+// parent links, so deep trees are slower to traverse but never corrupt memory
+struct bvh_stack_t
+{
+#if BVH_QUERY_STACKLESS
+	int nodes[1];
+#else
+	int nodes[BVH_QUERY_STACK_SIZE];
+#endif
+	int count;
+
+	// stackless traversal state
+	bool stackless;
+	bool ordered;	// children were pushed left first at some point
+	int current;	// most recently popped node
+	int pending;	// node to descend into on the next pop, or -1
+
+	CUDA_CALLABLE inline void clear()
+	{
+		count = 0;
+		stackless = false;
+		ordered = false;
+		current = -1;
+		pending = -1;
+	}
+
+	CUDA_CALLABLE inline void init(int root)
+	{
+		clear();
+
+#if BVH_QUERY_STACKLESS
+		stackless = true;
+		pending = root;
+#else
+		nodes[count++] = root;
+#endif
+	}
+
+	// returns the next node to visit, or -1 when the traversal is complete
+	CUDA_CALLABLE inline int pop(const BVH& bvh)
+	{
+		if (!stackless)
+			return count ? nodes[--count] : -1;
+
+		if (pending >= 0)
+		{
+			current = pending;
+			pending = -1;
+		}
+		else if (current >= 0)
+		{
+			current = bvh_next_stackless(bvh, current);
+		}
+
+		return current;
+	}
+
+	// pushes the children of an internal node, the right child is visited
+	// first unless left_first is set, stackless traversal ignores the hint
+	CUDA_CALLABLE inline void push(const BVH& bvh, int left_index, int right_index, bool left_first=false)
+	{
+		if (!stackless && count + 2 <= BVH_QUERY_STACK_SIZE)
+		{
+			if (left_first)
+			{
+				nodes[count++] = right_index;
+				nodes[count++] = left_index;
+				ordered = true;
+			}
+			else
+			{
+				nodes[count++] = left_index;
+				nodes[count++] = right_index;
+			}
+			return;
+		}
+
+		if (!stackless)
+		{
+			stackless = true;
+			count = 0;
+
+			if (ordered)
+			{
+				// the discarded entries don't follow the stackless order, restart
+				// from the root, this is only used by queries where revisiting
+				// nodes doesn't change the result (e.g.: closest point queries)
+				pending = bvh.root;
+				current = -1;
+				return;
+			}
+
+			// the discarded entries are exactly the left siblings of the
+			// current path which the stackless traversal visits on the way up
+		}
+
+		pending = right_index;
+	}
+
+	// re-queues a node so that the next pop returns it again
+	CUDA_CALLABLE inline void push_back(int node_index)
+	{
+		if (stackless)
+			pending = node_index;
+		else
+			nodes[count++] = node_index;
+	}
+};
 
 // stores state required to traverse the BVH nodes that 
 // overlap with a query AABB.
@@ -229,8 +681,7 @@ struct bvh_query_t
     BVH bvh;
 
 	// BVH traversal stack:
-	int stack[32];
-	int count;
+	bvh_stack_t stack;
 
     // inputs
 	bool is_ray;
@@ -238,6 +689,10 @@ struct bvh_query_t
     wp::vec3 input_upper;	// dir for ray
 
 	int bounds_nr;
+
+	// traverse the wide layout, stack entries are then wide node
+	// indices, or ~item for leaves that passed their parent's test
+	bool wide;
 };
 
 
@@ -256,28 +711,37 @@ CUDA_CALLABLE inline bvh_query_t bvh_query(
 
 	query.bvh = bvh;
 	query.is_ray = is_ray;
+	query.wide = false;
 
 
     // if no bvh nodes, return empty query.
     if (bvh.num_nodes == 0)
     {
-		query.count = 0;
+		query.stack.clear();
 		return query;
 	}
 
     // optimization: make the latest
 	
-	query.stack[0] = bvh.root;
-	query.count = 1;
+	query.stack.init(bvh.root);
     query.input_lower = lower;
     query.input_upper = upper;
 
+	if (bvh_use_wide(bvh))
+	{
+		// leaves are found by bvh_query_next()
+		query.wide = true;
+		query.stack.clear();
+		query.stack.push_back(0);
+		return query;
+	}
+
     wp::bounds3 input_bounds(query.input_lower, query.input_upper);
 
     // Navigate through the bvh, find the first overlapping leaf node.
-    while (query.count)
+    int node_index;
+    while ((node_index = query.stack.pop(bvh)) >= 0)
     {
-		const int node_index = query.stack[--query.count];
 
 		BVHPackedNodeHalf node_lower = bvh.node_lowers[node_index];
 		BVHPackedNodeHalf node_upper = bvh.node_uppers[node_index];
@@ -308,13 +772,12 @@ CUDA_CALLABLE inline bvh_query_t bvh_query(
         {
 			// found very first leaf index.
 			// Back up one level and return 
-			query.stack[query.count++] = node_index;
+			query.stack.push_back(node_index);
 			return query;
         }
         else
         {	
-		  query.stack[query.count++] = left_index;
-		  query.stack[query.count++] = right_index;
+		  query.stack.push(bvh, left_index, right_index);
 		}
 	}	
 
@@ -347,16 +810,65 @@ CUDA_CALLABLE inline void adj_bvh_query_ray(uint64_t id, const vec3& start, cons
 }
 
 
+CUDA_CALLABLE inline bool bvh_query_next_wide(bvh_query_t& query, int& index)
+{
+	const BVH& bvh = query.bvh;
+	bvh_stack_t& stack = query.stack;
+
+	wp::bounds3 input_bounds(query.input_lower, query.input_upper);
+
+	while (stack.count)
+	{
+		const int ref = stack.nodes[--stack.count];
+
+		if (ref < 0)
+		{
+			const int item = ~ref;
+
+			// quantized boxes are conservative, re-test the exact item bounds
+			if (bvh.bounds)
+			{
+				const bounds3& b = bvh.bounds[item];
+				float t = 0.0f;
+
+				if (query.is_ray ? !intersect_ray_aabb(query.input_lower, query.input_upper, b.lower, b.upper, t) : !input_bounds.overlaps(b))
+					continue;
+			}
+
+			// found leaf
+			query.bounds_nr = item;
+			index = item;
+			return true;
+		}
+
+		const BVHWideNode node = bvh.wide_nodes[ref];
+
+		float t[BVH_WIDE_WIDTH];
+		const int mask = query.is_ray ? bvh_intersect_wide_ray(node, query.input_lower, query.input_upper, 0.0f, t) : bvh_overlap_wide_aabb(node, input_bounds);
+
+		for (int k=BVH_WIDE_WIDTH-1; k >= 0; --k)
+		{
+			if (mask & (1 << k))
+				stack.nodes[stack.count++] = node.children[k];
+		}
+	}
+
+	return false;
+}
+
 CUDA_CALLABLE inline bool bvh_query_next(bvh_query_t& query, int& index)
 {
+	if (query.wide)
+		return bvh_query_next_wide(query, index);
+
     BVH bvh = query.bvh;
 	
 	wp::bounds3 input_bounds(query.input_lower, query.input_upper);
 
     // Navigate through the bvh, find the first overlapping leaf node.
-    while (query.count)
+    int node_index;
+    while ((node_index = query.stack.pop(bvh)) >= 0)
     {
-        const int node_index = query.stack[--query.count];
         BVHPackedNodeHalf node_lower = bvh.node_lowers[node_index];
         BVHPackedNodeHalf node_upper = bvh.node_uppers[node_index];
 
@@ -389,9 +901,7 @@ CUDA_CALLABLE inline bool bvh_query_next(bvh_query_t& query, int& index)
         }
         else
         {
-
-            query.stack[query.count++] = left_index;
-            query.stack[query.count++] = right_index;
+            query.stack.push(bvh, left_index, right_index);
         }
     }
     return false;
@@ -423,6 +933,111 @@ CUDA_CALLABLE inline void adj_bvh_query_next(bvh_query_t& query, int& index, bvh
 }
 
 
+// conservative bounds of a box after a rigid transform
+CUDA_CALLABLE inline bounds3 bounds_transform(const bounds3& b, const transform& xform)
+{
+	const vec3 c = transform_point(xform, b.center());
+	const vec3 e = 0.5f*b.edges();
+	const mat33 r = quat_to_matrix(transform_get_rotation(xform));
+
+	vec3 h;
+	for (int i=0; i < 3; ++i)
+		h[i] = abs(r.data[i][0])*e[0] + abs(r.data[i][1])*e[1] + abs(r.data[i][2])*e[2];
+
+	return bounds3(c - h, c + h);
+}
+
+// expands a pair of nodes in a dual traversal of the BVHs a and b, nodes of b are placed in
+// the frame of a by xform and nodes of a are grown by margin, returns the number of child pairs
+// written to children, overlapping leaf pairs write none and set leaf instead
+CUDA_CALLABLE inline int bvh_overlap_expand(const BVH& a, const BVH& b, const transform& xform, float margin, const vec2i& pair, vec2i* children, bool& leaf)
+{
+	leaf = false;
+
+	bounds3 bounds_a = bvh_get_node_bounds(a, pair[0]);
+	bounds_a.expand(margin);
+
+	const bounds3 bounds_b = bounds_transform(bvh_get_node_bounds(b, pair[1]), xform);
+
+	if (!bounds_a.overlaps(bounds_b))
+		return 0;
+
+	const BVHPackedNodeHalf lower_a = a.node_lowers[pair[0]];
+	const BVHPackedNodeHalf lower_b = b.node_lowers[pair[1]];
+
+	if (lower_a.b && lower_b.b)
+	{
+		leaf = true;
+		return 0;
+	}
+
+	// descend into the larger node so that both sides shrink at a similar rate
+	if (lower_b.b || (!lower_a.b && bounds_a.area() >= bounds_b.area()))
+	{
+		children[0] = vec2i(lower_a.i, pair[1]);
+		children[1] = vec2i(a.node_uppers[pair[0]].i, pair[1]);
+	}
+	else
+	{
+		children[0] = vec2i(pair[0], lower_b.i);
+		children[1] = vec2i(pair[0], b.node_uppers[pair[1]].i);
+	}
+
+	return 2;
+}
+
+// expands a pair of nodes in a dual traversal of a BVH with itself, a node paired with itself expands
+// to the pairs of its children and the pair of both children so that each pair of distinct items is
+// reached exactly once, other pairs are expanded by bvh_overlap_expand()
+CUDA_CALLABLE inline int bvh_overlap_expand_self(const BVH& a, float margin, const vec2i& pair, vec2i* children, bool& leaf)
+{
+	if (pair[0] != pair[1])
+		return bvh_overlap_expand(a, a, transform_identity<float>(), margin, pair, children, leaf);
+
+	leaf = false;
+
+	// items don't overlap themselves
+	const BVHPackedNodeHalf lower = a.node_lowers[pair[0]];
+	if (lower.b)
+		return 0;
+
+	const int left = lower.i;
+	const int right = a.node_uppers[pair[0]].i;
+
+	children[0] = vec2i(left, left);
+	children[1] = vec2i(right, right);
+	children[2] = vec2i(left, right);
+
+	return 3;
+}
+
+// item indices of an overlapping leaf pair, self overlaps return the lower item first
+CUDA_CALLABLE inline vec2i bvh_overlap_items(const BVH& a, const BVH& b, const vec2i& pair, bool self_overlap=false)
+{
+	const int item_a = a.node_lowers[pair[0]].i;
+	const int item_b = b.node_lowers[pair[1]].i;
+
+	if (self_overlap && item_b < item_a)
+		return vec2i(item_b, item_a);
+	else
+		return vec2i(item_a, item_b);
+}
+
+#if !defined(__CUDA_ARCH__)
+
+// writes the (item_a, item_b) pairs of overlapping items of a and b to pairs, see bvh_overlap_expand(),
+// pair_count receives the total number of pairs which can exceed max_pairs, in which case only
+// the first max_pairs are written, all pointers must live on the device of the BVHs
+void bvh_query_bvh_overlap_host(const BVH& a, const BVH& b, const transform& xform, float margin, vec2i* pairs, int max_pairs, int* pair_count);
+void bvh_query_bvh_overlap_device(const BVH& a, const BVH& b, const transform& xform, float margin, vec2i* pairs, int max_pairs, int* pair_count);
+
+// writes the pairs (i, j) with i < j of overlapping items of a, see bvh_overlap_expand_self()
+void bvh_query_self_overlap_host(const BVH& a, float margin, vec2i* pairs, int max_pairs, int* pair_count);
+void bvh_query_self_overlap_device(const BVH& a, float margin, vec2i* pairs, int max_pairs, int* pair_count);
+
+#endif  // !__CUDA_ARCH__
+
+
 
 
 CUDA_CALLABLE bool bvh_get_descriptor(uint64_t id, BVH& bvh);
@@ -12,6 +12,7 @@
 #include <clang/Basic/DiagnosticOptions.h>
 #include <clang/Frontend/TextDiagnosticPrinter.h>
 #include <clang/CodeGen/CodeGenAction.h>
+#include <clang/Frontend/FrontendActions.h>
 #include <clang/Basic/TargetInfo.h>
 #include <clang/Lex/PreprocessorOptions.h>
 
@@ -22,6 +23,8 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/PassRegistry.h>
 #include <llvm/InitializePasses.h>
 #include <llvm/IR/LegacyPassManager.h>
@@ -36,6 +39,7 @@
 #include <llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h>
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <iostream>
@@ -81,25 +85,86 @@ static void initialize_llvm()
     llvm::InitializeAllAsmPrinters();
 }
 
-static std::unique_ptr<llvm::Module> cpp_to_llvm(const std::string& input_file, const char* cpp_src, const char* include_dir, bool debug, llvm::LLVMContext& context)
+// CPU and features that CPU modules are compiled for, either those of the host or a generic target
+struct CpuTarget
 {
-    // Compilation arguments
-    std::vector<const char*> args;
-    args.push_back(input_file.c_str());
+    std::string cpu;
+    std::vector<std::string> features;
+};
+
+static CpuTarget get_host_cpu_target()
+{
+    CpuTarget target;
+    target.cpu = llvm::sys::getHostCPUName().str();
+
+    llvm::StringMap<bool> host_features;
+    if (llvm::sys::getHostCPUFeatures(host_features))
+    {
+        for (const auto& feature : host_features)
+            target.features.push_back((feature.getValue() ? "+" : "-") + feature.getKey().str());
+
+        // sorted so that the target description used in cache keys is stable
+        std::sort(target.features.begin(), target.features.end());
+    }
+
+    return target;
+}
+
+static const CpuTarget& get_cpu_target(bool native_isa)
+{
+    static const CpuTarget generic_target = { "generic", {} };
+    static const CpuTarget host_target = get_host_cpu_target();
+
+    return native_isa ? host_target : generic_target;
+}
+
+// front-end options of CPU modules, the precompiled headers they include are built with the same ones
+static std::vector<std::string> cpp_args(const char* include_dir, bool debug, bool native_isa)
+{
+    std::vector<std::string> args;
 
     args.push_back("-I");
     args.push_back(include_dir);
 
-    args.push_back(debug ? "-O0" : "-O2");
+    args.push_back(debug ? "-O0" : "-O3");
+
+    if(!debug)
+    {
+        // cc1 doesn't enable the vectorizers by itself, the clang driver adds these at -O2 and above
+        args.push_back("-vectorize-loops");
+        args.push_back("-vectorize-slp");
+    }
 
     args.push_back("-triple");
     args.push_back(target_triple);
 
+    const CpuTarget& target = get_cpu_target(native_isa);
+    if(native_isa)
+    {
+        args.push_back("-target-cpu");
+        args.push_back(target.cpu);
+    }
+
+    for(const std::string& feature : target.features)
+    {
+        args.push_back("-target-feature");
+        args.push_back(feature);
+    }
+
     #if defined(__x86_64__) || defined(_M_X64)
         args.push_back("-target-feature");
         args.push_back("+f16c");  // Enables support for _Float16
     #endif
 
+    return args;
+}
+
+static bool run_cpp_action(clang::FrontendAction& action, const std::vector<std::string>& arg_strings, const std::string& input_file, const char* cpp_src, const char* pch_file, bool debug)
+{
+    std::vector<const char*> args;
+    for(const std::string& arg : arg_strings)
+        args.push_back(arg.c_str());
+
     clang::IntrusiveRefCntPtr<clang::DiagnosticOptions> diagnostic_options = new clang::DiagnosticOptions();
     std::unique_ptr<clang::TextDiagnosticPrinter> text_diagnostic_printer =
             std::make_unique<clang::TextDiagnosticPrinter>(llvm::errs(), &*diagnostic_options);
@@ -117,9 +182,19 @@ static std::unique_ptr<llvm::Module> cpp_to_llvm(const std::string& input_file,
         compiler_invocation.getCodeGenOpts().setDebugInfo(clang::codegenoptions::FullDebugInfo);
     }
 
-    // Map code to a MemoryBuffer
-    std::unique_ptr<llvm::MemoryBuffer> buffer = llvm::MemoryBuffer::getMemBufferCopy(cpp_src);
-    compiler_invocation.getPreprocessorOpts().addRemappedFile(input_file.c_str(), buffer.get());
+    // Map code to a MemoryBuffer, precompiled headers are built from a file
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    if(cpp_src)
+    {
+        buffer = llvm::MemoryBuffer::getMemBufferCopy(cpp_src);
+        compiler_invocation.getPreprocessorOpts().addRemappedFile(input_file.c_str(), buffer.get());
+    }
+
+    // the header's macros and declarations are loaded before the source, which then skips its include of builtin.h
+    if(pch_file)
+    {
+        compiler_invocation.getPreprocessorOpts().ImplicitPCHInclude = pch_file;
+    }
 
     if(!debug)
     {
@@ -131,13 +206,35 @@ static std::unique_ptr<llvm::Module> cpp_to_llvm(const std::string& input_file,
 
     compiler_instance.createDiagnostics(text_diagnostic_printer.get(), false);
 
-    clang::EmitLLVMOnlyAction emit_llvm_only_action(&context);
-    bool success = compiler_instance.ExecuteAction(emit_llvm_only_action);
+    bool success = compiler_instance.ExecuteAction(action);
     buffer.release();
 
+    return success;
+}
+
+static std::unique_ptr<llvm::Module> cpp_to_llvm(const std::string& input_file, const char* cpp_src, const char* include_dir, bool debug, bool native_isa, const char* pch_file, llvm::LLVMContext& context)
+{
+    std::vector<std::string> args = cpp_args(include_dir, debug, native_isa);
+    args.insert(args.begin(), input_file);
+
+    clang::EmitLLVMOnlyAction emit_llvm_only_action(&context);
+    bool success = run_cpp_action(emit_llvm_only_action, args, input_file, cpp_src, pch_file, debug);
+
     return success ? std::move(emit_llvm_only_action.takeModule()) : nullptr;
 }
 
+// compiles the preamble of CPU modules, their option macros followed by the include of builtin.h,
+// into a precompiled header that modules with the same preamble and options load instead of parsing it
+static bool generate_cpp_pch(const char* header_file, const char* pch_file, const char* include_dir, bool debug, bool native_isa)
+{
+    std::vector<std::string> args = cpp_args(include_dir, debug, native_isa);
+    args.insert(args.begin(), { "-emit-pch", "-x", "c++-header", header_file, "-o", pch_file });
+
+    // the output is written to a temporary file and renamed, so concurrent builds don't see partial headers
+    clang::GeneratePCHAction generate_pch_action;
+    return run_cpp_action(generate_pch_action, args, header_file, nullptr, nullptr, debug);
+}
+
 static std::unique_ptr<llvm::Module> cuda_to_llvm(const std::string& input_file, const char* cpp_src, const char* include_dir, bool debug, llvm::LLVMContext& context)
 {
     // Compilation arguments
@@ -201,12 +298,21 @@ static std::unique_ptr<llvm::Module> cuda_to_llvm(const std::string& input_file,
 
 extern "C" {
 
-WP_API int compile_cpp(const char* cpp_src, const char *input_file, const char* include_dir, const char* output_file, bool debug)
+WP_API int compile_cpp(const char* cpp_src, const char *input_file, const char* include_dir, const char* output_file, bool debug, bool native_isa, const char* pch_header)
 {
     initialize_llvm();
 
+    // the precompiled header lives next to the preamble it is built from, its name identifies the options
+    std::string pch_file;
+    if(pch_header && *pch_header)
+    {
+        pch_file = std::string(pch_header) + ".pch";
+        if(!llvm::sys::fs::exists(pch_file) && !generate_cpp_pch(pch_header, pch_file.c_str(), include_dir, debug, native_isa))
+            pch_file.clear();
+    }
+
     llvm::LLVMContext context;
-    std::unique_ptr<llvm::Module> module = cpp_to_llvm(input_file, cpp_src, include_dir, debug, context);
+    std::unique_ptr<llvm::Module> module = cpp_to_llvm(input_file, cpp_src, include_dir, debug, native_isa, pch_file.empty() ? nullptr : pch_file.c_str(), context);
 
     if(!module)
     {
@@ -216,12 +322,17 @@ WP_API int compile_cpp(const char* cpp_src, const char *input_file, const char*
     std::string error;
     const llvm::Target* target = llvm::TargetRegistry::lookupTarget(target_triple, error);
 
-    const char* CPU = "generic";
-    const char* features = "";
+    const CpuTarget& cpu_target = get_cpu_target(native_isa);
+
+    std::string features;
+    for(const std::string& feature : cpu_target.features)
+        features += (features.empty() ? "" : ",") + feature;
+
     llvm::TargetOptions target_options;
     llvm::Reloc::Model relocation_model = llvm::Reloc::PIC_;  // Position Independent Code
     llvm::CodeModel::Model code_model = llvm::CodeModel::Large;  // Don't make assumptions about displacement sizes
-    llvm::TargetMachine* target_machine = target->createTargetMachine(target_triple, CPU, features, target_options, relocation_model, code_model);
+    llvm::CodeGenOpt::Level opt_level = debug ? llvm::CodeGenOpt::None : llvm::CodeGenOpt::Aggressive;
+    llvm::TargetMachine* target_machine = target->createTargetMachine(target_triple, cpu_target.cpu, features, target_options, relocation_model, code_model, opt_level);
 
     module->setDataLayout(target_machine->createDataLayout());
 
@@ -293,6 +404,23 @@ WP_API int compile_cuda(const char* cpp_src, const char *input_file, const char*
     return 0;
 }
 
+// Description of the host CPU's target, modules compiled for it are only reused on CPUs with the same one
+WP_API const char* cpu_host_target()
+{
+    static const std::string description = []()
+    {
+        const CpuTarget& target = get_cpu_target(true);
+
+        std::string s = target.cpu;
+        for(const std::string& feature : target.features)
+            s += "," + feature;
+
+        return s;
+    }();
+
+    return description.c_str();
+}
+
 // Global JIT instance
 static llvm::orc::LLJIT* jit = nullptr;
 
@@ -380,6 +508,7 @@ WP_API int load_obj(const char* object_file, const char* module_name)
             SYMBOL(memcpy), SYMBOL(memset), SYMBOL(memmove),
             SYMBOL(_wp_assert),
             SYMBOL(_wp_isfinite),
+            SYMBOL(_wp_parallel_for), SYMBOL(_wp_thread_index),
         #if defined(_WIN64)
             // For functions with large stack frames the compiler will emit a call to
             // __chkstk() to linearly touch each memory page. This grows the stack without
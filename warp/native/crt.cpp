@@ -12,6 +12,12 @@
 #include <cstdio>
 #include <cassert>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 extern "C" WP_API int _wp_isfinite(double x)
 {
     return std::isfinite(x);
@@ -29,4 +35,172 @@ extern "C" WP_API void _wp_assert(const char* expression, const char* file, unsi
     // Now invoke the standard assert(), which may abort the program or break
     // into the debugger as decided by the runtime environment.
     assert(false && "assert() failed");
-}
\ No newline at end of file
+}
+
+namespace
+{
+
+// Persistent pool of worker threads for CPU kernel launches. Each launch is
+// split into chunks which the workers and the calling thread claim through a
+// shared atomic counter, so uneven chunks are balanced automatically.
+class ThreadPool
+{
+public:
+
+    explicit ThreadPool(int num_threads)
+    {
+        // the calling thread also executes chunks
+        for (int i=1; i < num_threads; ++i)
+            workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+
+    int num_threads() const { return int(workers.size()) + 1; }
+
+    void run(_wp_range_func_t func, void* context, size_t n)
+    {
+        // launches from different host threads are serialized
+        std::lock_guard<std::mutex> launch_lock(launch_mutex);
+
+        // a few chunks per thread for load balancing, but not so small that
+        // claiming them dominates for cheap kernels
+        const size_t target_chunks = size_t(num_threads())*8;
+        const size_t chunk = (n + target_chunks - 1)/target_chunks;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            job_func = func;
+            job_context = context;
+            job_size = n;
+            job_chunk = chunk;
+            next_begin.store(0);
+            active = int(workers.size());
+            ++generation;
+        }
+        wake.notify_all();
+
+        in_pool = true;
+        execute_chunks();
+        in_pool = false;
+
+        // wait for workers to drain the remaining chunks
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+    }
+
+private:
+
+    void execute_chunks()
+    {
+        for (;;)
+        {
+            const size_t begin = next_begin.fetch_add(job_chunk);
+            if (begin >= job_size)
+                break;
+
+            const size_t end = begin + job_chunk < job_size ? begin + job_chunk : job_size;
+            job_func(job_context, begin, end);
+        }
+    }
+
+    void worker_loop()
+    {
+        in_pool = true;
+
+        size_t seen = 0;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+            }
+
+            execute_chunks();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--active == 0)
+                    done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+
+    std::mutex launch_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    size_t generation = 0;
+    int active = 0;
+
+    _wp_range_func_t job_func = nullptr;
+    void* job_context = nullptr;
+    size_t job_size = 0;
+    size_t job_chunk = 1;
+    std::atomic<size_t> next_begin{0};
+
+public:
+
+    // set while a thread executes chunks of a launch
+    static thread_local bool in_pool;
+};
+
+thread_local bool ThreadPool::in_pool = false;
+
+thread_local size_t g_thread_index = 0;
+
+std::mutex g_pool_mutex;
+ThreadPool* g_pool = nullptr;
+int g_max_threads = 0;
+
+ThreadPool* get_pool()
+{
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+
+    if (!g_pool)
+    {
+        int num_threads = g_max_threads > 0 ? g_max_threads : int(std::thread::hardware_concurrency());
+
+        // intentionally never destroyed, joining threads from static
+        // destructors of a shared library can deadlock on process exit
+        g_pool = new ThreadPool(num_threads > 0 ? num_threads : 1);
+    }
+
+    return g_pool;
+}
+
+} // anonymous namespace
+
+extern "C" WP_API size_t* _wp_thread_index()
+{
+    return &g_thread_index;
+}
+
+extern "C" WP_API void _wp_parallel_for(_wp_range_func_t func, void* context, size_t n)
+{
+    if (n == 0)
+        return;
+
+    ThreadPool* pool = ThreadPool::in_pool ? nullptr : get_pool();
+
+    // nested launches from inside a chunk run serially on the calling thread
+    if (!pool || pool->num_threads() == 1 || n == 1)
+    {
+        func(context, 0, n);
+        return;
+    }
+
+    pool->run(func, context, n);
+}
+
+// Sets the number of threads used for CPU launches, 0 selects the hardware concurrency.
+// Only takes effect before the first multithreaded launch.
+extern "C" WP_API void cpu_set_max_threads(int num_threads)
+{
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    g_max_threads = num_threads;
+}
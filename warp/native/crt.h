@@ -330,4 +330,30 @@ inline bool isfinite(double x)
 
 #endif  // !__CUDACC__
 
-#endif // WP_NO_CRT
\ No newline at end of file
+#endif // WP_NO_CRT
+
+#if !defined(__CUDA_ARCH__)
+
+// Helpers for multithreaded CPU kernel launches, the thread pool lives in the
+// compiler library so that kernel modules don't need to create threads or
+// thread-local storage themselves
+typedef void (*_wp_range_func_t)(void* context, size_t begin, size_t end);
+
+// Invokes func over [0, n) split into chunks on the thread pool, returns when all chunks are complete
+extern "C" WP_API void _wp_parallel_for(_wp_range_func_t func, void* context, size_t n);
+
+// Invokes f(i) for i in [0, n) on the thread pool
+template <typename Func>
+inline void _wp_parallel_for_each(size_t n, Func& f)
+{
+    _wp_parallel_for([](void* context, size_t begin, size_t end)
+    {
+        for (size_t i=begin; i < end; ++i)
+            (*static_cast<Func*>(context))(i);
+    }, &f, n);
+}
+
+// Returns the address of the calling thread's current launch index
+extern "C" WP_API size_t* _wp_thread_index();
+
+#endif  // !__CUDA_ARCH__
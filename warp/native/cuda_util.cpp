@@ -38,10 +38,12 @@
 namespace wp
 {
 typedef uint32_t GLuint;
+typedef uint32_t GLenum;
 }
 
 // function prototypes adapted from <cudaGLTypedefs.h>
 typedef CUresult (CUDAAPI *PFN_cuGraphicsGLRegisterBuffer_v3000)(CUgraphicsResource *pCudaResource, wp::GLuint buffer, unsigned int Flags);
+typedef CUresult (CUDAAPI *PFN_cuGraphicsGLRegisterImage_v3000)(CUgraphicsResource *pCudaResource, wp::GLuint image, wp::GLenum target, unsigned int Flags);
 
 
 // function pointers to driver API entry points
@@ -78,15 +80,24 @@ static PFN_cuStreamWaitEvent_v3020 pfn_cuStreamWaitEvent;
 static PFN_cuEventCreate_v2000 pfn_cuEventCreate;
 static PFN_cuEventDestroy_v4000 pfn_cuEventDestroy;
 static PFN_cuEventRecord_v2000 pfn_cuEventRecord;
+static PFN_cuEventElapsedTime_v2000 pfn_cuEventElapsedTime;
+static PFN_cuEventQuery_v2000 pfn_cuEventQuery;
+static PFN_cuEventSynchronize_v2000 pfn_cuEventSynchronize;
 static PFN_cuModuleLoadDataEx_v2010 pfn_cuModuleLoadDataEx;
 static PFN_cuModuleUnload_v2000 pfn_cuModuleUnload;
 static PFN_cuModuleGetFunction_v2000 pfn_cuModuleGetFunction;
 static PFN_cuLaunchKernel_v4000 pfn_cuLaunchKernel;
+static PFN_cuLaunchCooperativeKernel_v9000 pfn_cuLaunchCooperativeKernel;
+static PFN_cuOccupancyMaxPotentialBlockSize_v6050 pfn_cuOccupancyMaxPotentialBlockSize;
 static PFN_cuMemcpyPeerAsync_v4000 pfn_cuMemcpyPeerAsync;
+static PFN_cuPointerGetAttribute_v4000 pfn_cuPointerGetAttribute;
+static PFN_cuMemcpy2DAsync_v3020 pfn_cuMemcpy2DAsync;
 static PFN_cuGraphicsMapResources_v3000 pfn_cuGraphicsMapResources;
 static PFN_cuGraphicsUnmapResources_v3000 pfn_cuGraphicsUnmapResources;
 static PFN_cuGraphicsResourceGetMappedPointer_v3020 pfn_cuGraphicsResourceGetMappedPointer;
 static PFN_cuGraphicsGLRegisterBuffer_v3000 pfn_cuGraphicsGLRegisterBuffer;
+static PFN_cuGraphicsGLRegisterImage_v3000 pfn_cuGraphicsGLRegisterImage;
+static PFN_cuGraphicsSubResourceGetMappedArray_v3000 pfn_cuGraphicsSubResourceGetMappedArray;
 static PFN_cuGraphicsUnregisterResource_v3000 pfn_cuGraphicsUnregisterResource;
 
 
@@ -184,15 +195,24 @@ bool init_cuda_driver()
     get_driver_entry_point("cuEventCreate", &(void*&)pfn_cuEventCreate);
     get_driver_entry_point("cuEventDestroy", &(void*&)pfn_cuEventDestroy);
     get_driver_entry_point("cuEventRecord", &(void*&)pfn_cuEventRecord);
+    get_driver_entry_point("cuEventElapsedTime", &(void*&)pfn_cuEventElapsedTime);
+    get_driver_entry_point("cuEventQuery", &(void*&)pfn_cuEventQuery);
+    get_driver_entry_point("cuEventSynchronize", &(void*&)pfn_cuEventSynchronize);
     get_driver_entry_point("cuModuleLoadDataEx", &(void*&)pfn_cuModuleLoadDataEx);
     get_driver_entry_point("cuModuleUnload", &(void*&)pfn_cuModuleUnload);
     get_driver_entry_point("cuModuleGetFunction", &(void*&)pfn_cuModuleGetFunction);
     get_driver_entry_point("cuLaunchKernel", &(void*&)pfn_cuLaunchKernel);
+    get_driver_entry_point("cuLaunchCooperativeKernel", &(void*&)pfn_cuLaunchCooperativeKernel);
+    get_driver_entry_point("cuOccupancyMaxPotentialBlockSize", &(void*&)pfn_cuOccupancyMaxPotentialBlockSize);
     get_driver_entry_point("cuMemcpyPeerAsync", &(void*&)pfn_cuMemcpyPeerAsync);
+    get_driver_entry_point("cuPointerGetAttribute", &(void*&)pfn_cuPointerGetAttribute);
+    get_driver_entry_point("cuMemcpy2DAsync", &(void*&)pfn_cuMemcpy2DAsync);
     get_driver_entry_point("cuGraphicsMapResources", &(void*&)pfn_cuGraphicsMapResources);
     get_driver_entry_point("cuGraphicsUnmapResources", &(void*&)pfn_cuGraphicsUnmapResources);
     get_driver_entry_point("cuGraphicsResourceGetMappedPointer", &(void*&)pfn_cuGraphicsResourceGetMappedPointer);
     get_driver_entry_point("cuGraphicsGLRegisterBuffer", &(void*&)pfn_cuGraphicsGLRegisterBuffer);
+    get_driver_entry_point("cuGraphicsGLRegisterImage", &(void*&)pfn_cuGraphicsGLRegisterImage);
+    get_driver_entry_point("cuGraphicsSubResourceGetMappedArray", &(void*&)pfn_cuGraphicsSubResourceGetMappedArray);
     get_driver_entry_point("cuGraphicsUnregisterResource", &(void*&)pfn_cuGraphicsUnregisterResource);
 
     if (pfn_cuInit)
@@ -379,6 +399,21 @@ CUresult cuEventRecord_f(CUevent event, CUstream stream)
     return pfn_cuEventRecord ? pfn_cuEventRecord(event, stream) : DRIVER_ENTRY_POINT_ERROR;
 }
 
+CUresult cuEventElapsedTime_f(float* ms, CUevent start, CUevent end)
+{
+    return pfn_cuEventElapsedTime ? pfn_cuEventElapsedTime(ms, start, end) : DRIVER_ENTRY_POINT_ERROR;
+}
+
+CUresult cuEventQuery_f(CUevent event)
+{
+    return pfn_cuEventQuery ? pfn_cuEventQuery(event) : DRIVER_ENTRY_POINT_ERROR;
+}
+
+CUresult cuEventSynchronize_f(CUevent event)
+{
+    return pfn_cuEventSynchronize ? pfn_cuEventSynchronize(event) : DRIVER_ENTRY_POINT_ERROR;
+}
+
 CUresult cuModuleLoadDataEx_f(CUmodule *module, const void *image, unsigned int numOptions, CUjit_option *options, void **optionValues)
 {
     return pfn_cuModuleLoadDataEx ? pfn_cuModuleLoadDataEx(module, image, numOptions, options, optionValues) : DRIVER_ENTRY_POINT_ERROR;
@@ -399,11 +434,31 @@ CUresult cuLaunchKernel_f(CUfunction f, unsigned int gridDimX, unsigned int grid
     return pfn_cuLaunchKernel ? pfn_cuLaunchKernel(f, gridDimX, gridDimY, gridDimZ, blockDimX, blockDimY, blockDimZ, sharedMemBytes, hStream, kernelParams, extra) : DRIVER_ENTRY_POINT_ERROR;
 }
 
+CUresult cuLaunchCooperativeKernel_f(CUfunction f, unsigned int gridDimX, unsigned int gridDimY, unsigned int gridDimZ, unsigned int blockDimX, unsigned int blockDimY, unsigned int blockDimZ, unsigned int sharedMemBytes, CUstream hStream, void **kernelParams)
+{
+    return pfn_cuLaunchCooperativeKernel ? pfn_cuLaunchCooperativeKernel(f, gridDimX, gridDimY, gridDimZ, blockDimX, blockDimY, blockDimZ, sharedMemBytes, hStream, kernelParams) : DRIVER_ENTRY_POINT_ERROR;
+}
+
+CUresult cuOccupancyMaxPotentialBlockSize_f(int* min_grid_size, int* block_size, CUfunction func, CUoccupancyB2DSize block_size_to_dynamic_smem_size, size_t dynamic_smem_size, int block_size_limit)
+{
+    return pfn_cuOccupancyMaxPotentialBlockSize ? pfn_cuOccupancyMaxPotentialBlockSize(min_grid_size, block_size, func, block_size_to_dynamic_smem_size, dynamic_smem_size, block_size_limit) : DRIVER_ENTRY_POINT_ERROR;
+}
+
 CUresult cuMemcpyPeerAsync_f(CUdeviceptr dst_ptr, CUcontext dst_ctx, CUdeviceptr src_ptr, CUcontext src_ctx, size_t n, CUstream stream)
 {
     return pfn_cuMemcpyPeerAsync ? pfn_cuMemcpyPeerAsync(dst_ptr, dst_ctx, src_ptr, src_ctx, n, stream) : DRIVER_ENTRY_POINT_ERROR;
 }
 
+CUresult cuPointerGetAttribute_f(void* data, CUpointer_attribute attribute, CUdeviceptr ptr)
+{
+    return pfn_cuPointerGetAttribute ? pfn_cuPointerGetAttribute(data, attribute, ptr) : DRIVER_ENTRY_POINT_ERROR;
+}
+
+CUresult cuMemcpy2DAsync_f(const CUDA_MEMCPY2D* copy, CUstream stream)
+{
+    return pfn_cuMemcpy2DAsync ? pfn_cuMemcpy2DAsync(copy, stream) : DRIVER_ENTRY_POINT_ERROR;
+}
+
 CUresult cuGraphicsMapResources_f(unsigned int count, CUgraphicsResource* resources, CUstream stream)
 {
     return pfn_cuGraphicsMapResources ? pfn_cuGraphicsMapResources(count, resources, stream) : DRIVER_ENTRY_POINT_ERROR;
@@ -424,6 +479,16 @@ CUresult cuGraphicsGLRegisterBuffer_f(CUgraphicsResource *pCudaResource, unsigne
     return pfn_cuGraphicsGLRegisterBuffer ? pfn_cuGraphicsGLRegisterBuffer(pCudaResource, (wp::GLuint) buffer, flags) : DRIVER_ENTRY_POINT_ERROR;
 }
 
+CUresult cuGraphicsGLRegisterImage_f(CUgraphicsResource *pCudaResource, unsigned int image, unsigned int target, unsigned int flags)
+{
+    return pfn_cuGraphicsGLRegisterImage ? pfn_cuGraphicsGLRegisterImage(pCudaResource, (wp::GLuint) image, (wp::GLenum) target, flags) : DRIVER_ENTRY_POINT_ERROR;
+}
+
+CUresult cuGraphicsSubResourceGetMappedArray_f(CUarray* pArray, CUgraphicsResource resource, unsigned int arrayIndex, unsigned int mipLevel)
+{
+    return pfn_cuGraphicsSubResourceGetMappedArray ? pfn_cuGraphicsSubResourceGetMappedArray(pArray, resource, arrayIndex, mipLevel) : DRIVER_ENTRY_POINT_ERROR;
+}
+
 CUresult cuGraphicsUnregisterResource_f(CUgraphicsResource resource)
 {
     return pfn_cuGraphicsUnregisterResource ? pfn_cuGraphicsUnregisterResource(resource) : DRIVER_ENTRY_POINT_ERROR;
@@ -19,6 +19,7 @@ bool cutlass_gemm(
                   int compute_capability,
                   int m, int n, int k,
                   const char* datatype_str,
+                  const char* datatype_out_str,
                   const void* a, const void* b, const void* c, void* d,
                   float alpha, float beta,
                   bool row_major_a, bool row_major_b,
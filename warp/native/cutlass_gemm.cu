@@ -10,7 +10,8 @@
 
 #include "cutlass/cutlass.h"
 #include "cutlass/gemm/device/gemm_universal.h"
-#include "cutlass/util/device_memory.h"
+
+#include <map>
 
 #define F16_STR "<f2"
 #define F32_STR "<f4"
@@ -18,6 +19,33 @@
 
 namespace wp {
 
+struct GemmWorkspace
+{
+    void* mem = NULL;
+    size_t size = 0;
+};
+
+// map workspace buffers to CUDA contexts and streams, buffers only grow so that
+// GEMMs are allocation-free (and safe to capture in graphs) after warmup
+static std::map<std::pair<void*, void*>, GemmWorkspace> g_gemm_workspace_map;
+
+static void* gemm_workspace_reserve(void* context, void* stream, size_t size)
+{
+    if (size == 0)
+        return NULL;
+
+    GemmWorkspace& workspace = g_gemm_workspace_map[std::make_pair(context, stream)];
+
+    if (size > workspace.size)
+    {
+        free_device(context, workspace.mem);
+        workspace.mem = alloc_device(context, size);
+        workspace.size = size;
+    }
+
+    return workspace.mem;
+}
+
 template <typename Gemm>
 bool run_gemm(int m, int n, int k, int batch_count, const void* a, const void* b, const void* c, void* d, float alpha, float beta) {
     //
@@ -37,10 +65,13 @@ bool run_gemm(int m, int n, int k, int batch_count, const void* a, const void* b
         Gemm::LayoutA::packed({m, k}).stride(0), Gemm::LayoutB::packed({k, n}).stride(0), n, n
     };
 
+    void* context = cuda_context_get_current();
+    void* stream = cuda_stream_get_current();
+
     Gemm gemm;
     size_t workspace_size = Gemm::get_workspace_size(arguments);
-    cutlass::DeviceAllocation<uint8_t> workspace(workspace_size);
-    cutlass::Status status = gemm.initialize(arguments, workspace.get());
+    void* workspace = gemm_workspace_reserve(context, stream, workspace_size);
+    cutlass::Status status = gemm.initialize(arguments, workspace, (cudaStream_t)stream);
 
     if (status != cutlass::Status::kSuccess) {
         cudaError_t error = cudaGetLastError();
@@ -52,7 +83,7 @@ bool run_gemm(int m, int n, int k, int batch_count, const void* a, const void* b
     // Run the GEMM
     //
 
-    status = gemm();
+    status = gemm((cudaStream_t)stream);
     if (status != cutlass::Status::kSuccess) {
         cudaError_t error = cudaGetLastError();
         std::cerr << "Runtime error: " << cudaGetErrorString(error) << "\n";
@@ -66,7 +97,8 @@ template <
     int ComputeCapability,
     typename Element_,
     typename LayoutA,
-    typename LayoutB
+    typename LayoutB,
+    typename ElementOutput_ = Element_
 >
 struct DefaultGemmConfig;
 
@@ -120,24 +152,24 @@ struct DefaultGemmConfig<80, float, LayoutA, LayoutB> {
     >;
 };
 
-// Partial specialization for SM80 F16 Tensor Cores
-template <typename LayoutA, typename LayoutB>
-struct DefaultGemmConfig<80, cutlass::half_t, LayoutA, LayoutB> {
+// Partial specialization for SM80 F16 Tensor Cores with F32 accumulation and F16 or F32 output
+template <typename LayoutA, typename LayoutB, typename ElementOutput>
+struct DefaultGemmConfig<80, cutlass::half_t, LayoutA, LayoutB, ElementOutput> {
     using Gemm = cutlass::gemm::device::GemmUniversal<
         cutlass::half_t, LayoutA,                                       // ElementA and LayoutA
         cutlass::half_t, LayoutB,                                       // ElementB and LayoutB
-        cutlass::half_t, cutlass::layout::RowMajor,                     // ElementC and LayoutC
-        cutlass::half_t,                                                // ElementAccumulator
+        ElementOutput, cutlass::layout::RowMajor,                       // ElementC and LayoutC
+        float,                                                          // ElementAccumulator
         cutlass::arch::OpClassTensorOp,                                 // Operation type
         cutlass::arch::Sm80,                                            // Architecture
         cutlass::gemm::GemmShape<256, 128, 32>,                         // ThreadblockShape
         cutlass::gemm::GemmShape<64, 64, 32>,                           // WarpShape
         cutlass::gemm::GemmShape<16, 8, 16>,                            // Instruction Shape
         cutlass::epilogue::thread::LinearCombination<                   // Epilogue
-            cutlass::half_t,
-            128 / cutlass::sizeof_bits<cutlass::half_t>::value,
-            cutlass::half_t,
-            cutlass::half_t>,
+            ElementOutput,
+            128 / cutlass::sizeof_bits<ElementOutput>::value,
+            float,
+            float>,
         cutlass::gemm::threadblock::GemmIdentityThreadblockSwizzle<>,   // Swizzling
         3                                                               // Stages
     >;
@@ -145,24 +177,24 @@ struct DefaultGemmConfig<80, cutlass::half_t, LayoutA, LayoutB> {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Partial specialization for SM75 F16 Tensor Cores
-template <typename LayoutA, typename LayoutB>
-struct DefaultGemmConfig<75, cutlass::half_t, LayoutA, LayoutB> {
+// Partial specialization for SM75 F16 Tensor Cores with F32 accumulation and F16 or F32 output
+template <typename LayoutA, typename LayoutB, typename ElementOutput>
+struct DefaultGemmConfig<75, cutlass::half_t, LayoutA, LayoutB, ElementOutput> {
     using Gemm = cutlass::gemm::device::GemmUniversal<
         cutlass::half_t, LayoutA,                                       // ElementA and LayoutA
         cutlass::half_t, LayoutB,                                       // ElementB and LayoutB
-        cutlass::half_t, cutlass::layout::RowMajor,                     // ElementC and LayoutC
-        cutlass::half_t,                                                // ElementAccumulator
+        ElementOutput, cutlass::layout::RowMajor,                       // ElementC and LayoutC
+        float,                                                          // ElementAccumulator
         cutlass::arch::OpClassTensorOp,                                 // Operation type
         cutlass::arch::Sm75,                                            // Architecture
         cutlass::gemm::GemmShape<256, 128, 32>,                         // ThreadblockShape
         cutlass::gemm::GemmShape<64, 64, 32>,                           // WarpShape
         cutlass::gemm::GemmShape<16, 8, 8>,                             // Instruction Shape
         cutlass::epilogue::thread::LinearCombination<                   // Epilogue
-            cutlass::half_t,
-            128 / cutlass::sizeof_bits<cutlass::half_t>::value,
-            cutlass::half_t,
-            cutlass::half_t>,
+            ElementOutput,
+            128 / cutlass::sizeof_bits<ElementOutput>::value,
+            float,
+            float>,
         cutlass::gemm::threadblock::GemmIdentityThreadblockSwizzle<>,   // Swizzling
         2                                                               // Stages
     >;
@@ -170,24 +202,24 @@ struct DefaultGemmConfig<75, cutlass::half_t, LayoutA, LayoutB> {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Partial specialization for SM70 F16 Tensor Cores
-template <typename LayoutA, typename LayoutB>
-struct DefaultGemmConfig<70, cutlass::half_t, LayoutA, LayoutB> {
+// Partial specialization for SM70 F16 Tensor Cores with F32 accumulation and F16 or F32 output
+template <typename LayoutA, typename LayoutB, typename ElementOutput>
+struct DefaultGemmConfig<70, cutlass::half_t, LayoutA, LayoutB, ElementOutput> {
     using Gemm = cutlass::gemm::device::GemmUniversal<
         cutlass::half_t, LayoutA,                                       // ElementA and LayoutA
         cutlass::half_t, LayoutB,                                       // ElementB and LayoutB
-        cutlass::half_t, cutlass::layout::RowMajor,                     // ElementC and LayoutC
-        cutlass::half_t,                                                // ElementAccumulator
+        ElementOutput, cutlass::layout::RowMajor,                       // ElementC and LayoutC
+        float,                                                          // ElementAccumulator
         cutlass::arch::OpClassTensorOp,                                 // Operation type
         cutlass::arch::Sm70,                                            // Architecture
         cutlass::gemm::GemmShape<256, 128, 32>,                         // ThreadblockShape
         cutlass::gemm::GemmShape<64, 64, 32>,                           // WarpShape
         cutlass::gemm::GemmShape<8, 8, 4>,                              // Instruction Shape
         cutlass::epilogue::thread::LinearCombination<                   // Epilogue
-            cutlass::half_t,
-            128 / cutlass::sizeof_bits<cutlass::half_t>::value,
-            cutlass::half_t,
-            cutlass::half_t>,
+            ElementOutput,
+            128 / cutlass::sizeof_bits<ElementOutput>::value,
+            float,
+            float>,
         cutlass::gemm::threadblock::GemmIdentityThreadblockSwizzle<>,   // Swizzling
         2                                                               // Stages
     >;
@@ -218,6 +250,50 @@ struct DefaultGemmConfig<50, Element, LayoutA, LayoutB> {
     >;
 };
 
+// Dispatches on the operand layouts
+template <int ComputeCapability, typename Element, typename ElementOutput = Element>
+bool run_gemm_with_layouts(
+                  int m, int n, int k, int batch_count,
+                  const void* a, const void* b, const void* c, void* d,
+                  float alpha, float beta,
+                  bool row_major_a, bool row_major_b) {
+
+    using cutlass::layout::RowMajor;
+    using cutlass::layout::ColumnMajor;
+
+    if (row_major_a && row_major_b) {
+        using Gemm = typename DefaultGemmConfig<ComputeCapability, Element, RowMajor, RowMajor, ElementOutput>::Gemm;
+        return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
+    } else if (!row_major_a && row_major_b) {
+        using Gemm = typename DefaultGemmConfig<ComputeCapability, Element, ColumnMajor, RowMajor, ElementOutput>::Gemm;
+        return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
+    } else if (row_major_a && !row_major_b) {
+        using Gemm = typename DefaultGemmConfig<ComputeCapability, Element, RowMajor, ColumnMajor, ElementOutput>::Gemm;
+        return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
+    } else {
+        using Gemm = typename DefaultGemmConfig<ComputeCapability, Element, ColumnMajor, ColumnMajor, ElementOutput>::Gemm;
+        return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
+    }
+}
+
+// F16 inputs on Tensor Cores, accumulation is always in F32
+template <int ComputeCapability>
+bool run_gemm_f16(
+                  const std::string& datatype_out,
+                  int m, int n, int k, int batch_count,
+                  const void* a, const void* b, const void* c, void* d,
+                  float alpha, float beta,
+                  bool row_major_a, bool row_major_b) {
+
+    if (datatype_out == F16_STR)
+        return run_gemm_with_layouts<ComputeCapability, cutlass::half_t>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
+    else if (datatype_out == F32_STR)
+        return run_gemm_with_layouts<ComputeCapability, cutlass::half_t, float>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
+
+    std::cerr << "Output data type " << datatype_out << " is not supported for F16 inputs." << std::endl;
+    return false;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 extern "C" {
@@ -227,6 +303,7 @@ bool cutlass_gemm(
                   int compute_capability,
                   int m, int n, int k,
                   const char* datatype_str,
+                  const char* datatype_out_str,
                   const void* a, const void* b, const void* c, void* d,
                   float alpha, float beta,
                   bool row_major_a, bool row_major_b,
@@ -234,129 +311,43 @@ bool cutlass_gemm(
                   int batch_count) {
 
     std::string datatype(datatype_str);
+    std::string datatype_out(datatype_out_str);
+
+    // mixed precision is only available for F16 inputs on Tensor Cores
+    const bool mixed = datatype != datatype_out;
 
-    // Specializations for using Tensor Cores and A/B RowMajor/ColumnMajor designations
-    if (compute_capability == 80) {
-        if (datatype == F64_STR) {
-            if (row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<80, double, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<80, double, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<80, double, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<80, double, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            }
-        } else if (datatype == F32_STR && allow_tf32x3_arith) {
-            if (row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<80, float, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<80, float, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<80, float, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<80, float, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            }
+    // Specializations for using Tensor Cores, newer architectures (e.g.: SM86, SM90) run the SM80 kernels
+    if (compute_capability >= 80) {
+        // F64 Tensor Cores are only full rate on SM80 and SM90
+        if (datatype == F64_STR && !mixed && (compute_capability == 80 || compute_capability == 90)) {
+            return run_gemm_with_layouts<80, double>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
+        } else if (datatype == F32_STR && !mixed && allow_tf32x3_arith) {
+            return run_gemm_with_layouts<80, float>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
         } else if (datatype == F16_STR) {
-            if (row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<80, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<80, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<80, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<80, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            }
+            return run_gemm_f16<80>(datatype_out, m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
         }
-    } else if (compute_capability == 75) {
+    } else if (compute_capability >= 75) {
         if (datatype == F16_STR) {
-            if (row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<75, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);    
-            } else if (!row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<75, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);    
-            } else if (row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<75, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);    
-            } else if (!row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<75, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);    
-            }
+            return run_gemm_f16<75>(datatype_out, m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
         }
-    } else if (compute_capability == 70) {
+    } else if (compute_capability >= 70) {
         if (datatype == F16_STR) {
-            if (row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<70, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && row_major_b) {
-                using Gemm = DefaultGemmConfig<70, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<70, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            } else if (!row_major_a && !row_major_b) {
-                using Gemm = DefaultGemmConfig<70, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-                return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-            }
+            return run_gemm_f16<70>(datatype_out, m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
         }
     }
 
+    if (mixed) {
+        std::cerr << "Mixed precision GEMM from " << datatype << " to " << datatype_out << " requires Tensor Cores (SM70 or newer)." << std::endl;
+        return false;
+    }
+
     // No Tensor Core capability available. Run a SIMT kernel
     if (datatype == F64_STR) {
-        if (row_major_a && row_major_b) {
-            using Gemm = DefaultGemmConfig<50, double, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (!row_major_a && row_major_b) {
-            using Gemm = DefaultGemmConfig<50, double, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (row_major_a && !row_major_b) {
-            using Gemm = DefaultGemmConfig<50, double, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (!row_major_a && !row_major_b) {
-            using Gemm = DefaultGemmConfig<50, double, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        }
+        return run_gemm_with_layouts<50, double>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
     } else if (datatype == F32_STR) {
-        if (row_major_a && row_major_b) {
-            using Gemm = DefaultGemmConfig<50, float, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (!row_major_a && row_major_b) {
-            using Gemm = DefaultGemmConfig<50, float, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (row_major_a && !row_major_b) {
-            using Gemm = DefaultGemmConfig<50, float, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (!row_major_a && !row_major_b) {
-            using Gemm = DefaultGemmConfig<50, float, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        }
+        return run_gemm_with_layouts<50, float>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
     } else if (datatype == F16_STR) {
-        if (row_major_a && row_major_b) {
-            using Gemm = DefaultGemmConfig<50, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::RowMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (!row_major_a && row_major_b) {
-            using Gemm = DefaultGemmConfig<50, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::RowMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (row_major_a && !row_major_b) {
-            using Gemm = DefaultGemmConfig<50, cutlass::half_t, cutlass::layout::RowMajor, cutlass::layout::ColumnMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        } else if (!row_major_a && !row_major_b) {
-            using Gemm = DefaultGemmConfig<50, cutlass::half_t, cutlass::layout::ColumnMajor, cutlass::layout::ColumnMajor>::Gemm;
-            return run_gemm<Gemm>(m, n, k, batch_count, a, b, c, d, alpha, beta);
-        }
+        return run_gemm_with_layouts<50, cutlass::half_t>(m, n, k, batch_count, a, b, c, d, alpha, beta, row_major_a, row_major_b);
     }
 
     std::cerr << "Data type " << datatype << " is not currently supported." << std::endl;
@@ -0,0 +1,345 @@
+/** Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+namespace wp
+{
+
+// dual number carrying the derivatives of a float32 value along N tangent directions, the forward-mode
+// entry points of kernels (see codegen_kernel_jvp() in codegen.py) evaluate their code with every float32
+// replaced by dual_t<N>, so that the templated vector, matrix and quaternion builtins propagate tangents too
+template <int N>
+struct dual_t
+{
+    float32 val;
+    float32 dot[N];
+
+    inline CUDA_CALLABLE dual_t() : val(0.0f)
+    {
+        for (int i=0; i < N; ++i)
+            dot[i] = 0.0f;
+    }
+
+    // constants and values of other types have no tangents
+    template <typename T>
+    inline CUDA_CALLABLE dual_t(T v) : val(float32(v))
+    {
+        for (int i=0; i < N; ++i)
+            dot[i] = 0.0f;
+    }
+
+    // casts to other types drop the tangents
+    template <typename T>
+    inline CUDA_CALLABLE explicit operator T() const { return T(val); }
+
+    inline CUDA_CALLABLE dual_t& operator += (const dual_t& b);
+    inline CUDA_CALLABLE dual_t& operator -= (const dual_t& b);
+    inline CUDA_CALLABLE dual_t& operator *= (const dual_t& b);
+    inline CUDA_CALLABLE dual_t& operator /= (const dual_t& b);
+};
+
+// type of the intermediate 2x2 determinants of the 4x4 determinants and inverses of mat.h, accumulated in double
+// precision except for dual numbers which must keep their tangents
+template <typename Type>
+struct cofactor_t
+{
+    typedef double type;
+};
+
+template <int N>
+struct cofactor_t<dual_t<N>>
+{
+    typedef dual_t<N> type;
+};
+
+// value f(a) of a function with derivative d at a
+template <int N>
+inline CUDA_CALLABLE dual_t<N> dual_chain(float32 f, const dual_t<N>& a, float32 d)
+{
+    dual_t<N> r;
+    r.val = f;
+    for (int i=0; i < N; ++i)
+        r.dot[i] = d*a.dot[i];
+    return r;
+}
+
+// value f(a, b) of a function with partial derivatives da and db at (a, b)
+template <int N>
+inline CUDA_CALLABLE dual_t<N> dual_chain(float32 f, const dual_t<N>& a, float32 da, const dual_t<N>& b, float32 db)
+{
+    dual_t<N> r;
+    r.val = f;
+    for (int i=0; i < N; ++i)
+        r.dot[i] = da*a.dot[i] + db*b.dot[i];
+    return r;
+}
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator + (const dual_t<N>& a, const dual_t<N>& b) { return dual_chain(a.val + b.val, a, 1.0f, b, 1.0f); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator - (const dual_t<N>& a, const dual_t<N>& b) { return dual_chain(a.val - b.val, a, 1.0f, b, -1.0f); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator * (const dual_t<N>& a, const dual_t<N>& b) { return dual_chain(a.val*b.val, a, b.val, b, a.val); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator / (const dual_t<N>& a, const dual_t<N>& b) { return dual_chain(a.val/b.val, a, 1.0f/b.val, b, -a.val/(b.val*b.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator - (const dual_t<N>& a) { return dual_chain(-a.val, a, -1.0f); }
+
+// mixed arithmetic with constants, e.g.: Type(2)*x in the templated builtins
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator + (const dual_t<N>& a, float32 b) { return a + dual_t<N>(b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator + (float32 a, const dual_t<N>& b) { return dual_t<N>(a) + b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator - (const dual_t<N>& a, float32 b) { return a - dual_t<N>(b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator - (float32 a, const dual_t<N>& b) { return dual_t<N>(a) - b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator * (const dual_t<N>& a, float32 b) { return dual_chain(a.val*b, a, b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator * (float32 a, const dual_t<N>& b) { return dual_chain(a*b.val, b, a); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator / (const dual_t<N>& a, float32 b) { return dual_chain(a.val/b, a, 1.0f/b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> operator / (float32 a, const dual_t<N>& b) { return dual_t<N>(a)/b; }
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N>& dual_t<N>::operator += (const dual_t<N>& b) { return *this = *this + b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N>& dual_t<N>::operator -= (const dual_t<N>& b) { return *this = *this - b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N>& dual_t<N>::operator *= (const dual_t<N>& b) { return *this = *this * b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N>& dual_t<N>::operator /= (const dual_t<N>& b) { return *this = *this / b; }
+
+// comparisons are evaluated on the values
+#define DUAL_COMPARISON(op) \
+template <int N> \
+inline CUDA_CALLABLE bool operator op (const dual_t<N>& a, const dual_t<N>& b) { return a.val op b.val; } \
+template <int N> \
+inline CUDA_CALLABLE bool operator op (const dual_t<N>& a, float32 b) { return a.val op b; } \
+template <int N> \
+inline CUDA_CALLABLE bool operator op (float32 a, const dual_t<N>& b) { return a op b.val; }
+
+DUAL_COMPARISON(<)
+DUAL_COMPARISON(>)
+DUAL_COMPARISON(<=)
+DUAL_COMPARISON(>=)
+DUAL_COMPARISON(==)
+DUAL_COMPARISON(!=)
+
+#undef DUAL_COMPARISON
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> add(dual_t<N> a, dual_t<N> b) { return a + b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> sub(dual_t<N> a, dual_t<N> b) { return a - b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> mul(dual_t<N> a, dual_t<N> b) { return a*b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> div(dual_t<N> a, dual_t<N> b) { return a/b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> neg(dual_t<N> a) { return -a; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> pos(dual_t<N> a) { return a; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> dot(dual_t<N> a, dual_t<N> b) { return a*b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> tensordot(dual_t<N> a, dual_t<N> b) { return a*b; }
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> min(dual_t<N> a, dual_t<N> b) { return a.val < b.val ? a : b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> max(dual_t<N> a, dual_t<N> b) { return a.val > b.val ? a : b; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> leaky_min(dual_t<N> a, dual_t<N> b, dual_t<N> r) { return min(a, b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> leaky_max(dual_t<N> a, dual_t<N> b, dual_t<N> r) { return max(a, b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> clamp(dual_t<N> x, dual_t<N> a, dual_t<N> b) { return min(max(a, x), b); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> abs(dual_t<N> x) { return x.val < 0.0f ? -x : x; }
+
+// piecewise constant functions have zero derivatives
+template <int N>
+inline CUDA_CALLABLE dual_t<N> sign(dual_t<N> x) { return dual_t<N>(sign(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> step(dual_t<N> x) { return dual_t<N>(step(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> nonzero(dual_t<N> x) { return dual_t<N>(nonzero(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> floordiv(dual_t<N> a, dual_t<N> b) { return dual_t<N>(floordiv(a.val, b.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> round(dual_t<N> x) { return dual_t<N>(round(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> rint(dual_t<N> x) { return dual_t<N>(rint(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> trunc(dual_t<N> x) { return dual_t<N>(trunc(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> floor(dual_t<N> x) { return dual_t<N>(floor(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> ceil(dual_t<N> x) { return dual_t<N>(ceil(x.val)); }
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> mod(dual_t<N> a, dual_t<N> b) { return dual_chain(mod(a.val, b.val), a, 1.0f, b, -trunc(a.val/b.val)); }
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> sqrt(dual_t<N> x) { const float32 r = sqrt(x.val); return dual_chain(r, x, 0.5f/r); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> rsqrt(dual_t<N> x) { const float32 r = rsqrt(x.val); return dual_chain(r, x, -0.5f*r*r*r); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> exp(dual_t<N> x) { const float32 r = exp(x.val); return dual_chain(r, x, r); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> exp_approx(dual_t<N> x) { const float32 r = exp_approx(x.val); return dual_chain(r, x, r); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> log(dual_t<N> x) { return dual_chain(log(x.val), x, 1.0f/x.val); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> log2(dual_t<N> x) { return dual_chain(log2(x.val), x, 1.0f/(x.val*0.693147180559945f)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> log10(dual_t<N> x) { return dual_chain(log10(x.val), x, 1.0f/(x.val*2.302585092994046f)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> pow(dual_t<N> a, dual_t<N> b)
+{
+    const float32 r = pow(a.val, b.val);
+    // the derivative with respect to the exponent is only defined for positive bases
+    const float32 db = a.val > 0.0f ? r*log(a.val) : 0.0f;
+    return dual_chain(r, a, b.val*pow(a.val, b.val - 1.0f), b, db);
+}
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> sin(dual_t<N> x) { return dual_chain(sin(x.val), x, cos(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> cos(dual_t<N> x) { return dual_chain(cos(x.val), x, -sin(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> sin_approx(dual_t<N> x) { return dual_chain(sin_approx(x.val), x, cos_approx(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> cos_approx(dual_t<N> x) { return dual_chain(cos_approx(x.val), x, -sin_approx(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> tan(dual_t<N> x) { const float32 c = cos(x.val); return dual_chain(tan(x.val), x, 1.0f/(c*c)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> asin(dual_t<N> x)
+{
+    // the builtins clamp their arguments to [-1, 1], where the derivative is capped to stay finite
+    const float32 d = 1.0f/sqrt(max(1.0f - x.val*x.val, 1.0e-12f));
+    return dual_chain(asin(x.val), x, d);
+}
+template <int N>
+inline CUDA_CALLABLE dual_t<N> acos(dual_t<N> x)
+{
+    const float32 d = -1.0f/sqrt(max(1.0f - x.val*x.val, 1.0e-12f));
+    return dual_chain(acos(x.val), x, d);
+}
+template <int N>
+inline CUDA_CALLABLE dual_t<N> atan(dual_t<N> x) { return dual_chain(atan(x.val), x, 1.0f/(1.0f + x.val*x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> atan2(dual_t<N> y, dual_t<N> x)
+{
+    const float32 d = 1.0f/(x.val*x.val + y.val*y.val);
+    return dual_chain(atan2(y.val, x.val), y, x.val*d, x, -y.val*d);
+}
+template <int N>
+inline CUDA_CALLABLE dual_t<N> sinh(dual_t<N> x) { return dual_chain(sinh(x.val), x, cosh(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> cosh(dual_t<N> x) { return dual_chain(cosh(x.val), x, sinh(x.val)); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> tanh(dual_t<N> x) { const float32 t = tanh(x.val); return dual_chain(t, x, 1.0f - t*t); }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> degrees(dual_t<N> x) { return x*RAD_TO_DEG; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> radians(dual_t<N> x) { return x*DEG_TO_RAD; }
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> lerp(const dual_t<N>& a, const dual_t<N>& b, dual_t<N> t) { return a*(1.0f - t) + b*t; }
+template <int N>
+inline CUDA_CALLABLE dual_t<N> smoothstep(dual_t<N> edge0, dual_t<N> edge1, dual_t<N> x)
+{
+    x = clamp((x - edge0)/(edge1 - edge0), dual_t<N>(0.0f), dual_t<N>(1.0f));
+    return x*x*(3.0f - 2.0f*x);
+}
+
+template <int N>
+inline CUDA_CALLABLE bool isfinite(dual_t<N> x) { return isfinite(x.val); }
+
+// float(x) keeps the tangents of float32 values
+template <int N>
+inline CUDA_CALLABLE dual_t<N> cast_float(dual_t<N> x) { return x; }
+
+template <int N>
+inline CUDA_CALLABLE void print(dual_t<N> x)
+{
+    printf("%g (", x.val);
+    for (int i=0; i < N; ++i)
+        printf(i ? " %g" : "%g", x.dot[i]);
+    printf(")\n");
+}
+
+// each component is accumulated atomically, which is all that sums of values and tangents require, atomic_sub()
+// in array.h adds the negated value
+template <int N>
+inline CUDA_CALLABLE dual_t<N> atomic_add(dual_t<N>* buf, dual_t<N> value)
+{
+    dual_t<N> old;
+    old.val = atomic_add(&buf->val, value.val);
+    for (int i=0; i < N; ++i)
+        old.dot[i] = atomic_add(&buf->dot[i], value.dot[i]);
+    return old;
+}
+
+template<unsigned Length, typename Type> struct vec_t;
+template<unsigned Rows, unsigned Cols, typename Type> struct mat_t;
+template<typename Type> struct quat_t;
+template<typename Type> struct transform_t;
+
+// values computed without tangents, e.g.: by functions of integers or handles, have zero tangents in forward-mode
+// code, see codegen_tangent()
+template <int N, typename T>
+inline CUDA_CALLABLE T dual_lift(const T& x) { return x; }
+
+template <int N>
+inline CUDA_CALLABLE dual_t<N> dual_lift(float32 x) { return dual_t<N>(x); }
+
+// type of the components of lifted values, the float32 ones get tangents
+template <typename Type, int N>
+struct dual_lift_t
+{
+    typedef Type type;
+};
+
+template <int N>
+struct dual_lift_t<float32, N>
+{
+    typedef dual_t<N> type;
+};
+
+template <int N, unsigned Length, typename Type>
+inline CUDA_CALLABLE vec_t<Length, typename dual_lift_t<Type, N>::type> dual_lift(const vec_t<Length, Type>& x)
+{
+    return vec_t<Length, typename dual_lift_t<Type, N>::type>(x);
+}
+
+template <int N, unsigned Rows, unsigned Cols, typename Type>
+inline CUDA_CALLABLE mat_t<Rows, Cols, typename dual_lift_t<Type, N>::type> dual_lift(const mat_t<Rows, Cols, Type>& x)
+{
+    return mat_t<Rows, Cols, typename dual_lift_t<Type, N>::type>(x);
+}
+
+template <int N, typename Type>
+inline CUDA_CALLABLE quat_t<typename dual_lift_t<Type, N>::type> dual_lift(const quat_t<Type>& x)
+{
+    typedef typename dual_lift_t<Type, N>::type T;
+    return quat_t<T>(T(x.x), T(x.y), T(x.z), T(x.w));
+}
+
+template <int N, typename Type>
+inline CUDA_CALLABLE transform_t<typename dual_lift_t<Type, N>::type> dual_lift(const transform_t<Type>& x)
+{
+    return transform_t<typename dual_lift_t<Type, N>::type>(dual_lift<N>(x.p), dual_lift<N>(x.q));
+}
+
+} // namespace wp
@@ -591,6 +591,8 @@ WP_API void builtin_mesh_query_point_sign_winding_number_uint64_vec3f_float32_fl
 WP_API void builtin_mesh_query_ray_uint64_vec3f_vec3f_float32_float32_float32_float32_float32_vec3f_int32(uint64 id, vec3f start, vec3f dir, float32 max_t, float32 t, float32 bary_u, float32 bary_v, float32 sign, vec3f normal, int32 face, bool* ret) { *ret = mesh_query_ray(id, start, dir, max_t, t, bary_u, bary_v, sign, normal, face); }
 WP_API void builtin_mesh_query_aabb_uint64_vec3f_vec3f(uint64 id, vec3f lower, vec3f upper, mesh_query_aabb_t* ret) { *ret = mesh_query_aabb(id, lower, upper); }
 WP_API void builtin_mesh_query_aabb_next_mesh_query_aabb_t_int32(mesh_query_aabb_t query, int32 index, bool* ret) { *ret = mesh_query_aabb_next(query, index); }
+WP_API void builtin_tlas_query_ray_uint64_vec3f_vec3f_float32_float32_float32_float32_float32_vec3f_int32_int32(uint64 id, vec3f start, vec3f dir, float32 max_t, float32 t, float32 bary_u, float32 bary_v, float32 sign, vec3f normal, int32 face, int32 instance, bool* ret) { *ret = tlas_query_ray(id, start, dir, max_t, t, bary_u, bary_v, sign, normal, face, instance); }
+WP_API void builtin_tlas_query_aabb_uint64_vec3f_vec3f(uint64 id, vec3f lower, vec3f upper, bvh_query_t* ret) { *ret = tlas_query_aabb(id, lower, upper); }
 WP_API void builtin_mesh_eval_position_uint64_int32_float32_float32(uint64 id, int32 face, float32 bary_u, float32 bary_v, vec3f* ret) { *ret = mesh_eval_position(id, face, bary_u, bary_v); }
 WP_API void builtin_mesh_eval_velocity_uint64_int32_float32_float32(uint64 id, int32 face, float32 bary_u, float32 bary_v, vec3f* ret) { *ret = mesh_eval_velocity(id, face, bary_u, bary_v); }
 WP_API void builtin_hash_grid_query_uint64_vec3f_float32(uint64 id, vec3f point, float32 max_dist, hash_grid_query_t* ret) { *ret = hash_grid_query(id, point, max_dist); }
@@ -624,6 +626,11 @@ WP_API void builtin_randi_uint32_int32_int32(uint32 state, int32 min, int32 max,
 WP_API void builtin_randf_uint32(uint32 state, float* ret) { *ret = randf(state); }
 WP_API void builtin_randf_uint32_float32_float32(uint32 state, float32 min, float32 max, float* ret) { *ret = randf(state, min, max); }
 WP_API void builtin_randn_uint32(uint32 state, float* ret) { *ret = randn(state); }
+WP_API void builtin_randn2_uint32(uint32 state, vec2f* ret) { *ret = randn2(state); }
+WP_API void builtin_philox_vec2ui_vec4ui(vec2ui key, vec4ui counter, vec4ui* ret) { *ret = philox(key, counter); }
+WP_API void builtin_philox_int32_int32_int32(int32 seed, int32 index, int32 offset, vec4ui* ret) { *ret = philox(seed, index, offset); }
+WP_API void builtin_philox_randf4_int32_int32_int32(int32 seed, int32 index, int32 offset, vec4f* ret) { *ret = philox_randf4(seed, index, offset); }
+WP_API void builtin_philox_randn4_int32_int32_int32(int32 seed, int32 index, int32 offset, vec4f* ret) { *ret = philox_randn4(seed, index, offset); }
 WP_API void builtin_sample_triangle_uint32(uint32 state, vec2f* ret) { *ret = sample_triangle(state); }
 WP_API void builtin_sample_unit_ring_uint32(uint32 state, vec2f* ret) { *ret = sample_unit_ring(state); }
 WP_API void builtin_sample_unit_disk_uint32(uint32 state, vec2f* ret) { *ret = sample_unit_disk(state); }
@@ -642,6 +649,10 @@ WP_API void builtin_pnoise_uint32_float32_int32(uint32 state, float32 x, int32 p
 WP_API void builtin_pnoise_uint32_vec2f_int32_int32(uint32 state, vec2f xy, int32 px, int32 py, float* ret) { *ret = pnoise(state, xy, px, py); }
 WP_API void builtin_pnoise_uint32_vec3f_int32_int32_int32(uint32 state, vec3f xyz, int32 px, int32 py, int32 pz, float* ret) { *ret = pnoise(state, xyz, px, py, pz); }
 WP_API void builtin_pnoise_uint32_vec4f_int32_int32_int32_int32(uint32 state, vec4f xyzt, int32 px, int32 py, int32 pz, int32 pt, float* ret) { *ret = pnoise(state, xyzt, px, py, pz, pt); }
+WP_API void builtin_tnoise_uint32_vec2f(uint32 state, vec2f xy, float* ret) { *ret = tnoise(state, xy); }
+WP_API void builtin_tnoise_uint32_vec3f(uint32 state, vec3f xyz, float* ret) { *ret = tnoise(state, xyz); }
+WP_API void builtin_fbm_uint32_vec2f_int32_float32_float32(uint32 state, vec2f xy, int32 octaves, float32 lacunarity, float32 gain, float* ret) { *ret = fbm(state, xy, octaves, lacunarity, gain); }
+WP_API void builtin_fbm_uint32_vec3f_int32_float32_float32(uint32 state, vec3f xyz, int32 octaves, float32 lacunarity, float32 gain, float* ret) { *ret = fbm(state, xyz, octaves, lacunarity, gain); }
 WP_API void builtin_curlnoise_uint32_vec2f(uint32 state, vec2f xy, vec2f* ret) { *ret = curlnoise(state, xy); }
 WP_API void builtin_curlnoise_uint32_vec3f(uint32 state, vec3f xyz, vec3f* ret) { *ret = curlnoise(state, xyz); }
 WP_API void builtin_curlnoise_uint32_vec4f(uint32 state, vec4f xyzt, vec3f* ret) { *ret = curlnoise(state, xyzt); }
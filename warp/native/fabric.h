@@ -26,6 +26,12 @@ struct fabricarray_t
 
     size_t nbuckets;
     size_t size;
+
+    // optional lookup table on the same device as the buckets, the elements are split into pages of
+    // 2^table_shift consecutive indices and bucket_table[p] is the first bucket overlapping page p,
+    // so the bucket of an element is searched only among the few buckets overlapping its page
+    uint32_t* bucket_table;
+    size_t table_shift;
 };
 
 
@@ -50,26 +56,36 @@ struct indexedfabricarray_t
 #define FABRICARRAY_USE_BINARY_SEARCH 1
 #endif
 
-template <typename T>
-CUDA_CALLABLE inline const fabricbucket_t* fabricarray_find_bucket(const fabricarray_t<T>& fa, size_t i)
+// binary search for the bucket containing element i among the buckets [lo, hi)
+CUDA_CALLABLE inline const fabricbucket_t* fabricarray_search_buckets(const fabricbucket_t* buckets, size_t lo, size_t hi, size_t i)
 {
-#if FABRICARRAY_USE_BINARY_SEARCH
-    // use binary search to find the right bucket
-    const fabricbucket_t* bucket = nullptr;
-    size_t lo = 0;
-    size_t hi = fa.nbuckets - 1;
-    while (hi >= lo)
+    while (lo < hi)
     {
         size_t mid = (lo + hi) >> 1;
-        bucket = fa.buckets + mid;
+        const fabricbucket_t* bucket = buckets + mid;
         if (i >= bucket->index_end)
             lo = mid + 1;
         else if (i < bucket->index_start)
-            hi = mid - 1;
+            hi = mid;
         else
             return bucket;
     }
     return nullptr;
+}
+
+template <typename T>
+CUDA_CALLABLE inline const fabricbucket_t* fabricarray_find_bucket(const fabricarray_t<T>& fa, size_t i)
+{
+    if (fa.bucket_table && i < fa.size)
+    {
+        // the buckets overlapping a page are the range from its first bucket up to the first bucket of the next page
+        const size_t page = i >> fa.table_shift;
+        return fabricarray_search_buckets(fa.buckets, fa.bucket_table[page], size_t(fa.bucket_table[page + 1]) + 1, i);
+    }
+
+#if FABRICARRAY_USE_BINARY_SEARCH
+    // use binary search to find the right bucket
+    return fabricarray_search_buckets(fa.buckets, 0, fa.nbuckets, i);
 #else
     // use linear search to find the right bucket
     const fabricbucket_t* bucket = fa.buckets;
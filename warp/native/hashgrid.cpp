@@ -14,7 +14,10 @@
 
 using namespace wp;
 
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <vector>
 
 namespace 
 {
@@ -48,23 +51,80 @@ void hash_grid_rem_descriptor(uint64_t id)
 
 }
 
+// smallest power of two table that keeps the sparse cell table at most half full
+int hash_grid_table_size(int max_points)
+{
+    int table_size = 1;
+    while (table_size < 2*max_points)
+        table_size *= 2;
+    return table_size;
+}
+
+// Morton ordered grids round the dimensions up to a cube with power of two edges so that cell indices are dense
+static void hash_grid_set_dims(HashGrid& grid, int dim_x, int dim_y, int dim_z, int morton)
+{
+    if (morton)
+    {
+        int dim = 1;
+        while (dim < max(dim_x, max(dim_y, dim_z)) && dim < 1024)
+            dim *= 2;
+
+        dim_x = dim_y = dim_z = dim;
+    }
+
+    grid.dim_x = dim_x;
+    grid.dim_y = dim_y;
+    grid.dim_z = dim_z;
+    grid.morton = morton;
+}
+
+// host updates process the points and cells in blocks on the thread pool of CPU launches
+static const int kHashGridHostBlockSize = 4096;
+
+static int hash_grid_host_num_blocks(int n)
+{
+    return (n + kHashGridHostBlockSize - 1)/kHashGridHostBlockSize;
+}
+
+// invokes f(block, begin, end) for the blocks of [0, n)
+template <typename Func>
+static void hash_grid_for_each_block_host(int n, Func f)
+{
+    auto block = [&](size_t b)
+    {
+        const int begin = int(b)*kHashGridHostBlockSize;
+        f(int(b), begin, std::min(begin + kHashGridHostBlockSize, n));
+    };
+
+    _wp_parallel_for_each(hash_grid_host_num_blocks(n), block);
+}
+
+template <typename T>
+static void hash_grid_fill_host(T* dst, int value, int n)
+{
+    hash_grid_for_each_block_host(n, [&](int, int begin, int end)
+    {
+        memset(dst + begin, value, sizeof(T)*(end - begin));
+    });
+}
+
 // implemented in hashgrid.cu
-void hash_grid_rebuild_device(const HashGrid& grid, const wp::vec3* points, int num_points);
+void hash_grid_rebuild_device(const HashGrid& grid, const wp::vec3* points, const float* radii, int num_points);
+void hash_grid_gather_device(const HashGrid& grid, void* dst, const void* src, int element_size);
+void hash_grid_reset_point_ids_device(const HashGrid& grid);
 
 } // namespace wp
 
 
 // host methods
-uint64_t hash_grid_create_host(int dim_x, int dim_y, int dim_z)
+uint64_t hash_grid_create_host(int dim_x, int dim_y, int dim_z, int morton)
 {
     HashGrid* grid = new HashGrid();
     memset(grid, 0, sizeof(HashGrid));
     
-    grid->dim_x = dim_x;
-    grid->dim_y = dim_y;
-    grid->dim_z = dim_z;
+    hash_grid_set_dims(*grid, dim_x, dim_y, dim_z, morton);
 
-    const int num_cells = dim_x*dim_y*dim_z;   
+    const int num_cells = grid->dim_x*grid->dim_y*grid->dim_z;
     grid->cell_starts = (int*)alloc_host(num_cells*sizeof(int));
     grid->cell_ends = (int*)alloc_host(num_cells*sizeof(int));
 
@@ -77,12 +137,36 @@ void hash_grid_destroy_host(uint64_t id)
 
     free_host(grid->point_ids);
     free_host(grid->point_cells);
+    free_host(grid->point_keys);
+    free_host(grid->cell_keys);
     free_host(grid->cell_starts);
     free_host(grid->cell_ends);
+    free_host(grid->level_mask);
 
     delete grid;
 }
 
+uint64_t hash_grid_create_sparse_host()
+{
+    HashGrid* grid = new HashGrid();
+
+    grid->sparse = 1;
+
+    return (uint64_t)(grid);
+}
+
+uint64_t hash_grid_create_levels_host(float base_radius, int num_levels)
+{
+    HashGrid* grid = (HashGrid*)(hash_grid_create_sparse_host());
+
+    grid->num_levels = max(1, min(num_levels, WP_HASH_GRID_MAX_LEVELS));
+    grid->level_radius = base_radius;
+    grid->level_mask = (int*)alloc_host(sizeof(int));
+    *grid->level_mask = 0;
+
+    return (uint64_t)(grid);
+}
+
 void hash_grid_reserve_host(uint64_t id, int num_points)
 {
     HashGrid* grid = (HashGrid*)(id);
@@ -92,16 +176,108 @@ void hash_grid_reserve_host(uint64_t id, int num_points)
         free_host(grid->point_cells);
         free_host(grid->point_ids);
         
-        const int num_to_alloc = num_points*3/2;
-        grid->point_cells = (int*)alloc_host(2*num_to_alloc*sizeof(int));  // *2 for auxilliary radix buffers
+        // grow geometrically so that steadily emitting systems reallocate rarely
+        const int num_to_alloc = max(num_points, 2*grid->max_points);
         grid->point_ids = (int*)alloc_host(2*num_to_alloc*sizeof(int));    // *2 for auxilliary radix buffers
 
+        if (grid->sparse)
+        {
+            free_host(grid->point_keys);
+            free_host(grid->cell_keys);
+            free_host(grid->cell_starts);
+            free_host(grid->cell_ends);
+
+            // the table holds at most one cell per point
+            grid->table_size = hash_grid_table_size(num_to_alloc);
+            grid->point_keys = (uint64_t*)alloc_host(2*num_to_alloc*sizeof(uint64_t));  // *2 for auxilliary radix buffers
+            grid->cell_keys = (uint64_t*)alloc_host(grid->table_size*sizeof(uint64_t));
+            grid->cell_starts = (int*)alloc_host(grid->table_size*sizeof(int));
+            grid->cell_ends = (int*)alloc_host(grid->table_size*sizeof(int));
+        }
+        else
+        {
+            grid->point_cells = (int*)alloc_host(2*num_to_alloc*sizeof(int));  // *2 for auxilliary radix buffers
+        }
+
         grid->max_points = num_to_alloc;
     }
 
     grid->num_points = num_points;
 }
 
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "cell keys are updated in place as atomics");
+
+// inserts a cell key in the sparse cell table and returns its slot, the key may already be present, the points
+// starting and ending the runs of different cells insert them concurrently like insert_cell() in hashgrid.cu
+static int hash_grid_insert_cell_host(HashGrid* grid, uint64_t key)
+{
+    std::atomic<uint64_t>* cell_keys = reinterpret_cast<std::atomic<uint64_t>*>(grid->cell_keys);
+
+    int slot = hash_grid_table_slot(key, grid->table_size);
+
+    for (;;)
+    {
+        uint64_t prev = WP_HASH_GRID_EMPTY_KEY;
+        if (cell_keys[slot].compare_exchange_strong(prev, key, std::memory_order_relaxed) || prev == key)
+            return slot;
+
+        slot = (slot + 1) & (grid->table_size-1);
+    }
+}
+
+// points of single level grids are binned at level 0, multi-level grids bin each point at the level of its radius
+static void hash_grid_update_sparse_host(HashGrid* grid, const wp::vec3* points, const float* radii, int num_points)
+{
+    std::vector<int> level_masks(hash_grid_host_num_blocks(num_points), 0);
+
+    hash_grid_for_each_block_host(num_points, [&](int block, int begin, int end)
+    {
+        int level_mask = 0;
+
+        for (int i=begin; i < end; ++i)
+        {
+            const int level = radii ? hash_grid_point_level(*grid, radii[i]) : 0;
+
+            grid->point_keys[i] = hash_grid_cell_key(*grid, points[i], level);
+            grid->point_ids[i] = i;
+
+            level_mask |= 1<<level;
+        }
+
+        level_masks[block] = level_mask;
+    });
+
+    if (grid->level_mask)
+    {
+        int level_mask = 0;
+        for (int mask : level_masks)
+            level_mask |= mask;
+
+        *grid->level_mask = level_mask;
+    }
+
+    // sort points by cell, each run of equal keys is one occupied cell, the level is stored above the 60 bits
+    // of the cell coordinates
+    const int end_bit = grid->num_levels > 1 ? 60 + radix_sort_bits(grid->num_levels) : 60;
+    radix_sort_pairs_host(grid->point_keys, grid->point_ids, num_points, 0, end_bit);
+
+    hash_grid_fill_host(grid->cell_keys, 0xff, grid->table_size);
+
+    hash_grid_for_each_block_host(num_points, [&](int, int begin, int end)
+    {
+        for (int i=begin; i < end; ++i)
+        {
+            const uint64_t key = grid->point_keys[i];
+
+            if (i == 0 || key != grid->point_keys[i-1])
+                grid->cell_starts[hash_grid_insert_cell_host(grid, key)] = i;
+
+            if (i == num_points - 1 || key != grid->point_keys[i+1])
+                grid->cell_ends[hash_grid_insert_cell_host(grid, key)] = i + 1;
+        }
+    });
+}
+
 void hash_grid_update_host(uint64_t id, float cell_width, const wp::vec3* points, int num_points)
 {
     HashGrid* grid = (HashGrid*)(id);
@@ -111,48 +287,90 @@ void hash_grid_update_host(uint64_t id, float cell_width, const wp::vec3* points
     grid->cell_width = cell_width;
     grid->cell_width_inv = 1.0f / cell_width;
 
-    // calculate cell for each position
-    for (int i=0; i < num_points; ++i)
+    if (grid->sparse)
     {
-        grid->point_cells[i] = hash_grid_index(*grid, points[i]);
-        grid->point_ids[i] = i;
+        hash_grid_update_sparse_host(grid, points, NULL, num_points);
+        return;
     }
-    
-    // sort indices
-    radix_sort_pairs_host(grid->point_cells, grid->point_ids, num_points);
 
+    // calculate cell for each position
+    hash_grid_for_each_block_host(num_points, [&](int, int begin, int end)
+    {
+        for (int i=begin; i < end; ++i)
+        {
+            grid->point_cells[i] = hash_grid_index(*grid, points[i]);
+            grid->point_ids[i] = i;
+        }
+    });
+
+    // sort indices, the cells are in [0, num_cells) so only their low bits are sorted
     const int num_cells = grid->dim_x * grid->dim_y * grid->dim_z;
-    memset(grid->cell_starts, 0, sizeof(int) * num_cells);
-    memset(grid->cell_ends, 0, sizeof(int) * num_cells);
+    radix_sort_pairs_host(grid->point_cells, grid->point_ids, num_points, 0, radix_sort_bits(num_cells));
+
+    hash_grid_fill_host(grid->cell_starts, 0, num_cells);
+    hash_grid_fill_host(grid->cell_ends, 0, num_cells);
 
-    // compute cell start / end
-    for (int i=0; i < num_points; ++i)
+    // compute cell start / end, each boundary of the sorted cells is written by one point
+    hash_grid_for_each_block_host(num_points, [&](int, int begin, int end)
     {
-		// scan the particle-cell array to find the start and end
-		const int c = grid->point_cells[i];
-		
-		if (i == 0)
-			grid->cell_starts[c] = 0;
-		else
-		{
-			const int p = grid->point_cells[i-1];
-
-			if (c != p)
-			{
-				grid->cell_starts[c] = i;
-                grid->cell_ends[p] = i;
-			}
-		}
-
-        if (i == num_points - 1)
+        for (int i=begin; i < end; ++i)
         {
-            grid->cell_ends[c] = i + 1;
+            const int c = grid->point_cells[i];
+
+            if (i == 0 || c != grid->point_cells[i-1])
+                grid->cell_starts[c] = i;
+
+            if (i == num_points - 1 || c != grid->point_cells[i+1])
+                grid->cell_ends[c] = i + 1;
         }
-	}
+    });
+}
+
+void hash_grid_update_levels_host(uint64_t id, const wp::vec3* points, const float* radii, int num_points)
+{
+    HashGrid* grid = (HashGrid*)(id);
+
+    hash_grid_reserve_host(id, num_points);
+
+    // the cells of level 0 are as wide as the diameter of its largest points
+    grid->cell_width = 2.0f*grid->level_radius;
+    grid->cell_width_inv = 1.0f / grid->cell_width;
+
+    hash_grid_update_sparse_host(grid, points, radii, num_points);
+}
+
+uint64_t hash_grid_get_point_ids_host(uint64_t id)
+{
+    HashGrid* grid = (HashGrid*)(id);
+
+    return (uint64_t)(grid->point_ids);
+}
+
+void hash_grid_permute_host(uint64_t id, void* dst, const void* src, int element_size)
+{
+    const HashGrid* grid = (const HashGrid*)(id);
+
+    // gather elements into the cell order of the last update
+    hash_grid_for_each_block_host(grid->num_points, [&](int, int begin, int end)
+    {
+        for (int i=begin; i < end; ++i)
+            memcpy((char*)dst + size_t(i)*element_size, (const char*)src + size_t(grid->point_ids[i])*element_size, element_size);
+    });
+}
+
+void hash_grid_reset_order_host(uint64_t id)
+{
+    HashGrid* grid = (HashGrid*)(id);
+
+    hash_grid_for_each_block_host(grid->num_points, [&](int, int begin, int end)
+    {
+        for (int i=begin; i < end; ++i)
+            grid->point_ids[i] = i;
+    });
 }
 
 // device methods
-uint64_t hash_grid_create_device(void* context, int dim_x, int dim_y, int dim_z)
+uint64_t hash_grid_create_device(void* context, int dim_x, int dim_y, int dim_z, int morton)
 {
     ContextGuard guard(context);
 
@@ -161,11 +379,9 @@ uint64_t hash_grid_create_device(void* context, int dim_x, int dim_y, int dim_z)
 
     grid.context = context ? context : cuda_context_get_current();
 
-    grid.dim_x = dim_x;
-    grid.dim_y = dim_y;
-    grid.dim_z = dim_z;
+    hash_grid_set_dims(grid, dim_x, dim_y, dim_z, morton);
 
-    const int num_cells = dim_x*dim_y*dim_z;   
+    const int num_cells = grid.dim_x*grid.dim_y*grid.dim_z;
     grid.cell_starts = (int*)alloc_device(WP_CURRENT_CONTEXT, num_cells*sizeof(int));
     grid.cell_ends = (int*)alloc_device(WP_CURRENT_CONTEXT, num_cells*sizeof(int));
 
@@ -179,6 +395,49 @@ uint64_t hash_grid_create_device(void* context, int dim_x, int dim_y, int dim_z)
     return grid_id;
 }
 
+uint64_t hash_grid_create_sparse_device(void* context)
+{
+    ContextGuard guard(context);
+
+    HashGrid grid{};
+
+    grid.context = context ? context : cuda_context_get_current();
+    grid.sparse = 1;
+
+    // the cell table is allocated with the point buffers on the first reservation
+    HashGrid* grid_device = (HashGrid*)(alloc_device(WP_CURRENT_CONTEXT, sizeof(HashGrid)));
+    memcpy_h2d(WP_CURRENT_CONTEXT, grid_device, &grid, sizeof(HashGrid));
+
+    uint64_t grid_id = (uint64_t)(grid_device);
+    hash_grid_add_descriptor(grid_id, grid);
+
+    return grid_id;
+}
+
+uint64_t hash_grid_create_levels_device(void* context, float base_radius, int num_levels)
+{
+    ContextGuard guard(context);
+
+    HashGrid grid{};
+
+    grid.context = context ? context : cuda_context_get_current();
+    grid.sparse = 1;
+    grid.num_levels = max(1, min(num_levels, WP_HASH_GRID_MAX_LEVELS));
+    grid.level_radius = base_radius;
+
+    // the occupied levels are written on the device by the builds
+    grid.level_mask = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int));
+    memset_device(WP_CURRENT_CONTEXT, grid.level_mask, 0, sizeof(int));
+
+    HashGrid* grid_device = (HashGrid*)(alloc_device(WP_CURRENT_CONTEXT, sizeof(HashGrid)));
+    memcpy_h2d(WP_CURRENT_CONTEXT, grid_device, &grid, sizeof(HashGrid));
+
+    uint64_t grid_id = (uint64_t)(grid_device);
+    hash_grid_add_descriptor(grid_id, grid);
+
+    return grid_id;
+}
+
 void hash_grid_destroy_device(uint64_t id)
 {
     HashGrid grid;
@@ -188,8 +447,11 @@ void hash_grid_destroy_device(uint64_t id)
 
         free_device(WP_CURRENT_CONTEXT, grid.point_ids);
         free_device(WP_CURRENT_CONTEXT, grid.point_cells);
+        free_device(WP_CURRENT_CONTEXT, grid.point_keys);
+        free_device(WP_CURRENT_CONTEXT, grid.cell_keys);
         free_device(WP_CURRENT_CONTEXT, grid.cell_starts);
         free_device(WP_CURRENT_CONTEXT, grid.cell_ends);
+        free_device(WP_CURRENT_CONTEXT, grid.level_mask);
 
         free_device(WP_CURRENT_CONTEXT, (HashGrid*)id);
         
@@ -208,17 +470,48 @@ void hash_grid_reserve_device(uint64_t id, int num_points)
         {
             ContextGuard guard(grid.context);
 
-            free_device(WP_CURRENT_CONTEXT, grid.point_cells);
-            free_device(WP_CURRENT_CONTEXT, grid.point_ids);
+            // allocations made during capture would be owned by the graph and the descriptor
+            // upload below would be recorded from stack memory, so capacity must be reserved up front
+            if (cuda_stream_is_capturing(cuda_stream_get_current()))
+            {
+                fprintf(stderr, "Warp error: Hash grid capacity of %d points exceeded during graph capture (%d points), "
+                                "reserve capacity with HashGrid.reserve() or the max_points argument before capturing\n", grid.max_points, num_points);
+                return;
+            }
+
+            // stream-ordered frees and allocations avoid synchronizing the device when memory pools are supported
+            free_temp_device(WP_CURRENT_CONTEXT, grid.point_cells);
+            free_temp_device(WP_CURRENT_CONTEXT, grid.point_ids);
             
-            const int num_to_alloc = num_points*3/2;
-            grid.point_cells = (int*)alloc_device(WP_CURRENT_CONTEXT, 2*num_to_alloc*sizeof(int));  // *2 for auxilliary radix buffers
-            grid.point_ids = (int*)alloc_device(WP_CURRENT_CONTEXT, 2*num_to_alloc*sizeof(int));    // *2 for auxilliary radix buffers
+            // grow geometrically so that steadily emitting systems reallocate rarely
+            const int num_to_alloc = max(num_points, 2*grid.max_points);
+            grid.point_ids = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, 2*num_to_alloc*sizeof(int));    // *2 for auxilliary radix buffers
             grid.max_points = num_to_alloc;
 
-            // ensure we pre-size our sort routine to avoid
-            // allocations during graph capture
-            radix_sort_reserve(WP_CURRENT_CONTEXT, num_to_alloc);
+            if (grid.sparse)
+            {
+                free_temp_device(WP_CURRENT_CONTEXT, grid.point_keys);
+                free_temp_device(WP_CURRENT_CONTEXT, grid.cell_keys);
+                free_temp_device(WP_CURRENT_CONTEXT, grid.cell_starts);
+                free_temp_device(WP_CURRENT_CONTEXT, grid.cell_ends);
+
+                // the table holds at most one cell per point
+                grid.table_size = hash_grid_table_size(num_to_alloc);
+                grid.point_keys = (uint64_t*)alloc_temp_device(WP_CURRENT_CONTEXT, 2*num_to_alloc*sizeof(uint64_t));  // *2 for auxilliary radix buffers
+                grid.cell_keys = (uint64_t*)alloc_temp_device(WP_CURRENT_CONTEXT, grid.table_size*sizeof(uint64_t));
+                grid.cell_starts = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, grid.table_size*sizeof(int));
+                grid.cell_ends = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, grid.table_size*sizeof(int));
+
+                radix_sort_reserve_uint64(WP_CURRENT_CONTEXT, num_to_alloc);
+            }
+            else
+            {
+                grid.point_cells = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, 2*num_to_alloc*sizeof(int));  // *2 for auxilliary radix buffers
+
+                // ensure we pre-size our sort routine to avoid
+                // allocations during graph capture
+                radix_sort_reserve(WP_CURRENT_CONTEXT, num_to_alloc);
+            }
 
             // update device side grid descriptor, todo: this is
             // slightly redundant since it is performed again
@@ -233,9 +526,8 @@ void hash_grid_reserve_device(uint64_t id, int num_points)
     }
 }
 
-void hash_grid_update_device(uint64_t id, float cell_width, const wp::vec3* points, int num_points)
+static void hash_grid_update_device_impl(uint64_t id, float cell_width, const wp::vec3* points, const float* radii, int num_points)
 {
-    
     // ensure we have enough memory reserved for update
     // this must be done before retrieving the descriptor
     // below since it may update it
@@ -248,13 +540,17 @@ void hash_grid_update_device(uint64_t id, float cell_width, const wp::vec3* poin
 
     if (hash_grid_get_descriptor(id, grid))
     {
+        // reservation failed, e.g.: growth was requested during graph capture
+        if (num_points > grid.max_points)
+            return;
+
         ContextGuard guard(grid.context);
 
         grid.num_points = num_points;
         grid.cell_width = cell_width;
         grid.cell_width_inv = 1.0f / cell_width;
 
-        hash_grid_rebuild_device(grid, points, num_points);
+        hash_grid_rebuild_device(grid, points, radii, num_points);
 
         // update device side grid descriptor
         memcpy_h2d(WP_CURRENT_CONTEXT, (HashGrid*)id, &grid, sizeof(HashGrid));
@@ -264,12 +560,60 @@ void hash_grid_update_device(uint64_t id, float cell_width, const wp::vec3* poin
     }
 }
 
+void hash_grid_update_device(uint64_t id, float cell_width, const wp::vec3* points, int num_points)
+{
+    hash_grid_update_device_impl(id, cell_width, points, NULL, num_points);
+}
+
+void hash_grid_update_levels_device(uint64_t id, const wp::vec3* points, const float* radii, int num_points)
+{
+    HashGrid grid;
+    if (hash_grid_get_descriptor(id, grid))
+    {
+        // the cells of level 0 are as wide as the diameter of its largest points
+        hash_grid_update_device_impl(id, 2.0f*grid.level_radius, points, radii, num_points);
+    }
+}
+
+uint64_t hash_grid_get_point_ids_device(uint64_t id)
+{
+    HashGrid grid;
+    if (hash_grid_get_descriptor(id, grid))
+        return (uint64_t)(grid.point_ids);
+    else
+        return 0;
+}
+
+void hash_grid_permute_device(uint64_t id, void* dst, const void* src, int element_size)
+{
+    HashGrid grid;
+    if (hash_grid_get_descriptor(id, grid))
+        hash_grid_gather_device(grid, dst, src, element_size);
+}
+
+void hash_grid_reset_order_device(uint64_t id)
+{
+    HashGrid grid;
+    if (hash_grid_get_descriptor(id, grid))
+        hash_grid_reset_point_ids_device(grid);
+}
+
 #if !WP_ENABLE_CUDA
 
 namespace wp
 {
 
-void hash_grid_rebuild_device(const HashGrid& grid, const wp::vec3* points, int num_points)
+void hash_grid_rebuild_device(const HashGrid& grid, const wp::vec3* points, const float* radii, int num_points)
+{
+
+}
+
+void hash_grid_gather_device(const HashGrid& grid, void* dst, const void* src, int element_size)
+{
+
+}
+
+void hash_grid_reset_point_ids_device(const HashGrid& grid)
 {
 
 }
@@ -55,15 +55,88 @@ __global__ void compute_cell_offsets(int* cell_starts, int* cell_ends, const int
 	}    
 }
 
-void hash_grid_rebuild_device(const wp::HashGrid& grid, const wp::vec3* points, int num_points)
+// points of single level grids are binned at level 0, multi-level grids bin each point at the level of its radius
+__global__ void compute_cell_keys(HashGrid grid, const wp::vec3* points, const float* radii, int num_points)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < num_points)
+    {
+        const int level = radii ? hash_grid_point_level(grid, radii[tid]) : 0;
+
+        grid.point_keys[tid] = hash_grid_cell_key(grid, points[tid], level);
+        grid.point_ids[tid] = tid;
+
+        // only the first points of a level contend for the mask
+        if (grid.level_mask && (*(volatile int*)grid.level_mask & (1<<level)) == 0)
+            atomicOr(grid.level_mask, 1<<level);
+    }
+}
+
+// inserts a cell key in the sparse cell table and returns its slot, the key may already be present
+__device__ int insert_cell(const HashGrid& grid, uint64_t key)
+{
+    int slot = hash_grid_table_slot(key, grid.table_size);
+
+    while (1)
+    {
+        const uint64_t prev = atomicCAS((unsigned long long*)&grid.cell_keys[slot], (unsigned long long)WP_HASH_GRID_EMPTY_KEY, (unsigned long long)key);
+        if (prev == WP_HASH_GRID_EMPTY_KEY || prev == key)
+            return slot;
+
+        slot = (slot + 1) & (grid.table_size-1);
+    }
+}
+
+// run-length encodes the sorted point keys, the first and last point of each run insert the cell
+__global__ void compute_sparse_cell_offsets(HashGrid grid, int num_points)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < num_points)
+    {
+        const uint64_t key = grid.point_keys[tid];
+
+        if (tid == 0 || key != grid.point_keys[tid-1])
+            grid.cell_starts[insert_cell(grid, key)] = tid;
+
+        if (tid == num_points - 1 || key != grid.point_keys[tid+1])
+            grid.cell_ends[insert_cell(grid, key)] = tid + 1;
+    }
+}
+
+static void hash_grid_rebuild_sparse_device(const wp::HashGrid& grid, const wp::vec3* points, const float* radii, int num_points)
+{
+    if (grid.level_mask)
+        memset_device(WP_CURRENT_CONTEXT, grid.level_mask, 0, sizeof(int));
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_cell_keys, num_points, (grid, points, radii, num_points));
+
+    // the level is stored above the 60 bits of the cell coordinates
+    const int end_bit = grid.num_levels > 1 ? 60 + radix_sort_bits(grid.num_levels) : 60;
+    radix_sort_pairs_device(WP_CURRENT_CONTEXT, grid.point_keys, grid.point_ids, num_points, 0, end_bit);
+
+    memset_device(WP_CURRENT_CONTEXT, grid.cell_keys, -1, sizeof(uint64_t) * grid.table_size);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_sparse_cell_offsets, num_points, (grid, num_points));
+}
+
+void hash_grid_rebuild_device(const wp::HashGrid& grid, const wp::vec3* points, const float* radii, int num_points)
 {
     ContextGuard guard(grid.context);
 
+    if (grid.sparse)
+    {
+        hash_grid_rebuild_sparse_device(grid, points, radii, num_points);
+        return;
+    }
+
     wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_cell_indices, num_points, (grid, points, num_points));
-    
-    radix_sort_pairs_device(WP_CURRENT_CONTEXT, grid.point_cells, grid.point_ids, num_points);
 
     const int num_cells = grid.dim_x * grid.dim_y * grid.dim_z;
+
+    // only the bits of the cell indices need sorting, e.g.: 21 bits instead of 32 for 128^3 grids
+    radix_sort_pairs_device(WP_CURRENT_CONTEXT, grid.point_cells, grid.point_ids, num_points, 0, radix_sort_bits(num_cells));
     
     memset_device(WP_CURRENT_CONTEXT, grid.cell_starts, 0, sizeof(int) * num_cells);    
     memset_device(WP_CURRENT_CONTEXT, grid.cell_ends, 0, sizeof(int) * num_cells);
@@ -71,6 +144,52 @@ void hash_grid_rebuild_device(const wp::HashGrid& grid, const wp::vec3* points,
     wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_cell_offsets, num_points, (grid.cell_starts, grid.cell_ends, grid.point_cells, num_points));
 }
 
+// gathers elements of src into cell order, one thread per word so that both loads and stores coalesce
+template <typename Word>
+__global__ void permute_elements(Word* dst, const Word* src, const int* point_ids, int num_words, int words_per_element)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < num_words)
+    {
+        const int i = tid / words_per_element;
+        const int w = tid - i*words_per_element;
+
+        dst[tid] = src[size_t(point_ids[i])*words_per_element + w];
+    }
+}
+
+__global__ void reset_point_ids(int* point_ids, int num_points)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < num_points)
+        point_ids[tid] = tid;
+}
+
+void hash_grid_gather_device(const wp::HashGrid& grid, void* dst, const void* src, int element_size)
+{
+    ContextGuard guard(grid.context);
+
+    if (element_size % sizeof(int) == 0)
+    {
+        const int words_per_element = element_size / sizeof(int);
+        const int num_words = grid.num_points * words_per_element;
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::permute_elements<int>, num_words, ((int*)dst, (const int*)src, grid.point_ids, num_words, words_per_element));
+    }
+    else
+    {
+        const int num_bytes = grid.num_points * element_size;
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::permute_elements<uint8_t>, num_bytes, ((uint8_t*)dst, (const uint8_t*)src, grid.point_ids, num_bytes, element_size));
+    }
+}
+
+void hash_grid_reset_point_ids_device(const wp::HashGrid& grid)
+{
+    ContextGuard guard(grid.context);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::reset_point_ids, grid.num_points, (grid.point_ids, grid.num_points));
+}
 
 } // namespace wp
 
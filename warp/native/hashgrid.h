@@ -26,12 +26,113 @@ struct HashGrid
     int dim_y;
     int dim_z;
 
+    // cells are stored in Morton (Z-curve) order so that neighboring cells along all axes are close in memory,
+    // the dimensions of Morton ordered grids are a cube with power of two edges of at most 1024 cells
+    int morton;
+
     int num_points;
     int max_points;
 
+    // sparse grids store only the occupied cells in an open addressing table keyed by the 64-bit cell
+    // coordinates, so that far apart cells never alias, cell_starts and cell_ends are indexed by table slot
+    int sparse;
+    int table_size;                 // power of two, at least twice max_points so the table is at most half full
+    uint64_t* point_keys{nullptr};  // cell key of a point, 2*max_points in length for the radix sort
+    uint64_t* cell_keys{nullptr};   // cell key of each table slot, table_size in length
+
+    // multi-level grids are sparse grids that bin each point at the level matching its radius, the cells of level l
+    // are 2^l times wider than the cells of level 0 and hold the points with radius up to level_radius*2^l
+    int num_levels;                 // 0 for single level grids
+    float level_radius;             // radius bound of level 0, cell_width is twice this
+    int* level_mask{nullptr};       // bit l is set when level l holds points, written by the builds
+
     void* context;
 };
 
+// keys of the empty slots of the sparse cell table, cell keys only use the lower 63 bits
+#define WP_HASH_GRID_EMPTY_KEY 0xFFFFFFFFFFFFFFFFull
+
+// levels of multi-level grids, the level is stored in the upper bits of the cell keys
+#define WP_HASH_GRID_MAX_LEVELS 8
+
+// packs a virtual (world) cell coordinate and its level into a 64-bit key, 20 bits per axis and 3 bits for the level
+CUDA_CALLABLE inline uint64_t hash_grid_cell_key(int level, int x, int y, int z)
+{
+    // offset to ensure positive coordinates, cells further than 2^19 from the origin are clamped
+    const int origin = 1<<19;
+    const int max_coord = (1<<20) - 1;
+
+    const uint64_t cx = uint64_t(min(max(x + origin, 0), max_coord));
+    const uint64_t cy = uint64_t(min(max(y + origin, 0), max_coord));
+    const uint64_t cz = uint64_t(min(max(z + origin, 0), max_coord));
+
+    return (uint64_t(level) << 60) | (cz << 40) | (cy << 20) | cx;
+}
+
+// inverse cell width of a level, single level grids only have level 0
+CUDA_CALLABLE inline float hash_grid_level_width_inv(const HashGrid& grid, int level)
+{
+    return grid.cell_width_inv/float(1<<level);
+}
+
+// lowest level whose radius bound covers the radius, larger radii are binned at the top level
+CUDA_CALLABLE inline int hash_grid_point_level(const HashGrid& grid, float radius)
+{
+    int level = 0;
+    float level_radius = grid.level_radius;
+
+    while (level < grid.num_levels-1 && radius > level_radius)
+    {
+        level_radius *= 2.0f;
+        ++level;
+    }
+
+    return level;
+}
+
+CUDA_CALLABLE inline uint64_t hash_grid_cell_key(const HashGrid& grid, const vec3& p, int level)
+{
+    const float cell_width_inv = hash_grid_level_width_inv(grid, level);
+
+    return hash_grid_cell_key(level,
+                              int(p[0]*cell_width_inv),
+                              int(p[1]*cell_width_inv),
+                              int(p[2]*cell_width_inv));
+}
+
+// first slot probed for a cell key, the key bits are mixed so that neighboring cells spread over the table
+CUDA_CALLABLE inline int hash_grid_table_slot(uint64_t key, int table_size)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+
+    return int(key & uint64_t(table_size-1));
+}
+
+// returns the table slot of an occupied cell, or -1 if the cell is empty
+CUDA_CALLABLE inline int hash_grid_find_cell(const HashGrid& grid, uint64_t key)
+{
+    if (grid.table_size == 0)
+        return -1;
+
+    int slot = hash_grid_table_slot(key, grid.table_size);
+
+    // linear probing terminates since the table always has empty slots
+    while (1)
+    {
+        const uint64_t k = grid.cell_keys[slot];
+        if (k == key)
+            return slot;
+        if (k == WP_HASH_GRID_EMPTY_KEY)
+            return -1;
+
+        slot = (slot + 1) & (grid.table_size-1);
+    }
+}
+
 // convert a virtual (world) cell coordinate to a physical one
 CUDA_CALLABLE inline int hash_grid_index(const HashGrid& grid, int x, int y, int z)
 {
@@ -42,9 +143,19 @@ CUDA_CALLABLE inline int hash_grid_index(const HashGrid& grid, int x, int y, int
     y += origin;
     z += origin;
 
+#if WP_CHECKED
+    // checked builds record the cells past the guard region, reported with their virtual coordinate
+    if (x <= 0)
+        record_bounds_error(nullptr, 0, x - origin, origin);
+    if (y <= 0)
+        record_bounds_error(nullptr, 1, y - origin, origin);
+    if (z <= 0)
+        record_bounds_error(nullptr, 2, z - origin, origin);
+#else
     assert(0 < x);
     assert(0 < y);
     assert(0 < z);
+#endif
 
     // clamp in case any particles fall outside the guard region (-10^20 cell index)
     x = max(0, x);
@@ -61,6 +172,9 @@ CUDA_CALLABLE inline int hash_grid_index(const HashGrid& grid, int x, int y, int
     int cy = y%grid.dim_y;
     int cz = z%grid.dim_z;
 
+    if (grid.morton)
+        return int((part1by2(cz) << 2) | (part1by2(cy) << 1) | part1by2(cx));
+
     return cz*(grid.dim_x*grid.dim_y) + cy*grid.dim_x + cx;
 }
 
@@ -72,6 +186,31 @@ CUDA_CALLABLE inline int hash_grid_index(const HashGrid& grid, const vec3& p)
                            int(p[2]*grid.cell_width_inv));
 }
 
+// finds the range of point indices of a virtual cell, empty cells return an empty range
+CUDA_CALLABLE inline void hash_grid_cell_range(const HashGrid& grid, int level, int x, int y, int z, int& start, int& end)
+{
+    if (grid.sparse)
+    {
+        const int slot = hash_grid_find_cell(grid, hash_grid_cell_key(level, x, y, z));
+        if (slot < 0)
+        {
+            start = 0;
+            end = 0;
+        }
+        else
+        {
+            start = grid.cell_starts[slot];
+            end = grid.cell_ends[slot];
+        }
+    }
+    else
+    {
+        const int cell = hash_grid_index(grid, x, y, z);
+        start = grid.cell_starts[cell];
+        end = grid.cell_ends[cell];
+    }
+}
+
 // stores state required to traverse neighboring cells of a point
 struct hash_grid_query_t
 {
@@ -96,9 +235,49 @@ struct hash_grid_query_t
     
     int current;        // index of the current iterator value
 
+    // multi-level grids visit the cells of each occupied level in turn
+    int level;
+    vec3 pos;
+    float radius;
+
     HashGrid grid;
 };
 
+// moves a query to the cells of the next occupied level of a multi-level grid, returns false when no level is left
+CUDA_CALLABLE inline bool hash_grid_query_next_level(hash_grid_query_t& query)
+{
+    const HashGrid& grid = query.grid;
+    const int level_mask = grid.level_mask ? *grid.level_mask : 0;
+
+    while (++query.level < grid.num_levels)
+    {
+        if ((level_mask & (1<<query.level)) == 0)
+            continue;
+
+        // the points of a level may be up to its radius bound further away than the query radius
+        const float cell_width_inv = hash_grid_level_width_inv(grid, query.level);
+        const float radius = query.radius + grid.level_radius*float(1<<query.level);
+
+        query.x_start = int((query.pos[0]-radius)*cell_width_inv);
+        query.y_start = int((query.pos[1]-radius)*cell_width_inv);
+        query.z_start = int((query.pos[2]-radius)*cell_width_inv);
+
+        query.x_end = int((query.pos[0]+radius)*cell_width_inv);
+        query.y_end = int((query.pos[1]+radius)*cell_width_inv);
+        query.z_end = int((query.pos[2]+radius)*cell_width_inv);
+
+        query.x = query.x_start;
+        query.y = query.y_start;
+        query.z = query.z_start;
+
+        hash_grid_cell_range(grid, query.level, query.x, query.y, query.z, query.cell_index, query.cell_end);
+
+        return true;
+    }
+
+    return false;
+}
+
 
 CUDA_CALLABLE inline hash_grid_query_t hash_grid_query(uint64_t id, wp::vec3 pos, float radius)
 {
@@ -106,23 +285,46 @@ CUDA_CALLABLE inline hash_grid_query_t hash_grid_query(uint64_t id, wp::vec3 pos
 
     query.grid = *(const HashGrid*)(id);
 
+    query.level = 0;
+    query.pos = pos;
+    query.radius = radius;
+
+    if (query.grid.num_levels > 0)
+    {
+        // start from an exhausted range so that queries of empty grids finish on the first call to next
+        query.x_start = query.y_start = query.z_start = 0;
+        query.x_end = query.y_end = query.z_end = 0;
+        query.x = query.y = query.z = 0;
+        query.cell_index = query.cell_end = 0;
+        query.level = -1;
+
+        hash_grid_query_next_level(query);
+        return query;
+    }
+
     // convert coordinate to grid
     query.x_start = int((pos[0]-radius)*query.grid.cell_width_inv);
     query.y_start = int((pos[1]-radius)*query.grid.cell_width_inv);
     query.z_start = int((pos[2]-radius)*query.grid.cell_width_inv);
 
-    // do not want to visit any cells more than once, so limit large radius offset to one pass over each dimension
-    query.x_end = min(int((pos[0]+radius)*query.grid.cell_width_inv), query.x_start + query.grid.dim_x-1);
-    query.y_end = min(int((pos[1]+radius)*query.grid.cell_width_inv), query.y_start + query.grid.dim_y-1);
-    query.z_end = min(int((pos[2]+radius)*query.grid.cell_width_inv), query.z_start + query.grid.dim_z-1);
+    query.x_end = int((pos[0]+radius)*query.grid.cell_width_inv);
+    query.y_end = int((pos[1]+radius)*query.grid.cell_width_inv);
+    query.z_end = int((pos[2]+radius)*query.grid.cell_width_inv);
+
+    // do not want to visit any cells more than once, so limit large radius offset to one pass over each dimension,
+    // the cells of sparse grids do not alias
+    if (!query.grid.sparse)
+    {
+        query.x_end = min(query.x_end, query.x_start + query.grid.dim_x-1);
+        query.y_end = min(query.y_end, query.y_start + query.grid.dim_y-1);
+        query.z_end = min(query.z_end, query.z_start + query.grid.dim_z-1);
+    }
 
     query.x = query.x_start;
     query.y = query.y_start;
     query.z = query.z_start;
 
-    const int cell = hash_grid_index(query.grid, query.x, query.y, query.z);
-    query.cell_index = query.grid.cell_starts[cell];
-    query.cell_end = query.grid.cell_ends[cell];
+    hash_grid_cell_range(query.grid, 0, query.x, query.y, query.z, query.cell_index, query.cell_end);
 
     return query;
 }
@@ -131,7 +333,7 @@ CUDA_CALLABLE inline hash_grid_query_t hash_grid_query(uint64_t id, wp::vec3 pos
 CUDA_CALLABLE inline bool hash_grid_query_next(hash_grid_query_t& query, int& index)
 {
     const HashGrid& grid = query.grid;
-    if (!grid.point_cells)
+    if (!grid.point_ids)
         return false;
 
     while (1)
@@ -159,15 +361,15 @@ CUDA_CALLABLE inline bool hash_grid_query_next(hash_grid_query_t& query, int& in
 
             if (query.z > query.z_end)
             {
-                // finished lookup grid
-                return false;
+                // finished lookup grid, multi-level grids continue with the next occupied level
+                if (!hash_grid_query_next_level(query))
+                    return false;
+
+                continue;
             }
 
             // update cell pointers
-            const int cell = hash_grid_index(grid, query.x, query.y, query.z);
-
-            query.cell_index = grid.cell_starts[cell];
-            query.cell_end = grid.cell_ends[cell];        
+            hash_grid_cell_range(grid, query.level, query.x, query.y, query.z, query.cell_index, query.cell_end);
         }
     }
 }
@@ -199,9 +401,29 @@ CUDA_CALLABLE inline int hash_grid_point_id(uint64_t id, int& index)
     return grid->point_ids[index];
 }
 
+// pushes the points within max_dist of pos into the heap with their distance as key, returns the number of entries
+template<unsigned K>
+CUDA_CALLABLE inline int hash_grid_query_knn(uint64_t id, const array_t<vec3>& points, vec3 pos, float max_dist, topk_heap_t<K>& heap)
+{
+    hash_grid_query_t query = hash_grid_query(id, pos, max_dist);
+
+    int i;
+    while (hash_grid_query_next(query, i))
+    {
+        const float dist = length(index(points, i) - pos);
+        if (dist <= max_dist)
+            topk_push(heap, dist, i);
+    }
+
+    return heap.count;
+}
+
 CUDA_CALLABLE inline void adj_hash_grid_query(uint64_t id, wp::vec3 pos, float radius, uint64_t& adj_id, wp::vec3& adj_pos, float& adj_radius, hash_grid_query_t& adj_res) {}
 CUDA_CALLABLE inline void adj_hash_grid_query_next(hash_grid_query_t& query, int& index, hash_grid_query_t& adj_query, int& adj_index, bool& adj_res) {}
 CUDA_CALLABLE inline void adj_hash_grid_point_id(uint64_t id, int& index, uint64_t & adj_id, int& adj_index, int& adj_res) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_hash_grid_query_knn(uint64_t id, const array_t<vec3>& points, vec3 pos, float max_dist, topk_heap_t<K>& heap,
+                                                  uint64_t& adj_id, array_t<vec3>& adj_points, vec3& adj_pos, float& adj_max_dist, topk_heap_t<K>& adj_heap, int& adj_ret) {}
 
 
 } // namespace wp
@@ -1,3 +1,342 @@
+#include "warp.h"
+#include "marching.h"
+#include "scan.h"
 
+#include <vector>
 
-// not implemented yet
\ No newline at end of file
+namespace wp
+{
+
+    // ---------------------------------------------------------------------------------------
+    // Host version of the CUDA surfacer, the cells have the same layout and every pass
+    // processes one x-slice of ny*nz cells per task on the thread pool
+    struct MarchingCubesHost
+    {
+        int cell_index(int xi, int yi, int zi) const
+        {
+            return (xi * ny + yi) * nz + zi;
+        }
+
+        // grid, batches of fields are stacked along x
+        int nx;
+        int ny;
+        int nz;
+        int num_fields;
+
+        std::vector<int> first_cell_vert;
+        std::vector<int> first_cell_tri;
+        std::vector<int> cell_verts;
+
+        int num_cells;
+    };
+
+    namespace
+    {
+        inline bool edge_crossing(float d0, float d, float threshold)
+        {
+            return (d0 <= threshold && d >= threshold) || (d <= threshold && d0 >= threshold);
+        }
+
+        inline int corner_code(const MarchingCubesHost& mc, const float* density, int xi, int yi, int zi, float threshold)
+        {
+            int code = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                int cxi = xi + marchingCubeCorners[i][0];
+                int cyi = yi + marchingCubeCorners[i][1];
+                int czi = zi + marchingCubeCorners[i][2];
+
+                if (density[mc.cell_index(cxi, cyi, czi)] >= threshold)
+                    code |= (1 << i);
+            }
+            return code;
+        }
+
+        template <typename Func>
+        void for_each_slice(const MarchingCubesHost& mc, Func f)
+        {
+            auto slice = [&](size_t xi)
+            {
+                for (int yi = 0; yi < mc.ny; yi++)
+                    for (int zi = 0; zi < mc.nz; zi++)
+                        f(int(xi), yi, zi, mc.cell_index(int(xi), yi, zi));
+            };
+
+            _wp_parallel_for_each(size_t(mc.num_fields) * mc.nx, slice);
+        }
+
+        void count_cell_verts(MarchingCubesHost& mc, const float* density, float threshold)
+        {
+            for_each_slice(mc, [&](int xi, int yi, int zi, int cell)
+            {
+                int num = 0;
+                if (xi % mc.nx < mc.nx - 1 && yi < mc.ny - 1 && zi < mc.nz - 1)
+                {
+                    float d0 = density[cell];
+                    num += edge_crossing(d0, density[mc.cell_index(xi + 1, yi, zi)], threshold);
+                    num += edge_crossing(d0, density[mc.cell_index(xi, yi + 1, zi)], threshold);
+                    num += edge_crossing(d0, density[mc.cell_index(xi, yi, zi + 1)], threshold);
+                }
+                mc.first_cell_vert[cell] = num;
+            });
+        }
+
+        void create_cell_verts(MarchingCubesHost& mc, vec3* vertices, const float* density, float threshold, int max_verts)
+        {
+            for_each_slice(mc, [&](int xi, int yi, int zi, int cell)
+            {
+                if (xi % mc.nx >= mc.nx - 1 || yi >= mc.ny - 1 || zi >= mc.nz - 1)
+                    return;
+
+                vec3 p = vec3(xi % mc.nx + 0.5f, yi + 0.5f, zi + 0.5f);
+
+                float d0 = density[cell];
+                float ds[3];
+                ds[0] = density[mc.cell_index(xi + 1, yi, zi)];
+                ds[1] = density[mc.cell_index(xi, yi + 1, zi)];
+                ds[2] = density[mc.cell_index(xi, yi, zi + 1)];
+
+                int first = mc.first_cell_vert[cell];
+
+                for (int dim = 0; dim < 3; dim++)
+                {
+                    float d = ds[dim];
+                    mc.cell_verts[3 * cell + dim] = 0;
+
+                    if (edge_crossing(d0, d, threshold))
+                    {
+                        float t = (d != d0) ? clamp((threshold - d0) / (d - d0), 0.0f, 1.0f) : 0.5f;
+                        int id = first++;
+
+                        if (id < max_verts)
+                        {
+                            vec3 off;
+                            off[dim] = t;
+                            vertices[id] = p + off;
+                        }
+
+                        mc.cell_verts[3 * cell + dim] = id;
+                    }
+                }
+            });
+        }
+
+        void count_cell_tris(MarchingCubesHost& mc, const float* density, float threshold)
+        {
+            for_each_slice(mc, [&](int xi, int yi, int zi, int cell)
+            {
+                int num = 0;
+                if (xi % mc.nx < mc.nx - 2 && yi < mc.ny - 2 && zi < mc.nz - 2)
+                {
+                    int code = corner_code(mc, density, xi, yi, zi, threshold);
+                    num = firstMarchingCubesId[code + 1] - firstMarchingCubesId[code];
+                }
+                mc.first_cell_tri[cell] = num;
+            });
+        }
+
+        void create_cell_tris(MarchingCubesHost& mc, const float* density, int* triangles, float threshold, int max_indices)
+        {
+            for_each_slice(mc, [&](int xi, int yi, int zi, int cell)
+            {
+                if (xi % mc.nx >= mc.nx - 2 || yi >= mc.ny - 2 || zi >= mc.nz - 2)
+                    return;
+
+                int code = corner_code(mc, density, xi, yi, zi, threshold);
+
+                int firstIn = firstMarchingCubesId[code];
+                int num = firstMarchingCubesId[code + 1] - firstIn;
+                int firstOut = mc.first_cell_tri[cell];
+
+                // triangles index the vertices of their own field
+                int firstVert = mc.first_cell_vert[(xi / mc.nx) * mc.nx * mc.ny * mc.nz];
+
+                for (int i = 0; i < num && firstOut + i < max_indices; i++)
+                {
+                    int eid = marchingCubesIds[firstIn + i];
+
+                    int exi = xi + marchingCubesEdgeLocations[eid][0];
+                    int eyi = yi + marchingCubesEdgeLocations[eid][1];
+                    int ezi = zi + marchingCubesEdgeLocations[eid][2];
+                    int edgeNr = marchingCubesEdgeLocations[eid][3];
+
+                    int id = mc.cell_verts[3 * mc.cell_index(exi, eyi, ezi) + edgeNr];
+                    triangles[firstOut + i] = id - firstVert;
+                }
+            });
+        }
+
+        // exclusive scan of the per cell counts, the extra cell past the end receives the total
+        int scan_counts(std::vector<int>& counts, int num_cells)
+        {
+            counts[num_cells] = 0;
+            scan_host(counts.data(), counts.data(), num_cells + 1, false);
+            return counts[num_cells];
+        }
+
+        void marching_cubes_resize(MarchingCubesHost& mc, int num_fields, int nx, int ny, int nz)
+        {
+            mc.nx = nx;
+            mc.ny = ny;
+            mc.nz = nz;
+            mc.num_fields = num_fields;
+            mc.num_cells = num_fields * nx * ny * nz;
+
+            mc.first_cell_vert.resize(mc.num_cells + 1);
+            mc.first_cell_tri.resize(mc.num_cells + 1);
+            mc.cell_verts.resize(3 * size_t(mc.num_cells));
+        }
+
+    } // anonymous namespace
+
+} // namespace wp
+
+uint64_t marching_cubes_create_host()
+{
+    wp::MarchingCubesHost* mc = new wp::MarchingCubesHost();
+    return (uint64_t)(mc);
+}
+
+void marching_cubes_destroy_host(uint64_t id)
+{
+    if (!id)
+        return;
+
+    delete (wp::MarchingCubesHost*)(id);
+}
+
+int marching_cubes_surface_host(
+    uint64_t id,
+    const float* field,
+    int nx,
+    int ny,
+    int nz,
+    float threshold,
+    wp::vec3* verts,
+    int* triangles,
+    int max_verts,
+    int max_tris,
+    int* out_num_verts,
+    int* out_num_tris)
+{
+    if (!id)
+        return -1;
+
+    if (!field)
+        return -1;
+
+    wp::MarchingCubesHost& mc = *(wp::MarchingCubesHost*)(id);
+
+    // reset counts
+    *out_num_verts = 0;
+    *out_num_tris = 0;
+
+    wp::marching_cubes_resize(mc, 1, nx, ny, nz);
+
+    // create vertices
+    wp::count_cell_verts(mc, field, threshold);
+
+    int num_verts = wp::scan_counts(mc.first_cell_vert, mc.num_cells);
+
+    // check we have enough storage, if not then
+    // return required vertex buffer size, let user resize
+    if (num_verts > max_verts)
+    {
+        *out_num_verts = num_verts;
+        return -1;
+    }
+
+    wp::create_cell_verts(mc, verts, field, threshold, max_verts);
+
+    // create triangles
+    wp::count_cell_tris(mc, field, threshold);
+
+    int num_tris = wp::scan_counts(mc.first_cell_tri, mc.num_cells) / 3;
+
+    if (num_tris > max_tris)
+    {
+        *out_num_tris = num_tris;
+        return -1;
+    }
+
+    wp::create_cell_tris(mc, field, triangles, threshold, max_tris * 3);
+
+    *out_num_verts = num_verts;
+    *out_num_tris = num_tris;
+
+    return 0;
+}
+
+int marching_cubes_surface_batch_host(
+    uint64_t id,
+    const float* fields,
+    int num_fields,
+    int nx,
+    int ny,
+    int nz,
+    float threshold,
+    wp::vec3* verts,
+    int* triangles,
+    int max_verts,
+    int max_tris,
+    int* vert_offsets,
+    int* tri_offsets)
+{
+    if (!id)
+        return -1;
+
+    if (!fields || num_fields <= 0)
+        return -1;
+
+    wp::MarchingCubesHost& mc = *(wp::MarchingCubesHost*)(id);
+
+    wp::marching_cubes_resize(mc, num_fields, nx, ny, nz);
+
+    // same passes as the single field version, except that the outputs are
+    // clamped to the buffers instead of returning early when they overflow
+    wp::count_cell_verts(mc, fields, threshold);
+    wp::scan_counts(mc.first_cell_vert, mc.num_cells);
+    wp::create_cell_verts(mc, verts, fields, threshold, max_verts);
+
+    wp::count_cell_tris(mc, fields, threshold);
+    wp::scan_counts(mc.first_cell_tri, mc.num_cells);
+    wp::create_cell_tris(mc, fields, triangles, threshold, max_tris * 3);
+
+    for (int i = 0; i <= num_fields; i++)
+    {
+        const int cell = i * nx * ny * nz;
+
+        vert_offsets[i] = mc.first_cell_vert[cell];
+        tri_offsets[i] = mc.first_cell_tri[cell] / 3;
+    }
+
+    return 0;
+}
+
+#if !WP_ENABLE_CUDA
+
+uint64_t marching_cubes_create_device(void* context)
+{
+    return 0;
+}
+
+void marching_cubes_destroy_device(uint64_t id)
+{
+}
+
+int marching_cubes_surface_device(uint64_t id, const float* field, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* out_num_verts, int* out_num_tris)
+{
+    return -1;
+}
+
+int marching_cubes_surface_batch_device(uint64_t id, const float* fields, int num_fields, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* vert_offsets, int* tri_offsets)
+{
+    return -1;
+}
+
+int marching_cubes_surface_volume_device(uint64_t id, uint64_t volume, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* out_num_verts, int* out_num_tris)
+{
+    return -1;
+}
+
+#endif // !WP_ENABLE_CUDA
@@ -555,7 +555,7 @@ inline CUDA_CALLABLE Type determinant(const mat_t<4,4,Type>& m)
     Type x10, x11, x12, x13;
     Type x20, x21, x22, x23;
     Type x30, x31, x32, x33;
-    double y01, y02, y03, y12, y13, y23;
+    typename cofactor_t<Type>::type y01, y02, y03, y12, y13, y23;
     Type z00, z10, z20, z30;
 
     // Pickle 1st two columns of matrix into registers
@@ -601,7 +601,7 @@ inline CUDA_CALLABLE Type determinant(const mat_t<4,4,Type>& m)
     z00 = x11*y23 - x21*y13 + x31*y12;
 
     // compute 4x4 determinant & its reciprocal
-    double det = x30*z30 + x20*z20 + x10*z10 + x00*z00;
+    typename cofactor_t<Type>::type det = x30*z30 + x20*z20 + x10*z10 + x00*z00;
     return det;
 }
 
@@ -680,10 +680,10 @@ inline CUDA_CALLABLE mat_t<4,4,Type> inverse(const mat_t<4,4,Type>& m)
     Type x10, x11, x12, x13;
     Type x20, x21, x22, x23;
     Type x30, x31, x32, x33;
-    double y01, y02, y03, y12, y13, y23;
+    typename cofactor_t<Type>::type y01, y02, y03, y12, y13, y23;
     Type z00, z10, z20, z30;
     Type z01, z11, z21, z31;
-    double z02, z03, z12, z13, z22, z23, z32, z33;
+    typename cofactor_t<Type>::type z02, z03, z12, z13, z22, z23, z32, z33;
 
     // Pickle 1st two columns of matrix into registers
     x00 = m.data[0][0];
@@ -742,13 +742,13 @@ inline CUDA_CALLABLE mat_t<4,4,Type> inverse(const mat_t<4,4,Type>& m)
     z01 = x20*y13 - x30*y12 - x10*y23;
 
     // compute 4x4 determinant & its reciprocal
-    double det = x30*z30 + x20*z20 + x10*z10 + x00*z00;
+    typename cofactor_t<Type>::type det = x30*z30 + x20*z20 + x10*z10 + x00*z00;
     
-    if(fabs(det) > kEps) 
+    if (det > kEps || det < -kEps) 
     {
         mat_t<4,4,Type> invm;
 
-        double rcp = 1.0 / det;
+        typename cofactor_t<Type>::type rcp = 1.0 / det;
 
         // Multiply all 3x3 cofactors by reciprocal & transpose
         invm.data[0][0] = Type(z00*rcp);
@@ -1434,4 +1434,310 @@ inline CUDA_CALLABLE void adj_mat44(float m00, float m01, float m02, float m03,
     a33 += adj_ret.data[3][3];
 }
 
+// Factorizations and solves of small square matrices held in registers, the loops have compile-time bounds so that
+// they unroll. The symmetric factorizations only read the lower triangle of A, and their gradients are with respect
+// to it. Zero pivots, e.g.: of matrices that are not positive definite, give zero columns and solution components.
+
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE mat_t<N,N,Type> cholesky(const mat_t<N,N,Type>& A)
+{
+    mat_t<N,N,Type> L;
+
+    for (int j=0; j < int(N); ++j)
+    {
+        Type s = A.data[j][j];
+        for (int k=0; k < j; ++k)
+            s -= L.data[j][k]*L.data[j][k];
+
+        if (s <= Type(0))
+            continue;
+
+        Type ljj = sqrt(s);
+        Type inv = Type(1)/ljj;
+        L.data[j][j] = ljj;
+
+        for (int i=j+1; i < int(N); ++i)
+        {
+            Type t = A.data[i][j];
+            for (int k=0; k < j; ++k)
+                t -= L.data[i][k]*L.data[j][k];
+
+            L.data[i][j] = t*inv;
+        }
+    }
+
+    return L;
+}
+
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE void adj_cholesky(const mat_t<N,N,Type>& A, mat_t<N,N,Type>& adj_A, const mat_t<N,N,Type>& adj_ret)
+{
+    // reverse of the factorization loops, column by column from the last one
+    mat_t<N,N,Type> L = cholesky(A);
+    mat_t<N,N,Type> adj_L = adj_ret;
+
+    for (int j=int(N)-1; j >= 0; --j)
+    {
+        Type ljj = L.data[j][j];
+        if (ljj == Type(0))
+            continue;
+
+        Type inv = Type(1)/ljj;
+
+        for (int i=int(N)-1; i > j; --i)
+        {
+            Type adj_t = adj_L.data[i][j]*inv;
+            adj_L.data[j][j] -= adj_t*L.data[i][j];
+            adj_A.data[i][j] += adj_t;
+
+            for (int k=0; k < j; ++k)
+            {
+                adj_L.data[i][k] -= adj_t*L.data[j][k];
+                adj_L.data[j][k] -= adj_t*L.data[i][k];
+            }
+        }
+
+        Type adj_s = adj_L.data[j][j]*Type(0.5)*inv;
+        adj_A.data[j][j] += adj_s;
+
+        for (int k=0; k < j; ++k)
+            adj_L.data[j][k] -= Type(2)*adj_s*L.data[j][k];
+    }
+}
+
+// solves L*L^T*x = b for the Cholesky factor L
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE vec_t<N,Type> cholesky_solve(const mat_t<N,N,Type>& L, const vec_t<N,Type>& b)
+{
+    vec_t<N,Type> x;
+
+    for (int i=0; i < int(N); ++i)
+    {
+        Type s = b[i];
+        for (int k=0; k < i; ++k)
+            s -= L.data[i][k]*x[k];
+
+        x[i] = L.data[i][i] != Type(0) ? s/L.data[i][i] : Type(0);
+    }
+
+    for (int i=int(N)-1; i >= 0; --i)
+    {
+        Type s = x[i];
+        for (int k=i+1; k < int(N); ++k)
+            s -= L.data[k][i]*x[k];
+
+        x[i] = L.data[i][i] != Type(0) ? s/L.data[i][i] : Type(0);
+    }
+
+    return x;
+}
+
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE void adj_cholesky_solve(const mat_t<N,N,Type>& L, const vec_t<N,Type>& b, mat_t<N,N,Type>& adj_L, vec_t<N,Type>& adj_b, const vec_t<N,Type>& adj_ret)
+{
+    // with A = L*L^T symmetric, adj_b = A^-1*adj_x and adj_A = -adj_b*x^T, so adj_L = -(adj_b*x^T + x*adj_b^T)*L
+    vec_t<N,Type> x = cholesky_solve(L, b);
+    vec_t<N,Type> g = cholesky_solve(L, adj_ret);
+    adj_b += g;
+
+    vec_t<N,Type> u = mul(transpose(L), g);
+    vec_t<N,Type> v = mul(transpose(L), x);
+
+    for (int i=0; i < int(N); ++i)
+        for (int j=0; j <= i; ++j)
+            adj_L.data[i][j] -= g[i]*v[j] + x[i]*u[j];
+}
+
+// factors A = L*D*L^T with L unit lower triangular and D = diag(d), without square roots so that A may be indefinite
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE void ldlt(const mat_t<N,N,Type>& A, mat_t<N,N,Type>& L, vec_t<N,Type>& d)
+{
+    L = mat_t<N,N,Type>();
+    d = vec_t<N,Type>();
+
+    for (int j=0; j < int(N); ++j)
+    {
+        Type dj = A.data[j][j];
+        for (int k=0; k < j; ++k)
+            dj -= L.data[j][k]*L.data[j][k]*d[k];
+
+        d[j] = dj;
+        L.data[j][j] = Type(1);
+
+        Type inv = dj != Type(0) ? Type(1)/dj : Type(0);
+
+        for (int i=j+1; i < int(N); ++i)
+        {
+            Type t = A.data[i][j];
+            for (int k=0; k < j; ++k)
+                t -= L.data[i][k]*L.data[j][k]*d[k];
+
+            L.data[i][j] = t*inv;
+        }
+    }
+}
+
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE void adj_ldlt(const mat_t<N,N,Type>& A, const mat_t<N,N,Type>& L, const vec_t<N,Type>& d,
+                                   mat_t<N,N,Type>& adj_A, const mat_t<N,N,Type>& adj_L_in, const vec_t<N,Type>& adj_d_in)
+{
+    // reverse of the factorization loops, the unit diagonal of L has no gradient
+    mat_t<N,N,Type> adj_L = adj_L_in;
+    vec_t<N,Type> adj_d = adj_d_in;
+
+    for (int j=int(N)-1; j >= 0; --j)
+    {
+        Type inv = d[j] != Type(0) ? Type(1)/d[j] : Type(0);
+
+        for (int i=int(N)-1; i > j; --i)
+        {
+            Type adj_t = adj_L.data[i][j]*inv;
+            adj_d[j] -= adj_t*L.data[i][j];
+            adj_A.data[i][j] += adj_t;
+
+            for (int k=0; k < j; ++k)
+            {
+                adj_L.data[i][k] -= adj_t*L.data[j][k]*d[k];
+                adj_L.data[j][k] -= adj_t*L.data[i][k]*d[k];
+                adj_d[k] -= adj_t*L.data[i][k]*L.data[j][k];
+            }
+        }
+
+        adj_A.data[j][j] += adj_d[j];
+
+        for (int k=0; k < j; ++k)
+        {
+            adj_L.data[j][k] -= Type(2)*adj_d[j]*L.data[j][k]*d[k];
+            adj_d[k] -= adj_d[j]*L.data[j][k]*L.data[j][k];
+        }
+    }
+}
+
+// solves L*D*L^T*x = b for the factors of ldlt()
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE vec_t<N,Type> ldlt_solve(const mat_t<N,N,Type>& L, const vec_t<N,Type>& d, const vec_t<N,Type>& b)
+{
+    vec_t<N,Type> x;
+
+    for (int i=0; i < int(N); ++i)
+    {
+        Type s = b[i];
+        for (int k=0; k < i; ++k)
+            s -= L.data[i][k]*x[k];
+
+        x[i] = s;
+    }
+
+    for (int i=0; i < int(N); ++i)
+        x[i] = d[i] != Type(0) ? x[i]/d[i] : Type(0);
+
+    for (int i=int(N)-1; i >= 0; --i)
+    {
+        Type s = x[i];
+        for (int k=i+1; k < int(N); ++k)
+            s -= L.data[k][i]*x[k];
+
+        x[i] = s;
+    }
+
+    return x;
+}
+
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE void adj_ldlt_solve(const mat_t<N,N,Type>& L, const vec_t<N,Type>& d, const vec_t<N,Type>& b,
+                                         mat_t<N,N,Type>& adj_L, vec_t<N,Type>& adj_d, vec_t<N,Type>& adj_b, const vec_t<N,Type>& adj_ret)
+{
+    // with A = L*D*L^T symmetric, adj_b = A^-1*adj_x and adj_A = -adj_b*x^T
+    vec_t<N,Type> x = ldlt_solve(L, d, b);
+    vec_t<N,Type> g = ldlt_solve(L, d, adj_ret);
+    adj_b += g;
+
+    vec_t<N,Type> u = mul(transpose(L), g);
+    vec_t<N,Type> v = mul(transpose(L), x);
+
+    for (int i=0; i < int(N); ++i)
+    {
+        adj_d[i] -= u[i]*v[i];
+
+        for (int j=0; j < i; ++j)
+            adj_L.data[i][j] -= (g[i]*v[j] + x[i]*u[j])*d[j];
+    }
+}
+
+// solves A*x = b by LU factorization with partial pivoting, rows are swapped by comparing
+// the loop indices with the pivot row so that they are never indexed dynamically
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE vec_t<N,Type> solve(const mat_t<N,N,Type>& A, const vec_t<N,Type>& b)
+{
+    mat_t<N,N,Type> M = A;
+    vec_t<N,Type> x = b;
+
+    for (int j=0; j < int(N); ++j)
+    {
+        int p = j;
+        Type pmax = abs(M.data[j][j]);
+        for (int i=j+1; i < int(N); ++i)
+        {
+            if (abs(M.data[i][j]) > pmax)
+            {
+                p = i;
+                pmax = abs(M.data[i][j]);
+            }
+        }
+
+        for (int i=j+1; i < int(N); ++i)
+        {
+            if (i == p)
+            {
+                for (int k=j; k < int(N); ++k)
+                {
+                    Type t = M.data[j][k];
+                    M.data[j][k] = M.data[i][k];
+                    M.data[i][k] = t;
+                }
+
+                Type t = x[j];
+                x[j] = x[i];
+                x[i] = t;
+            }
+        }
+
+        if (M.data[j][j] == Type(0))
+            continue;
+
+        Type inv = Type(1)/M.data[j][j];
+
+        for (int i=j+1; i < int(N); ++i)
+        {
+            Type f = M.data[i][j]*inv;
+            for (int k=j+1; k < int(N); ++k)
+                M.data[i][k] -= f*M.data[j][k];
+
+            x[i] -= f*x[j];
+        }
+    }
+
+    for (int i=int(N)-1; i >= 0; --i)
+    {
+        Type s = x[i];
+        for (int k=i+1; k < int(N); ++k)
+            s -= M.data[i][k]*x[k];
+
+        x[i] = M.data[i][i] != Type(0) ? s/M.data[i][i] : Type(0);
+    }
+
+    return x;
+}
+
+template<unsigned N, typename Type>
+inline CUDA_CALLABLE void adj_solve(const mat_t<N,N,Type>& A, const vec_t<N,Type>& b, mat_t<N,N,Type>& adj_A, vec_t<N,Type>& adj_b, const vec_t<N,Type>& adj_ret)
+{
+    // adj_b = A^-T*adj_x and adj_A = -adj_b*x^T
+    vec_t<N,Type> x = solve(A, b);
+    vec_t<N,Type> g = solve(transpose(A), adj_ret);
+
+    adj_b += g;
+    adj_A -= outer(g, x);
+}
+
 } // namespace wp
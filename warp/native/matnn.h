@@ -31,9 +31,71 @@ CUDA_CALLABLE inline int dense_index(int rows, int cols, int i, int j)
 
 const int kNumThreadsPerBlock = 256;
 
+// batched factorizations and solves are computed by one warp per matrix
+const int kNumThreadsPerMatrix = 32;
+
+// side of the square tiles of A and B staged in shared memory by the blocked GEMM, one output per thread of a tile
+const int kGemmTileSize = 16;
+
+template <bool t1, bool t2, bool add>
+CUDA_CALLABLE_DEVICE inline void dense_gemm_tiled(int m, int n, int p, const float* __restrict__ A, const float* __restrict__ B, float* __restrict__ C)
+{
+#if defined(__CUDA_ARCH__)
+    // padded to avoid bank conflicts when reading columns of the tiles
+    __shared__ float As[kGemmTileSize][kGemmTileSize + 1];
+    __shared__ float Bs[kGemmTileSize][kGemmTileSize + 1];
+
+    const int ty = threadIdx.x / kGemmTileSize;
+    const int tx = threadIdx.x % kGemmTileSize;
+
+    // the block sweeps over the output tiles, all threads take part in every iteration so the barriers are uniform
+    for (int i0=0; i0 < m; i0 += kGemmTileSize)
+    {
+        for (int j0=0; j0 < n; j0 += kGemmTileSize)
+        {
+            const int i = i0 + ty;
+            const int j = j0 + tx;
+
+            float sum = 0.0f;
+
+            for (int k0=0; k0 < p; k0 += kGemmTileSize)
+            {
+                // consecutive threads load consecutive elements of the tiles when the operands are not transposed
+                As[ty][tx] = (i < m && k0 + tx < p) ? A[dense_index<t1>(m, p, i, k0 + tx)] : 0.0f;
+                Bs[ty][tx] = (k0 + ty < p && j < n) ? B[dense_index<t2>(p, n, k0 + ty, j)] : 0.0f;
+
+                __syncthreads();
+
+                for (int k=0; k < kGemmTileSize; ++k)
+                    sum += As[ty][k]*Bs[k][tx];
+
+                __syncthreads();
+            }
+
+            if (i < m && j < n)
+            {
+                if (add)
+                    C[i*n + j] += sum;
+                else
+                    C[i*n + j] = sum;
+            }
+        }
+    }
+#endif
+}
+
 template <bool t1, bool t2, bool add>
 CUDA_CALLABLE inline void dense_gemm_impl(int m, int n, int p, const float* __restrict__ A, const float* __restrict__ B, float* __restrict__ C)
 {
+#if defined(__CUDA_ARCH__)
+    // blocks of the batched launch stage the operands in shared memory tiles
+    if (blockDim.x == kGemmTileSize*kGemmTileSize)
+    {
+        dense_gemm_tiled<t1, t2, add>(m, n, p, A, B, C);
+        return;
+    }
+#endif
+
     // each thread in the block calculates an output (or more if output dim > block dim)
     for (int e=threadIdx.x; e < m*n; e += blockDim.x)
     {
@@ -57,6 +119,7 @@ CUDA_CALLABLE inline void dense_gemm_impl(int m, int n, int p, const float* __re
 #else
 
 const int kNumThreadsPerBlock = 1;
+const int kNumThreadsPerMatrix = 1;
 
 template <bool t1, bool t2, bool add>
 CUDA_CALLABLE inline void dense_gemm_impl(int m, int n, int p, const float* __restrict__ A, const float* __restrict__ B, float* __restrict__ C)
@@ -141,6 +204,87 @@ void  CUDA_CALLABLE inline dense_chol(int n, const float* __restrict__ A, const
 }
 
 
+#if defined(__CUDA_ARCH__)
+
+CUDA_CALLABLE_DEVICE inline float dense_warp_sum(float x)
+{
+    for (int offset=kNumThreadsPerMatrix/2; offset > 0; offset /= 2)
+        x += __shfl_xor_sync(0xffffffff, x, offset);
+
+    return x;
+}
+
+// Cholesky factorization by the lanes of a warp, each column is computed in parallel over its rows
+CUDA_CALLABLE_DEVICE inline void dense_chol_warp(int lane, int n, const float* __restrict__ A, const float* __restrict__ regularization, float* __restrict__ L)
+{
+    for (int j=0; j < n; ++j)
+    {
+        float r = 0.0f;
+        for (int k=lane; k < j; k += kNumThreadsPerMatrix)
+        {
+            const float l = L[dense_index(n, j, k)];
+            r += l*l;
+        }
+
+        const float s = sqrt(A[dense_index(n, j, j)] + regularization[j] - dense_warp_sum(r));
+        const float invS = 1.0f/s;
+
+        if (lane == 0)
+            L[dense_index(n, j, j)] = s;
+
+        for (int i=j+1+lane; i < n; i += kNumThreadsPerMatrix)
+        {
+            float t = A[dense_index(n, i, j)];
+
+            for (int k=0; k < j; ++k)
+                t -= L[dense_index(n, i, k)]*L[dense_index(n, j, k)];
+
+            L[dense_index(n, i, j)] = t*invS;
+        }
+
+        // the next column reads the entries of this column written by the other lanes
+        __syncwarp();
+    }
+}
+
+// Solves (L*L^T)x = b by the lanes of a warp, the dot products of each substitution step are reduced over the warp
+CUDA_CALLABLE_DEVICE inline void dense_subs_warp(int lane, int n, const float* __restrict__ L, const float* __restrict__ b, float* __restrict__ x)
+{
+    // forward substitution
+    for (int i=0; i < n; ++i)
+    {
+        float s = 0.0f;
+        for (int j=lane; j < i; j += kNumThreadsPerMatrix)
+            s += L[dense_index(n, i, j)]*x[j];
+
+        s = (b[i] - dense_warp_sum(s))/L[dense_index(n, i, i)];
+
+        if (lane == 0)
+            x[i] = s;
+
+        __syncwarp();
+    }
+
+    // backward substitution
+    for (int i=n-1; i >= 0; --i)
+    {
+        float s = 0.0f;
+        for (int j=i+1+lane; j < n; j += kNumThreadsPerMatrix)
+            s += L[dense_index(n, j, i)]*x[j];
+
+        s = (x[i] - dense_warp_sum(s))/L[dense_index(n, i, i)];
+
+        __syncwarp();
+
+        if (lane == 0)
+            x[i] = s;
+
+        __syncwarp();
+    }
+}
+
+#endif
+
 CUDA_CALLABLE inline void dense_chol_batched(const int* __restrict__ A_start, const int* __restrict__ A_dim, const float* __restrict__ A, const float* __restrict__ regularization, float* __restrict__ L)
 {
     const int batch = tid();
@@ -151,6 +295,21 @@ CUDA_CALLABLE inline void dense_chol_batched(const int* __restrict__ A_start, co
     dense_chol(n, A + offset, regularization + n*batch, L + offset);
 }
 
+// same as dense_chol_batched() but launched with kNumThreadsPerMatrix threads per matrix
+CUDA_CALLABLE inline void dense_chol_batched_warp(const int* __restrict__ A_start, const int* __restrict__ A_dim, const float* __restrict__ A, const float* __restrict__ regularization, float* __restrict__ L)
+{
+    const int batch = tid()/kNumThreadsPerMatrix;
+    
+    const int n = A_dim[batch];
+    const int offset = A_start[batch];
+    
+#if defined(__CUDA_ARCH__)
+    dense_chol_warp(tid()%kNumThreadsPerMatrix, n, A + offset, regularization + n*batch, L + offset);
+#else
+    dense_chol(n, A + offset, regularization + n*batch, L + offset);
+#endif
+}
+
 
 // Solves (L*L^T)x = b given the Cholesky factor L 
 CUDA_CALLABLE inline void dense_subs(int n, const float* __restrict__ L, const float* __restrict__ b, float* __restrict__ x)
@@ -198,6 +357,21 @@ CUDA_CALLABLE inline void dense_solve_batched(
     dense_solve(A_dim[batch], A + A_start[batch], L + A_start[batch], b + b_start[batch], NULL, x + b_start[batch]);
 }
 
+// same as dense_solve_batched() but launched with kNumThreadsPerMatrix threads per matrix
+CUDA_CALLABLE inline void dense_solve_batched_warp(
+    const int* __restrict__ b_start, const int* A_start, const int* A_dim, 
+    const float* __restrict__ A, const float* __restrict__ L, 
+    const float* __restrict__ b, float* __restrict__ tmp, float* __restrict__ x)
+{
+    const int batch = tid()/kNumThreadsPerMatrix;
+
+#if defined(__CUDA_ARCH__)
+    dense_subs_warp(tid()%kNumThreadsPerMatrix, A_dim[batch], L + A_start[batch], b + b_start[batch], x + b_start[batch]);
+#else
+    dense_solve(A_dim[batch], A + A_start[batch], L + A_start[batch], b + b_start[batch], NULL, x + b_start[batch]);
+#endif
+}
+
 
 // CUDA_CALLABLE inline void print_matrix(const char* name, int m, int n, const float* data)
 // {
@@ -271,6 +445,14 @@ CUDA_CALLABLE inline void adj_dense_chol_batched(
 }
 
 
+CUDA_CALLABLE inline void adj_dense_chol_batched_warp(
+    const int* __restrict__ A_start, const int* __restrict__ A_dim, const float* __restrict__ A, const float* __restrict__ regularization, float* __restrict__ L,
+    const int* __restrict__ adj_A_start, const int* __restrict__ adj_A_dim, const float* __restrict__ adj_A, const float* __restrict__ adj_regularization, float* __restrict__ adj_L)
+{
+    // nop, use dense_solve to differentiate through (A^-1)b = x
+}
+
+
 CUDA_CALLABLE inline void adj_dense_subs(
     int n, const array_t<float>& L, const array_t<float>& b, array_t<float>& x,
     int adj_n, const array_t<float>& adj_L, const array_t<float>& adj_b, array_t<float>& adj_x)
@@ -325,6 +507,46 @@ CUDA_CALLABLE inline void adj_dense_solve_batched(
 }
 
 
+CUDA_CALLABLE inline void adj_dense_solve_batched_warp(
+    const int* __restrict__ b_start, const int* A_start, const int* A_dim, 
+    const float* __restrict__ A, const float* __restrict__ L, 
+    const float* __restrict__ b, float* __restrict__ tmp, float* __restrict__ x,
+    // adj
+    int* __restrict__ adj_b_start, int* __restrict__ adj_A_start, int* __restrict__ adj_A_dim, 
+    float* __restrict__ adj_A, float* __restrict__ adj_L, 
+    float* __restrict__ adj_b, float* __restrict__ adj_tmp, const float* __restrict__ adj_x)
+{
+    const int batch = tid()/kNumThreadsPerMatrix;
+
+#if defined(__CUDA_ARCH__)
+    const int lane = tid()%kNumThreadsPerMatrix;
+    const int n = A_dim[batch];
+
+    tmp += b_start[batch];
+    adj_A += A_start[batch];
+    adj_b += b_start[batch];
+    x += b_start[batch];
+
+    for (int i=lane; i < n; i += kNumThreadsPerMatrix)
+        tmp[i] = 0.0f;
+
+    __syncwarp();
+
+    dense_subs_warp(lane, n, L + A_start[batch], adj_x + b_start[batch], tmp);
+
+    for (int i=lane; i < n; i += kNumThreadsPerMatrix)
+        adj_b[i] += tmp[i];
+
+    // A* = -adj_b*x^T
+    for (int e=lane; e < n*n; e += kNumThreadsPerMatrix)
+        adj_A[e] += -tmp[e/n]*x[e%n];
+#else
+    adj_dense_solve(A_dim[batch], A + A_start[batch], L + A_start[batch], b + b_start[batch], tmp + b_start[batch], x + b_start[batch],
+                    0, adj_A + A_start[batch], adj_L + A_start[batch], adj_b + b_start[batch], tmp + b_start[batch], adj_x + b_start[batch]);
+#endif
+}
+
+
 template <typename F>
 CUDA_CALLABLE inline void mlp(const array_t<float>& weights, const array_t<float>& bias, F activation, int index, const array_t<float>& x, array_t<float>& out)
 {
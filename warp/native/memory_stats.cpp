@@ -0,0 +1,190 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+struct MemoryCounters
+{
+    uint64_t current = 0;
+    uint64_t peak = 0;
+    uint64_t count = 0; // number of allocations made
+    uint64_t histogram[WP_MEMORY_HISTOGRAM_BINS] = {}; // live allocations by size class
+
+    void add(size_t size, int bin)
+    {
+        current += size;
+        peak = std::max(peak, current);
+        count += 1;
+        histogram[bin] += 1;
+    }
+
+    void remove(size_t size, int bin)
+    {
+        current -= size;
+        histogram[bin] -= 1;
+    }
+};
+
+struct Allocation
+{
+    size_t size;
+    int space;
+    int tag;
+};
+
+// constructed on first use, so that allocations made during static initialization are accounted safely
+struct MemoryStats
+{
+    std::mutex mutex;
+
+    // tag 0 is the untagged memory
+    std::vector<std::string> tag_names = {""};
+    std::unordered_map<std::string, int> tag_ids = {{"", 0}};
+
+    // counters by (memory space, tag), the tag -1 holds the totals of the space
+    std::map<std::pair<int, int>, MemoryCounters> counters;
+    std::unordered_map<void*, Allocation> allocations;
+};
+
+MemoryStats& memory_stats()
+{
+    static MemoryStats* stats = new MemoryStats();
+    return *stats;
+}
+
+thread_local int g_memory_tag = 0;
+
+// size classes are powers of two, bin b holds the sizes in (2^(b-1), 2^b]
+int memory_size_bin(size_t size)
+{
+    int bin = 0;
+    while (bin < WP_MEMORY_HISTOGRAM_BINS - 1 && (size_t(1) << bin) < size)
+        ++bin;
+    return bin;
+}
+
+} // anonymous namespace
+
+
+void memory_stats_record_alloc(int space, void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    const int bin = memory_size_bin(size);
+    const int tag = g_memory_tag;
+
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    stats.allocations[ptr] = Allocation{size, space, tag};
+    stats.counters[std::make_pair(space, -1)].add(size, bin);
+    stats.counters[std::make_pair(space, tag)].add(size, bin);
+}
+
+void memory_stats_record_free(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    auto it = stats.allocations.find(ptr);
+    if (it == stats.allocations.end())
+        return;
+
+    const Allocation& a = it->second;
+    const int bin = memory_size_bin(a.size);
+    stats.counters[std::make_pair(a.space, -1)].remove(a.size, bin);
+    stats.counters[std::make_pair(a.space, a.tag)].remove(a.size, bin);
+    stats.allocations.erase(it);
+}
+
+int memory_tag_register(const char* name)
+{
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    auto it = stats.tag_ids.find(name);
+    if (it != stats.tag_ids.end())
+        return it->second;
+
+    const int tag = int(stats.tag_names.size());
+    stats.tag_names.push_back(name);
+    stats.tag_ids[name] = tag;
+    return tag;
+}
+
+int memory_tag_count()
+{
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    return int(stats.tag_names.size());
+}
+
+const char* memory_tag_name(int tag)
+{
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    if (tag < 0 || tag >= int(stats.tag_names.size()))
+        return NULL;
+
+    // names are never removed, so the pointer stays valid
+    return stats.tag_names[tag].c_str();
+}
+
+int memory_tag_set(int tag)
+{
+    const int previous = g_memory_tag;
+    g_memory_tag = tag;
+    return previous;
+}
+
+int memory_stats_get(int space, int tag, uint64_t* current, uint64_t* peak, uint64_t* count, uint64_t* histogram)
+{
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    auto it = stats.counters.find(std::make_pair(space, tag));
+    if (it == stats.counters.end())
+        return 0;
+
+    const MemoryCounters& c = it->second;
+    *current = c.current;
+    *peak = c.peak;
+    *count = c.count;
+    if (histogram)
+        std::copy(c.histogram, c.histogram + WP_MEMORY_HISTOGRAM_BINS, histogram);
+
+    return 1;
+}
+
+void memory_stats_reset_peak(int space)
+{
+    MemoryStats& stats = memory_stats();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+
+    for (auto& it : stats.counters)
+    {
+        if (it.first.first == space)
+            it.second.peak = it.second.current;
+    }
+}
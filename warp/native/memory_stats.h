@@ -0,0 +1,31 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+#include "warp.h"
+
+// records the allocations of the native allocators in the counters of their memory space and of the calling
+// thread's current tag, freeing a pointer that was not recorded is ignored
+void memory_stats_record_alloc(int space, void* ptr, size_t size);
+void memory_stats_record_free(void* ptr);
+
+// records a device allocation made outside of alloc_device() in the space of the device of the context
+void memory_stats_record_device_alloc(void* context, void* ptr, size_t size);
+
+// attributes the allocations made by the calling thread in its scope to the named tag, the innermost tag wins
+struct ScopedMemoryTag
+{
+    explicit ScopedMemoryTag(const char* name) : previous(memory_tag_set(memory_tag_register(name))) {}
+    ~ScopedMemoryTag() { memory_tag_set(previous); }
+
+    ScopedMemoryTag(const ScopedMemoryTag&) = delete;
+    ScopedMemoryTag& operator=(const ScopedMemoryTag&) = delete;
+
+    int previous;
+};
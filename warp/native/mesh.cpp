@@ -13,13 +13,28 @@
 
 using namespace wp;
 
+#include <algorithm>
+#include <climits>
 #include <map>
+#include <vector>
 
 namespace 
 {
     // host-side copy of mesh descriptors, maps GPU mesh address (id) to a CPU desc
     std::map<uint64_t, Mesh> g_mesh_descriptors;
 
+    // allocations shared by the meshes of a batch, see mesh_create_batch_device()
+    struct MeshBatch
+    {
+        void* context;
+        void* mesh_pool;
+        void* node_pool;
+        int num_meshes;
+    };
+
+    // maps the ids of batched meshes to their batch
+    std::map<uint64_t, MeshBatch*> g_mesh_batches;
+
 } // anonymous namespace
 
 
@@ -47,6 +62,14 @@ void mesh_rem_descriptor(uint64_t id)
 
 }
 
+void mesh_add_batch(const uint64_t* ids, int num_meshes, void* context, void* mesh_pool, void* node_pool)
+{
+    MeshBatch* batch = new MeshBatch{context, mesh_pool, node_pool, num_meshes};
+
+    for (int i=0; i < num_meshes; ++i)
+        g_mesh_batches[ids[i]] = batch;
+}
+
 } // namespace wp
 
 void bvh_refit_with_solid_angle_recursive_host(BVH& bvh, int index, Mesh& mesh)
@@ -59,7 +82,7 @@ void bvh_refit_with_solid_angle_recursive_host(BVH& bvh, int index, Mesh& mesh)
         // Leaf, compute properties
         const int leaf_index = lower.i;
 
-        precompute_triangle_solid_angle_props(mesh.points[mesh.indices[leaf_index*3+0]], mesh.points[mesh.indices[leaf_index*3+1]], mesh.points[mesh.indices[leaf_index*3+2]], mesh.solid_angle_props[index]);        
+        precompute_triangle_solid_angle_props(mesh_point(mesh, mesh.indices[leaf_index*3+0]), mesh_point(mesh, mesh.indices[leaf_index*3+1]), mesh_point(mesh, mesh.indices[leaf_index*3+2]), mesh.solid_angle_props[index]);
         (vec3&)lower = mesh.solid_angle_props[index].box.lower;
         (vec3&)upper = mesh.solid_angle_props[index].box.upper;        
     }
@@ -97,6 +120,36 @@ void bvh_refit_with_solid_angle_recursive_host(BVH& bvh, int index, Mesh& mesh)
 void bvh_refit_with_solid_angle_host(BVH& bvh, Mesh& mesh)
 {
     bvh_refit_with_solid_angle_recursive_host(bvh, 0, mesh);
+
+    if (bvh.wide_nodes)
+        bvh_refit_wide_host(bvh);
+}
+
+// quantizes the points relative to the bounds of the last refit, then refits the BVH to the
+// decoded triangles so that the node bounds stay conservative for the queries
+static void mesh_update_quantized_points_host(Mesh* m)
+{
+    if (m->bvh.num_nodes == 0)
+        return;
+
+    const BVHPackedNodeHalf& lower = m->bvh.node_lowers[m->bvh.root];
+    const BVHPackedNodeHalf& upper = m->bvh.node_uppers[m->bvh.root];
+
+    m->quantized_frame[0] = vec3(lower.x, lower.y, lower.z);
+    m->quantized_frame[1] = (vec3(upper.x, upper.y, upper.z) - m->quantized_frame[0])/65535.0f;
+
+    for (int i=0; i < m->num_points; ++i)
+        mesh_quantize_point(m->points[i], m->quantized_frame, m->quantized_points + i*3);
+
+    for (int i=0; i < m->num_tris; ++i)
+    {
+        m->bounds[i] = bounds3();
+        m->bounds[i].add_point(mesh_point(*m, m->indices[i*3+0]));
+        m->bounds[i].add_point(mesh_point(*m, m->indices[i*3+1]));
+        m->bounds[i].add_point(mesh_point(*m, m->indices[i*3+2]));
+    }
+
+    bvh_refit_host(m->bvh, m->bounds);
 }
 
 uint64_t mesh_create_host(array_t<wp::vec3> points, array_t<wp::vec3> velocities, array_t<int> indices, int num_points, int num_tris, int support_winding_number)
@@ -122,88 +175,97 @@ uint64_t mesh_create_host(array_t<wp::vec3> points, array_t<wp::vec3> velocities
 
     if (support_winding_number) 
     {
-        // Let's first compute the sold
+        // the solid angle data is computed by the first mesh_refit_solid_angle_host()
         int num_bvh_nodes = 2*num_tris-1;
         m->solid_angle_props = new SolidAngleProps[num_bvh_nodes];
-        bvh_refit_with_solid_angle_host(m->bvh, *m);
     }
 
     return (uint64_t)m;
 }
 
-uint64_t mesh_create_device(void* context, array_t<wp::vec3> points, array_t<wp::vec3> velocities, array_t<int> indices, int num_points, int num_tris, int support_winding_number)
+void mesh_build_wide_host(uint64_t id)
 {
-    ContextGuard guard(context);
+    Mesh* m = (Mesh*)(id);
+    bvh_build_wide_host(m->bvh);
+}
 
-    Mesh mesh(points, velocities, indices, num_points, num_tris);
+void mesh_quantize_host(uint64_t id)
+{
+    Mesh* m = (Mesh*)(id);
 
-    mesh.context = context ? context : cuda_context_get_current();
+    if (!m->quantized_points)
+    {
+        m->quantized_points = new uint16_t[m->num_points*3];
+        m->quantized_frame = new vec3[2];
+    }
 
-    // mesh.points = array_t<vec3>(points, num_points, points_grad);
-    // mesh.velocities = array_t<vec3>(velocities, num_points, velocities_grad);
-    // mesh.indices = array_t<int>(indices, num_tris, 3);
+    mesh_update_quantized_points_host(m);
+    m->solid_angle_valid = 0;
+}
 
-    // mesh.num_points = num_points;
-    // mesh.num_tris = num_tris;
+void mesh_reorder_host(uint64_t id, int* tri_permutation, int* point_permutation)
+{
+    Mesh* m = (Mesh*)(id);
+    BVH& bvh = m->bvh;
 
+    // the median builder numbers the nodes depth-first, so leaves that are close in the tree are close in memory
+    int count = 0;
+    for (int i=0; i < bvh.num_nodes; ++i)
     {
-        // todo: BVH creation only on CPU at the moment so temporarily bring all the data back to host
-        vec3* points_host = (vec3*)alloc_host(sizeof(vec3)*num_points);
-        int* indices_host = (int*)alloc_host(sizeof(int)*num_tris*3);
-        bounds3* bounds_host = (bounds3*)alloc_host(sizeof(bounds3)*num_tris);
-
-        memcpy_d2h(WP_CURRENT_CONTEXT, points_host, points, sizeof(vec3)*num_points);
-        memcpy_d2h(WP_CURRENT_CONTEXT, indices_host, indices, sizeof(int)*num_tris*3);
-        cuda_context_synchronize(WP_CURRENT_CONTEXT);
-
-        float sum = 0.0;
-        for (int i=0; i < num_tris; ++i)
+        if (bvh.node_lowers[i].b)
         {
-            bounds_host[i] = bounds3();
-            wp::vec3 p0 = points_host[indices_host[i*3+0]];
-            wp::vec3 p1 = points_host[indices_host[i*3+1]];
-            wp::vec3 p2 = points_host[indices_host[i*3+2]];
-            bounds_host[i].add_point(p0);
-            bounds_host[i].add_point(p1);
-            bounds_host[i].add_point(p2);
-            sum += length(p0-p1) + length(p0-p2) + length(p2-p1);
+            tri_permutation[count] = bvh.node_lowers[i].i;
+            bvh.node_lowers[i].i = count;
+            bvh.node_uppers[i].i = count;
+            ++count;
         }
-        mesh.average_edge_length = sum / (num_tris*3);
+    }
 
-        BVH bvh_host = bvh_create(bounds_host, num_tris);
-        BVH bvh_device = bvh_clone(WP_CURRENT_CONTEXT, bvh_host);
+    std::vector<int> indices(m->indices.data, m->indices.data + m->num_tris*3);
+    std::vector<bounds3> bounds(m->bounds, m->bounds + m->num_tris);
 
-        bvh_destroy_host(bvh_host);
+    for (int i=0; i < m->num_tris; ++i)
+    {
+        const int t = tri_permutation[i];
 
-        // save gpu-side copy of bounds
-        mesh.bounds = (bounds3*)alloc_device(WP_CURRENT_CONTEXT, sizeof(bounds3)*num_tris);
-        memcpy_h2d(WP_CURRENT_CONTEXT, mesh.bounds, bounds_host, sizeof(bounds3)*num_tris);
+        m->indices[i*3+0] = indices[t*3+0];
+        m->indices[i*3+1] = indices[t*3+1];
+        m->indices[i*3+2] = indices[t*3+2];
+        m->bounds[i] = bounds[t];
+    }
 
-        free_host(points_host);
-        free_host(indices_host);
-        free_host(bounds_host);
+    if (!point_permutation)
+        return;
 
-        mesh.bvh = bvh_device;
+    // vertices are sorted by the first triangle that uses them, unused vertices go last
+    // in their original order, which matches the stable radix sort of mesh_reorder_device()
+    std::vector<int> first_use(m->num_points, INT_MAX);
+    for (int i=0; i < m->num_tris*3; ++i)
+        first_use[m->indices[i]] = std::min(first_use[m->indices[i]], i/3);
 
-        if (support_winding_number)
-        {
-            int num_bvh_nodes = 2*num_tris-1;
-            mesh.solid_angle_props = (SolidAngleProps*)alloc_device(WP_CURRENT_CONTEXT, sizeof(SolidAngleProps)*num_bvh_nodes);
-        }        
-    }
+    for (int i=0; i < m->num_points; ++i)
+        point_permutation[i] = i;
 
-    Mesh* mesh_device = (Mesh*)alloc_device(WP_CURRENT_CONTEXT, sizeof(Mesh));
-    memcpy_h2d(WP_CURRENT_CONTEXT, mesh_device, &mesh, sizeof(Mesh));
-    
-    // save descriptor
-    uint64_t mesh_id = (uint64_t)mesh_device;
-    mesh_add_descriptor(mesh_id, mesh);
+    std::stable_sort(point_permutation, point_permutation + m->num_points, [&](int a, int b) { return first_use[a] < first_use[b]; });
 
-    if (support_winding_number) 
+    std::vector<int> remap(m->num_points);
+    std::vector<vec3> points(m->points.data, m->points.data + m->num_points);
+    std::vector<vec3> velocities;
+    if (m->velocities.data)
+        velocities.assign(m->velocities.data, m->velocities.data + m->num_points);
+
+    for (int i=0; i < m->num_points; ++i)
     {
-        mesh_refit_device(mesh_id);
+        const int p = point_permutation[i];
+
+        remap[p] = i;
+        m->points[i] = points[p];
+        if (m->velocities.data)
+            m->velocities[i] = velocities[p];
     }
-    return mesh_id;
+
+    for (int i=0; i < m->num_tris*3; ++i)
+        m->indices[i] = remap[m->indices[i]];
 }
 
 void mesh_destroy_host(uint64_t id)
@@ -211,6 +273,9 @@ void mesh_destroy_host(uint64_t id)
     Mesh* m = (Mesh*)(id);
 
     delete[] m->bounds;
+    delete[] m->tri_nodes;
+    delete[] m->quantized_points;
+    delete[] m->quantized_frame;
     if (m->solid_angle_props) {
         delete [] m->solid_angle_props;
     }
@@ -226,18 +291,90 @@ void mesh_destroy_device(uint64_t id)
     {
         ContextGuard guard(mesh.context);
 
+        const auto batch = g_mesh_batches.find(id);
+        const bool batched = batch != g_mesh_batches.end();
+
+        // the buffers shared with the other meshes of the batch are freed with the last of them
+        if (batched)
+        {
+            mesh.bvh.node_lowers = NULL;
+            mesh.bvh.node_uppers = NULL;
+            mesh.bvh.node_parents = NULL;
+            mesh.bvh.node_counts = NULL;
+            mesh.bounds = NULL;
+            mesh.solid_angle_props = NULL;
+        }
+
         bvh_destroy_device(mesh.bvh);
 
         free_device(WP_CURRENT_CONTEXT, mesh.bounds);
-        free_device(WP_CURRENT_CONTEXT, (Mesh*)id);
+        free_device(WP_CURRENT_CONTEXT, mesh.tri_nodes);
+        free_device(WP_CURRENT_CONTEXT, mesh.quantized_points);
+        free_device(WP_CURRENT_CONTEXT, mesh.quantized_frame);
 
         if (mesh.solid_angle_props) {
             free_device(WP_CURRENT_CONTEXT, mesh.solid_angle_props);
         }
         mesh_rem_descriptor(id);
+
+        if (batched)
+        {
+            MeshBatch* b = batch->second;
+            g_mesh_batches.erase(batch);
+
+            if (--b->num_meshes == 0)
+            {
+                free_device(b->context, b->mesh_pool);
+                free_device(b->context, b->node_pool);
+                delete b;
+            }
+        }
+        else
+        {
+            free_device(WP_CURRENT_CONTEXT, (Mesh*)id);
+        }
     }
 }
 
+uint64_t mesh_clone_to_device(void* context, uint64_t id, wp::array_t<wp::vec3> points, wp::array_t<wp::vec3> velocities, wp::array_t<int> indices)
+{
+    Mesh mesh_src;
+    if (!mesh_get_descriptor(id, mesh_src))
+        return 0;
+
+    ContextGuard guard(context);
+
+    Mesh mesh = mesh_src;
+
+    mesh.context = context ? context : cuda_context_get_current();
+
+    // managed by the user
+    mesh.points = points;
+    mesh.velocities = velocities;
+    mesh.indices = indices;
+
+    mesh.bvh = bvh_clone_device(WP_CURRENT_CONTEXT, mesh_src.bvh);
+
+    mesh.bounds = (bounds3*)clone_buffer_device(WP_CURRENT_CONTEXT, mesh_src.bounds, sizeof(bounds3)*mesh_src.num_tris);
+    mesh.tri_nodes = (int*)clone_buffer_device(WP_CURRENT_CONTEXT, mesh_src.tri_nodes, sizeof(int)*mesh_src.num_tris);
+    mesh.quantized_points = (uint16_t*)clone_buffer_device(WP_CURRENT_CONTEXT, mesh_src.quantized_points, sizeof(uint16_t)*3*mesh_src.num_points);
+    mesh.quantized_frame = (vec3*)clone_buffer_device(WP_CURRENT_CONTEXT, mesh_src.quantized_frame, sizeof(vec3)*2);
+
+    if (mesh_src.solid_angle_props)
+        mesh.solid_angle_props = (SolidAngleProps*)clone_buffer_device(WP_CURRENT_CONTEXT, mesh_src.solid_angle_props, sizeof(SolidAngleProps)*(2*mesh_src.num_tris-1));
+
+    Mesh* mesh_device = (Mesh*)alloc_device(WP_CURRENT_CONTEXT, sizeof(Mesh));
+    memcpy_h2d(WP_CURRENT_CONTEXT, mesh_device, &mesh, sizeof(Mesh));
+
+    // the average edge length is only kept on the device, see mesh_refit_device()
+    memcpy_peer(WP_CURRENT_CONTEXT, &mesh_device->average_edge_length, &((Mesh*)id)->average_edge_length, sizeof(float));
+
+    uint64_t mesh_id = (uint64_t)mesh_device;
+    mesh_add_descriptor(mesh_id, mesh);
+
+    return mesh_id;
+}
+
 void mesh_refit_host(uint64_t id)
 {
     Mesh* m = (Mesh*)(id);
@@ -256,24 +393,269 @@ void mesh_refit_host(uint64_t id)
     }
     m->average_edge_length = sum / (m->num_tris*3);
 
-    if (m->solid_angle_props)
+    // solid angle data is only recomputed once a winding number query needs it
+    bvh_refit_host(m->bvh, m->bounds);
+    m->solid_angle_valid = 0;
+
+    if (m->quantized_points)
+        mesh_update_quantized_points_host(m);
+}
+
+void mesh_skin_host(uint64_t id, const wp::vec3* rest_points, const wp::transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, wp::transform* xform)
+{
+    Mesh* m = (Mesh*)(id);
+
+    for (int i=0; i < m->num_points; ++i)
+        m->points.data[i] = mesh_skin_point(rest_points[i], i, bones, bone_indices, bone_weights, bones_per_point, *xform);
+
+    // the average edge length is kept from the last full refit, skinning only changes it marginally
+    for (int i=0; i < m->num_tris; ++i)
     {
-        // If solid angle were used, use refit solid angle
-        bvh_refit_with_solid_angle_host(m->bvh, *m);
+        m->bounds[i] = bounds3();
+        m->bounds[i].add_point(m->points.data[m->indices.data[i*3+0]]);
+        m->bounds[i].add_point(m->points.data[m->indices.data[i*3+1]]);
+        m->bounds[i].add_point(m->points.data[m->indices.data[i*3+2]]);
     }
-    else
+
+    bvh_refit_host(m->bvh, m->bounds);
+    m->solid_angle_valid = 0;
+
+    if (m->quantized_points)
+        mesh_update_quantized_points_host(m);
+}
+
+void mesh_refit_solid_angle_host(uint64_t id)
+{
+    Mesh* m = (Mesh*)(id);
+
+    if (!m->solid_angle_props || m->solid_angle_valid)
+        return;
+
+    // the node bounds of the solid angle data match the ones of the last refit
+    bvh_refit_with_solid_angle_host(m->bvh, *m);
+    m->solid_angle_valid = 1;
+}
+
+void mesh_refit_partial_host(uint64_t id, const int* dirty_tris, int num_dirty)
+{
+    Mesh* m = (Mesh*)(id);
+    BVH& bvh = m->bvh;
+
+    // moved vertices may leave the bounds the points were quantized to
+    if (m->quantized_points)
     {
-        bvh_refit_host(m->bvh, m->bounds);
+        mesh_refit_host(id);
+        return;
     }
+
+    if (!m->tri_nodes)
+    {
+        m->tri_nodes = new int[m->num_tris];
+
+        for (int i=0; i < bvh.num_nodes; ++i)
+            if (bvh.node_lowers[i].b)
+                m->tri_nodes[bvh.node_lowers[i].i] = i;
+    }
+
+    // valid solid angle data is updated along with the dirty triangles, stale data is recomputed on demand
+    SolidAngleProps* solid_angle_props = m->solid_angle_valid ? m->solid_angle_props : NULL;
+
+    for (int d=0; d < num_dirty; ++d)
+    {
+        const int tri = dirty_tris[d];
+        const int leaf = m->tri_nodes[tri];
+
+        wp::vec3 p0 = m->points.data[m->indices.data[tri*3+0]];
+        wp::vec3 p1 = m->points.data[m->indices.data[tri*3+1]];
+        wp::vec3 p2 = m->points.data[m->indices.data[tri*3+2]];
+
+        m->bounds[tri] = bounds3();
+        m->bounds[tri].add_point(p0);
+        m->bounds[tri].add_point(p1);
+        m->bounds[tri].add_point(p2);
+
+        if (solid_angle_props)
+        {
+            precompute_triangle_solid_angle_props(p0, p1, p2, solid_angle_props[leaf]);
+            (vec3&)bvh.node_lowers[leaf] = solid_angle_props[leaf].box.lower;
+            (vec3&)bvh.node_uppers[leaf] = solid_angle_props[leaf].box.upper;
+        }
+        else
+        {
+            (vec3&)bvh.node_lowers[leaf] = m->bounds[tri].lower;
+            (vec3&)bvh.node_uppers[leaf] = m->bounds[tri].upper;
+        }
+
+        // ancestors are recomputed from their current children, so shared ones end up
+        // correct once the last dirty leaf below them has been processed
+        for (int index = bvh.node_parents[leaf]; index != -1; index = bvh.node_parents[index])
+        {
+            const int left_index = bvh.node_lowers[index].i;
+            const int right_index = bvh.node_uppers[index].i;
+
+            if (solid_angle_props)
+            {
+                SolidAngleProps* left_child_data = &solid_angle_props[left_index];
+                SolidAngleProps* right_child_data = (left_index != right_index) ? &solid_angle_props[right_index] : NULL;
+
+                combine_precomputed_solid_angle_props(solid_angle_props[index], left_child_data, right_child_data);
+            }
+
+            (vec3&)bvh.node_lowers[index] = min((vec3&)bvh.node_lowers[left_index], (vec3&)bvh.node_lowers[right_index]);
+            (vec3&)bvh.node_uppers[index] = max((vec3&)bvh.node_uppers[left_index], (vec3&)bvh.node_uppers[right_index]);
+        }
+    }
+
+    if (bvh.wide_nodes)
+        bvh_refit_wide_host(bvh);
+}
+
+void mesh_raycast_batch_host(uint64_t id, wp::vec3* origins, wp::vec3* dirs, int num_rays, float max_t, float* out_t, int* out_face, wp::vec2* out_uv, wp::vec3* out_normal, int sort_rays)
+{
+    // rays are traced in order, sorting only pays off for SIMT traversal
+    for (int i=0; i < num_rays; ++i)
+        mesh_raycast_batch_ray(id, origins, dirs, i, max_t, out_t, out_face, out_uv, out_normal);
+}
+
+void mesh_query_point_batch_host(uint64_t id, wp::vec3* points, int num_points, float max_dist, int* out_face, wp::vec2* out_uv, float* out_dist, int sort_points)
+{
+    const Mesh& mesh = *(const Mesh*)(id);
+
+    // points are queried in order, sorting only pays off for SIMT traversal
+    for (int i=0; i < num_points; ++i)
+    {
+        int face;
+        float u, v;
+        const bool found = mesh_query_point_no_sign(id, points[i], max_dist, face, u, v);
+
+        // distances are measured to the triangles the query saw, which are decoded for quantized meshes
+        float dist_sq = 0.0f;
+        if (found)
+        {
+            const vec3 p = mesh_point(mesh, mesh.indices[face*3+0]);
+            const vec3 q = mesh_point(mesh, mesh.indices[face*3+1]);
+            const vec3 r = mesh_point(mesh, mesh.indices[face*3+2]);
+
+            dist_sq = length_sq(u*p + v*q + (1.0f-u-v)*r - points[i]);
+        }
+
+        mesh_query_point_batch_write(i, found, face, u, v, dist_sq, out_face, out_uv, out_dist);
+    }
+}
+
+void mesh_query_mesh_overlap_host(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    // leaves of the mesh BVHs hold one triangle each
+    bvh_query_bvh_overlap_host(((Mesh*)id_a)->bvh, ((Mesh*)id_b)->bvh, *xform, margin, pairs, max_pairs, pair_count);
+}
+
+void mesh_query_bvh_overlap_host(uint64_t mesh_id, uint64_t bvh_id, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_bvh_overlap_host(((Mesh*)mesh_id)->bvh, *(BVH*)bvh_id, *xform, margin, pairs, max_pairs, pair_count);
+}
+
+void mesh_query_self_overlap_host(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    bvh_query_self_overlap_host(((Mesh*)id)->bvh, margin, pairs, max_pairs, pair_count);
+}
+
+void mesh_query_mesh_intersections_host(uint64_t id_a, uint64_t id_b, wp::transform* xform, wp::vec2i* pairs, wp::vec3* segments, int max_pairs, int* pair_count)
+{
+    const Mesh& a = *(const Mesh*)id_a;
+    const Mesh& b = *(const Mesh*)id_b;
+
+    // candidate pairs of overlapping triangle bounds, the query is repeated with the exact
+    // capacity when the first guess is too small
+    std::vector<vec2i> candidates(std::max(a.num_tris + b.num_tris, 1));
+
+    int num_candidates = 0;
+    bvh_query_bvh_overlap_host(a.bvh, b.bvh, *xform, 0.0f, candidates.data(), int(candidates.size()), &num_candidates);
+
+    if (num_candidates > int(candidates.size()))
+    {
+        candidates.resize(num_candidates);
+        bvh_query_bvh_overlap_host(a.bvh, b.bvh, *xform, 0.0f, candidates.data(), int(candidates.size()), &num_candidates);
+    }
+
+    int count = 0;
+    for (int i=0; i < num_candidates; ++i)
+    {
+        vec3 s0, s1;
+        if (mesh_intersect_tri_pair(a, b, *xform, candidates[i], s0, s1))
+            mesh_intersection_write(count++, candidates[i], s0, s1, pairs, segments, max_pairs);
+    }
+
+    *pair_count = count;
 }
 
 
 // stubs for non-CUDA platforms
 #if !WP_ENABLE_CUDA
 
+uint64_t mesh_create_device(void* context, array_t<wp::vec3> points, array_t<wp::vec3> velocities, array_t<int> indices, int num_points, int num_tris, int support_winding_number)
+{
+    return 0;
+}
+
+void mesh_create_batch_device(void* context, wp::vec3* points, wp::vec3* velocities, int* indices, const int* point_offsets, const int* tri_offsets, int num_meshes, int support_winding_number, uint64_t* ids)
+{
+}
+
 void mesh_refit_device(uint64_t id)
 {
 }
 
+void mesh_skin_device(uint64_t id, const wp::vec3* rest_points, const wp::transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, wp::transform* xform)
+{
+}
+
+void mesh_build_wide_device(uint64_t id)
+{
+}
+
+void mesh_quantize_device(uint64_t id)
+{
+}
+
+void mesh_reorder_device(uint64_t id, int* tri_permutation, int* point_permutation)
+{
+}
+
+void mesh_refit_partial_device(uint64_t id, const int* dirty_tris, int num_dirty)
+{
+}
+
+void mesh_refit_solid_angle_device(uint64_t id)
+{
+}
+
+void mesh_build_refit_levels_device(uint64_t id)
+{
+}
+
+void mesh_raycast_batch_device(uint64_t id, wp::vec3* origins, wp::vec3* dirs, int num_rays, float max_t, float* out_t, int* out_face, wp::vec2* out_uv, wp::vec3* out_normal, int sort_rays)
+{
+}
+
+void mesh_query_point_batch_device(uint64_t id, wp::vec3* points, int num_points, float max_dist, int* out_face, wp::vec2* out_uv, float* out_dist, int sort_points)
+{
+}
+
+void mesh_query_mesh_overlap_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+}
+
+void mesh_query_bvh_overlap_device(uint64_t mesh_id, uint64_t bvh_id, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+}
+
+void mesh_query_self_overlap_device(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+}
+
+void mesh_query_mesh_intersections_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, wp::vec2i* pairs, wp::vec3* segments, int max_pairs, int* pair_count)
+{
+}
+
 
 #endif // !WP_ENABLE_CUDA
\ No newline at end of file
@@ -11,11 +11,15 @@
 #include "mesh.h"
 #include "bvh.h"
 #include "scan.h"
+#include "sort.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace wp
 {
 
-__global__ void compute_triangle_bounds(int n, const vec3* points, const int* indices, bounds3* b)
+__global__ void compute_triangle_bounds(int n, const vec3* points, const uint16_t* quantized_points, const vec3* quantized_frame, const int* indices, bounds3* b)
 {
     const int tid = blockIdx.x*blockDim.x + threadIdx.x;
 
@@ -26,9 +30,9 @@ __global__ void compute_triangle_bounds(int n, const vec3* points, const int* in
         int j = indices[tid*3+1];
         int k = indices[tid*3+2];
 
-        vec3 p = points[i];
-        vec3 q = points[j];
-        vec3 r = points[k];
+        vec3 p = mesh_point(points, quantized_points, quantized_frame, i);
+        vec3 q = mesh_point(points, quantized_points, quantized_frame, j);
+        vec3 r = mesh_point(points, quantized_points, quantized_frame, k);
 
         vec3 lower = min(min(p, q), r);
         vec3 upper = max(max(p, q), r);
@@ -62,7 +66,7 @@ __global__ void compute_average_mesh_edge_length(int n, float* sum_edge_lengths,
     m->average_edge_length = sum_edge_lengths[n - 1] / (3*n);
 }
 
-__global__ void bvh_refit_with_solid_angle_kernel(int n, const int* __restrict__ parents, int* __restrict__ child_count, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const vec3* points, const int* indices, SolidAngleProps* solid_angle_props)
+__global__ void bvh_refit_with_solid_angle_kernel(int n, const int* __restrict__ parents, int* __restrict__ child_count, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const vec3* points, const uint16_t* quantized_points, const vec3* quantized_frame, const int* indices, SolidAngleProps* solid_angle_props)
 {
     int index = blockDim.x*blockIdx.x + threadIdx.x;
 
@@ -74,7 +78,9 @@ __global__ void bvh_refit_with_solid_angle_kernel(int n, const int* __restrict__
         {
             // update the leaf node
             const int leaf_index = lowers[index].i;        
-            precompute_triangle_solid_angle_props(points[indices[leaf_index*3+0]], points[indices[leaf_index*3+1]], points[indices[leaf_index*3+2]], solid_angle_props[index]);        
+            precompute_triangle_solid_angle_props(mesh_point(points, quantized_points, quantized_frame, indices[leaf_index*3+0]),
+                                                  mesh_point(points, quantized_points, quantized_frame, indices[leaf_index*3+1]),
+                                                  mesh_point(points, quantized_points, quantized_frame, indices[leaf_index*3+2]), solid_angle_props[index]);
 
             make_node(lowers+index, solid_angle_props[index].box.lower, leaf_index, true);
             make_node(uppers+index, solid_angle_props[index].box.upper, 0, false);
@@ -151,17 +157,609 @@ __global__ void bvh_refit_with_solid_angle_kernel(int n, const int* __restrict__
 }
 
 
+__global__ void bvh_refit_with_solid_angle_leaves_kernel(int n, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, const vec3* points, const uint16_t* quantized_points, const vec3* quantized_frame, const int* indices, SolidAngleProps* solid_angle_props)
+{
+    int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n && lowers[index].b)
+    {
+        const int leaf_index = lowers[index].i;
+        precompute_triangle_solid_angle_props(mesh_point(points, quantized_points, quantized_frame, indices[leaf_index*3+0]),
+                                              mesh_point(points, quantized_points, quantized_frame, indices[leaf_index*3+1]),
+                                              mesh_point(points, quantized_points, quantized_frame, indices[leaf_index*3+2]), solid_angle_props[index]);
+
+        make_node(lowers+index, solid_angle_props[index].box.lower, leaf_index, true);
+        make_node(uppers+index, solid_angle_props[index].box.upper, 0, false);
+    }
+}
+
+// one thread per internal node of a single level, see bvh_refit_level_kernel()
+__global__ void bvh_refit_with_solid_angle_level_kernel(int n, const int* __restrict__ nodes, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, SolidAngleProps* solid_angle_props)
+{
+    int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        const int node = nodes[index];
+
+        const int left_child = lowers[node].i;
+        const int right_child = uppers[node].i;
+
+        const BVHPackedNodeHalf left_lower = lowers[left_child];
+        const BVHPackedNodeHalf left_upper = uppers[left_child];
+        const BVHPackedNodeHalf right_lower = lowers[right_child];
+        const BVHPackedNodeHalf right_upper = uppers[right_child];
+
+        vec3 lower = min(vec3(left_lower.x, left_lower.y, left_lower.z), vec3(right_lower.x, right_lower.y, right_lower.z));
+        vec3 upper = max(vec3(left_upper.x, left_upper.y, left_upper.z), vec3(right_upper.x, right_upper.y, right_upper.z));
+
+        make_node(lowers+node, lower, left_child, false);
+        make_node(uppers+node, upper, right_child, false);
+
+        SolidAngleProps* left_child_data = &solid_angle_props[left_child];
+        SolidAngleProps* right_child_data = (left_child != right_child) ? &solid_angle_props[right_child] : NULL;
+
+        combine_precomputed_solid_angle_props(solid_angle_props[node], left_child_data, right_child_data);
+    }
+}
+
 void bvh_refit_with_solid_angle_device(BVH& bvh, Mesh& mesh)
 {
     ContextGuard guard(bvh.context);
 
-    // clear child counters
-    memset_device(WP_CURRENT_CONTEXT, bvh.node_counts, 0, sizeof(int)*bvh.max_nodes);
+    if (bvh.level_nodes)
+    {
+        wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_with_solid_angle_leaves_kernel, bvh.num_nodes, (bvh.num_nodes, bvh.node_lowers, bvh.node_uppers, mesh.points, mesh.quantized_points, mesh.quantized_frame, mesh.indices, mesh.solid_angle_props));
+
+        for (int level=bvh.num_levels-1; level >= 0; --level)
+        {
+            const int start = bvh.level_offsets[level];
+            const int count = bvh.level_offsets[level+1] - start;
+
+            wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_with_solid_angle_level_kernel, count, (count, bvh.level_nodes + start, bvh.node_lowers, bvh.node_uppers, mesh.solid_angle_props));
+        }
+    }
+    else
+    {
+        // clear child counters
+        memset_device(WP_CURRENT_CONTEXT, bvh.node_counts, 0, sizeof(int)*bvh.max_nodes);
+
+        wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_with_solid_angle_kernel, bvh.max_nodes, (bvh.max_nodes, bvh.node_parents, bvh.node_counts, bvh.node_lowers, bvh.node_uppers, mesh.points, mesh.quantized_points, mesh.quantized_frame, mesh.indices, mesh.solid_angle_props));
+    }
+
+    if (bvh.wide_nodes)
+        bvh_refit_wide_device(bvh);
+}
+
+// frame of the quantized positions from the root bounds of the last refit
+__global__ void mesh_compute_quantized_frame(BVH bvh, vec3* quantized_frame)
+{
+    const BVHPackedNodeHalf lower = bvh.node_lowers[bvh.root];
+    const BVHPackedNodeHalf upper = bvh.node_uppers[bvh.root];
+
+    quantized_frame[0] = vec3(lower.x, lower.y, lower.z);
+    quantized_frame[1] = (vec3(upper.x, upper.y, upper.z) - quantized_frame[0])/65535.0f;
+}
+
+__global__ void mesh_quantize_points(int n, const vec3* points, const vec3* quantized_frame, uint16_t* quantized_points)
+{
+    const int tid = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (tid < n)
+        mesh_quantize_point(points[tid], quantized_frame, quantized_points + tid*3);
+}
+
+// quantizes the points relative to the bounds of the last refit, then refits the BVH to the
+// decoded triangles so that the node bounds stay conservative for the queries
+void mesh_update_quantized_points_device(Mesh& m)
+{
+    if (m.bvh.num_nodes == 0)
+        return;
+
+    wp_launch_device(WP_CURRENT_CONTEXT, mesh_compute_quantized_frame, 1, (m.bvh, m.quantized_frame));
+    wp_launch_device(WP_CURRENT_CONTEXT, mesh_quantize_points, m.num_points, (m.num_points, m.points, m.quantized_frame, m.quantized_points));
+    wp_launch_device(WP_CURRENT_CONTEXT, compute_triangle_bounds, m.num_tris, (m.num_tris, m.points, m.quantized_points, m.quantized_frame, m.indices, m.bounds));
+
+    bvh_refit_device(m.bvh, m.bounds);
+}
+
+__global__ void mesh_compute_tri_nodes(int n, const BVHPackedNodeHalf* __restrict__ lowers, int* tri_nodes)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n && lowers[index].b)
+        tri_nodes[lowers[index].i] = index;
+}
+
+__global__ void mesh_skin_kernel(int n, const vec3* rest_points, const transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, transform xform, vec3* points)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < n)
+        points[tid] = mesh_skin_point(rest_points[tid], tid, bones, bone_indices, bone_weights, bones_per_point, xform);
+}
+
+// updates the dirty leaves and counts how many threads arrive at each dirty ancestor,
+// only the first thread to reach a node continues upwards
+__global__ void mesh_refit_partial_leaves(int n, const int* __restrict__ dirty_tris, const vec3* points, const int* indices, const int* __restrict__ tri_nodes, const int* __restrict__ parents,
+                                          int* __restrict__ counts, bounds3* bounds, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, SolidAngleProps* solid_angle_props)
+{
+    const int tid = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        const int tri = dirty_tris[tid];
+        const int leaf = tri_nodes[tri];
+
+        const vec3 p0 = points[indices[tri*3+0]];
+        const vec3 p1 = points[indices[tri*3+1]];
+        const vec3 p2 = points[indices[tri*3+2]];
+
+        bounds3 b;
+        b.add_point(p0);
+        b.add_point(p1);
+        b.add_point(p2);
+
+        bounds[tri] = b;
+
+        if (solid_angle_props)
+        {
+            precompute_triangle_solid_angle_props(p0, p1, p2, solid_angle_props[leaf]);
+            b = solid_angle_props[leaf].box;
+        }
+
+        make_node(lowers+leaf, b.lower, tri, true);
+        make_node(uppers+leaf, b.upper, 0, false);
+
+        for (int index = leaf;;)
+        {
+            const int parent = parents[index];
+
+            if (parent == -1 || atomicAdd(&counts[parent], 1) != 0)
+                break;
+
+            index = parent;
+        }
+    }
+}
+
+// the same threads walk up again, the last arrival at a node recomputes it, which
+// also returns the counters to zero
+__global__ void mesh_refit_partial_hierarchy(int n, const int* __restrict__ dirty_tris, const int* __restrict__ tri_nodes, const int* __restrict__ parents,
+                                             int* __restrict__ counts, BVHPackedNodeHalf* __restrict__ lowers, BVHPackedNodeHalf* __restrict__ uppers, SolidAngleProps* solid_angle_props)
+{
+    const int tid = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        int index = tri_nodes[dirty_tris[tid]];
+
+        for (;;)
+        {
+            const int parent = parents[index];
+
+            if (parent == -1)
+                return;
+
+            // ensure all writes are visible
+            __threadfence();
+
+            if (atomicSub(&counts[parent], 1) != 1)
+                return;
+
+            const int left_child = lowers[parent].i;
+            const int right_child = uppers[parent].i;
+
+            const BVHPackedNodeHalf left_lower = lowers[left_child];
+            const BVHPackedNodeHalf left_upper = uppers[left_child];
+            const BVHPackedNodeHalf right_lower = lowers[right_child];
+            const BVHPackedNodeHalf right_upper = uppers[right_child];
+
+            vec3 lower = min(vec3(left_lower.x, left_lower.y, left_lower.z), vec3(right_lower.x, right_lower.y, right_lower.z));
+            vec3 upper = max(vec3(left_upper.x, left_upper.y, left_upper.z), vec3(right_upper.x, right_upper.y, right_upper.z));
+
+            make_node(lowers+parent, lower, left_child, false);
+            make_node(uppers+parent, upper, right_child, false);
+
+            if (solid_angle_props)
+            {
+                SolidAngleProps* left_child_data = &solid_angle_props[left_child];
+                SolidAngleProps* right_child_data = (left_child != right_child) ? &solid_angle_props[right_child] : NULL;
+
+                combine_precomputed_solid_angle_props(solid_angle_props[parent], left_child_data, right_child_data);
+            }
+
+            index = parent;
+        }
+    }
+}
+
+// sort key that groups rays by direction octant, then by the Morton code of their origin
+__global__ void mesh_raycast_sort_keys(uint64_t id, const vec3* origins, const vec3* dirs, int n, int* keys, int* indices)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        Mesh mesh = mesh_get(id);
+        bounds3 b = bvh_get_node_bounds(mesh.bvh, mesh.bvh.root);
+
+        const vec3 o = origins[tid];
+        const vec3 d = dirs[tid];
+        const vec3 e = max(b.edges(), vec3(1.e-6f));
+
+        // origins outside the mesh bounds are clamped to the boundary cells
+        const vec3 p = cw_div(o - b.lower, e);
+        const int octant = (d[0] < 0.0f) | ((d[1] < 0.0f) << 1) | ((d[2] < 0.0f) << 2);
+
+        keys[tid] = (octant << 27) | int(morton3<512>(p[0], p[1], p[2]));
+        indices[tid] = tid;
+    }
+}
+
+// persistent threads, each warp repeatedly fetches the next batch of 32
+// (sorted) rays until all are traced so that no warp idles on a slow batch
+__global__ void mesh_raycast_batch_kernel(uint64_t id, const vec3* origins, const vec3* dirs, const int* order, int num_rays, float max_t,
+                                          int* next_ray, float* out_t, int* out_face, vec2* out_uv, vec3* out_normal)
+{
+    const int lane = threadIdx.x & 31;
+
+    for (;;)
+    {
+        int base = 0;
+        if (lane == 0)
+            base = atomicAdd(next_ray, 32);
+
+        base = __shfl_sync(0xffffffff, base, 0);
+
+        if (base >= num_rays)
+            return;
+
+        const int i = base + lane;
+        if (i < num_rays)
+            mesh_raycast_batch_ray(id, origins, dirs, order ? order[i] : i, max_t, out_t, out_face, out_uv, out_normal);
+    }
+}
+
+// sort key of the Morton code of a point within the mesh bounds
+__global__ void mesh_query_point_sort_keys(uint64_t id, const vec3* points, int n, int* keys, int* indices)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        Mesh mesh = mesh_get(id);
+        bounds3 b = bvh_get_node_bounds(mesh.bvh, mesh.bvh.root);
+
+        // points outside the mesh bounds are clamped to the boundary cells
+        const vec3 e = max(b.edges(), vec3(1.e-6f));
+        const vec3 p = cw_div(points[tid] - b.lower, e);
+
+        keys[tid] = int(morton3<1024>(p[0], p[1], p[2]));
+        indices[tid] = tid;
+    }
+}
+
+// closest point queries where the 32 (sorted) points of a warp traverse the BVH together, the
+// traversal state is warp-uniform so node fetches are broadcast to all lanes, a node is only
+// culled once it is further than the current closest face of every lane
+__global__ void mesh_query_point_batch_kernel(uint64_t id, const vec3* points, const int* order, int num_points, float max_dist,
+                                              int* out_face, vec2* out_uv, float* out_dist)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    // lanes past the end follow the traversal of their warp without results
+    if ((tid & ~31) >= num_points)
+        return;
+
+    const bool active = tid < num_points;
+    const int i = active ? (order ? order[tid] : tid) : 0;
+    const vec3 point = points[i];
+
+    Mesh mesh = mesh_get(id);
+
+    float min_dist_sq = active ? max_dist*max_dist : -1.0f;
+    int min_face = -1;
+    float min_v = 0.0f;
+    float min_w = 0.0f;
+
+    if (mesh.bvh.num_nodes > 0)
+    {
+        bvh_stack_t stack;
+        stack.init(mesh.bvh.root);
+
+        int node_index;
+        while ((node_index = stack.pop(mesh.bvh)) >= 0)
+        {
+            BVHPackedNodeHalf lower = mesh.bvh.node_lowers[node_index];
+            BVHPackedNodeHalf upper = mesh.bvh.node_uppers[node_index];
+
+            const float node_dist_sq = distance_to_aabb_sq(point, vec3(lower.x, lower.y, lower.z), vec3(upper.x, upper.y, upper.z));
+            if (__all_sync(0xffffffff, node_dist_sq > min_dist_sq))
+                continue;
+
+            const int left_index = lower.i;
+            const int right_index = upper.i;
+
+            if (lower.b)
+            {
+                vec3 p = mesh_point(mesh, mesh.indices[left_index*3+0]);
+                vec3 q = mesh_point(mesh, mesh.indices[left_index*3+1]);
+                vec3 r = mesh_point(mesh, mesh.indices[left_index*3+2]);
+
+                vec3 e0 = q-p;
+                vec3 e1 = r-p;
+                vec3 e2 = r-q;
+
+                // sliver detection, the same for all lanes
+                if (length(cross(e0, e1))/(dot(e0,e0) + dot(e1,e1) + dot(e2,e2)) < 1.e-6f)
+                    continue;
+
+                vec2 barycentric = closest_point_to_triangle(p, q, r, point);
+                float u = barycentric[0];
+                float v = barycentric[1];
+                float w = 1.f - u - v;
+
+                float dist_sq = length_sq(u*p + v*q + w*r - point);
+                if (dist_sq < min_dist_sq)
+                {
+                    min_dist_sq = dist_sq;
+                    min_v = v;
+                    min_w = w;
+                    min_face = left_index;
+                }
+            }
+            else
+            {
+                BVHPackedNodeHalf left_lower = mesh.bvh.node_lowers[left_index];
+                BVHPackedNodeHalf left_upper = mesh.bvh.node_uppers[left_index];
+
+                BVHPackedNodeHalf right_lower = mesh.bvh.node_lowers[right_index];
+                BVHPackedNodeHalf right_upper = mesh.bvh.node_uppers[right_index];
+
+                float left_dist_sq = distance_to_aabb_sq(point, vec3(left_lower.x, left_lower.y, left_lower.z), vec3(left_upper.x, left_upper.y, left_upper.z));
+                float right_dist_sq = distance_to_aabb_sq(point, vec3(right_lower.x, right_lower.y, right_lower.z), vec3(right_upper.x, right_upper.y, right_upper.z));
+
+                const bool visit = left_dist_sq < min_dist_sq || right_dist_sq < min_dist_sq;
+                const unsigned int visit_mask = __ballot_sync(0xffffffff, visit);
+
+                // visit the child that is nearest for most of the lanes first
+                if (visit_mask)
+                {
+                    const unsigned int left_mask = __ballot_sync(0xffffffff, visit && left_dist_sq < right_dist_sq);
+                    stack.push(mesh.bvh, left_index, right_index, 2*__popc(left_mask) > __popc(visit_mask));
+                }
+            }
+        }
+    }
+
+    if (active)
+    {
+        const bool found = min_face >= 0;
+        mesh_query_point_batch_write(i, found, min_face, 1.0f - min_v - min_w, min_v, min_dist_sq, out_face, out_uv, out_dist);
+    }
+}
+
+// the LBVH stores its leaves in Morton order after the n-1 internal nodes, leaf i receives triangle i
+__global__ void mesh_reorder_triangles(int n, BVHPackedNodeHalf* __restrict__ lowers, const int* __restrict__ indices, const bounds3* __restrict__ bounds,
+                                       int* __restrict__ new_indices, bounds3* __restrict__ new_bounds, int* __restrict__ permutation)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        const int leaf = n - 1 + index;
+        const int t = lowers[leaf].i;
+
+        new_indices[index*3+0] = indices[t*3+0];
+        new_indices[index*3+1] = indices[t*3+1];
+        new_indices[index*3+2] = indices[t*3+2];
+        new_bounds[index] = bounds[t];
+
+        permutation[index] = t;
+        lowers[leaf].i = index;
+    }
+}
+
+__global__ void mesh_init_first_use(int n, int unused_key, int* keys, int* values)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        keys[index] = unused_key;
+        values[index] = index;
+    }
+}
+
+__global__ void mesh_compute_first_use(int n, const int* __restrict__ indices, int* keys)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+        atomicMin(keys + indices[index], index/3);
+}
+
+__global__ void mesh_reorder_points(int n, const int* __restrict__ permutation, const vec3* __restrict__ points, const vec3* __restrict__ velocities,
+                                    vec3* __restrict__ new_points, vec3* __restrict__ new_velocities, int* __restrict__ remap)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+    {
+        const int p = permutation[index];
+
+        remap[p] = index;
+        new_points[index] = points[p];
+        if (velocities)
+            new_velocities[index] = velocities[p];
+    }
+}
+
+__global__ void mesh_remap_indices(int n, const int* __restrict__ remap, int* indices)
+{
+    const int index = blockDim.x*blockIdx.x + threadIdx.x;
+
+    if (index < n)
+        indices[index] = remap[indices[index]];
+}
+
+// narrow phase of the candidate pairs of a dual BVH traversal, intersecting pairs are compacted
+// with a single atomic per warp
+__global__ void mesh_intersect_kernel(Mesh a, Mesh b, transform xform, const vec2i* candidates, int n, vec2i* pairs, vec3* segments, int max_pairs, int* pair_count)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        const vec2i pair = candidates[tid];
+
+        vec3 s0, s1;
+        if (mesh_intersect_tri_pair(a, b, xform, pair, s0, s1))
+            mesh_intersection_write(atomic_add_aggregate(pair_count, 1), pair, s0, s1, pairs, segments, max_pairs);
+    }
+}
+
+// triangles of a batch of meshes, the indices of each mesh refer to its own range of points
+__global__ void compute_batch_triangle_bounds(int n, int num_meshes, const int* tri_offsets, const int* point_offsets, const vec3* points, const int* indices, bounds3* b, float* edge_lengths)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        const int mesh = bvh_batch_find(tri_offsets, num_meshes, 1, 0, tid);
+        const vec3* mesh_points = points + point_offsets[mesh];
+
+        vec3 p = mesh_points[indices[tid*3+0]];
+        vec3 q = mesh_points[indices[tid*3+1]];
+        vec3 r = mesh_points[indices[tid*3+2]];
+
+        b[tid] = bounds3(min(min(p, q), r), max(max(p, q), r));
+        edge_lengths[tid] = length(p-q) + length(p-r) + length(q-r);
+    }
+}
+
+__global__ void compute_batch_average_edge_lengths(int n, const int* tri_offsets, const float* sum_edge_lengths, Mesh* meshes)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
 
-    wp_launch_device(WP_CURRENT_CONTEXT, bvh_refit_with_solid_angle_kernel, bvh.max_nodes, (bvh.max_nodes, bvh.node_parents, bvh.node_counts, bvh.node_lowers, bvh.node_uppers, mesh.points, mesh.indices, mesh.solid_angle_props));
+    if (tid < n)
+        meshes[tid].average_edge_length = sum_edge_lengths[tid] / (3*(tri_offsets[tid+1] - tri_offsets[tid]));
 }
+
 } // namespace wp
 
+uint64_t mesh_create_device(void* context, wp::array_t<wp::vec3> points, wp::array_t<wp::vec3> velocities, wp::array_t<int> indices, int num_points, int num_tris, int support_winding_number)
+{
+    ContextGuard guard(context);
+
+    wp::Mesh mesh(points, velocities, indices, num_points, num_tris);
+
+    mesh.context = context ? context : cuda_context_get_current();
+
+    // triangle bounds are kept on the device for refits
+    mesh.bounds = (wp::bounds3*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::bounds3)*num_tris);
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_triangle_bounds, num_tris, (num_tris, mesh.points, NULL, NULL, mesh.indices, mesh.bounds));
+
+    mesh.bvh = wp::bvh_create_device(WP_CURRENT_CONTEXT, mesh.bounds, num_tris);
+
+    // the solid angle data is computed by the first mesh_refit_solid_angle_device()
+    if (support_winding_number)
+    {
+        int num_bvh_nodes = 2*num_tris-1;
+        mesh.solid_angle_props = (wp::SolidAngleProps*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::SolidAngleProps)*num_bvh_nodes);
+    }
+
+    wp::Mesh* mesh_device = (wp::Mesh*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::Mesh));
+    memcpy_h2d(WP_CURRENT_CONTEXT, mesh_device, &mesh, sizeof(wp::Mesh));
+
+    // save descriptor
+    uint64_t mesh_id = (uint64_t)mesh_device;
+    mesh_add_descriptor(mesh_id, mesh);
+
+    // computes the average edge length on the device
+    mesh_refit_device(mesh_id);
+
+    return mesh_id;
+}
+
+void mesh_create_batch_device(void* context, wp::vec3* points, wp::vec3* velocities, int* indices, const int* point_offsets, const int* tri_offsets, int num_meshes, int support_winding_number, uint64_t* ids)
+{
+    ContextGuard guard(context);
+
+    context = context ? context : cuda_context_get_current();
+
+    const int num_tris = tri_offsets[num_meshes];
+    const int num_nodes = 2*num_tris - num_meshes;
+
+    auto align = [](size_t size) { return (size + 255) & ~size_t(255); };
+
+    // the descriptors, triangle bounds and solid angle data of all meshes share one allocation,
+    // the BVH nodes another one
+    const size_t meshes_size = align(sizeof(wp::Mesh)*num_meshes);
+    const size_t bounds_size = align(sizeof(wp::bounds3)*num_tris);
+    const size_t solid_angle_size = support_winding_number ? sizeof(wp::SolidAngleProps)*num_nodes : 0;
+
+    char* pool = (char*)alloc_device(WP_CURRENT_CONTEXT, meshes_size + bounds_size + solid_angle_size);
+
+    wp::Mesh* meshes_device = (wp::Mesh*)pool;
+    wp::bounds3* bounds = (wp::bounds3*)(pool + meshes_size);
+    wp::SolidAngleProps* solid_angle_props = support_winding_number ? (wp::SolidAngleProps*)(pool + meshes_size + bounds_size) : NULL;
+
+    int* tri_offsets_device = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*2*(num_meshes+1));
+    int* point_offsets_device = tri_offsets_device + num_meshes + 1;
+    memcpy_h2d(WP_CURRENT_CONTEXT, tri_offsets_device, (void*)tri_offsets, sizeof(int)*(num_meshes+1));
+    memcpy_h2d(WP_CURRENT_CONTEXT, point_offsets_device, (void*)point_offsets, sizeof(int)*(num_meshes+1));
+
+    float* edge_lengths = (float*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(float)*(num_tris + num_meshes));
+    float* sum_edge_lengths = edge_lengths + num_tris;
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_batch_triangle_bounds, num_tris, (num_tris, num_meshes, tri_offsets_device, point_offsets_device, points, indices, bounds, edge_lengths));
+    segmented_reduce_float_device((uint64_t)edge_lengths, (uint64_t)sum_edge_lengths, (uint64_t)tri_offsets_device, num_meshes, WP_SEGMENTED_REDUCE_SUM);
+
+    std::vector<wp::BVH> bvhs(num_meshes);
+    void* node_pool = wp::bvh_create_batch_device(WP_CURRENT_CONTEXT, bounds, tri_offsets_device, tri_offsets, num_meshes, bvhs.data());
+
+    std::vector<wp::Mesh> meshes(num_meshes);
+    for (int i=0; i < num_meshes; ++i)
+    {
+        const int p = point_offsets[i];
+        const int t = tri_offsets[i];
+        const int num_points = point_offsets[i+1] - p;
+
+        wp::Mesh& mesh = meshes[i];
+        mesh = wp::Mesh(
+            wp::array_t<wp::vec3>(points + p, num_points),
+            wp::array_t<wp::vec3>(velocities ? velocities + p : NULL, velocities ? num_points : 0),
+            wp::array_t<int>(indices + 3*t, 3*(tri_offsets[i+1] - t)),
+            num_points,
+            tri_offsets[i+1] - t,
+            context);
+
+        mesh.bounds = bounds + t;
+        mesh.bvh = bvhs[i];
+
+        // the solid angle data is computed by the first mesh_refit_solid_angle_device()
+        if (solid_angle_props)
+            mesh.solid_angle_props = solid_angle_props + 2*t - i;
+    }
+
+    memcpy_h2d(WP_CURRENT_CONTEXT, meshes_device, meshes.data(), sizeof(wp::Mesh)*num_meshes);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_batch_average_edge_lengths, num_meshes, (num_meshes, tri_offsets_device, sum_edge_lengths, meshes_device));
+
+    free_temp_device(WP_CURRENT_CONTEXT, edge_lengths);
+    free_temp_device(WP_CURRENT_CONTEXT, tri_offsets_device);
+
+    for (int i=0; i < num_meshes; ++i)
+    {
+        ids[i] = (uint64_t)(meshes_device + i);
+        mesh_add_descriptor(ids[i], meshes[i]);
+    }
+
+    wp::mesh_add_batch(ids, num_meshes, context, pool, node_pool);
+}
+
 void mesh_refit_device(uint64_t id)
 {
 
@@ -182,16 +780,364 @@ void mesh_refit_device(uint64_t id)
         scan_device(length_tmp_ptr, length_tmp_ptr, m.num_tris, true);
             
         wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_average_mesh_edge_length, 1, (m.num_tris, length_tmp_ptr, (wp::Mesh*)id));
-        wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_triangle_bounds, m.num_tris, (m.num_tris, m.points, m.indices, m.bounds));
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_triangle_bounds, m.num_tris, (m.num_tris, m.points, NULL, NULL, m.indices, m.bounds));
+
+        // solid angle data is only recomputed once a winding number query needs it
+        bvh_refit_device(m.bvh, m.bounds);
+
+        if (m.quantized_points)
+            wp::mesh_update_quantized_points_device(m);
+
+        if (m.solid_angle_valid)
+        {
+            m.solid_angle_valid = 0;
+            mesh_add_descriptor(id, m);
+        }
+    }
+
+}
+
+void mesh_skin_device(uint64_t id, const wp::vec3* rest_points, const wp::transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, wp::transform* xform)
+{
+    wp::Mesh m;
+    if (mesh_get_descriptor(id, m))
+    {
+        ContextGuard guard(m.context);
+
+        // the points, their triangle bounds and the BVH are updated back to back on the stream without the edge
+        // length reduction of mesh_refit_device(), the average edge length is kept from the last full refit
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_skin_kernel, m.num_points, (m.num_points, rest_points, bones, bone_indices, bone_weights, bones_per_point, *xform, m.points.data));
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_triangle_bounds, m.num_tris, (m.num_tris, m.points, NULL, NULL, m.indices, m.bounds));
+
+        bvh_refit_device(m.bvh, m.bounds);
+
+        if (m.quantized_points)
+            wp::mesh_update_quantized_points_device(m);
+
+        if (m.solid_angle_valid)
+        {
+            m.solid_angle_valid = 0;
+            mesh_add_descriptor(id, m);
+        }
+    }
+}
+
+void mesh_refit_solid_angle_device(uint64_t id)
+{
+    wp::Mesh m;
+    if (mesh_get_descriptor(id, m))
+    {
+        if (!m.solid_angle_props || m.solid_angle_valid)
+            return;
+
+        ContextGuard guard(m.context);
+
+        // the node bounds of the solid angle data match the ones of the last refit
+        bvh_refit_with_solid_angle_device(m.bvh, m);
+
+        m.solid_angle_valid = 1;
+        mesh_add_descriptor(id, m);
+    }
+}
+
+void mesh_refit_partial_device(uint64_t id, const int* dirty_tris, int num_dirty)
+{
+    wp::Mesh m;
+    if (mesh_get_descriptor(id, m))
+    {
+        // moved vertices may leave the bounds the points were quantized to
+        if (m.quantized_points)
+        {
+            mesh_refit_device(id);
+            return;
+        }
+
+        ContextGuard guard(m.context);
+
+        wp::BVH& bvh = m.bvh;
+
+        if (!m.tri_nodes)
+        {
+            m.tri_nodes = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int)*m.num_tris);
+            wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_compute_tri_nodes, bvh.num_nodes, (bvh.num_nodes, bvh.node_lowers, m.tri_nodes));
+
+            // the device copy of the mesh is not read by the refit, the mapping only lives in the descriptor
+            mesh_add_descriptor(id, m);
+        }
+
+        // full refits leave the child counters set
+        memset_device(WP_CURRENT_CONTEXT, bvh.node_counts, 0, sizeof(int)*bvh.max_nodes);
+
+        // valid solid angle data is updated along with the dirty triangles, stale data is recomputed on demand
+        wp::SolidAngleProps* solid_angle_props = m.solid_angle_valid ? m.solid_angle_props : NULL;
+
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_refit_partial_leaves, num_dirty, (num_dirty, dirty_tris, m.points, m.indices, m.tri_nodes, bvh.node_parents, bvh.node_counts, m.bounds, bvh.node_lowers, bvh.node_uppers, solid_angle_props));
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_refit_partial_hierarchy, num_dirty, (num_dirty, dirty_tris, m.tri_nodes, bvh.node_parents, bvh.node_counts, bvh.node_lowers, bvh.node_uppers, solid_angle_props));
+
+        if (bvh.wide_nodes)
+            wp::bvh_refit_wide_device(bvh);
+    }
+}
+
+void mesh_build_wide_device(uint64_t id)
+{
+    wp::Mesh m;
+    if (mesh_get_descriptor(id, m))
+    {
+        ContextGuard guard(m.context);
+
+        wp::bvh_build_wide_device(m.bvh);
+
+        // only update the BVH on the device, other mesh fields are computed there
+        mesh_add_descriptor(id, m);
+        memcpy_h2d(WP_CURRENT_CONTEXT, &((wp::Mesh*)id)->bvh, &m.bvh, sizeof(wp::BVH));
+    }
+}
+
+void mesh_reorder_device(uint64_t id, int* tri_permutation, int* point_permutation)
+{
+    wp::Mesh m;
+    if (!mesh_get_descriptor(id, m) || m.num_tris == 0)
+        return;
+
+    ContextGuard guard(m.context);
+
+    const int num_tris = m.num_tris;
+    const int num_points = m.num_points;
+
+    // the bounds are permuted with the triangles so that the leaves can be refit from them
+    int* indices = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_tris*3);
+    wp::bounds3* bounds = (wp::bounds3*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(wp::bounds3)*num_tris);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_reorder_triangles, num_tris, (num_tris, m.bvh.node_lowers, m.indices, m.bounds, indices, bounds, tri_permutation));
+
+    memcpy_d2d(WP_CURRENT_CONTEXT, m.indices.data, indices, sizeof(int)*num_tris*3);
+    memcpy_d2d(WP_CURRENT_CONTEXT, m.bounds, bounds, sizeof(wp::bounds3)*num_tris);
+
+    free_temp_device(WP_CURRENT_CONTEXT, indices);
+    free_temp_device(WP_CURRENT_CONTEXT, bounds);
+
+    if (point_permutation)
+    {
+        // vertices are sorted by the first triangle that uses them, the radix sort is stable
+        // so ties and unused vertices keep their original order, matching mesh_reorder_host(),
+        // unused vertices get the key num_tris so that only the bits of the triangle indices are sorted
+        int* keys = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_points*2);
+        int* values = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_points*2);
+
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_init_first_use, num_points, (num_points, num_tris, keys, values));
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_compute_first_use, num_tris*3, (num_tris*3, m.indices, keys));
+
+        radix_sort_pairs_device(WP_CURRENT_CONTEXT, keys, values, num_points, 0, radix_sort_bits(num_tris + 1));
+
+        wp::vec3* points = (wp::vec3*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(wp::vec3)*num_points*2);
+        wp::vec3* velocities = m.velocities.data ? points + num_points : NULL;
+
+        // the remapped indices replace the keys, which are no longer needed
+        int* remap = keys;
+
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_reorder_points, num_points, (num_points, values, m.points, m.velocities, points, velocities, remap));
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_remap_indices, num_tris*3, (num_tris*3, remap, m.indices));
+
+        memcpy_d2d(WP_CURRENT_CONTEXT, m.points.data, points, sizeof(wp::vec3)*num_points);
+        if (velocities)
+            memcpy_d2d(WP_CURRENT_CONTEXT, m.velocities.data, velocities, sizeof(wp::vec3)*num_points);
+        memcpy_d2d(WP_CURRENT_CONTEXT, point_permutation, values, sizeof(int)*num_points);
+
+        free_temp_device(WP_CURRENT_CONTEXT, points);
+        free_temp_device(WP_CURRENT_CONTEXT, keys);
+        free_temp_device(WP_CURRENT_CONTEXT, values);
+    }
+}
+
+void mesh_quantize_device(uint64_t id)
+{
+    wp::Mesh m;
+    if (mesh_get_descriptor(id, m))
+    {
+        ContextGuard guard(m.context);
 
-        if (m.solid_angle_props) 
+        if (!m.quantized_points)
         {
-            bvh_refit_with_solid_angle_device(m.bvh, m);            
+            m.quantized_points = (uint16_t*)alloc_device(WP_CURRENT_CONTEXT, sizeof(uint16_t)*m.num_points*3);
+            m.quantized_frame = (wp::vec3*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::vec3)*2);
+
+            // only update the quantized buffers on the device, other mesh fields are computed there
+            memcpy_h2d(WP_CURRENT_CONTEXT, &((wp::Mesh*)id)->quantized_points, &m.quantized_points, sizeof(uint16_t*));
+            memcpy_h2d(WP_CURRENT_CONTEXT, &((wp::Mesh*)id)->quantized_frame, &m.quantized_frame, sizeof(wp::vec3*));
         }
-        else 
+
+        wp::mesh_update_quantized_points_device(m);
+
+        m.solid_angle_valid = 0;
+        mesh_add_descriptor(id, m);
+    }
+}
+
+void mesh_build_refit_levels_device(uint64_t id)
+{
+    wp::Mesh m;
+    if (mesh_get_descriptor(id, m))
+    {
+        ContextGuard guard(m.context);
+
+        wp::bvh_build_refit_levels_device(m.bvh);
+
+        // only update the BVH on the device, other mesh fields are computed there
+        mesh_add_descriptor(id, m);
+        memcpy_h2d(WP_CURRENT_CONTEXT, &((wp::Mesh*)id)->bvh, &m.bvh, sizeof(wp::BVH));
+    }
+}
+
+void mesh_raycast_batch_device(uint64_t id, wp::vec3* origins, wp::vec3* dirs, int num_rays, float max_t, float* out_t, int* out_face, wp::vec2* out_uv, wp::vec3* out_normal, int sort_rays)
+{
+    wp::Mesh m;
+    if (num_rays > 0 && mesh_get_descriptor(id, m))
+    {
+        ContextGuard guard(m.context);
+
+        int* order = NULL;
+        int* keys = NULL;
+
+        if (sort_rays && m.num_tris > 0)
         {
-            bvh_refit_device(m.bvh, m.bounds);
+            // radix sort requires double-sized buffers
+            keys = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_rays*2);
+            order = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_rays*2);
+
+            wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_raycast_sort_keys, num_rays, (id, origins, dirs, num_rays, keys, order));
+            // 3 octant bits above 9 Morton bits per axis
+            radix_sort_pairs_device(WP_CURRENT_CONTEXT, keys, order, num_rays, 0, 30);
+        }
+
+        int* next_ray = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int));
+        memset_device(WP_CURRENT_CONTEXT, next_ray, 0, sizeof(int));
+
+        // launch just enough threads to fill the device
+        int device = 0;
+        int num_sms = 0;
+        int blocks_per_sm = 0;
+        check_cuda(cudaGetDevice(&device));
+        check_cuda(cudaDeviceGetAttribute(&num_sms, cudaDevAttrMultiProcessorCount, device));
+        check_cuda(cudaOccupancyMaxActiveBlocksPerMultiprocessor(&blocks_per_sm, wp::mesh_raycast_batch_kernel, 256, 0));
+
+        const int num_threads = std::min(std::max(num_sms*blocks_per_sm, 1)*256, num_rays);
+
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_raycast_batch_kernel, num_threads,
+            (id, origins, dirs, order, num_rays, max_t, next_ray, out_t, out_face, out_uv, out_normal));
+
+        free_temp_device(WP_CURRENT_CONTEXT, next_ray);
+
+        if (order)
+        {
+            free_temp_device(WP_CURRENT_CONTEXT, keys);
+            free_temp_device(WP_CURRENT_CONTEXT, order);
+        }
+    }
+}
+
+void mesh_query_point_batch_device(uint64_t id, wp::vec3* points, int num_points, float max_dist, int* out_face, wp::vec2* out_uv, float* out_dist, int sort_points)
+{
+    wp::Mesh m;
+    if (num_points > 0 && mesh_get_descriptor(id, m))
+    {
+        ContextGuard guard(m.context);
+
+        int* order = NULL;
+        int* keys = NULL;
+
+        // warps only share their traversal when their points are close together
+        if (sort_points && m.num_tris > 0)
+        {
+            // radix sort requires double-sized buffers
+            keys = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_points*2);
+            order = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)*num_points*2);
+
+            wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_query_point_sort_keys, num_points, (id, points, num_points, keys, order));
+            radix_sort_pairs_device(WP_CURRENT_CONTEXT, keys, order, num_points, 0, 30);
+        }
+
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_query_point_batch_kernel, num_points,
+            (id, points, order, num_points, max_dist, out_face, out_uv, out_dist));
+
+        if (order)
+        {
+            free_temp_device(WP_CURRENT_CONTEXT, keys);
+            free_temp_device(WP_CURRENT_CONTEXT, order);
         }
     }
+}
+
+void mesh_query_mesh_overlap_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    wp::Mesh a, b;
+    if (mesh_get_descriptor(id_a, a) && mesh_get_descriptor(id_b, b))
+    {
+        ContextGuard guard(a.context);
 
+        // leaves of the mesh BVHs hold one triangle each
+        wp::bvh_query_bvh_overlap_device(a.bvh, b.bvh, *xform, margin, pairs, max_pairs, pair_count);
+    }
+}
+
+void mesh_query_mesh_intersections_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, wp::vec2i* pairs, wp::vec3* segments, int max_pairs, int* pair_count)
+{
+    wp::Mesh a, b;
+    if (mesh_get_descriptor(id_a, a) && mesh_get_descriptor(id_b, b))
+    {
+        ContextGuard guard(a.context);
+
+        // candidate pairs of overlapping triangle bounds, the query is repeated with the exact
+        // capacity when the first guess is too small
+        int capacity = std::max(a.num_tris + b.num_tris, 1);
+        wp::vec2i* candidates = (wp::vec2i*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(wp::vec2i)*capacity);
+        int* candidate_count = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int));
+
+        int num_candidates = 0;
+        wp::bvh_query_bvh_overlap_device(a.bvh, b.bvh, *xform, 0.0f, candidates, capacity, candidate_count);
+        memcpy_d2h(WP_CURRENT_CONTEXT, &num_candidates, candidate_count, sizeof(int));
+        cuda_context_synchronize(WP_CURRENT_CONTEXT);
+
+        if (num_candidates > capacity)
+        {
+            free_temp_device(WP_CURRENT_CONTEXT, candidates);
+            capacity = num_candidates;
+            candidates = (wp::vec2i*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(wp::vec2i)*capacity);
+
+            wp::bvh_query_bvh_overlap_device(a.bvh, b.bvh, *xform, 0.0f, candidates, capacity, candidate_count);
+        }
+
+        memset_device(WP_CURRENT_CONTEXT, pair_count, 0, sizeof(int));
+
+        if (num_candidates > 0)
+            wp_launch_device(WP_CURRENT_CONTEXT, wp::mesh_intersect_kernel, num_candidates,
+                (a, b, *xform, candidates, num_candidates, pairs, segments, max_pairs, pair_count));
+
+        free_temp_device(WP_CURRENT_CONTEXT, candidate_count);
+        free_temp_device(WP_CURRENT_CONTEXT, candidates);
+    }
+}
+
+void mesh_query_bvh_overlap_device(uint64_t mesh_id, uint64_t bvh_id, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    wp::Mesh mesh;
+    wp::BVH bvh;
+    if (mesh_get_descriptor(mesh_id, mesh) && bvh_get_descriptor(bvh_id, bvh))
+    {
+        ContextGuard guard(mesh.context);
+
+        wp::bvh_query_bvh_overlap_device(mesh.bvh, bvh, *xform, margin, pairs, max_pairs, pair_count);
+    }
+}
+
+void mesh_query_self_overlap_device(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count)
+{
+    wp::Mesh mesh;
+    if (mesh_get_descriptor(id, mesh))
+    {
+        ContextGuard guard(mesh.context);
+
+        // leaves of the mesh BVH hold one triangle each
+        wp::bvh_query_self_overlap_device(mesh.bvh, margin, pairs, max_pairs, pair_count);
+    }
 }
@@ -28,6 +28,12 @@ struct Mesh
 
     bounds3* bounds;
     SolidAngleProps* solid_angle_props;
+    int solid_angle_valid;  // solid angle data is computed on demand and invalidated by full refits
+    int* tri_nodes;     // leaf node of each triangle, built on the first partial refit
+
+    // optional 16 bit vertex positions relative to the mesh bounds, NULL unless built with mesh_quantize_host/device()
+    uint16_t* quantized_points;     // 3 per vertex
+    vec3* quantized_frame;          // origin and scale of the quantized positions
 
     int num_points;
     int num_tris;
@@ -45,6 +51,10 @@ struct Mesh
         num_tris = 0;
         context = nullptr;
         solid_angle_props = nullptr;	
+        solid_angle_valid = 0;
+        tri_nodes = nullptr;
+        quantized_points = nullptr;
+        quantized_frame = nullptr;
         average_edge_length = 0.0f;
     }
 
@@ -59,6 +69,10 @@ struct Mesh
     {
         bounds = nullptr;
         solid_angle_props = nullptr;
+        solid_angle_valid = 0;
+        tri_nodes = nullptr;
+        quantized_points = nullptr;
+        quantized_frame = nullptr;
         average_edge_length = 0.0f;
     }
 };
@@ -69,6 +83,55 @@ CUDA_CALLABLE inline Mesh mesh_get(uint64_t id)
 }
 
 
+// vertex position used by the queries, quantized meshes decode it on the fly
+CUDA_CALLABLE inline vec3 mesh_point(const vec3* points, const uint16_t* quantized_points, const vec3* quantized_frame, int i)
+{
+    if (quantized_points)
+    {
+        const uint16_t* q = quantized_points + i*3;
+        return quantized_frame[0] + cw_mul(vec3(float(q[0]), float(q[1]), float(q[2])), quantized_frame[1]);
+    }
+
+    return points[i];
+}
+
+CUDA_CALLABLE inline vec3 mesh_point(const Mesh& mesh, int i)
+{
+    return mesh_point(mesh.points.data, mesh.quantized_points, mesh.quantized_frame, i);
+}
+
+// linear-blend skinning of a rest position by the bones_per_point weighted bone transforms of vertex i, then by the
+// instance transform, points are only moved by the instance transform if bones is NULL
+CUDA_CALLABLE inline vec3 mesh_skin_point(const vec3& rest, int i, const transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, const transform& xform)
+{
+    vec3 p = rest;
+
+    if (bones)
+    {
+        p = vec3();
+        for (int j=0; j < bones_per_point; ++j)
+        {
+            const float w = bone_weights[i*bones_per_point + j];
+            if (w != 0.0f)
+                p += w*transform_point(bones[bone_indices[i*bones_per_point + j]], rest);
+        }
+    }
+
+    return transform_point(xform, p);
+}
+
+// encodes a position relative to the frame, positions outside of the frame are clamped
+CUDA_CALLABLE inline void mesh_quantize_point(const vec3& p, const vec3* quantized_frame, uint16_t* q)
+{
+    for (int c=0; c < 3; ++c)
+    {
+        const float scale = quantized_frame[1][c];
+        const float x = scale > 0.0f ? (p[c] - quantized_frame[0][c])/scale : 0.0f;
+
+        q[c] = uint16_t(clamp(x + 0.5f, 0.0f, 65535.0f));
+    }
+}
+
 CUDA_CALLABLE inline Mesh& operator += (Mesh& a, const Mesh& b) {
     // dummy operator needed for adj_select involving meshes
     return a;
@@ -91,10 +154,8 @@ CUDA_CALLABLE inline bool mesh_query_point(uint64_t id, const vec3& point, float
     if (mesh.bvh.num_nodes == 0)
         return false;
 
-    int stack[32];
-    stack[0] = mesh.bvh.root;
-
-    int count = 1;
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
 
     float min_dist_sq = max_dist*max_dist;
     int min_face;
@@ -110,10 +171,9 @@ CUDA_CALLABLE inline bool mesh_query_point(uint64_t id, const vec3& point, float
     std::vector<vec3> test_extents;
 #endif
 
-    while (count)
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = stack[--count];
-
         BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
     
@@ -137,9 +197,9 @@ CUDA_CALLABLE inline bool mesh_query_point(uint64_t id, const vec3& point, float
             int j = mesh.indices[left_index*3+1];
             int k = mesh.indices[left_index*3+2];
 
-            vec3 p = mesh.points[i];
-            vec3 q = mesh.points[j];
-            vec3 r = mesh.points[k];
+            vec3 p = mesh_point(mesh, i);
+            vec3 q = mesh_point(mesh, j);
+            vec3 r = mesh_point(mesh, k);
             
             vec3 e0 = q-p;
             vec3 e1 = r-p;
@@ -199,24 +259,9 @@ CUDA_CALLABLE inline bool mesh_query_point(uint64_t id, const vec3& point, float
             float left_score = left_dist_sq;
             float right_score = right_dist_sq;
 
-            if (left_score < right_score)
-            {
-                // put left on top of the stack
-                if (right_dist_sq < min_dist_sq)
-                    stack[count++] = right_index;
-
-                if (left_dist_sq < min_dist_sq)
-                    stack[count++] = left_index;
-            }
-            else
-            {
-                // put right on top of the stack
-                if (left_dist_sq < min_dist_sq)
-                    stack[count++] = left_index;
-
-                if (right_dist_sq < min_dist_sq)
-                    stack[count++] = right_index;
-            }
+            // visit the nearest child first, culled children are skipped when popped
+            if (left_dist_sq < min_dist_sq || right_dist_sq < min_dist_sq)
+                stack.push(mesh.bvh, left_index, right_index, left_score < right_score);
         }
     }
 
@@ -279,10 +324,8 @@ CUDA_CALLABLE inline bool mesh_query_point_no_sign(uint64_t id, const vec3& poin
     if (mesh.bvh.num_nodes == 0)
         return false;
 
-    int stack[32];
-    stack[0] = mesh.bvh.root;
-
-    int count = 1;
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
 
     float min_dist_sq = max_dist*max_dist;
     int min_face;
@@ -298,10 +341,9 @@ CUDA_CALLABLE inline bool mesh_query_point_no_sign(uint64_t id, const vec3& poin
     std::vector<vec3> test_extents;
 #endif
 
-    while (count)
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = stack[--count];
-
         BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
     
@@ -325,9 +367,9 @@ CUDA_CALLABLE inline bool mesh_query_point_no_sign(uint64_t id, const vec3& poin
             int j = mesh.indices[left_index*3+1];
             int k = mesh.indices[left_index*3+2];
 
-            vec3 p = mesh.points[i];
-            vec3 q = mesh.points[j];
-            vec3 r = mesh.points[k];
+            vec3 p = mesh_point(mesh, i);
+            vec3 q = mesh_point(mesh, j);
+            vec3 r = mesh_point(mesh, k);
             
             vec3 e0 = q-p;
             vec3 e1 = r-p;
@@ -387,24 +429,9 @@ CUDA_CALLABLE inline bool mesh_query_point_no_sign(uint64_t id, const vec3& poin
             float left_score = left_dist_sq;
             float right_score = right_dist_sq;
 
-            if (left_score < right_score)
-            {
-                // put left on top of the stack
-                if (right_dist_sq < min_dist_sq)
-                    stack[count++] = right_index;
-
-                if (left_dist_sq < min_dist_sq)
-                    stack[count++] = left_index;
-            }
-            else
-            {
-                // put right on top of the stack
-                if (left_dist_sq < min_dist_sq)
-                    stack[count++] = left_index;
-
-                if (right_dist_sq < min_dist_sq)
-                    stack[count++] = right_index;
-            }
+            // visit the nearest child first, culled children are skipped when popped
+            if (left_dist_sq < min_dist_sq || right_dist_sq < min_dist_sq)
+                stack.push(mesh.bvh, left_index, right_index, left_score < right_score);
         }
     }
 
@@ -456,15 +483,78 @@ CUDA_CALLABLE inline bool mesh_query_point_no_sign(uint64_t id, const vec3& poin
     }
 }
 
+// pushes the mesh vertices within max_dist of point into the heap with their distance as key, returns the number of
+// entries, the traversal culls the nodes further than the largest kept distance once the heap is full
+template<unsigned K>
+CUDA_CALLABLE inline int mesh_query_knn_points(uint64_t id, const vec3& point, float max_dist, topk_heap_t<K>& heap)
+{
+    Mesh mesh = mesh_get(id);
+
+    if (mesh.bvh.num_nodes == 0)
+        return heap.count;
+
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
+
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
+    {
+        const float bound = min(max_dist, topk_bound(heap));
+        const float bound_sq = bound*bound;
+
+        BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
+        BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
+
+        if (distance_to_aabb_sq(point, vec3(lower.x, lower.y, lower.z), vec3(upper.x, upper.y, upper.z)) > bound_sq)
+            continue;
+
+        const int left_index = lower.i;
+        const int right_index = upper.i;
+
+        if (lower.b)
+        {
+            for (int k=0; k < 3; ++k)
+            {
+                const int i = mesh.indices[left_index*3+k];
+                const float dist = length(mesh_point(mesh, i) - point);
+
+                // vertices shared by several triangles are only kept once
+                if (dist <= max_dist)
+                    topk_push_unique(heap, dist, i);
+            }
+        }
+        else
+        {
+            BVHPackedNodeHalf left_lower = mesh.bvh.node_lowers[left_index];
+            BVHPackedNodeHalf left_upper = mesh.bvh.node_uppers[left_index];
+
+            BVHPackedNodeHalf right_lower = mesh.bvh.node_lowers[right_index];
+            BVHPackedNodeHalf right_upper = mesh.bvh.node_uppers[right_index];
+
+            float left_dist_sq = distance_to_aabb_sq(point, vec3(left_lower.x, left_lower.y, left_lower.z), vec3(left_upper.x, left_upper.y, left_upper.z));
+            float right_dist_sq = distance_to_aabb_sq(point, vec3(right_lower.x, right_lower.y, right_lower.z), vec3(right_upper.x, right_upper.y, right_upper.z));
+
+            // visit the nearest child first so that the bound shrinks early
+            if (left_dist_sq <= bound_sq || right_dist_sq <= bound_sq)
+                stack.push(mesh.bvh, left_index, right_index, left_dist_sq < right_dist_sq);
+        }
+    }
+
+    return heap.count;
+}
+
+template<unsigned K>
+CUDA_CALLABLE inline void adj_mesh_query_knn_points(uint64_t id, const vec3& point, float max_dist, topk_heap_t<K>& heap,
+                                                    uint64_t& adj_id, vec3& adj_point, float& adj_max_dist, topk_heap_t<K>& adj_heap, int& adj_ret) {}
+
 // returns true if there is a point (strictly) < distance max_dist
 CUDA_CALLABLE inline bool mesh_query_point_sign_normal(uint64_t id, const vec3& point, float max_dist, float& inside, int& face, float& u, float& v, const float epsilon = 1e-3f)
 {
     Mesh mesh = mesh_get(id);
     if (mesh.bvh.num_nodes == 0)
         return false;
-    int stack[32];
-    stack[0] = mesh.bvh.root;
-    int count = 1;
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
     float min_dist = max_dist;
     int min_face;
     float min_v;
@@ -479,9 +569,14 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_normal(uint64_t id, const vec3&
 #endif
     float epsilon_min_dist = mesh.average_edge_length * epsilon;
     float epsilon_min_dist_sq = epsilon_min_dist*epsilon_min_dist;
-    while (count)
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = stack[--count];
+        // the traversal restarts from the root if the stack overflows,
+        // keep the distance bound but gather the normals again
+        if (nodeIndex == mesh.bvh.root)
+            accumulated_angle_weighted_normal = vec3();
+
         BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
         // re-test distance
@@ -501,9 +596,9 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_normal(uint64_t id, const vec3&
             int i = mesh.indices[left_index*3+0];
             int j = mesh.indices[left_index*3+1];
             int k = mesh.indices[left_index*3+2];
-            vec3 p = mesh.points[i];
-            vec3 q = mesh.points[j];
-            vec3 r = mesh.points[k];
+            vec3 p = mesh_point(mesh, i);
+            vec3 q = mesh_point(mesh, j);
+            vec3 r = mesh_point(mesh, k);
             vec3 e0 = q-p;
             vec3 e1 = r-p;
             vec3 e2 = r-q;
@@ -609,22 +704,10 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_normal(uint64_t id, const vec3&
             float left_score = left_dist_sq;
             float right_score = right_dist_sq;
 
-            if (left_score < right_score)
-            {
-                // put left on top of the stack
-                if (right_dist_sq < (min_dist + epsilon_min_dist) * (min_dist + epsilon_min_dist))
-                    stack[count++] = right_index;
-                if (left_dist_sq < (min_dist + epsilon_min_dist) * (min_dist + epsilon_min_dist))
-                    stack[count++] = left_index;
-            }
-            else
-            {
-                // put right on top of the stack
-                if (left_dist_sq < (min_dist + epsilon_min_dist) * (min_dist + epsilon_min_dist))
-                    stack[count++] = left_index;
-                if (right_dist_sq < (min_dist + epsilon_min_dist) * (min_dist + epsilon_min_dist))
-                    stack[count++] = right_index;
-            }
+            // visit the nearest child first, culled children are skipped when popped
+            float cull_dist_sq = (min_dist + epsilon_min_dist) * (min_dist + epsilon_min_dist);
+            if (left_dist_sq < cull_dist_sq || right_dist_sq < cull_dist_sq)
+                stack.push(mesh.bvh, left_index, right_index, left_score < right_score);
         }
     }
 #if BVH_DEBUG
@@ -663,9 +746,9 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_normal(uint64_t id, const vec3&
         int i = mesh.indices[min_face*3+0];
         int j = mesh.indices[min_face*3+1];
         int k = mesh.indices[min_face*3+2];
-        vec3 p = mesh.points[i];
-        vec3 q = mesh.points[j];
-        vec3 r = mesh.points[k];
+        vec3 p = mesh_point(mesh, i);
+        vec3 q = mesh_point(mesh, j);
+        vec3 r = mesh_point(mesh, k);
         vec3 closest_point = p*u+q*v+r*min_w;
         if (dot(accumulated_angle_weighted_normal, point-closest_point) > 0.0) 
         {
@@ -687,18 +770,17 @@ CUDA_CALLABLE inline float solid_angle_iterative(uint64_t id, const vec3& p, con
     Mesh mesh = mesh_get(id);
     if (mesh.bvh.num_nodes == 0)
         return 0.0f;
-    int stack[32];
-    int at_child[32]; // 0 for left, 1 for right, 2 for done	
-    float angle[32]; 
-    stack[0] = mesh.bvh.root;	
-    at_child[0] = 0;
 
-    int count = 1;
-    angle[0] = 0.0f;
+    // the solid angle is the sum over the nodes where the traversal stops,
+    // either leaves or nodes whose far field approximation is accurate enough
+    float angle = 0.0f;
+
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
 
-    while (count)
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = stack[count - 1];
         BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
     
@@ -708,51 +790,20 @@ CUDA_CALLABLE inline float solid_angle_iterative(uint64_t id, const vec3& p, con
         {
             // compute closest point on tri
             const int leaf_index = left_index;
-            angle[count - 1] = robust_solid_angle(mesh.points[mesh.indices[leaf_index*3+0]], mesh.points[mesh.indices[leaf_index*3+1]], mesh.points[mesh.indices[leaf_index*3+2]], p);
-            //printf("Leaf %d, got %f\n", leaf_index, my_data[count - 1]);
-            count--;
+            angle += robust_solid_angle(mesh_point(mesh, mesh.indices[leaf_index*3+0]), mesh_point(mesh, mesh.indices[leaf_index*3+1]), mesh_point(mesh, mesh.indices[leaf_index*3+2]), p);
         }
         else
         {
+            float node_angle;
+            
             // See if I have to descend
-            if (at_child[count - 1] == 0) 
-            {
-                // First visit
-                bool des = evaluate_node_solid_angle(p, &mesh.solid_angle_props[nodeIndex], angle[count - 1], accuracy_sq); 
-
-                //printf("Non-Leaf %d, got %f\n", nodeIndex, angle[count - 1]);
-                if (des) 
-                {
-                    // Go left
-                    stack[count] = left_index;
-                    at_child[count - 1] = 1;
-                    angle[count] = 0.0f;
-                    at_child[count] = 0;
-                    count++;
-                } else 
-                {				
-                    // Does not descend done
-                    count--;
-                }
-            } else
-            if (at_child[count - 1] == 1) 
-            {
-                // Add data to parent
-                angle[count - 1] += angle[count];
-                // Go right
-                stack[count] = right_index;
-                at_child[count - 1] = 2;
-                angle[count] = 0.0f;			
-                at_child[count] = 0;
-                count++;					
-            } else {
-                // Descend both sides already
-                angle[count - 1] += angle[count];
-                count--;
-            }
+            if (evaluate_node_solid_angle(p, &mesh.solid_angle_props[nodeIndex], node_angle, accuracy_sq))
+                stack.push(mesh.bvh, left_index, right_index);
+            else
+                angle += node_angle;
         }
     }
-    return angle[0];
+    return angle;
 }
 
 CUDA_CALLABLE inline float mesh_query_winding_number(uint64_t id, const vec3& p, const float accuracy) 
@@ -769,10 +820,8 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_winding_number(uint64_t id, cons
     if (mesh.bvh.num_nodes == 0)
         return false;
 
-    int stack[32];
-    stack[0] = mesh.bvh.root;
-
-    int count = 1;
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
 
     float min_dist_sq = max_dist*max_dist;
     int min_face;
@@ -788,10 +837,9 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_winding_number(uint64_t id, cons
     std::vector<vec3> test_extents;
 #endif
 
-    while (count)
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = stack[--count];
-
         BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
     
@@ -815,9 +863,9 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_winding_number(uint64_t id, cons
             int j = mesh.indices[left_index*3+1];
             int k = mesh.indices[left_index*3+2];
 
-            vec3 p = mesh.points[i];
-            vec3 q = mesh.points[j];
-            vec3 r = mesh.points[k];
+            vec3 p = mesh_point(mesh, i);
+            vec3 q = mesh_point(mesh, j);
+            vec3 r = mesh_point(mesh, k);
             
             vec3 e0 = q-p;
             vec3 e1 = r-p;
@@ -877,24 +925,9 @@ CUDA_CALLABLE inline bool mesh_query_point_sign_winding_number(uint64_t id, cons
             float left_score = left_dist_sq;
             float right_score = right_dist_sq;
 
-            if (left_score < right_score)
-            {
-                // put left on top of the stack
-                if (right_dist_sq < min_dist_sq)
-                    stack[count++] = right_index;
-
-                if (left_dist_sq < min_dist_sq)
-                    stack[count++] = left_index;
-            }
-            else
-            {
-                // put right on top of the stack
-                if (left_dist_sq < min_dist_sq)
-                    stack[count++] = left_index;
-
-                if (right_dist_sq < min_dist_sq)
-                    stack[count++] = right_index;
-            }
+            // visit the nearest child first, culled children are skipped when popped
+            if (left_dist_sq < min_dist_sq || right_dist_sq < min_dist_sq)
+                stack.push(mesh.bvh, left_index, right_index, left_score < right_score);
         }
     }
 
@@ -965,9 +998,9 @@ CUDA_CALLABLE inline void adj_mesh_query_point_no_sign(uint64_t id, const vec3&
     int j = mesh.indices[face*3+1];
     int k = mesh.indices[face*3+2];
 
-    vec3 p = mesh.points[i];
-    vec3 q = mesh.points[j];
-    vec3 r = mesh.points[k];
+    vec3 p = mesh_point(mesh, i);
+    vec3 q = mesh_point(mesh, j);
+    vec3 r = mesh_point(mesh, k);
 
     vec3 adj_p, adj_q, adj_r;
 
@@ -994,6 +1027,112 @@ CUDA_CALLABLE inline void adj_mesh_query_point_sign_winding_number(uint64_t id,
     adj_mesh_query_point_no_sign(id, point, max_dist, face, u, v, adj_id, adj_point, adj_max_dist, adj_face, adj_u, adj_v, adj_ret);
 }
 
+// closest hit traversal of the wide BVH layout, see bvh_build_wide_host()
+CUDA_CALLABLE inline bool mesh_query_ray_wide(const Mesh& mesh, const vec3& start, const vec3& dir, float max_t, float& t, float& u, float& v, float& sign, vec3& normal, int& face)
+{
+    bvh_stack_t stack;
+    stack.init(0);
+
+    vec3 rcp_dir = vec3(1.0f/dir[0], 1.0f/dir[1], 1.0f/dir[2]);
+
+    float min_t = max_t;
+    int min_face;
+    float min_u;
+    float min_v;
+    float min_sign = 1.0f;
+    vec3 min_normal;
+
+    while (stack.count)
+    {
+        const int ref = stack.nodes[--stack.count];
+
+        if (ref < 0)
+        {
+            // compute closest point on tri
+            const int face_index = ~ref;
+
+            int i = mesh.indices[face_index*3+0];
+            int j = mesh.indices[face_index*3+1];
+            int k = mesh.indices[face_index*3+2];
+
+            vec3 p = mesh_point(mesh, i);
+            vec3 q = mesh_point(mesh, j);
+            vec3 r = mesh_point(mesh, k);
+
+            float t, u, v, sign;
+            vec3 n;
+            
+            if (intersect_ray_tri_woop(start, dir, p, q, r, t, u, v, sign, &n))
+            {
+                if (t < min_t && t >= 0.0f)
+                {
+                    min_t = t;
+                    min_face = face_index;
+                    min_u = u;
+                    min_v = v;
+                    min_sign = sign;
+                    min_normal = n;
+                }
+            }
+
+            continue;
+        }
+
+        const BVHWideNode node = mesh.bvh.wide_nodes[ref];
+
+        // test all children, then push the hits so that the nearest is visited first
+        int hit_refs[BVH_WIDE_WIDTH];
+        float hit_ts[BVH_WIDE_WIDTH];
+        int num_hits = 0;
+
+        // todo: switch to robust ray-aabb, or expand bounds in build stage
+        float child_ts[BVH_WIDE_WIDTH];
+        const int mask = bvh_intersect_wide_ray(node, start, rcp_dir, 1.e-3f, child_ts);
+
+        for (int c=0; c < BVH_WIDE_WIDTH; ++c)
+        {
+            if (!(mask & (1 << c)))
+                continue;
+
+            const float t = child_ts[c];
+
+            if (t < min_t)
+            {
+                // insertion sort by decreasing distance
+                int h = num_hits++;
+                for (; h > 0 && hit_ts[h-1] < t; --h)
+                {
+                    hit_refs[h] = hit_refs[h-1];
+                    hit_ts[h] = hit_ts[h-1];
+                }
+
+                hit_refs[h] = node.children[c];
+                hit_ts[h] = t;
+            }
+        }
+
+        for (int h=0; h < num_hits; ++h)
+            stack.nodes[stack.count++] = hit_refs[h];
+    }
+
+    if (min_t < max_t)
+    {
+        // write outputs
+        u = min_u;
+        v = min_v;
+        sign = min_sign;
+        t = min_t;
+        normal = normalize(min_normal);
+        face = min_face;
+
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
 CUDA_CALLABLE inline bool mesh_query_ray(uint64_t id, const vec3& start, const vec3& dir, float max_t, float& t, float& u, float& v, float& sign, vec3& normal, int& face)
 {
     Mesh mesh = mesh_get(id);
@@ -1001,9 +1140,11 @@ CUDA_CALLABLE inline bool mesh_query_ray(uint64_t id, const vec3& start, const v
     if (mesh.bvh.num_nodes == 0)
         return false;
 
-    int stack[32];
-    stack[0] = mesh.bvh.root;
-    int count = 1;
+    if (bvh_use_wide(mesh.bvh))
+        return mesh_query_ray_wide(mesh, start, dir, max_t, t, u, v, sign, normal, face);
+
+    bvh_stack_t stack;
+    stack.init(mesh.bvh.root);
 
     vec3 rcp_dir = vec3(1.0f/dir[0], 1.0f/dir[1], 1.0f/dir[2]);
 
@@ -1014,10 +1155,9 @@ CUDA_CALLABLE inline bool mesh_query_ray(uint64_t id, const vec3& start, const v
     float min_sign = 1.0f;
     vec3 min_normal;
 
-    while (count)
+    int nodeIndex;
+    while ((nodeIndex = stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = stack[--count];
-
         BVHPackedNodeHalf lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf upper = mesh.bvh.node_uppers[nodeIndex];
 
@@ -1038,9 +1178,9 @@ CUDA_CALLABLE inline bool mesh_query_ray(uint64_t id, const vec3& start, const v
                 int j = mesh.indices[left_index*3+1];
                 int k = mesh.indices[left_index*3+2];
 
-                vec3 p = mesh.points[i];
-                vec3 q = mesh.points[j];
-                vec3 r = mesh.points[k];
+                vec3 p = mesh_point(mesh, i);
+                vec3 q = mesh_point(mesh, j);
+                vec3 r = mesh_point(mesh, k);
 
                 float t, u, v, sign;
                 vec3 n;
@@ -1060,8 +1200,7 @@ CUDA_CALLABLE inline bool mesh_query_ray(uint64_t id, const vec3& start, const v
             }
             else
             {
-                stack[count++] = left_index;
-                stack[count++] = right_index;
+                stack.push(mesh.bvh, left_index, right_index);
             }
         }
     }
@@ -1098,9 +1237,9 @@ CUDA_CALLABLE inline void adj_mesh_query_ray(
     int j = mesh.indices[face*3+1];
     int k = mesh.indices[face*3+2];
 
-    vec3 a = mesh.points[i];
-    vec3 b = mesh.points[j];
-    vec3 c = mesh.points[k];
+    vec3 a = mesh_point(mesh, i);
+    vec3 b = mesh_point(mesh, j);
+    vec3 c = mesh_point(mesh, k);
 
     vec3 adj_a, adj_b, adj_c;
 
@@ -1110,6 +1249,157 @@ CUDA_CALLABLE inline void adj_mesh_query_ray(
 
 
 // determine if a point is inside (ret < 0 ) or outside the mesh (ret > 0)
+// traces ray i of a batch for mesh_raycast_batch_host/device(), misses
+// write t = -1 and face = -1, each output array is optional
+CUDA_CALLABLE inline void mesh_raycast_batch_ray(uint64_t id, const vec3* origins, const vec3* dirs, int i, float max_t, float* out_t, int* out_face, vec2* out_uv, vec3* out_normal)
+{
+    float t, u, v, sign;
+    vec3 n;
+    int face;
+
+    if (!mesh_query_ray(id, origins[i], dirs[i], max_t, t, u, v, sign, n, face))
+    {
+        t = -1.0f;
+        u = 0.0f;
+        v = 0.0f;
+        n = vec3();
+        face = -1;
+    }
+
+    if (out_t)
+        out_t[i] = t;
+    if (out_face)
+        out_face[i] = face;
+    if (out_uv)
+        out_uv[i] = vec2(u, v);
+    if (out_normal)
+        out_normal[i] = n;
+}
+
+// writes the result for point i of a batch of mesh_query_point_batch_host/device(), points without
+// a face within max_dist write face = -1 and dist = -1, each output array is optional
+CUDA_CALLABLE inline void mesh_query_point_batch_write(int i, bool found, int face, float u, float v, float dist_sq, int* out_face, vec2* out_uv, float* out_dist)
+{
+    if (!found)
+    {
+        face = -1;
+        u = 0.0f;
+        v = 0.0f;
+    }
+
+    if (out_face)
+        out_face[i] = face;
+    if (out_uv)
+        out_uv[i] = vec2(u, v);
+    if (out_dist)
+        out_dist[i] = found ? sqrt(dist_sq) : -1.0f;
+}
+
+// end points of the segment where a triangle crosses a plane given the signed distances d of its vertices
+// to the plane, returns false if the triangle doesn't reach the plane
+CUDA_CALLABLE inline bool mesh_tri_plane_segment(const vec3* v, const float* d, vec3& s0, vec3& s1)
+{
+    int count = 0;
+    for (int i=0; i < 3; ++i)
+    {
+        const int j = (i + 1)%3;
+
+        vec3 p;
+        if (d[i] == 0.0f)
+            p = v[i];
+        else if (d[j] != 0.0f && (d[i] < 0.0f) != (d[j] < 0.0f))
+            p = v[i] + (v[j] - v[i])*(d[i]/(d[i] - d[j]));
+        else
+            continue;
+
+        if (count++ == 0)
+            s0 = p;
+        else
+            s1 = p;
+    }
+
+    if (count == 1)
+        s1 = s0;
+
+    return count > 0;
+}
+
+// tests the triangles p and q with NoDivTriTriIsect() and writes the segment along which they intersect,
+// coplanar triangles overlap over an area and write a zero-length segment at the centroid of p instead
+CUDA_CALLABLE inline bool mesh_intersect_tri_tri_segment(vec3* p, vec3* q, vec3& s0, vec3& s1)
+{
+    if (!NoDivTriTriIsect(&p[0][0], &p[1][0], &p[2][0], &q[0][0], &q[1][0], &q[2][0]))
+        return false;
+
+    const vec3 n_p = cross(p[1] - p[0], p[2] - p[0]);
+    const vec3 n_q = cross(q[1] - q[0], q[2] - q[0]);
+    const vec3 dir = cross(n_p, n_q);
+
+    // distances below the threshold of NoDivTriTriIsect() are snapped to the planes
+    float d_p[3], d_q[3];
+    for (int i=0; i < 3; ++i)
+    {
+        d_p[i] = dot(n_q, p[i] - q[0]);
+        d_q[i] = dot(n_p, q[i] - p[0]);
+
+        if (abs(d_p[i]) < 1.e-6f)
+            d_p[i] = 0.0f;
+        if (abs(d_q[i]) < 1.e-6f)
+            d_q[i] = 0.0f;
+    }
+
+    vec3 a0, a1, b0, b1;
+    if (length_sq(dir) == 0.0f || !mesh_tri_plane_segment(p, d_p, a0, a1) || !mesh_tri_plane_segment(q, d_q, b0, b1))
+    {
+        s0 = s1 = (p[0] + p[1] + p[2])/3.0f;
+        return true;
+    }
+
+    // both segments lie on the intersection line of the planes, the triangles cross over their common part
+    if (dot(dir, a1) < dot(dir, a0))
+    {
+        const vec3 t = a0; a0 = a1; a1 = t;
+    }
+    if (dot(dir, b1) < dot(dir, b0))
+    {
+        const vec3 t = b0; b0 = b1; b1 = t;
+    }
+
+    s0 = dot(dir, a0) > dot(dir, b0) ? a0 : b0;
+    s1 = dot(dir, a1) < dot(dir, b1) ? a1 : b1;
+
+    return true;
+}
+
+// narrow phase of mesh_query_mesh_intersections_host/device(), tests a pair of triangles of a and b overlapping
+// in the dual BVH traversal, triangles of b are placed in the frame of a by xform
+CUDA_CALLABLE inline bool mesh_intersect_tri_pair(const Mesh& a, const Mesh& b, const transform& xform, const vec2i& pair, vec3& s0, vec3& s1)
+{
+    vec3 p[3], q[3];
+    for (int i=0; i < 3; ++i)
+    {
+        p[i] = mesh_point(a, a.indices[pair[0]*3 + i]);
+        q[i] = transform_point(xform, mesh_point(b, b.indices[pair[1]*3 + i]));
+    }
+
+    return mesh_intersect_tri_tri_segment(p, q, s0, s1);
+}
+
+// writes an intersecting pair found by mesh_query_mesh_intersections_host/device() to slot index, the segments
+// are optional and hold two end points per pair
+CUDA_CALLABLE inline void mesh_intersection_write(int index, const vec2i& pair, const vec3& s0, const vec3& s1, vec2i* pairs, vec3* segments, int max_pairs)
+{
+    if (index >= max_pairs)
+        return;
+
+    pairs[index] = pair;
+    if (segments)
+    {
+        segments[2*index + 0] = s0;
+        segments[2*index + 1] = s1;
+    }
+}
+
 CUDA_CALLABLE inline float mesh_query_inside(uint64_t id, const vec3& p)
 {
     float t, u, v, sign;
@@ -1146,8 +1436,7 @@ struct mesh_query_aabb_t
     // Mesh Id
     Mesh mesh;
     // BVH traversal stack:
-    int stack[32];
-    int count;
+    bvh_stack_t stack;
 
     // inputs
     wp::vec3 input_lower;
@@ -1176,23 +1465,22 @@ CUDA_CALLABLE inline mesh_query_aabb_t mesh_query_aabb(
     // if no bvh nodes, return empty query.
     if (mesh.bvh.num_nodes == 0)
     {
-        query.count = 0;
+        query.stack.clear();
         return query;
     }
 
     // optimization: make the latest
     
-    query.stack[0] = mesh.bvh.root;
-    query.count = 1;
+    query.stack.init(mesh.bvh.root);
     query.input_lower = lower;
     query.input_upper = upper;
 
     wp::bounds3 input_bounds(query.input_lower, query.input_upper);
     
     // Navigate through the bvh, find the first overlapping leaf node.
-    while (query.count)
+    int nodeIndex;
+    while ((nodeIndex = query.stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = query.stack[--query.count];
         BVHPackedNodeHalf node_lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf node_upper = mesh.bvh.node_uppers[nodeIndex];
 
@@ -1213,13 +1501,12 @@ CUDA_CALLABLE inline mesh_query_aabb_t mesh_query_aabb(
         {
             // found very first triangle index.
             // Back up one level and return 
-            query.stack[query.count++] = nodeIndex;
+            query.stack.push_back(nodeIndex);
             return query;
         }
         else
         {	
-          query.stack[query.count++] = left_index;
-          query.stack[query.count++] = right_index;
+          query.stack.push(mesh.bvh, left_index, right_index);
         }
     }	
 
@@ -1239,9 +1526,9 @@ CUDA_CALLABLE inline bool mesh_query_aabb_next(mesh_query_aabb_t& query, int& in
     
     wp::bounds3 input_bounds(query.input_lower, query.input_upper);
     // Navigate through the bvh, find the first overlapping leaf node.
-    while (query.count)
+    int nodeIndex;
+    while ((nodeIndex = query.stack.pop(mesh.bvh)) >= 0)
     {
-        const int nodeIndex = query.stack[--query.count];
         BVHPackedNodeHalf node_lower = mesh.bvh.node_lowers[nodeIndex];
         BVHPackedNodeHalf node_upper = mesh.bvh.node_uppers[nodeIndex];
 
@@ -1267,9 +1554,7 @@ CUDA_CALLABLE inline bool mesh_query_aabb_next(mesh_query_aabb_t& query, int& in
         }
         else
         {
-
-            query.stack[query.count++] = left_index;
-            query.stack[query.count++] = right_index;
+            query.stack.push(mesh.bvh, left_index, right_index);
         }
     }
     return false;
@@ -1484,4 +1769,11 @@ CUDA_CALLABLE bool mesh_get_descriptor(uint64_t id, Mesh& mesh);
 CUDA_CALLABLE void mesh_add_descriptor(uint64_t id, const Mesh& mesh);
 CUDA_CALLABLE void mesh_rem_descriptor(uint64_t id);
 
+// meshes created by mesh_create_batch_device() share the allocations of their descriptors, bounds and BVH nodes,
+// which are freed with the last mesh of the batch
+void mesh_add_batch(const uint64_t* ids, int num_meshes, void* context, void* mesh_pool, void* node_pool);
+
 } // namespace wp
+
+// instance BVHs are built on top of meshes, keep them visible wherever meshes are
+#include "tlas.h"
@@ -0,0 +1,420 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+#include "cuda_util.h"
+#include "hashgrid.h"
+#include "neighbor_list.h"
+#include "scan.h"
+#include "string.h"
+
+using namespace wp;
+
+#include <map>
+
+namespace
+{
+    // host-side copy of neighbor list descriptors, maps GPU neighbor list address (id) to a CPU desc
+    std::map<uint64_t, NeighborList> g_neighbor_list_descriptors;
+
+} // anonymous namespace
+
+
+namespace wp
+{
+
+bool neighbor_list_get_descriptor(uint64_t id, NeighborList& list)
+{
+    const auto& iter = g_neighbor_list_descriptors.find(id);
+    if (iter == g_neighbor_list_descriptors.end())
+        return false;
+
+    list = iter->second;
+    return true;
+}
+
+void neighbor_list_add_descriptor(uint64_t id, const NeighborList& list)
+{
+    g_neighbor_list_descriptors[id] = list;
+}
+
+void neighbor_list_rem_descriptor(uint64_t id)
+{
+    g_neighbor_list_descriptors.erase(id);
+}
+
+// implemented in neighbor_list.cu, counting also computes the offsets of the lists
+void neighbor_list_count_device(const NeighborList& list, uint64_t grid, const wp::vec3* points, float radius);
+void neighbor_list_fill_device(const NeighborList& list, uint64_t grid, const wp::vec3* points, float radius);
+void neighbor_list_check_displacement_device(const NeighborList& list, const wp::vec3* points, float max_displacement);
+
+// implemented in neighbor_list.cu, the rows of the kNN graph are gathered at a stride of k and then compacted
+void knn_graph_gather_device(uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius,
+                             int* counts, int* offsets, int* indices, float* distances);
+void knn_graph_compact_device(int num_points, int k, const int* offsets, const int* row_indices, const float* row_distances,
+                              int* indices, float* distances);
+
+} // namespace wp
+
+
+// counts or writes the neighbors of a point within the radius, the neighbors are visited in grid order
+static int neighbor_list_gather_host(uint64_t grid, const wp::vec3* points, int i, float radius, int* neighbors)
+{
+    const wp::vec3 p = points[i];
+    const float radius_sq = radius*radius;
+
+    int count = 0;
+    int index;
+
+    hash_grid_query_t query = hash_grid_query(grid, p, radius);
+    while (hash_grid_query_next(query, index))
+    {
+        const wp::vec3 d = points[index] - p;
+        if (dot(d, d) <= radius_sq)
+        {
+            if (neighbors)
+                neighbors[count] = index;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+// host methods
+uint64_t neighbor_list_create_host()
+{
+    NeighborList* list = new NeighborList();
+
+    return (uint64_t)(list);
+}
+
+void neighbor_list_destroy_host(uint64_t id)
+{
+    NeighborList* list = (NeighborList*)(id);
+
+    free_host(list->offsets);
+    free_host(list->counts);
+    free_host(list->neighbors);
+    free_host(list->points);
+
+    delete list;
+}
+
+int neighbor_list_build_host(uint64_t id, uint64_t grid, const wp::vec3* points, int num_points, float radius)
+{
+    NeighborList* list = (NeighborList*)(id);
+
+    if (num_points > list->max_points)
+    {
+        free_host(list->offsets);
+        free_host(list->counts);
+        free_host(list->points);
+
+        // grow geometrically so that steadily emitting systems reallocate rarely
+        const int num_to_alloc = max(num_points, 2*list->max_points);
+        list->offsets = (int*)alloc_host((num_to_alloc+1)*sizeof(int));
+        list->counts = (int*)alloc_host(num_to_alloc*sizeof(int));
+        list->points = (wp::vec3*)alloc_host(num_to_alloc*sizeof(wp::vec3));
+        list->max_points = num_to_alloc;
+    }
+
+    list->num_points = num_points;
+
+    for (int i=0; i < num_points; ++i)
+        list->counts[i] = neighbor_list_gather_host(grid, points, i, radius, NULL);
+
+    list->offsets[0] = 0;
+    if (num_points > 0)
+        scan_host(list->counts, list->offsets + 1, num_points, true);
+
+    const int num_neighbors = list->offsets[num_points];
+    if (num_neighbors > list->max_neighbors)
+    {
+        free_host(list->neighbors);
+
+        const int num_to_alloc = max(num_neighbors, 2*list->max_neighbors);
+        list->neighbors = (int*)alloc_host(num_to_alloc*sizeof(int));
+        list->max_neighbors = num_to_alloc;
+    }
+
+    list->num_neighbors = num_neighbors;
+
+    for (int i=0; i < num_points; ++i)
+        neighbor_list_gather_host(grid, points, i, radius, list->neighbors + list->offsets[i]);
+
+    memcpy(list->points, points, num_points*sizeof(wp::vec3));
+
+    return num_neighbors;
+}
+
+int neighbor_list_check_host(uint64_t id, const wp::vec3* points, int num_points, float max_displacement)
+{
+    const NeighborList* list = (const NeighborList*)(id);
+
+    // lists must be rebuilt when points were added or removed
+    if (num_points != list->num_points)
+        return 1;
+
+    const float max_displacement_sq = max_displacement*max_displacement;
+
+    for (int i=0; i < num_points; ++i)
+    {
+        const wp::vec3 d = points[i] - list->points[i];
+        if (dot(d, d) > max_displacement_sq)
+            return 1;
+    }
+
+    return 0;
+}
+
+uint64_t neighbor_list_get_offsets_host(uint64_t id)
+{
+    const NeighborList* list = (const NeighborList*)(id);
+
+    return (uint64_t)(list->offsets);
+}
+
+uint64_t neighbor_list_get_neighbors_host(uint64_t id)
+{
+    const NeighborList* list = (const NeighborList*)(id);
+
+    return (uint64_t)(list->neighbors);
+}
+
+// device methods
+uint64_t neighbor_list_create_device(void* context)
+{
+    ContextGuard guard(context);
+
+    NeighborList list{};
+
+    list.context = context ? context : cuda_context_get_current();
+    list.flag = (int*)alloc_device(WP_CURRENT_CONTEXT, sizeof(int));
+
+    // upload to device
+    NeighborList* list_device = (NeighborList*)(alloc_device(WP_CURRENT_CONTEXT, sizeof(NeighborList)));
+    memcpy_h2d(WP_CURRENT_CONTEXT, list_device, &list, sizeof(NeighborList));
+
+    uint64_t list_id = (uint64_t)(list_device);
+    neighbor_list_add_descriptor(list_id, list);
+
+    return list_id;
+}
+
+void neighbor_list_destroy_device(uint64_t id)
+{
+    NeighborList list;
+    if (neighbor_list_get_descriptor(id, list))
+    {
+        ContextGuard guard(list.context);
+
+        free_device(WP_CURRENT_CONTEXT, list.offsets);
+        free_device(WP_CURRENT_CONTEXT, list.counts);
+        free_device(WP_CURRENT_CONTEXT, list.neighbors);
+        free_device(WP_CURRENT_CONTEXT, list.points);
+        free_device(WP_CURRENT_CONTEXT, list.flag);
+
+        free_device(WP_CURRENT_CONTEXT, (NeighborList*)id);
+
+        neighbor_list_rem_descriptor(id);
+    }
+}
+
+int neighbor_list_build_device(uint64_t id, uint64_t grid, const wp::vec3* points, int num_points, float radius)
+{
+    NeighborList list;
+    if (!neighbor_list_get_descriptor(id, list))
+        return 0;
+
+    ContextGuard guard(list.context);
+
+    // the size of the list is read back to allocate the neighbors, which cannot be recorded in a graph
+    if (cuda_stream_is_capturing(cuda_stream_get_current()))
+    {
+        fprintf(stderr, "Warp error: Neighbor lists cannot be built during graph capture, "
+                        "build the list before capturing and check NeighborList.needs_rebuild() outside of the graph\n");
+        return 0;
+    }
+
+    if (num_points > list.max_points)
+    {
+        // stream-ordered frees and allocations avoid synchronizing the device when memory pools are supported
+        free_temp_device(WP_CURRENT_CONTEXT, list.offsets);
+        free_temp_device(WP_CURRENT_CONTEXT, list.counts);
+        free_temp_device(WP_CURRENT_CONTEXT, list.points);
+
+        // grow geometrically so that steadily emitting systems reallocate rarely
+        const int num_to_alloc = max(num_points, 2*list.max_points);
+        list.offsets = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, (num_to_alloc+1)*sizeof(int));
+        list.counts = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, num_to_alloc*sizeof(int));
+        list.points = (wp::vec3*)alloc_temp_device(WP_CURRENT_CONTEXT, num_to_alloc*sizeof(wp::vec3));
+        list.max_points = num_to_alloc;
+    }
+
+    list.num_points = num_points;
+
+    neighbor_list_count_device(list, grid, points, radius);
+
+    int num_neighbors = 0;
+    memcpy_d2h(WP_CURRENT_CONTEXT, &num_neighbors, list.offsets + num_points, sizeof(int));
+    cuda_stream_synchronize(WP_CURRENT_CONTEXT, cuda_stream_get_current());
+
+    if (num_neighbors > list.max_neighbors)
+    {
+        free_temp_device(WP_CURRENT_CONTEXT, list.neighbors);
+
+        const int num_to_alloc = max(num_neighbors, 2*list.max_neighbors);
+        list.neighbors = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, num_to_alloc*sizeof(int));
+        list.max_neighbors = num_to_alloc;
+    }
+
+    list.num_neighbors = num_neighbors;
+
+    neighbor_list_fill_device(list, grid, points, radius);
+
+    memcpy_d2d(WP_CURRENT_CONTEXT, list.points, (void*)points, num_points*sizeof(wp::vec3));
+
+    // update device side list descriptor
+    memcpy_h2d(WP_CURRENT_CONTEXT, (NeighborList*)id, &list, sizeof(NeighborList));
+
+    // update host side list descriptor
+    neighbor_list_add_descriptor(id, list);
+
+    return num_neighbors;
+}
+
+int neighbor_list_check_device(uint64_t id, const wp::vec3* points, int num_points, float max_displacement)
+{
+    NeighborList list;
+    if (!neighbor_list_get_descriptor(id, list))
+        return 0;
+
+    if (num_points != list.num_points)
+        return 1;
+
+    ContextGuard guard(list.context);
+
+    memset_device(WP_CURRENT_CONTEXT, list.flag, 0, sizeof(int));
+    neighbor_list_check_displacement_device(list, points, max_displacement);
+
+    int flag = 0;
+    memcpy_d2h(WP_CURRENT_CONTEXT, &flag, list.flag, sizeof(int));
+    cuda_stream_synchronize(WP_CURRENT_CONTEXT, cuda_stream_get_current());
+
+    return flag;
+}
+
+uint64_t neighbor_list_get_offsets_device(uint64_t id)
+{
+    NeighborList list;
+    if (neighbor_list_get_descriptor(id, list))
+        return (uint64_t)(list.offsets);
+    else
+        return 0;
+}
+
+uint64_t neighbor_list_get_neighbors_device(uint64_t id)
+{
+    NeighborList list;
+    if (neighbor_list_get_descriptor(id, list))
+        return (uint64_t)(list.neighbors);
+    else
+        return 0;
+}
+
+int knn_graph_host(uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius,
+                   int* offsets, int* indices, float* distances)
+{
+    // each row is gathered at its final offset, which is at most i*k so that k entries always fit in the outputs
+    offsets[0] = 0;
+    for (int i=0; i < num_points; ++i)
+    {
+        const int begin = offsets[i];
+        offsets[i+1] = begin + knn_graph_gather(grid, points, i, k, radius, max_radius, indices + begin, distances + begin);
+    }
+
+    return offsets[num_points];
+}
+
+int knn_graph_device(void* context, uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius,
+                     int* offsets, int* indices, float* distances)
+{
+    ContextGuard guard(context);
+
+    // the number of edges is read back to compact the rows, which cannot be recorded in a graph
+    if (cuda_stream_is_capturing(cuda_stream_get_current()))
+    {
+        fprintf(stderr, "Warp error: kNN graphs cannot be built during graph capture\n");
+        return 0;
+    }
+
+    int* counts = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, max(num_points, 1)*sizeof(int));
+
+    knn_graph_gather_device(grid, points, num_points, k, radius, max_radius, counts, offsets, indices, distances);
+
+    int num_edges = 0;
+    memcpy_d2h(WP_CURRENT_CONTEXT, &num_edges, offsets + num_points, sizeof(int));
+    cuda_stream_synchronize(WP_CURRENT_CONTEXT, cuda_stream_get_current());
+
+    // rows with less than k neighbors leave gaps, the rows are moved through a copy since they overlap
+    if (size_t(num_edges) < size_t(num_points)*k)
+    {
+        const size_t num_slots = size_t(num_points)*k;
+        int* row_indices = (int*)alloc_temp_device(WP_CURRENT_CONTEXT, num_slots*sizeof(int));
+        float* row_distances = (float*)alloc_temp_device(WP_CURRENT_CONTEXT, num_slots*sizeof(float));
+
+        memcpy_d2d(WP_CURRENT_CONTEXT, row_indices, indices, num_slots*sizeof(int));
+        memcpy_d2d(WP_CURRENT_CONTEXT, row_distances, distances, num_slots*sizeof(float));
+
+        knn_graph_compact_device(num_points, k, offsets, row_indices, row_distances, indices, distances);
+
+        free_temp_device(WP_CURRENT_CONTEXT, row_indices);
+        free_temp_device(WP_CURRENT_CONTEXT, row_distances);
+    }
+
+    free_temp_device(WP_CURRENT_CONTEXT, counts);
+
+    return num_edges;
+}
+
+#if !WP_ENABLE_CUDA
+
+namespace wp
+{
+
+void neighbor_list_count_device(const NeighborList& list, uint64_t grid, const wp::vec3* points, float radius)
+{
+
+}
+
+void neighbor_list_fill_device(const NeighborList& list, uint64_t grid, const wp::vec3* points, float radius)
+{
+
+}
+
+void neighbor_list_check_displacement_device(const NeighborList& list, const wp::vec3* points, float max_displacement)
+{
+
+}
+
+void knn_graph_gather_device(uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius,
+                             int* counts, int* offsets, int* indices, float* distances)
+{
+
+}
+
+void knn_graph_compact_device(int num_points, int k, const int* offsets, const int* row_indices, const float* row_distances,
+                              int* indices, float* distances)
+{
+
+}
+
+} // namespace wp
+
+#endif // !WP_ENABLE_CUDA
@@ -0,0 +1,143 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+#include "cuda_util.h"
+#include "hashgrid.h"
+#include "neighbor_list.h"
+#include "scan.h"
+
+namespace wp
+{
+
+// counts or writes the neighbors of a point within the radius, the neighbors are visited in grid order
+__device__ int gather_neighbors(uint64_t grid, const wp::vec3* points, int i, float radius, int* neighbors)
+{
+    const wp::vec3 p = points[i];
+    const float radius_sq = radius*radius;
+
+    int count = 0;
+    int index;
+
+    hash_grid_query_t query = hash_grid_query(grid, p, radius);
+    while (hash_grid_query_next(query, index))
+    {
+        const wp::vec3 d = points[index] - p;
+        if (dot(d, d) <= radius_sq)
+        {
+            if (neighbors)
+                neighbors[count] = index;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+__global__ void count_neighbors(NeighborList list, uint64_t grid, const wp::vec3* points, float radius)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < list.num_points)
+        list.counts[tid] = gather_neighbors(grid, points, tid, radius, NULL);
+}
+
+__global__ void fill_neighbors(NeighborList list, uint64_t grid, const wp::vec3* points, float radius)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < list.num_points)
+        gather_neighbors(grid, points, tid, radius, list.neighbors + list.offsets[tid]);
+}
+
+__global__ void check_displacement(NeighborList list, const wp::vec3* points, float max_displacement_sq)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < list.num_points)
+    {
+        const wp::vec3 d = points[tid] - list.points[tid];
+        if (dot(d, d) > max_displacement_sq)
+            *list.flag = 1;
+    }
+}
+
+__global__ void knn_graph_gather_rows(uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius,
+                                      int* counts, int* indices, float* distances)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < num_points)
+    {
+        const size_t row = size_t(tid)*k;
+        counts[tid] = knn_graph_gather(grid, points, tid, k, radius, max_radius, indices + row, distances + row);
+    }
+}
+
+__global__ void knn_graph_compact_rows(int num_points, int k, const int* offsets, const int* row_indices, const float* row_distances,
+                                       int* indices, float* distances)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < num_points)
+    {
+        const size_t row = size_t(tid)*k;
+        const int begin = offsets[tid];
+        const int count = offsets[tid+1] - begin;
+
+        for (int j=0; j < count; ++j)
+        {
+            indices[begin + j] = row_indices[row + j];
+            distances[begin + j] = row_distances[row + j];
+        }
+    }
+}
+
+void neighbor_list_count_device(const NeighborList& list, uint64_t grid, const wp::vec3* points, float radius)
+{
+    ContextGuard guard(list.context);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::count_neighbors, list.num_points, (list, grid, points, radius));
+
+    // offsets[0] = 0 followed by the inclusive scan of the counts
+    memset_device(WP_CURRENT_CONTEXT, list.offsets, 0, sizeof(int));
+    if (list.num_points > 0)
+        scan_device(list.counts, list.offsets + 1, list.num_points, true);
+}
+
+void neighbor_list_fill_device(const NeighborList& list, uint64_t grid, const wp::vec3* points, float radius)
+{
+    ContextGuard guard(list.context);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::fill_neighbors, list.num_points, (list, grid, points, radius));
+}
+
+void neighbor_list_check_displacement_device(const NeighborList& list, const wp::vec3* points, float max_displacement)
+{
+    ContextGuard guard(list.context);
+
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::check_displacement, list.num_points, (list, points, max_displacement*max_displacement));
+}
+
+void knn_graph_gather_device(uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius,
+                             int* counts, int* offsets, int* indices, float* distances)
+{
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::knn_graph_gather_rows, num_points, (grid, points, num_points, k, radius, max_radius, counts, indices, distances));
+
+    memset_device(WP_CURRENT_CONTEXT, offsets, 0, sizeof(int));
+    if (num_points > 0)
+        scan_device(counts, offsets + 1, num_points, true);
+}
+
+void knn_graph_compact_device(int num_points, int k, const int* offsets, const int* row_indices, const float* row_distances,
+                              int* indices, float* distances)
+{
+    wp_launch_device(WP_CURRENT_CONTEXT, wp::knn_graph_compact_rows, num_points, (num_points, k, offsets, row_indices, row_distances, indices, distances));
+}
+
+} // namespace wp
@@ -0,0 +1,148 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+namespace wp
+{
+
+// neighbors of each point within a radius, stored in compressed sparse row format, the list is built with hash grid
+// queries and is reused as long as no point has moved more than half the skin added to the radius
+struct NeighborList
+{
+    int* offsets{nullptr};      // start of the neighbors of each point in neighbors, num_points+1 in length
+    int* counts{nullptr};       // number of neighbors of each point, max_points in length
+    int* neighbors{nullptr};    // indices of the neighbors, max_neighbors in length
+
+    vec3* points{nullptr};      // positions at the last build, max_points in length
+    int* flag{nullptr};         // device side result of the displacement check
+
+    int num_points;
+    int max_points;
+
+    int num_neighbors;
+    int max_neighbors;
+
+    void* context;
+};
+
+// stores state required to traverse the neighbors of a point
+struct neighbor_list_query_t
+{
+    CUDA_CALLABLE neighbor_list_query_t() {}
+    CUDA_CALLABLE neighbor_list_query_t(int) {} // for backward pass
+
+    const int* neighbors;
+
+    int neighbor_index;     // offset in the neighbor list of the point
+    int neighbor_end;       // index following the last neighbor of the point
+
+    int current;            // index of the current iterator value
+};
+
+
+CUDA_CALLABLE inline neighbor_list_query_t neighbor_list_query(uint64_t id, int point)
+{
+    const NeighborList& list = *(const NeighborList*)(id);
+
+    neighbor_list_query_t query;
+    query.neighbors = list.neighbors;
+    query.current = -1;
+
+    if (list.offsets && point >= 0 && point < list.num_points)
+    {
+        query.neighbor_index = list.offsets[point];
+        query.neighbor_end = list.offsets[point+1];
+    }
+    else
+    {
+        query.neighbor_index = 0;
+        query.neighbor_end = 0;
+    }
+
+    return query;
+}
+
+CUDA_CALLABLE inline bool neighbor_list_query_next(neighbor_list_query_t& query, int& index)
+{
+    if (query.neighbor_index < query.neighbor_end)
+    {
+        index = query.neighbors[query.neighbor_index++];
+        return true;
+    }
+
+    return false;
+}
+
+CUDA_CALLABLE inline int neighbor_list_count(uint64_t id, int point)
+{
+    const NeighborList& list = *(const NeighborList*)(id);
+    if (!list.offsets || point < 0 || point >= list.num_points)
+        return 0;
+
+    return list.offsets[point+1] - list.offsets[point];
+}
+
+CUDA_CALLABLE inline int iter_next(neighbor_list_query_t& query)
+{
+    return query.current;
+}
+
+CUDA_CALLABLE inline bool iter_cmp(neighbor_list_query_t& query)
+{
+    bool finished = neighbor_list_query_next(query, query.current);
+    return finished;
+}
+
+CUDA_CALLABLE inline neighbor_list_query_t iter_reverse(const neighbor_list_query_t& query)
+{
+    // neighbor lists are not traversed in reverse, users should not rely on neighbor ordering
+    return query;
+}
+
+// writes the k nearest neighbors of a point, excluding the point itself, by increasing distance and returns their
+// number. The search radius starts at radius and doubles until k neighbors are found or it reaches max_radius, the
+// neighbors are kept in a heap stored in the output row.
+CUDA_CALLABLE inline int knn_graph_gather(uint64_t grid, const vec3* points, int i, int k, float radius, float max_radius,
+                                          int* indices, float* distances)
+{
+    const vec3 p = points[i];
+
+    int count = 0;
+    while (1)
+    {
+        count = 0;
+
+        int index;
+        hash_grid_query_t query = hash_grid_query(grid, p, radius);
+        while (hash_grid_query_next(query, index))
+        {
+            if (index == i)
+                continue;
+
+            const float dist = length(points[index] - p);
+            if (dist <= radius)
+                topk_push(distances, indices, count, k, dist, index);
+        }
+
+        if (count == k || radius >= max_radius)
+            break;
+
+        radius = min(2.0f*radius, max_radius);
+    }
+
+    topk_sort_increasing(distances, indices, count);
+
+    return count;
+}
+
+CUDA_CALLABLE inline void adj_neighbor_list_query(uint64_t id, int point, uint64_t& adj_id, int& adj_point, neighbor_list_query_t& adj_res) {}
+CUDA_CALLABLE inline void adj_neighbor_list_query_next(neighbor_list_query_t& query, int& index, neighbor_list_query_t& adj_query, int& adj_index, bool& adj_res) {}
+CUDA_CALLABLE inline void adj_neighbor_list_count(uint64_t id, int point, uint64_t& adj_id, int& adj_point, int& adj_res) {}
+
+} // namespace wp
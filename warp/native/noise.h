@@ -904,4 +904,248 @@ inline CUDA_CALLABLE vec3 curlnoise(uint32 state, const vec4& xyzt)
 }
 inline CUDA_CALLABLE void adj_curlnoise(uint32 state, const vec4& xyzt, uint32& adj_state, vec4& adj_xyzt, const vec3& adj_ret) {}
 
+// table-driven gradient noise, uses Ken Perlin's reference permutation and
+// gradient sets rather than hashing every lattice corner through the RNG,
+// the tables live in constant memory on the device so that all lanes of a
+// warp share the cached lookups, the field repeats every 256 lattice units
+
+#define WP_NOISE_PERM \
+    151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, \
+    140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148, \
+    247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32, \
+    57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, \
+    74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122, \
+    60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54, \
+    65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169, \
+    200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64, \
+    52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212, \
+    207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213, \
+    119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9, \
+    129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104, \
+    218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241, \
+    81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157, \
+    184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93, \
+    222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180
+
+#define WP_NOISE_GRAD2 \
+    1.f, 0.f, -1.f, 0.f, 0.f, 1.f, 0.f, -1.f, \
+    0.70710678f, 0.70710678f, -0.70710678f, 0.70710678f, 0.70710678f, -0.70710678f, -0.70710678f, -0.70710678f
+
+#define WP_NOISE_GRAD3 \
+    1.f, 1.f, 0.f, -1.f, 1.f, 0.f, 1.f, -1.f, 0.f, -1.f, -1.f, 0.f, \
+    1.f, 0.f, 1.f, -1.f, 0.f, 1.f, 1.f, 0.f, -1.f, -1.f, 0.f, -1.f, \
+    0.f, 1.f, 1.f, 0.f, -1.f, 1.f, 0.f, 1.f, -1.f, 0.f, -1.f, -1.f, \
+    1.f, 1.f, 0.f, -1.f, 1.f, 0.f, 0.f, -1.f, 1.f, 0.f, -1.f, -1.f
+
+#if defined(__CUDACC__)
+static __constant__ unsigned char noise_perm_device[256] = { WP_NOISE_PERM };
+static __constant__ float noise_grad2_device[16] = { WP_NOISE_GRAD2 };
+static __constant__ float noise_grad3_device[48] = { WP_NOISE_GRAD3 };
+#endif
+
+static const unsigned char noise_perm_host[256] = { WP_NOISE_PERM };
+static const float noise_grad2_host[16] = { WP_NOISE_GRAD2 };
+static const float noise_grad3_host[48] = { WP_NOISE_GRAD3 };
+
+#undef WP_NOISE_PERM
+#undef WP_NOISE_GRAD2
+#undef WP_NOISE_GRAD3
+
+inline CUDA_CALLABLE int noise_perm(int i)
+{
+#if defined(__CUDA_ARCH__)
+    return noise_perm_device[i & 255];
+#else
+    return noise_perm_host[i & 255];
+#endif
+}
+
+inline CUDA_CALLABLE vec2 noise_grad2(int h)
+{
+#if defined(__CUDA_ARCH__)
+    const float* g = noise_grad2_device + (h & 7)*2;
+#else
+    const float* g = noise_grad2_host + (h & 7)*2;
+#endif
+    return vec2(g[0], g[1]);
+}
+
+inline CUDA_CALLABLE vec3 noise_grad3(int h)
+{
+#if defined(__CUDA_ARCH__)
+    const float* g = noise_grad3_device + (h & 15)*3;
+#else
+    const float* g = noise_grad3_host + (h & 15)*3;
+#endif
+    return vec3(g[0], g[1], g[2]);
+}
+
+// the low three bytes of the seed offset the lattice and the high byte
+// scrambles the gradient selection, so each RNG state gives its own field
+inline CUDA_CALLABLE float tnoise_eval(uint32 seed, const vec2& p, vec2& grad)
+{
+    float fx = floor(p[0]);
+    float fy = floor(p[1]);
+
+    float dx = p[0] - fx;
+    float dy = p[1] - fy;
+
+    int ix = int(fx) + int(seed & 255u);
+    int iy = int(fy) + int((seed >> 8) & 255u);
+    int s = int(seed >> 24);
+
+    float u[2] = { 1.f - smootherstep(dx), smootherstep(dx) };
+    float v[2] = { 1.f - smootherstep(dy), smootherstep(dy) };
+    float du[2] = { -smootherstep_gradient(dx), smootherstep_gradient(dx) };
+    float dv[2] = { -smootherstep_gradient(dy), smootherstep_gradient(dy) };
+
+    // permutation of the x lattice coordinates is shared by all corners
+    int px[2] = { noise_perm(ix), noise_perm(ix + 1) };
+
+    float value = 0.f;
+    grad = vec2(0.f);
+
+    for (int c=0; c < 4; ++c)
+    {
+        int cx = c & 1;
+        int cy = c >> 1;
+
+        vec2 g = noise_grad2(noise_perm(px[cx] + iy + cy) ^ s);
+        float n = g[0]*(dx - float(cx)) + g[1]*(dy - float(cy));
+        float w = u[cx]*v[cy];
+
+        value += w*n;
+        grad[0] += w*g[0] + du[cx]*v[cy]*n;
+        grad[1] += w*g[1] + u[cx]*dv[cy]*n;
+    }
+
+    return value;
+}
+
+inline CUDA_CALLABLE float tnoise_eval(uint32 seed, const vec3& p, vec3& grad)
+{
+    float fx = floor(p[0]);
+    float fy = floor(p[1]);
+    float fz = floor(p[2]);
+
+    float dx = p[0] - fx;
+    float dy = p[1] - fy;
+    float dz = p[2] - fz;
+
+    int ix = int(fx) + int(seed & 255u);
+    int iy = int(fy) + int((seed >> 8) & 255u);
+    int iz = int(fz) + int((seed >> 16) & 255u);
+    int s = int(seed >> 24);
+
+    float u[2] = { 1.f - smootherstep(dx), smootherstep(dx) };
+    float v[2] = { 1.f - smootherstep(dy), smootherstep(dy) };
+    float w[2] = { 1.f - smootherstep(dz), smootherstep(dz) };
+    float du[2] = { -smootherstep_gradient(dx), smootherstep_gradient(dx) };
+    float dv[2] = { -smootherstep_gradient(dy), smootherstep_gradient(dy) };
+    float dw[2] = { -smootherstep_gradient(dz), smootherstep_gradient(dz) };
+
+    // hash the lattice one axis at a time, 14 table lookups for 8 corners
+    int px[2] = { noise_perm(ix), noise_perm(ix + 1) };
+    int pxy[4] = { noise_perm(px[0] + iy), noise_perm(px[1] + iy), noise_perm(px[0] + iy + 1), noise_perm(px[1] + iy + 1) };
+
+    float value = 0.f;
+    grad = vec3(0.f);
+
+    for (int c=0; c < 8; ++c)
+    {
+        int cx = c & 1;
+        int cy = (c >> 1) & 1;
+        int cz = c >> 2;
+
+        vec3 g = noise_grad3(noise_perm(pxy[c & 3] + iz + cz) ^ s);
+        float n = g[0]*(dx - float(cx)) + g[1]*(dy - float(cy)) + g[2]*(dz - float(cz));
+        float weight = u[cx]*v[cy]*w[cz];
+
+        value += weight*n;
+        grad[0] += weight*g[0] + du[cx]*v[cy]*w[cz]*n;
+        grad[1] += weight*g[1] + u[cx]*dv[cy]*w[cz]*n;
+        grad[2] += weight*g[2] + u[cx]*v[cy]*dw[cz]*n;
+    }
+
+    return value;
+}
+
+template <typename T>
+inline CUDA_CALLABLE float tnoise(uint32 state, const T& p)
+{
+    T grad;
+    return tnoise_eval(state, p, grad);
+}
+
+template <typename T>
+inline CUDA_CALLABLE void adj_tnoise(uint32 state, const T& p, uint32& adj_state, T& adj_p, const float adj_ret)
+{
+    T grad;
+    tnoise_eval(state, p, grad);
+    adj_p += grad*adj_ret;
+}
+
+// fractal Brownian motion, sums octaves of table noise with the frequency
+// scaled by lacunarity and the amplitude by gain each octave, the value and
+// all derivatives are accumulated in one pass over the octaves
+template <typename T>
+inline CUDA_CALLABLE float fbm_eval(uint32 state, const T& p, int octaves, float lacunarity, float gain, T& d_p, float& d_lacunarity, float& d_gain)
+{
+    float value = 0.f;
+    float amplitude = 1.f;
+    float frequency = 1.f;
+
+    // d(amplitude)/d(gain) and d(frequency)/d(lacunarity) of the current octave
+    float d_amplitude = 0.f;
+    float d_frequency = 0.f;
+
+    d_p = T(0.f);
+    d_lacunarity = 0.f;
+    d_gain = 0.f;
+
+    uint32 seed = state;
+
+    for (int i=0; i < octaves; ++i)
+    {
+        T grad;
+        float n = tnoise_eval(seed, p*frequency, grad);
+
+        value += amplitude*n;
+        d_p += grad*(amplitude*frequency);
+        d_lacunarity += amplitude*dot(grad, p)*d_frequency;
+        d_gain += d_amplitude*n;
+
+        d_amplitude = d_amplitude*gain + amplitude;
+        d_frequency = d_frequency*lacunarity + frequency;
+        amplitude *= gain;
+        frequency *= lacunarity;
+
+        // decorrelate octaves by moving to a different lattice offset
+        seed += 0x9E3779B9u;
+    }
+
+    return value;
+}
+
+template <typename T>
+inline CUDA_CALLABLE float fbm(uint32 state, const T& p, int octaves, float lacunarity, float gain)
+{
+    T d_p;
+    float d_lacunarity, d_gain;
+    return fbm_eval(state, p, octaves, lacunarity, gain, d_p, d_lacunarity, d_gain);
+}
+
+template <typename T>
+inline CUDA_CALLABLE void adj_fbm(uint32 state, const T& p, int octaves, float lacunarity, float gain,
+                                  uint32& adj_state, T& adj_p, int& adj_octaves, float& adj_lacunarity, float& adj_gain, const float adj_ret)
+{
+    T d_p;
+    float d_lacunarity, d_gain;
+    fbm_eval(state, p, octaves, lacunarity, gain, d_p, d_lacunarity, d_gain);
+
+    adj_p += d_p*adj_ret;
+    adj_lacunarity += d_lacunarity*adj_ret;
+    adj_gain += d_gain*adj_ret;
+}
+
 } // namespace wp
@@ -44,7 +44,95 @@ inline CUDA_CALLABLE void adj_randi(uint32& state, int min, int max, uint32& adj
 inline CUDA_CALLABLE void adj_randf(uint32& state, uint32& adj_state, float adj_ret) {}
 inline CUDA_CALLABLE void adj_randf(uint32& state, float min, float max, uint32& adj_state, float& adj_min, float& adj_max, float adj_ret) {}
 
+// Box-Muller method, both outputs of the transform from one pair of uniforms
+inline CUDA_CALLABLE vec2 randn2(uint32& state)
+{
+    // shift the first uniform to (0, 1] so the log is always finite
+    float u1 = 1.f - randf(state);
+    float u2 = randf(state);
+    float r = sqrt(-2.f * log(u1));
+    float theta = 2.f * M_PI * u2;
+    return vec2(r * cos(theta), r * sin(theta));
+}
+
 inline CUDA_CALLABLE void adj_randn(uint32& state, uint32& adj_state, float adj_ret) {}
+inline CUDA_CALLABLE void adj_randn2(uint32& state, uint32& adj_state, const vec2& adj_ret) {}
+
+// Philox4x32-10 counter-based generator (Salmon et al. 2011, "Parallel Random Numbers: As Easy as 1, 2, 3"),
+// the output is a pure function of (key, counter) so streams can be indexed and skipped ahead without any state
+inline CUDA_CALLABLE uint32 philox_mulhilo(uint32 a, uint32 b, uint32& hi)
+{
+#if defined(__CUDA_ARCH__)
+    hi = __umulhi(a, b);
+    return a * b;
+#else
+    uint64 p = uint64(a) * uint64(b);
+    hi = uint32(p >> 32);
+    return uint32(p);
+#endif
+}
+
+inline CUDA_CALLABLE vec4ui philox(const vec2ui& key, const vec4ui& counter)
+{
+    uint32 k0 = key[0];
+    uint32 k1 = key[1];
+
+    uint32 c0 = counter[0];
+    uint32 c1 = counter[1];
+    uint32 c2 = counter[2];
+    uint32 c3 = counter[3];
+
+    for (int i=0; i < 10; ++i)
+    {
+        uint32 hi0, hi1;
+        uint32 lo0 = philox_mulhilo(0xD2511F53u, c0, hi0);
+        uint32 lo1 = philox_mulhilo(0xCD9E8D57u, c2, hi1);
+
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+
+        // Weyl sequence key schedule
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+
+    return vec4ui(c0, c1, c2, c3);
+}
+
+// the seed selects the stream, the index (usually the thread id) and the
+// offset (the number of 4-value blocks already consumed) select the block within it
+inline CUDA_CALLABLE vec4ui philox(int seed, int index, int offset)
+{
+    return philox(vec2ui(uint32(seed), 0u), vec4ui(uint32(index), uint32(offset), 0u, 0u));
+}
+
+inline CUDA_CALLABLE vec4 philox_randf4(int seed, int index, int offset)
+{
+    vec4ui x = philox(seed, index, offset);
+    const float s = 1.0f / 16777216.0f;
+    return vec4((x[0] >> 8) * s, (x[1] >> 8) * s, (x[2] >> 8) * s, (x[3] >> 8) * s);
+}
+
+inline CUDA_CALLABLE vec4 philox_randn4(int seed, int index, int offset)
+{
+    vec4ui x = philox(seed, index, offset);
+    const float s = 1.0f / 16777216.0f;
+
+    // first uniform of each pair is in (0, 1]
+    float r0 = sqrt(-2.f * log(((x[0] >> 8) + 1u) * s));
+    float r1 = sqrt(-2.f * log(((x[2] >> 8) + 1u) * s));
+    float theta0 = 2.f * M_PI * ((x[1] >> 8) * s);
+    float theta1 = 2.f * M_PI * ((x[3] >> 8) * s);
+
+    return vec4(r0 * cos(theta0), r0 * sin(theta0), r1 * cos(theta1), r1 * sin(theta1));
+}
+
+inline CUDA_CALLABLE void adj_philox(const vec2ui& key, const vec4ui& counter, vec2ui& adj_key, vec4ui& adj_counter, const vec4ui& adj_ret) {}
+inline CUDA_CALLABLE void adj_philox(int seed, int index, int offset, int& adj_seed, int& adj_index, int& adj_offset, const vec4ui& adj_ret) {}
+inline CUDA_CALLABLE void adj_philox_randf4(int seed, int index, int offset, int& adj_seed, int& adj_index, int& adj_offset, const vec4& adj_ret) {}
+inline CUDA_CALLABLE void adj_philox_randn4(int seed, int index, int offset, int& adj_seed, int& adj_index, int& adj_offset, const vec4& adj_ret) {}
 
 inline CUDA_CALLABLE int sample_cdf(uint32& state, const array_t<float>& cdf)
 {
@@ -1,5 +1,9 @@
 #include "warp.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 namespace
 {
 
@@ -36,6 +40,37 @@ template <typename T> void dyn_len_inner(const T *a, const T *b, T *dot, int val
     }
 }
 
+// items per block, each block is reduced by a single thread
+const int kReduceBlockSize = 1 << 16;
+const int kReduceMaxBlocks = 256;
+
+// Reduces [0, count) in blocks on the thread pool, reduce_block(begin, end, partial) accumulates into
+// a zero-initialized partial of type_length values. Partials are summed in block order, the partition
+// only depends on count so results do not vary with the number of threads.
+template <typename T, typename Func> void parallel_sum(int count, int type_length, T *out, Func reduce_block)
+{
+    const int num_blocks = std::max(1, std::min((count + kReduceBlockSize - 1) / kReduceBlockSize, kReduceMaxBlocks));
+    const int block_size = (count + num_blocks - 1) / num_blocks;
+
+    std::vector<T> partials(num_blocks * type_length, T(0));
+
+    auto reduce_task = [&](size_t b) {
+        const int begin = int(b) * block_size;
+        const int end = std::min(begin + block_size, count);
+        reduce_block(begin, end, &partials[b * type_length]);
+    };
+
+    _wp_parallel_for_each(num_blocks, reduce_task);
+
+    for (int k = 0; k < type_length; ++k)
+    {
+        T sum = T(0);
+        for (int b = 0; b < num_blocks; ++b)
+            sum += partials[b * type_length + k];
+        out[k] = sum;
+    }
+}
+
 } // namespace
 
 template <typename T>
@@ -66,11 +101,12 @@ void array_inner_host(const T *ptr_a, const T *ptr_b, T *ptr_out, int count, int
         inner_func = dyn_len_inner<T>;
     }
 
-    *ptr_out = 0.0f;
-    for (int i = 0; i < count; ++i)
-    {
-        inner_func(ptr_a + i * stride_a, ptr_b + i * stride_b, ptr_out, type_length);
-    }
+    parallel_sum(count, 1, ptr_out, [&](int begin, int end, T *partial) {
+        for (int i = begin; i < end; ++i)
+        {
+            inner_func(ptr_a + i * stride_a, ptr_b + i * stride_b, partial, type_length);
+        }
+    });
 }
 
 template <typename T> void array_sum_host(const T *ptr_a, T *ptr_out, int count, int byte_stride, int type_length)
@@ -97,9 +133,89 @@ template <typename T> void array_sum_host(const T *ptr_a, T *ptr_out, int count,
         accumulate_func = dyn_len_sum<T>;
     }
 
-    *ptr_out = 0.0f;
-    for (int i = 0; i < count; ++i)
-        accumulate_func(ptr_a + i * stride, ptr_out, type_length);
+    parallel_sum(count, type_length, ptr_out, [&](int begin, int end, T *partial) {
+        for (int i = begin; i < end; ++i)
+            accumulate_func(ptr_a + i * stride, partial, type_length);
+    });
+}
+
+template <typename T>
+void array_stats_host(const T *ptr_a, int count, int byte_stride, int type_length, T *out_sum, T *out_min, T *out_max,
+                      int *out_argmin, int *out_argmax)
+{
+    assert((byte_stride % sizeof(T)) == 0);
+    const int stride = byte_stride / sizeof(T);
+
+    const int num_blocks = std::max(1, std::min((count + kReduceBlockSize - 1) / kReduceBlockSize, kReduceMaxBlocks));
+    const int block_size = (count + num_blocks - 1) / num_blocks;
+
+    std::vector<T> sum(num_blocks * type_length, T(0));
+    std::vector<T> min(num_blocks * type_length, std::numeric_limits<T>::max());
+    std::vector<T> max(num_blocks * type_length, std::numeric_limits<T>::lowest());
+    std::vector<int> argmin(num_blocks * type_length, -1);
+    std::vector<int> argmax(num_blocks * type_length, -1);
+
+    // all statistics are gathered in a single pass over the array, ties resolve to the first index
+    auto reduce_block = [&](size_t b) {
+        const int begin = int(b) * block_size;
+        const int end = std::min(begin + block_size, count);
+        const int offset = int(b) * type_length;
+
+        for (int i = begin; i < end; ++i)
+        {
+            const T *val = ptr_a + i * stride;
+            for (int k = 0; k < type_length; ++k)
+            {
+                sum[offset + k] += val[k];
+                if (argmin[offset + k] < 0 || val[k] < min[offset + k])
+                {
+                    min[offset + k] = val[k];
+                    argmin[offset + k] = i;
+                }
+                if (argmax[offset + k] < 0 || val[k] > max[offset + k])
+                {
+                    max[offset + k] = val[k];
+                    argmax[offset + k] = i;
+                }
+            }
+        }
+    };
+
+    _wp_parallel_for_each(num_blocks, reduce_block);
+
+    // combine partials in block order, so that ties still resolve to the first index
+    for (int b = 1; b < num_blocks; ++b)
+    {
+        const int offset = b * type_length;
+        for (int k = 0; k < type_length; ++k)
+        {
+            sum[k] += sum[offset + k];
+            if (argmin[offset + k] >= 0 && (argmin[k] < 0 || min[offset + k] < min[k]))
+            {
+                min[k] = min[offset + k];
+                argmin[k] = argmin[offset + k];
+            }
+            if (argmax[offset + k] >= 0 && (argmax[k] < 0 || max[offset + k] > max[k]))
+            {
+                max[k] = max[offset + k];
+                argmax[k] = argmax[offset + k];
+            }
+        }
+    }
+
+    for (int k = 0; k < type_length; ++k)
+    {
+        if (out_sum)
+            out_sum[k] = sum[k];
+        if (out_min)
+            out_min[k] = min[k];
+        if (out_max)
+            out_max[k] = max[k];
+        if (out_argmin)
+            out_argmin[k] = argmin[k];
+        if (out_argmax)
+            out_argmax[k] = argmax[k];
+    }
 }
 
 void array_inner_float_host(uint64_t a, uint64_t b, uint64_t out, int count, int byte_stride_a, int byte_stride_b,
@@ -136,6 +252,20 @@ void array_sum_double_host(uint64_t a, uint64_t out, int count, int byte_stride_
     array_sum_host(ptr_a, ptr_out, count, byte_stride_a, type_length);
 }
 
+void array_stats_float_host(uint64_t a, int count, int byte_stride, int type_length, uint64_t out_sum, uint64_t out_min,
+                            uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax)
+{
+    array_stats_host((const float *)(a), count, byte_stride, type_length, (float *)(out_sum), (float *)(out_min),
+                     (float *)(out_max), (int *)(out_argmin), (int *)(out_argmax));
+}
+
+void array_stats_double_host(uint64_t a, int count, int byte_stride, int type_length, uint64_t out_sum,
+                             uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax)
+{
+    array_stats_host((const double *)(a), count, byte_stride, type_length, (double *)(out_sum), (double *)(out_min),
+                     (double *)(out_max), (int *)(out_argmin), (int *)(out_argmax));
+}
+
 #if !WP_ENABLE_CUDA
 void array_inner_float_device(uint64_t a, uint64_t b, uint64_t out, int count, int byte_stride_a, int byte_stride_b,
                               int type_length)
@@ -154,4 +284,14 @@ void array_sum_float_device(uint64_t a, uint64_t out, int count, int byte_stride
 void array_sum_double_device(uint64_t a, uint64_t out, int count, int byte_stride_a, int type_length)
 {
 }
+
+void array_stats_float_device(uint64_t a, int count, int byte_stride, int type_length, uint64_t out_sum,
+                              uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax)
+{
+}
+
+void array_stats_double_device(uint64_t a, int count, int byte_stride, int type_length, uint64_t out_sum,
+                               uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax)
+{
+}
 #endif
\ No newline at end of file
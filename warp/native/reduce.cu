@@ -7,6 +7,9 @@
 #define THRUST_IGNORE_CUB_VERSION_CHECK
 #include <cub/device/device_reduce.cuh>
 #include <cub/iterator/counting_input_iterator.cuh>
+#include <cub/iterator/transform_input_iterator.cuh>
+
+#include <limits>
 
 namespace
 {
@@ -309,6 +312,164 @@ void array_inner_device_dispatch(const T *ptr_a, const T *ptr_b, T *ptr_out, int
     return array_inner_device(ptr_a, ptr_b, ptr_out, count, byte_stride_a, byte_stride_b, type_length);
 }
 
+/// Per-component statistics of a contiguous group of N scalars, reduced in a single pass
+template <unsigned N, typename T> struct array_stats_t
+{
+    T sum[N];
+    T min[N];
+    T max[N];
+    int argmin[N];
+    int argmax[N];
+};
+
+/// Loads the statistics of a single element, for use with cub::TransformInputIterator
+template <unsigned N, typename T> struct array_stats_load
+{
+    const T *ptr;
+    int stride;
+
+    CUDA_CALLABLE array_stats_t<N, T> operator()(int i) const
+    {
+        array_stats_t<N, T> stats;
+        const T *val = ptr + i * stride;
+        for (int k = 0; k < N; ++k)
+        {
+            stats.sum[k] = val[k];
+            stats.min[k] = val[k];
+            stats.max[k] = val[k];
+            stats.argmin[k] = i;
+            stats.argmax[k] = i;
+        }
+        return stats;
+    }
+};
+
+/// Combines partial statistics, ties resolve to the first index and negative indices denote empty partials
+template <unsigned N, typename T> struct array_stats_reduce
+{
+    CUDA_CALLABLE array_stats_t<N, T> operator()(const array_stats_t<N, T> &a, const array_stats_t<N, T> &b) const
+    {
+        array_stats_t<N, T> stats;
+        for (int k = 0; k < N; ++k)
+        {
+            stats.sum[k] = a.sum[k] + b.sum[k];
+
+            const bool b_min =
+                a.argmin[k] < 0 || (b.argmin[k] >= 0 && (b.min[k] < a.min[k] ||
+                                                          (b.min[k] == a.min[k] && b.argmin[k] < a.argmin[k])));
+            stats.min[k] = b_min ? b.min[k] : a.min[k];
+            stats.argmin[k] = b_min ? b.argmin[k] : a.argmin[k];
+
+            const bool b_max =
+                a.argmax[k] < 0 || (b.argmax[k] >= 0 && (b.max[k] > a.max[k] ||
+                                                          (b.max[k] == a.max[k] && b.argmax[k] < a.argmax[k])));
+            stats.max[k] = b_max ? b.max[k] : a.max[k];
+            stats.argmax[k] = b_max ? b.argmax[k] : a.argmax[k];
+        }
+        return stats;
+    }
+};
+
+template <unsigned N, typename T>
+__global__ void array_stats_store_kernel(const array_stats_t<N, T> *stats, T *out_sum, T *out_min, T *out_max,
+                                         int *out_argmin, int *out_argmax)
+{
+    int k = blockIdx.x * blockDim.x + threadIdx.x;
+    if (k >= N)
+        return;
+
+    if (out_sum)
+        out_sum[k] = stats->sum[k];
+    if (out_min)
+        out_min[k] = stats->min[k];
+    if (out_max)
+        out_max[k] = stats->max[k];
+    if (out_argmin)
+        out_argmin[k] = stats->argmin[k];
+    if (out_argmax)
+        out_argmax[k] = stats->argmax[k];
+}
+
+template <unsigned N, typename T>
+void array_stats_device(const T *ptr_a, int count, int byte_stride, int type_length, T *out_sum, T *out_min,
+                        T *out_max, int *out_argmin, int *out_argmax)
+{
+    assert((byte_stride % sizeof(T)) == 0);
+    const int stride = byte_stride / sizeof(T);
+
+    ContextGuard guard(cuda_context_get_current());
+    cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+
+    using stats_t = array_stats_t<N, T>;
+    using iterator_t = cub::TransformInputIterator<stats_t, array_stats_load<N, T>, cub::CountingInputIterator<int>>;
+
+    stats_t init;
+    for (int k = 0; k < N; ++k)
+    {
+        init.sum[k] = T(0);
+        init.min[k] = std::numeric_limits<T>::max();
+        init.max[k] = std::numeric_limits<T>::lowest();
+        init.argmin[k] = -1;
+        init.argmax[k] = -1;
+    }
+
+    cub::CountingInputIterator<int> indices(0);
+    iterator_t stats_iterator(indices, array_stats_load<N, T>{ptr_a, stride});
+
+    size_t buff_size = 0;
+    check_cuda(cub::DeviceReduce::Reduce(nullptr, buff_size, stats_iterator, (stats_t *)nullptr, count,
+                                         array_stats_reduce<N, T>(), init, stream));
+
+    // the reduced statistics are followed by the cub temporary storage
+    const size_t stats_size = (sizeof(stats_t) + 255) / 256 * 256;
+    void *temp_buffer = alloc_temp_device(WP_CURRENT_CONTEXT, stats_size + buff_size);
+    stats_t *stats = static_cast<stats_t *>(temp_buffer);
+
+    // groups of N components are reduced together, which is a single pass for common vector types
+    for (int k = 0; k < type_length; k += N)
+    {
+        iterator_t chunk_iterator(indices, array_stats_load<N, T>{ptr_a + k, stride});
+        check_cuda(cub::DeviceReduce::Reduce(static_cast<char *>(temp_buffer) + stats_size, buff_size, chunk_iterator,
+                                             stats, count, array_stats_reduce<N, T>(), init, stream));
+
+        auto store_kernel = array_stats_store_kernel<N, T>;
+        wp_launch_device(WP_CURRENT_CONTEXT, store_kernel, N,
+                         (stats, out_sum ? out_sum + k : nullptr, out_min ? out_min + k : nullptr,
+                          out_max ? out_max + k : nullptr, out_argmin ? out_argmin + k : nullptr,
+                          out_argmax ? out_argmax + k : nullptr));
+    }
+
+    free_temp_device(WP_CURRENT_CONTEXT, temp_buffer);
+}
+
+template <typename T>
+void array_stats_device_dispatch(const T *ptr_a, int count, int byte_stride, int type_length, T *out_sum, T *out_min,
+                                 T *out_max, int *out_argmin, int *out_argmax)
+{
+    // specialized calls for common vector types
+
+    if ((type_length % 4) == 0)
+    {
+        return array_stats_device<4>(ptr_a, count, byte_stride, type_length, out_sum, out_min, out_max, out_argmin,
+                                     out_argmax);
+    }
+
+    if ((type_length % 3) == 0)
+    {
+        return array_stats_device<3>(ptr_a, count, byte_stride, type_length, out_sum, out_min, out_max, out_argmin,
+                                     out_argmax);
+    }
+
+    if ((type_length % 2) == 0)
+    {
+        return array_stats_device<2>(ptr_a, count, byte_stride, type_length, out_sum, out_min, out_max, out_argmin,
+                                     out_argmax);
+    }
+
+    return array_stats_device<1>(ptr_a, count, byte_stride, type_length, out_sum, out_min, out_max, out_argmin,
+                                 out_argmax);
+}
+
 } // anonymous namespace
 
 void array_inner_float_device(uint64_t a, uint64_t b, uint64_t out, int count, int byte_stride_a, int byte_stride_b,
@@ -346,3 +507,17 @@ void array_sum_double_device(uint64_t a, uint64_t out, int count, int byte_strid
     double *ptr_out = (double *)(out);
     array_sum_device_dispatch(ptr_a, ptr_out, count, byte_stride, type_length);
 }
+
+void array_stats_float_device(uint64_t a, int count, int byte_stride, int type_length, uint64_t out_sum,
+                              uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax)
+{
+    array_stats_device_dispatch((const float *)(a), count, byte_stride, type_length, (float *)(out_sum),
+                                (float *)(out_min), (float *)(out_max), (int *)(out_argmin), (int *)(out_argmax));
+}
+
+void array_stats_double_device(uint64_t a, int count, int byte_stride, int type_length, uint64_t out_sum,
+                               uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax)
+{
+    array_stats_device_dispatch((const double *)(a), count, byte_stride, type_length, (double *)(out_sum),
+                                (double *)(out_min), (double *)(out_max), (int *)(out_argmin), (int *)(out_argmax));
+}
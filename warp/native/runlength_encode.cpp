@@ -2,6 +2,22 @@
 
 #include <cstdint>
 
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+// items per block, each block is processed by a single thread
+const int kMinBlockSize = 1 << 16;
+const int kMaxBlocks = 256;
+
+} // anonymous namespace
+
+// Runs start wherever a value differs from its predecessor. A first parallel
+// pass counts run starts per block, which are scanned to give each block the
+// index of its first run, then a second pass writes run values and lengths.
+// The last run of a block ends at the first run start of the following blocks.
 template <typename T>
 void runlength_encode_host(int n,
                            const T *values,
@@ -15,25 +31,65 @@ void runlength_encode_host(int n,
         return;
     }
 
-    const T *end = values + n;
+    const int num_blocks = std::min((n + kMinBlockSize - 1) / kMinBlockSize, kMaxBlocks);
+    const int block_size = (n + num_blocks - 1) / num_blocks;
 
-    *run_count = 1;
-    *run_lengths = 1;
-    *run_values = *values;
+    std::vector<int> block_runs(num_blocks + 1, 0);
+    std::vector<int> block_first_start(num_blocks + 1, n);
 
-    while (++values != end)
+    auto count_block = [&](size_t b)
     {
-        if (*values == *run_values)
+        const int begin = int(b) * block_size;
+        const int end = std::min(begin + block_size, n);
+
+        int count = 0;
+        for (int i = begin; i < end; ++i)
         {
-            ++*run_lengths;
+            if (i == 0 || !(values[i] == values[i - 1]))
+            {
+                if (count == 0)
+                    block_first_start[b] = i;
+                ++count;
+            }
         }
-        else
+        block_runs[b + 1] = count;
+    };
+
+    _wp_parallel_for_each(num_blocks, count_block);
+
+    for (int b = 0; b < num_blocks; ++b)
+        block_runs[b + 1] += block_runs[b];
+
+    // first run start at or after each block
+    for (int b = num_blocks - 1; b >= 0; --b)
+        block_first_start[b] = std::min(block_first_start[b], block_first_start[b + 1]);
+
+    auto encode_block = [&](size_t b)
+    {
+        const int begin = int(b) * block_size;
+        const int end = std::min(begin + block_size, n);
+
+        int run = block_runs[b];
+        int run_start = -1;
+        for (int i = begin; i < end; ++i)
         {
-            ++*run_count;
-            *(++run_lengths) = 1;
-            *(++run_values) = *values;
+            if (i == 0 || !(values[i] == values[i - 1]))
+            {
+                if (run_start >= 0)
+                    run_lengths[run++] = i - run_start;
+
+                run_values[run] = values[i];
+                run_start = i;
+            }
         }
-    }
+
+        if (run_start >= 0)
+            run_lengths[run] = block_first_start[b + 1] - run_start;
+    };
+
+    _wp_parallel_for_each(num_blocks, encode_block);
+
+    *run_count = block_runs[num_blocks];
 }
 
 void runlength_encode_int_host(
@@ -1,30 +1,125 @@
 #include "scan.h"
 
-#include <numeric>
+#include <algorithm>
+#include <vector>
 
+namespace
+{
+
+// items per block, each block is processed by a single thread
+const int kScanBlockSize = 1 << 16;
+const int kScanMaxBlocks = 256;
+
+} // anonymous namespace
+
+// Two-pass block scan: per-block totals are computed in parallel and scanned
+// serially, then each block is scanned from its offset. The block partition
+// only depends on n so results do not vary with the number of threads.
+// Values are loaded before being written, which allows in-place scans.
+// Per-block totals only cover elements after the last segment head of the
+// block, and do not propagate past blocks that contain a head.
 template<typename T>
-void scan_host(const T* values_in, T* values_out, int n, bool inclusive)
+void scan_vec_host(const T* values_in, T* values_out, int n, int type_length, bool inclusive, const int* segment_offsets, int num_segments)
 {
-    static void* scan_temp_memory = NULL;
-    static size_t scan_temp_max_size = 0;
+    if (n <= 0 || type_length <= 0)
+        return;
 
-    // compute temporary memory required
-    if (!inclusive && n > scan_temp_max_size)
+    std::vector<char> heads;
+    if (segment_offsets && num_segments > 0)
     {
-	    free_host(scan_temp_memory);
-        scan_temp_memory = alloc_host(sizeof(T) * n);
-        scan_temp_max_size = n;
+        heads.resize(n, 0);
+        for (int s=0; s < num_segments; ++s)
+        {
+            if (segment_offsets[s] < segment_offsets[s + 1] && segment_offsets[s] < n)
+                heads[segment_offsets[s]] = 1;
+        }
     }
 
-    T* result = inclusive ? values_out : static_cast<T*>(scan_temp_memory);
+    const bool segmented = !heads.empty();
+
+    const int num_blocks = std::min((n + kScanBlockSize - 1)/kScanBlockSize, kScanMaxBlocks);
+    const int block_size = (n + num_blocks - 1)/num_blocks;
+
+    std::vector<T> block_offsets(num_blocks*type_length, T(0));
+
+    if (num_blocks > 1)
+    {
+        std::vector<char> block_has_head(num_blocks, 0);
+
+        auto sum_block = [&](size_t b)
+        {
+            const int begin = int(b)*block_size;
+            const int end = std::min(begin + block_size, n);
+
+            T* sum = &block_offsets[b*type_length];
+            for (int i=begin; i < end; ++i)
+            {
+                if (segmented && heads[i])
+                {
+                    block_has_head[b] = 1;
+                    std::fill(sum, sum + type_length, T(0));
+                }
+
+                for (int k=0; k < type_length; ++k)
+                    sum[k] += values_in[i*type_length + k];
+            }
+        };
 
-    // scan
-    std::partial_sum(values_in, values_in + n, result);
-    if (!inclusive) {
-        values_out[0] = (T)0;
-        memcpy_h2h(values_out + 1, result, sizeof(T) * (n - 1));
+        _wp_parallel_for_each(num_blocks, sum_block);
+
+        std::vector<T> offset(type_length, T(0));
+        for (int b=0; b < num_blocks; ++b)
+        {
+            T* sum = &block_offsets[b*type_length];
+            for (int k=0; k < type_length; ++k)
+            {
+                const T block_sum = sum[k];
+                sum[k] = offset[k];
+                offset[k] = block_has_head[b] ? block_sum : offset[k] + block_sum;
+            }
+        }
     }
+
+    auto scan_block = [&](size_t b)
+    {
+        const int begin = int(b)*block_size;
+        const int end = std::min(begin + block_size, n);
+
+        std::vector<T> sum(block_offsets.begin() + b*type_length, block_offsets.begin() + (b + 1)*type_length);
+        for (int i=begin; i < end; ++i)
+        {
+            if (segmented && heads[i])
+                std::fill(sum.begin(), sum.end(), T(0));
+
+            for (int k=0; k < type_length; ++k)
+            {
+                const T value = values_in[i*type_length + k];
+                if (inclusive)
+                {
+                    sum[k] += value;
+                    values_out[i*type_length + k] = sum[k];
+                }
+                else
+                {
+                    values_out[i*type_length + k] = sum[k];
+                    sum[k] += value;
+                }
+            }
+        }
+    };
+
+    _wp_parallel_for_each(num_blocks, scan_block);
+}
+
+template<typename T>
+void scan_host(const T* values_in, T* values_out, int n, bool inclusive)
+{
+    scan_vec_host(values_in, values_out, n, 1, inclusive, (const int*)NULL, 0);
 }
 
 template void scan_host(const int*, int*, int, bool);
 template void scan_host(const float*, float*, int, bool);
+
+template void scan_vec_host(const int*, int*, int, int, bool, const int*, int);
+template void scan_vec_host(const float*, float*, int, int, bool, const int*, int);
+template void scan_vec_host(const double*, double*, int, int, bool, const int*, int);
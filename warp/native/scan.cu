@@ -34,3 +34,280 @@ void scan_device(const T* values_in, T* values_out, int n, bool inclusive)
 
 template void scan_device(const int*, int*, int, bool);
 template void scan_device(const float*, float*, int, bool);
+
+
+#include "temp_buffer.h"
+
+namespace
+{
+
+const int kScanBlockDim = 128;
+const int kScanItemsPerThread = 4;
+const int kScanTileSize = kScanBlockDim*kScanItemsPerThread;
+
+// tile status for the decoupled look-back
+const int kTileInvalid = 0;
+const int kTileAggregate = 1;
+const int kTilePrefix = 2;
+
+// persistent scratch memory per context, see DeviceTemporaryBuffer
+struct ScanTemporaryBuffers
+{
+    DeviceTemporaryBuffer tile_states;
+    DeviceTemporaryBuffer heads;
+};
+
+std::unordered_map<void*, ScanTemporaryBuffers> g_scan_temp_buffer_map;
+
+// Partial scan result: the sum of a range of elements restarted at the last segment head of the range,
+// and whether the range contains a segment head. Combining is associative but not commutative.
+template <typename E>
+struct scan_item
+{
+    E value;
+    int head;
+};
+
+template <typename E>
+CUDA_CALLABLE inline scan_item<E> scan_combine(const scan_item<E>& a, const scan_item<E>& b)
+{
+    scan_item<E> r;
+    r.head = a.head | b.head;
+    r.value = b.head ? b.value : wp::add(a.value, b.value);
+    return r;
+}
+
+template <typename E>
+struct scan_tile_state
+{
+    int status;
+    scan_item<E> aggregate;
+    scan_item<E> prefix;
+};
+
+// tile states are exchanged between blocks, loads and stores bypass the non-coherent L1 cache
+template <unsigned N, typename T>
+__device__ inline void scan_store_cg(scan_item<wp::vec_t<N, T>>* dst, const scan_item<wp::vec_t<N, T>>& src)
+{
+    for (unsigned k=0; k < N; ++k)
+        __stcg(&dst->value.c[k], src.value.c[k]);
+    __stcg(&dst->head, src.head);
+}
+
+template <unsigned N, typename T>
+__device__ inline scan_item<wp::vec_t<N, T>> scan_load_cg(const scan_item<wp::vec_t<N, T>>* src)
+{
+    scan_item<wp::vec_t<N, T>> r;
+    for (unsigned k=0; k < N; ++k)
+        r.value.c[k] = __ldcg(&src->value.c[k]);
+    r.head = __ldcg(&src->head);
+    return r;
+}
+
+template <typename E>
+__device__ inline void scan_publish(scan_tile_state<E>* state, int status, const scan_item<E>& item)
+{
+    scan_store_cg(status == kTilePrefix ? &state->prefix : &state->aggregate, item);
+    __threadfence();
+    atomicExch(&state->status, status);
+}
+
+__global__ void scan_mark_segment_heads(int n, int num_segments, const int* segment_offsets, int* heads)
+{
+    const int s = blockIdx.x*blockDim.x + threadIdx.x;
+    if (s >= num_segments)
+        return;
+
+    const int begin = segment_offsets[s];
+    if (begin < segment_offsets[s + 1] && begin < n)
+        heads[begin] = 1;
+}
+
+// Single-pass scan with decoupled look-back (Merrill & Garland). Tiles are numbered in
+// scheduling order so that predecessors are always resident, each tile publishes its
+// aggregate, then walks back over predecessor tiles until it finds an inclusive prefix
+// (or a segment head), and publishes its own inclusive prefix.
+// Elements are N components located every stride scalars, values are read before
+// being written so that the scan can be done in place.
+template <unsigned N, typename T>
+__global__ void scan_tiles_kernel(int n, int stride, bool inclusive, const T* values_in, T* values_out,
+                                  const int* heads, scan_tile_state<wp::vec_t<N, T>>* tile_states, int* tile_counter)
+{
+    typedef wp::vec_t<N, T> E;
+    typedef scan_item<E> item_t;
+
+    // raw storage since shared variables cannot have constructors
+    __shared__ int s_tile;
+    __shared__ __align__(16) char s_storage[sizeof(item_t)*(kScanBlockDim + 1)];
+
+    item_t* s_thread_totals = reinterpret_cast<item_t*>(s_storage);
+    item_t& s_tile_prefix = s_thread_totals[kScanBlockDim];
+
+    if (threadIdx.x == 0)
+        s_tile = atomicAdd(tile_counter, 1);
+    __syncthreads();
+
+    const int tile = s_tile;
+    const int begin = tile*kScanTileSize + threadIdx.x*kScanItemsPerThread;
+
+    // sequential scan of the items of each thread
+    item_t items[kScanItemsPerThread];
+    item_t total = {};
+    for (int j=0; j < kScanItemsPerThread; ++j)
+    {
+        const int i = begin + j;
+
+        item_t item = {};
+        if (i < n)
+        {
+            for (unsigned k=0; k < N; ++k)
+                item.value.c[k] = values_in[i*stride + k];
+            item.head = heads ? heads[i] : 0;
+        }
+
+        items[j] = item;
+        total = scan_combine(total, item);
+    }
+
+    // block-wide inclusive scan of the thread totals
+    s_thread_totals[threadIdx.x] = total;
+    __syncthreads();
+
+    for (int offset=1; offset < kScanBlockDim; offset *= 2)
+    {
+        item_t t = s_thread_totals[threadIdx.x];
+        if (threadIdx.x >= offset)
+            t = scan_combine(s_thread_totals[threadIdx.x - offset], t);
+        __syncthreads();
+        s_thread_totals[threadIdx.x] = t;
+        __syncthreads();
+    }
+
+    if (threadIdx.x == 0)
+    {
+        const item_t tile_aggregate = s_thread_totals[kScanBlockDim - 1];
+
+        item_t exclusive = {};
+        if (tile == 0)
+        {
+            scan_publish(&tile_states[tile], kTilePrefix, tile_aggregate);
+        }
+        else
+        {
+            scan_publish(&tile_states[tile], kTileAggregate, tile_aggregate);
+
+            // elements before a segment head do not contribute, which ends the look-back early
+            for (int pred=tile - 1; pred >= 0 && !exclusive.head; --pred)
+            {
+                int status;
+                while ((status = atomicAdd(&tile_states[pred].status, 0)) == kTileInvalid) {}
+                __threadfence();
+
+                if (status == kTilePrefix)
+                {
+                    exclusive = scan_combine(scan_load_cg(&tile_states[pred].prefix), exclusive);
+                    break;
+                }
+
+                exclusive = scan_combine(scan_load_cg(&tile_states[pred].aggregate), exclusive);
+            }
+
+            scan_publish(&tile_states[tile], kTilePrefix, scan_combine(exclusive, tile_aggregate));
+        }
+
+        s_tile_prefix = exclusive;
+    }
+    __syncthreads();
+
+    item_t running = s_tile_prefix;
+    if (threadIdx.x > 0)
+        running = scan_combine(running, s_thread_totals[threadIdx.x - 1]);
+
+    for (int j=0; j < kScanItemsPerThread; ++j)
+    {
+        const int i = begin + j;
+        if (i >= n)
+            break;
+
+        const item_t& item = items[j];
+        E result;
+        if (inclusive)
+        {
+            running = scan_combine(running, item);
+            result = running.value;
+        }
+        else
+        {
+            // exclusive scans restart from zero at segment heads
+            result = item.head ? E() : running.value;
+            running = scan_combine(running, item);
+        }
+
+        for (unsigned k=0; k < N; ++k)
+            values_out[i*stride + k] = result.c[k];
+    }
+}
+
+template <unsigned N, typename T>
+void scan_vec_device_impl(const T* values_in, T* values_out, int n, int type_length, bool inclusive, const int* heads)
+{
+    typedef scan_tile_state<wp::vec_t<N, T>> state_t;
+
+    const int num_tiles = (n + kScanTileSize - 1)/kScanTileSize;
+
+    DeviceTemporaryBuffer& temp = g_scan_temp_buffer_map[WP_CURRENT_CONTEXT].tile_states;
+    temp.context = WP_CURRENT_CONTEXT;
+    temp.ensure_fits(sizeof(int)*4 + sizeof(state_t)*num_tiles);
+
+    int* tile_counter = static_cast<int*>(temp.buffer);
+    state_t* tile_states = reinterpret_cast<state_t*>(static_cast<char*>(temp.buffer) + sizeof(int)*4);
+
+    auto scan_kernel = scan_tiles_kernel<N, T>;
+
+    // N components at a time, a single pass for common vector types
+    for (int k=0; k < type_length; k += N)
+    {
+        memset_device(WP_CURRENT_CONTEXT, temp.buffer, 0, sizeof(int)*4 + sizeof(state_t)*num_tiles);
+
+        scan_kernel<<<num_tiles, kScanBlockDim, 0, static_cast<cudaStream_t>(cuda_stream_get_current())>>>(
+            n, type_length, inclusive, values_in + k, values_out + k, heads, tile_states, tile_counter);
+        check_cuda(cuda_context_check(WP_CURRENT_CONTEXT));
+    }
+}
+
+} // anonymous namespace
+
+template<typename T>
+void scan_vec_device(const T* values_in, T* values_out, int n, int type_length, bool inclusive, const int* segment_offsets, int num_segments)
+{
+    if (n <= 0 || type_length <= 0)
+        return;
+
+    ContextGuard guard(cuda_context_get_current());
+
+    // segment head flags, elements before the first segment are scanned as a segment of their own
+    int* heads = NULL;
+    if (segment_offsets && num_segments > 0)
+    {
+        DeviceTemporaryBuffer& head_temp = g_scan_temp_buffer_map[WP_CURRENT_CONTEXT].heads;
+        head_temp.context = WP_CURRENT_CONTEXT;
+        head_temp.ensure_fits(sizeof(int)*n);
+
+        heads = static_cast<int*>(head_temp.buffer);
+        memset_device(WP_CURRENT_CONTEXT, heads, 0, sizeof(int)*n);
+        wp_launch_device(WP_CURRENT_CONTEXT, scan_mark_segment_heads, num_segments, (n, num_segments, segment_offsets, heads));
+    }
+
+    if (type_length % 4 == 0)
+        scan_vec_device_impl<4>(values_in, values_out, n, type_length, inclusive, heads);
+    else if (type_length % 3 == 0)
+        scan_vec_device_impl<3>(values_in, values_out, n, type_length, inclusive, heads);
+    else if (type_length % 2 == 0)
+        scan_vec_device_impl<2>(values_in, values_out, n, type_length, inclusive, heads);
+    else
+        scan_vec_device_impl<1>(values_in, values_out, n, type_length, inclusive, heads);
+}
+
+template void scan_vec_device(const int*, int*, int, int, bool, const int*, int);
+template void scan_vec_device(const float*, float*, int, int, bool, const int*, int);
+template void scan_vec_device(const double*, double*, int, int, bool, const int*, int);
@@ -5,3 +5,9 @@ void scan_host(const T* values_in, T* values_out, int n, bool inclusive = true);
 template<typename T>
 void scan_device(const T* values_in, T* values_out, int n, bool inclusive = true);
 
+// Scans of elements made of type_length scalars with component-wise addition. If segment_offsets
+// is not null, the scan restarts at the first element of every non-empty segment.
+template<typename T>
+void scan_vec_host(const T* values_in, T* values_out, int n, int type_length, bool inclusive, const int* segment_offsets, int num_segments);
+template<typename T>
+void scan_vec_device(const T* values_in, T* values_out, int n, int type_length, bool inclusive, const int* segment_offsets, int num_segments);
@@ -0,0 +1,126 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+// Segments are processed in parallel, each segment by a single thread.
+// Segment s covers [segment_offsets[s], segment_offsets[s+1]).
+template <typename T>
+void segmented_sort_pairs_host(T* keys, int* values, const int* segment_offsets, int num_segments)
+{
+    auto sort_segment = [&](size_t s)
+    {
+        const int begin = segment_offsets[s];
+        const int end = segment_offsets[s+1];
+
+        if (end - begin < 2)
+            return;
+
+        std::vector<std::pair<T, int>> pairs(end - begin);
+        for (int i=begin; i < end; ++i)
+            pairs[i-begin] = std::make_pair(keys[i], values[i]);
+
+        std::stable_sort(pairs.begin(), pairs.end(), [](const std::pair<T, int>& a, const std::pair<T, int>& b)
+        {
+            return a.first < b.first;
+        });
+
+        for (int i=begin; i < end; ++i)
+        {
+            keys[i] = pairs[i-begin].first;
+            values[i] = pairs[i-begin].second;
+        }
+    };
+
+    _wp_parallel_for_each(num_segments, sort_segment);
+}
+
+template <typename T, typename Op>
+void segmented_reduce_host(const T* values, T* out, const int* segment_offsets, int num_segments, T init, Op op)
+{
+    auto reduce_segment = [&](size_t s)
+    {
+        T result = init;
+        for (int i=segment_offsets[s]; i < segment_offsets[s+1]; ++i)
+            result = op(result, values[i]);
+
+        out[s] = result;
+    };
+
+    _wp_parallel_for_each(num_segments, reduce_segment);
+}
+
+// empty segments produce the identity of the operation, matching cub
+template <typename T>
+void segmented_reduce_host(const T* values, T* out, const int* segment_offsets, int num_segments, int op)
+{
+    switch (op)
+    {
+    case WP_SEGMENTED_REDUCE_SUM:
+        segmented_reduce_host(values, out, segment_offsets, num_segments, T(0), [](T a, T b) { return a + b; });
+        break;
+    case WP_SEGMENTED_REDUCE_MIN:
+        segmented_reduce_host(values, out, segment_offsets, num_segments, std::numeric_limits<T>::max(), [](T a, T b) { return std::min(a, b); });
+        break;
+    case WP_SEGMENTED_REDUCE_MAX:
+        segmented_reduce_host(values, out, segment_offsets, num_segments, std::numeric_limits<T>::lowest(), [](T a, T b) { return std::max(a, b); });
+        break;
+    }
+}
+
+} // anonymous namespace
+
+
+void segmented_sort_pairs_int_host(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments)
+{
+    segmented_sort_pairs_host(
+        reinterpret_cast<int *>(keys),
+        reinterpret_cast<int *>(values),
+        reinterpret_cast<const int *>(segment_offsets), num_segments);
+}
+
+void segmented_sort_pairs_float_host(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments)
+{
+    segmented_sort_pairs_host(
+        reinterpret_cast<float *>(keys),
+        reinterpret_cast<int *>(values),
+        reinterpret_cast<const int *>(segment_offsets), num_segments);
+}
+
+void segmented_reduce_int_host(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op)
+{
+    segmented_reduce_host(
+        reinterpret_cast<const int *>(values),
+        reinterpret_cast<int *>(out),
+        reinterpret_cast<const int *>(segment_offsets), num_segments, op);
+}
+
+void segmented_reduce_float_host(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op)
+{
+    segmented_reduce_host(
+        reinterpret_cast<const float *>(values),
+        reinterpret_cast<float *>(out),
+        reinterpret_cast<const int *>(segment_offsets), num_segments, op);
+}
+
+#if !WP_ENABLE_CUDA
+
+void segmented_sort_pairs_int_device(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments) {}
+void segmented_sort_pairs_float_device(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments) {}
+void segmented_reduce_int_device(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op) {}
+void segmented_reduce_float_device(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op) {}
+
+#endif // !WP_ENABLE_CUDA
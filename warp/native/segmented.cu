@@ -0,0 +1,112 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+#include "cuda_util.h"
+
+#define THRUST_IGNORE_CUB_VERSION_CHECK
+#include <cub/device/device_segmented_radix_sort.cuh>
+#include <cub/device/device_segmented_reduce.cuh>
+
+namespace
+{
+
+template <typename T>
+void segmented_sort_pairs_device(T* keys, int* values, int n, const int* segment_offsets, int num_segments)
+{
+    ContextGuard guard(cuda_context_get_current());
+    cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+
+    cub::DoubleBuffer<T> d_keys(keys, keys + n);
+    cub::DoubleBuffer<int> d_values(values, values + n);
+
+    size_t buff_size = 0;
+    check_cuda(cub::DeviceSegmentedRadixSort::SortPairs(
+        nullptr, buff_size, d_keys, d_values, n, num_segments,
+        segment_offsets, segment_offsets + 1, 0, int(sizeof(T))*8, stream));
+
+    void* temp_buffer = alloc_temp_device(WP_CURRENT_CONTEXT, buff_size);
+
+    check_cuda(cub::DeviceSegmentedRadixSort::SortPairs(
+        temp_buffer, buff_size, d_keys, d_values, n, num_segments,
+        segment_offsets, segment_offsets + 1, 0, int(sizeof(T))*8, stream));
+
+    free_temp_device(WP_CURRENT_CONTEXT, temp_buffer);
+
+    if (d_keys.Current() != keys)
+        memcpy_d2d(WP_CURRENT_CONTEXT, keys, d_keys.Current(), sizeof(T)*n);
+
+    if (d_values.Current() != values)
+        memcpy_d2d(WP_CURRENT_CONTEXT, values, d_values.Current(), sizeof(int)*n);
+}
+
+// runs one of cub's segmented reductions, empty segments produce the identity of the operation
+template <typename T>
+cudaError_t segmented_reduce(void* temp_buffer, size_t& buff_size, const T* values, T* out, const int* segment_offsets, int num_segments, int op, cudaStream_t stream)
+{
+    switch (op)
+    {
+    case WP_SEGMENTED_REDUCE_MIN:
+        return cub::DeviceSegmentedReduce::Min(temp_buffer, buff_size, values, out, num_segments, segment_offsets, segment_offsets + 1, stream);
+    case WP_SEGMENTED_REDUCE_MAX:
+        return cub::DeviceSegmentedReduce::Max(temp_buffer, buff_size, values, out, num_segments, segment_offsets, segment_offsets + 1, stream);
+    default:
+        return cub::DeviceSegmentedReduce::Sum(temp_buffer, buff_size, values, out, num_segments, segment_offsets, segment_offsets + 1, stream);
+    }
+}
+
+template <typename T>
+void segmented_reduce_device(const T* values, T* out, const int* segment_offsets, int num_segments, int op)
+{
+    ContextGuard guard(cuda_context_get_current());
+    cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+
+    size_t buff_size = 0;
+    check_cuda(segmented_reduce(nullptr, buff_size, values, out, segment_offsets, num_segments, op, stream));
+
+    void* temp_buffer = alloc_temp_device(WP_CURRENT_CONTEXT, buff_size);
+
+    check_cuda(segmented_reduce(temp_buffer, buff_size, values, out, segment_offsets, num_segments, op, stream));
+
+    free_temp_device(WP_CURRENT_CONTEXT, temp_buffer);
+}
+
+} // anonymous namespace
+
+
+void segmented_sort_pairs_int_device(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments)
+{
+    segmented_sort_pairs_device(
+        reinterpret_cast<int *>(keys),
+        reinterpret_cast<int *>(values), n,
+        reinterpret_cast<const int *>(segment_offsets), num_segments);
+}
+
+void segmented_sort_pairs_float_device(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments)
+{
+    segmented_sort_pairs_device(
+        reinterpret_cast<float *>(keys),
+        reinterpret_cast<int *>(values), n,
+        reinterpret_cast<const int *>(segment_offsets), num_segments);
+}
+
+void segmented_reduce_int_device(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op)
+{
+    segmented_reduce_device(
+        reinterpret_cast<const int *>(values),
+        reinterpret_cast<int *>(out),
+        reinterpret_cast<const int *>(segment_offsets), num_segments, op);
+}
+
+void segmented_reduce_float_device(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op)
+{
+    segmented_reduce_device(
+        reinterpret_cast<const float *>(values),
+        reinterpret_cast<float *>(out),
+        reinterpret_cast<const int *>(segment_offsets), num_segments, op);
+}
@@ -12,83 +12,249 @@
 
 #include <cstdint>
 
-void radix_sort_pairs_host(int* keys, int* values, int n)
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+
+// Maps keys to unsigned integers with the same ordering so that
+// all key types can share one LSD radix sort implementation
+template <typename Key>
+struct radix_key_traits;
+
+template <>
+struct radix_key_traits<int>
+{
+	typedef uint32_t bits_t;
+	static bits_t to_bits(int k) { return uint32_t(k) ^ 0x80000000u; }
+};
+
+template <>
+struct radix_key_traits<int64_t>
+{
+	typedef uint64_t bits_t;
+	static bits_t to_bits(int64_t k) { return uint64_t(k) ^ 0x8000000000000000ull; }
+};
+
+template <>
+struct radix_key_traits<uint64_t>
+{
+	typedef uint64_t bits_t;
+	static bits_t to_bits(uint64_t k) { return k; }
+};
+
+template <>
+struct radix_key_traits<float>
 {
-	static int tables[2][1 << 16];
-	memset(tables, 0, sizeof(tables));
-		
-	int* auxKeys = keys + n;
-	int* auxValues = values + n;
-
-	// build histograms
-	for (int i=0; i < n; ++i)
+	typedef uint32_t bits_t;
+	static bits_t to_bits(float k)
 	{
-		const unsigned short low = keys[i] & 0xffff;
-		const unsigned short high = keys[i] >> 16;
-		
-		++tables[0][low];
-		++tables[1][high];
+		uint32_t u;
+		memcpy(&u, &k, sizeof(u));
+
+		// negative floats have all bits flipped, positive floats only the sign bit
+		return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
 	}
-	
-	// convert histograms to offset tables in-place
-	int offlow = 0;
-	int offhigh = 0;
-	
-	for (int i=0; i < 65536; ++i)
+};
+
+const int kRadixBits = 8;
+const int kRadixSize = 1 << kRadixBits;
+
+// items per histogram block, each block is processed by a single thread
+const int kMinBlockSize = 1 << 14;
+const int kMaxBlocks = 256;
+
+// Stable LSD radix sort of (key, value) pairs, keys and values must have
+// storage for 2*n elements, the upper half is used as a scratch buffer.
+// The input is split into blocks with a histogram per block, scattering
+// block b's items after those of blocks [0, b) for each digit keeps the
+// sort stable and independent of the number of threads. Only the key bits
+// [begin_bit, end_bit) are sorted, the last digit may be narrower.
+template <typename Key>
+void radix_sort_pairs_host_impl(Key* keys, int* values, int n, int begin_bit, int end_bit)
+{
+	typedef radix_key_traits<Key> traits;
+	typedef typename traits::bits_t bits_t;
+
+	// skipping the passes where all keys share their digit already ignores the unused upper bits
+	if (end_bit == RADIX_SORT_ALL_BITS || end_bit == RADIX_SORT_AUTO_BITS)
+		end_bit = int(sizeof(bits_t))*8;
+
+	const int num_passes = (end_bit - begin_bit + kRadixBits - 1)/kRadixBits;
+
+	auto digit = [&](bits_t k, int p)
 	{
-		const int newofflow = offlow + tables[0][i];
-		const int newoffhigh = offhigh + tables[1][i];
-		
-		tables[0][i] = offlow;
-		tables[1][i] = offhigh;
-		
-		offlow = newofflow;
-		offhigh = newoffhigh;
-	}
-		
-	// pass 1 - sort by low 16 bits
-	for (int i=0; i < n; ++i)
+		const int shift = begin_bit + p*kRadixBits;
+		const int bits = std::min(kRadixBits, end_bit - shift);
+
+		return int((k >> shift) & ((bits_t(1) << bits) - 1));
+	};
+
+	if (n < 2)
+		return;
+
+	const int num_blocks = std::min((n + kMinBlockSize - 1)/kMinBlockSize, kMaxBlocks);
+	const int block_size = (n + num_blocks - 1)/num_blocks;
+
+	// histograms of every digit ahead of the first pass, used to skip passes
+	// where all keys share the same digit (e.g.: small or clustered keys)
+	std::vector<int> digit_counts(num_blocks*num_passes*kRadixSize, 0);
+
+	auto count_digits = [&](size_t b)
+	{
+		int* counts = &digit_counts[b*num_passes*kRadixSize];
+
+		const int begin = int(b)*block_size;
+		const int end = std::min(begin + block_size, n);
+
+		for (int i=begin; i < end; ++i)
+		{
+			const bits_t k = traits::to_bits(keys[i]);
+
+			for (int p=0; p < num_passes; ++p)
+				++counts[p*kRadixSize + digit(k, p)];
+		}
+	};
+
+	_wp_parallel_for_each(num_blocks, count_digits);
+
+	for (int b=1; b < num_blocks; ++b)
+		for (int i=0; i < num_passes*kRadixSize; ++i)
+			digit_counts[i] += digit_counts[b*num_passes*kRadixSize + i];
+
+	std::vector<int> offsets(num_blocks*kRadixSize);
+
+	Key* src_keys = keys;
+	int* src_values = values;
+	Key* dst_keys = keys + n;
+	int* dst_values = values + n;
+
+	for (int p=0; p < num_passes; ++p)
 	{
-		// lookup offset of input
-		const int k = keys[i];
-		const int v = values[i];
-		const int b = k & 0xffff;
-		
-		// find offset and increment
-		const int offset = tables[0][b]++;
-		
-		auxKeys[offset] = k;
-		auxValues[offset] = v;
-	}	
-		
-	// pass 2 - sort by high 16 bits
-	for (int i=0; i < n; ++i)
+		const int first_digit = digit(traits::to_bits(keys[0]), p);
+
+		if (digit_counts[p*kRadixSize + first_digit] == n)
+			continue;
+
+		// per-block histograms of the current order
+		auto count_block = [&](size_t b)
+		{
+			int* counts = &offsets[b*kRadixSize];
+			memset(counts, 0, sizeof(int)*kRadixSize);
+
+			const int begin = int(b)*block_size;
+			const int end = std::min(begin + block_size, n);
+
+			for (int i=begin; i < end; ++i)
+				++counts[digit(traits::to_bits(src_keys[i]), p)];
+		};
+
+		_wp_parallel_for_each(num_blocks, count_block);
+
+		// convert histograms to offsets in-place, digit-major then block order
+		int offset = 0;
+		for (int d=0; d < kRadixSize; ++d)
+		{
+			for (int b=0; b < num_blocks; ++b)
+			{
+				const int count = offsets[b*kRadixSize + d];
+				offsets[b*kRadixSize + d] = offset;
+				offset += count;
+			}
+		}
+
+		auto scatter_block = [&](size_t b)
+		{
+			int* block_offsets = &offsets[b*kRadixSize];
+
+			const int begin = int(b)*block_size;
+			const int end = std::min(begin + block_size, n);
+
+			for (int i=begin; i < end; ++i)
+			{
+				const Key k = src_keys[i];
+				const int o = block_offsets[digit(traits::to_bits(k), p)]++;
+
+				dst_keys[o] = k;
+				dst_values[o] = src_values[i];
+			}
+		};
+
+		_wp_parallel_for_each(num_blocks, scatter_block);
+
+		std::swap(src_keys, dst_keys);
+		std::swap(src_values, dst_values);
+	}
+
+	// an odd number of passes leaves the result in the scratch buffer
+	if (src_keys != keys)
 	{
-		// lookup offset of input
-		const int k = auxKeys[i];
-		const int v = auxValues[i];
-
-		const int b = k >> 16;
-		
-		const int offset = tables[1][b]++;
-		
-		keys[offset] = k;
-		values[offset] = v;
-	}	
+		memcpy(keys, src_keys, sizeof(Key)*n);
+		memcpy(values, src_values, sizeof(int)*n);
+	}
+}
+
+} // anonymous namespace
+
+
+void radix_sort_pairs_host(int* keys, int* values, int n, int begin_bit, int end_bit)
+{
+	radix_sort_pairs_host_impl(keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_host(int64_t* keys, int* values, int n, int begin_bit, int end_bit)
+{
+	radix_sort_pairs_host_impl(keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_host(uint64_t* keys, int* values, int n, int begin_bit, int end_bit)
+{
+	radix_sort_pairs_host_impl(keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_host(float* keys, int* values, int n, int begin_bit, int end_bit)
+{
+	radix_sort_pairs_host_impl(keys, values, n, begin_bit, end_bit);
 }
 
 #if !WP_ENABLE_CUDA
 
 void radix_sort_reserve(void* context, int n, void** mem_out, size_t* size_out) {}
+void radix_sort_reserve_uint64(void* context, int n) {}
 
-void radix_sort_pairs_int_device(uint64_t keys, uint64_t values, int n) {}
+void radix_sort_pairs_int_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit) {}
+void radix_sort_pairs_int64_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit) {}
+void radix_sort_pairs_uint64_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit) {}
+void radix_sort_pairs_float_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit) {}
 
 #endif // !WP_ENABLE_CUDA
 
 
-void radix_sort_pairs_int_host(uint64_t keys, uint64_t values, int n)
+void radix_sort_pairs_int_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
 {
     radix_sort_pairs_host(
         reinterpret_cast<int *>(keys),
-        reinterpret_cast<int *>(values), n);
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_int64_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_host(
+        reinterpret_cast<int64_t *>(keys),
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_uint64_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_host(
+        reinterpret_cast<uint64_t *>(keys),
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_float_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_host(
+        reinterpret_cast<float *>(keys),
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
 }
@@ -8,13 +8,16 @@
 
 #include "warp.h"
 #include "cuda_util.h"
+#include "memory_stats.h"
 #include "sort.h"
 
 #define THRUST_IGNORE_CUB_VERSION_CHECK
 
 #include <cub/cub.cuh>
 
+#include <algorithm>
 #include <map>
+#include <type_traits>
 
 // temporary buffer for radix sort
 struct RadixSortTemp
@@ -27,11 +30,15 @@ struct RadixSortTemp
 static std::map<void*, RadixSortTemp> g_radix_sort_temp_map;
 
 
-void radix_sort_reserve(void* context, int n, void** mem_out, size_t* size_out)
+namespace
+{
+
+template <typename Key>
+void radix_sort_reserve_typed(void* context, int n, void** mem_out, size_t* size_out)
 {
     ContextGuard guard(context);
 
-    cub::DoubleBuffer<int> d_keys;
+    cub::DoubleBuffer<Key> d_keys;
 	cub::DoubleBuffer<int> d_values;
 
     // compute temporary memory required
@@ -41,16 +48,19 @@ void radix_sort_reserve(void* context, int n, void** mem_out, size_t* size_out)
         sort_temp_size,
         d_keys,
         d_values,
-        n, 0, 32,
+        n, 0, int(sizeof(Key))*8,
         (cudaStream_t)cuda_stream_get_current()));
 
     if (!context)
         context = cuda_context_get_current();
 
+    // temp buffer is shared between key types and only ever grows
     RadixSortTemp& temp = g_radix_sort_temp_map[context];
 
     if (sort_temp_size > temp.size)
     {
+        ScopedMemoryTag tag("sort");
+
 	    free_device(WP_CURRENT_CONTEXT, temp.mem);
         temp.mem = alloc_device(WP_CURRENT_CONTEXT, sort_temp_size);
         temp.size = sort_temp_size;
@@ -62,15 +72,64 @@ void radix_sort_reserve(void* context, int n, void** mem_out, size_t* size_out)
         *size_out = temp.size;
 }
 
-void radix_sort_pairs_device(void* context, int* keys, int* values, int n)
+// bits of the largest key if all keys are non-negative, all bits otherwise
+template <typename Key>
+int radix_sort_auto_end_bit(void* context, const Key* keys, int n)
+{
+    const int all_bits = int(sizeof(Key))*8;
+
+    // the bits of floats don't follow their magnitude
+    if (std::is_floating_point<Key>::value || n == 0)
+        return all_bits;
+
+    cudaStream_t stream = (cudaStream_t)cuda_stream_get_current();
+
+    Key* range = (Key*)alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(Key)*2);
+
+    size_t min_size = 0;
+    size_t max_size = 0;
+    check_cuda(cub::DeviceReduce::Min(NULL, min_size, keys, range, n, stream));
+    check_cuda(cub::DeviceReduce::Max(NULL, max_size, keys, range + 1, n, stream));
+
+    size_t temp_size = std::max(min_size, max_size);
+    void* temp = alloc_temp_device(WP_CURRENT_CONTEXT, temp_size);
+    check_cuda(cub::DeviceReduce::Min(temp, temp_size, keys, range, n, stream));
+    check_cuda(cub::DeviceReduce::Max(temp, temp_size, keys, range + 1, n, stream));
+
+    Key host_range[2];
+    memcpy_d2h(WP_CURRENT_CONTEXT, host_range, range, sizeof(Key)*2);
+    cuda_stream_synchronize(WP_CURRENT_CONTEXT, stream);
+
+    free_temp_device(WP_CURRENT_CONTEXT, temp);
+    free_temp_device(WP_CURRENT_CONTEXT, range);
+
+    if (std::is_signed<Key>::value && host_range[0] < Key(0))
+        return all_bits;
+
+    int bits = 1;
+    for (uint64_t k = uint64_t(host_range[1]) >> 1; k; k >>= 1)
+        ++bits;
+
+    return bits;
+}
+
+// CUB selects the onesweep implementation on the devices that support it
+template <typename Key>
+void radix_sort_pairs_device_typed(void* context, Key* keys, int* values, int n, int begin_bit, int end_bit)
 {
     ContextGuard guard(context);
 
-    cub::DoubleBuffer<int> d_keys(keys, keys + n);
+    if (end_bit == RADIX_SORT_AUTO_BITS)
+        end_bit = radix_sort_auto_end_bit(WP_CURRENT_CONTEXT, keys, n);
+    else if (end_bit == RADIX_SORT_ALL_BITS)
+        end_bit = int(sizeof(Key))*8;
+
+    cub::DoubleBuffer<Key> d_keys(keys, keys + n);
 	cub::DoubleBuffer<int> d_values(values, values + n);
 
+    // the temporary storage of all bits also fits narrower ranges
     RadixSortTemp temp;
-    radix_sort_reserve(WP_CURRENT_CONTEXT, n, &temp.mem, &temp.size);
+    radix_sort_reserve_typed<Key>(WP_CURRENT_CONTEXT, n, &temp.mem, &temp.size);
 
     // sort
     check_cuda(cub::DeviceRadixSort::SortPairs(
@@ -78,20 +137,77 @@ void radix_sort_pairs_device(void* context, int* keys, int* values, int n)
         temp.size,
         d_keys, 
         d_values, 
-        n, 0, 32, 
+        n, begin_bit, end_bit, 
         (cudaStream_t)cuda_stream_get_current()));
 
 	if (d_keys.Current() != keys)
-		memcpy_d2d(WP_CURRENT_CONTEXT, keys, d_keys.Current(), sizeof(int)*n);
+		memcpy_d2d(WP_CURRENT_CONTEXT, keys, d_keys.Current(), sizeof(Key)*n);
 
 	if (d_values.Current() != values)
 		memcpy_d2d(WP_CURRENT_CONTEXT, values, d_values.Current(), sizeof(int)*n);
 }
 
-void radix_sort_pairs_int_device(uint64_t keys, uint64_t values, int n)
+} // anonymous namespace
+
+
+void radix_sort_reserve(void* context, int n, void** mem_out, size_t* size_out)
+{
+    radix_sort_reserve_typed<int>(context, n, mem_out, size_out);
+}
+
+void radix_sort_reserve_uint64(void* context, int n)
+{
+    radix_sort_reserve_typed<uint64_t>(context, n, NULL, NULL);
+}
+
+void radix_sort_pairs_device(void* context, int* keys, int* values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device_typed(context, keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_device(void* context, int64_t* keys, int* values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device_typed(context, keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_device(void* context, uint64_t* keys, int* values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device_typed(context, keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_device(void* context, float* keys, int* values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device_typed(context, keys, values, n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_int_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
 {
     radix_sort_pairs_device(
         WP_CURRENT_CONTEXT,
         reinterpret_cast<int *>(keys),
-        reinterpret_cast<int *>(values), n);
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_int64_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device(
+        WP_CURRENT_CONTEXT,
+        reinterpret_cast<int64_t *>(keys),
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_uint64_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device(
+        WP_CURRENT_CONTEXT,
+        reinterpret_cast<uint64_t *>(keys),
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
+}
+
+void radix_sort_pairs_float_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit)
+{
+    radix_sort_pairs_device(
+        WP_CURRENT_CONTEXT,
+        reinterpret_cast<float *>(keys),
+        reinterpret_cast<int *>(values), n, begin_bit, end_bit);
 }
@@ -9,7 +9,33 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
+
+// end_bit values selecting all the bits of the keys, or on devices the bits of the largest key when all keys are
+// non-negative, which costs a reduction and a host synchronization, otherwise the keys are sorted on their bits
+// [begin_bit, end_bit) after flipping the sign bit of signed keys, so keys in [0, 2^k) only need end_bit = k
+#define RADIX_SORT_ALL_BITS (-1)
+#define RADIX_SORT_AUTO_BITS (-2)
 
 void radix_sort_reserve(void* context, int n, void** mem_out=NULL, size_t* size_out=NULL);
-void radix_sort_pairs_host(int* keys, int* values, int n);
-void radix_sort_pairs_device(void* context, int* keys, int* values, int n);
\ No newline at end of file
+void radix_sort_reserve_uint64(void* context, int n);
+
+// number of bits needed to represent n-1, i.e.: the end bit of keys in [0, n)
+inline int radix_sort_bits(int n)
+{
+    int bits = 1;
+    while (bits < 31 && (1 << bits) < n)
+        ++bits;
+    return bits;
+}
+
+// keys and values must have storage for 2*n elements, the second half is used as scratch space
+void radix_sort_pairs_host(int* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+void radix_sort_pairs_host(int64_t* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+void radix_sort_pairs_host(uint64_t* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+void radix_sort_pairs_host(float* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+
+void radix_sort_pairs_device(void* context, int* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+void radix_sort_pairs_device(void* context, int64_t* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+void radix_sort_pairs_device(void* context, uint64_t* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
+void radix_sort_pairs_device(void* context, float* keys, int* values, int n, int begin_bit=0, int end_bit=RADIX_SORT_ALL_BITS);
@@ -1,3 +1,5 @@
+#include "builtin.h"
+#include "sparse.h"
 #include "warp.h"
 
 #include <algorithm>
@@ -64,7 +66,8 @@ template <typename T> void bsr_dyn_block_transpose(const T *src, T *dest, int ro
 template <typename T>
 int bsr_matrix_from_triplets_host(const int rows_per_block, const int cols_per_block, const int row_count,
                                   const int nnz, const int *tpl_rows, const int *tpl_columns, const T *tpl_values,
-                                  int *bsr_offsets, int *bsr_columns, T *bsr_values)
+                                  int *bsr_offsets, int *bsr_columns, T *bsr_values, int *tpl_block_offsets,
+                                  int *tpl_block_indices)
 {
 
     // get specialized accumulator for common block sizes (1,1), (1,2), (1,3),
@@ -151,6 +154,11 @@ int bsr_matrix_from_triplets_host(const int rows_per_block, const int cols_per_b
         {
             *(bsr_columns++) = col;
 
+            if (tpl_block_offsets)
+            {
+                *(tpl_block_offsets++) = i;
+            }
+
             if (bsr_values)
             {
                 bsr_values += block_size;
@@ -164,12 +172,43 @@ int bsr_matrix_from_triplets_host(const int rows_per_block, const int cols_per_b
         }
     }
 
+    // save the triplet-to-block mapping for values-only updates
+    if (tpl_block_offsets)
+    {
+        *tpl_block_offsets = static_cast<int>(block_indices.size());
+    }
+    if (tpl_block_indices)
+    {
+        std::copy(block_indices.begin(), block_indices.end(), tpl_block_indices);
+    }
+
     // build postfix sum of row counts
     std::partial_sum(bsr_offsets, bsr_offsets + row_count + 1, bsr_offsets);
 
     return bsr_offsets[row_count];
 }
 
+// Acc is the accumulation type, wider than T for half-precision values
+template <typename T, typename Acc = T>
+void bsr_set_triplet_values_host(const int block_size, const int nnz, const int *tpl_block_offsets,
+                                 const int *tpl_block_indices, const T *tpl_values, T *bsr_values)
+{
+    auto scatter_block = [=](size_t block)
+    {
+        for (int k = 0; k < block_size; ++k)
+        {
+            Acc sum = Acc(0);
+            for (int cur = tpl_block_offsets[block]; cur != tpl_block_offsets[block + 1]; ++cur)
+            {
+                sum += Acc(tpl_values[static_cast<size_t>(tpl_block_indices[cur]) * block_size + k]);
+            }
+            bsr_values[block * block_size + k] = T(sum);
+        }
+    };
+
+    _wp_parallel_for_each(nnz, scatter_block);
+}
+
 template <typename T>
 void bsr_transpose_host(int rows_per_block, int cols_per_block, int row_count, int col_count, int nnz,
                         const int *bsr_offsets, const int *bsr_columns, const T *bsr_values,
@@ -260,26 +299,475 @@ void bsr_transpose_host(int rows_per_block, int cols_per_block, int row_count, i
     std::partial_sum(transposed_bsr_offsets, transposed_bsr_offsets + col_count + 1, transposed_bsr_offsets);
 }
 
+// Register-blocked product for block shapes known at compile time, the outputs of a row of blocks are accumulated
+// in Rows registers while streaming its blocks
+template <int Rows, int Cols, typename T, typename V>
+void bsr_fixed_block_mv_host(int row_count, const int *bsr_offsets, const int *bsr_columns, const V *bsr_values,
+                             const T *x, T *y, T alpha, T beta)
+{
+    auto mv_row = [&](size_t row)
+    {
+        T sum[Rows];
+        for (int r = 0; r < Rows; ++r)
+        {
+            sum[r] = T(0);
+        }
+
+        for (int block = bsr_offsets[row]; block < bsr_offsets[row + 1]; ++block)
+        {
+            const V *val = bsr_values + block * Rows * Cols;
+            const T *xb = x + bsr_columns[block] * Cols;
+            for (int r = 0; r < Rows; ++r)
+            {
+                for (int c = 0; c < Cols; ++c)
+                {
+                    sum[r] += T(val[r * Cols + c]) * xb[c];
+                }
+            }
+        }
+
+        for (int r = 0; r < Rows; ++r)
+        {
+            const int i = int(row) * Rows + r;
+            y[i] = beta == T(0) ? alpha * sum[r] : alpha * sum[r] + beta * y[i];
+        }
+    };
+
+    _wp_parallel_for_each(row_count, mv_row);
+}
+
+// Values of type V are converted to the vector type T, which is also used for accumulation
+template <typename T, typename V>
+void bsr_mv_host(int rows_per_block, int cols_per_block, int row_count, const int *bsr_offsets,
+                 const int *bsr_columns, const V *bsr_values, const T *x, T *y, T alpha, T beta)
+{
+    if (rows_per_block == cols_per_block)
+    {
+        switch (rows_per_block)
+        {
+        case 1:
+            return bsr_fixed_block_mv_host<1, 1>(row_count, bsr_offsets, bsr_columns, bsr_values, x, y, alpha, beta);
+        case 2:
+            return bsr_fixed_block_mv_host<2, 2>(row_count, bsr_offsets, bsr_columns, bsr_values, x, y, alpha, beta);
+        case 3:
+            return bsr_fixed_block_mv_host<3, 3>(row_count, bsr_offsets, bsr_columns, bsr_values, x, y, alpha, beta);
+        case 4:
+            return bsr_fixed_block_mv_host<4, 4>(row_count, bsr_offsets, bsr_columns, bsr_values, x, y, alpha, beta);
+        case 6:
+            return bsr_fixed_block_mv_host<6, 6>(row_count, bsr_offsets, bsr_columns, bsr_values, x, y, alpha, beta);
+        }
+    }
+
+    const int block_size = rows_per_block * cols_per_block;
+
+    auto mv_row = [&](size_t row)
+    {
+        const int beg = bsr_offsets[row];
+        const int end = bsr_offsets[row + 1];
+
+        for (int r = 0; r < rows_per_block; ++r)
+        {
+            T sum = T(0);
+            for (int block = beg; block < end; ++block)
+            {
+                const V *val = bsr_values + block * block_size + r * cols_per_block;
+                const T *xb = x + bsr_columns[block] * cols_per_block;
+                for (int c = 0; c < cols_per_block; ++c)
+                {
+                    sum += T(val[c]) * xb[c];
+                }
+            }
+
+            // y is not read when beta is zero, so it may be uninitialized
+            const int i = int(row) * rows_per_block + r;
+            y[i] = beta == T(0) ? alpha * sum : alpha * sum + beta * y[i];
+        }
+    };
+
+    _wp_parallel_for_each(row_count, mv_row);
+}
+
+namespace
+{
+
+// Sorted block columns of row `row` of X*Y, merged with those of Z if z_offsets is not null
+void bsr_mm_row_columns(int row, const int *x_offsets, const int *x_columns, const int *y_offsets,
+                        const int *y_columns, const int *z_offsets, const int *z_columns, std::vector<int> &columns)
+{
+    columns.clear();
+
+    if (z_offsets)
+    {
+        columns.insert(columns.end(), z_columns + z_offsets[row], z_columns + z_offsets[row + 1]);
+    }
+
+    for (int a = x_offsets[row]; a < x_offsets[row + 1]; ++a)
+    {
+        const int k = x_columns[a];
+        columns.insert(columns.end(), y_columns + y_offsets[k], y_columns + y_offsets[k + 1]);
+    }
+
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+}
+
+// Index of `col` in the sorted range columns[beg, end), or -1
+int bsr_find_column(const int *columns, int beg, int end, int col)
+{
+    const int *it = std::lower_bound(columns + beg, columns + end, col);
+    return (it != columns + end && *it == col) ? int(it - columns) : -1;
+}
+
+} // namespace
+
+int bsr_mm_count_host(int row_count, const int *x_offsets, const int *x_columns, const int *y_offsets,
+                      const int *y_columns, const int *z_offsets, const int *z_columns, int *mm_offsets)
+{
+    auto count_row = [&](size_t row)
+    {
+        std::vector<int> columns;
+        bsr_mm_row_columns(int(row), x_offsets, x_columns, y_offsets, y_columns, z_offsets, z_columns, columns);
+        mm_offsets[row + 1] = int(columns.size());
+    };
+
+    _wp_parallel_for_each(row_count, count_row);
+
+    mm_offsets[0] = 0;
+    std::partial_sum(mm_offsets, mm_offsets + row_count + 1, mm_offsets);
+
+    return mm_offsets[row_count];
+}
+
+void bsr_mm_list_columns_host(int row_count, const int *x_offsets, const int *x_columns, const int *y_offsets,
+                              const int *y_columns, const int *z_offsets, const int *z_columns,
+                              const int *mm_offsets, int *mm_columns)
+{
+    auto list_row = [&](size_t row)
+    {
+        std::vector<int> columns;
+        bsr_mm_row_columns(int(row), x_offsets, x_columns, y_offsets, y_columns, z_offsets, z_columns, columns);
+        std::copy(columns.begin(), columns.end(), mm_columns + mm_offsets[row]);
+    };
+
+    _wp_parallel_for_each(row_count, list_row);
+}
+
+// mm := alpha * X * Y + beta * Z. When mm and Z share storage the values are scaled in place;
+// product blocks outside of the mm sparsity pattern are dropped
+// Non-zero XRows, XCols and YCols fix the block shapes at compile time so that block products are unrolled
+template <int XRows, int XCols, int YCols, typename T>
+void bsr_mm_compute_values_host(int x_rows, int x_cols, int y_cols, int row_count, const int *x_offsets,
+                                const int *x_columns, const T *x_values, const int *y_offsets, const int *y_columns,
+                                const T *y_values, const int *z_offsets, const int *z_columns, const T *z_values,
+                                const int *mm_offsets, const int *mm_columns, T *mm_values, T alpha, T beta)
+{
+    const int x_rows_per_block = XRows ? XRows : x_rows;
+    const int x_cols_per_block = XCols ? XCols : x_cols;
+    const int y_cols_per_block = YCols ? YCols : y_cols;
+
+    const int x_block_size = x_rows_per_block * x_cols_per_block;
+    const int y_block_size = x_cols_per_block * y_cols_per_block;
+    const int mm_block_size = x_rows_per_block * y_cols_per_block;
+
+    auto compute_row = [&](size_t row)
+    {
+        const int beg = mm_offsets[row];
+        const int end = mm_offsets[row + 1];
+
+        if (z_values == mm_values)
+        {
+            for (int i = beg * mm_block_size; i < end * mm_block_size; ++i)
+            {
+                mm_values[i] = beta == T(0) ? T(0) : beta * mm_values[i];
+            }
+        }
+        else
+        {
+            std::fill(mm_values + beg * mm_block_size, mm_values + end * mm_block_size, T(0));
+
+            if (beta != T(0) && z_values)
+            {
+                for (int i = z_offsets[row]; i < z_offsets[row + 1]; ++i)
+                {
+                    const int slot = bsr_find_column(mm_columns, beg, end, z_columns[i]);
+                    if (slot < 0)
+                        continue;
+                    for (int k = 0; k < mm_block_size; ++k)
+                    {
+                        mm_values[slot * mm_block_size + k] += beta * z_values[i * mm_block_size + k];
+                    }
+                }
+            }
+        }
+
+        for (int a = x_offsets[row]; a < x_offsets[row + 1]; ++a)
+        {
+            const int k = x_columns[a];
+            const T *xv = x_values + a * x_block_size;
+
+            for (int b = y_offsets[k]; b < y_offsets[k + 1]; ++b)
+            {
+                const int slot = bsr_find_column(mm_columns, beg, end, y_columns[b]);
+                if (slot < 0)
+                    continue;
+
+                const T *yv = y_values + b * y_block_size;
+                T *mv = mm_values + slot * mm_block_size;
+
+                for (int r = 0; r < x_rows_per_block; ++r)
+                {
+                    for (int c = 0; c < y_cols_per_block; ++c)
+                    {
+                        T sum = T(0);
+                        for (int m = 0; m < x_cols_per_block; ++m)
+                        {
+                            sum += xv[r * x_cols_per_block + m] * yv[m * y_cols_per_block + c];
+                        }
+                        mv[r * y_cols_per_block + c] += alpha * sum;
+                    }
+                }
+            }
+        }
+    };
+
+    _wp_parallel_for_each(row_count, compute_row);
+}
+
+template <typename T>
+void bsr_mm_compute_values_host(int x_rows_per_block, int x_cols_per_block, int y_cols_per_block, int row_count,
+                                const int *x_offsets, const int *x_columns, const T *x_values, const int *y_offsets,
+                                const int *y_columns, const T *y_values, const int *z_offsets, const int *z_columns,
+                                const T *z_values, const int *mm_offsets, const int *mm_columns, T *mm_values,
+                                T alpha, T beta)
+{
+    auto compute_values = bsr_mm_compute_values_host<0, 0, 0, T>;
+
+    if (x_rows_per_block == x_cols_per_block && x_cols_per_block == y_cols_per_block)
+    {
+        switch (x_rows_per_block)
+        {
+        case 1:
+            compute_values = bsr_mm_compute_values_host<1, 1, 1, T>;
+            break;
+        case 2:
+            compute_values = bsr_mm_compute_values_host<2, 2, 2, T>;
+            break;
+        case 3:
+            compute_values = bsr_mm_compute_values_host<3, 3, 3, T>;
+            break;
+        case 4:
+            compute_values = bsr_mm_compute_values_host<4, 4, 4, T>;
+            break;
+        case 6:
+            compute_values = bsr_mm_compute_values_host<6, 6, 6, T>;
+            break;
+        }
+    }
+
+    compute_values(x_rows_per_block, x_cols_per_block, y_cols_per_block, row_count, x_offsets, x_columns, x_values,
+                   y_offsets, y_columns, y_values, z_offsets, z_columns, z_values, mm_offsets, mm_columns, mm_values,
+                   alpha, beta);
+}
+
+// dst := dst + scale * src for the blocks of src, whose rows and columns are given by triplets. All destination
+// blocks must exist in the dst sparsity pattern
+template <int BlockSize, typename T>
+void bsr_axpy_blocks_host(int block_size, int nnz, const int *rows, const int *columns, const int *dst_offsets,
+                          const int *dst_columns, const T *src_values, T *dst_values, T scale)
+{
+    if (BlockSize)
+    {
+        block_size = BlockSize;
+    }
+
+    // blocks of src have distinct positions, so they may be added concurrently
+    auto add_block = [&](size_t i)
+    {
+        const int row = rows[i];
+        const int block = bsr_find_column(dst_columns, dst_offsets[row], dst_offsets[row + 1], columns[i]);
+
+        const T *src = src_values + i * block_size;
+        T *dst = dst_values + block * block_size;
+        for (int k = 0; k < block_size; ++k)
+        {
+            dst[k] += scale * src[k];
+        }
+    };
+
+    _wp_parallel_for_each(nnz, add_block);
+}
+
+template <typename T>
+void bsr_axpy_blocks_host(int block_size, int nnz, const int *rows, const int *columns, const int *dst_offsets,
+                          const int *dst_columns, const T *src_values, T *dst_values, T scale)
+{
+    auto axpy_blocks = bsr_axpy_blocks_host<0, T>;
+
+    switch (block_size)
+    {
+    case 1:
+        axpy_blocks = bsr_axpy_blocks_host<1, T>;
+        break;
+    case 4:
+        axpy_blocks = bsr_axpy_blocks_host<4, T>;
+        break;
+    case 9:
+        axpy_blocks = bsr_axpy_blocks_host<9, T>;
+        break;
+    case 16:
+        axpy_blocks = bsr_axpy_blocks_host<16, T>;
+        break;
+    case 36:
+        axpy_blocks = bsr_axpy_blocks_host<36, T>;
+        break;
+    }
+
+    axpy_blocks(block_size, nnz, rows, columns, dst_offsets, dst_columns, src_values, dst_values, scale);
+}
+
+template <int N, typename T>
+void bsr_block_diag_inverse_host(int row_count, const int *offsets, const int *columns, const T *values, T *inv_diag)
+{
+    auto invert_row = [&](size_t row) { wp::bsr_diag_block_inverse<N>(int(row), offsets, columns, values, inv_diag); };
+    _wp_parallel_for_each(row_count, invert_row);
+}
+
+template <typename T>
+void bsr_block_diag_inverse_host(int block_size, int row_count, const int *offsets, const int *columns,
+                                 const T *values, T *inv_diag)
+{
+    switch (block_size)
+    {
+    case 1:
+        return bsr_block_diag_inverse_host<1>(row_count, offsets, columns, values, inv_diag);
+    case 2:
+        return bsr_block_diag_inverse_host<2>(row_count, offsets, columns, values, inv_diag);
+    case 3:
+        return bsr_block_diag_inverse_host<3>(row_count, offsets, columns, values, inv_diag);
+    case 4:
+        return bsr_block_diag_inverse_host<4>(row_count, offsets, columns, values, inv_diag);
+    case 5:
+        return bsr_block_diag_inverse_host<5>(row_count, offsets, columns, values, inv_diag);
+    case 6:
+        return bsr_block_diag_inverse_host<6>(row_count, offsets, columns, values, inv_diag);
+    }
+}
+
+// Rows are factored in order on the host, the level schedule is only needed for parallel execution
+template <int N, typename T>
+void bsr_ilu_factor_host(int row_count, const int *offsets, const int *columns, T *values, T *inv_diag)
+{
+    for (int row = 0; row < row_count; ++row)
+    {
+        wp::bsr_ilu_factor_row<N>(row, offsets, columns, values, inv_diag);
+    }
+}
+
+template <typename T>
+void bsr_ilu_factor_host(int block_size, int row_count, const int *offsets, const int *columns, T *values,
+                         T *inv_diag)
+{
+    switch (block_size)
+    {
+    case 1:
+        return bsr_ilu_factor_host<1>(row_count, offsets, columns, values, inv_diag);
+    case 2:
+        return bsr_ilu_factor_host<2>(row_count, offsets, columns, values, inv_diag);
+    case 3:
+        return bsr_ilu_factor_host<3>(row_count, offsets, columns, values, inv_diag);
+    case 4:
+        return bsr_ilu_factor_host<4>(row_count, offsets, columns, values, inv_diag);
+    case 5:
+        return bsr_ilu_factor_host<5>(row_count, offsets, columns, values, inv_diag);
+    case 6:
+        return bsr_ilu_factor_host<6>(row_count, offsets, columns, values, inv_diag);
+    }
+}
+
+template <int N, typename T>
+void bsr_ilu_solve_host(int row_count, const int *offsets, const int *columns, const T *values, const T *inv_diag,
+                        const T *x, T *z)
+{
+    for (int row = 0; row < row_count; ++row)
+    {
+        wp::bsr_ilu_lower_solve_row<N>(row, offsets, columns, values, x, z);
+    }
+    for (int row = row_count - 1; row >= 0; --row)
+    {
+        wp::bsr_ilu_upper_solve_row<N>(row, offsets, columns, values, inv_diag, z);
+    }
+}
+
+template <typename T>
+void bsr_ilu_solve_host(int block_size, int row_count, const int *offsets, const int *columns, const T *values,
+                        const T *inv_diag, const T *x, T *z)
+{
+    switch (block_size)
+    {
+    case 1:
+        return bsr_ilu_solve_host<1>(row_count, offsets, columns, values, inv_diag, x, z);
+    case 2:
+        return bsr_ilu_solve_host<2>(row_count, offsets, columns, values, inv_diag, x, z);
+    case 3:
+        return bsr_ilu_solve_host<3>(row_count, offsets, columns, values, inv_diag, x, z);
+    case 4:
+        return bsr_ilu_solve_host<4>(row_count, offsets, columns, values, inv_diag, x, z);
+    case 5:
+        return bsr_ilu_solve_host<5>(row_count, offsets, columns, values, inv_diag, x, z);
+    case 6:
+        return bsr_ilu_solve_host<6>(row_count, offsets, columns, values, inv_diag, x, z);
+    }
+}
+
 WP_API int bsr_matrix_from_triplets_float_host(int rows_per_block, int cols_per_block, int row_count, int nnz,
                                                uint64_t tpl_rows, uint64_t tpl_columns, uint64_t tpl_values,
-                                               uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values)
+                                               uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+                                               uint64_t tpl_block_offsets, uint64_t tpl_block_indices)
 {
     return bsr_matrix_from_triplets_host(
         rows_per_block, cols_per_block, row_count, nnz, reinterpret_cast<const int *>(tpl_rows),
         reinterpret_cast<const int *>(tpl_columns), reinterpret_cast<const float *>(tpl_values),
         reinterpret_cast<int *>(bsr_offsets), reinterpret_cast<int *>(bsr_columns),
-        reinterpret_cast<float *>(bsr_values));
+        reinterpret_cast<float *>(bsr_values), reinterpret_cast<int *>(tpl_block_offsets),
+        reinterpret_cast<int *>(tpl_block_indices));
+}
+
+WP_API void bsr_set_triplet_values_float_host(int block_size, int nnz, uint64_t tpl_block_offsets,
+                                           uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values)
+{
+    bsr_set_triplet_values_host(block_size, nnz, reinterpret_cast<const int *>(tpl_block_offsets),
+                                reinterpret_cast<const int *>(tpl_block_indices),
+                                reinterpret_cast<const float *>(tpl_values), reinterpret_cast<float *>(bsr_values));
 }
 
 WP_API int bsr_matrix_from_triplets_double_host(int rows_per_block, int cols_per_block, int row_count, int nnz,
                                                 uint64_t tpl_rows, uint64_t tpl_columns, uint64_t tpl_values,
-                                                uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values)
+                                                uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+                                                uint64_t tpl_block_offsets, uint64_t tpl_block_indices)
 {
     return bsr_matrix_from_triplets_host(
         rows_per_block, cols_per_block, row_count, nnz, reinterpret_cast<const int *>(tpl_rows),
         reinterpret_cast<const int *>(tpl_columns), reinterpret_cast<const double *>(tpl_values),
         reinterpret_cast<int *>(bsr_offsets), reinterpret_cast<int *>(bsr_columns),
-        reinterpret_cast<double *>(bsr_values));
+        reinterpret_cast<double *>(bsr_values), reinterpret_cast<int *>(tpl_block_offsets),
+        reinterpret_cast<int *>(tpl_block_indices));
+}
+
+WP_API void bsr_set_triplet_values_double_host(int block_size, int nnz, uint64_t tpl_block_offsets,
+                                            uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values)
+{
+    bsr_set_triplet_values_host(block_size, nnz, reinterpret_cast<const int *>(tpl_block_offsets),
+                                reinterpret_cast<const int *>(tpl_block_indices),
+                                reinterpret_cast<const double *>(tpl_values), reinterpret_cast<double *>(bsr_values));
+}
+
+WP_API void bsr_set_triplet_values_half_host(int block_size, int nnz, uint64_t tpl_block_offsets,
+                                          uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values)
+{
+    bsr_set_triplet_values_host<wp::half, float>(block_size, nnz, reinterpret_cast<const int *>(tpl_block_offsets),
+                                                 reinterpret_cast<const int *>(tpl_block_indices),
+                                                 reinterpret_cast<const wp::half *>(tpl_values),
+                                                 reinterpret_cast<wp::half *>(bsr_values));
 }
 
 WP_API void bsr_transpose_float_host(int rows_per_block, int cols_per_block, int row_count, int col_count, int nnz,
@@ -306,21 +794,237 @@ WP_API void bsr_transpose_double_host(int rows_per_block, int cols_per_block, in
                        reinterpret_cast<double *>(transposed_bsr_values));
 }
 
+WP_API void bsr_transpose_half_host(int rows_per_block, int cols_per_block, int row_count, int col_count, int nnz,
+                                    uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+                                    uint64_t transposed_bsr_offsets, uint64_t transposed_bsr_columns,
+                                    uint64_t transposed_bsr_values)
+{
+    // blocks are only moved around, no need for half arithmetic
+    bsr_transpose_host(rows_per_block, cols_per_block, row_count, col_count, nnz,
+                       reinterpret_cast<const int *>(bsr_offsets), reinterpret_cast<const int *>(bsr_columns),
+                       reinterpret_cast<const uint16_t *>(bsr_values),
+                       reinterpret_cast<int *>(transposed_bsr_offsets),
+                       reinterpret_cast<int *>(transposed_bsr_columns),
+                       reinterpret_cast<uint16_t *>(transposed_bsr_values));
+}
+
+WP_API void bsr_mv_float_host(int rows_per_block, int cols_per_block, int row_count, int nnz, uint64_t bsr_offsets,
+                              uint64_t bsr_columns, uint64_t bsr_values, uint64_t x, uint64_t y, int group_size,
+                              float alpha, float beta)
+{
+    bsr_mv_host(rows_per_block, cols_per_block, row_count, reinterpret_cast<const int *>(bsr_offsets),
+                reinterpret_cast<const int *>(bsr_columns), reinterpret_cast<const float *>(bsr_values),
+                reinterpret_cast<const float *>(x), reinterpret_cast<float *>(y), alpha, beta);
+}
+
+WP_API void bsr_mv_double_host(int rows_per_block, int cols_per_block, int row_count, int nnz, uint64_t bsr_offsets,
+                               uint64_t bsr_columns, uint64_t bsr_values, uint64_t x, uint64_t y, int group_size,
+                               double alpha, double beta)
+{
+    bsr_mv_host(rows_per_block, cols_per_block, row_count, reinterpret_cast<const int *>(bsr_offsets),
+                reinterpret_cast<const int *>(bsr_columns), reinterpret_cast<const double *>(bsr_values),
+                reinterpret_cast<const double *>(x), reinterpret_cast<double *>(y), alpha, beta);
+}
+
+WP_API void bsr_mv_half_host(int rows_per_block, int cols_per_block, int row_count, int nnz, uint64_t bsr_offsets,
+                             uint64_t bsr_columns, uint64_t bsr_values, uint64_t x, uint64_t y, int group_size,
+                             float alpha, float beta)
+{
+    bsr_mv_host(rows_per_block, cols_per_block, row_count, reinterpret_cast<const int *>(bsr_offsets),
+                reinterpret_cast<const int *>(bsr_columns), reinterpret_cast<const wp::half *>(bsr_values),
+                reinterpret_cast<const float *>(x), reinterpret_cast<float *>(y), alpha, beta);
+}
+
+WP_API int bsr_mm_count_host(int row_count, uint64_t x_offsets, uint64_t x_columns, uint64_t y_offsets,
+                             uint64_t y_columns, uint64_t z_offsets, uint64_t z_columns, uint64_t mm_offsets)
+{
+    return bsr_mm_count_host(row_count, reinterpret_cast<const int *>(x_offsets),
+                             reinterpret_cast<const int *>(x_columns), reinterpret_cast<const int *>(y_offsets),
+                             reinterpret_cast<const int *>(y_columns), reinterpret_cast<const int *>(z_offsets),
+                             reinterpret_cast<const int *>(z_columns), reinterpret_cast<int *>(mm_offsets));
+}
+
+WP_API void bsr_mm_list_columns_host(int row_count, uint64_t x_offsets, uint64_t x_columns, uint64_t y_offsets,
+                                     uint64_t y_columns, uint64_t z_offsets, uint64_t z_columns,
+                                     uint64_t mm_offsets, uint64_t mm_columns)
+{
+    bsr_mm_list_columns_host(row_count, reinterpret_cast<const int *>(x_offsets),
+                             reinterpret_cast<const int *>(x_columns), reinterpret_cast<const int *>(y_offsets),
+                             reinterpret_cast<const int *>(y_columns), reinterpret_cast<const int *>(z_offsets),
+                             reinterpret_cast<const int *>(z_columns), reinterpret_cast<const int *>(mm_offsets),
+                             reinterpret_cast<int *>(mm_columns));
+}
+
+WP_API void bsr_mm_compute_values_float_host(int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+                                             int row_count, uint64_t x_offsets, uint64_t x_columns,
+                                             uint64_t x_values, uint64_t y_offsets, uint64_t y_columns,
+                                             uint64_t y_values, uint64_t z_offsets, uint64_t z_columns,
+                                             uint64_t z_values, uint64_t mm_offsets, uint64_t mm_columns,
+                                             uint64_t mm_values, float alpha, float beta)
+{
+    bsr_mm_compute_values_host(
+        x_rows_per_block, x_cols_per_block, y_cols_per_block, row_count, reinterpret_cast<const int *>(x_offsets),
+        reinterpret_cast<const int *>(x_columns), reinterpret_cast<const float *>(x_values),
+        reinterpret_cast<const int *>(y_offsets), reinterpret_cast<const int *>(y_columns),
+        reinterpret_cast<const float *>(y_values), reinterpret_cast<const int *>(z_offsets),
+        reinterpret_cast<const int *>(z_columns), reinterpret_cast<const float *>(z_values),
+        reinterpret_cast<const int *>(mm_offsets), reinterpret_cast<const int *>(mm_columns),
+        reinterpret_cast<float *>(mm_values), alpha, beta);
+}
+
+WP_API void bsr_mm_compute_values_double_host(int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+                                              int row_count, uint64_t x_offsets, uint64_t x_columns,
+                                              uint64_t x_values, uint64_t y_offsets, uint64_t y_columns,
+                                              uint64_t y_values, uint64_t z_offsets, uint64_t z_columns,
+                                              uint64_t z_values, uint64_t mm_offsets, uint64_t mm_columns,
+                                              uint64_t mm_values, double alpha, double beta)
+{
+    bsr_mm_compute_values_host(
+        x_rows_per_block, x_cols_per_block, y_cols_per_block, row_count, reinterpret_cast<const int *>(x_offsets),
+        reinterpret_cast<const int *>(x_columns), reinterpret_cast<const double *>(x_values),
+        reinterpret_cast<const int *>(y_offsets), reinterpret_cast<const int *>(y_columns),
+        reinterpret_cast<const double *>(y_values), reinterpret_cast<const int *>(z_offsets),
+        reinterpret_cast<const int *>(z_columns), reinterpret_cast<const double *>(z_values),
+        reinterpret_cast<const int *>(mm_offsets), reinterpret_cast<const int *>(mm_columns),
+        reinterpret_cast<double *>(mm_values), alpha, beta);
+}
+
+WP_API void bsr_axpy_blocks_float_host(int block_size, int nnz, uint64_t rows, uint64_t columns, uint64_t dst_offsets,
+                                       uint64_t dst_columns, uint64_t src_values, uint64_t dst_values, float scale)
+{
+    bsr_axpy_blocks_host(block_size, nnz, reinterpret_cast<const int *>(rows), reinterpret_cast<const int *>(columns),
+                         reinterpret_cast<const int *>(dst_offsets), reinterpret_cast<const int *>(dst_columns),
+                         reinterpret_cast<const float *>(src_values), reinterpret_cast<float *>(dst_values), scale);
+}
+
+WP_API void bsr_axpy_blocks_double_host(int block_size, int nnz, uint64_t rows, uint64_t columns,
+                                        uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values,
+                                        uint64_t dst_values, double scale)
+{
+    bsr_axpy_blocks_host(block_size, nnz, reinterpret_cast<const int *>(rows), reinterpret_cast<const int *>(columns),
+                         reinterpret_cast<const int *>(dst_offsets), reinterpret_cast<const int *>(dst_columns),
+                         reinterpret_cast<const double *>(src_values), reinterpret_cast<double *>(dst_values), scale);
+}
+
+WP_API void bsr_block_diag_inverse_float_host(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                              uint64_t values, uint64_t inv_diag)
+{
+    bsr_block_diag_inverse_host(block_size, row_count, reinterpret_cast<const int *>(offsets),
+                                reinterpret_cast<const int *>(columns), reinterpret_cast<const float *>(values),
+                                reinterpret_cast<float *>(inv_diag));
+}
+
+WP_API void bsr_block_diag_inverse_double_host(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                               uint64_t values, uint64_t inv_diag)
+{
+    bsr_block_diag_inverse_host(block_size, row_count, reinterpret_cast<const int *>(offsets),
+                                reinterpret_cast<const int *>(columns), reinterpret_cast<const double *>(values),
+                                reinterpret_cast<double *>(inv_diag));
+}
+
+// Level of each row in the dependency graphs of the lower and upper triangular solves; rows of a level only depend
+// on rows of lower levels. The factorization has the same dependencies as the lower solve
+WP_API void bsr_ilu_levels_host(int row_count, uint64_t offsets, uint64_t columns, uint64_t lower_levels,
+                                uint64_t upper_levels)
+{
+    const int *offsets_ptr = reinterpret_cast<const int *>(offsets);
+    const int *columns_ptr = reinterpret_cast<const int *>(columns);
+    int *lower = reinterpret_cast<int *>(lower_levels);
+    int *upper = reinterpret_cast<int *>(upper_levels);
+
+    for (int row = 0; row < row_count; ++row)
+    {
+        int level = 0;
+        for (int p = offsets_ptr[row]; p < offsets_ptr[row + 1] && columns_ptr[p] < row; ++p)
+        {
+            level = std::max(level, lower[columns_ptr[p]] + 1);
+        }
+        lower[row] = level;
+    }
+
+    for (int row = row_count - 1; row >= 0; --row)
+    {
+        int level = 0;
+        for (int p = offsets_ptr[row + 1] - 1; p >= offsets_ptr[row] && columns_ptr[p] > row; --p)
+        {
+            level = std::max(level, upper[columns_ptr[p]] + 1);
+        }
+        upper[row] = level;
+    }
+}
+
+WP_API void bsr_ilu_factor_float_host(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                      uint64_t values, uint64_t inv_diag, uint64_t level_rows, uint64_t level_offsets,
+                                      int level_count)
+{
+    bsr_ilu_factor_host(block_size, row_count, reinterpret_cast<const int *>(offsets),
+                        reinterpret_cast<const int *>(columns), reinterpret_cast<float *>(values),
+                        reinterpret_cast<float *>(inv_diag));
+}
+
+WP_API void bsr_ilu_factor_double_host(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                       uint64_t values, uint64_t inv_diag, uint64_t level_rows,
+                                       uint64_t level_offsets, int level_count)
+{
+    bsr_ilu_factor_host(block_size, row_count, reinterpret_cast<const int *>(offsets),
+                        reinterpret_cast<const int *>(columns), reinterpret_cast<double *>(values),
+                        reinterpret_cast<double *>(inv_diag));
+}
+
+WP_API void bsr_ilu_solve_float_host(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                     uint64_t values, uint64_t inv_diag, uint64_t lower_rows,
+                                     uint64_t lower_level_offsets, int lower_level_count, uint64_t upper_rows,
+                                     uint64_t upper_level_offsets, int upper_level_count, uint64_t x, uint64_t z)
+{
+    bsr_ilu_solve_host(block_size, row_count, reinterpret_cast<const int *>(offsets),
+                       reinterpret_cast<const int *>(columns), reinterpret_cast<const float *>(values),
+                       reinterpret_cast<const float *>(inv_diag), reinterpret_cast<const float *>(x),
+                       reinterpret_cast<float *>(z));
+}
+
+WP_API void bsr_ilu_solve_double_host(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                      uint64_t values, uint64_t inv_diag, uint64_t lower_rows,
+                                      uint64_t lower_level_offsets, int lower_level_count, uint64_t upper_rows,
+                                      uint64_t upper_level_offsets, int upper_level_count, uint64_t x, uint64_t z)
+{
+    bsr_ilu_solve_host(block_size, row_count, reinterpret_cast<const int *>(offsets),
+                       reinterpret_cast<const int *>(columns), reinterpret_cast<const double *>(values),
+                       reinterpret_cast<const double *>(inv_diag), reinterpret_cast<const double *>(x),
+                       reinterpret_cast<double *>(z));
+}
+
 #if !WP_ENABLE_CUDA
 WP_API int bsr_matrix_from_triplets_float_device(int rows_per_block, int cols_per_block, int row_count, int nnz,
                                                  uint64_t tpl_rows, uint64_t tpl_columns, uint64_t tpl_values,
-                                                 uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values)
+                                                 uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+                                                 uint64_t tpl_block_offsets, uint64_t tpl_block_indices)
 {
     return 0;
 }
 
+WP_API void bsr_set_triplet_values_float_device(int block_size, int nnz, uint64_t tpl_block_offsets,
+                                             uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values)
+{
+}
+
 WP_API int bsr_matrix_from_triplets_double_device(int rows_per_block, int cols_per_block, int row_count, int nnz,
                                                   uint64_t tpl_rows, uint64_t tpl_columns, uint64_t tpl_values,
-                                                  uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values)
+                                                  uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+                                                  uint64_t tpl_block_offsets, uint64_t tpl_block_indices)
 {
     return 0;
 }
 
+WP_API void bsr_set_triplet_values_double_device(int block_size, int nnz, uint64_t tpl_block_offsets,
+                                              uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values)
+{
+}
+
+WP_API void bsr_set_triplet_values_half_device(int block_size, int nnz, uint64_t tpl_block_offsets,
+                                            uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values)
+{
+}
+
 WP_API void bsr_transpose_float_device(int rows_per_block, int cols_per_block, int row_count, int col_count, int nnz,
                                        uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
                                        uint64_t transposed_bsr_offsets, uint64_t transposed_bsr_columns,
@@ -335,4 +1039,107 @@ WP_API void bsr_transpose_double_device(int rows_per_block, int cols_per_block,
 {
 }
 
+WP_API void bsr_transpose_half_device(int rows_per_block, int cols_per_block, int row_count, int col_count, int nnz,
+                                      uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+                                      uint64_t transposed_bsr_offsets, uint64_t transposed_bsr_columns,
+                                      uint64_t transposed_bsr_values)
+{
+}
+
+WP_API void bsr_mv_float_device(int rows_per_block, int cols_per_block, int row_count, int nnz, uint64_t bsr_offsets,
+                                uint64_t bsr_columns, uint64_t bsr_values, uint64_t x, uint64_t y, int group_size,
+                                float alpha, float beta)
+{
+}
+
+WP_API void bsr_mv_double_device(int rows_per_block, int cols_per_block, int row_count, int nnz, uint64_t bsr_offsets,
+                                 uint64_t bsr_columns, uint64_t bsr_values, uint64_t x, uint64_t y, int group_size,
+                                 double alpha, double beta)
+{
+}
+
+WP_API void bsr_mv_half_device(int rows_per_block, int cols_per_block, int row_count, int nnz, uint64_t bsr_offsets,
+                               uint64_t bsr_columns, uint64_t bsr_values, uint64_t x, uint64_t y, int group_size,
+                               float alpha, float beta)
+{
+}
+
+WP_API int bsr_mm_count_device(int row_count, uint64_t x_offsets, uint64_t x_columns, uint64_t y_offsets,
+                               uint64_t y_columns, uint64_t z_offsets, uint64_t z_columns, uint64_t mm_offsets)
+{
+    return 0;
+}
+
+WP_API void bsr_mm_list_columns_device(int row_count, uint64_t x_offsets, uint64_t x_columns, uint64_t y_offsets,
+                                       uint64_t y_columns, uint64_t z_offsets, uint64_t z_columns,
+                                       uint64_t mm_offsets, uint64_t mm_columns)
+{
+}
+
+WP_API void bsr_mm_compute_values_float_device(int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+                                               int row_count, uint64_t x_offsets, uint64_t x_columns,
+                                               uint64_t x_values, uint64_t y_offsets, uint64_t y_columns,
+                                               uint64_t y_values, uint64_t z_offsets, uint64_t z_columns,
+                                               uint64_t z_values, uint64_t mm_offsets, uint64_t mm_columns,
+                                               uint64_t mm_values, float alpha, float beta)
+{
+}
+
+WP_API void bsr_mm_compute_values_double_device(int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+                                                int row_count, uint64_t x_offsets, uint64_t x_columns,
+                                                uint64_t x_values, uint64_t y_offsets, uint64_t y_columns,
+                                                uint64_t y_values, uint64_t z_offsets, uint64_t z_columns,
+                                                uint64_t z_values, uint64_t mm_offsets, uint64_t mm_columns,
+                                                uint64_t mm_values, double alpha, double beta)
+{
+}
+
+WP_API void bsr_axpy_blocks_float_device(int block_size, int nnz, uint64_t rows, uint64_t columns,
+                                         uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values,
+                                         uint64_t dst_values, float scale)
+{
+}
+
+WP_API void bsr_axpy_blocks_double_device(int block_size, int nnz, uint64_t rows, uint64_t columns,
+                                          uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values,
+                                          uint64_t dst_values, double scale)
+{
+}
+
+WP_API void bsr_block_diag_inverse_float_device(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                                uint64_t values, uint64_t inv_diag)
+{
+}
+
+WP_API void bsr_block_diag_inverse_double_device(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                                 uint64_t values, uint64_t inv_diag)
+{
+}
+
+WP_API void bsr_ilu_factor_float_device(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                        uint64_t values, uint64_t inv_diag, uint64_t level_rows,
+                                        uint64_t level_offsets, int level_count)
+{
+}
+
+WP_API void bsr_ilu_factor_double_device(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                         uint64_t values, uint64_t inv_diag, uint64_t level_rows,
+                                         uint64_t level_offsets, int level_count)
+{
+}
+
+WP_API void bsr_ilu_solve_float_device(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                       uint64_t values, uint64_t inv_diag, uint64_t lower_rows,
+                                       uint64_t lower_level_offsets, int lower_level_count, uint64_t upper_rows,
+                                       uint64_t upper_level_offsets, int upper_level_count, uint64_t x, uint64_t z)
+{
+}
+
+WP_API void bsr_ilu_solve_double_device(int block_size, int row_count, uint64_t offsets, uint64_t columns,
+                                        uint64_t values, uint64_t inv_diag, uint64_t lower_rows,
+                                        uint64_t lower_level_offsets, int lower_level_count, uint64_t upper_rows,
+                                        uint64_t upper_level_offsets, int upper_level_count, uint64_t x, uint64_t z)
+{
+}
+
 #endif
\ No newline at end of file
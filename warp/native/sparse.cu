@@ -1,5 +1,9 @@
+#include "builtin.h"
 #include "cuda_util.h"
+#include "memory_stats.h"
 #include "warp.h"
+#include "sort.h"
+#include "sparse.h"
 
 #define THRUST_IGNORE_CUB_VERSION_CHECK
 
@@ -135,13 +139,37 @@ bsr_merge_blocks(int nnz, int block_size, const int *block_offsets,
   }
 }
 
+template <typename T, typename Acc>
+__global__ void bsr_scatter_triplet_values(int nnz, int block_size,
+                                           const int *tpl_block_offsets,
+                                           const int *tpl_block_indices,
+                                           const T *tpl_values,
+                                           T *bsr_values) {
+  // one thread per block coefficient
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= nnz * block_size)
+    return;
+
+  const int block = i / block_size;
+  const int k = i - block * block_size;
+
+  const int beg = tpl_block_offsets[block];
+  const int end = tpl_block_offsets[block + 1];
+
+  Acc sum = Acc(0);
+  for (int cur = beg; cur != end; ++cur) {
+    sum += Acc(tpl_values[tpl_block_indices[cur] * block_size + k]);
+  }
+
+  bsr_values[i] = T(sum);
+}
+
 template <typename T>
-int bsr_matrix_from_triplets_device(const int rows_per_block,
-                                    const int cols_per_block,
-                                    const int row_count, const int nnz,
-                                    const int *tpl_rows, const int *tpl_columns,
-                                    const T *tpl_values, int *bsr_offsets,
-                                    int *bsr_columns, T *bsr_values) {
+int bsr_matrix_from_triplets_device(
+    const int rows_per_block, const int cols_per_block, const int row_count,
+    const int nnz, const int *tpl_rows, const int *tpl_columns,
+    const T *tpl_values, int *bsr_offsets, int *bsr_columns, T *bsr_values,
+    int *tpl_block_offsets, int *tpl_block_indices) {
   const int block_size = rows_per_block * cols_per_block;
 
   void *context = cuda_context_get_current();
@@ -151,6 +179,7 @@ int bsr_matrix_from_triplets_device(const int rows_per_block,
   BsrFromTripletsTemp &bsr_temp = g_bsr_from_triplets_temp_map[context];
 
   ContextGuard guard(context);
+  ScopedMemoryTag memory_tag("sparse");
 
   cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
   bsr_temp.ensure_fits(nnz);
@@ -206,15 +235,17 @@ int bsr_matrix_from_triplets_device(const int rows_per_block,
 
   const int nz_triplet_count = *pinned_count;
 
-  // Sort
+  // Sort, the rows are stored above the 32 bits of the columns
+  const int end_bit = 32 + radix_sort_bits(row_count);
+
   size_t buff_size = 0;
   check_cuda(cub::DeviceRadixSort::SortPairs(
-      nullptr, buff_size, d_values, d_keys, nz_triplet_count, 0, 64, stream));
+      nullptr, buff_size, d_values, d_keys, nz_triplet_count, 0, end_bit, stream));
   void* temp_buffer = alloc_temp_device(WP_CURRENT_CONTEXT, buff_size);
   
   check_cuda(cub::DeviceRadixSort::SortPairs(temp_buffer, buff_size,
                                              d_values, d_keys, nz_triplet_count,
-                                             0, 64, stream));
+                                             0, end_bit, stream));
   free_temp_device(WP_CURRENT_CONTEXT, temp_buffer);
 
   // Runlength encode row-col sequences
@@ -269,9 +300,35 @@ int bsr_matrix_from_triplets_device(const int rows_per_block,
                                            row_count + 1, stream));
   free_temp_device(WP_CURRENT_CONTEXT, temp_buffer);
 
+  // Optionally save the triplet-to-block mapping for values-only updates
+  if (tpl_block_offsets) {
+    memset_device(WP_CURRENT_CONTEXT, tpl_block_offsets, 0, sizeof(int));
+    memcpy_d2d(WP_CURRENT_CONTEXT, tpl_block_offsets + 1, d_keys.Alternate(),
+               compressed_nnz * sizeof(int));
+  }
+  if (tpl_block_indices) {
+    memcpy_d2d(WP_CURRENT_CONTEXT, tpl_block_indices, d_keys.Current(),
+               nz_triplet_count * sizeof(int));
+  }
+
   return compressed_nnz;
 }
 
+// Acc is the accumulation type, wider than T for half-precision values
+template <typename T, typename Acc = T>
+void bsr_set_triplet_values_device(const int block_size, const int nnz,
+                                   const int *tpl_block_offsets,
+                                   const int *tpl_block_indices,
+                                   const T *tpl_values, T *bsr_values) {
+  ContextGuard guard(cuda_context_get_current());
+
+  auto kernel = bsr_scatter_triplet_values<T, Acc>;
+  wp_launch_device(WP_CURRENT_CONTEXT, kernel,
+                   nnz * block_size,
+                   (nnz, block_size, tpl_block_offsets, tpl_block_indices,
+                    tpl_values, bsr_values));
+}
+
 __global__ void bsr_transpose_fill_row_col(const int nnz, const int row_count,
                                            const int *bsr_offsets,
                                            const int *bsr_columns,
@@ -365,6 +422,7 @@ void bsr_transpose_device(int rows_per_block, int cols_per_block, int row_count,
   BsrFromTripletsTemp &bsr_temp = g_bsr_from_triplets_temp_map[context];
 
   ContextGuard guard(context);
+  ScopedMemoryTag memory_tag("sparse");
 
   cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
   bsr_temp.ensure_fits(nnz);
@@ -382,13 +440,15 @@ void bsr_transpose_device(int rows_per_block, int cols_per_block, int row_count,
                    (nnz, row_count, bsr_offsets, bsr_columns, d_keys.Current(),
                     d_values.Current(), transposed_bsr_offsets));
 
-  // Sort blocks
+  // Sort blocks, the transposed rows are stored above the 32 bits of the columns
+  const int end_bit = 32 + radix_sort_bits(col_count);
+
   size_t buff_size = 0;
   check_cuda(cub::DeviceRadixSort::SortPairs(nullptr, buff_size, d_values,
-                                             d_keys, nnz, 0, 64, stream));
+                                             d_keys, nnz, 0, end_bit, stream));
   void* temp_buffer = alloc_temp_device(WP_CURRENT_CONTEXT, buff_size);
   check_cuda(cub::DeviceRadixSort::SortPairs(
-      temp_buffer, buff_size, d_values, d_keys, nnz, 0, 64, stream));
+      temp_buffer, buff_size, d_values, d_keys, nnz, 0, end_bit, stream));
 
   // Prefix sum the trasnposed row block counts
   check_cuda(cub::DeviceScan::InclusiveSum(
@@ -474,12 +534,734 @@ void bsr_transpose_device(int rows_per_block, int cols_per_block, int row_count,
        transposed_bsr_values));
 }
 
+// Block size used by wp_launch_device(), the SpMV kernels size their shared
+// memory accordingly
+constexpr int kBsrMvThreads = 256;
+
+// y := alpha * A * x + beta * y with GroupSize consecutive threads per block
+// row. Values of the row are read in coalesced chunks of Step scalars; as
+// Step is a multiple of the block size each lane keeps the same position
+// within the blocks across iterations, so accumulators can be summed per
+// output component once at the end of the row. Values of type V are
+// converted to the vector type T, which is also used for accumulation.
+template <int Rows, int Cols, int GroupSize, typename T, typename V>
+__global__ void bsr_mv_group_kernel(const int row_count, const int *bsr_offsets,
+                                    const int *bsr_columns, const V *bsr_values,
+                                    const T *x, T *y, const T alpha,
+                                    const T beta) {
+  constexpr int BlockSize = Rows * Cols;
+  constexpr int BlocksPerStep =
+      GroupSize >= BlockSize ? GroupSize / BlockSize : 1;
+  constexpr int Step = BlocksPerStep * BlockSize;
+  constexpr int SlotsPerLane = (Step + GroupSize - 1) / GroupSize;
+
+  __shared__ T partial_sums[kBsrMvThreads * SlotsPerLane];
+
+  const int tid = blockIdx.x * blockDim.x + threadIdx.x;
+  const int row = tid / GroupSize;
+  const int lane = threadIdx.x % GroupSize;
+
+  T *group_sums =
+      partial_sums + (threadIdx.x / GroupSize) * GroupSize * SlotsPerLane;
+
+  T acc[SlotsPerLane];
+  for (int s = 0; s < SlotsPerLane; ++s)
+    acc[s] = T(0);
+
+  // no early exit, all lanes of the warp must reach __syncwarp()
+  if (row < row_count) {
+    const int beg = bsr_offsets[row] * BlockSize;
+    const int end = bsr_offsets[row + 1] * BlockSize;
+
+    for (int base = beg; base < end; base += Step) {
+      for (int s = 0; s < SlotsPerLane; ++s) {
+        const int p = lane + s * GroupSize;
+        const int i = base + p;
+        if (p < Step && i < end) {
+          const int col = bsr_columns[i / BlockSize];
+          acc[s] += T(bsr_values[i]) * x[col * Cols + p % Cols];
+        }
+      }
+    }
+  }
+
+  for (int s = 0; s < SlotsPerLane; ++s)
+    group_sums[lane + s * GroupSize] = acc[s];
+
+  __syncwarp();
+
+  if (row < row_count) {
+    for (int r = lane; r < Rows; r += GroupSize) {
+      T sum = T(0);
+      for (int b = 0; b < BlocksPerStep; ++b)
+        for (int c = 0; c < Cols; ++c)
+          sum += group_sums[b * BlockSize + r * Cols + c];
+
+      // y is not read when beta is zero, so it may be uninitialized
+      const int i = row * Rows + r;
+      y[i] = beta == T(0) ? alpha * sum : alpha * sum + beta * y[i];
+    }
+  }
+}
+
+// Fallback for arbitrary block shapes, one thread per block row
+template <typename T, typename V>
+__global__ void bsr_mv_row_kernel(const int row_count, const int rows_per_block,
+                                  const int cols_per_block,
+                                  const int *bsr_offsets,
+                                  const int *bsr_columns, const V *bsr_values,
+                                  const T *x, T *y, const T alpha,
+                                  const T beta) {
+  const int row = blockIdx.x * blockDim.x + threadIdx.x;
+  if (row >= row_count)
+    return;
+
+  const int block_size = rows_per_block * cols_per_block;
+  const int beg = bsr_offsets[row];
+  const int end = bsr_offsets[row + 1];
+
+  for (int r = 0; r < rows_per_block; ++r) {
+    T sum = T(0);
+    for (int block = beg; block < end; ++block) {
+      const V *val = bsr_values + block * block_size + r * cols_per_block;
+      const T *xb = x + bsr_columns[block] * cols_per_block;
+      for (int c = 0; c < cols_per_block; ++c)
+        sum += T(val[c]) * xb[c];
+    }
+
+    const int i = row * rows_per_block + r;
+    y[i] = beta == T(0) ? alpha * sum : alpha * sum + beta * y[i];
+  }
+}
+
+template <int Rows, int Cols, int GroupSize, typename T, typename V>
+void bsr_mv_launch_groups(int row_count, const int *bsr_offsets,
+                          const int *bsr_columns, const V *bsr_values,
+                          const T *x, T *y, T alpha, T beta) {
+  auto kernel = bsr_mv_group_kernel<Rows, Cols, GroupSize, T, V>;
+  wp_launch_device(WP_CURRENT_CONTEXT, kernel, row_count * GroupSize,
+                   (row_count, bsr_offsets, bsr_columns, bsr_values, x, y,
+                    alpha, beta));
+}
+
+template <int Rows, int Cols, typename T, typename V>
+void bsr_mv_launch(int row_count, int nnz, int group_size,
+                   const int *bsr_offsets, const int *bsr_columns,
+                   const V *bsr_values, const T *x, T *y, T alpha, T beta) {
+  // Unless a tuned group size is given, pick it from the average number of
+  // values per row, so short rows do not leave most of a warp idle
+  const int64_t row_values =
+      group_size > 0 ? group_size
+                     : static_cast<int64_t>(nnz) * Rows * Cols / row_count;
+
+  if (row_values <= 4)
+    bsr_mv_launch_groups<Rows, Cols, 4>(row_count, bsr_offsets, bsr_columns,
+                                        bsr_values, x, y, alpha, beta);
+  else if (row_values <= 8)
+    bsr_mv_launch_groups<Rows, Cols, 8>(row_count, bsr_offsets, bsr_columns,
+                                        bsr_values, x, y, alpha, beta);
+  else if (row_values <= 16)
+    bsr_mv_launch_groups<Rows, Cols, 16>(row_count, bsr_offsets, bsr_columns,
+                                         bsr_values, x, y, alpha, beta);
+  else
+    bsr_mv_launch_groups<Rows, Cols, 32>(row_count, bsr_offsets, bsr_columns,
+                                         bsr_values, x, y, alpha, beta);
+}
+
+template <typename T, typename V>
+void bsr_mv_device(int rows_per_block, int cols_per_block, int row_count,
+                   int nnz, int group_size, const int *bsr_offsets,
+                   const int *bsr_columns, const V *bsr_values, const T *x, T *y,
+                   T alpha, T beta) {
+  if (row_count == 0)
+    return;
+
+  ContextGuard guard(cuda_context_get_current());
+
+  if (rows_per_block == 1 && cols_per_block == 1) {
+    bsr_mv_launch<1, 1>(row_count, nnz, group_size, bsr_offsets, bsr_columns,
+                        bsr_values, x, y, alpha, beta);
+  } else if (rows_per_block == 2 && cols_per_block == 2) {
+    bsr_mv_launch<2, 2>(row_count, nnz, group_size, bsr_offsets, bsr_columns,
+                        bsr_values, x, y, alpha, beta);
+  } else if (rows_per_block == 3 && cols_per_block == 3) {
+    bsr_mv_launch<3, 3>(row_count, nnz, group_size, bsr_offsets, bsr_columns,
+                        bsr_values, x, y, alpha, beta);
+  } else if (rows_per_block == 4 && cols_per_block == 4) {
+    bsr_mv_launch<4, 4>(row_count, nnz, group_size, bsr_offsets, bsr_columns,
+                        bsr_values, x, y, alpha, beta);
+  } else if (rows_per_block == 6 && cols_per_block == 6) {
+    bsr_mv_launch<6, 6>(row_count, nnz, group_size, bsr_offsets, bsr_columns,
+                        bsr_values, x, y, alpha, beta);
+  } else {
+    auto kernel = bsr_mv_row_kernel<T, V>;
+    wp_launch_device(WP_CURRENT_CONTEXT, kernel, row_count,
+                     (row_count, rows_per_block, cols_per_block, bsr_offsets,
+                      bsr_columns, bsr_values, x, y, alpha, beta));
+  }
+}
+
+// One CUDA block per row of the product, the distinct block columns of a row
+// are gathered in a shared memory hash table
+constexpr int kBsrMmThreads = 256;
+constexpr int kBsrMmHashSize = 2048;
+
+CUDA_CALLABLE_DEVICE bool bsr_mm_hash_insert(int *table, int col,
+                                             int *count) {
+  unsigned int h = (static_cast<unsigned int>(col) * 2654435761u) &
+                   (kBsrMmHashSize - 1);
+  for (int probe = 0; probe < kBsrMmHashSize; ++probe) {
+    const int prev = atomicCAS(table + h, -1, col);
+    if (prev == -1) {
+      atomicAdd(count, 1);
+      return true;
+    }
+    if (prev == col)
+      return true;
+    h = (h + 1) & (kBsrMmHashSize - 1);
+  }
+  return false;
+}
+
+// Inserts the block columns of row `row` of X*Y, and of Z if z_offsets is
+// not null, returns false if the table is full
+CUDA_CALLABLE_DEVICE bool
+bsr_mm_hash_row(int row, const int *x_offsets, const int *x_columns,
+                const int *y_offsets, const int *y_columns,
+                const int *z_offsets, const int *z_columns, int *table,
+                int *count) {
+  bool ok = true;
+
+  if (z_offsets) {
+    for (int i = z_offsets[row] + threadIdx.x; i < z_offsets[row + 1];
+         i += blockDim.x)
+      ok &= bsr_mm_hash_insert(table, z_columns[i], count);
+  }
+
+  for (int a = x_offsets[row] + threadIdx.x; a < x_offsets[row + 1];
+       a += blockDim.x) {
+    const int k = x_columns[a];
+    for (int b = y_offsets[k]; b < y_offsets[k + 1]; ++b)
+      ok &= bsr_mm_hash_insert(table, y_columns[b], count);
+  }
+
+  return ok;
+}
+
+__global__ void bsr_mm_count_rows(const int *x_offsets, const int *x_columns,
+                                  const int *y_offsets, const int *y_columns,
+                                  const int *z_offsets, const int *z_columns,
+                                  int *mm_row_counts, int *overflow) {
+  __shared__ int table[kBsrMmHashSize];
+  __shared__ int count;
+
+  const int row = blockIdx.x;
+
+  for (int i = threadIdx.x; i < kBsrMmHashSize; i += blockDim.x)
+    table[i] = -1;
+  if (threadIdx.x == 0)
+    count = 0;
+  __syncthreads();
+
+  if (!bsr_mm_hash_row(row, x_offsets, x_columns, y_offsets, y_columns,
+                       z_offsets, z_columns, table, &count))
+    *overflow = 1;
+
+  __syncthreads();
+
+  if (threadIdx.x == 0)
+    mm_row_counts[row] = count;
+}
+
+__global__ void bsr_mm_list_rows(const int *x_offsets, const int *x_columns,
+                                 const int *y_offsets, const int *y_columns,
+                                 const int *z_offsets, const int *z_columns,
+                                 const int *mm_offsets, int *mm_columns) {
+  __shared__ int table[kBsrMmHashSize];
+  __shared__ int unique_columns[kBsrMmHashSize];
+  __shared__ int count;
+  __shared__ int unique_count;
+
+  const int row = blockIdx.x;
+
+  for (int i = threadIdx.x; i < kBsrMmHashSize; i += blockDim.x)
+    table[i] = -1;
+  if (threadIdx.x == 0) {
+    count = 0;
+    unique_count = 0;
+  }
+  __syncthreads();
+
+  // cannot overflow, the count pass would have reported it
+  bsr_mm_hash_row(row, x_offsets, x_columns, y_offsets, y_columns, z_offsets,
+                  z_columns, table, &count);
+  __syncthreads();
+
+  for (int i = threadIdx.x; i < kBsrMmHashSize; i += blockDim.x) {
+    if (table[i] != -1)
+      unique_columns[atomicAdd(&unique_count, 1)] = table[i];
+  }
+  __syncthreads();
+
+  // sort columns by rank, rows hold at most a few hundred blocks in practice
+  int *row_columns = mm_columns + mm_offsets[row];
+  for (int i = threadIdx.x; i < unique_count; i += blockDim.x) {
+    const int col = unique_columns[i];
+    int rank = 0;
+    for (int j = 0; j < unique_count; ++j)
+      rank += unique_columns[j] < col;
+    row_columns[rank] = col;
+  }
+}
+
+// Index of `col` in the sorted range columns[beg, end), or -1
+CUDA_CALLABLE_DEVICE int bsr_find_column(const int *columns, int beg, int end,
+                                         int col) {
+  int lo = beg;
+  int hi = end;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (columns[mid] < col)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (lo < end && columns[lo] == col) ? lo : -1;
+}
+
+// mm := alpha * X * Y + beta * Z, one thread per row. When mm and Z share
+// storage the row is scaled in place; product blocks outside of the mm
+// sparsity pattern are dropped. Non-zero XRows, XCols and YCols fix the block
+// shapes at compile time so that block products are unrolled
+template <int XRows, int XCols, int YCols, typename T>
+__global__ void
+bsr_mm_compute_values(const int row_count, const int x_rows,
+                      const int x_cols, const int y_cols,
+                      const T alpha, const T beta, const int *x_offsets,
+                      const int *x_columns, const T *x_values,
+                      const int *y_offsets, const int *y_columns,
+                      const T *y_values, const int *z_offsets,
+                      const int *z_columns, const T *z_values,
+                      const int *mm_offsets, const int *mm_columns,
+                      T *mm_values) {
+  const int row = blockIdx.x * blockDim.x + threadIdx.x;
+  if (row >= row_count)
+    return;
+
+  const int x_rows_per_block = XRows ? XRows : x_rows;
+  const int x_cols_per_block = XCols ? XCols : x_cols;
+  const int y_cols_per_block = YCols ? YCols : y_cols;
+
+  const int x_block_size = x_rows_per_block * x_cols_per_block;
+  const int y_block_size = x_cols_per_block * y_cols_per_block;
+  const int mm_block_size = x_rows_per_block * y_cols_per_block;
+
+  const int beg = mm_offsets[row];
+  const int end = mm_offsets[row + 1];
+
+  if (z_values == mm_values) {
+    for (int i = beg * mm_block_size; i < end * mm_block_size; ++i)
+      mm_values[i] = beta == T(0) ? T(0) : beta * mm_values[i];
+  } else {
+    for (int i = beg * mm_block_size; i < end * mm_block_size; ++i)
+      mm_values[i] = T(0);
+
+    if (beta != T(0) && z_values) {
+      for (int i = z_offsets[row]; i < z_offsets[row + 1]; ++i) {
+        const int slot = bsr_find_column(mm_columns, beg, end, z_columns[i]);
+        if (slot < 0)
+          continue;
+        for (int k = 0; k < mm_block_size; ++k)
+          mm_values[slot * mm_block_size + k] +=
+              beta * z_values[i * mm_block_size + k];
+      }
+    }
+  }
+
+  for (int a = x_offsets[row]; a < x_offsets[row + 1]; ++a) {
+    const int k = x_columns[a];
+    const T *xv = x_values + a * x_block_size;
+
+    for (int b = y_offsets[k]; b < y_offsets[k + 1]; ++b) {
+      const int slot = bsr_find_column(mm_columns, beg, end, y_columns[b]);
+      if (slot < 0)
+        continue;
+
+      const T *yv = y_values + b * y_block_size;
+      T *mv = mm_values + slot * mm_block_size;
+
+      for (int r = 0; r < x_rows_per_block; ++r) {
+        for (int c = 0; c < y_cols_per_block; ++c) {
+          T sum = T(0);
+          for (int m = 0; m < x_cols_per_block; ++m)
+            sum += xv[r * x_cols_per_block + m] * yv[m * y_cols_per_block + c];
+          mv[r * y_cols_per_block + c] += alpha * sum;
+        }
+      }
+    }
+  }
+}
+
+int bsr_mm_count_device(int row_count, const int *x_offsets,
+                        const int *x_columns, const int *y_offsets,
+                        const int *y_columns, const int *z_offsets,
+                        const int *z_columns, int *mm_offsets) {
+  void *context = cuda_context_get_current();
+
+  // Per-context cached temporary buffers
+  PinnedTemporaryBuffer &pinned_temp = g_pinned_temp_buffer_map[context];
+  BsrFromTripletsTemp &bsr_temp = g_bsr_from_triplets_temp_map[context];
+
+  ContextGuard guard(context);
+  ScopedMemoryTag memory_tag("sparse");
+
+  cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+  bsr_temp.ensure_fits(0);
+
+  pinned_temp.ensure_fits(2 * sizeof(int));
+  int *pinned_count = static_cast<int *>(pinned_temp.buffer);
+
+  int *d_overflow =
+      static_cast<int *>(alloc_temp_device(WP_CURRENT_CONTEXT, sizeof(int)));
+  memset_device(WP_CURRENT_CONTEXT, d_overflow, 0, sizeof(int));
+
+  // Last element stays zero so that the exclusive scan yields offsets
+  memset_device(WP_CURRENT_CONTEXT, mm_offsets + row_count, 0, sizeof(int));
+
+  if (row_count > 0) {
+    bsr_mm_count_rows<<<row_count, kBsrMmThreads, 0, stream>>>(
+        x_offsets, x_columns, y_offsets, y_columns, z_offsets, z_columns,
+        mm_offsets, d_overflow);
+  }
+
+  size_t buff_size = 0;
+  check_cuda(cub::DeviceScan::ExclusiveSum(nullptr, buff_size, mm_offsets,
+                                           mm_offsets, row_count + 1, stream));
+  void *temp_buffer = alloc_temp_device(WP_CURRENT_CONTEXT, buff_size);
+  check_cuda(cub::DeviceScan::ExclusiveSum(temp_buffer, buff_size, mm_offsets,
+                                           mm_offsets, row_count + 1, stream));
+  free_temp_device(WP_CURRENT_CONTEXT, temp_buffer);
+
+  memcpy_d2h(WP_CURRENT_CONTEXT, pinned_count, mm_offsets + row_count,
+             sizeof(int));
+  memcpy_d2h(WP_CURRENT_CONTEXT, pinned_count + 1, d_overflow, sizeof(int));
+  cudaEventRecord(bsr_temp.host_sync_event, stream);
+
+  free_temp_device(WP_CURRENT_CONTEXT, d_overflow);
+
+  cudaEventSynchronize(bsr_temp.host_sync_event);
+
+  return pinned_count[1] ? -1 : pinned_count[0];
+}
+
+void bsr_mm_list_columns_device(int row_count, const int *x_offsets,
+                                const int *x_columns, const int *y_offsets,
+                                const int *y_columns, const int *z_offsets,
+                                const int *z_columns, const int *mm_offsets,
+                                int *mm_columns) {
+  if (row_count == 0)
+    return;
+
+  ContextGuard guard(cuda_context_get_current());
+  cudaStream_t stream = static_cast<cudaStream_t>(cuda_stream_get_current());
+
+  bsr_mm_list_rows<<<row_count, kBsrMmThreads, 0, stream>>>(
+      x_offsets, x_columns, y_offsets, y_columns, z_offsets, z_columns,
+      mm_offsets, mm_columns);
+}
+
+template <typename T>
+void bsr_mm_compute_values_device(
+    int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+    int row_count, const int *x_offsets, const int *x_columns,
+    const T *x_values, const int *y_offsets, const int *y_columns,
+    const T *y_values, const int *z_offsets, const int *z_columns,
+    const T *z_values, const int *mm_offsets, const int *mm_columns,
+    T *mm_values, T alpha, T beta) {
+  ContextGuard guard(cuda_context_get_current());
+
+  auto kernel = bsr_mm_compute_values<0, 0, 0, T>;
+  if (x_rows_per_block == x_cols_per_block &&
+      x_cols_per_block == y_cols_per_block) {
+    switch (x_rows_per_block) {
+    case 1:
+      kernel = bsr_mm_compute_values<1, 1, 1, T>;
+      break;
+    case 2:
+      kernel = bsr_mm_compute_values<2, 2, 2, T>;
+      break;
+    case 3:
+      kernel = bsr_mm_compute_values<3, 3, 3, T>;
+      break;
+    case 4:
+      kernel = bsr_mm_compute_values<4, 4, 4, T>;
+      break;
+    case 6:
+      kernel = bsr_mm_compute_values<6, 6, 6, T>;
+      break;
+    }
+  }
+
+  wp_launch_device(WP_CURRENT_CONTEXT, kernel, row_count,
+                   (row_count, x_rows_per_block, x_cols_per_block,
+                    y_cols_per_block, alpha, beta, x_offsets, x_columns,
+                    x_values, y_offsets, y_columns, y_values, z_offsets,
+                    z_columns, z_values, mm_offsets, mm_columns, mm_values));
+}
+
+// dst := dst + scale * src for the blocks of src, whose rows and columns are
+// given by triplets, one thread per block coefficient. Blocks of src have
+// distinct positions so no atomics are needed
+template <int BlockSize, typename T>
+__global__ void bsr_axpy_blocks(const int block_size, const int count,
+                                const int *rows, const int *columns,
+                                const int *dst_offsets,
+                                const int *dst_columns, const T *src_values,
+                                T *dst_values, const T scale) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= count)
+    return;
+
+  const int size = BlockSize ? BlockSize : block_size;
+  const int src_block = i / size;
+  const int k = i - src_block * size;
+
+  const int row = rows[src_block];
+  const int block = bsr_find_column(dst_columns, dst_offsets[row],
+                                    dst_offsets[row + 1], columns[src_block]);
+
+  dst_values[block * size + k] += scale * src_values[i];
+}
+
+template <int N, typename T>
+__global__ void bsr_block_diag_inverse_kernel(const int row_count,
+                                              const int *offsets,
+                                              const int *columns,
+                                              const T *values, T *inv_diag) {
+  const int row = blockIdx.x * blockDim.x + threadIdx.x;
+  if (row < row_count)
+    wp::bsr_diag_block_inverse<N>(row, offsets, columns, values, inv_diag);
+}
+
+// One launch per level of the schedule, the rows of a level are independent
+template <int N, typename T>
+__global__ void bsr_ilu_factor_level(const int count, const int *rows,
+                                     const int *offsets, const int *columns,
+                                     T *values, T *inv_diag) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < count)
+    wp::bsr_ilu_factor_row<N>(rows[i], offsets, columns, values, inv_diag);
+}
+
+template <int N, typename T>
+__global__ void bsr_ilu_lower_solve_level(const int count, const int *rows,
+                                          const int *offsets,
+                                          const int *columns,
+                                          const T *values, const T *x, T *z) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < count)
+    wp::bsr_ilu_lower_solve_row<N>(rows[i], offsets, columns, values, x, z);
+}
+
+template <int N, typename T>
+__global__ void bsr_ilu_upper_solve_level(const int count, const int *rows,
+                                          const int *offsets,
+                                          const int *columns,
+                                          const T *values, const T *inv_diag,
+                                          T *z) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < count)
+    wp::bsr_ilu_upper_solve_row<N>(rows[i], offsets, columns, values,
+                                   inv_diag, z);
+}
+
+template <int N, typename T>
+void bsr_ilu_factor_levels(const int *level_rows, const int *level_offsets,
+                           int level_count, const int *offsets,
+                           const int *columns, T *values, T *inv_diag) {
+  auto kernel = bsr_ilu_factor_level<N, T>;
+  for (int l = 0; l < level_count; ++l) {
+    const int count = level_offsets[l + 1] - level_offsets[l];
+    wp_launch_device(WP_CURRENT_CONTEXT, kernel, count,
+                     (count, level_rows + level_offsets[l], offsets, columns,
+                      values, inv_diag));
+  }
+}
+
+template <int N, typename T>
+void bsr_ilu_solve_levels(const int *lower_rows,
+                          const int *lower_level_offsets,
+                          int lower_level_count, const int *upper_rows,
+                          const int *upper_level_offsets,
+                          int upper_level_count, const int *offsets,
+                          const int *columns, const T *values,
+                          const T *inv_diag, const T *x, T *z) {
+  auto lower_kernel = bsr_ilu_lower_solve_level<N, T>;
+  for (int l = 0; l < lower_level_count; ++l) {
+    const int count = lower_level_offsets[l + 1] - lower_level_offsets[l];
+    wp_launch_device(WP_CURRENT_CONTEXT, lower_kernel, count,
+                     (count, lower_rows + lower_level_offsets[l], offsets,
+                      columns, values, x, z));
+  }
+
+  auto upper_kernel = bsr_ilu_upper_solve_level<N, T>;
+  for (int l = 0; l < upper_level_count; ++l) {
+    const int count = upper_level_offsets[l + 1] - upper_level_offsets[l];
+    wp_launch_device(WP_CURRENT_CONTEXT, upper_kernel, count,
+                     (count, upper_rows + upper_level_offsets[l], offsets,
+                      columns, values, inv_diag, z));
+  }
+}
+
+template <typename T>
+void bsr_block_diag_inverse_device(int block_size, int row_count,
+                                   const int *offsets, const int *columns,
+                                   const T *values, T *inv_diag) {
+  ContextGuard guard(cuda_context_get_current());
+
+  auto kernel = bsr_block_diag_inverse_kernel<1, T>;
+  switch (block_size) {
+  case 1:
+    kernel = bsr_block_diag_inverse_kernel<1, T>;
+    break;
+  case 2:
+    kernel = bsr_block_diag_inverse_kernel<2, T>;
+    break;
+  case 3:
+    kernel = bsr_block_diag_inverse_kernel<3, T>;
+    break;
+  case 4:
+    kernel = bsr_block_diag_inverse_kernel<4, T>;
+    break;
+  case 5:
+    kernel = bsr_block_diag_inverse_kernel<5, T>;
+    break;
+  case 6:
+    kernel = bsr_block_diag_inverse_kernel<6, T>;
+    break;
+  default:
+    return;
+  }
+
+  wp_launch_device(WP_CURRENT_CONTEXT, kernel, row_count,
+                   (row_count, offsets, columns, values, inv_diag));
+}
+
+template <typename T>
+void bsr_ilu_factor_device(int block_size, const int *level_rows,
+                           const int *level_offsets, int level_count,
+                           const int *offsets, const int *columns, T *values,
+                           T *inv_diag) {
+  ContextGuard guard(cuda_context_get_current());
+
+  switch (block_size) {
+  case 1:
+    return bsr_ilu_factor_levels<1>(level_rows, level_offsets, level_count,
+                                    offsets, columns, values, inv_diag);
+  case 2:
+    return bsr_ilu_factor_levels<2>(level_rows, level_offsets, level_count,
+                                    offsets, columns, values, inv_diag);
+  case 3:
+    return bsr_ilu_factor_levels<3>(level_rows, level_offsets, level_count,
+                                    offsets, columns, values, inv_diag);
+  case 4:
+    return bsr_ilu_factor_levels<4>(level_rows, level_offsets, level_count,
+                                    offsets, columns, values, inv_diag);
+  case 5:
+    return bsr_ilu_factor_levels<5>(level_rows, level_offsets, level_count,
+                                    offsets, columns, values, inv_diag);
+  case 6:
+    return bsr_ilu_factor_levels<6>(level_rows, level_offsets, level_count,
+                                    offsets, columns, values, inv_diag);
+  }
+}
+
+template <typename T>
+void bsr_ilu_solve_device(int block_size, const int *lower_rows,
+                          const int *lower_level_offsets,
+                          int lower_level_count, const int *upper_rows,
+                          const int *upper_level_offsets,
+                          int upper_level_count, const int *offsets,
+                          const int *columns, const T *values,
+                          const T *inv_diag, const T *x, T *z) {
+  ContextGuard guard(cuda_context_get_current());
+
+  switch (block_size) {
+  case 1:
+    return bsr_ilu_solve_levels<1>(
+        lower_rows, lower_level_offsets, lower_level_count, upper_rows,
+        upper_level_offsets, upper_level_count, offsets, columns, values,
+        inv_diag, x, z);
+  case 2:
+    return bsr_ilu_solve_levels<2>(
+        lower_rows, lower_level_offsets, lower_level_count, upper_rows,
+        upper_level_offsets, upper_level_count, offsets, columns, values,
+        inv_diag, x, z);
+  case 3:
+    return bsr_ilu_solve_levels<3>(
+        lower_rows, lower_level_offsets, lower_level_count, upper_rows,
+        upper_level_offsets, upper_level_count, offsets, columns, values,
+        inv_diag, x, z);
+  case 4:
+    return bsr_ilu_solve_levels<4>(
+        lower_rows, lower_level_offsets, lower_level_count, upper_rows,
+        upper_level_offsets, upper_level_count, offsets, columns, values,
+        inv_diag, x, z);
+  case 5:
+    return bsr_ilu_solve_levels<5>(
+        lower_rows, lower_level_offsets, lower_level_count, upper_rows,
+        upper_level_offsets, upper_level_count, offsets, columns, values,
+        inv_diag, x, z);
+  case 6:
+    return bsr_ilu_solve_levels<6>(
+        lower_rows, lower_level_offsets, lower_level_count, upper_rows,
+        upper_level_offsets, upper_level_count, offsets, columns, values,
+        inv_diag, x, z);
+  }
+}
+
+template <typename T>
+void bsr_axpy_blocks_device(int block_size, int nnz, const int *rows,
+                            const int *columns, const int *dst_offsets,
+                            const int *dst_columns, const T *src_values,
+                            T *dst_values, T scale) {
+  if (nnz == 0)
+    return;
+
+  ContextGuard guard(cuda_context_get_current());
+
+  auto kernel = bsr_axpy_blocks<0, T>;
+  switch (block_size) {
+  case 1:
+    kernel = bsr_axpy_blocks<1, T>;
+    break;
+  case 4:
+    kernel = bsr_axpy_blocks<4, T>;
+    break;
+  case 9:
+    kernel = bsr_axpy_blocks<9, T>;
+    break;
+  case 16:
+    kernel = bsr_axpy_blocks<16, T>;
+    break;
+  case 36:
+    kernel = bsr_axpy_blocks<36, T>;
+    break;
+  }
+
+  const int count = nnz * block_size;
+  wp_launch_device(WP_CURRENT_CONTEXT, kernel, count,
+                   (block_size, count, rows, columns, dst_offsets,
+                    dst_columns, src_values, dst_values, scale));
+}
+
 } // namespace
 
 int bsr_matrix_from_triplets_float_device(
     int rows_per_block, int cols_per_block, int row_count, int nnz,
     uint64_t tpl_rows, uint64_t tpl_columns, uint64_t tpl_values,
-    uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values) {
+    uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+    uint64_t tpl_block_offsets, uint64_t tpl_block_indices) {
   return bsr_matrix_from_triplets_device<float>(
       rows_per_block, cols_per_block, row_count, nnz,
       reinterpret_cast<const int *>(tpl_rows),
@@ -487,13 +1269,28 @@ int bsr_matrix_from_triplets_float_device(
       reinterpret_cast<const float *>(tpl_values),
       reinterpret_cast<int *>(bsr_offsets),
       reinterpret_cast<int *>(bsr_columns),
+      reinterpret_cast<float *>(bsr_values),
+      reinterpret_cast<int *>(tpl_block_offsets),
+      reinterpret_cast<int *>(tpl_block_indices));
+}
+
+void bsr_set_triplet_values_float_device(int block_size, int nnz,
+                                       uint64_t tpl_block_offsets,
+                                       uint64_t tpl_block_indices,
+                                       uint64_t tpl_values,
+                                       uint64_t bsr_values) {
+  bsr_set_triplet_values_device<float>(
+      block_size, nnz, reinterpret_cast<const int *>(tpl_block_offsets),
+      reinterpret_cast<const int *>(tpl_block_indices),
+      reinterpret_cast<const float *>(tpl_values),
       reinterpret_cast<float *>(bsr_values));
 }
 
 int bsr_matrix_from_triplets_double_device(
     int rows_per_block, int cols_per_block, int row_count, int nnz,
     uint64_t tpl_rows, uint64_t tpl_columns, uint64_t tpl_values,
-    uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values) {
+    uint64_t bsr_offsets, uint64_t bsr_columns, uint64_t bsr_values,
+    uint64_t tpl_block_offsets, uint64_t tpl_block_indices) {
   return bsr_matrix_from_triplets_device<double>(
       rows_per_block, cols_per_block, row_count, nnz,
       reinterpret_cast<const int *>(tpl_rows),
@@ -501,9 +1298,35 @@ int bsr_matrix_from_triplets_double_device(
       reinterpret_cast<const double *>(tpl_values),
       reinterpret_cast<int *>(bsr_offsets),
       reinterpret_cast<int *>(bsr_columns),
+      reinterpret_cast<double *>(bsr_values),
+      reinterpret_cast<int *>(tpl_block_offsets),
+      reinterpret_cast<int *>(tpl_block_indices));
+}
+
+void bsr_set_triplet_values_double_device(int block_size, int nnz,
+                                       uint64_t tpl_block_offsets,
+                                       uint64_t tpl_block_indices,
+                                       uint64_t tpl_values,
+                                       uint64_t bsr_values) {
+  bsr_set_triplet_values_device<double>(
+      block_size, nnz, reinterpret_cast<const int *>(tpl_block_offsets),
+      reinterpret_cast<const int *>(tpl_block_indices),
+      reinterpret_cast<const double *>(tpl_values),
       reinterpret_cast<double *>(bsr_values));
 }
 
+void bsr_set_triplet_values_half_device(int block_size, int nnz,
+                                        uint64_t tpl_block_offsets,
+                                        uint64_t tpl_block_indices,
+                                        uint64_t tpl_values,
+                                        uint64_t bsr_values) {
+  bsr_set_triplet_values_device<wp::half, float>(
+      block_size, nnz, reinterpret_cast<const int *>(tpl_block_offsets),
+      reinterpret_cast<const int *>(tpl_block_indices),
+      reinterpret_cast<const wp::half *>(tpl_values),
+      reinterpret_cast<wp::half *>(bsr_values));
+}
+
 void bsr_transpose_float_device(int rows_per_block, int cols_per_block,
                                 int row_count, int col_count, int nnz,
                                 uint64_t bsr_offsets, uint64_t bsr_columns,
@@ -535,3 +1358,236 @@ void bsr_transpose_double_device(int rows_per_block, int cols_per_block,
                        reinterpret_cast<int *>(transposed_bsr_columns),
                        reinterpret_cast<double *>(transposed_bsr_values));
 }
+
+void bsr_transpose_half_device(int rows_per_block, int cols_per_block,
+                               int row_count, int col_count, int nnz,
+                               uint64_t bsr_offsets, uint64_t bsr_columns,
+                               uint64_t bsr_values,
+                               uint64_t transposed_bsr_offsets,
+                               uint64_t transposed_bsr_columns,
+                               uint64_t transposed_bsr_values) {
+  // blocks are only moved around, no need for half arithmetic
+  bsr_transpose_device(rows_per_block, cols_per_block, row_count, col_count,
+                       nnz, reinterpret_cast<const int *>(bsr_offsets),
+                       reinterpret_cast<const int *>(bsr_columns),
+                       reinterpret_cast<const uint16_t *>(bsr_values),
+                       reinterpret_cast<int *>(transposed_bsr_offsets),
+                       reinterpret_cast<int *>(transposed_bsr_columns),
+                       reinterpret_cast<uint16_t *>(transposed_bsr_values));
+}
+
+void bsr_mv_float_device(int rows_per_block, int cols_per_block, int row_count,
+                         int nnz, uint64_t bsr_offsets, uint64_t bsr_columns,
+                         uint64_t bsr_values, uint64_t x, uint64_t y,
+                         int group_size, float alpha, float beta) {
+  bsr_mv_device(rows_per_block, cols_per_block, row_count, nnz, group_size,
+                reinterpret_cast<const int *>(bsr_offsets),
+                reinterpret_cast<const int *>(bsr_columns),
+                reinterpret_cast<const float *>(bsr_values),
+                reinterpret_cast<const float *>(x),
+                reinterpret_cast<float *>(y), alpha, beta);
+}
+
+void bsr_mv_double_device(int rows_per_block, int cols_per_block, int row_count,
+                          int nnz, uint64_t bsr_offsets, uint64_t bsr_columns,
+                          uint64_t bsr_values, uint64_t x, uint64_t y,
+                          int group_size, double alpha, double beta) {
+  bsr_mv_device(rows_per_block, cols_per_block, row_count, nnz, group_size,
+                reinterpret_cast<const int *>(bsr_offsets),
+                reinterpret_cast<const int *>(bsr_columns),
+                reinterpret_cast<const double *>(bsr_values),
+                reinterpret_cast<const double *>(x),
+                reinterpret_cast<double *>(y), alpha, beta);
+}
+
+void bsr_mv_half_device(int rows_per_block, int cols_per_block, int row_count,
+                        int nnz, uint64_t bsr_offsets, uint64_t bsr_columns,
+                        uint64_t bsr_values, uint64_t x, uint64_t y,
+                        int group_size, float alpha, float beta) {
+  bsr_mv_device(rows_per_block, cols_per_block, row_count, nnz, group_size,
+                reinterpret_cast<const int *>(bsr_offsets),
+                reinterpret_cast<const int *>(bsr_columns),
+                reinterpret_cast<const wp::half *>(bsr_values),
+                reinterpret_cast<const float *>(x),
+                reinterpret_cast<float *>(y), alpha, beta);
+}
+
+int bsr_mm_count_device(int row_count, uint64_t x_offsets, uint64_t x_columns,
+                        uint64_t y_offsets, uint64_t y_columns,
+                        uint64_t z_offsets, uint64_t z_columns,
+                        uint64_t mm_offsets) {
+  return bsr_mm_count_device(row_count,
+                             reinterpret_cast<const int *>(x_offsets),
+                             reinterpret_cast<const int *>(x_columns),
+                             reinterpret_cast<const int *>(y_offsets),
+                             reinterpret_cast<const int *>(y_columns),
+                             reinterpret_cast<const int *>(z_offsets),
+                             reinterpret_cast<const int *>(z_columns),
+                             reinterpret_cast<int *>(mm_offsets));
+}
+
+void bsr_mm_list_columns_device(int row_count, uint64_t x_offsets,
+                                uint64_t x_columns, uint64_t y_offsets,
+                                uint64_t y_columns, uint64_t z_offsets,
+                                uint64_t z_columns, uint64_t mm_offsets,
+                                uint64_t mm_columns) {
+  bsr_mm_list_columns_device(row_count,
+                             reinterpret_cast<const int *>(x_offsets),
+                             reinterpret_cast<const int *>(x_columns),
+                             reinterpret_cast<const int *>(y_offsets),
+                             reinterpret_cast<const int *>(y_columns),
+                             reinterpret_cast<const int *>(z_offsets),
+                             reinterpret_cast<const int *>(z_columns),
+                             reinterpret_cast<const int *>(mm_offsets),
+                             reinterpret_cast<int *>(mm_columns));
+}
+
+void bsr_mm_compute_values_float_device(
+    int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+    int row_count, uint64_t x_offsets, uint64_t x_columns, uint64_t x_values,
+    uint64_t y_offsets, uint64_t y_columns, uint64_t y_values,
+    uint64_t z_offsets, uint64_t z_columns, uint64_t z_values,
+    uint64_t mm_offsets, uint64_t mm_columns, uint64_t mm_values, float alpha,
+    float beta) {
+  bsr_mm_compute_values_device(
+      x_rows_per_block, x_cols_per_block, y_cols_per_block, row_count,
+      reinterpret_cast<const int *>(x_offsets),
+      reinterpret_cast<const int *>(x_columns),
+      reinterpret_cast<const float *>(x_values),
+      reinterpret_cast<const int *>(y_offsets),
+      reinterpret_cast<const int *>(y_columns),
+      reinterpret_cast<const float *>(y_values),
+      reinterpret_cast<const int *>(z_offsets),
+      reinterpret_cast<const int *>(z_columns),
+      reinterpret_cast<const float *>(z_values),
+      reinterpret_cast<const int *>(mm_offsets),
+      reinterpret_cast<const int *>(mm_columns),
+      reinterpret_cast<float *>(mm_values), alpha, beta);
+}
+
+void bsr_mm_compute_values_double_device(
+    int x_rows_per_block, int x_cols_per_block, int y_cols_per_block,
+    int row_count, uint64_t x_offsets, uint64_t x_columns, uint64_t x_values,
+    uint64_t y_offsets, uint64_t y_columns, uint64_t y_values,
+    uint64_t z_offsets, uint64_t z_columns, uint64_t z_values,
+    uint64_t mm_offsets, uint64_t mm_columns, uint64_t mm_values,
+    double alpha, double beta) {
+  bsr_mm_compute_values_device(
+      x_rows_per_block, x_cols_per_block, y_cols_per_block, row_count,
+      reinterpret_cast<const int *>(x_offsets),
+      reinterpret_cast<const int *>(x_columns),
+      reinterpret_cast<const double *>(x_values),
+      reinterpret_cast<const int *>(y_offsets),
+      reinterpret_cast<const int *>(y_columns),
+      reinterpret_cast<const double *>(y_values),
+      reinterpret_cast<const int *>(z_offsets),
+      reinterpret_cast<const int *>(z_columns),
+      reinterpret_cast<const double *>(z_values),
+      reinterpret_cast<const int *>(mm_offsets),
+      reinterpret_cast<const int *>(mm_columns),
+      reinterpret_cast<double *>(mm_values), alpha, beta);
+}
+
+void bsr_axpy_blocks_float_device(int block_size, int nnz, uint64_t rows,
+                                  uint64_t columns, uint64_t dst_offsets,
+                                  uint64_t dst_columns, uint64_t src_values,
+                                  uint64_t dst_values, float scale) {
+  bsr_axpy_blocks_device(block_size, nnz, reinterpret_cast<const int *>(rows),
+                         reinterpret_cast<const int *>(columns),
+                         reinterpret_cast<const int *>(dst_offsets),
+                         reinterpret_cast<const int *>(dst_columns),
+                         reinterpret_cast<const float *>(src_values),
+                         reinterpret_cast<float *>(dst_values), scale);
+}
+
+void bsr_axpy_blocks_double_device(int block_size, int nnz, uint64_t rows,
+                                   uint64_t columns, uint64_t dst_offsets,
+                                   uint64_t dst_columns, uint64_t src_values,
+                                   uint64_t dst_values, double scale) {
+  bsr_axpy_blocks_device(block_size, nnz, reinterpret_cast<const int *>(rows),
+                         reinterpret_cast<const int *>(columns),
+                         reinterpret_cast<const int *>(dst_offsets),
+                         reinterpret_cast<const int *>(dst_columns),
+                         reinterpret_cast<const double *>(src_values),
+                         reinterpret_cast<double *>(dst_values), scale);
+}
+
+void bsr_block_diag_inverse_float_device(int block_size, int row_count,
+                                     uint64_t offsets, uint64_t columns,
+                                     uint64_t values, uint64_t inv_diag) {
+  bsr_block_diag_inverse_device(block_size, row_count,
+                                reinterpret_cast<const int *>(offsets),
+                                reinterpret_cast<const int *>(columns),
+                                reinterpret_cast<const float *>(values),
+                                reinterpret_cast<float *>(inv_diag));
+}
+
+void bsr_block_diag_inverse_double_device(int block_size, int row_count,
+                                     uint64_t offsets, uint64_t columns,
+                                     uint64_t values, uint64_t inv_diag) {
+  bsr_block_diag_inverse_device(block_size, row_count,
+                                reinterpret_cast<const int *>(offsets),
+                                reinterpret_cast<const int *>(columns),
+                                reinterpret_cast<const double *>(values),
+                                reinterpret_cast<double *>(inv_diag));
+}
+
+void bsr_ilu_factor_float_device(int block_size, int row_count, uint64_t offsets,
+                             uint64_t columns, uint64_t values,
+                             uint64_t inv_diag, uint64_t level_rows,
+                             uint64_t level_offsets, int level_count) {
+  bsr_ilu_factor_device(block_size, reinterpret_cast<const int *>(level_rows),
+                        reinterpret_cast<const int *>(level_offsets),
+                        level_count, reinterpret_cast<const int *>(offsets),
+                        reinterpret_cast<const int *>(columns),
+                        reinterpret_cast<float *>(values),
+                        reinterpret_cast<float *>(inv_diag));
+}
+
+void bsr_ilu_factor_double_device(int block_size, int row_count, uint64_t offsets,
+                             uint64_t columns, uint64_t values,
+                             uint64_t inv_diag, uint64_t level_rows,
+                             uint64_t level_offsets, int level_count) {
+  bsr_ilu_factor_device(block_size, reinterpret_cast<const int *>(level_rows),
+                        reinterpret_cast<const int *>(level_offsets),
+                        level_count, reinterpret_cast<const int *>(offsets),
+                        reinterpret_cast<const int *>(columns),
+                        reinterpret_cast<double *>(values),
+                        reinterpret_cast<double *>(inv_diag));
+}
+
+void bsr_ilu_solve_float_device(int block_size, int row_count, uint64_t offsets,
+                            uint64_t columns, uint64_t values,
+                            uint64_t inv_diag, uint64_t lower_rows,
+                            uint64_t lower_level_offsets, int lower_level_count,
+                            uint64_t upper_rows, uint64_t upper_level_offsets,
+                            int upper_level_count, uint64_t x, uint64_t z) {
+  bsr_ilu_solve_device(
+      block_size, reinterpret_cast<const int *>(lower_rows),
+      reinterpret_cast<const int *>(lower_level_offsets), lower_level_count,
+      reinterpret_cast<const int *>(upper_rows),
+      reinterpret_cast<const int *>(upper_level_offsets), upper_level_count,
+      reinterpret_cast<const int *>(offsets),
+      reinterpret_cast<const int *>(columns),
+      reinterpret_cast<const float *>(values),
+      reinterpret_cast<const float *>(inv_diag),
+      reinterpret_cast<const float *>(x), reinterpret_cast<float *>(z));
+}
+
+void bsr_ilu_solve_double_device(int block_size, int row_count, uint64_t offsets,
+                            uint64_t columns, uint64_t values,
+                            uint64_t inv_diag, uint64_t lower_rows,
+                            uint64_t lower_level_offsets, int lower_level_count,
+                            uint64_t upper_rows, uint64_t upper_level_offsets,
+                            int upper_level_count, uint64_t x, uint64_t z) {
+  bsr_ilu_solve_device(
+      block_size, reinterpret_cast<const int *>(lower_rows),
+      reinterpret_cast<const int *>(lower_level_offsets), lower_level_count,
+      reinterpret_cast<const int *>(upper_rows),
+      reinterpret_cast<const int *>(upper_level_offsets), upper_level_count,
+      reinterpret_cast<const int *>(offsets),
+      reinterpret_cast<const int *>(columns),
+      reinterpret_cast<const double *>(values),
+      reinterpret_cast<const double *>(inv_diag),
+      reinterpret_cast<const double *>(x), reinterpret_cast<double *>(z));
+}
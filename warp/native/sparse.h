@@ -0,0 +1,244 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+#include "builtin.h"
+
+// Row operations of BSR matrices with square N x N blocks stored in row-major order, shared by the host and device
+// implementations of the block diagonal inverse and of the incomplete LU factorization
+
+namespace wp
+{
+
+// first position of the sorted range columns[beg, end) whose column is not below col
+CUDA_CALLABLE inline int bsr_row_lower_bound(const int* columns, int beg, int end, int col)
+{
+    while (beg < end)
+    {
+        const int mid = (beg + end)/2;
+        if (columns[mid] < col)
+            beg = mid + 1;
+        else
+            end = mid;
+    }
+    return beg;
+}
+
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_block_identity(T* a)
+{
+    for (int i=0; i < N*N; ++i)
+        a[i] = T(0);
+    for (int i=0; i < N; ++i)
+        a[i*N + i] = T(1);
+}
+
+// inverts a block by Gauss-Jordan elimination with partial pivoting, singular blocks are replaced by the identity
+// so that the corresponding rows are left unscaled
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_block_inverse(const T* a, T* inv)
+{
+    T m[N*N];
+    for (int i=0; i < N*N; ++i)
+        m[i] = a[i];
+
+    bsr_block_identity<N>(inv);
+
+    for (int c=0; c < N; ++c)
+    {
+        int pivot = c;
+        for (int r=c+1; r < N; ++r)
+        {
+            if (abs(m[r*N + c]) > abs(m[pivot*N + c]))
+                pivot = r;
+        }
+
+        if (m[pivot*N + c] == T(0))
+        {
+            bsr_block_identity<N>(inv);
+            return;
+        }
+
+        if (pivot != c)
+        {
+            for (int k=0; k < N; ++k)
+            {
+                T t = m[c*N + k]; m[c*N + k] = m[pivot*N + k]; m[pivot*N + k] = t;
+                t = inv[c*N + k]; inv[c*N + k] = inv[pivot*N + k]; inv[pivot*N + k] = t;
+            }
+        }
+
+        const T s = T(1)/m[c*N + c];
+        for (int k=0; k < N; ++k)
+        {
+            m[c*N + k] *= s;
+            inv[c*N + k] *= s;
+        }
+
+        for (int r=0; r < N; ++r)
+        {
+            const T f = m[r*N + c];
+            if (r == c || f == T(0))
+                continue;
+
+            for (int k=0; k < N; ++k)
+            {
+                m[r*N + k] -= f*m[c*N + k];
+                inv[r*N + k] -= f*inv[c*N + k];
+            }
+        }
+    }
+}
+
+// c := a*b
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_block_mul(const T* a, const T* b, T* c)
+{
+    for (int i=0; i < N; ++i)
+    {
+        for (int j=0; j < N; ++j)
+        {
+            T sum = T(0);
+            for (int k=0; k < N; ++k)
+                sum += a[i*N + k]*b[k*N + j];
+            c[i*N + j] = sum;
+        }
+    }
+}
+
+// c := c - a*b
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_block_mul_sub(const T* a, const T* b, T* c)
+{
+    for (int i=0; i < N; ++i)
+    {
+        for (int j=0; j < N; ++j)
+        {
+            T sum = T(0);
+            for (int k=0; k < N; ++k)
+                sum += a[i*N + k]*b[k*N + j];
+            c[i*N + j] -= sum;
+        }
+    }
+}
+
+// y := y - a*x
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_block_mv_sub(const T* a, const T* x, T* y)
+{
+    for (int i=0; i < N; ++i)
+    {
+        T sum = T(0);
+        for (int k=0; k < N; ++k)
+            sum += a[i*N + k]*x[k];
+        y[i] -= sum;
+    }
+}
+
+// inverse of the diagonal block of a row, identity if the row has no diagonal block
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_diag_block_inverse(int row, const int* offsets, const int* columns, const T* values, T* inv_diag)
+{
+    const int end = offsets[row + 1];
+    const int diag = bsr_row_lower_bound(columns, offsets[row], end, row);
+
+    if (diag < end && columns[diag] == row)
+        bsr_block_inverse<N>(values + diag*N*N, inv_diag + row*N*N);
+    else
+        bsr_block_identity<N>(inv_diag + row*N*N);
+}
+
+// Block ILU(0), IKJ variant: factors a row in place once the rows of the blocks left of the diagonal are factored.
+// Blocks left of the diagonal are replaced by those of the unit lower factor L, the others by those of U, and the
+// inverse of the diagonal block of U is written to inv_diag. Fill-in outside of the sparsity pattern is dropped.
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_ilu_factor_row(int row, const int* offsets, const int* columns, T* values, T* inv_diag)
+{
+    const int beg = offsets[row];
+    const int end = offsets[row + 1];
+    const int split = bsr_row_lower_bound(columns, beg, end, row);
+
+    for (int p=beg; p < split; ++p)
+    {
+        const int k = columns[p];
+
+        T l[N*N];
+        bsr_block_mul<N>(values + p*N*N, inv_diag + k*N*N, l);
+        for (int i=0; i < N*N; ++i)
+            values[p*N*N + i] = l[i];
+
+        // merge the rest of the row with the strictly upper part of row k
+        const int k_end = offsets[k + 1];
+        int r = bsr_row_lower_bound(columns, offsets[k], k_end, k + 1);
+        int q = p + 1;
+        while (q < end && r < k_end)
+        {
+            if (columns[q] < columns[r])
+            {
+                ++q;
+            }
+            else if (columns[r] < columns[q])
+            {
+                ++r;
+            }
+            else
+            {
+                bsr_block_mul_sub<N>(l, values + r*N*N, values + q*N*N);
+                ++q;
+                ++r;
+            }
+        }
+    }
+
+    bsr_diag_block_inverse<N>(row, offsets, columns, values, inv_diag);
+}
+
+// z_row := x_row - sum L_row,k z_k, after the rows k < row
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_ilu_lower_solve_row(int row, const int* offsets, const int* columns, const T* values, const T* x, T* z)
+{
+    const int beg = offsets[row];
+    const int split = bsr_row_lower_bound(columns, beg, offsets[row + 1], row);
+
+    T y[N];
+    for (int i=0; i < N; ++i)
+        y[i] = x[row*N + i];
+
+    for (int p=beg; p < split; ++p)
+        bsr_block_mv_sub<N>(values + p*N*N, z + columns[p]*N, y);
+
+    for (int i=0; i < N; ++i)
+        z[row*N + i] = y[i];
+}
+
+// z_row := U_row,row^-1 (z_row - sum U_row,j z_j), after the rows j > row
+template <int N, typename T>
+CUDA_CALLABLE inline void bsr_ilu_upper_solve_row(int row, const int* offsets, const int* columns, const T* values, const T* inv_diag, T* z)
+{
+    const int end = offsets[row + 1];
+    const int upper = bsr_row_lower_bound(columns, offsets[row], end, row + 1);
+
+    T y[N];
+    for (int i=0; i < N; ++i)
+        y[i] = z[row*N + i];
+
+    for (int q=upper; q < end; ++q)
+        bsr_block_mv_sub<N>(values + q*N*N, z + columns[q]*N, y);
+
+    const T* d = inv_diag + row*N*N;
+    for (int i=0; i < N; ++i)
+    {
+        T sum = T(0);
+        for (int k=0; k < N; ++k)
+            sum += d[i*N + k]*y[k];
+        z[row*N + i] = sum;
+    }
+}
+
+} // namespace wp
@@ -43,8 +43,6 @@ namespace wp
 #define _sstar 0.3826834323 // sin(p/8)
 #define _EPSILON 1e-6
 
-// TODO: replace sqrt with rsqrt
-
 template<typename Type>
 inline CUDA_CALLABLE
 Type accurateSqrt(Type x)
@@ -152,7 +150,7 @@ void approximateGivensQuaternion(Type a11, Type a12, Type a22, Type &ch, Type &s
     ch = Type(2)*(a11-a22);
     sh = a12;
     bool b = _gamma*sh*sh < ch*ch;
-    Type w = Type(1) / sqrt(ch*ch+sh*sh);
+    Type w = rsqrt(ch*ch+sh*sh);
     ch=b?w*ch:Type(_cstar);
     sh=b?w*sh:Type(_sstar);
 }
@@ -219,7 +217,8 @@ Type dist2(Type x, Type y, Type z)
     return x*x+y*y+z*z;
 }
 
-// finds transformation that diagonalizes a symmetric matrix
+// finds transformation that diagonalizes a symmetric matrix, each sweep
+// applies the three Jacobi rotations so that the cost is independent of the input
 template<typename Type>
 inline CUDA_CALLABLE
 void jacobiEigenanlysis( // symmetric matrix
@@ -227,10 +226,11 @@ void jacobiEigenanlysis( // symmetric matrix
                                 Type &s21, Type &s22,
                                 Type &s31, Type &s32, Type &s33,
                                 // quaternion representation of V
-                                Type * qV)
+                                Type * qV,
+                                int sweeps=4)
 {
     qV[3]=1; qV[0]=0;qV[1]=0;qV[2]=0; // follow same indexing convention as GLM
-    for (int i=0;i<4;i++)
+    for (int i=0;i<sweeps;i++)
     {
         // we wish to eliminate the maximum off-diagonal element
         // on every iteration, but cycling over all 3 possible rotations
@@ -286,7 +286,7 @@ void QRGivensQuaternion(Type a1, Type a2, Type &ch, Type &sh)
     ch = abs(a1) + max(rho,epsilon);
     bool b = a1 < Type(0);
     condSwap(b,sh,ch);
-    Type w = Type(1) / sqrt(ch*ch+sh*sh);
+    Type w = rsqrt(ch*ch+sh*sh);
     ch *= w;
     sh *= w;
 }
@@ -374,7 +374,9 @@ void _svd(// input A
         // output V
         Type &v11, Type &v12, Type &v13,
         Type &v21, Type &v22, Type &v23,
-        Type &v31, Type &v32, Type &v33)
+        Type &v31, Type &v32, Type &v33,
+        // number of Jacobi sweeps
+        int sweeps=4)
 {
     // normal equations matrix
     Type ATA11, ATA12, ATA13;
@@ -387,7 +389,7 @@ void _svd(// input A
 
     // symmetric eigenalysis
     Type qV[4];
-    jacobiEigenanlysis( ATA11,ATA21,ATA22, ATA31,ATA32,ATA33,qV);
+    jacobiEigenanlysis( ATA11,ATA21,ATA22, ATA31,ATA32,ATA33,qV,sweeps);
     quatToMat3(qV,v11,v12,v13,v21,v22,v23,v31,v32,v33);
 
     Type b11, b12, b13;
@@ -408,8 +410,16 @@ void _svd(// input A
     );
 }
 
+// keeps x at least eps away from zero without branching, zero maps to eps
+template<typename Type>
+inline CUDA_CALLABLE
+Type clampAwayFromZero(Type x, Type eps)
+{
+    return x < Type(0) ? min(x, -eps) : max(x, eps);
+}
+
 template<typename Type>
-inline CUDA_CALLABLE void svd3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& U, vec_t<3,Type>& sigma, mat_t<3,3,Type>& V) {
+inline CUDA_CALLABLE void svd3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& U, vec_t<3,Type>& sigma, mat_t<3,3,Type>& V, int sweeps=4) {
   Type s12, s13, s21, s23, s31, s32;
   _svd(A.data[0][0], A.data[0][1], A.data[0][2],
        A.data[1][0], A.data[1][1], A.data[1][2],
@@ -425,7 +435,9 @@ inline CUDA_CALLABLE void svd3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& U, vec
 
        V.data[0][0], V.data[0][1], V.data[0][2],
        V.data[1][0], V.data[1][1], V.data[1][2],
-       V.data[2][0], V.data[2][1], V.data[2][2]);
+       V.data[2][0], V.data[2][1], V.data[2][2],
+
+       sweeps);
 }
 
 template<typename Type>
@@ -468,6 +480,60 @@ inline CUDA_CALLABLE void adj_svd3(const mat_t<3,3,Type>& A,
   adj_A = adj_A + (u_term + v_term + sigma_term);
 }
 
+template<typename Type>
+inline CUDA_CALLABLE void adj_svd3(const mat_t<3,3,Type>& A,
+                                  const mat_t<3,3,Type>& U,
+                                  const vec_t<3,Type>& sigma,
+                                  const mat_t<3,3,Type>& V,
+                                  int sweeps,
+                                  mat_t<3,3,Type>& adj_A,
+                                  const mat_t<3,3,Type>& adj_U,
+                                  const vec_t<3,Type>& adj_sigma,
+                                  const mat_t<3,3,Type>& adj_V,
+                                  int& adj_sweeps) {
+  adj_svd3(A, U, sigma, V, adj_A, adj_U, adj_sigma, adj_V);
+}
+
+// rotational part R of the polar decomposition A = R*S, obtained as R = U*V^T from the SVD,
+// det(R) = 1 since the SVD returns rotations for U and V and folds reflections into sigma
+template<typename Type>
+inline CUDA_CALLABLE mat_t<3,3,Type> polar3(const mat_t<3,3,Type>& A, int sweeps=4) {
+  mat_t<3,3,Type> U, V;
+  vec_t<3,Type> sigma;
+  svd3(A, U, sigma, V, sweeps);
+
+  return mul(U, transpose(V));
+}
+
+template<typename Type>
+inline CUDA_CALLABLE void adj_polar3(const mat_t<3,3,Type>& A,
+                                    int sweeps,
+                                    mat_t<3,3,Type>& adj_A,
+                                    int& adj_sweeps,
+                                    const mat_t<3,3,Type>& adj_ret) {
+  mat_t<3,3,Type> U, V;
+  vec_t<3,Type> sigma;
+  svd3(A, U, sigma, V, sweeps);
+
+  // U^T*dR*V is the skew matrix with entries (P_ij - P_ji)/(s_i + s_j) where P = U^T*dA*V,
+  // unlike the gradients of U and V alone this is not singular for repeated singular values
+  mat_t<3,3,Type> M = mul(transpose(U), mul(adj_ret, V));
+
+  Type d01 = Type(1) / clampAwayFromZero(sigma[0] + sigma[1], Type(1e-6));
+  Type d02 = Type(1) / clampAwayFromZero(sigma[0] + sigma[2], Type(1e-6));
+  Type d12 = Type(1) / clampAwayFromZero(sigma[1] + sigma[2], Type(1e-6));
+
+  Type k01 = (M.data[0][1] - M.data[1][0]) * d01;
+  Type k02 = (M.data[0][2] - M.data[2][0]) * d02;
+  Type k12 = (M.data[1][2] - M.data[2][1]) * d12;
+
+  mat_t<3,3,Type> K = mat_t<3,3,Type>(0, k01, k02,
+                  -k01, 0, k12,
+                  -k02, -k12, 0);
+
+  adj_A = adj_A + mul(U, mul(K, transpose(V)));
+}
+
 
 template<typename Type>
 inline CUDA_CALLABLE void qr3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& Q, mat_t<3,3,Type>& R) {
@@ -502,7 +568,7 @@ inline CUDA_CALLABLE void adj_qr3(const mat_t<3,3,Type>& A,
 
 
 template<typename Type>
-inline CUDA_CALLABLE void eig3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& Q, vec_t<3,Type>& d) {
+inline CUDA_CALLABLE void eig3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& Q, vec_t<3,Type>& d, int sweeps=4) {
     Type qV[4];
     Type s11 = A.data[0][0];
     Type s21 = A.data[1][0];
@@ -511,7 +577,7 @@ inline CUDA_CALLABLE void eig3(const mat_t<3,3,Type>& A, mat_t<3,3,Type>& Q, vec
     Type s32 = A.data[2][1];
     Type s33 = A.data[2][2];
                        
-    jacobiEigenanlysis(s11, s21, s22, s31, s32, s33, qV);
+    jacobiEigenanlysis(s11, s21, s22, s31, s32, s33, qV, sweeps);
     quatToMat3(qV, Q.data[0][0], Q.data[0][1], Q.data[0][2], Q.data[1][0], Q.data[1][1], Q.data[1][2], Q.data[2][0], Q.data[2][1], Q.data[2][2]);
     mat_t<3,3,Type> t;
     multAtB(Q.data[0][0], Q.data[0][1], Q.data[0][2], Q.data[1][0], Q.data[1][1], Q.data[1][2], Q.data[2][0], Q.data[2][1], Q.data[2][2],
@@ -537,18 +603,9 @@ inline CUDA_CALLABLE void adj_eig3(const mat_t<3,3,Type>& A, const mat_t<3,3,Typ
                     0, adj_d[1], 0,
                     0, 0, adj_d[2]);
                     
-    Type dyx = d[1] - d[0];
-    Type dzx = d[2] - d[0];
-    Type dzy = d[2] - d[1];
-
-    if ((dyx < Type(0)) && (dyx > Type(-1e-6))) dyx = -1e-6;
-    if ((dyx > Type(0)) && (dyx < Type(1e-6))) dyx = 1e-6;
-
-    if ((dzx < Type(0)) && (dzx > Type(-1e-6))) dzx = -1e-6;
-    if ((dzx > Type(0)) && (dzx < Type(1e-6))) dzx = 1e-6;
-
-    if ((dzy < Type(0)) && (dzy > Type(-1e-6))) dzy = -1e-6;
-    if ((dzy > Type(0)) && (dzy < Type(1e-6))) dzy = 1e-6;
+    Type dyx = clampAwayFromZero(d[1] - d[0], Type(1e-6));
+    Type dzx = clampAwayFromZero(d[2] - d[0], Type(1e-6));
+    Type dzy = clampAwayFromZero(d[2] - d[1], Type(1e-6));
 
     Type F01 = Type(1) / dyx;
     Type F02 = Type(1) / dzx;
@@ -559,4 +616,10 @@ inline CUDA_CALLABLE void adj_eig3(const mat_t<3,3,Type>& A, const mat_t<3,3,Typ
     mat_t<3,3,Type> QT = transpose(Q);
     adj_A = adj_A + mul(Q, mul(D_bar + cw_mul(F, mul(QT, adj_Q)), QT));
 }
+
+template<typename Type>
+inline CUDA_CALLABLE void adj_eig3(const mat_t<3,3,Type>& A, const mat_t<3,3,Type>& Q, const vec_t<3,Type>& d, int sweeps,
+                                     mat_t<3,3,Type>& adj_A, const mat_t<3,3,Type>& adj_Q, const vec_t<3,Type>& adj_d, int& adj_sweeps) {
+    adj_eig3(A, Q, d, adj_A, adj_Q, adj_d);
+}
 }
@@ -24,3 +24,22 @@ struct PinnedTemporaryBuffer
 
 // map temp buffers to CUDA contexts
 static std::unordered_map<void *, PinnedTemporaryBuffer> g_pinned_temp_buffer_map;
+
+// Device buffer that is kept alive between calls, so that kernels using scratch memory
+// can be captured in graphs once the buffer has been sized by a first (uncaptured) call
+struct DeviceTemporaryBuffer
+{
+    void *context = NULL;
+    void *buffer = NULL;
+    size_t buffer_size = 0;
+
+    void ensure_fits(size_t size)
+    {
+        if (size > buffer_size)
+        {
+            free_device(context, buffer);
+            buffer = alloc_device(context, size);
+            buffer_size = size;
+        }
+    }
+};
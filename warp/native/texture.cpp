@@ -0,0 +1,183 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+#include "cuda_util.h"
+#include "texture.h"
+
+#include <map>
+
+using namespace wp;
+
+namespace
+{
+
+struct TextureDesc
+{
+    // host copy of the texture descriptor
+    texture3d_t texture;
+
+    // CUDA context and array holding the texels of device textures (NULL if CPU)
+    void* context;
+    void* array;
+};
+
+// Host-side texture descriptors, maps each CPU/GPU texture descriptor address (id) to a CPU desc
+std::map<uint64_t, TextureDesc> g_texture_descriptors;
+
+bool texture_valid_params(int nx, int ny, int nz, int filter_mode, int address_mode)
+{
+    return nx > 0 && ny > 0 && nz > 0 &&
+        (filter_mode == texture::CLOSEST || filter_mode == texture::LINEAR) &&
+        address_mode >= texture::CLAMP && address_mode <= texture::BORDER;
+}
+
+texture3d_t texture_init(int nx, int ny, int nz, bool half_storage, int filter_mode, int address_mode)
+{
+    texture3d_t t;
+    t.tex = 0;
+    t.tex_point = 0;
+    t.data = nullptr;
+    t.nx = nx;
+    t.ny = ny;
+    t.nz = nz;
+    t.filter_mode = filter_mode;
+    t.address_mode = address_mode;
+    t.half_storage = half_storage;
+    return t;
+}
+
+} // anonymous namespace
+
+
+// NB: data must be a host pointer to nx*ny*nz float or half values, copied into the texture
+uint64_t texture3d_create_host(void* data, int nx, int ny, int nz, bool half_storage, int filter_mode, int address_mode)
+{
+    if (!texture_valid_params(nx, ny, nz, filter_mode, address_mode))
+        return 0;
+
+    TextureDesc desc;
+    desc.context = NULL;
+    desc.array = NULL;
+    desc.texture = texture_init(nx, ny, nz, half_storage, filter_mode, address_mode);
+
+    const size_t size = size_t(nx) * ny * nz * (half_storage ? sizeof(half) : sizeof(float));
+    void* values = alloc_host(size);
+    memcpy_h2h(values, data, size);
+    desc.texture.data = values;
+
+    texture3d_t* t = static_cast<texture3d_t*>(alloc_host(sizeof(texture3d_t)));
+    *t = desc.texture;
+
+    const uint64_t id = (uint64_t)t;
+    g_texture_descriptors[id] = desc;
+
+    return id;
+}
+
+void texture3d_destroy_host(uint64_t id)
+{
+    const auto iter = g_texture_descriptors.find(id);
+    if (iter == g_texture_descriptors.end())
+        return;
+
+    free_host(const_cast<void*>(iter->second.texture.data));
+    free_host((void*)id);
+    g_texture_descriptors.erase(iter);
+}
+
+
+#if WP_ENABLE_CUDA
+
+// NB: data must be a pointer to nx*ny*nz float or half values on the same device or on the host
+uint64_t texture3d_create_device(void* context, void* data, int nx, int ny, int nz, bool half_storage, int filter_mode, int address_mode)
+{
+    if (!texture_valid_params(nx, ny, nz, filter_mode, address_mode))
+        return 0;
+
+    ContextGuard guard(context);
+
+    TextureDesc desc;
+    desc.context = context ? context : cuda_context_get_current();
+    desc.texture = texture_init(nx, ny, nz, half_storage, filter_mode, address_mode);
+
+    // k varies fastest in the texel layout and therefore maps to the width of the array
+    const size_t texel_size = half_storage ? sizeof(half) : sizeof(float);
+    const cudaExtent extent = { size_t(nz), size_t(ny), size_t(nx) };
+    const cudaChannelFormatDesc channel = cudaCreateChannelDesc(int(texel_size) * 8, 0, 0, 0, cudaChannelFormatKindFloat);
+
+    cudaArray_t array;
+    if (!check_cuda(cudaMalloc3DArray(&array, &channel, extent)))
+        return 0;
+
+    cudaMemcpy3DParms copy = {};
+    copy.srcPtr = { data, size_t(nz) * texel_size, size_t(nz), size_t(ny) };
+    copy.dstArray = array;
+    copy.extent = extent;
+    copy.kind = cudaMemcpyDefault;
+    check_cuda(cudaMemcpy3DAsync(&copy, static_cast<cudaStream_t>(cuda_stream_get_current())));
+
+    cudaResourceDesc resource = {};
+    resource.resType = cudaResourceTypeArray;
+    resource.res.array.array = array;
+
+    static const cudaTextureAddressMode address_modes[] = { cudaAddressModeClamp, cudaAddressModeWrap, cudaAddressModeMirror, cudaAddressModeBorder };
+
+    // coordinates are normalized for the wrap and mirror modes, half texels are read as float
+    cudaTextureDesc sampler = {};
+    sampler.addressMode[0] = sampler.addressMode[1] = sampler.addressMode[2] = address_modes[address_mode];
+    sampler.filterMode = filter_mode == texture::LINEAR ? cudaFilterModeLinear : cudaFilterModePoint;
+    sampler.readMode = cudaReadModeElementType;
+    sampler.normalizedCoords = 1;
+
+    cudaTextureObject_t tex, tex_point;
+    check_cuda(cudaCreateTextureObject(&tex, &resource, &sampler, NULL));
+    sampler.filterMode = cudaFilterModePoint;
+    check_cuda(cudaCreateTextureObject(&tex_point, &resource, &sampler, NULL));
+
+    desc.array = array;
+    desc.texture.tex = tex;
+    desc.texture.tex_point = tex_point;
+
+    texture3d_t* t = static_cast<texture3d_t*>(alloc_device(WP_CURRENT_CONTEXT, sizeof(texture3d_t)));
+    memcpy_h2d(WP_CURRENT_CONTEXT, t, &desc.texture, sizeof(texture3d_t));
+
+    const uint64_t id = (uint64_t)t;
+    g_texture_descriptors[id] = desc;
+
+    return id;
+}
+
+void texture3d_destroy_device(uint64_t id)
+{
+    const auto iter = g_texture_descriptors.find(id);
+    if (iter == g_texture_descriptors.end())
+        return;
+
+    const TextureDesc& desc = iter->second;
+
+    ContextGuard guard(desc.context);
+
+    check_cuda(cudaDestroyTextureObject(desc.texture.tex));
+    check_cuda(cudaDestroyTextureObject(desc.texture.tex_point));
+    check_cuda(cudaFreeArray(static_cast<cudaArray_t>(desc.array)));
+    free_device(WP_CURRENT_CONTEXT, (void*)id);
+
+    g_texture_descriptors.erase(iter);
+}
+
+#else
+// stubs for non-CUDA platforms
+uint64_t texture3d_create_device(void* context, void* data, int nx, int ny, int nz, bool half_storage, int filter_mode, int address_mode)
+{
+    return 0;
+}
+
+void texture3d_destroy_device(uint64_t id) {}
+
+#endif
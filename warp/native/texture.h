@@ -0,0 +1,170 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+#include "builtin.h"
+
+namespace wp
+{
+
+namespace texture
+{
+    // filter modes
+    static constexpr int CLOSEST = 0;
+    static constexpr int LINEAR = 1;
+
+    // address modes
+    static constexpr int CLAMP = 0;
+    static constexpr int WRAP = 1;
+    static constexpr int MIRROR = 2;
+    static constexpr int BORDER = 3;
+}
+
+// Dense 3D texture of scalar values, the texture id is the address of its descriptor on the texture's device.
+// Coordinates are normalized, the center of texel (i, j, k) lies at ((i + 0.5) / nx, (j + 0.5) / ny, (k + 0.5) / nz).
+// Texels are laid out with k varying fastest, so device textures address them as (k, j, i) in CUDA's (x, y, z) order.
+struct texture3d_t
+{
+    // CUDA texture objects of device textures, filtering with the texture's filter mode and with point sampling
+    uint64_t tex;
+    uint64_t tex_point;
+
+    // texel values of host textures, stored as float or half, texel (i, j, k) at (i * ny + j) * nz + k
+    const void* data;
+
+    int nx, ny, nz;
+    int filter_mode;
+    int address_mode;
+    int half_storage;
+};
+
+namespace texture
+{
+
+#if defined(__CUDA_ARCH__)
+
+CUDA_CALLABLE_DEVICE inline float fetch_device(uint64_t tex, float u, float v, float w)
+{
+    float r, g, b, a;
+    asm("tex.3d.v4.f32.f32 {%0, %1, %2, %3}, [%4, {%5, %6, %7, %7}];"
+        : "=f"(r), "=f"(g), "=f"(b), "=f"(a) : "l"(tex), "f"(u), "f"(v), "f"(w));
+    return r;
+}
+
+#endif
+
+// Maps a texel index into [0, n) following the address mode, returns -1 for texels outside of a bordered texture
+CUDA_CALLABLE inline int address(int i, int n, int address_mode)
+{
+    if (i >= 0 && i < n)
+        return i;
+
+    switch (address_mode)
+    {
+    case WRAP:
+        return ((i % n) + n) % n;
+    case MIRROR:
+    {
+        const int m = ((i % (2 * n)) + 2 * n) % (2 * n);
+        return m < n ? m : 2 * n - 1 - m;
+    }
+    case BORDER:
+        return -1;
+    default:
+        return i < 0 ? 0 : n - 1;
+    }
+}
+
+// Value of texel (i, j, k) after addressing, border texels are 0
+CUDA_CALLABLE inline float texel(const texture3d_t& t, int i, int j, int k)
+{
+#if defined(__CUDA_ARCH__)
+    return fetch_device(t.tex_point, (k + 0.5f) / t.nz, (j + 0.5f) / t.ny, (i + 0.5f) / t.nx);
+#else
+    i = address(i, t.nx, t.address_mode);
+    j = address(j, t.ny, t.address_mode);
+    k = address(k, t.nz, t.address_mode);
+    if (i < 0 || j < 0 || k < 0)
+        return 0.0f;
+
+    const size_t n = (size_t(i) * t.ny + j) * t.nz + k;
+    return t.half_storage ? half_to_float(static_cast<const half*>(t.data)[n]) : static_cast<const float*>(t.data)[n];
+#endif
+}
+
+// Lower texel and interpolation weights of the linear filter at uvw
+CUDA_CALLABLE inline void linear_cell(const texture3d_t& t, const vec3& uvw, int (&ijk)[3], float (&f)[3])
+{
+    const int n[3] = { t.nx, t.ny, t.nz };
+    for (int c = 0; c < 3; ++c)
+    {
+        const float x = uvw[c] * n[c] - 0.5f;
+        const float x0 = floor(x);
+        ijk[c] = int(x0);
+        f[c] = x - x0;
+    }
+}
+
+} // namespace texture
+
+CUDA_CALLABLE inline float texture_sample_f(uint64_t id, vec3 uvw)
+{
+    const texture3d_t& t = *(const texture3d_t*)id;
+
+#if defined(__CUDA_ARCH__)
+    return texture::fetch_device(t.tex, uvw[2], uvw[1], uvw[0]);
+#else
+    if (t.filter_mode == texture::CLOSEST)
+        return texture::texel(t, int(floor(uvw[0] * t.nx)), int(floor(uvw[1] * t.ny)), int(floor(uvw[2] * t.nz)));
+
+    int ijk[3];
+    float f[3];
+    texture::linear_cell(t, uvw, ijk, f);
+
+    float val = 0.0f;
+    for (int idx = 0; idx < 8; ++idx)
+    {
+        const int dx = idx >> 2, dy = (idx >> 1) & 1, dz = idx & 1;
+        const float w = (dx ? f[0] : 1.0f - f[0]) * (dy ? f[1] : 1.0f - f[1]) * (dz ? f[2] : 1.0f - f[2]);
+        val += w * texture::texel(t, ijk[0] + dx, ijk[1] + dy, ijk[2] + dz);
+    }
+    return val;
+#endif
+}
+
+CUDA_CALLABLE inline void adj_texture_sample_f(uint64_t id, vec3 uvw, uint64_t& adj_id, vec3& adj_uvw, const float& adj_ret)
+{
+    const texture3d_t& t = *(const texture3d_t*)id;
+
+    if (t.filter_mode != texture::LINEAR)
+        return; // NOP
+
+    // the gradient is evaluated from the texels rather than from the hardware filter, which has an 8-bit weight precision
+    int ijk[3];
+    float f[3];
+    texture::linear_cell(t, uvw, ijk, f);
+
+    vec3 dphi(0.0f);
+    for (int idx = 0; idx < 8; ++idx)
+    {
+        const int dx = idx >> 2, dy = (idx >> 1) & 1, dz = idx & 1;
+        const float wx = dx ? f[0] : 1.0f - f[0];
+        const float wy = dy ? f[1] : 1.0f - f[1];
+        const float wz = dz ? f[2] : 1.0f - f[2];
+        const float v = texture::texel(t, ijk[0] + dx, ijk[1] + dy, ijk[2] + dz);
+
+        dphi[0] += (dx ? 1.0f : -1.0f) * wy * wz * v;
+        dphi[1] += (dy ? 1.0f : -1.0f) * wx * wz * v;
+        dphi[2] += (dz ? 1.0f : -1.0f) * wx * wy * v;
+    }
+
+    adj_uvw += vec3(dphi[0] * t.nx, dphi[1] * t.ny, dphi[2] * t.nz) * adj_ret;
+}
+
+} // namespace wp
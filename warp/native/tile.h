@@ -0,0 +1,107 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+#include "builtin.h"
+
+namespace wp
+{
+
+namespace tile
+{
+    // largest halo of a tile on each side, and largest tile including its halo for blocks of up to 1024 threads
+    static constexpr int MAX_HALO = 32;
+    static constexpr int MAX_SIZE = 1024 + 2 * MAX_HALO;
+}
+
+// Block-wide window of a 1D float array, covering the elements of the block's threads and a halo on each side.
+// On device the window is staged in shared memory, each tile_load() call site of a kernel owning its own storage.
+// On host, where the threads of a launch run one after another, the tile reads the array directly.
+struct tile_t
+{
+    CUDA_CALLABLE tile_t() {}
+    CUDA_CALLABLE tile_t(int) {} // for backward pass
+
+    // shared storage on device, element of thread t at halo + t
+    const float* data;
+
+    // source array, used by host tiles
+    array_t<float> src;
+
+    int halo;
+};
+
+namespace tile
+{
+
+CUDA_CALLABLE inline int clamp_index(int i, int n)
+{
+    return i < 0 ? 0 : (i >= n ? n - 1 : i);
+}
+
+} // namespace tile
+
+template <int Slot>
+CUDA_CALLABLE inline tile_t tile_load(const array_t<float>& a, int halo)
+{
+    tile_t t;
+    t.src = a;
+    t.halo = halo < 0 ? 0 : (halo > tile::MAX_HALO ? tile::MAX_HALO : halo);
+    t.data = NULL;
+
+#if defined(__CUDA_ARCH__)
+    __shared__ float storage[tile::MAX_SIZE];
+
+    // the block's threads cooperatively load the window, elements past the ends of the array are clamped to the edge
+    const int n = a.shape[0];
+    const int begin = int(grid_index()) - int(threadIdx.x) - t.halo;
+    const int size = int(blockDim.x) + 2 * t.halo;
+
+    for (int i = threadIdx.x; i < size; i += blockDim.x)
+        storage[i] = index(a, tile::clamp_index(begin + i, n));
+
+    __syncthreads();
+
+    t.data = storage;
+#endif
+
+    return t;
+}
+
+CUDA_CALLABLE inline void adj_tile_load(const array_t<float>& a, int halo, array_t<float>& adj_a, int& adj_halo, tile_t& adj_ret)
+{
+    // NOP
+}
+
+// Value offset elements away from the calling thread's element, offsets are clamped to the halo of the tile
+CUDA_CALLABLE inline float tile_read(const tile_t& t, int offset)
+{
+    offset = offset < -t.halo ? -t.halo : (offset > t.halo ? t.halo : offset);
+
+#if defined(__CUDA_ARCH__)
+    return t.data[t.halo + int(threadIdx.x) + offset];
+#else
+    return index(t.src, tile::clamp_index(int(grid_index()) + offset, t.src.shape[0]));
+#endif
+}
+
+CUDA_CALLABLE inline void adj_tile_read(const tile_t& t, int offset, tile_t& adj_t, int& adj_offset, const float& adj_ret)
+{
+    // NOP
+}
+
+// Barrier between the threads of a block, e.g.: before loading a tile again in a loop once all threads are done reading it
+CUDA_CALLABLE inline void tile_sync()
+{
+#if defined(__CUDA_ARCH__)
+    __syncthreads();
+#endif
+}
+
+} // namespace wp
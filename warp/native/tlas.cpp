@@ -0,0 +1,115 @@
+/** Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+#include "cuda_util.h"
+#include "tlas.h"
+
+using namespace wp;
+
+#include <map>
+
+namespace
+{
+    // host-side copy of TLAS descriptors, maps GPU TLAS address (id) to a CPU desc
+    std::map<uint64_t, TLAS> g_tlas_descriptors;
+
+} // anonymous namespace
+
+
+namespace wp
+{
+
+bool tlas_get_descriptor(uint64_t id, TLAS& tlas)
+{
+    const auto& iter = g_tlas_descriptors.find(id);
+    if (iter == g_tlas_descriptors.end())
+        return false;
+    else
+        tlas = iter->second;
+        return true;
+}
+
+void tlas_add_descriptor(uint64_t id, const TLAS& tlas)
+{
+    g_tlas_descriptors[id] = tlas;
+}
+
+void tlas_rem_descriptor(uint64_t id)
+{
+    g_tlas_descriptors.erase(id);
+}
+
+void tlas_compute_bounds_host(TLAS& tlas)
+{
+    for (int i=0; i < tlas.num_instances; ++i)
+        tlas.bounds[i] = tlas_compute_instance_bounds(tlas.meshes[i], tlas.transforms[i]);
+}
+
+} // namespace wp
+
+
+uint64_t tlas_create_host(uint64_t* meshes, wp::transform* transforms, int num_instances)
+{
+    TLAS* tlas = new TLAS();
+    memset(tlas, 0, sizeof(TLAS));
+
+    tlas->meshes = meshes;
+    tlas->transforms = transforms;
+    tlas->num_instances = num_instances;
+
+    if (num_instances > 0)
+    {
+        tlas->bounds = new bounds3[num_instances];
+        tlas_compute_bounds_host(*tlas);
+
+        tlas->bvh = bvh_create(tlas->bounds, num_instances);
+    }
+
+    return (uint64_t)tlas;
+}
+
+void tlas_destroy_host(uint64_t id)
+{
+    TLAS* tlas = (TLAS*)(id);
+
+    bvh_destroy_host(tlas->bvh);
+    delete[] tlas->bounds;
+
+    delete tlas;
+}
+
+void tlas_refit_host(uint64_t id)
+{
+    TLAS* tlas = (TLAS*)(id);
+
+    if (tlas->num_instances == 0)
+        return;
+
+    tlas_compute_bounds_host(*tlas);
+    bvh_refit_host(tlas->bvh, tlas->bounds);
+}
+
+
+// stubs for non-CUDA platforms
+#if !WP_ENABLE_CUDA
+
+uint64_t tlas_create_device(void* context, uint64_t* meshes, wp::transform* transforms, int num_instances)
+{
+    return 0;
+}
+
+void tlas_destroy_device(uint64_t id)
+{
+}
+
+void tlas_refit_device(uint64_t id)
+{
+}
+
+#endif // !WP_ENABLE_CUDA
@@ -0,0 +1,87 @@
+/** Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#include "warp.h"
+#include "cuda_util.h"
+#include "tlas.h"
+
+namespace wp
+{
+
+__global__ void compute_instance_bounds(int n, const uint64_t* meshes, const transform* transforms, bounds3* b)
+{
+    const int tid = blockIdx.x*blockDim.x + threadIdx.x;
+
+    if (tid < n)
+    {
+        b[tid] = tlas_compute_instance_bounds(meshes[tid], transforms[tid]);
+    }
+}
+
+} // namespace wp
+
+
+uint64_t tlas_create_device(void* context, uint64_t* meshes, wp::transform* transforms, int num_instances)
+{
+    ContextGuard guard(context);
+
+    wp::TLAS tlas;
+    memset(&tlas, 0, sizeof(tlas));
+
+    tlas.context = context ? context : cuda_context_get_current();
+    tlas.meshes = meshes;
+    tlas.transforms = transforms;
+    tlas.num_instances = num_instances;
+
+    if (num_instances > 0)
+    {
+        // instance bounds are kept on the device for refits
+        tlas.bounds = (wp::bounds3*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::bounds3)*num_instances);
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_instance_bounds, num_instances, (num_instances, tlas.meshes, tlas.transforms, tlas.bounds));
+
+        tlas.bvh = wp::bvh_create_device(WP_CURRENT_CONTEXT, tlas.bounds, num_instances);
+    }
+
+    wp::TLAS* tlas_device = (wp::TLAS*)alloc_device(WP_CURRENT_CONTEXT, sizeof(wp::TLAS));
+    memcpy_h2d(WP_CURRENT_CONTEXT, tlas_device, &tlas, sizeof(wp::TLAS));
+
+    uint64_t tlas_id = (uint64_t)tlas_device;
+    wp::tlas_add_descriptor(tlas_id, tlas);
+
+    return tlas_id;
+}
+
+void tlas_destroy_device(uint64_t id)
+{
+    wp::TLAS tlas;
+    if (wp::tlas_get_descriptor(id, tlas))
+    {
+        ContextGuard guard(tlas.context);
+
+        if (tlas.num_instances > 0)
+            wp::bvh_destroy_device(tlas.bvh);
+
+        free_device(WP_CURRENT_CONTEXT, tlas.bounds);
+        free_device(WP_CURRENT_CONTEXT, (wp::TLAS*)id);
+
+        wp::tlas_rem_descriptor(id);
+    }
+}
+
+void tlas_refit_device(uint64_t id)
+{
+    wp::TLAS tlas;
+    if (wp::tlas_get_descriptor(id, tlas) && tlas.num_instances > 0)
+    {
+        ContextGuard guard(tlas.context);
+
+        // only the instance bounds change, mesh geometry is left untouched
+        wp_launch_device(WP_CURRENT_CONTEXT, wp::compute_instance_bounds, tlas.num_instances, (tlas.num_instances, tlas.meshes, tlas.transforms, tlas.bounds));
+        wp::bvh_refit_device(tlas.bvh, tlas.bounds);
+    }
+}
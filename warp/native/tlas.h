@@ -0,0 +1,167 @@
+/** Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+#include "builtin.h"
+#include "bvh.h"
+#include "mesh.h"
+
+namespace wp
+{
+
+// top-level acceleration structure, a BVH over the world space bounds of
+// rigidly transformed instances of existing meshes
+struct TLAS
+{
+    // must stay the first member, tlas_query_aabb() traverses it as a plain BVH
+    BVH bvh;
+
+    const uint64_t* meshes;         // mesh id per instance, managed by the user
+    const transform* transforms;    // world from mesh transform per instance, managed by the user
+
+    bounds3* bounds;                // world space instance bounds
+    int num_instances;
+
+    void* context;
+};
+
+CUDA_CALLABLE inline TLAS tlas_get(uint64_t id)
+{
+    return *(TLAS*)(id);
+}
+
+// world space bounds of a mesh instance, empty meshes return inverted bounds
+CUDA_CALLABLE inline bounds3 tlas_compute_instance_bounds(uint64_t mesh_id, const transform& xform)
+{
+    Mesh mesh = mesh_get(mesh_id);
+
+    bounds3 b;
+
+    if (mesh.bvh.num_nodes == 0)
+        return b;
+
+    bounds3 local = bvh_get_node_bounds(mesh.bvh, mesh.bvh.root);
+
+    for (int i=0; i < 8; ++i)
+    {
+        vec3 corner((i&1) ? local.upper[0] : local.lower[0],
+                    (i&2) ? local.upper[1] : local.lower[1],
+                    (i&4) ? local.upper[2] : local.lower[2]);
+
+        b.add_point(transform_point(xform, corner));
+    }
+
+    return b;
+}
+
+// returns true if there is a hit (strictly) < max_t on any instance,
+// the ray is transformed into mesh space so t stays a world space distance
+CUDA_CALLABLE inline bool tlas_query_ray(uint64_t id, const vec3& start, const vec3& dir, float max_t, float& t, float& u, float& v, float& sign, vec3& normal, int& face, int& instance)
+{
+    TLAS tlas = tlas_get(id);
+
+    if (tlas.bvh.num_nodes == 0)
+        return false;
+
+    bvh_stack_t stack;
+    stack.init(tlas.bvh.root);
+
+    vec3 rcp_dir = vec3(1.0f/dir[0], 1.0f/dir[1], 1.0f/dir[2]);
+
+    float min_t = max_t;
+    float min_u;
+    float min_v;
+    float min_sign = 1.0f;
+    vec3 min_normal;
+    int min_face;
+    int min_instance = -1;
+
+    int node_index;
+    while ((node_index = stack.pop(tlas.bvh)) >= 0)
+    {
+        BVHPackedNodeHalf lower = tlas.bvh.node_lowers[node_index];
+        BVHPackedNodeHalf upper = tlas.bvh.node_uppers[node_index];
+
+        float node_t = 0.0f;
+        if (!intersect_ray_aabb(start, rcp_dir, vec3(lower.x, lower.y, lower.z), vec3(upper.x, upper.y, upper.z), node_t) || node_t >= min_t)
+            continue;
+
+        if (lower.b)
+        {
+            const int i = lower.i;
+            const transform xform = tlas.transforms[i];
+            const transform inv = transform_inverse(xform);
+
+            float hit_t, hit_u, hit_v, hit_sign;
+            vec3 hit_normal;
+            int hit_face;
+
+            if (mesh_query_ray(tlas.meshes[i], transform_point(inv, start), transform_vector(inv, dir), min_t, hit_t, hit_u, hit_v, hit_sign, hit_normal, hit_face))
+            {
+                min_t = hit_t;
+                min_u = hit_u;
+                min_v = hit_v;
+                min_sign = hit_sign;
+                min_normal = transform_vector(xform, hit_normal);
+                min_face = hit_face;
+                min_instance = i;
+            }
+        }
+        else
+        {
+            stack.push(tlas.bvh, lower.i, upper.i);
+        }
+    }
+
+    if (min_instance >= 0)
+    {
+        t = min_t;
+        u = min_u;
+        v = min_v;
+        sign = min_sign;
+        normal = min_normal;
+        face = min_face;
+        instance = min_instance;
+
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+// stub
+CUDA_CALLABLE inline void adj_tlas_query_ray(uint64_t id, const vec3& start, const vec3& dir, float max_t, float& t, float& u, float& v, float& sign, vec3& normal, int& face, int& instance,
+                                             uint64_t adj_id, vec3& adj_start, vec3& adj_dir, float& adj_max_t, float& adj_t, float& adj_u, float& adj_v, float& adj_sign, vec3& adj_normal, int& adj_face, int& adj_instance, bool adj_ret)
+{
+}
+
+// iterates over the instances whose world space bounds overlap the query box,
+// use bvh_query_next() to step through the instance indices
+CUDA_CALLABLE inline bvh_query_t tlas_query_aabb(uint64_t id, const vec3& lower, const vec3& upper)
+{
+    return bvh_query_aabb((uint64_t)&((TLAS*)id)->bvh, lower, upper);
+}
+
+// stub
+CUDA_CALLABLE inline void adj_tlas_query_aabb(uint64_t id, const vec3& lower, const vec3& upper,
+                                              uint64_t, vec3&, vec3&, bvh_query_t&)
+{
+}
+
+#if !defined(__CUDA_ARCH__)
+
+bool tlas_get_descriptor(uint64_t id, TLAS& tlas);
+void tlas_add_descriptor(uint64_t id, const TLAS& tlas);
+void tlas_rem_descriptor(uint64_t id);
+
+#endif  // !__CUDA_ARCH__
+
+} // namespace wp
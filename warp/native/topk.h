@@ -0,0 +1,200 @@
+/** Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+ * NVIDIA CORPORATION and its licensors retain all intellectual property
+ * and proprietary rights in and to this software, related documentation
+ * and any modifications thereto.  Any use, reproduction, disclosure or
+ * distribution of this software and related documentation without an express
+ * license agreement from NVIDIA CORPORATION is strictly prohibited.
+ */
+
+#pragma once
+
+namespace wp
+{
+
+// holds the K smallest keys pushed so far with their values in a max-heap, so that the largest kept key is at the
+// root. K is a compile-time constant so the entries stay in registers or thread local memory.
+template<unsigned K>
+struct topk_heap_t
+{
+    CUDA_CALLABLE topk_heap_t() {}
+    CUDA_CALLABLE topk_heap_t(int) : count(0) {} // for backward pass
+
+    float keys[K];
+    int values[K];
+
+    int count;
+};
+
+template<unsigned K>
+CUDA_CALLABLE inline topk_heap_t<K> topk_heap()
+{
+    topk_heap_t<K> heap;
+    heap.count = 0;
+
+    return heap;
+}
+
+// the heap operations work on arrays of keys and values so that they also apply to runtime sized heaps stored in
+// memory, e.g.: the rows of a kNN graph
+CUDA_CALLABLE inline void topk_swap(float* keys, int* values, int i, int j)
+{
+    const float key = keys[i];
+    const int value = values[i];
+
+    keys[i] = keys[j];
+    values[i] = values[j];
+    keys[j] = key;
+    values[j] = value;
+}
+
+// restores the heap order of the first n entries below entry i
+CUDA_CALLABLE inline void topk_sift_down(float* keys, int* values, int i, int n)
+{
+    while (1)
+    {
+        const int left = 2*i + 1;
+        const int right = left + 1;
+
+        int largest = i;
+        if (left < n && keys[left] > keys[largest])
+            largest = left;
+        if (right < n && keys[right] > keys[largest])
+            largest = right;
+
+        if (largest == i)
+            return;
+
+        topk_swap(keys, values, i, largest);
+        i = largest;
+    }
+}
+
+// inserts an entry in a heap of the given capacity, evicting the largest key once the heap is full, returns false
+// if the key was not kept
+CUDA_CALLABLE inline bool topk_push(float* keys, int* values, int& count, int capacity, float key, int value)
+{
+    if (count < capacity)
+    {
+        int i = count++;
+        keys[i] = key;
+        values[i] = value;
+
+        while (i > 0)
+        {
+            const int parent = (i - 1)/2;
+            if (keys[parent] >= keys[i])
+                break;
+
+            topk_swap(keys, values, i, parent);
+            i = parent;
+        }
+
+        return true;
+    }
+
+    if (!(key < keys[0]))
+        return false;
+
+    keys[0] = key;
+    values[0] = value;
+    topk_sift_down(keys, values, 0, capacity);
+
+    return true;
+}
+
+// sorts the entries of a heap by increasing key
+CUDA_CALLABLE inline void topk_sort_increasing(float* keys, int* values, int count)
+{
+    for (int n=count-1; n > 0; --n)
+    {
+        topk_swap(keys, values, 0, n);
+        topk_sift_down(keys, values, 0, n);
+    }
+}
+
+template<unsigned K>
+CUDA_CALLABLE inline bool topk_push(topk_heap_t<K>& heap, float key, int value)
+{
+    return topk_push(heap.keys, heap.values, heap.count, int(K), key, value);
+}
+
+// same as topk_push() but skips values that the heap already holds, e.g.: vertices shared by several triangles
+template<unsigned K>
+CUDA_CALLABLE inline bool topk_push_unique(topk_heap_t<K>& heap, float key, int value)
+{
+    if (heap.count == int(K) && !(key < heap.keys[0]))
+        return false;
+
+    for (int i=0; i < heap.count; ++i)
+    {
+        if (heap.values[i] == value)
+            return false;
+    }
+
+    return topk_push(heap, key, value);
+}
+
+template<unsigned K>
+CUDA_CALLABLE inline int topk_count(const topk_heap_t<K>& heap)
+{
+    return heap.count;
+}
+
+// the key a new entry must be below to be kept, queries can discard candidates further than it
+template<unsigned K>
+CUDA_CALLABLE inline float topk_bound(const topk_heap_t<K>& heap)
+{
+    return heap.count < int(K) ? FLT_MAX : heap.keys[0];
+}
+
+// sorts the entries by decreasing key, which is still a valid max-heap, so that topk_key(heap, 0) is the smallest
+template<unsigned K>
+CUDA_CALLABLE inline void topk_sort(topk_heap_t<K>& heap)
+{
+    topk_sort_increasing(heap.keys, heap.values, heap.count);
+
+    for (int i=0; i < heap.count/2; ++i)
+        topk_swap(heap.keys, heap.values, i, heap.count-1-i);
+}
+
+// entries are read from the end so that sorted heaps are read in increasing key order
+template<unsigned K>
+CUDA_CALLABLE inline float topk_key(const topk_heap_t<K>& heap, int i)
+{
+    assert(i >= 0 && i < heap.count);
+    return heap.keys[heap.count-1-i];
+}
+
+template<unsigned K>
+CUDA_CALLABLE inline int topk_value(const topk_heap_t<K>& heap, int i)
+{
+    assert(i >= 0 && i < heap.count);
+    return heap.values[heap.count-1-i];
+}
+
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_heap(topk_heap_t<K>& adj_ret) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_push(topk_heap_t<K>& heap, float key, int value, topk_heap_t<K>& adj_heap, float& adj_key, int& adj_value, bool& adj_ret) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_count(const topk_heap_t<K>& heap, topk_heap_t<K>& adj_heap, int& adj_ret) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_bound(const topk_heap_t<K>& heap, topk_heap_t<K>& adj_heap, float& adj_ret) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_sort(topk_heap_t<K>& heap, topk_heap_t<K>& adj_heap) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_key(const topk_heap_t<K>& heap, int i, topk_heap_t<K>& adj_heap, int& adj_i, float& adj_ret) {}
+template<unsigned K>
+CUDA_CALLABLE inline void adj_topk_value(const topk_heap_t<K>& heap, int i, topk_heap_t<K>& adj_heap, int& adj_i, int& adj_ret) {}
+
+// fixed-size thread local array, a vector that kernels index with dynamic indices
+template<unsigned Length, typename Type>
+CUDA_CALLABLE inline vec_t<Length,Type> local_array()
+{
+    return vec_t<Length,Type>();
+}
+
+template<unsigned Length, typename Type>
+CUDA_CALLABLE inline void adj_local_array(vec_t<Length,Type>& adj_ret) {}
+
+} // namespace wp
@@ -10,8 +10,24 @@
 #include "volume_builder.h"
 #include "warp.h"
 #include "cuda_util.h"
+#include "mesh.h"
 
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace wp;
 
@@ -24,6 +40,9 @@ struct VolumeDesc
     void* buffer; 
     uint64_t size_in_bytes;
 
+    // size of the allocation of the buffer, device volumes may be rebuilt in place while their grid fits
+    uint64_t capacity_in_bytes;
+
     // offset to the voxel values of the first leaf node relative to buffer
     uint64_t first_voxel_data_offs;
 
@@ -62,8 +81,90 @@ void volume_rem_descriptor(uint64_t id)
     g_volume_descriptors.erase(id);
 }
 
+struct VolumeAtlasDesc
+{
+    // lookup table followed by the grids, either in device or host memory
+    void* buffer;
+    uint64_t size_in_bytes;
+
+    // CUDA context for this atlas (NULL if CPU)
+    void* context;
+};
+
+// Host-side atlas descriptors, the id of an atlas is the address of its buffer
+std::map<uint64_t, VolumeAtlasDesc> g_volume_atlas_descriptors;
+
+inline uint64_t volume_atlas_align(uint64_t size)
+{
+    return (size + NANOVDB_DATA_ALIGNMENT - 1) & ~uint64_t(NANOVDB_DATA_ALIGNMENT - 1);
+}
+
+// Packs copies of the grids of the volumes into one buffer behind a table of their offsets, see volume_atlas_get()
+uint64_t volume_atlas_create(void* context, const uint64_t* ids, int count)
+{
+    if (count <= 0)
+        return 0;
+
+    std::vector<uint64_t> table(1 + count);
+    std::vector<VolumeDesc> volumes(count);
+
+    table[0] = uint64_t(count);
+    uint64_t size = volume_atlas_align(table.size() * sizeof(uint64_t));
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (!volume_get_descriptor(ids[i], volumes[i]) || volumes[i].context != context)
+            return 0;
+
+        table[1 + i] = size;
+        size += volume_atlas_align(volumes[i].size_in_bytes);
+    }
+
+    VolumeAtlasDesc atlas;
+    atlas.context = context;
+    atlas.size_in_bytes = size;
+
+    if (context)
+    {
+        atlas.buffer = alloc_device(context, size);
+        memcpy_h2d(context, atlas.buffer, table.data(), table.size() * sizeof(uint64_t));
+        for (int i = 0; i < count; ++i)
+            memcpy_d2d(context, (uint8_t*)atlas.buffer + table[1 + i], volumes[i].buffer, volumes[i].size_in_bytes);
+    }
+    else
+    {
+        atlas.buffer = alloc_host(size);
+        memcpy_h2h(atlas.buffer, table.data(), table.size() * sizeof(uint64_t));
+        for (int i = 0; i < count; ++i)
+            memcpy_h2h((uint8_t*)atlas.buffer + table[1 + i], volumes[i].buffer, volumes[i].size_in_bytes);
+    }
+
+    const uint64_t id = (uint64_t)atlas.buffer;
+    g_volume_atlas_descriptors[id] = atlas;
+
+    return id;
+}
+
 } // anonymous namespace
 
+namespace wp
+{
+
+bool volume_get_leaf_layout(uint64_t id, uint64_t& first_leaf_offset, uint32_t& leaf_stride, uint32_t& leaf_count, uint32_t& grid_type)
+{
+    VolumeDesc volume;
+    if (!volume_get_descriptor(id, volume))
+        return false;
+
+    first_leaf_offset = sizeof(pnanovdb_grid_t) + volume.tree_data.node_offset_leaf;
+    leaf_stride = PNANOVDB_GRID_TYPE_GET(volume.grid_data.grid_type, leaf_size);
+    leaf_count = volume.tree_data.node_count_leaf;
+    grid_type = volume.grid_data.grid_type;
+    return true;
+}
+
+} // namespace wp
+
 
 // NB: buf must be a host pointer
 uint64_t volume_create_host(void* buf, uint64_t size)
@@ -82,6 +183,7 @@ uint64_t volume_create_host(void* buf, uint64_t size)
         return 0;
 
     volume.size_in_bytes = size;
+    volume.capacity_in_bytes = size;
     volume.buffer = alloc_host(size);
     memcpy_h2h(volume.buffer, buf, size);
 
@@ -114,6 +216,7 @@ uint64_t volume_create_device(void* context, void* buf, uint64_t size)
         return 0;
 
     volume.size_in_bytes = size;
+    volume.capacity_in_bytes = size;
     volume.buffer = alloc_device(WP_CURRENT_CONTEXT, size);
     memcpy_d2d(WP_CURRENT_CONTEXT, volume.buffer, buf, size);
 
@@ -209,6 +312,351 @@ void volume_destroy_device(uint64_t id)
     }
 }
 
+// NanoVDB grids are addressed by offsets, so a copy of the buffer is a valid grid on the new device
+uint64_t volume_clone_to_device(void* context, uint64_t id)
+{
+    VolumeDesc volume_src;
+    if (!volume_get_descriptor(id, volume_src) || !volume_src.context)
+        return 0;
+
+    ContextGuard guard(context);
+
+    VolumeDesc volume = volume_src;
+
+    volume.context = context ? context : cuda_context_get_current();
+    volume.capacity_in_bytes = volume_src.size_in_bytes;
+    volume.buffer = alloc_device(WP_CURRENT_CONTEXT, volume_src.size_in_bytes);
+    memcpy_peer(WP_CURRENT_CONTEXT, volume.buffer, volume_src.buffer, volume_src.size_in_bytes);
+
+    const uint64_t clone_id = (uint64_t)volume.buffer;
+
+    volume_add_descriptor(clone_id, volume);
+
+    return clone_id;
+}
+
+uint64_t volume_atlas_create_host(uint64_t* ids, int count)
+{
+    return volume_atlas_create(NULL, ids, count);
+}
+
+uint64_t volume_atlas_create_device(void* context, uint64_t* ids, int count)
+{
+    ContextGuard guard(context);
+
+    return volume_atlas_create(context ? context : cuda_context_get_current(), ids, count);
+}
+
+void volume_atlas_destroy_host(uint64_t id)
+{
+    free_host((void*)id);
+    g_volume_atlas_descriptors.erase(id);
+}
+
+void volume_atlas_destroy_device(uint64_t id)
+{
+    const auto iter = g_volume_atlas_descriptors.find(id);
+    if (iter != g_volume_atlas_descriptors.end())
+    {
+        ContextGuard guard(iter->second.context);
+        free_device(WP_CURRENT_CONTEXT, iter->second.buffer);
+        g_volume_atlas_descriptors.erase(iter);
+    }
+}
+
+namespace
+{
+
+// Read-only mapping of a .nvdb file, the pages are only faulted in when the grid is copied out
+struct NvdbFile
+{
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+};
+
+bool nvdb_file_open(const char* path, NvdbFile& file)
+{
+#if defined(_WIN32)
+    file.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file.file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file.file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file.file);
+        return false;
+    }
+
+    file.mapping = CreateFileMappingA(file.file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (file.mapping)
+        file.data = static_cast<const uint8_t*>(MapViewOfFile(file.mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!file.data)
+    {
+        if (file.mapping)
+            CloseHandle(file.mapping);
+        CloseHandle(file.file);
+        return false;
+    }
+
+    file.size = uint64_t(size.QuadPart);
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+
+    file.data = static_cast<const uint8_t*>(data);
+    file.size = uint64_t(st.st_size);
+#endif
+
+    return true;
+}
+
+void nvdb_file_close(NvdbFile& file)
+{
+    if (!file.data)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(file.data);
+    CloseHandle(file.mapping);
+    CloseHandle(file.file);
+#else
+    munmap(const_cast<uint8_t*>(file.data), size_t(file.size));
+#endif
+
+    file.data = nullptr;
+    file.size = 0;
+}
+
+// Locates the grid of an uncompressed single-grid .nvdb file, see nanovdb/util/IO.h for the layout of the headers.
+// Compressed files are left to the Python loader, which inflates them in memory.
+bool nvdb_file_find_grid(const NvdbFile& file, const uint8_t*& grid, uint64_t& grid_size)
+{
+    static constexpr uint64_t FILE_HEADER_SIZE = 16;
+    static constexpr uint64_t GRID_META_SIZE = 176;
+
+    if (file.size < FILE_HEADER_SIZE + GRID_META_SIZE)
+        return false;
+
+    uint64_t magic;
+    uint32_t version;
+    uint16_t grid_count, codec;
+    memcpy(&magic, file.data, sizeof(magic));
+    memcpy(&version, file.data + 8, sizeof(version));
+    memcpy(&grid_count, file.data + 12, sizeof(grid_count));
+    memcpy(&codec, file.data + 14, sizeof(codec));
+
+    if (magic != PNANOVDB_MAGIC_NUMBER || (version >> 21) != PNANOVDB_MAJOR_VERSION_NUMBER || grid_count != 1 || codec != 0)
+        return false;
+
+    uint32_t name_size;
+    memcpy(&grid_size, file.data + FILE_HEADER_SIZE, sizeof(grid_size));
+    memcpy(&name_size, file.data + FILE_HEADER_SIZE + 136, sizeof(name_size));
+
+    const uint64_t grid_offset = FILE_HEADER_SIZE + GRID_META_SIZE + name_size;
+    if (grid_offset > file.size || grid_size > file.size - grid_offset || grid_size < sizeof(pnanovdb_grid_t) + sizeof(pnanovdb_tree_t))
+        return false;
+
+    grid = file.data + grid_offset;
+    return reinterpret_cast<const pnanovdb_grid_t*>(grid)->magic == PNANOVDB_MAGIC_NUMBER;
+}
+
+// Registers a volume for a buffer that already holds a copy of the grid, the metadata is read from the host copy
+uint64_t volume_adopt_buffer(void* context, void* buffer, const uint8_t* host_grid, uint64_t size)
+{
+    VolumeDesc volume;
+
+    volume.context = context;
+    volume.buffer = buffer;
+    volume.size_in_bytes = size;
+    volume.capacity_in_bytes = size;
+
+    memcpy(&volume.grid_data, host_grid, sizeof(pnanovdb_grid_t));
+    memcpy(&volume.tree_data, host_grid + sizeof(pnanovdb_grid_t), sizeof(pnanovdb_tree_t));
+
+    volume.first_voxel_data_offs =
+        sizeof(pnanovdb_grid_t) + volume.tree_data.node_offset_leaf + PNANOVDB_GRID_TYPE_GET(PNANOVDB_GRID_TYPE_FLOAT, leaf_off_table);
+
+    const uint64_t id = (uint64_t)volume.buffer;
+
+    volume_add_descriptor(id, volume);
+
+    return id;
+}
+
+// In-flight load of a .nvdb file, the copy runs on a worker thread and the volume is registered by volume_prefetch_wait()
+struct VolumePrefetch
+{
+    NvdbFile file;
+    const uint8_t* grid = nullptr;
+    uint64_t grid_size = 0;
+
+    // destination buffer and its CUDA context (NULL if CPU)
+    void* buffer = nullptr;
+    void* context = nullptr;
+
+    // private stream the upload is issued on, and the event ordering it after the allocation
+    void* stream = nullptr;
+    void* event = nullptr;
+
+    bool success = false;
+    std::thread worker;
+};
+
+VolumePrefetch* volume_prefetch_begin(const char* path)
+{
+    VolumePrefetch* prefetch = new VolumePrefetch();
+
+    if (!nvdb_file_open(path, prefetch->file) || !nvdb_file_find_grid(prefetch->file, prefetch->grid, prefetch->grid_size))
+    {
+        nvdb_file_close(prefetch->file);
+        delete prefetch;
+        return nullptr;
+    }
+
+    return prefetch;
+}
+
+#if WP_ENABLE_CUDA
+
+// Uploads the mapped grid in chunks through two pinned staging buffers, so that reading the next chunk from the
+// file overlaps with the DMA transfer of the previous one
+bool nvdb_upload_device(void* stream, void* dest, const uint8_t* src, uint64_t size)
+{
+    static constexpr uint64_t CHUNK_SIZE = 16 << 20;
+
+    const uint64_t chunk_size = std::min(size, CHUNK_SIZE);
+
+    void* staging[2] = { alloc_pinned(chunk_size), alloc_pinned(chunk_size) };
+    void* copied[2] = { cuda_event_create(WP_CURRENT_CONTEXT, 0), cuda_event_create(WP_CURRENT_CONTEXT, 0) };
+
+    bool success = staging[0] && staging[1] && copied[0] && copied[1];
+
+    for (uint64_t offset = 0, chunk = 0; success && offset < size; offset += chunk_size, ++chunk)
+    {
+        const int b = int(chunk & 1);
+        const uint64_t n = std::min(chunk_size, size - offset);
+
+        // wait for the transfer that last used this staging buffer before overwriting it
+        if (chunk >= 2)
+            success = check_cuda(cudaEventSynchronize(static_cast<cudaEvent_t>(copied[b])));
+
+        memcpy(staging[b], src + offset, n);
+
+        success = success && check_cuda(cudaMemcpyAsync(static_cast<uint8_t*>(dest) + offset, staging[b], n, cudaMemcpyHostToDevice, static_cast<cudaStream_t>(stream)));
+        cuda_event_record(WP_CURRENT_CONTEXT, copied[b], stream);
+    }
+
+    cuda_stream_synchronize(WP_CURRENT_CONTEXT, stream);
+
+    for (int b = 0; b < 2; ++b)
+    {
+        if (copied[b])
+            cuda_event_destroy(WP_CURRENT_CONTEXT, copied[b]);
+        if (staging[b])
+            free_pinned(staging[b]);
+    }
+
+    return success;
+}
+
+#endif // WP_ENABLE_CUDA
+
+} // anonymous namespace
+
+uint64_t volume_load_nvdb_host(const char* path)
+{
+    NvdbFile file;
+    const uint8_t* grid;
+    uint64_t grid_size;
+
+    if (!nvdb_file_open(path, file))
+        return 0;
+
+    uint64_t id = 0;
+    if (nvdb_file_find_grid(file, grid, grid_size))
+        id = volume_create_host(const_cast<uint8_t*>(grid), grid_size);
+
+    nvdb_file_close(file);
+
+    return id;
+}
+
+void* volume_prefetch_nvdb_host(const char* path)
+{
+    VolumePrefetch* prefetch = volume_prefetch_begin(path);
+    if (!prefetch)
+        return nullptr;
+
+    prefetch->buffer = alloc_host(prefetch->grid_size);
+    prefetch->worker = std::thread([prefetch]()
+    {
+        memcpy(prefetch->buffer, prefetch->grid, prefetch->grid_size);
+        prefetch->success = true;
+    });
+
+    return prefetch;
+}
+
+uint64_t volume_prefetch_wait(void* handle)
+{
+    VolumePrefetch* prefetch = static_cast<VolumePrefetch*>(handle);
+    if (!prefetch)
+        return 0;
+
+    prefetch->worker.join();
+
+    uint64_t id = 0;
+    if (prefetch->success)
+        id = volume_adopt_buffer(prefetch->context, prefetch->buffer, prefetch->grid, prefetch->grid_size);
+
+#if WP_ENABLE_CUDA
+    if (prefetch->context)
+    {
+        ContextGuard guard(prefetch->context);
+
+        cuda_event_destroy(WP_CURRENT_CONTEXT, prefetch->event);
+        cuda_stream_destroy(WP_CURRENT_CONTEXT, prefetch->stream);
+
+        if (!id)
+            free_device(WP_CURRENT_CONTEXT, prefetch->buffer);
+    }
+    else
+#endif
+    if (!id)
+    {
+        free_host(prefetch->buffer);
+    }
+
+    nvdb_file_close(prefetch->file);
+    delete prefetch;
+
+    return id;
+}
+
 
 #if WP_ENABLE_CUDA
 uint64_t volume_f_from_tiles_device(void* context, void* points, int num_points, float voxel_size, float bg_value, float tx, float ty, float tz, bool points_in_world_space)
@@ -253,6 +701,243 @@ uint64_t volume_i_from_tiles_device(void* context, void* points, int num_points,
     return volume_create_device(context, grid, gridSize);
 }
 
+namespace
+{
+
+// Creates a volume from a grid built on the device, the builder's buffer is released once copied
+template <typename BuildT>
+uint64_t volume_from_grid_device(void* context, nanovdb::Grid<nanovdb::NanoTree<BuildT>>* grid, size_t grid_size)
+{
+    ContextGuard guard(context);
+
+    const uint64_t id = volume_create_device(WP_CURRENT_CONTEXT, grid, grid_size);
+    free_device(WP_CURRENT_CONTEXT, grid);
+
+    return id;
+}
+
+template <typename BuildT>
+uint64_t volume_from_dense_device(void* context, const void* values, int nx, int ny, int nz, float tolerance, const BuildGridParams<BuildT>& params)
+{
+    if (nx <= 0 || ny <= 0 || nz <= 0)
+        return 0;
+
+    ContextGuard guard(context);
+
+    nanovdb::Grid<nanovdb::NanoTree<BuildT>>* grid;
+    size_t gridSize;
+
+    build_grid_from_dense(grid, gridSize, static_cast<const BuildT*>(values), nx, ny, nz, tolerance, params);
+
+    return volume_from_grid_device(WP_CURRENT_CONTEXT, grid, gridSize);
+}
+
+// Replaces the grid of a device volume by a grid built on the device, the builder's buffer is released once copied.
+// The volume keeps its buffer and id while the grid fits into it, otherwise it moves to a buffer grown with headroom
+// for later edits.
+uint64_t volume_replace_grid_device(uint64_t id, void* grid, size_t grid_size)
+{
+    VolumeDesc volume;
+    if (!grid || !volume_get_descriptor(id, volume))
+        return 0;
+
+    ContextGuard guard(volume.context);
+
+    if (grid_size > volume.capacity_in_bytes)
+    {
+        const uint64_t capacity = grid_size + grid_size / 2;
+
+        free_device(WP_CURRENT_CONTEXT, volume.buffer);
+        volume_rem_descriptor(id);
+
+        volume.buffer = alloc_device(WP_CURRENT_CONTEXT, capacity);
+        volume.capacity_in_bytes = capacity;
+        id = (uint64_t)volume.buffer;
+    }
+
+    memcpy_d2d(WP_CURRENT_CONTEXT, volume.buffer, grid, grid_size);
+    free_device(WP_CURRENT_CONTEXT, grid);
+
+    memcpy_d2h(WP_CURRENT_CONTEXT, &volume.grid_data, volume.buffer, sizeof(pnanovdb_grid_t));
+    memcpy_d2h(WP_CURRENT_CONTEXT, &volume.tree_data, (pnanovdb_grid_t*)volume.buffer + 1, sizeof(pnanovdb_tree_t));
+
+    volume.size_in_bytes = grid_size;
+    volume.first_voxel_data_offs =
+        sizeof(pnanovdb_grid_t) + volume.tree_data.node_offset_leaf + PNANOVDB_GRID_TYPE_GET(PNANOVDB_GRID_TYPE_FLOAT, leaf_off_table);
+
+    volume_add_descriptor(id, volume);
+
+    return id;
+}
+
+template <typename BuildT>
+uint64_t volume_edit_tiles_device(const VolumeDesc& volume, uint64_t id, const void* points, int num_points, bool points_in_world_space, int dilation, float prune_tolerance)
+{
+    nanovdb::Grid<nanovdb::NanoTree<BuildT>>* grid;
+    size_t gridSize;
+
+    build_grid_with_tiles(grid, gridSize, static_cast<const nanovdb::Grid<nanovdb::NanoTree<BuildT>>*>(volume.buffer), points, size_t(num_points), points_in_world_space, dilation, prune_tolerance);
+
+    return volume_replace_grid_device(id, grid, gridSize);
+}
+
+uint64_t volume_edit_tiles_device(void* context, uint64_t id, const void* points, int num_points, bool points_in_world_space, int dilation, float prune_tolerance)
+{
+    VolumeDesc volume;
+    if (!volume_get_descriptor(id, volume) || !volume.context || num_points < 0)
+        return 0;
+
+    ContextGuard guard(volume.context);
+
+    switch (volume.grid_data.grid_type)
+    {
+    case PNANOVDB_GRID_TYPE_FLOAT:
+        return volume_edit_tiles_device<float>(volume, id, points, num_points, points_in_world_space, dilation, prune_tolerance);
+    case PNANOVDB_GRID_TYPE_VEC3F:
+        return volume_edit_tiles_device<nanovdb::Vec3f>(volume, id, points, num_points, points_in_world_space, dilation, prune_tolerance);
+    case PNANOVDB_GRID_TYPE_INT32:
+        return volume_edit_tiles_device<int32_t>(volume, id, points, num_points, points_in_world_space, dilation, prune_tolerance);
+    default:
+        return 0;
+    }
+}
+
+} // anonymous namespace
+
+uint64_t volume_activate_tiles_device(void* context, uint64_t id, void* points, int num_points, bool points_in_world_space)
+{
+    return volume_edit_tiles_device(context, id, points, num_points, points_in_world_space, 0, -1.0f);
+}
+
+uint64_t volume_dilate_device(void* context, uint64_t id, int voxels)
+{
+    if (voxels < 0)
+        return 0;
+
+    return volume_edit_tiles_device(context, id, nullptr, 0, false, voxels, -1.0f);
+}
+
+uint64_t volume_prune_device(void* context, uint64_t id, float tolerance)
+{
+    if (tolerance < 0.0f)
+        return 0;
+
+    return volume_edit_tiles_device(context, id, nullptr, 0, false, 0, tolerance);
+}
+
+uint64_t volume_f_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, float bg_value, float tolerance, float tx, float ty, float tz)
+{
+    BuildGridParams<float> params;
+    params.voxel_size = voxel_size;
+    params.background_value = bg_value;
+    params.translation = nanovdb::Vec3f{tx, ty, tz};
+
+    return volume_from_dense_device(context, values, nx, ny, nz, tolerance, params);
+}
+
+uint64_t volume_v_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, float bg_value_x, float bg_value_y, float bg_value_z, float tolerance, float tx, float ty, float tz)
+{
+    BuildGridParams<nanovdb::Vec3f> params;
+    params.voxel_size = voxel_size;
+    params.background_value = nanovdb::Vec3f{bg_value_x, bg_value_y, bg_value_z};
+    params.translation = nanovdb::Vec3f{tx, ty, tz};
+
+    return volume_from_dense_device(context, values, nx, ny, nz, tolerance, params);
+}
+
+uint64_t volume_i_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, int bg_value, float tolerance, float tx, float ty, float tz)
+{
+    BuildGridParams<int32_t> params;
+    params.voxel_size = voxel_size;
+    params.background_value = (int32_t)(bg_value);
+    params.translation = nanovdb::Vec3f{tx, ty, tz};
+
+    return volume_from_dense_device(context, values, nx, ny, nz, tolerance, params);
+}
+
+uint64_t volume_sdf_from_mesh_device(void* context, uint64_t mesh_id, float voxel_size, float narrow_band, float tx, float ty, float tz)
+{
+    wp::Mesh mesh;
+    if (!mesh_get_descriptor(mesh_id, mesh) || mesh.num_tris == 0 || narrow_band <= 0.0f)
+        return 0;
+
+    ContextGuard guard(context);
+
+    nanovdb::FloatGrid* grid;
+    size_t gridSize;
+    BuildGridParams<float> params;
+    params.voxel_size = voxel_size;
+    params.background_value = narrow_band;
+    params.translation = nanovdb::Vec3f{tx, ty, tz};
+
+    build_sdf_grid_from_mesh(grid, gridSize, mesh_id, reinterpret_cast<const nanovdb::Vec3f*>(mesh.points.data), mesh.indices.data, mesh.num_tris, narrow_band, params);
+
+    return volume_from_grid_device(WP_CURRENT_CONTEXT, grid, gridSize);
+}
+
+uint64_t volume_quantize_device(void* context, uint64_t id, int bits)
+{
+    VolumeDesc volume;
+    if (!volume_get_descriptor(id, volume) || !volume.context || volume.grid_data.grid_type != PNANOVDB_GRID_TYPE_FLOAT)
+        return 0;
+
+    ContextGuard guard(context);
+
+    const nanovdb::FloatGrid* grid = static_cast<const nanovdb::FloatGrid*>(volume.buffer);
+    size_t gridSize;
+
+    if (bits == 4)
+    {
+        nanovdb::Grid<nanovdb::NanoTree<nanovdb::Fp4>>* out;
+        build_quantized_grid(out, gridSize, grid);
+        return out ? volume_from_grid_device(WP_CURRENT_CONTEXT, out, gridSize) : 0;
+    }
+    else if (bits == 8)
+    {
+        nanovdb::Grid<nanovdb::NanoTree<nanovdb::Fp8>>* out;
+        build_quantized_grid(out, gridSize, grid);
+        return out ? volume_from_grid_device(WP_CURRENT_CONTEXT, out, gridSize) : 0;
+    }
+    else if (bits == 16)
+    {
+        nanovdb::Grid<nanovdb::NanoTree<nanovdb::Fp16>>* out;
+        build_quantized_grid(out, gridSize, grid);
+        return out ? volume_from_grid_device(WP_CURRENT_CONTEXT, out, gridSize) : 0;
+    }
+
+    return 0;
+}
+
+void* volume_prefetch_nvdb_device(void* context, const char* path)
+{
+    VolumePrefetch* prefetch = volume_prefetch_begin(path);
+    if (!prefetch)
+        return nullptr;
+
+    ContextGuard guard(context);
+
+    prefetch->context = context ? context : cuda_context_get_current();
+    prefetch->buffer = alloc_device(WP_CURRENT_CONTEXT, prefetch->grid_size);
+    prefetch->stream = cuda_stream_create(WP_CURRENT_CONTEXT);
+    prefetch->event = cuda_event_create(WP_CURRENT_CONTEXT, 0);
+
+    // the buffer may be a stream-ordered allocation on the current stream
+    cuda_stream_wait_stream(WP_CURRENT_CONTEXT, prefetch->stream, cuda_stream_get_current(), prefetch->event);
+
+    prefetch->worker = std::thread([prefetch]()
+    {
+        ContextGuard guard(prefetch->context);
+        prefetch->success = nvdb_upload_device(prefetch->stream, prefetch->buffer, prefetch->grid, prefetch->grid_size);
+    });
+
+    return prefetch;
+}
+
+uint64_t volume_load_nvdb_device(void* context, const char* path)
+{
+    return volume_prefetch_wait(volume_prefetch_nvdb_device(context, path));
+}
+
 void launch_get_leaf_coords(void* context, const uint32_t leaf_count, pnanovdb_coord_t *leaf_coords, const uint64_t first_leaf, const uint32_t leaf_stride);
 
 void volume_get_tiles_device(uint64_t id, void** buf, uint64_t* size)
@@ -292,6 +977,56 @@ uint64_t volume_i_from_tiles_device(void* context, void* points, int num_points,
     return 0;
 }
 
+uint64_t volume_f_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, float bg_value, float tolerance, float tx, float ty, float tz)
+{
+    return 0;
+}
+
+uint64_t volume_v_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, float bg_value_x, float bg_value_y, float bg_value_z, float tolerance, float tx, float ty, float tz)
+{
+    return 0;
+}
+
+uint64_t volume_i_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, int bg_value, float tolerance, float tx, float ty, float tz)
+{
+    return 0;
+}
+
+uint64_t volume_sdf_from_mesh_device(void* context, uint64_t mesh_id, float voxel_size, float narrow_band, float tx, float ty, float tz)
+{
+    return 0;
+}
+
+uint64_t volume_quantize_device(void* context, uint64_t id, int bits)
+{
+    return 0;
+}
+
+uint64_t volume_activate_tiles_device(void* context, uint64_t id, void* points, int num_points, bool points_in_world_space)
+{
+    return 0;
+}
+
+uint64_t volume_dilate_device(void* context, uint64_t id, int voxels)
+{
+    return 0;
+}
+
+uint64_t volume_prune_device(void* context, uint64_t id, float tolerance)
+{
+    return 0;
+}
+
+void* volume_prefetch_nvdb_device(void* context, const char* path)
+{
+    return nullptr;
+}
+
+uint64_t volume_load_nvdb_device(void* context, const char* path)
+{
+    return 0;
+}
+
 void volume_get_tiles_device(uint64_t id, void** buf, uint64_t* size) {}
 
 #endif
@@ -18,6 +18,11 @@
 
 namespace wp
 {
+
+// Byte offset of the first leaf node relative to the volume buffer, leaf node size and count, used to map
+// leaf nodes to their index in volume_get_tiles_*(). Returns false if id is not a known volume.
+bool volume_get_leaf_layout(uint64_t id, uint64_t& first_leaf_offset, uint32_t& leaf_stride, uint32_t& leaf_count, uint32_t& grid_type);
+
 namespace volume
 {
 
@@ -44,6 +49,38 @@ CUDA_CALLABLE inline pnanovdb_root_handle_t get_root(const pnanovdb_buf_t& buf,
     const auto tree = pnanovdb_grid_get_tree(buf, grid);
     return pnanovdb_tree_get_root(buf, tree);
 }
+
+// float grids, with their leaf values either stored at full precision or quantized
+CUDA_CALLABLE inline bool is_float_grid(pnanovdb_uint32_t grid_type)
+{
+    return grid_type == PNANOVDB_GRID_TYPE_FLOAT || (grid_type >= PNANOVDB_GRID_TYPE_FP4 && grid_type <= PNANOVDB_GRID_TYPE_FPN);
+}
+
+// Decodes value n of a quantized leaf, the codes are packed in 32 bit words and mapped linearly
+// to [minimum, minimum + quantum * (2^bits - 1)]. FpN leaves store their own bit width in their flags.
+CUDA_CALLABLE inline float read_quantized(pnanovdb_buf_t buf, pnanovdb_uint32_t grid_type, pnanovdb_leaf_handle_t leaf, pnanovdb_uint32_t n)
+{
+    const pnanovdb_address_t table = pnanovdb_address_offset(leaf.address, PNANOVDB_GRID_TYPE_GET(grid_type, leaf_off_table));
+
+    pnanovdb_uint32_t value_log_bits;
+    if (grid_type == PNANOVDB_GRID_TYPE_FP4)
+        value_log_bits = 2u;
+    else if (grid_type == PNANOVDB_GRID_TYPE_FP8)
+        value_log_bits = 3u;
+    else if (grid_type == PNANOVDB_GRID_TYPE_FP16)
+        value_log_bits = 4u;
+    else
+        value_log_bits = pnanovdb_read_uint32(buf, pnanovdb_address_offset_neg(table, PNANOVDB_LEAF_TABLE_NEG_OFF_BBOX_DIF_AND_FLAGS)) >> 29u;
+
+    const pnanovdb_uint32_t values_per_word_bits = 5u - value_log_bits;
+    const pnanovdb_uint32_t value_mask = (1u << (1u << value_log_bits)) - 1u;
+
+    const float minimum = pnanovdb_read_float(buf, pnanovdb_address_offset_neg(table, PNANOVDB_LEAF_TABLE_NEG_OFF_MINIMUM));
+    const float quantum = pnanovdb_read_float(buf, pnanovdb_address_offset_neg(table, PNANOVDB_LEAF_TABLE_NEG_OFF_QUANTUM));
+    const pnanovdb_uint32_t raw = pnanovdb_read_uint32(buf, pnanovdb_address_offset(table, (n >> values_per_word_bits) << 2u));
+    const pnanovdb_uint32_t code = (raw >> ((n & ((1u << values_per_word_bits) - 1u)) << value_log_bits)) & value_mask;
+    return float(code) * quantum + minimum;
+}
 } // namespace volume
 
 CUDA_CALLABLE inline void pnano_read(float& result, pnanovdb_buf_t buf, pnanovdb_root_handle_t root, PNANOVDB_IN(pnanovdb_coord_t) ijk) {
@@ -74,59 +111,198 @@ CUDA_CALLABLE inline void pnano_read(vec3& result, pnanovdb_buf_t buf, PNANOVDB_
     result = {v.x, v.y, v.z};
 }
 
-// Sampling the volume at the given index-space coordinates, uvw can be fractional
+// Read accessor of a volume, caching the nodes visited by the last query so that the following queries
+// close to it skip the descent from the root. The cache persists across the builtins taking the accessor.
+struct volume_accessor_t
+{
+    CUDA_CALLABLE volume_accessor_t() {}
+    CUDA_CALLABLE volume_accessor_t(int) {} // for backward pass
+
+    pnanovdb_buf_t buf;
+    pnanovdb_readaccessor_t accessor;
+    pnanovdb_uint32_t grid_type;
+};
+
+CUDA_CALLABLE inline volume_accessor_t volume_accessor(uint64_t id)
+{
+    volume_accessor_t acc;
+    acc.buf = volume::id_to_buffer(id);
+    acc.grid_type = volume::get_grid_type(acc.buf);
+    pnanovdb_readaccessor_init(PNANOVDB_REF(acc.accessor), volume::get_root(acc.buf));
+    return acc;
+}
+
+CUDA_CALLABLE inline void adj_volume_accessor(uint64_t id, uint64_t& adj_id, volume_accessor_t& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline void pnano_read(float& result, pnanovdb_buf_t buf, pnanovdb_address_t address) {
+    result = pnanovdb_read_float(buf, address);
+}
+CUDA_CALLABLE inline void pnano_read(int32_t& result, pnanovdb_buf_t buf, pnanovdb_address_t address) {
+    result = pnanovdb_read_int32(buf, address);
+}
+CUDA_CALLABLE inline void pnano_read(vec3& result, pnanovdb_buf_t buf, pnanovdb_address_t address) {
+    const pnanovdb_vec3_t v = pnanovdb_read_vec3f(buf, address);
+    result = {v.x, v.y, v.z};
+}
+
+// Reads voxel ijk through the accessor, float volumes may be quantized
 template<typename T>
-CUDA_CALLABLE inline T volume_sample(uint64_t id, vec3 uvw, int sampling_mode)
+CUDA_CALLABLE inline void volume_read(T& result, volume_accessor_t& acc, const pnanovdb_coord_t& ijk)
 {
-    const pnanovdb_buf_t buf = volume::id_to_buffer(id);
-    const pnanovdb_root_handle_t root = volume::get_root(buf);
-    const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
+    pnano_read(result, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk));
+}
+
+CUDA_CALLABLE inline void volume_read(float& result, volume_accessor_t& acc, const pnanovdb_coord_t& ijk)
+{
+    if (acc.grid_type == PNANOVDB_GRID_TYPE_FLOAT)
+    {
+        pnano_read(result, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk));
+        return;
+    }
 
+    pnanovdb_uint32_t level;
+    const pnanovdb_address_t address = pnanovdb_readaccessor_get_value_address_and_level(acc.grid_type, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk), PNANOVDB_REF(level));
+
+    // only leaf values are quantized, tiles and the background are stored at full precision
+    if (level == 0)
+        result = volume::read_quantized(acc.buf, acc.grid_type, acc.accessor.leaf, pnanovdb_leaf_coord_to_offset(PNANOVDB_REF(ijk)));
+    else
+        result = pnanovdb_read_float(acc.buf, address);
+}
+
+// Reads value n of the leaf node cached by the accessor
+template<typename T>
+CUDA_CALLABLE inline void volume_read_leaf(T& result, const volume_accessor_t& acc, pnanovdb_uint32_t n)
+{
+    pnano_read(result, acc.buf, pnanovdb_leaf_get_table_address(acc.grid_type, acc.buf, acc.accessor.leaf, n));
+}
+
+CUDA_CALLABLE inline void volume_read_leaf(float& result, const volume_accessor_t& acc, pnanovdb_uint32_t n)
+{
+    if (acc.grid_type == PNANOVDB_GRID_TYPE_FLOAT)
+        result = pnanovdb_read_float(acc.buf, pnanovdb_leaf_get_table_address(acc.grid_type, acc.buf, acc.accessor.leaf, n));
+    else
+        result = volume::read_quantized(acc.buf, acc.grid_type, acc.accessor.leaf, n);
+}
+
+// Reads the NxNxN voxels ijk + [0, N)^3 into values, ordered along z, then y, then x. When all of them
+// lie in the leaf node of ijk they are read from its value table after a single descent.
+template<int N, typename T>
+CUDA_CALLABLE inline void volume_read_stencil(volume_accessor_t& acc, pnanovdb_coord_t ijk, T* values)
+{
+    pnanovdb_uint32_t level;
+    pnanovdb_readaccessor_get_value_address_and_level(acc.grid_type, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk), PNANOVDB_REF(level));
+
+    if (level == 0 && (ijk.x & 7) + N <= 8 && (ijk.y & 7) + N <= 8 && (ijk.z & 7) + N <= 8)
+    {
+        const pnanovdb_uint32_t n = pnanovdb_leaf_coord_to_offset(PNANOVDB_REF(ijk));
+        for (int dx = 0; dx < N; ++dx)
+            for (int dy = 0; dy < N; ++dy)
+                for (int dz = 0; dz < N; ++dz)
+                    volume_read_leaf(values[(dx * N + dy) * N + dz], acc, n + ((dx << 6) | (dy << 3) | dz));
+    }
+    else
+    {
+        for (int dx = 0; dx < N; ++dx)
+            for (int dy = 0; dy < N; ++dy)
+                for (int dz = 0; dz < N; ++dz)
+                {
+                    const pnanovdb_coord_t ijk_shifted{ ijk.x + dx, ijk.y + dy, ijk.z + dz };
+                    volume_read(values[(dx * N + dy) * N + dz], acc, ijk_shifted);
+                }
+    }
+}
+
+namespace volume
+{
+// cell of a trilinear sample and the interpolation weights along each axis
+struct linear_cell
+{
+    CUDA_CALLABLE linear_cell(const vec3& uvw)
+    {
+        const pnanovdb_vec3_t ijk_base{ floorf(uvw[0]), floorf(uvw[1]), floorf(uvw[2]) };
+        const pnanovdb_vec3_t ijk_frac{ uvw[0] - ijk_base.x, uvw[1] - ijk_base.y, uvw[2] - ijk_base.z };
+        ijk = { (pnanovdb_int32_t)ijk_base.x, (pnanovdb_int32_t)ijk_base.y, (pnanovdb_int32_t)ijk_base.z };
+
+        wx[0] = 1 - ijk_frac.x; wx[1] = ijk_frac.x;
+        wy[0] = 1 - ijk_frac.y; wy[1] = ijk_frac.y;
+        wz[0] = 1 - ijk_frac.z; wz[1] = ijk_frac.z;
+    }
+
+    // offset of a cell corner, in the order of volume_read_stencil<2>()
+    static CUDA_CALLABLE pnanovdb_coord_t corner(int idx)
+    {
+        return { idx >> 2, (idx >> 1) & 1, idx & 1 };
+    }
+
+    pnanovdb_coord_t ijk;
+    float wx[2];
+    float wy[2];
+    float wz[2];
+};
+} // namespace volume
+
+// Sampling the volume at the given index-space coordinates, uvw can be fractional
+template<typename T>
+CUDA_CALLABLE inline T volume_sample(volume_accessor_t& acc, vec3 uvw, int sampling_mode)
+{
     if (sampling_mode == volume::CLOSEST)
     {
+        const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
         const pnanovdb_coord_t ijk = pnanovdb_vec3_round_to_coord(uvw_pnano);
         T val;
-        pnano_read(val, buf, root, PNANOVDB_REF(ijk));
+        volume_read(val, acc, ijk);
         return val;
     }
     else if (sampling_mode == volume::LINEAR)
     {
         // NB. linear sampling is not used on int volumes
-        constexpr pnanovdb_coord_t OFFSETS[] = {
-            { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 1 }, { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 0 }, { 1, 1, 1 },
-        };
+        const volume::linear_cell cell(uvw);
 
-        const pnanovdb_vec3_t ijk_base{ floorf(uvw_pnano.x), floorf(uvw_pnano.y), floorf(uvw_pnano.z) };
-        const pnanovdb_vec3_t ijk_frac{ uvw_pnano.x - ijk_base.x, uvw_pnano.y - ijk_base.y, uvw_pnano.z - ijk_base.z };
-        const pnanovdb_coord_t ijk{ (pnanovdb_int32_t)ijk_base.x, (pnanovdb_int32_t)ijk_base.y, (pnanovdb_int32_t)ijk_base.z };
+        T v[8];
+        volume_read_stencil<2>(acc, cell.ijk, v);
 
-        pnanovdb_readaccessor_t accessor;
-        pnanovdb_readaccessor_init(PNANOVDB_REF(accessor), root);
         T val = 0;
-        const float wx[2]{ 1 - ijk_frac.x, ijk_frac.x };
-        const float wy[2]{ 1 - ijk_frac.y, ijk_frac.y };
-        const float wz[2]{ 1 - ijk_frac.z, ijk_frac.z };
         for (int idx = 0; idx < 8; ++idx)
         {
-            const pnanovdb_coord_t& offs = OFFSETS[idx];
-            const pnanovdb_coord_t ijk_shifted = pnanovdb_coord_add(ijk, offs);
-            T v;
-            pnano_read(v, buf, PNANOVDB_REF(accessor), PNANOVDB_REF(ijk_shifted));
-            val = add(val, T(wx[offs.x] * wy[offs.y] * wz[offs.z] * v));
+            const pnanovdb_coord_t offs = volume::linear_cell::corner(idx);
+            val = add(val, T(cell.wx[offs.x] * cell.wy[offs.y] * cell.wz[offs.z] * v[idx]));
         }
         return val;
     }
     return 0;
 }
 
+template<typename T>
+CUDA_CALLABLE inline T volume_sample(uint64_t id, vec3 uvw, int sampling_mode)
+{
+    volume_accessor_t acc = volume_accessor(id);
+    return volume_sample<T>(acc, uvw, sampling_mode);
+}
+
 // Sampling a float volume at the given index-space coordinates, uvw can be fractional
+CUDA_CALLABLE inline float volume_sample_f(volume_accessor_t& acc, vec3 uvw, int sampling_mode)
+{
+    if (!volume::is_float_grid(acc.grid_type)) return 0.f;
+    return volume_sample<float>(acc, uvw, sampling_mode);
+}
+
 CUDA_CALLABLE inline float volume_sample_f(uint64_t id, vec3 uvw, int sampling_mode)
 {
-    if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_FLOAT) return 0.f;
+    if (!volume::is_float_grid(volume::get_grid_type(volume::id_to_buffer(id)))) return 0.f;
     return volume_sample<float>(id, uvw, sampling_mode);
 }
 
 // Sampling an int volume at the given index-space coordinates, uvw can be fractional
+CUDA_CALLABLE inline int32_t volume_sample_i(volume_accessor_t& acc, vec3 uvw)
+{
+    if (acc.grid_type != PNANOVDB_GRID_TYPE_INT32) return 0;
+    return volume_sample<int32_t>(acc, uvw, volume::CLOSEST);
+}
+
 CUDA_CALLABLE inline int32_t volume_sample_i(uint64_t id, vec3 uvw)
 {
     if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_INT32) return 0;
@@ -134,6 +310,12 @@ CUDA_CALLABLE inline int32_t volume_sample_i(uint64_t id, vec3 uvw)
 }
 
 // Sampling a vector volume at the given index-space coordinates, uvw can be fractional
+CUDA_CALLABLE inline vec3 volume_sample_v(volume_accessor_t& acc, vec3 uvw, int sampling_mode)
+{
+    if (acc.grid_type != PNANOVDB_GRID_TYPE_VEC3F) return vec3(0.f);
+    return volume_sample<vec3>(acc, uvw, sampling_mode);
+}
+
 CUDA_CALLABLE inline vec3 volume_sample_v(uint64_t id, vec3 uvw, int sampling_mode)
 {
     if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_VEC3F) return vec3(0.f);
@@ -141,84 +323,62 @@ CUDA_CALLABLE inline vec3 volume_sample_v(uint64_t id, vec3 uvw, int sampling_mo
 }
 
 CUDA_CALLABLE inline void adj_volume_sample_f(
-    uint64_t id, vec3 uvw, int sampling_mode, uint64_t& adj_id, vec3& adj_uvw, int& adj_sampling_mode, const float& adj_ret)
+    volume_accessor_t& acc, vec3 uvw, int sampling_mode, volume_accessor_t& adj_acc, vec3& adj_uvw, int& adj_sampling_mode, const float& adj_ret)
 {
-    if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_FLOAT) return;
+    if (!volume::is_float_grid(acc.grid_type)) return;
 
     if (sampling_mode != volume::LINEAR) {
         return; // NOP
     }
 
-    const pnanovdb_buf_t buf = volume::id_to_buffer(id);
-    const pnanovdb_root_handle_t root = volume::get_root(buf);
-    const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
-
-    constexpr pnanovdb_coord_t OFFSETS[] = {
-        { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 1 }, { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 0 }, { 1, 1, 1 },
-    };
+    const volume::linear_cell cell(uvw);
 
-    const pnanovdb_vec3_t ijk_base{ floorf(uvw_pnano.x), floorf(uvw_pnano.y), floorf(uvw_pnano.z) };
-    const pnanovdb_vec3_t ijk_frac{ uvw_pnano.x - ijk_base.x, uvw_pnano.y - ijk_base.y, uvw_pnano.z - ijk_base.z };
-    const pnanovdb_coord_t ijk{ (pnanovdb_int32_t)ijk_base.x, (pnanovdb_int32_t)ijk_base.y, (pnanovdb_int32_t)ijk_base.z };
+    float v[8];
+    volume_read_stencil<2>(acc, cell.ijk, v);
 
-    pnanovdb_readaccessor_t accessor;
-    pnanovdb_readaccessor_init(PNANOVDB_REF(accessor), root);
-    const float wx[2]{ 1 - ijk_frac.x, ijk_frac.x };
-    const float wy[2]{ 1 - ijk_frac.y, ijk_frac.y };
-    const float wz[2]{ 1 - ijk_frac.z, ijk_frac.z };
     vec3 dphi(0,0,0);
     for (int idx = 0; idx < 8; ++idx)
     {
-        const pnanovdb_coord_t& offs = OFFSETS[idx];
-        const pnanovdb_coord_t ijk_shifted = pnanovdb_coord_add(ijk, offs);
-        float v;
-        pnano_read(v, buf, PNANOVDB_REF(accessor), PNANOVDB_REF(ijk_shifted));
+        const pnanovdb_coord_t offs = volume::linear_cell::corner(idx);
         const vec3 signs(offs.x * 2 - 1, offs.y * 2 - 1, offs.z * 2 - 1);
-        const vec3 grad_w(signs[0] * wy[offs.y] * wz[offs.z], signs[1] * wx[offs.x] * wz[offs.z], signs[2] * wx[offs.x] * wy[offs.y]); 
-        dphi = add(dphi, mul(v, grad_w));
+        const vec3 grad_w(signs[0] * cell.wy[offs.y] * cell.wz[offs.z], signs[1] * cell.wx[offs.x] * cell.wz[offs.z], signs[2] * cell.wx[offs.x] * cell.wy[offs.y]);
+        dphi = add(dphi, mul(v[idx], grad_w));
     }
 
     adj_uvw += mul(dphi, adj_ret);
 }
 
+CUDA_CALLABLE inline void adj_volume_sample_f(
+    uint64_t id, vec3 uvw, int sampling_mode, uint64_t& adj_id, vec3& adj_uvw, int& adj_sampling_mode, const float& adj_ret)
+{
+    volume_accessor_t acc = volume_accessor(id);
+    volume_accessor_t adj_acc;
+    adj_volume_sample_f(acc, uvw, sampling_mode, adj_acc, adj_uvw, adj_sampling_mode, adj_ret);
+}
+
 CUDA_CALLABLE inline void adj_volume_sample_v(
-    uint64_t id, vec3 uvw, int sampling_mode, uint64_t& adj_id, vec3& adj_uvw, int& adj_sampling_mode, const vec3& adj_ret)
+    volume_accessor_t& acc, vec3 uvw, int sampling_mode, volume_accessor_t& adj_acc, vec3& adj_uvw, int& adj_sampling_mode, const vec3& adj_ret)
 {
-    if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_VEC3F) return;
+    if (acc.grid_type != PNANOVDB_GRID_TYPE_VEC3F) return;
 
     if (sampling_mode != volume::LINEAR) {
         return; // NOP
     }
 
-    const pnanovdb_buf_t buf = volume::id_to_buffer(id);
-    const pnanovdb_root_handle_t root = volume::get_root(buf);
-    const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
-
-    constexpr pnanovdb_coord_t OFFSETS[] = {
-        { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 1 }, { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 0 }, { 1, 1, 1 },
-    };
+    const volume::linear_cell cell(uvw);
 
-    const pnanovdb_vec3_t ijk_base{ floorf(uvw_pnano.x), floorf(uvw_pnano.y), floorf(uvw_pnano.z) };
-    const pnanovdb_vec3_t ijk_frac{ uvw_pnano.x - ijk_base.x, uvw_pnano.y - ijk_base.y, uvw_pnano.z - ijk_base.z };
-    const pnanovdb_coord_t ijk{ (pnanovdb_int32_t)ijk_base.x, (pnanovdb_int32_t)ijk_base.y, (pnanovdb_int32_t)ijk_base.z };
+    vec3 v[8];
+    volume_read_stencil<2>(acc, cell.ijk, v);
 
-    pnanovdb_readaccessor_t accessor;
-    pnanovdb_readaccessor_init(PNANOVDB_REF(accessor), root);
-    const float wx[2]{ 1 - ijk_frac.x, ijk_frac.x };
-    const float wy[2]{ 1 - ijk_frac.y, ijk_frac.y };
-    const float wz[2]{ 1 - ijk_frac.z, ijk_frac.z };
     vec3 dphi[3] = {{0,0,0}, {0,0,0}, {0,0,0}};
     for (int idx = 0; idx < 8; ++idx)
     {
-        const pnanovdb_coord_t& offs = OFFSETS[idx];
-        const pnanovdb_coord_t ijk_shifted = pnanovdb_coord_add(ijk, offs);
-        vec3 v;
-        pnano_read(v, buf, PNANOVDB_REF(accessor), PNANOVDB_REF(ijk_shifted));
+        const pnanovdb_coord_t offs = volume::linear_cell::corner(idx);
         const vec3 signs(offs.x * 2 - 1, offs.y * 2 - 1, offs.z * 2 - 1);
-        const vec3 grad_w(signs[0] * wy[offs.y] * wz[offs.z], signs[1] * wx[offs.x] * wz[offs.z], signs[2] * wx[offs.x] * wy[offs.y]); 
-        dphi[0] = add(dphi[0], mul(v[0], grad_w));
-        dphi[1] = add(dphi[1], mul(v[1], grad_w));
-        dphi[2] = add(dphi[2], mul(v[2], grad_w));
+        const vec3 grad_w(signs[0] * cell.wy[offs.y] * cell.wz[offs.z], signs[1] * cell.wx[offs.x] * cell.wz[offs.z], signs[2] * cell.wx[offs.x] * cell.wy[offs.y]);
+        dphi[0] = add(dphi[0], mul(v[idx][0], grad_w));
+        dphi[1] = add(dphi[1], mul(v[idx][1], grad_w));
+        dphi[2] = add(dphi[2], mul(v[idx][2], grad_w));
     }
 
     for (int k = 0; k < 3; ++k)
@@ -227,61 +387,62 @@ CUDA_CALLABLE inline void adj_volume_sample_v(
     }
 }
 
+CUDA_CALLABLE inline void adj_volume_sample_v(
+    uint64_t id, vec3 uvw, int sampling_mode, uint64_t& adj_id, vec3& adj_uvw, int& adj_sampling_mode, const vec3& adj_ret)
+{
+    volume_accessor_t acc = volume_accessor(id);
+    volume_accessor_t adj_acc;
+    adj_volume_sample_v(acc, uvw, sampling_mode, adj_acc, adj_uvw, adj_sampling_mode, adj_ret);
+}
+
+CUDA_CALLABLE inline void adj_volume_sample_i(volume_accessor_t& acc, vec3 uvw, volume_accessor_t& adj_acc, vec3& adj_uvw, const int32_t& adj_ret)
+{
+    // NOP
+}
+
 CUDA_CALLABLE inline void adj_volume_sample_i(uint64_t id, vec3 uvw, uint64_t& adj_id, vec3& adj_uvw, const int32_t& adj_ret)
 {
     // NOP
 }
 
 // Sampling the volume at the given index-space coordinates, uvw can be fractional
-CUDA_CALLABLE inline float volume_sample_grad_f(uint64_t id, vec3 uvw, int sampling_mode, vec3& grad)
+CUDA_CALLABLE inline float volume_sample_grad_f(volume_accessor_t& acc, vec3 uvw, int sampling_mode, vec3& grad)
 {
-    const pnanovdb_buf_t buf = volume::id_to_buffer(id);
-    const pnanovdb_root_handle_t root = volume::get_root(buf);
-    const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
+    if (!volume::is_float_grid(acc.grid_type))
+    {
+        grad = vec3(0.0f, 0.0f, 0.0f);
+        return 0.0f;
+    }
 
     if (sampling_mode == volume::CLOSEST)
     {
+        const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
         const pnanovdb_coord_t ijk = pnanovdb_vec3_round_to_coord(uvw_pnano);
         float val;
-        pnano_read(val, buf, root, PNANOVDB_REF(ijk));
+        volume_read(val, acc, ijk);
         grad = vec3(0.0f, 0.0f, 0.0f);
         return val;
     }
     else if (sampling_mode == volume::LINEAR)
     {
         // NB. linear sampling is not used on int volumes
-        constexpr pnanovdb_coord_t OFFSETS[] = {
-            { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 1 }, { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 0 }, { 1, 1, 1 },
-        };
+        const volume::linear_cell cell(uvw);
 
-        const pnanovdb_vec3_t ijk_base{ floorf(uvw_pnano.x), floorf(uvw_pnano.y), floorf(uvw_pnano.z) };
-        const pnanovdb_vec3_t ijk_frac{ uvw_pnano.x - ijk_base.x, uvw_pnano.y - ijk_base.y, uvw_pnano.z - ijk_base.z };
-        const pnanovdb_coord_t ijk{ (pnanovdb_int32_t)ijk_base.x, (pnanovdb_int32_t)ijk_base.y, (pnanovdb_int32_t)ijk_base.z };
+        float v[8];
+        volume_read_stencil<2>(acc, cell.ijk, v);
 
-        pnanovdb_readaccessor_t accessor;
-        pnanovdb_readaccessor_init(PNANOVDB_REF(accessor), root);
         float val = 0.0f;
-        const float wx[2]{ 1 - ijk_frac.x, ijk_frac.x };
-        const float wy[2]{ 1 - ijk_frac.y, ijk_frac.y };
-        const float wz[2]{ 1 - ijk_frac.z, ijk_frac.z };
-
-        const float sign_dx[8] = {-1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
-        const float sign_dy[8] = {-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f};
-        const float sign_dz[8] = {-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f};
-        
         float dfdx = 0.0f;
         float dfdy = 0.0f;
         float dfdz = 0.0f;
         for (int idx = 0; idx < 8; ++idx)
         {
-            const pnanovdb_coord_t& offs = OFFSETS[idx];
-            const pnanovdb_coord_t ijk_shifted = pnanovdb_coord_add(ijk, offs);
-            float v;
-            pnano_read(v, buf, PNANOVDB_REF(accessor), PNANOVDB_REF(ijk_shifted));
-            val = add(val, wx[offs.x] * wy[offs.y] * wz[offs.z] * v);
-            dfdx = add(dfdx, wy[offs.y] * wz[offs.z] * sign_dx[idx] * v);
-            dfdy = add(dfdy, wx[offs.x] * wz[offs.z] * sign_dy[idx] * v);
-            dfdz = add(dfdz, wx[offs.x] * wy[offs.y] * sign_dz[idx] * v);
+            const pnanovdb_coord_t offs = volume::linear_cell::corner(idx);
+            const vec3 signs(offs.x * 2 - 1, offs.y * 2 - 1, offs.z * 2 - 1);
+            val = add(val, cell.wx[offs.x] * cell.wy[offs.y] * cell.wz[offs.z] * v[idx]);
+            dfdx = add(dfdx, cell.wy[offs.y] * cell.wz[offs.z] * signs[0] * v[idx]);
+            dfdy = add(dfdy, cell.wx[offs.x] * cell.wz[offs.z] * signs[1] * v[idx]);
+            dfdz = add(dfdz, cell.wx[offs.x] * cell.wy[offs.y] * signs[2] * v[idx]);
         }
         grad = vec3(dfdx, dfdy, dfdz);
         return val;
@@ -289,61 +450,51 @@ CUDA_CALLABLE inline float volume_sample_grad_f(uint64_t id, vec3 uvw, int sampl
     return 0.0f;
 }
 
+CUDA_CALLABLE inline float volume_sample_grad_f(uint64_t id, vec3 uvw, int sampling_mode, vec3& grad)
+{
+    volume_accessor_t acc = volume_accessor(id);
+    return volume_sample_grad_f(acc, uvw, sampling_mode, grad);
+}
+
 CUDA_CALLABLE inline void adj_volume_sample_grad_f(
-    uint64_t id, vec3 uvw, int sampling_mode, vec3& grad, uint64_t& adj_id, vec3& adj_uvw, int& adj_sampling_mode, vec3& adj_grad, const float& adj_ret)
+    volume_accessor_t& acc, vec3 uvw, int sampling_mode, vec3& grad, volume_accessor_t& adj_acc, vec3& adj_uvw, int& adj_sampling_mode, vec3& adj_grad, const float& adj_ret)
 {
-    if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_FLOAT) return;
+    if (!volume::is_float_grid(acc.grid_type)) return;
 
     if (sampling_mode != volume::LINEAR) {
         return; // NOP
     }
 
-    const pnanovdb_buf_t buf = volume::id_to_buffer(id);
-    const pnanovdb_root_handle_t root = volume::get_root(buf);
-    const pnanovdb_vec3_t uvw_pnano{ uvw[0], uvw[1], uvw[2] };
-
-    constexpr pnanovdb_coord_t OFFSETS[] = {
-        { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 1 }, { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 0 }, { 1, 1, 1 },
-    };
+    const volume::linear_cell cell(uvw);
+    const float* wx = cell.wx;
+    const float* wy = cell.wy;
+    const float* wz = cell.wz;
 
-    const pnanovdb_vec3_t ijk_base{ floorf(uvw_pnano.x), floorf(uvw_pnano.y), floorf(uvw_pnano.z) };
-    const pnanovdb_vec3_t ijk_frac{ uvw_pnano.x - ijk_base.x, uvw_pnano.y - ijk_base.y, uvw_pnano.z - ijk_base.z };
-    const pnanovdb_coord_t ijk{ (pnanovdb_int32_t)ijk_base.x, (pnanovdb_int32_t)ijk_base.y, (pnanovdb_int32_t)ijk_base.z };
+    float v[8];
+    volume_read_stencil<2>(acc, cell.ijk, v);
 
-    pnanovdb_readaccessor_t accessor;
-    pnanovdb_readaccessor_init(PNANOVDB_REF(accessor), root);
-    const float wx[2]{ 1 - ijk_frac.x, ijk_frac.x };
-    const float wy[2]{ 1 - ijk_frac.y, ijk_frac.y };
-    const float wz[2]{ 1 - ijk_frac.z, ijk_frac.z };
-    const float sign_dx[8] = {-1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
-    const float sign_dy[8] = {-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f};
-    const float sign_dz[8] = {-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f};
-    
     float dfdxdy = 0.0f;
     float dfdxdz = 0.0f;
     float dfdydx = 0.0f;
     float dfdydz = 0.0f;
-    float dfdzdx = 0.0f;    
-    float dfdzdy = 0.0f;    
+    float dfdzdx = 0.0f;
+    float dfdzdy = 0.0f;
     vec3 dphi(0,0,0);
     for (int idx = 0; idx < 8; ++idx)
     {
-        const pnanovdb_coord_t& offs = OFFSETS[idx];
-        const pnanovdb_coord_t ijk_shifted = pnanovdb_coord_add(ijk, offs);
-        float v;
-        pnano_read(v, buf, PNANOVDB_REF(accessor), PNANOVDB_REF(ijk_shifted));
+        const pnanovdb_coord_t offs = volume::linear_cell::corner(idx);
         const vec3 signs(offs.x * 2 - 1, offs.y * 2 - 1, offs.z * 2 - 1);
-        const vec3 grad_w(signs[0] * wy[offs.y] * wz[offs.z], signs[1] * wx[offs.x] * wz[offs.z], signs[2] * wx[offs.x] * wy[offs.y]); 
-        dphi = add(dphi, mul(v, grad_w));
+        const vec3 grad_w(signs[0] * wy[offs.y] * wz[offs.z], signs[1] * wx[offs.x] * wz[offs.z], signs[2] * wx[offs.x] * wy[offs.y]);
+        dphi = add(dphi, mul(v[idx], grad_w));
 
-        dfdxdy = add(dfdxdy, signs[1] * wz[offs.z] * sign_dx[idx] * v);
-        dfdxdz = add(dfdxdz, wy[offs.y] * signs[2] * sign_dx[idx] * v);
+        dfdxdy = add(dfdxdy, signs[1] * wz[offs.z] * signs[0] * v[idx]);
+        dfdxdz = add(dfdxdz, wy[offs.y] * signs[2] * signs[0] * v[idx]);
 
-        dfdydx = add(dfdydx, signs[0] * wz[offs.z] * sign_dy[idx] * v);
-        dfdydz = add(dfdydz, wx[offs.x] * signs[2] * sign_dy[idx] * v);
+        dfdydx = add(dfdydx, signs[0] * wz[offs.z] * signs[1] * v[idx]);
+        dfdydz = add(dfdydz, wx[offs.x] * signs[2] * signs[1] * v[idx]);
 
-        dfdzdx = add(dfdzdx, signs[0] * wy[offs.y] * sign_dz[idx] * v);        
-        dfdzdy = add(dfdzdy, wx[offs.x] * signs[1] * sign_dz[idx] * v);        
+        dfdzdx = add(dfdzdx, signs[0] * wy[offs.y] * signs[2] * v[idx]);
+        dfdzdy = add(dfdzdy, wx[offs.x] * signs[1] * signs[2] * v[idx]);
     }
 
     adj_uvw += mul(dphi, adj_ret);
@@ -352,11 +503,103 @@ CUDA_CALLABLE inline void adj_volume_sample_grad_f(
     adj_uvw[2] += adj_grad[0] * dfdxdz + adj_grad[1] * dfdydz;
 }
 
-CUDA_CALLABLE inline float volume_lookup_f(uint64_t id, int32_t i, int32_t j, int32_t k)
+CUDA_CALLABLE inline void adj_volume_sample_grad_f(
+    uint64_t id, vec3 uvw, int sampling_mode, vec3& grad, uint64_t& adj_id, vec3& adj_uvw, int& adj_sampling_mode, vec3& adj_grad, const float& adj_ret)
 {
-    if (volume::get_grid_type(volume::id_to_buffer(id)) != PNANOVDB_GRID_TYPE_FLOAT) return 0.f;
+    volume_accessor_t acc = volume_accessor(id);
+    volume_accessor_t adj_acc;
+    adj_volume_sample_grad_f(acc, uvw, sampling_mode, grad, adj_acc, adj_uvw, adj_sampling_mode, adj_grad, adj_ret);
+}
+
+template<typename T>
+CUDA_CALLABLE inline T volume_lookup(volume_accessor_t& acc, int32_t i, int32_t j, int32_t k)
+{
+    const pnanovdb_coord_t ijk{ i, j, k };
+    T val;
+    volume_read(val, acc, ijk);
+    return val;
+}
+
+CUDA_CALLABLE inline float volume_lookup_f(volume_accessor_t& acc, int32_t i, int32_t j, int32_t k)
+{
+    if (!volume::is_float_grid(acc.grid_type)) return 0.f;
+    return volume_lookup<float>(acc, i, j, k);
+}
 
+CUDA_CALLABLE inline int32_t volume_lookup_i(volume_accessor_t& acc, int32_t i, int32_t j, int32_t k)
+{
+    if (acc.grid_type != PNANOVDB_GRID_TYPE_INT32) return 0;
+    return volume_lookup<int32_t>(acc, i, j, k);
+}
+
+CUDA_CALLABLE inline vec3 volume_lookup_v(volume_accessor_t& acc, int32_t i, int32_t j, int32_t k)
+{
+    if (acc.grid_type != PNANOVDB_GRID_TYPE_VEC3F) return vec3(0.f);
+    return volume_lookup<vec3>(acc, i, j, k);
+}
+
+CUDA_CALLABLE inline void adj_volume_lookup_f(
+    volume_accessor_t& acc, int32_t i, int32_t j, int32_t k, volume_accessor_t& adj_acc, int32_t& adj_i, int32_t& adj_j, int32_t& adj_k, const float& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline void adj_volume_lookup_i(
+    volume_accessor_t& acc, int32_t i, int32_t j, int32_t k, volume_accessor_t& adj_acc, int32_t& adj_i, int32_t& adj_j, int32_t& adj_k, const int32_t& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline void adj_volume_lookup_v(
+    volume_accessor_t& acc, int32_t i, int32_t j, int32_t k, volume_accessor_t& adj_acc, int32_t& adj_i, int32_t& adj_j, int32_t& adj_k, const vec3& adj_ret)
+{
+    // NOP
+}
+
+// Values of the 2x2x2 voxels ijk + {0, 1}^3, index (di*2 + dj)*2 + dk, i.e. the corners of a trilinear cell
+CUDA_CALLABLE inline vec_t<8, float32> volume_lookup_stencil2_f(volume_accessor_t& acc, int32_t i, int32_t j, int32_t k)
+{
+    vec_t<8, float32> values;
+    if (volume::is_float_grid(acc.grid_type))
+        volume_read_stencil<2>(acc, pnanovdb_coord_t{ i, j, k }, values.c);
+    return values;
+}
+
+// Values of the 3x3x3 voxels ijk + {-1, 0, 1}^3, index ((di + 1)*3 + dj + 1)*3 + dk + 1
+CUDA_CALLABLE inline vec_t<27, float32> volume_lookup_stencil3_f(volume_accessor_t& acc, int32_t i, int32_t j, int32_t k)
+{
+    vec_t<27, float32> values;
+    if (volume::is_float_grid(acc.grid_type))
+        volume_read_stencil<3>(acc, pnanovdb_coord_t{ i - 1, j - 1, k - 1 }, values.c);
+    return values;
+}
+
+CUDA_CALLABLE inline void adj_volume_lookup_stencil2_f(
+    volume_accessor_t& acc, int32_t i, int32_t j, int32_t k, volume_accessor_t& adj_acc, int32_t& adj_i, int32_t& adj_j, int32_t& adj_k, const vec_t<8, float32>& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline void adj_volume_lookup_stencil3_f(
+    volume_accessor_t& acc, int32_t i, int32_t j, int32_t k, volume_accessor_t& adj_acc, int32_t& adj_i, int32_t& adj_j, int32_t& adj_k, const vec_t<27, float32>& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline float volume_lookup_f(uint64_t id, int32_t i, int32_t j, int32_t k)
+{
     const pnanovdb_buf_t buf = volume::id_to_buffer(id);
+    const pnanovdb_uint32_t grid_type = volume::get_grid_type(buf);
+
+    if (grid_type != PNANOVDB_GRID_TYPE_FLOAT)
+    {
+        if (!volume::is_float_grid(grid_type)) return 0.f;
+
+        // quantized values are decoded from the leaf node cached by the accessor
+        volume_accessor_t acc = volume_accessor(id);
+        return volume_lookup<float>(acc, i, j, k);
+    }
+
     const pnanovdb_root_handle_t root = volume::get_root(buf);
 
     const pnanovdb_coord_t ijk{ i, j, k };
@@ -535,4 +778,306 @@ CUDA_CALLABLE inline void adj_volume_world_to_index_dir(uint64_t id, vec3 xyz, u
     adj_volume_world_to_index(id, xyz, adj_id, adj_xyz, adj_ret);
 }
 
+namespace volume
+{
+// Hierarchical DDA (Museth 2014), steps a ray through the cells of the tree where the size of the current cell is
+// the extent of the node or tile containing it, so empty space is crossed one upper, lower or leaf node at a time
+// and only the leaf nodes along the ray are walked voxel by voxel. Positions are shifted by half a voxel so that
+// cell [i, i + 1) holds voxel i, matching the rounding of volume::CLOSEST sampling.
+struct hdda
+{
+    vec3 origin;
+    vec3 dir;
+
+    float tmin;
+    float tmax;
+
+    int dim;
+    pnanovdb_coord_t voxel;
+    pnanovdb_coord_t step;
+    vec3 delta;
+    vec3 next;
+
+    CUDA_CALLABLE hdda(const vec3& ray_origin, const vec3& ray_dir)
+    : origin(ray_origin + vec3(0.5f)), dir(ray_dir) {}
+
+    // clips [t0, t1] to the index bounding box of the volume, returns false if the ray misses it
+    CUDA_CALLABLE bool clip(const volume_accessor_t& acc, float t0, float t1)
+    {
+        const pnanovdb_coord_t lo = pnanovdb_root_get_bbox_min(acc.buf, acc.accessor.root);
+        const pnanovdb_coord_t hi = pnanovdb_root_get_bbox_max(acc.buf, acc.accessor.root);
+        const int lo_c[3] = { lo.x, lo.y, lo.z };
+        const int hi_c[3] = { hi.x, hi.y, hi.z };
+
+        for (int i=0; i < 3; ++i)
+        {
+            if (dir[i] == 0.f)
+            {
+                if (origin[i] < float(lo_c[i]) || origin[i] > float(hi_c[i] + 1))
+                    return false;
+                continue;
+            }
+
+            const float inv = 1.f/dir[i];
+            float tlo = (float(lo_c[i]) - origin[i])*inv;
+            float thi = (float(hi_c[i] + 1) - origin[i])*inv;
+            if (tlo > thi)
+            {
+                const float tmp = tlo; tlo = thi; thi = tmp;
+            }
+            t0 = max(t0, tlo);
+            t1 = min(t1, thi);
+        }
+
+        tmin = t0;
+        tmax = t1;
+        return t0 <= t1;
+    }
+
+    // coordinates of the voxel the ray is in just after tmin, kept inside the current cell when there is one
+    CUDA_CALLABLE pnanovdb_coord_t voxel_at_tmin(bool in_cell) const
+    {
+        const float t = tmin + 1.0e-4f*max(1.f, fabsf(tmin));
+        const int p[3] = { int(floorf(origin[0] + dir[0]*t)), int(floorf(origin[1] + dir[1]*t)), int(floorf(origin[2] + dir[2]*t)) };
+        if (!in_cell)
+            return { p[0], p[1], p[2] };
+
+        const int c[3] = { voxel.x, voxel.y, voxel.z };
+        int q[3];
+        for (int i=0; i < 3; ++i)
+            q[i] = p[i] < c[i] ? c[i] : (p[i] > c[i] + dim - 1 ? c[i] + dim - 1 : p[i]);
+        return { q[0], q[1], q[2] };
+    }
+
+    // moves to a cell of size cell_dim containing ijk, recomputing the parametric distance to its faces
+    CUDA_CALLABLE void set_cell(const pnanovdb_coord_t& ijk, int cell_dim)
+    {
+        dim = cell_dim;
+        voxel = { ijk.x & ~(cell_dim - 1), ijk.y & ~(cell_dim - 1), ijk.z & ~(cell_dim - 1) };
+
+        const vec3 pos = origin + dir*tmin;
+        const int c[3] = { voxel.x, voxel.y, voxel.z };
+        int s[3];
+
+        for (int i=0; i < 3; ++i)
+        {
+            if (dir[i] == 0.f)
+            {
+                s[i] = 0;
+                next[i] = FLT_MAX;
+                delta[i] = 0.f;
+            }
+            else if (dir[i] > 0.f)
+            {
+                s[i] = 1;
+                next[i] = tmin + (float(c[i] + cell_dim) - pos[i])/dir[i];
+                delta[i] = 1.f/dir[i];
+            }
+            else
+            {
+                s[i] = -1;
+                next[i] = tmin + (float(c[i]) - pos[i])/dir[i];
+                delta[i] = -1.f/dir[i];
+            }
+        }
+
+        step = { s[0], s[1], s[2] };
+    }
+
+    // parametric distance at which the ray leaves the current cell
+    CUDA_CALLABLE float t_exit() const
+    {
+        return min(next[0], min(next[1], next[2]));
+    }
+
+    // advances to the neighboring cell of the same size, returns false once past tmax
+    CUDA_CALLABLE bool advance()
+    {
+        const int axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+        tmin = next[axis];
+        next[axis] += float(dim)*delta[axis];
+
+        if (axis == 0) voxel.x += dim*step.x;
+        else if (axis == 1) voxel.y += dim*step.y;
+        else voxel.z += dim*step.z;
+
+        return tmin <= tmax;
+    }
+
+    // enters the cell of the tree node or tile containing the ray at tmin, returns its voxel coordinates
+    CUDA_CALLABLE pnanovdb_coord_t descend(volume_accessor_t& acc, bool in_cell)
+    {
+        const pnanovdb_coord_t ijk = voxel_at_tmin(in_cell);
+        const int cell_dim = int(pnanovdb_readaccessor_get_dim(acc.grid_type, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk)));
+        if (!in_cell || cell_dim != dim)
+            set_cell(ijk, cell_dim);
+        return ijk;
+    }
+};
+} // namespace volume
+
+// Finds the first zero crossing of a float volume along the index-space ray origin + t*dir with t in [tmin, tmax],
+// relative to the first voxel on the ray. Inactive voxels and tiles are skipped without being read. The hit is
+// interpolated linearly between consecutive active voxels, value returns the voxel value just past the crossing.
+CUDA_CALLABLE inline bool volume_query_ray(uint64_t id, const vec3& origin, const vec3& dir, float tmin, float tmax, float& t, float& value)
+{
+    volume_accessor_t acc = volume_accessor(id);
+    if (!volume::is_float_grid(acc.grid_type))
+        return false;
+
+    volume::hdda ray(origin, dir);
+    if (!ray.clip(acc, tmin, tmax))
+        return false;
+
+    pnanovdb_coord_t ijk = ray.descend(acc, false);
+
+    float v0;
+    volume_read(v0, acc, ijk);
+
+    // last active voxel sample, and the ray parameter of the middle of its segment
+    bool prev_valid = false;
+    float prev_v = 0.f;
+    float prev_t = 0.f;
+
+    for (;;)
+    {
+        if (ray.dim == 1 && pnanovdb_readaccessor_is_active(acc.grid_type, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk)))
+        {
+            float v;
+            volume_read(v, acc, ijk);
+
+            const float t_mid = 0.5f*(ray.tmin + min(ray.t_exit(), ray.tmax));
+
+            if (v*v0 < 0.f)
+            {
+                t = ray.tmin;
+                if (prev_valid && prev_v != v)
+                    t = prev_t + (t_mid - prev_t)*prev_v/(prev_v - v);
+
+                value = v;
+                return true;
+            }
+
+            prev_valid = true;
+            prev_v = v;
+            prev_t = t_mid;
+        }
+        else
+        {
+            prev_valid = false;
+        }
+
+        if (!ray.advance())
+            break;
+
+        ijk = ray.descend(acc, true);
+    }
+
+    return false;
+}
+
+// Finds the first span [t0, t1] of the index-space ray origin + t*dir within [tmin, tmax] that lies in active voxels
+// or active tiles of the volume, stepping over inactive regions one tree node at a time. Rendering loops can march
+// each span with volume_sample() and continue the query from t1.
+CUDA_CALLABLE inline bool volume_query_ray_span(uint64_t id, const vec3& origin, const vec3& dir, float tmin, float tmax, float& t0, float& t1)
+{
+    volume_accessor_t acc = volume_accessor(id);
+
+    volume::hdda ray(origin, dir);
+    if (!ray.clip(acc, tmin, tmax))
+        return false;
+
+    pnanovdb_coord_t ijk = ray.descend(acc, false);
+    bool inside = false;
+
+    for (;;)
+    {
+        const bool active = pnanovdb_readaccessor_is_active(acc.grid_type, acc.buf, PNANOVDB_REF(acc.accessor), PNANOVDB_REF(ijk));
+
+        if (active && !inside)
+        {
+            inside = true;
+            t0 = ray.tmin;
+        }
+        else if (!active && inside)
+        {
+            t1 = ray.tmin;
+            return true;
+        }
+
+        if (!ray.advance())
+            break;
+
+        ijk = ray.descend(acc, true);
+    }
+
+    if (inside)
+        t1 = ray.tmax;
+
+    return inside;
+}
+
+CUDA_CALLABLE inline void adj_volume_query_ray(
+    uint64_t id, const vec3& origin, const vec3& dir, float tmin, float tmax, float& t, float& value,
+    uint64_t& adj_id, vec3& adj_origin, vec3& adj_dir, float& adj_tmin, float& adj_tmax, float& adj_t, float& adj_value, const bool& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline void adj_volume_query_ray_span(
+    uint64_t id, const vec3& origin, const vec3& dir, float tmin, float tmax, float& t0, float& t1,
+    uint64_t& adj_id, vec3& adj_origin, vec3& adj_dir, float& adj_tmin, float& adj_tmax, float& adj_t0, float& adj_t1, const bool& adj_ret)
+{
+    // NOP
+}
+
+// A volume atlas packs several grids into a single buffer, which starts with the number of grids followed by the
+// byte offset of each grid from the start of the buffer. The id of a grid is the address of its first byte.
+CUDA_CALLABLE inline uint64_t volume_atlas_get(uint64_t atlas, int32_t index)
+{
+    const uint64_t* table = (const uint64_t*)atlas;
+    assert(index >= 0 && uint64_t(index) < table[0]);
+    return atlas + table[1 + index];
+}
+
+CUDA_CALLABLE inline void adj_volume_atlas_get(uint64_t atlas, int32_t index, uint64_t& adj_atlas, int32_t& adj_index, const uint64_t& adj_ret)
+{
+    // NOP
+}
+
+CUDA_CALLABLE inline float volume_sample_f(uint64_t atlas, int32_t index, vec3 uvw, int sampling_mode)
+{
+    return volume_sample_f(volume_atlas_get(atlas, index), uvw, sampling_mode);
+}
+
+CUDA_CALLABLE inline void adj_volume_sample_f(
+    uint64_t atlas, int32_t index, vec3 uvw, int sampling_mode, uint64_t& adj_atlas, int32_t& adj_index, vec3& adj_uvw, int& adj_sampling_mode, const float& adj_ret)
+{
+    uint64_t adj_id;
+    adj_volume_sample_f(volume_atlas_get(atlas, index), uvw, sampling_mode, adj_id, adj_uvw, adj_sampling_mode, adj_ret);
+}
+
+CUDA_CALLABLE inline float volume_sample_grad_f(uint64_t atlas, int32_t index, vec3 uvw, int sampling_mode, vec3& grad)
+{
+    return volume_sample_grad_f(volume_atlas_get(atlas, index), uvw, sampling_mode, grad);
+}
+
+CUDA_CALLABLE inline void adj_volume_sample_grad_f(
+    uint64_t atlas, int32_t index, vec3 uvw, int sampling_mode, vec3& grad, uint64_t& adj_atlas, int32_t& adj_index, vec3& adj_uvw, int& adj_sampling_mode, vec3& adj_grad, const float& adj_ret)
+{
+    uint64_t adj_id;
+    adj_volume_sample_grad_f(volume_atlas_get(atlas, index), uvw, sampling_mode, grad, adj_id, adj_uvw, adj_sampling_mode, adj_grad, adj_ret);
+}
+
+CUDA_CALLABLE inline float volume_lookup_f(uint64_t atlas, int32_t index, int32_t i, int32_t j, int32_t k)
+{
+    return volume_lookup_f(volume_atlas_get(atlas, index), i, j, k);
+}
+
+CUDA_CALLABLE inline void adj_volume_lookup_f(
+    uint64_t atlas, int32_t index, int32_t i, int32_t j, int32_t k, uint64_t& adj_atlas, int32_t& adj_index, int32_t& adj_i, int32_t& adj_j, int32_t& adj_k, const float& adj_ret)
+{
+    // NOP
+}
+
 } // namespace wp
@@ -1,4 +1,6 @@
 #include "volume_builder.h"
+#include "memory_stats.h"
+#include "mesh.h"
 
 #include <cuda.h>
 #include <cuda_runtime_api.h>
@@ -23,6 +25,38 @@
 //
 // upper_key (36 bits) == lower_key >> 15 == leaf_key >> 27 == tile key
 
+// CUB's caching allocator, the blocks in use are accounted to the "volume" memory tag
+struct VolumeTempAllocator
+{
+    cub::CachingDeviceAllocator allocator;
+
+    cudaError_t DeviceAllocate(void** ptr, size_t size)
+    {
+        ScopedMemoryTag tag("volume");
+
+        const cudaError_t result = allocator.DeviceAllocate(ptr, size);
+        if (result == cudaSuccess)
+            memory_stats_record_device_alloc(WP_CURRENT_CONTEXT, *ptr, size);
+        return result;
+    }
+
+    cudaError_t DeviceFree(void* ptr)
+    {
+        memory_stats_record_free(ptr);
+        return allocator.DeviceFree(ptr);
+    }
+};
+
+// the grids are returned to volume.cpp which releases them with free_device()
+template <typename GridData>
+void alloc_volume_grid(GridData*& grid, size_t size)
+{
+    ScopedMemoryTag tag("volume");
+
+    check_cuda(cudaMalloc(&grid, size));
+    memory_stats_record_device_alloc(WP_CURRENT_CONTEXT, grid, size);
+}
+
 CUDA_CALLABLE inline uint64_t coord_to_full_key(const nanovdb::Coord& ijk) 
 {
     using Tree = nanovdb::FloatTree; // any type is fine at this point
@@ -149,7 +183,7 @@ void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
     out_grid = nullptr;
     out_grid_size = 0;
 
-    cub::CachingDeviceAllocator allocator;
+    VolumeTempAllocator allocator;
     
     uint64_t* leaf_keys;
     uint64_t* lower_keys;
@@ -178,10 +212,26 @@ void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
         void*  d_temp_storage = nullptr;
         size_t temp_storage_bytes;
 
+        // Only sort the bits up to the largest key, points close to the positive octant need far fewer than 63
+        uint64_t* max_key;
+        allocator.DeviceAllocate((void**)&max_key, sizeof(uint64_t));
+        cub::DeviceReduce::Max(nullptr, temp_storage_bytes, all_leaf_keys, max_key, static_cast<int>(num_points));
+        allocator.DeviceAllocate((void**)&d_temp_storage, temp_storage_bytes);
+        cub::DeviceReduce::Max(d_temp_storage, temp_storage_bytes, all_leaf_keys, max_key, static_cast<int>(num_points));
+        allocator.DeviceFree(d_temp_storage);
+
+        uint64_t host_max_key;
+        check_cuda(cudaMemcpy(&host_max_key, max_key, sizeof(uint64_t), cudaMemcpyDeviceToHost));
+        allocator.DeviceFree(max_key);
+
+        int end_bit = 1;
+        while (end_bit < 63 && (host_max_key >> end_bit))
+            ++end_bit;
+
         // Sort the keys, then get an array of unique keys
-        cub::DeviceRadixSort::SortKeys(nullptr, temp_storage_bytes, all_leaf_keys, all_leaf_keys_sorted, static_cast<int>(num_points), /* begin_bit = */ 0, /* end_bit = */ 63);
+        cub::DeviceRadixSort::SortKeys(nullptr, temp_storage_bytes, all_leaf_keys, all_leaf_keys_sorted, static_cast<int>(num_points), /* begin_bit = */ 0, end_bit);
         allocator.DeviceAllocate((void**)&d_temp_storage, temp_storage_bytes);
-        cub::DeviceRadixSort::SortKeys(d_temp_storage, temp_storage_bytes, all_leaf_keys, all_leaf_keys_sorted, static_cast<int>(num_points), /* begin_bit = */ 0, /* end_bit = */ 63);
+        cub::DeviceRadixSort::SortKeys(d_temp_storage, temp_storage_bytes, all_leaf_keys, all_leaf_keys_sorted, static_cast<int>(num_points), /* begin_bit = */ 0, end_bit);
         allocator.DeviceFree(d_temp_storage);
 
         cub::DeviceSelect::Unique(nullptr, temp_storage_bytes, all_leaf_keys_sorted, leaf_keys, node_counts, static_cast<int>(num_points));
@@ -232,7 +282,7 @@ void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
     const int64_t leaf_mem_offset = lower_mem_offset + sizeof(typename Tree::Node1) * lower_node_count;
 
     typename Grid::DataType* grid;
-    check_cuda(cudaMalloc(&grid, total_bytes));
+    alloc_volume_grid(grid, total_bytes);
 
     typename Tree::DataType* const tree = reinterpret_cast<typename Tree::DataType*>(grid + 1); // The tree is immediately after the grid
     typename Tree::RootType::DataType* const root = reinterpret_cast<typename Tree::RootType::DataType*>(tree + 1); // The root is immediately after the tree
@@ -423,3 +473,492 @@ void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
 template void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<float>>*&, size_t&, const void*, size_t, bool, const BuildGridParams<float>&);
 template void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<nanovdb::Vec3f>>*&, size_t&, const void*, size_t, bool, const BuildGridParams<nanovdb::Vec3f>&);
 template void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<int32_t>>*&, size_t&, const void*, size_t, bool, const BuildGridParams<int32_t>&);
+
+
+// --- Builders on top of build_grid_from_tiles ---
+
+// Sets every voxel of the leaf nodes of the grid to f(ijk)
+template <typename BuildT, typename Func>
+void set_leaf_values(nanovdb::Grid<nanovdb::NanoTree<BuildT>>* grid, Func f)
+{
+    using Tree = nanovdb::NanoTree<BuildT>;
+    using LeafT = typename Tree::Node0;
+
+    const typename Tree::DataType* tree = reinterpret_cast<const typename Tree::DataType*>(reinterpret_cast<const nanovdb::GridData*>(grid) + 1);
+
+    uint32_t leaf_count;
+    check_cuda(cudaMemcpy(&leaf_count, &tree->mNodeCount[0], sizeof(uint32_t), cudaMemcpyDeviceToHost));
+
+    const size_t num_voxels = size_t(leaf_count) * LeafT::SIZE;
+    const unsigned int num_threads = 256;
+    const unsigned int num_blocks = static_cast<unsigned int>((num_voxels + num_threads - 1) / num_threads);
+
+    kernel<<<num_blocks, num_threads>>>(num_voxels, [=] __device__(size_t i) {
+        LeafT* leaf = grid->tree().template getFirstNode<0>() + i / LeafT::SIZE;
+        const uint32_t offset = static_cast<uint32_t>(i % LeafT::SIZE);
+        leaf->setValueOnly(offset, f(leaf->offsetToGlobalCoord(offset)));
+    });
+}
+
+CUDA_CALLABLE_DEVICE inline bool differs_from_background(float value, float background, float tolerance)
+{
+    return fabsf(value - background) > tolerance;
+}
+
+CUDA_CALLABLE_DEVICE inline bool differs_from_background(int32_t value, int32_t background, float tolerance)
+{
+    return float(abs(value - background)) > tolerance;
+}
+
+CUDA_CALLABLE_DEVICE inline bool differs_from_background(const nanovdb::Vec3f& value, const nanovdb::Vec3f& background, float tolerance)
+{
+    return (value - background).length() > tolerance;
+}
+
+template <typename BuildT>
+void build_grid_from_dense(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
+                           size_t &out_grid_size,
+                           const BuildT *values,
+                           int nx, int ny, int nz,
+                           float tolerance,
+                           const BuildGridParams<BuildT> &params)
+{
+    const BuildT background_value = params.background_value;
+
+    const int tiles_x = (nx + 7) / 8;
+    const int tiles_y = (ny + 7) / 8;
+    const int tiles_z = (nz + 7) / 8;
+    const size_t num_tiles = size_t(tiles_x) * tiles_y * tiles_z;
+    const size_t num_values = size_t(nx) * ny * nz;
+
+    const unsigned int num_threads = 256;
+    unsigned int num_blocks;
+
+    VolumeTempAllocator allocator;
+
+    uint32_t* tile_flags;
+    nanovdb::Coord* tile_points;
+    uint32_t* tile_count;
+    allocator.DeviceAllocate((void**)&tile_flags, sizeof(uint32_t) * num_tiles);
+    allocator.DeviceAllocate((void**)&tile_points, sizeof(nanovdb::Coord) * num_tiles);
+    allocator.DeviceAllocate((void**)&tile_count, sizeof(uint32_t));
+    check_cuda(cudaMemset(tile_flags, 0, sizeof(uint32_t) * num_tiles));
+    check_cuda(cudaMemset(tile_count, 0, sizeof(uint32_t)));
+
+    // Flag the tiles holding at least one value that is not background
+    num_blocks = static_cast<unsigned int>((num_values + num_threads - 1) / num_threads);
+    kernel<<<num_blocks, num_threads>>>(num_values, [=] __device__(size_t i) {
+        if (differs_from_background(values[i], background_value, tolerance)) {
+            const int k = static_cast<int>(i % nz);
+            const int j = static_cast<int>((i / nz) % ny);
+            const int t = static_cast<int>(i / (size_t(ny) * nz));
+            tile_flags[(size_t(t / 8) * tiles_y + j / 8) * tiles_z + k / 8] = 1;
+        }
+    });
+
+    // Compact the flagged tiles to their origins, the order does not matter as the builder sorts them
+    num_blocks = static_cast<unsigned int>((num_tiles + num_threads - 1) / num_threads);
+    kernel<<<num_blocks, num_threads>>>(num_tiles, [=] __device__(size_t i) {
+        if (tile_flags[i]) {
+            const int k = static_cast<int>(i % tiles_z);
+            const int j = static_cast<int>((i / tiles_z) % tiles_y);
+            const int t = static_cast<int>(i / (size_t(tiles_y) * tiles_z));
+            tile_points[atomicAdd(tile_count, 1u)] = nanovdb::Coord(t * 8, j * 8, k * 8);
+        }
+    });
+
+    uint32_t num_points;
+    check_cuda(cudaMemcpy(&num_points, tile_count, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+
+    // Keep the tile at the origin for arrays without any active value so that the grid is valid
+    if (num_points == 0) {
+        check_cuda(cudaMemset(tile_points, 0, sizeof(nanovdb::Coord)));
+        num_points = 1;
+    }
+
+    build_grid_from_tiles(out_grid, out_grid_size, tile_points, num_points, false, params);
+
+    // Voxels of the allocated tiles that lie outside of the array receive the background value
+    set_leaf_values(out_grid, [=] __device__(const nanovdb::Coord& ijk) {
+        if (ijk[0] < nx && ijk[1] < ny && ijk[2] < nz)
+            return values[(size_t(ijk[0]) * ny + ijk[1]) * nz + ijk[2]];
+        else
+            return background_value;
+    });
+
+    check_cuda(cudaDeviceSynchronize());
+
+    allocator.DeviceFree(tile_flags);
+    allocator.DeviceFree(tile_points);
+    allocator.DeviceFree(tile_count);
+}
+
+template void build_grid_from_dense(nanovdb::Grid<nanovdb::NanoTree<float>>*&, size_t&, const float*, int, int, int, float, const BuildGridParams<float>&);
+template void build_grid_from_dense(nanovdb::Grid<nanovdb::NanoTree<nanovdb::Vec3f>>*&, size_t&, const nanovdb::Vec3f*, int, int, int, float, const BuildGridParams<nanovdb::Vec3f>&);
+template void build_grid_from_dense(nanovdb::Grid<nanovdb::NanoTree<int32_t>>*&, size_t&, const int32_t*, int, int, int, float, const BuildGridParams<int32_t>&);
+
+void build_sdf_grid_from_mesh(nanovdb::Grid<nanovdb::NanoTree<float>> *&out_grid,
+                              size_t &out_grid_size,
+                              uint64_t mesh,
+                              const nanovdb::Vec3f *points,
+                              const int *indices,
+                              int num_tris,
+                              float narrow_band,
+                              const BuildGridParams<float> &params)
+{
+    const float dx = static_cast<float>(params.voxel_size);
+    const nanovdb::Vec3f translation(params.translation);
+
+    const unsigned int num_threads = 256;
+    unsigned int num_blocks = (static_cast<unsigned int>(num_tris) + num_threads - 1) / num_threads;
+
+    VolumeTempAllocator allocator;
+
+    // Range of tiles overlapping the bounds of a triangle grown by the narrow band
+    auto tile_range = [=] __device__(int tri, nanovdb::Coord& lower, nanovdb::Coord& upper) {
+        const nanovdb::Vec3f p = points[indices[tri * 3 + 0]];
+        const nanovdb::Vec3f q = points[indices[tri * 3 + 1]];
+        const nanovdb::Vec3f r = points[indices[tri * 3 + 2]];
+
+        const float tile_size = 8.0f * dx;
+        for (int c = 0; c < 3; ++c) {
+            const float lo = fminf(p[c], fminf(q[c], r[c])) - narrow_band - translation[c];
+            const float hi = fmaxf(p[c], fmaxf(q[c], r[c])) + narrow_band - translation[c];
+            lower[c] = static_cast<int>(floorf(lo / tile_size));
+            upper[c] = static_cast<int>(floorf(hi / tile_size));
+        }
+    };
+
+    uint32_t* tile_counts;
+    uint32_t* tile_offsets;
+    allocator.DeviceAllocate((void**)&tile_counts, sizeof(uint32_t) * num_tris);
+    allocator.DeviceAllocate((void**)&tile_offsets, sizeof(uint32_t) * num_tris);
+
+    kernel<<<num_blocks, num_threads>>>(num_tris, [=] __device__(size_t i) {
+        nanovdb::Coord lower, upper;
+        tile_range(static_cast<int>(i), lower, upper);
+        tile_counts[i] = (upper[0] - lower[0] + 1) * (upper[1] - lower[1] + 1) * (upper[2] - lower[2] + 1);
+    });
+
+    void*  d_temp_storage = nullptr;
+    size_t temp_storage_bytes;
+    cub::DeviceScan::ExclusiveSum(nullptr, temp_storage_bytes, tile_counts, tile_offsets, num_tris);
+    allocator.DeviceAllocate((void**)&d_temp_storage, temp_storage_bytes);
+    cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes, tile_counts, tile_offsets, num_tris);
+    allocator.DeviceFree(d_temp_storage);
+
+    uint32_t last_count, last_offset;
+    check_cuda(cudaMemcpy(&last_count, tile_counts + num_tris - 1, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    check_cuda(cudaMemcpy(&last_offset, tile_offsets + num_tris - 1, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    const size_t num_points = size_t(last_count) + last_offset;
+
+    // Emit the tiles of every triangle, duplicates are removed by the builder
+    nanovdb::Coord* tile_points;
+    allocator.DeviceAllocate((void**)&tile_points, sizeof(nanovdb::Coord) * num_points);
+
+    kernel<<<num_blocks, num_threads>>>(num_tris, [=] __device__(size_t i) {
+        nanovdb::Coord lower, upper;
+        tile_range(static_cast<int>(i), lower, upper);
+
+        nanovdb::Coord* out = tile_points + tile_offsets[i];
+        for (int x = lower[0]; x <= upper[0]; ++x)
+            for (int y = lower[1]; y <= upper[1]; ++y)
+                for (int z = lower[2]; z <= upper[2]; ++z)
+                    *out++ = nanovdb::Coord(x * 8, y * 8, z * 8);
+    });
+
+    build_grid_from_tiles(out_grid, out_grid_size, tile_points, num_points, false, params);
+
+    // Voxels of the tiles may be farther than the narrow band from the mesh, so the closest point
+    // query is unbounded to always obtain the sign from the winding number
+    set_leaf_values(out_grid, [=] __device__(const nanovdb::Coord& ijk) {
+        const wp::vec3 p(ijk[0] * dx + translation[0], ijk[1] * dx + translation[1], ijk[2] * dx + translation[2]);
+
+        float inside, u, v;
+        int face;
+        if (!wp::mesh_query_point_sign_winding_number(mesh, p, FLT_MAX, inside, face, u, v, 2.0f, 0.5f))
+            return narrow_band;
+
+        const float d = wp::length(p - wp::mesh_eval_position(mesh, face, u, v));
+        return inside * fminf(d, narrow_band);
+    });
+
+    check_cuda(cudaDeviceSynchronize());
+
+    allocator.DeviceFree(tile_counts);
+    allocator.DeviceFree(tile_offsets);
+    allocator.DeviceFree(tile_points);
+}
+
+// --- Topology edits of existing grids ---
+
+template <typename BuildT>
+void build_grid_with_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
+                           size_t &out_grid_size,
+                           const nanovdb::Grid<nanovdb::NanoTree<BuildT>> *grid,
+                           const void *points,
+                           size_t num_points,
+                           bool points_in_world_space,
+                           int dilation,
+                           float prune_tolerance)
+{
+    using Tree = nanovdb::NanoTree<BuildT>;
+    using LeafT = typename Tree::Node0;
+
+    // The builder is set up from the metadata of the grid, read back to the host
+    nanovdb::GridData grid_data;
+    typename Tree::DataType tree_data;
+    check_cuda(cudaMemcpy(&grid_data, grid, sizeof(nanovdb::GridData), cudaMemcpyDeviceToHost));
+    check_cuda(cudaMemcpy(&tree_data, reinterpret_cast<const nanovdb::GridData*>(grid) + 1, sizeof(tree_data), cudaMemcpyDeviceToHost));
+
+    const typename Tree::RootType::DataType* root = nanovdb::PtrAdd<typename Tree::RootType::DataType>(
+        reinterpret_cast<const nanovdb::GridData*>(grid) + 1, tree_data.mNodeOffset[3]);
+
+    BuildGridParams<BuildT> params;
+    params.voxel_size = grid_data.mVoxelSize[0];
+    params.translation = nanovdb::Vec3d(grid_data.mMap.mVecD[0], grid_data.mMap.mVecD[1], grid_data.mMap.mVecD[2]);
+    check_cuda(cudaMemcpy(&params.background_value, &root->mBackground, sizeof(BuildT), cudaMemcpyDeviceToHost));
+    memcpy(params.name, grid_data.mGridName, sizeof(params.name));
+
+    const BuildT background_value = params.background_value;
+    const uint32_t leaf_count = tree_data.mNodeCount[0];
+
+    // Dilating by n voxels reaches the tiles up to ceil(n / 8) tiles away in every direction
+    const int r = dilation > 0 ? (dilation + LeafT::DIM - 1) / LeafT::DIM : 0;
+    const int w = 2 * r + 1;
+    const size_t stencil_size = size_t(w) * w * w;
+    const size_t max_points = size_t(leaf_count) * stencil_size + num_points + 1;
+
+    const unsigned int num_threads = 256;
+    unsigned int num_blocks;
+
+    VolumeTempAllocator allocator;
+
+    uint8_t* leaf_flags;
+    nanovdb::Coord* tile_points;
+    uint32_t* tile_count;
+    allocator.DeviceAllocate((void**)&leaf_flags, sizeof(uint8_t) * leaf_count);
+    allocator.DeviceAllocate((void**)&tile_points, sizeof(nanovdb::Coord) * max_points);
+    allocator.DeviceAllocate((void**)&tile_count, sizeof(uint32_t));
+    check_cuda(cudaMemset(tile_count, 0, sizeof(uint32_t)));
+
+    // Flag the leaves to keep, pruning drops those whose voxels are all within the tolerance of the background
+    if (prune_tolerance >= 0.0f) {
+        check_cuda(cudaMemset(leaf_flags, 0, sizeof(uint8_t) * leaf_count));
+
+        const size_t num_voxels = size_t(leaf_count) * LeafT::SIZE;
+        num_blocks = static_cast<unsigned int>((num_voxels + num_threads - 1) / num_threads);
+        kernel<<<num_blocks, num_threads>>>(num_voxels, [=] __device__(size_t i) {
+            const LeafT* leaf = grid->tree().template getFirstNode<0>() + i / LeafT::SIZE;
+            if (differs_from_background(leaf->getValue(static_cast<uint32_t>(i % LeafT::SIZE)), background_value, prune_tolerance))
+                leaf_flags[i / LeafT::SIZE] = 1;
+        });
+    } else {
+        check_cuda(cudaMemset(leaf_flags, 1, sizeof(uint8_t) * leaf_count));
+    }
+
+    // Emit the tiles of the kept leaves and their neighborhoods, duplicates are removed by the builder
+    const size_t num_stencil_points = size_t(leaf_count) * stencil_size;
+    num_blocks = static_cast<unsigned int>((num_stencil_points + num_threads - 1) / num_threads);
+    kernel<<<num_blocks, num_threads>>>(num_stencil_points, [=] __device__(size_t i) {
+        const size_t n = i / stencil_size;
+        if (!leaf_flags[n])
+            return;
+
+        const int s = static_cast<int>(i % stencil_size);
+        const nanovdb::Coord offset((s / (w * w) - r) * LeafT::DIM, ((s / w) % w - r) * LeafT::DIM, (s % w - r) * LeafT::DIM);
+        const LeafT* leaf = grid->tree().template getFirstNode<0>() + n;
+        tile_points[atomicAdd(tile_count, 1u)] = leaf->origin() + offset;
+    });
+
+    // Activate the tiles containing the points, world space points are mapped by the transform of the grid
+    num_blocks = static_cast<unsigned int>((num_points + num_threads - 1) / num_threads);
+    if (num_points) {
+        kernel<<<num_blocks, num_threads>>>(num_points, [=] __device__(size_t i) {
+            const nanovdb::Coord ijk = points_in_world_space
+                ? grid->worldToIndexF(static_cast<const nanovdb::Vec3f*>(points)[i]).round()
+                : static_cast<const nanovdb::Coord*>(points)[i];
+            tile_points[atomicAdd(tile_count, 1u)] = ijk;
+        });
+    }
+
+    uint32_t count;
+    check_cuda(cudaMemcpy(&count, tile_count, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+
+    // Keep the tile at the origin when every tile was pruned so that the grid is valid
+    if (count == 0) {
+        check_cuda(cudaMemset(tile_points, 0, sizeof(nanovdb::Coord)));
+        count = 1;
+    }
+
+    build_grid_from_tiles(out_grid, out_grid_size, tile_points, count, false, params);
+
+    // The builder only supports uniform voxels, keep the exact transform of the grid
+    nanovdb::Grid<nanovdb::NanoTree<BuildT>>* const out = out_grid;
+    kernel<<<1, 1>>>(1, [=] __device__(size_t i) {
+        nanovdb::GridData* data = reinterpret_cast<nanovdb::GridData*>(out);
+        const nanovdb::GridData* src = reinterpret_cast<const nanovdb::GridData*>(grid);
+        const nanovdb::CoordBBox& bbox = out->tree().root().bbox();
+
+        data->mMap = src->mMap;
+        data->mVoxelSize = src->mVoxelSize;
+        data->mGridClass = src->mGridClass;
+        data->mWorldBBox.mCoord[0] = src->mMap.applyMap(nanovdb::Vec3R(bbox.min()));
+        data->mWorldBBox.mCoord[1] = src->mMap.applyMap(nanovdb::Vec3R(bbox.max()));
+    });
+
+    // Voxels keep their values, those of the new tiles receive the background value
+    set_leaf_values(out_grid, [=] __device__(const nanovdb::Coord& ijk) {
+        return grid->tree().getValue(ijk);
+    });
+
+    check_cuda(cudaDeviceSynchronize());
+
+    allocator.DeviceFree(leaf_flags);
+    allocator.DeviceFree(tile_points);
+    allocator.DeviceFree(tile_count);
+}
+
+template void build_grid_with_tiles(nanovdb::Grid<nanovdb::NanoTree<float>>*&, size_t&, const nanovdb::Grid<nanovdb::NanoTree<float>>*, const void*, size_t, bool, int, float);
+template void build_grid_with_tiles(nanovdb::Grid<nanovdb::NanoTree<nanovdb::Vec3f>>*&, size_t&, const nanovdb::Grid<nanovdb::NanoTree<nanovdb::Vec3f>>*, const void*, size_t, bool, int, float);
+template void build_grid_with_tiles(nanovdb::Grid<nanovdb::NanoTree<int32_t>>*&, size_t&, const nanovdb::Grid<nanovdb::NanoTree<int32_t>>*, const void*, size_t, bool, int, float);
+
+// --- Quantization of float grids ---
+
+// Stores code n of a quantized leaf
+template <typename LeafDataT>
+CUDA_CALLABLE_DEVICE inline void set_leaf_code(LeafDataT& leaf, uint32_t n, uint32_t code)
+{
+    leaf.mCode[n] = static_cast<typename LeafDataT::ArrayType>(code);
+}
+
+// Fp4 leaves pack two codes per byte, the low half holding the even one
+template <>
+CUDA_CALLABLE_DEVICE inline void set_leaf_code(nanovdb::NanoLeaf<nanovdb::Fp4>::DataType& leaf, uint32_t n, uint32_t code)
+{
+    uint8_t& c = leaf.mCode[n >> 1];
+    c = (n & 1) ? uint8_t((c & 0x0Fu) | (code << 4)) : uint8_t((c & 0xF0u) | code);
+}
+
+template <typename FpT>
+void build_quantized_grid(nanovdb::Grid<nanovdb::NanoTree<FpT>> *&out_grid,
+                          size_t &out_grid_size,
+                          const nanovdb::FloatGrid *grid)
+{
+    using InTree = nanovdb::FloatTree;
+    using OutTree = nanovdb::NanoTree<FpT>;
+    using InLeaf = typename InTree::Node0::DataType;
+    using OutLeaf = typename OutTree::Node0::DataType;
+    using OutLower = typename OutTree::Node1::DataType;
+
+    // only the leaf nodes differ between both layouts
+    static_assert(sizeof(typename InTree::RootType) == sizeof(typename OutTree::RootType), "Mismatching root node");
+    static_assert(sizeof(typename InTree::RootType::Tile) == sizeof(typename OutTree::RootType::Tile), "Mismatching root tile");
+    static_assert(sizeof(typename InTree::Node2) == sizeof(typename OutTree::Node2), "Mismatching upper node");
+    static_assert(sizeof(typename InTree::Node1) == sizeof(typename OutTree::Node1), "Mismatching lower node");
+
+    out_grid = nullptr;
+    out_grid_size = 0;
+
+    nanovdb::GridData grid_data;
+    typename InTree::DataType tree_data;
+    check_cuda(cudaMemcpy(&grid_data, grid, sizeof(grid_data), cudaMemcpyDeviceToHost));
+    check_cuda(cudaMemcpy(&tree_data, reinterpret_cast<const nanovdb::GridData*>(grid) + 1, sizeof(tree_data), cudaMemcpyDeviceToHost));
+
+    const uint32_t leaf_count = tree_data.mNodeCount[0];
+    const uint32_t lower_count = tree_data.mNodeCount[1];
+    const int64_t leaf_mem_offset = sizeof(nanovdb::GridData) + tree_data.mNodeOffset[0];
+    const int64_t lower_mem_offset = sizeof(nanovdb::GridData) + tree_data.mNodeOffset[1];
+
+    if (grid_data.mGridType != nanovdb::GridType::Float || grid_data.mBlindMetadataCount != 0 || leaf_count == 0 ||
+        leaf_mem_offset + sizeof(InLeaf) * leaf_count != grid_data.mGridSize)
+        return;
+
+    const size_t total_bytes = leaf_mem_offset + sizeof(OutLeaf) * leaf_count;
+
+    nanovdb::GridData* out;
+    alloc_volume_grid(out, total_bytes);
+
+    // The grid, tree, root and internal nodes are copied as is, except for the grid's type and size
+    check_cuda(cudaMemcpy(out, grid, leaf_mem_offset, cudaMemcpyDeviceToDevice));
+
+    grid_data.mChecksum = 0xFFFFFFFFFFFFFFFFull;
+    grid_data.mGridSize = total_bytes;
+    grid_data.mGridType = nanovdb::mapToGridType<FpT>();
+    grid_data.mBlindMetadataOffset = total_bytes;
+    check_cuda(cudaMemcpy(out, &grid_data, sizeof(grid_data), cudaMemcpyHostToDevice));
+
+    const InLeaf* const in_leaves = nanovdb::PtrAdd<InLeaf>(grid, leaf_mem_offset);
+    OutLeaf* const out_leaves = nanovdb::PtrAdd<OutLeaf>(out, leaf_mem_offset);
+    OutLower* const lower_nodes = nanovdb::PtrAdd<OutLower>(out, lower_mem_offset);
+
+    const unsigned int num_threads = 256;
+
+    // Pointing the children of the lower nodes to the smaller leaves
+    {
+        constexpr uint32_t NODE_SIZE = OutTree::Node1::SIZE;
+        const size_t num_items = size_t(lower_count) * NODE_SIZE;
+        const unsigned int num_blocks = static_cast<unsigned int>((num_items + num_threads - 1) / num_threads);
+
+        kernel<<<num_blocks, num_threads>>>(num_items, [=] __device__(size_t i) {
+            const size_t node = i / NODE_SIZE;
+            const uint32_t n = static_cast<uint32_t>(i % NODE_SIZE);
+
+            OutLower& lower = lower_nodes[node];
+            if (!lower.mChildMask.isOn(n))
+                return;
+
+            const int64_t node_offset = lower_mem_offset + int64_t(node * sizeof(OutLower));
+            const int64_t leaf = (node_offset + lower.mTable[n].child - leaf_mem_offset) / int64_t(sizeof(InLeaf));
+            lower.mTable[n].child = leaf_mem_offset + leaf * int64_t(sizeof(OutLeaf)) - node_offset;
+        });
+    }
+
+    // Quantizing the leaves, their codes cover the range of all their values
+    {
+        constexpr uint32_t LEAF_SIZE = OutTree::Node0::SIZE;
+        constexpr uint32_t max_code = (1u << OutLeaf::bitWidth()) - 1u;
+        const unsigned int num_blocks = (leaf_count + num_threads - 1) / num_threads;
+
+        kernel<<<num_blocks, num_threads>>>(leaf_count, [=] __device__(size_t i) {
+            const InLeaf& in = in_leaves[i];
+            OutLeaf& leaf = out_leaves[i];
+
+            float vmin = in.mValues[0];
+            float vmax = in.mValues[0];
+            for (uint32_t n = 1; n < LEAF_SIZE; ++n) {
+                vmin = fminf(vmin, in.mValues[n]);
+                vmax = fmaxf(vmax, in.mValues[n]);
+            }
+
+            leaf.mBBoxMin = in.mBBoxMin;
+            leaf.mBBoxDif[0] = in.mBBoxDif[0];
+            leaf.mBBoxDif[1] = in.mBBoxDif[1];
+            leaf.mBBoxDif[2] = in.mBBoxDif[2];
+            leaf.mFlags = in.mFlags;
+            leaf.mValueMask = in.mValueMask;
+            leaf.mMinimum = vmin;
+            leaf.mQuantum = (vmax - vmin) / float(max_code);
+
+            const float scale = leaf.mQuantum > 0.0f ? 1.0f / leaf.mQuantum : 0.0f;
+            auto encode = [=](float v) { return min(static_cast<uint32_t>((v - vmin) * scale + 0.5f), max_code); };
+
+            for (uint32_t n = 0; n < LEAF_SIZE; ++n)
+                set_leaf_code(leaf, n, encode(in.mValues[n]));
+
+            leaf.mMin = static_cast<uint16_t>(encode(fmaxf(in.mMinimum, vmin)));
+            leaf.mMax = static_cast<uint16_t>(encode(fmaxf(in.mMaximum, vmin)));
+            leaf.mAvg = static_cast<uint16_t>(encode(fmaxf(in.mAverage, vmin)));
+            leaf.mDev = static_cast<uint16_t>(min(static_cast<uint32_t>(fabsf(in.mStdDevi) * scale + 0.5f), max_code));
+        });
+    }
+
+    check_cuda(cudaDeviceSynchronize());
+
+    out_grid = reinterpret_cast<nanovdb::Grid<OutTree>*>(out);
+    out_grid_size = total_bytes;
+}
+
+template void build_quantized_grid(nanovdb::Grid<nanovdb::NanoTree<nanovdb::Fp4>>*&, size_t&, const nanovdb::FloatGrid*);
+template void build_quantized_grid(nanovdb::Grid<nanovdb::NanoTree<nanovdb::Fp8>>*&, size_t&, const nanovdb::FloatGrid*);
+template void build_quantized_grid(nanovdb::Grid<nanovdb::NanoTree<nanovdb::Fp16>>*&, size_t&, const nanovdb::FloatGrid*);
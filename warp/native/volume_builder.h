@@ -17,3 +17,45 @@ void build_grid_from_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
                            size_t num_points,
                            bool points_in_world_space,
                            const BuildGridParams<BuildT> &params);
+
+// Builds a grid from a dense nx*ny*nz array of device values, voxel ijk holds values[(i*ny + j)*nz + k].
+// Only the tiles containing values that differ from the background by more than tolerance are allocated.
+template <typename BuildT>
+void build_grid_from_dense(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
+                           size_t &out_grid_size,
+                           const BuildT *values,
+                           int nx, int ny, int nz,
+                           float tolerance,
+                           const BuildGridParams<BuildT> &params);
+
+// Builds a narrow band signed distance field of a mesh, the tiles overlapping the bounds of the triangles
+// grown by narrow_band are allocated and distances are clamped to [-narrow_band, narrow_band].
+void build_sdf_grid_from_mesh(nanovdb::Grid<nanovdb::NanoTree<float>> *&out_grid,
+                              size_t &out_grid_size,
+                              uint64_t mesh,
+                              const nanovdb::Vec3f *points,
+                              const int *indices,
+                              int num_tris,
+                              float narrow_band,
+                              const BuildGridParams<float> &params);
+
+// Rebuilds a device grid with its tiles grown by dilation voxels in every direction, plus the tiles containing the
+// points. The tiles whose voxels are all within prune_tolerance of the background are dropped first, a negative
+// tolerance keeps every tile. Voxels keep their values and the voxels of new tiles receive the background value.
+template <typename BuildT>
+void build_grid_with_tiles(nanovdb::Grid<nanovdb::NanoTree<BuildT>> *&out_grid,
+                           size_t &out_grid_size,
+                           const nanovdb::Grid<nanovdb::NanoTree<BuildT>> *grid,
+                           const void *points,
+                           size_t num_points,
+                           bool points_in_world_space,
+                           int dilation,
+                           float prune_tolerance);
+
+// Converts a device float grid into a grid of the same topology with quantized leaf values, FpT is nanovdb::Fp4,
+// Fp8 or Fp16. Each leaf maps its codes linearly to the range of its values, tiles and background are kept at full
+// precision. Only grids with their leaf nodes stored last and no blind data are supported, out_grid is null otherwise.
+template <typename FpT>
+void build_quantized_grid(nanovdb::Grid<nanovdb::NanoTree<FpT>> *&out_grid,
+                          size_t &out_grid_size,
+                          const nanovdb::FloatGrid *grid);
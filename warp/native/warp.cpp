@@ -7,6 +7,7 @@
  */
 
 #include "warp.h"
+#include "memory_stats.h"
 #include "scan.h"
 #include "array.h"
 
@@ -141,11 +142,14 @@ int is_debug_enabled()
 
 void* alloc_host(size_t s)
 {
-    return malloc(s);
+    void* ptr = malloc(s);
+    memory_stats_record_alloc(WP_MEMORY_SPACE_HOST, ptr, s);
+    return ptr;
 }
 
 void free_host(void* ptr)
 {
+    memory_stats_record_free(ptr);
     free(ptr);
 }
 
@@ -212,6 +216,21 @@ void array_scan_float_host(uint64_t in, uint64_t out, int len, bool inclusive)
     scan_host((const float*)in, (float*)out, len, inclusive);
 }
 
+void array_scan_vec_int_host(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments)
+{
+    scan_vec_host((const int*)in, (int*)out, len, type_len, inclusive, (const int*)segment_offsets, num_segments);
+}
+
+void array_scan_vec_float_host(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments)
+{
+    scan_vec_host((const float*)in, (float*)out, len, type_len, inclusive, (const int*)segment_offsets, num_segments);
+}
+
+void array_scan_vec_double_host(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments)
+{
+    scan_vec_host((const double*)in, (double*)out, len, type_len, inclusive, (const int*)segment_offsets, num_segments);
+}
+
 
 static void array_copy_nd(void* dst, const void* src,
                       const int* dst_strides, const int* src_strides,
@@ -900,15 +919,52 @@ void free_pinned(void* ptr)
     free_host(ptr);
 }
 
+void pinned_pool_release()
+{
+}
+
+void pinned_pool_get_stats(uint64_t* used_current, uint64_t* used_high, uint64_t* reserved_current, uint64_t* reserved_high)
+{
+    *used_current = *used_high = *reserved_current = *reserved_high = 0;
+}
+
 void* alloc_device(void* context, size_t s)
 {
     return NULL;
 }
 
+void* alloc_temp_device(void* context, size_t s)
+{
+    return NULL;
+}
+
 void free_device(void* context, void* ptr)
 {
 }
 
+void free_temp_device(void* context, void* ptr)
+{
+}
+
+void* alloc_managed(void* context, size_t s)
+{
+    return NULL;
+}
+
+void free_managed(void* context, void* ptr)
+{
+}
+
+int memprefetch_managed(void* context, void* ptr, size_t n, int ordinal)
+{
+    return 0;
+}
+
+int memadvise_managed(void* context, void* ptr, size_t n, int advice, int ordinal)
+{
+    return 0;
+}
+
 
 void memcpy_h2d(void* context, void* dest, void* src, size_t n)
 {
@@ -956,6 +1012,11 @@ WP_API const char* cuda_device_get_name(int ordinal) { return NULL; }
 WP_API int cuda_device_get_arch(int ordinal) { return 0; }
 WP_API int cuda_device_is_uva(int ordinal) { return 0; }
 WP_API int cuda_device_is_memory_pool_supported() { return 0; }
+WP_API int cuda_device_is_mempool_enabled(int ordinal) { return 0; }
+WP_API int cuda_device_set_mempool_enabled(int ordinal, int enable) { return 0; }
+WP_API int cuda_device_set_mempool_release_threshold(int ordinal, uint64_t threshold) { return 0; }
+WP_API uint64_t cuda_device_get_mempool_release_threshold(int ordinal) { return 0; }
+WP_API int cuda_device_get_mempool_stats(int ordinal, uint64_t* used_current, uint64_t* used_high, uint64_t* reserved_current, uint64_t* reserved_high) { return 0; }
 
 WP_API void* cuda_context_get_current() { return NULL; }
 WP_API void cuda_context_set_current(void* ctx) {}
@@ -970,12 +1031,14 @@ WP_API int cuda_context_is_primary(void* context) { return 0; }
 WP_API int cuda_context_is_memory_pool_supported(void* context) { return 0; }
 WP_API void* cuda_context_get_stream(void* context) { return NULL; }
 WP_API void cuda_context_set_stream(void* context, void* stream) {}
+WP_API void cuda_context_set_allocator(void* context, void* alloc_func, void* free_func) {}
 WP_API int cuda_context_can_access_peer(void* context, void* peer_context) { return 0; }
 WP_API int cuda_context_enable_peer_access(void* context, void* peer_context) { return 0; }
 
 WP_API void* cuda_stream_create(void* context) { return NULL; }
 WP_API void cuda_stream_destroy(void* context, void* stream) {}
 WP_API void* cuda_stream_get_current() { return NULL; }
+WP_API int cuda_stream_is_capturing(void* stream) { return 0; }
 WP_API void cuda_stream_synchronize(void* context, void* stream) {}
 WP_API void cuda_stream_wait_event(void* context, void* stream, void* event) {}
 WP_API void cuda_stream_wait_stream(void* context, void* stream, void* other_stream, void* event) {}
@@ -983,29 +1046,51 @@ WP_API void cuda_stream_wait_stream(void* context, void* stream, void* other_str
 WP_API void* cuda_event_create(void* context, unsigned flags) { return NULL; }
 WP_API void cuda_event_destroy(void* context, void* event) {}
 WP_API void cuda_event_record(void* context, void* event, void* stream) {}
+WP_API int cuda_event_query(void* event) { return 1; }
+WP_API void cuda_event_synchronize(void* event) {}
+WP_API float cuda_event_elapsed_time(void* start, void* end) { return 0.0f; }
+WP_API void cuda_nvtx_range_push(const char* name) {}
+WP_API void cuda_nvtx_range_pop() {}
 
 WP_API void cuda_graph_begin_capture(void* context) {}
 WP_API void* cuda_graph_end_capture(void* context) { return NULL; }
+WP_API void* cuda_graph_end_capture_update(void* context, void* graph) { return NULL; }
+WP_API bool cuda_graph_create_conditional(void* context, int* condition, bool invert, uint64_t* handle_out) { return false; }
+WP_API bool cuda_graph_begin_conditional(void* context, uint64_t handle, bool loop, void** graph_out, void** node_out) { return false; }
+WP_API bool cuda_graph_end_conditional(void* context, uint64_t handle, int* condition, bool loop, void* graph, void* node) { return false; }
 WP_API void cuda_graph_launch(void* context, void* graph) {}
 WP_API void cuda_graph_destroy(void* context, void* graph) {}
 
-WP_API size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file) { return 0; }
+WP_API size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file, const char* pch_dir) { return 0; }
+WP_API size_t cuda_compile_lto(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file, const char* pch_dir) { return 0; }
+WP_API size_t cuda_compile_fatbin(const char* cuda_src, const int* archs, int num_archs, int ptx_arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file, const char* pch_dir) { return 0; }
 
 WP_API void* cuda_load_module(void* context, const char* ptx) { return NULL; }
+WP_API void* cuda_load_module_data(void* context, const void* data, size_t size, bool is_ptx) { return NULL; }
 WP_API void cuda_unload_module(void* context, void* module) {}
 WP_API void* cuda_get_kernel(void* context, void* module, const char* name) { return NULL; }
-WP_API size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, void** args) { return 0;}
+WP_API int cuda_get_kernel_occupancy_block_dim(void* context, void* kernel) { return 0; }
+WP_API size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, int block_dim, void** args) { return 0;}
+WP_API size_t cuda_launch_kernels(void* context, void** kernels, int* block_dims, void*** args, int count) { return 0;}
+WP_API size_t cuda_launch_persistent_kernel(void* context, void* kernel, void* tasks, int num_tasks, void* barrier, size_t max_dim) { return 0;}
+WP_API size_t cuda_launch_kernels_multi(void** contexts, void** streams, void** kernels, int* block_dims, void*** args, int count) { return 0;}
+WP_API void cuda_jax_custom_call(void* stream, void** buffers, const char* opaque, size_t opaque_len) {}
 
 WP_API void cuda_set_context_restore_policy(bool always_restore) {}
 WP_API int cuda_get_context_restore_policy() { return false; }
 
 WP_API void array_scan_int_device(uint64_t in, uint64_t out, int len, bool inclusive) {}
 WP_API void array_scan_float_device(uint64_t in, uint64_t out, int len, bool inclusive) {}
+WP_API void array_scan_vec_int_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments) {}
+WP_API void array_scan_vec_float_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments) {}
+WP_API void array_scan_vec_double_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments) {}
 
 WP_API void cuda_graphics_map(void* context, void* resource) {}
 WP_API void cuda_graphics_unmap(void* context, void* resource) {}
 WP_API void cuda_graphics_device_ptr_and_size(void* context, void* resource, uint64_t* ptr, size_t* size) {}
 WP_API void* cuda_graphics_register_gl_buffer(void* context, uint32_t gl_buffer, unsigned int flags) { return NULL; }
+WP_API void* cuda_graphics_register_gl_image(void* context, uint32_t gl_image, uint32_t target, unsigned int flags) { return NULL; }
+WP_API void cuda_graphics_copy_image(void* context, void* resource, uint64_t dst, size_t dst_pitch, size_t width_bytes, size_t height) {}
 WP_API void cuda_graphics_unregister_resource(void* context, void* resource) {}
 
 #endif // !WP_ENABLE_CUDA
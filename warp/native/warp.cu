@@ -7,17 +7,29 @@
  */
 
 #include "warp.h"
+#include "memory_stats.h"
 #include "scan.h"
 #include "cuda_util.h"
 
 #include <nvrtc.h>
 #include <nvPTXCompiler.h>
+#include <nvtx3/nvToolsExt.h>
+#if CUDA_VERSION >= 12040
+#include <nvFatbin.h>
+#include <nvJitLink.h>
+#endif
 
+#include <algorithm>
 #include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #define check_nvrtc(code) (check_nvrtc_result(code, __FILE__, __LINE__))
 #define check_nvptx(code) (check_nvptx_result(code, __FILE__, __LINE__))
+#define check_nvfatbin(code) (check_nvfatbin_result(code, __FILE__, __LINE__))
+#define check_nvjitlink(handle, code) (check_nvjitlink_result(handle, code, __FILE__, __LINE__))
 
 bool check_nvrtc_result(nvrtcResult result, const char* file, int line)
 {
@@ -67,6 +79,36 @@ bool check_nvptx_result(nvPTXCompileResult result, const char* file, int line)
     return false;
 }
 
+#if CUDA_VERSION >= 12040
+bool check_nvfatbin_result(nvFatbinResult result, const char* file, int line)
+{
+    if (result == NVFATBIN_SUCCESS)
+        return true;
+
+    const char* error_string = nvFatbinGetErrorString(result);
+    fprintf(stderr, "Warp fatbin error %u: %s (%s:%d)\n", unsigned(result), error_string, file, line);
+    return false;
+}
+
+bool check_nvjitlink_result(nvJitLinkHandle handle, nvJitLinkResult result, const char* file, int line)
+{
+    if (result == NVJITLINK_SUCCESS)
+        return true;
+
+    fprintf(stderr, "Warp nvJitLink error %u (%s:%d)\n", unsigned(result), file, line);
+
+    // print the linker log, which describes the failure
+    size_t log_size = 0;
+    if (handle && nvJitLinkGetErrorLogSize(handle, &log_size) == NVJITLINK_SUCCESS && log_size > 1)
+    {
+        std::vector<char> log(log_size);
+        if (nvJitLinkGetErrorLog(handle, log.data()) == NVJITLINK_SUCCESS)
+            fprintf(stderr, "%s", log.data());
+    }
+    return false;
+}
+#endif
+
 
 struct DeviceInfo
 {
@@ -78,13 +120,22 @@ struct DeviceInfo
     int arch = 0;
     int is_uva = 0;
     int is_memory_pool_supported = 0;
+    int is_mempool_enabled = 0;    // route alloc_device() through the device's default memory pool
 };
 
+// user-provided device allocator, e.g. to share the caching allocator of another framework
+typedef void* (*DeviceAllocFunc)(size_t size, void* stream);
+typedef void (*DeviceFreeFunc)(void* ptr, void* stream);
+
 struct ContextInfo
 {
     DeviceInfo* device_info = NULL;
 
     CUstream stream = NULL; // created when needed
+
+    // custom allocator functions, NULL when using the default allocator
+    DeviceAllocFunc alloc_func = NULL;
+    DeviceFreeFunc free_func = NULL;
 };
 
 // cached info for all devices, indexed by ordinal
@@ -96,6 +147,9 @@ static std::map<CUdevice, DeviceInfo*> g_device_map;
 // cached info for all known contexts
 static std::map<CUcontext, ContextInfo> g_contexts;
 
+// maps allocations made by custom allocators to the function that frees them
+static std::unordered_map<void*, DeviceFreeFunc> g_custom_allocations;
+
 
 void cuda_set_context_restore_policy(bool always_restore)
 {
@@ -197,16 +251,216 @@ static ContextInfo* get_context_info(CUcontext ctx)
 }
 
 
+// Pool of page-locked host blocks. cudaMallocHost() is slow and synchronous, so freed blocks are cached for reuse.
+// Asynchronous copies to or from a block record an event on their stream, and a freed block is only handed out
+// again once all of its events have completed, so pending transfers never see the memory of a new owner.
+struct PinnedBlock
+{
+    size_t size = 0; // size class
+    bool in_use = false;
+    std::vector<CUevent> events;
+};
+
+static std::mutex g_pinned_mutex;
+static std::map<char*, PinnedBlock> g_pinned_blocks; // all blocks, ordered by address for range lookups
+static std::map<size_t, std::vector<char*>> g_pinned_free; // free blocks by size class
+static uint64_t g_pinned_used = 0, g_pinned_used_high = 0;
+static uint64_t g_pinned_reserved = 0, g_pinned_reserved_high = 0;
+
+// power-of-two classes for small blocks, 2 MiB granularity for large blocks to bound the waste
+static size_t pinned_size_class(size_t s)
+{
+    const size_t min_size = 512;
+    const size_t large_size = size_t(32) << 20;
+    const size_t large_granularity = size_t(2) << 20;
+
+    if (s > large_size)
+        return (s + large_granularity - 1) / large_granularity * large_granularity;
+
+    size_t c = min_size;
+    while (c < s)
+        c *= 2;
+    return c;
+}
+
+// returns true if the transfers recorded on the block have completed, destroying their events
+static bool pinned_block_ready(PinnedBlock& block)
+{
+    while (!block.events.empty())
+    {
+        CUresult res = cuEventQuery_f(block.events.back());
+        if (res == CUDA_ERROR_NOT_READY)
+            return false;
+
+        cuEventDestroy_f(block.events.back());
+        block.events.pop_back();
+    }
+    return true;
+}
+
+// records the current stream's pending work on the pinned block that contains ptr, if any
+static void pinned_record_use(void* ptr)
+{
+    std::lock_guard<std::mutex> lock(g_pinned_mutex);
+
+    if (g_pinned_blocks.empty())
+        return;
+
+    auto it = g_pinned_blocks.upper_bound(static_cast<char*>(ptr));
+    if (it == g_pinned_blocks.begin())
+        return;
+    --it;
+    if (static_cast<char*>(ptr) >= it->first + it->second.size)
+        return;
+
+    CUstream stream = get_current_stream();
+
+    // events recorded during graph capture become graph nodes and cannot be queried
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    if (cudaStreamIsCapturing(static_cast<cudaStream_t>(stream), &status) != cudaSuccess || status != cudaStreamCaptureStatusNone)
+        return;
+
+    // drop the events of completed transfers so that blocks reused by many copies do not accumulate them,
+    // recycling one of them for the new record
+    std::vector<CUevent>& events = it->second.events;
+    CUevent event = NULL;
+    for (size_t i = 0; i < events.size();)
+    {
+        if (cuEventQuery_f(events[i]) != CUDA_SUCCESS)
+        {
+            ++i;
+            continue;
+        }
+
+        if (event)
+            cuEventDestroy_f(events[i]);
+        else
+            event = events[i];
+        events[i] = events.back();
+        events.pop_back();
+    }
+
+    if (event || check_cu(cuEventCreate_f(&event, CU_EVENT_DISABLE_TIMING)))
+    {
+        check_cu(cuEventRecord_f(event, stream));
+        events.push_back(event);
+    }
+}
+
 void* alloc_pinned(size_t s)
 {
-    void* ptr;
-    check_cuda(cudaMallocHost(&ptr, s));
+    const size_t size = pinned_size_class(s);
+
+    std::lock_guard<std::mutex> lock(g_pinned_mutex);
+
+    char* ptr = NULL;
+
+    // reuse a free block whose transfers have completed
+    std::vector<char*>& free_blocks = g_pinned_free[size];
+    for (size_t i = 0; i < free_blocks.size(); ++i)
+    {
+        if (pinned_block_ready(g_pinned_blocks[free_blocks[i]]))
+        {
+            ptr = free_blocks[i];
+            free_blocks.erase(free_blocks.begin() + i);
+            break;
+        }
+    }
+
+    if (!ptr)
+    {
+        if (!check_cuda(cudaMallocHost((void**)&ptr, size)))
+            return NULL;
+
+        g_pinned_blocks[ptr].size = size;
+        g_pinned_reserved += size;
+        g_pinned_reserved_high = std::max(g_pinned_reserved_high, g_pinned_reserved);
+    }
+
+    g_pinned_blocks[ptr].in_use = true;
+    g_pinned_used += size;
+    g_pinned_used_high = std::max(g_pinned_used_high, g_pinned_used);
+
+    memory_stats_record_alloc(WP_MEMORY_SPACE_PINNED, ptr, size);
+
     return ptr;
 }
 
 void free_pinned(void* ptr)
 {
-    cudaFreeHost(ptr);
+    if (!ptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_pinned_mutex);
+
+    auto it = g_pinned_blocks.find(static_cast<char*>(ptr));
+    if (it == g_pinned_blocks.end() || !it->second.in_use)
+    {
+        fprintf(stderr, "Warp error: Freeing unknown pinned memory %p\n", ptr);
+        return;
+    }
+
+    memory_stats_record_free(ptr);
+
+    it->second.in_use = false;
+    g_pinned_used -= it->second.size;
+    g_pinned_free[it->second.size].push_back(it->first);
+}
+
+void pinned_pool_release()
+{
+    std::lock_guard<std::mutex> lock(g_pinned_mutex);
+
+    for (auto& free_blocks : g_pinned_free)
+    {
+        for (char* ptr : free_blocks.second)
+        {
+            PinnedBlock& block = g_pinned_blocks[ptr];
+            for (CUevent event : block.events)
+            {
+                check_cu(cuEventSynchronize_f(event));
+                cuEventDestroy_f(event);
+            }
+
+            check_cuda(cudaFreeHost(ptr));
+            g_pinned_reserved -= block.size;
+            g_pinned_blocks.erase(ptr);
+        }
+    }
+    g_pinned_free.clear();
+}
+
+void pinned_pool_get_stats(uint64_t* used_current, uint64_t* used_high, uint64_t* reserved_current, uint64_t* reserved_high)
+{
+    std::lock_guard<std::mutex> lock(g_pinned_mutex);
+
+    *used_current = g_pinned_used;
+    *used_high = g_pinned_used_high;
+    *reserved_current = g_pinned_reserved;
+    *reserved_high = g_pinned_reserved_high;
+}
+
+static inline bool is_mempool_enabled(void* context)
+{
+    ContextInfo* info = get_context_info(static_cast<CUcontext>(context));
+    return info && info->device_info && info->device_info->is_mempool_enabled;
+}
+
+// returns true if the pointer was allocated from a stream-ordered memory pool
+static inline bool is_mempool_allocation(void* ptr)
+{
+    CUmemoryPool pool = NULL;
+    if (cuPointerGetAttribute_f(&pool, CU_POINTER_ATTRIBUTE_MEMPOOL_HANDLE, (CUdeviceptr)ptr) == CUDA_SUCCESS)
+        return pool != NULL;
+    else
+        return false;
+}
+
+void memory_stats_record_device_alloc(void* context, void* ptr, size_t s)
+{
+    ContextInfo* info = get_context_info(static_cast<CUcontext>(context));
+    if (info && info->device_info)
+        memory_stats_record_alloc(info->device_info->ordinal, ptr, s);
 }
 
 void* alloc_device(void* context, size_t s)
@@ -214,7 +468,28 @@ void* alloc_device(void* context, size_t s)
     ContextGuard guard(context);
 
     void* ptr;
-    check_cuda(cudaMalloc(&ptr, s));
+
+    ContextInfo* info = get_context_info(static_cast<CUcontext>(context));
+    if (info && info->alloc_func)
+    {
+        ptr = info->alloc_func(s, get_current_stream());
+        if (ptr)
+            g_custom_allocations[ptr] = info->free_func;
+        else
+            fprintf(stderr, "Warp error: Custom allocator failed to allocate %llu bytes\n", (unsigned long long)s);
+    }
+    else if (is_mempool_enabled(context))
+    {
+        // stream-ordered allocation, does not synchronize the device and can be captured in graphs
+        check_cuda(cudaMallocAsync(&ptr, s, get_current_stream()));
+    }
+    else
+    {
+        check_cuda(cudaMalloc(&ptr, s));
+    }
+
+    memory_stats_record_device_alloc(context, ptr, s);
+
     return ptr;
 }
 
@@ -235,6 +510,8 @@ void* alloc_temp_device(void* context, size_t s)
         check_cuda(cudaMalloc(&ptr, s));
     }
 
+    memory_stats_record_device_alloc(context, ptr, s);
+
     return ptr;
 }
 
@@ -242,13 +519,62 @@ void free_device(void* context, void* ptr)
 {
     ContextGuard guard(context);
 
+    memory_stats_record_free(ptr);
+
+    // the allocator may have changed since the allocation was made, so check where the pointer came from
+    auto it = g_custom_allocations.find(ptr);
+    if (it != g_custom_allocations.end())
+    {
+        DeviceFreeFunc free_func = it->second;
+        g_custom_allocations.erase(it);
+        free_func(ptr, get_current_stream());
+    }
+    else if (is_mempool_allocation(ptr))
+    {
+        check_cuda(cudaFreeAsync(ptr, get_current_stream()));
+    }
+    else
+    {
+        check_cuda(cudaFree(ptr));
+    }
+}
+
+void* alloc_managed(void* context, size_t s)
+{
+    ContextGuard guard(context);
+
+    void* ptr = NULL;
+    check_cuda(cudaMallocManaged(&ptr, s, cudaMemAttachGlobal));
+    return ptr;
+}
+
+void free_managed(void* context, void* ptr)
+{
+    ContextGuard guard(context);
+
     check_cuda(cudaFree(ptr));
 }
 
+int memprefetch_managed(void* context, void* ptr, size_t n, int ordinal)
+{
+    ContextGuard guard(context);
+
+    return check_cuda(cudaMemPrefetchAsync(ptr, n, ordinal < 0 ? cudaCpuDeviceId : ordinal, get_current_stream()));
+}
+
+int memadvise_managed(void* context, void* ptr, size_t n, int advice, int ordinal)
+{
+    ContextGuard guard(context);
+
+    return check_cuda(cudaMemAdvise(ptr, n, cudaMemoryAdvise(advice), ordinal < 0 ? cudaCpuDeviceId : ordinal));
+}
+
 void free_temp_device(void* context, void* ptr)
 {
     ContextGuard guard(context);
 
+    memory_stats_record_free(ptr);
+
     if (cuda_context_is_memory_pool_supported(context))
     {
         check_cuda(cudaFreeAsync(ptr, get_current_stream()));
@@ -264,6 +590,7 @@ void memcpy_h2d(void* context, void* dest, void* src, size_t n)
     ContextGuard guard(context);
     
     check_cuda(cudaMemcpyAsync(dest, src, n, cudaMemcpyHostToDevice, get_current_stream()));
+    pinned_record_use(src);
 }
 
 void memcpy_d2h(void* context, void* dest, void* src, size_t n)
@@ -271,6 +598,7 @@ void memcpy_d2h(void* context, void* dest, void* src, size_t n)
     ContextGuard guard(context);
 
     check_cuda(cudaMemcpyAsync(dest, src, n, cudaMemcpyDeviceToHost, get_current_stream()));
+    pinned_record_use(dest);
 }
 
 void memcpy_d2d(void* context, void* dest, void* src, size_t n)
@@ -382,104 +710,108 @@ void memtile_device(void* context, void* dst, const void* src, size_t srcsize, s
 }
 
 
-static __global__ void array_copy_1d_kernel(void* dst, const void* src,
-                                        int dst_stride, int src_stride,
-                                        const int* dst_indices, const int* src_indices,
-                                        int n, int elem_size)
+// Copies one element as num_words words of type T, the word size evenly divides the element size and alignment
+template <typename T>
+static __device__ inline void array_copy_element(char* q, const char* p, int num_words)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-    if (i < n)
+    const T* src = reinterpret_cast<const T*>(p);
+    T* dst = reinterpret_cast<T*>(q);
+    for (int w = 0; w < num_words; ++w)
+        dst[w] = src[w];
+}
+
+// Strided (and indexed) copy of n elements, indices are decomposed with 64-bit math to support arrays beyond 2^31 elements
+template <int NDIM, typename T>
+static __global__ void array_copy_kernel(void* dst, const void* src,
+                                         wp::vec_t<NDIM, int> dst_strides, wp::vec_t<NDIM, int> src_strides,
+                                         wp::vec_t<NDIM, const int*> dst_indices, wp::vec_t<NDIM, const int*> src_indices,
+                                         wp::vec_t<NDIM, int> shape, size_t n, int num_words)
+{
+    size_t tid = size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (tid >= n)
+        return;
+
+    ptrdiff_t src_offset = 0;
+    ptrdiff_t dst_offset = 0;
+    for (int d = NDIM - 1; d >= 0; --d)
     {
-        int src_idx = src_indices ? src_indices[i] : i;
-        int dst_idx = dst_indices ? dst_indices[i] : i;
-        const char* p = (const char*)src + src_idx * src_stride;
-        char* q = (char*)dst + dst_idx * dst_stride;
-        memcpy(q, p, elem_size);
+        const size_t dim = size_t(shape[d]);
+        const int i = int(tid % dim);
+        tid /= dim;
+
+        const int src_idx = src_indices[d] ? src_indices[d][i] : i;
+        const int dst_idx = dst_indices[d] ? dst_indices[d][i] : i;
+        src_offset += ptrdiff_t(src_idx) * src_strides[d];
+        dst_offset += ptrdiff_t(dst_idx) * dst_strides[d];
     }
+
+    array_copy_element<T>((char*)dst + dst_offset, (const char*)src + src_offset, num_words);
 }
 
-static __global__ void array_copy_2d_kernel(void* dst, const void* src,
-                                        wp::vec_t<2, int> dst_strides, wp::vec_t<2, int> src_strides,
-                                        wp::vec_t<2, const int*> dst_indices, wp::vec_t<2, const int*> src_indices,
-                                        wp::vec_t<2, int> shape, int elem_size)
+// Widest word size (up to 16 bytes) that divides the element size, the base addresses, and all strides
+static int array_copy_word_size(const void* dst, const void* src, const int* dst_strides, const int* src_strides, int ndim, int elem_size)
 {
-    int tid = blockIdx.x * blockDim.x + threadIdx.x;
-    int n = shape[1];
-    int i = tid / n;
-    int j = tid % n;
-    if (i < shape[0] /*&& j < shape[1]*/)
+    uintptr_t bits = uintptr_t(dst) | uintptr_t(src) | uintptr_t(elem_size);
+    for (int d = 0; d < ndim; d++)
+        bits |= uintptr_t(unsigned(dst_strides[d])) | uintptr_t(unsigned(src_strides[d]));
+
+    for (int w = 16; w > 1; w /= 2)
     {
-        int src_idx0 = src_indices[0] ? src_indices[0][i] : i;
-        int dst_idx0 = dst_indices[0] ? dst_indices[0][i] : i;
-        int src_idx1 = src_indices[1] ? src_indices[1][j] : j;
-        int dst_idx1 = dst_indices[1] ? dst_indices[1][j] : j;
-        const char* p = (const char*)src + src_idx0 * src_strides[0] + src_idx1 * src_strides[1];
-        char* q = (char*)dst + dst_idx0 * dst_strides[0] + dst_idx1 * dst_strides[1];
-        memcpy(q, p, elem_size);
+        if ((bits & (w - 1)) == 0)
+            return w;
     }
+    return 1;
 }
 
-static __global__ void array_copy_3d_kernel(void* dst, const void* src,
-                                        wp::vec_t<3, int> dst_strides, wp::vec_t<3, int> src_strides,
-                                        wp::vec_t<3, const int*> dst_indices, wp::vec_t<3, const int*> src_indices,
-                                        wp::vec_t<3, int> shape, int elem_size)
+template <int NDIM, typename T>
+static void launch_array_copy(void* dst, const void* src,
+                              const int* dst_strides, const int* src_strides,
+                              const int* const* dst_indices, const int* const* src_indices,
+                              const int* shape, size_t n, int elem_size)
 {
-    int tid = blockIdx.x * blockDim.x + threadIdx.x;
-    int n = shape[1];
-    int o = shape[2];
-    int i = tid / (n * o);
-    int j = tid % (n * o) / o;
-    int k = tid % o;
-    if (i < shape[0] && j < shape[1] /*&& k < shape[2]*/)
+    wp::vec_t<NDIM, int> shape_v, dst_strides_v, src_strides_v;
+    wp::vec_t<NDIM, const int*> dst_indices_v, src_indices_v;
+    for (int d = 0; d < NDIM; d++)
     {
-        int src_idx0 = src_indices[0] ? src_indices[0][i] : i;
-        int dst_idx0 = dst_indices[0] ? dst_indices[0][i] : i;
-        int src_idx1 = src_indices[1] ? src_indices[1][j] : j;
-        int dst_idx1 = dst_indices[1] ? dst_indices[1][j] : j;
-        int src_idx2 = src_indices[2] ? src_indices[2][k] : k;
-        int dst_idx2 = dst_indices[2] ? dst_indices[2][k] : k;
-        const char* p = (const char*)src + src_idx0 * src_strides[0]
-                                         + src_idx1 * src_strides[1]
-                                         + src_idx2 * src_strides[2];
-        char* q = (char*)dst + dst_idx0 * dst_strides[0]
-                             + dst_idx1 * dst_strides[1]
-                             + dst_idx2 * dst_strides[2];
-        memcpy(q, p, elem_size);
+        shape_v[d] = shape[d];
+        dst_strides_v[d] = dst_strides[d];
+        src_strides_v[d] = src_strides[d];
+        dst_indices_v[d] = dst_indices[d];
+        src_indices_v[d] = src_indices[d];
     }
+
+    const int num_words = elem_size / int(sizeof(T));
+
+    auto kernel = array_copy_kernel<NDIM, T>;
+    wp_launch_device(WP_CURRENT_CONTEXT, kernel, n, (dst, src,
+                                                 dst_strides_v, src_strides_v,
+                                                 dst_indices_v, src_indices_v,
+                                                 shape_v, n, num_words));
 }
 
-static __global__ void array_copy_4d_kernel(void* dst, const void* src,
-                                        wp::vec_t<4, int> dst_strides, wp::vec_t<4, int> src_strides,
-                                        wp::vec_t<4, const int*> dst_indices, wp::vec_t<4, const int*> src_indices,
-                                        wp::vec_t<4, int> shape, int elem_size)
+template <int NDIM>
+static void launch_array_copy(void* dst, const void* src,
+                              const int* dst_strides, const int* src_strides,
+                              const int* const* dst_indices, const int* const* src_indices,
+                              const int* shape, size_t n, int elem_size)
 {
-    int tid = blockIdx.x * blockDim.x + threadIdx.x;
-    int n = shape[1];
-    int o = shape[2];
-    int p = shape[3];
-    int i = tid / (n * o * p);
-    int j = tid % (n * o * p) / (o * p);
-    int k = tid % (o * p) / p;
-    int l = tid % p;
-    if (i < shape[0] && j < shape[1] && k < shape[2] /*&& l < shape[3]*/)
+    switch (array_copy_word_size(dst, src, dst_strides, src_strides, NDIM, elem_size))
     {
-        int src_idx0 = src_indices[0] ? src_indices[0][i] : i;
-        int dst_idx0 = dst_indices[0] ? dst_indices[0][i] : i;
-        int src_idx1 = src_indices[1] ? src_indices[1][j] : j;
-        int dst_idx1 = dst_indices[1] ? dst_indices[1][j] : j;
-        int src_idx2 = src_indices[2] ? src_indices[2][k] : k;
-        int dst_idx2 = dst_indices[2] ? dst_indices[2][k] : k;
-        int src_idx3 = src_indices[3] ? src_indices[3][l] : l;
-        int dst_idx3 = dst_indices[3] ? dst_indices[3][l] : l;
-        const char* p = (const char*)src + src_idx0 * src_strides[0]
-                                         + src_idx1 * src_strides[1]
-                                         + src_idx2 * src_strides[2]
-                                         + src_idx3 * src_strides[3];
-        char* q = (char*)dst + dst_idx0 * dst_strides[0]
-                             + dst_idx1 * dst_strides[1]
-                             + dst_idx2 * dst_strides[2]
-                             + dst_idx3 * dst_strides[3];
-        memcpy(q, p, elem_size);
+    case 16:
+        launch_array_copy<NDIM, int4>(dst, src, dst_strides, src_strides, dst_indices, src_indices, shape, n, elem_size);
+        break;
+    case 8:
+        launch_array_copy<NDIM, int2>(dst, src, dst_strides, src_strides, dst_indices, src_indices, shape, n, elem_size);
+        break;
+    case 4:
+        launch_array_copy<NDIM, int>(dst, src, dst_strides, src_strides, dst_indices, src_indices, shape, n, elem_size);
+        break;
+    case 2:
+        launch_array_copy<NDIM, short>(dst, src, dst_strides, src_strides, dst_indices, src_indices, shape, n, elem_size);
+        break;
+    default:
+        launch_array_copy<NDIM, char>(dst, src, dst_strides, src_strides, dst_indices, src_indices, shape, n, elem_size);
+        break;
     }
 }
 
@@ -826,60 +1158,84 @@ WP_API size_t array_copy_device(void* context, void* dst, void* src, int dst_typ
         n *= src_shape[i];
     }
 
-    switch (src_ndim)
-    {
-    case 1:
+    if (n == 0)
+        return 0;
+
+    int ndim = src_ndim;
+    int shape[wp::ARRAY_MAX_DIMS];
+    int src_strides_c[wp::ARRAY_MAX_DIMS];
+    int dst_strides_c[wp::ARRAY_MAX_DIMS];
+    for (int i = 0; i < ndim; i++)
     {
-        wp_launch_device(WP_CURRENT_CONTEXT, array_copy_1d_kernel, n, (dst_data, src_data,
-                                                                   dst_strides[0], src_strides[0],
-                                                                   dst_indices[0], src_indices[0],
-                                                                   src_shape[0], elem_size));
-        break;
+        shape[i] = src_shape[i];
+        src_strides_c[i] = src_strides[i];
+        dst_strides_c[i] = dst_strides[i];
     }
-    case 2:
+
+    if (src_type == wp::ARRAY_TYPE_REGULAR && dst_type == wp::ARRAY_TYPE_REGULAR)
     {
-        wp::vec_t<2, int> shape_v(src_shape[0], src_shape[1]);
-        wp::vec_t<2, int> src_strides_v(src_strides[0], src_strides[1]);
-        wp::vec_t<2, int> dst_strides_v(dst_strides[0], dst_strides[1]);
-        wp::vec_t<2, const int*> src_indices_v(src_indices[0], src_indices[1]);
-        wp::vec_t<2, const int*> dst_indices_v(dst_indices[0], dst_indices[1]);
+        // merge dimensions that are contiguous in both arrays, e.g. a slice of whole rows becomes 1D
+        int m = 0;
+        for (int i = 1; i < ndim; i++)
+        {
+            const int64_t merged = int64_t(shape[m]) * shape[i];
+            if (merged <= INT32_MAX &&
+                src_strides_c[m] == int64_t(src_strides_c[i]) * shape[i] &&
+                dst_strides_c[m] == int64_t(dst_strides_c[i]) * shape[i])
+            {
+                shape[m] *= shape[i];
+                src_strides_c[m] = src_strides_c[i];
+                dst_strides_c[m] = dst_strides_c[i];
+            }
+            else
+            {
+                ++m;
+                shape[m] = shape[i];
+                src_strides_c[m] = src_strides_c[i];
+                dst_strides_c[m] = dst_strides_c[i];
+            }
+        }
+        ndim = m + 1;
 
-        wp_launch_device(WP_CURRENT_CONTEXT, array_copy_2d_kernel, n, (dst_data, src_data,
-                                                                   dst_strides_v, src_strides_v,
-                                                                   dst_indices_v, src_indices_v,
-                                                                   shape_v, elem_size));
-        break;
+        const bool inner_contiguous = src_strides_c[ndim - 1] == elem_size && dst_strides_c[ndim - 1] == elem_size;
+
+        if (ndim == 1 && inner_contiguous)
+        {
+            // contiguous copy
+            if (check_cuda(cudaMemcpyAsync(dst_data, src_data, n * elem_size, cudaMemcpyDeviceToDevice, get_current_stream())))
+                return n;
+            else
+                return 0;
+        }
+
+        const int64_t width = int64_t(shape[ndim - 1]) * elem_size;
+        if (ndim == 2 && inner_contiguous && src_strides_c[0] >= width && dst_strides_c[0] >= width)
+        {
+            // pitched copy of contiguous rows
+            if (check_cuda(cudaMemcpy2DAsync(dst_data, dst_strides_c[0], src_data, src_strides_c[0], width, shape[0],
+                                             cudaMemcpyDeviceToDevice, get_current_stream())))
+                return n;
+            else
+                return 0;
+        }
     }
-    case 3:
-    {
-        wp::vec_t<3, int> shape_v(src_shape[0], src_shape[1], src_shape[2]);
-        wp::vec_t<3, int> src_strides_v(src_strides[0], src_strides[1], src_strides[2]);
-        wp::vec_t<3, int> dst_strides_v(dst_strides[0], dst_strides[1], dst_strides[2]);
-        wp::vec_t<3, const int*> src_indices_v(src_indices[0], src_indices[1], src_indices[2]);
-        wp::vec_t<3, const int*> dst_indices_v(dst_indices[0], dst_indices[1], dst_indices[2]);
 
-        wp_launch_device(WP_CURRENT_CONTEXT, array_copy_3d_kernel, n, (dst_data, src_data,
-                                                                   dst_strides_v, src_strides_v,
-                                                                   dst_indices_v, src_indices_v,
-                                                                   shape_v, elem_size));
+    switch (ndim)
+    {
+    case 1:
+        launch_array_copy<1>(dst_data, src_data, dst_strides_c, src_strides_c, dst_indices, src_indices, shape, n, elem_size);
+        break;
+    case 2:
+        launch_array_copy<2>(dst_data, src_data, dst_strides_c, src_strides_c, dst_indices, src_indices, shape, n, elem_size);
+        break;
+    case 3:
+        launch_array_copy<3>(dst_data, src_data, dst_strides_c, src_strides_c, dst_indices, src_indices, shape, n, elem_size);
         break;
-    }
     case 4:
-    {
-        wp::vec_t<4, int> shape_v(src_shape[0], src_shape[1], src_shape[2], src_shape[3]);
-        wp::vec_t<4, int> src_strides_v(src_strides[0], src_strides[1], src_strides[2], src_strides[3]);
-        wp::vec_t<4, int> dst_strides_v(dst_strides[0], dst_strides[1], dst_strides[2], dst_strides[3]);
-        wp::vec_t<4, const int*> src_indices_v(src_indices[0], src_indices[1], src_indices[2], src_indices[3]);
-        wp::vec_t<4, const int*> dst_indices_v(dst_indices[0], dst_indices[1], dst_indices[2], dst_indices[3]);
-
-        wp_launch_device(WP_CURRENT_CONTEXT, array_copy_4d_kernel, n, (dst_data, src_data,
-                                                                   dst_strides_v, src_strides_v,
-                                                                   dst_indices_v, src_indices_v,
-                                                                   shape_v, elem_size));
+        launch_array_copy<4>(dst_data, src_data, dst_strides_c, src_strides_c, dst_indices, src_indices, shape, n, elem_size);
         break;
-    }
     default:
-        fprintf(stderr, "Warp copy error: invalid array dimensionality (%d)\n", src_ndim);
+        fprintf(stderr, "Warp copy error: invalid array dimensionality (%d)\n", ndim);
         return 0;
     }
 
@@ -1127,6 +1483,21 @@ void array_scan_float_device(uint64_t in, uint64_t out, int len, bool inclusive)
     scan_device((const float*)in, (float*)out, len, inclusive);
 }
 
+void array_scan_vec_int_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments)
+{
+    scan_vec_device((const int*)in, (int*)out, len, type_len, inclusive, (const int*)segment_offsets, num_segments);
+}
+
+void array_scan_vec_float_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments)
+{
+    scan_vec_device((const float*)in, (float*)out, len, type_len, inclusive, (const int*)segment_offsets, num_segments);
+}
+
+void array_scan_vec_double_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments)
+{
+    scan_vec_device((const double*)in, (double*)out, len, type_len, inclusive, (const int*)segment_offsets, num_segments);
+}
+
 int cuda_driver_version()
 {
     int version;
@@ -1209,19 +1580,85 @@ int cuda_device_is_memory_pool_supported(int ordinal)
     return false;
 }
 
-void* cuda_context_get_current()
+int cuda_device_is_mempool_enabled(int ordinal)
 {
-    return get_current_context();
+    if (ordinal >= 0 && ordinal < int(g_devices.size()))
+        return g_devices[ordinal].is_mempool_enabled;
+    return false;
 }
 
-void cuda_context_set_current(void* context)
+int cuda_device_set_mempool_enabled(int ordinal, int enable)
 {
-    CUcontext ctx = static_cast<CUcontext>(context);
-    CUcontext prev_ctx = NULL;
-    check_cu(cuCtxGetCurrent_f(&prev_ctx));
-    if (ctx != prev_ctx)
+    if (ordinal < 0 || ordinal >= int(g_devices.size()))
+        return 0;
+
+    if (enable && !g_devices[ordinal].is_memory_pool_supported)
     {
-        check_cu(cuCtxSetCurrent_f(ctx));
+        fprintf(stderr, "Warp error: Device %d does not support stream-ordered memory pools\n", ordinal);
+        return 0;
+    }
+
+    g_devices[ordinal].is_mempool_enabled = enable ? 1 : 0;
+    return 1;
+}
+
+static bool get_device_mempool(int ordinal, cudaMemPool_t* pool)
+{
+    if (ordinal < 0 || ordinal >= int(g_devices.size()) || !g_devices[ordinal].is_memory_pool_supported)
+        return false;
+
+    return check_cuda(cudaDeviceGetDefaultMemPool(pool, ordinal));
+}
+
+int cuda_device_set_mempool_release_threshold(int ordinal, uint64_t threshold)
+{
+    cudaMemPool_t pool;
+    if (!get_device_mempool(ordinal, &pool))
+        return 0;
+
+    // memory above the threshold is returned to the OS at the next synchronization point
+    return check_cuda(cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+}
+
+uint64_t cuda_device_get_mempool_release_threshold(int ordinal)
+{
+    cudaMemPool_t pool;
+    if (!get_device_mempool(ordinal, &pool))
+        return 0;
+
+    uint64_t threshold = 0;
+    check_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+    return threshold;
+}
+
+int cuda_device_get_mempool_stats(int ordinal, uint64_t* used_current, uint64_t* used_high, uint64_t* reserved_current, uint64_t* reserved_high)
+{
+    cudaMemPool_t pool;
+    if (!get_device_mempool(ordinal, &pool))
+        return 0;
+
+    // values are in bytes, the high watermarks track the peak since the pool was created
+    bool ok = true;
+    ok = ok && check_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrUsedMemCurrent, used_current));
+    ok = ok && check_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrUsedMemHigh, used_high));
+    ok = ok && check_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemCurrent, reserved_current));
+    ok = ok && check_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemHigh, reserved_high));
+    return int(ok);
+}
+
+void* cuda_context_get_current()
+{
+    return get_current_context();
+}
+
+void cuda_context_set_current(void* context)
+{
+    CUcontext ctx = static_cast<CUcontext>(context);
+    CUcontext prev_ctx = NULL;
+    check_cu(cuCtxGetCurrent_f(&prev_ctx));
+    if (ctx != prev_ctx)
+    {
+        check_cu(cuCtxSetCurrent_f(ctx));
     }
 }
 
@@ -1346,6 +1783,25 @@ void cuda_context_set_stream(void* context, void* stream)
     }
 }
 
+void cuda_context_set_allocator(void* context, void* alloc_func, void* free_func)
+{
+    ContextInfo* info = get_context_info(static_cast<CUcontext>(context));
+    if (info)
+    {
+        // both functions are needed to use a custom allocator
+        if (alloc_func && free_func)
+        {
+            info->alloc_func = reinterpret_cast<DeviceAllocFunc>(alloc_func);
+            info->free_func = reinterpret_cast<DeviceFreeFunc>(free_func);
+        }
+        else
+        {
+            info->alloc_func = NULL;
+            info->free_func = NULL;
+        }
+    }
+}
+
 int cuda_context_enable_peer_access(void* context, void* peer_context)
 {
     if (!context || !peer_context)
@@ -1476,6 +1932,13 @@ void* cuda_stream_get_current()
     return get_current_stream();
 }
 
+int cuda_stream_is_capturing(void* stream)
+{
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    check_cuda(cudaStreamIsCapturing(static_cast<cudaStream_t>(stream), &status));
+    return status != cudaStreamCaptureStatusNone;
+}
+
 void cuda_stream_wait_event(void* context, void* stream, void* event)
 {
     ContextGuard guard(context);
@@ -1516,6 +1979,38 @@ void cuda_event_record(void* context, void* event, void* stream)
     check_cu(cuEventRecord_f(static_cast<CUevent>(event), static_cast<CUstream>(stream)));
 }
 
+int cuda_event_query(void* event)
+{
+    CUresult res = cuEventQuery_f(static_cast<CUevent>(event));
+    if (res == CUDA_ERROR_NOT_READY)
+        return 0;
+
+    check_cu(res);
+    return 1;
+}
+
+void cuda_event_synchronize(void* event)
+{
+    check_cu(cuEventSynchronize_f(static_cast<CUevent>(event)));
+}
+
+float cuda_event_elapsed_time(void* start, void* end)
+{
+    float ms = 0.0f;
+    check_cu(cuEventElapsedTime_f(&ms, static_cast<CUevent>(start), static_cast<CUevent>(end)));
+    return ms;
+}
+
+void cuda_nvtx_range_push(const char* name)
+{
+    nvtxRangePushA(name);
+}
+
+void cuda_nvtx_range_pop()
+{
+    nvtxRangePop();
+}
+
 void cuda_graph_begin_capture(void* context)
 {
     ContextGuard guard(context);
@@ -1552,6 +2047,141 @@ void* cuda_graph_end_capture(void* context)
     }
 }
 
+void* cuda_graph_end_capture_update(void* context, void* graph_exec)
+{
+    ContextGuard guard(context);
+
+    cudaGraph_t graph = NULL;
+    check_cuda(cudaStreamEndCapture(get_current_stream(), &graph));
+
+    if (!graph)
+        return NULL;
+
+    // try to patch the kernel parameters, launch dims and memcpy/memset nodes of the existing executable graph,
+    // this fails when the topology or the node types changed, in which case the graph is re-instantiated
+#if CUDA_VERSION >= 12000
+    cudaGraphExecUpdateResultInfo info;
+    const bool updated = cudaGraphExecUpdate((cudaGraphExec_t)graph_exec, graph, &info) == cudaSuccess;
+#else
+    cudaGraphNode_t error_node = NULL;
+    cudaGraphExecUpdateResult result;
+    const bool updated = cudaGraphExecUpdate((cudaGraphExec_t)graph_exec, graph, &error_node, &result) == cudaSuccess;
+#endif
+
+    if (!updated)
+    {
+        // clear the error state left by the failed update
+        cudaGetLastError();
+
+        check_cuda(cudaGraphExecDestroy((cudaGraphExec_t)graph_exec));
+
+        graph_exec = NULL;
+        check_cuda(cudaGraphInstantiateWithFlags((cudaGraphExec_t*)&graph_exec, graph, cudaGraphInstantiateFlagAutoFreeOnLaunch));
+    }
+
+    check_cuda(cudaGraphDestroy(graph));
+
+    return graph_exec;
+}
+
+#if CUDA_VERSION >= 12040
+
+__global__ void set_conditional_kernel(cudaGraphConditionalHandle handle, const int* condition, bool invert)
+{
+    cudaGraphSetConditional(handle, (*condition != 0) != invert);
+}
+
+bool cuda_graph_create_conditional(void* context, int* condition, bool invert, uint64_t* handle_out)
+{
+    ContextGuard guard(context);
+
+    CUstream stream = get_current_stream();
+
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    cudaGraph_t graph = NULL;
+    if (!check_cuda(cudaStreamGetCaptureInfo(stream, &status, NULL, &graph)) || status != cudaStreamCaptureStatusActive)
+        return false;
+
+    cudaGraphConditionalHandle handle;
+    if (!check_cuda(cudaGraphConditionalHandleCreate(&handle, graph, 0, 0)))
+        return false;
+
+    // the condition is read on the device when the graph reaches this point, before the conditional node
+    set_conditional_kernel<<<1, 1, 0, stream>>>(handle, condition, invert);
+    if (!check_cuda(cudaGetLastError()))
+        return false;
+
+    *handle_out = handle;
+    return true;
+}
+
+bool cuda_graph_begin_conditional(void* context, uint64_t handle, bool loop, void** graph_out, void** node_out)
+{
+    ContextGuard guard(context);
+
+    CUstream stream = get_current_stream();
+
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    cudaGraph_t graph = NULL;
+    const cudaGraphNode_t* deps = NULL;
+    size_t num_deps = 0;
+    if (!check_cuda(cudaStreamGetCaptureInfo(stream, &status, NULL, &graph, &deps, &num_deps)) || status != cudaStreamCaptureStatusActive)
+        return false;
+
+    cudaGraphNodeParams params = {};
+    params.type = cudaGraphNodeTypeConditional;
+    params.conditional.handle = handle;
+    params.conditional.type = loop ? cudaGraphCondTypeWhile : cudaGraphCondTypeIf;
+    params.conditional.size = 1;
+
+    cudaGraphNode_t node = NULL;
+    if (!check_cuda(cudaGraphAddNode(&node, graph, deps, num_deps, &params)))
+        return false;
+
+    // suspend the capture of the outer graph and capture the following work into the body of the node,
+    // the outer graph stays alive and is resumed by cuda_graph_end_conditional()
+    if (!check_cuda(cudaStreamUpdateCaptureDependencies(stream, &node, 1, cudaStreamSetCaptureDependencies)))
+        return false;
+
+    cudaGraph_t outer = NULL;
+    if (!check_cuda(cudaStreamEndCapture(stream, &outer)))
+        return false;
+
+    if (!check_cuda(cudaStreamBeginCaptureToGraph(stream, params.conditional.phGraph_out[0], NULL, NULL, 0, cudaStreamCaptureModeGlobal)))
+        return false;
+
+    *graph_out = outer;
+    *node_out = node;
+    return true;
+}
+
+bool cuda_graph_end_conditional(void* context, uint64_t handle, int* condition, bool loop, void* graph, void* node)
+{
+    ContextGuard guard(context);
+
+    CUstream stream = get_current_stream();
+
+    // loops re-evaluate the condition at the end of each iteration
+    if (loop)
+        set_conditional_kernel<<<1, 1, 0, stream>>>(handle, condition, false);
+
+    cudaGraph_t body = NULL;
+    if (!check_cuda(cudaStreamEndCapture(stream, &body)))
+        return false;
+
+    // resume the capture of the outer graph after the conditional node
+    const cudaGraphNode_t deps[] = { static_cast<cudaGraphNode_t>(node) };
+    return check_cuda(cudaStreamBeginCaptureToGraph(stream, static_cast<cudaGraph_t>(graph), deps, NULL, 1, cudaStreamCaptureModeGlobal));
+}
+
+#else
+
+bool cuda_graph_create_conditional(void* context, int* condition, bool invert, uint64_t* handle_out) { return false; }
+bool cuda_graph_begin_conditional(void* context, uint64_t handle, bool loop, void** graph_out, void** node_out) { return false; }
+bool cuda_graph_end_conditional(void* context, uint64_t handle, int* condition, bool loop, void* graph, void* node) { return false; }
+
+#endif // CUDA_VERSION >= 12040
+
 void cuda_graph_launch(void* context, void* graph_exec)
 {
     ContextGuard guard(context);
@@ -1566,12 +2196,9 @@ void cuda_graph_destroy(void* context, void* graph_exec)
     check_cuda(cudaGraphExecDestroy((cudaGraphExec_t)graph_exec));
 }
 
-size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_path)
+// compiles CUDA source to PTX, CUBIN, or with lto to LTO-IR for nvJitLink in memory
+static size_t compile_program(const char* cuda_src, int arch, bool use_ptx, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* pch_dir, std::vector<char>& output, bool lto = false)
 {
-    // use file extension to determine whether to output PTX or CUBIN
-    const char* output_ext = strrchr(output_path, '.');
-    bool use_ptx = output_ext && strcmp(output_ext + 1, "ptx") == 0;
-
     // check include dir path len (path + option)
     const int max_path = 4096 + 16;
     if (strlen(include_dir) > max_path)
@@ -1615,6 +2242,22 @@ size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_
     if (fast_math)
         opts.push_back("--use_fast_math");
 
+    if (lto)
+    {
+        opts.push_back("-dlto");
+        opts.push_back("--relocatable-device-code=true");
+    }
+
+    // automatic precompiled headers avoid re-parsing builtin.h for every module (NVRTC 12.8+)
+    std::string pch_dir_opt;
+    if (pch_dir && *pch_dir)
+    {
+#if CUDA_VERSION >= 12080
+        pch_dir_opt = std::string("--pch-dir=") + pch_dir;
+        opts.push_back("--pch");
+        opts.push_back(pch_dir_opt.c_str());
+#endif
+    }
 
     nvrtcProgram prog;
     nvrtcResult res;
@@ -1658,45 +2301,32 @@ size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_
 
     nvrtcResult (*get_output_size)(nvrtcProgram, size_t*);
     nvrtcResult (*get_output_data)(nvrtcProgram, char*);
-    const char* output_mode;
+#if CUDA_VERSION >= 12040
+    if (lto)
+    {
+        get_output_size = nvrtcGetLTOIRSize;
+        get_output_data = nvrtcGetLTOIR;
+    }
+    else
+#endif
     if (use_ptx)
     {
         get_output_size = nvrtcGetPTXSize;
         get_output_data = nvrtcGetPTX;
-        output_mode = "wt";
     }
     else
     {
         get_output_size = nvrtcGetCUBINSize;
         get_output_data = nvrtcGetCUBIN;
-        output_mode = "wb";
     }
 
-    // save output
     size_t output_size;
     res = get_output_size(prog, &output_size);
     if (check_nvrtc(res))
     {
-        std::vector<char> output(output_size);
+        output.resize(output_size);
         res = get_output_data(prog, output.data());
-        if (check_nvrtc(res))
-        {
-            FILE* file = fopen(output_path, output_mode);
-            if (file)
-            {
-                if (fwrite(output.data(), 1, output_size, file) != output_size)
-                {
-                    fprintf(stderr, "Warp error: Failed to write output file '%s'\n", output_path);
-                    res = nvrtcResult(-1);
-                }
-                fclose(file);
-            }
-            else
-            {
-                fprintf(stderr, "Warp error: Failed to open output file '%s'\n", output_path);
-                res = nvrtcResult(-1);
-            }
-        }
+        check_nvrtc(res);
     }
 
     check_nvrtc(nvrtcDestroyProgram(&prog));
@@ -1704,40 +2334,158 @@ size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_
     return res;
 }
 
-void* cuda_load_module(void* context, const char* path)
+static size_t write_output_file(const char* output_path, const std::vector<char>& output, const char* output_mode)
 {
-    ContextGuard guard(context);
+    FILE* file = fopen(output_path, output_mode);
+    if (!file)
+    {
+        fprintf(stderr, "Warp error: Failed to open output file '%s'\n", output_path);
+        return size_t(-1);
+    }
 
-    // use file extension to determine whether to load PTX or CUBIN
-    const char* input_ext = strrchr(path, '.');
-    bool load_ptx = input_ext && strcmp(input_ext + 1, "ptx") == 0;
+    size_t res = 0;
+    if (fwrite(output.data(), 1, output.size(), file) != output.size())
+    {
+        fprintf(stderr, "Warp error: Failed to write output file '%s'\n", output_path);
+        res = size_t(-1);
+    }
+    fclose(file);
 
-    std::vector<char> input;
+    return res;
+}
 
-    FILE* file = fopen(path, "rb");
-    if (file)
+size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_path, const char* pch_dir)
+{
+    // use file extension to determine whether to output PTX or CUBIN
+    const char* output_ext = strrchr(output_path, '.');
+    bool use_ptx = output_ext && strcmp(output_ext + 1, "ptx") == 0;
+
+    std::vector<char> output;
+    size_t res = compile_program(cuda_src, arch, use_ptx, include_dir, debug, verbose, verify_fp, fast_math, pch_dir, output);
+    if (res != NVRTC_SUCCESS)
+        return res;
+
+    return write_output_file(output_path, output, use_ptx ? "wt" : "wb");
+}
+
+size_t cuda_compile_lto(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_path, const char* pch_dir)
+{
+#if CUDA_VERSION >= 12040
+    std::vector<char> ltoir;
+    size_t res = compile_program(cuda_src, arch, false, include_dir, debug, verbose, verify_fp, fast_math, pch_dir, ltoir, true);
+    if (res != NVRTC_SUCCESS)
+        return res;
+
+    // link-time optimization of the whole module into SASS for the target architecture
+    char arch_opt[32];
+    snprintf(arch_opt, sizeof(arch_opt), "-arch=sm_%d", arch);
+    const char* link_options[] = { "-lto", arch_opt, debug ? "-lineinfo" : "-O3" };
+
+    nvJitLinkHandle handle = NULL;
+    if (!check_nvjitlink(handle, nvJitLinkCreate(&handle, 3, link_options)))
+        return size_t(-1);
+
+    std::vector<char> output;
+    res = size_t(-1);
+    if (check_nvjitlink(handle, nvJitLinkAddData(handle, NVJITLINK_INPUT_LTOIR, ltoir.data(), ltoir.size(), "module")) &&
+        check_nvjitlink(handle, nvJitLinkComplete(handle)))
     {
-        fseek(file, 0, SEEK_END);
-        size_t length = ftell(file);
-        fseek(file, 0, SEEK_SET);
+        size_t cubin_size = 0;
+        if (check_nvjitlink(handle, nvJitLinkGetLinkedCubinSize(handle, &cubin_size)))
+        {
+            output.resize(cubin_size);
+            if (check_nvjitlink(handle, nvJitLinkGetLinkedCubin(handle, output.data())))
+                res = write_output_file(output_path, output, "wb");
+        }
+    }
 
-        input.resize(length + 1);
-        if (fread(input.data(), 1, length, file) != length)
+    if (verbose)
+    {
+        size_t log_size = 0;
+        if (nvJitLinkGetInfoLogSize(handle, &log_size) == NVJITLINK_SUCCESS && log_size > 1)
         {
-            fprintf(stderr, "Warp error: Failed to read input file '%s'\n", path);
-            fclose(file);
-            return NULL;
+            std::vector<char> log(log_size);
+            if (nvJitLinkGetInfoLog(handle, log.data()) == NVJITLINK_SUCCESS)
+                fprintf(stdout, "%s", log.data());
         }
-        fclose(file);
+    }
 
-        input[length] = '\0';
+    nvJitLinkDestroy(&handle);
+
+    return res;
+#else
+    fprintf(stderr, "Warp error: Link-time optimization requires CUDA Toolkit 12.4 or higher\n");
+    return size_t(-1);
+#endif
+}
+
+size_t cuda_compile_fatbin(const char* cuda_src, const int* archs, int num_archs, int ptx_arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_path, const char* pch_dir)
+{
+#if CUDA_VERSION >= 12040
+    nvFatbinHandle handle = NULL;
+    const char* fatbin_options[] = { "-64" };
+    if (!check_nvfatbin(nvFatbinCreate(&handle, fatbin_options, 1)))
+        return size_t(-1);
+
+    size_t res = 0;
+    char arch_str[16];
+    std::vector<char> output;
+
+    // SASS for every requested architecture
+    for (int i = 0; i < num_archs && res == 0; i++)
+    {
+        res = compile_program(cuda_src, archs[i], false, include_dir, debug, verbose, verify_fp, fast_math, pch_dir, output);
+        if (res == 0)
+        {
+            snprintf(arch_str, sizeof(arch_str), "%d", archs[i]);
+            if (!check_nvfatbin(nvFatbinAddCubin(handle, output.data(), output.size(), arch_str, NULL)))
+                res = size_t(-1);
+        }
     }
-    else
+
+    // PTX fallback for architectures that are not covered by SASS
+    if (res == 0 && ptx_arch > 0)
     {
-        fprintf(stderr, "Warp error: Failed to open input file '%s'\n", path);
-        return NULL;
+        res = compile_program(cuda_src, ptx_arch, true, include_dir, debug, verbose, verify_fp, fast_math, pch_dir, output);
+        if (res == 0)
+        {
+            snprintf(arch_str, sizeof(arch_str), "%d", ptx_arch);
+            if (!check_nvfatbin(nvFatbinAddPTX(handle, output.data(), output.size(), arch_str, NULL, NULL)))
+                res = size_t(-1);
+        }
+    }
+
+    if (res == 0)
+    {
+        size_t fatbin_size = 0;
+        if (check_nvfatbin(nvFatbinSize(handle, &fatbin_size)))
+        {
+            output.resize(fatbin_size);
+            if (check_nvfatbin(nvFatbinGet(handle, output.data())))
+                res = write_output_file(output_path, output, "wb");
+            else
+                res = size_t(-1);
+        }
+        else
+        {
+            res = size_t(-1);
+        }
     }
 
+    check_nvfatbin(nvFatbinDestroy(&handle));
+
+    return res;
+#else
+    fprintf(stderr, "Warp error: Building fat binaries requires CUDA Toolkit 12.4 or higher\n");
+    return size_t(-1);
+#endif
+}
+
+// loads a null-terminated PTX or a CUBIN/fatbin image into the given context
+static void* load_module_image(void* context, const std::vector<char>& input, bool load_ptx)
+{
+    ContextGuard guard(context);
+
     int driver_cuda_version = 0;
     CUmodule module = NULL;
 
@@ -1823,6 +2571,51 @@ void* cuda_load_module(void* context, const char* path)
     return module;
 }
 
+void* cuda_load_module(void* context, const char* path)
+{
+    // use file extension to determine whether to load PTX or CUBIN
+    const char* input_ext = strrchr(path, '.');
+    bool load_ptx = input_ext && strcmp(input_ext + 1, "ptx") == 0;
+
+    std::vector<char> input;
+
+    FILE* file = fopen(path, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        size_t length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        input.resize(length + 1);
+        if (fread(input.data(), 1, length, file) != length)
+        {
+            fprintf(stderr, "Warp error: Failed to read input file '%s'\n", path);
+            fclose(file);
+            return NULL;
+        }
+        fclose(file);
+
+        input[length] = '\0';
+    }
+    else
+    {
+        fprintf(stderr, "Warp error: Failed to open input file '%s'\n", path);
+        return NULL;
+    }
+
+    return load_module_image(context, input, load_ptx);
+}
+
+void* cuda_load_module_data(void* context, const void* data, size_t size, bool is_ptx)
+{
+    // PTX images are passed to the driver and compiler as null-terminated strings
+    std::vector<char> input(size + 1);
+    memcpy(input.data(), data, size);
+    input[size] = '\0';
+
+    return load_module_image(context, input, is_ptx);
+}
+
 void cuda_unload_module(void* context, void* module)
 {
     ContextGuard guard(context);
@@ -1841,18 +2634,55 @@ void* cuda_get_kernel(void* context, void* module, const char* name)
     return kernel;
 }
 
-size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, void** args)
+int cuda_get_kernel_occupancy_block_dim(void* context, void* kernel)
 {
     ContextGuard guard(context);
 
-    const int block_dim = 256;
-    // CUDA specs up to compute capability 9.0 says the max x-dim grid is 2**31-1, so
-    // grid_dim is fine as an int for the near future
-    const int grid_dim = (dim + block_dim - 1)/block_dim;
+    int min_grid_size = 0;
+    int block_size = 0;
+
+    // kernels don't use dynamic shared memory
+    if (!check_cu(cuOccupancyMaxPotentialBlockSize_f(&min_grid_size, &block_size, (CUfunction)kernel, NULL, 0, 0)))
+        return 0;
+
+    return block_size;
+}
+
+// CUDA specs up to compute capability 9.0 say the max grid is 2**31-1 blocks along x and 65535 along y,
+// launches with more blocks than the x-dim limit are folded into rows of the grid, grid_index() in builtin.h
+// linearizes the block index and the kernels discard the threads past the launch size
+static bool get_launch_grid(size_t dim, int block_dim, unsigned int& grid_x, unsigned int& grid_y)
+{
+    const size_t max_grid_x = 2147483647;
+    const size_t max_grid_y = 65535;
+
+    const size_t num_blocks = (dim + block_dim - 1)/block_dim;
+    const size_t num_rows = (num_blocks + max_grid_x - 1)/max_grid_x;
+    if (num_rows > max_grid_y)
+    {
+        fprintf(stderr, "Warp CUDA error: Launch size %llu exceeds the maximum grid size\n", (unsigned long long)dim);
+        return false;
+    }
+
+    grid_x = (unsigned int)(num_rows > 1 ? max_grid_x : num_blocks);
+    grid_y = (unsigned int)num_rows;
+    return true;
+}
+
+size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, int block_dim, void** args)
+{
+    ContextGuard guard(context);
+
+    if (block_dim <= 0)
+        block_dim = 256;
+
+    unsigned int grid_x, grid_y;
+    if (!get_launch_grid(dim, block_dim, grid_x, grid_y))
+        return CUDA_ERROR_INVALID_VALUE;
 
     CUresult res = cuLaunchKernel_f(
         (CUfunction)kernel,
-        grid_dim, 1, 1,
+        grid_x, grid_y, 1,
         block_dim, 1, 1,
         0, get_current_stream(),
         args,
@@ -1863,6 +2693,207 @@ size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, void** args)
     return res;
 }
 
+size_t cuda_launch_kernels(void* context, void** kernels, int* block_dims, void*** args, int count)
+{
+    ContextGuard guard(context);
+
+    CUstream stream = get_current_stream();
+
+    for (int i = 0; i < count; ++i)
+    {
+        // the launch bounds are the first parameter of every kernel, they are read at submission so that
+        // the dimensions can be patched between submissions like the other parameters
+        const wp::launch_bounds_t* bounds = static_cast<const wp::launch_bounds_t*>(args[i][0]);
+        if (bounds->size == 0)
+            continue;
+
+        const int block_dim = block_dims[i] > 0 ? block_dims[i] : 256;
+
+        unsigned int grid_x, grid_y;
+        if (!get_launch_grid(bounds->size, block_dim, grid_x, grid_y))
+            return CUDA_ERROR_INVALID_VALUE;
+
+        CUresult res = cuLaunchKernel_f(
+            (CUfunction)kernels[i],
+            grid_x, grid_y, 1,
+            block_dim, 1, 1,
+            0, stream,
+            args[i],
+            0);
+
+        if (!check_cu(res))
+            return res;
+    }
+
+    return CUDA_SUCCESS;
+}
+
+size_t cuda_launch_persistent_kernel(void* context, void* kernel, void* tasks, int num_tasks, void* barrier, size_t max_dim)
+{
+    ContextGuard guard(context);
+
+    if (num_tasks <= 0 || max_dim == 0)
+        return CUDA_SUCCESS;
+
+    // the barriers between tasks need all blocks of the grid to be resident at once, the occupancy
+    // query returns the number of blocks that fill the device at the block size it picks
+    int max_grid_dim = 0;
+    int block_dim = 0;
+    if (!check_cu(cuOccupancyMaxPotentialBlockSize_f(&max_grid_dim, &block_dim, (CUfunction)kernel, NULL, 0, 256)))
+        return CUDA_ERROR_INVALID_VALUE;
+
+    const size_t num_blocks = (max_dim + block_dim - 1)/block_dim;
+    const unsigned int grid_dim = (unsigned int)std::max(size_t(1), std::min(num_blocks, size_t(max_grid_dim)));
+
+    CUstream stream = get_current_stream();
+
+    if (!check_cuda(cudaMemsetAsync(barrier, 0, sizeof(unsigned int), stream)))
+        return CUDA_ERROR_INVALID_VALUE;
+
+    void* args[] = { &tasks, &num_tasks, &barrier };
+
+    // cooperative launches fail rather than deadlock when the blocks can't all be resident
+    CUresult res = cuLaunchCooperativeKernel_f(
+        (CUfunction)kernel,
+        grid_dim, 1, 1,
+        block_dim, 1, 1,
+        0, stream,
+        args);
+
+    check_cu(res);
+
+    return res;
+}
+
+size_t cuda_launch_kernels_multi(void** contexts, void** streams, void** kernels, int* block_dims, void*** args, int count)
+{
+    // a single call enqueues the launches on all devices, each is asynchronous so the devices run concurrently
+    for (int i = 0; i < count; ++i)
+    {
+        ContextGuard guard(contexts[i]);
+
+        const wp::launch_bounds_t* bounds = static_cast<const wp::launch_bounds_t*>(args[i][0]);
+        if (bounds->size == 0)
+            continue;
+
+        const int block_dim = block_dims[i] > 0 ? block_dims[i] : 256;
+
+        unsigned int grid_x, grid_y;
+        if (!get_launch_grid(bounds->size, block_dim, grid_x, grid_y))
+            return CUDA_ERROR_INVALID_VALUE;
+
+        CUresult res = cuLaunchKernel_f(
+            (CUfunction)kernels[i],
+            grid_x, grid_y, 1,
+            block_dim, 1, 1,
+            0, static_cast<CUstream>(streams[i]),
+            args[i],
+            0);
+
+        if (!check_cu(res))
+            return res;
+    }
+
+    return CUDA_SUCCESS;
+}
+
+// descriptor of a kernel launch made by an XLA custom call, followed by a (context, kernel) pair for each device
+// the computation may run on and by the kernel parameters (see jax_kernel() in warp/jax.py)
+struct JaxLaunchHeader
+{
+    uint64_t dim;
+    int32_t block_dim;
+    int32_t num_kernels;
+    int32_t num_params;
+    int32_t padding;
+};
+
+// each parameter value is padded to 8 bytes, array parameters take their data pointer from an XLA buffer
+struct JaxLaunchParam
+{
+    int32_t size;
+    int32_t buffer; // -1 for plain values
+};
+
+void cuda_jax_custom_call(void* stream, void** buffers, const char* opaque, size_t opaque_len)
+{
+    // the parameters are patched in a copy of the descriptor
+    static thread_local std::vector<uint64_t> storage;
+    static thread_local std::vector<void*> params;
+
+    if (opaque_len < sizeof(JaxLaunchHeader))
+    {
+        fprintf(stderr, "Warp error: Invalid JAX launch descriptor\n");
+        return;
+    }
+
+    storage.resize((opaque_len + 7) / 8);
+    memcpy(storage.data(), opaque, opaque_len);
+
+    char* data = reinterpret_cast<char*>(storage.data());
+    const JaxLaunchHeader& header = *reinterpret_cast<const JaxLaunchHeader*>(data);
+    size_t offset = sizeof(JaxLaunchHeader);
+
+    // XLA runs the custom call with the context of the stream's device current
+    CUcontext context = get_current_context();
+    CUfunction kernel = NULL;
+    for (int i = 0; i < header.num_kernels && offset + 2 * sizeof(uint64_t) <= opaque_len; ++i, offset += 2 * sizeof(uint64_t))
+    {
+        const uint64_t* entry = reinterpret_cast<const uint64_t*>(data + offset);
+        if (entry[0] == uint64_t(context))
+            kernel = reinterpret_cast<CUfunction>(entry[1]);
+    }
+
+    if (!kernel)
+    {
+        fprintf(stderr, "Warp error: JAX custom call kernel is not loaded on the current device\n");
+        return;
+    }
+
+    params.resize(header.num_params);
+    for (int i = 0; i < header.num_params; ++i)
+    {
+        if (offset + sizeof(JaxLaunchParam) > opaque_len)
+        {
+            fprintf(stderr, "Warp error: Invalid JAX launch descriptor\n");
+            return;
+        }
+
+        const JaxLaunchParam param = *reinterpret_cast<const JaxLaunchParam*>(data + offset);
+        offset += sizeof(JaxLaunchParam);
+
+        if (offset + param.size > opaque_len)
+        {
+            fprintf(stderr, "Warp error: Invalid JAX launch descriptor\n");
+            return;
+        }
+
+        // the data pointer is the first member of array_t
+        if (param.buffer >= 0)
+            memcpy(data + offset, &buffers[param.buffer], sizeof(void*));
+
+        params[i] = data + offset;
+        offset += (size_t(param.size) + 7) & ~size_t(7);
+    }
+
+    if (header.dim == 0)
+        return;
+
+    const int block_dim = header.block_dim > 0 ? header.block_dim : 256;
+
+    unsigned int grid_x, grid_y;
+    if (!get_launch_grid(header.dim, block_dim, grid_x, grid_y))
+        return;
+
+    check_cu(cuLaunchKernel_f(
+        kernel,
+        grid_x, grid_y, 1,
+        block_dim, 1, 1,
+        0, static_cast<CUstream>(stream),
+        params.data(),
+        0));
+}
+
 void cuda_graphics_map(void* context, void* resource)
 {
     ContextGuard guard(context);
@@ -1899,6 +2930,36 @@ void* cuda_graphics_register_gl_buffer(void* context, uint32_t gl_buffer, unsign
     return resource;
 }
 
+void* cuda_graphics_register_gl_image(void* context, uint32_t gl_image, uint32_t target, unsigned int flags)
+{
+    ContextGuard guard(context);
+
+    CUgraphicsResource *resource = new CUgraphicsResource;
+    check_cu(cuGraphicsGLRegisterImage_f(resource, gl_image, target, flags));
+
+    return resource;
+}
+
+void cuda_graphics_copy_image(void* context, void* resource, uint64_t dst, size_t dst_pitch, size_t width_bytes, size_t height)
+{
+    ContextGuard guard(context);
+
+    // mapped images are opaque CUDA arrays, copy the base level into linear memory so kernels can read it
+    CUarray array;
+    check_cu(cuGraphicsSubResourceGetMappedArray_f(&array, *(CUgraphicsResource*)resource, 0, 0));
+
+    CUDA_MEMCPY2D copy = {};
+    copy.srcMemoryType = CU_MEMORYTYPE_ARRAY;
+    copy.srcArray = array;
+    copy.dstMemoryType = CU_MEMORYTYPE_DEVICE;
+    copy.dstDevice = (CUdeviceptr)dst;
+    copy.dstPitch = dst_pitch;
+    copy.WidthInBytes = width_bytes;
+    copy.Height = height;
+
+    check_cu(cuMemcpy2DAsync_f(&copy, get_current_stream()));
+}
+
 void cuda_graphics_unregister_resource(void* context, void* resource)
 {
     ContextGuard guard(context);
@@ -1912,11 +2973,14 @@ void cuda_graphics_unregister_resource(void* context, void* resource)
 // impl. files
 #include "bvh.cu"
 #include "mesh.cu"
+#include "tlas.cu"
 #include "sort.cu"
+#include "segmented.cu"
 #include "hashgrid.cu"
 #include "reduce.cu"
 #include "runlength_encode.cu"
 #include "scan.cu"
+#include "neighbor_list.cu"
 #include "marching.cu"
 #include "sparse.cu"
 #include "volume.cu"
@@ -11,6 +11,11 @@
 // defines all crt + builtin types
 #include "builtin.h"
 
+// reduction operations for segmented_reduce_*(), must match warp.utils
+#define WP_SEGMENTED_REDUCE_SUM 0
+#define WP_SEGMENTED_REDUCE_MIN 1
+#define WP_SEGMENTED_REDUCE_MAX 2
+
 // this is the core runtime API exposed on the DLL level
 extern "C"
 {
@@ -33,11 +38,38 @@ extern "C"
     WP_API void* alloc_pinned(size_t s);
     WP_API void* alloc_device(void* context, size_t s);
     WP_API void* alloc_temp_device(void* context, size_t s);
+    // unified memory that is accessible from the host and all devices, pages migrate on demand
+    WP_API void* alloc_managed(void* context, size_t s);
 
     WP_API void free_host(void* ptr);
     WP_API void free_pinned(void* ptr);
     WP_API void free_device(void* context, void* ptr);
     WP_API void free_temp_device(void* context, void* ptr);
+    WP_API void free_managed(void* context, void* ptr);
+
+    // pinned allocations are pooled, freed blocks are reused once the transfers that used them have completed
+    WP_API void pinned_pool_release();
+    WP_API void pinned_pool_get_stats(uint64_t* used_current, uint64_t* used_high, uint64_t* reserved_current, uint64_t* reserved_high);
+
+    // memory accounting of the allocators per memory space and tag, spaces are device ordinals or one of the
+    // WP_MEMORY_SPACE values, tag 0 is the untagged memory and registering a name again returns the same tag
+    #define WP_MEMORY_SPACE_HOST -1
+    #define WP_MEMORY_SPACE_PINNED -2
+    #define WP_MEMORY_HISTOGRAM_BINS 48
+    WP_API int memory_tag_register(const char* name);
+    WP_API const char* memory_tag_name(int tag);
+    WP_API int memory_tag_count();
+    // sets the tag of the allocations made by the calling thread and returns the previous one
+    WP_API int memory_tag_set(int tag);
+    // tag -1 queries the totals of the space, the histogram counts the live allocations in (2^(b-1), 2^b] bytes,
+    // returns 0 if nothing was allocated in the space with the tag
+    WP_API int memory_stats_get(int space, int tag, uint64_t* current, uint64_t* peak, uint64_t* count, uint64_t* histogram);
+    WP_API void memory_stats_reset_peak(int space);
+
+    // migrates managed memory to a device ahead of use on the current stream, ordinal -1 is the host
+    WP_API int memprefetch_managed(void* context, void* ptr, size_t n, int ordinal);
+    // sets or unsets a cudaMemoryAdvise hint on managed memory, ordinal -1 is the host
+    WP_API int memadvise_managed(void* context, void* ptr, size_t n, int advice, int ordinal);
 
     // all memcpys are performed asynchronously
     WP_API void memcpy_h2h(void* dest, void* src, size_t n);
@@ -57,32 +89,114 @@ extern "C"
 	WP_API uint64_t bvh_create_host(wp::vec3* lowers, wp::vec3* uppers, int num_bounds);
 	WP_API void bvh_destroy_host(uint64_t id);
     WP_API void bvh_refit_host(uint64_t id);
+    WP_API void bvh_build_wide_host(uint64_t id);
+    WP_API void bvh_query_bvh_overlap_host(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    WP_API void bvh_query_self_overlap_host(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
 
 	WP_API uint64_t bvh_create_device(void* context, wp::vec3* lowers, wp::vec3* uppers, int num_bounds);
 	WP_API void bvh_destroy_device(uint64_t id);
     WP_API void bvh_refit_device(uint64_t id);
+    WP_API void bvh_build_wide_device(uint64_t id);
+    WP_API void bvh_build_refit_levels_device(uint64_t id);
+    // copies a device BVH to the device of context without rebuilding it, lowers and uppers must live on that device
+    WP_API uint64_t bvh_clone_to_device(void* context, uint64_t id, wp::vec3* lowers, wp::vec3* uppers);
+    WP_API void bvh_query_bvh_overlap_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    WP_API void bvh_query_self_overlap_device(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
 
     // create a user-accessible copy of the mesh, it is the 
     // users responsibility to keep-alive the points/tris data for the duration of the mesh lifetime
 	WP_API uint64_t mesh_create_host(wp::array_t<wp::vec3> points, wp::array_t<wp::vec3> velocities, wp::array_t<int> tris, int num_points, int num_tris, int support_winding_number);
 	WP_API void mesh_destroy_host(uint64_t id);
     WP_API void mesh_refit_host(uint64_t id);
+    // deforms the points of a mesh from rest positions by linear-blend skinning and refits it, see mesh_skin_point()
+    WP_API void mesh_skin_host(uint64_t id, const wp::vec3* rest_points, const wp::transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, wp::transform* xform);
+    WP_API void mesh_refit_partial_host(uint64_t id, const int* dirty_tris, int num_dirty);
+    WP_API void mesh_refit_solid_angle_host(uint64_t id);
+    WP_API void mesh_build_wide_host(uint64_t id);
+    WP_API void mesh_quantize_host(uint64_t id);
+    // permutes the triangles of a new mesh (and optionally its points, if point_permutation is not NULL) to the order
+    // of the BVH leaves, writes the original index of each triangle and point
+    WP_API void mesh_reorder_host(uint64_t id, int* tri_permutation, int* point_permutation);
+    WP_API void mesh_raycast_batch_host(uint64_t id, wp::vec3* origins, wp::vec3* dirs, int num_rays, float max_t, float* out_t, int* out_face, wp::vec2* out_uv, wp::vec3* out_normal, int sort_rays);
+    WP_API void mesh_query_point_batch_host(uint64_t id, wp::vec3* points, int num_points, float max_dist, int* out_face, wp::vec2* out_uv, float* out_dist, int sort_points);
+    WP_API void mesh_query_mesh_overlap_host(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    // pairs of triangles of the mesh and items of a BVH, e.g.: built from particle bounds
+    WP_API void mesh_query_bvh_overlap_host(uint64_t mesh_id, uint64_t bvh_id, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    WP_API void mesh_query_self_overlap_host(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    // intersecting triangle pairs of two meshes and their intersection segments (optional, 2 points per pair)
+    WP_API void mesh_query_mesh_intersections_host(uint64_t id_a, uint64_t id_b, wp::transform* xform, wp::vec2i* pairs, wp::vec3* segments, int max_pairs, int* pair_count);
 
 	WP_API uint64_t mesh_create_device(void* context, wp::array_t<wp::vec3> points, wp::array_t<wp::vec3> velocities, wp::array_t<int> tris, int num_points, int num_tris, int support_winding_number);
 	WP_API void mesh_destroy_device(uint64_t id);
+    // copies a device mesh to the device of context without rebuilding its BVH, the arrays must live on that device
+    WP_API uint64_t mesh_clone_to_device(void* context, uint64_t id, wp::array_t<wp::vec3> points, wp::array_t<wp::vec3> velocities, wp::array_t<int> tris);
+    // creates num_meshes meshes over concatenated points and triangles in one batched build, the points and triangles
+    // of mesh i are points[point_offsets[i]:point_offsets[i+1]] and tris[3*tri_offsets[i]:3*tri_offsets[i+1]], whose
+    // indices refer to the points of the mesh, offsets live on the host and every mesh needs at least one triangle
+    WP_API void mesh_create_batch_device(void* context, wp::vec3* points, wp::vec3* velocities, int* tris, const int* point_offsets, const int* tri_offsets, int num_meshes, int support_winding_number, uint64_t* ids);
     WP_API void mesh_refit_device(uint64_t id);
-
-    WP_API uint64_t hash_grid_create_host(int dim_x, int dim_y, int dim_z);
+    WP_API void mesh_skin_device(uint64_t id, const wp::vec3* rest_points, const wp::transform* bones, const int* bone_indices, const float* bone_weights, int bones_per_point, wp::transform* xform);
+    WP_API void mesh_refit_partial_device(uint64_t id, const int* dirty_tris, int num_dirty);
+    WP_API void mesh_refit_solid_angle_device(uint64_t id);
+    WP_API void mesh_build_wide_device(uint64_t id);
+    WP_API void mesh_quantize_device(uint64_t id);
+    WP_API void mesh_reorder_device(uint64_t id, int* tri_permutation, int* point_permutation);
+    WP_API void mesh_build_refit_levels_device(uint64_t id);
+    WP_API void mesh_raycast_batch_device(uint64_t id, wp::vec3* origins, wp::vec3* dirs, int num_rays, float max_t, float* out_t, int* out_face, wp::vec2* out_uv, wp::vec3* out_normal, int sort_rays);
+    WP_API void mesh_query_point_batch_device(uint64_t id, wp::vec3* points, int num_points, float max_dist, int* out_face, wp::vec2* out_uv, float* out_dist, int sort_points);
+    WP_API void mesh_query_mesh_overlap_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    WP_API void mesh_query_bvh_overlap_device(uint64_t mesh_id, uint64_t bvh_id, wp::transform* xform, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    WP_API void mesh_query_self_overlap_device(uint64_t id, float margin, wp::vec2i* pairs, int max_pairs, int* pair_count);
+    WP_API void mesh_query_mesh_intersections_device(uint64_t id_a, uint64_t id_b, wp::transform* xform, wp::vec2i* pairs, wp::vec3* segments, int max_pairs, int* pair_count);
+
+    WP_API uint64_t tlas_create_host(uint64_t* meshes, wp::transform* transforms, int num_instances);
+    WP_API void tlas_destroy_host(uint64_t id);
+    WP_API void tlas_refit_host(uint64_t id);
+
+    WP_API uint64_t tlas_create_device(void* context, uint64_t* meshes, wp::transform* transforms, int num_instances);
+    WP_API void tlas_destroy_device(uint64_t id);
+    WP_API void tlas_refit_device(uint64_t id);
+
+    WP_API uint64_t hash_grid_create_host(int dim_x, int dim_y, int dim_z, int morton);
+    WP_API uint64_t hash_grid_create_sparse_host();
+    WP_API uint64_t hash_grid_create_levels_host(float base_radius, int num_levels);
     WP_API void hash_grid_reserve_host(uint64_t id, int num_points);
     WP_API void hash_grid_destroy_host(uint64_t id);
     WP_API void hash_grid_update_host(uint64_t id, float cell_width, const wp::vec3* positions, int num_points);
-
-    WP_API uint64_t hash_grid_create_device(void* context, int dim_x, int dim_y, int dim_z);
+    WP_API void hash_grid_update_levels_host(uint64_t id, const wp::vec3* positions, const float* radii, int num_points);
+    WP_API uint64_t hash_grid_get_point_ids_host(uint64_t id);
+    WP_API void hash_grid_permute_host(uint64_t id, void* dst, const void* src, int element_size);
+    WP_API void hash_grid_reset_order_host(uint64_t id);
+
+    WP_API uint64_t hash_grid_create_device(void* context, int dim_x, int dim_y, int dim_z, int morton);
+    WP_API uint64_t hash_grid_create_sparse_device(void* context);
+    WP_API uint64_t hash_grid_create_levels_device(void* context, float base_radius, int num_levels);
     WP_API void hash_grid_reserve_device(uint64_t id, int num_points);
     WP_API void hash_grid_destroy_device(uint64_t id);
     WP_API void hash_grid_update_device(uint64_t id, float cell_width, const wp::vec3* positions, int num_points);
-
-    WP_API bool cutlass_gemm(int compute_capability, int m, int n, int k, const char* datatype,
+    WP_API void hash_grid_update_levels_device(uint64_t id, const wp::vec3* positions, const float* radii, int num_points);
+    WP_API uint64_t hash_grid_get_point_ids_device(uint64_t id);
+    WP_API void hash_grid_permute_device(uint64_t id, void* dst, const void* src, int element_size);
+    WP_API void hash_grid_reset_order_device(uint64_t id);
+
+    WP_API uint64_t neighbor_list_create_host();
+    WP_API void neighbor_list_destroy_host(uint64_t id);
+    WP_API int neighbor_list_build_host(uint64_t id, uint64_t grid, const wp::vec3* points, int num_points, float radius);
+    WP_API int neighbor_list_check_host(uint64_t id, const wp::vec3* points, int num_points, float max_displacement);
+    WP_API uint64_t neighbor_list_get_offsets_host(uint64_t id);
+    WP_API uint64_t neighbor_list_get_neighbors_host(uint64_t id);
+
+    WP_API uint64_t neighbor_list_create_device(void* context);
+    WP_API void neighbor_list_destroy_device(uint64_t id);
+    WP_API int neighbor_list_build_device(uint64_t id, uint64_t grid, const wp::vec3* points, int num_points, float radius);
+    WP_API int neighbor_list_check_device(uint64_t id, const wp::vec3* points, int num_points, float max_displacement);
+    WP_API uint64_t neighbor_list_get_offsets_device(uint64_t id);
+    WP_API uint64_t neighbor_list_get_neighbors_device(uint64_t id);
+
+    WP_API int knn_graph_host(uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius, int* offsets, int* indices, float* distances);
+    WP_API int knn_graph_device(void* context, uint64_t grid, const wp::vec3* points, int num_points, int k, float radius, float max_radius, int* offsets, int* indices, float* distances);
+
+    WP_API bool cutlass_gemm(int compute_capability, int m, int n, int k, const char* datatype, const char* datatype_out,
                              const void* a, const void* b, const void* c, void* d, float alpha, float beta,
                              bool row_major_a, bool row_major_b, bool allow_tf32x3_arith, int batch_count);
 
@@ -90,20 +204,54 @@ extern "C"
     WP_API void volume_get_buffer_info_host(uint64_t id, void** buf, uint64_t* size);
     WP_API void volume_get_tiles_host(uint64_t id, void** buf, uint64_t* size);
     WP_API void volume_destroy_host(uint64_t id);
+    WP_API uint64_t volume_load_nvdb_host(const char* path);
+    WP_API void* volume_prefetch_nvdb_host(const char* path);
 
     WP_API uint64_t volume_create_device(void* context, void* buf, uint64_t size);
     WP_API uint64_t volume_f_from_tiles_device(void* context, void* points, int num_points, float voxel_size, float bg_value, float tx, float ty, float tz, bool points_in_world_space);
     WP_API uint64_t volume_v_from_tiles_device(void* context, void* points, int num_points, float voxel_size, float bg_value_x, float bg_value_y, float bg_value_z, float tx, float ty, float tz, bool points_in_world_space);
     WP_API uint64_t volume_i_from_tiles_device(void* context, void* points, int num_points, float voxel_size, int bg_value, float tx, float ty, float tz, bool points_in_world_space);
+    WP_API uint64_t volume_f_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, float bg_value, float tolerance, float tx, float ty, float tz);
+    WP_API uint64_t volume_v_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, float bg_value_x, float bg_value_y, float bg_value_z, float tolerance, float tx, float ty, float tz);
+    WP_API uint64_t volume_i_from_dense_device(void* context, void* values, int nx, int ny, int nz, float voxel_size, int bg_value, float tolerance, float tx, float ty, float tz);
+    WP_API uint64_t volume_sdf_from_mesh_device(void* context, uint64_t mesh, float voxel_size, float narrow_band, float tx, float ty, float tz);
+    WP_API uint64_t volume_quantize_device(void* context, uint64_t id, int bits);
+    WP_API uint64_t volume_clone_to_device(void* context, uint64_t id);
+    // topology edits rebuild the volume in its own buffer when it fits and return its id, which changes otherwise
+    WP_API uint64_t volume_activate_tiles_device(void* context, uint64_t id, void* points, int num_points, bool points_in_world_space);
+    WP_API uint64_t volume_dilate_device(void* context, uint64_t id, int voxels);
+    WP_API uint64_t volume_prune_device(void* context, uint64_t id, float tolerance);
     WP_API void volume_get_buffer_info_device(uint64_t id, void** buf, uint64_t* size);
     WP_API void volume_get_tiles_device(uint64_t id, void** buf, uint64_t* size);
     WP_API void volume_destroy_device(uint64_t id);
+    WP_API uint64_t volume_load_nvdb_device(void* context, const char* path);
+    WP_API void* volume_prefetch_nvdb_device(void* context, const char* path);
+
+    // waits for a prefetch started by volume_prefetch_nvdb_host/device() and returns the volume id (0 on failure)
+    WP_API uint64_t volume_prefetch_wait(void* handle);
 
     WP_API void volume_get_voxel_size(uint64_t id, float* dx, float* dy, float* dz);
+
+    WP_API uint64_t volume_atlas_create_host(uint64_t* ids, int count);
+    WP_API uint64_t volume_atlas_create_device(void* context, uint64_t* ids, int count);
+    WP_API void volume_atlas_destroy_host(uint64_t id);
+    WP_API void volume_atlas_destroy_device(uint64_t id);
+
+    WP_API uint64_t texture3d_create_host(void* data, int nx, int ny, int nz, bool half_storage, int filter_mode, int address_mode);
+    WP_API void texture3d_destroy_host(uint64_t id);
+    WP_API uint64_t texture3d_create_device(void* context, void* data, int nx, int ny, int nz, bool half_storage, int filter_mode, int address_mode);
+    WP_API void texture3d_destroy_device(uint64_t id);
     
+    WP_API uint64_t marching_cubes_create_host();
+    WP_API void marching_cubes_destroy_host(uint64_t id);
+    WP_API int marching_cubes_surface_host(uint64_t id, const float* field, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* out_num_verts, int* out_num_tris);
+    WP_API int marching_cubes_surface_batch_host(uint64_t id, const float* fields, int num_fields, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* vert_offsets, int* tri_offsets);
+
     WP_API uint64_t marching_cubes_create_device(void* context);
     WP_API void marching_cubes_destroy_device(uint64_t id);
     WP_API int marching_cubes_surface_device(uint64_t id, const float* field, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* out_num_verts, int* out_num_tris);
+    WP_API int marching_cubes_surface_batch_device(uint64_t id, const float* fields, int num_fields, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* vert_offsets, int* tri_offsets);
+    WP_API int marching_cubes_surface_volume_device(uint64_t id, uint64_t volume, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* out_num_verts, int* out_num_tris);
 
     // generic copy supporting non-contiguous arrays
     WP_API size_t array_copy_host(void* dst, void* src, int dst_type, int src_type, int elem_size);
@@ -123,14 +271,44 @@ extern "C"
     WP_API void array_sum_double_host(uint64_t a, uint64_t out, int count, int stride, int type_len);
     WP_API void array_sum_double_device(uint64_t a, uint64_t out, int count, int stride, int type_len);
 
+    // fused single-pass reductions, statistics with a null output pointer are not stored
+    WP_API void array_stats_float_host(uint64_t a, int count, int stride, int type_len, uint64_t out_sum, uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax);
+    WP_API void array_stats_double_host(uint64_t a, int count, int stride, int type_len, uint64_t out_sum, uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax);
+    WP_API void array_stats_float_device(uint64_t a, int count, int stride, int type_len, uint64_t out_sum, uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax);
+    WP_API void array_stats_double_device(uint64_t a, int count, int stride, int type_len, uint64_t out_sum, uint64_t out_min, uint64_t out_max, uint64_t out_argmin, uint64_t out_argmax);
+
     WP_API void array_scan_int_host(uint64_t in, uint64_t out, int len, bool inclusive);
     WP_API void array_scan_float_host(uint64_t in, uint64_t out, int len, bool inclusive);
 
     WP_API void array_scan_int_device(uint64_t in, uint64_t out, int len, bool inclusive);
     WP_API void array_scan_float_device(uint64_t in, uint64_t out, int len, bool inclusive);
 
-    WP_API void radix_sort_pairs_int_host(uint64_t keys, uint64_t values, int n);
-    WP_API void radix_sort_pairs_int_device(uint64_t keys, uint64_t values, int n);
+    // scans of vector, matrix or homogeneous struct elements, optionally restarted at each segment of segment_offsets
+    WP_API void array_scan_vec_int_host(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments);
+    WP_API void array_scan_vec_float_host(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments);
+    WP_API void array_scan_vec_double_host(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments);
+    WP_API void array_scan_vec_int_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments);
+    WP_API void array_scan_vec_float_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments);
+    WP_API void array_scan_vec_double_device(uint64_t in, uint64_t out, int len, int type_len, bool inclusive, uint64_t segment_offsets, int num_segments);
+
+    WP_API void radix_sort_pairs_int_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_int_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_int64_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_int64_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_uint64_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_uint64_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_float_host(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+    WP_API void radix_sort_pairs_float_device(uint64_t keys, uint64_t values, int n, int begin_bit, int end_bit);
+
+    WP_API void segmented_sort_pairs_int_host(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments);
+    WP_API void segmented_sort_pairs_int_device(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments);
+    WP_API void segmented_sort_pairs_float_host(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments);
+    WP_API void segmented_sort_pairs_float_device(uint64_t keys, uint64_t values, int n, uint64_t segment_offsets, int num_segments);
+
+    WP_API void segmented_reduce_int_host(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op);
+    WP_API void segmented_reduce_int_device(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op);
+    WP_API void segmented_reduce_float_host(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op);
+    WP_API void segmented_reduce_float_device(uint64_t values, uint64_t out, uint64_t segment_offsets, int num_segments, int op);
 
     WP_API void runlength_encode_int_host(uint64_t values, uint64_t run_values, uint64_t run_lengths, uint64_t run_count, int n);
     WP_API void runlength_encode_int_device(uint64_t values, uint64_t run_values, uint64_t run_lengths, uint64_t run_count, int n);
@@ -145,7 +323,9 @@ extern "C"
         uint64_t tpl_values,
         uint64_t bsr_offsets,
         uint64_t bsr_columns,
-        uint64_t bsr_values);
+        uint64_t bsr_values,
+        uint64_t tpl_block_offsets,
+        uint64_t tpl_block_indices);
     WP_API int bsr_matrix_from_triplets_double_host(
         int rows_per_block,
         int cols_per_block,
@@ -156,7 +336,9 @@ extern "C"
         uint64_t tpl_values,
         uint64_t bsr_offsets,
         uint64_t bsr_columns,
-        uint64_t bsr_values);
+        uint64_t bsr_values,
+        uint64_t tpl_block_offsets,
+        uint64_t tpl_block_indices);
 
     WP_API int bsr_matrix_from_triplets_float_device(
         int rows_per_block,
@@ -168,7 +350,9 @@ extern "C"
         uint64_t tpl_values,
         uint64_t bsr_offsets,
         uint64_t bsr_columns,
-        uint64_t bsr_values);
+        uint64_t bsr_values,
+        uint64_t tpl_block_offsets,
+        uint64_t tpl_block_indices);
     WP_API int bsr_matrix_from_triplets_double_device(
         int rows_per_block,
         int cols_per_block,
@@ -179,7 +363,16 @@ extern "C"
         uint64_t tpl_values,
         uint64_t bsr_offsets,
         uint64_t bsr_columns,
-        uint64_t bsr_values);
+        uint64_t bsr_values,
+        uint64_t tpl_block_offsets,
+        uint64_t tpl_block_indices);
+
+    WP_API void bsr_set_triplet_values_float_host(int block_size, int nnz, uint64_t tpl_block_offsets, uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values);
+    WP_API void bsr_set_triplet_values_double_host(int block_size, int nnz, uint64_t tpl_block_offsets, uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values);
+    WP_API void bsr_set_triplet_values_float_device(int block_size, int nnz, uint64_t tpl_block_offsets, uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values);
+    WP_API void bsr_set_triplet_values_double_device(int block_size, int nnz, uint64_t tpl_block_offsets, uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values);
+    WP_API void bsr_set_triplet_values_half_host(int block_size, int nnz, uint64_t tpl_block_offsets, uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values);
+    WP_API void bsr_set_triplet_values_half_device(int block_size, int nnz, uint64_t tpl_block_offsets, uint64_t tpl_block_indices, uint64_t tpl_values, uint64_t bsr_values);
 
     WP_API void bsr_transpose_float_host(int rows_per_block, int cols_per_block,
         int row_count, int col_count, int nnz,
@@ -211,6 +404,170 @@ extern "C"
         uint64_t transposed_bsr_columns,
         uint64_t transposed_bsr_values);
 
+    WP_API void bsr_transpose_half_host(int rows_per_block, int cols_per_block,
+        int row_count, int col_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t transposed_bsr_offsets,
+        uint64_t transposed_bsr_columns,
+        uint64_t transposed_bsr_values);
+    WP_API void bsr_transpose_half_device(int rows_per_block, int cols_per_block,
+        int row_count, int col_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t transposed_bsr_offsets,
+        uint64_t transposed_bsr_columns,
+        uint64_t transposed_bsr_values);
+
+    // group_size is the number of threads per row of the device kernels of square blocks up to 6x6, one of 4, 8,
+    // 16 or 32, or 0 to pick it from the average number of values per row, hosts ignore it
+    WP_API void bsr_mv_float_host(int rows_per_block, int cols_per_block,
+        int row_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t x, uint64_t y, int group_size,
+        float alpha, float beta);
+    WP_API void bsr_mv_double_host(int rows_per_block, int cols_per_block,
+        int row_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t x, uint64_t y, int group_size,
+        double alpha, double beta);
+
+    WP_API void bsr_mv_float_device(int rows_per_block, int cols_per_block,
+        int row_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t x, uint64_t y, int group_size,
+        float alpha, float beta);
+    WP_API void bsr_mv_double_device(int rows_per_block, int cols_per_block,
+        int row_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t x, uint64_t y, int group_size,
+        double alpha, double beta);
+
+    // half-precision values, float vectors and accumulation
+    WP_API void bsr_mv_half_host(int rows_per_block, int cols_per_block,
+        int row_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t x, uint64_t y, int group_size,
+        float alpha, float beta);
+    WP_API void bsr_mv_half_device(int rows_per_block, int cols_per_block,
+        int row_count, int nnz,
+        uint64_t bsr_offsets, uint64_t bsr_columns,
+        uint64_t bsr_values,
+        uint64_t x, uint64_t y, int group_size,
+        float alpha, float beta);
+
+    WP_API int bsr_mm_count_host(int row_count,
+        uint64_t x_offsets, uint64_t x_columns,
+        uint64_t y_offsets, uint64_t y_columns,
+        uint64_t z_offsets, uint64_t z_columns,
+        uint64_t mm_offsets);
+    WP_API void bsr_mm_list_columns_host(int row_count,
+        uint64_t x_offsets, uint64_t x_columns,
+        uint64_t y_offsets, uint64_t y_columns,
+        uint64_t z_offsets, uint64_t z_columns,
+        uint64_t mm_offsets, uint64_t mm_columns);
+    WP_API void bsr_mm_compute_values_float_host(int x_rows_per_block, int x_cols_per_block,
+        int y_cols_per_block, int row_count,
+        uint64_t x_offsets, uint64_t x_columns, uint64_t x_values,
+        uint64_t y_offsets, uint64_t y_columns, uint64_t y_values,
+        uint64_t z_offsets, uint64_t z_columns, uint64_t z_values,
+        uint64_t mm_offsets, uint64_t mm_columns, uint64_t mm_values,
+        float alpha, float beta);
+    WP_API void bsr_mm_compute_values_double_host(int x_rows_per_block, int x_cols_per_block,
+        int y_cols_per_block, int row_count,
+        uint64_t x_offsets, uint64_t x_columns, uint64_t x_values,
+        uint64_t y_offsets, uint64_t y_columns, uint64_t y_values,
+        uint64_t z_offsets, uint64_t z_columns, uint64_t z_values,
+        uint64_t mm_offsets, uint64_t mm_columns, uint64_t mm_values,
+        double alpha, double beta);
+
+    WP_API int bsr_mm_count_device(int row_count,
+        uint64_t x_offsets, uint64_t x_columns,
+        uint64_t y_offsets, uint64_t y_columns,
+        uint64_t z_offsets, uint64_t z_columns,
+        uint64_t mm_offsets);
+    WP_API void bsr_mm_list_columns_device(int row_count,
+        uint64_t x_offsets, uint64_t x_columns,
+        uint64_t y_offsets, uint64_t y_columns,
+        uint64_t z_offsets, uint64_t z_columns,
+        uint64_t mm_offsets, uint64_t mm_columns);
+    WP_API void bsr_mm_compute_values_float_device(int x_rows_per_block, int x_cols_per_block,
+        int y_cols_per_block, int row_count,
+        uint64_t x_offsets, uint64_t x_columns, uint64_t x_values,
+        uint64_t y_offsets, uint64_t y_columns, uint64_t y_values,
+        uint64_t z_offsets, uint64_t z_columns, uint64_t z_values,
+        uint64_t mm_offsets, uint64_t mm_columns, uint64_t mm_values,
+        float alpha, float beta);
+    WP_API void bsr_mm_compute_values_double_device(int x_rows_per_block, int x_cols_per_block,
+        int y_cols_per_block, int row_count,
+        uint64_t x_offsets, uint64_t x_columns, uint64_t x_values,
+        uint64_t y_offsets, uint64_t y_columns, uint64_t y_values,
+        uint64_t z_offsets, uint64_t z_columns, uint64_t z_values,
+        uint64_t mm_offsets, uint64_t mm_columns, uint64_t mm_values,
+        double alpha, double beta);
+
+    WP_API void bsr_axpy_blocks_float_host(int block_size, int nnz, uint64_t rows, uint64_t columns,
+        uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values, uint64_t dst_values, float scale);
+    WP_API void bsr_axpy_blocks_double_host(int block_size, int nnz, uint64_t rows, uint64_t columns,
+        uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values, uint64_t dst_values, double scale);
+    WP_API void bsr_axpy_blocks_float_device(int block_size, int nnz, uint64_t rows, uint64_t columns,
+        uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values, uint64_t dst_values, float scale);
+    WP_API void bsr_axpy_blocks_double_device(int block_size, int nnz, uint64_t rows, uint64_t columns,
+        uint64_t dst_offsets, uint64_t dst_columns, uint64_t src_values, uint64_t dst_values, double scale);
+
+    WP_API void bsr_block_diag_inverse_float_host(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag);
+    WP_API void bsr_block_diag_inverse_double_host(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag);
+    WP_API void bsr_block_diag_inverse_float_device(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag);
+    WP_API void bsr_block_diag_inverse_double_device(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag);
+
+    // level schedule of the incomplete LU factorization, for host arrays only
+    WP_API void bsr_ilu_levels_host(int row_count, uint64_t offsets, uint64_t columns,
+        uint64_t lower_levels, uint64_t upper_levels);
+
+    // level offsets are host arrays, level rows live on the device of the matrix
+    WP_API void bsr_ilu_factor_float_host(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t level_rows, uint64_t level_offsets, int level_count);
+    WP_API void bsr_ilu_factor_double_host(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t level_rows, uint64_t level_offsets, int level_count);
+    WP_API void bsr_ilu_factor_float_device(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t level_rows, uint64_t level_offsets, int level_count);
+    WP_API void bsr_ilu_factor_double_device(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t level_rows, uint64_t level_offsets, int level_count);
+
+    WP_API void bsr_ilu_solve_float_host(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t lower_rows, uint64_t lower_level_offsets, int lower_level_count,
+        uint64_t upper_rows, uint64_t upper_level_offsets, int upper_level_count,
+        uint64_t x, uint64_t z);
+    WP_API void bsr_ilu_solve_double_host(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t lower_rows, uint64_t lower_level_offsets, int lower_level_count,
+        uint64_t upper_rows, uint64_t upper_level_offsets, int upper_level_count,
+        uint64_t x, uint64_t z);
+    WP_API void bsr_ilu_solve_float_device(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t lower_rows, uint64_t lower_level_offsets, int lower_level_count,
+        uint64_t upper_rows, uint64_t upper_level_offsets, int upper_level_count,
+        uint64_t x, uint64_t z);
+    WP_API void bsr_ilu_solve_double_device(int block_size, int row_count,
+        uint64_t offsets, uint64_t columns, uint64_t values, uint64_t inv_diag,
+        uint64_t lower_rows, uint64_t lower_level_offsets, int lower_level_count,
+        uint64_t upper_rows, uint64_t upper_level_offsets, int upper_level_count,
+        uint64_t x, uint64_t z);
+
 
     WP_API int cuda_driver_version();   // CUDA driver version
     WP_API int cuda_toolkit_version();  // CUDA Toolkit version used to build Warp
@@ -225,6 +582,11 @@ extern "C"
     WP_API int cuda_device_get_arch(int ordinal);
     WP_API int cuda_device_is_uva(int ordinal);
     WP_API int cuda_device_is_memory_pool_supported(int ordinal);
+    WP_API int cuda_device_is_mempool_enabled(int ordinal);
+    WP_API int cuda_device_set_mempool_enabled(int ordinal, int enable);
+    WP_API int cuda_device_set_mempool_release_threshold(int ordinal, uint64_t threshold);
+    WP_API uint64_t cuda_device_get_mempool_release_threshold(int ordinal);
+    WP_API int cuda_device_get_mempool_stats(int ordinal, uint64_t* used_current, uint64_t* used_high, uint64_t* reserved_current, uint64_t* reserved_high);
 
     WP_API void* cuda_context_get_current();
     WP_API void cuda_context_set_current(void* context);
@@ -237,6 +599,8 @@ extern "C"
     WP_API int cuda_context_is_memory_pool_supported(void* context);
     WP_API void* cuda_context_get_stream(void* context);
     WP_API void cuda_context_set_stream(void* context, void* stream);
+    // alloc_func: void* (size_t size, void* stream), free_func: void (void* ptr, void* stream), NULL to restore the default allocator
+    WP_API void cuda_context_set_allocator(void* context, void* alloc_func, void* free_func);
     WP_API int cuda_context_can_access_peer(void* context, void* peer_context);
     WP_API int cuda_context_enable_peer_access(void* context, void* peer_context);
 
@@ -250,24 +614,58 @@ extern "C"
     WP_API void cuda_stream_destroy(void* context, void* stream);
     WP_API void cuda_stream_synchronize(void* context, void* stream);
     WP_API void* cuda_stream_get_current();
+    WP_API int cuda_stream_is_capturing(void* stream);
     WP_API void cuda_stream_wait_event(void* context, void* stream, void* event);
     WP_API void cuda_stream_wait_stream(void* context, void* stream, void* other_stream, void* event);
 
     WP_API void* cuda_event_create(void* context, unsigned flags);
     WP_API void cuda_event_destroy(void* context, void* event);
     WP_API void cuda_event_record(void* context, void* event, void* stream);
+    // returns 1 if all work captured by the event has completed, 0 if it is still pending
+    WP_API int cuda_event_query(void* event);
+    // blocks the calling thread until the work captured by the event has completed
+    WP_API void cuda_event_synchronize(void* event);
+    // milliseconds between two completed events created with timing enabled
+    WP_API float cuda_event_elapsed_time(void* start, void* end);
+
+    // NVTX ranges, shown by Nsight Systems on the CPU timeline of the calling thread
+    WP_API void cuda_nvtx_range_push(const char* name);
+    WP_API void cuda_nvtx_range_pop();
 
     WP_API void cuda_graph_begin_capture(void* context);
     WP_API void* cuda_graph_end_capture(void* context);
+    // ends a capture and updates graph in place when only node parameters changed, returns the new graph if it had to be re-instantiated
+    WP_API void* cuda_graph_end_capture_update(void* context, void* graph);
+    // conditional nodes (CUDA 12.4+): create a handle set from the device-side condition, then capture the node body
+    // between begin and end, while loops re-evaluate the condition after each iteration of the body
+    WP_API bool cuda_graph_create_conditional(void* context, int* condition, bool invert, uint64_t* handle_out);
+    WP_API bool cuda_graph_begin_conditional(void* context, uint64_t handle, bool loop, void** graph_out, void** node_out);
+    WP_API bool cuda_graph_end_conditional(void* context, uint64_t handle, int* condition, bool loop, void* graph, void* node);
     WP_API void cuda_graph_launch(void* context, void* graph);
     WP_API void cuda_graph_destroy(void* context, void* graph);
 
-    WP_API size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file);
+    WP_API size_t cuda_compile_program(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file, const char* pch_dir);
+    // compiles to LTO-IR and links it with nvJitLink link-time optimization into a CUBIN (CUDA 12.4+)
+    WP_API size_t cuda_compile_lto(const char* cuda_src, int arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file, const char* pch_dir);
+    WP_API size_t cuda_compile_fatbin(const char* cuda_src, const int* archs, int num_archs, int ptx_arch, const char* include_dir, bool debug, bool verbose, bool verify_fp, bool fast_math, const char* output_file, const char* pch_dir);
 
     WP_API void* cuda_load_module(void* context, const char* ptx);
+    // loads a PTX, CUBIN, or fatbin image from memory, e.g. from a precompiled module bundle
+    WP_API void* cuda_load_module_data(void* context, const void* data, size_t size, bool is_ptx);
     WP_API void cuda_unload_module(void* context, void* module);
     WP_API void* cuda_get_kernel(void* context, void* module, const char* name);
-    WP_API size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, void** args);
+    // returns the block size that maximizes the occupancy of the kernel, or 0 on failure
+    WP_API int cuda_get_kernel_occupancy_block_dim(void* context, void* kernel);
+    // launches the kernel with dim threads, block_dim <= 0 selects the default block size
+    WP_API size_t cuda_launch_kernel(void* context, void* kernel, size_t dim, int block_dim, void** args);
+    // launches count kernels on the current stream, args[i] are the parameters of kernel i starting with its launch bounds
+    WP_API size_t cuda_launch_kernels(void* context, void** kernels, int* block_dims, void*** args, int count);
+    // runs the tasks of a command list with the persistent kernel of their module, see CommandList
+    WP_API size_t cuda_launch_persistent_kernel(void* context, void* kernel, void* tasks, int num_tasks, void* barrier, size_t max_dim);
+    // launches one kernel per context on the given streams, e.g. the shards of a data-parallel step
+    WP_API size_t cuda_launch_kernels_multi(void** contexts, void** streams, void** kernels, int* block_dims, void*** args, int count);
+    // XLA GPU custom call target, launches the kernel described by the opaque descriptor on the XLA stream
+    WP_API void cuda_jax_custom_call(void* stream, void** buffers, const char* opaque, size_t opaque_len);
 
     WP_API void cuda_set_context_restore_policy(bool always_restore);
     WP_API int cuda_get_context_restore_policy();
@@ -276,6 +674,8 @@ extern "C"
     WP_API void cuda_graphics_unmap(void* context, void* resource);
     WP_API void cuda_graphics_device_ptr_and_size(void* context, void* resource, uint64_t* ptr, size_t* size);
     WP_API void* cuda_graphics_register_gl_buffer(void* context, uint32_t gl_buffer, unsigned int flags);
+    WP_API void* cuda_graphics_register_gl_image(void* context, uint32_t gl_image, uint32_t target, unsigned int flags);
+    WP_API void cuda_graphics_copy_image(void* context, void* resource, uint64_t dst, size_t dst_pitch, size_t width_bytes, size_t height);
     WP_API void cuda_graphics_unregister_resource(void* context, void* resource);
 
 } // extern "C"
@@ -6,6 +6,7 @@
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
 import warp as wp
+from warp.optim.multi_tensor import MultiTensorState, TensorSlot, tensor_slot_index
 
 
 @wp.kernel
@@ -50,13 +51,50 @@ def adam_step_kernel_float(
     params[i] = params[i] - lr * mhat / (wp.sqrt(vhat) + eps)
 
 
+@wp.kernel
+def adam_step_kernel_multi_tensor(
+    slots: wp.array(dtype=TensorSlot),
+    offsets: wp.array(dtype=int),
+    step: wp.array(dtype=int),
+    grad_norm: wp.array(dtype=float),
+    clip: int,
+    lr: float,
+    beta1: float,
+    beta2: float,
+    eps: float,
+):
+    tid = wp.tid()
+    s = tensor_slot_index(offsets, tid)
+    i = tid - offsets[s]
+    slot = slots[s]
+    params = slot.param
+    m = slot.state0
+    v = slot.state1
+
+    g = slot.grad[i]
+    if clip != 0:
+        g = g * grad_norm[1]
+    t = float(step[0])
+    m[i] = beta1 * m[i] + (1.0 - beta1) * g
+    v[i] = beta2 * v[i] + (1.0 - beta2) * g * g
+    mhat = m[i] / (1.0 - wp.pow(beta1, (t + 1.0)))
+    vhat = v[i] / (1.0 - wp.pow(beta2, (t + 1.0)))
+    params[i] = params[i] - lr * mhat / (wp.sqrt(vhat) + eps)
+
+
 class Adam:
     """An implementation of the Adam Optimizer
     It is designed to mimic Pytorch's version.
     https://pytorch.org/docs/stable/generated/torch.optim.Adam.html#torch.optim.Adam
+
+    When all parameters are contiguous float32-based arrays on the same device, a step updates all of them in a
+    single kernel launch and keeps the step counter on the device, so the whole step can be captured in a CUDA
+    graph once a first step has run with the same gradient arrays. The learning rate and betas are baked into
+    captured graphs. If ``max_grad_norm`` is set, the gradients are scaled so that their global norm is at most
+    ``max_grad_norm``, the norm of the last step is available in :attr:`grad_norm`.
     """
 
-    def __init__(self, params=None, lr=0.001, betas=(0.9, 0.999), eps=1e-08):
+    def __init__(self, params=None, lr=0.001, betas=(0.9, 0.999), eps=1e-08, max_grad_norm=None):
         self.m = []  # first moment
         self.v = []  # second moment
         self.set_params(params)
@@ -64,7 +102,9 @@ class Adam:
         self.beta1 = betas[0]
         self.beta2 = betas[1]
         self.eps = eps
+        self.max_grad_norm = max_grad_norm
         self.t = 0
+        self._multi_tensor = MultiTensorState()
 
     def set_params(self, params):
         self.params = params
@@ -86,13 +126,44 @@ class Adam:
         for v_i in self.v:
             v_i.zero_()
         self.t = 0
+        self._multi_tensor.reset()
+
+    @property
+    def grad_norm(self):
+        """Device array holding the global gradient norm and the clipping factor of the last fused step"""
+        return self._multi_tensor.grad_norm
 
     def step(self, grad):
         assert self.params != None
-        for i in range(len(self.params)):
-            Adam.step_detail(
-                grad[i], self.m[i], self.v[i], self.lr, self.beta1, self.beta2, self.t, self.eps, self.params[i]
+        table = self._multi_tensor.prepare(self.params, grad, [self.m, self.v], self.t)
+        if table is not None:
+            clip = self.max_grad_norm is not None
+            if clip:
+                table.compute_grad_norm(self.max_grad_norm, self._multi_tensor.grad_norm)
+            wp.launch(
+                kernel=adam_step_kernel_multi_tensor,
+                dim=table.size,
+                inputs=[
+                    table.slots,
+                    table.offsets,
+                    self._multi_tensor.step_count,
+                    self._multi_tensor.grad_norm,
+                    int(clip),
+                    self.lr,
+                    self.beta1,
+                    self.beta2,
+                    self.eps,
+                ],
+                device=table.device,
             )
+            self._multi_tensor.advance()
+        else:
+            if self.max_grad_norm is not None:
+                raise RuntimeError("Gradient clipping requires contiguous float32 parameters on a single device.")
+            for i in range(len(self.params)):
+                Adam.step_detail(
+                    grad[i], self.m[i], self.v[i], self.lr, self.beta1, self.beta2, self.t, self.eps, self.params[i]
+                )
         self.t = self.t + 1
 
     @staticmethod
@@ -0,0 +1,1130 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+"""Iterative solvers for linear systems with sparse (BSR) matrices.
+
+All vector updates read their coefficients from device arrays and are skipped once the residual
+is below tolerance, so no host synchronization is required between iterations. With ``check_every=0``
+the solvers run exactly ``maxiter`` iterations without synchronizing at all, and may be captured
+into a CUDA graph.
+"""
+
+import math
+from typing import Any, Callable, Optional, Sequence, Tuple, Union
+
+import numpy as np
+
+import warp as wp
+import warp.sparse as sparse
+import warp.types
+from warp.utils import array_inner, array_max, array_scan
+
+
+class LinearOperator:
+    """
+    Linear operator to be used as left-hand-side or preconditioner of the iterative solvers.
+
+    Args:
+        shape: Tuple containing the number of rows and columns of the operator
+        dtype: Scalar type of the operator
+        device: Device on which the operator is applied
+        matvec: Function computing ``y := alpha * A * x + beta * y``, with signature ``matvec(x, y, alpha, beta)``
+    """
+
+    def __init__(self, shape: Tuple[int, int], dtype: type, device: wp.context.Device, matvec: Callable):
+        self._shape = shape
+        self._dtype = dtype
+        self._device = device
+        self._matvec = matvec
+
+    @property
+    def shape(self) -> Tuple[int, int]:
+        return self._shape
+
+    @property
+    def dtype(self) -> type:
+        return self._dtype
+
+    @property
+    def device(self) -> wp.context.Device:
+        return self._device
+
+    @property
+    def matvec(self) -> Callable:
+        return self._matvec
+
+
+def aslinearoperator(
+    A: Union[sparse.BsrMatrix, sparse.SellMatrix, LinearOperator, None]
+) -> Optional[LinearOperator]:
+    """Wraps a :class:`warp.sparse.BsrMatrix` or :class:`warp.sparse.SellMatrix` in a :class:`LinearOperator`,
+    operators and ``None`` are returned as-is"""
+
+    if A is None or isinstance(A, LinearOperator):
+        return A
+
+    if isinstance(A, sparse.BsrMatrix):
+
+        def matvec(x, y, alpha, beta):
+            sparse.bsr_mv(A, x, y, alpha, beta)
+
+        return LinearOperator(A.shape, A.scalar_type, A.values.device, matvec)
+
+    if isinstance(A, sparse.SellMatrix):
+
+        def matvec(x, y, alpha, beta):
+            sparse.sell_mv(A, x, y, alpha, beta)
+
+        return LinearOperator(A.shape, A.scalar_type, A.values.device, matvec)
+
+    raise ValueError(f"Unable to create LinearOperator from {A}")
+
+
+def preconditioner(A: sparse.BsrMatrix, ptype: str = "diag") -> Optional[LinearOperator]:
+    """Constructs a preconditioner for the square matrix `A`
+
+    Args:
+        A: The matrix to precondition
+        ptype: Either "id" for no preconditioning, "diag" for Jacobi preconditioning with the inverse
+          of the diagonal coefficients, "block_diag" for block-Jacobi preconditioning with the inverse
+          of the diagonal blocks (blocks must be square and at most 6x6), or "ilu" for the incomplete
+          factorization of :func:`ilu_preconditioner`
+    """
+
+    if ptype == "id":
+        return None
+
+    if ptype == "ilu":
+        return ilu_preconditioner(A)
+
+    if ptype not in ("diag", "block_diag"):
+        raise ValueError(f"Unsupported preconditioner type '{ptype}'")
+
+    return aslinearoperator(_inverse_diagonal(A, ptype))
+
+
+def ilu_preconditioner(A: sparse.BsrMatrix) -> LinearOperator:
+    """Constructs a block incomplete LU preconditioner with zero fill-in, ILU(0), for the square matrix `A`
+
+    `A` is factored as ``L * U`` on its own sparsity pattern, with blocks as coefficients. For symmetric matrices
+    ``U = D * L^T``, so the preconditioner is the symmetric IC(0) factorization ``L * D * L^T`` and may be used with
+    :func:`cg`. Rows are processed in levels of independent rows, which are computed on the host when the
+    preconditioner is constructed; applying it then launches two kernels per level, without synchronizing with the
+    host, so that solves can be captured into CUDA graphs. The level count grows with the bandwidth of the matrix,
+    e.g. with the sum of the grid dimensions for structured grids.
+
+    The factorization uses precompiled native kernels, which support square blocks of up to 6x6 single or double
+    precision coefficients. Rows without diagonal block or with a singular pivot block are left unscaled.
+    The values of `A` are copied, so `A` may be modified afterwards.
+    """
+
+    block_shape = A.block_shape
+    if A.nrow != A.ncol:
+        raise ValueError("Incomplete LU factorization is only available for square sparse matrices")
+    if block_shape[0] != block_shape[1] or block_shape[0] > 6:
+        raise ValueError(f"Incomplete LU factorization is not supported for block shape {block_shape}")
+    if A.scalar_type not in (wp.float32, wp.float64):
+        raise ValueError(f"Incomplete LU factorization is not supported for scalar type {A.scalar_type}")
+
+    from warp.context import runtime
+
+    device = A.values.device
+    suffix = "host" if device.is_cpu else "device"
+    scalar_name = "float" if A.scalar_type == wp.float32 else "double"
+    factor_func = getattr(runtime.core, f"bsr_ilu_factor_{scalar_name}_{suffix}")
+    solve_func = getattr(runtime.core, f"bsr_ilu_solve_{scalar_name}_{suffix}")
+
+    n = A.nrow
+    block_size = block_shape[0]
+
+    offsets = wp.clone(A.offsets[: n + 1])
+    columns = wp.clone(A.columns[: A.nnz])
+    values = wp.clone(A.values[: A.nnz])
+    inv_diag = wp.empty(shape=(n,), dtype=A.values.dtype, device=device)
+
+    # level schedules of the lower and upper triangular dependencies, with level offsets kept on the host
+    offsets_np = offsets.numpy()
+    columns_np = columns.numpy()
+    lower_levels = np.empty(n, dtype=np.int32)
+    upper_levels = np.empty(n, dtype=np.int32)
+    runtime.core.bsr_ilu_levels_host(
+        n,
+        offsets_np.ctypes.data,
+        columns_np.ctypes.data,
+        lower_levels.ctypes.data,
+        upper_levels.ctypes.data,
+    )
+
+    def schedule(levels):
+        rows = np.argsort(levels, kind="stable").astype(np.int32)
+        level_offsets = np.zeros(levels.max(initial=-1) + 2, dtype=np.int32)
+        np.cumsum(np.bincount(levels), out=level_offsets[1:])
+        return wp.array(rows, dtype=int, device=device), level_offsets
+
+    lower_rows, lower_offsets = schedule(lower_levels)
+    upper_rows, upper_offsets = schedule(upper_levels)
+
+    factor_func(
+        block_size,
+        n,
+        offsets.ptr,
+        columns.ptr,
+        values.ptr,
+        inv_diag.ptr,
+        lower_rows.ptr,
+        lower_offsets.ctypes.data,
+        len(lower_offsets) - 1,
+    )
+
+    z = None
+
+    def matvec(x, y, alpha, beta):
+        nonlocal z
+
+        if z is None or z.dtype != y.dtype:
+            z = wp.empty_like(y)
+
+        solve_func(
+            block_size,
+            n,
+            offsets.ptr,
+            columns.ptr,
+            values.ptr,
+            inv_diag.ptr,
+            lower_rows.ptr,
+            lower_offsets.ctypes.data,
+            len(lower_offsets) - 1,
+            upper_rows.ptr,
+            upper_offsets.ctypes.data,
+            len(upper_offsets) - 1,
+            x.ptr,
+            z.ptr,
+        )
+
+        wp.launch(
+            kernel=_axpby,
+            dim=y.shape[0],
+            device=device,
+            inputs=[A.scalar_type(alpha), z, A.scalar_type(beta), y],
+        )
+
+    return LinearOperator(A.shape, A.scalar_type, device, matvec)
+
+
+def _inverse_diagonal(A: sparse.BsrMatrix, ptype: str) -> sparse.BsrMatrix:
+    """Diagonal matrix with the inverse diagonal coefficients or blocks of `A`"""
+
+    diag = sparse.bsr_get_diag(A)
+    inv_diag = wp.zeros_like(diag)
+
+    block_shape = A.block_shape
+
+    if ptype == "diag" or block_shape == (1, 1):
+        # Operate on scalar views of the diagonal blocks
+        block_rows = block_shape[0]
+        count = A.nrow * block_rows * block_rows
+        diag_values = wp.array(
+            ptr=diag.ptr, dtype=A.scalar_type, shape=(count,), device=diag.device, owner=False, copy=False
+        )
+        inv_values = wp.array(
+            ptr=inv_diag.ptr, dtype=A.scalar_type, shape=(count,), device=diag.device, owner=False, copy=False
+        )
+
+        wp.launch(
+            kernel=_invert_diagonal_coefficients,
+            dim=A.nrow * block_rows,
+            device=diag.device,
+            inputs=[block_rows, A.scalar_type(1.0), diag_values, inv_values],
+        )
+    elif A.scalar_type in (wp.float32, wp.float64):
+        if block_shape[0] != block_shape[1] or block_shape[0] > 6:
+            raise ValueError(f"Block-Jacobi preconditioning is not supported for block shape {block_shape}")
+
+        sparse.bsr_block_diag_inverse(A, out=inv_diag)
+    else:
+        if block_shape[0] != block_shape[1] or block_shape[0] not in (2, 3, 4):
+            raise ValueError(f"Block-Jacobi preconditioning is not supported for block shape {block_shape}")
+
+        wp.launch(kernel=_invert_diagonal_blocks, dim=A.nrow, device=diag.device, inputs=[diag, inv_diag])
+
+    return sparse.bsr_diag(inv_diag)
+
+
+def multigrid_preconditioner(
+    A: sparse.BsrMatrix,
+    prolongations: Sequence[sparse.BsrMatrix],
+    smoothing_steps: int = 2,
+    smoothing_weight: float = 2.0 / 3.0,
+    coarse_steps: int = 32,
+) -> LinearOperator:
+    """Constructs a geometric multigrid V-cycle preconditioner for the symmetric positive definite matrix `A`
+
+    Coarse operators are computed as Galerkin products ``P^T A P``. Levels are smoothed with damped Jacobi iterations,
+    the same number before and after the coarse correction so that the preconditioner remains symmetric, and
+    the coarsest level is solved approximately with more Jacobi iterations.
+
+    Args:
+        A: The matrix to precondition
+        prolongations: Prolongation matrices from each level to the next finer one, ordered from the finest level down.
+          The first prolongation has as many rows as `A`, e.g. built with :func:`warp.fem.space.make_prolongation`
+        smoothing_steps: Number of Jacobi iterations before and after the coarse correction at each level
+        smoothing_weight: Damping factor of the Jacobi iterations
+        coarse_steps: Number of Jacobi iterations on the coarsest level
+    """
+
+    if A.nrow != A.ncol:
+        raise ValueError("Multigrid preconditioning requires a square matrix")
+
+    levels = [_MultigridLevel(A)]
+    for P in prolongations:
+        fine = levels[-1]
+        if P.nrow != fine.A.nrow or P.block_shape[0] != fine.A.block_shape[1]:
+            raise ValueError("Prolongation matrix shapes do not match the multigrid levels")
+
+        levels.append(fine.coarsen(P))
+
+    return _multigrid_operator(levels, smoothing_steps, smoothing_weight, coarse_steps)
+
+
+def amg_preconditioner(
+    A: sparse.BsrMatrix,
+    strength_threshold: float = 0.08,
+    max_levels: int = 10,
+    coarse_size: int = 64,
+    smoothing_steps: int = 2,
+    smoothing_weight: float = 2.0 / 3.0,
+    coarse_steps: int = 32,
+    seed: int = 42,
+) -> LinearOperator:
+    """Constructs a smoothed aggregation algebraic multigrid preconditioner for the symmetric positive definite `A`
+
+    Unlike :func:`multigrid_preconditioner`, the hierarchy is built from the matrix coefficients only,
+    e.g. for problems on unstructured meshes. Nodes (block rows) are grouped into aggregates around the roots of a
+    distance-two maximal independent set of the strongly connected nodes, chosen in parallel on the device.
+    The piecewise constant tentative prolongator is then smoothed with one damped Jacobi iteration.
+    Applying the preconditioner does not synchronize with the host, so that solves can be captured into CUDA graphs.
+
+    Args:
+        A: The matrix to precondition, with square blocks
+        strength_threshold: Nodes `i` and `j` are strongly connected if ``|A_ij|^2 >= threshold^2 |A_ii| |A_jj|``,
+          using Frobenius norms for blocks
+        max_levels: Maximum number of levels of the hierarchy, including the finest one
+        coarse_size: Number of nodes below which no coarser level is built
+        smoothing_steps: Number of Jacobi iterations before and after the coarse correction at each level
+        smoothing_weight: Damping factor of the Jacobi iterations
+        coarse_steps: Number of Jacobi iterations on the coarsest level
+        seed: Seed of the random priorities used to select the aggregate roots
+    """
+
+    if A.nrow != A.ncol or A.block_shape[0] != A.block_shape[1]:
+        raise ValueError("Algebraic multigrid preconditioning requires a square matrix with square blocks")
+
+    levels = [_MultigridLevel(A)]
+    while len(levels) < max_levels and levels[-1].A.nrow > coarse_size:
+        fine = levels[-1]
+        P = _smoothed_aggregation_prolongation(fine.A, strength_threshold, seed + len(levels))
+        if P is None:
+            break
+
+        levels.append(fine.coarsen(P))
+
+    return _multigrid_operator(levels, smoothing_steps, smoothing_weight, coarse_steps)
+
+
+def _multigrid_operator(levels, smoothing_steps: int, smoothing_weight: float, coarse_steps: int) -> LinearOperator:
+    """V-cycle preconditioner over the given hierarchy, from the finest level down"""
+
+    A = levels[0].A
+    device = A.values.device
+    scalar_type = A.scalar_type
+
+    def smooth(level, steps):
+        for _ in range(steps):
+            wp.copy(dest=level.r, src=level.b)
+            sparse.bsr_mv(level.A, level.x, level.r, alpha=-1.0, beta=1.0)
+            sparse.bsr_mv(level.inv_diag, level.r, level.x, alpha=smoothing_weight, beta=1.0)
+
+    def matvec(x, y, alpha, beta):
+        fine = levels[0]
+        fine.b = x
+
+        for l in range(len(levels) - 1):
+            level = levels[l]
+            level.x.zero_()
+            smooth(level, smoothing_steps)
+
+            wp.copy(dest=level.r, src=level.b)
+            sparse.bsr_mv(level.A, level.x, level.r, alpha=-1.0, beta=1.0)
+            sparse.bsr_mv(level.R, level.r, levels[l + 1].b, alpha=1.0, beta=0.0)
+
+        coarsest = levels[-1]
+        coarsest.x.zero_()
+        smooth(coarsest, coarse_steps)
+
+        for l in range(len(levels) - 2, -1, -1):
+            level = levels[l]
+            sparse.bsr_mv(level.P, levels[l + 1].x, level.x, alpha=1.0, beta=1.0)
+            smooth(level, smoothing_steps)
+
+        wp.launch(
+            kernel=_axpby,
+            dim=y.shape[0],
+            device=device,
+            inputs=[scalar_type(alpha), fine.x, scalar_type(beta), y],
+        )
+
+    return LinearOperator(A.shape, scalar_type, device, matvec)
+
+
+class _MultigridLevel:
+    """Operator, transfer matrices and work vectors of one level of the multigrid hierarchy"""
+
+    def __init__(self, A: sparse.BsrMatrix):
+        self.A = A
+        self.P = None
+        self.R = None
+
+        # Jacobi iterations scale the residual by the inverse diagonal
+        self.inv_diag = _inverse_diagonal(A, "diag")
+
+        device = A.values.device
+        if A.block_shape == (1, 1):
+            vec_type = A.scalar_type
+        else:
+            vec_type = wp.types.vector(length=A.block_shape[0], dtype=A.scalar_type)
+
+        self.b = wp.zeros(shape=A.nrow, dtype=vec_type, device=device)
+        self.x = wp.zeros_like(self.b)
+        self.r = wp.zeros_like(self.b)
+
+    def coarsen(self, P: sparse.BsrMatrix) -> "_MultigridLevel":
+        """Sets the prolongation from the next coarser level, and returns that level with the Galerkin operator"""
+        self.P = P
+        self.R = sparse.bsr_transposed(P)
+        return _MultigridLevel(sparse.bsr_mm(self.R, sparse.bsr_mm(self.A, P)))
+
+
+def _smoothed_aggregation_prolongation(A: sparse.BsrMatrix, strength_threshold: float, seed: int):
+    """Smoothed aggregation prolongation of `A`, or None if its nodes cannot be aggregated further"""
+
+    device = A.values.device
+    scalar_type = A.scalar_type
+    n = A.nrow
+
+    # Frobenius norms of the blocks, from a scalar view of the values
+    block_size = A.block_shape[0] * A.block_shape[1]
+    scalar_values = wp.array(
+        ptr=A.values.ptr, dtype=scalar_type, shape=(A.nnz * block_size,), device=device, owner=False, copy=False
+    )
+    norms = wp.empty(shape=A.nnz, dtype=scalar_type, device=device)
+    wp.launch(kernel=_amg_block_norms, dim=A.nnz, device=device, inputs=[block_size, scalar_values, norms])
+
+    diag_norms = wp.zeros(shape=n, dtype=scalar_type, device=device)
+    wp.launch(kernel=_amg_diag_norms, dim=n, device=device, inputs=[A.offsets, A.columns, norms, diag_norms])
+
+    strong = wp.empty(shape=A.nnz, dtype=int, device=device)
+    wp.launch(
+        kernel=_amg_strength,
+        dim=n,
+        device=device,
+        inputs=[scalar_type(strength_threshold * strength_threshold), A.offsets, A.columns, norms, diag_norms, strong],
+    )
+
+    # Distance-2 maximal independent set of the strength graph, by propagating the largest (state, priority, index)
+    # tuples twice over strong connections, see Bell et al., "Exposing fine-grained parallelism in algebraic multigrid"
+    state = wp.full(shape=n, value=_AMG_UNDECIDED, dtype=int, device=device)
+    priority = wp.empty(shape=n, dtype=int, device=device)
+    wp.launch(kernel=_amg_priorities, dim=n, device=device, inputs=[seed, priority])
+
+    tuples = [wp.empty(shape=n, dtype=wp.vec3i, device=device) for _ in range(2)]
+    undecided_count = wp.empty(shape=1, dtype=int, device=device)
+
+    while True:
+        wp.launch(kernel=_amg_mis_tuples, dim=n, device=device, inputs=[state, priority, tuples[0]])
+        for k in range(2):
+            wp.launch(
+                kernel=_amg_mis_max,
+                dim=n,
+                device=device,
+                inputs=[A.offsets, A.columns, strong, tuples[k], tuples[1 - k]],
+            )
+
+        undecided_count.zero_()
+        wp.launch(kernel=_amg_mis_update, dim=n, device=device, inputs=[tuples[0], state, undecided_count])
+        if undecided_count.numpy()[0] == 0:
+            break
+
+    # Number the aggregates after their roots, then join each node to a strongly connected root,
+    # directly or through a neighbor, which always exists for distance-2 independent sets
+    root_offsets = wp.empty(shape=n, dtype=int, device=device)
+    wp.launch(kernel=_amg_root_mask, dim=n, device=device, inputs=[state, root_offsets])
+    array_scan(root_offsets, root_offsets, inclusive=True)
+
+    aggregate_count = int(root_offsets.numpy()[n - 1])
+    if aggregate_count == n or aggregate_count == 0:
+        return None
+
+    aggregates = [wp.empty(shape=n, dtype=int, device=device) for _ in range(2)]
+    wp.launch(kernel=_amg_root_aggregates, dim=n, device=device, inputs=[state, root_offsets, aggregates[0]])
+    for k in range(2):
+        wp.launch(
+            kernel=_amg_join_aggregates,
+            dim=n,
+            device=device,
+            inputs=[A.offsets, A.columns, strong, aggregates[k], aggregates[1 - k]],
+        )
+
+    # Piecewise constant tentative prolongator, with identity blocks filled through a scalar view
+    block_type = A.values.dtype
+    block_rows = A.block_shape[0]
+    rows = wp.empty(shape=n, dtype=int, device=device)
+    unit_blocks = wp.zeros(shape=n, dtype=block_type, device=device)
+    unit_coefficients = wp.array(
+        ptr=unit_blocks.ptr, dtype=scalar_type, shape=(n * block_size,), device=device, owner=False, copy=False
+    )
+    wp.launch(
+        kernel=_amg_tentative_triplets,
+        dim=n * block_rows,
+        device=device,
+        inputs=[block_rows, scalar_type(1.0), rows, unit_coefficients],
+    )
+
+    T = sparse.bsr_zeros(n, aggregate_count, block_type=block_type, device=device)
+    sparse.bsr_set_from_triplets(T, rows, aggregates[0], unit_blocks)
+
+    # Jacobi smoothing P = (I - omega D^-1 A) T, with omega = 4 / (3 rho) and rho bounding the spectral radius
+    # of D^-1 A from its Gershgorin discs
+    row_bounds = wp.empty(shape=n, dtype=scalar_type, device=device)
+    wp.launch(kernel=_amg_row_bounds, dim=n, device=device, inputs=[A.offsets, norms, diag_norms, row_bounds])
+    rho = float(array_max(row_bounds))
+    omega = 4.0 / (3.0 * rho) if rho > 0.0 else 0.0
+
+    D_inv_AT = sparse.bsr_mm(_inverse_diagonal(A, "diag"), sparse.bsr_mm(A, T))
+    return sparse.bsr_axpy(D_inv_AT, T, alpha=-omega, beta=1.0)
+
+
+def cg(
+    A: Union[sparse.BsrMatrix, LinearOperator],
+    b: wp.array,
+    x: wp.array,
+    tol: float = 1.0e-5,
+    atol: float = 0.0,
+    maxiter: int = 0,
+    M: Optional[Union[sparse.BsrMatrix, LinearOperator]] = None,
+    check_every: int = 10,
+    callback: Optional[Callable] = None,
+) -> Tuple[int, Any, Any]:
+    """Solves `Ax = b` for a symmetric positive definite `A` with the (preconditioned) Conjugate Gradient method.
+
+    Args:
+        A: The system matrix
+        b: The right-hand side
+        x: Initial guess, overwritten with the solution
+        tol: Tolerance on the residual norm, relative to the norm of `b`
+        atol: Absolute tolerance on the residual norm, the largest of the two tolerances is used
+        maxiter: Maximum number of iterations, defaults to the system size
+        M: Optional preconditioner, approximating the inverse of `A`
+        check_every: Number of iterations between host-side convergence checks. If 0, exactly `maxiter` iterations
+          are run without host synchronization
+        callback: Optional function called at each check as ``callback(iteration, residual_norm, tolerance)``
+
+    Returns:
+        Tuple ``(iterations, residual_norm, tolerance)``. If `check_every` is 0, the residual norm and tolerance
+        are returned as single-element device arrays rather than host floats.
+    """
+
+    A = aslinearoperator(A)
+    M = aslinearoperator(M)
+    solver = _SolverState(A, b, x, tol, atol, maxiter)
+
+    r = wp.clone(b)
+    A.matvec(x, r, -1.0, 1.0)
+
+    if M is None:
+        z = r
+    else:
+        z = wp.zeros_like(r)
+        M.matvec(r, z, 1.0, 0.0)
+
+    p = wp.clone(z)
+    Ap = wp.zeros_like(r)
+
+    rz_old = solver.scalar()
+    rz_new = solver.scalar()
+    p_Ap = solver.scalar()
+
+    solver.update_residual(r)
+    rz = solver.resid_sq if M is None else rz_old
+    if M is not None:
+        array_inner(r, z, out=rz_old)
+
+    def iteration():
+        nonlocal rz, rz_new
+
+        A.matvec(p, Ap, 1.0, 0.0)
+        array_inner(p, Ap, out=p_Ap)
+
+        solver.launch(_cg_update_x_r, [rz, p_Ap, p, Ap, x, r])
+
+        if M is None:
+            # rz is the squared residual norm itself
+            array_inner(r, r, out=rz_new)
+            solver.launch(_cg_update_p, [rz, rz_new, z, p], resid_sq=rz_new)
+            solver.resid_sq, rz, rz_new = rz_new, rz_new, rz
+        else:
+            M.matvec(r, z, 1.0, 0.0)
+            array_inner(r, z, out=rz_new)
+            solver.update_residual(r)
+            solver.launch(_cg_update_p, [rz, rz_new, z, p])
+            rz, rz_new = rz_new, rz
+
+    return solver.run(iteration, check_every, callback)
+
+
+def cr(
+    A: Union[sparse.BsrMatrix, LinearOperator],
+    b: wp.array,
+    x: wp.array,
+    tol: float = 1.0e-5,
+    atol: float = 0.0,
+    maxiter: int = 0,
+    M: Optional[Union[sparse.BsrMatrix, LinearOperator]] = None,
+    check_every: int = 10,
+    callback: Optional[Callable] = None,
+) -> Tuple[int, Any, Any]:
+    """Solves `Ax = b` for a symmetric (possibly indefinite) `A` with the (preconditioned) Conjugate Residual method.
+
+    See :func:`cg` for a description of the arguments and return values.
+    """
+
+    A = aslinearoperator(A)
+    M = aslinearoperator(M)
+    solver = _SolverState(A, b, x, tol, atol, maxiter)
+
+    r = wp.clone(b)
+    A.matvec(x, r, -1.0, 1.0)
+
+    if M is None:
+        z = r
+    else:
+        z = wp.zeros_like(r)
+        M.matvec(r, z, 1.0, 0.0)
+
+    Az = wp.zeros_like(r)
+    A.matvec(z, Az, 1.0, 0.0)
+
+    p = wp.clone(z)
+    Ap = wp.clone(Az)
+    y = Ap if M is None else wp.zeros_like(r)
+
+    zAz_old = solver.scalar()
+    zAz_new = solver.scalar()
+    y_Ap = solver.scalar()
+
+    solver.update_residual(r)
+    array_inner(z, Az, out=zAz_old)
+
+    def iteration():
+        nonlocal zAz_old, zAz_new
+
+        if M is not None:
+            M.matvec(Ap, y, 1.0, 0.0)
+        array_inner(Ap, y, out=y_Ap)
+
+        # without preconditioner z aliases r, which must only be updated once
+        solver.launch(_cr_update_x_r_z, [zAz_old, y_Ap, p, Ap, y, x, r, z, 0 if M is None else 1])
+
+        A.matvec(z, Az, 1.0, 0.0)
+        array_inner(z, Az, out=zAz_new)
+        solver.update_residual(r)
+
+        solver.launch(_cr_update_p_Ap, [zAz_old, zAz_new, z, Az, p, Ap])
+        zAz_old, zAz_new = zAz_new, zAz_old
+
+    return solver.run(iteration, check_every, callback)
+
+
+def bicgstab(
+    A: Union[sparse.BsrMatrix, LinearOperator],
+    b: wp.array,
+    x: wp.array,
+    tol: float = 1.0e-5,
+    atol: float = 0.0,
+    maxiter: int = 0,
+    M: Optional[Union[sparse.BsrMatrix, LinearOperator]] = None,
+    check_every: int = 10,
+    callback: Optional[Callable] = None,
+) -> Tuple[int, Any, Any]:
+    """Solves `Ax = b` for a general `A` with the right-preconditioned BiCGSTAB method.
+
+    See :func:`cg` for a description of the arguments and return values.
+    """
+
+    A = aslinearoperator(A)
+    M = aslinearoperator(M)
+    solver = _SolverState(A, b, x, tol, atol, maxiter)
+
+    r = wp.clone(b)
+    A.matvec(x, r, -1.0, 1.0)
+
+    r0 = wp.clone(r)
+    p = wp.clone(r)
+    v = wp.zeros_like(r)
+    t = wp.zeros_like(r)
+
+    if M is None:
+        y = p
+        z = r
+    else:
+        y = wp.zeros_like(r)
+        z = wp.zeros_like(r)
+
+    rho_old = solver.scalar()
+    rho_new = solver.scalar()
+    r0_v = solver.scalar()
+    t_s = solver.scalar()
+    t_t = solver.scalar()
+
+    solver.update_residual(r)
+    array_inner(r0, r, out=rho_old)
+
+    def iteration():
+        nonlocal rho_old, rho_new
+
+        if M is not None:
+            M.matvec(p, y, 1.0, 0.0)
+        A.matvec(y, v, 1.0, 0.0)
+        array_inner(r0, v, out=r0_v)
+
+        # half step, r now holds the intermediate residual s
+        solver.launch(_bicgstab_update_half, [rho_old, r0_v, y, v, x, r])
+        solver.update_residual(r)
+
+        if M is not None:
+            M.matvec(r, z, 1.0, 0.0)
+        A.matvec(z, t, 1.0, 0.0)
+        array_inner(t, r, out=t_s)
+        array_inner(t, t, out=t_t)
+
+        solver.launch(_bicgstab_update_full, [t_s, t_t, z, t, x, r])
+        solver.update_residual(r)
+
+        array_inner(r0, r, out=rho_new)
+        solver.launch(_bicgstab_update_p, [rho_old, rho_new, r0_v, t_s, t_t, r, v, p])
+        rho_old, rho_new = rho_new, rho_old
+
+    return solver.run(iteration, check_every, callback)
+
+
+class _SolverState:
+    """Residual and tolerance device scalars shared by the solvers, and the iteration loop"""
+
+    def __init__(self, A: LinearOperator, b: wp.array, x: wp.array, tol: float, atol: float, maxiter: int):
+        if A.shape[0] != A.shape[1]:
+            raise ValueError("System matrix must be square")
+
+        if b.device != A.device or x.device != A.device:
+            raise ValueError("A, b and x must reside on the same device")
+
+        self.scalar_type = warp.types.type_scalar_type(b.dtype)
+        self.device = A.device
+        self.dim = b.shape[0]
+        self.maxiter = maxiter if maxiter > 0 else A.shape[0]
+
+        b_sq = self.scalar()
+        array_inner(b, b, out=b_sq)
+
+        self.tol_sq = self.scalar()
+        wp.launch(
+            kernel=_tolerance_sq,
+            dim=1,
+            device=self.device,
+            inputs=[b_sq, self.scalar_type(tol * tol), self.scalar_type(atol * atol), self.tol_sq],
+        )
+
+        self.resid_sq = self.scalar()
+
+    def scalar(self):
+        return wp.zeros(shape=(1,), dtype=self.scalar_type, device=self.device)
+
+    def update_residual(self, r: wp.array):
+        array_inner(r, r, out=self.resid_sq)
+
+    def launch(self, kernel, inputs, resid_sq=None):
+        """Launches a vector update, skipped on device once the residual `resid_sq` is below tolerance"""
+        if resid_sq is None:
+            resid_sq = self.resid_sq
+        wp.launch(kernel=kernel, dim=self.dim, device=self.device, inputs=[resid_sq, self.tol_sq] + inputs)
+
+    def run(self, iteration: Callable, check_every: int, callback: Optional[Callable]):
+        if check_every <= 0:
+            for _ in range(self.maxiter):
+                iteration()
+
+            resid = self.scalar()
+            tol = self.scalar()
+            wp.launch(kernel=_sqrt_norms, dim=1, device=self.device, inputs=[self.resid_sq, self.tol_sq, resid, tol])
+            return self.maxiter, resid, tol
+
+        resid, tol = self._norms()
+        if resid <= tol:
+            return 0, resid, tol
+
+        for i in range(self.maxiter):
+            iteration()
+
+            if (i + 1) % check_every == 0 or i + 1 == self.maxiter:
+                resid, tol = self._norms()
+                if callback is not None:
+                    callback(i + 1, resid, tol)
+                if resid <= tol:
+                    return i + 1, resid, tol
+
+        return self.maxiter, resid, tol
+
+    def _norms(self):
+        return math.sqrt(self.resid_sq.numpy()[0]), math.sqrt(self.tol_sq.numpy()[0])
+
+
+@wp.func
+def _safe_div(a: Any, b: Any):
+    zero = b - b
+    if b == zero:
+        return zero
+    return a / b
+
+
+@wp.kernel
+def _tolerance_sq(b_sq: wp.array(dtype=Any), rel_sq: Any, abs_sq: Any, tol_sq: wp.array(dtype=Any)):
+    tol_sq[0] = wp.max(rel_sq * b_sq[0], abs_sq)
+
+
+@wp.kernel
+def _sqrt_norms(
+    resid_sq: wp.array(dtype=Any), tol_sq: wp.array(dtype=Any), resid: wp.array(dtype=Any), tol: wp.array(dtype=Any)
+):
+    resid[0] = wp.sqrt(resid_sq[0])
+    tol[0] = wp.sqrt(tol_sq[0])
+
+
+@wp.kernel
+def _invert_diagonal_coefficients(
+    block_rows: int, one: Any, diag: wp.array(dtype=Any), inv_diag: wp.array(dtype=Any)
+):
+    i = wp.tid()
+    k = (i / block_rows) * block_rows * block_rows + (i % block_rows) * (block_rows + 1)
+
+    # zero diagonal coefficients are left unscaled
+    d = diag[k]
+    if d == one - one:
+        inv_diag[k] = one
+    else:
+        inv_diag[k] = one / d
+
+
+@wp.kernel
+def _invert_diagonal_blocks(diag: wp.array(dtype=Any), inv_diag: wp.array(dtype=Any)):
+    i = wp.tid()
+    inv_diag[i] = wp.inverse(diag[i])
+
+
+_AMG_OUT = wp.constant(0)
+_AMG_UNDECIDED = wp.constant(1)
+_AMG_ROOT = wp.constant(2)
+
+
+@wp.kernel
+def _amg_block_norms(block_size: int, values: wp.array(dtype=Any), norms: wp.array(dtype=Any)):
+    i = wp.tid()
+    sq_norm = values[0] - values[0]
+    for k in range(block_size):
+        v = values[i * block_size + k]
+        sq_norm += v * v
+    norms[i] = wp.sqrt(sq_norm)
+
+
+@wp.kernel
+def _amg_diag_norms(
+    offsets: wp.array(dtype=int),
+    columns: wp.array(dtype=int),
+    norms: wp.array(dtype=Any),
+    diag_norms: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    for k in range(offsets[i], offsets[i + 1]):
+        if columns[k] == i:
+            diag_norms[i] = norms[k]
+
+
+@wp.kernel
+def _amg_strength(
+    threshold_sq: Any,
+    offsets: wp.array(dtype=int),
+    columns: wp.array(dtype=int),
+    norms: wp.array(dtype=Any),
+    diag_norms: wp.array(dtype=Any),
+    strong: wp.array(dtype=int),
+):
+    i = wp.tid()
+    for k in range(offsets[i], offsets[i + 1]):
+        j = columns[k]
+        strong[k] = 0
+        if j != i and norms[k] * norms[k] >= threshold_sq * diag_norms[i] * diag_norms[j]:
+            strong[k] = 1
+
+
+@wp.kernel
+def _amg_row_bounds(
+    offsets: wp.array(dtype=int),
+    norms: wp.array(dtype=Any),
+    diag_norms: wp.array(dtype=Any),
+    row_bounds: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    row_sum = norms[0] - norms[0]
+    for k in range(offsets[i], offsets[i + 1]):
+        row_sum += norms[k]
+    row_bounds[i] = _safe_div(row_sum, diag_norms[i])
+
+
+@wp.kernel
+def _amg_priorities(seed: int, priority: wp.array(dtype=int)):
+    i = wp.tid()
+    state = wp.rand_init(seed, i)
+    priority[i] = wp.randi(state)
+
+
+@wp.kernel
+def _amg_mis_tuples(state: wp.array(dtype=int), priority: wp.array(dtype=int), tuples: wp.array(dtype=wp.vec3i)):
+    i = wp.tid()
+    tuples[i] = wp.vec3i(state[i], priority[i], i)
+
+
+@wp.func
+def _amg_tuple_greater(a: wp.vec3i, b: wp.vec3i):
+    if a[0] != b[0]:
+        return a[0] > b[0]
+    if a[1] != b[1]:
+        return a[1] > b[1]
+    return a[2] > b[2]
+
+
+@wp.kernel
+def _amg_mis_max(
+    offsets: wp.array(dtype=int),
+    columns: wp.array(dtype=int),
+    strong: wp.array(dtype=int),
+    tuples: wp.array(dtype=wp.vec3i),
+    max_tuples: wp.array(dtype=wp.vec3i),
+):
+    i = wp.tid()
+    t = tuples[i]
+    for k in range(offsets[i], offsets[i + 1]):
+        if strong[k]:
+            n = tuples[columns[k]]
+            if _amg_tuple_greater(n, t):
+                t = n
+    max_tuples[i] = t
+
+
+@wp.kernel
+def _amg_mis_update(
+    max_tuples: wp.array(dtype=wp.vec3i), state: wp.array(dtype=int), undecided_count: wp.array(dtype=int)
+):
+    i = wp.tid()
+    if state[i] == _AMG_UNDECIDED:
+        t = max_tuples[i]
+        if t[2] == i:
+            state[i] = _AMG_ROOT
+        elif t[0] == _AMG_ROOT:
+            state[i] = _AMG_OUT
+        else:
+            wp.atomic_add(undecided_count, 0, 1)
+
+
+@wp.kernel
+def _amg_root_mask(state: wp.array(dtype=int), mask: wp.array(dtype=int)):
+    i = wp.tid()
+    mask[i] = wp.select(state[i] == _AMG_ROOT, 0, 1)
+
+
+@wp.kernel
+def _amg_root_aggregates(
+    state: wp.array(dtype=int), root_offsets: wp.array(dtype=int), aggregates: wp.array(dtype=int)
+):
+    i = wp.tid()
+    aggregates[i] = wp.select(state[i] == _AMG_ROOT, -1, root_offsets[i] - 1)
+
+
+@wp.kernel
+def _amg_join_aggregates(
+    offsets: wp.array(dtype=int),
+    columns: wp.array(dtype=int),
+    strong: wp.array(dtype=int),
+    aggregates: wp.array(dtype=int),
+    joined_aggregates: wp.array(dtype=int),
+):
+    i = wp.tid()
+    agg = aggregates[i]
+    if agg < 0:
+        for k in range(offsets[i], offsets[i + 1]):
+            if strong[k] and agg < 0:
+                agg = aggregates[columns[k]]
+    joined_aggregates[i] = agg
+
+
+@wp.kernel
+def _amg_tentative_triplets(block_rows: int, one: Any, rows: wp.array(dtype=int), coefficients: wp.array(dtype=Any)):
+    i = wp.tid()
+    row = i / block_rows
+    k = row * block_rows * block_rows + (i % block_rows) * (block_rows + 1)
+
+    rows[row] = row
+    coefficients[k] = one
+
+
+@wp.kernel
+def _axpby(alpha: Any, x: wp.array(dtype=Any), beta: Any, y: wp.array(dtype=Any)):
+    i = wp.tid()
+
+    # y is not read when beta is zero, so it may be uninitialized
+    if beta == beta - beta:
+        y[i] = alpha * x[i]
+    else:
+        y[i] = alpha * x[i] + beta * y[i]
+
+
+@wp.kernel
+def _cg_update_x_r(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    rz: wp.array(dtype=Any),
+    p_Ap: wp.array(dtype=Any),
+    p: wp.array(dtype=Any),
+    Ap: wp.array(dtype=Any),
+    x: wp.array(dtype=Any),
+    r: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        alpha = _safe_div(rz[0], p_Ap[0])
+        x[i] = x[i] + alpha * p[i]
+        r[i] = r[i] - alpha * Ap[i]
+
+
+@wp.kernel
+def _cg_update_p(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    rz_old: wp.array(dtype=Any),
+    rz_new: wp.array(dtype=Any),
+    z: wp.array(dtype=Any),
+    p: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        beta = _safe_div(rz_new[0], rz_old[0])
+        p[i] = z[i] + beta * p[i]
+
+
+@wp.kernel
+def _cr_update_x_r_z(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    zAz: wp.array(dtype=Any),
+    y_Ap: wp.array(dtype=Any),
+    p: wp.array(dtype=Any),
+    Ap: wp.array(dtype=Any),
+    y: wp.array(dtype=Any),
+    x: wp.array(dtype=Any),
+    r: wp.array(dtype=Any),
+    z: wp.array(dtype=Any),
+    update_z: int,
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        alpha = _safe_div(zAz[0], y_Ap[0])
+        x[i] = x[i] + alpha * p[i]
+        r[i] = r[i] - alpha * Ap[i]
+        if update_z:
+            z[i] = z[i] - alpha * y[i]
+
+
+@wp.kernel
+def _cr_update_p_Ap(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    zAz_old: wp.array(dtype=Any),
+    zAz_new: wp.array(dtype=Any),
+    z: wp.array(dtype=Any),
+    Az: wp.array(dtype=Any),
+    p: wp.array(dtype=Any),
+    Ap: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        beta = _safe_div(zAz_new[0], zAz_old[0])
+        p[i] = z[i] + beta * p[i]
+        Ap[i] = Az[i] + beta * Ap[i]
+
+
+@wp.kernel
+def _bicgstab_update_half(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    rho: wp.array(dtype=Any),
+    r0_v: wp.array(dtype=Any),
+    y: wp.array(dtype=Any),
+    v: wp.array(dtype=Any),
+    x: wp.array(dtype=Any),
+    r: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        alpha = _safe_div(rho[0], r0_v[0])
+        x[i] = x[i] + alpha * y[i]
+        r[i] = r[i] - alpha * v[i]
+
+
+@wp.kernel
+def _bicgstab_update_full(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    t_s: wp.array(dtype=Any),
+    t_t: wp.array(dtype=Any),
+    z: wp.array(dtype=Any),
+    t: wp.array(dtype=Any),
+    x: wp.array(dtype=Any),
+    r: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        omega = _safe_div(t_s[0], t_t[0])
+        # x first, z may alias r
+        x[i] = x[i] + omega * z[i]
+        r[i] = r[i] - omega * t[i]
+
+
+@wp.kernel
+def _bicgstab_update_p(
+    resid_sq: wp.array(dtype=Any),
+    tol_sq: wp.array(dtype=Any),
+    rho_old: wp.array(dtype=Any),
+    rho_new: wp.array(dtype=Any),
+    r0_v: wp.array(dtype=Any),
+    t_s: wp.array(dtype=Any),
+    t_t: wp.array(dtype=Any),
+    r: wp.array(dtype=Any),
+    v: wp.array(dtype=Any),
+    p: wp.array(dtype=Any),
+):
+    i = wp.tid()
+    if resid_sq[0] > tol_sq[0]:
+        alpha = _safe_div(rho_old[0], r0_v[0])
+        omega = _safe_div(t_s[0], t_t[0])
+        beta = _safe_div(rho_new[0] * alpha, rho_old[0] * omega)
+        p[i] = r[i] + beta * (p[i] - omega * v[i])
@@ -0,0 +1,179 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import warp as wp
+
+
+@wp.struct
+class TensorSlot:
+    # flat float views of a parameter tensor, its gradient and up to two optimizer state tensors
+    param: wp.array(dtype=float)
+    grad: wp.array(dtype=float)
+    state0: wp.array(dtype=float)
+    state1: wp.array(dtype=float)
+
+
+@wp.func
+def tensor_slot_index(offsets: wp.array(dtype=int), tid: int):
+    # offsets[s] <= tid < offsets[s + 1], empty tensors are skipped
+    return wp.lower_bound(offsets, tid + 1) - 1
+
+
+@wp.kernel
+def tensor_grad_sq_kernel(
+    slots: wp.array(dtype=TensorSlot),
+    offsets: wp.array(dtype=int),
+    out: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    s = tensor_slot_index(offsets, tid)
+    grad = slots[s].grad
+    g = grad[tid - offsets[s]]
+    out[tid] = g * g
+
+
+@wp.kernel
+def grad_clip_scale_kernel(grad_sq_sum: wp.array(dtype=float), max_norm: float, grad_norm: wp.array(dtype=float)):
+    norm = wp.sqrt(grad_sq_sum[0])
+    grad_norm[0] = norm
+    grad_norm[1] = wp.min(1.0, max_norm / (norm + 1.0e-6))
+
+
+@wp.kernel
+def step_count_increment_kernel(step: wp.array(dtype=int)):
+    step[0] = step[0] + 1
+
+
+def _flat_float_view(a):
+    return wp.array(
+        ptr=a.ptr,
+        dtype=float,
+        shape=(a.size * wp.types.type_length(a.dtype),),
+        device=a.device,
+        copy=False,
+        owner=False,
+    )
+
+
+class TensorTable:
+    """Device-side table of parameter, gradient and optimizer state tensors.
+
+    All tensors are viewed as flat float arrays, so that an optimizer updates every parameter in a single kernel
+    launch with one thread per scalar, instead of one launch per parameter array. The table only holds pointers,
+    tensors must outlive it and keep their storage.
+    """
+
+    def __init__(self, params, grads, states):
+        self.device = params[0].device
+        self.key = TensorTable.make_key(params, grads, states)
+
+        slots = []
+        offsets = [0]
+        for i in range(len(params)):
+            slot = TensorSlot()
+            slot.param = _flat_float_view(params[i])
+            slot.grad = _flat_float_view(grads[i])
+            if len(states) > 0:
+                slot.state0 = _flat_float_view(states[0][i])
+            if len(states) > 1:
+                slot.state1 = _flat_float_view(states[1][i])
+            slots.append(slot)
+            offsets.append(offsets[-1] + params[i].size * wp.types.type_length(params[i].dtype))
+
+        self.size = offsets[-1]
+        self.slots = wp.array(slots, dtype=TensorSlot, device=self.device)
+        self.offsets = wp.array(offsets, dtype=int, device=self.device)
+
+        # scratch storage of the squared gradients, allocated on the first clipped step
+        self._grad_sq = None
+        self._grad_sq_sum = None
+
+    @staticmethod
+    def make_key(params, grads, states):
+        arrays = [*params, *grads]
+        for s in states:
+            arrays.extend(s)
+        return tuple(None if a is None else (a.ptr, a.size, a.dtype) for a in arrays)
+
+    @staticmethod
+    def supports(params, grads, states):
+        """Returns whether the tensors can be updated in a single launch, i.e. they are contiguous float32 arrays
+        on the same device with matching shapes"""
+        if not params or len(grads) != len(params):
+            return False
+
+        device = params[0].device
+        for i, p in enumerate(params):
+            tensors = [p, grads[i]] + [s[i] for s in states]
+            for a in tensors:
+                if a is None or a.device != device or not a.is_contiguous:
+                    return False
+                if wp.types.type_scalar_type(a.dtype) != wp.float32 or a.dtype != p.dtype or a.shape != p.shape:
+                    return False
+        return True
+
+    def compute_grad_norm(self, max_norm, grad_norm):
+        """Writes the global norm of the gradients to ``grad_norm[0]`` and the factor scaling them to a norm of at
+        most ``max_norm`` to ``grad_norm[1]``, without synchronizing with the host"""
+        if self._grad_sq is None:
+            self._grad_sq = wp.empty(self.size, dtype=float, device=self.device)
+            self._grad_sq_sum = wp.empty(1, dtype=float, device=self.device)
+
+        wp.launch(
+            tensor_grad_sq_kernel,
+            dim=self.size,
+            inputs=[self.slots, self.offsets],
+            outputs=[self._grad_sq],
+            device=self.device,
+        )
+        wp.utils.array_sum(self._grad_sq, out=self._grad_sq_sum)
+        wp.launch(
+            grad_clip_scale_kernel,
+            dim=1,
+            inputs=[self._grad_sq_sum, max_norm],
+            outputs=[grad_norm],
+            device=self.device,
+        )
+
+
+class MultiTensorState:
+    """Step counter, gradient norm and tensor table shared by the fused optimizer steps.
+
+    The step counter lives on the device, so a step captured in a CUDA graph keeps advancing it on replay.
+    """
+
+    def __init__(self):
+        self.table = None
+        self.step_count = None
+        # global gradient norm and clipping factor of the last step: [norm, scale]
+        self.grad_norm = None
+
+    def prepare(self, params, grads, states, t):
+        """Returns the tensor table of the given tensors, or None if they do not support a fused update. The table
+        is only rebuilt when the tensors change, so steps reusing the same arrays do not allocate or copy from the
+        host and can be captured once a first step has run."""
+        key = TensorTable.make_key(params, grads, states) if params else None
+        if self.table is not None and self.table.key == key:
+            return self.table
+
+        if not TensorTable.supports(params, grads, states):
+            self.table = None
+            return None
+
+        self.table = TensorTable(params, grads, states)
+        if self.step_count is None or self.step_count.device != self.table.device:
+            self.step_count = wp.array([t], dtype=int, device=self.table.device)
+            self.grad_norm = wp.array([0.0, 1.0], dtype=float, device=self.table.device)
+        return self.table
+
+    def advance(self):
+        wp.launch(step_count_increment_kernel, dim=1, inputs=[self.step_count], device=self.step_count.device)
+
+    def reset(self):
+        if self.step_count is not None:
+            self.step_count.zero_()
+            self.grad_norm.assign([0.0, 1.0])
@@ -6,6 +6,7 @@
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
 import warp as wp
+from warp.optim.multi_tensor import MultiTensorState, TensorSlot, tensor_slot_index
 from typing import Any
 
 
@@ -39,13 +40,64 @@ def sgd_step_kernel(
     params[i] = params[i] - lr * gt
 
 
+@wp.kernel
+def sgd_step_kernel_multi_tensor(
+    slots: wp.array(dtype=TensorSlot),
+    offsets: wp.array(dtype=int),
+    step: wp.array(dtype=int),
+    grad_norm: wp.array(dtype=float),
+    clip: int,
+    lr: float,
+    weight_decay: float,
+    momentum: float,
+    damping: float,
+    nesterov: int,
+):
+    tid = wp.tid()
+    s = tensor_slot_index(offsets, tid)
+    i = tid - offsets[s]
+    slot = slots[s]
+    params = slot.param
+    b = slot.state0
+
+    gt = slot.grad[i]
+    if clip != 0:
+        gt = gt * grad_norm[1]
+    if weight_decay != 0.0:
+        gt += weight_decay * params[i]
+    if momentum != 0.0:
+        bt = b[i]
+        if step[0] > 0:
+            bt = momentum * bt + (1.0 - damping) * gt
+        else:
+            bt = gt
+        if nesterov == 1:
+            gt += momentum * bt
+        else:
+            gt = bt
+        b[i] = bt
+    params[i] = params[i] - lr * gt
+
+
 class SGD:
     """An implementation of the Stochastic Gradient Descent Optimizer
     It is designed to mimic Pytorch's version.
     https://pytorch.org/docs/stable/generated/torch.optim.SGD.html
+
+    Float32-based parameters on a single device are updated in one kernel launch, see :class:`warp.optim.Adam`
+    for the graph capture and ``max_grad_norm`` gradient clipping behavior.
     """
 
-    def __init__(self, params=None, lr=0.001, momentum=0.0, dampening=0.0, weight_decay=0.0, nesterov=False):
+    def __init__(
+        self,
+        params=None,
+        lr=0.001,
+        momentum=0.0,
+        dampening=0.0,
+        weight_decay=0.0,
+        nesterov=False,
+        max_grad_norm=None,
+    ):
         self.b = []  # momentum buffer
         self.set_params(params)
         self.lr = lr
@@ -53,7 +105,9 @@ class SGD:
         self.dampening = dampening
         self.weight_decay = weight_decay
         self.nesterov = nesterov
+        self.max_grad_norm = max_grad_norm
         self.t = 0
+        self._multi_tensor = MultiTensorState()
 
     def set_params(self, params):
         self.params = params
@@ -69,13 +123,53 @@ class SGD:
         for b_i in self.b:
             b_i.zero_()
         self.t = 0
+        self._multi_tensor.reset()
+
+    @property
+    def grad_norm(self):
+        """Device array holding the global gradient norm and the clipping factor of the last fused step"""
+        return self._multi_tensor.grad_norm
 
     def step(self, grad):
         assert self.params is not None
-        for i in range(len(self.params)):
-            SGD.step_detail(
-                grad[i], self.b[i], self.lr, self.momentum, self.dampening, self.weight_decay, self.nesterov, self.t, self.params[i]
+        table = self._multi_tensor.prepare(self.params, grad, [self.b], self.t)
+        if table is not None:
+            clip = self.max_grad_norm is not None
+            if clip:
+                table.compute_grad_norm(self.max_grad_norm, self._multi_tensor.grad_norm)
+            wp.launch(
+                kernel=sgd_step_kernel_multi_tensor,
+                dim=table.size,
+                inputs=[
+                    table.slots,
+                    table.offsets,
+                    self._multi_tensor.step_count,
+                    self._multi_tensor.grad_norm,
+                    int(clip),
+                    self.lr,
+                    self.weight_decay,
+                    self.momentum,
+                    self.dampening,
+                    int(self.nesterov),
+                ],
+                device=table.device,
             )
+            self._multi_tensor.advance()
+        else:
+            if self.max_grad_norm is not None:
+                raise RuntimeError("Gradient clipping requires contiguous float32 parameters on a single device.")
+            for i in range(len(self.params)):
+                SGD.step_detail(
+                    grad[i],
+                    self.b[i],
+                    self.lr,
+                    self.momentum,
+                    self.dampening,
+                    self.weight_decay,
+                    self.nesterov,
+                    self.t,
+                    self.params[i],
+                )
         self.t = self.t + 1
 
     @staticmethod
@@ -8,3 +8,4 @@
 from .utils import bourke_color_map
 from .render_usd import UsdRenderer
 from .render_opengl import OpenGLRenderer
+from .render_raytrace import RayTracer
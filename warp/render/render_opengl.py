@@ -62,7 +62,8 @@ void main()
 
 shape_fragment_shader = """
 #version 330 core
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out float FragDepth;
 
 in vec3 Normal;
 in vec3 FragPos;
@@ -113,6 +114,7 @@ void main()
 
     vec3 result = (ambient + diffuse + specular) * checkerColor;
     FragColor = vec4(result, 1.0);
+    FragDepth = gl_FragCoord.z;
 }
 """
 
@@ -134,10 +136,12 @@ void main() {
 grid_fragment_shader = """
 #version 330 core
 
-out vec4 outColor;
+layout (location = 0) out vec4 outColor;
+layout (location = 1) out float FragDepth;
 
 void main() {
     outColor = vec4(0.5, 0.5, 0.5, 1.0);
+    FragDepth = gl_FragCoord.z;
 }
 """
 
@@ -168,7 +172,8 @@ void main()
 sky_fragment_shader = """
 #version 330 core
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out float FragDepth;
 
 in vec3 FragPos;
 in vec2 TexCoord;
@@ -193,6 +198,7 @@ void main()
     vec3 sun = pow(diff, 32) * vec3(1.0, 0.8, 0.6) * 0.5;
 
     FragColor = vec4(sky + sun, 1.0);
+    FragDepth = gl_FragCoord.z;
 }
 """
 
@@ -268,14 +274,46 @@ def update_vbo_transforms(
     )
 
 
+@wp.kernel
+def update_vbo_colors(
+    instance_id: wp.array(dtype=int),
+    instance_colors1: wp.array(dtype=wp.vec3),
+    instance_colors2: wp.array(dtype=wp.vec3),
+    # outputs
+    vbo_colors1: wp.array(dtype=wp.vec3),
+    vbo_colors2: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    i = tid
+    if instance_id:
+        i = instance_id[tid]
+    vbo_colors1[tid] = instance_colors1[i]
+    vbo_colors2[tid] = instance_colors2[i]
+
+
+@wp.kernel
+def compute_instance_transforms(
+    positions: wp.array(dtype=wp.vec3),
+    rotations: wp.array(dtype=wp.quat),
+    # outputs
+    instance_transforms: wp.array(dtype=wp.transform),
+):
+    tid = wp.tid()
+    q = wp.quat_identity()
+    if rotations:
+        q = rotations[tid]
+    instance_transforms[tid] = wp.transform(positions[tid], q)
+
+
 @wp.kernel
 def update_vbo_vertices(
     points: wp.array(dtype=wp.vec3),
+    scale: wp.vec3,
     # outputs
     vbo_vertices: wp.array(dtype=float, ndim=2),
 ):
     tid = wp.tid()
-    p = points[tid]
+    p = wp.cw_mul(points[tid], scale)
     vbo_vertices[tid, 0] = p[0]
     vbo_vertices[tid, 1] = p[1]
     vbo_vertices[tid, 2] = p[2]
@@ -303,15 +341,8 @@ def update_points_positions(
     # fmt: on
 
 
-@wp.kernel
-def update_line_transforms(
-    lines: wp.array(dtype=wp.vec3, ndim=2),
-    # outputs
-    vbo_transforms: wp.array(dtype=wp.mat44),
-):
-    tid = wp.tid()
-    p0 = lines[tid, 0]
-    p1 = lines[tid, 1]
+@wp.func
+def line_transform(p0: wp.vec3, p1: wp.vec3):
     p = 0.5 * (p0 + p1)
     d = p1 - p0
     s = wp.length(d)
@@ -323,7 +354,7 @@ def update_line_transforms(
     rot = wp.quat_to_matrix(q)
     # transposed definition
     # fmt: off
-    vbo_transforms[tid] = wp.mat44(
+    return wp.mat44(
             rot[0, 0],     rot[1, 0],     rot[2, 0], 0.0,
         s * rot[0, 1], s * rot[1, 1], s * rot[2, 1], 0.0,
             rot[0, 2],     rot[1, 2],     rot[2, 2], 0.0,
@@ -332,6 +363,37 @@ def update_line_transforms(
     # fmt: on
 
 
+@wp.kernel
+def update_line_transforms(
+    lines: wp.array(dtype=wp.vec3, ndim=2),
+    # outputs
+    vbo_transforms: wp.array(dtype=wp.mat44),
+):
+    tid = wp.tid()
+    vbo_transforms[tid] = line_transform(lines[tid, 0], lines[tid, 1])
+
+
+@wp.kernel
+def update_line_list_transforms(
+    vertices: wp.array(dtype=wp.vec3),
+    indices: wp.array(dtype=int),
+    # outputs
+    vbo_transforms: wp.array(dtype=wp.mat44),
+):
+    tid = wp.tid()
+    vbo_transforms[tid] = line_transform(vertices[indices[2 * tid]], vertices[indices[2 * tid + 1]])
+
+
+@wp.kernel
+def update_line_strip_transforms(
+    vertices: wp.array(dtype=wp.vec3),
+    # outputs
+    vbo_transforms: wp.array(dtype=wp.mat44),
+):
+    tid = wp.tid()
+    vbo_transforms[tid] = line_transform(vertices[tid], vertices[tid + 1])
+
+
 @wp.kernel
 def compute_gfx_vertices(
     indices: wp.array(dtype=int, ndim=2),
@@ -410,33 +472,44 @@ def assemble_gfx_vertices(
     gfx_vertices[tid, 5] = n[2]
 
 
+@wp.func
+def linearize_depth(depth: float, near_plane: float, far_plane: float):
+    # convert window-space depth to the distance along the view axis
+    z = 2.0 * depth - 1.0
+    return 2.0 * near_plane * far_plane / (far_plane + near_plane - z * (far_plane - near_plane))
+
+
 @wp.kernel
 def copy_frame(
-    input_img: wp.array(dtype=wp.uint8),
-    width: int,
-    height: int,
+    input_img: wp.array(dtype=wp.uint8, ndim=3),
     # outputs
     output_img: wp.array(dtype=float, ndim=3),
 ):
     w, v = wp.tid()
-    pixel = v * width + w
-    pixel *= 3
-    r = float(input_img[pixel + 0])
-    g = float(input_img[pixel + 1])
-    b = float(input_img[pixel + 2])
     # flip vertically (OpenGL coordinates start at bottom)
-    v = height - v - 1
-    output_img[v, w, 0] = r / 255.0
-    output_img[v, w, 1] = g / 255.0
-    output_img[v, w, 2] = b / 255.0
+    y = input_img.shape[0] - v - 1
+    for c in range(3):
+        output_img[y, w, c] = float(input_img[v, w, c]) / 255.0
+
+
+@wp.kernel
+def copy_depth_frame(
+    input_depth: wp.array(dtype=float, ndim=2),
+    near_plane: float,
+    far_plane: float,
+    # outputs
+    output_img: wp.array(dtype=float, ndim=3),
+):
+    w, v = wp.tid()
+    # flip vertically (OpenGL coordinates start at bottom)
+    y = input_depth.shape[0] - v - 1
+    output_img[y, w, 0] = linearize_depth(input_depth[v, w], near_plane, far_plane)
 
 
 @wp.kernel
 def copy_frame_tiles(
-    input_img: wp.array(dtype=wp.uint8),
+    input_img: wp.array(dtype=wp.uint8, ndim=3),
     positions: wp.array(dtype=int, ndim=2),
-    screen_width: int,
-    screen_height: int,
     tile_height: int,
     # outputs
     output_img: wp.array(dtype=float, ndim=4),
@@ -445,52 +518,36 @@ def copy_frame_tiles(
     p = positions[tile]
     qx = x + p[0]
     qy = y + p[1]
-    pixel = qy * screen_width + qx
     # flip vertically (OpenGL coordinates start at bottom)
     y = tile_height - y - 1
-    if qx >= screen_width or qy >= screen_height:
-        output_img[tile, y, x, 0] = 0.0
-        output_img[tile, y, x, 1] = 0.0
-        output_img[tile, y, x, 2] = 0.0
+    if qx >= input_img.shape[1] or qy >= input_img.shape[0]:
+        for c in range(3):
+            output_img[tile, y, x, c] = 0.0
         return  # prevent out-of-bounds access
-    pixel *= 3
-    r = float(input_img[pixel + 0])
-    g = float(input_img[pixel + 1])
-    b = float(input_img[pixel + 2])
-    output_img[tile, y, x, 0] = r / 255.0
-    output_img[tile, y, x, 1] = g / 255.0
-    output_img[tile, y, x, 2] = b / 255.0
+    for c in range(3):
+        output_img[tile, y, x, c] = float(input_img[qy, qx, c]) / 255.0
 
 
 @wp.kernel
-def copy_frame_tile(
-    input_img: wp.array(dtype=wp.uint8),
-    offset_x: int,
-    offset_y: int,
-    screen_width: int,
-    screen_height: int,
+def copy_depth_frame_tiles(
+    input_depth: wp.array(dtype=float, ndim=2),
+    positions: wp.array(dtype=int, ndim=2),
     tile_height: int,
+    near_plane: float,
+    far_plane: float,
     # outputs
     output_img: wp.array(dtype=float, ndim=4),
 ):
     tile, x, y = wp.tid()
-    qx = x + offset_x
-    qy = y + offset_y
-    pixel = qy * screen_width + qx
+    p = positions[tile]
+    qx = x + p[0]
+    qy = y + p[1]
     # flip vertically (OpenGL coordinates start at bottom)
     y = tile_height - y - 1
-    if qx >= screen_width or qy >= screen_height:
-        output_img[tile, y, x, 0] = 0.0
-        output_img[tile, y, x, 1] = 0.0
-        output_img[tile, y, x, 2] = 0.0
+    if qx >= input_depth.shape[1] or qy >= input_depth.shape[0]:
+        output_img[tile, y, x, 0] = far_plane
         return  # prevent out-of-bounds access
-    pixel *= 3
-    r = float(input_img[pixel + 0])
-    g = float(input_img[pixel + 1])
-    b = float(input_img[pixel + 2])
-    output_img[tile, y, x, 0] = r / 255.0
-    output_img[tile, y, x, 1] = g / 255.0
-    output_img[tile, y, x, 2] = b / 255.0
+    output_img[tile, y, x, 0] = linearize_depth(input_depth[qy, qx], near_plane, far_plane)
 
 
 def check_gl_error():
@@ -519,9 +576,15 @@ class ShapeInstancer:
         self.color1 = (1.0, 1.0, 1.0)
         self.color2 = (0.0, 0.0, 0.0)
         self.num_instances = 0
-        self.transforms = None
-        self.scalings = None
+        self.instance_ids = None
+        self.instance_transforms = None
+        self.instance_scalings = None
+        self.instance_colors1 = None
+        self.instance_colors2 = None
+        self._instance_capacity = 0
         self._instance_transform_cuda_buffer = None
+        self._instance_color1_cuda_buffer = None
+        self._instance_color2_cuda_buffer = None
 
     def __del__(self):
         from pyglet import gl
@@ -583,87 +646,69 @@ class ShapeInstancer:
         self.face_count = len(indices)
 
     def allocate_instances(self, positions, rotations=None, colors1=None, colors2=None, scalings=None):
-        from pyglet import gl
-
-        gl.glBindVertexArray(self.vao)
-
         self.num_instances = len(positions)
 
-        # Create instance buffer and bind it as an instanced array
-        if self.instance_transform_gl_buffer is None:
-            self.instance_transform_gl_buffer = gl.GLuint()
-            gl.glGenBuffers(1, self.instance_transform_gl_buffer)
-        gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self.instance_transform_gl_buffer)
+        # GL storage is only reallocated when the number of instances grows,
+        # instance data is then written to it by kernels through the registered CUDA buffers
+        if self.num_instances > self._instance_capacity:
+            self._allocate_instance_buffers(self.num_instances)
 
         self.instance_ids = wp.array(np.arange(self.num_instances), dtype=wp.int32, device=self.device)
-        if rotations is None:
-            self.instance_transforms = wp.array(
-                [(*pos, 0.0, 0.0, 0.0, 1.0) for pos in positions], dtype=wp.transform, device=self.device
-            )
-        else:
-            self.instance_transforms = wp.array(
-                [(*pos, *rot) for pos, rot in zip(positions, rotations)], dtype=wp.transform, device=self.device
-            )
-
-        if scalings is None:
-            self.instance_scalings = wp.array(
-                np.tile((1.0, 1.0, 1.0), (self.num_instances, 1)), dtype=wp.vec3, device=self.device
-            )
-        else:
-            self.instance_scalings = wp.array(scalings, dtype=wp.vec3, device=self.device)
 
-        vbo_transforms = wp.zeros(dtype=wp.mat44, shape=(self.num_instances,), device=self.device)
+        if not isinstance(positions, wp.array):
+            positions = wp.array(positions, dtype=wp.vec3, device=self.device)
+        if rotations is not None and not isinstance(rotations, wp.array):
+            rotations = wp.array(rotations, dtype=wp.quat, device=self.device)
 
+        self.instance_transforms = wp.empty(shape=(self.num_instances,), dtype=wp.transform, device=self.device)
         wp.launch(
-            update_vbo_transforms,
+            compute_instance_transforms,
             dim=self.num_instances,
-            inputs=[
-                self.instance_ids,
-                None,
-                self.instance_transforms,
-                self.instance_scalings,
-                None,
-            ],
-            outputs=[
-                vbo_transforms,
-            ],
+            inputs=[positions.to(self.device), None if rotations is None else rotations.to(self.device)],
+            outputs=[self.instance_transforms],
             device=self.device,
         )
 
-        vbo_transforms = vbo_transforms.numpy()
-        gl.glBufferData(gl.GL_ARRAY_BUFFER, vbo_transforms.nbytes, vbo_transforms.ctypes.data, gl.GL_DYNAMIC_DRAW)
-
-        # Create CUDA buffer for instance transforms
-        self._instance_transform_cuda_buffer = wp.RegisteredGLBuffer(
-            int(self.instance_transform_gl_buffer.value), self.device
-        )
+        if scalings is None:
+            self.instance_scalings = wp.full(
+                shape=(self.num_instances,), value=wp.vec3(1.0), dtype=wp.vec3, device=self.device
+            )
+        else:
+            self.instance_scalings = self._to_device_vec3(scalings)
 
         if colors1 is None:
-            colors1 = np.tile(self.color1, (self.num_instances, 1))
+            colors1 = self._full_colors(self.color1)
         if colors2 is None:
-            colors2 = np.tile(self.color2, (self.num_instances, 1))
-        colors1 = np.array(colors1, dtype=np.float32)
-        colors2 = np.array(colors2, dtype=np.float32)
+            colors2 = self._full_colors(self.color2)
 
-        # create buffer for checkerboard colors
-        if self.instance_color1_buffer is None:
+        self.update_instances(
+            transforms=self.instance_transforms,
+            scalings=self.instance_scalings,
+            colors1=colors1,
+            colors2=colors2,
+        )
+
+    def _allocate_instance_buffers(self, capacity):
+        from pyglet import gl
+
+        self._instance_capacity = capacity
+
+        gl.glBindVertexArray(self.vao)
+
+        if self.instance_transform_gl_buffer is None:
+            self.instance_transform_gl_buffer = gl.GLuint()
+            gl.glGenBuffers(1, self.instance_transform_gl_buffer)
             self.instance_color1_buffer = gl.GLuint()
             gl.glGenBuffers(1, self.instance_color1_buffer)
-        gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self.instance_color1_buffer)
-        gl.glBufferData(gl.GL_ARRAY_BUFFER, colors1.nbytes, colors1.ctypes.data, gl.GL_STATIC_DRAW)
-
-        if self.instance_color2_buffer is None:
             self.instance_color2_buffer = gl.GLuint()
             gl.glGenBuffers(1, self.instance_color2_buffer)
-        gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self.instance_color2_buffer)
-        gl.glBufferData(gl.GL_ARRAY_BUFFER, colors2.nbytes, colors2.ctypes.data, gl.GL_STATIC_DRAW)
 
-        # Set up instance attribute pointers
-        matrix_size = vbo_transforms[0].nbytes
-
-        gl.glBindVertexArray(self.vao)
+        matrix_size = 16 * ctypes.sizeof(ctypes.c_float)
+        color_size = 3 * ctypes.sizeof(ctypes.c_float)
 
+        # Allocate uninitialized storage, then register it with CUDA
         gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self.instance_transform_gl_buffer)
+        gl.glBufferData(gl.GL_ARRAY_BUFFER, capacity * matrix_size, None, gl.GL_DYNAMIC_DRAW)
 
         # we can only send vec4s to the shader, so we need to split the instance transforms matrix into its column vectors
         for i in range(4):
@@ -673,36 +718,38 @@ class ShapeInstancer:
             gl.glEnableVertexAttribArray(3 + i)
             gl.glVertexAttribDivisor(3 + i, 1)
 
-        gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self.instance_color1_buffer)
-        gl.glVertexAttribPointer(7, 3, gl.GL_FLOAT, gl.GL_FALSE, colors1[0].nbytes, ctypes.c_void_p(0))
-        gl.glEnableVertexAttribArray(7)
-        gl.glVertexAttribDivisor(7, 1)
-
-        gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self.instance_color2_buffer)
-        gl.glVertexAttribPointer(8, 3, gl.GL_FLOAT, gl.GL_FALSE, colors2[0].nbytes, ctypes.c_void_p(0))
-        gl.glEnableVertexAttribArray(8)
-        gl.glVertexAttribDivisor(8, 1)
+        # create buffers for checkerboard colors
+        for attrib, color_buffer in ((7, self.instance_color1_buffer), (8, self.instance_color2_buffer)):
+            gl.glBindBuffer(gl.GL_ARRAY_BUFFER, color_buffer)
+            gl.glBufferData(gl.GL_ARRAY_BUFFER, capacity * color_size, None, gl.GL_DYNAMIC_DRAW)
+            gl.glVertexAttribPointer(attrib, 3, gl.GL_FLOAT, gl.GL_FALSE, color_size, ctypes.c_void_p(0))
+            gl.glEnableVertexAttribArray(attrib)
+            gl.glVertexAttribDivisor(attrib, 1)
 
         gl.glBindVertexArray(0)
 
-    def update_instances(self, transforms: wp.array = None, scalings: wp.array = None, colors1=None, colors2=None):
-        from pyglet import gl
+        self._instance_transform_cuda_buffer = wp.RegisteredGLBuffer(
+            int(self.instance_transform_gl_buffer.value), self.device
+        )
+        self._instance_color1_cuda_buffer = wp.RegisteredGLBuffer(int(self.instance_color1_buffer.value), self.device)
+        self._instance_color2_cuda_buffer = wp.RegisteredGLBuffer(int(self.instance_color2_buffer.value), self.device)
+
+    def _full_colors(self, color):
+        color = wp.vec3(*(float(c) for c in color))
+        return wp.full(shape=(self.num_instances,), value=color, dtype=wp.vec3, device=self.device)
 
+    def _to_device_vec3(self, values):
+        if isinstance(values, wp.array):
+            return values.to(self.device)
+        return wp.array(np.array(values, dtype=np.float32).reshape(-1, 3), dtype=wp.vec3, device=self.device)
+
+    def update_instances(self, transforms: wp.array = None, scalings: wp.array = None, colors1=None, colors2=None):
         if transforms is not None:
-            if transforms.device.is_cuda:
-                wp_transforms = transforms
-            else:
-                wp_transforms = transforms.to(self.device)
-            self.transforms = wp_transforms
+            self.instance_transforms = transforms.to(self.device)
         if scalings is not None:
-            if transforms.device.is_cuda:
-                wp_scalings = scalings
-            else:
-                wp_scalings = scalings.to(self.device)
-            self.scalings = wp_scalings
+            self.instance_scalings = scalings.to(self.device)
 
         if transforms is not None or scalings is not None:
-            gl.glBindVertexArray(self.vao)
             vbo_transforms = self._instance_transform_cuda_buffer.map(dtype=wp.mat44, shape=(self.num_instances,))
 
             wp.launch(
@@ -723,6 +770,26 @@ class ShapeInstancer:
 
             self._instance_transform_cuda_buffer.unmap()
 
+        if colors1 is not None:
+            self.instance_colors1 = self._to_device_vec3(colors1)
+        if colors2 is not None:
+            self.instance_colors2 = self._to_device_vec3(colors2)
+
+        if colors1 is not None or colors2 is not None:
+            vbo_colors1 = self._instance_color1_cuda_buffer.map(dtype=wp.vec3, shape=(self.num_instances,))
+            vbo_colors2 = self._instance_color2_cuda_buffer.map(dtype=wp.vec3, shape=(self.num_instances,))
+
+            wp.launch(
+                update_vbo_colors,
+                dim=self.num_instances,
+                inputs=[None, self.instance_colors1, self.instance_colors2],
+                outputs=[vbo_colors1, vbo_colors2],
+                device=self.device,
+            )
+
+            self._instance_color1_cuda_buffer.unmap()
+            self._instance_color2_cuda_buffer.unmap()
+
     def render(self):
         from pyglet import gl
 
@@ -860,6 +927,8 @@ class OpenGLRenderer:
         self._instance_transform_cuda_buffer = None
         self._instance_color1_buffer = None
         self._instance_color2_buffer = None
+        self._instance_color1_cuda_buffer = None
+        self._instance_color2_cuda_buffer = None
         self._instance_count = 0
         self._wp_instance_ids = None
         self._instance_ids = None
@@ -867,7 +936,13 @@ class OpenGLRenderer:
         self._wp_instance_transforms = None
         self._wp_instance_scalings = None
         self._wp_instance_bodies = None
+        self._wp_instance_colors1 = None
+        self._wp_instance_colors2 = None
+        self._instance_transforms_host = None
+        self._instance_colors1_host = None
+        self._instance_colors2_host = None
         self._update_shape_instances = False
+        self._update_shape_colors = False
         self._add_shape_instances = False
 
         # additional shape instancer used for points and line rendering
@@ -888,8 +963,10 @@ class OpenGLRenderer:
         self._tile_projection_matrices = None
 
         self._frame_texture = None
+        self._frame_depth_texture = None
         self._frame_fbo = None
-        self._frame_pbo = None
+        # registered frame textures and device staging arrays, keyed by readback mode
+        self._frame_readback = {}
 
         self.window.push_handlers(on_draw=self._draw)
         self.window.push_handlers(on_resize=self._window_resize_callback)
@@ -1136,6 +1213,8 @@ class OpenGLRenderer:
         self.app.event_loop.dispatch_event("on_exit")
         self.app.platform_event_loop.stop()
 
+        self._frame_readback.clear()
+
         if self._instance_transform_gl_buffer is not None:
             try:
                 gl.glDeleteBuffers(1, self._instance_transform_gl_buffer)
@@ -1163,11 +1242,19 @@ class OpenGLRenderer:
         self._instance_transform_cuda_buffer = None
         self._instance_color1_buffer = None
         self._instance_color2_buffer = None
+        self._instance_color1_cuda_buffer = None
+        self._instance_color2_cuda_buffer = None
         self._wp_instance_ids = None
         self._wp_instance_transforms = None
         self._wp_instance_scalings = None
         self._wp_instance_bodies = None
+        self._wp_instance_colors1 = None
+        self._wp_instance_colors2 = None
+        self._instance_transforms_host = None
+        self._instance_colors1_host = None
+        self._instance_colors2_host = None
         self._update_shape_instances = False
+        self._update_shape_colors = False
 
     @property
     def tiled_rendering(self):
@@ -1319,26 +1406,50 @@ class OpenGLRenderer:
     def _setup_framebuffer(self):
         from pyglet import gl
 
+        # textures must be unregistered from CUDA before their storage is reallocated
+        self._frame_readback.clear()
+
         if self._frame_texture is None:
             self._frame_texture = gl.GLuint()
             gl.glGenTextures(1, self._frame_texture)
+        if self._frame_depth_texture is None:
+            self._frame_depth_texture = gl.GLuint()
+            gl.glGenTextures(1, self._frame_depth_texture)
 
         gl.glBindFramebuffer(gl.GL_FRAMEBUFFER, 0)
         gl.glBindBuffer(gl.GL_PIXEL_UNPACK_BUFFER, 0)
+        # RGBA rather than RGB storage so that the texture can be registered with CUDA
         gl.glBindTexture(gl.GL_TEXTURE_2D, self._frame_texture)
         gl.glTexImage2D(
             gl.GL_TEXTURE_2D,
             0,
-            gl.GL_RGB,
+            gl.GL_RGBA8,
             self.screen_width,
             self.screen_height,
             0,
-            gl.GL_RGB,
+            gl.GL_RGBA,
             gl.GL_UNSIGNED_BYTE,
             None,
         )
         gl.glTexParameteri(gl.GL_TEXTURE_2D, gl.GL_TEXTURE_MIN_FILTER, gl.GL_LINEAR)
         gl.glTexParameteri(gl.GL_TEXTURE_2D, gl.GL_TEXTURE_MAG_FILTER, gl.GL_LINEAR)
+
+        # depth renderbuffers cannot be mapped by CUDA, the shaders write the fragment depth
+        # to a second color attachment instead
+        gl.glBindTexture(gl.GL_TEXTURE_2D, self._frame_depth_texture)
+        gl.glTexImage2D(
+            gl.GL_TEXTURE_2D,
+            0,
+            gl.GL_R32F,
+            self.screen_width,
+            self.screen_height,
+            0,
+            gl.GL_RED,
+            gl.GL_FLOAT,
+            None,
+        )
+        gl.glTexParameteri(gl.GL_TEXTURE_2D, gl.GL_TEXTURE_MIN_FILTER, gl.GL_NEAREST)
+        gl.glTexParameteri(gl.GL_TEXTURE_2D, gl.GL_TEXTURE_MAG_FILTER, gl.GL_NEAREST)
         gl.glBindTexture(gl.GL_TEXTURE_2D, 0)
 
         # create a framebuffer object (FBO)
@@ -1351,6 +1462,11 @@ class OpenGLRenderer:
             gl.glFramebufferTexture2D(
                 gl.GL_FRAMEBUFFER, gl.GL_COLOR_ATTACHMENT0, gl.GL_TEXTURE_2D, self._frame_texture, 0
             )
+            gl.glFramebufferTexture2D(
+                gl.GL_FRAMEBUFFER, gl.GL_COLOR_ATTACHMENT1, gl.GL_TEXTURE_2D, self._frame_depth_texture, 0
+            )
+            draw_buffers = (gl.GLenum * 2)(gl.GL_COLOR_ATTACHMENT0, gl.GL_COLOR_ATTACHMENT1)
+            gl.glDrawBuffers(2, draw_buffers)
 
             self._frame_depth_renderbuffer = gl.GLuint()
             gl.glGenRenderbuffers(1, self._frame_depth_renderbuffer)
@@ -1377,16 +1493,6 @@ class OpenGLRenderer:
         # unbind the FBO (switch back to the default framebuffer)
         gl.glBindFramebuffer(gl.GL_FRAMEBUFFER, 0)
 
-        if self._frame_pbo is None:
-            self._frame_pbo = gl.GLuint()
-            gl.glGenBuffers(1, self._frame_pbo)  # generate 1 buffer reference
-        gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, self._frame_pbo)  # binding to this buffer
-
-        # allocate memory for PBO
-        pixels = np.zeros((self.screen_height, self.screen_width, 3), dtype=np.uint8)
-        gl.glBufferData(gl.GL_PIXEL_PACK_BUFFER, pixels.nbytes, pixels.ctypes.data, gl.GL_DYNAMIC_DRAW)
-        gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, 0)
-
     @staticmethod
     def compute_projection_matrix(
         fov: float,
@@ -1546,6 +1652,9 @@ class OpenGLRenderer:
 
         gl.glClearColor(*self.background_color, 1)
         gl.glClear(gl.GL_COLOR_BUFFER_BIT | gl.GL_DEPTH_BUFFER_BIT)
+        if self._frame_fbo is not None:
+            # pixels not covered by any geometry are at the far plane
+            gl.glClearBufferfv(gl.GL_COLOR, 1, (gl.GLfloat * 4)(1.0, 1.0, 1.0, 1.0))
         gl.glBindVertexArray(0)
 
         if not self._tiled_rendering:
@@ -1845,61 +1954,65 @@ Instances: {len(self._instances)}"""
         from pyglet import gl
 
         self._add_shape_instances = False
-        self._wp_instance_transforms = wp.array(
-            [instance[3] for instance in self._instances.values()], dtype=wp.transform, device=self._device
-        )
+
+        # Host copies of the instance data, modified in place by update_shape_instance()
+        instances = list(self._instances.values())
+        self._instance_transforms_host = np.array([instance[3] for instance in instances], dtype=np.float32)
+        self._instance_colors1_host = np.array([instance[5] for instance in instances], dtype=np.float32)
+        self._instance_colors2_host = np.array([instance[6] for instance in instances], dtype=np.float32)
+
+        self._wp_instance_transforms = wp.array(self._instance_transforms_host, dtype=wp.transform, device=self._device)
         self._wp_instance_scalings = wp.array(
-            [instance[4] for instance in self._instances.values()], dtype=wp.vec3, device=self._device
+            [instance[4] for instance in instances], dtype=wp.vec3, device=self._device
         )
         self._wp_instance_bodies = wp.array(
-            [instance[1] for instance in self._instances.values()], dtype=wp.int32, device=self._device
+            [instance[1] for instance in instances], dtype=wp.int32, device=self._device
         )
+        self._wp_instance_colors1 = wp.array(self._instance_colors1_host, dtype=wp.vec3, device=self._device)
+        self._wp_instance_colors2 = wp.array(self._instance_colors2_host, dtype=wp.vec3, device=self._device)
 
         gl.glUseProgram(self._shape_shader.id)
         if self._instance_transform_gl_buffer is not None:
+            # unregister from CUDA before releasing the GL storage
+            self._instance_transform_cuda_buffer = None
+            self._instance_color1_cuda_buffer = None
+            self._instance_color2_cuda_buffer = None
             gl.glDeleteBuffers(1, self._instance_transform_gl_buffer)
             gl.glDeleteBuffers(1, self._instance_color1_buffer)
             gl.glDeleteBuffers(1, self._instance_color2_buffer)
 
-        # Create instance buffer and bind it as an instanced array
+        matrix_size = 16 * ctypes.sizeof(ctypes.c_float)
+        color_size = 3 * ctypes.sizeof(ctypes.c_float)
+
+        # Create instance buffers with uninitialized storage, their content is written by CUDA kernels
         self._instance_transform_gl_buffer = gl.GLuint()
         gl.glGenBuffers(1, self._instance_transform_gl_buffer)
         gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self._instance_transform_gl_buffer)
+        gl.glBufferData(gl.GL_ARRAY_BUFFER, self._instance_count * matrix_size, None, gl.GL_DYNAMIC_DRAW)
 
-        transforms = np.tile(np.diag(np.ones(4, dtype=np.float32)), (len(self._instances), 1, 1))
-        gl.glBufferData(gl.GL_ARRAY_BUFFER, transforms.nbytes, transforms.ctypes.data, gl.GL_DYNAMIC_DRAW)
-
-        # Create CUDA buffer for instance transforms
-        self._instance_transform_cuda_buffer = wp.RegisteredGLBuffer(
-            int(self._instance_transform_gl_buffer.value), self._device
-        )
-
-        colors1, colors2 = [], []
-        all_instances = list(self._instances.values())
-        for shape, instances in self._shape_instances.items():
-            for i in instances:
-                if i >= len(all_instances):
-                    continue
-                instance = all_instances[i]
-                colors1.append(instance[5])
-                colors2.append(instance[6])
-        colors1 = np.array(colors1, dtype=np.float32)
-        colors2 = np.array(colors2, dtype=np.float32)
-
-        # create buffer for checkerboard colors
+        # create buffers for checkerboard colors
         self._instance_color1_buffer = gl.GLuint()
         gl.glGenBuffers(1, self._instance_color1_buffer)
         gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self._instance_color1_buffer)
-        gl.glBufferData(gl.GL_ARRAY_BUFFER, colors1.nbytes, colors1.ctypes.data, gl.GL_STATIC_DRAW)
+        gl.glBufferData(gl.GL_ARRAY_BUFFER, self._instance_count * color_size, None, gl.GL_DYNAMIC_DRAW)
 
         self._instance_color2_buffer = gl.GLuint()
         gl.glGenBuffers(1, self._instance_color2_buffer)
         gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self._instance_color2_buffer)
-        gl.glBufferData(gl.GL_ARRAY_BUFFER, colors2.nbytes, colors2.ctypes.data, gl.GL_STATIC_DRAW)
+        gl.glBufferData(gl.GL_ARRAY_BUFFER, self._instance_count * color_size, None, gl.GL_DYNAMIC_DRAW)
 
-        # Set up instance attribute pointers
-        matrix_size = transforms[0].nbytes
+        # Create CUDA buffers for instance transforms and colors
+        self._instance_transform_cuda_buffer = wp.RegisteredGLBuffer(
+            int(self._instance_transform_gl_buffer.value), self._device
+        )
+        self._instance_color1_cuda_buffer = wp.RegisteredGLBuffer(
+            int(self._instance_color1_buffer.value), self._device
+        )
+        self._instance_color2_cuda_buffer = wp.RegisteredGLBuffer(
+            int(self._instance_color2_buffer.value), self._device
+        )
 
+        # Set up instance attribute pointers
         instance_ids = []
         inverse_instance_ids = {}
         instance_count = 0
@@ -1917,12 +2030,12 @@ Instances: {len(self._instances)}"""
                 gl.glVertexAttribDivisor(3 + i, 1)
 
             gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self._instance_color1_buffer)
-            gl.glVertexAttribPointer(7, 3, gl.GL_FLOAT, gl.GL_FALSE, colors1[0].nbytes, ctypes.c_void_p(0))
+            gl.glVertexAttribPointer(7, 3, gl.GL_FLOAT, gl.GL_FALSE, color_size, ctypes.c_void_p(0))
             gl.glEnableVertexAttribArray(7)
             gl.glVertexAttribDivisor(7, 1)
 
             gl.glBindBuffer(gl.GL_ARRAY_BUFFER, self._instance_color2_buffer)
-            gl.glVertexAttribPointer(8, 3, gl.GL_FLOAT, gl.GL_FALSE, colors2[0].nbytes, ctypes.c_void_p(0))
+            gl.glVertexAttribPointer(8, 3, gl.GL_FLOAT, gl.GL_FALSE, color_size, ctypes.c_void_p(0))
             gl.glEnableVertexAttribArray(8)
             gl.glVertexAttribDivisor(8, 1)
 
@@ -1931,8 +2044,9 @@ Instances: {len(self._instances)}"""
                 inverse_instance_ids[i] = instance_count
                 instance_count += 1
 
-        # trigger update to the instance transforms
+        # trigger update to the instance transforms and colors
         self._update_shape_instances = True
+        self._update_shape_colors = True
 
         self._wp_instance_ids = wp.array(instance_ids, dtype=wp.int32, device=self._device)
         self._instance_ids = instance_ids
@@ -1947,32 +2061,62 @@ Instances: {len(self._instances)}"""
             name: The name of the shape
             pos: The position of the shape
             rot: The rotation of the shape
+            color1: The new first color of the shape checkerboard, if provided
+            color2: The new second color of the shape checkerboard, if provided
         """
         if name in self._instances:
             i, body, shape, _, scale, old_color1, old_color2 = self._instances[name]
             self._instances[name] = (i, body, shape, [*pos, *rot], scale, color1 or old_color1, color2 or old_color2)
             self._update_shape_instances = True
+
+            # instances added since the last allocation are uploaded with the next one
+            if self._instance_transforms_host is not None and i < len(self._instance_transforms_host):
+                self._instance_transforms_host[i] = (*pos, *rot)
+                if color1 is not None:
+                    self._instance_colors1_host[i] = color1
+                    self._update_shape_colors = True
+                if color2 is not None:
+                    self._instance_colors2_host[i] = color2
+                    self._update_shape_colors = True
             return True
         return False
 
     def update_shape_instances(self):
+        if self._wp_instance_transforms is None:
+            self._update_shape_instances = False
+            return
+
         with self._shape_shader:
             self._update_shape_instances = False
-            self._wp_instance_transforms = wp.array(
-                [instance[3] for instance in self._instances.values()], dtype=wp.transform, device=self._device
-            )
+            self._wp_instance_transforms.assign(self._instance_transforms_host)
             self.update_body_transforms(None)
 
+            if self._update_shape_colors:
+                self._update_shape_colors = False
+                self._wp_instance_colors1.assign(self._instance_colors1_host)
+                self._wp_instance_colors2.assign(self._instance_colors2_host)
+
+                vbo_colors1 = self._instance_color1_cuda_buffer.map(dtype=wp.vec3, shape=(self._instance_count,))
+                vbo_colors2 = self._instance_color2_cuda_buffer.map(dtype=wp.vec3, shape=(self._instance_count,))
+
+                wp.launch(
+                    update_vbo_colors,
+                    dim=self._instance_count,
+                    inputs=[self._wp_instance_ids, self._wp_instance_colors1, self._wp_instance_colors2],
+                    outputs=[vbo_colors1, vbo_colors2],
+                    device=self._device,
+                )
+
+                self._instance_color1_cuda_buffer.unmap()
+                self._instance_color2_cuda_buffer.unmap()
+
     def update_body_transforms(self, body_tf: wp.array):
         if self._instance_transform_cuda_buffer is None:
             return
 
         body_q = None
         if body_tf is not None:
-            if body_tf.device.is_cuda:
-                body_q = body_tf
-            else:
-                body_q = body_tf.to(self._device)
+            body_q = body_tf.to(self._device)
 
         vbo_transforms = self._instance_transform_cuda_buffer.map(dtype=wp.mat44, shape=(self._instance_count,))
 
@@ -2018,8 +2162,48 @@ Instances: {len(self._instances)}"""
             self.clear()
             self.app.event_loop.exit()
 
-    def get_pixels(self, target_image: wp.array, split_up_tiles=True):
-        from pyglet import gl
+    def _read_frame(self, mode: str) -> wp.array:
+        """Copies the frame texture for the given mode to a device staging array, without a host round trip
+
+        The staging array stores the frame rows bottom to top, as RGBA bytes for the ``"rgb"`` mode
+        and window-space depth values for the ``"depth"`` mode.
+        """
+
+        readback = self._frame_readback.get(mode)
+        if readback is None:
+            if mode == "rgb":
+                gl_texture = self._frame_texture
+                shape = (self.screen_height, self.screen_width, 4)
+                dtype = wp.uint8
+            else:
+                gl_texture = self._frame_depth_texture
+                shape = (self.screen_height, self.screen_width)
+                dtype = wp.float32
+
+            # registered once and reused across frames until the framebuffer is resized
+            texture = wp.RegisteredGLTexture(int(gl_texture.value), self._device, wp.RegisteredGLTexture.READ_ONLY)
+            staging = wp.empty(shape, dtype=dtype, device=self._device)
+            readback = (texture, staging)
+            self._frame_readback[mode] = readback
+
+        texture, staging = readback
+        texture.copy_to(staging)
+        return staging
+
+    def get_pixels(self, target_image: wp.array, split_up_tiles=True, mode="rgb"):
+        """Reads the rendered frame into a Warp array, entirely on the device
+
+        Args:
+            target_image: Float array of shape ``(num_tiles, tile_height, tile_width, channels)`` if `split_up_tiles`
+              is True, or ``(screen_height, screen_width, channels)`` otherwise
+            split_up_tiles: Whether to split the frame into one image per tile
+            mode: ``"rgb"`` for color images in [0, 1] with 3 channels, or ``"depth"`` for the 1-channel distance
+              along the camera view axis of each pixel, equal to the far plane distance for the background
+        """
+
+        if mode not in ("rgb", "depth"):
+            raise ValueError(f"Unknown pixel readback mode '{mode}', must be 'rgb' or 'depth'")
+        channels = 3 if mode == "rgb" else 1
 
         if split_up_tiles:
             assert (
@@ -2035,92 +2219,77 @@ Instances: {len(self._instances)}"""
                 self.num_tiles,
                 self._tile_height,
                 self._tile_width,
-                3,
-            ), f"Shape of `target_image` array does not match {self.num_tiles} x {self.screen_height} x {self.screen_width} x 3"
+                channels,
+            ), f"Shape of `target_image` array does not match {self.num_tiles} x {self._tile_height} x {self._tile_width} x {channels}"
         else:
             assert target_image.shape == (
                 self.screen_height,
                 self.screen_width,
-                3,
-            ), f"Shape of `target_image` array does not match {self.screen_height} x {self.screen_width} x 3"
+                channels,
+            ), f"Shape of `target_image` array does not match {self.screen_height} x {self.screen_width} x {channels}"
 
-        gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, self._frame_pbo)
-        gl.glBindTexture(gl.GL_TEXTURE_2D, self._frame_texture)
-        try:
-            # read screen texture into PBO
-            gl.glGetTexImage(gl.GL_TEXTURE_2D, 0, gl.GL_RGB, gl.GL_UNSIGNED_BYTE, ctypes.c_void_p(0))
-        except gl.GLException:
-            # this can happen if the window is closed/being moved to a different display
-            gl.glBindTexture(gl.GL_TEXTURE_2D, 0)
-            gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, 0)
-            return False
-        gl.glBindTexture(gl.GL_TEXTURE_2D, 0)
-        gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, 0)
-
-        pbo_buffer = wp.RegisteredGLBuffer(
-            int(self._frame_pbo.value), self._device, wp.RegisteredGLBuffer.WRITE_DISCARD
-        )
-        screen_size = self.screen_height * self.screen_width
-        img = pbo_buffer.map(dtype=wp.uint8, shape=(screen_size * 3))
-        img = img.to(target_image.device)
+        img = self._read_frame(mode).to(target_image.device)
         if split_up_tiles:
             positions = wp.array(self._tile_viewports, ndim=2, dtype=wp.int32, device=target_image.device)
+            self._copy_tiles(img, positions, self._tile_width, self._tile_height, mode, target_image)
+        elif mode == "rgb":
             wp.launch(
-                copy_frame_tiles,
-                dim=(self.num_tiles, self._tile_width, self._tile_height),
-                inputs=[img, positions, self.screen_width, self.screen_height, self._tile_height],
+                copy_frame,
+                dim=(self.screen_width, self.screen_height),
+                inputs=[img],
                 outputs=[target_image],
                 device=target_image.device,
             )
         else:
             wp.launch(
-                copy_frame,
+                copy_depth_frame,
                 dim=(self.screen_width, self.screen_height),
-                inputs=[img, self.screen_width, self.screen_height],
+                inputs=[img, self.camera_near_plane, self.camera_far_plane],
                 outputs=[target_image],
                 device=target_image.device,
             )
-        pbo_buffer.unmap()
         return True
 
-    def get_tile_pixels(self, tile_id: int, target_image: wp.array):
-        from pyglet import gl
+    def get_tile_pixels(self, tile_id: int, target_image: wp.array, mode="rgb"):
+        """Reads the rendered image of a single tile into a Warp array of shape ``(height, width, channels)``,
+        see :meth:`get_pixels`"""
+
+        if mode not in ("rgb", "depth"):
+            raise ValueError(f"Unknown pixel readback mode '{mode}', must be 'rgb' or 'depth'")
+        channels = 3 if mode == "rgb" else 1
 
         viewport = self._tile_viewports[tile_id]
         assert target_image.shape == (
             viewport[3],
             viewport[2],
-            3,
-        ), f"Shape of `target_image` array does not match {viewport[3]} x {viewport[2]} x 3"
-        gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, self._frame_pbo)
-        gl.glBindTexture(gl.GL_TEXTURE_2D, self._frame_texture)
-        try:
-            # read screen texture into PBO
-            gl.glGetTexImage(gl.GL_TEXTURE_2D, 0, gl.GL_RGB, gl.GL_UNSIGNED_BYTE, ctypes.c_void_p(0))
-        except gl.GLException:
-            # this can happen if the window is closed/being moved to a different display
-            gl.glBindTexture(gl.GL_TEXTURE_2D, 0)
-            gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, 0)
-            return False
-        gl.glBindTexture(gl.GL_TEXTURE_2D, 0)
-        gl.glBindBuffer(gl.GL_PIXEL_PACK_BUFFER, 0)
+            channels,
+        ), f"Shape of `target_image` array does not match {viewport[3]} x {viewport[2]} x {channels}"
 
-        pbo_buffer = wp.RegisteredGLBuffer(
-            int(self._frame_pbo.value), self._device, wp.RegisteredGLBuffer.WRITE_DISCARD
+        img = self._read_frame(mode).to(target_image.device)
+        positions = wp.array([viewport], ndim=2, dtype=wp.int32, device=target_image.device)
+        self._copy_tiles(
+            img, positions, viewport[2], viewport[3], mode, target_image.reshape((1, *target_image.shape))
         )
-        screen_size = self.screen_height * self.screen_width
-        img = pbo_buffer.map(dtype=wp.uint8, shape=(screen_size * 3))
-        img = img.to(target_image.device)
-        wp.launch(
-            copy_frame_tiles,
-            dim=(self.num_tiles, self._tile_width, self._tile_height),
-            inputs=[img, viewport[0], viewport[1], self.screen_width, self.screen_height, self._tile_height],
-            outputs=[target_image],
-            device=target_image.device,
-        )
-        pbo_buffer.unmap()
         return True
 
+    def _copy_tiles(self, img, positions, tile_width, tile_height, mode, target_image):
+        if mode == "rgb":
+            wp.launch(
+                copy_frame_tiles,
+                dim=(positions.shape[0], tile_width, tile_height),
+                inputs=[img, positions, tile_height],
+                outputs=[target_image],
+                device=target_image.device,
+            )
+        else:
+            wp.launch(
+                copy_depth_frame_tiles,
+                dim=(positions.shape[0], tile_width, tile_height),
+                inputs=[img, positions, tile_height, self.camera_near_plane, self.camera_far_plane],
+                outputs=[target_image],
+                device=target_image.device,
+            )
+
     # def create_image_texture(self, file_path):
     #     from PIL import Image
     #     img = Image.open(file_path)
@@ -2410,17 +2579,18 @@ Instances: {len(self._instances)}"""
             name: A name for the USD prim on the stage
             smooth_shading: Whether to average face normals at each vertex or introduce additional vertices for each face
         """
+        if name in self._instances:
+            # update the existing vertex buffer in place, without going through host memory for device points
+            self.update_shape_instance(name, pos, rot)
+            shape = self._instances[name][2]
+            self.update_shape_vertices(shape, points, scale)
+            return
         if colors is None:
             colors = np.ones((len(points), 3), dtype=np.float32)
         else:
             colors = np.array(colors, dtype=np.float32)
         points = np.array(points, dtype=np.float32) * np.array(scale, dtype=np.float32)
         indices = np.array(indices, dtype=np.int32).reshape((-1, 3))
-        if name in self._instances:
-            self.update_shape_instance(name, pos, rot)
-            shape = self._instances[name][2]
-            self.update_shape_vertices(shape, points)
-            return
         geo_hash = hash((points.tobytes(), indices.tobytes(), colors.tobytes()))
         if geo_hash in self._shape_geo_hash:
             shape = self._shape_geo_hash[geo_hash]
@@ -2528,12 +2698,11 @@ Instances: {len(self._instances)}"""
             return
 
         if isinstance(points, wp.array):
-            wp_points = points
+            wp_points = points.to(self._device)
         else:
             wp_points = wp.array(points, dtype=wp.vec3, device=self._device)
 
         if name not in self._shape_instancers:
-            np_points = points.numpy() if isinstance(points, wp.array) else points
             instancer = ShapeInstancer(self._shape_shader, self._device)
             radius_is_scalar = np.isscalar(radius)
             if radius_is_scalar:
@@ -2546,13 +2715,12 @@ Instances: {len(self._instances)}"""
                 color = colors[0]
             instancer.register_shape(vertices, indices, color, color)
             scalings = None if radius_is_scalar else np.tile(radius, (3, 1)).T
-            instancer.allocate_instances(np_points, colors1=colors, colors2=colors, scalings=scalings)
+            instancer.allocate_instances(wp_points, colors1=colors, colors2=colors, scalings=scalings)
             self._shape_instancers[name] = instancer
         else:
             instancer = self._shape_instancers[name]
             if len(points) != instancer.num_instances:
-                np_points = points.numpy() if isinstance(points, wp.array) else points
-                instancer.allocate_instances(np_points)
+                instancer.allocate_instances(wp_points)
 
         with instancer:
             wp.launch(
@@ -2563,29 +2731,34 @@ Instances: {len(self._instances)}"""
                 device=self._device,
             )
 
-    def _render_lines(self, name: str, lines, color: tuple, radius: float = 0.01):
-        if len(lines) == 0:
-            return
-
+    def _get_line_instancer(self, name: str, line_count: int, color: tuple, radius: float):
         if name not in self._shape_instancers:
             instancer = ShapeInstancer(self._shape_shader, self._device)
             vertices, indices = self._create_capsule_mesh(radius, 0.5)
             if color is None or isinstance(color, list):
                 color = tab10_color_map(len(self._shape_geo_hash))
             instancer.register_shape(vertices, indices, color, color)
-            instancer.allocate_instances(np.zeros((len(lines), 3)))
+            instancer.allocate_instances(np.zeros((line_count, 3)))
             self._shape_instancers[name] = instancer
         else:
             instancer = self._shape_instancers[name]
-            if len(lines) != instancer.num_instances:
-                instancer.allocate_instances(np.zeros((len(lines), 3)))
+            if line_count != instancer.num_instances:
+                instancer.allocate_instances(np.zeros((line_count, 3)))
 
-        lines_wp = wp.array(lines, dtype=wp.vec3, ndim=2, device=self._device)
+        return instancer
+
+    def _render_lines(self, name: str, lines, color: tuple, radius: float = 0.01):
+        if len(lines) == 0:
+            return
+
+        instancer = self._get_line_instancer(name, len(lines), color, radius)
+
+        lines_wp = lines if isinstance(lines, wp.array) else wp.array(lines, dtype=wp.vec3, ndim=2, device=self._device)
         with instancer:
             wp.launch(
                 update_line_transforms,
                 dim=len(lines),
-                inputs=[lines_wp],
+                inputs=[lines_wp.to(self._device)],
                 outputs=[instancer.vbo_transforms],
                 device=self._device,
             )
@@ -2599,11 +2772,22 @@ Instances: {len(self._instances)}"""
             color: The color of the line
             radius: The radius of the line
         """
-        lines = []
-        for i in range(len(indices) // 2):
-            lines.append((vertices[indices[2 * i]], vertices[indices[2 * i + 1]]))
-        lines = np.array(lines)
-        self._render_lines(name, lines, color, radius)
+        line_count = len(indices) // 2
+        if line_count == 0:
+            return
+
+        instancer = self._get_line_instancer(name, line_count, color, radius)
+
+        vertices_wp = vertices if isinstance(vertices, wp.array) else wp.array(vertices, dtype=wp.vec3, device=self._device)
+        indices_wp = indices if isinstance(indices, wp.array) else wp.array(indices, dtype=int, device=self._device)
+        with instancer:
+            wp.launch(
+                update_line_list_transforms,
+                dim=line_count,
+                inputs=[vertices_wp.to(self._device), indices_wp.to(self._device)],
+                outputs=[instancer.vbo_transforms],
+                device=self._device,
+            )
 
     def render_line_strip(self, name: str, vertices, color: tuple, radius: float = 0.01):
         """Add a line strip as a set of capsules
@@ -2613,13 +2797,23 @@ Instances: {len(self._instances)}"""
             color: The color of the line
             radius: The radius of the line
         """
-        lines = []
-        for i in range(len(vertices) - 1):
-            lines.append((vertices[i], vertices[i + 1]))
-        lines = np.array(lines)
-        self._render_lines(name, lines, color, radius)
+        line_count = len(vertices) - 1
+        if line_count <= 0:
+            return
+
+        instancer = self._get_line_instancer(name, line_count, color, radius)
+
+        vertices_wp = vertices if isinstance(vertices, wp.array) else wp.array(vertices, dtype=wp.vec3, device=self._device)
+        with instancer:
+            wp.launch(
+                update_line_strip_transforms,
+                dim=line_count,
+                inputs=[vertices_wp.to(self._device)],
+                outputs=[instancer.vbo_transforms],
+                device=self._device,
+            )
 
-    def update_shape_vertices(self, shape, points):
+    def update_shape_vertices(self, shape, points, scale=(1.0, 1.0, 1.0)):
         if isinstance(points, wp.array):
             wp_points = points.to(self._device)
         else:
@@ -2632,7 +2826,7 @@ Instances: {len(self._instances)}"""
         wp.launch(
             update_vbo_vertices,
             dim=vertices_shape[0],
-            inputs=[wp_points],
+            inputs=[wp_points, wp.vec3(*scale)],
             outputs=[vbo_vertices],
             device=self._device,
         )
@@ -0,0 +1,432 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import math
+from typing import List, Union
+
+import numpy as np
+
+import warp as wp
+from warp.render.render_opengl import OpenGLRenderer
+from warp.render.utils import tab10_color_map
+
+
+@wp.kernel
+def update_shape_instance_transforms(
+    instance_shape: wp.array(dtype=int),
+    shape_body: wp.array(dtype=int),
+    shape_transform: wp.array(dtype=wp.transform),
+    body_q: wp.array(dtype=wp.transform),
+    # outputs
+    instance_transforms: wp.array(dtype=wp.transform),
+):
+    tid = wp.tid()
+    shape = instance_shape[tid]
+    X_ws = shape_transform[shape]
+    body = shape_body[shape]
+    if body >= 0 and body_q:
+        X_ws = body_q[body] * X_ws
+    instance_transforms[tid] = X_ws
+
+
+@wp.func
+def camera_world_transform(
+    camera: int,
+    camera_transforms: wp.array(dtype=wp.transform),
+    camera_body: wp.array(dtype=int),
+    body_q: wp.array(dtype=wp.transform),
+):
+    X_wc = camera_transforms[camera]
+    if camera_body:
+        body = camera_body[camera]
+        if body >= 0 and body_q:
+            X_wc = body_q[body] * X_wc
+    return X_wc
+
+
+@wp.kernel
+def raytrace_cameras(
+    tlas: wp.uint64,
+    instance_shape: wp.array(dtype=int),
+    plane_shapes: wp.array(dtype=int),
+    shape_body: wp.array(dtype=int),
+    shape_transform: wp.array(dtype=wp.transform),
+    shape_colors: wp.array(dtype=wp.vec3),
+    body_q: wp.array(dtype=wp.transform),
+    camera_transforms: wp.array(dtype=wp.transform),
+    camera_body: wp.array(dtype=int),
+    camera_pixel_offsets: wp.array(dtype=int),
+    camera_widths: wp.array(dtype=int),
+    camera_heights: wp.array(dtype=int),
+    camera_tan_half_fov: wp.array(dtype=float),
+    near_plane: float,
+    far_plane: float,
+    light_direction: wp.vec3,
+    ambient: float,
+    background_color: wp.vec3,
+    shadows: int,
+    # outputs
+    depth: wp.array(dtype=float),
+    segmentation: wp.array(dtype=int),
+    color: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    # pixels of all cameras are laid out contiguously, camera by camera
+    camera = wp.lower_bound(camera_pixel_offsets, tid + 1) - 1
+    pixel = tid - camera_pixel_offsets[camera]
+    width = camera_widths[camera]
+    height = camera_heights[camera]
+    x = pixel % width
+    y = pixel / width
+
+    # camera looks along -Z with +Y up, rows are stored from the top of the image
+    tan_half_fov = camera_tan_half_fov[camera]
+    aspect = float(width) / float(height)
+    u = (2.0 * (float(x) + 0.5) / float(width) - 1.0) * tan_half_fov * aspect
+    v = (1.0 - 2.0 * (float(y) + 0.5) / float(height)) * tan_half_fov
+    dir_cam = wp.normalize(wp.vec3(u, v, -1.0))
+
+    X_wc = camera_world_transform(camera, camera_transforms, camera_body, body_q)
+    origin = wp.transform_get_translation(X_wc)
+    dir = wp.transform_vector(X_wc, dir_cam)
+
+    # rays start at the near plane and end at the far plane along the view axis
+    max_t = far_plane / (-dir_cam[2])
+    min_t = near_plane / (-dir_cam[2])
+
+    hit_t = max_t
+    hit_shape = int(-1)
+    hit_normal = wp.vec3()
+
+    t = float(0.0)
+    bary_u = float(0.0)
+    bary_v = float(0.0)
+    sign = float(0.0)
+    n = wp.vec3()
+    face = int(0)
+    instance = int(0)
+
+    has_instances = tlas != wp.uint64(0)
+    if has_instances:
+        if wp.tlas_query_ray(tlas, origin, dir, max_t, t, bary_u, bary_v, sign, n, face, instance):
+            if t >= min_t:
+                hit_t = t
+                hit_shape = instance_shape[instance]
+                hit_normal = n
+
+    # infinite planes are intersected analytically, their normal is the local +Y axis
+    for i in range(plane_shapes.shape[0]):
+        shape = plane_shapes[i]
+        X_ws = shape_transform[shape]
+        body = shape_body[shape]
+        if body >= 0 and body_q:
+            X_ws = body_q[body] * X_ws
+        plane_normal = wp.transform_vector(X_ws, wp.vec3(0.0, 1.0, 0.0))
+        denom = wp.dot(plane_normal, dir)
+        if wp.abs(denom) > 1.0e-8:
+            t = wp.dot(plane_normal, wp.transform_get_translation(X_ws) - origin) / denom
+            if t >= min_t and t < hit_t:
+                hit_t = t
+                hit_shape = shape
+                hit_normal = plane_normal
+
+    if hit_shape < 0:
+        if depth:
+            depth[tid] = far_plane
+        if segmentation:
+            segmentation[tid] = -1
+        if color:
+            color[tid] = background_color
+        return
+
+    if depth:
+        # distance along the view axis, consistent with rasterized depth buffers
+        depth[tid] = hit_t * (-dir_cam[2])
+    if segmentation:
+        segmentation[tid] = hit_shape
+    if color:
+        # face the normal towards the camera
+        if wp.dot(hit_normal, dir) > 0.0:
+            hit_normal = -hit_normal
+
+        diffuse = wp.max(wp.dot(hit_normal, light_direction), 0.0)
+        if shadows != 0 and has_instances and diffuse > 0.0:
+            # offset the shadow ray origin to avoid self-intersections
+            p = origin + dir * hit_t + hit_normal * (1.0e-4 * hit_t)
+            if wp.tlas_query_ray(tlas, p, light_direction, far_plane, t, bary_u, bary_v, sign, n, face, instance):
+                diffuse = 0.0
+
+        color[tid] = shape_colors[hit_shape] * (ambient + (1.0 - ambient) * diffuse)
+
+
+class RayTracer:
+    """Headless renderer ray tracing depth, segmentation and shaded color images of the rigid shapes of a
+    :class:`warp.sim.Model` for many cameras at once.
+
+    Every shape except signed distance fields is tessellated into a :class:`warp.Mesh` once, identical geometries
+    sharing the same mesh, and the shapes are placed with a :class:`warp.Tlas` that is refit to the body transforms
+    of the rendered state. Infinite planes, such as the ground, are intersected analytically.
+    The pixels of all cameras, which may have different resolutions, are traced by a single kernel launch.
+
+    Cameras look along their local -Z axis with +Y up. Each camera may be attached to a body, in which case its
+    transform is given relative to that body. All environments of the model share the same scene, so cameras
+    see the shapes of every environment in their field of view.
+
+    Images are stored in flat arrays covering all the cameras, use :meth:`get_image` to obtain the image of a
+    single camera as an array view of shape ``(height, width)``, with rows from the top of the image.
+
+    Attributes:
+        depth (wp.array): Distance along the camera view axis to the closest hit of each pixel,
+          equal to the far plane distance for the background, or None if depth is not rendered
+        segmentation (wp.array): Index of the shape hit by each pixel, -1 for the background,
+          or None if segmentation is not rendered
+        color (wp.array): Shaded color of each pixel, or None if color is not rendered
+    """
+
+    def __init__(
+        self,
+        model,
+        camera_widths: Union[int, List[int]],
+        camera_heights: Union[int, List[int]],
+        camera_count: int = 1,
+        camera_fov: Union[float, List[float]] = 45.0,
+        camera_body: List[int] = None,
+        near_plane: float = 0.01,
+        far_plane: float = 1000.0,
+        light_direction=(0.2, 0.8, 0.3),
+        ambient: float = 0.3,
+        background_color=(0.53, 0.8, 0.92),
+        shadows: bool = False,
+        render_depth: bool = True,
+        render_segmentation: bool = True,
+        render_color: bool = True,
+        shape_colors=None,
+        mesh_segments: int = 32,
+        device=None,
+    ):
+        """
+        Args:
+            model: Simulation model whose shapes are rendered
+            camera_widths: Image width of each camera, or of all cameras
+            camera_heights: Image height of each camera, or of all cameras
+            camera_count: Number of cameras, only used if neither the resolutions nor the field of views are lists
+            camera_fov: Vertical field of view in degrees of each camera, or of all cameras
+            camera_body: Index of the body each camera is attached to, -1 for cameras placed in world space.
+              If None, all cameras are placed in world space
+            near_plane: Distance to the camera below which hits are ignored
+            far_plane: Maximum distance along the view axis of the rendered hits
+            light_direction: Direction towards the directional light used for shading
+            ambient: Fraction of the shape color visible in the absence of direct light
+            background_color: Color of the pixels that do not hit any shape
+            shadows: Whether to trace shadow rays towards the light
+            render_depth: Whether to allocate and render the :attr:`depth` images
+            render_segmentation: Whether to allocate and render the :attr:`segmentation` images
+            render_color: Whether to allocate and render the :attr:`color` images
+            shape_colors: Color of each shape of the model. If None, shapes are colored by index
+            mesh_segments: Number of segments used to tessellate curved primitives
+            device: Device on which to render, defaults to the model device
+        """
+
+        # resolve per-camera parameters
+        per_camera = [p for p in (camera_widths, camera_heights, camera_fov) if isinstance(p, (list, tuple))]
+        if per_camera:
+            camera_count = len(per_camera[0])
+            if any(len(p) != camera_count for p in per_camera):
+                raise ValueError("Per-camera parameters must all have the same length")
+
+        def expand(p):
+            return list(p) if isinstance(p, (list, tuple)) else [p] * camera_count
+
+        widths = expand(camera_widths)
+        heights = expand(camera_heights)
+        fovs = expand(camera_fov)
+
+        if camera_body is not None and len(camera_body) != camera_count:
+            raise ValueError(f"Expected {camera_count} camera body indices, got {len(camera_body)}")
+
+        self.model = model
+        self.device = wp.get_device(device if device is not None else model.device)
+        self.camera_count = camera_count
+        self.camera_widths = widths
+        self.camera_heights = heights
+        self.near_plane = near_plane
+        self.far_plane = far_plane
+        self.light_direction = wp.vec3(*(np.array(light_direction) / np.linalg.norm(light_direction)))
+        self.ambient = ambient
+        self.background_color = wp.vec3(*background_color)
+        self.shadows = shadows
+
+        pixel_counts = [w * h for w, h in zip(widths, heights)]
+        self._pixel_offsets = np.concatenate(([0], np.cumsum(pixel_counts))).astype(np.int32)
+        self.pixel_count = int(self._pixel_offsets[-1])
+
+        self._camera_pixel_offsets = wp.array(self._pixel_offsets, dtype=int, device=self.device)
+        self._camera_widths = wp.array(widths, dtype=int, device=self.device)
+        self._camera_heights = wp.array(heights, dtype=int, device=self.device)
+        self._camera_tan_half_fov = wp.array(
+            [math.tan(math.radians(fov) * 0.5) for fov in fovs], dtype=float, device=self.device
+        )
+        self._camera_body = None if camera_body is None else wp.array(camera_body, dtype=int, device=self.device)
+
+        self.depth = wp.empty(self.pixel_count, dtype=float, device=self.device) if render_depth else None
+        self.segmentation = wp.empty(self.pixel_count, dtype=int, device=self.device) if render_segmentation else None
+        self.color = wp.empty(self.pixel_count, dtype=wp.vec3, device=self.device) if render_color else None
+
+        if shape_colors is None:
+            shape_colors = [tab10_color_map(s) for s in range(model.shape_count)]
+        self.shape_colors = wp.array(shape_colors, dtype=wp.vec3, device=self.device)
+
+        self._create_shape_instances(mesh_segments)
+
+    def _create_shape_instances(self, mesh_segments: int):
+        import warp.sim
+
+        model = self.model
+
+        shape_geo_type = model.shape_geo.type.numpy()
+        shape_geo_scale = model.shape_geo.scale.numpy()
+
+        # one mesh per unique geometry, and one instance per shape
+        geo_meshes = {}
+        instance_meshes = []
+        instance_shape = []
+        plane_shapes = []
+
+        for s in range(model.shape_count):
+            geo_type = int(shape_geo_type[s])
+            geo_scale = [float(v) for v in shape_geo_scale[s]]
+            geo_src = model.shape_geo_src[s]
+
+            if geo_type == warp.sim.GEO_PLANE:
+                if s == model.shape_count - 1 and not model.ground:
+                    continue  # hide ground plane
+                if geo_scale[0] <= 0.0 or geo_scale[1] <= 0.0:
+                    plane_shapes.append(s)
+                    continue
+            elif geo_type == warp.sim.GEO_SDF:
+                continue
+
+            geo_hash = hash((geo_type, geo_src, *geo_scale))
+            mesh = geo_meshes.get(geo_hash)
+            if mesh is None:
+                points, indices = self._tessellate_shape(geo_type, geo_scale, geo_src, mesh_segments)
+                mesh = wp.Mesh(
+                    points=wp.array(points, dtype=wp.vec3, device=self.device),
+                    indices=wp.array(indices, dtype=wp.int32, device=self.device),
+                )
+                geo_meshes[geo_hash] = mesh
+
+            instance_meshes.append(mesh)
+            instance_shape.append(s)
+
+        self._instance_shape = wp.array(instance_shape, dtype=int, device=self.device)
+        self._plane_shapes = wp.array(plane_shapes, dtype=int, device=self.device)
+        self._instance_transforms = wp.empty(len(instance_shape), dtype=wp.transform, device=self.device)
+
+        if instance_meshes:
+            self._update_instance_transforms(model.body_q)
+            self._tlas = wp.Tlas(instance_meshes, self._instance_transforms)
+        else:
+            self._tlas = None
+
+    @staticmethod
+    def _tessellate_shape(geo_type: int, geo_scale, geo_src, segments: int):
+        import warp.sim
+
+        if geo_type == warp.sim.GEO_MESH:
+            return np.array(geo_src.vertices) * np.array(geo_scale), np.array(geo_src.indices)
+
+        if geo_type == warp.sim.GEO_SPHERE:
+            vertices, indices = OpenGLRenderer._create_sphere_mesh(geo_scale[0], segments, segments)
+        elif geo_type == warp.sim.GEO_CAPSULE:
+            vertices, indices = OpenGLRenderer._create_capsule_mesh(geo_scale[0], geo_scale[1], segments=segments)
+        elif geo_type == warp.sim.GEO_CYLINDER:
+            vertices, indices = OpenGLRenderer._create_cylinder_mesh(geo_scale[0], geo_scale[1], segments=segments)
+        elif geo_type == warp.sim.GEO_CONE:
+            vertices, indices = OpenGLRenderer._create_cone_mesh(geo_scale[0], geo_scale[1], segments=segments)
+        elif geo_type == warp.sim.GEO_BOX:
+            vertices, indices = OpenGLRenderer._create_box_mesh(geo_scale)
+        elif geo_type == warp.sim.GEO_PLANE:
+            width, length = geo_scale[0], geo_scale[1]
+            vertices = np.array(
+                [[-width, 0.0, -length], [-width, 0.0, length], [width, 0.0, length], [width, 0.0, -length]]
+            )
+            indices = np.array([0, 1, 2, 2, 3, 0])
+        else:
+            raise ValueError(f"Unsupported shape geometry type {geo_type}")
+
+        # drop the normal and texture coordinates of the rasterization vertices
+        return vertices[:, :3], indices
+
+    def _update_instance_transforms(self, body_q):
+        wp.launch(
+            update_shape_instance_transforms,
+            dim=len(self._instance_transforms),
+            inputs=[self._instance_shape, self.model.shape_body, self.model.shape_transform, body_q],
+            outputs=[self._instance_transforms],
+            device=self.device,
+        )
+
+    def render(self, state, camera_transforms: wp.array):
+        """Ray traces the images of all cameras for the body transforms of a simulation state
+
+        Args:
+            state: Simulation state providing the body transforms, or None to use the model's initial transforms
+            camera_transforms: Array of type :class:`warp.transform` holding the world (or body) from camera
+              transform of each camera
+        """
+
+        if camera_transforms.dtype != wp.transform or len(camera_transforms) != self.camera_count:
+            raise ValueError(f"Expected an array of {self.camera_count} camera transforms of type wp.transform")
+
+        body_q = self.model.body_q if state is None else state.body_q
+
+        tlas_id = 0
+        if self._tlas is not None:
+            self._update_instance_transforms(body_q)
+            self._tlas.refit()
+            tlas_id = self._tlas.id
+
+        wp.launch(
+            raytrace_cameras,
+            dim=self.pixel_count,
+            inputs=[
+                tlas_id,
+                self._instance_shape,
+                self._plane_shapes,
+                self.model.shape_body,
+                self.model.shape_transform,
+                self.shape_colors,
+                body_q,
+                camera_transforms,
+                self._camera_body,
+                self._camera_pixel_offsets,
+                self._camera_widths,
+                self._camera_heights,
+                self._camera_tan_half_fov,
+                self.near_plane,
+                self.far_plane,
+                self.light_direction,
+                self.ambient,
+                self.background_color,
+                int(self.shadows),
+            ],
+            outputs=[self.depth, self.segmentation, self.color],
+            device=self.device,
+        )
+
+    def get_image(self, images: wp.array, camera: int) -> wp.array:
+        """Returns a view of shape ``(height, width)`` of the image of a single camera
+
+        Args:
+            images: One of :attr:`depth`, :attr:`segmentation` or :attr:`color`
+            camera: Index of the camera
+        """
+        begin = int(self._pixel_offsets[camera])
+        end = int(self._pixel_offsets[camera + 1])
+        return images[begin:end].reshape((self.camera_heights[camera], self.camera_widths[camera]))
@@ -8,6 +8,8 @@
 import warp as wp
 import numpy as np
 import math
+import queue
+import threading
 
 
 def _usd_add_xform(prim):
@@ -50,10 +52,71 @@ def _compute_segment_xform(pos0, pos1):
     return (mid, Gf.Quath(rot.GetQuat()), scale)
 
 
+class _UsdAsyncWriter:
+    """Background thread authoring the time samples of arrays read back asynchronously from the device.
+
+    Jobs queued while the previous ones are being written are authored together in a single Sdf change block.
+    The stage lock is held by the renderer between ``begin_frame()`` and ``end_frame()``, so the samples are
+    written while the simulation steps.
+    """
+
+    def __init__(self, stage_lock, num_slots):
+        self._stage_lock = stage_lock
+        self._num_slots = num_slots
+        # one readback ring per device, so the sim only waits for the device once all slots are in flight
+        self._rings = {}
+        self._queue = queue.Queue()
+        self._error = None
+
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+
+    def readback(self, arr: wp.array):
+        ring = None
+        if arr.device.is_cuda:
+            ring = self._rings.get(arr.device)
+            if ring is None:
+                ring = self._rings[arr.device] = wp.ReadbackRing(arr.device, self._num_slots)
+        return arr.numpy_async(ring)
+
+    def submit(self, write_fn, time, future):
+        self._queue.put((write_fn, time, future))
+
+    def flush(self):
+        self._queue.join()
+        if self._error is not None:
+            error, self._error = self._error, None
+            raise error
+
+    def _run(self):
+        from pxr import Sdf
+
+        while True:
+            jobs = [self._queue.get()]
+            while True:
+                try:
+                    jobs.append(self._queue.get_nowait())
+                except queue.Empty:
+                    break
+
+            try:
+                # wait for the readbacks before taking the stage from the renderer
+                values = [future.result() for _, _, future in jobs]
+
+                with self._stage_lock, Sdf.ChangeBlock():
+                    for (write_fn, time, _), value in zip(jobs, values):
+                        write_fn(value, time)
+            except Exception as e:
+                self._error = e
+            finally:
+                for _ in jobs:
+                    self._queue.task_done()
+
+
 class UsdRenderer:
     """A USD renderer"""
 
-    def __init__(self, stage, up_axis="Y", fps=60, scaling=1.0):
+    def __init__(self, stage, up_axis="Y", fps=60, scaling=1.0, async_write=False, readback_slots=16):
         """Construct a UsdRenderer object
 
         Args:
@@ -62,6 +125,11 @@ class UsdRenderer:
             up_axis (str): The upfacing axis of the stage
             fps: The number of frames per second to use in the USD file
             scaling: Scaling factor to use for the entities in the scene
+            async_write: If True, body transforms and points given as Warp arrays are read back asynchronously
+              and authored to the stage by a background thread between frames, so recording only enqueues
+              device-to-host copies. The stage must then only be accessed between ``begin_frame()`` and
+              ``end_frame()``, or after :meth:`flush`
+            readback_slots: Number of readbacks that may be in flight before recording waits for the device
         """
 
         from pxr import Usd, UsdGeom, UsdLux, Sdf, Gf
@@ -123,12 +191,42 @@ class UsdRenderer:
         UsdGeom.Xform(light_1.GetPrim()).AddRotateYOp().Set(value=(-70.0))
         UsdGeom.Xform(light_1.GetPrim()).AddRotateXOp().Set(value=(-45.0))
 
+        self.async_write = async_write
+        self._writer = None
+        self._frame_locked = False
+        # cached xform ops of the bodies whose transforms are updated every frame
+        self._body_xform_ops = None
+        if async_write:
+            self._stage_lock = threading.Lock()
+            self._writer = _UsdAsyncWriter(self._stage_lock, readback_slots)
+
     def begin_frame(self, time):
+        if self._writer is not None and not self._frame_locked:
+            self._stage_lock.acquire()
+            self._frame_locked = True
+
         self.stage.SetEndTimeCode(time * self.fps)
         self.time = time * self.fps
 
     def end_frame(self):
-        pass
+        if self._frame_locked:
+            self._frame_locked = False
+            self._stage_lock.release()
+
+    def flush(self):
+        """Waits until all the asynchronously recorded time samples have been authored to the stage"""
+        if self._writer is not None:
+            self.end_frame()
+            self._writer.flush()
+
+    def _set_time_samples(self, attr, values):
+        # arrays are authored by the writer thread once their readback completes
+        if isinstance(values, wp.array):
+            if self._writer is not None:
+                self._writer.submit(lambda v, time: attr.Set(v, time), self.time, self._writer.readback(values))
+                return
+            values = values.numpy()
+        attr.Set(values, self.time)
 
     def register_body(self, body_name):
         from pxr import UsdGeom
@@ -522,7 +620,7 @@ class UsdRenderer:
             # force topology update on first frame
             update_topology = True
 
-        mesh.GetPointsAttr().Set(points, self.time)
+        self._set_time_samples(mesh.GetPointsAttr(), points)
 
         if update_topology:
             idxs = np.array(indices).reshape(-1, 3)
@@ -669,28 +767,42 @@ class UsdRenderer:
                     instancer.GetWidthsAttr().Set(radius)
 
         if colors is None:
-            instancer.GetPositionsAttr().Set(points, self.time)
+            self._set_time_samples(instancer.GetPositionsAttr(), points)
         else:
-            instancer.GetPointsAttr().Set(points, self.time)
+            self._set_time_samples(instancer.GetPointsAttr(), points)
             instancer.GetDisplayColorAttr().Set(colors, self.time)
 
     def update_body_transforms(self, body_q):
-        from pxr import UsdGeom, Sdf
+        from pxr import Sdf
+
+        if self._writer is not None and isinstance(body_q, wp.array):
+            self._writer.submit(self._write_body_transforms, self.time, self._writer.readback(body_q))
+            return
 
         if isinstance(body_q, wp.array):
             body_q = body_q.numpy()
 
         with Sdf.ChangeBlock():
-            for b in range(self.model.body_count):
-                node_name = self.body_names[b]
-                node = UsdGeom.Xform(self.stage.GetPrimAtPath(self.root.GetPath().AppendChild(node_name)))
+            self._write_body_transforms(body_q, self.time)
 
-                # unpack rigid transform
-                X_sb = wp.transform_expand(body_q[b])
+    def _write_body_transforms(self, body_q, time):
+        from pxr import UsdGeom, Gf
+
+        if self._body_xform_ops is None or len(self._body_xform_ops) != self.model.body_count:
+            self._body_xform_ops = []
+            for b in range(self.model.body_count):
+                node = UsdGeom.Xform(self.stage.GetPrimAtPath(self.root.GetPath().AppendChild(self.body_names[b])))
+                self._body_xform_ops.append(node.GetOrderedXformOps())
 
-                _usd_set_xform(node, X_sb.p, X_sb.q, (1.0, 1.0, 1.0), self.time)
+        body_q = np.asarray(body_q, dtype=np.float64).reshape(-1, 7)
+        unit_scale = Gf.Vec3d(1.0, 1.0, 1.0)
+        for (translate, orient, scale), (px, py, pz, qx, qy, qz, qw) in zip(self._body_xform_ops, body_q.tolist()):
+            translate.Set(Gf.Vec3d(px, py, pz), time)
+            orient.Set(Gf.Quatf(qw, qx, qy, qz), time)
+            scale.Set(unit_scale, time)
 
     def save(self):
+        self.flush()
         try:
             self.stage.Save()
             return True
@@ -38,6 +38,7 @@ from .model import JOINT_D6
 
 from .integrator_euler import SemiImplicitIntegrator
 from .integrator_euler import VariationalImplicitIntegrator
+from .integrator_euler import ImplicitEulerIntegrator
 
 from .integrator_xpbd import XPBDIntegrator
 
@@ -47,9 +48,12 @@ from .integrator_moreau import MoreauIntegrator
 
 from .integrator_toi import TOIIntegrator
 
+from .integrator_mpm import MPMIntegrator
+
 from .collide import collide
 from .articulation import eval_fk, eval_ik
 
+from .mesh_cache import MeshCache
 from .import_mjcf import parse_mjcf
 from .import_urdf import parse_urdf
 from .import_snu import parse_snu
@@ -9,8 +9,11 @@
 Collision handling functions and kernels.
 """
 
+from typing import Any
+
 import warp as wp
-from .model import PARTICLE_FLAG_ACTIVE, ModelShapeGeometry
+from .model import PARTICLE_FLAG_ACTIVE, ModelShapeGeometry, body_speed
+from .utils import store_contact_normal, store_contact_shape
 
 
 @wp.func
@@ -460,25 +463,28 @@ def volume_grad(volume: wp.uint64, p: wp.vec3):
     eps = 0.05  # TODO make this a parameter
     q = wp.volume_world_to_index(volume, p)
 
-    # compute gradient of the SDF using finite differences
-    dx = wp.volume_sample_f(volume, q + wp.vec3(eps, 0.0, 0.0), wp.Volume.LINEAR) - wp.volume_sample_f(
-        volume, q - wp.vec3(eps, 0.0, 0.0), wp.Volume.LINEAR
+    # compute gradient of the SDF using finite differences, the samples
+    # share an accessor since they mostly fall in the same leaf node
+    acc = wp.volume_accessor(volume)
+    dx = wp.volume_sample_f(acc, q + wp.vec3(eps, 0.0, 0.0), wp.Volume.LINEAR) - wp.volume_sample_f(
+        acc, q - wp.vec3(eps, 0.0, 0.0), wp.Volume.LINEAR
     )
-    dy = wp.volume_sample_f(volume, q + wp.vec3(0.0, eps, 0.0), wp.Volume.LINEAR) - wp.volume_sample_f(
-        volume, q - wp.vec3(0.0, eps, 0.0), wp.Volume.LINEAR
+    dy = wp.volume_sample_f(acc, q + wp.vec3(0.0, eps, 0.0), wp.Volume.LINEAR) - wp.volume_sample_f(
+        acc, q - wp.vec3(0.0, eps, 0.0), wp.Volume.LINEAR
     )
-    dz = wp.volume_sample_f(volume, q + wp.vec3(0.0, 0.0, eps), wp.Volume.LINEAR) - wp.volume_sample_f(
-        volume, q - wp.vec3(0.0, 0.0, eps), wp.Volume.LINEAR
+    dz = wp.volume_sample_f(acc, q + wp.vec3(0.0, 0.0, eps), wp.Volume.LINEAR) - wp.volume_sample_f(
+        acc, q - wp.vec3(0.0, 0.0, eps), wp.Volume.LINEAR
     )
 
     return wp.normalize(wp.vec3(dx, dy, dz))
 
 
-@wp.kernel
-def create_soft_contacts(
+@wp.func
+def eval_soft_contact(
+    particle_index: int,
+    shape_index: int,
     particle_x: wp.array(dtype=wp.vec3),
     particle_radius: wp.array(dtype=float),
-    particle_flags: wp.array(dtype=wp.uint32),
     body_X_wb: wp.array(dtype=wp.transform),
     shape_X_bs: wp.array(dtype=wp.transform),
     shape_body: wp.array(dtype=int),
@@ -488,15 +494,11 @@ def create_soft_contacts(
     # outputs
     soft_contact_count: wp.array(dtype=int),
     soft_contact_particle: wp.array(dtype=int),
-    soft_contact_shape: wp.array(dtype=int),
+    soft_contact_shape: wp.array(dtype=Any),
     soft_contact_body_pos: wp.array(dtype=wp.vec3),
     soft_contact_body_vel: wp.array(dtype=wp.vec3),
-    soft_contact_normal: wp.array(dtype=wp.vec3),
+    soft_contact_normal: wp.array(dtype=Any),
 ):
-    particle_index, shape_index = wp.tid()
-    if (particle_flags[particle_index] & PARTICLE_FLAG_ACTIVE) == 0:
-        return
-
     rigid_index = shape_body[shape_index]
 
     px = particle_x[particle_index]
@@ -587,11 +589,230 @@ def create_soft_contacts(
 
             world_normal = wp.transform_vector(X_ws, n)
 
-            soft_contact_shape[index] = shape_index
+            store_contact_shape(soft_contact_shape, index, shape_index)
             soft_contact_body_pos[index] = body_pos
             soft_contact_body_vel[index] = body_vel
             soft_contact_particle[index] = particle_index
-            soft_contact_normal[index] = world_normal
+            store_contact_normal(soft_contact_normal, index, world_normal)
+
+
+@wp.kernel
+def create_soft_contacts(
+    particle_x: wp.array(dtype=wp.vec3),
+    particle_radius: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    body_X_wb: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+    geo: ModelShapeGeometry,
+    margin: float,
+    soft_contact_max: int,
+    # outputs
+    soft_contact_count: wp.array(dtype=int),
+    soft_contact_particle: wp.array(dtype=int),
+    soft_contact_shape: wp.array(dtype=Any),
+    soft_contact_body_pos: wp.array(dtype=wp.vec3),
+    soft_contact_body_vel: wp.array(dtype=wp.vec3),
+    soft_contact_normal: wp.array(dtype=Any),
+):
+    particle_index, shape_index = wp.tid()
+    if (particle_flags[particle_index] & PARTICLE_FLAG_ACTIVE) == 0:
+        return
+
+    eval_soft_contact(
+        particle_index,
+        shape_index,
+        particle_x,
+        particle_radius,
+        body_X_wb,
+        shape_X_bs,
+        shape_body,
+        geo,
+        margin,
+        soft_contact_max,
+        soft_contact_count,
+        soft_contact_particle,
+        soft_contact_shape,
+        soft_contact_body_pos,
+        soft_contact_body_vel,
+        soft_contact_normal,
+    )
+
+
+@wp.kernel
+def compute_soft_contact_shape_bounds(
+    body_q: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+    collision_radius: wp.array(dtype=float),
+    soft_contact_margin: float,
+    # outputs
+    lowers: wp.array(dtype=wp.vec3),
+    uppers: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    rigid = shape_body[tid]
+    if rigid == -1:
+        X_ws = shape_X_bs[tid]
+    else:
+        X_ws = wp.transform_multiply(body_q[rigid], shape_X_bs[tid])
+
+    # particles within the margin of a shape overlap its bounding sphere grown by the margin
+    p = wp.transform_get_translation(X_ws)
+    r = collision_radius[tid] + soft_contact_margin
+    lowers[tid] = p - wp.vec3(r, r, r)
+    uppers[tid] = p + wp.vec3(r, r, r)
+
+
+@wp.kernel
+def find_soft_contact_pairs(
+    bvh: wp.uint64,
+    particle_x: wp.array(dtype=wp.vec3),
+    particle_radius: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    max_pairs: int,
+    # outputs
+    pairs: wp.array(dtype=int, ndim=2),
+    pair_count: wp.array(dtype=int),
+):
+    particle_index = wp.tid()
+    if (particle_flags[particle_index] & PARTICLE_FLAG_ACTIVE) == 0:
+        return
+
+    px = particle_x[particle_index]
+    r = particle_radius[particle_index]
+    extent = wp.vec3(r, r, r)
+
+    shape_index = int(0)
+    query = wp.bvh_query_aabb(bvh, px - extent, px + extent)
+    while wp.bvh_query_next(query, shape_index):
+        index = wp.atomic_add(pair_count, 0, 1)
+        if index < max_pairs:
+            pairs[index, 0] = particle_index
+            pairs[index, 1] = shape_index
+
+
+@wp.kernel
+def create_soft_contacts_from_pairs(
+    pairs: wp.array(dtype=int, ndim=2),
+    pair_count: wp.array(dtype=int),
+    particle_x: wp.array(dtype=wp.vec3),
+    particle_radius: wp.array(dtype=float),
+    body_X_wb: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+    geo: ModelShapeGeometry,
+    margin: float,
+    soft_contact_max: int,
+    # outputs
+    soft_contact_count: wp.array(dtype=int),
+    soft_contact_particle: wp.array(dtype=int),
+    soft_contact_shape: wp.array(dtype=Any),
+    soft_contact_body_pos: wp.array(dtype=wp.vec3),
+    soft_contact_body_vel: wp.array(dtype=wp.vec3),
+    soft_contact_normal: wp.array(dtype=Any),
+):
+    # launched over the pair capacity, the pairs beyond the count found by the broadphase are skipped
+    tid = wp.tid()
+    if tid >= pair_count[0]:
+        return
+
+    eval_soft_contact(
+        pairs[tid, 0],
+        pairs[tid, 1],
+        particle_x,
+        particle_radius,
+        body_X_wb,
+        shape_X_bs,
+        shape_body,
+        geo,
+        margin,
+        soft_contact_max,
+        soft_contact_count,
+        soft_contact_particle,
+        soft_contact_shape,
+        soft_contact_body_pos,
+        soft_contact_body_vel,
+        soft_contact_normal,
+    )
+
+
+@wp.kernel
+def compute_shape_bounds(
+    body_q: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+    collision_radius: wp.array(dtype=float),
+    rigid_contact_margin: float,
+    # outputs
+    lowers: wp.array(dtype=wp.vec3),
+    uppers: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    rigid = shape_body[tid]
+    if rigid == -1:
+        X_ws = shape_X_bs[tid]
+    else:
+        X_ws = wp.transform_multiply(body_q[rigid], shape_X_bs[tid])
+
+    # the bounds of two shapes overlap whenever they pass the bounding sphere test of broadphase_collision_pairs
+    p = wp.transform_get_translation(X_ws)
+    r = 2.0 * collision_radius[tid] + rigid_contact_margin + 0.1
+    lowers[tid] = p - wp.vec3(r, r, r)
+    uppers[tid] = p + wp.vec3(r, r, r)
+
+
+@wp.func
+def shape_pair_filtered(filter_keys: wp.array(dtype=wp.int64), key: wp.int64):
+    # binary search of the sorted filter pair keys
+    lo = int(0)
+    hi = filter_keys.shape[0]
+    while lo < hi:
+        mid = (lo + hi) // 2
+        if filter_keys[mid] < key:
+            lo = mid + 1
+        else:
+            hi = mid
+    if lo < filter_keys.shape[0]:
+        return filter_keys[lo] == key
+    return False
+
+
+@wp.kernel
+def find_shape_contact_pairs_bvh(
+    bvh: wp.uint64,
+    lowers: wp.array(dtype=wp.vec3),
+    uppers: wp.array(dtype=wp.vec3),
+    collision_group: wp.array(dtype=int),
+    filter_keys: wp.array(dtype=wp.int64),
+    shape_count: int,
+    max_pairs: int,
+    # outputs
+    contact_pairs: wp.array(dtype=int, ndim=2),
+    contact_pair_count: wp.array(dtype=int),
+):
+    shape_a = wp.tid()
+    group_a = collision_group[shape_a]
+
+    shape_b = int(0)
+    query = wp.bvh_query_aabb(bvh, lowers[shape_a], uppers[shape_a])
+    while wp.bvh_query_next(query, shape_b):
+        # each pair is reported by its lower shape index only
+        if shape_b <= shape_a:
+            continue
+        # shapes with collision group -1 collide with all other shapes
+        group_b = collision_group[shape_b]
+        if group_a != group_b and group_a != -1 and group_b != -1:
+            continue
+        if shape_pair_filtered(filter_keys, wp.int64(shape_a) * wp.int64(shape_count) + wp.int64(shape_b)):
+            continue
+
+        index = wp.atomic_add(contact_pair_count, 0, 1)
+        if index < max_pairs:
+            contact_pairs[index, 0] = shape_a
+            contact_pairs[index, 1] = shape_b
 
 
 @wp.kernel
@@ -604,6 +825,8 @@ def count_contact_points(
     tid = wp.tid()
     shape_a = contact_pairs[tid, 0]
     shape_b = contact_pairs[tid, 1]
+    if shape_a == -1:
+        return  # unused slot of the dynamic broadphase
 
     if shape_b == -1:
         actual_type_a = geo.type[shape_a]
@@ -675,6 +898,39 @@ def count_contact_points(
     wp.atomic_add(contact_count, 0, num_contacts)
 
 
+@wp.func
+def record_contact_pair(
+    index: int,
+    num_contacts: int,
+    pair: int,
+    contact_pair_size: wp.array(dtype=int),
+    contact_pair_index: wp.array(dtype=int),
+):
+    # the contacts of a pair occupy the consecutive slots starting at index, the first slot records
+    # their number and the pair for the contact reduction
+    if contact_pair_size.shape[0] > 0:
+        contact_pair_size[index] = num_contacts
+        contact_pair_index[index] = pair
+
+
+@wp.func
+def allocate_pair_contacts(
+    tid: int,
+    num_contacts: int,
+    contact_count: wp.array(dtype=int),
+    pair_offsets: wp.array(dtype=int),
+    pair_counts: wp.array(dtype=int),
+):
+    # in deterministic mode a first pass records the number of contacts of each pair and returns -1, the second
+    # pass places them after the contacts of the pairs before it, instead of in the order the threads arrive
+    if pair_counts.shape[0] > 0:
+        pair_counts[tid] = num_contacts
+        return -1
+    if pair_offsets.shape[0] > 0:
+        return contact_count[0] + pair_offsets[tid]
+    return wp.atomic_add(contact_count, 0, num_contacts)
+
+
 @wp.kernel
 def broadphase_collision_pairs(
     contact_pairs: wp.array(dtype=int, ndim=2),
@@ -685,15 +941,26 @@ def broadphase_collision_pairs(
     collision_radius: wp.array(dtype=float),
     rigid_contact_max: int,
     rigid_contact_margin: float,
+    pair_offset: int,
+    pair_skip: wp.array(dtype=int),
+    pair_offsets: wp.array(dtype=int),
     # outputs
     contact_count: wp.array(dtype=int),
     contact_shape0: wp.array(dtype=int),
     contact_shape1: wp.array(dtype=int),
     contact_point_id: wp.array(dtype=int),
+    contact_pair_size: wp.array(dtype=int),
+    contact_pair_index: wp.array(dtype=int),
+    pair_counts: wp.array(dtype=int),
 ):
     tid = wp.tid()
     shape_a = contact_pairs[tid, 0]
     shape_b = contact_pairs[tid, 1]
+    if shape_a == -1:
+        return  # unused slot of the dynamic broadphase
+    if pair_skip.shape[0] > 0:
+        if pair_skip[pair_offset + tid] != 0:
+            return  # contacts were reused from the contact cache
 
     rigid_a = shape_body[shape_a]
     if rigid_a == -1:
@@ -758,10 +1025,13 @@ def broadphase_collision_pairs(
             mesh_b = wp.mesh_get(geo.source[actual_shape_b])
             num_contacts_b = mesh_b.points.shape[0]
             num_contacts = num_contacts_a + num_contacts_b
-            index = wp.atomic_add(contact_count, 0, num_contacts)
+            index = allocate_pair_contacts(tid, num_contacts, contact_count, pair_offsets, pair_counts)
+            if index < 0:
+                return
             if index + num_contacts - 1 >= rigid_contact_max:
                 print("Number of rigid contacts exceeded limit. Increase Model.rigid_contact_max.")
                 return
+            record_contact_pair(index, num_contacts, pair_offset + tid, contact_pair_size, contact_pair_index)
             # allocate contact points from capsule A against mesh B
             for i in range(num_contacts_a):
                 contact_shape0[index + i] = actual_shape_a
@@ -777,10 +1047,13 @@ def broadphase_collision_pairs(
             num_contacts = 2
     elif actual_type_a == wp.sim.GEO_BOX:
         if actual_type_b == wp.sim.GEO_BOX:
-            index = wp.atomic_add(contact_count, 0, 24)
+            index = allocate_pair_contacts(tid, 24, contact_count, pair_offsets, pair_counts)
+            if index < 0:
+                return
             if index + 23 >= rigid_contact_max:
                 print("Number of rigid contacts exceeded limit. Increase Model.rigid_contact_max.")
                 return
+            record_contact_pair(index, 24, pair_offset + tid, contact_pair_size, contact_pair_index)
             # allocate contact points from box A against B
             for i in range(12):  # 12 edges
                 contact_shape0[index + i] = shape_a
@@ -797,10 +1070,13 @@ def broadphase_collision_pairs(
             mesh_b = wp.mesh_get(geo.source[actual_shape_b])
             num_contacts_b = mesh_b.points.shape[0]
             num_contacts = num_contacts_a + num_contacts_b
-            index = wp.atomic_add(contact_count, 0, num_contacts)
+            index = allocate_pair_contacts(tid, num_contacts, contact_count, pair_offsets, pair_counts)
+            if index < 0:
+                return
             if index + num_contacts - 1 >= rigid_contact_max:
                 print("Number of rigid contacts exceeded limit. Increase Model.rigid_contact_max.")
                 return
+            record_contact_pair(index, num_contacts, pair_offset + tid, contact_pair_size, contact_pair_index)
             # allocate contact points from box A against mesh B
             for i in range(num_contacts_a):
                 contact_shape0[index + i] = actual_shape_a
@@ -831,10 +1107,13 @@ def broadphase_collision_pairs(
             return
         num_contacts = num_contacts_a + num_contacts_b
         if num_contacts > 0:
-            index = wp.atomic_add(contact_count, 0, num_contacts)
+            index = allocate_pair_contacts(tid, num_contacts, contact_count, pair_offsets, pair_counts)
+            if index < 0:
+                return
             if index + num_contacts - 1 >= rigid_contact_max:
                 print("Mesh contact: Number of rigid contacts exceeded limit. Increase Model.rigid_contact_max.")
                 return
+            record_contact_pair(index, num_contacts, pair_offset + tid, contact_pair_size, contact_pair_index)
             # allocate contact points from mesh A against B
             for i in range(num_contacts_a):
                 contact_shape0[index + i] = actual_shape_a
@@ -852,7 +1131,9 @@ def broadphase_collision_pairs(
         print("broadphase_collision_pairs: unsupported geometry type")
 
     if num_contacts > 0:
-        index = wp.atomic_add(contact_count, 0, num_contacts)
+        index = allocate_pair_contacts(tid, num_contacts, contact_count, pair_offsets, pair_counts)
+        if index < 0:
+            return
         if index + num_contacts - 1 >= rigid_contact_max:
             print("Number of rigid contacts exceeded limit. Increase Model.rigid_contact_max.")
             return
@@ -895,6 +1176,8 @@ def handle_contact_pairs(
         return
 
     point_id = contact_point_id[tid]
+    if point_id < 0:
+        return  # reused from the contact cache
 
     rigid_a = shape_body[shape_a]
     X_wb_a = wp.transform_identity()
@@ -1323,28 +1606,554 @@ def handle_contact_pairs(
         contact_shape1[tid] = -1
 
 
-def collide(model, state, edge_sdf_iter: int = 10):
-    """
-    Generates contact points for the particles and rigid bodies in the model,
-    to be used in the contact dynamics kernel of the integrator.
+@wp.func
+def contact_pair_transform(
+    pair: int,
+    contact_pairs: wp.array(dtype=int, ndim=2),
+    ground_contact_pairs: wp.array(dtype=int, ndim=2),
+    body_q: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+):
+    # transform of the second shape of a pair relative to its first shape, ground pairs follow the shape pairs
+    if pair < contact_pairs.shape[0]:
+        shape_a = contact_pairs[pair, 0]
+        shape_b = contact_pairs[pair, 1]
+    else:
+        shape_a = ground_contact_pairs[pair - contact_pairs.shape[0], 0]
+        shape_b = ground_contact_pairs[pair - contact_pairs.shape[0], 1]
 
-    Args:
-        model: the model to be simulated
-        state: the state of the model
-        edge_sdf_iter: number of search iterations for finding closest contact points between edges and SDF
-    """
+    X_ws_a = shape_X_bs[shape_a]
+    if shape_body[shape_a] >= 0:
+        X_ws_a = wp.transform_multiply(body_q[shape_body[shape_a]], X_ws_a)
+    X_ws_b = shape_X_bs[shape_b]
+    if shape_body[shape_b] >= 0:
+        X_ws_b = wp.transform_multiply(body_q[shape_body[shape_b]], X_ws_b)
 
-    # generate soft contacts for particles and shapes except ground plane (last shape)
-    if model.particle_count and model.shape_count > 1:
-        # clear old count
-        model.soft_contact_count.zero_()
+    return wp.transform_multiply(wp.transform_inverse(X_ws_a), X_ws_b)
+
+
+@wp.func
+def contact_position(
+    tid: int,
+    body_q: wp.array(dtype=wp.transform),
+    contact_body0: wp.array(dtype=int),
+    contact_point0: wp.array(dtype=wp.vec3),
+):
+    body = contact_body0[tid]
+    if body >= 0:
+        return wp.transform_point(body_q[body], contact_point0[tid])
+    return contact_point0[tid]
+
+
+@wp.kernel
+def reduce_contact_manifolds(
+    body_q: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+    contact_pairs: wp.array(dtype=int, ndim=2),
+    ground_contact_pairs: wp.array(dtype=int, ndim=2),
+    rigid_contact_count: wp.array(dtype=int),
+    contact_pair_size: wp.array(dtype=int),
+    contact_pair_index: wp.array(dtype=int),
+    contact_body0: wp.array(dtype=int),
+    contact_body1: wp.array(dtype=int),
+    contact_point0: wp.array(dtype=wp.vec3),
+    contact_point1: wp.array(dtype=wp.vec3),
+    contact_offset0: wp.array(dtype=wp.vec3),
+    contact_offset1: wp.array(dtype=wp.vec3),
+    contact_normal: wp.array(dtype=wp.vec3),
+    contact_thickness: wp.array(dtype=float),
+    # outputs
+    contact_shape0: wp.array(dtype=int),
+    contact_shape1: wp.array(dtype=int),
+    cache_count: wp.array(dtype=int),
+    cache_xform: wp.array(dtype=wp.transform),
+    cache_shape0: wp.array(dtype=int, ndim=2),
+    cache_shape1: wp.array(dtype=int, ndim=2),
+    cache_body0: wp.array(dtype=int, ndim=2),
+    cache_body1: wp.array(dtype=int, ndim=2),
+    cache_point0: wp.array(dtype=wp.vec3, ndim=2),
+    cache_point1: wp.array(dtype=wp.vec3, ndim=2),
+    cache_offset0: wp.array(dtype=wp.vec3, ndim=2),
+    cache_offset1: wp.array(dtype=wp.vec3, ndim=2),
+    cache_normal: wp.array(dtype=wp.vec3, ndim=2),
+    cache_thickness: wp.array(dtype=float, ndim=2),
+):
+    # keeps at most 4 contacts of the contacts generated for a shape pair: the deepest one, the one farthest
+    # from it, then the ones spanning the largest triangle and quadrilateral with the contacts kept so far
+    start = wp.tid()
+    if start >= rigid_contact_count[0]:
+        return
+    size = contact_pair_size[start]
+    if size == 0:
+        return
+    end = wp.min(start + size, contact_shape0.shape[0])
+
+    i0 = int(-1)
+    d0 = float(1.0e10)
+    for i in range(start, end):
+        if contact_shape0[i] != contact_shape1[i]:
+            p_a = contact_position(i, body_q, contact_body0, contact_point0)
+            p_b = contact_position(i, body_q, contact_body1, contact_point1)
+            d = wp.dot(contact_normal[i], p_a - p_b) - contact_thickness[i]
+            if d < d0:
+                d0 = d
+                i0 = i
+
+    i1 = int(-1)
+    i2 = int(-1)
+    i3 = int(-1)
+    if i0 >= 0:
+        x0 = contact_position(i0, body_q, contact_body0, contact_point0)
+        best = float(-1.0)
+        for i in range(start, end):
+            if contact_shape0[i] != contact_shape1[i] and i != i0:
+                s = wp.length_sq(contact_position(i, body_q, contact_body0, contact_point0) - x0)
+                if s > best:
+                    best = s
+                    i1 = i
+    if i1 >= 0:
+        x0 = contact_position(i0, body_q, contact_body0, contact_point0)
+        x1 = contact_position(i1, body_q, contact_body0, contact_point0)
+        best = float(-1.0)
+        for i in range(start, end):
+            if contact_shape0[i] != contact_shape1[i] and i != i0 and i != i1:
+                x = contact_position(i, body_q, contact_body0, contact_point0)
+                s = wp.length_sq(wp.cross(x1 - x0, x - x0))
+                if s > best:
+                    best = s
+                    i2 = i
+    if i2 >= 0:
+        x0 = contact_position(i0, body_q, contact_body0, contact_point0)
+        x1 = contact_position(i1, body_q, contact_body0, contact_point0)
+        x2 = contact_position(i2, body_q, contact_body0, contact_point0)
+        best = float(-1.0)
+        for i in range(start, end):
+            if contact_shape0[i] != contact_shape1[i] and i != i0 and i != i1 and i != i2:
+                x = contact_position(i, body_q, contact_body0, contact_point0)
+                # the area added to the triangle grows with the distance of x outside of it
+                s = (
+                    wp.length(wp.cross(x0 - x, x1 - x))
+                    + wp.length(wp.cross(x1 - x, x2 - x))
+                    + wp.length(wp.cross(x2 - x, x0 - x))
+                )
+                if s > best:
+                    best = s
+                    i3 = i
+
+    count = int(0)
+    pair = contact_pair_index[start]
+    for i in range(start, end):
+        if i == i0 or i == i1 or i == i2 or i == i3:
+            if cache_count.shape[0] > 0:
+                # normals are cached in the frame of the second body to follow its rotation
+                n = contact_normal[i]
+                if contact_body1[i] >= 0:
+                    n = wp.transform_vector(wp.transform_inverse(body_q[contact_body1[i]]), n)
+                cache_shape0[pair, count] = contact_shape0[i]
+                cache_shape1[pair, count] = contact_shape1[i]
+                cache_body0[pair, count] = contact_body0[i]
+                cache_body1[pair, count] = contact_body1[i]
+                cache_point0[pair, count] = contact_point0[i]
+                cache_point1[pair, count] = contact_point1[i]
+                cache_offset0[pair, count] = contact_offset0[i]
+                cache_offset1[pair, count] = contact_offset1[i]
+                cache_normal[pair, count] = n
+                cache_thickness[pair, count] = contact_thickness[i]
+            count += 1
+        else:
+            contact_shape0[i] = -1
+            contact_shape1[i] = -1
+
+    if cache_count.shape[0] > 0:
+        cache_count[pair] = count
+        cache_xform[pair] = contact_pair_transform(
+            pair, contact_pairs, ground_contact_pairs, body_q, shape_X_bs, shape_body
+        )
+
+
+@wp.kernel
+def reuse_cached_contacts(
+    body_q: wp.array(dtype=wp.transform),
+    shape_X_bs: wp.array(dtype=wp.transform),
+    shape_body: wp.array(dtype=int),
+    collision_radius: wp.array(dtype=float),
+    contact_pairs: wp.array(dtype=int, ndim=2),
+    ground_contact_pairs: wp.array(dtype=int, ndim=2),
+    cache_count: wp.array(dtype=int),
+    cache_xform: wp.array(dtype=wp.transform),
+    cache_shape0: wp.array(dtype=int, ndim=2),
+    cache_shape1: wp.array(dtype=int, ndim=2),
+    cache_body0: wp.array(dtype=int, ndim=2),
+    cache_body1: wp.array(dtype=int, ndim=2),
+    cache_point0: wp.array(dtype=wp.vec3, ndim=2),
+    cache_point1: wp.array(dtype=wp.vec3, ndim=2),
+    cache_offset0: wp.array(dtype=wp.vec3, ndim=2),
+    cache_offset1: wp.array(dtype=wp.vec3, ndim=2),
+    cache_normal: wp.array(dtype=wp.vec3, ndim=2),
+    cache_thickness: wp.array(dtype=float, ndim=2),
+    tolerance: float,
+    rigid_contact_max: int,
+    # outputs
+    pair_skip: wp.array(dtype=int),
+    contact_count: wp.array(dtype=int),
+    contact_shape0: wp.array(dtype=int),
+    contact_shape1: wp.array(dtype=int),
+    contact_point_id: wp.array(dtype=int),
+    contact_body0: wp.array(dtype=int),
+    contact_body1: wp.array(dtype=int),
+    contact_point0: wp.array(dtype=wp.vec3),
+    contact_point1: wp.array(dtype=wp.vec3),
+    contact_offset0: wp.array(dtype=wp.vec3),
+    contact_offset1: wp.array(dtype=wp.vec3),
+    contact_normal: wp.array(dtype=wp.vec3),
+    contact_thickness: wp.array(dtype=float),
+):
+    # reuses the contacts of the last narrow phase of a pair if the relative transform of its shapes has
+    # moved the points of the shapes by less than the tolerance since then
+    pair = wp.tid()
+    pair_skip[pair] = 0
+    count = cache_count[pair]
+    if count == 0:
+        return
+
+    X = contact_pair_transform(pair, contact_pairs, ground_contact_pairs, body_q, shape_X_bs, shape_body)
+    X_c = cache_xform[pair]
+
+    shape_a = cache_shape0[pair, 0]
+    shape_b = cache_shape1[pair, 0]
+    radius = wp.max(collision_radius[shape_a], collision_radius[shape_b])
+
+    dq = wp.transform_get_rotation(X) * wp.quat_inverse(wp.transform_get_rotation(X_c))
+    angle = 2.0 * wp.acos(wp.min(wp.abs(dq[3]), 1.0))
+    motion = wp.length(wp.transform_get_translation(X) - wp.transform_get_translation(X_c)) + angle * radius
+    if motion > tolerance:
+        return
+
+    index = wp.atomic_add(contact_count, 0, count)
+    if index + count > rigid_contact_max:
+        return
+
+    pair_skip[pair] = 1
+    for k in range(count):
+        i = index + k
+        n = cache_normal[pair, k]
+        if cache_body1[pair, k] >= 0:
+            n = wp.transform_vector(body_q[cache_body1[pair, k]], n)
+        contact_shape0[i] = cache_shape0[pair, k]
+        contact_shape1[i] = cache_shape1[pair, k]
+        contact_point_id[i] = -1
+        contact_body0[i] = cache_body0[pair, k]
+        contact_body1[i] = cache_body1[pair, k]
+        contact_point0[i] = cache_point0[pair, k]
+        contact_point1[i] = cache_point1[pair, k]
+        contact_offset0[i] = cache_offset0[pair, k]
+        contact_offset1[i] = cache_offset1[pair, k]
+        contact_normal[i] = n
+        contact_thickness[i] = cache_thickness[pair, k]
+
+
+@wp.kernel
+def wake_rigid_contact_islands(
+    contact_count: wp.array(dtype=int),
+    contact_shape0: wp.array(dtype=int),
+    contact_body0: wp.array(dtype=int),
+    contact_body1: wp.array(dtype=int),
+    body_qd: wp.array(dtype=wp.spatial_vector),
+    body_island: wp.array(dtype=int),
+    sleep_velocity: float,
+    contact_max: int,
+    # outputs
+    island_wake: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    if tid >= wp.min(contact_count[0], contact_max) or contact_shape0[tid] < 0:
+        return
+
+    body0 = contact_body0[tid]
+    body1 = contact_body1[tid]
+    if body0 < 0 or body1 < 0:
+        return
+
+    # a moving body wakes up the island it touches
+    if body_speed(body_qd[body0]) > sleep_velocity:
+        island_wake[body_island[body1]] = 1
+    if body_speed(body_qd[body1]) > sleep_velocity:
+        island_wake[body_island[body0]] = 1
+
+
+@wp.kernel
+def wake_soft_contact_islands(
+    contact_count: wp.array(dtype=int),
+    contact_particle: wp.array(dtype=int),
+    contact_shape: wp.array(dtype=int),
+    particle_qd: wp.array(dtype=wp.vec3),
+    shape_body: wp.array(dtype=int),
+    body_island: wp.array(dtype=int),
+    sleep_velocity: float,
+    contact_max: int,
+    # outputs
+    island_wake: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    if tid >= wp.min(contact_count[0], contact_max):
+        return
+
+    body = shape_body[contact_shape[tid]]
+    if body >= 0 and wp.length(particle_qd[contact_particle[tid]]) > sleep_velocity:
+        island_wake[body_island[body]] = 1
+
+
+@wp.kernel
+def advance_contact_count(
+    pair_offsets: wp.array(dtype=int),
+    pair_counts: wp.array(dtype=int),
+    pair_count: int,
+    contact_count: wp.array(dtype=int),
+):
+    contact_count[0] = contact_count[0] + pair_offsets[pair_count - 1] + pair_counts[pair_count - 1]
+
+
+@wp.kernel
+def shape_contact_pair_keys(
+    pairs: wp.array(dtype=int, ndim=2),
+    shape_count: int,
+    keys: wp.array(dtype=wp.int64),
+    order: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    a = pairs[tid, 0]
+    # unused slots of the dynamic broadphase hold -1 and go last
+    key = wp.int64(shape_count) * wp.int64(shape_count)
+    if a >= 0:
+        key = wp.int64(a) * wp.int64(shape_count) + wp.int64(pairs[tid, 1])
+    keys[tid] = key
+    order[tid] = tid
+
+
+@wp.kernel
+def gather_shape_contact_pairs(
+    order: wp.array(dtype=int),
+    pairs: wp.array(dtype=int, ndim=2),
+    sorted_pairs: wp.array(dtype=int, ndim=2),
+):
+    tid = wp.tid()
+    i = order[tid]
+    sorted_pairs[tid, 0] = pairs[i, 0]
+    sorted_pairs[tid, 1] = pairs[i, 1]
+
+
+@wp.kernel
+def soft_contact_keys(
+    contact_count: wp.array(dtype=int),
+    contact_max: int,
+    contact_particle: wp.array(dtype=int),
+    contact_shape: wp.array(dtype=Any),
+    particle_count: int,
+    shape_count: int,
+    keys: wp.array(dtype=wp.int64),
+    order: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    # the slots past the contact count go last
+    key = wp.int64(particle_count) * wp.int64(shape_count)
+    if tid < wp.min(contact_count[0], contact_max):
+        key = wp.int64(contact_particle[tid]) * wp.int64(shape_count) + wp.int64(contact_shape[tid])
+    keys[tid] = key
+    order[tid] = tid
+
+
+@wp.kernel
+def gather_soft_contacts(
+    order: wp.array(dtype=int),
+    contact_particle: wp.array(dtype=int),
+    contact_shape: wp.array(dtype=Any),
+    contact_body_pos: wp.array(dtype=wp.vec3),
+    contact_body_vel: wp.array(dtype=wp.vec3),
+    contact_normal: wp.array(dtype=Any),
+    # outputs
+    sorted_particle: wp.array(dtype=int),
+    sorted_shape: wp.array(dtype=Any),
+    sorted_body_pos: wp.array(dtype=wp.vec3),
+    sorted_body_vel: wp.array(dtype=wp.vec3),
+    sorted_normal: wp.array(dtype=Any),
+):
+    tid = wp.tid()
+    i = order[tid]
+    sorted_particle[tid] = contact_particle[i]
+    sorted_shape[tid] = contact_shape[i]
+    sorted_body_pos[tid] = contact_body_pos[i]
+    sorted_body_vel[tid] = contact_body_vel[i]
+    sorted_normal[tid] = contact_normal[i]
+
+
+def _deterministic_buffers(model, name, create):
+    # scratch arrays of the deterministic mode, allocated on first use
+    buffers = model.__dict__.setdefault("_deterministic_buffers", {})
+    if name not in buffers:
+        buffers[name] = create()
+    return buffers[name]
+
+
+def sort_shape_contact_pairs(model):
+    """Sorts the shape pairs found by the dynamic broadphase, which come in the order the BVH queries complete"""
+    n = model.shape_contact_pair_count
+
+    def create():
+        return (
+            wp.empty(2 * n, dtype=wp.int64, device=model.device),
+            wp.empty(2 * n, dtype=int, device=model.device),
+            wp.empty_like(model.shape_contact_pairs),
+        )
+
+    keys, order, sorted_pairs = _deterministic_buffers(model, "shape_contact_pairs", create)
+    wp.launch(
+        shape_contact_pair_keys,
+        dim=n,
+        inputs=[model.shape_contact_pairs, model.shape_count],
+        outputs=[keys, order],
+        device=model.device,
+        record_tape=False,
+    )
+    wp.utils.radix_sort_pairs(keys, order, n)
+    wp.launch(
+        gather_shape_contact_pairs,
+        dim=n,
+        inputs=[order, model.shape_contact_pairs],
+        outputs=[sorted_pairs],
+        device=model.device,
+        record_tape=False,
+    )
+    wp.copy(model.shape_contact_pairs, sorted_pairs)
+
+
+def sort_soft_contacts(model):
+    """Sorts the soft contacts by particle and shape, which come in the order the threads found them"""
+    n = model.soft_contact_max
+    contacts = [
+        model.soft_contact_particle,
+        model.soft_contact_shape,
+        model.soft_contact_body_pos,
+        model.soft_contact_body_vel,
+        model.soft_contact_normal,
+    ]
+
+    def create():
+        keys = wp.empty(2 * n, dtype=wp.int64, device=model.device)
+        order = wp.empty(2 * n, dtype=int, device=model.device)
+        return keys, order, [wp.empty_like(a) for a in contacts]
+
+    keys, order, sorted_contacts = _deterministic_buffers(model, "soft_contacts", create)
+    wp.launch(
+        soft_contact_keys,
+        dim=n,
+        inputs=[
+            model.soft_contact_count,
+            model.soft_contact_max,
+            model.soft_contact_particle,
+            model.soft_contact_shape,
+            model.particle_count,
+            model.shape_count,
+        ],
+        outputs=[keys, order],
+        device=model.device,
+        record_tape=False,
+    )
+    wp.utils.radix_sort_pairs(keys, order, n)
+    wp.launch(
+        gather_soft_contacts,
+        dim=n,
+        inputs=[order, *contacts],
+        outputs=sorted_contacts,
+        device=model.device,
+        record_tape=False,
+    )
+    for dst, src in zip(contacts, sorted_contacts):
+        wp.copy(dst, src)
+
+
+def _launch_broadphase(model, state, contact_pairs, pair_count, pair_offset, deterministic):
+    inputs = [
+        contact_pairs,
+        state.body_q,
+        model.shape_transform,
+        model.shape_body,
+        model.shape_geo,
+        model.shape_collision_radius,
+        model.rigid_contact_max,
+        model.rigid_contact_margin,
+        pair_offset,
+        model.rigid_contact_pair_skip,
+    ]
+    outputs = [
+        model.rigid_contact_count,
+        model.rigid_contact_shape0,
+        model.rigid_contact_shape1,
+        model.rigid_contact_point_id,
+        model.rigid_contact_pair_size,
+        model.rigid_contact_pair_index,
+    ]
+
+    def launch(pair_offsets, pair_counts):
         wp.launch(
-            kernel=create_soft_contacts,
-            dim=(model.particle_count, model.shape_count - 1),
+            kernel=broadphase_collision_pairs,
+            dim=pair_count,
+            inputs=[*inputs, pair_offsets],
+            outputs=[*outputs, pair_counts],
+            device=model.device,
+            record_tape=False,
+        )
+
+    if not deterministic:
+        launch(None, None)
+        return
+
+    # count the contacts of each pair, then write them at the exclusive prefix sum of the counts
+    def create():
+        return (
+            wp.zeros(pair_count, dtype=int, device=model.device),
+            wp.zeros(pair_count, dtype=int, device=model.device),
+        )
+
+    pair_counts, pair_offsets = _deterministic_buffers(model, f"broadphase_{pair_offset}", create)
+    pair_counts.zero_()
+    launch(None, pair_counts)
+    wp.utils.array_scan(pair_counts, pair_offsets, inclusive=False)
+    launch(pair_offsets, None)
+    wp.launch(
+        advance_contact_count,
+        dim=1,
+        inputs=[pair_offsets, pair_counts, pair_count],
+        outputs=[model.rigid_contact_count],
+        device=model.device,
+        record_tape=False,
+    )
+
+
+def _create_soft_contacts(model, state, deterministic):
+    # clear old count
+    model.soft_contact_count.zero_()
+    soft_contact_outputs = [
+        model.soft_contact_count,
+        model.soft_contact_particle,
+        model.soft_contact_shape,
+        model.soft_contact_body_pos,
+        model.soft_contact_body_vel,
+        model.soft_contact_normal,
+    ]
+
+    if model.use_soft_contact_broadphase():
+        # evaluate the shapes only for the particles within their bounds
+        model.update_soft_contact_pairs(state.particle_q, state.body_q)
+        wp.launch(
+            kernel=create_soft_contacts_from_pairs,
+            dim=model.soft_contact_pair_max,
             inputs=[
+                model.soft_contact_pairs,
+                model.soft_contact_pair_found,
                 state.particle_q,
                 model.particle_radius,
-                model.particle_flags,
                 state.body_q,
                 model.shape_transform,
                 model.shape_body,
@@ -1352,72 +2161,129 @@ def collide(model, state, edge_sdf_iter: int = 10):
                 model.soft_contact_margin,
                 model.soft_contact_max,
             ],
-            outputs=[
-                model.soft_contact_count,
-                model.soft_contact_particle,
-                model.soft_contact_shape,
-                model.soft_contact_body_pos,
-                model.soft_contact_body_vel,
-                model.soft_contact_normal,
-            ],
+            outputs=soft_contact_outputs,
             device=model.device,
         )
-
-    # clear old count
-    model.rigid_contact_count.zero_()
-
-    if model.shape_contact_pair_count:
+    else:
         wp.launch(
-            kernel=broadphase_collision_pairs,
-            dim=model.shape_contact_pair_count,
+            kernel=create_soft_contacts,
+            dim=(model.particle_count, model.shape_count - 1),
             inputs=[
-                model.shape_contact_pairs,
+                state.particle_q,
+                model.particle_radius,
+                model.particle_flags,
                 state.body_q,
                 model.shape_transform,
                 model.shape_body,
                 model.shape_geo,
-                model.shape_collision_radius,
-                model.rigid_contact_max,
-                model.rigid_contact_margin,
-            ],
-            outputs=[
-                model.rigid_contact_count,
-                model.rigid_contact_shape0,
-                model.rigid_contact_shape1,
-                model.rigid_contact_point_id,
+                model.soft_contact_margin,
+                model.soft_contact_max,
             ],
+            outputs=soft_contact_outputs,
             device=model.device,
-            record_tape=False,
         )
 
-    if model.ground and model.shape_ground_contact_pair_count:
+    if deterministic:
+        sort_soft_contacts(model)
+
+
+def collide(model, state, edge_sdf_iter: int = 10, deterministic: bool = None):
+    """
+    Generates contact points for the particles and rigid bodies in the model,
+    to be used in the contact dynamics kernel of the integrator.
+
+    Args:
+        model: the model to be simulated
+        state: the state of the model
+        edge_sdf_iter: number of search iterations for finding closest contact points between edges and SDF
+        deterministic: generate the contacts in the same order on every run, defaults to ``wp.config.deterministic``.
+            The broadphase then runs twice to count and place the contacts of each shape pair, and the soft contacts
+            and the pairs of the dynamic broadphase are sorted. Contacts reused by the contact cache are not ordered.
+    """
+
+    if deterministic is None:
+        deterministic = wp.config.deterministic
+
+    # generate soft contacts for particles and shapes except ground plane (last shape)
+    if model.particle_count and model.shape_count > 1:
+        _create_soft_contacts(model, state, deterministic)
+        # the contacts that didn't fit are generated again in the grown buffers
+        while model.soft_contact_dynamic and not model.device.is_capturing and model.grow_soft_contacts():
+            _create_soft_contacts(model, state, deterministic)
+
+    # clear old count
+    model.rigid_contact_count.zero_()
+
+    if model.shape_bvh is not None:
+        model.update_shape_contact_pairs(state.body_q)
+        if deterministic:
+            sort_shape_contact_pairs(model)
+
+    # shape pairs and ground pairs are numbered consecutively in the contact cache
+    contact_pairs = model.shape_contact_pairs if model.shape_contact_pair_count else None
+    ground_contact_pairs = model.shape_ground_contact_pairs if model.shape_ground_contact_pair_count else None
+
+    if model.rigid_contact_pair_size is not None:
+        model.rigid_contact_pair_size.zero_()
+
+    cached_pair_count = (model.shape_contact_pair_count or 0) + (
+        model.shape_ground_contact_pair_count if model.ground else 0
+    )
+    if model.rigid_contact_cache_count is not None and cached_pair_count:
         wp.launch(
-            kernel=broadphase_collision_pairs,
-            dim=model.shape_ground_contact_pair_count,
+            kernel=reuse_cached_contacts,
+            dim=cached_pair_count,
             inputs=[
-                model.shape_ground_contact_pairs,
                 state.body_q,
                 model.shape_transform,
                 model.shape_body,
-                model.shape_geo,
                 model.shape_collision_radius,
+                contact_pairs,
+                ground_contact_pairs,
+                *model.rigid_contact_cache_arrays(),
+                model.rigid_contact_cache_tolerance,
                 model.rigid_contact_max,
-                model.rigid_contact_margin,
             ],
             outputs=[
+                model.rigid_contact_pair_skip,
                 model.rigid_contact_count,
                 model.rigid_contact_shape0,
                 model.rigid_contact_shape1,
                 model.rigid_contact_point_id,
+                model.rigid_contact_body0,
+                model.rigid_contact_body1,
+                model.rigid_contact_point0,
+                model.rigid_contact_point1,
+                model.rigid_contact_offset0,
+                model.rigid_contact_offset1,
+                model.rigid_contact_normal,
+                model.rigid_contact_thickness,
             ],
             device=model.device,
             record_tape=False,
         )
 
+    if model.shape_contact_pair_count:
+        _launch_broadphase(
+            model, state, model.shape_contact_pairs, model.shape_contact_pair_count, 0, deterministic
+        )
+
+    if model.ground and model.shape_ground_contact_pair_count:
+        _launch_broadphase(
+            model,
+            state,
+            model.shape_ground_contact_pairs,
+            model.shape_ground_contact_pair_count,
+            model.shape_contact_pair_count or 0,
+            deterministic,
+        )
+
     if model.shape_contact_pair_count or model.ground and model.shape_ground_contact_pair_count:
+        # only the threads of the contacts found by the narrow phase run, without reading the count back
         wp.launch(
             kernel=handle_contact_pairs,
-            dim=model.rigid_contact_max,
+            dim=model.rigid_contact_count,
+            max_dim=model.rigid_contact_max,
             inputs=[
                 state.body_q,
                 model.shape_transform,
@@ -1443,3 +2309,73 @@ def collide(model, state, edge_sdf_iter: int = 10):
             ],
             device=model.device,
         )
+
+        if model.rigid_contact_pair_size is not None:
+            if model.rigid_contact_cache_count is not None:
+                cache = model.rigid_contact_cache_arrays()
+            else:
+                cache = [None] * 12
+            wp.launch(
+                kernel=reduce_contact_manifolds,
+                dim=model.rigid_contact_max,
+                inputs=[
+                    state.body_q,
+                    model.shape_transform,
+                    model.shape_body,
+                    contact_pairs,
+                    ground_contact_pairs,
+                    model.rigid_contact_count,
+                    model.rigid_contact_pair_size,
+                    model.rigid_contact_pair_index,
+                    model.rigid_contact_body0,
+                    model.rigid_contact_body1,
+                    model.rigid_contact_point0,
+                    model.rigid_contact_point1,
+                    model.rigid_contact_offset0,
+                    model.rigid_contact_offset1,
+                    model.rigid_contact_normal,
+                    model.rigid_contact_thickness,
+                ],
+                outputs=[model.rigid_contact_shape0, model.rigid_contact_shape1, *cache],
+                device=model.device,
+                record_tape=False,
+            )
+
+    if model.body_island is not None:
+        # wake up sleeping islands touched by moving bodies or particles before the next integration step
+        if model.shape_contact_pair_count or model.ground and model.shape_ground_contact_pair_count:
+            wp.launch(
+                kernel=wake_rigid_contact_islands,
+                dim=model.rigid_contact_max,
+                inputs=[
+                    model.rigid_contact_count,
+                    model.rigid_contact_shape0,
+                    model.rigid_contact_body0,
+                    model.rigid_contact_body1,
+                    state.body_qd,
+                    model.body_island,
+                    model.body_sleep_velocity,
+                    model.rigid_contact_max,
+                ],
+                outputs=[model.island_wake],
+                device=model.device,
+                record_tape=False,
+            )
+        if model.particle_count and model.shape_count > 1:
+            wp.launch(
+                kernel=wake_soft_contact_islands,
+                dim=model.soft_contact_max,
+                inputs=[
+                    model.soft_contact_count,
+                    model.soft_contact_particle,
+                    model.soft_contact_shape,
+                    state.particle_qd,
+                    model.shape_body,
+                    model.body_island,
+                    model.body_sleep_velocity,
+                    model.soft_contact_max,
+                ],
+                outputs=[model.island_wake],
+                device=model.device,
+                record_tape=False,
+            )
@@ -38,6 +38,7 @@ def parse_mjcf(
     up_axis="Z",
     ignore_classes=[],
     collapse_fixed_joints=False,
+    mesh_cache=None,
 ):
     """
     Parses MuJoCo XML (MJCF) file and adds the bodies and joints to the given ModelBuilder.
@@ -64,6 +65,8 @@ def parse_mjcf(
         up_axis (str): The up axis of the mechanism. Can be either `"X"`, `"Y"` or `"Z"`. The default is `"Z"`.
         ignore_classes (List[str]): A list of regular expressions. Bodies and joints with a class matching one of the regular expressions will be ignored.
         collapse_fixed_joints (bool): If True, fixed joints are removed and the respective bodies are merged.
+        mesh_cache (MeshCache): Cache of the loaded mesh files, share it across imports to parse each asset only once.
+            If None, a cache local to this import is used.
 
     Note:
         The inertia and masses of the bodies are calculated from the shape geometry and the given density. The values defined in the MJCF are not respected at the moment.
@@ -97,6 +100,13 @@ def parse_mjcf(
                     name = ".".join(os.path.basename(fname).split(".")[:-1])
                     mesh_assets[name] = fname
 
+    if mesh_cache is None:
+        mesh_cache = wp.sim.MeshCache()
+
+    if parse_meshes:
+        # parse all mesh assets in parallel ahead of building the shapes
+        mesh_cache.prefetch((fname, (scale,) * 3) for fname in set(mesh_assets.values()) if os.path.exists(fname))
+
     class_parent = {}
     class_children = {}
     class_defaults = {"__all__": {}}
@@ -188,21 +198,8 @@ def parse_mjcf(
         return wp.quat_identity()
 
     def parse_mesh(geom):
-        import trimesh
-
-        faces = []
-        vertices = []
-        stl_file = mesh_assets[geom["mesh"]]
-        m = trimesh.load(stl_file)
-
-        for v in m.vertices:
-            vertices.append(np.array(v) * scale)
-
-        for f in m.faces:
-            faces.append(int(f[0]))
-            faces.append(int(f[1]))
-            faces.append(int(f[2]))
-        return wp.sim.Mesh(vertices, faces), m.scale
+        # files containing a scene hold multiple meshes
+        return mesh_cache.load(mesh_assets[geom["mesh"]], (scale,) * 3)
 
     def parse_body(body, parent, incoming_defaults: dict):
         body_class = body.get("childclass")
@@ -373,25 +370,26 @@ def parse_mjcf(
                 )
 
             elif geom_type == "mesh" and parse_meshes:
-                mesh, _ = parse_mesh(geom_attrib)
+                meshes = parse_mesh(geom_attrib)
                 if "mesh" in defaults:
                     mesh_scale = parse_vec(defaults["mesh"], "scale", [1.0, 1.0, 1.0])
                 else:
                     mesh_scale = [1.0, 1.0, 1.0]
                 # as per the Mujoco XML reference, ignore geom size attribute
                 assert len(geom_size) == 3, "need to specify size for mesh geom"
-                builder.add_shape_mesh(
-                    body=link,
-                    pos=geom_pos,
-                    rot=geom_rot,
-                    mesh=mesh,
-                    scale=mesh_scale,
-                    density=density,
-                    ke=contact_ke,
-                    kd=contact_kd,
-                    kf=contact_kf,
-                    mu=contact_mu,
-                )
+                for mesh in meshes:
+                    builder.add_shape_mesh(
+                        body=link,
+                        pos=geom_pos,
+                        rot=geom_rot,
+                        mesh=mesh,
+                        scale=mesh_scale,
+                        density=density,
+                        ke=contact_ke,
+                        kd=contact_kd,
+                        kf=contact_kf,
+                        mu=contact_mu,
+                    )
 
             elif geom_type in {"capsule", "cylinder"}:
                 if "fromto" in geom_attrib:
@@ -12,7 +12,7 @@ from typing import Union
 import numpy as np
 
 import warp as wp
-from warp.sim.model import Mesh
+from warp.sim.mesh_cache import MeshCache
 
 
 def parse_urdf(
@@ -41,6 +41,7 @@ def parse_urdf(
     ensure_nonstatic_links=True,
     static_link_mass=1e-2,
     collapse_fixed_joints=False,
+    mesh_cache: MeshCache = None,
 ):
     """
     Parses a URDF file and adds the bodies and joints to the given ModelBuilder.
@@ -70,11 +71,33 @@ def parse_urdf(
         ensure_nonstatic_links (bool): If True, links with zero mass are given a small mass (see `static_link_mass`) to ensure they are dynamic.
         static_link_mass (float): The mass to assign to links with zero mass (if `ensure_nonstatic_links` is set to True).
         collapse_fixed_joints (bool): If True, fixed joints are removed and the respective bodies are merged.
+        mesh_cache (MeshCache): Cache of the loaded mesh files, share it across imports to parse each asset only once.
+            If None, a cache local to this import is used.
     """
 
     file = ET.parse(urdf_filename)
     root = file.getroot()
 
+    if mesh_cache is None:
+        mesh_cache = MeshCache()
+
+    def mesh_file_and_scale(mesh):
+        filename = os.path.join(os.path.dirname(urdf_filename), mesh.get("filename"))
+        scaling = mesh.get("scale") or "1 1 1"
+        return filename, np.array([float(x) * scale for x in scaling.split()])
+
+    # parse all local mesh files in parallel ahead of building the shapes
+    collider_tag = "visual" if parse_visuals_as_colliders else "collision"
+    mesh_assets = []
+    for mesh in root.findall(f"link/{collider_tag}/geometry/mesh"):
+        filename = mesh.get("filename")
+        if filename is None or filename.startswith("http://") or filename.startswith("https://"):
+            continue
+        filename, scaling = mesh_file_and_scale(mesh)
+        if os.path.exists(filename):
+            mesh_assets.append((filename, scaling))
+    mesh_cache.prefetch(mesh_assets)
+
     def parse_transform(element):
         if element is None or element.find("origin") is None:
             return wp.transform()
@@ -158,6 +181,8 @@ def parse_urdf(
 
                     import requests
 
+                    scaling = mesh.get("scale") or "1 1 1"
+                    scaling = np.array([float(x) * scale for x in scaling.split()])
                     with tempfile.TemporaryDirectory() as tmpdir:
                         # get filename extension
                         extension = os.path.splitext(filename)[1]
@@ -165,42 +190,16 @@ def parse_urdf(
                         with requests.get(filename, stream=True) as r:
                             with open(tmpfile, "wb") as f:
                                 shutil.copyfileobj(r.raw, f)
-                        filename = tmpfile
-                else:
-                    filename = os.path.join(os.path.dirname(urdf_filename), filename)
-                if not os.path.exists(filename):
-                    wp.utils.warn(f"Warning: mesh file {filename} does not exist")
-                    continue
-
-                import trimesh
-
-                m = trimesh.load_mesh(filename)
-                scaling = mesh.get("scale") or "1 1 1"
-                scaling = np.array([float(x) * scale for x in scaling.split()])
-                if hasattr(m, "geometry"):
-                    # multiple meshes are contained in a scene
-                    for geom in m.geometry.values():
-                        vertices = np.array(geom.vertices, dtype=np.float32) * scaling
-                        faces = np.array(geom.faces, dtype=np.int32)
-                        mesh = Mesh(vertices, faces)
-                        builder.add_shape_mesh(
-                            body=link,
-                            pos=tf.p,
-                            rot=tf.q,
-                            mesh=mesh,
-                            density=density,
-                            ke=shape_ke,
-                            kd=shape_kd,
-                            kf=shape_kf,
-                            mu=shape_mu,
-                            restitution=shape_restitution,
-                            thickness=shape_thickness,
-                        )
+                        meshes = mesh_cache.load(tmpfile, scaling)
                 else:
-                    # a single mesh
-                    vertices = np.array(m.vertices, dtype=np.float32) * scaling
-                    faces = np.array(m.faces, dtype=np.int32)
-                    mesh = Mesh(vertices, faces)
+                    filename, scaling = mesh_file_and_scale(mesh)
+                    if not os.path.exists(filename):
+                        wp.utils.warn(f"Warning: mesh file {filename} does not exist")
+                        continue
+                    meshes = mesh_cache.load(filename, scaling)
+
+                # files containing a scene hold multiple meshes
+                for mesh in meshes:
                     builder.add_shape_mesh(
                         body=link,
                         pos=tf.p,
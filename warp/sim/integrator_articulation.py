@@ -849,6 +849,89 @@ def eval_rigid_id(
         )
 
 
+@wp.kernel
+def eval_rigid_fk_level(
+    level_joints: wp.array(dtype=int),
+    level_start: int,
+    joint_type: wp.array(dtype=int),
+    joint_parent: wp.array(dtype=int),
+    joint_q_start: wp.array(dtype=int),
+    joint_qd_start: wp.array(dtype=int),
+    joint_q: wp.array(dtype=float),
+    joint_X_pj: wp.array(dtype=wp.transform),
+    joint_X_cm: wp.array(dtype=wp.transform),
+    joint_axis: wp.array(dtype=wp.vec3),
+    body_X_sc: wp.array(dtype=wp.transform),
+    body_X_sm: wp.array(dtype=wp.transform),
+):
+
+    # one thread per-joint of a depth level, the parents were processed by the previous launch
+    tid = wp.tid()
+
+    compute_link_transform(
+        level_joints[level_start + tid],
+        joint_type,
+        joint_parent,
+        joint_q_start,
+        joint_qd_start,
+        joint_q,
+        joint_X_pj,
+        joint_X_cm,
+        joint_axis,
+        body_X_sc,
+        body_X_sm,
+    )
+
+
+@wp.kernel
+def eval_rigid_id_level(
+    level_joints: wp.array(dtype=int),
+    level_start: int,
+    joint_type: wp.array(dtype=int),
+    joint_parent: wp.array(dtype=int),
+    joint_q_start: wp.array(dtype=int),
+    joint_qd_start: wp.array(dtype=int),
+    joint_q: wp.array(dtype=float),
+    joint_qd: wp.array(dtype=float),
+    joint_axis: wp.array(dtype=wp.vec3),
+    joint_target_ke: wp.array(dtype=float),
+    joint_target_kd: wp.array(dtype=float),
+    body_I_m: wp.array(dtype=wp.spatial_matrix),
+    body_X_sc: wp.array(dtype=wp.transform),
+    body_X_sm: wp.array(dtype=wp.transform),
+    joint_X_pj: wp.array(dtype=wp.transform),
+    gravity: wp.vec3,
+    # outputs
+    joint_S_s: wp.array(dtype=wp.spatial_vector),
+    body_I_s: wp.array(dtype=wp.spatial_matrix),
+    body_v_s: wp.array(dtype=wp.spatial_vector),
+    body_f_s: wp.array(dtype=wp.spatial_vector),
+    body_a_s: wp.array(dtype=wp.spatial_vector),
+):
+
+    # one thread per-joint of a depth level, the parents were processed by the previous launch
+    tid = wp.tid()
+
+    compute_link_velocity(
+        level_joints[level_start + tid],
+        joint_type,
+        joint_parent,
+        joint_qd_start,
+        joint_qd,
+        joint_axis,
+        body_I_m,
+        body_X_sc,
+        body_X_sm,
+        joint_X_pj,
+        gravity,
+        joint_S_s,
+        body_I_s,
+        body_v_s,
+        body_f_s,
+        body_a_s,
+    )
+
+
 @wp.kernel
 def eval_rigid_tau(
     articulation_start: wp.array(dtype=int),
@@ -1052,6 +1135,17 @@ def eval_dense_cholesky_batched(
     wp.dense_chol_batched(A_start, A_dim, A, regularization, L)
 
 
+@wp.kernel
+def eval_dense_cholesky_batched_warp(
+    A_start: wp.array(dtype=int),
+    A_dim: wp.array(dtype=int),
+    A: wp.array(dtype=float),
+    regularization: wp.array(dtype=float),
+    L: wp.array(dtype=float),
+):
+    wp.dense_chol_batched_warp(A_start, A_dim, A, regularization, L)
+
+
 @wp.kernel
 def eval_dense_subs(n: int, L: wp.array(dtype=float), b: wp.array(dtype=float), x: wp.array(dtype=float)):
     wp.dense_subs(n, L, b, x)
@@ -1087,6 +1181,28 @@ def eval_dense_solve_batched(
     wp.dense_solve_batched(b_start, A_start, A_dim, A, L, b, tmp, x)
 
 
+@wp.kernel
+def eval_dense_solve_batched_warp(
+    b_start: wp.array(dtype=int),
+    A_start: wp.array(dtype=int),
+    A_dim: wp.array(dtype=int),
+    A: wp.array(dtype=float),
+    L: wp.array(dtype=float),
+    b: wp.array(dtype=float),
+    tmp: wp.array(dtype=float),
+    x: wp.array(dtype=float),
+):
+    wp.dense_solve_batched_warp(b_start, A_start, A_dim, A, L, b, tmp, x)
+
+
+def threads_per_matrix(device):
+    # batched factorizations and solves run one warp per matrix on CUDA, must match kNumThreadsPerMatrix in matnn.h
+    if wp.get_device(device).is_cpu:
+        return 1
+    else:
+        return 32
+
+
 def matmul_batched(batch_count, m, n, k, t1, t2, A_start, B_start, C_start, A, B, C, device):
 
     if device == "cpu":
@@ -1115,11 +1231,41 @@ def matmul_batched(batch_count, m, n, k, t1, t2, A_start, B_start, C_start, A, B
 
 
 class SemiImplicitArticulationIntegrator:
+    """
+    Args:
+        level_parallel (bool): Evaluate the forward kinematics and inverse dynamics with one launch per depth level
+            of the kinematic trees (see :func:`Model.compute_joint_levels`) and one thread per joint of the level,
+            instead of one thread per articulation walking its joints serially. Faster for few articulations
+            with many links.
+    """
 
-    def __init__(self):
-        pass
+    def __init__(self, level_parallel=False):
+        self.level_parallel = level_parallel
 
     def eval_rigid_fk(self, model, state_in):
+        if self.level_parallel:
+            for level in range(model.joint_level_count):
+                start = model.joint_level_start[level]
+                wp.launch(
+                    kernel=eval_rigid_fk_level,
+                    dim=model.joint_level_start[level + 1] - start,
+                    inputs=[
+                        model.joint_level_joints,
+                        start,
+                        model.joint_type,
+                        model.joint_parent,
+                        model.joint_q_start,
+                        model.joint_qd_start,
+                        state_in.joint_q,
+                        model.joint_X_p,
+                        model.joint_X_cm,
+                        model.joint_axis,
+                    ],
+                    outputs=[state_in.body_X_sc, state_in.body_X_sm],
+                    device=model.device,
+                )
+            return
+
         # evaluate body transforms
         wp.launch(
             kernel=eval_rigid_fk,
@@ -1140,6 +1286,41 @@ class SemiImplicitArticulationIntegrator:
         )
 
     def eval_rigid_id(self, model, state_in):
+        if self.level_parallel:
+            for level in range(model.joint_level_count):
+                start = model.joint_level_start[level]
+                wp.launch(
+                    kernel=eval_rigid_id_level,
+                    dim=model.joint_level_start[level + 1] - start,
+                    inputs=[
+                        model.joint_level_joints,
+                        start,
+                        model.joint_type,
+                        model.joint_parent,
+                        model.joint_q_start,
+                        model.joint_qd_start,
+                        state_in.joint_q,
+                        state_in.joint_qd,
+                        model.joint_axis,
+                        model.joint_target_ke,
+                        model.joint_target_kd,
+                        model.body_I_m,
+                        state_in.body_X_sc,
+                        state_in.body_X_sm,
+                        model.joint_X_p,
+                        model.gravity,
+                    ],
+                    outputs=[
+                        state_in.joint_S_s,
+                        state_in.body_I_s,
+                        state_in.body_v_s,
+                        state_in.body_f_s,
+                        state_in.body_a_s,
+                    ],
+                    device=model.device,
+                )
+            return
+
         # evaluate final joint inertias, motion vectors, and forces
         wp.launch(
             kernel=eval_rigid_id,
@@ -1238,8 +1419,8 @@ class SemiImplicitArticulationIntegrator:
 
         # compute decomposition
         wp.launch(
-            kernel=eval_dense_cholesky_batched,
-            dim=model.articulation_count,
+            kernel=eval_dense_cholesky_batched_warp,
+            dim=model.articulation_count * threads_per_matrix(model.device),
             inputs=[model.articulation_H_start, model.articulation_H_rows, model.H, model.joint_armature],
             outputs=[model.L],
             device=model.device,
@@ -1302,8 +1483,8 @@ class SemiImplicitArticulationIntegrator:
 
         # solve for qdd
         wp.launch(
-            kernel=eval_dense_solve_batched,
-            dim=model.articulation_count,
+            kernel=eval_dense_solve_batched_warp,
+            dim=model.articulation_count * threads_per_matrix(model.device),
             inputs=[
                 model.articulation_dof_start,
                 model.articulation_H_start,
@@ -1338,54 +1519,10 @@ class SemiImplicitArticulationIntegrator:
         )
 
         # evaluate final body transforms
-        wp.launch(
-            kernel=eval_rigid_fk,
-            dim=model.articulation_count,
-            inputs=[
-                model.articulation_start,  # now, originally articulation_joint_start
-                model.joint_type,
-                model.joint_parent,
-                model.joint_q_start,
-                model.joint_qd_start,
-                state_out.joint_q,
-                model.joint_X_p,  # now, originally joint_X_pj
-                model.joint_X_cm,
-                model.joint_axis,
-            ],
-            outputs=[state_out.body_X_sc, state_out.body_X_sm],
-            device=model.device,
-        )
+        self.eval_rigid_fk(model, state_out)
 
         # evaluate final joint inertias, motion vectors, and forces
-        wp.launch(
-            kernel=eval_rigid_id,
-            dim=model.articulation_count,
-            inputs=[
-                model.articulation_start,  # now, originally articulation_joint_start
-                model.joint_type,
-                model.joint_parent,
-                model.joint_q_start,
-                model.joint_qd_start,
-                state_out.joint_q,
-                state_out.joint_qd,
-                model.joint_axis,
-                model.joint_target_ke,
-                model.joint_target_kd,
-                model.body_I_m,
-                state_out.body_X_sc,
-                state_out.body_X_sm,
-                model.joint_X_p,  # now, originally joint_X_pj
-                model.gravity,
-            ],
-            outputs=[
-                state_out.joint_S_s,
-                state_out.body_I_s,
-                state_out.body_v_s,
-                state_out.body_f_s,
-                state_out.body_a_s,
-            ],
-            device=model.device,
-        )
+        self.eval_rigid_id(model, state_out)
 
         # body position and velocity in inertial frame
         wp.launch(
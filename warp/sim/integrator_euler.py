@@ -10,13 +10,18 @@ models + state forward in time.
 
 """
 
+import numpy as np
+from typing import Any
+
 import warp as wp
+from warp.optim.linear import cg, preconditioner
+from warp.sparse import BsrTripletsTopology, bsr_set_from_triplets, bsr_zeros
 
 from .collide import triangle_closest_point_barycentric
 from .model import PARTICLE_FLAG_ACTIVE, ModelShapeGeometry, ModelShapeMaterials
 from .optimizer import Optimizer
 from .particles import eval_particle_forces
-from .utils import quat_decompose, quat_twist
+from .utils import load_contact_normal, quat_decompose, quat_twist
 
 
 @wp.kernel
@@ -55,8 +60,9 @@ def integrate_particles(
 
 
 # semi-implicit Euler integration
-@wp.kernel
-def integrate_bodies(
+@wp.func
+def integrate_body(
+    tid: int,
     body_q: wp.array(dtype=wp.transform),
     body_qd: wp.array(dtype=wp.spatial_vector),
     body_f: wp.array(dtype=wp.spatial_vector),
@@ -72,8 +78,6 @@ def integrate_bodies(
     body_q_new: wp.array(dtype=wp.transform),
     body_qd_new: wp.array(dtype=wp.spatial_vector),
 ):
-    tid = wp.tid()
-
     # positions
     q = body_q[tid]
     qd = body_qd[tid]
@@ -119,7 +123,99 @@ def integrate_bodies(
 
 
 @wp.kernel
-def eval_springs(
+def integrate_bodies(
+    body_q: wp.array(dtype=wp.transform),
+    body_qd: wp.array(dtype=wp.spatial_vector),
+    body_f: wp.array(dtype=wp.spatial_vector),
+    body_com: wp.array(dtype=wp.vec3),
+    m: wp.array(dtype=float),
+    I: wp.array(dtype=wp.mat33),
+    inv_m: wp.array(dtype=float),
+    inv_I: wp.array(dtype=wp.mat33),
+    gravity: wp.vec3,
+    angular_damping: float,
+    dt: float,
+    # outputs
+    body_q_new: wp.array(dtype=wp.transform),
+    body_qd_new: wp.array(dtype=wp.spatial_vector),
+):
+    tid = wp.tid()
+    integrate_body(
+        tid, body_q, body_qd, body_f, body_com, m, I, inv_m, inv_I, gravity, angular_damping, dt, body_q_new, body_qd_new
+    )
+
+
+# integrates the bodies of the awake islands listed by Model.update_active_bodies()
+@wp.kernel
+def integrate_active_bodies(
+    body_active_indices: wp.array(dtype=int),
+    body_active_count: wp.array(dtype=int),
+    body_q: wp.array(dtype=wp.transform),
+    body_qd: wp.array(dtype=wp.spatial_vector),
+    body_f: wp.array(dtype=wp.spatial_vector),
+    body_com: wp.array(dtype=wp.vec3),
+    m: wp.array(dtype=float),
+    I: wp.array(dtype=wp.mat33),
+    inv_m: wp.array(dtype=float),
+    inv_I: wp.array(dtype=wp.mat33),
+    gravity: wp.vec3,
+    angular_damping: float,
+    dt: float,
+    # outputs
+    body_q_new: wp.array(dtype=wp.transform),
+    body_qd_new: wp.array(dtype=wp.spatial_vector),
+):
+    tid = wp.tid()
+    if tid >= body_active_count[0]:
+        return
+
+    integrate_body(
+        body_active_indices[tid],
+        body_q,
+        body_qd,
+        body_f,
+        body_com,
+        m,
+        I,
+        inv_m,
+        inv_I,
+        gravity,
+        angular_damping,
+        dt,
+        body_q_new,
+        body_qd_new,
+    )
+
+
+@wp.func
+def add_particle_force(
+    f: wp.array(dtype=wp.vec3), f_slots: wp.array(dtype=wp.vec3), slot: int, index: int, force: wp.vec3
+):
+    # in deterministic mode each contribution is stored in its own slot, and the slots are summed per particle in a
+    # fixed order by a DeterministicScatter
+    if f_slots.shape[0] > 0:
+        f_slots[slot] = force
+    else:
+        wp.atomic_add(f, index, force)
+
+
+@wp.func
+def add_body_force(
+    f: wp.array(dtype=wp.spatial_vector),
+    f_slots: wp.array(dtype=wp.spatial_vector),
+    slot: int,
+    index: int,
+    force: wp.spatial_vector,
+):
+    if f_slots.shape[0] > 0:
+        f_slots[slot] = force
+    else:
+        wp.atomic_add(f, index, force)
+
+
+@wp.func
+def eval_spring(
+    tid: int,
     x: wp.array(dtype=wp.vec3),
     v: wp.array(dtype=wp.vec3),
     spring_indices: wp.array(dtype=int),
@@ -127,9 +223,8 @@ def eval_springs(
     spring_stiffness: wp.array(dtype=float),
     spring_damping: wp.array(dtype=float),
     f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
 ):
-    tid = wp.tid()
-
     i = spring_indices[tid * 2 + 0]
     j = spring_indices[tid * 2 + 1]
 
@@ -158,12 +253,28 @@ def eval_springs(
     # damping based on relative velocity.
     fs = dir * (ke * c + kd * dcdt)
 
-    wp.atomic_sub(f, i, fs)
-    wp.atomic_add(f, j, fs)
+    add_particle_force(f, f_slots, tid * 2 + 0, i, -fs)
+    add_particle_force(f, f_slots, tid * 2 + 1, j, fs)
 
 
 @wp.kernel
-def eval_triangles(
+def eval_springs(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    spring_indices: wp.array(dtype=int),
+    spring_rest_lengths: wp.array(dtype=float),
+    spring_stiffness: wp.array(dtype=float),
+    spring_damping: wp.array(dtype=float),
+    f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    eval_spring(tid, x, v, spring_indices, spring_rest_lengths, spring_stiffness, spring_damping, f, f_slots)
+
+
+@wp.func
+def eval_triangle(
+    tid: int,
     x: wp.array(dtype=wp.vec3),
     v: wp.array(dtype=wp.vec3),
     indices: wp.array2d(dtype=int),
@@ -171,9 +282,8 @@ def eval_triangles(
     activation: wp.array(dtype=float),
     materials: wp.array2d(dtype=float),
     f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
 ):
-    tid = wp.tid()
-
     k_mu = materials[tid, 0]
     k_lambda = materials[tid, 1]
     k_damp = materials[tid, 2]
@@ -303,9 +413,24 @@ def eval_triangles(
     f2 = f2 + f_drag + f_lift
 
     # apply forces
-    wp.atomic_add(f, i, f0)
-    wp.atomic_sub(f, j, f1)
-    wp.atomic_sub(f, k, f2)
+    add_particle_force(f, f_slots, tid * 3 + 0, i, f0)
+    add_particle_force(f, f_slots, tid * 3 + 1, j, -f1)
+    add_particle_force(f, f_slots, tid * 3 + 2, k, -f2)
+
+
+@wp.kernel
+def eval_triangles(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    indices: wp.array2d(dtype=int),
+    pose: wp.array(dtype=wp.mat22),
+    activation: wp.array(dtype=float),
+    materials: wp.array2d(dtype=float),
+    f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    eval_triangle(tid, x, v, indices, pose, activation, materials, f, f_slots)
 
 
 # @wp.func
@@ -534,16 +659,17 @@ def eval_triangles_body_contacts(
     wp.atomic_add(tri_f, k, f_total * bary[2])
 
 
-@wp.kernel
-def eval_bending(
+@wp.func
+def eval_bending_edge(
+    tid: int,
     x: wp.array(dtype=wp.vec3),
     v: wp.array(dtype=wp.vec3),
     indices: wp.array2d(dtype=int),
     rest: wp.array(dtype=float),
     bending_properties: wp.array2d(dtype=float),
     f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
 ):
-    tid = wp.tid()
     ke = bending_properties[tid, 0]
     kd = bending_properties[tid, 1]
 
@@ -602,14 +728,29 @@ def eval_bending(
     # total force, proportional to edge length
     f_total = 0.0 - e_length * (f_elastic + f_damp)
 
-    wp.atomic_add(f, i, d1 * f_total)
-    wp.atomic_add(f, j, d2 * f_total)
-    wp.atomic_add(f, k, d3 * f_total)
-    wp.atomic_add(f, l, d4 * f_total)
+    add_particle_force(f, f_slots, tid * 4 + 0, i, d1 * f_total)
+    add_particle_force(f, f_slots, tid * 4 + 1, j, d2 * f_total)
+    add_particle_force(f, f_slots, tid * 4 + 2, k, d3 * f_total)
+    add_particle_force(f, f_slots, tid * 4 + 3, l, d4 * f_total)
 
 
 @wp.kernel
-def eval_tetrahedra(
+def eval_bending(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    indices: wp.array2d(dtype=int),
+    rest: wp.array(dtype=float),
+    bending_properties: wp.array2d(dtype=float),
+    f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    eval_bending_edge(tid, x, v, indices, rest, bending_properties, f, f_slots)
+
+
+@wp.func
+def eval_tetrahedron(
+    tid: int,
     x: wp.array(dtype=wp.vec3),
     v: wp.array(dtype=wp.vec3),
     indices: wp.array2d(dtype=int),
@@ -617,9 +758,8 @@ def eval_tetrahedra(
     activation: wp.array(dtype=float),
     materials: wp.array2d(dtype=float),
     f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
 ):
-    tid = wp.tid()
-
     i = indices[tid, 0]
     j = indices[tid, 1]
     k = indices[tid, 2]
@@ -781,14 +921,30 @@ def eval_tetrahedra(
     f0 = (f1 + f2 + f3) * (0.0 - 1.0)
 
     # apply forces
-    wp.atomic_sub(f, i, f0)
-    wp.atomic_sub(f, j, f1)
-    wp.atomic_sub(f, k, f2)
-    wp.atomic_sub(f, l, f3)
+    add_particle_force(f, f_slots, tid * 4 + 0, i, -f0)
+    add_particle_force(f, f_slots, tid * 4 + 1, j, -f1)
+    add_particle_force(f, f_slots, tid * 4 + 2, k, -f2)
+    add_particle_force(f, f_slots, tid * 4 + 3, l, -f3)
 
 
 @wp.kernel
-def eval_particle_ground_contacts(
+def eval_tetrahedra(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    indices: wp.array2d(dtype=int),
+    pose: wp.array(dtype=wp.mat33),
+    activation: wp.array(dtype=float),
+    materials: wp.array2d(dtype=float),
+    f: wp.array(dtype=wp.vec3),
+    f_slots: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    eval_tetrahedron(tid, x, v, indices, pose, activation, materials, f, f_slots)
+
+
+@wp.func
+def eval_particle_ground_contact(
+    tid: int,
     particle_x: wp.array(dtype=wp.vec3),
     particle_v: wp.array(dtype=wp.vec3),
     particle_radius: wp.array(dtype=float),
@@ -801,7 +957,6 @@ def eval_particle_ground_contacts(
     # outputs
     f: wp.array(dtype=wp.vec3),
 ):
-    tid = wp.tid()
     if (particle_flags[tid] & PARTICLE_FLAG_ACTIVE) == 0:
         return
 
@@ -833,8 +988,26 @@ def eval_particle_ground_contacts(
     # Coulomb condition
     ft = wp.min(vs * kf, mu * wp.abs(fn))
 
-    # total force
-    f[tid] = f[tid] - n * fn - vt * ft
+    # total force, accumulated atomically since the fused force kernel may evaluate other terms concurrently
+    wp.atomic_sub(f, tid, n * fn + vt * ft)
+
+
+@wp.kernel
+def eval_particle_ground_contacts(
+    particle_x: wp.array(dtype=wp.vec3),
+    particle_v: wp.array(dtype=wp.vec3),
+    particle_radius: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    ke: float,
+    kd: float,
+    kf: float,
+    mu: float,
+    ground: wp.array(dtype=float),
+    # outputs
+    f: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    eval_particle_ground_contact(tid, particle_x, particle_v, particle_radius, particle_flags, ke, kd, kf, mu, ground, f)
 
 
 @wp.kernel
@@ -855,14 +1028,16 @@ def eval_particle_contacts(
     particle_ka: float,
     contact_count: wp.array(dtype=int),
     contact_particle: wp.array(dtype=int),
-    contact_shape: wp.array(dtype=int),
+    contact_shape: wp.array(dtype=Any),
     contact_body_pos: wp.array(dtype=wp.vec3),
     contact_body_vel: wp.array(dtype=wp.vec3),
-    contact_normal: wp.array(dtype=wp.vec3),
+    contact_normal: wp.array(dtype=Any),
     contact_max: int,
     # outputs
     particle_f: wp.array(dtype=wp.vec3),
     body_f: wp.array(dtype=wp.spatial_vector),
+    particle_f_slots: wp.array(dtype=wp.vec3),
+    body_f_slots: wp.array(dtype=wp.spatial_vector),
 ):
     tid = wp.tid()
 
@@ -870,7 +1045,7 @@ def eval_particle_contacts(
     if tid >= count:
         return
 
-    shape_index = contact_shape[tid]
+    shape_index = int(contact_shape[tid])
     body_index = shape_body[shape_index]
     particle_index = contact_particle[tid]
     if (particle_flags[particle_index] & PARTICLE_FLAG_ACTIVE) == 0:
@@ -892,7 +1067,7 @@ def eval_particle_contacts(
     bx = wp.transform_point(X_wb, contact_body_pos[tid])
     r = bx - wp.transform_point(X_wb, X_com)
 
-    n = contact_normal[tid]
+    n = load_contact_normal(contact_normal, tid)
     c = wp.dot(n, px - bx) - particle_radius[tid]
 
     if c > particle_ka:
@@ -941,10 +1116,10 @@ def eval_particle_contacts(
     f_total = fn + (fd + ft)
     t_total = wp.cross(r, f_total)
 
-    wp.atomic_sub(particle_f, particle_index, f_total)
+    add_particle_force(particle_f, particle_f_slots, tid, particle_index, -f_total)
 
     if body_index >= 0:
-        wp.atomic_add(body_f, body_index, wp.spatial_vector(t_total, f_total))
+        add_body_force(body_f, body_f_slots, tid, body_index, wp.spatial_vector(t_total, f_total))
 
 
 @wp.kernel
@@ -964,6 +1139,7 @@ def eval_rigid_contacts(
     contact_shape1: wp.array(dtype=int),
     # outputs
     body_f: wp.array(dtype=wp.spatial_vector),
+    body_f_slots: wp.array(dtype=wp.spatial_vector),
 ):
     tid = wp.tid()
     if contact_shape0[tid] == contact_shape1[tid]:
@@ -1081,9 +1257,9 @@ def eval_rigid_contacts(
     # print(f_total)
 
     if body_a >= 0:
-        wp.atomic_sub(body_f, body_a, wp.spatial_vector(wp.cross(r_a, f_total), f_total))
+        add_body_force(body_f, body_f_slots, tid * 2 + 0, body_a, -wp.spatial_vector(wp.cross(r_a, f_total), f_total))
     if body_b >= 0:
-        wp.atomic_add(body_f, body_b, wp.spatial_vector(wp.cross(r_b, f_total), f_total))
+        add_body_force(body_f, body_f_slots, tid * 2 + 1, body_b, wp.spatial_vector(wp.cross(r_b, f_total), f_total))
 
 
 @wp.func
@@ -1142,6 +1318,7 @@ def eval_body_joints(
     joint_attach_ke: float,
     joint_attach_kd: float,
     body_f: wp.array(dtype=wp.spatial_vector),
+    body_f_slots: wp.array(dtype=wp.spatial_vector),
 ):
     tid = wp.tid()
     type = joint_type[tid]
@@ -1425,9 +1602,13 @@ def eval_body_joints(
 
     # write forces
     if c_parent >= 0:
-        wp.atomic_add(body_f, c_parent, wp.spatial_vector(t_total + wp.cross(r_p, f_total), f_total))
+        add_body_force(
+            body_f, body_f_slots, tid * 2 + 0, c_parent, wp.spatial_vector(t_total + wp.cross(r_p, f_total), f_total)
+        )
 
-    wp.atomic_sub(body_f, c_child, wp.spatial_vector(t_total + wp.cross(r_c, f_total), f_total))
+    add_body_force(
+        body_f, body_f_slots, tid * 2 + 1, c_child, -wp.spatial_vector(t_total + wp.cross(r_c, f_total), f_total)
+    )
 
 
 @wp.func
@@ -1491,9 +1672,277 @@ def eval_muscles(
         compute_muscle_force(i, body_X_s, body_v_s, body_com, muscle_links, muscle_points, activation, body_f_s)
 
 
-def compute_forces(model, state, particle_f, body_f, requires_grad):
+# evaluates the spring, triangle, bending, tetrahedral and particle ground contact forces in a single
+# launch, each thread handles element tid of every force term whose element count exceeds it, terms
+# are disabled by passing a count of zero
+@wp.kernel
+def eval_particle_forces_fused(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    spring_count: int,
+    spring_indices: wp.array(dtype=int),
+    spring_rest_lengths: wp.array(dtype=float),
+    spring_stiffness: wp.array(dtype=float),
+    spring_damping: wp.array(dtype=float),
+    tri_count: int,
+    tri_indices: wp.array2d(dtype=int),
+    tri_poses: wp.array(dtype=wp.mat22),
+    tri_activations: wp.array(dtype=float),
+    tri_materials: wp.array2d(dtype=float),
+    edge_count: int,
+    edge_indices: wp.array2d(dtype=int),
+    edge_rest_angle: wp.array(dtype=float),
+    edge_bending_properties: wp.array2d(dtype=float),
+    tet_count: int,
+    tet_indices: wp.array2d(dtype=int),
+    tet_poses: wp.array(dtype=wp.mat33),
+    tet_activations: wp.array(dtype=float),
+    tet_materials: wp.array2d(dtype=float),
+    ground_count: int,
+    particle_radius: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    ke: float,
+    kd: float,
+    kf: float,
+    mu: float,
+    ground: wp.array(dtype=float),
+    # outputs
+    f: wp.array(dtype=wp.vec3),
+    spring_f_slots: wp.array(dtype=wp.vec3),
+    tri_f_slots: wp.array(dtype=wp.vec3),
+    edge_f_slots: wp.array(dtype=wp.vec3),
+    tet_f_slots: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    if tid < spring_count:
+        eval_spring(
+            tid, x, v, spring_indices, spring_rest_lengths, spring_stiffness, spring_damping, f, spring_f_slots
+        )
+    if tid < tri_count:
+        eval_triangle(tid, x, v, tri_indices, tri_poses, tri_activations, tri_materials, f, tri_f_slots)
+    if tid < edge_count:
+        eval_bending_edge(tid, x, v, edge_indices, edge_rest_angle, edge_bending_properties, f, edge_f_slots)
+    if tid < tet_count:
+        eval_tetrahedron(tid, x, v, tet_indices, tet_poses, tet_activations, tet_materials, f, tet_f_slots)
+    if tid < ground_count:
+        eval_particle_ground_contact(tid, x, v, particle_radius, particle_flags, ke, kd, kf, mu, ground, f)
+
+
+@wp.kernel
+def rigid_contact_force_keys(
+    contact_count: wp.array(dtype=int),
+    contact_body0: wp.array(dtype=int),
+    contact_body1: wp.array(dtype=int),
+    # outputs
+    keys: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    if tid < contact_count[0]:
+        keys[tid * 2 + 0] = contact_body0[tid]
+        keys[tid * 2 + 1] = contact_body1[tid]
+    else:
+        keys[tid * 2 + 0] = -1
+        keys[tid * 2 + 1] = -1
+
+
+@wp.kernel
+def soft_contact_force_keys(
+    contact_count: wp.array(dtype=int),
+    contact_particle: wp.array(dtype=int),
+    contact_shape: wp.array(dtype=Any),
+    shape_body: wp.array(dtype=int),
+    # outputs
+    particle_keys: wp.array(dtype=int),
+    body_keys: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    if tid < contact_count[0]:
+        particle_keys[tid] = contact_particle[tid]
+        body_keys[tid] = shape_body[int(contact_shape[tid])]
+    else:
+        particle_keys[tid] = -1
+        body_keys[tid] = -1
+
+
+class DeterministicForces:
+    """Per-contribution force slots of the deterministic mode of :func:`compute_forces`
+
+    Instead of atomically adding their forces, the terms store each contribution in its own slot, and the slots are
+    summed into ``particle_f`` and ``body_f`` in a fixed order by :class:`warp.utils.DeterministicScatter`. The keys
+    of the elastic terms and joints are static, the keys of the contacts are sorted again on every evaluation.
+    """
+
+    def __init__(self, model):
+        self.device = model.device
+
+        # particle force slots of the elastic terms, in the slot layout of their kernels
+        counts = [2 * model.spring_count, 3 * model.tri_count, 4 * model.edge_count, 4 * model.tet_count]
+        self.particle_slots = wp.zeros(sum(counts), dtype=wp.vec3, device=self.device)
+        self.spring_slots, self.tri_slots, self.edge_slots, self.tet_slots = self._views(self.particle_slots, counts)
+
+        indices = [
+            model.spring_indices.numpy().flatten()[: counts[0]] if counts[0] else None,
+            model.tri_indices.numpy().flatten() if counts[1] else None,
+            model.edge_indices.numpy().flatten() if counts[2] else None,
+            model.tet_indices.numpy().flatten() if counts[3] else None,
+        ]
+        keys = np.concatenate([np.zeros(0, dtype=np.int32)] + [i.astype(np.int32) for i in indices if i is not None])
+        self.particle_scatter = wp.utils.DeterministicScatter(
+            wp.array(keys, dtype=int, device=self.device), model.particle_count
+        )
+
+        # joint slots hold the parent and child wrenches of each joint
+        self.joint_slots = wp.zeros(2 * model.joint_count, dtype=wp.spatial_vector, device=self.device)
+        keys = np.zeros(2 * model.joint_count, dtype=np.int32)
+        if model.joint_count:
+            keys[0::2] = model.joint_parent.numpy()
+            keys[1::2] = model.joint_child.numpy()
+        self.joint_scatter = wp.utils.DeterministicScatter(
+            wp.array(keys, dtype=int, device=self.device), model.body_count
+        )
+
+        self.rigid_contact_max = None
+        self.soft_contact_max = None
+
+    @staticmethod
+    def _views(slots, counts):
+        views = []
+        start = 0
+        for count in counts:
+            views.append(slots[start : start + count] if count else None)
+            start += count
+        return views
+
+    def _update_contacts(self, model):
+        # the contact buffers may be reallocated by the collision detection
+        if self.rigid_contact_max != model.rigid_contact_max:
+            self.rigid_contact_max = model.rigid_contact_max
+            self.rigid_contact_slots = wp.zeros(
+                2 * model.rigid_contact_max, dtype=wp.spatial_vector, device=self.device
+            )
+            self.rigid_contact_keys = wp.full(2 * model.rigid_contact_max, -1, dtype=int, device=self.device)
+            self.rigid_contact_scatter = wp.utils.DeterministicScatter(self.rigid_contact_keys, model.body_count)
+
+        if self.soft_contact_max != model.soft_contact_max:
+            self.soft_contact_max = model.soft_contact_max
+            self.soft_contact_particle_slots = wp.zeros(model.soft_contact_max, dtype=wp.vec3, device=self.device)
+            self.soft_contact_body_slots = wp.zeros(
+                model.soft_contact_max, dtype=wp.spatial_vector, device=self.device
+            )
+            self.soft_contact_particle_keys = wp.full(model.soft_contact_max, -1, dtype=int, device=self.device)
+            self.soft_contact_body_keys = wp.full(model.soft_contact_max, -1, dtype=int, device=self.device)
+            self.soft_contact_particle_scatter = wp.utils.DeterministicScatter(
+                self.soft_contact_particle_keys, model.particle_count
+            )
+            self.soft_contact_body_scatter = wp.utils.DeterministicScatter(
+                self.soft_contact_body_keys, model.body_count
+            )
+
+        if model.rigid_contact_max:
+            wp.launch(
+                kernel=rigid_contact_force_keys,
+                dim=model.rigid_contact_max,
+                inputs=[model.rigid_contact_count, model.rigid_contact_body0, model.rigid_contact_body1],
+                outputs=[self.rigid_contact_keys],
+                device=self.device,
+            )
+            self.rigid_contact_scatter.update(self.rigid_contact_keys)
+
+        if model.soft_contact_max and model.particle_count and model.shape_count > 1:
+            wp.launch(
+                kernel=soft_contact_force_keys,
+                dim=model.soft_contact_max,
+                inputs=[
+                    model.soft_contact_count,
+                    model.soft_contact_particle,
+                    model.soft_contact_shape,
+                    model.shape_body,
+                ],
+                outputs=[self.soft_contact_particle_keys, self.soft_contact_body_keys],
+                device=self.device,
+            )
+            self.soft_contact_particle_scatter.update(self.soft_contact_particle_keys)
+            self.soft_contact_body_scatter.update(self.soft_contact_body_keys)
+
+    def begin(self, model):
+        """Clears the slots and sorts the contacts of the current step"""
+        self._update_contacts(model)
+
+        # the threads that exit early leave their slots untouched
+        self.particle_slots.zero_()
+        self.joint_slots.zero_()
+        self.rigid_contact_slots.zero_()
+        self.soft_contact_particle_slots.zero_()
+        self.soft_contact_body_slots.zero_()
+
+    @staticmethod
+    def get(model):
+        """Returns the slots of the model, created on first use"""
+        forces = model.__dict__.get("_deterministic_forces")
+        if forces is None:
+            forces = DeterministicForces(model)
+            model.__dict__["_deterministic_forces"] = forces
+        return forces
+
+
+def compute_particle_forces_fused(model, state, particle_f, forces=None):
+    ground_count = model.particle_count if model.ground else 0
+    dim = max(model.spring_count, model.tri_count, model.edge_count, model.tet_count, ground_count)
+    if dim == 0:
+        return
+
+    # the arrays of disabled terms are passed as NULL since they may not have the expected dimensions
+    def term(count, *arrays):
+        return [count] + [a if count else None for a in arrays]
+
+    wp.launch(
+        kernel=eval_particle_forces_fused,
+        dim=dim,
+        inputs=[
+            state.particle_q,
+            state.particle_qd,
+            *term(
+                model.spring_count,
+                model.spring_indices,
+                model.spring_rest_length,
+                model.spring_stiffness,
+                model.spring_damping,
+            ),
+            *term(model.tri_count, model.tri_indices, model.tri_poses, model.tri_activations, model.tri_materials),
+            *term(model.edge_count, model.edge_indices, model.edge_rest_angle, model.edge_bending_properties),
+            *term(model.tet_count, model.tet_indices, model.tet_poses, model.tet_activations, model.tet_materials),
+            *term(ground_count, model.particle_radius, model.particle_flags),
+            model.soft_contact_ke,
+            model.soft_contact_kd,
+            model.soft_contact_kf,
+            model.soft_contact_mu,
+            model.ground_plane if ground_count else None,
+        ],
+        outputs=[
+            particle_f,
+            *([forces.spring_slots, forces.tri_slots, forces.edge_slots, forces.tet_slots] if forces else [None] * 4),
+        ],
+        device=model.device,
+    )
+
+
+def compute_forces(model, state, particle_f, body_f, requires_grad, fuse_particle_forces=False, deterministic=False):
+    # in deterministic mode the forces of the terms that accumulate into shared particles and bodies are stored per
+    # contribution and summed in a fixed order, the other terms only write the forces of their own thread
+    forces = None
+    if deterministic:
+        forces = DeterministicForces.get(model)
+        forces.begin(model)
+
+    def slots(name):
+        return getattr(forces, name) if forces else None
+
+    if fuse_particle_forces:
+        compute_particle_forces_fused(model, state, particle_f, forces)
+
     # damped springs
-    if model.spring_count:
+    if model.spring_count and not fuse_particle_forces:
         wp.launch(
             kernel=eval_springs,
             dim=model.spring_count,
@@ -1505,7 +1954,7 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.spring_stiffness,
                 model.spring_damping,
             ],
-            outputs=[particle_f],
+            outputs=[particle_f, slots("spring_slots")],
             device=model.device,
         )
 
@@ -1514,7 +1963,7 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
         eval_particle_forces(model, state, particle_f)
 
     # triangle elastic and lift/drag forces
-    if model.tri_count:
+    if model.tri_count and not fuse_particle_forces:
         wp.launch(
             kernel=eval_triangles,
             dim=model.tri_count,
@@ -1526,7 +1975,7 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.tri_activations,
                 model.tri_materials,
             ],
-            outputs=[particle_f],
+            outputs=[particle_f, slots("tri_slots")],
             device=model.device,
         )
 
@@ -1549,7 +1998,7 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
         )
 
     # triangle bending
-    if model.edge_count:
+    if model.edge_count and not fuse_particle_forces:
         wp.launch(
             kernel=eval_bending,
             dim=model.edge_count,
@@ -1560,12 +2009,12 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.edge_rest_angle,
                 model.edge_bending_properties,
             ],
-            outputs=[particle_f],
+            outputs=[particle_f, slots("edge_slots")],
             device=model.device,
         )
 
     # particle ground contact
-    if model.ground and model.particle_count:
+    if model.ground and model.particle_count and not fuse_particle_forces:
         wp.launch(
             kernel=eval_particle_ground_contacts,
             dim=model.particle_count,
@@ -1585,7 +2034,7 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
         )
 
     # tetrahedral FEM
-    if model.tet_count:
+    if model.tet_count and not fuse_particle_forces:
         wp.launch(
             kernel=eval_tetrahedra,
             dim=model.tet_count,
@@ -1597,10 +2046,13 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.tet_activations,
                 model.tet_materials,
             ],
-            outputs=[particle_f],
+            outputs=[particle_f, slots("tet_slots")],
             device=model.device,
         )
 
+    if forces:
+        forces.particle_scatter.add(forces.particle_slots, particle_f)
+
     if model.rigid_contact_max and (
         model.ground and model.shape_ground_contact_pair_count or model.shape_contact_pair_count
     ):
@@ -1622,10 +2074,13 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.rigid_contact_shape0,
                 model.rigid_contact_shape1,
             ],
-            outputs=[body_f],
+            outputs=[body_f, slots("rigid_contact_slots")],
             device=model.device,
         )
 
+        if forces:
+            forces.rigid_contact_scatter.add(forces.rigid_contact_slots, body_f)
+
     if model.joint_count:
         wp.launch(
             kernel=eval_body_joints,
@@ -1656,10 +2111,13 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.joint_attach_ke,
                 model.joint_attach_kd,
             ],
-            outputs=[body_f],
+            outputs=[body_f, slots("joint_slots")],
             device=model.device,
         )
 
+        if forces:
+            forces.joint_scatter.add(forces.joint_slots, body_f)
+
     # particle shape contact
     if model.particle_count and model.shape_count > 1:
         wp.launch(
@@ -1689,10 +2147,14 @@ def compute_forces(model, state, particle_f, body_f, requires_grad):
                 model.soft_contact_max,
             ],
             # outputs
-            outputs=[particle_f, body_f],
+            outputs=[particle_f, body_f, slots("soft_contact_particle_slots"), slots("soft_contact_body_slots")],
             device=model.device,
         )
 
+        if forces:
+            forces.soft_contact_particle_scatter.add(forces.soft_contact_particle_slots, particle_f)
+            forces.soft_contact_body_scatter.add(forces.soft_contact_body_slots, body_f)
+
     # evaluate muscle actuation
     if False and model.muscle_count:
         wp.launch(
@@ -1772,10 +2234,33 @@ class SemiImplicitIntegrator:
         for i in range(100):
             state = integrator.simulate(model, state_in, state_out, dt)
 
+    For small models the cost of a step is dominated by the kernel launches, with ``fuse_particle_forces``
+    the spring, triangle, bending, tetrahedral and particle ground contact forces are evaluated by a single
+    kernel, and :func:`capture_substeps` records a number of substeps into a CUDA graph:
+
+    .. code-block:: python
+
+        integrator = wp.sim.SemiImplicitIntegrator(fuse_particle_forces=True)
+        graph = integrator.capture_substeps(model, state_0, state_1, dt, substeps=16)
+
+        for i in range(100):
+            wp.capture_launch(graph)
+
+    When the model was built with ``ModelBuilder.body_sleep``, only the bodies of awake islands are integrated,
+    see :func:`Model.update_active_bodies`.
+
+    With ``deterministic`` (defaults to ``wp.config.deterministic``) the spring, triangle, bending, tetrahedral,
+    joint and contact forces are summed per particle and body in a fixed order instead of with atomics, so that
+    repeated runs are bitwise identical. This costs a sort of the contacts and an extra pass over the forces per
+    step, and is meant for debugging and reproducible experiments rather than for gradients, since the force slots
+    are not differentiated. Triangle self-contacts are still accumulated with atomics.
+
     """
 
-    def __init__(self, angular_damping=0.05):
+    def __init__(self, angular_damping=0.05, fuse_particle_forces=False, deterministic=None):
         self.angular_damping = angular_damping
+        self.fuse_particle_forces = fuse_particle_forces
+        self.deterministic = wp.config.deterministic if deterministic is None else deterministic
 
     def simulate(self, model, state_in, state_out, dt, requires_grad=False):
         with wp.ScopedTimer("simulate", False):
@@ -1788,16 +2273,29 @@ class SemiImplicitIntegrator:
             if state_in.body_count:
                 body_f = state_in.body_f
 
-            compute_forces(model, state_in, particle_f, body_f, requires_grad=requires_grad)
+            compute_forces(
+                model,
+                state_in,
+                particle_f,
+                body_f,
+                requires_grad=requires_grad,
+                fuse_particle_forces=self.fuse_particle_forces,
+                deterministic=self.deterministic,
+            )
 
             # -------------------------------------
             # integrate bodies
 
-            if model.body_count:
+            if model.body_count and model.body_island is not None:
+                # the launch covers all bodies so that it can be captured, the threads past the active bodies
+                # of the compacted list exit right away
+                model.update_active_bodies(state_in, state_out, dt)
                 wp.launch(
-                    kernel=integrate_bodies,
+                    kernel=integrate_active_bodies,
                     dim=model.body_count,
                     inputs=[
+                        model.body_active_indices,
+                        model.body_active_count,
                         state_in.body_q,
                         state_in.body_qd,
                         state_in.body_f,
@@ -1813,30 +2311,307 @@ class SemiImplicitIntegrator:
                     outputs=[state_out.body_q, state_out.body_qd],
                     device=model.device,
                 )
-
-            # ----------------------------
-            # integrate particles
-
-            if model.particle_count:
+            elif model.body_count:
                 wp.launch(
-                    kernel=integrate_particles,
-                    dim=model.particle_count,
+                    kernel=integrate_bodies,
+                    dim=model.body_count,
                     inputs=[
-                        state_in.particle_q,
-                        state_in.particle_qd,
-                        state_in.particle_f,
-                        model.particle_inv_mass,
-                        model.particle_flags,
+                        state_in.body_q,
+                        state_in.body_qd,
+                        state_in.body_f,
+                        model.body_com,
+                        model.body_mass,
+                        model.body_inertia,
+                        model.body_inv_mass,
+                        model.body_inv_inertia,
                         model.gravity,
+                        self.angular_damping,
                         dt,
-                        model.particle_max_velocity,
                     ],
-                    outputs=[state_out.particle_q, state_out.particle_qd],
+                    outputs=[state_out.body_q, state_out.body_qd],
                     device=model.device,
                 )
 
+            # ----------------------------
+            # integrate particles
+
+            if model.particle_count:
+                self.integrate_particles(model, state_in, state_out, dt)
+
             return state_out
 
+    def integrate_particles(self, model, state_in, state_out, dt):
+        wp.launch(
+            kernel=integrate_particles,
+            dim=model.particle_count,
+            inputs=[
+                state_in.particle_q,
+                state_in.particle_qd,
+                state_in.particle_f,
+                model.particle_inv_mass,
+                model.particle_flags,
+                model.gravity,
+                dt,
+                model.particle_max_velocity,
+            ],
+            outputs=[state_out.particle_q, state_out.particle_qd],
+            device=model.device,
+        )
+
+    def simulate_substeps(self, model, state_0, state_1, dt, substeps, collide=False):
+        """
+        Advances ``state_0`` by a number of substeps of size ``dt``, using ``state_1`` as the intermediate
+        state, the result is always written to ``state_0`` so that the launches can be replayed from a graph.
+
+        Args:
+            model: The model to simulate
+            state_0: The state to advance
+            state_1: An intermediate state of the same model
+            dt: The substep size
+            substeps: The number of substeps
+            collide: Whether to update the contacts with :func:`warp.sim.collide` before each substep
+        """
+        from .collide import collide as collide_fn
+
+        for _ in range(substeps):
+            state_0.clear_forces()
+            if collide:
+                collide_fn(model, state_0)
+            self.simulate(model, state_0, state_1, dt)
+            state_0, state_1 = state_1, state_0
+
+        if substeps % 2:
+            # the result of an odd number of substeps is in the intermediate state
+            for name in ("particle_q", "particle_qd", "body_q", "body_qd"):
+                src = getattr(state_0, name, None)
+                if src is not None:
+                    wp.copy(getattr(state_1, name), src)
+
+    def capture_substeps(self, model, state_0, state_1, dt, substeps, collide=False):
+        """
+        Records :func:`simulate_substeps` into a CUDA graph on the model's device, each launch of the
+        returned graph with :func:`warp.capture_launch` advances ``state_0`` by ``substeps`` substeps.
+        """
+        wp.capture_begin(model.device)
+        self.simulate_substeps(model, state_0, state_1, dt, substeps, collide=collide)
+        return wp.capture_end(model.device)
+
+
+@wp.func
+def particle_is_fixed(tid: int, particle_inv_mass: wp.array(dtype=float), particle_flags: wp.array(dtype=wp.uint32)):
+    return particle_inv_mass[tid] == 0.0 or (particle_flags[tid] & PARTICLE_FLAG_ACTIVE) == 0
+
+
+@wp.kernel
+def eval_implicit_mass_blocks(
+    particle_f: wp.array(dtype=wp.vec3),
+    particle_mass: wp.array(dtype=float),
+    particle_inv_mass: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    gravity: wp.vec3,
+    dt: float,
+    # outputs
+    values: wp.array(dtype=wp.mat33),
+    rhs: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    # velocity changes of fixed particles are constrained to zero by an identity row
+    if particle_is_fixed(tid, particle_inv_mass, particle_flags):
+        values[tid] = wp.identity(n=3, dtype=float)
+        rhs[tid] = wp.vec3()
+        return
+
+    m = particle_mass[tid]
+    values[tid] = wp.identity(n=3, dtype=float) * m
+    rhs[tid] = (particle_f[tid] + gravity * m) * dt
+
+
+@wp.kernel
+def eval_spring_hessian_blocks(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    spring_indices: wp.array(dtype=int),
+    spring_rest_lengths: wp.array(dtype=float),
+    spring_stiffness: wp.array(dtype=float),
+    spring_damping: wp.array(dtype=float),
+    particle_inv_mass: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    particle_count: int,
+    dt: float,
+    # outputs
+    values: wp.array(dtype=wp.mat33),
+    rhs: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    i = spring_indices[tid * 2 + 0]
+    j = spring_indices[tid * 2 + 1]
+
+    xij = x[i] - x[j]
+    vij = v[i] - v[j]
+
+    l = wp.length(xij)
+    dir = xij / wp.max(l, 1.0e-9)
+    nn = wp.outer(dir, dir)
+
+    # stiffness block -df_i/dx_i, the transverse term of compressed springs is dropped to keep it definite
+    stretch = wp.max(1.0 - spring_rest_lengths[tid] / wp.max(l, 1.0e-9), 0.0)
+    K = (nn + (wp.identity(n=3, dtype=float) - nn) * stretch) * spring_stiffness[tid]
+    H = K * (dt * dt) + nn * (spring_damping[tid] * dt)
+
+    fixed_i = particle_is_fixed(i, particle_inv_mass, particle_flags)
+    fixed_j = particle_is_fixed(j, particle_inv_mass, particle_flags)
+
+    # the blocks of spring s are the triplets (i, i), (j, j), (i, j), (j, i) after the particle mass blocks
+    base = particle_count + tid * 4
+    zero = wp.mat33()
+    values[base + 0] = wp.select(fixed_i, H, zero)
+    values[base + 1] = wp.select(fixed_j, H, zero)
+    values[base + 2] = wp.select(fixed_i or fixed_j, -H, zero)
+    values[base + 3] = wp.select(fixed_i or fixed_j, -H, zero)
+
+    # force change from advancing the positions with the current velocities, dt^2 * df/dx * v
+    r = K * vij * (dt * dt)
+    if not fixed_i:
+        wp.atomic_sub(rhs, i, r)
+    if not fixed_j:
+        wp.atomic_add(rhs, j, r)
+
+
+@wp.kernel
+def integrate_particles_implicit(
+    x: wp.array(dtype=wp.vec3),
+    v: wp.array(dtype=wp.vec3),
+    dv: wp.array(dtype=wp.vec3),
+    particle_flags: wp.array(dtype=wp.uint32),
+    dt: float,
+    v_max: float,
+    x_new: wp.array(dtype=wp.vec3),
+    v_new: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    if (particle_flags[tid] & PARTICLE_FLAG_ACTIVE) == 0:
+        return
+
+    v1 = v[tid] + dv[tid]
+    v1_mag = wp.length(v1)
+    if v1_mag > v_max:
+        v1 *= v_max / v1_mag
+
+    x_new[tid] = x[tid] + v1 * dt
+    v_new[tid] = v1
+
+
+class ImplicitEulerIntegrator(SemiImplicitIntegrator):
+    """A linearized backward Euler integrator for particles connected by springs (Baraff and Witkin, 1998)
+
+    Each step solves ``(M + dt D + dt^2 K) dv = dt (f + dt (df/dx) v)`` for the change of the particle
+    velocities with the conjugate gradient method, where the spring stiffness ``K`` and damping ``D``
+    blocks are assembled into a :class:`warp.sparse.BsrMatrix` of 3x3 blocks. Springs are integrated
+    implicitly, while the remaining particle forces and the rigid bodies are integrated as in
+    :class:`SemiImplicitIntegrator`, so that stiff spring cloth can take much larger steps.
+
+    Example
+    -------
+
+    .. code-block:: python
+
+        integrator = wp.sim.ImplicitEulerIntegrator(model)
+
+        # simulation loop
+        for i in range(100):
+            state = integrator.simulate(model, state_in, state_out, dt)
+
+    """
+
+    def __init__(self, model, max_iters=32, tol=1.0e-6, angular_damping=0.05):
+        super().__init__(angular_damping=angular_damping)
+        self.max_iters = max_iters
+        self.tol = tol
+
+        n = model.particle_count
+        springs = model.spring_indices.numpy().reshape(-1, 2) if model.spring_count else np.zeros((0, 2), dtype=int)
+        i, j = springs[:, 0], springs[:, 1]
+
+        # one mass block per particle followed by four blocks per spring
+        rows = np.concatenate([np.arange(n), np.stack([i, j, i, j], axis=1).flatten()])
+        cols = np.concatenate([np.arange(n), np.stack([i, j, j, i], axis=1).flatten()])
+
+        self.rows = wp.array(rows, dtype=int, device=model.device)
+        self.cols = wp.array(cols, dtype=int, device=model.device)
+        self.values = wp.zeros(len(rows), dtype=wp.mat33, device=model.device)
+        self.topology = BsrTripletsTopology()
+        self.A = bsr_zeros(n, n, wp.mat33, device=model.device)
+
+        self.rhs = wp.zeros(n, dtype=wp.vec3, device=model.device)
+        self.dv = wp.zeros(n, dtype=wp.vec3, device=model.device)
+
+    def integrate_particles(self, model, state_in, state_out, dt):
+        wp.launch(
+            kernel=eval_implicit_mass_blocks,
+            dim=model.particle_count,
+            inputs=[
+                state_in.particle_f,
+                model.particle_mass,
+                model.particle_inv_mass,
+                model.particle_flags,
+                model.gravity,
+                dt,
+            ],
+            outputs=[self.values, self.rhs],
+            device=model.device,
+        )
+
+        if model.spring_count:
+            wp.launch(
+                kernel=eval_spring_hessian_blocks,
+                dim=model.spring_count,
+                inputs=[
+                    state_in.particle_q,
+                    state_in.particle_qd,
+                    model.spring_indices,
+                    model.spring_rest_length,
+                    model.spring_stiffness,
+                    model.spring_damping,
+                    model.particle_inv_mass,
+                    model.particle_flags,
+                    model.particle_count,
+                    dt,
+                ],
+                outputs=[self.values, self.rhs],
+                device=model.device,
+            )
+
+        bsr_set_from_triplets(self.A, self.rows, self.cols, self.values, topology=self.topology)
+
+        # a fixed number of iterations keeps the solve free of host synchronization
+        self.dv.zero_()
+        cg(
+            self.A,
+            self.rhs,
+            self.dv,
+            tol=self.tol,
+            maxiter=self.max_iters,
+            M=preconditioner(self.A, "block_diag"),
+            check_every=0,
+        )
+
+        wp.launch(
+            kernel=integrate_particles_implicit,
+            dim=model.particle_count,
+            inputs=[
+                state_in.particle_q,
+                state_in.particle_qd,
+                self.dv,
+                model.particle_flags,
+                dt,
+                model.particle_max_velocity,
+            ],
+            outputs=[state_out.particle_q, state_out.particle_qd],
+            device=model.device,
+        )
+
 
 @wp.kernel
 def compute_particle_residual(
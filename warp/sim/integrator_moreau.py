@@ -10,8 +10,10 @@ models + state forward in time.
 
 """
 
+import numpy as np
 import torch
 import warp as wp
+import warp.sparse as sparse
 from .model import ModelShapeGeometry, ModelShapeMaterials
 
 
@@ -1657,6 +1659,92 @@ def create_matrix(
         A[A_start[tid] + i + 198] = a_12[a_start[tid] + i]
 
 
+@wp.func
+def project_friction_cone(p: wp.vec3, mu: float):
+    # percussions with a negative normal (y) part are released, tangential parts are clamped to the cone
+    if p[1] <= 0.0:
+        return wp.vec3(0.0, 0.0, 0.0)
+
+    fm = wp.sqrt(p[0] * p[0] + p[2] * p[2])  # friction magnitude
+    if mu * p[1] < fm:
+        return wp.vec3(p[0] * mu * p[1] / fm, p[1], p[2] * mu * p[1] / fm)
+    return p
+
+
+@wp.kernel
+def eval_delassus_inv_diag(G_diag: wp.array(dtype=wp.mat33), G_inv_diag: wp.array(dtype=wp.mat33)):
+    tid = wp.tid()
+
+    # contacts whose Jacobian vanishes get a zero percussion
+    G_ii = G_diag[tid]
+    if wp.abs(wp.determinant(G_ii)) > 1.0e-12:
+        G_inv_diag[tid] = wp.inverse(G_ii)
+    else:
+        G_inv_diag[tid] = wp.mat33()
+
+
+@wp.kernel
+def init_percussion(
+    G_inv_diag: wp.array(dtype=wp.mat33),
+    c_vec: wp.array(dtype=wp.vec3),
+    percussion_prev: wp.array(dtype=wp.vec3),
+    warm_start: int,
+    mu: float,
+    percussion: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    if warm_start:
+        p = percussion_prev[tid]
+    else:
+        # steady state of each contact on its own
+        p = -(G_inv_diag[tid] * c_vec[tid])
+
+    percussion[tid] = project_friction_cone(p, mu)
+
+
+@wp.kernel
+def pgs_island_iteration(
+    island_rows: int,
+    G_offsets: wp.array(dtype=int),
+    G_columns: wp.array(dtype=int),
+    G_values: wp.array(dtype=wp.mat33),
+    G_inv_diag: wp.array(dtype=wp.mat33),
+    c_vec: wp.array(dtype=wp.vec3),
+    mu: float,
+    iterations: int,
+    relaxation: float,
+    percussion: wp.array(dtype=wp.vec3),
+):
+    # islands don't share dofs, so they are swept in parallel and the contacts of an island in sequence
+    tid = wp.tid()
+    row_start = tid * island_rows
+
+    for it in range(iterations):
+        for row in range(row_start, row_start + island_rows):
+            r = c_vec[row]
+            for k in range(G_offsets[row], G_offsets[row + 1]):
+                r += G_values[k] * percussion[G_columns[k]]
+
+            p = percussion[row] - relaxation * (G_inv_diag[row] * r)
+            percussion[row] = project_friction_cone(p, mu)
+
+
+@wp.kernel
+def jacobi_iteration(
+    G_p: wp.array(dtype=wp.vec3),
+    G_inv_diag: wp.array(dtype=wp.mat33),
+    c_vec: wp.array(dtype=wp.vec3),
+    mu: float,
+    relaxation: float,
+    percussion: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    p = percussion[tid] - relaxation * (G_inv_diag[tid] * (G_p[tid] + c_vec[tid]))
+    percussion[tid] = project_friction_cone(p, mu)
+
+
 ##########################
 
 ###  INTEGRATOR CLASS  ###
@@ -1665,8 +1753,27 @@ def create_matrix(
 
 
 class MoreauIntegrator:
-    def __init__(self):
-        pass
+    """Moreau time-stepping of articulations with contacts resolved as percussions
+
+    The contacts are resolved by :meth:`simulate` according to its ``mode``:
+
+        * ``"hard"`` and ``"soft"``: fixed point iterations on the dense Delassus blocks of each articulation
+        * ``"pgs"``: projected Gauss-Seidel sweeps, the articulations in parallel and their contacts in sequence
+        * ``"jacobi"``: projected Jacobi iterations over all the contacts at once
+
+    The ``"pgs"`` and ``"jacobi"`` modes assemble the Delassus operator ``G = Jc*H^-1*Jc^T`` of all the contacts as a
+    :class:`warp.sparse.BsrMatrix` of 3x3 blocks that is block diagonal by articulation, whose sparsity is computed
+    once. They start from the percussions of the previous step when ``warm_start`` is set, so that resting
+    contacts converge in a few iterations, and scale their updates by ``relaxation``.
+    """
+
+    def __init__(self, warm_start=True, relaxation=1.0):
+        self.warm_start = warm_start
+        self.relaxation = relaxation
+
+        self.delassus = None
+        self.delassus_topology = sparse.BsrTripletsTopology()
+        self.percussion_prev = None
 
     def simulate(
         self,
@@ -2374,10 +2481,97 @@ class MoreauIntegrator:
             device=model.device,
         )
 
+    def assemble_delassus(self, model):
+        # G_mat holds the dense blocks between the contacts of each articulation
+        articulation_count, contact_count = model.G_mat.shape[0], model.G_mat.shape[1]
+        row_count = articulation_count * contact_count
+
+        if self.delassus is None or self.delassus.nrow != row_count:
+            self.delassus = sparse.bsr_zeros(row_count, row_count, wp.mat33, device=model.device)
+            self.delassus_topology = sparse.BsrTripletsTopology()
+
+            local = np.arange(contact_count)
+            offsets = np.arange(articulation_count)[:, None, None] * contact_count
+            rows = (offsets + local[None, :, None]).repeat(contact_count, axis=2)
+            cols = (offsets + local[None, None, :]).repeat(contact_count, axis=1)
+            self.delassus_rows = wp.array(rows.flatten(), dtype=int, device=model.device)
+            self.delassus_cols = wp.array(cols.flatten(), dtype=int, device=model.device)
+            self.delassus_diag = wp.zeros(row_count, dtype=wp.mat33, device=model.device)
+            self.delassus_inv_diag = wp.empty(row_count, dtype=wp.mat33, device=model.device)
+            self.delassus_G_p = wp.empty(row_count, dtype=wp.vec3, device=model.device)
+
+        sparse.bsr_set_from_triplets(
+            self.delassus,
+            self.delassus_rows,
+            self.delassus_cols,
+            model.G_mat.flatten(),
+            topology=self.delassus_topology,
+        )
+
+        wp.launch(
+            kernel=eval_delassus_inv_diag,
+            dim=row_count,
+            inputs=[sparse.bsr_get_diag(self.delassus, out=self.delassus_diag)],
+            outputs=[self.delassus_inv_diag],
+            device=model.device,
+        )
+
+    def solve_contacts(self, model, state_mid, mu, iterations, mode):
+        self.assemble_delassus(model)
+
+        c_vec = state_mid.c_vec.flatten()
+        percussion = state_mid.percussion.flatten()
+        row_count = self.delassus.nrow
+
+        warm_start = self.warm_start and self.percussion_prev is not None
+        if self.percussion_prev is None or self.percussion_prev.shape[0] != row_count:
+            self.percussion_prev = wp.zeros(row_count, dtype=wp.vec3, device=model.device)
+
+        wp.launch(
+            kernel=init_percussion,
+            dim=row_count,
+            inputs=[self.delassus_inv_diag, c_vec, self.percussion_prev, int(warm_start), mu],
+            outputs=[percussion],
+            device=model.device,
+        )
+
+        if mode == "pgs":
+            wp.launch(
+                kernel=pgs_island_iteration,
+                dim=model.articulation_count,
+                inputs=[
+                    row_count // model.articulation_count,
+                    self.delassus.offsets,
+                    self.delassus.columns,
+                    self.delassus.values,
+                    self.delassus_inv_diag,
+                    c_vec,
+                    mu,
+                    iterations,
+                    self.relaxation,
+                ],
+                outputs=[percussion],
+                device=model.device,
+            )
+        else:
+            for _ in range(iterations):
+                sparse.bsr_mv(self.delassus, percussion, self.delassus_G_p)
+                wp.launch(
+                    kernel=jacobi_iteration,
+                    dim=row_count,
+                    inputs=[self.delassus_G_p, self.delassus_inv_diag, c_vec, mu, self.relaxation],
+                    outputs=[percussion],
+                    device=model.device,
+                )
+
+        wp.copy(self.percussion_prev, percussion)
+
     def eval_contact_forces(self, model, state_mid, dt, mu, prox_iter, mode):
         # prox iteration
         # kernel 7
-        if mode == "hard":
+        if mode == "pgs" or mode == "jacobi":
+            self.solve_contacts(model, state_mid, mu, prox_iter, mode)
+        elif mode == "hard":
             wp.launch(
                 kernel=prox_iteration_unrolled,
                 dim=model.articulation_count,
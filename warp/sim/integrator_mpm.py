@@ -0,0 +1,691 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+"""A material point method (MPM) integrator for continua such as snow, sand and soil
+
+Particles carry the mass, velocity, deformation gradient and APIC affine velocity of the material, and each step
+transfers them to a background grid (P2G), solves the momentum on the grid, and transfers the grid velocities back
+to the particles (G2P), using the MLS-MPM formulation with quadratic B-spline weights.
+
+The grid is sparse: it only stores the blocks of 4x4x4 nodes touched by particles. Each step sorts the particles by
+block, which both finds the occupied blocks and orders the P2G scatter so that the threads of a warp add to the same
+nodes, then lists the blocks with their neighbors, whose sorted keys are searched to map grid coordinates to nodes.
+"""
+
+import numpy as np
+
+import warp as wp
+from warp.utils import radix_sort_pairs, runlength_encode
+
+from .model import PARTICLE_FLAG_ACTIVE
+
+MPM_MATERIAL_ELASTIC = wp.constant(0)
+MPM_MATERIAL_SNOW = wp.constant(1)
+MPM_MATERIAL_SAND = wp.constant(2)
+
+# nodes per block side, block coordinates use 10 bits per axis in the sort keys
+MPM_BLOCK_SIZE = wp.constant(4)
+MPM_BLOCK_NODES = wp.constant(64)
+MPM_BLOCK_ORIGIN = wp.constant(512)
+MPM_BLOCK_MAX = wp.constant(1023)
+MPM_BLOCK_KEY_BITS = 30
+
+
+@wp.func
+def mpm_block_key(bx: int, by: int, bz: int):
+    bx = wp.clamp(bx + MPM_BLOCK_ORIGIN, 0, MPM_BLOCK_MAX)
+    by = wp.clamp(by + MPM_BLOCK_ORIGIN, 0, MPM_BLOCK_MAX)
+    bz = wp.clamp(bz + MPM_BLOCK_ORIGIN, 0, MPM_BLOCK_MAX)
+    return (bx << 20) | (by << 10) | bz
+
+
+@wp.func
+def mpm_node_base(x: wp.vec3, inv_dx: float):
+    # lowest node of the 3x3x3 stencil of a particle, offset so that divisions by the block size round down,
+    # and clamped so that the stencil and the blocks next to it stay within the key range
+    origin = MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE
+    hi = (MPM_BLOCK_MAX - 1) * MPM_BLOCK_SIZE
+    return wp.vec3i(
+        wp.clamp(int(wp.floor(x[0] * inv_dx - 0.5)) + origin, 0, hi),
+        wp.clamp(int(wp.floor(x[1] * inv_dx - 0.5)) + origin, 0, hi),
+        wp.clamp(int(wp.floor(x[2] * inv_dx - 0.5)) + origin, 0, hi),
+    )
+
+
+@wp.func
+def mpm_find_block(keys: wp.array(dtype=int), count: int, key: int):
+    # index of key in the first count sorted keys, or -1
+    lo = int(0)
+    hi = count
+    while lo < hi:
+        mid = (lo + hi) // 2
+        if keys[mid] < key:
+            lo = mid + 1
+        else:
+            hi = mid
+    if lo < count:
+        if keys[lo] == key:
+            return lo
+    return -1
+
+
+@wp.func
+def mpm_weights(fx: float):
+    # quadratic B-spline weights of the three nodes around a particle at fx from the first one, in cells
+    return wp.vec3(
+        0.5 * (1.5 - fx) * (1.5 - fx),
+        0.75 - (fx - 1.0) * (fx - 1.0),
+        0.5 * (fx - 0.5) * (fx - 0.5),
+    )
+
+
+@wp.kernel
+def mpm_particle_keys(
+    particle_q: wp.array(dtype=wp.vec3),
+    inv_dx: float,
+    keys: wp.array(dtype=int),
+    ids: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    base = mpm_node_base(particle_q[tid], inv_dx)
+    keys[tid] = mpm_block_key(
+        base[0] // MPM_BLOCK_SIZE - MPM_BLOCK_ORIGIN,
+        base[1] // MPM_BLOCK_SIZE - MPM_BLOCK_ORIGIN,
+        base[2] // MPM_BLOCK_SIZE - MPM_BLOCK_ORIGIN,
+    )
+    ids[tid] = tid
+
+
+@wp.kernel
+def mpm_expand_blocks(
+    unique_keys: wp.array(dtype=int),
+    expanded_keys: wp.array(dtype=int),
+    expanded_ids: wp.array(dtype=int),
+):
+    # the stencil of a particle reaches at most one block further along each axis
+    tid = wp.tid()
+    u = tid // 8
+    k = tid - u * 8
+
+    key = unique_keys[u]
+    bx = ((key >> 20) & MPM_BLOCK_MAX) + (k & 1)
+    by = ((key >> 10) & MPM_BLOCK_MAX) + ((k >> 1) & 1)
+    bz = (key & MPM_BLOCK_MAX) + ((k >> 2) & 1)
+    expanded_keys[tid] = mpm_block_key(bx - MPM_BLOCK_ORIGIN, by - MPM_BLOCK_ORIGIN, bz - MPM_BLOCK_ORIGIN)
+    expanded_ids[tid] = tid
+
+
+@wp.kernel
+def mpm_block_neighbors(
+    unique_keys: wp.array(dtype=int),
+    unique_count: wp.array(dtype=int),
+    block_keys: wp.array(dtype=int),
+    block_count: wp.array(dtype=int),
+    neighbors: wp.array(dtype=int),
+):
+    # grid blocks of the 2x2x2 neighborhood of each occupied block
+    tid = wp.tid()
+    u = tid // 8
+    k = tid - u * 8
+    if u >= unique_count[0]:
+        return
+
+    key = unique_keys[u]
+    bx = ((key >> 20) & MPM_BLOCK_MAX) + (k & 1)
+    by = ((key >> 10) & MPM_BLOCK_MAX) + ((k >> 1) & 1)
+    bz = (key & MPM_BLOCK_MAX) + ((k >> 2) & 1)
+    neighbor = mpm_block_key(bx - MPM_BLOCK_ORIGIN, by - MPM_BLOCK_ORIGIN, bz - MPM_BLOCK_ORIGIN)
+    neighbors[tid] = mpm_find_block(block_keys, block_count[0], neighbor)
+
+
+@wp.func
+def mpm_node_index(
+    base: wp.vec3i,
+    i: int,
+    j: int,
+    k: int,
+    block: wp.vec3i,
+    neighbors: wp.array(dtype=int),
+    u: int,
+):
+    nx = base[0] + i
+    ny = base[1] + j
+    nz = base[2] + k
+    ox = nx // MPM_BLOCK_SIZE - block[0]
+    oy = ny // MPM_BLOCK_SIZE - block[1]
+    oz = nz // MPM_BLOCK_SIZE - block[2]
+    b = neighbors[u * 8 + ox + oy * 2 + oz * 4]
+    local = (nx - (nx // MPM_BLOCK_SIZE) * MPM_BLOCK_SIZE) * 16
+    local += (ny - (ny // MPM_BLOCK_SIZE) * MPM_BLOCK_SIZE) * 4
+    local += nz - (nz // MPM_BLOCK_SIZE) * MPM_BLOCK_SIZE
+    return b * MPM_BLOCK_NODES + local
+
+
+@wp.func
+def mpm_kirchhoff_stress(F: wp.mat33, material: int, mu: float, lam: float, Jp: float, hardening: float):
+    if material == MPM_MATERIAL_SAND:
+        # Hencky strain with St. Venant-Kirchhoff energy
+        U = wp.mat33()
+        sigma = wp.vec3()
+        V = wp.mat33()
+        wp.svd3(F, U, sigma, V)
+        eps = wp.vec3(
+            wp.log(wp.max(sigma[0], 1.0e-6)),
+            wp.log(wp.max(sigma[1], 1.0e-6)),
+            wp.log(wp.max(sigma[2], 1.0e-6)),
+        )
+        tr = eps[0] + eps[1] + eps[2]
+        d = 2.0 * mu * eps + wp.vec3(lam * tr)
+        return U * wp.diag(d) * wp.transpose(U)
+
+    # fixed corotated energy, snow stiffens as it is compressed
+    if material == MPM_MATERIAL_SNOW:
+        h = wp.exp(hardening * (1.0 - Jp))
+        mu = mu * h
+        lam = lam * h
+
+    J = wp.determinant(F)
+    R = wp.polar3(F)
+    return 2.0 * mu * (F - R) * wp.transpose(F) + wp.identity(n=3, dtype=float) * (lam * (J - 1.0) * J)
+
+
+@wp.kernel
+def mpm_p2g(
+    particle_q: wp.array(dtype=wp.vec3),
+    particle_qd: wp.array(dtype=wp.vec3),
+    particle_mass: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    particle_F: wp.array(dtype=wp.mat33),
+    particle_C: wp.array(dtype=wp.mat33),
+    particle_Jp: wp.array(dtype=float),
+    sorted_keys: wp.array(dtype=int),
+    sorted_ids: wp.array(dtype=int),
+    unique_keys: wp.array(dtype=int),
+    unique_count: wp.array(dtype=int),
+    neighbors: wp.array(dtype=int),
+    dx: float,
+    inv_dx: float,
+    dt: float,
+    inv_density: float,
+    material: int,
+    mu: float,
+    lam: float,
+    hardening: float,
+    grid_mv: wp.array(dtype=wp.vec3),
+    grid_m: wp.array(dtype=float),
+):
+    # threads follow the block order of the particles, so neighboring threads add to the same nodes
+    tid = wp.tid()
+    p = sorted_ids[tid]
+    if (particle_flags[p] & PARTICLE_FLAG_ACTIVE) == 0:
+        return
+
+    m = particle_mass[p]
+    if m == 0.0:
+        return
+
+    x = particle_q[p]
+    base = mpm_node_base(x, inv_dx)
+    fx = x * inv_dx - wp.vec3(
+        float(base[0] - MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE),
+        float(base[1] - MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE),
+        float(base[2] - MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE),
+    )
+    wx = mpm_weights(fx[0])
+    wy = mpm_weights(fx[1])
+    wz = mpm_weights(fx[2])
+
+    u = mpm_find_block(unique_keys, unique_count[0], sorted_keys[tid])
+    block = wp.vec3i(base[0] // MPM_BLOCK_SIZE, base[1] // MPM_BLOCK_SIZE, base[2] // MPM_BLOCK_SIZE)
+
+    # MLS-MPM fuses the stress force into the APIC affine momentum
+    tau = mpm_kirchhoff_stress(particle_F[p], material, mu, lam, particle_Jp[p], hardening)
+    vol = m * inv_density
+    affine = tau * (-dt * vol * 4.0 * inv_dx * inv_dx) + particle_C[p] * m
+    mv = particle_qd[p] * m
+
+    for i in range(3):
+        for j in range(3):
+            for k in range(3):
+                w = wx[i] * wy[j] * wz[k]
+                dpos = (wp.vec3(float(i), float(j), float(k)) - fx) * dx
+                n = mpm_node_index(base, i, j, k, block, neighbors, u)
+                wp.atomic_add(grid_mv, n, w * (mv + affine * dpos))
+                wp.atomic_add(grid_m, n, w * m)
+
+
+@wp.kernel
+def mpm_grid_update(
+    grid_mv: wp.array(dtype=wp.vec3),
+    grid_m: wp.array(dtype=float),
+    block_keys: wp.array(dtype=int),
+    block_count: wp.array(dtype=int),
+    dx: float,
+    dt: float,
+    gravity: wp.vec3,
+    ground: wp.array(dtype=float),
+    ground_enabled: int,
+    friction: float,
+    grid_v: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    b = tid // MPM_BLOCK_NODES
+    if b >= block_count[0]:
+        return
+
+    m = grid_m[tid]
+    if m <= 0.0:
+        grid_v[tid] = wp.vec3()
+        return
+
+    v = grid_mv[tid] / m + gravity * dt
+
+    if ground_enabled:
+        key = block_keys[b]
+        local = tid - b * MPM_BLOCK_NODES
+        x = wp.vec3(
+            float((((key >> 20) & MPM_BLOCK_MAX) - MPM_BLOCK_ORIGIN) * MPM_BLOCK_SIZE + local // 16),
+            float((((key >> 10) & MPM_BLOCK_MAX) - MPM_BLOCK_ORIGIN) * MPM_BLOCK_SIZE + (local // 4) % 4),
+            float(((key & MPM_BLOCK_MAX) - MPM_BLOCK_ORIGIN) * MPM_BLOCK_SIZE + local % 4),
+        ) * dx
+
+        n = wp.vec3(ground[0], ground[1], ground[2])
+        vn = wp.dot(v, n)
+        if wp.dot(n, x) + ground[3] < 0.0 and vn < 0.0:
+            # separating boundary with Coulomb friction
+            vt = v - n * vn
+            vt_len = wp.length(vt)
+            if vt_len <= -friction * vn:
+                v = wp.vec3()
+            else:
+                v = vt * (1.0 + friction * vn / vt_len)
+
+    grid_v[tid] = v
+
+
+@wp.func
+def mpm_project_plasticity(
+    F: wp.mat33,
+    material: int,
+    mu: float,
+    lam: float,
+    critical_compression: float,
+    critical_stretch: float,
+    friction_alpha: float,
+):
+    # returns the elastic part of F, the plastic volume change goes to the snow hardening
+    U = wp.mat33()
+    sigma = wp.vec3()
+    V = wp.mat33()
+    wp.svd3(F, U, sigma, V)
+
+    if material == MPM_MATERIAL_SNOW:
+        lo = 1.0 - critical_compression
+        hi = 1.0 + critical_stretch
+        sigma = wp.vec3(wp.clamp(sigma[0], lo, hi), wp.clamp(sigma[1], lo, hi), wp.clamp(sigma[2], lo, hi))
+    else:
+        # Drucker-Prager return mapping of the Hencky strain, Klar et al. 2016
+        eps = wp.vec3(
+            wp.log(wp.max(sigma[0], 1.0e-6)),
+            wp.log(wp.max(sigma[1], 1.0e-6)),
+            wp.log(wp.max(sigma[2], 1.0e-6)),
+        )
+        tr = eps[0] + eps[1] + eps[2]
+        if tr >= 0.0:
+            sigma = wp.vec3(1.0)
+        else:
+            dev = eps - wp.vec3(tr / 3.0)
+            dev_len = wp.length(dev)
+            dg = dev_len + (3.0 * lam + 2.0 * mu) / (2.0 * mu) * tr * friction_alpha
+            if dg > 0.0 and dev_len > 0.0:
+                eps = eps - dev * (dg / dev_len)
+                sigma = wp.vec3(wp.exp(eps[0]), wp.exp(eps[1]), wp.exp(eps[2]))
+
+    return U * wp.diag(sigma) * wp.transpose(V)
+
+
+@wp.kernel
+def mpm_g2p(
+    particle_q: wp.array(dtype=wp.vec3),
+    particle_qd: wp.array(dtype=wp.vec3),
+    particle_mass: wp.array(dtype=float),
+    particle_flags: wp.array(dtype=wp.uint32),
+    particle_F: wp.array(dtype=wp.mat33),
+    particle_C: wp.array(dtype=wp.mat33),
+    particle_Jp: wp.array(dtype=float),
+    sorted_keys: wp.array(dtype=int),
+    sorted_ids: wp.array(dtype=int),
+    unique_keys: wp.array(dtype=int),
+    unique_count: wp.array(dtype=int),
+    neighbors: wp.array(dtype=int),
+    grid_v: wp.array(dtype=wp.vec3),
+    dx: float,
+    inv_dx: float,
+    dt: float,
+    material: int,
+    mu: float,
+    lam: float,
+    critical_compression: float,
+    critical_stretch: float,
+    friction_alpha: float,
+    particle_q_out: wp.array(dtype=wp.vec3),
+    particle_qd_out: wp.array(dtype=wp.vec3),
+    particle_F_out: wp.array(dtype=wp.mat33),
+    particle_C_out: wp.array(dtype=wp.mat33),
+    particle_Jp_out: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    p = sorted_ids[tid]
+
+    x = particle_q[p]
+    F = particle_F[p]
+    Jp = particle_Jp[p]
+
+    if (particle_flags[p] & PARTICLE_FLAG_ACTIVE) == 0 or particle_mass[p] == 0.0:
+        particle_q_out[p] = x
+        particle_qd_out[p] = particle_qd[p]
+        particle_F_out[p] = F
+        particle_C_out[p] = particle_C[p]
+        particle_Jp_out[p] = Jp
+        return
+
+    base = mpm_node_base(x, inv_dx)
+    fx = x * inv_dx - wp.vec3(
+        float(base[0] - MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE),
+        float(base[1] - MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE),
+        float(base[2] - MPM_BLOCK_ORIGIN * MPM_BLOCK_SIZE),
+    )
+    wx = mpm_weights(fx[0])
+    wy = mpm_weights(fx[1])
+    wz = mpm_weights(fx[2])
+
+    u = mpm_find_block(unique_keys, unique_count[0], sorted_keys[tid])
+    block = wp.vec3i(base[0] // MPM_BLOCK_SIZE, base[1] // MPM_BLOCK_SIZE, base[2] // MPM_BLOCK_SIZE)
+
+    v = wp.vec3()
+    B = wp.mat33()
+    for i in range(3):
+        for j in range(3):
+            for k in range(3):
+                w = wx[i] * wy[j] * wz[k]
+                dpos = (wp.vec3(float(i), float(j), float(k)) - fx) * dx
+                gv = grid_v[mpm_node_index(base, i, j, k, block, neighbors, u)]
+                v += gv * w
+                B += wp.outer(gv, dpos) * w
+
+    C = B * (4.0 * inv_dx * inv_dx)
+    F = (wp.identity(n=3, dtype=float) + C * dt) * F
+
+    if material != MPM_MATERIAL_ELASTIC:
+        J = wp.determinant(F)
+        F = mpm_project_plasticity(F, material, mu, lam, critical_compression, critical_stretch, friction_alpha)
+        Jp = Jp * J / wp.determinant(F)
+
+    particle_q_out[p] = x + v * dt
+    particle_qd_out[p] = v
+    particle_F_out[p] = F
+    particle_C_out[p] = C
+    particle_Jp_out[p] = Jp
+
+
+@wp.kernel
+def mpm_init_particles(
+    particle_F: wp.array(dtype=wp.mat33),
+    particle_C: wp.array(dtype=wp.mat33),
+    particle_Jp: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    particle_F[tid] = wp.identity(n=3, dtype=float)
+    particle_C[tid] = wp.mat33()
+    particle_Jp[tid] = 1.0
+
+
+class MPMIntegrator:
+    """A material point method integrator for particles modelling snow, sand, soil or elastic solids
+
+    Each call to :meth:`simulate` is one explicit MLS-MPM step with APIC transfers on a sparse grid of spacing
+    ``dx``, made of blocks of 4x4x4 nodes allocated around the particles. Grid coordinates are limited to +/-2048
+    nodes from the origin along each axis, particles further away are clamped to the border blocks. The model
+    ground plane is a frictional boundary of the grid.
+
+    Besides positions and velocities, the particles carry a deformation gradient, an affine velocity and a plastic
+    volume ratio, stored in the ``mpm_F``, ``mpm_C`` and ``mpm_Jp`` arrays of the states, which are created at rest
+    on the first step if the states don't have them. Particle volumes are their mass divided by ``density``.
+
+    Materials:
+
+        * ``"elastic"``: fixed corotated elasticity, using ``polar3()``
+        * ``"snow"``: corotated elasticity whose singular values are clamped to
+          ``[1 - critical_compression, 1 + critical_stretch]``, stiffening under compression, Stomakhin et al. 2013
+        * ``"sand"``: Hencky elasticity with Drucker-Prager plasticity of friction angle ``friction_angle``, in degrees
+
+    Each step sorts the particles and reads back the number of occupied blocks to size the grid, which
+    synchronizes with the device once.
+
+    Example
+    -------
+
+    .. code-block:: python
+
+        integrator = wp.sim.MPMIntegrator(dx=0.02, material="snow")
+
+        # simulation loop
+        for i in range(100):
+            integrator.simulate(model, state_in, state_out, dt)
+            state_in, state_out = state_out, state_in
+
+    """
+
+    def __init__(
+        self,
+        dx,
+        material="elastic",
+        youngs_modulus=1.0e5,
+        poisson_ratio=0.3,
+        density=1000.0,
+        hardening=10.0,
+        critical_compression=2.5e-2,
+        critical_stretch=7.5e-3,
+        friction_angle=30.0,
+        ground_friction=0.5,
+    ):
+        materials = {"elastic": MPM_MATERIAL_ELASTIC, "snow": MPM_MATERIAL_SNOW, "sand": MPM_MATERIAL_SAND}
+        if material not in materials:
+            raise ValueError(f"Unknown MPM material '{material}', expected one of {list(materials)}")
+
+        self.dx = dx
+        self.material = materials[material]
+        self.mu = youngs_modulus / (2.0 * (1.0 + poisson_ratio))
+        self.lam = youngs_modulus * poisson_ratio / ((1.0 + poisson_ratio) * (1.0 - 2.0 * poisson_ratio))
+        self.density = density
+        self.hardening = hardening
+        self.critical_compression = critical_compression
+        self.critical_stretch = critical_stretch
+        s = np.sin(np.radians(friction_angle))
+        self.friction_alpha = np.sqrt(2.0 / 3.0) * 2.0 * s / (3.0 - s)
+        self.ground_friction = ground_friction
+
+        self.particle_capacity = 0
+        self.block_capacity = 0
+
+    def _reserve(self, model, num_unique):
+        device = model.device
+        n = model.particle_count
+
+        if n > self.particle_capacity:
+            self.particle_capacity = n
+            self.sort_keys = wp.empty(2 * n, dtype=int, device=device)
+            self.sort_ids = wp.empty(2 * n, dtype=int, device=device)
+            self.unique_keys = wp.empty(n, dtype=int, device=device)
+            self.unique_lengths = wp.empty(n, dtype=int, device=device)
+            self.unique_count = wp.empty(1, dtype=int, device=device)
+            self.block_count = wp.empty(1, dtype=int, device=device)
+
+        if num_unique is not None and 8 * num_unique > self.block_capacity:
+            count = 8 * num_unique
+            self.block_capacity = count
+            self.expanded_keys = wp.empty(2 * count, dtype=int, device=device)
+            self.expanded_ids = wp.empty(2 * count, dtype=int, device=device)
+            self.block_keys = wp.empty(count, dtype=int, device=device)
+            self.block_lengths = wp.empty(count, dtype=int, device=device)
+            self.neighbors = wp.empty(count, dtype=int, device=device)
+            self.grid_mv = wp.empty(count * MPM_BLOCK_NODES, dtype=wp.vec3, device=device)
+            self.grid_m = wp.empty(count * MPM_BLOCK_NODES, dtype=float, device=device)
+            self.grid_v = wp.empty(count * MPM_BLOCK_NODES, dtype=wp.vec3, device=device)
+
+    def _ensure_state(self, model, state):
+        if getattr(state, "mpm_F", None) is None:
+            state.mpm_F = wp.empty(model.particle_count, dtype=wp.mat33, device=model.device)
+            state.mpm_C = wp.empty(model.particle_count, dtype=wp.mat33, device=model.device)
+            state.mpm_Jp = wp.empty(model.particle_count, dtype=float, device=model.device)
+            wp.launch(
+                mpm_init_particles,
+                dim=model.particle_count,
+                inputs=[state.mpm_F, state.mpm_C, state.mpm_Jp],
+                device=model.device,
+            )
+
+    def simulate(self, model, state_in, state_out, dt):
+        n = model.particle_count
+        if not n:
+            return state_out
+
+        with wp.ScopedTimer("simulate", False):
+            self._ensure_state(model, state_in)
+            self._ensure_state(model, state_out)
+            self._reserve(model, None)
+
+            inv_dx = 1.0 / self.dx
+
+            # occupied blocks, in the order of the sorted particles
+            wp.launch(
+                mpm_particle_keys,
+                dim=n,
+                inputs=[state_in.particle_q, inv_dx],
+                outputs=[self.sort_keys, self.sort_ids],
+                device=model.device,
+            )
+            radix_sort_pairs(self.sort_keys, self.sort_ids, n, 0, MPM_BLOCK_KEY_BITS)
+            runlength_encode(
+                self.sort_keys, self.unique_keys, self.unique_lengths, run_count=self.unique_count, value_count=n
+            )
+            num_unique = int(self.unique_count.numpy()[0])
+
+            # grid blocks of the stencils of the particles
+            self._reserve(model, num_unique)
+            count = 8 * num_unique
+            wp.launch(
+                mpm_expand_blocks,
+                dim=count,
+                inputs=[self.unique_keys],
+                outputs=[self.expanded_keys, self.expanded_ids],
+                device=model.device,
+            )
+            radix_sort_pairs(self.expanded_keys, self.expanded_ids, count, 0, MPM_BLOCK_KEY_BITS)
+            runlength_encode(
+                self.expanded_keys, self.block_keys, self.block_lengths, run_count=self.block_count, value_count=count
+            )
+            wp.launch(
+                mpm_block_neighbors,
+                dim=count,
+                inputs=[self.unique_keys, self.unique_count, self.block_keys, self.block_count],
+                outputs=[self.neighbors],
+                device=model.device,
+            )
+
+            # the grid is sized for every occupied block having distinct neighbors, unused blocks are skipped
+            num_nodes = count * MPM_BLOCK_NODES
+            self.grid_mv[:num_nodes].zero_()
+            self.grid_m[:num_nodes].zero_()
+
+            wp.launch(
+                mpm_p2g,
+                dim=n,
+                inputs=[
+                    state_in.particle_q,
+                    state_in.particle_qd,
+                    model.particle_mass,
+                    model.particle_flags,
+                    state_in.mpm_F,
+                    state_in.mpm_C,
+                    state_in.mpm_Jp,
+                    self.sort_keys,
+                    self.sort_ids,
+                    self.unique_keys,
+                    self.unique_count,
+                    self.neighbors,
+                    self.dx,
+                    inv_dx,
+                    dt,
+                    1.0 / self.density,
+                    self.material,
+                    self.mu,
+                    self.lam,
+                    self.hardening,
+                ],
+                outputs=[self.grid_mv, self.grid_m],
+                device=model.device,
+            )
+
+            ground = model.ground and model.ground_plane is not None
+            wp.launch(
+                mpm_grid_update,
+                dim=num_nodes,
+                inputs=[
+                    self.grid_mv,
+                    self.grid_m,
+                    self.block_keys,
+                    self.block_count,
+                    self.dx,
+                    dt,
+                    model.gravity,
+                    model.ground_plane,
+                    int(ground),
+                    self.ground_friction,
+                ],
+                outputs=[self.grid_v],
+                device=model.device,
+            )
+
+            wp.launch(
+                mpm_g2p,
+                dim=n,
+                inputs=[
+                    state_in.particle_q,
+                    state_in.particle_qd,
+                    model.particle_mass,
+                    model.particle_flags,
+                    state_in.mpm_F,
+                    state_in.mpm_C,
+                    state_in.mpm_Jp,
+                    self.sort_keys,
+                    self.sort_ids,
+                    self.unique_keys,
+                    self.unique_count,
+                    self.neighbors,
+                    self.grid_v,
+                    self.dx,
+                    inv_dx,
+                    dt,
+                    self.material,
+                    self.mu,
+                    self.lam,
+                    self.critical_compression,
+                    self.critical_stretch,
+                    self.friction_alpha,
+                ],
+                outputs=[
+                    state_out.particle_q,
+                    state_out.particle_qd,
+                    state_out.mpm_F,
+                    state_out.mpm_C,
+                    state_out.mpm_Jp,
+                ],
+                device=model.device,
+            )
+
+            return state_out
@@ -10,9 +10,11 @@ models + state forward in time.
 
 """
 
+import numpy as np
 import torch
 import warp as wp
-from .model import ModelShapeGeometry, ModelShapeMaterials
+from .collide import triangle_closest_point_barycentric
+from .model import PARTICLE_FLAG_ACTIVE, ModelShapeGeometry, ModelShapeMaterials
 
 
 @wp.func
@@ -1447,6 +1449,232 @@ def create_matrix(
         A[A_start[tid] + i + 198] = a_12[a_start[tid] + i]
 
 
+##########################
+
+###  PARTICLE CCD  ###
+
+##########################
+
+
+@wp.kernel
+def compute_swept_triangle_bounds(
+    x0: wp.array(dtype=wp.vec3),
+    x1: wp.array(dtype=wp.vec3),
+    tri_indices: wp.array2d(dtype=int),
+    thickness: float,
+    lowers: wp.array(dtype=wp.vec3),
+    uppers: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+
+    lower = x0[tri_indices[tid, 0]]
+    upper = lower
+    for k in range(3):
+        p0 = x0[tri_indices[tid, k]]
+        p1 = x1[tri_indices[tid, k]]
+        lower = wp.min(lower, wp.min(p0, p1))
+        upper = wp.max(upper, wp.max(p0, p1))
+
+    lowers[tid] = lower - wp.vec3(thickness)
+    uppers[tid] = upper + wp.vec3(thickness)
+
+
+@wp.kernel
+def compute_swept_edge_bounds(
+    x0: wp.array(dtype=wp.vec3),
+    x1: wp.array(dtype=wp.vec3),
+    edge_indices: wp.array2d(dtype=int),
+    thickness: float,
+    lowers: wp.array(dtype=wp.vec3),
+    uppers: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    i = edge_indices[tid, 0]
+    j = edge_indices[tid, 1]
+
+    lower = wp.min(wp.min(x0[i], x1[i]), wp.min(x0[j], x1[j]))
+    upper = wp.max(wp.max(x0[i], x1[i]), wp.max(x0[j], x1[j]))
+
+    lowers[tid] = lower - wp.vec3(thickness)
+    uppers[tid] = upper + wp.vec3(thickness)
+
+
+@wp.func
+def vertex_face_distance(p: wp.vec3, a: wp.vec3, b: wp.vec3, c: wp.vec3):
+    bary = triangle_closest_point_barycentric(a, b, c, p)
+    return wp.length(p - (a * bary[0] + b * bary[1] + c * bary[2]))
+
+
+@wp.func
+def vertex_face_toi(
+    p0: wp.vec3,
+    a0: wp.vec3,
+    b0: wp.vec3,
+    c0: wp.vec3,
+    p1: wp.vec3,
+    a1: wp.vec3,
+    b1: wp.vec3,
+    c1: wp.vec3,
+    thickness: float,
+    max_iter: int,
+):
+    # conservative advancement: the distance cannot shrink faster than the largest relative displacement
+    dp = p1 - p0
+    da = a1 - a0
+    db = b1 - b0
+    dc = c1 - c0
+    bound = wp.length(dp) + wp.max(wp.length(da), wp.max(wp.length(db), wp.length(dc)))
+
+    d = vertex_face_distance(p0, a0, b0, c0)
+    # pairs that start closer than the thickness may still approach to half of their distance
+    gap = wp.min(thickness, 0.5 * d)
+    if bound <= 1.0e-9 or d <= 1.0e-9:
+        return 1.0
+
+    t = float(0.0)
+    for _ in range(max_iter):
+        if d - gap <= 0.1 * gap:
+            return t
+        t = t + (d - gap) / bound
+        if t >= 1.0:
+            return 1.0
+        d = vertex_face_distance(p0 + dp * t, a0 + da * t, b0 + db * t, c0 + dc * t)
+
+    return t
+
+
+@wp.func
+def edge_edge_toi(
+    p0: wp.vec3,
+    q0: wp.vec3,
+    r0: wp.vec3,
+    s0: wp.vec3,
+    p1: wp.vec3,
+    q1: wp.vec3,
+    r1: wp.vec3,
+    s1: wp.vec3,
+    thickness: float,
+    max_iter: int,
+):
+    dp = p1 - p0
+    dq = q1 - q0
+    dr = r1 - r0
+    ds = s1 - s0
+    bound = wp.max(wp.length(dp), wp.length(dq)) + wp.max(wp.length(dr), wp.length(ds))
+
+    st = wp.closest_point_edge_edge(p0, q0, r0, s0, 1.0e-6)
+    d = st[2]
+    gap = wp.min(thickness, 0.5 * d)
+    if bound <= 1.0e-9 or d <= 1.0e-9:
+        return 1.0
+
+    t = float(0.0)
+    for _ in range(max_iter):
+        if d - gap <= 0.1 * gap:
+            return t
+        t = t + (d - gap) / bound
+        if t >= 1.0:
+            return 1.0
+        st = wp.closest_point_edge_edge(p0 + dp * t, q0 + dq * t, r0 + dr * t, s0 + ds * t, 1.0e-6)
+        d = st[2]
+
+    return t
+
+
+@wp.kernel
+def eval_vertex_face_toi(
+    tri_bvh: wp.uint64,
+    x0: wp.array(dtype=wp.vec3),
+    x1: wp.array(dtype=wp.vec3),
+    particle_flags: wp.array(dtype=wp.uint32),
+    tri_indices: wp.array2d(dtype=int),
+    thickness: float,
+    max_iter: int,
+    # outputs
+    particle_toi: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    if (particle_flags[tid] & PARTICLE_FLAG_ACTIVE) == 0:
+        return
+
+    p0 = x0[tid]
+    p1 = x1[tid]
+    lower = wp.min(p0, p1) - wp.vec3(thickness)
+    upper = wp.max(p0, p1) + wp.vec3(thickness)
+
+    tri = int(0)
+    query = wp.bvh_query_aabb(tri_bvh, lower, upper)
+    while wp.bvh_query_next(query, tri):
+        i = tri_indices[tri, 0]
+        j = tri_indices[tri, 1]
+        k = tri_indices[tri, 2]
+        if i == tid or j == tid or k == tid:
+            continue
+
+        toi = vertex_face_toi(p0, x0[i], x0[j], x0[k], p1, x1[i], x1[j], x1[k], thickness, max_iter)
+        if toi < 1.0:
+            wp.atomic_min(particle_toi, tid, toi)
+            wp.atomic_min(particle_toi, i, toi)
+            wp.atomic_min(particle_toi, j, toi)
+            wp.atomic_min(particle_toi, k, toi)
+
+
+@wp.kernel
+def eval_edge_edge_toi(
+    edge_bvh: wp.uint64,
+    x0: wp.array(dtype=wp.vec3),
+    x1: wp.array(dtype=wp.vec3),
+    edge_indices: wp.array2d(dtype=int),
+    edge_lowers: wp.array(dtype=wp.vec3),
+    edge_uppers: wp.array(dtype=wp.vec3),
+    thickness: float,
+    max_iter: int,
+    # outputs
+    particle_toi: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    i = edge_indices[tid, 0]
+    j = edge_indices[tid, 1]
+
+    edge = int(0)
+    query = wp.bvh_query_aabb(edge_bvh, edge_lowers[tid], edge_uppers[tid])
+    while wp.bvh_query_next(query, edge):
+        # each pair is tested once, by its lower edge
+        if edge <= tid:
+            continue
+        k = edge_indices[edge, 0]
+        l = edge_indices[edge, 1]
+        if k == i or k == j or l == i or l == j:
+            continue
+
+        toi = edge_edge_toi(x0[i], x0[j], x0[k], x0[l], x1[i], x1[j], x1[k], x1[l], thickness, max_iter)
+        if toi < 1.0:
+            wp.atomic_min(particle_toi, i, toi)
+            wp.atomic_min(particle_toi, j, toi)
+            wp.atomic_min(particle_toi, k, toi)
+            wp.atomic_min(particle_toi, l, toi)
+
+
+@wp.kernel
+def apply_particle_toi(
+    x0: wp.array(dtype=wp.vec3),
+    particle_toi: wp.array(dtype=float),
+    dt: float,
+    # outputs
+    x1: wp.array(dtype=wp.vec3),
+    v1: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    toi = particle_toi[tid]
+    if toi >= 1.0:
+        return
+
+    # advance the particles of colliding primitives to their time of impact and drop the remaining motion
+    x = x0[tid] + (x1[tid] - x0[tid]) * toi
+    x1[tid] = x
+    v1[tid] = (x - x0[tid]) / dt
+
+
 ##########################
 
 ###  INTEGRATOR CLASS  ###
@@ -1456,7 +1684,97 @@ def create_matrix(
 
 class TOIIntegrator:
     def __init__(self):
-        pass
+        # swept bounds and BVHs of the model triangles and their edges, built by the first particle CCD step
+        self.ccd_model = None
+
+    def init_particle_ccd(self, model):
+        tris = model.tri_indices.numpy()
+        edges = np.unique(np.sort(tris[:, [0, 1, 1, 2, 2, 0]].reshape(-1, 2), axis=1), axis=0)
+
+        self.ccd_edge_indices = wp.array(edges, dtype=wp.int32, device=model.device)
+        self.ccd_tri_lowers = wp.zeros(model.tri_count, dtype=wp.vec3, device=model.device)
+        self.ccd_tri_uppers = wp.zeros(model.tri_count, dtype=wp.vec3, device=model.device)
+        self.ccd_edge_lowers = wp.zeros(len(edges), dtype=wp.vec3, device=model.device)
+        self.ccd_edge_uppers = wp.zeros(len(edges), dtype=wp.vec3, device=model.device)
+        self.ccd_tri_bvh = wp.Bvh(self.ccd_tri_lowers, self.ccd_tri_uppers)
+        self.ccd_edge_bvh = wp.Bvh(self.ccd_edge_lowers, self.ccd_edge_uppers)
+        self.particle_toi = wp.zeros(model.particle_count, dtype=float, device=model.device)
+        self.ccd_model = model
+
+    def eval_particle_toi(self, model, state_in, state_out, thickness, max_iter=16):
+        """
+        Computes the fraction of the step from ``state_in`` to ``state_out`` at which the particles of each
+        vertex-triangle and edge-edge pair of the model triangles first come within ``thickness``, into
+        ``self.particle_toi`` (1.0 for particles without an impact). Candidate pairs are found from BVHs over
+        the swept bounds of the triangles and edges, which are refit every step.
+        """
+        if model.tri_count == 0:
+            return
+
+        if self.ccd_model is not model:
+            self.init_particle_ccd(model)
+
+        x0 = state_in.particle_q
+        x1 = state_out.particle_q
+
+        wp.launch(
+            kernel=compute_swept_triangle_bounds,
+            dim=model.tri_count,
+            inputs=[x0, x1, model.tri_indices, thickness],
+            outputs=[self.ccd_tri_lowers, self.ccd_tri_uppers],
+            device=model.device,
+        )
+        wp.launch(
+            kernel=compute_swept_edge_bounds,
+            dim=len(self.ccd_edge_indices),
+            inputs=[x0, x1, self.ccd_edge_indices, thickness],
+            outputs=[self.ccd_edge_lowers, self.ccd_edge_uppers],
+            device=model.device,
+        )
+        self.ccd_tri_bvh.refit()
+        self.ccd_edge_bvh.refit()
+
+        self.particle_toi.fill_(1.0)
+        wp.launch(
+            kernel=eval_vertex_face_toi,
+            dim=model.particle_count,
+            inputs=[self.ccd_tri_bvh.id, x0, x1, model.particle_flags, model.tri_indices, thickness, max_iter],
+            outputs=[self.particle_toi],
+            device=model.device,
+        )
+        wp.launch(
+            kernel=eval_edge_edge_toi,
+            dim=len(self.ccd_edge_indices),
+            inputs=[
+                self.ccd_edge_bvh.id,
+                x0,
+                x1,
+                self.ccd_edge_indices,
+                self.ccd_edge_lowers,
+                self.ccd_edge_uppers,
+                thickness,
+                max_iter,
+            ],
+            outputs=[self.particle_toi],
+            device=model.device,
+        )
+
+    def advance_particles(self, model, state_in, state_out, dt, thickness, max_iter=16):
+        """
+        Conservative advancement of the particles from ``state_in`` towards the positions predicted in
+        ``state_out`` by another integrator, the particles of colliding primitives stop at their time of impact.
+        """
+        if model.tri_count == 0:
+            return
+
+        self.eval_particle_toi(model, state_in, state_out, thickness, max_iter)
+        wp.launch(
+            kernel=apply_particle_toi,
+            dim=model.particle_count,
+            inputs=[state_in.particle_q, self.particle_toi, dt],
+            outputs=[state_out.particle_q, state_out.particle_qd],
+            device=model.device,
+        )
 
     def eval_rigid_fk(self, model, state_in):
         # evaluate body transforms
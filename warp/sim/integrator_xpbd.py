@@ -5,6 +5,8 @@
 # distribution of this software and related documentation without an express
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
+from typing import Any
+
 import warp as wp
 from .model import (
     PARTICLE_FLAG_ACTIVE,
@@ -13,7 +15,7 @@ from .model import (
     JOINT_MODE_TARGET_VELOCITY,
     JOINT_MODE_LIMIT,
 )
-from .utils import velocity_at_point, vec_min, vec_max, vec_abs
+from .utils import velocity_at_point, vec_min, vec_max, vec_abs, load_contact_normal
 from .integrator_euler import integrate_bodies, integrate_particles
 
 
@@ -123,10 +125,10 @@ def solve_particle_shape_contacts(
     particle_ka: float,
     contact_count: wp.array(dtype=int),
     contact_particle: wp.array(dtype=int),
-    contact_shape: wp.array(dtype=int),
+    contact_shape: wp.array(dtype=Any),
     contact_body_pos: wp.array(dtype=wp.vec3),
     contact_body_vel: wp.array(dtype=wp.vec3),
-    contact_normal: wp.array(dtype=wp.vec3),
+    contact_normal: wp.array(dtype=Any),
     contact_max: int,
     dt: float,
     relaxation: float,
@@ -142,7 +144,7 @@ def solve_particle_shape_contacts(
     if tid >= count:
         return
 
-    shape_index = contact_shape[tid]
+    shape_index = int(contact_shape[tid])
     body_index = shape_body[shape_index]
     particle_index = contact_particle[tid]
 
@@ -160,7 +162,7 @@ def solve_particle_shape_contacts(
     bx = wp.transform_point(X_wb, contact_body_pos[tid])
     r = bx - wp.transform_point(X_wb, X_com)
 
-    n = contact_normal[tid]
+    n = load_contact_normal(contact_normal, tid)
     c = wp.dot(n, px - bx) - particle_radius[tid]
 
     if c > particle_ka:
@@ -282,6 +284,17 @@ def solve_particle_particle_contacts(
     wp.atomic_add(deltas, i, delta * relaxation)
 
 
+@wp.func
+def apply_particle_constraint_delta(
+    x: wp.array(dtype=wp.vec3), delta: wp.array(dtype=wp.vec3), gauss_seidel: bool, i: int, dx: wp.vec3
+):
+    if gauss_seidel:
+        # no other constraint of the same color moves particle i
+        x[i] = x[i] + dx
+    else:
+        wp.atomic_add(delta, i, dx)
+
+
 @wp.kernel
 def solve_springs(
     x: wp.array(dtype=wp.vec3),
@@ -293,10 +306,16 @@ def solve_springs(
     spring_damping: wp.array(dtype=float),
     dt: float,
     lambdas: wp.array(dtype=float),
+    color_ids: wp.array(dtype=int),
     delta: wp.array(dtype=wp.vec3),
 ):
     tid = wp.tid()
 
+    # Gauss-Seidel mode solves one color of springs per launch and moves the particles directly
+    gauss_seidel = color_ids.shape[0] > 0
+    if gauss_seidel:
+        tid = color_ids[tid]
+
     i = spring_indices[tid * 2 + 0]
     j = spring_indices[tid * 2 + 1]
 
@@ -344,8 +363,8 @@ def solve_springs(
 
     lambdas[tid] = lambdas[tid] + dlambda
 
-    wp.atomic_add(delta, i, dxi)
-    wp.atomic_add(delta, j, dxj)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, i, dxi)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, j, dxj)
 
 
 @wp.kernel
@@ -358,12 +377,17 @@ def bending_constraint(
     bending_properties: wp.array2d(dtype=float),
     dt: float,
     lambdas: wp.array(dtype=float),
+    color_ids: wp.array(dtype=int),
     delta: wp.array(dtype=wp.vec3),
 ):
 
     tid = wp.tid()
     eps = 1.0e-6
 
+    gauss_seidel = color_ids.shape[0] > 0
+    if gauss_seidel:
+        tid = color_ids[tid]
+
     ke = bending_properties[tid, 0]
     kd = bending_properties[tid, 1]
 
@@ -439,10 +463,10 @@ def bending_constraint(
 
     lambdas[tid] = lambdas[tid] + dlambda
 
-    wp.atomic_add(delta, i, delta0)
-    wp.atomic_add(delta, j, delta1)
-    wp.atomic_add(delta, k, delta2)
-    wp.atomic_add(delta, l, delta3)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, i, delta0)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, j, delta1)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, k, delta2)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, l, delta3)
 
 
 @wp.kernel
@@ -456,10 +480,15 @@ def solve_tetrahedra(
     materials: wp.array(dtype=float, ndim=2),
     dt: float,
     relaxation: float,
+    color_ids: wp.array(dtype=int),
     delta: wp.array(dtype=wp.vec3),
 ):
     tid = wp.tid()
 
+    gauss_seidel = color_ids.shape[0] > 0
+    if gauss_seidel:
+        tid = color_ids[tid]
+
     i = indices[tid, 0]
     j = indices[tid, 1]
     k = indices[tid, 2]
@@ -589,10 +618,10 @@ def solve_tetrahedra(
     delta3 += grad3 * multiplier
 
     # apply forces
-    wp.atomic_sub(delta, i, delta0 * w0 * relaxation)
-    wp.atomic_sub(delta, j, delta1 * w1 * relaxation)
-    wp.atomic_sub(delta, k, delta2 * w2 * relaxation)
-    wp.atomic_sub(delta, l, delta3 * w3 * relaxation)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, i, -delta0 * w0 * relaxation)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, j, -delta1 * w1 * relaxation)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, k, -delta2 * w2 * relaxation)
+    apply_particle_constraint_delta(x, delta, gauss_seidel, l, -delta3 * w3 * relaxation)
 
 
 @wp.kernel
@@ -952,9 +981,16 @@ def solve_body_joints(
     angular_relaxation: float,
     linear_relaxation: float,
     dt: float,
+    color_ids: wp.array(dtype=int),
     deltas: wp.array(dtype=wp.spatial_vector),
 ):
     tid = wp.tid()
+
+    # Gauss-Seidel mode solves one color of joints per launch, no two of which share a body
+    gauss_seidel = color_ids.shape[0] > 0
+    if gauss_seidel:
+        tid = color_ids[tid]
+
     type = joint_type[tid]
 
     if joint_enabled[tid] == 0 or type == wp.sim.JOINT_FREE:
@@ -1407,10 +1443,16 @@ def solve_body_joints(
             ang_delta_p += angular_p * d_lambda
             ang_delta_c += angular_c * d_lambda
 
-    if id_p >= 0:
-        wp.atomic_add(deltas, id_p, wp.spatial_vector(ang_delta_p, lin_delta_p))
-    if id_c >= 0:
-        wp.atomic_add(deltas, id_c, wp.spatial_vector(ang_delta_c, lin_delta_c))
+    if gauss_seidel:
+        if id_p >= 0:
+            deltas[id_p] = deltas[id_p] + wp.spatial_vector(ang_delta_p, lin_delta_p)
+        if id_c >= 0:
+            deltas[id_c] = deltas[id_c] + wp.spatial_vector(ang_delta_c, lin_delta_c)
+    else:
+        if id_p >= 0:
+            wp.atomic_add(deltas, id_p, wp.spatial_vector(ang_delta_p, lin_delta_p))
+        if id_c >= 0:
+            wp.atomic_add(deltas, id_c, wp.spatial_vector(ang_delta_c, lin_delta_c))
 
 
 @wp.func
@@ -1952,6 +1994,7 @@ class XPBDIntegrator:
         rigid_contact_con_weighting=True,
         angular_damping=0.0,
         enable_restitution=False,
+        gauss_seidel=False,
     ):
         self.iterations = iterations
 
@@ -1968,7 +2011,25 @@ class XPBDIntegrator:
 
         self.enable_restitution = enable_restitution
 
+        # solve springs, bending edges, tetrahedra and joints one color at a time such that each constraint
+        # sees the corrections of the previous colors, falls back to Jacobi iterations when requires_grad is set
+        self.gauss_seidel = gauss_seidel
+
+    def _constraint_colors(self, colors, count, requires_grad):
+        # yields the constraint ids and launch size of each color in Gauss-Seidel mode,
+        # or a single launch over all constraints otherwise
+        if not count:
+            return []
+
+        if not self.gauss_seidel or requires_grad:
+            return [(None, count)]
+
+        return [(ids, len(ids)) for ids in colors]
+
     def simulate(self, model, state_in, state_out, dt, requires_grad=False):
+        if self.gauss_seidel and model.spring_colors is None:
+            model.color_constraints()
+
         with wp.ScopedTimer("simulate", False):
             particle_q = None
             particle_qd = None
@@ -2152,10 +2213,12 @@ class XPBDIntegrator:
                         )
 
                     # distance constraints
-                    if model.spring_count:
+                    for color_ids, count in self._constraint_colors(
+                        model.spring_colors, model.spring_count, requires_grad
+                    ):
                         wp.launch(
                             kernel=solve_springs,
-                            dim=model.spring_count,
+                            dim=count,
                             inputs=[
                                 particle_q,
                                 particle_qd,
@@ -2166,16 +2229,17 @@ class XPBDIntegrator:
                                 model.spring_damping,
                                 dt,
                                 model.spring_constraint_lambdas,
+                                color_ids,
                             ],
                             outputs=[deltas],
                             device=model.device,
                         )
 
                     # bending constraints
-                    if model.edge_count:
+                    for color_ids, count in self._constraint_colors(model.edge_colors, model.edge_count, requires_grad):
                         wp.launch(
                             kernel=bending_constraint,
-                            dim=model.edge_count,
+                            dim=count,
                             inputs=[
                                 particle_q,
                                 particle_qd,
@@ -2185,16 +2249,17 @@ class XPBDIntegrator:
                                 model.edge_bending_properties,
                                 dt,
                                 model.edge_constraint_lambdas,
+                                color_ids,
                             ],
                             outputs=[deltas],
                             device=model.device,
                         )
 
                     # tetrahedral FEM
-                    if model.tet_count:
+                    for color_ids, count in self._constraint_colors(model.tet_colors, model.tet_count, requires_grad):
                         wp.launch(
                             kernel=solve_tetrahedra,
-                            dim=model.tet_count,
+                            dim=count,
                             inputs=[
                                 particle_q,
                                 particle_qd,
@@ -2205,6 +2270,7 @@ class XPBDIntegrator:
                                 model.tet_materials,
                                 dt,
                                 self.soft_body_relaxation,
+                                color_ids,
                             ],
                             outputs=[deltas],
                             device=model.device,
@@ -2244,61 +2310,68 @@ class XPBDIntegrator:
                 # ----------------------------
 
                 if model.joint_count:
-                    wp.launch(
-                        kernel=solve_body_joints,
-                        dim=model.joint_count,
-                        inputs=[
-                            state_out.body_q,
-                            state_out.body_qd,
-                            model.body_com,
-                            model.body_inv_mass,
-                            model.body_inv_inertia,
-                            model.joint_type,
-                            model.joint_enabled,
-                            model.joint_parent,
-                            model.joint_child,
-                            model.joint_X_p,
-                            model.joint_X_c,
-                            model.joint_limit_lower,
-                            model.joint_limit_upper,
-                            model.joint_axis_start,
-                            model.joint_axis_dim,
-                            model.joint_axis_mode,
-                            model.joint_axis,
-                            model.joint_target,
-                            model.joint_target_ke,
-                            model.joint_target_kd,
-                            model.joint_linear_compliance,
-                            model.joint_angular_compliance,
-                            self.joint_angular_relaxation,
-                            self.joint_linear_relaxation,
-                            dt,
-                        ],
-                        outputs=[state_out.body_deltas],
-                        device=model.device,
-                    )
+                    for color_ids, count in self._constraint_colors(
+                        model.joint_colors, model.joint_count, requires_grad
+                    ):
+                        if color_ids is not None:
+                            state_out.body_deltas.zero_()
 
-                    # apply updates
-                    wp.launch(
-                        kernel=apply_body_deltas,
-                        dim=model.body_count,
-                        inputs=[
-                            state_out.body_q,
-                            state_out.body_qd,
-                            model.body_com,
-                            model.body_inertia,
-                            model.body_inv_mass,
-                            model.body_inv_inertia,
-                            state_out.body_deltas,
-                            None,
-                            dt,
-                        ],
-                        outputs=[
-                            out_body_q,
-                            out_body_qd,
-                        ],
-                        device=model.device,
-                    )
+                        wp.launch(
+                            kernel=solve_body_joints,
+                            dim=count,
+                            inputs=[
+                                state_out.body_q,
+                                state_out.body_qd,
+                                model.body_com,
+                                model.body_inv_mass,
+                                model.body_inv_inertia,
+                                model.joint_type,
+                                model.joint_enabled,
+                                model.joint_parent,
+                                model.joint_child,
+                                model.joint_X_p,
+                                model.joint_X_c,
+                                model.joint_limit_lower,
+                                model.joint_limit_upper,
+                                model.joint_axis_start,
+                                model.joint_axis_dim,
+                                model.joint_axis_mode,
+                                model.joint_axis,
+                                model.joint_target,
+                                model.joint_target_ke,
+                                model.joint_target_kd,
+                                model.joint_linear_compliance,
+                                model.joint_angular_compliance,
+                                self.joint_angular_relaxation,
+                                self.joint_linear_relaxation,
+                                dt,
+                                color_ids,
+                            ],
+                            outputs=[state_out.body_deltas],
+                            device=model.device,
+                        )
+
+                        # apply updates
+                        wp.launch(
+                            kernel=apply_body_deltas,
+                            dim=model.body_count,
+                            inputs=[
+                                state_out.body_q,
+                                state_out.body_qd,
+                                model.body_com,
+                                model.body_inertia,
+                                model.body_inv_mass,
+                                model.body_inv_inertia,
+                                state_out.body_deltas,
+                                None,
+                                dt,
+                            ],
+                            outputs=[
+                                out_body_q,
+                                out_body_qd,
+                            ],
+                            device=model.device,
+                        )
 
                 if model.body_count and requires_grad:
                     # update state
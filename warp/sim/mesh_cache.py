@@ -0,0 +1,153 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import concurrent.futures
+import hashlib
+import os
+from typing import Iterable, List, Tuple
+
+import numpy as np
+
+from warp.sim.model import Mesh
+
+
+class MeshCache:
+    """Cache of the collision meshes loaded from asset files by the URDF and MJCF importers.
+
+    Meshes are keyed by file and scale, so importing the same asset several times, e.g. once per environment
+    or for robot variants sharing parts, parses each file and computes its inertia only once, and the imported
+    shapes share the same :class:`warp.sim.Mesh` objects. Files are parsed in parallel when prefetched.
+
+    If a cache directory is given, the preprocessed vertices, indices and inertia properties are also stored on
+    disk, keyed by the file content, so later processes skip parsing entirely.
+    """
+
+    # bump when the format of the files stored in the cache directory changes
+    VERSION = 1
+
+    def __init__(self, cache_dir: str = None, max_workers: int = None):
+        """
+        Args:
+            cache_dir: Directory storing the preprocessed meshes across processes, or None to only cache in memory
+            max_workers: Maximum number of threads parsing mesh files, defaults to the executor's default
+        """
+        self.cache_dir = cache_dir
+        self.max_workers = max_workers
+        self._meshes = {}
+
+        if cache_dir is not None:
+            os.makedirs(cache_dir, exist_ok=True)
+
+    def clear(self):
+        """Drops the meshes cached in memory, the cache directory is left untouched"""
+        self._meshes.clear()
+
+    def load(self, filename: str, scale=(1.0, 1.0, 1.0), is_solid: bool = True) -> List[Mesh]:
+        """Returns the meshes of an asset file with vertices scaled by `scale`, one for each geometry in the file
+
+        Args:
+            filename: Path of a mesh file in a format supported by ``trimesh``
+            scale: Scale applied to the vertex coordinates
+            is_solid: Whether the inertia of the meshes is computed as solids or hollow surfaces
+        """
+        key = self._key(filename, scale, is_solid)
+        meshes = self._meshes.get(key)
+        if meshes is None:
+            meshes = self._finalize(*self._read(filename, scale, is_solid), is_solid)
+            self._meshes[key] = meshes
+        return meshes
+
+    def prefetch(self, assets: Iterable[Tuple[str, tuple]], is_solid: bool = True):
+        """Loads several asset files in parallel, so that the subsequent :meth:`load` calls are cache hits
+
+        Args:
+            assets: Pairs of filename and scale
+            is_solid: Whether the inertia of the meshes is computed as solids or hollow surfaces
+        """
+        pending = {}
+        for filename, scale in assets:
+            key = self._key(filename, scale, is_solid)
+            if key not in self._meshes and key not in pending:
+                pending[key] = (filename, scale)
+
+        if not pending:
+            return
+
+        # file parsing runs in worker threads, inertia computations launch kernels from the calling thread
+        with concurrent.futures.ThreadPoolExecutor(max_workers=self.max_workers) as executor:
+            futures = {
+                key: executor.submit(self._read, filename, scale, is_solid)
+                for key, (filename, scale) in pending.items()
+            }
+
+        for key, future in futures.items():
+            self._meshes[key] = self._finalize(*future.result(), is_solid)
+
+    @staticmethod
+    def _key(filename, scale, is_solid):
+        path = os.path.abspath(filename)
+        stat = os.stat(path)
+        return (path, stat.st_mtime_ns, stat.st_size, tuple(float(s) for s in np.broadcast_to(scale, 3)), is_solid)
+
+    def _read(self, filename, scale, is_solid):
+        """Returns the path of the file storing the preprocessed meshes, and either its archive if it exists
+        or the list of (vertices, indices) of the geometries parsed from the asset file"""
+        disk_path = None
+        if self.cache_dir is not None:
+            with open(filename, "rb") as f:
+                digest = hashlib.sha1(f.read())
+            digest.update(np.asarray(np.broadcast_to(scale, 3), dtype=np.float64).tobytes())
+            digest.update(f"{is_solid}-{MeshCache.VERSION}".encode())
+            disk_path = os.path.join(self.cache_dir, digest.hexdigest() + ".npz")
+
+            if os.path.exists(disk_path):
+                return disk_path, np.load(disk_path)
+
+        import trimesh
+
+        m = trimesh.load(filename)
+        # multiple meshes are contained in a scene
+        geometries = m.geometry.values() if hasattr(m, "geometry") else [m]
+
+        scale = np.asarray(scale, dtype=np.float32)
+        geometries = [
+            (np.array(geom.vertices, dtype=np.float32) * scale, np.array(geom.faces, dtype=np.int32).flatten())
+            for geom in geometries
+        ]
+        return disk_path, geometries
+
+    def _finalize(self, disk_path, data, is_solid):
+        if isinstance(data, np.lib.npyio.NpzFile):
+            meshes = []
+            for i in range(int(data["count"])):
+                mesh = Mesh(data[f"vertices_{i}"], data[f"indices_{i}"], compute_inertia=False, is_solid=is_solid)
+                mesh.has_inertia = True
+                mesh.mass = float(data[f"mass_{i}"])
+                mesh.com = data[f"com_{i}"]
+                mesh.I = data[f"I_{i}"]
+                meshes.append(mesh)
+            data.close()
+            return meshes
+
+        meshes = [Mesh(vertices, indices, is_solid=is_solid) for vertices, indices in data]
+
+        if disk_path is not None:
+            arrays = {"count": len(meshes)}
+            for i, mesh in enumerate(meshes):
+                arrays[f"vertices_{i}"] = mesh.vertices
+                arrays[f"indices_{i}"] = mesh.indices
+                arrays[f"mass_{i}"] = mesh.mass
+                arrays[f"com_{i}"] = np.asarray(mesh.com)
+                arrays[f"I_{i}"] = np.asarray(mesh.I)
+
+            # write atomically so that concurrent processes never read partial files
+            tmp_path = f"{disk_path}.{os.getpid()}.tmp"
+            with open(tmp_path, "wb") as f:
+                np.savez(f, **arrays)
+            os.replace(tmp_path, disk_path)
+
+        return meshes
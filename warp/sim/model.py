@@ -10,7 +10,7 @@
 
 import copy
 import math
-from typing import List, Optional, Tuple
+from typing import Any, List, Optional, Tuple
 
 import numpy as np
 
@@ -71,6 +71,209 @@ def flag_to_int(flag):
     return int(flag)
 
 
+# kinds of elements whose per-environment ranges are recorded by ModelBuilder.add_builder()
+ENV_ELEMENT_KINDS = ("body", "shape", "joint", "joint_coord", "joint_dof", "joint_axis")
+
+
+@wp.kernel
+def reset_env_elements(
+    env_ids: wp.array(dtype=int),
+    start: int,
+    count: int,
+    src: wp.array(dtype=Any),
+    dst: wp.array(dtype=Any),
+):
+    env, i = wp.tid()
+    j = start + env_ids[env] * count + i
+    dst[j] = src[j]
+
+
+@wp.kernel
+def restore_env_segments(
+    env_ids: wp.array(dtype=int),
+    seg_offset: wp.array(dtype=int),
+    seg_size: wp.array(dtype=int),
+    src: wp.array(dtype=wp.uint32),
+    dst: wp.array(dtype=wp.uint32),
+):
+    # copies word i of segment seg of an environment, segments are the per-env rows of the arrays of a state
+    # arena, which are contiguous so that the row of an environment is seg_size words after the previous one
+    env, seg, i = wp.tid()
+    if i >= seg_size[seg]:
+        return
+    j = seg_offset[seg] + env_ids[env] * seg_size[seg] + i
+    dst[j] = src[j]
+
+
+# alignment in bytes of the arrays that share the allocation of a state, see State.allocate()
+STATE_ARENA_ALIGNMENT = 256
+
+
+@wp.kernel
+def replicate_elements(src: wp.array(dtype=Any), count: int, dst: wp.array(dtype=Any)):
+    env, i = wp.tid()
+    dst[env * count + i] = src[i]
+
+
+@wp.kernel
+def replicate_indices(src: wp.array(dtype=int), count: int, offset: int, dst: wp.array(dtype=int)):
+    env, i = wp.tid()
+    j = src[i]
+    # negative indices refer to the world and are kept
+    if j >= 0:
+        j += env * offset
+    dst[env * count + i] = j
+
+
+@wp.kernel
+def replicate_transforms(
+    src: wp.array(dtype=wp.transform),
+    mask: wp.array(dtype=int),
+    env_xforms: wp.array(dtype=wp.transform),
+    count: int,
+    dst: wp.array(dtype=wp.transform),
+):
+    env, i = wp.tid()
+    X = src[i]
+    if mask[i] != 0:
+        X = env_xforms[env] * X
+    dst[env * count + i] = X
+
+
+@wp.kernel
+def replicate_free_joint_coords(
+    free_joint_q_start: wp.array(dtype=int),
+    env_xforms: wp.array(dtype=wp.transform),
+    count: int,
+    joint_q: wp.array(dtype=float),
+):
+    env, i = wp.tid()
+    s = env * count + free_joint_q_start[i]
+    p = wp.vec3(joint_q[s + 0], joint_q[s + 1], joint_q[s + 2])
+    q = wp.quat(joint_q[s + 3], joint_q[s + 4], joint_q[s + 5], joint_q[s + 6])
+    X = env_xforms[env] * wp.transform(p, q)
+    p = wp.transform_get_translation(X)
+    q = wp.transform_get_rotation(X)
+    for k in range(3):
+        joint_q[s + k] = p[k]
+    for k in range(4):
+        joint_q[s + 3 + k] = q[k]
+
+
+@wp.kernel
+def replicate_contact_pairs(
+    src: wp.array2d(dtype=int),
+    count: int,
+    offset: int,
+    ground: int,
+    env_ground: int,
+    dst: wp.array2d(dtype=int),
+):
+    env, i, k = wp.tid()
+    s = src[i, k]
+    # all environments share the ground plane, which is the last shape of the replicated model
+    if s == ground:
+        s = env_ground
+    else:
+        s += env * offset
+    dst[env * count + i, k] = s
+
+
+@wp.func
+def body_speed(qd: wp.spatial_vector):
+    # norm of the body twist, compared against Model.body_sleep_velocity
+    return wp.length(wp.spatial_top(qd)) + wp.length(wp.spatial_bottom(qd))
+
+
+@wp.kernel
+def update_body_sleep(
+    body_qd: wp.array(dtype=wp.spatial_vector),
+    body_island: wp.array(dtype=int),
+    island_wake: wp.array(dtype=int),
+    sleep_velocity: float,
+    sleep_time: float,
+    dt: float,
+    # outputs
+    body_sleep_timer: wp.array(dtype=float),
+    island_awake: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    island = body_island[tid]
+
+    timer = body_sleep_timer[tid] + dt
+    if body_speed(body_qd[tid]) > sleep_velocity or island_wake[island] != 0:
+        timer = 0.0
+    body_sleep_timer[tid] = timer
+
+    # an island stays awake as long as one of its bodies has not been at rest for sleep_time
+    if timer < sleep_time:
+        island_awake[island] = 1
+
+
+@wp.kernel
+def mark_active_bodies(
+    body_island: wp.array(dtype=int),
+    island_awake: wp.array(dtype=int),
+    body_q: wp.array(dtype=wp.transform),
+    # outputs
+    body_active: wp.array(dtype=int),
+    body_q_new: wp.array(dtype=wp.transform),
+    body_qd_new: wp.array(dtype=wp.spatial_vector),
+):
+    tid = wp.tid()
+    active = island_awake[body_island[tid]]
+    body_active[tid] = active
+
+    if active == 0:
+        # sleeping bodies are not integrated, keep them at rest in the output state
+        body_q_new[tid] = body_q[tid]
+        body_qd_new[tid] = wp.spatial_vector()
+
+
+@wp.kernel
+def compact_active_bodies(
+    body_active: wp.array(dtype=int),
+    body_active_offset: wp.array(dtype=int),
+    body_count: int,
+    # outputs
+    body_active_indices: wp.array(dtype=int),
+    body_active_count: wp.array(dtype=int),
+):
+    tid = wp.tid()
+    if body_active[tid] != 0:
+        body_active_indices[body_active_offset[tid]] = tid
+    if tid == body_count - 1:
+        body_active_count[0] = body_active_offset[tid] + body_active[tid]
+
+
+def color_constraints_greedy(indices, movable, device=None):
+    """Greedily partitions constraints into colors such that no two constraints of a color share a movable node.
+
+    Args:
+        indices: Node indices of each constraint, shape [constraint_count, nodes_per_constraint], negative indices are ignored
+        movable: Whether each node is moved by the constraints, nodes that are not movable may be shared within a color
+        device: The device on which the color arrays are allocated
+
+    Returns:
+        A list of int32 arrays holding the constraint indices of each color
+    """
+    used = [0] * len(movable)
+    colors = []
+    for tid, nodes in enumerate(indices):
+        nodes = [int(n) for n in nodes if n >= 0 and movable[n]]
+        mask = 0
+        for n in nodes:
+            mask |= used[n]
+        # lowest color not used by any constraint sharing a node
+        color = (~mask & (mask + 1)).bit_length() - 1
+        for n in nodes:
+            used[n] |= 1 << color
+        if color == len(colors):
+            colors.append([])
+        colors[color].append(tid)
+    return [wp.array(np.array(c, dtype=np.int32), dtype=wp.int32, device=device) for c in colors]
+
+
 # Material properties pertaining to rigid shape contact dynamics
 @wp.struct
 class ModelShapeMaterials:
@@ -237,6 +440,9 @@ class State:
         body_qd (wp.array): Tensor of body velocities
         body_f (wp.array): Tensor of body forces
 
+    The arrays created by :func:`Model.state()` are views into a single allocation (the arena), so that
+    :func:`clone` and :func:`assign` take one device copy, e.g. to snapshot and restore a simulation.
+
     """
 
     def __init__(self):
@@ -252,6 +458,107 @@ class State:
         self.body_qd = None
         self.body_f = None
 
+        # single allocation holding the arrays listed in _arena_fields as (name, dtype, shape, byte offset)
+        self._arena = None
+        self._grad_arena = None
+        self._arena_fields = []
+
+    def allocate(self, fields, device, requires_grad=False):
+        """
+        Allocates zero-initialized arrays as views into one contiguous arena and assigns them as attributes.
+
+        Args:
+            fields: List of (name, dtype, shape) of the arrays
+            device: The device of the arena
+            requires_grad: Whether to allocate a gradient arena with the same layout
+        """
+        device = wp.get_device(device)
+
+        layout = []
+        size = 0
+        for name, dtype, shape in fields:
+            size = (size + STATE_ARENA_ALIGNMENT - 1) // STATE_ARENA_ALIGNMENT * STATE_ARENA_ALIGNMENT
+            layout.append((name, dtype, tuple(shape), size))
+            size += wp.types.type_size_in_bytes(dtype) * int(np.prod(shape))
+
+        # keep the allocation non-empty so that the views have a valid base pointer
+        size = max(size, 4)
+        self._arena = wp.zeros(size, dtype=wp.uint8, device=device)
+        self._grad_arena = wp.zeros(size, dtype=wp.uint8, device=device) if requires_grad else None
+        self._arena_fields = layout
+
+        for name, dtype, shape, offset in layout:
+            a = self._arena_view(self._arena, dtype, shape, offset)
+            if requires_grad:
+                a.grad = self._arena_view(self._grad_arena, dtype, shape, offset)
+            setattr(self, name, a)
+
+    @staticmethod
+    def _arena_view(arena, dtype, shape, offset):
+        a = wp.array(ptr=arena.ptr + offset, dtype=dtype, shape=shape, device=arena.device, owner=False)
+        # keep the arena alive as long as the view
+        a._ref = arena
+        return a
+
+    def _arena_intact(self):
+        # the arrays have not been replaced by separate allocations since allocate()
+        return self._arena is not None and all(
+            getattr(self, name) is not None and getattr(self, name).ptr == self._arena.ptr + offset
+            for name, _, _, offset in self._arena_fields
+        )
+
+    def _same_layout(self, other):
+        return (
+            self._arena_intact()
+            and other._arena_intact()
+            and self._arena.device == other._arena.device
+            and self._arena.size == other._arena.size
+            and [f[:3] for f in self._arena_fields] == [f[:3] for f in other._arena_fields]
+        )
+
+    def assign(self, src):
+        """
+        Copies the arrays of ``src``, e.g. a snapshot taken with :func:`clone`, into this state. States
+        created by the same model share their arena layout and are copied with a single device copy.
+        Gradients are not copied.
+        """
+        if self._same_layout(src):
+            wp.copy(self._arena, src._arena)
+            names = set(f[0] for f in self._arena_fields)
+        else:
+            names = set()
+
+        for name, value in src.__dict__.items():
+            if name in names or name.startswith("_") or not isinstance(value, wp.array):
+                continue
+            dst = getattr(self, name, None)
+            if isinstance(dst, wp.array) and dst.shape == value.shape:
+                wp.copy(dst, value)
+
+    def clone(self, requires_grad=None):
+        """
+        Returns a copy of the state with its own arena, requires_grad defaults to that of the copied state.
+        """
+        if requires_grad is None:
+            requires_grad = self._grad_arena is not None
+
+        s = State()
+        for name, value in self.__dict__.items():
+            if not name.startswith("_") and not isinstance(value, wp.array):
+                setattr(s, name, value)
+
+        if self._arena is not None:
+            s.allocate([f[:3] for f in self._arena_fields], self._arena.device, requires_grad)
+            s.assign(self)
+
+        # arrays that are not part of the arena, e.g. scratch buffers of the integrators
+        names = set(f[0] for f in self._arena_fields)
+        for name, value in self.__dict__.items():
+            if isinstance(value, wp.array) and not name.startswith("_") and name not in names:
+                setattr(s, name, wp.clone(value, requires_grad=value.requires_grad))
+
+        return s
+
     def clear_forces(self):
         if self.particle_count:
             self.particle_f.zero_()
@@ -276,7 +583,7 @@ class State:
 
         # build a list of all tensor attributes
         for attr, value in self.__dict__.items():
-            if isinstance(value, wp.array):
+            if isinstance(value, wp.array) and not attr.startswith("_"):
                 arrays.append(value)
 
         return arrays
@@ -364,6 +671,8 @@ class Model:
     Attributes:
         requires_grad (float): Indicates whether the model was finalized with gradient computation enabled
         num_envs (int): Number of articulation environments that were added to the ModelBuilder via `add_builder`
+        env_layout (dict): Maps each kind of element ("body", "shape", "joint", "joint_coord", "joint_dof", "joint_axis") to the (start, count) of its
+            elements in the first environment if all environments store the same number of them back to back, see :func:`env_view`
 
         particle_q (wp.array): Particle positions, shape [particle_count, 3], float
         particle_qd (wp.array): Particle velocities, shape [particle_count, 3], float
@@ -394,6 +703,9 @@ class Model:
         shape_collision_radius (wp.array): Collision radius of each shape used for bounding sphere broadphase collision checking, shape [shape_count], float
         shape_ground_collision (list): Indicates whether each shape should collide with the ground, shape [shape_count], bool
         shape_contact_pairs (wp.array): Pairs of shape indices that may collide, shape [contact_pair_count, 2], int
+        shape_contact_pair_found (wp.array): Number of overlapping shape pairs found by the last dynamic broadphase update, may exceed shape_contact_pair_count, shape [1], int
+        shape_bvh (wp.Bvh): BVH over the shape bounds used by the dynamic broadphase, None if the contact pairs are precomputed
+        dynamic_broadphase (bool): Whether the shape contact pairs are found every step by the dynamic broadphase, see :func:`update_shape_contact_pairs`
         shape_ground_contact_pairs (wp.array): Pairs of shape, ground indices that may collide, shape [ground_contact_pair_count, 2], int
 
         spring_indices (wp.array): Particle spring indices, shape [spring_count*2], int
@@ -416,6 +728,11 @@ class Model:
         tet_activations (wp.array): Tetrahedral volumetric activations, shape [tet_count], float
         tet_materials (wp.array): Tetrahedral elastic parameters in form :math:`k_{mu}, k_{lambda}, k_{damp}`, shape [tet_count, 3]
 
+        spring_colors (list): Spring indices of each constraint color, see :func:`color_constraints`, None if not colored
+        edge_colors (list): Bending edge indices of each constraint color, None if not colored
+        tet_colors (list): Tetrahedral element indices of each constraint color, None if not colored
+        joint_colors (list): Joint indices of each constraint color, None if not colored
+
         body_q (wp.array): Poses of rigid bodies used for state initialization, shape [body_count, 7], float
         body_qd (wp.array): Velocities of rigid bodies used for state initialization, shape [body_count, 6], float
         body_com (wp.array): Rigid body center of mass (in local frame), shape [body_count, 7], float
@@ -453,11 +770,18 @@ class Model:
         joint_q_start (wp.array): Start index of the first position coordinate per joint, shape [joint_count], int
         joint_qd_start (wp.array): Start index of the first velocity coordinate per joint, shape [joint_count], int
         articulation_start (wp.array): Articulation start index, shape [articulation_count], int
+        joint_level_joints (wp.array): Joint indices sorted by their depth in the kinematic tree, shape [joint_count], int
+        joint_level_start (list): Start index of each depth level in joint_level_joints, shape [joint_level_count + 1], int
         joint_name (list): Joint names, shape [joint_count], str
         joint_attach_ke (float): Joint attachment force stiffness (used by SemiImplicitIntegrator)
         joint_attach_kd (float): Joint attachment force damping (used by SemiImplicitIntegrator)
 
         soft_contact_margin (float): Contact margin for generation of soft contacts
+        soft_contact_broadphase (bool): Whether the particle-shape pairs of the soft contacts are found by querying a BVH over the shape bounds, see :func:`update_soft_contact_pairs`, if None it is used for more than 8 shapes
+        soft_contact_pair_max (int): Number of particle-shape pairs the soft contact broadphase can store
+        soft_contact_pair_found (wp.array): Number of particle-shape pairs found by the last soft contact broadphase update, may exceed soft_contact_pair_max, shape [1], int
+        soft_contact_compact (bool): Whether the soft contacts store their shape index as uint16 and their normal as a vec2h in octahedral encoding, see :func:`allocate_soft_contacts`
+        soft_contact_dynamic (bool): Whether :func:`warp.sim.collide` grows the soft contact buffers when more contacts are found than they can hold, see :func:`grow_soft_contacts`
         soft_contact_ke (float): Stiffness of soft contacts (used by SemiImplicitIntegrator)
         soft_contact_kd (float): Damping of soft contacts (used by SemiImplicitIntegrator)
         soft_contact_kf (float): Stiffness of friction force in soft contacts (used by SemiImplicitIntegrator)
@@ -467,6 +791,15 @@ class Model:
         rigid_contact_margin (float): Contact margin for generation of rigid body contacts
         rigid_contact_torsional_friction (float): Torsional friction coefficient for rigid body contacts (used by XPBDIntegrator)
         rigid_contact_rolling_friction (float): Rolling friction coefficient for rigid body contacts (used by XPBDIntegrator)
+        rigid_contact_reduction (bool): Whether the contacts of box, capsule and mesh pairs are reduced to at most 4 per pair by :func:`warp.sim.collide`
+        rigid_contact_cache (bool): Whether the reduced contacts of a shape pair are reused while the relative transform of its shapes barely changes
+        rigid_contact_cache_tolerance (float): Displacement of the shapes of a pair below which its cached contacts are reused
+
+        body_sleep (bool): Whether islands of bodies at rest fall asleep and are skipped by the SemiImplicitIntegrator
+        body_sleep_velocity (float): Norm of the body twist below which a body is considered at rest
+        body_sleep_time (float): Time after which an island whose bodies are all at rest falls asleep
+        body_island (wp.array): Island of bodies connected by joints of each body, shape [body_count], int
+        body_active_indices (wp.array): Indices of the bodies of awake islands, the first body_active_count[0] are valid, shape [body_count], int
 
         ground (bool): Whether the ground plane and ground contacts are enabled
         ground_plane (wp.array): Ground plane 3D normal and offset, shape [4], float
@@ -499,6 +832,7 @@ class Model:
     def __init__(self, device=None):
         self.requires_grad = False
         self.num_envs = 0
+        self.env_layout = {}
 
         self.particle_q = None
         self.particle_qd = None
@@ -529,8 +863,25 @@ class Model:
         self.shape_collision_radius = None
         self.shape_ground_collision = None
         self.shape_contact_pairs = None
+        self.shape_contact_pair_found = None
         self.shape_ground_contact_pairs = None
 
+        self.soft_contact_broadphase = None
+        self.soft_contact_pair_max = None
+        self.soft_contact_pairs = None
+        self.soft_contact_pair_found = None
+        self.soft_contact_shape_bvh = None
+        self.soft_contact_compact = False
+        self.soft_contact_dynamic = False
+
+        self.dynamic_broadphase = False
+        self.shape_contact_pair_max = None
+        self.shape_bvh = None
+        self.shape_bvh_lowers = None
+        self.shape_bvh_uppers = None
+        self.shape_collision_group_array = None
+        self.shape_collision_filter_keys = None
+
         self.spring_indices = None
         self.spring_rest_length = None
         self.spring_stiffness = None
@@ -551,6 +902,11 @@ class Model:
         self.tet_activations = None
         self.tet_materials = None
 
+        self.spring_colors = None
+        self.edge_colors = None
+        self.tet_colors = None
+        self.joint_colors = None
+
         self.body_q = None
         self.body_qd = None
         self.body_com = None
@@ -590,6 +946,9 @@ class Model:
         self.joint_q_start = None
         self.joint_qd_start = None
         self.articulation_start = None
+        self.joint_level_joints = None
+        self.joint_level_start = [0]
+        self.joint_level_count = 0
         self.joint_name = None
 
         self.composite_rigid_body_alg = False
@@ -608,6 +967,22 @@ class Model:
         self.rigid_contact_margin = None
         self.rigid_contact_torsional_friction = None
         self.rigid_contact_rolling_friction = None
+        self.rigid_contact_reduction = False
+        self.rigid_contact_cache = False
+        self.rigid_contact_cache_tolerance = 1.0e-4
+
+        self.rigid_contact_pair_size = None
+        self.rigid_contact_pair_index = None
+        self.rigid_contact_pair_skip = None
+        self.rigid_contact_cache_count = None
+
+        self.body_sleep = False
+        self.body_sleep_velocity = 0.05
+        self.body_sleep_time = 0.5
+        self.island_count = 0
+        self.body_island = None
+        self.body_active_indices = None
+        self.body_active_count = None
 
         # toggles ground contact for all shapes
         self.ground = True
@@ -649,35 +1024,29 @@ class Model:
         # --------------------------------
         # dynamic state (input, output)
 
+        # (name, source array or None for zeros, like array), all allocated in one arena
+        fields = []
+
         # particles
         if self.particle_count:
-            s.particle_q = wp.clone(self.particle_q)
-            s.particle_qd = wp.clone(self.particle_qd)
-            s.particle_f = wp.zeros_like(self.particle_qd)
-
-            s.particle_q.requires_grad = requires_grad
-            s.particle_qd.requires_grad = requires_grad
-            s.particle_f.requires_grad = requires_grad
+            fields.append(("particle_q", self.particle_q, self.particle_q))
+            fields.append(("particle_qd", self.particle_qd, self.particle_qd))
+            fields.append(("particle_f", None, self.particle_qd))
 
         # articulations
         if self.body_count:
-            s.body_q = wp.clone(self.body_q)
-            s.body_qd = wp.clone(self.body_qd)
-            s.body_f = wp.zeros_like(self.body_qd)
-
-            s.body_deltas = wp.zeros(
-                self.body_count, dtype=wp.spatial_vector, device=s.body_q.device, requires_grad=requires_grad
-            )
-
-            s.body_q.requires_grad = requires_grad
-            s.body_qd.requires_grad = requires_grad
-            s.body_f.requires_grad = requires_grad
-
-            s.joint_q = wp.clone(self.joint_q)
-            s.joint_qd = wp.clone(self.joint_qd)
-
-            s.joint_q.requires_grad = requires_grad
-            s.joint_qd.requires_grad = requires_grad
+            fields.append(("body_q", self.body_q, self.body_q))
+            fields.append(("body_qd", self.body_qd, self.body_qd))
+            fields.append(("body_f", None, self.body_qd))
+            fields.append(("body_deltas", None, self.body_qd))
+            fields.append(("joint_q", self.joint_q, self.joint_q))
+            fields.append(("joint_qd", self.joint_qd, self.joint_qd))
+
+        if fields:
+            s.allocate([(name, like.dtype, like.shape) for name, _, like in fields], self.device, requires_grad)
+            for name, src, _ in fields:
+                if src is not None:
+                    wp.copy(getattr(s, name), src)
         
         if self.composite_rigid_body_alg:
             # joints
@@ -761,12 +1130,58 @@ class Model:
         return s
 
     def allocate_soft_contacts(self, count, requires_grad=False):
+        """Allocates the buffers of ``count`` soft contacts
+
+        With ``soft_contact_compact``, the shape indices are stored as uint16 and the normals as the two fp16
+        coordinates of their octahedral encoding, which takes 34 bytes per contact instead of 44. Kernels convert the
+        shape indices with ``int()`` and decode the normals with :func:`warp.sim.utils.load_contact_normal`. Compact
+        contacts are not differentiable.
+        """
+        shape_dtype = int
+        normal_dtype = wp.vec3
+        if self.soft_contact_compact:
+            if requires_grad:
+                raise RuntimeError("Compact soft contacts are not differentiable, disable Model.soft_contact_compact")
+            if self.shape_count > 65536:
+                raise RuntimeError("Compact soft contacts store shape indices as uint16, use at most 65536 shapes")
+            shape_dtype = wp.uint16
+            normal_dtype = wp.vec2h
+
         self.soft_contact_count = wp.zeros(1, dtype=wp.int32, device=self.device)
         self.soft_contact_particle = wp.zeros(count, dtype=int, device=self.device)
-        self.soft_contact_shape = wp.zeros(count, dtype=int, device=self.device)
+        self.soft_contact_shape = wp.zeros(count, dtype=shape_dtype, device=self.device)
         self.soft_contact_body_pos = wp.zeros(count, dtype=wp.vec3, device=self.device, requires_grad=requires_grad)
         self.soft_contact_body_vel = wp.zeros(count, dtype=wp.vec3, device=self.device, requires_grad=requires_grad)
-        self.soft_contact_normal = wp.zeros(count, dtype=wp.vec3, device=self.device, requires_grad=requires_grad)
+        self.soft_contact_normal = wp.zeros(count, dtype=normal_dtype, device=self.device, requires_grad=requires_grad)
+
+    def grow_soft_contacts(self):
+        """Reallocates the soft contact buffers to hold all the contacts found by the last :func:`warp.sim.collide`
+
+        The pairs of the soft contact broadphase are grown first, if they overflowed. The counts are read back to the
+        host, so this synchronizes the device and can't be captured in a CUDA graph. The capacities are rounded up to
+        a power of two so that they only grow a few times, and the contacts need to be generated again after the
+        buffers grew.
+
+        Returns:
+            Whether the buffers were reallocated
+        """
+        if self.use_soft_contact_broadphase() and self.soft_contact_pairs is not None:
+            found = int(self.soft_contact_pair_found.numpy()[0])
+            if found > self.soft_contact_pair_max:
+                self.soft_contact_pair_max = 1 << (found - 1).bit_length()
+                self.soft_contact_pairs = wp.empty((self.soft_contact_pair_max, 2), dtype=wp.int32, device=self.device)
+                # the contact count is incomplete until the missing pairs are evaluated
+                return True
+
+        count = int(self.soft_contact_count.numpy()[0])
+        if count <= self.soft_contact_max:
+            return False
+
+        requires_grad = self.soft_contact_body_pos.requires_grad
+        self.allocate_soft_contacts(1 << (count - 1).bit_length(), requires_grad=requires_grad)
+        # the scratch arrays of the deterministic mode are sized for the old capacity
+        self.__dict__.get("_deterministic_buffers", {}).pop("soft_contacts", None)
+        return True
 
     def alloc_mass_matrix(self):
         if (self.body_count):
@@ -790,7 +1205,9 @@ class Model:
         for a, b in self.shape_collision_filter_pairs:
             filters.add((b, a))
         contact_pairs = []
-        if not self.composite_rigid_body_alg:
+        if not self.composite_rigid_body_alg and self.dynamic_broadphase:
+            self._create_dynamic_broadphase()
+        elif not self.composite_rigid_body_alg:
             # iterate over collision groups (islands)
             for group, shapes in self.shape_collision_group_map.items():
                 for shape_a, shape_b in itertools.product(shapes, shapes):
@@ -815,6 +1232,315 @@ class Model:
         self.shape_ground_contact_pairs = wp.array(np.array(ground_contact_pairs), dtype=wp.int32, device=self.device)
         self.shape_ground_contact_pair_count = len(ground_contact_pairs)
 
+    def compute_joint_levels(self):
+        """
+        Groups the joints by their depth in the kinematic tree, where root joints have depth 0 and the joint
+        of a child body is one level deeper than the joint of its parent body. The joints of a level only
+        depend on the levels above, so that level-synchronous algorithms such as the level-parallel mode of
+        :class:`SemiImplicitArticulationIntegrator` process all joints of a level in parallel.
+        """
+        if not self.joint_count:
+            self.joint_level_joints = None
+            self.joint_level_start = [0]
+            self.joint_level_count = 0
+            return
+
+        joint_parent = self.joint_parent.numpy()
+        joint_child = self.joint_child.numpy()
+
+        body_joint = np.full(max(self.body_count, 1), -1, dtype=np.int32)
+        body_joint[joint_child] = np.arange(self.joint_count, dtype=np.int32)
+
+        level = np.full(self.joint_count, -1, dtype=np.int32)
+        for j in range(self.joint_count):
+            # walk up to the first joint of known depth, then assign the depths on the way back down
+            chain = []
+            k = j
+            while k >= 0 and level[k] < 0:
+                chain.append(k)
+                parent = joint_parent[k]
+                k = body_joint[parent] if parent >= 0 else -1
+                if len(chain) > self.joint_count:
+                    raise RuntimeError("The joints of the model contain a kinematic loop")
+            depth = level[k] + 1 if k >= 0 else 0
+            for k in reversed(chain):
+                level[k] = depth
+                depth += 1
+
+        order = np.argsort(level, kind="stable").astype(np.int32)
+        counts = np.bincount(level)
+        self.joint_level_joints = wp.array(order, dtype=wp.int32, device=self.device)
+        self.joint_level_start = [0] + np.cumsum(counts).tolist()
+        self.joint_level_count = len(counts)
+
+    def env_view(self, a, kind):
+        """
+        Returns a view of the per-element array ``a`` with shape [num_envs, count], where row ``i`` holds the
+        elements of environment ``i``, e.g. ``model.env_view(state.body_q, "body")``. The environments must
+        have been added by :func:`ModelBuilder.add_builder` with the same number of elements of ``kind``.
+        """
+        if kind not in self.env_layout:
+            raise RuntimeError(f"The {kind} elements of the model are not laid out uniformly per environment")
+
+        start, count = self.env_layout[kind]
+        return a[start : start + self.num_envs * count].reshape((self.num_envs, count))
+
+    def reset_envs(self, state, env_ids):
+        """
+        Resets the bodies and joints of the given environments in ``state`` to the initial state of the model.
+
+        Args:
+            state: The state to reset
+            env_ids: Indices of the environments to reset, a wp.array of int on the model's device
+        """
+        if len(env_ids) == 0:
+            return
+
+        resets = []
+        if self.body_count:
+            resets.extend(
+                [
+                    ("body", self.body_q, state.body_q),
+                    ("body", self.body_qd, state.body_qd),
+                    ("joint_coord", self.joint_q, state.joint_q),
+                    ("joint_dof", self.joint_qd, state.joint_qd),
+                ]
+            )
+
+        for kind, src, dst in resets:
+            start, count = self.env_layout.get(kind, (0, 0))
+            if count == 0:
+                continue
+            # one thread per element of each environment, environments are contiguous rows
+            wp.launch(
+                reset_env_elements,
+                dim=(len(env_ids), count),
+                inputs=[env_ids, start, count, src, dst],
+                device=self.device,
+            )
+
+    def restore_envs(self, state, snapshot, env_ids):
+        """
+        Restores the bodies and joints of the given environments in ``state`` from ``snapshot``, a state of
+        this model taken with :func:`State.clone`, using a single copy kernel over the arenas of the states.
+
+        Args:
+            state: The state to restore
+            snapshot: The state to restore from
+            env_ids: Indices of the environments to restore, a wp.array of int on the model's device
+        """
+        if len(env_ids) == 0:
+            return
+
+        if not state._same_layout(snapshot):
+            raise RuntimeError("The state and the snapshot must be created by this model")
+
+        # per-env rows of each array as (offset, size) in 32-bit words of the arena, cached per layout
+        kinds = {
+            "body_q": "body",
+            "body_qd": "body",
+            "body_f": "body",
+            "body_deltas": "body",
+            "joint_q": "joint_coord",
+            "joint_qd": "joint_dof",
+        }
+        key = tuple(f[:4] for f in state._arena_fields)
+        if getattr(self, "_env_segments_key", None) != key:
+            segments = []
+            for name, dtype, shape, offset in state._arena_fields:
+                start, count = self.env_layout.get(kinds.get(name), (0, 0))
+                if count == 0:
+                    continue
+                size = wp.types.type_size_in_bytes(dtype)
+                segments.append(((offset + start * size) // 4, count * size // 4))
+
+            seg_offset = [s[0] for s in segments]
+            seg_size = [s[1] for s in segments]
+            self._env_segments = (
+                wp.array(seg_offset, dtype=int, device=self.device),
+                wp.array(seg_size, dtype=int, device=self.device),
+                max(seg_size, default=0),
+            )
+            self._env_segments_key = key
+
+        seg_offset, seg_size, max_size = self._env_segments
+        if max_size == 0:
+            return
+
+        src = wp.array(ptr=snapshot._arena.ptr, dtype=wp.uint32, shape=snapshot._arena.size // 4, device=self.device)
+        dst = wp.array(ptr=state._arena.ptr, dtype=wp.uint32, shape=state._arena.size // 4, device=self.device)
+        src._ref = snapshot._arena
+        dst._ref = state._arena
+
+        wp.launch(
+            restore_env_segments,
+            dim=(len(env_ids), len(seg_size), max_size),
+            inputs=[env_ids, seg_offset, seg_size, src, dst],
+            device=self.device,
+        )
+
+    def color_constraints(self):
+        """
+        Partitions the springs, bending edges, tetrahedra and joints into colors of constraints that do not share
+        a movable particle or body, so that the constraints of a color can be solved in parallel without atomics
+        by the Gauss-Seidel mode of :class:`XPBDIntegrator`. Particles with zero inverse mass may be shared.
+        """
+        inv_mass = self.particle_inv_mass.numpy() if self.particle_count else []
+        movable = [m > 0.0 for m in inv_mass]
+
+        self.spring_colors = []
+        if self.spring_count:
+            indices = self.spring_indices.numpy().reshape(-1, 2)
+            self.spring_colors = color_constraints_greedy(indices, movable, self.device)
+        self.edge_colors = []
+        if self.edge_count:
+            self.edge_colors = color_constraints_greedy(self.edge_indices.numpy(), movable, self.device)
+        self.tet_colors = []
+        if self.tet_count:
+            self.tet_colors = color_constraints_greedy(self.tet_indices.numpy(), movable, self.device)
+        self.joint_colors = []
+        if self.joint_count:
+            # static bodies are updated by the body deltas as well, so they are not shared within a color
+            indices = np.stack((self.joint_parent.numpy(), self.joint_child.numpy()), axis=1)
+            self.joint_colors = color_constraints_greedy(indices, [True] * self.body_count, self.device)
+
+    def _create_dynamic_broadphase(self):
+        # shape pairs are found every step by querying a BVH over the shape bounds instead of
+        # testing all pairs of a collision group, pair slots beyond the found pairs hold -1
+        if self.shape_contact_pair_max is None:
+            self.shape_contact_pair_max = max(16 * self.shape_count, 1024)
+
+        self.shape_contact_pairs = wp.empty((self.shape_contact_pair_max, 2), dtype=wp.int32, device=self.device)
+        self.shape_contact_pair_count = self.shape_contact_pair_max
+        self.shape_contact_pair_found = wp.zeros(1, dtype=wp.int32, device=self.device)
+
+        # filter pairs are looked up by binary search on their sorted keys
+        keys = sorted({min(a, b) * self.shape_count + max(a, b) for a, b in self.shape_collision_filter_pairs})
+        self.shape_collision_filter_keys = wp.array(np.array(keys, dtype=np.int64), dtype=wp.int64, device=self.device)
+        self.shape_collision_group_array = wp.array(self.shape_collision_group, dtype=wp.int32, device=self.device)
+
+        self.shape_bvh_lowers = wp.empty(self.shape_count, dtype=wp.vec3, device=self.device)
+        self.shape_bvh_uppers = wp.empty(self.shape_count, dtype=wp.vec3, device=self.device)
+        self._compute_shape_bounds(self.body_q)
+        self.shape_bvh = wp.Bvh(self.shape_bvh_lowers, self.shape_bvh_uppers)
+
+        self.update_shape_contact_pairs(self.body_q)
+
+    def _compute_shape_bounds(self, body_q):
+        from .collide import compute_shape_bounds
+
+        wp.launch(
+            kernel=compute_shape_bounds,
+            dim=self.shape_count,
+            inputs=[
+                body_q,
+                self.shape_transform,
+                self.shape_body,
+                self.shape_collision_radius,
+                self.rigid_contact_margin,
+            ],
+            outputs=[self.shape_bvh_lowers, self.shape_bvh_uppers],
+            device=self.device,
+            record_tape=False,
+        )
+
+    def use_soft_contact_broadphase(self):
+        """Whether :func:`warp.sim.collide` finds the soft contact pairs with :func:`update_soft_contact_pairs`"""
+        if self.soft_contact_broadphase is None:
+            return self.shape_count - 1 > 8
+        return self.soft_contact_broadphase and self.shape_count > 1
+
+    def update_soft_contact_pairs(self, particle_q, body_q):
+        """
+        Finds the pairs of particles and shapes that may be in contact for the soft contacts, by querying a BVH over
+        the bounding spheres of the shapes grown by ``soft_contact_margin`` with the particle bounds. The ground
+        plane, the last shape, is not included. Called by :func:`warp.sim.collide` every step.
+
+        At most ``soft_contact_pair_max`` pairs are stored, the total number of overlapping pairs is written to
+        ``soft_contact_pair_found``.
+        """
+        from .collide import compute_soft_contact_shape_bounds, find_soft_contact_pairs
+
+        shape_count = self.shape_count - 1
+
+        if self.soft_contact_shape_bvh is None:
+            if self.soft_contact_pair_max is None:
+                self.soft_contact_pair_max = 2 * self.soft_contact_max
+            self.soft_contact_pairs = wp.empty((self.soft_contact_pair_max, 2), dtype=wp.int32, device=self.device)
+            self.soft_contact_pair_found = wp.zeros(1, dtype=wp.int32, device=self.device)
+            self.soft_contact_shape_lowers = wp.empty(shape_count, dtype=wp.vec3, device=self.device)
+            self.soft_contact_shape_uppers = wp.empty(shape_count, dtype=wp.vec3, device=self.device)
+
+        wp.launch(
+            kernel=compute_soft_contact_shape_bounds,
+            dim=shape_count,
+            inputs=[
+                body_q,
+                self.shape_transform,
+                self.shape_body,
+                self.shape_collision_radius,
+                self.soft_contact_margin,
+            ],
+            outputs=[self.soft_contact_shape_lowers, self.soft_contact_shape_uppers],
+            device=self.device,
+            record_tape=False,
+        )
+
+        if self.soft_contact_shape_bvh is None:
+            self.soft_contact_shape_bvh = wp.Bvh(self.soft_contact_shape_lowers, self.soft_contact_shape_uppers)
+        else:
+            self.soft_contact_shape_bvh.refit()
+
+        self.soft_contact_pair_found.zero_()
+
+        wp.launch(
+            kernel=find_soft_contact_pairs,
+            dim=self.particle_count,
+            inputs=[
+                self.soft_contact_shape_bvh.id,
+                particle_q,
+                self.particle_radius,
+                self.particle_flags,
+                self.soft_contact_pair_max,
+            ],
+            outputs=[self.soft_contact_pairs, self.soft_contact_pair_found],
+            device=self.device,
+            record_tape=False,
+        )
+
+    def update_shape_contact_pairs(self, body_q):
+        """
+        Finds the shape pairs whose bounds overlap at the given body transforms for the dynamic broadphase,
+        respecting collision groups and filter pairs. Called by :func:`warp.sim.collide` every step.
+
+        At most ``shape_contact_pair_count`` pairs are stored, the total number of overlapping pairs is
+        written to ``shape_contact_pair_found``.
+        """
+        from .collide import find_shape_contact_pairs_bvh
+
+        self._compute_shape_bounds(body_q)
+        self.shape_bvh.refit()
+
+        self.shape_contact_pairs.fill_(-1)
+        self.shape_contact_pair_found.zero_()
+
+        wp.launch(
+            kernel=find_shape_contact_pairs_bvh,
+            dim=self.shape_count,
+            inputs=[
+                self.shape_bvh.id,
+                self.shape_bvh_lowers,
+                self.shape_bvh_uppers,
+                self.shape_collision_group_array,
+                self.shape_collision_filter_keys,
+                self.shape_count,
+                self.shape_contact_pair_count,
+            ],
+            outputs=[self.shape_contact_pairs, self.shape_contact_pair_found],
+            device=self.device,
+            record_tape=False,
+        )
+
     def count_contact_points(self):
         """
         Counts the maximum number of contact points that need to be allocated.
@@ -924,6 +1650,111 @@ class Model:
         )
         # contact bodies of quadruped feet
         self.c_body_vec = wp.zeros(self.articulation_count*4, dtype=wp.int32, device=self.device)
+
+        if self.rigid_contact_reduction or self.rigid_contact_cache:
+            # number of contact slots and shape pair of each pair's first contact slot, 0 for the other slots
+            self.rigid_contact_pair_size = wp.zeros(self.rigid_contact_max, dtype=wp.int32, device=self.device)
+            self.rigid_contact_pair_index = wp.zeros(self.rigid_contact_max, dtype=wp.int32, device=self.device)
+
+        if self.rigid_contact_cache:
+            if self.dynamic_broadphase:
+                wp.utils.warn("The rigid contact cache is not supported by the dynamic broadphase and is disabled")
+            else:
+                self.allocate_rigid_contact_cache()
+
+    def allocate_rigid_contact_cache(self):
+        # up to 4 reduced contacts per shape pair, followed by the ground pairs, keyed by the pair index
+        pair_count = (self.shape_contact_pair_count or 0) + self.shape_ground_contact_pair_count
+        shape = (pair_count, 4)
+
+        # whether the contacts of a pair were reused in the last collision step
+        self.rigid_contact_pair_skip = wp.zeros(pair_count, dtype=wp.int32, device=self.device)
+        # number of cached contacts of a pair, 0 if the pair has to go through the narrow phase
+        self.rigid_contact_cache_count = wp.zeros(pair_count, dtype=wp.int32, device=self.device)
+        # transform of the second shape of a pair relative to its first shape when the contacts were generated
+        self.rigid_contact_cache_xform = wp.zeros(pair_count, dtype=wp.transform, device=self.device)
+        self.rigid_contact_cache_shape0 = wp.zeros(shape, dtype=wp.int32, device=self.device)
+        self.rigid_contact_cache_shape1 = wp.zeros(shape, dtype=wp.int32, device=self.device)
+        self.rigid_contact_cache_body0 = wp.zeros(shape, dtype=wp.int32, device=self.device)
+        self.rigid_contact_cache_body1 = wp.zeros(shape, dtype=wp.int32, device=self.device)
+        self.rigid_contact_cache_point0 = wp.zeros(shape, dtype=wp.vec3, device=self.device)
+        self.rigid_contact_cache_point1 = wp.zeros(shape, dtype=wp.vec3, device=self.device)
+        self.rigid_contact_cache_offset0 = wp.zeros(shape, dtype=wp.vec3, device=self.device)
+        self.rigid_contact_cache_offset1 = wp.zeros(shape, dtype=wp.vec3, device=self.device)
+        # contact normal in the frame of the second body
+        self.rigid_contact_cache_normal = wp.zeros(shape, dtype=wp.vec3, device=self.device)
+        self.rigid_contact_cache_thickness = wp.zeros(shape, dtype=wp.float32, device=self.device)
+
+    def rigid_contact_cache_arrays(self):
+        return [
+            self.rigid_contact_cache_count,
+            self.rigid_contact_cache_xform,
+            self.rigid_contact_cache_shape0,
+            self.rigid_contact_cache_shape1,
+            self.rigid_contact_cache_body0,
+            self.rigid_contact_cache_body1,
+            self.rigid_contact_cache_point0,
+            self.rigid_contact_cache_point1,
+            self.rigid_contact_cache_offset0,
+            self.rigid_contact_cache_offset1,
+            self.rigid_contact_cache_normal,
+            self.rigid_contact_cache_thickness,
+        ]
+
+    def allocate_body_sleep(self, body_island):
+        """
+        Allocates the sleep state of the bodies, ``body_island`` assigns each body to the island of bodies
+        connected to it by joints, islands fall asleep and wake up as a whole.
+        """
+        self.island_count = int(np.max(body_island)) + 1 if len(body_island) else 0
+        self.body_island = wp.array(body_island, dtype=wp.int32, device=self.device)
+        self.body_sleep_timer = wp.zeros(self.body_count, dtype=wp.float32, device=self.device)
+        # islands whose bodies are integrated in the current step, and islands woken up by contacts
+        self.island_awake = wp.zeros(self.island_count, dtype=wp.int32, device=self.device)
+        self.island_wake = wp.zeros(self.island_count, dtype=wp.int32, device=self.device)
+        # compact list of the bodies of the awake islands, the first body_active_count[0] entries are valid
+        self.body_active = wp.zeros(self.body_count, dtype=wp.int32, device=self.device)
+        self.body_active_offset = wp.zeros(self.body_count, dtype=wp.int32, device=self.device)
+        self.body_active_indices = wp.zeros(self.body_count, dtype=wp.int32, device=self.device)
+        self.body_active_count = wp.zeros(1, dtype=wp.int32, device=self.device)
+
+    def update_active_bodies(self, state_in, state_out, dt):
+        """
+        Advances the sleep timers of the bodies in ``state_in`` by ``dt`` and rebuilds the list of active bodies.
+        Sleeping bodies are copied to ``state_out`` with zero velocity, islands marked by the contacts of
+        :func:`warp.sim.collide` are woken up.
+        """
+        self.island_awake.zero_()
+        wp.launch(
+            update_body_sleep,
+            dim=self.body_count,
+            inputs=[
+                state_in.body_qd,
+                self.body_island,
+                self.island_wake,
+                self.body_sleep_velocity,
+                self.body_sleep_time,
+                dt,
+            ],
+            outputs=[self.body_sleep_timer, self.island_awake],
+            device=self.device,
+        )
+        wp.launch(
+            mark_active_bodies,
+            dim=self.body_count,
+            inputs=[self.body_island, self.island_awake, state_in.body_q],
+            outputs=[self.body_active, state_out.body_q, state_out.body_qd],
+            device=self.device,
+        )
+        wp.utils.array_scan(self.body_active, self.body_active_offset, inclusive=False)
+        wp.launch(
+            compact_active_bodies,
+            dim=self.body_count,
+            inputs=[self.body_active, self.body_active_offset, self.body_count],
+            outputs=[self.body_active_indices, self.body_active_count],
+            device=self.device,
+        )
+        self.island_wake.zero_()
         
 
     def flatten(self):
@@ -1076,6 +1907,8 @@ class ModelBuilder:
 
     def __init__(self, up_vector=(0.0, 1.0, 0.0), gravity=-9.80665, composite_rigid_body_alg = False):
         self.num_envs = 0
+        # element counts of each kind before and after every environment added by add_builder()
+        self.env_ranges = []
 
         # particles
         self.particle_q = []
@@ -1222,6 +2055,18 @@ class ModelBuilder:
         # Maximum number of soft contacts that can be registered
         self.soft_contact_max = 64 * 1024
 
+        # find the particle-shape pairs of the soft contacts from a BVH over the shape bounds instead of testing
+        # every particle against every shape, used for more than 8 shapes if None
+        self.soft_contact_broadphase = None
+        # number of particle-shape pairs the soft contact broadphase can store, twice soft_contact_max if None
+        self.soft_contact_pair_max = None
+        # store the shape index of the soft contacts as uint16 and their normal in the octahedral encoding as
+        # two fp16 values, see Model.allocate_soft_contacts()
+        self.soft_contact_compact = False
+        # grow the soft contact buffers in warp.sim.collide() when they overflow, soft_contact_max is then the
+        # initial capacity, this reads the contact count back to the host every step
+        self.soft_contact_dynamic = False
+
         # contacts to be generated within the given distance margin to be generated at
         # every simulation substep (can be 0 if only one PBD solver iteration is used)
         if self.composite_rigid_body_alg:
@@ -1237,6 +2082,29 @@ class ModelBuilder:
         # if setting is None, the number of worst-case number of contacts will be calculated in self.finalize()
         self.num_rigid_contacts_per_env = None
 
+        # keep at most 4 contacts per box, capsule and mesh pair, and reuse them for pairs whose
+        # shapes moved relative to each other by less than rigid_contact_cache_tolerance
+        self.rigid_contact_reduction = False
+        self.rigid_contact_cache = False
+        self.rigid_contact_cache_tolerance = 1.0e-4
+
+        # let islands of bodies connected by joints fall asleep once all of their bodies moved slower than
+        # body_sleep_velocity for body_sleep_time, sleeping islands are woken up by contacts with moving bodies
+        self.body_sleep = False
+        self.body_sleep_velocity = 0.05
+        self.body_sleep_time = 0.5
+
+        # find the shape contact pairs on the device every step from a BVH over the shape bounds instead of
+        # precomputing all pairs of each collision group in self.finalize(), if num_rigid_contacts_per_env is
+        # None the contacts are then allocated for the pairs that overlap in the initial configuration
+        self.dynamic_broadphase = False
+        # number of shape pairs the dynamic broadphase can store, 16 per shape if None
+        self.shape_contact_pair_max = None
+
+        # color the constraints in self.finalize() for the Gauss-Seidel mode of the XPBD integrator,
+        # otherwise they are colored by the integrator on the first step
+        self.constraint_coloring = False
+
     @property
     def shape_count(self):
         return len(self.shape_geo_type)
@@ -1303,6 +2171,8 @@ class ModelBuilder:
             separate_collision_group: if True, the shapes from the articulation will all be put into a single new collision group, otherwise, only the shapes in collision group > -1 will be moved to a new group.
         """
 
+        env_begin = self._env_element_counts()
+
         start_body_idx = self.body_count
         start_shape_idx = self.shape_count
         for s, b in enumerate(articulation.shape_body):
@@ -1434,6 +2304,50 @@ class ModelBuilder:
 
         if update_num_env_count:
             self.num_envs += 1
+            self.env_ranges.append((env_begin, self._env_element_counts()))
+
+    def _env_element_counts(self):
+        return {
+            "body": self.body_count,
+            "shape": self.shape_count,
+            "joint": self.joint_count,
+            "joint_coord": self.joint_coord_count,
+            "joint_dof": self.joint_dof_count,
+            "joint_axis": self.joint_axis_total_count,
+        }
+
+    def _body_islands(self):
+        # union-find over the joints, islands are numbered in the order of their first body
+        parent = list(range(self.body_count))
+
+        def find(i):
+            while parent[i] != i:
+                parent[i] = parent[parent[i]]
+                i = parent[i]
+            return i
+
+        for p, c in zip(self.joint_parent, self.joint_child):
+            if p >= 0 and c >= 0:
+                parent[find(c)] = find(p)
+
+        roots = {}
+        return [roots.setdefault(find(i), len(roots)) for i in range(self.body_count)]
+
+    def _env_layout(self):
+        # (start, count) of the elements of each kind in the first environment, for the kinds that have the same
+        # number of elements in every environment stored back to back
+        layout = {}
+        if not self.env_ranges or len(self.env_ranges) != self.num_envs:
+            return layout
+        for kind in ENV_ELEMENT_KINDS:
+            start = self.env_ranges[0][0][kind]
+            count = self.env_ranges[0][1][kind] - start
+            if all(
+                begin[kind] == start + i * count and end[kind] == start + (i + 1) * count
+                for i, (begin, end) in enumerate(self.env_ranges)
+            ):
+                layout[kind] = (start, count)
+        return layout
 
     # register a rigid body and return its index.
     def add_body(
@@ -3896,6 +4810,7 @@ class ModelBuilder:
             m.requires_grad = requires_grad
 
             m.num_envs = self.num_envs
+            m.env_layout = self._env_layout()
 
             # ---------------------
             # particles
@@ -3910,8 +4825,8 @@ class ModelBuilder:
             m.particle_max_radius = np.max(self.particle_radius) if len(self.particle_radius) > 0 else 0.0
             m.particle_max_velocity = self.particle_max_velocity
 
-            # hash-grid for particle interactions
-            m.particle_grid = wp.HashGrid(128, 128, 128)
+            # hash-grid for particle interactions, Morton ordered cells keep the neighbor walks cache friendly
+            m.particle_grid = wp.HashGrid(128, 128, 128, morton=True)
 
             # ---------------------
             # collision geometry
@@ -3923,12 +4838,17 @@ class ModelBuilder:
             # build list of ids for geometry sources (meshes, sdfs)
             geo_sources = []
             finalized_meshes = {}  # do not duplicate meshes
+            finalized_geo_ids = {}  # shapes sharing a source object skip the hash computation
             for geo in self.shape_geo_src:
-                geo_hash = hash(geo)  # avoid repeated hash computations
                 if geo:
-                    if geo_hash not in finalized_meshes:
-                        finalized_meshes[geo_hash] = geo.finalize(device=device)
-                    geo_sources.append(finalized_meshes[geo_hash])
+                    geo_source = finalized_geo_ids.get(id(geo))
+                    if geo_source is None:
+                        geo_hash = hash(geo)
+                        if geo_hash not in finalized_meshes:
+                            finalized_meshes[geo_hash] = geo.finalize(device=device)
+                        geo_source = finalized_meshes[geo_hash]
+                        finalized_geo_ids[id(geo)] = geo_source
+                    geo_sources.append(geo_source)
                 else:
                     # add null pointer
                     geo_sources.append(0)
@@ -4075,19 +4995,40 @@ class ModelBuilder:
             m.joint_q_start = wp.array(self.joint_q_start, dtype=wp.int32)
             m.joint_qd_start = wp.array(self.joint_qd_start, dtype=wp.int32)
             m.articulation_start = wp.array(self.articulation_start, dtype=wp.int32)
+            m.compute_joint_levels()
 
             # contacts
+            m.soft_contact_compact = self.soft_contact_compact
+            m.soft_contact_dynamic = self.soft_contact_dynamic
             if m.particle_count:
-                m.allocate_soft_contacts(self.soft_contact_max, requires_grad=requires_grad)
+                with wp.ScopedMemoryTag("contacts"):
+                    m.allocate_soft_contacts(self.soft_contact_max, requires_grad=requires_grad)
+            m.rigid_contact_margin = self.rigid_contact_margin
+            m.soft_contact_broadphase = self.soft_contact_broadphase
+            m.soft_contact_pair_max = self.soft_contact_pair_max
+            m.dynamic_broadphase = self.dynamic_broadphase
+            m.shape_contact_pair_max = self.shape_contact_pair_max
             m.find_shape_contact_pairs()
+            if self.constraint_coloring:
+                m.color_constraints()
             if self.num_rigid_contacts_per_env is None:
                 contact_count = m.count_contact_points()
             else:
                 contact_count = self.num_rigid_contacts_per_env * self.num_envs
             if wp.config.verbose:
                 print(f"Allocating {contact_count} rigid contacts.")
-            m.allocate_rigid_contacts(contact_count, requires_grad=requires_grad)
+            m.rigid_contact_reduction = self.rigid_contact_reduction
+            m.rigid_contact_cache = self.rigid_contact_cache
+            m.rigid_contact_cache_tolerance = self.rigid_contact_cache_tolerance
+            with wp.ScopedMemoryTag("contacts"):
+                m.allocate_rigid_contacts(contact_count, requires_grad=requires_grad)
             m.rigid_contact_margin = self.rigid_contact_margin
+
+            m.body_sleep = self.body_sleep
+            m.body_sleep_velocity = self.body_sleep_velocity
+            m.body_sleep_time = self.body_sleep_time
+            if m.body_sleep and m.body_count:
+                m.allocate_body_sleep(self._body_islands())
             m.rigid_contact_torsional_friction = self.rigid_contact_torsional_friction
             m.rigid_contact_rolling_friction = self.rigid_contact_rolling_friction
 
@@ -4218,4 +5159,211 @@ class ModelBuilder:
 
                 m.alloc_mass_matrix()
 
-            return m
\ No newline at end of file
+            return m
+    def finalize_replicated(self, num_envs, env_xforms=None, device=None, requires_grad=False) -> Model:
+        """Finalizes this builder as a single environment and replicates it into ``num_envs`` environments.
+
+        Unlike adding the environments with :func:`add_builder` before :func:`finalize`, the elements of the
+        environments are replicated by kernels from the finalized template, with their indices offset per
+        environment, so that the cost of finalizing barely depends on the number of environments. The
+        environments share the ground plane, and each environment only collides with itself and the ground.
+
+        Args:
+            num_envs: The number of environments
+            env_xforms: Transforms of the environments applied to the bodies, the root joints and the static shapes,
+                a list or wp.array of transforms, identity if None
+            device: The simulation device to use, e.g.: 'cpu', 'cuda'
+            requires_grad: Whether to enable gradient computation for the model
+
+        Returns:
+
+            A model object.
+        """
+
+        if self.num_envs > 1:
+            raise RuntimeError("The template of finalize_replicated() must consist of a single environment")
+        if len(self.particle_q) or len(self.muscle_start):
+            raise RuntimeError("finalize_replicated() only supports rigid bodies and joints")
+        if self.composite_rigid_body_alg or self.dynamic_broadphase:
+            raise RuntimeError(
+                "finalize_replicated() does not support the composite rigid body algorithm or the dynamic broadphase"
+            )
+
+        t = self.finalize(device=device, requires_grad=requires_grad)
+        device = t.device
+
+        # the ground plane is the last shape of the template and is shared by all environments
+        nb, ns, nj = t.body_count, t.shape_count - 1, t.joint_count
+        nc, nd, na = t.joint_coord_count, t.joint_dof_count, len(t.joint_axis)
+
+        if env_xforms is None:
+            env_xforms = np.tile(np.array(wp.transform_identity()), (num_envs, 1))
+        env_xforms = wp.array(env_xforms, dtype=wp.transform, device=device)
+        if len(env_xforms) != num_envs:
+            raise RuntimeError("The number of environment transforms does not match the number of environments")
+
+        def tile(src, count, extra=0):
+            # count elements per environment, followed by the `extra` elements of src after the first count
+            dst = wp.empty(num_envs * count + extra, dtype=src.dtype, device=device, requires_grad=src.requires_grad)
+            if count:
+                wp.launch(replicate_elements, dim=(num_envs, count), inputs=[src, count], outputs=[dst], device=device)
+            if extra:
+                wp.copy(dst, src, dest_offset=num_envs * count, src_offset=count, count=extra)
+            return dst
+
+        def tile_indices(src, count, offset, sentinel=None):
+            # indices offset by `offset` per environment, optionally closed by a sentinel value
+            dst = wp.empty(num_envs * count + (sentinel is not None), dtype=wp.int32, device=device)
+            if count:
+                wp.launch(
+                    replicate_indices,
+                    dim=(num_envs, count),
+                    inputs=[src, count, offset],
+                    outputs=[dst],
+                    device=device,
+                )
+            if sentinel is not None:
+                dst[num_envs * count :].fill_(sentinel)
+            return dst
+
+        def tile_transforms(src, count, mask, extra=0):
+            dst = tile(src, count, extra)
+            if count:
+                mask = wp.array(mask.astype(np.int32), dtype=wp.int32, device=device)
+                wp.launch(
+                    replicate_transforms,
+                    dim=(num_envs, count),
+                    inputs=[src, mask, env_xforms, count],
+                    outputs=[dst],
+                    device=device,
+                )
+            return dst
+
+        def tile_pairs(src, count):
+            if count == 0:
+                return src, 0
+            dst = wp.empty((num_envs * count, 2), dtype=wp.int32, device=device)
+            wp.launch(
+                replicate_contact_pairs,
+                dim=(num_envs, count, 2),
+                inputs=[src, count, ns, ns, num_envs * ns],
+                outputs=[dst],
+                device=device,
+            )
+            return dst, num_envs * count
+
+        m = copy.copy(t)
+        m.num_envs = num_envs
+        m.env_layout = {
+            "body": (0, nb),
+            "shape": (0, ns),
+            "joint": (0, nj),
+            "joint_coord": (0, nc),
+            "joint_dof": (0, nd),
+            "joint_axis": (0, na),
+        }
+
+        # rigid bodies
+        m.body_q = tile_transforms(t.body_q, nb, np.ones(nb, dtype=bool))
+        for attr in ("body_qd", "body_com", "body_inertia", "body_inv_inertia", "body_mass", "body_inv_mass"):
+            setattr(m, attr, tile(getattr(t, attr), nb))
+        m.body_name = t.body_name * num_envs
+
+        # joints, root joints are moved with their environment
+        joint_type = t.joint_type.numpy()
+        joint_parent = t.joint_parent.numpy()
+        m.joint_X_p = tile_transforms(t.joint_X_p, nj, (joint_parent == -1) & (joint_type != JOINT_FREE))
+        m.joint_parent = tile_indices(t.joint_parent, nj, nb)
+        m.joint_child = tile_indices(t.joint_child, nj, nb)
+        m.joint_axis_start = tile_indices(t.joint_axis_start, nj, na)
+        m.joint_q_start = tile_indices(t.joint_q_start, nj, nc, sentinel=num_envs * nc)
+        m.joint_qd_start = tile_indices(t.joint_qd_start, nj, nd, sentinel=num_envs * nd)
+        m.articulation_start = tile_indices(t.articulation_start, t.articulation_count, nj, sentinel=num_envs * nj)
+        m.joint_axis_dim = wp.array(np.tile(t.joint_axis_dim.numpy(), (num_envs, 1)), dtype=wp.int32, device=device)
+        for attr in ("joint_type", "joint_X_c", "joint_enabled", "joint_linear_compliance", "joint_angular_compliance"):
+            setattr(m, attr, tile(getattr(t, attr), nj))
+        for attr in (
+            "joint_axis",
+            "joint_axis_mode",
+            "joint_target",
+            "joint_target_ke",
+            "joint_target_kd",
+            "joint_limit_lower",
+            "joint_limit_upper",
+            "joint_limit_ke",
+            "joint_limit_kd",
+        ):
+            setattr(m, attr, tile(getattr(t, attr), na))
+        for attr in ("joint_qd", "joint_act", "joint_armature"):
+            setattr(m, attr, tile(getattr(t, attr), nd))
+        m.joint_q = tile(t.joint_q, nc)
+        m.joint_name = t.joint_name * num_envs
+
+        free_joint_q_start = t.joint_q_start.numpy()[:nj][joint_type == JOINT_FREE]
+        if len(free_joint_q_start):
+            wp.launch(
+                replicate_free_joint_coords,
+                dim=(num_envs, len(free_joint_q_start)),
+                inputs=[wp.array(free_joint_q_start, dtype=wp.int32, device=device), env_xforms, nc],
+                outputs=[m.joint_q],
+                device=device,
+            )
+
+        # shapes, static shapes are moved with their environment
+        shape_body = t.shape_body.numpy()
+        m.shape_transform = tile_transforms(t.shape_transform, ns, shape_body[:ns] == -1, extra=1)
+        m.shape_body = tile_indices(t.shape_body, ns, nb, sentinel=-1)
+        m.body_shapes = {
+            b + env * nb: [s + env * ns for s in shapes]
+            for env in range(num_envs)
+            for b, shapes in t.body_shapes.items()
+            if b > -1
+        }
+        if -1 in t.body_shapes:
+            static_shapes = [s for s in t.body_shapes[-1] if s < ns]
+            m.body_shapes[-1] = [s + env * ns for env in range(num_envs) for s in static_shapes] + [num_envs * ns]
+
+        m.shape_geo = ModelShapeGeometry()
+        m.shape_materials = ModelShapeMaterials()
+        for attr in ("type", "source", "scale", "is_solid", "thickness"):
+            setattr(m.shape_geo, attr, tile(getattr(t.shape_geo, attr), ns, extra=1))
+        for attr in ("ke", "kd", "kf", "mu", "restitution"):
+            setattr(m.shape_materials, attr, tile(getattr(t.shape_materials, attr), ns, extra=1))
+        m.shape_collision_radius = tile(t.shape_collision_radius, ns, extra=1)
+        m.shape_geo_src = t.shape_geo_src[:ns] * num_envs + t.shape_geo_src[ns:]
+        m.shape_ground_collision = t.shape_ground_collision[:ns] * num_envs + t.shape_ground_collision[ns:]
+
+        # the contact pairs are replicated from the template, the group map and filters are not needed anymore
+        groups = np.array(t.shape_collision_group[:ns], dtype=np.int64)
+        group_count = int(groups.max()) + 1 if ns else 0
+        env_groups = groups[None, :] + group_count * np.arange(num_envs)[:, None]
+        env_groups = np.where(groups[None, :] > -1, env_groups, -1)
+        m.shape_collision_group = env_groups.flatten().tolist() + t.shape_collision_group[ns:]
+        m.shape_collision_group_map = {}
+        m.shape_collision_filter_pairs = set()
+        m.shape_contact_pairs, m.shape_contact_pair_count = tile_pairs(
+            t.shape_contact_pairs, t.shape_contact_pair_count
+        )
+        m.shape_ground_contact_pairs, m.shape_ground_contact_pair_count = tile_pairs(
+            t.shape_ground_contact_pairs, t.shape_ground_contact_pair_count
+        )
+
+        # counts
+        m.body_count = num_envs * nb
+        m.shape_count = num_envs * ns + 1
+        m.joint_count = num_envs * nj
+        m.joint_coord_count = num_envs * nc
+        m.joint_dof_count = num_envs * nd
+        m.joint_axis_count = num_envs * t.joint_axis_count
+        m.articulation_count = num_envs * t.articulation_count
+        m.compute_joint_levels()
+
+        with wp.ScopedMemoryTag("contacts"):
+            m.allocate_rigid_contacts(num_envs * t.rigid_contact_max, requires_grad=requires_grad)
+        if t.body_island is not None:
+            islands = t.body_island.numpy()[None, :] + t.island_count * np.arange(num_envs)[:, None]
+            m.allocate_body_sleep(islands.flatten())
+        if self.constraint_coloring:
+            m.color_constraints()
+
+        return m
@@ -287,7 +287,11 @@ def CreateSimRenderer(renderer):
                 return
 
             if self.model.particle_count:
-                particle_q = state.particle_q.numpy()
+                # asynchronous renderers read the particle positions back themselves
+                if getattr(self, "async_write", False):
+                    particle_q = state.particle_q
+                else:
+                    particle_q = state.particle_q.numpy()
 
                 # render particles
                 self.render_points("particles", particle_q, radius=self.model.particle_radius.numpy())
@@ -298,6 +302,8 @@ def CreateSimRenderer(renderer):
 
                 # render springs
                 if self.model.spring_count:
+                    if isinstance(particle_q, wp.array):
+                        particle_q = particle_q.numpy()
                     self.render_line_list("springs", particle_q, self.model.spring_indices.numpy().flatten(), [], 0.05)
 
             # render muscles
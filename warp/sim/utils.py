@@ -196,4 +196,65 @@ def vec_abs(a: wp.vec3):
     return wp.vec3(wp.abs(a[0]), wp.abs(a[1]), wp.abs(a[2]))
 
 
-        
\ No newline at end of file
+        
+
+@wp.func
+def octahedral_encode(n: wp.vec3):
+    """
+    Encodes a unit vector as the two fp16 coordinates of its projection onto the unit octahedron,
+    folded into the [-1, 1] square.
+    """
+
+    n = n / (wp.abs(n[0]) + wp.abs(n[1]) + wp.abs(n[2]))
+    x = n[0]
+    y = n[1]
+    if n[2] < 0.0:
+        x = (1.0 - wp.abs(n[1])) * wp.select(n[0] < 0.0, 1.0, -1.0)
+        y = (1.0 - wp.abs(n[0])) * wp.select(n[1] < 0.0, 1.0, -1.0)
+    return wp.vec2h(wp.float16(x), wp.float16(y))
+
+
+@wp.func
+def octahedral_decode(e: wp.vec2h):
+    """
+    Decodes a unit vector from its octahedral encoding, see :func:`octahedral_encode`.
+    """
+
+    x = float(e[0])
+    y = float(e[1])
+    z = 1.0 - wp.abs(x) - wp.abs(y)
+    # unfold the lower hemisphere
+    t = wp.max(-z, 0.0)
+    x = x + wp.select(x < 0.0, -t, t)
+    y = y + wp.select(y < 0.0, -t, t)
+    return wp.normalize(wp.vec3(x, y, z))
+
+
+@wp.func
+def load_contact_normal(normals: wp.array(dtype=wp.vec3), index: int):
+    return normals[index]
+
+
+@wp.func
+def load_contact_normal(normals: wp.array(dtype=wp.vec2h), index: int):
+    return octahedral_decode(normals[index])
+
+
+@wp.func
+def store_contact_normal(normals: wp.array(dtype=wp.vec3), index: int, n: wp.vec3):
+    normals[index] = n
+
+
+@wp.func
+def store_contact_normal(normals: wp.array(dtype=wp.vec2h), index: int, n: wp.vec3):
+    normals[index] = octahedral_encode(n)
+
+
+@wp.func
+def store_contact_shape(shapes: wp.array(dtype=int), index: int, shape: int):
+    shapes[index] = shape
+
+
+@wp.func
+def store_contact_shape(shapes: wp.array(dtype=wp.uint16), index: int, shape: int):
+    shapes[index] = wp.uint16(shape)
@@ -0,0 +1,413 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+"""Square BSR matrices partitioned by rows of blocks across several devices.
+
+Distributed vectors are lists holding one array per partition, on the partition's device, with the
+entries of the rows owned by that partition. Off-partition entries needed by each partition's blocks
+are exchanged peer-to-peer before applying the corresponding (halo) part of the matrix.
+"""
+
+import math
+from typing import Any, Callable, List, Optional, Sequence, Tuple
+
+import numpy as np
+
+import warp as wp
+from warp.sparse import BsrMatrix, _bsr_scale_values, bsr_mv, bsr_zeros
+from warp.utils import array_inner
+
+
+class DistributedBsrMatrix:
+    """Square BSR matrix partitioned by rows of blocks, built with :func:`bsr_distribute`.
+
+    Partition ``p`` owns block rows ``row_offsets[p]`` to ``row_offsets[p+1]`` and the corresponding entries of
+    distributed vectors. Its blocks are split between `local`, whose columns are renumbered relative to the owned
+    rows, and `halo`, whose columns index into the partition's buffer of off-partition vector entries.
+
+    Attributes:
+        devices (List[Device]): Device of each partition
+        row_offsets (List[int]): First block row of each partition, followed by the total number of block rows
+        local (List[BsrMatrix]): Blocks with columns owned by the partition
+        halo (List[BsrMatrix]): Blocks with columns owned by other partitions
+    """
+
+    def __init__(self):
+        self.devices = []
+        self.row_offsets = [0]
+        self.local = []
+        self.halo = []
+
+        # per partition received halo entries, and (dest partition, source indices, send buffer, dest offset)
+        # tuples for each partition sending entries
+        self._halo_buffers = []
+        self._sends = []
+
+    @property
+    def partition_count(self) -> int:
+        return len(self.devices)
+
+    @property
+    def nrow(self) -> int:
+        return self.row_offsets[-1]
+
+    @property
+    def scalar_type(self) -> type:
+        return self.local[0].scalar_type
+
+    @property
+    def block_shape(self) -> Tuple[int, int]:
+        return self.local[0].block_shape
+
+    @property
+    def shape(self) -> Tuple[int, int]:
+        block_shape = self.block_shape
+        return (self.nrow * block_shape[0], self.nrow * block_shape[1])
+
+    @property
+    def vector_dtype(self) -> type:
+        """Data type of distributed vector entries"""
+        block_shape = self.block_shape
+        if block_shape[1] == 1:
+            return self.scalar_type
+        return wp.vec(length=block_shape[1], dtype=self.scalar_type)
+
+
+def bsr_distribute(
+    A: BsrMatrix, devices: Sequence[wp.context.Devicelike], row_offsets: Optional[Sequence[int]] = None
+) -> DistributedBsrMatrix:
+    """Partitions the square matrix `A` by rows of blocks across `devices`.
+
+    Args:
+        A: The matrix to distribute, on any device
+        devices: Device of each partition. Devices must be either all CUDA devices or all CPU, and may repeat.
+          Peer access is enabled between CUDA devices that support it.
+        row_offsets: First block row of each partition, followed by ``A.nrow``. By default rows are split so that
+          partitions hold similar numbers of blocks.
+    """
+
+    if A.nrow != A.ncol:
+        raise ValueError("Only square matrices can be distributed")
+
+    devices = [wp.get_device(device) for device in devices]
+    if len(devices) == 0:
+        raise ValueError("At least one device is required")
+    if any(device.is_cuda != devices[0].is_cuda for device in devices):
+        raise ValueError("Partitions must either all reside on CUDA devices or all on the CPU")
+
+    offsets = A.offsets.numpy()[: A.nrow + 1]
+    columns = A.columns.numpy()[: A.nnz]
+    values = A.values.numpy()[: A.nnz]
+
+    if row_offsets is None:
+        # balance number of blocks
+        targets = np.linspace(0, A.nnz, len(devices) + 1)[1:-1]
+        row_offsets = [0] + list(np.searchsorted(offsets, targets)) + [A.nrow]
+    row_offsets = [int(r) for r in row_offsets]
+
+    if len(row_offsets) != len(devices) + 1 or row_offsets[0] != 0 or row_offsets[-1] != A.nrow:
+        raise ValueError("row_offsets must contain one entry per partition followed by the number of rows")
+    if any(row_offsets[p] > row_offsets[p + 1] for p in range(len(devices))):
+        raise ValueError("row_offsets must be non-decreasing")
+
+    for device in devices:
+        for peer in devices:
+            if device.is_cuda and device != peer and device.can_access(peer):
+                device.enable_peer_access(peer)
+
+    D = DistributedBsrMatrix()
+    D.devices = devices
+    D.row_offsets = row_offsets
+    D._sends = [[] for _ in devices]
+
+    halo_columns = []
+
+    for p, device in enumerate(devices):
+        row_beg, row_end = row_offsets[p], row_offsets[p + 1]
+        row_count = row_end - row_beg
+
+        block_beg, block_end = offsets[row_beg], offsets[row_end]
+        block_rows = np.repeat(np.arange(row_count), np.diff(offsets[row_beg : row_end + 1]))
+        block_cols = columns[block_beg:block_end]
+        block_values = values[block_beg:block_end]
+
+        owned = (block_cols >= row_beg) & (block_cols < row_end)
+
+        # halo columns are sorted by global index, so grouped by owning partition
+        halo_cols = np.unique(block_cols[~owned])
+        halo_columns.append(halo_cols)
+
+        D.local.append(
+            _bsr_from_sorted_blocks(
+                A, device, row_count, row_count, block_rows[owned], block_cols[owned] - row_beg, block_values[owned]
+            )
+        )
+        D.halo.append(
+            _bsr_from_sorted_blocks(
+                A,
+                device,
+                row_count,
+                len(halo_cols),
+                block_rows[~owned],
+                np.searchsorted(halo_cols, block_cols[~owned]),
+                block_values[~owned],
+            )
+        )
+        D._halo_buffers.append(wp.empty(shape=(len(halo_cols),), dtype=D.vector_dtype, device=device))
+
+    for p, halo_cols in enumerate(halo_columns):
+        for q in range(len(devices)):
+            seg_beg, seg_end = np.searchsorted(halo_cols, [row_offsets[q], row_offsets[q + 1]])
+            if seg_end > seg_beg and q != p:
+                indices = wp.array(halo_cols[seg_beg:seg_end] - row_offsets[q], dtype=int, device=devices[q])
+                buffer = wp.empty(shape=(seg_end - seg_beg,), dtype=D.vector_dtype, device=devices[q])
+                D._sends[q].append((p, indices, buffer, int(seg_beg)))
+
+    return D
+
+
+def distributed_zeros(A: DistributedBsrMatrix, dtype: type = None) -> List[wp.array]:
+    """Returns a zero distributed vector compatible with `A`"""
+
+    if dtype is None:
+        dtype = A.vector_dtype
+
+    return [
+        wp.zeros(shape=(A.row_offsets[p + 1] - A.row_offsets[p],), dtype=dtype, device=device)
+        for p, device in enumerate(A.devices)
+    ]
+
+
+def distribute_array(A: DistributedBsrMatrix, array: wp.array) -> List[wp.array]:
+    """Splits `array` into a distributed vector compatible with `A`"""
+
+    parts = distributed_zeros(A, array.dtype)
+    for p, part in enumerate(parts):
+        if part.shape[0] > 0:
+            wp.copy(dest=part, src=array, src_offset=A.row_offsets[p], count=part.shape[0])
+    return parts
+
+
+def gather_array(parts: List[wp.array]) -> np.ndarray:
+    """Concatenates a distributed vector into a numpy array"""
+    return np.concatenate([part.numpy() for part in parts])
+
+
+def distributed_mv(
+    A: DistributedBsrMatrix, x: List[wp.array], y: List[wp.array], alpha: float = 1.0, beta: float = 0.0
+):
+    """Distributed sparse matrix-vector product, `y := alpha * A * x + beta * y`.
+
+    Local products are issued before the halo exchange so that they may overlap with peer copies.
+    """
+
+    # Gather entries requested by other partitions
+    for q, sends in enumerate(A._sends):
+        for p, indices, buffer, _ in sends:
+            # the previous exchange must be done reading the send buffer
+            _wait_partition(A, q, p)
+            wp.launch(
+                kernel=_gather_halo, dim=indices.shape[0], device=A.devices[q], inputs=[indices, x[q], buffer]
+            )
+
+    for p, device in enumerate(A.devices):
+        with wp.ScopedDevice(device):
+            if A.local[p].nnz > 0:
+                bsr_mv(A.local[p], x[p], y[p], alpha, beta)
+            elif y[p].shape[0] > 0:
+                # partitions whose rows only couple to other partitions
+                _bsr_scale_values(y[p], wp.types.type_scalar_type(y[p].dtype)(beta))
+
+    for q, sends in enumerate(A._sends):
+        for p, indices, buffer, offset in sends:
+            _wait_partition(A, p, q)
+            wp.copy(dest=A._halo_buffers[p], src=buffer, dest_offset=offset, count=buffer.shape[0])
+
+    for p, device in enumerate(A.devices):
+        if A.halo[p].nnz > 0:
+            with wp.ScopedDevice(device):
+                bsr_mv(A.halo[p], A._halo_buffers[p], y[p], alpha, 1.0)
+
+
+def distributed_dot(A: DistributedBsrMatrix, x: List[wp.array], y: List[wp.array]) -> float:
+    """Inner product of two distributed vectors, returned on host"""
+
+    dot = _DistributedScalar(A)
+    dot.inner(x, y)
+    return float(dot.totals[0].numpy()[0])
+
+
+def distributed_cg(
+    A: DistributedBsrMatrix,
+    b: List[wp.array],
+    x: List[wp.array],
+    tol: float = 1.0e-5,
+    atol: float = 0.0,
+    maxiter: int = 0,
+    check_every: int = 10,
+    callback: Optional[Callable] = None,
+) -> Tuple[int, float, float]:
+    """Solves `Ax = b` for a symmetric positive definite distributed `A` with the Conjugate Gradient method.
+
+    Inner products are all-reduced between devices with peer copies, so the residual is only read back to host
+    every `check_every` iterations. See :func:`warp.optim.linear.cg` for a description of the arguments.
+
+    Returns:
+        Tuple ``(iterations, residual_norm, tolerance)``
+    """
+
+    from warp.optim.linear import _cg_update_p, _cg_update_x_r, _tolerance_sq
+
+    scalar_type = A.scalar_type
+    maxiter = maxiter if maxiter > 0 else A.shape[0]
+
+    r = [wp.clone(part) for part in b]
+    distributed_mv(A, x, r, -1.0, 1.0)
+
+    p_vec = [wp.clone(part) for part in r]
+    Ap = distributed_zeros(A, b[0].dtype)
+
+    b_sq = _DistributedScalar(A)
+    b_sq.inner(b, b)
+
+    tol_sq = []
+    for p, device in enumerate(A.devices):
+        tol_sq.append(wp.empty(shape=(1,), dtype=scalar_type, device=device))
+        wp.launch(
+            kernel=_tolerance_sq,
+            dim=1,
+            device=device,
+            inputs=[b_sq.totals[p], scalar_type(tol * tol), scalar_type(atol * atol), tol_sq[p]],
+        )
+
+    rz_old = _DistributedScalar(A)
+    rz_new = _DistributedScalar(A)
+    p_Ap = _DistributedScalar(A)
+    rz_old.inner(r, r)
+
+    def norms():
+        return math.sqrt(rz_old.totals[0].numpy()[0]), math.sqrt(tol_sq[0].numpy()[0])
+
+    resid, tol_norm = norms()
+    if resid <= tol_norm:
+        return 0, resid, tol_norm
+
+    for i in range(maxiter):
+        distributed_mv(A, p_vec, Ap, 1.0, 0.0)
+        p_Ap.inner(p_vec, Ap)
+
+        for p, device in enumerate(A.devices):
+            wp.launch(
+                kernel=_cg_update_x_r,
+                dim=r[p].shape[0],
+                device=device,
+                inputs=[rz_old.totals[p], tol_sq[p], rz_old.totals[p], p_Ap.totals[p], p_vec[p], Ap[p], x[p], r[p]],
+            )
+
+        rz_new.inner(r, r)
+
+        for p, device in enumerate(A.devices):
+            wp.launch(
+                kernel=_cg_update_p,
+                dim=r[p].shape[0],
+                device=device,
+                inputs=[rz_new.totals[p], tol_sq[p], rz_old.totals[p], rz_new.totals[p], r[p], p_vec[p]],
+            )
+
+        rz_old, rz_new = rz_new, rz_old
+
+        if check_every > 0 and ((i + 1) % check_every == 0 or i + 1 == maxiter):
+            resid, tol_norm = norms()
+            if callback is not None:
+                callback(i + 1, resid, tol_norm)
+            if resid <= tol_norm:
+                return i + 1, resid, tol_norm
+
+    resid, tol_norm = norms()
+    return maxiter, resid, tol_norm
+
+
+class _DistributedScalar:
+    """Scalar reduced over all partitions, with the total replicated on each device"""
+
+    def __init__(self, A: DistributedBsrMatrix):
+        self._A = A
+        count = A.partition_count
+        self.partials = [wp.zeros(shape=(1,), dtype=A.scalar_type, device=device) for device in A.devices]
+        self.gathered = [wp.zeros(shape=(count,), dtype=A.scalar_type, device=device) for device in A.devices]
+        self.totals = [wp.zeros(shape=(1,), dtype=A.scalar_type, device=device) for device in A.devices]
+
+    def inner(self, x: List[wp.array], y: List[wp.array]):
+        A = self._A
+        count = A.partition_count
+
+        for p in range(count):
+            # other partitions must be done reading the previous partial and total
+            for q in range(count):
+                _wait_partition(A, p, q)
+
+            if x[p].shape[0] > 0:
+                array_inner(x[p], y[p], out=self.partials[p])
+            else:
+                self.partials[p].zero_()
+
+        # all-gather partials then sum on each device, so that the totals are bitwise identical
+        for p in range(count):
+            for q in range(count):
+                _wait_partition(A, p, q)
+                wp.copy(dest=self.gathered[p], src=self.partials[q], dest_offset=q, count=1)
+
+            wp.launch(
+                kernel=_sum_partials, dim=1, device=A.devices[p], inputs=[count, self.gathered[p], self.totals[p]]
+            )
+
+
+def _wait_partition(A: DistributedBsrMatrix, p: int, q: int):
+    """Makes the stream of partition `p` wait for work previously issued on partition `q`"""
+    device = A.devices[p]
+    other = A.devices[q]
+    if device.is_cuda and device != other:
+        wp.get_stream(device).wait_stream(wp.get_stream(other))
+
+
+def _bsr_from_sorted_blocks(
+    A: BsrMatrix,
+    device: wp.context.Device,
+    nrow: int,
+    ncol: int,
+    block_rows: np.ndarray,
+    block_cols: np.ndarray,
+    block_values: np.ndarray,
+) -> BsrMatrix:
+    """BSR matrix from blocks already sorted by row and column"""
+
+    M = bsr_zeros(nrow, ncol, A.values.dtype, device=device)
+
+    offsets = np.zeros(nrow + 1, dtype=np.int32)
+    np.cumsum(np.bincount(block_rows, minlength=nrow), out=offsets[1:])
+
+    M.nnz = len(block_cols)
+    M.offsets = wp.array(offsets, dtype=int, device=device)
+    if M.nnz > 0:
+        M.columns = wp.array(np.asarray(block_cols, dtype=np.int32), dtype=int, device=device)
+        M.values = wp.array(block_values, dtype=A.values.dtype, device=device)
+
+    return M
+
+
+@wp.kernel
+def _gather_halo(indices: wp.array(dtype=int), src: wp.array(dtype=Any), dst: wp.array(dtype=Any)):
+    i = wp.tid()
+    dst[i] = src[indices[i]]
+
+
+@wp.kernel
+def _sum_partials(count: int, partials: wp.array(dtype=Any), total: wp.array(dtype=Any)):
+    s = partials[0]
+    for k in range(1, count):
+        s = s + partials[k]
+    total[0] = s
@@ -38,7 +38,8 @@ from warp.types import spatial_vector, spatial_vectorh, spatial_vectorf, spatial
 from warp.types import spatial_matrix, spatial_matrixh, spatial_matrixf, spatial_matrixd
 
 from warp.types import Bvh, Mesh, HashGrid, Volume, MarchingCubes
-from warp.types import bvh_query_t, mesh_query_aabb_t, hash_grid_query_t
+from warp.types import bvh_query_t, mesh_query_aabb_t, hash_grid_query_t, volume_accessor_t, tile_t
+from warp.types import neighbor_list_query_t, topk_heap_t
 
 from warp.types import matmul, adj_matmul, batched_matmul, adj_batched_matmul, from_ptr
 
@@ -61,6 +62,7 @@ from warp.context import (
     copy,
     from_numpy,
     launch,
+    launch_multi,
     synchronize,
     force_load,
     load_module,
@@ -71,6 +73,7 @@ from warp.context import print_builtins, export_builtins, export_stubs
 from warp.context import Kernel, Function, Launch
 from warp.context import Stream, get_stream, set_stream, synchronize_stream
 from warp.context import Event, record_event, wait_event, wait_stream
+from warp.context import ReadbackRing, ReadbackFuture
 from warp.context import RegisteredGLBuffer
 
 from warp.tape import Tape
@@ -319,6 +322,40 @@ def exp(x: Float) -> Float:
     ...
 
 
+@over
+def sin_approx(x: Float) -> Float:
+    """
+    Return an approximation of the sine of x in radians, faster than :func:`sin` with an absolute error
+    around 1e-6 for small arguments that grows with the magnitude of x.
+    """
+    ...
+
+
+@over
+def cos_approx(x: Float) -> Float:
+    """
+    Return an approximation of the cosine of x in radians, faster than :func:`cos` with an absolute error
+    around 1e-6 for small arguments that grows with the magnitude of x.
+    """
+    ...
+
+
+@over
+def exp_approx(x: Float) -> Float:
+    """
+    Return an approximation of e^x, faster than :func:`exp` with a relative error of a few ulps.
+    """
+    ...
+
+
+@over
+def rsqrt(x: Float) -> Float:
+    """
+    Return the reciprocal square root of x, where x is positive, using the approximate hardware instruction on CUDA devices.
+    """
+    ...
+
+
 @over
 def pow(x: Float, y: Float) -> Float:
     """
@@ -598,6 +635,48 @@ def cw_div(x: Matrix[Any, Any, Scalar], y: Matrix[Any, Any, Scalar]) -> Matrix[A
     ...
 
 
+@over
+def polar3(A: Matrix[3, 3, Float], sweeps: int32):
+    """
+    Compute the rotation R of the polar decomposition A = R*S of a 3x3 matrix, where S is symmetric.
+    R is found from the SVD of A using ``sweeps`` Jacobi sweeps, see :func:`svd3`.
+    """
+    ...
+
+
+@over
+def cholesky(A: Matrix[Any, Any, Float]) -> Matrix[Any, Any, Float]:
+    """
+    Compute the Cholesky factor L of a symmetric positive definite matrix A = L*L^T, only the lower triangle of A is read.
+    The factorization is fully unrolled for the size of A, columns with a non-positive pivot are returned as zero.
+    """
+    ...
+
+
+@over
+def cholesky_solve(L: Matrix[Any, Any, Float], b: Vector[Any, Float]) -> Vector[Any, Float]:
+    """
+    Solve L*L^T*x = b for x given the Cholesky factor L returned by :func:`cholesky`.
+    """
+    ...
+
+
+@over
+def ldlt_solve(L: Matrix[Any, Any, Float], d: Vector[Any, Float], b: Vector[Any, Float]) -> Vector[Any, Float]:
+    """
+    Solve L*diag(d)*L^T*x = b for x given the factors returned by :func:`ldlt`, components with a zero pivot are returned as zero.
+    """
+    ...
+
+
+@over
+def solve(A: Matrix[Any, Any, Float], b: Vector[Any, Float]) -> Vector[Any, Float]:
+    """
+    Solve A*x = b for x with a fully unrolled LU factorization with partial pivoting of the square matrix A.
+    """
+    ...
+
+
 @over
 def quat_identity() -> quatf:
     """
@@ -964,6 +1043,7 @@ def mesh_query_point_sign_winding_number(
        but also the most expensive.
 
         Note that the Mesh object must be constructed with ``suport_winding_number=True`` for this method to return correct results.
+        The solid angle data is computed before launching kernels that call this method, after the mesh was created or refit.
 
        :param id: The mesh identifier
        :param point: The point in space to query
@@ -1030,6 +1110,52 @@ def mesh_query_aabb_next(query: mesh_query_aabb_t, index: int32) -> bool:
     ...
 
 
+@over
+def tlas_query_ray(
+    id: uint64,
+    start: vec3f,
+    dir: vec3f,
+    max_t: float32,
+    t: float32,
+    bary_u: float32,
+    bary_v: float32,
+    sign: float32,
+    normal: vec3f,
+    face: int32,
+    instance: int32,
+) -> bool:
+    """
+    Computes the closest ray hit over all mesh instances of the TLAS with identifier `id`, returns ``True`` if a point < ``max_t`` is found.
+       The ray is given in world space and transformed into the space of each instance's mesh.
+
+       :param id: The TLAS identifier
+       :param start: The start point of the ray
+       :param dir: The ray direction (should be normalized)
+       :param max_t: The maximum distance along the ray to check for intersections
+       :param t: Returns the distance of the closest hit along the ray
+       :param bary_u: Returns the barycentric u coordinate of the closest hit
+       :param bary_v: Returns the barycentric v coordinate of the closest hit
+       :param sign: Returns a value > 0 if the hit ray hit front of the face, returns < 0 otherwise
+       :param normal: Returns the world space face normal
+       :param face: Returns the index of the hit face in the instance's mesh
+       :param instance: Returns the index of the hit instance
+    """
+    ...
+
+
+@over
+def tlas_query_aabb(id: uint64, lower: vec3f, upper: vec3f) -> bvh_query_t:
+    """
+    Construct an axis-aligned bounding box query against the instances of a TLAS object. Iterate it with
+       `wp.bvh_query_next()` to visit the indices of all instances whose world space bounds overlap the box.
+
+       :param id: The TLAS identifier
+       :param lower: The lower bound of the bounding box in world space
+       :param upper: The upper bound of the bounding box in world space
+    """
+    ...
+
+
 @over
 def mesh_eval_position(id: uint64, face: int32, bary_u: float32, bary_v: float32) -> vec3f:
     """
@@ -1073,6 +1199,36 @@ def hash_grid_point_id(id: uint64, index: int32) -> int:
     ...
 
 
+@over
+def neighbor_list_query(id: uint64, point: int32) -> neighbor_list_query_t:
+    """
+    Construct a query over the precomputed neighbors of a point in a neighbor list. Returns an object that is
+       used to track state during neighbor traversal, the neighbors may lie up to the radius plus the skin of the list
+       away from the point and include the point itself.
+
+       :param id: The neighbor list identifier
+       :param point: The index of the point whose neighbors are visited
+    """
+    ...
+
+
+@over
+def neighbor_list_query_next(query: neighbor_list_query_t, index: int32) -> bool:
+    """
+    Move to the next neighbor in the neighbor list query. The index of the current neighbor is stored in
+       ``index``, returns ``False`` if there are no more neighbors.
+    """
+    ...
+
+
+@over
+def neighbor_list_count(id: uint64, point: int32) -> int:
+    """
+    Return the number of neighbors of a point in a neighbor list.
+    """
+    ...
+
+
 @over
 def intersect_tri_tri(v0: vec3f, v1: vec3f, v2: vec3f, u0: vec3f, u1: vec3f, u2: vec3f) -> int:
     """
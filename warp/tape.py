@@ -5,6 +5,8 @@
 # distribution of this software and related documentation without an express
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
+import math
+
 import warp as wp
 
 
@@ -36,12 +38,22 @@ class Tape:
 
         print(tape.gradients[a])
 
+    The backward pass skips the launches none of whose arguments has a gradient allocated, which can only hold zeros.
+    With ``warp.config.lazy_grad`` enabled, arrays allocate their gradients when a backward launch first writes to
+    them, so that only the arrays reached from the seeded gradients get one. :meth:`zero` only clears the gradients
+    written since the previous call.
     """
     def __init__(self):
         self.gradients = {}
         self.const_gradients = set()
         self.launches = []
 
+        # arrays and structs whose gradients were written since the last zero()
+        self.dirty_gradients = set()
+
+        # arrays whose gradients are written by the functions recorded with record_func(), by function id
+        self.func_arrays = {}
+
         self.loss = None
 
     def __enter__(self):
@@ -88,6 +100,8 @@ class Tape:
 
             # set the seed grad to 1.0
             loss.grad.fill_(1.0)
+            self.gradients[loss] = loss.grad
+            self.dirty_gradients.add(loss)
 
         # simply apply dict grads to objects
         # this is just for backward compat. with
@@ -103,16 +117,25 @@ class Tape:
             if callable(launch):
                 launch()
 
+                self.dirty_gradients.update(self.func_arrays.get(id(launch), ()))
+
             else:
                 kernel = launch[0]
                 dim = launch[1]
                 inputs = launch[2]
                 outputs = launch[3]
                 device = launch[4]
+                intermediates = launch[5]
+                max_dim = launch[6]
 
                 adj_inputs = []
                 adj_outputs = []
 
+                # the adjoints of a launch are linear in the ones of its arguments, which are all zero when none of
+                # them has a gradient allocated yet
+                if not any(Tape._grad_allocated(a) for a in list(inputs) + list(outputs)):
+                    continue
+
                 # lookup adjoint inputs
                 for a in inputs:
                     adj_inputs.append(self.get_adjoint(a))
@@ -130,8 +153,14 @@ class Tape:
                     adj_outputs=adj_outputs,
                     device=device,
                     adjoint=True,
+                    intermediates=intermediates,
+                    max_dim=max_dim,
                 )
 
+                for a in list(inputs) + list(outputs):
+                    if (wp.types.is_array(a) or isinstance(a, wp.codegen.StructInstance)) and a in self.gradients:
+                        self.dirty_gradients.add(a)
+
             # print("---------------------  kernel", i, "---------------------")
             # for adj in adj_inputs:
             #     if isinstance(adj, wp.array):
@@ -148,9 +177,53 @@ class Tape:
 
             # i += 1
 
-    # record a kernel launch on the tape
-    def record_launch(self, kernel, dim, inputs, outputs, device):
-        self.launches.append([kernel, dim, inputs, outputs, device])
+    def capture_backward(self, loss: wp.array = None, grads: dict = None, zero: bool = True):
+        """
+        Capture the backward pass of the recorded operations into a CUDA graph, optionally preceded by zeroing the
+        gradients, so that it can be replayed with :func:`~warp.capture_launch()` at every optimizer iteration
+        without the host cost of walking the tape. The recorded launches must all run on the same CUDA device.
+
+        Args:
+            loss (wp.array): A single-element array that holds the loss function value whose gradient is to be computed
+            grads (dict): A dictionary of arrays that map from Warp arrays to their incoming gradients
+            zero (bool): Whether the graph zeroes the gradients of the tape before evaluating the backward pass
+
+        Returns:
+            The captured graph
+        """
+        devices = set(launch[4] for launch in self.launches if not callable(launch))
+        if loss is not None:
+            devices.add(loss.device)
+
+        if len(devices) != 1:
+            raise RuntimeError("Can only capture the backward pass of a tape recorded on a single device")
+
+        device = wp.get_device(devices.pop())
+        if not device.is_cuda:
+            raise RuntimeError("Can only capture the backward pass of a tape recorded on a CUDA device")
+
+        # register the gradients of all launch arguments so the graph zeroes every one of them, which also allocates
+        # the lazy ones outside of the capture
+        for launch in self.launches:
+            if not callable(launch):
+                for a in list(launch[2]) + list(launch[3]):
+                    self.get_adjoint(a)
+        self.dirty_gradients.update(self.gradients.keys())
+
+        # the adjoint kernels belong to the modules already loaded by the forward launches
+        wp.capture_begin(device, force_module_load=False)
+        try:
+            if zero:
+                self.zero()
+            self.backward(loss=loss, grads=grads)
+        finally:
+            graph = wp.capture_end(device)
+
+        return graph
+
+    # record a kernel launch on the tape, along with the intermediates stored by its forward pass if any
+    def record_launch(self, kernel, dim, inputs, outputs, device, intermediates=None, max_dim=None):
+        self.launches.append([kernel, dim, inputs, outputs, device, intermediates, max_dim])
 
     def record_func(self, backward, arrays):
         """
@@ -165,11 +238,28 @@ class Tape:
         for a in arrays:
             if isinstance(a, wp.array) and a.grad:
                 self.gradients[a] = a.grad
+                self.dirty_gradients.add(a)
+                self.func_arrays.setdefault(id(backward), []).append(a)
             else:
                 raise RuntimeError(
                     f"Array {a} is not of type wp.array or is missing a gradient array. Set array parameter requires_grad=True during instantiation."
                 )
 
+    @staticmethod
+    def _grad_allocated(a):
+        # whether the gradient of a launch argument may hold nonzero values, without allocating lazy gradients
+        if isinstance(a, wp.array):
+            return a.grad_allocated
+        elif wp.types.is_array(a):
+            return a.grad is not None
+        elif isinstance(a, wp.codegen.StructInstance):
+            return any(
+                isinstance(a._cls.vars[name].type, wp.array) and Tape._grad_allocated(getattr(a, name))
+                for name, _ in a._cls.ctype._fields_
+                if not name.startswith("_")
+            )
+        return False
+
     # returns the adjoint of a kernel parameter
     def get_adjoint(self, a):
         if not wp.types.is_array(a) and not isinstance(a, wp.codegen.StructInstance):
@@ -208,17 +298,182 @@ class Tape:
         Clear all operations recorded on the tape and zero out all gradients.
         """
         self.launches = []
+        self.func_arrays = {}
         self.zero()
 
     def zero(self):
         """
-        Zero out all gradients recorded on the tape.
+        Zero out all gradients recorded on the tape, only clearing the ones written since the previous call.
         """
-        for a, g in self.gradients.items():
-            if a not in self.const_gradients:
+        for a in self.dirty_gradients:
+            g = self.gradients.get(a)
+            if g is not None and a not in self.const_gradients:
                 if isinstance(a, wp.codegen.StructInstance):
                     for name in g._cls.vars:
                         if isinstance(g._cls.vars[name].type, wp.array) and g._cls.vars[name].requires_grad:
                             getattr(g, name).zero_()
                 else:
                     g.zero_()
+
+        self.dirty_gradients.clear()
+
+
+class CheckpointTape:
+    """
+    Differentiable rollout of ``num_steps`` applications of ``step(state_in, state_out)`` that only stores every
+    ``checkpoint_every``-th state instead of every intermediate state kept alive by a :class:`Tape`.
+    During :meth:`backward` each segment between two checkpoints is re-run forward on a temporary tape and
+    differentiated, which trades one extra forward pass for storing about ``2 * sqrt(num_steps)`` states.
+
+    The states are arbitrary objects whose ``wp.array`` attributes make up the differentiable state, e.g.
+    :class:`warp.sim.State`, and ``alloc_state()`` must return a new state with the same arrays.
+
+    Example
+    -------
+
+    .. code-block:: python
+
+        def step(state_in, state_out):
+            state_in.clear_forces()
+            integrator.simulate(model, state_in, state_out, dt)
+
+        rollout = wp.CheckpointTape(step, lambda: model.state(requires_grad=True), num_steps=1000)
+        state_n = rollout.forward(state_0)
+
+        tape = wp.Tape()
+        with tape:
+            wp.launch(kernel=loss_kernel, dim=1, inputs=[state_n.particle_q, loss], device="cuda")
+        tape.backward(loss)
+
+        # propagates the gradients of state_n to state_0 and to the model parameters
+        rollout.backward()
+
+    """
+
+    def __init__(self, step, alloc_state, num_steps: int, checkpoint_every: int = None, memory_budget: int = None):
+        """
+        Args:
+            step (Callable): Launches the kernels advancing ``state_in`` to ``state_out``, must be deterministic
+            alloc_state (Callable): Returns a new state to hold checkpoints and recomputed segments
+            num_steps (int): Number of steps of the rollout
+            checkpoint_every (int): Number of steps between checkpoints, defaults to ``ceil(sqrt(num_steps))``
+            memory_budget (int): Maximum number of bytes of the states allocated by the rollout, including gradients
+        """
+        if num_steps < 1:
+            raise ValueError("A checkpointed rollout needs at least one step")
+
+        self.step = step
+        self.alloc_state = alloc_state
+        self.num_steps = num_steps
+
+        if checkpoint_every is None:
+            checkpoint_every = int(math.ceil(math.sqrt(num_steps)))
+        self.checkpoint_every = max(1, min(checkpoint_every, num_steps))
+
+        self.state_0 = None
+        self.checkpoints = []
+        self.segment = []
+
+        # ping-pong buffers of the forward pass, the last one written holds the final state
+        self.buffers = [alloc_state(), alloc_state()]
+
+        if memory_budget is not None:
+            required = self.num_states() * CheckpointTape._state_bytes(self.buffers[0])
+            if required > memory_budget:
+                raise RuntimeError(
+                    f"Checkpointed rollout of {num_steps} steps with a checkpoint every {self.checkpoint_every} steps "
+                    f"needs {required} bytes, exceeding the memory budget of {memory_budget} bytes"
+                )
+
+    @staticmethod
+    def _arrays(state):
+        return [(name, a) for name, a in vars(state).items() if isinstance(a, wp.array)]
+
+    @staticmethod
+    def _state_bytes(state):
+        return sum(a.capacity * (2 if a.requires_grad else 1) for _, a in CheckpointTape._arrays(state))
+
+    @staticmethod
+    def _copy(dest, src, grad=False):
+        for name, a in CheckpointTape._arrays(src):
+            b = getattr(dest, name)
+            if grad:
+                if a.grad and b.grad:
+                    wp.copy(b.grad, a.grad)
+            else:
+                wp.copy(b, a)
+
+    @staticmethod
+    def _zero_grad(state):
+        for _, a in CheckpointTape._arrays(state):
+            if a.grad:
+                a.grad.zero_()
+
+    def num_states(self):
+        """
+        Number of states allocated by the rollout: checkpoints, segment states and the two forward buffers.
+        """
+        num_checkpoints = (self.num_steps - 1) // self.checkpoint_every
+        return num_checkpoints + self.checkpoint_every + 3
+
+    def forward(self, state_0):
+        """
+        Runs the rollout from ``state_0`` without recording it and stores the checkpoints.
+
+        Returns:
+            The final state, whose gradients seed :meth:`backward`
+        """
+        if wp.context.runtime.tape is not None:
+            raise RuntimeError("Warp: Error, a checkpointed rollout cannot be recorded on an active tape")
+
+        self.state_0 = state_0
+
+        num_checkpoints = (self.num_steps - 1) // self.checkpoint_every
+        while len(self.checkpoints) < num_checkpoints:
+            self.checkpoints.append(self.alloc_state())
+
+        state = state_0
+        for i in range(self.num_steps):
+            out = self.buffers[i % 2]
+            self.step(state, out)
+            state = out
+
+            if (i + 1) % self.checkpoint_every == 0 and i + 1 < self.num_steps:
+                CheckpointTape._copy(self.checkpoints[(i + 1) // self.checkpoint_every - 1], state)
+
+        self.final_state = state
+        return state
+
+    def backward(self):
+        """
+        Propagates the gradients of the final state returned by :meth:`forward` to ``state_0`` and accumulates the
+        gradients of any other array read by ``step``, such as model parameters.
+        """
+        if self.state_0 is None:
+            raise RuntimeError("Warp: Error, the rollout must be run forward before calling backward()")
+
+        while len(self.segment) < self.checkpoint_every + 1:
+            self.segment.append(self.alloc_state())
+
+        k = self.checkpoint_every
+        seed = self.final_state
+
+        for j in reversed(range((self.num_steps - 1) // k + 1)):
+            length = min(k, self.num_steps - j * k)
+            states = [self.state_0 if j == 0 else self.segment[0]] + self.segment[1 : length + 1]
+
+            # the end of this segment receives the gradients of the start of the following one
+            CheckpointTape._copy(states[length], seed, grad=True)
+            for s in states[1:length]:
+                CheckpointTape._zero_grad(s)
+            if j > 0:
+                CheckpointTape._zero_grad(states[0])
+                CheckpointTape._copy(states[0], self.checkpoints[j - 1])
+
+            tape = Tape()
+            with tape:
+                for i in range(length):
+                    self.step(states[i], states[i + 1])
+            tape.backward()
+
+            seed = states[0]
@@ -142,6 +142,64 @@ def test_adam_solve_two_inputs(test, device):
             test.assertLessEqual(v, tol)
 
 
+def test_adam_multi_tensor(test, device):
+    rng = np.random.default_rng(123)
+    lengths = [5, 12, 0, 7]
+    dtypes = [float, wp.vec3, float, wp.vec3]
+
+    def make_arrays():
+        arrays = []
+        for n, dtype in zip(lengths, dtypes):
+            shape = (n, 3) if dtype == wp.vec3 else n
+            arrays.append(wp.array(rng.standard_normal(shape), dtype=dtype, device=device))
+        return arrays
+
+    def reference_step(opt, grads):
+        for i, p in enumerate(opt.params):
+            if isinstance(opt, warp.optim.Adam):
+                opt.step_detail(grads[i], opt.m[i], opt.v[i], opt.lr, opt.beta1, opt.beta2, opt.t, opt.eps, p)
+            else:
+                opt.step_detail(
+                    grads[i], opt.b[i], opt.lr, opt.momentum, opt.dampening, opt.weight_decay, opt.nesterov, opt.t, p
+                )
+        opt.t += 1
+
+    params_init = make_arrays()
+    grads = make_arrays()
+    g_np = np.concatenate([g.numpy().flatten() for g in grads])
+    max_norm = 0.5 * np.linalg.norm(g_np)
+
+    for opt_type, kwargs in ((warp.optim.Adam, {"lr": 0.1}), (warp.optim.SGD, {"lr": 0.1, "momentum": 0.9})):
+        # reference: one launch per parameter array with pre-scaled gradients
+        params_ref = [wp.clone(p) for p in params_init]
+        ref = opt_type(params_ref, **kwargs)
+        scaled = [wp.array(g.numpy() * 0.5, dtype=g.dtype, device=device) for g in grads]
+        for _ in range(3):
+            reference_step(ref, scaled)
+
+        params = [wp.clone(p) for p in params_init]
+        opt = opt_type(params, max_grad_norm=max_norm, **kwargs)
+        opt.step(grads)
+
+        # the following steps only launch kernels and can be captured
+        if wp.get_device(device).is_cuda:
+            wp.capture_begin(device)
+            try:
+                opt.step(grads)
+            finally:
+                graph = wp.capture_end(device)
+            for _ in range(2):
+                wp.capture_launch(graph)
+        else:
+            opt.step(grads)
+            opt.step(grads)
+
+        assert_np_equal(opt.grad_norm.numpy(), np.array([np.linalg.norm(g_np), 0.5]), tol=1e-5)
+        test.assertEqual(opt._multi_tensor.step_count.numpy()[0], 3)
+        for p, p_ref in zip(params, params_ref):
+            assert_np_equal(p.numpy(), p_ref.numpy(), tol=1e-5)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -151,6 +209,7 @@ def register(parent):
     add_function_test(TestArray, "test_adam_solve_float", test_adam_solve_float, devices=devices)
     add_function_test(TestArray, "test_adam_solve_vec3", test_adam_solve_vec3, devices=devices)
     add_function_test(TestArray, "test_adam_solve_two_inputs", test_adam_solve_two_inputs, devices=devices)
+    add_function_test(TestArray, "test_adam_multi_tensor", test_adam_multi_tensor, devices=devices)
 
     return TestArray
 
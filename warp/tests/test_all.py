@@ -21,20 +21,33 @@ import warp.tests.test_mesh_query_aabb
 import warp.tests.test_mesh_query_point
 import warp.tests.test_mesh_query_ray
 import warp.tests.test_bvh
+import warp.tests.test_tlas
+import warp.tests.test_ray_tracer
+import warp.tests.test_radix_sort
+import warp.tests.test_segmented
+import warp.tests.test_scan
+import warp.tests.test_compact
+import warp.tests.test_persistent
 import warp.tests.test_conditional
 import warp.tests.test_operators
 import warp.tests.test_rounding
 import warp.tests.test_hash_grid
+import warp.tests.test_neighbor_list
 import warp.tests.test_ctypes
 import warp.tests.test_rand
 import warp.tests.test_noise
 import warp.tests.test_tape
 import warp.tests.test_compile_consts
 import warp.tests.test_volume
+import warp.tests.test_texture
+import warp.tests.test_tile
 import warp.tests.test_mlp
 import warp.tests.test_grad
 import warp.tests.test_intersect
 import warp.tests.test_array
+import warp.tests.test_autotune
+import warp.tests.test_bounds_check
+import warp.tests.test_checkpoint
 import warp.tests.test_launch
 import warp.tests.test_import
 import warp.tests.test_func
@@ -45,23 +58,31 @@ import warp.tests.test_closest_point_edge_edge
 import warp.tests.test_multigpu
 import warp.tests.test_quat
 import warp.tests.test_atomic
+import warp.tests.test_intrinsics
 import warp.tests.test_adam
 import warp.tests.test_transient_module
 import warp.tests.test_lerp
 import warp.tests.test_smoothstep
 import warp.tests.test_model
+import warp.tests.test_sim_mpm
 import warp.tests.test_fast_math
 import warp.tests.test_streams
+import warp.tests.test_mempool
+import warp.tests.test_memory_stats
+import warp.tests.test_deterministic
 import warp.tests.test_torch
 import warp.tests.test_pinned
 import warp.tests.test_matmul
 import warp.tests.test_options
 import warp.tests.test_dlpack
+import warp.tests.test_jax
 import warp.tests.test_vec
 import warp.tests.test_mat
 import warp.tests.test_arithmetic
 import warp.tests.test_spatial
 import warp.tests.test_sparse
+import warp.tests.test_linear_solvers
+import warp.tests.test_sparse_distributed
 import warp.tests.test_math
 import warp.tests.test_generics
 import warp.tests.test_indexedarray
@@ -79,20 +100,33 @@ def register_tests(parent):
     tests.append(warp.tests.test_mesh_query_point.register(parent))
     tests.append(warp.tests.test_mesh_query_ray.register(parent))
     tests.append(warp.tests.test_bvh.register(parent))
+    tests.append(warp.tests.test_tlas.register(parent))
+    tests.append(warp.tests.test_ray_tracer.register(parent))
+    tests.append(warp.tests.test_radix_sort.register(parent))
+    tests.append(warp.tests.test_segmented.register(parent))
+    tests.append(warp.tests.test_scan.register(parent))
+    tests.append(warp.tests.test_compact.register(parent))
+    tests.append(warp.tests.test_persistent.register(parent))
     tests.append(warp.tests.test_conditional.register(parent))
     tests.append(warp.tests.test_operators.register(parent))
     tests.append(warp.tests.test_rounding.register(parent))
     tests.append(warp.tests.test_hash_grid.register(parent))
+    tests.append(warp.tests.test_neighbor_list.register(parent))
     tests.append(warp.tests.test_ctypes.register(parent))
     tests.append(warp.tests.test_rand.register(parent))
     tests.append(warp.tests.test_noise.register(parent))
     tests.append(warp.tests.test_tape.register(parent))
     tests.append(warp.tests.test_compile_consts.register(parent))
     tests.append(warp.tests.test_volume.register(parent))
+    tests.append(warp.tests.test_texture.register(parent))
+    tests.append(warp.tests.test_tile.register(parent))
     tests.append(warp.tests.test_mlp.register(parent))
     tests.append(warp.tests.test_grad.register(parent))
     tests.append(warp.tests.test_intersect.register(parent))
     tests.append(warp.tests.test_array.register(parent))
+    tests.append(warp.tests.test_autotune.register(parent))
+    tests.append(warp.tests.test_bounds_check.register(parent))
+    tests.append(warp.tests.test_checkpoint.register(parent))
     tests.append(warp.tests.test_launch.register(parent))
     tests.append(warp.tests.test_import.register(parent))
     tests.append(warp.tests.test_func.register(parent))
@@ -103,23 +137,31 @@ def register_tests(parent):
     tests.append(warp.tests.test_multigpu.register(parent))
     tests.append(warp.tests.test_quat.register(parent))
     tests.append(warp.tests.test_atomic.register(parent))
+    tests.append(warp.tests.test_intrinsics.register(parent))
     tests.append(warp.tests.test_adam.register(parent))
     tests.append(warp.tests.test_transient_module.register(parent))
     tests.append(warp.tests.test_lerp.register(parent))
     tests.append(warp.tests.test_smoothstep.register(parent))
     tests.append(warp.tests.test_model.register(parent))
+    tests.append(warp.tests.test_sim_mpm.register(parent))
     tests.append(warp.tests.test_fast_math.register(parent))
     tests.append(warp.tests.test_streams.register(parent))
+    tests.append(warp.tests.test_mempool.register(parent))
+    tests.append(warp.tests.test_memory_stats.register(parent))
+    tests.append(warp.tests.test_deterministic.register(parent))
     tests.append(warp.tests.test_torch.register(parent))
     tests.append(warp.tests.test_pinned.register(parent))
     tests.append(warp.tests.test_matmul.register(parent))
     tests.append(warp.tests.test_options.register(parent))
     tests.append(warp.tests.test_dlpack.register(parent))
+    tests.append(warp.tests.test_jax.register(parent))
     tests.append(warp.tests.test_vec.register(parent))
     tests.append(warp.tests.test_mat.register(parent))
     tests.append(warp.tests.test_arithmetic.register(parent))
     tests.append(warp.tests.test_spatial.register(parent))
     tests.append(warp.tests.test_sparse.register(parent))
+    tests.append(warp.tests.test_linear_solvers.register(parent))
+    tests.append(warp.tests.test_sparse_distributed.register(parent))
     tests.append(warp.tests.test_math.register(parent))
     tests.append(warp.tests.test_generics.register(parent))
     tests.append(warp.tests.test_indexedarray.register(parent))
@@ -6,6 +6,7 @@
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
 import math
+import os
 import unittest
 
 # include parent path
@@ -2102,6 +2103,185 @@ def test_array_from_numpy(test, device):
     assert_np_equal(result.numpy(), expected.numpy())
 
 
+@wp.kernel
+def kernel_managed_inc(a: wp.array(dtype=float)):
+    i = wp.tid()
+    a[i] = a[i] + float(i)
+
+
+def test_managed(test, device):
+    n = 1024
+    a = wp.zeros(n, dtype=float, device=device, managed=True)
+    test.assertTrue(a.managed)
+    test.assertTrue(a[1:].managed)
+
+    a.advise("preferred_location")
+    a.prefetch()
+    wp.launch(kernel_managed_inc, dim=n, inputs=[a], device=device)
+    wp.synchronize_device(device)
+
+    # the same memory is used by CPU kernels after the device work has completed
+    a.prefetch("cpu")
+    wp.synchronize_device(device)
+    wp.launch(kernel_managed_inc, dim=n, inputs=[a], device="cpu")
+    assert_np_equal(a.numpy(), 2.0 * np.arange(n, dtype=np.float32))
+
+    a.advise("read_mostly")
+    a.advise("read_mostly", unset=True)
+
+    with test.assertRaises(ValueError):
+        a.advise("sometimes")
+
+    with test.assertRaises(RuntimeError):
+        wp.zeros(n, dtype=float, device=device).prefetch()
+
+    with test.assertRaises(RuntimeError):
+        wp.zeros(n, dtype=float, device="cpu", managed=True)
+
+
+@wp.kernel
+def kernel_soa_scale(a: wp.array(dtype=wp.vec3, layout="soa"), b: wp.array(dtype=wp.vec3), s: float):
+    i = wp.tid()
+    b[i] = a[i] * s
+    a[i] = a[i] + wp.vec3(1.0)
+
+
+@wp.kernel
+def kernel_soa_loss(a: wp.array(dtype=wp.vec3, layout="soa"), loss: wp.array(dtype=float)):
+    i = wp.tid()
+    wp.atomic_add(loss, 0, wp.dot(a[i], wp.vec3(1.0, 2.0, 3.0)) * float(a.shape[0]))
+
+
+def test_array_soa(test, device):
+    data = np.arange(12, dtype=np.float32).reshape(4, 3)
+    a = wp.array(data, dtype=wp.vec3, layout="soa", device=device, requires_grad=True)
+    test.assertIsInstance(a, wp.soaarray)
+    assert_np_equal(a.numpy(), data)
+    assert_np_equal(a.planes.numpy(), data.T)
+
+    # existing kernel code works unchanged on the planes
+    b = wp.zeros(4, dtype=wp.vec3, device=device)
+    wp.launch(kernel_soa_scale, dim=4, inputs=[a, b, 2.0], device=device)
+    assert_np_equal(b.numpy(), 2.0 * data)
+    assert_np_equal(a.numpy(), data + 1.0)
+
+    # copies convert between layouts
+    wp.copy(a, b)
+    assert_np_equal(a.numpy(), 2.0 * data)
+    assert_np_equal(a.contiguous().numpy(), 2.0 * data)
+    a.fill_(wp.vec3(1.0, 2.0, 3.0))
+    assert_np_equal(a.numpy(), np.tile([1.0, 2.0, 3.0], (4, 1)))
+
+    # gradients are stored in the same layout
+    loss = wp.zeros(1, dtype=float, device=device, requires_grad=True)
+    tape = wp.Tape()
+    with tape:
+        wp.launch(kernel_soa_loss, dim=4, inputs=[a, loss], device=device)
+    tape.backward(loss)
+    test.assertIsInstance(a.grad, wp.soaarray)
+    assert_np_equal(a.grad.numpy(), np.tile([4.0, 8.0, 12.0], (4, 1)))
+
+    with test.assertRaises(RuntimeError):
+        wp.launch(kernel_soa_scale, dim=4, inputs=[b, b, 2.0], device=device)
+    with test.assertRaises(TypeError):
+        wp.array(dtype=float, layout="soa")
+    with test.assertRaises(ValueError):
+        wp.array(dtype=wp.vec3, layout="aosoa")
+
+
+@wp.kernel
+def kernel_sum_2d(a: wp.array2d(dtype=float), total: wp.array(dtype=float)):
+    i, j = wp.tid()
+    wp.atomic_add(total, 0, a[i, j])
+
+
+def test_array_expression(test, device):
+    x_np = np.linspace(-1.0, 1.0, 12, dtype=np.float32).reshape(4, 3)
+    y_np = np.linspace(0.0, 2.0, 12, dtype=np.float32).reshape(4, 3)
+    x = wp.array(x_np, dtype=float, device=device, requires_grad=True)
+    y = wp.array(y_np, dtype=float, device=device)
+
+    # the whole expression is evaluated by a single kernel
+    e = wp.clamp(2.0 * x + y - 1.0, 0.0, 1.0)
+    test.assertIsInstance(e, wp.ArrayExpression)
+    test.assertEqual(e.shape, (4, 3))
+    kernel, leaves = e.kernel()
+    test.assertEqual(sum(1 for a in leaves if isinstance(a, wp.array)), 2)
+    assert_np_equal(e.numpy(), np.clip(2.0 * x_np + y_np - 1.0, 0.0, 1.0))
+
+    # kernels are shared by expressions of the same structure and types
+    test.assertIs(wp.clamp(3.0 * y + x - 2.0, 0.5, 1.0).kernel()[0], kernel)
+
+    out = wp.zeros_like(y)
+    out.assign(wp.where(x > y, wp.sin(x), y / 3.0))
+    assert_np_equal(out.numpy(), np.where(x_np > y_np, np.sin(x_np), y_np / 3.0), tol=1.0e-6)
+
+    # vectors scaled by arrays of scalars
+    v = wp.array(np.ones((4, 3, 3)), dtype=wp.vec3, device=device)
+    assert_np_equal(wp.length(v * x + v).numpy(), np.sqrt(3.0) * np.abs(x_np + 1.0), tol=1.0e-6)
+
+    # expressions passed to launches are evaluated first
+    z = wp.zeros(1, dtype=float, device=device, requires_grad=True)
+    tape = wp.Tape()
+    with tape:
+        wp.launch(kernel_sum_2d, dim=(4, 3), inputs=[-x * x], outputs=[z], device=device)
+    assert_np_equal(z.numpy(), [-np.sum(x_np * x_np)], tol=1.0e-5)
+
+    # the fused launch is recorded on the tape too
+    tape.backward(z)
+    assert_np_equal(x.grad.numpy(), -2.0 * x_np, tol=1.0e-6)
+
+    with test.assertRaises(RuntimeError):
+        x + wp.zeros(3, dtype=float, device=device)
+    with test.assertRaises(RuntimeError):
+        x + v
+
+
+@wp.kernel
+def double_values(a: wp.array(dtype=wp.vec2)):
+    tid = wp.tid()
+    a[tid] = 2.0 * a[tid]
+
+
+def test_array_from_numpy_no_copy(test, device):
+    na = np.arange(8, dtype=np.float32).reshape(4, 2)
+    a = wp.from_numpy(na, dtype=wp.vec2, device=device, copy=False)
+
+    wp.launch(double_values, dim=4, inputs=[a], device=device)
+    assert_np_equal(a.numpy(), 2.0 * np.arange(8).reshape(4, 2))
+
+    # CPU arrays alias the NumPy memory
+    if device.is_cpu:
+        test.assertEqual(a.ptr, na.ctypes.data)
+        assert_np_equal(na, 2.0 * np.arange(8).reshape(4, 2))
+    else:
+        assert_np_equal(na, np.arange(8).reshape(4, 2))
+
+
+def test_array_from_file(test, device):
+    import tempfile
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "points.bin")
+        np.arange(16, dtype=np.float32).tofile(path)
+
+        # the whole file as vectors, and a slice of it after an offset
+        a = wp.array.from_file(path, dtype=wp.vec2, device=device)
+        test.assertEqual(a.shape, (8,))
+        assert_np_equal(a.numpy(), np.arange(16).reshape(8, 2))
+
+        b = wp.array.from_file(path, dtype=float, shape=(2, 3), offset=8, mmap=False, device=device)
+        assert_np_equal(b.numpy(), np.arange(2, 8).reshape(2, 3))
+
+        # writable mappings of CPU arrays write through to the file
+        c = wp.array.from_file(path, dtype=wp.vec2, mode="r+", device=device)
+        wp.launch(double_values, dim=8, inputs=[c], device=device)
+        wp.synchronize_device(device)
+        expected = 2.0 * np.arange(16) if device.is_cpu else np.arange(16)
+        del a, c
+        assert_np_equal(np.fromfile(path, dtype=np.float32), expected)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -2147,6 +2327,11 @@ def register(parent):
     add_function_test(TestArray, "test_array_of_structs_from_numpy", test_array_of_structs_from_numpy, devices=devices)
     add_function_test(TestArray, "test_array_of_structs_roundtrip", test_array_of_structs_roundtrip, devices=devices)
     add_function_test(TestArray, "test_array_from_numpy", test_array_from_numpy, devices=devices)
+    add_function_test(TestArray, "test_array_from_numpy_no_copy", test_array_from_numpy_no_copy, devices=devices)
+    add_function_test(TestArray, "test_array_from_file", test_array_from_file, devices=devices)
+    add_function_test(TestArray, "test_managed", test_managed, devices=wp.get_cuda_devices())
+    add_function_test(TestArray, "test_array_soa", test_array_soa, devices=devices)
+    add_function_test(TestArray, "test_array_expression", test_array_expression, devices=devices)
 
     return TestArray
 
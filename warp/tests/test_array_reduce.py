@@ -1,7 +1,7 @@
 import numpy as np
 import warp as wp
 
-from warp.utils import array_sum, array_inner
+from warp.utils import array_sum, array_inner, array_stats, array_min, array_argmax
 from warp.tests.test_base import *
 
 wp.init()
@@ -93,6 +93,70 @@ def make_test_array_inner_axis(dtype):
     return test_array_inner
 
 
+def make_test_array_stats(dtype):
+    N = 1000
+
+    def test_array_stats(test, device):
+        cols = wp.types.type_length(dtype)
+
+        values_np = np.random.rand(N, cols)
+        values = wp.array(values_np, device=device, dtype=dtype)
+
+        vsum = wp.empty(1, dtype=dtype, device=device)
+        vmin = wp.empty(1, dtype=dtype, device=device)
+        vmax = wp.empty(1, dtype=dtype, device=device)
+        argmin = wp.empty(cols, dtype=wp.int32, device=device)
+        argmax = wp.empty(cols, dtype=wp.int32, device=device)
+
+        array_stats(values, sum=vsum, min=vmin, max=vmax, argmin=argmin, argmax=argmax)
+
+        assert_np_equal(vsum.numpy().reshape(-1) / N, values_np.sum(axis=0) / N, 0.0001)
+        assert_np_equal(vmin.numpy().reshape(-1), values_np.min(axis=0), 0.0001)
+        assert_np_equal(vmax.numpy().reshape(-1), values_np.max(axis=0), 0.0001)
+        assert_np_equal(argmin.numpy(), values_np.argmin(axis=0))
+        assert_np_equal(argmax.numpy(), values_np.argmax(axis=0))
+
+    return test_array_stats
+
+
+def test_array_stats_strided(test, device):
+    values_np = np.random.rand(200, 3)
+    values = wp.array(values_np, device=device, dtype=float)
+
+    # reduce a single column
+    column = values[:, 1]
+    test.assertAlmostEqual(array_min(column), values_np[:, 1].min(), places=5)
+    test.assertEqual(array_argmax(column), values_np[:, 1].argmax())
+
+    # results stay on device when an output array is provided
+    out = wp.empty(1, dtype=wp.int32, device=device)
+    array_argmax(column, out=out, value_count=50)
+    test.assertEqual(out.numpy()[0], values_np[:50, 1].argmax())
+
+
+def test_array_stats_empty(test, device):
+    values = wp.empty(0, dtype=wp.vec3, device=device)
+
+    vsum = wp.full(1, 1.0, dtype=wp.vec3, device=device)
+    vmin = wp.empty(1, dtype=wp.vec3, device=device)
+    vmax = wp.empty(1, dtype=wp.vec3, device=device)
+    argmin = wp.empty(3, dtype=wp.int32, device=device)
+    argmax = wp.empty(3, dtype=wp.int32, device=device)
+
+    array_stats(values, sum=vsum, min=vmin, max=vmax, argmin=argmin, argmax=argmax)
+
+    limits = np.finfo(np.float32)
+    assert_np_equal(vsum.numpy().reshape(-1), np.zeros(3))
+    assert_np_equal(vmin.numpy().reshape(-1), np.full(3, limits.max))
+    assert_np_equal(vmax.numpy().reshape(-1), np.full(3, limits.min))
+    assert_np_equal(argmin.numpy(), np.full(3, -1))
+    assert_np_equal(argmax.numpy(), np.full(3, -1))
+
+    # leading elements of a non-empty array
+    values = wp.array(np.random.rand(10), dtype=float, device=device)
+    test.assertEqual(array_argmax(values, value_count=0), -1)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -107,6 +171,10 @@ def register(parent):
     add_function_test(
         TestArraySym, "test_array_inner_axis_float", make_test_array_inner_axis(wp.float32), devices=devices
     )
+    add_function_test(TestArraySym, "test_array_stats_double", make_test_array_stats(wp.float64), devices=devices)
+    add_function_test(TestArraySym, "test_array_stats_vec3", make_test_array_stats(wp.vec3), devices=devices)
+    add_function_test(TestArraySym, "test_array_stats_strided", test_array_stats_strided, devices=devices)
+    add_function_test(TestArraySym, "test_array_stats_empty", test_array_stats_empty, devices=devices)
 
     return TestArraySym
 
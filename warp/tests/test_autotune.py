@@ -0,0 +1,151 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import tempfile
+import unittest
+
+import numpy as np
+
+import warp as wp
+import warp.autotune
+from warp.sparse import bsr_zeros, bsr_set_from_triplets, bsr_mv
+from warp.tests.test_base import *
+
+wp.init()
+
+
+@wp.kernel(block_dim=64)
+def scale_small_blocks(a: wp.array(dtype=float), b: wp.array(dtype=float)):
+    i = wp.tid()
+    b[i] = 2.0 * a[i]
+
+
+@wp.kernel(block_dim=256)
+def scale_large_blocks(a: wp.array(dtype=float), b: wp.array(dtype=float)):
+    i = wp.tid()
+    b[i] = 2.0 * a[i]
+
+
+class TemporaryTuningDatabase:
+    """Points the tuning database to an empty directory, modules are loaded before so they aren't rebuilt there"""
+
+    def __enter__(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.saved = wp.config.kernel_cache_dir
+        wp.config.kernel_cache_dir = self.tmp.name
+        return self
+
+    def __exit__(self, *args):
+        wp.config.kernel_cache_dir = self.saved
+        self.tmp.cleanup()
+
+
+def test_autotune_kernels(test, device):
+    n = 1000
+    a = wp.array(np.arange(n, dtype=np.float32), device=device)
+    b = wp.zeros(n, dtype=float, device=device)
+
+    variants = [scale_small_blocks, scale_large_blocks]
+    for kernel in variants:
+        wp.launch(kernel, dim=n, inputs=[a, b], device=device)
+
+    with TemporaryTuningDatabase():
+        kernel = wp.autotune(variants, dim=n, inputs=[a, b], device=device, iterations=2)
+        test.assertIn(kernel, variants)
+
+        # the winner is recorded for the size bucket of the launch
+        key = warp.autotune.kernel_key(variants)
+        test.assertIs(variants[warp.autotune.lookup(key, device, 1024)], kernel)
+        test.assertIsNone(warp.autotune.lookup(key, device, 2048))
+
+        wp.launch(kernel, dim=n, inputs=[a, b], device=device)
+        assert_np_equal(b.numpy(), 2.0 * np.arange(n))
+
+
+def test_autotune_callables(test, device):
+    with TemporaryTuningDatabase():
+        calls = []
+
+        def variant(i):
+            return lambda: calls.append(i)
+
+        variants = [variant(0), variant(1)]
+        with test.assertRaises(ValueError):
+            wp.autotune(variants, device=device, size=100)
+
+        warp.autotune.record("test_autotune", device, 100, 1)
+        test.assertEqual(warp.autotune.lookup("test_autotune", device, 128), 1)
+
+        # recorded results are returned without running the variants
+        test.assertIs(wp.autotune(variants, device=device, key="test_autotune", size=100), variants[1])
+        test.assertEqual(calls, [])
+
+        best = wp.autotune(variants, device=device, key="test_autotune", size=100, iterations=3, force=True)
+        test.assertIn(best, variants)
+        test.assertEqual(len(calls), 8)
+
+        # results are read back from the database file
+        warp.autotune._database = None
+        test.assertEqual(warp.autotune.lookup("test_autotune", device, 100), variants.index(best))
+
+        warp.autotune.clear()
+        test.assertIsNone(warp.autotune.lookup("test_autotune", device, 100))
+
+
+def test_autotune_bsr_mv(test, device):
+    nrow = 40
+    ncol = 30
+    nnz = 200
+    block_shape = (3, 3)
+
+    rows = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+    cols = wp.array(np.random.randint(0, ncol, nnz, dtype=int), dtype=int, device=device)
+    vals = wp.array(np.random.rand(nnz, *block_shape), dtype=float, device=device)
+
+    A = bsr_zeros(nrow, ncol, wp.mat33, device=device)
+    bsr_set_from_triplets(A, rows, cols, vals)
+
+    x = wp.array(np.random.rand(ncol, 3), dtype=wp.vec3, device=device)
+    y = wp.array(np.random.rand(nrow, 3), dtype=wp.vec3, device=device)
+
+    dense = np.zeros((nrow * 3, ncol * 3))
+    for r, c, v in zip(rows.numpy(), cols.numpy(), vals.numpy()):
+        dense[r * 3 : (r + 1) * 3, c * 3 : (c + 1) * 3] += v
+
+    ref = -1.0 * (dense @ x.numpy().flatten()) + 2.0 * y.numpy().flatten()
+
+    with TemporaryTuningDatabase():
+        saved = wp.config.autotune
+        wp.config.autotune = True
+        try:
+            bsr_mv(A, x, y, -1.0, 2.0)
+        finally:
+            wp.config.autotune = saved
+
+        if device.is_cuda:
+            key = f"warp.sparse.bsr_mv:3x3:{A.scalar_type.__name__}"
+            test.assertIsNotNone(warp.autotune.lookup(key, device, A.nnz))
+
+    assert_np_equal(y.numpy().flatten(), ref, 0.0001)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestAutotune(parent):
+        pass
+
+    add_function_test(TestAutotune, "test_autotune_kernels", test_autotune_kernels, devices=devices)
+    add_function_test(TestAutotune, "test_autotune_callables", test_autotune_callables, devices=devices)
+    add_function_test(TestAutotune, "test_autotune_bsr_mv", test_autotune_bsr_mv, devices=devices)
+
+    return TestAutotune
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
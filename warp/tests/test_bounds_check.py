@@ -0,0 +1,130 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import unittest
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+wp.init()
+
+# the kernels of this module report their out-of-bounds accesses
+wp.set_module_options({"mode": "checked"})
+
+
+@wp.kernel
+def gather(values: wp.array(dtype=float), indices: wp.array(dtype=int), out: wp.array(dtype=float)):
+    i = wp.tid()
+    out[i] = values[indices[i]]
+
+
+@wp.kernel
+def gather_columns(values: wp.array2d(dtype=float), indices: wp.array(dtype=int), out: wp.array(dtype=float)):
+    i = wp.tid()
+    out[i] = values[0, indices[i]]
+
+
+@wp.struct
+class Table:
+    values: wp.array(dtype=float)
+
+
+@wp.kernel
+def gather_struct(table: Table, indices: wp.array(dtype=int), out: wp.array(dtype=float)):
+    i = wp.tid()
+    out[i] = table.values[indices[i]]
+
+
+def test_bounds_check_in_bounds(test, device):
+    values = wp.array(np.arange(4, dtype=np.float32), device=device)
+    indices = wp.array([3, 0, 2, 1], dtype=int, device=device)
+    out = wp.zeros(4, dtype=float, device=device)
+
+    wp.launch(gather, dim=4, inputs=[values, indices, out], device=device)
+    wp.synchronize_device(device)
+
+    assert_np_equal(out.numpy(), np.array([3.0, 0.0, 2.0, 1.0]))
+
+
+def test_bounds_check_out_of_bounds(test, device):
+    values = wp.array(np.arange(1, 5, dtype=np.float32), device=device)
+    indices = wp.array([0, 1, 5, 2, -1], dtype=int, device=device)
+    out = wp.zeros(5, dtype=float, device=device)
+
+    wp.launch(gather, dim=5, inputs=[values, indices, out], device=device)
+
+    with test.assertRaisesRegex(
+        RuntimeError,
+        r"kernel 'gather'.*thread (2|4): index (5|-1) of dimension 0 of size 4 of array 'values' \(1 more",
+    ):
+        wp.synchronize_device(device)
+
+    # out-of-bounds reads are redirected to the first element
+    assert_np_equal(out.numpy(), np.array([1.0, 2.0, 1.0, 3.0, 1.0]))
+
+    # the record is cleared once reported
+    wp.synchronize_device(device)
+
+    columns = wp.array(np.ones((2, 3), dtype=np.float32), device=device)
+    wp.launch(gather_columns, dim=5, inputs=[columns, indices, out], device=device)
+
+    with test.assertRaisesRegex(RuntimeError, r"kernel 'gather_columns'.*of dimension 1 of size 3 of array 'values'"):
+        wp.synchronize()
+
+
+def test_bounds_check_struct(test, device):
+    table = Table()
+    table.values = wp.zeros(3, dtype=float, device=device)
+    indices = wp.array([1, 3], dtype=int, device=device)
+    out = wp.zeros(2, dtype=float, device=device)
+
+    wp.launch(gather_struct, dim=2, inputs=[table, indices, out], device=device)
+
+    with test.assertRaisesRegex(RuntimeError, r"index 3 of dimension 0 of size 3 of array 'table.values'"):
+        wp.synchronize_device(device)
+
+
+def test_bounds_check_recorded_launch(test, device):
+    values = wp.zeros(4, dtype=float, device=device)
+    indices = wp.array([0, 1, 2, 3, 4, 5], dtype=int, device=device)
+    out = wp.zeros(6, dtype=float, device=device)
+
+    cmd = wp.launch(gather, dim=4, inputs=[values, indices, out], device=device, record_cmd=True)
+    cmd.launch()
+    wp.synchronize_device(device)
+
+    # resized launches keep reporting their accesses
+    cmd.set_dim(6)
+    cmd.launch()
+
+    with test.assertRaisesRegex(RuntimeError, r"kernel 'gather'.*of size 4 of array 'values'"):
+        wp.synchronize_device(device)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestBoundsCheck(parent):
+        pass
+
+    add_function_test(TestBoundsCheck, "test_bounds_check_in_bounds", test_bounds_check_in_bounds, devices=devices)
+    add_function_test(
+        TestBoundsCheck, "test_bounds_check_out_of_bounds", test_bounds_check_out_of_bounds, devices=devices
+    )
+    add_function_test(TestBoundsCheck, "test_bounds_check_struct", test_bounds_check_struct, devices=devices)
+    add_function_test(
+        TestBoundsCheck, "test_bounds_check_recorded_launch", test_bounds_check_recorded_launch, devices=devices
+    )
+
+    return TestBoundsCheck
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
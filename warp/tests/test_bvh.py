@@ -70,15 +70,14 @@ def intersect_ray_aabb(start, dir, lower, upper):
         return 0
 
 
-def test_bvh(test, type, device):
-    num_bounds = 100
+def test_bvh(test, type, device, wide=False, level_refit=False, num_bounds=100):
     lowers = np.random.rand(num_bounds, 3) * 5.0
     uppers = lowers + np.random.rand(num_bounds, 3) * 5.0
 
     device_lowers = wp.array(lowers, dtype=wp.vec3, device=device)
     device_uppers = wp.array(uppers, dtype=wp.vec3, device=device)
 
-    bvh = wp.Bvh(device_lowers, device_uppers)
+    bvh = wp.Bvh(device_lowers, device_uppers, wide=wide, level_refit=level_refit)
 
     bounds_intersected = wp.zeros(shape=(num_bounds), dtype=int, device=device)
 
@@ -130,6 +129,137 @@ def test_bvh_query_ray(test, device):
     test_bvh(test, "ray", device)
 
 
+def test_bvh_duplicate_bounds(test, device):
+    # coincident and flat bounds produce identical Morton codes on the device builder
+    num_bounds = 64
+    lowers = np.zeros((num_bounds, 3))
+    lowers[num_bounds // 2 :, 0] = 1.0
+    uppers = lowers + 0.5
+
+    bvh = wp.Bvh(wp.array(lowers, dtype=wp.vec3, device=device), wp.array(uppers, dtype=wp.vec3, device=device))
+
+    bounds_intersected = wp.zeros(shape=(num_bounds), dtype=int, device=device)
+
+    wp.launch(
+        kernel=bvh_query_aabb,
+        dim=1,
+        inputs=[bvh.id, wp.vec3(-1.0, -1.0, -1.0), wp.vec3(2.0, 2.0, 2.0), bounds_intersected],
+        device=device,
+    )
+
+    test.assertTrue(np.all(bounds_intersected.numpy() == 1))
+
+
+def test_bvh_wide(test, device):
+    test_bvh(test, "AABB", device, wide=True)
+    test_bvh(test, "ray", device, wide=True)
+
+
+def test_bvh_level_refit(test, device):
+    test_bvh(test, "AABB", device, level_refit=True)
+    test_bvh(test, "ray", device, level_refit=True)
+
+
+def test_bvh_large(test, device):
+    # enough bounds for the host builder to split the tree into parallel tasks
+    test_bvh(test, "AABB", device, num_bounds=10000)
+
+
+def test_bvh_short_stack(test, device):
+    # trees deeper than the stack fall back to walking parent links
+    wp.set_module_options({"bvh_stack_size": 2})
+    test_bvh(test, "AABB", device)
+    test_bvh(test, "ray", device)
+    wp.set_module_options({"bvh_stack_size": None})
+
+
+def test_bvh_stackless(test, device):
+    wp.set_module_options({"bvh_stackless": True})
+    test_bvh(test, "AABB", device)
+    test_bvh(test, "ray", device)
+    wp.set_module_options({"bvh_stackless": False})
+
+
+def quat_to_matrix_np(q):
+    x, y, z, w = q
+    return np.array(
+        [
+            [1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y - z * w), 2.0 * (x * z + y * w)],
+            [2.0 * (x * y + z * w), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z - x * w)],
+            [2.0 * (x * z - y * w), 2.0 * (y * z + x * w), 1.0 - 2.0 * (x * x + y * y)],
+        ]
+    )
+
+
+# brute force reference of Bvh.query_overlap(), bounds b are moved into the frame of a by xform
+def overlap_pairs_np(lowers_a, uppers_a, lowers_b, uppers_b, margin, xform):
+    r = quat_to_matrix_np(xform.q)
+    c = 0.5 * (lowers_b + uppers_b) @ r.T + np.array(xform.p)
+    h = 0.5 * (uppers_b - lowers_b) @ np.abs(r).T
+
+    lo_a = lowers_a[:, None, :] - margin
+    up_a = uppers_a[:, None, :] + margin
+    overlap = np.all((lo_a <= (c + h)[None, :, :]) & (up_a >= (c - h)[None, :, :]), axis=2)
+
+    return set(zip(*np.nonzero(overlap)))
+
+
+def test_bvh_overlap(test, device):
+    num_a, num_b = 300, 400
+    lowers_a = np.random.rand(num_a, 3) * 5.0
+    uppers_a = lowers_a + np.random.rand(num_a, 3) * 0.5
+    lowers_b = np.random.rand(num_b, 3) * 5.0
+    uppers_b = lowers_b + np.random.rand(num_b, 3) * 0.5
+
+    a = wp.Bvh(wp.array(lowers_a, dtype=wp.vec3, device=device), wp.array(uppers_a, dtype=wp.vec3, device=device))
+    b = wp.Bvh(wp.array(lowers_b, dtype=wp.vec3, device=device), wp.array(uppers_b, dtype=wp.vec3, device=device))
+
+    xform = wp.transform(wp.vec3(0.5, -0.2, 0.1), wp.quat_from_axis_angle(wp.normalize(wp.vec3(1.0, 2.0, 3.0)), 0.4))
+    margin = 0.05
+
+    expected = overlap_pairs_np(lowers_a, uppers_a, lowers_b, uppers_b, margin, xform)
+
+    pairs = wp.zeros(len(expected) + 16, dtype=wp.vec2i, device=device)
+    count = wp.zeros(1, dtype=wp.int32, device=device)
+    a.query_overlap(b, pairs, count, margin=margin, xform=xform)
+
+    n = count.numpy()[0]
+    test.assertEqual(n, len(expected))
+    test.assertEqual(set(map(tuple, pairs.numpy()[:n])), expected)
+
+    # the count still reports all pairs when the output is too small
+    pairs = wp.zeros(4, dtype=wp.vec2i, device=device)
+    a.query_overlap(b, pairs, count, margin=margin, xform=xform)
+    test.assertEqual(count.numpy()[0], len(expected))
+    test.assertTrue(set(map(tuple, pairs.numpy())) <= expected)
+
+
+def test_bvh_self_overlap(test, device):
+    num_bounds = 500
+    lowers = np.random.rand(num_bounds, 3) * 5.0
+    uppers = lowers + np.random.rand(num_bounds, 3) * 0.5
+
+    bvh = wp.Bvh(wp.array(lowers, dtype=wp.vec3, device=device), wp.array(uppers, dtype=wp.vec3, device=device))
+    margin = 0.05
+
+    # each pair of distinct bounds once
+    all_pairs = overlap_pairs_np(lowers, uppers, lowers, uppers, margin, wp.transform_identity())
+    expected = set((i, j) for i, j in all_pairs if i < j)
+
+    pairs = wp.zeros(len(expected) + 16, dtype=wp.vec2i, device=device)
+    count = wp.zeros(1, dtype=wp.int32, device=device)
+    bvh.query_self_overlap(pairs, count, margin=margin)
+
+    n = count.numpy()[0]
+    test.assertEqual(n, len(expected))
+    test.assertEqual(set(map(tuple, pairs.numpy()[:n])), expected)
+
+    pairs = wp.zeros(4, dtype=wp.vec2i, device=device)
+    bvh.query_self_overlap(pairs, count, margin=margin)
+    test.assertEqual(count.numpy()[0], len(expected))
+    test.assertTrue(set(map(tuple, pairs.numpy())) <= expected)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -138,6 +268,14 @@ def register(parent):
 
     add_function_test(TestBvh, "test_bvh_aabb", test_bvh_query_aabb, devices=devices)
     add_function_test(TestBvh, "test_bvh_ray", test_bvh_query_ray, devices=devices)
+    add_function_test(TestBvh, "test_bvh_duplicate_bounds", test_bvh_duplicate_bounds, devices=devices)
+    add_function_test(TestBvh, "test_bvh_wide", test_bvh_wide, devices=devices)
+    add_function_test(TestBvh, "test_bvh_level_refit", test_bvh_level_refit, devices=devices)
+    add_function_test(TestBvh, "test_bvh_large", test_bvh_large, devices=devices)
+    add_function_test(TestBvh, "test_bvh_short_stack", test_bvh_short_stack, devices=devices)
+    add_function_test(TestBvh, "test_bvh_stackless", test_bvh_stackless, devices=devices)
+    add_function_test(TestBvh, "test_bvh_overlap", test_bvh_overlap, devices=devices)
+    add_function_test(TestBvh, "test_bvh_self_overlap", test_bvh_self_overlap, devices=devices)
 
     return TestBvh
 
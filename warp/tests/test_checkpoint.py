@@ -0,0 +1,79 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+wp.init()
+
+
+@wp.kernel
+def overwrite(a: wp.array(dtype=wp.vec3)):
+    tid = wp.tid()
+    a[tid] = wp.vec3(-1.0)
+
+
+class CheckpointState:
+    def __init__(self, device):
+        self.particle_q = wp.array(np.arange(30, dtype=np.float32).reshape(10, 3), dtype=wp.vec3, device=device)
+        self.body_q = wp.array(np.eye(7, dtype=np.float32)[:4], dtype=wp.transform, device=device)
+        self.count = wp.array(np.arange(6, dtype=np.int32).reshape(2, 3), dtype=int, device=device)
+        self.empty = wp.empty(0, dtype=float, device=device)
+        self.dt = 0.01
+
+
+def test_checkpoint_roundtrip(test, device):
+    state = CheckpointState(device)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "state.wpc")
+        future = wp.save_checkpoint(path, state)
+
+        # the arrays may change while the checkpoint is written
+        wp.launch(overwrite, dim=10, inputs=[state.particle_q], device=device)
+        future.result()
+
+        arrays = wp.load_checkpoint(path, device=device)
+        test.assertEqual(set(arrays.keys()), {"particle_q", "body_q", "count", "empty"})
+        test.assertEqual(arrays["body_q"].dtype, wp.transform)
+        test.assertEqual(arrays["count"].shape, (2, 3))
+        assert_np_equal(arrays["particle_q"].numpy(), np.arange(30).reshape(10, 3))
+        assert_np_equal(arrays["body_q"].numpy(), np.eye(7)[:4])
+        assert_np_equal(arrays["count"].numpy(), np.arange(6).reshape(2, 3))
+
+        # restores the arrays of an existing state in place
+        restored = CheckpointState(device)
+        restored.particle_q.zero_()
+        wp.load_checkpoint(path, into=restored)
+        assert_np_equal(restored.particle_q.numpy(), np.arange(30).reshape(10, 3))
+
+        # arrays of another shape are rejected
+        other = {"count": wp.zeros(5, dtype=int, device=device)}
+        with test.assertRaises(RuntimeError):
+            wp.load_checkpoint(path, into=other)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestCheckpoint(parent):
+        pass
+
+    add_function_test(TestCheckpoint, "test_checkpoint_roundtrip", test_checkpoint_roundtrip, devices=devices)
+
+    return TestCheckpoint
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
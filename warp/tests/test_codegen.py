@@ -187,6 +187,23 @@ def test_pass(n: int):
     wp.expect_eq(i, n)
 
 
+@wp.kernel
+def test_while_break_continue(n: int):
+    i = int(0)
+    evens = int(0)
+
+    while i < n:
+        i = i + 1
+        if i % 2 == 1:
+            continue
+        if i == 8:
+            break
+        evens = evens + 1
+
+    wp.expect_eq(i, 8)
+    wp.expect_eq(evens, 3)
+
+
 @wp.kernel
 def test_break(n: int):
     a = int(0)
@@ -317,6 +334,123 @@ def test_range_constant_dynamic_nested(m: int):
     wp.expect_eq(s, N * m * N)
 
 
+@wp.kernel
+def test_common_subexpressions(x: float, n: int):
+    a = wp.sin(x) * 2.0
+    b = wp.sin(x) + 1.0
+    unused = wp.cos(x) * 3.0
+
+    # reused values can be modified without affecting the values they were computed with
+    u = wp.vec3(x, 1.0, 2.0)
+    v = wp.vec3(x, 1.0, 2.0)
+    v[0] = 4.0
+
+    s = float(0.0)
+    for i in range(n):
+        s = s + wp.sin(x)
+        x = x + 1.0
+
+    wp.expect_eq(a, wp.sin(1.0) * 2.0)
+    wp.expect_eq(b, wp.sin(1.0) + 1.0)
+    wp.expect_eq(u[0], 1.0)
+    wp.expect_eq(v[0], 4.0)
+    wp.expect_near(s, wp.sin(1.0) + wp.sin(2.0) + wp.sin(3.0), 1.0e-5)
+    wp.expect_eq(wp.sin(x), wp.sin(4.0))
+
+
+def test_optimize_codegen(test, device):
+    module = test_common_subexpressions.module
+
+    def forward_source(options):
+        wp.context.ModuleBuilder(module, options)
+        return "\n".join(test_common_subexpressions.adj.blocks[0].body_forward)
+
+    # the second sin(x) reuses the first one, the ones in and after the loop that modifies x are evaluated
+    # again, and the unused cos(x) is removed
+    source = forward_source(module.options)
+    test.assertEqual(source.count("wp::sin(var_x)"), 3)
+    test.assertNotIn("wp::cos(", source)
+
+    source = forward_source({**module.options, "optimize_codegen": False})
+    test.assertEqual(source.count("wp::sin(var_x)"), 4)
+    test.assertIn("wp::cos(", source)
+
+    # rebuild with the module's options
+    forward_source(module.options)
+
+
+@wp.kernel(specialize=["n", "scale"])
+def test_specialized(out: wp.array(dtype=float), n: int, scale: float):
+    s = float(0.0)
+    for i in range(n):
+        s += float(i)
+
+    if n > 2:
+        s *= scale
+
+    out[0] = s
+
+
+def test_specialize(test, device):
+    out = wp.zeros(1, dtype=float, device=device)
+
+    for n, scale, expected in ((3, 2.0, 6.0), (2, 2.0, 1.0), (3, 0.5, 1.5), (40, 1.0, 780.0)):
+        wp.launch(test_specialized, dim=1, inputs=[out, n, scale], device=device)
+        test.assertEqual(out.numpy()[0], expected)
+
+    # one kernel is compiled for each combination of values, equal values of other types share it
+    wp.launch(test_specialized, dim=1, inputs=[out, wp.int32(3), 2], device=device)
+    test.assertEqual(out.numpy()[0], 6.0)
+    test.assertEqual(len(test_specialized.specializations), 4)
+
+    # loops over specialized bounds are unrolled up to the module's max_unroll
+    unrolled = test_specialized.specializations[(3, 2.0)]
+    dynamic = test_specialized.specializations[(40, 1.0)]
+    test.assertFalse(any("for_start" in s for s in unrolled.adj.blocks[0].body_forward))
+    test.assertTrue(any("for_start" in s for s in dynamic.adj.blocks[0].body_forward))
+
+    with test.assertRaises(TypeError):
+        wp.Kernel(func=test_specialized.func, key="bad_specialization", module=None, specialize=["out"])
+
+
+@wp.kernel(cpu_simd_width=4)
+def test_simd_lanes(x: wp.array(dtype=wp.vec3), y: wp.array2d(dtype=float)):
+    i, j = wp.tid()
+    v = x[i] * float(j + 1)
+    if wp.length(v) > 1.0:
+        v = wp.normalize(v)
+    y[i, j] = wp.dot(v, wp.vec3(1.0, 2.0, 3.0))
+
+
+@wp.kernel(cpu_simd_width=4)
+def test_simd_lanes_loop(y: wp.array(dtype=float), n: int):
+    i = wp.tid()
+    for k in range(n):
+        y[i] = y[i] + float(k)
+
+
+def test_cpu_simd_width(test, device):
+    x = wp.array([[0.1, 0.2, 0.0], [0.0, 3.0, 4.0], [-0.25, 0.0, 0.0]], dtype=wp.vec3, device=device)
+    y = wp.zeros((3, 5), dtype=float, device=device)
+    wp.launch(test_simd_lanes, dim=y.shape, inputs=[x, y], device=device)
+
+    expected = np.zeros((3, 5))
+    for i, v in enumerate(x.numpy()):
+        for j in range(5):
+            w = v * (j + 1)
+            if np.linalg.norm(w) > 1.0:
+                w = w / np.linalg.norm(w)
+            expected[i, j] = np.dot(w, (1.0, 2.0, 3.0))
+    assert_np_equal(y.numpy(), expected, tol=1.0e-6)
+
+    # kernels with dynamic loops keep running one thread at a time
+    y = wp.zeros(4, dtype=float, device=device)
+    wp.launch(test_simd_lanes_loop, dim=4, inputs=[y, 3], device=device)
+    assert_np_equal(y.numpy(), np.full(4, 3.0))
+    test.assertTrue(test_simd_lanes.adj.lane_safe)
+    test.assertFalse(test_simd_lanes_loop.adj.lane_safe)
+
+
 def test_unresolved_func(test, device):
     # kernel with unresolved function must be in a separate module, otherwise the current module would fail to load
     from warp.tests.test_unresolved_func import unresolved_func_kernel
@@ -345,6 +479,57 @@ def test_unresolved_symbol(test, device):
     del sys.modules["warp.tests.test_unresolved_symbol"]
 
 
+def test_module_hash_cache(test, device):
+    module = test_inplace.module
+
+    h = module.hash_module()
+    test.assertEqual(module.hash_module(), h)
+
+    # the cached hash is recomputed when an option changes and matches again once restored
+    max_unroll = module.options["max_unroll"]
+    module.options["max_unroll"] = max_unroll + 1
+    test.assertNotEqual(module.hash_module(), h)
+    module.options["max_unroll"] = max_unroll
+    test.assertEqual(module.hash_module(), h)
+
+    # the content hash is rebuilt from the digests cached on the functions and kernels
+    module.content_hash = None
+    test.assertEqual(module.hash_module(), h)
+    test.assertIsNotNone(test_inplace.adj.source_hash)
+
+
+def _keyed_kernel_fn(x: wp.array(dtype=float)):
+    x[wp.tid()] = 1.0
+
+
+def test_module_hash_keys(test, device):
+    # kernels generated from the same function under different keys must not share cached binaries
+    hashes = []
+    for key in ("keyed_kernel_a", "keyed_kernel_b"):
+        module = wp.get_module(f"warp.tests.test_codegen_{key}")
+        wp.Kernel(func=_keyed_kernel_fn, key=key, module=module)
+        hashes.append(module.hash_module())
+        del wp.context.user_modules[module.name]
+
+    test.assertNotEqual(hashes[0], hashes[1])
+
+
+def test_kernel_metadata(test, device):
+    module = test_inplace.module
+    module.load(device)
+
+    # launch properties are restored from the metadata saved with the binaries instead of generating code
+    metadata = module.get_kernel_metadata()
+    kernel_name = test_inplace.get_mangled_name()
+    test.assertIn(kernel_name, metadata)
+
+    test_inplace.adj.intermediates_size = -1
+    module.restore_kernel_metadata(module.hash_module())
+    test.assertEqual(module.get_kernel_metadata(), metadata)
+
+    test.assertFalse(module.set_kernel_metadata({}))
+
+
 def register(parent):
     class TestCodeGen(parent):
         pass
@@ -454,6 +639,14 @@ def register(parent):
     add_kernel_test(TestCodeGen, name="test_while_zero", kernel=test_while, dim=1, inputs=[0], devices=devices)
     add_kernel_test(TestCodeGen, name="test_while_positive", kernel=test_while, dim=1, inputs=[16], devices=devices)
     add_kernel_test(TestCodeGen, name="test_pass", kernel=test_pass, dim=1, inputs=[16], devices=devices)
+    add_kernel_test(
+        TestCodeGen,
+        name="test_while_break_continue",
+        kernel=test_while_break_continue,
+        dim=1,
+        inputs=[16],
+        devices=devices,
+    )
 
     add_kernel_test(TestCodeGen, name="test_break", kernel=test_break, dim=1, inputs=[10], devices=devices)
     add_kernel_test(TestCodeGen, name="test_break_early", kernel=test_break_early, dim=1, inputs=[10], devices=devices)
@@ -466,6 +659,20 @@ def register(parent):
 
     add_function_test(TestCodeGen, func=test_unresolved_func, name="test_unresolved_func", devices=devices)
     add_function_test(TestCodeGen, func=test_unresolved_symbol, name="test_unresolved_symbol", devices=devices)
+    add_function_test(TestCodeGen, func=test_module_hash_cache, name="test_module_hash_cache")
+    add_function_test(TestCodeGen, func=test_module_hash_keys, name="test_module_hash_keys")
+    add_function_test(TestCodeGen, func=test_kernel_metadata, name="test_kernel_metadata", devices=devices)
+    add_kernel_test(
+        TestCodeGen,
+        name="test_common_subexpressions",
+        kernel=test_common_subexpressions,
+        inputs=[1.0, 3],
+        dim=1,
+        devices=devices,
+    )
+    add_function_test(TestCodeGen, func=test_optimize_codegen, name="test_optimize_codegen")
+    add_function_test(TestCodeGen, func=test_specialize, name="test_specialize", devices=devices)
+    add_function_test(TestCodeGen, func=test_cpu_simd_width, name="test_cpu_simd_width", devices=devices)
 
     return TestCodeGen
 
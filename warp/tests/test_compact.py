@@ -0,0 +1,139 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+@wp.kernel
+def emit_particles(
+    positions: wp.array(dtype=wp.vec3), count: wp.array(dtype=int), capacity: int, out: wp.array(dtype=wp.vec3)
+):
+    tid = wp.tid()
+
+    i = wp.atomic_add(count, 0, 1)
+    if i < capacity:
+        out[i] = positions[tid]
+
+
+@wp.kernel
+def mark_below(
+    positions: wp.array(dtype=wp.vec3), count: wp.array(dtype=int), height: float, mask: wp.array(dtype=int)
+):
+    tid = wp.tid()
+
+    # launched over the capacity, the threads past the device-side count are idle
+    if tid >= count[0]:
+        return
+
+    if positions[tid][1] < height:
+        mask[tid] = 1
+    else:
+        mask[tid] = 0
+
+
+def test_compact(test, device):
+    rng = np.random.default_rng(123)
+    values_np = rng.standard_normal(size=(1000, 3)).astype(np.float32)
+    mask_np = rng.integers(0, 3, size=1000).astype(np.int32)
+
+    values = wp.array(values_np, dtype=wp.vec3, device=device)
+    mask = wp.array(mask_np, dtype=int, device=device)
+    out = wp.zeros(1000, dtype=wp.vec3, device=device)
+
+    count = wp.utils.compact(values, mask, out)
+    expected = values_np[mask_np != 0]
+    test.assertEqual(count.numpy()[0], len(expected))
+    assert_np_equal(out.numpy()[: len(expected)], expected)
+
+    # limited by a host count
+    wp.utils.compact(values, mask, out, count=count, value_count=100)
+    expected = values_np[:100][mask_np[:100] != 0]
+    test.assertEqual(count.numpy()[0], len(expected))
+    assert_np_equal(out.numpy()[: len(expected)], expected)
+
+    # limited by a device count, which can also receive the result
+    count = wp.array([300], dtype=int, device=device)
+    wp.utils.compact(values, mask, out, count=count, value_count=count)
+    expected = values_np[:300][mask_np[:300] != 0]
+    test.assertEqual(count.numpy()[0], len(expected))
+    assert_np_equal(out.numpy()[: len(expected)], expected)
+
+    with test.assertRaises(RuntimeError):
+        wp.utils.compact(values, mask, wp.zeros(1000, dtype=float, device=device))
+
+
+def test_append_buffer(test, device):
+    rng = np.random.default_rng(456)
+    capacity = 256
+
+    buffer = wp.utils.AppendBuffer(wp.vec3, capacity, device=device)
+    test.assertEqual(buffer.size(), 0)
+
+    # two emissions in a row, the order within each one is not defined
+    emitted = []
+    for _ in range(2):
+        positions_np = rng.standard_normal(size=(100, 3)).astype(np.float32)
+        positions = wp.array(positions_np, dtype=wp.vec3, device=device)
+        wp.launch(
+            emit_particles, dim=100, inputs=[positions, buffer.count, buffer.capacity, buffer.data], device=device
+        )
+        emitted.append(positions_np)
+
+    test.assertEqual(buffer.size(), 200)
+    test.assertFalse(buffer.overflowed())
+
+    emitted = np.concatenate(emitted)
+    stored = buffer.data.numpy()[:200]
+    assert_np_equal(np.sort(stored, axis=0), np.sort(emitted, axis=0))
+
+    # remove the particles that fell below the ground without reading the count back
+    mask = wp.zeros(capacity, dtype=int, device=device)
+    wp.launch(mark_below, dim=capacity, inputs=[buffer.data, buffer.count, 0.0], outputs=[mask], device=device)
+    buffer.remove(mask)
+
+    expected = stored[stored[:, 1] >= 0.0]
+    test.assertEqual(buffer.size(), len(expected))
+    assert_np_equal(buffer.data.numpy()[: len(expected)], expected)
+
+    # appends past the capacity are dropped until the buffer grows
+    positions = wp.array(rng.standard_normal(size=(capacity, 3)).astype(np.float32), dtype=wp.vec3, device=device)
+    wp.launch(
+        emit_particles, dim=capacity, inputs=[positions, buffer.count, buffer.capacity, buffer.data], device=device
+    )
+    test.assertTrue(buffer.overflowed())
+    test.assertEqual(buffer.size(), capacity)
+
+    buffer.clear()
+    test.assertEqual(buffer.size(), 0)
+
+    buffer.reserve(2 * capacity)
+    test.assertEqual(buffer.capacity, 2 * capacity)
+    test.assertEqual(buffer.data.size, 2 * capacity)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestCompact(parent):
+        pass
+
+    add_function_test(TestCompact, "test_compact", test_compact, devices=devices)
+    add_function_test(TestCompact, "test_append_buffer", test_append_buffer, devices=devices)
+
+    return TestCompact
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -200,6 +200,39 @@ def test_copy_indexed(test, device):
         assert_np_equal(a4.numpy(), expected4 * s)
 
 
+def test_copy_layouts(test, device):
+    with wp.ScopedDevice(device):
+        # element sizes of 1, 2, 6, 16, and 36 bytes with whole-row, row-range, and strided views
+        for dtype, dtype_shape, np_dtype in (
+            (wp.uint8, (), np.uint8),
+            (wp.float16, (), np.float16),
+            (wp.vec3h, (3,), np.float16),
+            (wp.vec4, (4,), np.float32),
+            (wp.mat33, (3, 3), np.float32),
+        ):
+            np_data = (np.arange(4 * 6 * 8 * wp.types.type_length(dtype)) % 251).astype(np_dtype)
+            np_data = np_data.reshape((4, 6, 8, *dtype_shape))
+            wp_data = wp.array(np_data, dtype=dtype)
+
+            for view in (
+                (slice(1, 3),),
+                (slice(None), slice(2, 5)),
+                (slice(None), slice(None), slice(1, 7)),
+                (slice(None, None, 2), slice(1, None), slice(None, None, 3)),
+            ):
+                src = wp_data[view]
+                dst = wp.zeros_like(src)
+                wp.copy(dst, src)
+                assert_np_equal(dst.numpy(), np_data[view])
+
+                # copy back into a view of a different array
+                out = wp.zeros_like(wp_data)
+                wp.copy(out[view], dst)
+                expected = np.zeros_like(np_data)
+                expected[view] = np_data[view]
+                assert_np_equal(out.numpy(), expected)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -208,6 +241,7 @@ def register(parent):
 
     add_function_test(TestCopy, "test_copy_strided", test_copy_strided, devices=devices)
     add_function_test(TestCopy, "test_copy_indexed", test_copy_indexed, devices=devices)
+    add_function_test(TestCopy, "test_copy_layouts", test_copy_layouts, devices=devices)
 
     return TestCopy
 
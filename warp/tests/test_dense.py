@@ -42,12 +42,116 @@ def eval_dense_solve(
     wp.dense_solve(n, A, L, b, x)
 
 
+@wp.kernel
+def eval_dense_gemm_batched(
+    m: wp.array(dtype=int),
+    n: wp.array(dtype=int),
+    p: wp.array(dtype=int),
+    t1: int,
+    t2: int,
+    A_start: wp.array(dtype=int),
+    B_start: wp.array(dtype=int),
+    C_start: wp.array(dtype=int),
+    A: wp.array(dtype=float),
+    B: wp.array(dtype=float),
+    C: wp.array(dtype=float),
+):
+    wp.dense_gemm_batched(m, n, p, t1, t2, A_start, B_start, C_start, A, B, C)
+
+
+@wp.kernel
+def eval_dense_cholesky_batched_warp(
+    A_start: wp.array(dtype=int),
+    A_dim: wp.array(dtype=int),
+    A: wp.array(dtype=float),
+    regularization: wp.array(dtype=float),
+    L: wp.array(dtype=float),
+):
+    wp.dense_chol_batched_warp(A_start, A_dim, A, regularization, L)
+
+
+@wp.kernel
+def eval_dense_solve_batched_warp(
+    b_start: wp.array(dtype=int),
+    A_start: wp.array(dtype=int),
+    A_dim: wp.array(dtype=int),
+    A: wp.array(dtype=float),
+    L: wp.array(dtype=float),
+    b: wp.array(dtype=float),
+    tmp: wp.array(dtype=float),
+    x: wp.array(dtype=float),
+):
+    wp.dense_solve_batched_warp(b_start, A_start, A_dim, A, L, b, tmp, x)
+
+
+def test_dense_batched(test, device):
+    rng = np.random.default_rng(123)
+
+    # sizes larger than a warp and than a GEMM tile exercise the strided loops
+    dims = [5, 40, 17]
+    starts = np.cumsum([0] + [n * n for n in dims])[:-1]
+    b_starts = np.cumsum([0] + dims)[:-1]
+
+    mats = []
+    for n in dims:
+        M = rng.uniform(-1.0, 1.0, size=(n, n))
+        mats.append(M @ M.T + n * np.eye(n))
+    rhs = [rng.uniform(-1.0, 1.0, size=n) for n in dims]
+
+    threads_per_matrix = 1 if device.is_cpu else 32
+    threads_per_gemm = 1 if device.is_cpu else 256
+
+    A = wp.array(np.concatenate([M.flatten() for M in mats]), dtype=float, device=device)
+    A_start = wp.array(starts, dtype=int, device=device)
+    A_dim = wp.array(dims, dtype=int, device=device)
+    b_start = wp.array(b_starts, dtype=int, device=device)
+    b = wp.array(np.concatenate(rhs), dtype=float, device=device)
+    reg = wp.zeros(sum(dims), dtype=float, device=device)
+
+    L = wp.zeros_like(A)
+    x = wp.zeros_like(b)
+    tmp = wp.zeros_like(b)
+
+    wp.launch(
+        eval_dense_cholesky_batched_warp,
+        dim=len(dims) * threads_per_matrix,
+        inputs=[A_start, A_dim, A, reg, L],
+        device=device,
+    )
+    wp.launch(
+        eval_dense_solve_batched_warp,
+        dim=len(dims) * threads_per_matrix,
+        inputs=[b_start, A_start, A_dim, A, L, b, tmp, x],
+        device=device,
+    )
+
+    for i, n in enumerate(dims):
+        L_i = L.numpy()[starts[i] : starts[i] + n * n].reshape(n, n)
+        assert_np_equal(np.tril(L_i), np.linalg.cholesky(mats[i]), tol=1e-3)
+        assert_np_equal(x.numpy()[b_starts[i] : b_starts[i] + n], np.linalg.solve(mats[i], rhs[i]), tol=1e-4)
+
+    # C = A^T*A for each matrix
+    C = wp.zeros_like(A)
+    wp.launch(
+        eval_dense_gemm_batched,
+        dim=len(dims) * threads_per_gemm,
+        inputs=[A_dim, A_dim, A_dim, 1, 0, A_start, A_start, A_start, A, A, C],
+        device=device,
+    )
+    for i, n in enumerate(dims):
+        C_i = C.numpy()[starts[i] : starts[i] + n * n].reshape(n, n)
+        expected = mats[i].T @ mats[i]
+        assert_np_equal(C_i / expected.max(), expected / expected.max(), tol=1e-5)
+
+
 def register(parent):
     devices = get_test_devices()
 
     class TestDense(parent):
         pass
 
+    add_function_test(TestDense, "test_dense_batched", test_dense_batched, devices=devices)
+
     # just testing compilation of the dense matrix routines
     # most are deprecated / WIP
     wp.force_load()
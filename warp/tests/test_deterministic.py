@@ -0,0 +1,117 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import math
+
+import numpy as np
+import warp as wp
+import warp.sim
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+def test_deterministic_scatter(test, device):
+    rng = np.random.default_rng(123)
+    keys = rng.integers(-1, 16, size=1000).astype(np.int32)
+    values = rng.standard_normal(size=(1000, 3)).astype(np.float32)
+
+    scatter = wp.utils.DeterministicScatter(wp.array(keys, dtype=int, device=device), 16)
+    out = wp.zeros(16, dtype=wp.vec3, device=device)
+    scatter.add(wp.array(values, dtype=wp.vec3, device=device), out)
+
+    # the values of each key are summed in increasing slot order, negative keys are dropped
+    expected = np.zeros((16, 3), dtype=np.float32)
+    for k, v in zip(keys, values):
+        if k >= 0:
+            expected[k] += v
+    assert_np_equal(out.numpy(), expected, tol=1.0e-5)
+
+    # sorting by new keys
+    keys = rng.integers(0, 16, size=1000).astype(np.int32)
+    scatter.update(wp.array(keys, dtype=int, device=device))
+    out.zero_()
+    scatter.add(wp.array(values, dtype=wp.vec3, device=device), out)
+
+    expected = np.zeros((16, 3), dtype=np.float32)
+    for k, v in zip(keys, values):
+        expected[k] += v
+    assert_np_equal(out.numpy(), expected, tol=1.0e-5)
+
+
+def build_cloth_model(device):
+    builder = wp.sim.ModelBuilder()
+    builder.add_cloth_grid(
+        pos=(0.0, 1.0, 0.0),
+        rot=wp.quat_from_axis_angle((1.0, 0.0, 0.0), math.pi * 0.5),
+        vel=(0.0, 0.0, 0.0),
+        dim_x=16,
+        dim_y=16,
+        cell_x=0.1,
+        cell_y=0.1,
+        mass=0.1,
+        add_springs=True,
+        spring_ke=1.0e3,
+    )
+    builder.add_shape_sphere(body=-1, pos=(0.8, 0.5, 0.8), radius=0.5)
+
+    b = builder.add_body(origin=wp.transform((0.0, 0.5, 2.0), wp.quat_identity()))
+    builder.add_shape_box(body=b, hx=0.2, hy=0.2, hz=0.2)
+
+    model = builder.finalize(device=device)
+    model.ground = True
+    return model
+
+
+def simulate(model, deterministic, steps=20):
+    integrator = wp.sim.SemiImplicitIntegrator(deterministic=deterministic)
+    state_0 = model.state()
+    state_1 = model.state()
+    for _ in range(steps):
+        wp.sim.collide(model, state_0, deterministic=deterministic)
+        state_0.clear_forces()
+        integrator.simulate(model, state_0, state_1, 1.0 / 1000.0)
+        state_0, state_1 = state_1, state_0
+    return state_0.particle_q.numpy(), state_0.body_q.numpy()
+
+
+def test_deterministic_sim(test, device):
+    particle_q = None
+    body_q = None
+    for _ in range(3):
+        # a new model each time so that nothing carries over between the runs
+        model = build_cloth_model(device)
+        q, b = simulate(model, deterministic=True)
+        if particle_q is None:
+            particle_q, body_q = q, b
+        else:
+            test.assertTrue(np.array_equal(q, particle_q))
+            test.assertTrue(np.array_equal(b, body_q))
+
+    # the deterministic mode sums the same forces as the atomics
+    q, b = simulate(build_cloth_model(device), deterministic=False)
+    assert_np_equal(q, particle_q, tol=1.0e-3)
+    assert_np_equal(b, body_q, tol=1.0e-3)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestDeterministic(parent):
+        pass
+
+    add_function_test(TestDeterministic, "test_deterministic_scatter", test_deterministic_scatter, devices=devices)
+    add_function_test(TestDeterministic, "test_deterministic_sim", test_deterministic_sim, devices=devices)
+
+    return TestDeterministic
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
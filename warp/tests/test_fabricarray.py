@@ -271,6 +271,36 @@ def test_fabricarray_kernel(test, device):
     wp.synchronize_device(device)
 
 
+@wp.kernel
+def fa_gather_kernel(a: wp.fabricarray(dtype=float), b: wp.array(dtype=float)):
+    i = wp.tid()
+    b[i] = a[i]
+
+
+def test_fabricarray_buckets(test, device):
+    # skewed and empty buckets exercise the page lookup table
+    bucket_sizes = [1, 0, 200, 3, 0, 1, 50, 1, 1, 43]
+    data = wp.array(data=np.arange(300, dtype=np.float32), device=device)
+    iface = _create_fabric_array_interface(data, "foo", bucket_sizes=bucket_sizes)
+    fa = wp.fabricarray(data=iface, attrib="foo")
+
+    test.assertIsNotNone(fa.ctype.bucket_table)
+
+    out = wp.zeros_like(data)
+    wp.launch(fa_gather_kernel, dim=fa.size, inputs=[fa, out], device=device)
+    assert_np_equal(out.numpy(), data.numpy())
+
+    # arrays with a single bucket skip the lookup
+    iface = _create_fabric_array_interface(data, "foo", bucket_sizes=[300])
+    fa = wp.fabricarray(data=iface, attrib="foo")
+
+    test.assertIsNone(fa.ctype.bucket_table)
+
+    out = wp.zeros_like(data)
+    wp.launch(fa_gather_kernel, dim=fa.size, inputs=[fa, out], device=device)
+    assert_np_equal(out.numpy(), data.numpy())
+
+
 @wp.kernel
 def fa_generic_dtype_kernel(a: wp.fabricarray(dtype=Any), b: wp.fabricarray(dtype=Any)):
     i = wp.tid()
@@ -935,6 +965,7 @@ def register(parent):
 
     # fabric arrays
     add_function_test(TestFabricArray, "test_fabricarray_kernel", test_fabricarray_kernel, devices=devices)
+    add_function_test(TestFabricArray, "test_fabricarray_buckets", test_fabricarray_buckets, devices=devices)
     add_function_test(TestFabricArray, "test_fabricarray_empty", test_fabricarray_empty, devices=devices)
     add_function_test(
         TestFabricArray, "test_fabricarray_generic_dtype", test_fabricarray_generic_dtype, devices=devices
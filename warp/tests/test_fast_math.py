@@ -34,6 +34,44 @@ def test_fast_math(test, device):
                 wp.launch(test_pow, dim=1, inputs=[-2.0, 2.0, 2.0], device=device)
 
 
+@wp.kernel
+def approx_math(x: wp.array(dtype=float), out: wp.array2d(dtype=float)):
+    i = wp.tid()
+    out[i, 0] = wp.sin_approx(x[i])
+    out[i, 1] = wp.cos_approx(x[i])
+    out[i, 2] = wp.exp_approx(x[i])
+    out[i, 3] = wp.rsqrt(wp.abs(x[i]) + 1.0)
+
+
+@wp.kernel(fast_math=True)
+def approx_sin_exp(x: wp.array(dtype=float), out: wp.array(dtype=float)):
+    i = wp.tid()
+    out[i] = wp.sin(x[i]) * wp.exp(x[i])
+
+
+def test_approx_math(test, device):
+    x_np = np.linspace(-20.0, 20.0, 401, dtype=np.float32)
+    x = wp.array(x_np, dtype=float, device=device, requires_grad=True)
+    out = wp.zeros((len(x_np), 4), dtype=float, device=device)
+    wp.launch(approx_math, dim=len(x_np), inputs=[x, out], device=device)
+
+    expected = np.stack((np.sin(x_np), np.cos(x_np), np.exp(x_np), 1.0 / np.sqrt(np.abs(x_np) + 1.0)), axis=1)
+    assert_np_equal(out.numpy()[:, :2], expected[:, :2], tol=1.0e-5)
+    assert_np_equal(out.numpy()[:, 2] / expected[:, 2], np.ones(len(x_np)), tol=1.0e-5)
+    assert_np_equal(out.numpy()[:, 3], expected[:, 3], tol=1.0e-5)
+
+    # kernels compiled with fast_math evaluate the approximations instead, including their gradients
+    out = wp.zeros(len(x_np), dtype=float, device=device, requires_grad=True)
+    tape = wp.Tape()
+    with tape:
+        wp.launch(approx_sin_exp, dim=len(x_np), inputs=[x, out], device=device)
+    tape.backward(grads={out: wp.array(np.ones(len(x_np)), dtype=float, device=device)})
+
+    test.assertTrue(any("wp::sin_approx(" in s for s in approx_sin_exp.adj.blocks[0].body_forward))
+    assert_np_equal(out.numpy() / expected[:, 2], np.sin(x_np), tol=1.0e-5)
+    assert_np_equal(x.grad.numpy() / expected[:, 2], np.sin(x_np) + np.cos(x_np), tol=1.0e-5)
+
+
 def register(parent):
     class TestFastMath(parent):
         pass
@@ -41,6 +79,7 @@ def register(parent):
     devices = get_test_devices()
 
     add_function_test(TestFastMath, "test_fast_math", test_fast_math, devices=devices)
+    add_function_test(TestFastMath, "test_approx_math", test_approx_math, devices=devices)
 
     return TestFastMath
 
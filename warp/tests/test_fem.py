@@ -11,15 +11,17 @@ from warp.tests.test_base import *
 
 
 from warp.fem.types import *
-from warp.fem.geometry import Grid2D, Trimesh2D, Tetmesh
+from warp.fem.geometry import Grid2D, Grid3D, Trimesh2D, Tetmesh
 from warp.fem.geometry.closest_point import project_on_tri_at_origin, project_on_tet_at_origin
-from warp.fem.space import make_polynomial_space, SymmetricTensorMapper
-from warp.fem.field import make_test
-from warp.fem.domain import Cells
-from warp.fem.integrate import integrate
-from warp.fem.operator import integrand
-from warp.fem.quadrature import RegularQuadrature
+from warp.fem.space import make_polynomial_space, make_prolongation, make_space_partitions, SymmetricTensorMapper
+from warp.fem.space import make_side_connectivity
+from warp.fem.field import make_test, make_trial
+from warp.fem.domain import Cells, Sides
+from warp.fem.integrate import integrate, integrate_residual_and_jacobian, integrate_interior_penalty
+from warp.fem.operator import integrand, grad, normal, measure_ratio, jump, grad_average
+from warp.fem.quadrature import RegularQuadrature, CachedQuadrature, PicQuadrature
 from warp.fem.utils import unit_element
+from warp.sparse import bsr_mv
 
 wp.init()
 
@@ -63,6 +65,238 @@ def test_integrate_gradient(test_case, device):
         test_case.assertLess(err, 1.0e-8)
 
 
+@integrand
+def mass_form(s: Sample, u: Field, v: Field):
+    return u(s) * v(s)
+
+
+@integrand
+def diffusion_form(s: Sample, u: Field, v: Field, nu: float):
+    return nu * wp.dot(grad(u, s), grad(v, s)) + u(s) * v(s)
+
+
+def test_integrate_apply(test_case, device):
+    with wp.ScopedDevice(device):
+        geo = Grid2D(res=vec2i(4))
+        domain = Cells(geometry=geo)
+
+        scalar_space = make_polynomial_space(geo, degree=2)
+        test = make_test(space=scalar_space, domain=domain)
+        trial = make_trial(space=scalar_space, domain=domain)
+
+        x_np = np.random.default_rng(123).random(scalar_space.node_count())
+        x = wp.array(x_np, dtype=wp.float32)
+
+        for form, values, nodal in ((diffusion_form, {"nu": 0.5}, False), (mass_form, {}, True)):
+            matrix = integrate(form, fields={"u": trial, "v": test}, values=values, nodal=nodal)
+            expected = wp.zeros(scalar_space.node_count(), dtype=wp.float64)
+            bsr_mv(matrix, wp.array(x_np, dtype=wp.float64), expected)
+
+            # matrix-free application, allocating the result and then reusing it
+            y = integrate(form, fields={"u": trial, "v": test}, values=values, nodal=nodal, apply_to=x)
+            assert_np_equal(y.numpy(), expected.numpy(), tol=1.0e-5)
+
+            integrate(form, fields={"u": trial, "v": test}, values=values, nodal=nodal, apply_to=x, output=y)
+            assert_np_equal(y.numpy(), expected.numpy(), tol=1.0e-5)
+
+        with test_case.assertRaises(ValueError):
+            integrate(linear_form, fields={"u": test}, apply_to=x)
+
+
+@integrand
+def nonlinear_residual_form(s: Sample, u: Field, v: Field, nu: float):
+    return nu * wp.dot(grad(u, s), grad(v, s)) + u(s) * u(s) * u(s) * v(s)
+
+
+@integrand
+def nonlinear_jacobian_form(s: Sample, u: Field, du: Field, v: Field, nu: float):
+    return nu * wp.dot(grad(du, s), grad(v, s)) + 3.0 * u(s) * u(s) * du(s) * v(s)
+
+
+def test_integrate_residual_and_jacobian(test_case, device):
+    with wp.ScopedDevice(device):
+        geo = Grid2D(res=vec2i(4))
+        domain = Cells(geometry=geo)
+        quadrature = RegularQuadrature(domain=domain, order=4)
+
+        scalar_space = make_polynomial_space(geo, degree=2)
+        test = make_test(space=scalar_space, domain=domain)
+        trial = make_trial(space=scalar_space, domain=domain)
+
+        rng = np.random.default_rng(123)
+        u = scalar_space.make_field()
+        u.dof_values = wp.array(rng.random(scalar_space.node_count()), dtype=float)
+        values = {"nu": 0.5}
+
+        residual, jacobian = integrate_residual_and_jacobian(
+            nonlinear_residual_form,
+            nonlinear_jacobian_form,
+            quadrature=quadrature,
+            fields={"u": u, "du": trial, "v": test},
+            values=values,
+        )
+
+        # same results as separate passes
+        expected_residual = integrate(
+            nonlinear_residual_form, quadrature=quadrature, fields={"u": u, "v": test}, values=values
+        )
+        assert_np_equal(residual.numpy(), expected_residual.numpy(), tol=1.0e-8)
+
+        expected_jacobian = integrate(
+            nonlinear_jacobian_form, quadrature=quadrature, fields={"u": u, "du": trial, "v": test}, values=values
+        )
+        x = wp.array(rng.random(scalar_space.node_count()), dtype=wp.float64)
+        y = wp.zeros_like(x)
+        expected_y = wp.zeros_like(x)
+        bsr_mv(jacobian, x, y)
+        bsr_mv(expected_jacobian, x, expected_y)
+        assert_np_equal(y.numpy(), expected_y.numpy(), tol=1.0e-8)
+
+        with test_case.assertRaises(ValueError):
+            integrate_residual_and_jacobian(
+                nonlinear_jacobian_form,
+                nonlinear_jacobian_form,
+                quadrature=quadrature,
+                fields={"u": u, "du": trial, "v": test},
+                values=values,
+            )
+
+
+@integrand
+def sip_form(s: Sample, domain: Domain, u: Field, v: Field, penalty: float):
+    nor = normal(domain, s)
+    flux_u = wp.dot(grad_average(u, s), nor)
+    flux_v = wp.dot(grad_average(v, s), nor)
+    return penalty * measure_ratio(domain, s) * jump(u, s) * jump(v, s) - (flux_u * jump(v, s) + flux_v * jump(u, s))
+
+
+def test_integrate_interior_penalty(test_case, device):
+    with wp.ScopedDevice(device):
+        rng = np.random.default_rng(123)
+
+        positions, tri_vidx = _gen_trimesh(3)
+        geometries = (Grid2D(res=vec2i(3)), Trimesh2D(tri_vertex_indices=tri_vidx, positions=positions))
+
+        for geo, degree in ((g, d) for g in geometries for d in (1, 2)):
+            space = make_polynomial_space(geo, degree=degree, discontinuous=True)
+            quadrature = RegularQuadrature(domain=Sides(geo), order=2 * degree)
+            penalty = float(degree * degree)
+
+            matrix = integrate_interior_penalty(space, quadrature=quadrature)
+
+            # same operator as the generic side integration, which yields zero on boundary sides
+            test = make_test(space=space, domain=quadrature.domain)
+            trial = make_trial(space=space, domain=quadrature.domain)
+            expected = integrate(
+                sip_form, quadrature=quadrature, fields={"u": trial, "v": test}, values={"penalty": penalty}
+            )
+
+            x = wp.array(rng.random(space.node_count()), dtype=wp.float64)
+            y = wp.zeros_like(x)
+            expected_y = wp.zeros_like(x)
+            bsr_mv(matrix, x, y)
+            bsr_mv(expected, x, expected_y)
+            assert_np_equal(y.numpy(), expected_y.numpy(), tol=1.0e-8)
+
+            # the connectivity is shared with other spaces of the geometry
+            test_case.assertIs(
+                make_side_connectivity(make_polynomial_space(geo, degree=degree)), make_side_connectivity(space)
+            )
+
+        with test_case.assertRaises(ValueError):
+            integrate_interior_penalty(make_polynomial_space(geometries[0], dtype=wp.vec2))
+
+
+@integrand
+def grad_x_form(s: Sample, u: Field):
+    return grad(u, s)[0]
+
+
+def test_grid_factorized_eval(test_case, device):
+    with wp.ScopedDevice(device):
+        # polynomials of degree 3 along each axis, so exactly represented by cubic grid spaces
+        for geo, exact_value, exact_grad_x in (
+            (Grid2D(res=vec2i(3)), 5.0 / 12.0, 4.0 / 3.0),
+            (Grid3D(res=vec3i(2)), 1.0 / 3.0, 7.0 / 6.0),
+        ):
+            domain = Cells(geometry=geo)
+            quadrature = RegularQuadrature(domain=domain, order=6)
+
+            space = make_polynomial_space(geo, degree=3)
+            positions = [X.flatten() for X in space.node_positions()]
+            if geo.dimension == 2:
+                values = positions[0] ** 3 + positions[0] * positions[1] ** 2
+            else:
+                values = positions[0] ** 3 + positions[0] * positions[1] ** 2 * positions[2]
+
+            u = space.make_field()
+            u.dof_values = wp.array(values, dtype=float)
+
+            value = integrate(linear_form, quadrature=quadrature, fields={"u": u})
+            grad_x = integrate(grad_x_form, quadrature=quadrature, fields={"u": u})
+
+            test_case.assertAlmostEqual(value, exact_value, places=5)
+            test_case.assertAlmostEqual(grad_x, exact_grad_x, places=5)
+
+
+def test_prolongation(test_case, device):
+    with wp.ScopedDevice(device):
+        # polynomials of the space degree are interpolated exactly from the coarse to the fine grid
+        for coarse_geo, fine_geo, dtype in (
+            (Grid2D(res=vec2i(2)), Grid2D(res=vec2i(4)), float),
+            (Grid3D(res=vec3i(1)), Grid3D(res=vec3i(2)), wp.vec3),
+        ):
+            for degree in (1, 2):
+                coarse_space = make_polynomial_space(coarse_geo, degree=degree, dtype=dtype)
+                fine_space = make_polynomial_space(fine_geo, degree=degree, dtype=dtype)
+
+                P = make_prolongation(coarse_space, fine_space)
+                test_case.assertEqual(P.shape, (fine_space.node_count(), coarse_space.node_count()))
+
+                def poly(positions):
+                    x, y = positions[0].flatten(), positions[1].flatten()
+                    values = x**degree + 2.0 * y
+                    return values if dtype == float else np.stack((values, -values, 3.0 * values), axis=-1)
+
+                coarse_values = wp.array(poly(coarse_space.node_positions()), dtype=dtype)
+                fine_values = wp.zeros(fine_space.node_count(), dtype=dtype)
+                bsr_mv(P, coarse_values, fine_values)
+
+                assert_np_equal(fine_values.numpy(), poly(fine_space.node_positions()), tol=1.0e-5)
+
+
+def test_space_partition(test_case, device):
+    with wp.ScopedDevice(device):
+        geo = Grid2D(res=vec2i(4))
+        space = make_polynomial_space(geo, degree=1)
+
+        partitions = make_space_partitions(space, devices=[device, device])
+        test_case.assertEqual(len(partitions), 2)
+
+        covered_nodes = np.zeros(space.node_count(), dtype=int)
+        for partition in partitions:
+            # each half of the grid owns three node columns, the middle one being on the frontier
+            test_case.assertEqual(partition.node_count(), 15)
+            test_case.assertEqual(partition.owned_node_count(), 15)
+            test_case.assertEqual(partition.interior_node_count(), 10)
+
+            node_indices = partition.space_node_indices().numpy()
+            space_to_partition = partition.partition_arg_value(device).space_to_partition.numpy()
+
+            # nodes remain sorted within each category
+            interior_count = partition.interior_node_count()
+            test_case.assertTrue(np.all(np.diff(node_indices[:interior_count]) > 0))
+            test_case.assertTrue(np.all(np.diff(node_indices[interior_count:]) > 0))
+
+            assert_np_equal(space_to_partition[node_indices], np.arange(partition.node_count()))
+            test_case.assertEqual(np.count_nonzero(space_to_partition >= 0), partition.node_count())
+
+            covered_nodes[node_indices] += 1
+
+        assert_np_equal(np.unique(covered_nodes), np.array([1, 2]))
+        test_case.assertEqual(np.count_nonzero(covered_nodes == 2), 5)
+
+
 def _gen_trimesh(N):
     x = np.linspace(0.0, 1.0, N + 1)
     y = np.linspace(0.0, 1.0, N + 1)
@@ -200,6 +434,76 @@ def test_tet_mesh(test_case, device):
     test_case.assertEqual(geo.boundary_side_count(), 12 * N * N)
 
 
+@integrand
+def unit_form(s: Sample):
+    return 1.0
+
+
+def test_cached_quadrature(test_case, device):
+    N = 3
+
+    with wp.ScopedDevice(device):
+        positions, tet_vidx = _gen_tetmesh(N)
+
+        geo = Tetmesh(tet_vertex_indices=tet_vidx, positions=positions)
+        domain = Cells(geometry=geo)
+
+        quadrature = RegularQuadrature(domain=domain, order=2)
+        cached_quadrature = CachedQuadrature(quadrature)
+        test_case.assertEqual(cached_quadrature.measures.shape[0], quadrature.total_point_count())
+
+        space = make_polynomial_space(geo, degree=2)
+        test = make_test(space=space, domain=domain)
+        trial = make_trial(space=space, domain=domain)
+
+        rhs = integrate(linear_form, quadrature=quadrature, fields={"u": test})
+        cached_rhs = integrate(linear_form, quadrature=cached_quadrature, fields={"u": test})
+        assert_np_equal(cached_rhs.numpy(), rhs.numpy(), tol=1.0e-6)
+
+        matrix = integrate(mass_form, quadrature=quadrature, fields={"u": trial, "v": test})
+        cached_matrix = integrate(mass_form, quadrature=cached_quadrature, fields={"u": trial, "v": test})
+        assert_np_equal(cached_matrix.values.numpy(), matrix.values.numpy(), tol=1.0e-6)
+
+        test_case.assertAlmostEqual(integrate(unit_form, quadrature=cached_quadrature), 1.0, places=5)
+
+        # cached measures only reflect geometry modifications after an update
+        positions.assign(2.0 * positions.numpy())
+        test_case.assertAlmostEqual(integrate(unit_form, quadrature=cached_quadrature), 1.0, places=5)
+        cached_quadrature.update()
+        test_case.assertAlmostEqual(integrate(unit_form, quadrature=cached_quadrature), 8.0, places=4)
+
+
+def test_pic_quadrature(test_case, device):
+    particle_count = 100
+
+    with wp.ScopedDevice(device):
+        geo = Grid2D(res=vec2i(4))
+        domain = Cells(geometry=geo)
+
+        rng = np.random.default_rng(123)
+        positions = wp.array(rng.uniform(0.05, 0.95, size=(particle_count, 2)), dtype=wp.vec2)
+        measures = wp.full(particle_count, 1.0 / particle_count, dtype=float)
+
+        pic = PicQuadrature(domain=domain, positions=positions, measures=measures)
+        test_case.assertEqual(pic.arg_value(device).cell_particle_offsets.numpy()[-1], particle_count)
+        test_case.assertAlmostEqual(integrate(unit_form, quadrature=pic), 1.0, places=5)
+
+        # incremental update after a small displacement matches binning from scratch
+        positions.assign(positions.numpy() + rng.uniform(-0.05, 0.05, size=(particle_count, 2)))
+        pic.update()
+
+        expected = PicQuadrature(domain=domain, positions=positions, measures=measures)
+        assert_np_equal(
+            pic.arg_value(device).cell_particle_offsets.numpy(),
+            expected.arg_value(device).cell_particle_offsets.numpy(),
+        )
+        assert_np_equal(
+            pic.arg_value(device).particle_coords.numpy(),
+            expected.arg_value(device).particle_coords.numpy(),
+        )
+        test_case.assertAlmostEqual(integrate(unit_form, quadrature=pic), 1.0, places=5)
+
+
 @wp.kernel
 def _test_closest_point_on_tri_kernel(
     e0: wp.vec2,
@@ -349,6 +653,16 @@ def register(parent):
     add_function_test(TestFem, "test_regular_quadrature", test_regular_quadrature)
     add_function_test(TestFem, "test_closest_point_queries", test_closest_point_queries)
     add_function_test(TestFem, "test_integrate_gradient", test_integrate_gradient, devices=devices)
+    add_function_test(TestFem, "test_integrate_apply", test_integrate_apply, devices=devices)
+    add_function_test(
+        TestFem, "test_integrate_residual_and_jacobian", test_integrate_residual_and_jacobian, devices=devices
+    )
+    add_function_test(TestFem, "test_integrate_interior_penalty", test_integrate_interior_penalty, devices=devices)
+    add_function_test(TestFem, "test_grid_factorized_eval", test_grid_factorized_eval, devices=devices)
+    add_function_test(TestFem, "test_cached_quadrature", test_cached_quadrature, devices=devices)
+    add_function_test(TestFem, "test_pic_quadrature", test_pic_quadrature, devices=devices)
+    add_function_test(TestFem, "test_prolongation", test_prolongation, devices=devices)
+    add_function_test(TestFem, "test_space_partition", test_space_partition, devices=devices)
     add_function_test(TestFem, "test_triangle_mesh", test_triangle_mesh, devices=devices)
     add_function_test(TestFem, "test_tet_mesh", test_tet_mesh, devices=devices)
     add_function_test(TestFem, "test_dof_mapper", test_dof_mapper)
@@ -669,6 +669,129 @@ def test_custom_overload_grad(test, device):
     # fmt: on
 
 
+@wp.func
+def stored_energy(x: float):
+    return wp.sin(x) * x
+
+
+def stored_grad_body(x: wp.array(dtype=float), y: wp.array(dtype=float)):
+    tid = wp.tid()
+    a = x[tid]
+    e = stored_energy(a)
+    s = float(0.0)
+    for i in range(3):
+        s += stored_energy(a * float(i))
+    y[tid] = e * e + s
+
+
+# the same function registered as a kernel recomputing its intermediates in the backward pass and as one storing them
+module = wp.get_module(stored_grad_body.__module__)
+recompute_grad_kernel = wp.Kernel(func=stored_grad_body, key="recompute_grad_kernel", module=module)
+store_grad_kernel = wp.Kernel(
+    func=stored_grad_body, key="store_grad_kernel", module=module, options={"store_intermediates": True}
+)
+
+
+def test_store_intermediates_grad(test, device):
+    n = 16
+    x_np = np.linspace(-1.0, 1.0, n, dtype=np.float32)
+
+    grads = []
+    for kernel in (recompute_grad_kernel, store_grad_kernel):
+        x = wp.array(x_np, dtype=float, device=device, requires_grad=True)
+        y = wp.zeros(n, dtype=float, device=device, requires_grad=True)
+
+        tape = wp.Tape()
+        with tape:
+            wp.launch(kernel, dim=n, inputs=[x, y], device=device)
+        tape.backward(grads={y: wp.full(n, 1.0, dtype=float, device=device)})
+        grads.append(x.grad.numpy())
+
+        # the backward launch of the storing kernel reloads the calls of the forward launch
+        intermediates = tape.launches[0][5]
+        if kernel is store_grad_kernel:
+            test.assertEqual(kernel.adj.intermediates_size, 32)
+            test.assertEqual(intermediates.size, kernel.adj.intermediates_size * n)
+        else:
+            test.assertIsNone(intermediates)
+
+    e = np.sin(x_np) * x_np
+    de = np.cos(x_np) * x_np + np.sin(x_np)
+    expected = 2.0 * e * de + sum(i * (np.cos(i * x_np) * i * x_np + np.sin(i * x_np)) for i in range(3))
+
+    assert_np_equal(grads[0], expected, tol=1.0e-4)
+    assert_np_equal(grads[1], grads[0], tol=1.0e-6)
+
+    # launches outside of a tape don't store intermediates and their backward launches recompute them
+    x = wp.array(x_np, dtype=float, device=device, requires_grad=True)
+    y = wp.zeros(n, dtype=float, device=device, requires_grad=True)
+    wp.launch(store_grad_kernel, dim=n, inputs=[x, y], device=device)
+    wp.launch(
+        store_grad_kernel,
+        dim=n,
+        inputs=[x, y],
+        adj_inputs=[x.grad, wp.full(n, 1.0, dtype=float, device=device)],
+        device=device,
+        adjoint=True,
+    )
+    assert_np_equal(x.grad.numpy(), grads[0], tol=1.0e-6)
+
+
+@wp.func
+def jvp_scale(a: float, b: wp.vec3):
+    return a * wp.length(b)
+
+
+@wp.kernel(forward_mode_width=2)
+def jvp_kernel(x: wp.array(dtype=float), s: float, y: wp.array(dtype=wp.vec3), z: wp.array(dtype=float)):
+    tid = wp.tid()
+    v = x[tid]
+    y[tid] = wp.vec3(wp.sin(v), v * v * s, float(tid))
+    wp.atomic_add(z, 0, jvp_scale(v, y[tid]))
+
+
+def test_jvp(test, device):
+    n = 8
+    x_np = np.linspace(-1.0, 1.0, n, dtype=np.float32)
+    s = 2.0
+
+    # three directions are evaluated by two launches of two tangents: d/dx, d/ds and their sum
+    x_dot = np.array([np.ones(n), np.zeros(n), np.ones(n)], dtype=np.float32)
+    s_dot = [0.0, 1.0, 1.0]
+
+    x = wp.array(x_np, dtype=float, device=device)
+    y = wp.zeros(n, dtype=wp.vec3, device=device)
+    z = wp.zeros(1, dtype=float, device=device)
+    tangents = wp.jvp(
+        jvp_kernel,
+        dim=n,
+        inputs=[x, s],
+        outputs=[y, z],
+        tangents={"x": wp.array(x_dot, dtype=float, device=device), "s": s_dot},
+        device=device,
+    )
+
+    y_np = np.stack([np.sin(x_np), x_np * x_np * s, np.arange(n)], axis=1)
+    assert_np_equal(y.numpy(), y_np, tol=1.0e-6)
+    assert_np_equal(z.numpy(), [np.sum(x_np * np.linalg.norm(y_np, axis=1))], tol=1.0e-4)
+
+    test.assertEqual(tangents["y"].shape, (3, n))
+    test.assertEqual(tangents["z"].shape, (3, 1))
+
+    for k in range(3):
+        y_dot = np.stack(
+            [np.cos(x_np) * x_dot[k], 2.0 * x_np * s * x_dot[k] + x_np * x_np * s_dot[k], np.zeros(n)], axis=1
+        )
+        norm = np.linalg.norm(y_np, axis=1)
+        z_dot = np.sum(x_dot[k] * norm + x_np * np.sum(y_np * y_dot, axis=1) / norm)
+        assert_np_equal(tangents["y"].numpy()[k], y_dot, tol=1.0e-5)
+        assert_np_equal(tangents["z"].numpy()[k], [z_dot], tol=1.0e-3)
+
+    # kernels that can't be evaluated on dual numbers report why
+    with test.assertRaisesRegex(RuntimeError, "stores intermediates"):
+        wp.jvp(store_grad_kernel, dim=n, inputs=[x, z], tangents={"s": [1.0]}, device=device)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -689,6 +812,8 @@ def register(parent):
     add_function_test(TestGrad, "test_mesh_grad", test_mesh_grad, devices=devices)
     add_function_test(TestGrad, "test_custom_replay_grad", test_custom_replay_grad, devices=devices)
     add_function_test(TestGrad, "test_custom_overload_grad", test_custom_overload_grad, devices=devices)
+    add_function_test(TestGrad, "test_store_intermediates_grad", test_store_intermediates_grad, devices=devices)
+    add_function_test(TestGrad, "test_jvp", test_jvp, devices=devices)
 
     return TestGrad
 
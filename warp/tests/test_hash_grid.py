@@ -131,6 +131,326 @@ def test_hashgrid_query(test, device):
         test.assertTrue(np.array_equal(counts, counts_ref))
 
 
+def test_hashgrid_reorder(test, device):
+    points = np.random.rand(num_points, 3) * scale - np.array((scale, scale, scale)) * 0.5
+    ids = np.arange(num_points, dtype=np.int32)
+
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+    ids_arr = wp.array(ids, dtype=int, device=device)
+
+    grid = wp.HashGrid(dim_x, dim_y, dim_z, device)
+    grid.build(points_arr, cell_radius)
+
+    counts_before = wp.zeros(num_points, dtype=int, device=device)
+    wp.launch(count_neighbors, dim=num_points, inputs=[grid.id, query_radius, points_arr, counts_before], device=device)
+
+    # the permutation must be a valid reordering of the points
+    perm = grid.get_point_ids().numpy()
+    assert_np_equal(np.sort(perm), ids)
+
+    grid.reorder([points_arr, ids_arr])
+
+    assert_np_equal(points_arr.numpy(), points[perm].astype(np.float32))
+    assert_np_equal(ids_arr.numpy(), perm)
+
+    # queries now return indices into the reordered arrays
+    assert_np_equal(grid.get_point_ids().numpy(), ids)
+
+    counts_after = wp.zeros(num_points, dtype=int, device=device)
+    wp.launch(count_neighbors, dim=num_points, inputs=[grid.id, query_radius, points_arr, counts_after], device=device)
+
+    assert_np_equal(counts_after.numpy(), counts_before.numpy()[perm])
+
+
+def test_hashgrid_graph_capture(test, device):
+    points = np.random.rand(num_points, 3) * scale - np.array((scale, scale, scale)) * 0.5
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+    # reserving capacity up front means the rebuild never allocates
+    grid = wp.HashGrid(dim_x, dim_y, dim_z, device, max_points=num_points)
+
+    counts_ref = wp.zeros(num_points, dtype=int, device=device)
+    grid.build(points_arr, cell_radius)
+    wp.launch(count_neighbors, dim=num_points, inputs=[grid.id, query_radius, points_arr, counts_ref], device=device)
+
+    counts = wp.zeros(num_points, dtype=int, device=device)
+
+    wp.capture_begin(device)
+    try:
+        grid.build(points_arr, cell_radius)
+        wp.launch(count_neighbors, dim=num_points, inputs=[grid.id, query_radius, points_arr, counts], device=device)
+    finally:
+        graph = wp.capture_end(device)
+
+    wp.capture_launch(graph)
+
+    assert_np_equal(counts.numpy(), counts_ref.numpy())
+
+
+def test_hashgrid_morton(test, device):
+    points = np.random.rand(num_points, 3) * scale - np.array((scale, scale, scale)) * 0.5
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+    counts_ref = wp.zeros(num_points, dtype=int, device=device)
+    wp.launch(
+        kernel=count_neighbors_reference,
+        dim=num_points * num_points,
+        inputs=[query_radius, points_arr, counts_ref, num_points],
+        device=device,
+    )
+
+    # non power of two dimensions are rounded up for Morton ordering
+    for dims in [(dim_x, dim_y, dim_z), (24, 40, 7)]:
+        grid = wp.HashGrid(*dims, device, morton=True)
+        grid.build(points_arr, cell_radius)
+
+        counts = wp.zeros(num_points, dtype=int, device=device)
+        wp.launch(count_neighbors, dim=num_points, inputs=[grid.id, query_radius, points_arr, counts], device=device)
+        assert_np_equal(counts.numpy(), counts_ref.numpy())
+
+        grid.reorder([points_arr])
+        counts.zero_()
+        wp.launch(count_neighbors, dim=num_points, inputs=[grid.id, query_radius, points_arr, counts], device=device)
+        assert_np_equal(np.sort(counts.numpy()), np.sort(counts_ref.numpy()))
+
+        points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+
+@wp.kernel
+def count_candidates(grid: wp.uint64, radius: float, points: wp.array(dtype=wp.vec3), counts: wp.array(dtype=int)):
+    tid = wp.tid()
+
+    count = int(0)
+    for index in wp.hash_grid_query(grid, points[tid], radius):
+        count += 1
+
+    counts[tid] = count
+
+
+def test_sparse_hashgrid_query(test, device):
+    # clusters of points scattered over a domain much larger than the dense grid dimensions
+    centers = (np.random.rand(64, 3) - 0.5) * 1.0e4
+    points = (centers[:, None, :] + np.random.rand(64, 64, 3) * cell_radius * 4.0).reshape(-1, 3)
+
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+    counts_ref = wp.zeros(len(points), dtype=int, device=device)
+    wp.launch(
+        kernel=count_neighbors_reference,
+        dim=len(points) * len(points),
+        inputs=[query_radius, points_arr, counts_ref, len(points)],
+        device=device,
+    )
+
+    grid = wp.SparseHashGrid(device)
+    grid.build(points_arr, cell_radius)
+
+    counts = wp.zeros(len(points), dtype=int, device=device)
+    wp.launch(count_neighbors, dim=len(points), inputs=[grid.id, query_radius, points_arr, counts], device=device)
+    assert_np_equal(counts.numpy(), counts_ref.numpy())
+
+    # occupied cells never alias, so the sparse grid returns no more candidates than the dense one
+    dense = wp.HashGrid(dim_x, dim_y, dim_z, device)
+    dense.build(points_arr, cell_radius)
+
+    candidates = wp.zeros(len(points), dtype=int, device=device)
+    candidates_dense = wp.zeros(len(points), dtype=int, device=device)
+    wp.launch(count_candidates, dim=len(points), inputs=[grid.id, query_radius, points_arr, candidates], device=device)
+    wp.launch(
+        count_candidates, dim=len(points), inputs=[dense.id, query_radius, points_arr, candidates_dense], device=device
+    )
+    test.assertTrue(np.all(candidates.numpy() <= candidates_dense.numpy()))
+
+    # growing the point set rebuilds the cell table
+    points = np.concatenate([points, points + 1.0e3])
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+    grid.build(points_arr, cell_radius)
+
+    perm = grid.get_point_ids().numpy()
+    assert_np_equal(np.sort(perm), np.arange(len(points), dtype=np.int32))
+
+    counts = wp.zeros(len(points), dtype=int, device=device)
+    counts_ref = wp.zeros(len(points), dtype=int, device=device)
+    wp.launch(count_neighbors, dim=len(points), inputs=[grid.id, query_radius, points_arr, counts], device=device)
+    wp.launch(
+        kernel=count_neighbors_reference,
+        dim=len(points) * len(points),
+        inputs=[query_radius, points_arr, counts_ref, len(points)],
+        device=device,
+    )
+    assert_np_equal(counts.numpy(), counts_ref.numpy())
+
+
+@wp.kernel
+def count_contacts(
+    grid: wp.uint64,
+    points: wp.array(dtype=wp.vec3),
+    radii: wp.array(dtype=float),
+    counts: wp.array(dtype=int),
+    candidates: wp.array(dtype=int),
+):
+    tid = wp.tid()
+
+    p = points[tid]
+    r = radii[tid]
+    count = int(0)
+    num_candidates = int(0)
+
+    for index in wp.hash_grid_query(grid, p, r):
+        if wp.length(p - points[index]) <= r + radii[index]:
+            count += 1
+        num_candidates += 1
+
+    counts[tid] = count
+    candidates[tid] = num_candidates
+
+
+def test_multilevel_hashgrid_query(test, device):
+    # mostly small grains with a few boulders
+    rng = np.random.default_rng(123)
+    n = 4096
+    radii = np.where(rng.random(n) < 0.02, 4.0, 0.25).astype(np.float32)
+    radii *= rng.uniform(0.5, 1.0, size=n).astype(np.float32)
+    points = (rng.random((n, 3)) * 24.0).astype(np.float32)
+
+    d = np.linalg.norm(points[:, None, :] - points[None, :, :], axis=-1)
+    counts_ref = np.sum(d <= radii[:, None] + radii[None, :], axis=1).astype(np.int32)
+
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+    radii_arr = wp.array(radii, dtype=float, device=device)
+
+    grid = wp.MultiLevelHashGrid(0.125, 4.0, device)
+    test.assertEqual(grid.num_levels, 6)
+    grid.build(points_arr, radii_arr)
+
+    counts = wp.zeros(n, dtype=int, device=device)
+    candidates = wp.zeros(n, dtype=int, device=device)
+    wp.launch(count_contacts, dim=n, inputs=[grid.id, points_arr, radii_arr, counts, candidates], device=device)
+    assert_np_equal(counts.numpy(), counts_ref)
+
+    # a single level grid must be queried with the largest radius
+    single = wp.SparseHashGrid(device)
+    single.build(points_arr, 8.0)
+
+    query_arr = wp.array(radii + 4.0, dtype=float, device=device)
+    counts_single = wp.zeros(n, dtype=int, device=device)
+    candidates_single = wp.zeros(n, dtype=int, device=device)
+    wp.launch(
+        count_contacts,
+        dim=n,
+        inputs=[single.id, points_arr, query_arr, counts_single, candidates_single],
+        device=device,
+    )
+    test.assertLess(np.sum(candidates.numpy()), np.sum(candidates_single.numpy()) // 4)
+
+
+knn_k = 8
+
+
+@wp.kernel
+def query_knn(
+    grid: wp.uint64,
+    radius: float,
+    points: wp.array(dtype=wp.vec3),
+    counts: wp.array(dtype=int),
+    ids: wp.array(dtype=int, ndim=2),
+    dists: wp.array(dtype=float, ndim=2),
+):
+    tid = wp.tid()
+
+    heap = wp.topk_heap(k=knn_k)
+    count = wp.hash_grid_query_knn(grid, points, points[tid], radius, heap)
+    wp.topk_sort(heap)
+
+    # staged in a thread local array to exercise dynamic indexing
+    local_dists = wp.local_array(n=knn_k, dtype=float)
+    for i in range(count):
+        local_dists[i] = wp.topk_key(heap, i)
+        ids[tid, i] = wp.topk_value(heap, i)
+
+    for i in range(count):
+        dists[tid, i] = local_dists[i]
+
+    counts[tid] = count
+
+
+def test_hashgrid_knn(test, device):
+    points = np.random.rand(1024, 3) * scale * 0.5
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+    radius = query_radius * 2.0
+
+    for grid in [wp.HashGrid(dim_x, dim_y, dim_z, device), wp.SparseHashGrid(device)]:
+        grid.build(points_arr, cell_radius)
+
+        counts = wp.zeros(len(points), dtype=int, device=device)
+        ids = wp.full((len(points), knn_k), -1, dtype=int, device=device)
+        dists = wp.zeros((len(points), knn_k), dtype=float, device=device)
+        wp.launch(query_knn, dim=len(points), inputs=[grid.id, radius, points_arr, counts, ids, dists], device=device)
+
+        counts = counts.numpy()
+        ids = ids.numpy()
+        dists = dists.numpy()
+
+        d = np.linalg.norm(points[:, None, :] - points[None, :, :], axis=-1)
+        d_sorted = np.sort(d, axis=1)
+        counts_ref = np.minimum(np.sum(d <= radius, axis=1), knn_k)
+
+        assert_np_equal(counts, counts_ref)
+        for i in range(len(points)):
+            n = counts[i]
+            # the nearest point is the query point itself
+            test.assertEqual(ids[i, 0], i)
+            assert_np_equal(dists[i, :n], d_sorted[i, :n], tol=1.0e-4)
+            assert_np_equal(d[i, ids[i, :n]], d_sorted[i, :n], tol=1.0e-4)
+
+
+def test_knn_graph(test, device):
+    import warp.sparse
+
+    k = 6
+
+    # clustered points make the search radius grow for the isolated ones
+    points = np.concatenate([np.random.rand(400, 3), np.random.rand(8, 3) * 20.0 + 5.0])
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+    d = np.linalg.norm(points[:, None, :] - points[None, :, :], axis=-1)
+    np.fill_diagonal(d, np.inf)
+    d_sorted = np.sort(d, axis=1)
+
+    for grid in [None, wp.HashGrid(dim_x, dim_y, dim_z, device)]:
+        offsets, indices, distances = wp.knn_graph(points_arr, k, grid=grid)
+
+        assert_np_equal(offsets.numpy(), np.arange(len(points) + 1) * k)
+        indices = indices.numpy().reshape(-1, k)
+        distances = distances.numpy().reshape(-1, k)
+
+        assert_np_equal(distances, d_sorted[:, :k], tol=1.0e-4)
+        assert_np_equal(np.take_along_axis(d, indices, axis=1), d_sorted[:, :k], tol=1.0e-4)
+
+    # rows are short when there are less than k other points
+    offsets, indices, distances = wp.knn_graph(points_arr[:4], k)
+    assert_np_equal(offsets.numpy(), np.arange(5) * 3)
+    for i in range(4):
+        test.assertEqual(sorted(indices.numpy()[3 * i : 3 * i + 3]), [j for j in range(4) if j != i])
+
+    # the graph fills sparse matrices
+    offsets, indices, distances = wp.knn_graph(points_arr, k)
+    A = warp.sparse.bsr_zeros(len(points), len(points), block_type=wp.float32, device=device)
+    warp.sparse.bsr_set_from_csr(A, offsets, indices, distances)
+
+    A_dense = np.zeros((len(points), len(points)))
+    rows = np.repeat(np.arange(len(points)), k)
+    A_dense[rows, indices.numpy()] = distances.numpy()
+
+    A_offsets = A.offsets.numpy()
+    A_columns = A.columns.numpy()
+    A_values = A.values.numpy()
+    test.assertEqual(A.nnz, len(points) * k)
+    for i in range(len(points)):
+        row = slice(A_offsets[i], A_offsets[i + 1])
+        assert_np_equal(A_values[row], A_dense[i, A_columns[row]], tol=1.0e-6)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -138,6 +458,18 @@ def register(parent):
         pass
 
     add_function_test(TestHashGrid, "test_hashgrid_query", test_hashgrid_query, devices=devices)
+    add_function_test(TestHashGrid, "test_hashgrid_reorder", test_hashgrid_reorder, devices=devices)
+    add_function_test(TestHashGrid, "test_hashgrid_morton", test_hashgrid_morton, devices=devices)
+    add_function_test(TestHashGrid, "test_sparse_hashgrid_query", test_sparse_hashgrid_query, devices=devices)
+    add_function_test(TestHashGrid, "test_multilevel_hashgrid_query", test_multilevel_hashgrid_query, devices=devices)
+    add_function_test(TestHashGrid, "test_hashgrid_knn", test_hashgrid_knn, devices=devices)
+    add_function_test(TestHashGrid, "test_knn_graph", test_knn_graph, devices=devices)
+    add_function_test(
+        TestHashGrid,
+        "test_hashgrid_graph_capture",
+        test_hashgrid_graph_capture,
+        devices=[d for d in devices if d.is_cuda],
+    )
 
     return TestHashGrid
 
@@ -0,0 +1,180 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+@wp.kernel
+def warp_ops(
+    values: wp.array(dtype=float),
+    lanes: wp.array(dtype=int),
+    ballots: wp.array(dtype=wp.uint32),
+    sums: wp.array(dtype=float),
+    mins: wp.array(dtype=float),
+    maxs: wp.array(dtype=float),
+    shuffled: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    v = values[tid]
+
+    lanes[tid] = wp.lane_id()
+    ballots[tid] = wp.warp_ballot(v > 0.0)
+    sums[tid] = wp.warp_reduce_sum(v)
+    mins[tid] = wp.warp_reduce_min(v)
+    maxs[tid] = wp.warp_reduce_max(v)
+    shuffled[tid] = wp.warp_shuffle(v, 0)
+
+
+@wp.kernel
+def warp_sum_grad(values: wp.array(dtype=float), out: wp.array(dtype=float)):
+    tid = wp.tid()
+    out[tid] = wp.warp_reduce_sum(values[tid] * values[tid])
+
+
+@wp.kernel
+def atomic_counter(counter: wp.array(dtype=int), total: wp.array(dtype=float), old: wp.array(dtype=int)):
+    tid = wp.tid()
+    old[tid] = wp.atomic_add(counter, 0, 1)
+    wp.atomic_add(total, 0, float(tid))
+
+
+@wp.kernel
+def shared_params(
+    k: wp.array(dtype=float),
+    w: wp.array(dtype=wp.vec3),
+    index: int,
+    x: wp.array(dtype=float),
+    out: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    out[tid] = k[0] * x[tid] + wp.dot(w[index], wp.vec3(1.0, 2.0, 3.0))
+
+
+def warps_of(values, warp_size):
+    # splits the values of a launch into the warps executing it, the last one may be partial
+    return [values[i : i + warp_size] for i in range(0, len(values), warp_size)]
+
+
+def test_warp_ops(test, device):
+    # the last warp of the launch is partial on CUDA devices
+    n = 1000
+    warp_size = 32 if device.is_cuda else 1
+
+    rng = np.random.default_rng(123)
+    values_np = rng.uniform(-1.0, 1.0, size=n).astype(np.float32)
+
+    values = wp.array(values_np, dtype=float, device=device)
+    lanes = wp.zeros(n, dtype=int, device=device)
+    ballots = wp.zeros(n, dtype=wp.uint32, device=device)
+    sums = wp.zeros(n, dtype=float, device=device)
+    mins = wp.zeros(n, dtype=float, device=device)
+    maxs = wp.zeros(n, dtype=float, device=device)
+    shuffled = wp.zeros(n, dtype=float, device=device)
+
+    wp.launch(warp_ops, dim=n, inputs=[values, lanes, ballots, sums, mins, maxs, shuffled], device=device)
+
+    expected_lanes = np.arange(n) % warp_size
+    expected_ballots = []
+    expected_sums, expected_mins, expected_maxs, expected_shuffled = [], [], [], []
+    for w in warps_of(values_np, warp_size):
+        expected_ballots += [sum(1 << i for i, v in enumerate(w) if v > 0.0)] * len(w)
+        expected_sums += [w.sum()] * len(w)
+        expected_mins += [w.min()] * len(w)
+        expected_maxs += [w.max()] * len(w)
+        expected_shuffled += [w[0]] * len(w)
+
+    assert_np_equal(lanes.numpy(), expected_lanes)
+    assert_np_equal(ballots.numpy(), np.array(expected_ballots, dtype=np.uint32))
+    assert_np_equal(sums.numpy(), np.array(expected_sums), tol=1e-5)
+    assert_np_equal(mins.numpy(), np.array(expected_mins))
+    assert_np_equal(maxs.numpy(), np.array(expected_maxs))
+    assert_np_equal(shuffled.numpy(), np.array(expected_shuffled))
+
+
+def test_warp_reduce_grad(test, device):
+    n = 100
+    warp_size = 32 if device.is_cuda else 1
+
+    values_np = np.linspace(-1.0, 1.0, n, dtype=np.float32)
+    values = wp.array(values_np, dtype=float, device=device, requires_grad=True)
+    out = wp.zeros(n, dtype=float, device=device, requires_grad=True)
+
+    tape = wp.Tape()
+    with tape:
+        wp.launch(warp_sum_grad, dim=n, inputs=[values, out], device=device)
+    tape.backward(grads={out: wp.full(n, 1.0, dtype=float, device=device)})
+
+    # every lane of a warp receives the sum, so each value contributes once per lane
+    expected = np.concatenate([2.0 * w * len(w) for w in warps_of(values_np, warp_size)])
+    assert_np_equal(values.grad.numpy(), expected, tol=1e-5)
+
+
+def test_atomic_aggregate(test, device):
+    n = 1000
+
+    counter = wp.zeros(1, dtype=int, device=device)
+    total = wp.zeros(1, dtype=float, device=device)
+    old = wp.zeros(n, dtype=int, device=device)
+
+    wp.launch(atomic_counter, dim=n, inputs=[counter, total, old], device=device)
+
+    # aggregated atomics return the same set of values as per-thread atomics
+    test.assertEqual(counter.numpy()[0], n)
+    test.assertAlmostEqual(total.numpy()[0], n * (n - 1) / 2, delta=1.0)
+    assert_np_equal(np.sort(old.numpy()), np.arange(n))
+
+
+def test_shared_param_grad(test, device):
+    n = 1000
+
+    x_np = np.linspace(0.0, 1.0, n, dtype=np.float32)
+    k = wp.array([2.0], dtype=float, device=device, requires_grad=True)
+    w = wp.zeros(3, dtype=wp.vec3, device=device, requires_grad=True)
+    x = wp.array(x_np, dtype=float, device=device, requires_grad=True)
+    out = wp.zeros(n, dtype=float, device=device, requires_grad=True)
+
+    tape = wp.Tape()
+    with tape:
+        wp.launch(shared_params, dim=n, inputs=[k, w, 1, x, out], device=device)
+    tape.backward(grads={out: wp.full(n, 1.0, dtype=float, device=device)})
+
+    test.assertAlmostEqual(k.grad.numpy()[0], x_np.sum(), delta=1e-2)
+    assert_np_equal(w.grad.numpy(), np.array([[0.0, 0.0, 0.0], [n, 2.0 * n, 3.0 * n], [0.0, 0.0, 0.0]]))
+    assert_np_equal(x.grad.numpy(), np.full(n, 2.0))
+
+    # only the gradients of the loads at uniform indices are aggregated
+    module = wp.get_module(shared_params.__module__)
+    source = wp.context.ModuleBuilder(module, module.options).codegen("cpu")
+    test.assertIn("wp::adj_load_aggregate(var_k", source)
+    test.assertIn("wp::adj_load_aggregate(var_w", source)
+    test.assertIn("wp::adj_load(var_x", source)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestIntrinsics(parent):
+        pass
+
+    add_function_test(TestIntrinsics, "test_warp_ops", test_warp_ops, devices=devices)
+    add_function_test(TestIntrinsics, "test_warp_reduce_grad", test_warp_reduce_grad, devices=devices)
+    add_function_test(TestIntrinsics, "test_atomic_aggregate", test_atomic_aggregate, devices=devices)
+    add_function_test(TestIntrinsics, "test_shared_param_grad", test_shared_param_grad, devices=devices)
+
+    return TestIntrinsics
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -0,0 +1,97 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import os
+import unittest
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+wp.init()
+
+
+@wp.kernel
+def saxpy_kernel(x: wp.array(dtype=float), y: wp.array(dtype=float), z: wp.array(dtype=float)):
+    tid = wp.tid()
+    z[tid] = 2.0 * x[tid] + y[tid]
+
+
+@wp.kernel
+def split_kernel(v: wp.array2d(dtype=wp.vec3), lengths: wp.array2d(dtype=float), dirs: wp.array2d(dtype=wp.vec3)):
+    i, j = wp.tid()
+    lengths[i, j] = wp.length(v[i, j])
+    dirs[i, j] = wp.normalize(v[i, j])
+
+
+def test_jax_kernel(test, device):
+    import jax
+    import jax.numpy as jp
+
+    saxpy = wp.jax.jax_kernel(saxpy_kernel)
+    split = wp.jax.jax_kernel(split_kernel)
+
+    with jax.default_device(wp.device_to_jax(device)):
+        x = jp.arange(64, dtype=jp.float32)
+        y = jp.ones(64, dtype=jp.float32)
+
+        # the custom call composes with other XLA operations inside jit
+        @jax.jit
+        def f(x, y):
+            return saxpy(x * 0.5, y) + 1.0
+
+        assert_np_equal(np.asarray(f(x, y)), np.arange(64) + 2.0)
+
+        v = jp.asarray(np.random.default_rng(123).uniform(1.0, 2.0, size=(4, 5, 3)), dtype=jp.float32)
+        lengths, dirs = split(v)
+        test.assertEqual(lengths.shape, (4, 5))
+        test.assertEqual(dirs.shape, (4, 5, 3))
+
+        expected = np.linalg.norm(np.asarray(v), axis=-1)
+        assert_np_equal(np.asarray(lengths), expected, tol=1e-5)
+        assert_np_equal(np.asarray(dirs), np.asarray(v) / expected[..., None], tol=1e-5)
+
+        with test.assertRaises(RuntimeError):
+            saxpy(x.astype(jp.int32), y)
+
+
+def register(parent):
+    class TestJax(parent):
+        pass
+
+    try:
+        # prevent Jax from gobbling up GPU memory
+        os.environ["XLA_PYTHON_CLIENT_PREALLOCATE"] = "false"
+
+        import jax
+
+        # custom calls only run on CUDA devices, which may fail if Jax cannot find a CUDA Toolkit
+        jax_compatible_cuda_devices = []
+        for d in get_test_devices():
+            if not d.is_cuda:
+                continue
+            try:
+                with jax.default_device(wp.device_to_jax(d)):
+                    j = jax.numpy.arange(10, dtype=jax.numpy.float32)
+                    j += 1
+                jax_compatible_cuda_devices.append(d)
+            except Exception as e:
+                print(f"Skipping Jax tests on device '{d}' due to exception: {e}")
+
+        if jax_compatible_cuda_devices:
+            add_function_test(TestJax, "test_jax_kernel", test_jax_kernel, devices=jax_compatible_cuda_devices)
+
+    except Exception as e:
+        print(f"Skipping Jax tests due to exception: {e}")
+
+    return TestJax
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
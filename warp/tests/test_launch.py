@@ -329,6 +329,336 @@ def test_launch_large_kernel(test, device):
     test.assertEqual(test_result.numpy()[0], half_result)
 
 
+@wp.kernel(block_dim=64)
+def kernel_block_dim_64(a: wp.array(dtype=int)):
+    i = wp.tid()
+    a[i] = i
+
+
+@wp.kernel(block_dim="auto")
+def kernel_block_dim_auto(a: wp.array(dtype=int)):
+    i = wp.tid()
+    a[i] = i
+
+
+def test_launch_block_dim(test, device):
+    n = 1000
+
+    for kernel in (kernel_block_dim_64, kernel_block_dim_auto):
+        a = wp.zeros(n, dtype=int, device=device)
+        wp.launch(kernel, dim=n, inputs=[a], device=device)
+        assert_np_equal(a.numpy(), np.arange(n))
+
+
+def test_launch_command_list(test, device):
+    n = 10
+
+    values = wp.zeros(n, dtype=int, device=device)
+    out = wp.zeros(n, dtype=int, device=device)
+
+    cmds = wp.CommandList()
+    cmds.append(wp.launch(arange, dim=n, inputs=[values], device=device, record_cmd=True))
+    cmds.append(wp.launch(kernel_mul, dim=n, inputs=[values, 3], outputs=[out], device=device, record_cmd=True))
+    test.assertEqual(len(cmds), 2)
+
+    cmds.submit()
+    assert_np_equal(out.numpy(), 3 * np.arange(n))
+
+    # patch the recorded launches in place and submit them again
+    values.zero_()
+    cmds.launches[0].set_dim(5)
+    cmds.launches[1].set_param_by_name("coeff", 5)
+    cmds.submit()
+    assert_np_equal(out.numpy(), np.concatenate([5 * np.arange(5), np.zeros(5)]))
+
+    cpu_values = wp.zeros(n, dtype=int, device="cpu")
+    with test.assertRaises(RuntimeError):
+        cmds.append(wp.launch(arange, dim=n, inputs=[cpu_values], device="cpu", record_cmd=True))
+
+
+def test_launch_graph_update(test, device):
+    n = 10
+
+    values = wp.zeros(n, dtype=int, device=device)
+    out1 = wp.zeros(n, dtype=int, device=device)
+    out2 = wp.zeros(n, dtype=int, device=device)
+
+    wp.capture_begin(device)
+    wp.launch(arange, dim=n, inputs=[values], device=device)
+    wp.launch(kernel_mul, dim=n, inputs=[values, 3], outputs=[out1], device=device)
+    graph = wp.capture_end(device)
+
+    wp.capture_launch(graph)
+    assert_np_equal(out1.numpy(), 3 * np.arange(n))
+
+    # same topology with a new scalar, array and launch dim, patched in place
+    wp.capture_begin(device)
+    wp.launch(arange, dim=n, inputs=[values], device=device)
+    wp.launch(kernel_mul, dim=5, inputs=[values, 5], outputs=[out2], device=device)
+    test.assertIs(wp.capture_update(graph), graph)
+
+    wp.capture_launch(graph)
+    assert_np_equal(out1.numpy(), 3 * np.arange(n))
+    assert_np_equal(out2.numpy(), np.concatenate([5 * np.arange(5), np.zeros(5)]))
+
+    # a different topology falls back to re-instantiating the graph
+    wp.capture_begin(device)
+    wp.launch(kernel_mul, dim=n, inputs=[values, 2], outputs=[out1], device=device)
+    wp.capture_update(graph)
+
+    wp.capture_launch(graph)
+    assert_np_equal(out1.numpy(), 2 * np.arange(n))
+
+
+@wp.kernel
+def countdown(counter: wp.array(dtype=int), condition: wp.array(dtype=wp.int32), total: wp.array(dtype=int)):
+    counter[0] = counter[0] - 1
+    total[0] = total[0] + 1
+    condition[0] = wp.select(counter[0] > 0, 0, 1)
+
+
+@wp.kernel
+def add_value(a: wp.array(dtype=int), value: int):
+    a[0] = a[0] + value
+
+
+def test_launch_conditional(test, device):
+    counter = wp.array([4], dtype=int, device=device)
+    condition = wp.array([1], dtype=wp.int32, device=device)
+    total = wp.zeros(1, dtype=int, device=device)
+    branch = wp.zeros(1, dtype=int, device=device)
+
+    def body():
+        wp.launch(countdown, dim=1, inputs=[counter, condition, total], device=device)
+
+    def record():
+        wp.capture_if(
+            condition,
+            on_true=lambda: wp.launch(add_value, dim=1, inputs=[branch, 1], device=device),
+            on_false=lambda: wp.launch(add_value, dim=1, inputs=[branch, 10], device=device),
+        )
+        wp.capture_while(condition, body)
+
+    # evaluated on the host outside of a capture
+    record()
+    assert_np_equal(total.numpy(), np.array([4]))
+    assert_np_equal(branch.numpy(), np.array([1]))
+
+    if not device.is_cuda or not wp.is_conditional_graph_supported():
+        return
+
+    wp.capture_begin(device)
+    record()
+    graph = wp.capture_end(device)
+
+    # the true branch is taken and the loop runs until the counter reaches zero on the device
+    counter.assign([3])
+    condition.fill_(1)
+    wp.capture_launch(graph)
+    assert_np_equal(total.numpy(), np.array([7]))
+    assert_np_equal(branch.numpy(), np.array([2]))
+
+    # the false branch is taken and the loop body is skipped
+    counter.assign([5])
+    condition.fill_(0)
+    wp.capture_launch(graph)
+    assert_np_equal(total.numpy(), np.array([7]))
+    assert_np_equal(branch.numpy(), np.array([12]))
+
+
+def test_launch_async_load(test, device):
+    n = 10
+
+    future = wp.load_module(device=device, asynchronous=True)
+
+    # the launch waits for the background load instead of compiling the module again
+    values = wp.zeros(n, dtype=int, device=device)
+    wp.launch(arange, dim=n, inputs=[values], device=device)
+    assert_np_equal(values.numpy(), np.arange(n))
+
+    test.assertIsNone(future.result())
+
+
+def test_launch_module_bundle(test, device):
+    import os
+    import tempfile
+
+    n = 10
+    module = arange.module
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "kernels.wpb")
+        wp.save_module_bundle(path, modules=[module], device=device)
+
+        # loading the bundle skips code generation and compilation of the module
+        module.unload()
+        test.assertEqual(wp.load_module_bundle(path, device=device), [module])
+        test.assertIn(device.context, module.cuda_modules)
+
+    values = wp.zeros(n, dtype=int, device=device)
+    wp.launch(arange, dim=n, inputs=[values], device=device)
+    assert_np_equal(values.numpy(), np.arange(n))
+
+
+def test_launch_kernel_profiler(test, device):
+    n = 1024
+
+    values = wp.zeros(n, dtype=int, device=device)
+    out = wp.zeros(n, dtype=int, device=device)
+
+    results = {}
+    with wp.ScopedKernelProfiler(print=False, dict=results) as profiler:
+        for _ in range(3):
+            wp.launch(arange, dim=n, inputs=[values], device=device)
+        wp.launch(kernel_mul, dim=n, inputs=[values, 2], outputs=[out], device=device)
+
+    test.assertIsNone(wp.context.runtime.kernel_profiler)
+    test.assertEqual(set(results.keys()), {arange.key, kernel_mul.key})
+    test.assertEqual(results[arange.key].count, 3)
+    test.assertEqual(results[arange.key].dims, [n] * 3)
+    test.assertEqual(results[kernel_mul.key].bytes, 2 * n * 4)
+    test.assertGreaterEqual(results[kernel_mul.key].p99, 0.0)
+    test.assertIs(profiler.results[arange.key], results[arange.key])
+
+
+@wp.kernel
+def count_even(values: wp.array(dtype=int), count: wp.array(dtype=int)):
+    tid = wp.tid()
+
+    if values[tid] % 2 == 0:
+        wp.atomic_add(count, 0, 1)
+
+
+def test_launch_indirect(test, device):
+    n = 64
+
+    values = wp.full(n, -1, dtype=int, device=device)
+    count = wp.array([20], dtype=int, device=device)
+
+    # the count is read on the device, threads past it do nothing
+    wp.launch(arange, dim=count, max_dim=n, inputs=[values], device=device)
+    assert_np_equal(values.numpy(), np.concatenate([np.arange(20), np.full(n - 20, -1)]))
+
+    # counts larger than max_dim are clamped
+    count.fill_(1000)
+    wp.launch(arange, dim=count, max_dim=n, inputs=[values], device=device)
+    assert_np_equal(values.numpy(), np.arange(n))
+
+    # the dimension may be written by a previous kernel, and changed between launches of a recorded command
+    out = wp.zeros(n, dtype=int, device=device)
+    count.zero_()
+    wp.launch(count_even, dim=n, inputs=[values, count], device=device)
+
+    cmd = wp.launch(kernel_mul, dim=count, max_dim=n, inputs=[values, 2], outputs=[out], device=device, record_cmd=True)
+    cmd.launch()
+    assert_np_equal(out.numpy(), np.concatenate([2 * np.arange(n // 2), np.zeros(n // 2)]))
+
+    count.fill_(4)
+    cmd.launch()
+    assert_np_equal(out.numpy()[:4], 2 * np.arange(4))
+
+    with test.assertRaises(RuntimeError):
+        wp.launch(arange, dim=count, inputs=[values], device=device)
+
+    with test.assertRaises(RuntimeError):
+        wp.launch(arange, dim=wp.zeros(1, dtype=float, device=device), max_dim=n, inputs=[values], device=device)
+
+    if device.is_cuda:
+        # captured graphs read the count every time they are replayed
+        out.zero_()
+        wp.capture_begin(device)
+        count.zero_()
+        wp.launch(count_even, dim=n, inputs=[values, count], device=device)
+        wp.launch(kernel_mul, dim=count, max_dim=n, inputs=[values, 3], outputs=[out], device=device)
+        graph = wp.capture_end(device)
+
+        values.fill_(1)
+        wp.launch(arange, dim=n // 4, inputs=[values], device=device)
+        wp.capture_launch(graph)
+
+        expected = np.zeros(n, dtype=int)
+        expected[: n // 8] = 3 * np.arange(n // 8)
+        assert_np_equal(out.numpy(), expected)
+
+
+def test_launch_cpu_pch_header(test, device):
+    if not wp.config.enable_cpu_pch:
+        return
+
+    # modules sharing their preamble share the precompiled header, other options get their own
+    src = b'#define WP_NO_CRT\n#include "builtin.h"\n'
+    header = wp.build.get_cpu_pch_header(src + b"int a;\n", "release")
+    test.assertEqual(header, wp.build.get_cpu_pch_header(src + b"int b;\n", "release"))
+    test.assertNotEqual(header, wp.build.get_cpu_pch_header(src, "debug"))
+    test.assertNotEqual(header, wp.build.get_cpu_pch_header(b"#define BVH_QUERY_STACKLESS 1\n" + src, "release"))
+
+    with open(header, "rb") as f:
+        test.assertEqual(f.read(), src)
+
+
+def test_launch_kernel_cache_shared(test, device):
+    import os
+    import tempfile
+
+    saved = (wp.build.kernel_bin_dir, wp.build.kernel_gen_dir, wp.config.kernel_cache_shared_dir)
+    saved_max_size = wp.config.kernel_cache_max_size
+
+    files = {"wp_m.o": b"object", "wp_m.cpu.hash": b"hash", "wp_m.meta": b"{}"}
+
+    with tempfile.TemporaryDirectory() as local_dir, tempfile.TemporaryDirectory() as shared_dir:
+        os.makedirs(os.path.join(shared_dir, "bin"))
+        for name, data in files.items():
+            with open(os.path.join(shared_dir, "bin", name), "wb") as f:
+                f.write(data)
+
+        wp.build.kernel_bin_dir = local_dir
+        wp.build.kernel_gen_dir = None
+        wp.config.kernel_cache_shared_dir = shared_dir
+
+        try:
+            obj_path, hash_path, meta_path = (os.path.join(local_dir, name) for name in files)
+
+            # entries are only copied for a matching hash
+            test.assertFalse(wp.build.fetch_shared_cache_entry(obj_path, hash_path, b"other", meta_path))
+            test.assertFalse(os.path.exists(obj_path))
+
+            test.assertTrue(wp.build.fetch_shared_cache_entry(obj_path, hash_path, b"hash", meta_path))
+            for name, data in files.items():
+                with open(os.path.join(local_dir, name), "rb") as f:
+                    test.assertEqual(f.read(), data)
+
+            # the least recently used files are evicted first
+            wp.config.kernel_cache_max_size = len(b"hash") + len(b"{}")
+            os.utime(obj_path, (0, 0))
+            wp.build.evict_kernel_cache()
+            test.assertEqual(sorted(os.listdir(local_dir)), ["wp_m.cpu.hash", "wp_m.meta"])
+
+            wp.config.kernel_cache_max_size = 1
+            wp.build.evict_kernel_cache(keep=(meta_path,))
+            test.assertEqual(os.listdir(local_dir), ["wp_m.meta"])
+        finally:
+            wp.build.kernel_bin_dir, wp.build.kernel_gen_dir, wp.config.kernel_cache_shared_dir = saved
+            wp.config.kernel_cache_max_size = saved_max_size
+
+
+def test_launch_dim_limits(test, device):
+    # launch and array dimensions are 32-bit, larger extents must fail rather than wrap around
+    bounds = wp.types.launch_bounds_t((2**16, 2**16, 4))
+    test.assertEqual(bounds.size, 2**34)
+
+    with test.assertRaises(RuntimeError):
+        wp.types.launch_bounds_t(2**31)
+
+    with test.assertRaises(RuntimeError):
+        wp.types.launch_bounds_t((2, 2**31))
+
+    with test.assertRaises(RuntimeError):
+        wp.types.array_t(ndim=1, shape=(2**31,), strides=(4,))
+
+    with test.assertRaises(RuntimeError):
+        wp.types.array_t(ndim=2, shape=(4, 2**30), strides=(2**32, 4))
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -345,8 +675,20 @@ def register(parent):
     add_function_test(TestLaunch, "test_launch_cmd_set_ctype", test_launch_cmd_set_ctype, devices=devices)
     add_function_test(TestLaunch, "test_launch_cmd_set_dim", test_launch_cmd_set_dim, devices=devices)
     add_function_test(TestLaunch, "test_launch_cmd_empty", test_launch_cmd_empty, devices=devices)
+    add_function_test(TestLaunch, "test_launch_command_list", test_launch_command_list, devices=wp.get_cuda_devices())
+    add_function_test(TestLaunch, "test_launch_graph_update", test_launch_graph_update, devices=wp.get_cuda_devices())
+    add_function_test(TestLaunch, "test_launch_conditional", test_launch_conditional, devices=devices)
+    add_function_test(TestLaunch, "test_launch_async_load", test_launch_async_load, devices=devices)
+    add_function_test(TestLaunch, "test_launch_module_bundle", test_launch_module_bundle, devices=wp.get_cuda_devices())
+    add_function_test(TestLaunch, "test_launch_kernel_profiler", test_launch_kernel_profiler, devices=wp.get_cuda_devices())
+
+    add_function_test(TestLaunch, "test_launch_block_dim", test_launch_block_dim, devices=devices)
 
     add_function_test(TestLaunch, "test_launch_large_kernel", test_launch_large_kernel, devices=wp.get_cuda_devices())
+    add_function_test(TestLaunch, "test_launch_indirect", test_launch_indirect, devices=devices)
+    add_function_test(TestLaunch, "test_launch_cpu_pch_header", test_launch_cpu_pch_header)
+    add_function_test(TestLaunch, "test_launch_kernel_cache_shared", test_launch_kernel_cache_shared)
+    add_function_test(TestLaunch, "test_launch_dim_limits", test_launch_dim_limits)
 
     return TestLaunch
 
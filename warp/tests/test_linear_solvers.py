@@ -0,0 +1,293 @@
+import numpy as np
+import warp as wp
+
+from warp.sparse import bsr_zeros, bsr_set_from_triplets
+from warp.optim.linear import preconditioner, multigrid_preconditioner, amg_preconditioner, ilu_preconditioner
+from warp.optim.linear import cg, cr, bicgstab
+from warp.tests.test_base import *
+
+wp.init()
+
+
+def _make_spd_system(block_size, dtype, rows_of_blocks, device, seed=123):
+    rng = np.random.default_rng(seed)
+
+    n = rows_of_blocks * block_size
+    mat = rng.random((n, n)) * (rng.random((n, n)) < 0.1)
+    mat = mat + mat.T
+    mat += np.diag(np.sum(np.abs(mat), axis=1) + 1.0)
+
+    # gather non-zero blocks as triplets
+    blocks = mat.reshape(rows_of_blocks, block_size, rows_of_blocks, block_size).transpose(0, 2, 1, 3)
+    rows, cols = np.nonzero(np.any(blocks != 0.0, axis=(2, 3)))
+    values = blocks[rows, cols]
+
+    if block_size == 1:
+        block_type = dtype
+        values = values.reshape(-1)
+        vec_type = dtype
+    else:
+        block_type = wp.types.matrix(shape=(block_size, block_size), dtype=dtype)
+        vec_type = wp.types.vector(length=block_size, dtype=dtype)
+
+    A = bsr_zeros(rows_of_blocks, rows_of_blocks, block_type, device=device)
+    bsr_set_from_triplets(
+        A,
+        wp.array(rows.astype(np.int32), dtype=int, device=device),
+        wp.array(cols.astype(np.int32), dtype=int, device=device),
+        wp.array(values, dtype=block_type, device=device),
+    )
+
+    b_np = rng.random(n)
+    b = wp.array(b_np.reshape(rows_of_blocks, block_size) if block_size > 1 else b_np, dtype=vec_type, device=device)
+    x = wp.zeros_like(b)
+
+    return mat, b_np, A, b, x
+
+
+def make_test_solver(solver, block_size, dtype, ptype):
+    def test_solver(test, device):
+        mat, b_np, A, b, x = _make_spd_system(block_size, dtype, 64, device)
+
+        M = preconditioner(A, ptype)
+        tol = 1.0e-6 if dtype == wp.float64 else 1.0e-4
+
+        iterations, resid, atol = solver(A, b, x, tol=tol, maxiter=1000, M=M)
+
+        test.assertLessEqual(resid, atol)
+        test.assertLess(iterations, 1000)
+
+        x_np = x.numpy().reshape(-1)
+        ref = np.linalg.solve(mat, b_np)
+
+        assert_np_equal(x_np, ref, tol=100.0 * tol)
+
+    return test_solver
+
+
+def test_solver_no_sync(test, device):
+    mat, b_np, A, b, x = _make_spd_system(3, wp.float64, 32, device)
+
+    # fixed iteration count without host-side convergence checks
+    iterations, resid, atol = cg(A, b, x, tol=1.0e-8, maxiter=200, M=preconditioner(A, "block_diag"), check_every=0)
+
+    test.assertEqual(iterations, 200)
+    test.assertLessEqual(resid.numpy()[0], atol.numpy()[0])
+
+    ref = np.linalg.solve(mat, b_np)
+    assert_np_equal(x.numpy().reshape(-1), ref, tol=1.0e-6)
+
+
+def test_solver_callback(test, device):
+    mat, b_np, A, b, x = _make_spd_system(1, wp.float32, 64, device)
+
+    checks = []
+
+    def callback(i, resid, atol):
+        checks.append((i, resid))
+
+    iterations, resid, atol = cg(A, b, x, tol=1.0e-4, maxiter=1000, check_every=5, callback=callback)
+
+    test.assertGreater(len(checks), 0)
+    test.assertEqual(checks[-1][0], iterations)
+    test.assertTrue(all(check[0] % 5 == 0 for check in checks))
+
+
+def _make_csr(n_rows, n_cols, rows, cols, values, device):
+    A = bsr_zeros(n_rows, n_cols, wp.float64, device=device)
+    bsr_set_from_triplets(
+        A,
+        wp.array(np.asarray(rows, dtype=np.int32), dtype=int, device=device),
+        wp.array(np.asarray(cols, dtype=np.int32), dtype=int, device=device),
+        wp.array(np.asarray(values, dtype=np.float64), dtype=wp.float64, device=device),
+    )
+    return A
+
+
+def test_multigrid(test, device):
+    # 1D Poisson problem with Dirichlet boundary conditions, on levels of 2^k - 1 interior nodes
+    level_count = 6
+    n = 2**7 - 1
+
+    idx = np.arange(n)
+    A = _make_csr(
+        n,
+        n,
+        np.concatenate((idx, idx[1:], idx[:-1])),
+        np.concatenate((idx, idx[:-1], idx[1:])),
+        np.concatenate((np.full(n, 2.0), np.full(2 * n - 2, -1.0))),
+        device,
+    )
+
+    # linear interpolation from the coarse nodes, at odd fine indices, to their fine neighbours
+    prolongations = []
+    fine_n = n
+    for _ in range(level_count - 1):
+        coarse_n = (fine_n - 1) // 2
+        coarse = np.arange(coarse_n)
+        prolongations.append(
+            _make_csr(
+                fine_n,
+                coarse_n,
+                np.concatenate((2 * coarse + 1, 2 * coarse, 2 * coarse + 2)),
+                np.concatenate((coarse, coarse, coarse)),
+                np.concatenate((np.ones(coarse_n), np.full(2 * coarse_n, 0.5))),
+                device,
+            )
+        )
+        fine_n = coarse_n
+
+    b = wp.array(np.random.default_rng(123).random(n), dtype=wp.float64, device=device)
+
+    x = wp.zeros_like(b)
+    diag_iterations, _, _ = cg(A, b, x, tol=1.0e-8, maxiter=1000, M=preconditioner(A, "diag"), check_every=1)
+
+    x = wp.zeros_like(b)
+    M = multigrid_preconditioner(A, prolongations)
+    iterations, resid, atol = cg(A, b, x, tol=1.0e-8, maxiter=1000, M=M, check_every=1)
+
+    test.assertLessEqual(resid, atol)
+    test.assertLess(iterations, diag_iterations // 4)
+
+    mat = 2.0 * np.eye(n) - np.eye(n, k=1) - np.eye(n, k=-1)
+    ref = np.linalg.solve(mat, b.numpy())
+    assert_np_equal(x.numpy(), ref, tol=1.0e-3 * np.max(np.abs(ref)))
+
+
+def _make_poisson_system(res, device):
+    # 2D five-point Poisson problem with Dirichlet boundary conditions
+    n = res * res
+
+    idx = np.arange(n).reshape(res, res)
+    rows = [idx.flatten()]
+    cols = [idx.flatten()]
+    for fine, neighbor in (
+        (idx[1:, :], idx[:-1, :]),
+        (idx[:-1, :], idx[1:, :]),
+        (idx[:, 1:], idx[:, :-1]),
+        (idx[:, :-1], idx[:, 1:]),
+    ):
+        rows.append(fine.flatten())
+        cols.append(neighbor.flatten())
+
+    rows = np.concatenate(rows)
+    cols = np.concatenate(cols)
+    values = np.where(rows == cols, 4.0, -1.0)
+    A = _make_csr(n, n, rows, cols, values, device)
+
+    b = wp.array(np.random.default_rng(123).random(n), dtype=wp.float64, device=device)
+
+    mat = np.zeros((n, n))
+    np.add.at(mat, (rows, cols), values)
+
+    return mat, A, b
+
+
+def test_amg(test, device):
+    mat, A, b = _make_poisson_system(32, device)
+
+    x = wp.zeros_like(b)
+    diag_iterations, _, _ = cg(A, b, x, tol=1.0e-8, maxiter=1000, M=preconditioner(A, "diag"), check_every=1)
+
+    x = wp.zeros_like(b)
+    M = amg_preconditioner(A, coarse_size=32)
+    iterations, resid, atol = cg(A, b, x, tol=1.0e-8, maxiter=1000, M=M, check_every=1)
+
+    test.assertLessEqual(resid, atol)
+    test.assertLess(iterations, diag_iterations // 4)
+
+    ref = np.linalg.solve(mat, b.numpy())
+    assert_np_equal(x.numpy(), ref, tol=1.0e-3 * np.max(np.abs(ref)))
+
+
+def test_ilu(test, device):
+    mat, A, b = _make_poisson_system(32, device)
+
+    x = wp.zeros_like(b)
+    diag_iterations, _, _ = cg(A, b, x, tol=1.0e-8, maxiter=1000, M=preconditioner(A, "diag"), check_every=1)
+
+    # the factorization of a symmetric matrix is IC(0), which can precondition CG
+    x = wp.zeros_like(b)
+    M = ilu_preconditioner(A)
+    iterations, resid, atol = cg(A, b, x, tol=1.0e-8, maxiter=1000, M=M, check_every=1)
+
+    test.assertLessEqual(resid, atol)
+    test.assertLess(iterations, diag_iterations // 2)
+
+    ref = np.linalg.solve(mat, b.numpy())
+    assert_np_equal(x.numpy(), ref, tol=1.0e-3 * np.max(np.abs(ref)))
+
+    # a tridiagonal matrix has no fill-in, so that its ILU(0) factorization is exact
+    n = 64
+    rows = np.concatenate([np.arange(n), np.arange(1, n), np.arange(n - 1)])
+    cols = np.concatenate([np.arange(n), np.arange(n - 1), np.arange(1, n)])
+    values = np.concatenate([np.full(n, 3.0), np.full(n - 1, -1.0), np.full(n - 1, -0.5)])
+    A = _make_csr(n, n, rows, cols, values, device)
+    mat = np.zeros((n, n))
+    mat[rows, cols] = values
+
+    b = wp.array(np.random.default_rng(123).random(n), dtype=wp.float64, device=device)
+    z = wp.zeros_like(b)
+    ilu_preconditioner(A).matvec(b, z, 1.0, 0.0)
+    assert_np_equal(z.numpy(), np.linalg.solve(mat, b.numpy()), tol=1.0e-10)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestLinearSolvers(parent):
+        pass
+
+    add_function_test(TestLinearSolvers, "test_cg_csr", make_test_solver(cg, 1, wp.float32, "id"), devices=devices)
+    add_function_test(
+        TestLinearSolvers, "test_cg_csr_diag", make_test_solver(cg, 1, wp.float64, "diag"), devices=devices
+    )
+    add_function_test(
+        TestLinearSolvers, "test_cg_bsr_diag", make_test_solver(cg, 3, wp.float64, "diag"), devices=devices
+    )
+    add_function_test(
+        TestLinearSolvers,
+        "test_cg_bsr_block_diag",
+        make_test_solver(cg, 3, wp.float32, "block_diag"),
+        devices=devices,
+    )
+
+    add_function_test(
+        TestLinearSolvers,
+        "test_cg_bsr_block_diag_6",
+        make_test_solver(cg, 6, wp.float64, "block_diag"),
+        devices=devices,
+    )
+    add_function_test(TestLinearSolvers, "test_cg_bsr_ilu", make_test_solver(cg, 3, wp.float64, "ilu"), devices=devices)
+
+    add_function_test(TestLinearSolvers, "test_cr_csr", make_test_solver(cr, 1, wp.float64, "id"), devices=devices)
+    add_function_test(
+        TestLinearSolvers, "test_cr_bsr_block_diag", make_test_solver(cr, 3, wp.float64, "block_diag"), devices=devices
+    )
+
+    add_function_test(
+        TestLinearSolvers, "test_bicgstab_csr", make_test_solver(bicgstab, 1, wp.float64, "id"), devices=devices
+    )
+    add_function_test(
+        TestLinearSolvers,
+        "test_bicgstab_bsr_diag",
+        make_test_solver(bicgstab, 3, wp.float32, "diag"),
+        devices=devices,
+    )
+
+    add_function_test(
+        TestLinearSolvers, "test_bicgstab_bsr_ilu", make_test_solver(bicgstab, 2, wp.float32, "ilu"), devices=devices
+    )
+
+    add_function_test(TestLinearSolvers, "test_solver_no_sync", test_solver_no_sync, devices=devices)
+    add_function_test(TestLinearSolvers, "test_solver_callback", test_solver_callback, devices=devices)
+    add_function_test(TestLinearSolvers, "test_multigrid", test_multigrid, devices=devices)
+    add_function_test(TestLinearSolvers, "test_amg", test_amg, devices=devices)
+    add_function_test(TestLinearSolvers, "test_ilu", test_ilu, devices=devices)
+
+    return TestLinearSolvers
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
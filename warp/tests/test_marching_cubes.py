@@ -39,7 +39,7 @@ def test_marching_cubes(test, device):
 
     radius = dim / 4.0
 
-    wp.launch(make_field, dim=field.shape, inputs=[field, wp.vec3(dim / 2, dim / 2, dim / 2), radius], device="cuda")
+    wp.launch(make_field, dim=field.shape, inputs=[field, wp.vec3(dim / 2, dim / 2, dim / 2), radius], device=device)
 
     iso.surface(field=field, threshold=0.0)
 
@@ -50,13 +50,117 @@ def test_marching_cubes(test, device):
     test.assertTrue(np.max(error) < 1.0)
 
 
+@wp.kernel
+def make_batch_field(fields: wp.array4d(dtype=float), center: wp.vec3, radii: wp.array(dtype=float)):
+    b, i, j, k = wp.tid()
+
+    p = wp.vec3(float(i), float(j), float(k))
+
+    fields[b, i, j, k] = wp.length(p - center) - radii[b]
+
+
+def test_marching_cubes_batch(test, device):
+    dim = 32
+    num_fields = 4
+
+    radii_np = np.array([4.0, 6.0, 8.0, 10.0], dtype=np.float32)
+    radii = wp.array(radii_np, dtype=float, device=device)
+    center = wp.vec3(dim / 2, dim / 2, dim / 2)
+
+    fields = wp.zeros(shape=(num_fields, dim, dim, dim), dtype=float, device=device)
+    wp.launch(make_batch_field, dim=fields.shape, inputs=[fields, center, radii], device=device)
+
+    iso = wp.MarchingCubes(nx=dim, ny=dim, nz=dim, max_verts=10**5, max_tris=10**5, device=device)
+    iso.surface_batch(fields=fields, threshold=0.0)
+
+    vert_offsets = iso.vert_offsets.numpy()
+    tri_offsets = iso.tri_offsets.numpy()
+    verts = iso.verts.numpy()
+    indices = iso.indices.numpy()
+
+    test.assertEqual(vert_offsets[0], 0)
+    test.assertEqual(tri_offsets[0], 0)
+
+    # every field matches a single surface() call
+    single = wp.MarchingCubes(nx=dim, ny=dim, nz=dim, max_verts=10**5, max_tris=10**5, device=device)
+
+    for b in range(num_fields):
+        single.surface(field=wp.array(fields.numpy()[b], dtype=float, device=device), threshold=0.0)
+
+        field_verts = verts[vert_offsets[b] : vert_offsets[b + 1]]
+        field_indices = indices[3 * tri_offsets[b] : 3 * tri_offsets[b + 1]]
+
+        assert_np_equal(field_verts, single.verts.numpy())
+        assert_np_equal(field_indices, single.indices.numpy())
+
+        length = np.linalg.norm(field_verts - np.array([dim / 2, dim / 2, dim / 2]), axis=1)
+        test.assertTrue(np.max(np.abs(length - radii_np[b])) < 1.0)
+
+
+@wp.kernel
+def make_volume_field(volume: wp.uint64, tiles: wp.array2d(dtype=int), center: wp.vec3, radius: float):
+    t, i, j, k = wp.tid()
+
+    x = tiles[t, 0] + i
+    y = tiles[t, 1] + j
+    z = tiles[t, 2] + k
+
+    p = wp.volume_index_to_world(volume, wp.vec3(float(x), float(y), float(z)))
+    wp.volume_store_f(volume, x, y, z, wp.length(p - center) - radius)
+
+
+def test_marching_cubes_volume(test, device):
+    voxel_size = 0.5
+    radius = 8.0
+    center = np.array([1.0, -2.0, 3.0])
+
+    # narrow band of tiles around the sphere
+    lo = np.floor((center - radius - 2.0) / voxel_size).astype(int)
+    hi = np.ceil((center + radius + 2.0) / voxel_size).astype(int)
+    tile_coords = np.stack(
+        np.meshgrid(*[np.arange(a // 8, b // 8 + 1) * 8 for a, b in zip(lo, hi)], indexing="ij"), axis=-1
+    ).reshape(-1, 3)
+    tile_centers = (tile_coords + 4) * voxel_size
+    band = np.abs(np.linalg.norm(tile_centers - center, axis=1) - radius) < 8 * voxel_size
+    tile_points = wp.array(tile_coords[band], dtype=int, device=device)
+
+    volume = wp.Volume.allocate_by_tiles(tile_points, voxel_size=voxel_size, bg_value=1.0e3, device=device)
+
+    tiles = volume.get_tiles()
+    wp.launch(
+        make_volume_field,
+        dim=(tiles.shape[0], 8, 8, 8),
+        inputs=[volume.id, tiles, wp.vec3(center), radius],
+        device=device,
+    )
+
+    iso = wp.MarchingCubes(nx=0, ny=0, nz=0, max_verts=10**6, max_tris=10**6, device=device)
+    iso.surface_volume(volume=volume, threshold=0.0)
+
+    test.assertGreater(iso.verts.shape[0], 0)
+    test.assertGreater(iso.indices.shape[0], 0)
+
+    # vertices lie on the sphere and triangles reference valid vertices
+    verts = iso.verts.numpy()
+    error = np.abs(np.linalg.norm(verts - center, axis=1) - radius)
+    test.assertTrue(np.max(error) < voxel_size)
+
+    indices = iso.indices.numpy()
+    test.assertTrue(np.all(indices >= 0))
+    test.assertTrue(np.all(indices < verts.shape[0]))
+
+
 def register(parent):
-    devices = ["cuda"]
+    devices = get_test_devices()
 
     class TestMarchingCubes(parent):
         pass
 
     add_function_test(TestMarchingCubes, "test_marching_cubes", test_marching_cubes, devices=devices)
+    add_function_test(TestMarchingCubes, "test_marching_cubes_batch", test_marching_cubes_batch, devices=devices)
+    add_function_test(
+        TestMarchingCubes, "test_marching_cubes_volume", test_marching_cubes_volume, devices=wp.get_cuda_devices()
+    )
 
     return TestMarchingCubes
 
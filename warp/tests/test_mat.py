@@ -3398,6 +3398,207 @@ def test_eig(test, device, dtype, register_kernels=False):
                 assert_np_equal((plusval - minusval) / (2 * dx), m3grads[ii, jj], tol=fdtol)
 
 
+def test_polar(test, device, dtype, register_kernels=False):
+    np.random.seed(123)
+
+    tol = {
+        np.float16: 2.0e-2,
+        np.float32: 1.0e-5,
+        np.float64: 1.0e-5,
+    }.get(dtype, 0)
+
+    wptype = wp.types.np_dtype_to_warp_type[np.dtype(dtype)]
+    mat33 = wp.types.matrix(shape=(3, 3), dtype=wptype)
+
+    def check_mat_polar(
+        m3: wp.array(dtype=mat33),
+        Rout: wp.array(dtype=mat33),
+        Rsweeps: wp.array(dtype=mat33),
+        outcomponents: wp.array(dtype=wptype),
+    ):
+        R = wp.polar3(m3[0])
+
+        Rout[0] = R
+        Rsweeps[0] = wp.polar3(m3[0], 8)
+
+        # multiply outputs by 2 so we've got something to backpropagate:
+        idx = 0
+        for i in range(3):
+            for j in range(3):
+                outcomponents[idx] = wptype(2) * R[i, j]
+                idx = idx + 1
+
+    kernel = getkernel(check_mat_polar, suffix=dtype.__name__)
+    output_select_kernel = get_select_kernel(wptype)
+
+    if register_kernels:
+        return
+
+    m3_np = randvals([1, 3, 3], dtype) + np.eye(3, dtype=dtype)
+    m3 = wp.array(m3_np, dtype=mat33, requires_grad=True, device=device)
+
+    outcomponents = wp.zeros(3 * 3, dtype=wptype, requires_grad=True, device=device)
+    Rout = wp.zeros(1, dtype=mat33, requires_grad=True, device=device)
+    Rsweeps = wp.zeros(1, dtype=mat33, device=device)
+
+    wp.launch(kernel, dim=1, inputs=[m3], outputs=[Rout, Rsweeps, outcomponents], device=device)
+
+    Rout_np = Rout.numpy()[0].astype(np.float64)
+    m3_64 = m3_np[0].astype(np.float64)
+
+    # check R is a rotation:
+    assert_np_equal(np.matmul(Rout_np.T, Rout_np), np.eye(3), tol=tol)
+    test.assertGreater(np.linalg.det(Rout_np), 0.0)
+
+    # check S = R^T*A is symmetric:
+    S = np.matmul(Rout_np.T, m3_64)
+    assert_np_equal(S, S.T, tol=10 * tol)
+
+    # more sweeps converge to the same rotation:
+    assert_np_equal(Rsweeps.numpy()[0].astype(np.float64), Rout_np, tol=10 * tol)
+
+    if dtype == np.float16:
+        # I'm not even going to bother testing the gradients for float16
+        # because the rounding errors are terrible...
+        return
+
+    # check gradients:
+    out = wp.zeros(1, dtype=wptype, requires_grad=True, device=device)
+    for idx in range(len(outcomponents)):
+        tape = wp.Tape()
+        with tape:
+            wp.launch(kernel, dim=1, inputs=[m3], outputs=[Rout, Rsweeps, outcomponents], device=device)
+            wp.launch(output_select_kernel, dim=1, inputs=[outcomponents, idx], outputs=[out], device=device)
+        tape.backward(out)
+        m3grads = 1.0 * tape.gradients[m3].numpy()[0]
+
+        tape.zero()
+
+        dx = 0.0001
+        fdtol = 5.0e-4 if dtype == np.float64 else 2.0e-2
+        for ii in range(3):
+            for jj in range(3):
+                m3test = 1.0 * m3.numpy()
+                m3test[0, ii, jj] += dx
+                wp.launch(
+                    kernel,
+                    dim=1,
+                    inputs=[wp.array(m3test, dtype=mat33, device=device)],
+                    outputs=[Rout, Rsweeps, outcomponents],
+                    device=device,
+                )
+                wp.launch(output_select_kernel, dim=1, inputs=[outcomponents, idx], outputs=[out], device=device)
+                plusval = out.numpy()[0]
+
+                m3test = 1.0 * m3.numpy()
+                m3test[0, ii, jj] -= dx
+                wp.launch(
+                    kernel,
+                    dim=1,
+                    inputs=[wp.array(m3test, dtype=mat33, device=device)],
+                    outputs=[Rout, Rsweeps, outcomponents],
+                    device=device,
+                )
+                wp.launch(output_select_kernel, dim=1, inputs=[outcomponents, idx], outputs=[out], device=device)
+                minusval = out.numpy()[0]
+
+                assert_np_equal((plusval - minusval) / (2 * dx), m3grads[ii, jj], tol=fdtol)
+
+
+def test_factorizations(test, device, dtype, register_kernels=False):
+    np.random.seed(123)
+
+    tol = {
+        np.float16: 5.0e-2,
+        np.float32: 1.0e-4,
+        np.float64: 1.0e-8,
+    }.get(dtype, 0)
+
+    wptype = wp.types.np_dtype_to_warp_type[np.dtype(dtype)]
+    mat66 = wp.types.matrix(shape=(6, 6), dtype=wptype)
+    vec6 = wp.types.vector(length=6, dtype=wptype)
+
+    def check_mat_factorizations(
+        A: wp.array(dtype=mat66),
+        b: wp.array(dtype=vec6),
+        w: wp.array(dtype=vec6),
+        Lout: wp.array(dtype=mat66),
+        x_chol: wp.array(dtype=vec6),
+        x_ldlt: wp.array(dtype=vec6),
+        x_lu: wp.array(dtype=vec6),
+        f: wp.array(dtype=wptype),
+    ):
+        L = wp.cholesky(A[0])
+        Lout[0] = L
+        xc = wp.cholesky_solve(L, b[0])
+
+        Ld = mat66()
+        d = vec6()
+        wp.ldlt(A[0], Ld, d)
+        xd = wp.ldlt_solve(Ld, d, b[0])
+
+        xl = wp.solve(A[0], b[0])
+
+        x_chol[0] = xc
+        x_ldlt[0] = xd
+        x_lu[0] = xl
+
+        # scalar functions of each solution to backpropagate:
+        f[0] = wp.dot(w[0], xc)
+        f[1] = wp.dot(w[0], xd)
+        f[2] = wp.dot(w[0], xl)
+
+    kernel = getkernel(check_mat_factorizations, suffix=dtype.__name__)
+
+    if register_kernels:
+        return
+
+    # symmetric positive definite system
+    M = randvals([6, 6], np.float64)
+    A_np = (M @ M.T + 6.0 * np.eye(6)).astype(dtype)
+    b_np = randvals([6], dtype)
+    w_np = randvals([6], dtype)
+
+    A = wp.array([A_np], dtype=mat66, requires_grad=True, device=device)
+    b = wp.array([b_np], dtype=vec6, requires_grad=True, device=device)
+    w = wp.array([w_np], dtype=vec6, device=device)
+    Lout = wp.zeros(1, dtype=mat66, device=device)
+    x_chol = wp.zeros(1, dtype=vec6, requires_grad=True, device=device)
+    x_ldlt = wp.zeros(1, dtype=vec6, requires_grad=True, device=device)
+    x_lu = wp.zeros(1, dtype=vec6, requires_grad=True, device=device)
+    f = wp.zeros(3, dtype=wptype, requires_grad=True, device=device)
+
+    outputs = [Lout, x_chol, x_ldlt, x_lu, f]
+
+    A_64 = A_np.astype(np.float64)
+    x_ref = np.linalg.solve(A_64, b_np.astype(np.float64))
+
+    wp.launch(kernel, dim=1, inputs=[A, b, w], outputs=outputs, device=device)
+
+    assert_np_equal(Lout.numpy()[0].astype(np.float64), np.linalg.cholesky(A_64), tol=tol)
+    assert_np_equal(x_chol.numpy()[0].astype(np.float64), x_ref, tol=tol)
+    assert_np_equal(x_ldlt.numpy()[0].astype(np.float64), x_ref, tol=tol)
+    assert_np_equal(x_lu.numpy()[0].astype(np.float64), x_ref, tol=tol)
+
+    if dtype == np.float16:
+        return
+
+    # d(w.x)/dA = -y*x^T with y = A^-T*w, the symmetric factorizations only read the lower triangle of A
+    y = np.linalg.solve(A_64.T, w_np.astype(np.float64))
+    G = -np.outer(y, x_ref)
+    G_lower = np.tril(G + G.T) - np.diag(np.diag(G))
+
+    for i, expected_A in enumerate([G_lower, G_lower, G]):
+        tape = wp.Tape()
+        with tape:
+            wp.launch(kernel, dim=1, inputs=[A, b, w], outputs=outputs, device=device)
+        tape.backward(grads={f: wp.array(np.eye(3, dtype=dtype)[i], dtype=wptype, device=device)})
+
+        assert_np_equal(tape.gradients[A].numpy()[0].astype(np.float64), expected_A, tol=10 * tol)
+        assert_np_equal(tape.gradients[b].numpy()[0].astype(np.float64), y, tol=10 * tol)
+        tape.zero()
+
+
 def test_skew(test, device, dtype, register_kernels=False):
     np.random.seed(123)
 
@@ -4187,6 +4388,12 @@ def register(parent):
         add_function_test_register_kernel(TestMat, f"test_svd_{dtype.__name__}", test_svd, devices=devices, dtype=dtype)
         add_function_test_register_kernel(TestMat, f"test_qr_{dtype.__name__}", test_qr, devices=devices, dtype=dtype)
         add_function_test_register_kernel(TestMat, f"test_eig_{dtype.__name__}", test_eig, devices=devices, dtype=dtype)
+        add_function_test_register_kernel(
+            TestMat, f"test_polar_{dtype.__name__}", test_polar, devices=devices, dtype=dtype
+        )
+        add_function_test_register_kernel(
+            TestMat, f"test_factorizations_{dtype.__name__}", test_factorizations, devices=devices, dtype=dtype
+        )
         add_function_test_register_kernel(
             TestMat, f"test_transform_point_{dtype.__name__}", test_transform_point, devices=devices, dtype=dtype
         )
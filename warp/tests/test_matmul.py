@@ -191,6 +191,23 @@ def test_operator(test, device):
     assert_array_equal(A.grad, wp.zeros_like(A))
 
 
+def test_f16_f32_mixed(test, device):
+    m = 64
+    n = 128
+    k = 256
+    low = -4.5
+    high = 3.5
+    A = wp.array2d(np.ceil(np.random.uniform(low=low, high=high, size=(m, k))), dtype=wp.float16, device=device)
+    B = wp.array2d(np.ceil(np.random.uniform(low=low, high=high, size=(k, n))), dtype=wp.float16, device=device)
+    C = wp.array2d(np.ceil(np.random.uniform(low=low, high=high, size=(m, n))), dtype=wp.float32, device=device)
+    D = wp.array2d(np.zeros((m, n)), dtype=wp.float32, device=device)
+
+    # half precision inputs accumulated and written out in single precision
+    wp.matmul(A, B, C, D, 1.0, 1.0, False, device)
+    D_np = A.numpy().astype(np.float32) @ B.numpy().astype(np.float32) + C.numpy()
+    assert np.array_equal(D_np, D.numpy())
+
+
 def register(parent):
     devices = [d for d in get_test_devices()]
 
@@ -205,6 +222,7 @@ def register(parent):
             # add_function_test(TestMatmul, "test_f16", test_f16, devices=devices)
             add_function_test(TestMatmul, "test_f32", test_f32, devices=devices)
             add_function_test(TestMatmul, "test_f64", test_f64, devices=devices)
+            add_function_test(TestMatmul, "test_f16_f32_mixed", test_f16_f32_mixed, devices=devices)
             add_function_test(TestMatmul, "test_tape", test_tape, devices=devices)
             add_function_test(TestMatmul, "test_operator", test_operator, devices=devices)
         else:
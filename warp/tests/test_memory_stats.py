@@ -0,0 +1,106 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+def test_memory_stats_tag(test, device):
+    base = wp.get_memory_stats(device)
+
+    with wp.ScopedMemoryTag("test_tag"):
+        a = wp.zeros(1024, dtype=float, device=device)
+
+    stats = wp.get_memory_stats(device)
+    test.assertEqual(stats["current"], base["current"] + a.capacity)
+    test.assertGreaterEqual(stats["peak"], stats["current"])
+    test.assertEqual(stats["count"], base["count"] + 1)
+
+    tag = stats["tags"]["test_tag"]
+    test.assertGreaterEqual(tag["current"], a.capacity)
+    test.assertGreaterEqual(tag["histogram"][4096], 1)
+
+    # the tag keeps its peak once the memory is released
+    current = tag["current"]
+    del a
+    wp.synchronize_device(device)
+
+    tag = wp.get_memory_stats(device)["tags"]["test_tag"]
+    test.assertEqual(tag["current"], current - 4096)
+    test.assertGreaterEqual(tag["peak"], current)
+
+    wp.reset_memory_peak(device)
+    tag = wp.get_memory_stats(device)["tags"]["test_tag"]
+    test.assertEqual(tag["peak"], tag["current"])
+
+
+def test_memory_stats_nested_tags(test, device):
+    with wp.ScopedMemoryTag("test_outer"):
+        a = wp.zeros(256, dtype=float, device=device)
+        with wp.ScopedMemoryTag("test_inner"):
+            b = wp.zeros(512, dtype=float, device=device)
+        c = wp.zeros(256, dtype=float, device=device)
+
+    tags = wp.get_memory_stats(device)["tags"]
+    test.assertGreaterEqual(tags["test_outer"]["current"], a.capacity + c.capacity)
+    test.assertGreaterEqual(tags["test_inner"]["current"], b.capacity)
+
+    # allocations outside of any tag are not attributed to the tags
+    outer = tags["test_outer"]["current"]
+    d = wp.zeros(256, dtype=float, device=device)
+    test.assertEqual(wp.get_memory_stats(device)["tags"]["test_outer"]["current"], outer)
+
+    del a, b, c, d
+
+
+def test_memory_stats_sort(test, device):
+    keys = wp.array(np.random.randint(0, 1 << 20, size=2 * 4096, dtype=np.int32), device=device)
+    values = wp.array(np.arange(2 * 4096, dtype=np.int32), device=device)
+
+    wp.utils.radix_sort_pairs(keys, values, 4096)
+
+    # the native temporary buffers are attributed to their subsystem
+    test.assertGreater(wp.get_memory_stats(device)["tags"]["sort"]["peak"], 0)
+
+
+def test_memory_stats_pinned(test, device):
+    base = wp.get_memory_stats(pinned=True)
+
+    a = wp.zeros(1024, dtype=float, device="cpu", pinned=True)
+
+    stats = wp.get_memory_stats(pinned=True)
+    test.assertGreaterEqual(stats["current"], base["current"] + a.capacity)
+    test.assertEqual(stats["count"], base["count"] + 1)
+
+    del a
+
+
+def register(parent):
+    devices = get_test_devices()
+    cuda_devices = [d for d in devices if d.is_cuda]
+
+    class TestMemoryStats(parent):
+        pass
+
+    add_function_test(TestMemoryStats, "test_memory_stats_tag", test_memory_stats_tag, devices=devices)
+    add_function_test(
+        TestMemoryStats, "test_memory_stats_nested_tags", test_memory_stats_nested_tags, devices=devices
+    )
+    add_function_test(TestMemoryStats, "test_memory_stats_sort", test_memory_stats_sort, devices=cuda_devices)
+    add_function_test(TestMemoryStats, "test_memory_stats_pinned", test_memory_stats_pinned, devices=cuda_devices)
+
+    return TestMemoryStats
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -0,0 +1,102 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+@wp.kernel
+def inc(a: wp.array(dtype=float)):
+    tid = wp.tid()
+    a[tid] = a[tid] + 1.0
+
+
+def test_mempool_alloc(test, device):
+    saved = wp.is_mempool_enabled(device)
+    try:
+        # allocate one array with cudaMalloc and one from the pool
+        wp.set_mempool_enabled(device, False)
+        a = wp.zeros(1024, dtype=float, device=device)
+
+        wp.set_mempool_enabled(device, True)
+        test.assertTrue(wp.is_mempool_enabled(device))
+        b = wp.zeros(1024, dtype=float, device=device)
+
+        stats = wp.get_mempool_stats(device)
+        test.assertGreaterEqual(stats["used_current"], b.capacity)
+        test.assertGreaterEqual(stats["reserved_high"], stats["used_current"])
+
+        wp.launch(inc, dim=a.size, inputs=[a], device=device)
+        wp.launch(inc, dim=b.size, inputs=[b], device=device)
+
+        assert_np_equal(a.numpy(), np.ones(1024, dtype=np.float32))
+        assert_np_equal(b.numpy(), np.ones(1024, dtype=np.float32))
+
+        # both arrays must be freed through the matching path regardless of the current mode
+        wp.set_mempool_enabled(device, False)
+        del a
+        del b
+        wp.synchronize_device(device)
+    finally:
+        wp.set_mempool_enabled(device, saved)
+
+
+def test_mempool_release_threshold(test, device):
+    saved = wp.get_mempool_release_threshold(device)
+    try:
+        wp.set_mempool_release_threshold(device, 64 * 1024 * 1024)
+        test.assertEqual(wp.get_mempool_release_threshold(device), 64 * 1024 * 1024)
+    finally:
+        wp.set_mempool_release_threshold(device, saved)
+
+
+def test_mempool_graph_capture(test, device):
+    saved = wp.is_mempool_enabled(device)
+    try:
+        wp.set_mempool_enabled(device, True)
+
+        a = wp.zeros(1024, dtype=float, device=device)
+
+        # transient arrays created during capture become graph allocation nodes
+        wp.capture_begin(device)
+        try:
+            tmp = wp.zeros_like(a)
+            wp.launch(inc, dim=tmp.size, inputs=[tmp], device=device)
+            wp.copy(a, tmp)
+            del tmp
+        finally:
+            graph = wp.capture_end(device)
+
+        wp.capture_launch(graph)
+        wp.capture_launch(graph)
+
+        assert_np_equal(a.numpy(), np.ones(1024, dtype=np.float32))
+    finally:
+        wp.set_mempool_enabled(device, saved)
+
+
+def register(parent):
+    devices = [d for d in wp.get_cuda_devices() if d.is_mempool_supported]
+
+    class TestMempool(parent):
+        pass
+
+    add_function_test(TestMempool, "test_mempool_alloc", test_mempool_alloc, devices=devices)
+    add_function_test(TestMempool, "test_mempool_release_threshold", test_mempool_release_threshold, devices=devices)
+    add_function_test(TestMempool, "test_mempool_graph_capture", test_mempool_graph_capture, devices=devices)
+
+    return TestMempool
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
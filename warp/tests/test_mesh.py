@@ -250,6 +250,54 @@ def test_mesh_query_ray(test, device):
     )
 
 
+@wp.kernel(enable_backward=False)
+def query_ray_face_kernel(mesh_id: wp.uint64, out_face: wp.array(dtype=int)):
+    start = wp.vec3(0.1, 0.2, 0.3)
+    dir = wp.normalize(wp.vec3(-1.2, 2.3, -3.4))
+
+    t = float(0.0)
+    bary_u = float(0.0)
+    bary_v = float(0.0)
+    sign = float(0.0)
+    normal = wp.vec3(0.0, 0.0, 0.0)
+    face = int(0)
+
+    if wp.mesh_query_ray(mesh_id, start, dir, 1e6, t, bary_u, bary_v, sign, normal, face):
+        out_face[0] = face
+
+
+def test_mesh_reorder(test, device):
+    input_points = np.array(POINT_POSITIONS, dtype=np.float32)
+    input_indices = np.array(RIGHT_HANDED_FACE_VERTEX_INDICES, dtype=np.int32).reshape(-1, 3)
+
+    for reorder_points in (False, True):
+        points = wp.array(input_points, dtype=wp.vec3, device=device)
+        indices = wp.array(input_indices.flatten(), dtype=int, device=device)
+        mesh = wp.Mesh(points=points, indices=indices, reorder=True, reorder_points=reorder_points)
+
+        tri_permutation = mesh.triangle_permutation.numpy()
+        assert_np_equal(np.sort(tri_permutation), np.arange(FACE_COUNT))
+
+        # the triangles keep their vertices and winding
+        tris = points.numpy()[indices.numpy().reshape(-1, 3)]
+        assert_np_equal(tris, input_points[input_indices[tri_permutation]])
+
+        if reorder_points:
+            assert_np_equal(points.numpy(), input_points[mesh.point_permutation.numpy()])
+        else:
+            test.assertIsNone(mesh.point_permutation)
+
+        # faces returned by the queries map back to the input order
+        face = wp.full(1, -1, dtype=int, device=device)
+        wp.launch(query_ray_face_kernel, dim=1, inputs=[mesh.id, face], device=device)
+        test.assertEqual(tri_permutation[face.numpy()[0]], 4)
+
+        # refits use the permuted bounds
+        mesh.refit()
+        wp.launch(query_ray_face_kernel, dim=1, inputs=[mesh.id, face], device=device)
+        test.assertEqual(tri_permutation[face.numpy()[0]], 4)
+
+
 def test_mesh_refit_graph(test, device):
     points = wp.array(POINT_POSITIONS, dtype=wp.vec3)
 
@@ -268,6 +316,111 @@ def test_mesh_refit_graph(test, device):
         wp.capture_launch(graph)
 
 
+@wp.kernel(enable_backward=False)
+def query_point_hit_kernel(
+    mesh_id: wp.uint64, points: wp.array(dtype=wp.vec3), max_dist: float, hits: wp.array(dtype=int)
+):
+    tid = wp.tid()
+
+    face = int(0)
+    u = float(0.0)
+    v = float(0.0)
+    hits[tid] = int(wp.mesh_query_point_no_sign(mesh_id, points[tid], max_dist, face, u, v))
+
+
+def test_mesh_skin(test, device):
+    rest = np.array(POINT_POSITIONS, dtype=np.float32)
+    rest_points = wp.array(rest, dtype=wp.vec3, device=device)
+    points = wp.array(rest, dtype=wp.vec3, device=device)
+    indices = wp.array(RIGHT_HANDED_FACE_VERTEX_INDICES, dtype=int, device=device)
+    mesh = wp.Mesh(points=points, indices=indices)
+
+    # the top points follow the second bone, the bottom ones are blended between both
+    bones = wp.array(
+        [wp.transform_identity(), wp.transform(wp.vec3(2.0, 0.0, 0.0), wp.quat_identity())],
+        dtype=wp.transform,
+        device=device,
+    )
+    top = rest[:, 2] > 0.0
+    bone_indices = wp.array(np.tile(np.array([0, 1], dtype=np.int32), (POINT_COUNT, 1)), dtype=int, device=device)
+    bone_weights = wp.array(np.where(top[:, None], [0.0, 1.0], [0.5, 0.5]), dtype=float, device=device)
+
+    instance = wp.transform(wp.vec3(0.0, 10.0, 0.0), wp.quat_identity())
+    mesh.skin(rest_points, bones, bone_indices, bone_weights, xform=instance)
+
+    expected = rest + np.where(top[:, None], [2.0, 10.0, 0.0], [1.0, 10.0, 0.0])
+    assert_np_equal(points.numpy(), expected, tol=1.0e-6)
+
+    # the BVH is refit to the deformed points
+    queries = wp.array([(1.5, 10.0, 0.5), (0.0, 0.0, 0.0)], dtype=wp.vec3, device=device)
+    hits = wp.zeros(2, dtype=int, device=device)
+    wp.launch(query_point_hit_kernel, dim=2, inputs=[mesh.id, queries, 0.1, hits], device=device)
+    assert_np_equal(hits.numpy(), np.array([1, 0]))
+
+    # without bones the rest points are only moved by the instance transform
+    mesh.skin(rest_points, xform=instance)
+    assert_np_equal(points.numpy(), rest + np.array([0.0, 10.0, 0.0]), tol=1.0e-6)
+
+
+@wp.kernel(enable_backward=False)
+def query_closest_point_kernel(
+    mesh_ids: wp.array(dtype=wp.uint64), points: wp.array(dtype=wp.vec3), closest: wp.array2d(dtype=wp.vec3)
+):
+    i, j = wp.tid()
+
+    face = int(0)
+    u = float(0.0)
+    v = float(0.0)
+    closest[i, j] = wp.vec3(1.0e6)
+    if wp.mesh_query_point_no_sign(mesh_ids[i], points[j], 1.0e6, face, u, v):
+        closest[i, j] = wp.mesh_eval_position(mesh_ids[i], face, u, v)
+
+
+def test_mesh_create_batch(test, device):
+    rng = np.random.default_rng(123)
+
+    # a cube, a translated and scaled cube and a single triangle
+    cube = np.array(POINT_POSITIONS, dtype=np.float32)
+    cube_indices = np.array(RIGHT_HANDED_FACE_VERTEX_INDICES, dtype=np.int32)
+    mesh_points = [cube, 2.0 * cube + np.array([3.0, 0.0, 0.0], dtype=np.float32), cube[:3]]
+    mesh_indices = [cube_indices, cube_indices, np.array([0, 1, 2], dtype=np.int32)]
+
+    point_offsets = np.cumsum([0] + [len(p) for p in mesh_points])
+    tri_offsets = np.cumsum([0] + [len(i) // 3 for i in mesh_indices])
+
+    points = wp.array(np.concatenate(mesh_points), dtype=wp.vec3, device=device)
+    indices = wp.array(np.concatenate(mesh_indices), dtype=int, device=device)
+    batch = wp.Mesh.create_batch(points, indices, point_offsets, tri_offsets)
+    test.assertEqual(len(batch), len(mesh_points))
+
+    meshes = [
+        wp.Mesh(wp.array(p, dtype=wp.vec3, device=device), wp.array(i, dtype=int, device=device))
+        for p, i in zip(mesh_points, mesh_indices)
+    ]
+
+    queries = wp.array(rng.uniform(-2.0, 6.0, size=(256, 3)), dtype=wp.vec3, device=device)
+
+    def closest_points(meshes):
+        ids = wp.array([mesh.id for mesh in meshes], dtype=wp.uint64, device=device)
+        closest = wp.empty((len(meshes), len(queries)), dtype=wp.vec3, device=device)
+        wp.launch(query_closest_point_kernel, dim=closest.shape, inputs=[ids, queries, closest], device=device)
+        return closest.numpy()
+
+    assert_np_equal(closest_points(batch), closest_points(meshes), tol=1.0e-5)
+
+    # the meshes of a batch are refit independently and stay valid when the others are released
+    batch[1].points.assign(batch[1].points.numpy() + np.array([0.0, 5.0, 0.0], dtype=np.float32))
+    batch[1].refit()
+    meshes[1].points.assign(meshes[1].points.numpy() + np.array([0.0, 5.0, 0.0], dtype=np.float32))
+    meshes[1].refit()
+
+    del batch[0]
+    assert_np_equal(closest_points(batch), closest_points(meshes[1:]), tol=1.0e-5)
+
+    with test.assertRaises(RuntimeError):
+        wp.Mesh.create_batch(points, indices, point_offsets, [0, tri_offsets[1], tri_offsets[1], tri_offsets[3]])
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -277,6 +430,9 @@ def register(parent):
     add_function_test(TestMesh, "test_mesh_read_properties", test_mesh_read_properties, devices=devices)
     add_function_test(TestMesh, "test_mesh_query_point", test_mesh_query_point, devices=devices)
     add_function_test(TestMesh, "test_mesh_query_ray", test_mesh_query_ray, devices=devices)
+    add_function_test(TestMesh, "test_mesh_reorder", test_mesh_reorder, devices=devices)
+    add_function_test(TestMesh, "test_mesh_skin", test_mesh_skin, devices=devices)
+    add_function_test(TestMesh, "test_mesh_create_batch", test_mesh_create_batch, devices=devices)
     add_function_test(TestMesh, "test_mesh_refit_graph", test_mesh_refit_graph, devices=wp.get_cuda_devices())
     return TestMesh
 
@@ -197,6 +197,116 @@ def test_mesh_query_aabb_count_nonoverlap(test, device):
         test.assertTrue(c == 1)
 
 
+def test_mesh_query_mesh_overlap(test, device):
+    # two unit squares on top of each other, the second one is lifted by 0.5
+    points = np.array([[0, 0, 0], [1, 0, 0], [1, 1, 0], [0, 1, 0]], dtype=float)
+    indices = np.array([0, 1, 2, 0, 2, 3])
+
+    a = wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(indices, dtype=int, device=device),
+    )
+    b = wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(indices, dtype=int, device=device),
+    )
+
+    pairs = wp.zeros(8, dtype=wp.vec2i, device=device)
+    count = wp.zeros(1, dtype=wp.int32, device=device)
+
+    lift = wp.transform(wp.vec3(0.0, 0.0, 0.5), wp.quat_identity())
+
+    a.query_overlap(b, pairs, count, margin=0.1, xform=lift)
+    test.assertEqual(count.numpy()[0], 0)
+
+    # all triangle bounds overlap once the margin covers the gap
+    a.query_overlap(b, pairs, count, margin=0.6, xform=lift)
+    test.assertEqual(count.numpy()[0], 4)
+    test.assertEqual(set(map(tuple, pairs.numpy()[:4])), {(0, 0), (0, 1), (1, 0), (1, 1)})
+
+
+def test_mesh_query_intersections(test, device):
+    points = np.array([[0, 0, 0], [1, 0, 0], [1, 1, 0], [0, 1, 0]], dtype=float)
+    indices = np.array([0, 1, 2, 0, 2, 3])
+
+    a = wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(indices, dtype=int, device=device),
+    )
+    b = wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(indices, dtype=int, device=device),
+    )
+
+    pairs = wp.zeros(8, dtype=wp.vec2i, device=device)
+    segments = wp.zeros((8, 2), dtype=wp.vec3, device=device)
+    count = wp.zeros(1, dtype=wp.int32, device=device)
+
+    # the second square stands upright and crosses the first one along y = 0.5 for x in [0.1, 1]
+    rot = wp.quat_from_axis_angle(wp.vec3(1.0, 0.0, 0.0), 0.5 * np.pi)
+    cross = wp.transform(wp.vec3(0.1, 0.5, -0.5), rot)
+
+    a.query_intersections(b, pairs, count, segments, xform=cross)
+    test.assertEqual(count.numpy()[0], 3)
+    test.assertEqual(set(map(tuple, pairs.numpy()[:3])), {(0, 0), (0, 1), (1, 1)})
+
+    ends = segments.numpy()[:3]
+    assert_np_equal(ends[:, :, 1], np.full((3, 2), 0.5), tol=1.0e-5)
+    assert_np_equal(ends[:, :, 2], np.zeros((3, 2)), tol=1.0e-5)
+    test.assertAlmostEqual(np.sum(np.abs(ends[:, 1, 0] - ends[:, 0, 0])), 0.9, delta=1.0e-5)
+
+    # the count covers the pairs that don't fit in the output
+    a.query_intersections(b, pairs[:1], count, xform=cross)
+    test.assertEqual(count.numpy()[0], 3)
+
+    # lifted above the first square the triangles no longer cross
+    lift = wp.transform(wp.vec3(0.1, 0.5, 0.01), rot)
+    a.query_intersections(b, pairs, count, segments, xform=lift)
+    test.assertEqual(count.numpy()[0], 0)
+
+
+def test_mesh_query_self_overlap(test, device):
+    points = np.array([[0, 0, 0], [1, 0, 0], [1, 1, 0], [0, 1, 0], [5, 5, 5], [6, 5, 5], [6, 6, 5]], dtype=float)
+    indices = np.array([0, 1, 2, 0, 2, 3, 4, 5, 6])
+
+    mesh = wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(indices, dtype=int, device=device),
+    )
+
+    pairs = wp.zeros(8, dtype=wp.vec2i, device=device)
+    count = wp.zeros(1, dtype=wp.int32, device=device)
+
+    # the two triangles of the square once, the distant triangle overlaps neither
+    mesh.query_self_overlap(pairs, count, margin=0.1)
+    test.assertEqual(count.numpy()[0], 1)
+    test.assertEqual(tuple(pairs.numpy()[0]), (0, 1))
+
+
+def test_mesh_query_bvh_overlap(test, device):
+    points = np.array([[0, 0, 0], [1, 0, 0], [1, 1, 0], [0, 1, 0]], dtype=float)
+    indices = np.array([0, 1, 2, 0, 2, 3])
+
+    mesh = wp.Mesh(
+        points=wp.array(points, dtype=wp.vec3, device=device),
+        indices=wp.array(indices, dtype=int, device=device),
+    )
+
+    # particles as point bounds, one above the square and one far away
+    particles = wp.array([[0.8, 0.2, 0.2], [5.0, 5.0, 5.0]], dtype=wp.vec3, device=device)
+    bvh = wp.Bvh(particles, particles)
+
+    pairs = wp.zeros(8, dtype=wp.vec2i, device=device)
+    count = wp.zeros(1, dtype=wp.int32, device=device)
+
+    mesh.query_overlap(bvh, pairs, count, margin=0.1)
+    test.assertEqual(count.numpy()[0], 0)
+
+    mesh.query_overlap(bvh, pairs, count, margin=0.25)
+    test.assertEqual(count.numpy()[0], 2)
+    test.assertEqual(set(map(tuple, pairs.numpy()[:2])), {(0, 0), (1, 0)})
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -216,6 +326,30 @@ def register(parent):
         test_mesh_query_aabb_count_nonoverlap,
         devices=devices,
     )
+    add_function_test(
+        TestMeshQueryAABBMethods,
+        "test_mesh_query_mesh_overlap",
+        test_mesh_query_mesh_overlap,
+        devices=devices,
+    )
+    add_function_test(
+        TestMeshQueryAABBMethods,
+        "test_mesh_query_intersections",
+        test_mesh_query_intersections,
+        devices=devices,
+    )
+    add_function_test(
+        TestMeshQueryAABBMethods,
+        "test_mesh_query_self_overlap",
+        test_mesh_query_self_overlap,
+        devices=devices,
+    )
+    add_function_test(
+        TestMeshQueryAABBMethods,
+        "test_mesh_query_bvh_overlap",
+        test_mesh_query_bvh_overlap,
+        devices=devices,
+    )
 
     return TestMeshQueryAABBMethods
 
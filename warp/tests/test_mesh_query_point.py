@@ -557,12 +557,237 @@ def test_adj_mesh_query_point(test, device):
     test.assertTrue(error < tolerance, f"error is {error} which is >= {tolerance}")
 
 
+def test_mesh_query_winding_number_lazy(test, device):
+    # unit cube centered at the origin
+    corners = np.array([[x, y, z] for x in (-0.5, 0.5) for y in (-0.5, 0.5) for z in (-0.5, 0.5)], dtype=np.float32)
+    # fmt: off
+    faces = np.array([
+        [0, 1, 3], [0, 3, 2], [4, 6, 7], [4, 7, 5], [0, 4, 5], [0, 5, 1],
+        [2, 3, 7], [2, 7, 6], [0, 2, 6], [0, 6, 4], [1, 5, 7], [1, 7, 3],
+    ])
+    # fmt: on
+    points = wp.array(corners, dtype=wp.vec3, device=device)
+    indices = wp.array(faces.flatten(), dtype=int, device=device)
+    mesh = wp.Mesh(points=points, indices=indices, support_winding_number=True)
+
+    rng = np.random.default_rng(42)
+    query_np = rng.uniform(-1.5, 1.5, size=(500, 3)).astype(np.float32)
+    query_points = wp.array(query_np, dtype=wp.vec3, device=device)
+    faces_out = wp.zeros(len(query_np), dtype=int, device=device)
+    signs = wp.zeros(len(query_np), dtype=float, device=device)
+    dist = wp.zeros(len(query_np), dtype=float, device=device)
+
+    def check_signs(offset):
+        wp.launch(
+            sample_mesh_query_sign_winding_number,
+            dim=len(query_np),
+            inputs=[mesh.id, query_points, faces_out, signs, dist],
+            device=device,
+        )
+        inside = np.all(np.abs(query_np - offset) < 0.5, axis=1)
+        assert_np_equal(signs.numpy() < 0.0, inside)
+
+    # the solid angle data is computed before the first winding number query
+    test.assertIn(mesh.id, wp.Mesh._stale_winding_number)
+    check_signs(np.zeros(3))
+    test.assertNotIn(mesh.id, wp.Mesh._stale_winding_number)
+
+    # full refits invalidate it
+    offset = np.array([0.5, 0.0, 0.0], dtype=np.float32)
+    points.assign(corners + offset)
+    mesh.refit()
+    test.assertIn(mesh.id, wp.Mesh._stale_winding_number)
+    check_signs(offset)
+
+    # partial refits update it along with the dirty triangles
+    offset = np.array([0.5, 0.25, 0.0], dtype=np.float32)
+    points.assign(corners + offset)
+    mesh.refit_partial(wp.array(np.arange(len(faces), dtype=np.int32), device=device))
+    test.assertNotIn(mesh.id, wp.Mesh._stale_winding_number)
+    check_signs(offset)
+
+
+def test_mesh_query_point_batch(test, device):
+    # wavy cloth with particles scattered above and below it
+    n = 32
+    x, z = np.meshgrid(np.linspace(0.0, 1.0, n), np.linspace(0.0, 1.0, n))
+    y = 0.1 * np.sin(x * 6.0) * np.cos(z * 4.0)
+    vertices = np.stack([x, y, z], axis=-1).reshape(-1, 3)
+
+    quads = np.array(
+        [[i * n + j, i * n + j + 1, (i + 1) * n + j + 1, (i + 1) * n + j] for i in range(n - 1) for j in range(n - 1)]
+    )
+    triangles = np.concatenate([quads[:, [0, 1, 2]], quads[:, [0, 2, 3]]])
+
+    mesh = wp.Mesh(
+        points=wp.array(vertices, dtype=wp.vec3, device=device),
+        indices=wp.array(triangles.flatten(), dtype=np.int32, device=device),
+    )
+
+    rng = np.random.default_rng(123)
+    query_np = rng.uniform((-0.2, -0.3, -0.2), (1.2, 0.3, 1.2), size=(1000, 3)).astype(np.float32)
+    query_points = wp.array(query_np, dtype=wp.vec3, device=device)
+
+    expect_face = wp.zeros(len(query_np), dtype=int, device=device)
+    expect_dist = wp.zeros(len(query_np), dtype=float, device=device)
+    wp.launch(
+        sample_mesh_query_no_sign,
+        dim=len(query_np),
+        inputs=[mesh.id, query_points, expect_face, expect_dist],
+        device=device,
+    )
+
+    for sort_points in (False, True):
+        face = wp.zeros(len(query_np), dtype=int, device=device)
+        uv = wp.zeros(len(query_np), dtype=wp.vec2, device=device)
+        dist = wp.zeros(len(query_np), dtype=float, device=device)
+
+        mesh.query_points(query_points, face=face, uv=uv, dist=dist, sort_points=sort_points)
+        assert_np_equal(dist.numpy(), expect_dist.numpy(), tol=1.0e-5)
+        test.assertTrue(np.all(face.numpy() >= 0))
+
+        # the closest faces may differ on shared edges, but they are at the same distance
+        face_np = face.numpy()
+        uv_np = uv.numpy()
+        tris = vertices[triangles[face_np]]
+        w = 1.0 - uv_np.sum(axis=1)
+        closest = uv_np[:, 0:1] * tris[:, 0] + uv_np[:, 1:2] * tris[:, 1] + w[:, None] * tris[:, 2]
+        assert_np_equal(np.linalg.norm(closest - query_np, axis=1), expect_dist.numpy(), tol=1.0e-4)
+
+    # points further than max_dist from the cloth are not found
+    max_dist = 0.1
+    dist = wp.zeros(len(query_np), dtype=float, device=device)
+    mesh.query_points(query_points, max_dist=max_dist, dist=dist)
+    expect = expect_dist.numpy()
+    assert_np_equal(dist.numpy(), np.where(expect < max_dist, expect, -1.0), tol=1.0e-5)
+
+    with test.assertRaises(RuntimeError):
+        mesh.query_points(query_points, dist=wp.zeros(len(query_np), dtype=int, device=device))
+
+
+def test_mesh_query_point_quantized(test, device):
+    n = 32
+    x, z = np.meshgrid(np.linspace(0.0, 1.0, n), np.linspace(0.0, 1.0, n))
+    y = 0.1 * np.sin(x * 6.0) * np.cos(z * 4.0)
+    vertices = np.stack([x, y, z], axis=-1).reshape(-1, 3).astype(np.float32)
+
+    quads = np.array(
+        [[i * n + j, i * n + j + 1, (i + 1) * n + j + 1, (i + 1) * n + j] for i in range(n - 1) for j in range(n - 1)]
+    )
+    triangles = np.concatenate([quads[:, [0, 1, 2]], quads[:, [0, 2, 3]]])
+
+    points = wp.array(vertices, dtype=wp.vec3, device=device)
+    indices = wp.array(triangles.flatten(), dtype=np.int32, device=device)
+    mesh = wp.Mesh(points=points, indices=indices)
+    mesh_quantized = wp.Mesh(points=points, indices=indices, quantize_points=True)
+
+    rng = np.random.default_rng(123)
+    query_np = rng.uniform((-0.2, -0.3, -0.2), (1.2, 0.3, 1.2), size=(1000, 3)).astype(np.float32)
+    query_points = wp.array(query_np, dtype=wp.vec3, device=device)
+
+    def query(m):
+        dist = wp.zeros(len(query_np), dtype=float, device=device)
+        m.query_points(query_points, dist=dist)
+        return dist.numpy()
+
+    # the quantized triangles are within 1/65535 of the mesh extent of the input
+    assert_np_equal(query(mesh_quantized), query(mesh), tol=1.0e-4)
+
+    # refits quantize relative to the new bounds, the points now extend beyond the initial ones
+    moved = vertices * np.array([1.0, 3.0, 1.0], dtype=np.float32) + np.array([0.5, 0.0, 0.0], dtype=np.float32)
+    points.assign(wp.array(moved, dtype=wp.vec3, device=device))
+    mesh.refit()
+    mesh_quantized.refit()
+    assert_np_equal(query(mesh_quantized), query(mesh), tol=1.0e-4)
+
+    # partial refits fall back to full ones
+    moved[:n] += np.array([0.0, 0.5, 0.0], dtype=np.float32)
+    points.assign(wp.array(moved, dtype=wp.vec3, device=device))
+    first_row = np.arange(n - 1, dtype=np.int32)
+    dirty = wp.array(np.concatenate([first_row, first_row + len(quads)]), dtype=np.int32, device=device)
+    mesh.refit_partial(dirty)
+    mesh_quantized.refit_partial(dirty)
+    assert_np_equal(query(mesh_quantized), query(mesh), tol=1.0e-4)
+
+
+@wp.kernel
+def sample_mesh_knn_points(
+    mesh: wp.uint64,
+    query_points: wp.array(dtype=wp.vec3),
+    max_dist: float,
+    ids: wp.array(dtype=int, ndim=2),
+    dists: wp.array(dtype=float, ndim=2),
+):
+    tid = wp.tid()
+
+    heap = wp.topk_heap(k=6)
+    count = wp.mesh_query_knn_points(mesh, query_points[tid], max_dist, heap)
+    wp.topk_sort(heap)
+
+    for i in range(count):
+        ids[tid, i] = wp.topk_value(heap, i)
+        dists[tid, i] = wp.topk_key(heap, i)
+
+
+def test_mesh_query_knn_points(test, device):
+    n = 16
+    x, z = np.meshgrid(np.linspace(0.0, 1.0, n), np.linspace(0.0, 1.0, n))
+    y = 0.1 * np.sin(x * 6.0) * np.cos(z * 4.0)
+    vertices = np.stack([x, y, z], axis=-1).reshape(-1, 3).astype(np.float32)
+
+    quads = np.array(
+        [[i * n + j, i * n + j + 1, (i + 1) * n + j + 1, (i + 1) * n + j] for i in range(n - 1) for j in range(n - 1)]
+    )
+    triangles = np.concatenate([quads[:, [0, 1, 2]], quads[:, [0, 2, 3]]])
+
+    mesh = wp.Mesh(
+        points=wp.array(vertices, dtype=wp.vec3, device=device),
+        indices=wp.array(triangles.flatten(), dtype=np.int32, device=device),
+    )
+
+    rng = np.random.default_rng(123)
+    query_np = rng.uniform((-0.2, -0.3, -0.2), (1.2, 0.3, 1.2), size=(500, 3)).astype(np.float32)
+    query_points = wp.array(query_np, dtype=wp.vec3, device=device)
+
+    d = np.linalg.norm(query_np[:, None, :] - vertices[None, :, :], axis=-1)
+    d_sorted = np.sort(d, axis=1)
+
+    for max_dist in (1.0e6, 0.1):
+        ids = wp.full((len(query_np), 6), -1, dtype=int, device=device)
+        dists = wp.full((len(query_np), 6), -1.0, dtype=float, device=device)
+        wp.launch(
+            sample_mesh_knn_points,
+            dim=len(query_np),
+            inputs=[mesh.id, query_points, max_dist, ids, dists],
+            device=device,
+        )
+        ids = ids.numpy()
+        dists = dists.numpy()
+
+        # vertices shared by several triangles are found once, and those further than max_dist are not found
+        found = ids >= 0
+        assert_np_equal(np.sum(found, axis=1), np.minimum(np.sum(d <= max_dist, axis=1), 6))
+        for i in range(len(query_np)):
+            k = np.sum(found[i])
+            test.assertEqual(len(np.unique(ids[i, :k])), k)
+            assert_np_equal(dists[i, :k], d_sorted[i, :k], tol=1.0e-5)
+
+
 def register(parent):
     devices = get_test_devices()
 
     class TestMeshQuery(parent):
         pass
 
+    add_function_test(
+        TestMeshQuery, "test_mesh_query_winding_number_lazy", test_mesh_query_winding_number_lazy, devices=devices
+    )
+    add_function_test(TestMeshQuery, "test_mesh_query_point_batch", test_mesh_query_point_batch, devices=devices)
+    add_function_test(
+        TestMeshQuery, "test_mesh_query_point_quantized", test_mesh_query_point_quantized, devices=devices
+    )
+    add_function_test(TestMeshQuery, "test_mesh_query_knn_points", test_mesh_query_knn_points, devices=devices)
+
     # USD import failures should not count as a test failure
     try:
         from pxr import Usd, UsdGeom
@@ -259,6 +259,233 @@ def test_mesh_query_ray_edge(test, device):
     test.assertEqual(counts.numpy()[0], n)
 
 
+@wp.kernel
+def raycast_closest_kernel(
+    mesh: wp.uint64,
+    ray_starts: wp.array(dtype=wp.vec3),
+    ray_directions: wp.array(dtype=wp.vec3),
+    ray_t: wp.array(dtype=float),
+    ray_face: wp.array(dtype=int),
+):
+    tid = wp.tid()
+
+    t = float(0.0)
+    u = float(0.0)
+    v = float(0.0)
+    sign = float(0.0)
+    n = wp.vec3()
+    f = int(0)
+
+    if wp.mesh_query_ray(mesh, ray_starts[tid], ray_directions[tid], 1.0e6, t, u, v, sign, n, f):
+        ray_t[tid] = t
+        ray_face[tid] = f
+    else:
+        ray_t[tid] = -1.0
+        ray_face[tid] = -1
+
+
+def sphere_mesh_data(res):
+    # latitude-longitude grid of a unit sphere
+    theta, phi = np.meshgrid(np.linspace(0.0, np.pi, res + 1), np.linspace(0.0, 2.0 * np.pi, res + 1), indexing="ij")
+    vertices = np.stack((np.sin(theta) * np.cos(phi), np.sin(theta) * np.sin(phi), np.cos(theta)), axis=-1)
+    vertices = vertices.reshape(-1, 3)
+
+    triangles = []
+    for i in range(res):
+        for j in range(res):
+            a = i * (res + 1) + j
+            b = a + res + 1
+            triangles.append([a, b, a + 1])
+            triangles.append([a + 1, b, b + 1])
+
+    return vertices, np.array(triangles, dtype=np.int32)
+
+
+def random_rays(n, device):
+    rng = np.random.default_rng(123)
+    ray_starts = wp.array(rng.uniform(-2.0, 2.0, (n, 3)), dtype=wp.vec3, device=device)
+    ray_dirs = rng.normal(size=(n, 3))
+    ray_dirs = wp.array(ray_dirs / np.linalg.norm(ray_dirs, axis=1, keepdims=True), dtype=wp.vec3, device=device)
+
+    return ray_starts, ray_dirs
+
+
+def test_mesh_query_ray_wide(test, device):
+    # large enough for several levels of wide nodes
+    vertices, triangles = sphere_mesh_data(32)
+
+    n = 1024
+    ray_starts, ray_dirs = random_rays(n, device)
+
+    points = wp.array(vertices, dtype=wp.vec3, device=device)
+    indices = wp.array(triangles.flatten(), dtype=int, device=device)
+
+    results = []
+    for wide_bvh in (False, True):
+        mesh = wp.Mesh(points=points, indices=indices, wide_bvh=wide_bvh)
+
+        for scale in (1.0, 1.5):
+            # the wide layout must follow refits
+            if scale != 1.0:
+                points.assign(wp.array(vertices * scale, dtype=wp.vec3, device=device))
+                mesh.refit()
+
+            ray_t = wp.zeros(n, dtype=float, device=device)
+            ray_face = wp.zeros(n, dtype=int, device=device)
+            wp.launch(
+                raycast_closest_kernel, dim=n, inputs=[mesh.id, ray_starts, ray_dirs, ray_t, ray_face], device=device
+            )
+            results.append((ray_t.numpy(), ray_face.numpy()))
+
+        points.assign(wp.array(vertices, dtype=wp.vec3, device=device))
+
+    for binary, wide in zip(results[:2], results[2:]):
+        assert_np_equal(wide[0], binary[0], tol=1.0e-6)
+        test.assertGreater(np.count_nonzero(binary[1] >= 0), 0)
+
+
+def test_mesh_query_ray_short_stack(test, device):
+    vertices, triangles = sphere_mesh_data(32)
+    mesh = wp.Mesh(
+        points=wp.array(vertices, dtype=wp.vec3, device=device),
+        indices=wp.array(triangles.flatten(), dtype=int, device=device),
+    )
+
+    n = 1024
+    ray_starts, ray_dirs = random_rays(n, device)
+
+    # closest hits must not depend on whether the traversal restarted once the stack overflowed
+    results = []
+    for options in ({}, {"bvh_stack_size": 2}, {"bvh_stackless": True}):
+        wp.set_module_options(options)
+        ray_t = wp.zeros(n, dtype=float, device=device)
+        ray_face = wp.zeros(n, dtype=int, device=device)
+        wp.launch(raycast_closest_kernel, dim=n, inputs=[mesh.id, ray_starts, ray_dirs, ray_t, ray_face], device=device)
+        results.append((ray_t.numpy(), ray_face.numpy()))
+        wp.set_module_options({"bvh_stack_size": None, "bvh_stackless": False})
+
+    test.assertGreater(np.count_nonzero(results[0][1] >= 0), 0)
+    for ray_t, ray_face in results[1:]:
+        assert_np_equal(ray_t, results[0][0], tol=1.0e-6)
+        assert_np_equal(ray_face, results[0][1])
+
+
+def test_mesh_level_refit(test, device):
+    vertices, triangles = sphere_mesh_data(24)
+
+    n = 1024
+    ray_starts, ray_dirs = random_rays(n, device)
+
+    indices = wp.array(triangles.flatten(), dtype=int, device=device)
+
+    # the solid angle refit has its own level-synchronous variant
+    for support_winding_number in (False, True):
+        results = []
+        for level_refit in (False, True):
+            points = wp.array(vertices, dtype=wp.vec3, device=device)
+            mesh = wp.Mesh(
+                points=points,
+                indices=indices,
+                support_winding_number=support_winding_number,
+                level_refit=level_refit,
+            )
+
+            points.assign(wp.array(vertices * np.array([1.5, 0.5, 1.0]), dtype=wp.vec3, device=device))
+            mesh.refit()
+
+            ray_t = wp.zeros(n, dtype=float, device=device)
+            ray_face = wp.zeros(n, dtype=int, device=device)
+            wp.launch(
+                raycast_closest_kernel, dim=n, inputs=[mesh.id, ray_starts, ray_dirs, ray_t, ray_face], device=device
+            )
+            results.append((ray_t.numpy(), ray_face.numpy()))
+
+        test.assertGreater(np.count_nonzero(results[0][1] >= 0), 0)
+        assert_np_equal(results[1][0], results[0][0])
+        assert_np_equal(results[1][1], results[0][1])
+
+
+def test_mesh_refit_partial(test, device):
+    vertices, triangles = sphere_mesh_data(24)
+
+    n = 1024
+    ray_starts, ray_dirs = random_rays(n, device)
+
+    # push a patch of vertices outwards, only the triangles touching them are dirty
+    rng = np.random.default_rng(7)
+    moved = rng.choice(len(vertices), 40, replace=False)
+    deformed = vertices.copy()
+    deformed[moved] *= 1.4
+    dirty = np.nonzero(np.any(np.isin(triangles, moved), axis=1))[0].astype(np.int32)
+
+    indices = wp.array(triangles.flatten(), dtype=int, device=device)
+
+    for support_winding_number in (False, True):
+        results = []
+        for partial in (False, True):
+            points = wp.array(vertices, dtype=wp.vec3, device=device)
+            mesh = wp.Mesh(points=points, indices=indices, support_winding_number=support_winding_number)
+
+            points.assign(wp.array(deformed, dtype=wp.vec3, device=device))
+
+            if partial:
+                mesh.refit_partial(wp.array(dirty, dtype=wp.int32, device=device))
+            else:
+                mesh.refit()
+
+            ray_t = wp.zeros(n, dtype=float, device=device)
+            ray_face = wp.zeros(n, dtype=int, device=device)
+            wp.launch(
+                raycast_closest_kernel, dim=n, inputs=[mesh.id, ray_starts, ray_dirs, ray_t, ray_face], device=device
+            )
+            results.append((ray_t.numpy(), ray_face.numpy()))
+
+        test.assertGreater(np.count_nonzero(results[0][1] >= 0), 0)
+        assert_np_equal(results[1][0], results[0][0])
+        assert_np_equal(results[1][1], results[0][1])
+
+
+def test_mesh_raycast_batch(test, device):
+    vertices, triangles = sphere_mesh_data(16)
+
+    mesh = wp.Mesh(
+        points=wp.array(vertices, dtype=wp.vec3, device=device),
+        indices=wp.array(triangles.flatten(), dtype=int, device=device),
+    )
+
+    n = 1000
+    ray_starts, ray_dirs = random_rays(n, device)
+
+    expect_t = wp.zeros(n, dtype=float, device=device)
+    expect_face = wp.zeros(n, dtype=int, device=device)
+    wp.launch(
+        raycast_closest_kernel, dim=n, inputs=[mesh.id, ray_starts, ray_dirs, expect_t, expect_face], device=device
+    )
+
+    for sort_rays in (False, True):
+        t = wp.zeros(n, dtype=float, device=device)
+        face = wp.zeros(n, dtype=int, device=device)
+        uv = wp.zeros(n, dtype=wp.vec2, device=device)
+        normal = wp.zeros(n, dtype=wp.vec3, device=device)
+
+        mesh.raycast(ray_starts, ray_dirs, t=t, face=face, uv=uv, normal=normal, sort_rays=sort_rays)
+
+        assert_np_equal(t.numpy(), expect_t.numpy(), tol=1.0e-6)
+
+        hits = expect_face.numpy() >= 0
+        test.assertGreater(np.count_nonzero(hits), 0)
+        assert_np_equal(face.numpy()[~hits], expect_face.numpy()[~hits])
+        assert_np_equal(np.linalg.norm(normal.numpy()[hits], axis=1), np.ones(np.count_nonzero(hits)), tol=1.0e-5)
+
+    # outputs are optional
+    t = wp.zeros(n, dtype=float, device=device)
+    mesh.raycast(ray_starts, ray_dirs, t=t)
+    assert_np_equal(t.numpy(), expect_t.numpy(), tol=1.0e-6)
+
+    with test.assertRaises(RuntimeError):
+        mesh.raycast(ray_starts, ray_dirs, t=wp.zeros(n, dtype=int, device=device))
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -266,6 +493,13 @@ def register(parent):
         pass
 
     add_function_test(TestMeshQueryRay, "test_mesh_query_ray_edge", test_mesh_query_ray_edge, devices=devices)
+    add_function_test(TestMeshQueryRay, "test_mesh_query_ray_wide", test_mesh_query_ray_wide, devices=devices)
+    add_function_test(
+        TestMeshQueryRay, "test_mesh_query_ray_short_stack", test_mesh_query_ray_short_stack, devices=devices
+    )
+    add_function_test(TestMeshQueryRay, "test_mesh_level_refit", test_mesh_level_refit, devices=devices)
+    add_function_test(TestMeshQueryRay, "test_mesh_refit_partial", test_mesh_refit_partial, devices=devices)
+    add_function_test(TestMeshQueryRay, "test_mesh_raycast_batch", test_mesh_raycast_batch, devices=devices)
 
     # USD import failures should not count as a test failure
     try:
@@ -5,15 +5,24 @@
 # distribution of this software and related documentation without an express
 # license agreement from NVIDIA CORPORATION is strictly prohibited.
 
+import os
+
 import warp as wp
 from warp.tests.test_base import *
 from warp.sim import ModelBuilder
+from warp.sim.utils import load_contact_normal
 
 import numpy as np
 
 wp.init()
 
 
+@wp.kernel
+def decode_contact_normals(normals: wp.array(dtype=wp.vec2h), decoded: wp.array(dtype=wp.vec3)):
+    tid = wp.tid()
+    decoded[tid] = load_contact_normal(normals, tid)
+
+
 def register(parent):
     class TestModel(parent):
         def test_add_triangles(self):
@@ -99,6 +108,562 @@ def register(parent):
             assert_np_equal(np.array(builder1.edge_rest_angle), np.array(builder2.edge_rest_angle), tol=1.0e-4)
             assert_np_equal(np.array(builder1.edge_bending_properties), np.array(builder2.edge_bending_properties))
 
+        def test_dynamic_broadphase(self):
+            rng = np.random.default_rng(42)
+
+            def add_spheres(builder, count):
+                for _ in range(count):
+                    body = builder.add_body(origin=wp.transform(rng.uniform(-2.0, 2.0, 3), wp.quat_identity()))
+                    builder.add_shape_sphere(body, radius=rng.uniform(0.05, 0.2))
+
+            # shapes of the two environments only collide with the shapes outside of any environment
+            builder = ModelBuilder()
+            add_spheres(builder, 20)
+            for _ in range(2):
+                env = ModelBuilder()
+                add_spheres(env, 20)
+                builder.add_builder(env)
+            builder.shape_collision_filter_pairs.add((1, 0))
+            builder.dynamic_broadphase = True
+
+            model = builder.finalize()
+
+            found = model.shape_contact_pair_found.numpy()[0]
+            self.assertLessEqual(found, model.shape_contact_pair_count)
+            dynamic = set(map(tuple, model.shape_contact_pairs.numpy()[:found]))
+            self.assertTrue(np.all(model.shape_contact_pairs.numpy()[found:] == -1))
+
+            # the precomputed pairs whose bounds overlap
+            model.dynamic_broadphase = False
+            model.find_shape_contact_pairs()
+
+            shape_body = model.shape_body.numpy()
+            p = model.shape_transform.numpy()[:, :3] + np.where(
+                shape_body[:, None] >= 0, model.body_q.numpy()[shape_body, :3], 0.0
+            )
+            h = 2.0 * model.shape_collision_radius.numpy() + model.rigid_contact_margin + 0.1
+            expected = {
+                (a, b)
+                for a, b in model.shape_contact_pairs.numpy()
+                if np.all(np.abs(p[a] - p[b]) <= h[a] + h[b])
+            }
+
+            self.assertGreater(len(expected), 0)
+            self.assertNotIn((0, 1), dynamic)
+            self.assertEqual(dynamic, expected)
+
+        def test_soft_contact_broadphase(self):
+            rng = np.random.default_rng(42)
+
+            builder = ModelBuilder()
+            for x in rng.uniform(-1.0, 1.0, (1000, 3)):
+                builder.add_particle(x, (0.0, 0.0, 0.0), 1.0, radius=0.05)
+            for _ in range(10):
+                builder.add_shape_sphere(-1, pos=rng.uniform(-1.0, 1.0, 3), radius=rng.uniform(0.05, 0.3))
+                builder.add_shape_box(-1, pos=rng.uniform(-1.0, 1.0, 3), hx=0.2, hy=0.1, hz=0.3)
+            model = builder.finalize()
+            model.soft_contact_margin = 0.05
+            state = model.state()
+
+            def soft_contacts(broadphase):
+                model.soft_contact_broadphase = broadphase
+                wp.sim.collide(model, state)
+                count = model.soft_contact_count.numpy()[0]
+                self.assertLessEqual(count, model.soft_contact_max)
+                particles = model.soft_contact_particle.numpy()[:count]
+                shapes = model.soft_contact_shape.numpy()[:count]
+                return set(zip(particles, shapes))
+
+            # the broadphase only skips the pairs that are out of contact
+            expected = soft_contacts(False)
+            self.assertTrue(model.use_soft_contact_broadphase())
+            self.assertGreater(len(expected), 0)
+            self.assertEqual(soft_contacts(True), expected)
+            self.assertLessEqual(model.soft_contact_pair_found.numpy()[0], model.soft_contact_pair_max)
+
+        def test_compact_soft_contacts(self):
+            rng = np.random.default_rng(42)
+
+            builder = ModelBuilder()
+            for x in rng.uniform(-1.0, 1.0, (1000, 3)):
+                builder.add_particle(x, (0.0, 0.0, 0.0), 1.0, radius=0.05)
+            for _ in range(10):
+                builder.add_shape_sphere(-1, pos=rng.uniform(-1.0, 1.0, 3), radius=rng.uniform(0.05, 0.3))
+                builder.add_shape_capsule(-1, pos=rng.uniform(-1.0, 1.0, 3), radius=0.1, half_height=0.3)
+            model = builder.finalize()
+
+            builder.soft_contact_max = 16
+            builder.soft_contact_compact = True
+            builder.soft_contact_dynamic = True
+            compact = builder.finalize()
+            self.assertEqual(compact.soft_contact_shape.dtype, wp.uint16)
+            self.assertEqual(compact.soft_contact_normal.dtype, wp.vec2h)
+
+            state = model.state()
+            wp.sim.collide(model, state, deterministic=True)
+            wp.sim.collide(compact, state, deterministic=True)
+
+            # the buffers grew to the next power of two of the contact count
+            count = model.soft_contact_count.numpy()[0]
+            self.assertGreater(count, 16)
+            self.assertEqual(compact.soft_contact_count.numpy()[0], count)
+            self.assertEqual(compact.soft_contact_max, 1 << (int(count) - 1).bit_length())
+
+            assert_np_equal(compact.soft_contact_particle.numpy()[:count], model.soft_contact_particle.numpy()[:count])
+            assert_np_equal(compact.soft_contact_shape.numpy()[:count], model.soft_contact_shape.numpy()[:count])
+            assert_np_equal(compact.soft_contact_body_pos.numpy()[:count], model.soft_contact_body_pos.numpy()[:count])
+
+            normals = wp.empty(compact.soft_contact_max, dtype=wp.vec3, device=compact.device)
+            wp.launch(
+                decode_contact_normals,
+                dim=compact.soft_contact_max,
+                inputs=[compact.soft_contact_normal, normals],
+                device=compact.device,
+            )
+            assert_np_equal(normals.numpy()[:count], model.soft_contact_normal.numpy()[:count], tol=5.0e-3)
+
+        def test_color_constraints(self):
+            builder = ModelBuilder()
+            builder.add_cloth_grid(
+                pos=(0.0, 1.0, 0.0),
+                rot=wp.quat_identity(),
+                vel=(0.0, 0.0, 0.0),
+                dim_x=6,
+                dim_y=5,
+                cell_x=0.1,
+                cell_y=0.1,
+                mass=0.1,
+                fix_left=True,
+                add_springs=True,
+            )
+            builder.constraint_coloring = True
+            model = builder.finalize()
+
+            movable = model.particle_inv_mass.numpy() > 0.0
+
+            def check_colors(colors, indices):
+                ids = np.concatenate([c.numpy() for c in colors])
+                # every constraint is in exactly one color
+                assert_np_equal(np.sort(ids), np.arange(len(indices)))
+                for c in colors:
+                    nodes = indices[c.numpy()].flatten()
+                    nodes = nodes[(nodes >= 0) & movable[np.maximum(nodes, 0)]]
+                    self.assertEqual(len(nodes), len(np.unique(nodes)))
+
+            check_colors(model.spring_colors, model.spring_indices.numpy().reshape(-1, 2))
+            check_colors(model.edge_colors, model.edge_indices.numpy())
+            self.assertEqual(model.tet_colors, [])
+            self.assertEqual(model.joint_colors, [])
+
+            # the colored Gauss-Seidel solve runs and keeps the fixed particles in place
+            integrator = wp.sim.XPBDIntegrator(iterations=2, gauss_seidel=True)
+            state_0, state_1 = model.state(), model.state()
+            for _ in range(4):
+                state_0.clear_forces()
+                integrator.simulate(model, state_0, state_1, 1.0 / 60.0)
+                state_0, state_1 = state_1, state_0
+            q = state_0.particle_q.numpy()
+            self.assertTrue(np.all(np.isfinite(q)))
+            assert_np_equal(q[~movable], model.particle_q.numpy()[~movable], tol=1e-6)
+
+        def test_fused_particle_forces(self):
+            builder = ModelBuilder()
+            builder.add_cloth_grid(
+                pos=(0.0, 0.02, 0.0),
+                rot=wp.quat_from_axis_angle((1.0, 0.0, 0.0), 0.3),
+                vel=(0.0, 0.0, 0.0),
+                dim_x=4,
+                dim_y=4,
+                cell_x=0.1,
+                cell_y=0.1,
+                mass=0.1,
+                add_springs=True,
+            )
+            builder.add_soft_grid(
+                pos=(1.0, 0.05, 0.0),
+                rot=wp.quat_identity(),
+                vel=(0.0, 0.0, 0.0),
+                dim_x=2,
+                dim_y=2,
+                dim_z=2,
+                cell_x=0.1,
+                cell_y=0.1,
+                cell_z=0.1,
+                density=100.0,
+                k_mu=1000.0,
+                k_lambda=1000.0,
+                k_damp=1.0,
+            )
+            model = builder.finalize()
+            model.ground = True
+
+            # the fused force kernel and a captured substep sequence match the separate launches
+            results = []
+            for fused in (False, True):
+                integrator = wp.sim.SemiImplicitIntegrator(fuse_particle_forces=fused)
+                state_0, state_1 = model.state(), model.state()
+                integrator.simulate_substeps(model, state_0, state_1, 1.0e-3, substeps=5)
+                results.append(state_0.particle_q.numpy())
+
+            self.assertFalse(np.allclose(results[0], model.particle_q.numpy()))
+            assert_np_equal(results[1], results[0], tol=1e-5)
+
+            if wp.get_device(model.device).is_cuda:
+                state_0, state_1 = model.state(), model.state()
+                graph = integrator.capture_substeps(model, state_0, state_1, 1.0e-3, substeps=5)
+                wp.capture_launch(graph)
+                assert_np_equal(state_0.particle_q.numpy(), results[1], tol=1e-5)
+
+        def test_rigid_contact_reduction(self):
+            def build(reduction, cache):
+                builder = ModelBuilder()
+                b0 = builder.add_body(origin=wp.transform((0.0, 0.5, 0.0), wp.quat_identity()))
+                builder.add_shape_box(b0, has_ground_collision=False)
+                b1 = builder.add_body(
+                    origin=wp.transform((0.1, 1.45, 0.05), wp.quat_from_axis_angle((0.0, 1.0, 0.0), 0.3))
+                )
+                builder.add_shape_box(b1, has_ground_collision=False)
+                builder.rigid_contact_reduction = reduction
+                builder.rigid_contact_cache = cache
+                model = builder.finalize()
+                model.ground = False
+                return model
+
+            def active_contacts(model):
+                count = model.rigid_contact_count.numpy()[0]
+                shape0 = model.rigid_contact_shape0.numpy()[:count]
+                active = np.flatnonzero(shape0 != model.rigid_contact_shape1.numpy()[:count])
+                body_q = model.body_q.numpy()
+
+                def to_world(bodies, points):
+                    xforms = [wp.transform(body_q[b, :3], body_q[b, 3:]) for b in bodies]
+                    return np.array([wp.transform_point(X, p) for X, p in zip(xforms, points)])
+
+                p0 = to_world(model.rigid_contact_body0.numpy()[active], model.rigid_contact_point0.numpy()[active])
+                p1 = to_world(model.rigid_contact_body1.numpy()[active], model.rigid_contact_point1.numpy()[active])
+                depth = np.sum(model.rigid_contact_normal.numpy()[active] * (p0 - p1), axis=1)
+                return active, depth
+
+            model = build(False, False)
+            wp.sim.collide(model, model.state())
+            full, full_depth = active_contacts(model)
+            self.assertGreater(len(full), 4)
+
+            # the reduced manifold keeps the deepest contact
+            model = build(True, False)
+            wp.sim.collide(model, model.state())
+            reduced, reduced_depth = active_contacts(model)
+            self.assertEqual(len(reduced), 4)
+            self.assertAlmostEqual(reduced_depth.min(), full_depth.min(), places=5)
+
+            # contacts of a pair that did not move are reused instead of going through the narrow phase
+            model = build(True, True)
+            state = model.state()
+            wp.sim.collide(model, state)
+            first, first_depth = active_contacts(model)
+            self.assertEqual(model.rigid_contact_pair_skip.numpy()[0], 0)
+            wp.sim.collide(model, state)
+            second, second_depth = active_contacts(model)
+            self.assertEqual(model.rigid_contact_pair_skip.numpy()[0], 1)
+            self.assertEqual(len(second), 4)
+            assert_np_equal(np.sort(second_depth), np.sort(first_depth), tol=1e-5)
+
+        def test_env_layout(self):
+            env = ModelBuilder()
+            b0 = env.add_body(origin=wp.transform((0.0, 1.0, 0.0), wp.quat_identity()))
+            b1 = env.add_body(origin=wp.transform((0.0, 2.0, 0.0), wp.quat_identity()))
+            env.add_shape_box(b0, hx=0.1, hy=0.1, hz=0.1)
+            env.add_joint_revolute(-1, b0, wp.transform_identity(), wp.transform_identity(), (0.0, 0.0, 1.0))
+            env.add_joint_revolute(b0, b1, wp.transform_identity(), wp.transform_identity(), (0.0, 0.0, 1.0))
+
+            builder = ModelBuilder()
+            builder.add_shape_sphere(-1, radius=0.5)
+            for i in range(3):
+                builder.add_builder(env, xform=wp.transform((float(i), 0.0, 0.0), wp.quat_identity()))
+            model = builder.finalize()
+
+            self.assertEqual(model.env_layout["body"], (0, 2))
+            self.assertEqual(model.env_layout["shape"], (1, 1))
+            self.assertEqual(model.env_layout["joint_coord"], (0, 2))
+
+            state = model.state()
+            body_q = model.env_view(state.body_q, "body")
+            self.assertEqual(body_q.shape, (3, 2))
+            assert_np_equal(body_q.numpy(), state.body_q.numpy().reshape(3, 2, 7))
+
+            # resetting an environment restores only its bodies and joints
+            state.body_q.fill_(wp.transform((5.0, 5.0, 5.0), wp.quat_identity()))
+            state.joint_q.fill_(1.0)
+            model.reset_envs(state, wp.array([2, 0], dtype=int, device=model.device))
+
+            initial = model.body_q.numpy().reshape(3, 2, 7)
+            body_q = model.env_view(state.body_q, "body").numpy()
+            assert_np_equal(body_q[0], initial[0])
+            assert_np_equal(body_q[2], initial[2])
+            assert_np_equal(body_q[1, :, :3], np.full((2, 3), 5.0))
+            assert_np_equal(model.env_view(state.joint_q, "joint_coord").numpy()[:, 0], np.array([0.0, 1.0, 0.0]))
+
+        def test_state_snapshot(self):
+            env = ModelBuilder()
+            b0 = env.add_body(origin=wp.transform((0.0, 1.0, 0.0), wp.quat_identity()))
+            env.add_shape_box(b0, hx=0.1, hy=0.1, hz=0.1)
+            env.add_joint_revolute(-1, b0, wp.transform_identity(), wp.transform_identity(), (0.0, 0.0, 1.0))
+
+            builder = ModelBuilder()
+            builder.add_particle((0.0, 0.0, 0.0), (1.0, 0.0, 0.0), 1.0)
+            for i in range(3):
+                builder.add_builder(env, xform=wp.transform((float(i), 0.0, 0.0), wp.quat_identity()))
+            model = builder.finalize()
+
+            # the arrays of a state share one allocation
+            state = model.state(requires_grad=True)
+            self.assertIs(state.body_q._ref, state.particle_q._ref)
+            self.assertIs(state.body_q.grad._ref, state.joint_qd.grad._ref)
+            assert_np_equal(state.body_q.numpy(), model.body_q.numpy())
+            assert_np_equal(state.particle_qd.numpy(), model.particle_qd.numpy())
+            assert_np_equal(state.body_f.numpy(), np.zeros((3, 6)))
+
+            snapshot = state.clone()
+            self.assertNotEqual(snapshot.body_q.ptr, state.body_q.ptr)
+            self.assertTrue(snapshot.body_q.requires_grad)
+
+            state.body_q.fill_(wp.transform((5.0, 5.0, 5.0), wp.quat_identity()))
+            state.joint_q.fill_(1.0)
+            state.particle_q.fill_(2.0)
+
+            # restoring environments copies only their bodies and joints
+            model.restore_envs(state, snapshot, wp.array([1], dtype=int, device=model.device))
+            body_q = state.body_q.numpy()
+            assert_np_equal(body_q[1], model.body_q.numpy()[1])
+            assert_np_equal(body_q[0, :3], np.full(3, 5.0))
+            assert_np_equal(state.joint_q.numpy(), np.array([1.0, 0.0, 1.0]))
+            assert_np_equal(state.particle_q.numpy(), np.full((1, 3), 2.0))
+
+            # restoring the whole state
+            state.assign(snapshot)
+            assert_np_equal(state.body_q.numpy(), model.body_q.numpy())
+            assert_np_equal(state.joint_q.numpy(), np.zeros(3))
+            assert_np_equal(state.particle_q.numpy(), model.particle_q.numpy())
+
+        def test_joint_levels(self):
+            builder = ModelBuilder(composite_rigid_body_alg=True)
+            # a chain of four links and a root with two children
+            for links in ((4,), (1, 1)):
+                builder.add_articulation()
+                root = builder.add_body(origin=wp.transform_identity())
+                builder.add_shape_box(root, hx=0.1, hy=0.1, hz=0.1)
+                builder.add_joint_revolute(-1, root, wp.transform_identity(), wp.transform_identity(), (0.0, 0.0, 1.0))
+                for count in links:
+                    parent = root
+                    for i in range(count):
+                        body = builder.add_body(origin=wp.transform_identity())
+                        builder.add_shape_box(body, hx=0.1, hy=0.1, hz=0.1)
+                        builder.add_joint_revolute(
+                            parent, body, wp.transform((0.0, 0.2, 0.0), wp.quat_identity()), wp.transform_identity(),
+                            (0.0, 0.0, 1.0),
+                        )
+                        parent = body
+            builder.joint_q = [0.1 * (i + 1) for i in range(builder.joint_coord_count)]
+            model = builder.finalize()
+
+            self.assertEqual(model.joint_level_count, 5)
+            self.assertEqual(model.joint_level_start, [0, 2, 5, 6, 7, 8])
+            assert_np_equal(model.joint_level_joints.numpy(), np.array([0, 5, 1, 6, 7, 2, 3, 4]))
+
+            # the level-parallel kinematics match the serial ones
+            states = []
+            for level_parallel in (False, True):
+                state = model.state()
+                integrator = wp.sim.SemiImplicitArticulationIntegrator(level_parallel=level_parallel)
+                integrator.eval_rigid_fk(model, state)
+                integrator.eval_rigid_id(model, state)
+                states.append(state)
+
+            for name in ("body_X_sc", "body_X_sm", "body_v_s", "body_I_s", "joint_S_s"):
+                assert_np_equal(getattr(states[0], name).numpy(), getattr(states[1], name).numpy(), tol=1e-6)
+
+        def test_body_sleep(self):
+            builder = ModelBuilder(gravity=0.0)
+            builder.body_sleep = True
+            builder.body_sleep_time = 0.5
+            bodies = [builder.add_body(origin=wp.transform((float(i), 1.0, 0.0), wp.quat_identity())) for i in range(4)]
+            builder.add_joint_revolute(
+                bodies[0], bodies[1], wp.transform_identity(), wp.transform_identity(), (0.0, 0.0, 1.0)
+            )
+            model = builder.finalize()
+            model.ground = False
+
+            # the jointed bodies share an island
+            assert_np_equal(model.body_island.numpy(), np.array([0, 0, 1, 2]))
+
+            state_0, state_1 = model.state(), model.state()
+            qd = state_0.body_qd.numpy()
+            qd[3] = (0.0, 0.0, 0.0, 1.0, 0.0, 0.0)
+            state_0.body_qd.assign(qd)
+
+            integrator = wp.sim.SemiImplicitIntegrator()
+            dt = 0.1
+            for _ in range(7):
+                state_0.clear_forces()
+                integrator.simulate(model, state_0, state_1, dt)
+                state_0, state_1 = state_1, state_0
+
+            # only the moving body is still integrated
+            self.assertEqual(model.body_active_count.numpy()[0], 1)
+            self.assertEqual(model.body_active_indices.numpy()[0], 3)
+            self.assertAlmostEqual(state_0.body_q.numpy()[3, 0], 3.7, places=4)
+
+            # woken islands are integrated again
+            model.island_wake.fill_(1)
+            integrator.simulate(model, state_0, state_1, dt)
+            self.assertEqual(model.body_active_count.numpy()[0], 4)
+
+        def test_finalize_replicated(self):
+            def build_env():
+                env = ModelBuilder()
+                env.add_articulation()
+                b0 = env.add_body(origin=wp.transform((0.0, 1.0, 0.0), wp.quat_identity()))
+                b1 = env.add_body(origin=wp.transform((0.0, 2.0, 0.0), wp.quat_identity()))
+                b2 = env.add_body(origin=wp.transform((1.0, 1.0, 0.0), wp.quat_identity()))
+                for b in (b0, b1, b2):
+                    env.add_shape_box(b, hx=0.1, hy=0.1, hz=0.1)
+                env.add_shape_sphere(-1, pos=(0.0, 0.5, 0.0), radius=0.2)
+                X = wp.transform((0.0, 1.0, 0.0), wp.quat_identity())
+                env.add_joint_revolute(-1, b0, X, wp.transform_identity(), (0.0, 0.0, 1.0))
+                env.add_joint_revolute(b0, b1, X, wp.transform_identity(), (0.0, 0.0, 1.0))
+                env.add_joint_free(b2, parent_xform=wp.transform((1.0, 1.0, 0.0), wp.quat_identity()))
+                return env
+
+            num_envs = 3
+            xforms = [wp.transform((2.0 * i, 0.0, 0.0), wp.quat_rpy(0.0, 0.3 * i, 0.0)) for i in range(num_envs)]
+
+            builder = ModelBuilder()
+            for i in range(num_envs):
+                builder.add_builder(build_env(), xform=xforms[i])
+            expected = builder.finalize()
+            model = build_env().finalize_replicated(num_envs, xforms)
+
+            self.assertEqual(model.env_layout, expected.env_layout)
+            for attr in ("body_count", "shape_count", "joint_count", "joint_coord_count", "articulation_count"):
+                self.assertEqual(getattr(model, attr), getattr(expected, attr))
+            self.assertEqual(model.rigid_contact_max, expected.rigid_contact_max)
+
+            for attr in (
+                "joint_parent",
+                "joint_child",
+                "joint_q_start",
+                "joint_qd_start",
+                "joint_axis_start",
+                "articulation_start",
+                "shape_body",
+                "body_mass",
+            ):
+                assert_np_equal(getattr(model, attr).numpy(), getattr(expected, attr).numpy())
+            for attr in ("joint_X_p", "joint_q", "shape_transform"):
+                assert_np_equal(getattr(model, attr).numpy(), getattr(expected, attr).numpy(), tol=1e-5)
+            assert_np_equal(model.shape_geo.scale.numpy(), expected.shape_geo.scale.numpy())
+
+            def pairs(a):
+                return sorted(map(tuple, a.numpy().tolist()))
+
+            self.assertEqual(pairs(model.shape_contact_pairs), pairs(expected.shape_contact_pairs))
+            self.assertEqual(pairs(model.shape_ground_contact_pairs), pairs(expected.shape_ground_contact_pairs))
+
+            # the bodies end up at the same poses once the joints are evaluated
+            for m in (model, expected):
+                m.state_fk = m.state()
+                wp.sim.eval_fk(m, m.joint_q, m.joint_qd, None, m.state_fk)
+            assert_np_equal(model.state_fk.body_q.numpy(), expected.state_fk.body_q.numpy(), tol=1e-5)
+
+        def test_implicit_euler(self):
+            builder = ModelBuilder()
+            builder.add_particle((0.0, 0.0, 0.0), (0.0, 0.0, 0.0), 0.0)
+            builder.add_particle((0.0, -1.0, 0.0), (0.0, 0.0, 0.0), 1.0)
+            builder.add_spring(0, 1, 1.0e6, 10.0, 0.0)
+            model = builder.finalize()
+            model.ground = False
+
+            # the step is far beyond the stability limit of explicit integration for this stiffness
+            dt = 0.01
+            integrator = wp.sim.ImplicitEulerIntegrator(model)
+            state_0, state_1 = model.state(), model.state()
+            for _ in range(100):
+                state_0.clear_forces()
+                integrator.simulate(model, state_0, state_1, dt)
+                state_0, state_1 = state_1, state_0
+
+            x = state_0.particle_q.numpy()
+            assert_np_equal(x[0], np.zeros(3))
+            self.assertTrue(np.all(np.isfinite(x)))
+            # the spring stretches by m g / ke under gravity
+            assert_np_equal(x[1], np.array([0.0, -1.0 - 9.80665e-6, 0.0]), tol=1e-4)
+
+        def test_particle_ccd(self):
+            builder = ModelBuilder()
+            for pos in [(-1.0, 0.0, -1.0), (1.0, 0.0, -1.0), (0.0, 0.0, 1.0)]:
+                builder.add_particle(pos, (0.0, 0.0, 0.0), 0.0)
+            builder.add_triangle(0, 1, 2)
+            builder.add_particle((0.0, 1.0, 0.0), (0.0, 0.0, 0.0), 1.0)
+            builder.add_particle((5.0, 1.0, 0.0), (0.0, 0.0, 0.0), 1.0)
+            model = builder.finalize()
+
+            # the first free particle tunnels through the triangle within one step, the second one misses it
+            state_in, state_out = model.state(), model.state()
+            x1 = state_in.particle_q.numpy()
+            x1[3:, 1] = -1.0
+            state_out.particle_q.assign(x1)
+
+            dt = 0.1
+            thickness = 0.01
+            integrator = wp.sim.TOIIntegrator()
+            integrator.advance_particles(model, state_in, state_out, dt, thickness)
+
+            toi = integrator.particle_toi.numpy()
+            self.assertAlmostEqual(toi[3], 0.5 - 0.5 * thickness, places=4)
+            self.assertEqual(toi[4], 1.0)
+
+            x = state_out.particle_q.numpy()
+            self.assertAlmostEqual(x[3, 1], thickness, places=4)
+            self.assertEqual(x[4, 1], -1.0)
+            assert_np_equal(state_out.particle_qd.numpy()[3], np.array([0.0, (thickness - 1.0) / dt, 0.0]), tol=1e-3)
+
+        def test_mesh_cache(self):
+            try:
+                import trimesh  # noqa: F401
+            except ImportError:
+                self.skipTest("trimesh is not installed")
+
+            import tempfile
+
+            with tempfile.TemporaryDirectory() as tmpdir:
+                filename = os.path.join(tmpdir, "tet.obj")
+                with open(filename, "w") as f:
+                    f.write("v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\nf 1 3 2\nf 1 2 4\nf 1 4 3\nf 2 3 4\n")
+
+                cache_dir = os.path.join(tmpdir, "cache")
+                cache = wp.sim.MeshCache(cache_dir=cache_dir)
+                cache.prefetch([(filename, (2.0, 2.0, 2.0)), (filename, (1.0, 1.0, 1.0))])
+                meshes = cache.load(filename, (2.0, 2.0, 2.0))
+                self.assertEqual(len(meshes), 1)
+                self.assertIs(cache.load(filename, (2.0, 2.0, 2.0))[0], meshes[0])
+                self.assertEqual(len(os.listdir(cache_dir)), 2)
+                self.assertAlmostEqual(np.max(meshes[0].vertices), 2.0)
+
+                # a new cache reads the preprocessed mesh and its inertia back from the cache directory
+                cached = wp.sim.MeshCache(cache_dir=cache_dir).load(filename, (2.0, 2.0, 2.0))[0]
+                assert_np_equal(np.array(cached.vertices), np.array(meshes[0].vertices))
+                assert_np_equal(np.array(cached.indices), np.array(meshes[0].indices))
+                self.assertAlmostEqual(cached.mass, meshes[0].mass, places=5)
+                assert_np_equal(np.array(cached.I), np.array(meshes[0].I), tol=1e-6)
+
+            # shapes sharing a mesh share its finalized buffers
+            builder = ModelBuilder()
+            for i in range(3):
+                body = builder.add_body(origin=wp.transform((float(i), 1.0, 0.0), wp.quat_identity()))
+                builder.add_shape_mesh(body, mesh=meshes[0])
+            model = builder.finalize()
+            self.assertEqual(len(set(model.shape_geo.source.numpy()[:3])), 1)
+
     return TestModel
 
 
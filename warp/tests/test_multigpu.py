@@ -167,16 +167,239 @@ def test_multigpu_pingpong_streams(test, device):
     assert_np_equal(a1.numpy(), expected)
 
 
+def test_multigpu_capture(test, device):
+    assert len(wp.get_cuda_devices()) > 1, "At least two CUDA devices are required"
+
+    n = 1024
+
+    a0 = wp.zeros(n, dtype=float, device="cuda:0")
+    a1 = wp.zeros(n, dtype=float, device="cuda:1")
+
+    stream0 = wp.get_stream("cuda:0")
+    stream1 = wp.get_stream("cuda:1")
+
+    # force module load before capture
+    wp.load_module(device="cuda:0")
+    wp.load_module(device="cuda:1")
+
+    wp.capture_begin(device="cuda:0", peers=["cuda:1"], force_module_load=False)
+    try:
+        test.assertTrue(wp.get_device("cuda:1").is_capturing)
+
+        wp.launch(inc, dim=n, inputs=[a0], stream=stream0)
+        stream1.wait_stream(stream0)
+        wp.copy(a1, a0, stream=stream1)
+        wp.launch(inc, dim=n, inputs=[a1], stream=stream1)
+        stream0.wait_stream(stream1)
+        wp.copy(a0, a1, stream=stream0)
+    finally:
+        graph = wp.capture_end(device="cuda:0")
+
+    test.assertFalse(wp.get_device("cuda:1").is_capturing)
+
+    # the work of both devices is replayed by a single launch
+    iters = 3
+    for _ in range(iters):
+        wp.capture_launch(graph)
+
+    wp.synchronize()
+
+    expected = np.full(n, iters * 2, dtype=np.float32)
+    assert_np_equal(a0.numpy(), expected)
+    assert_np_equal(a1.numpy(), expected)
+
+    with test.assertRaises(RuntimeError):
+        wp.capture_begin(device="cuda:0", peers=[stream0])
+
+
+def test_multigpu_launch_multi(test, device):
+    assert len(wp.get_cuda_devices()) > 1, "At least two CUDA devices are required"
+
+    devices = wp.get_cuda_devices()
+    n = 1024
+
+    # one shard per device, each with a different start value
+    shards = [wp.empty(n, dtype=int, device=d) for d in devices]
+    wp.launch_multi(arange, dims=[n] * len(devices), inputs=[[i, 1, a] for i, a in enumerate(shards)], devices=devices)
+
+    for i, a in enumerate(shards):
+        assert_np_equal(a.numpy(), np.arange(i, i + n, dtype=int))
+
+    # the arrays must be on the device they are launched on
+    with test.assertRaises(RuntimeError):
+        wp.launch_multi(arange, dims=[n, n], inputs=[[0, 1, shards[1]], [0, 1, shards[0]]], devices=devices[:2])
+
+    # all-reduce the shards, every device holds the sum afterwards
+    grads = [wp.array(np.full(n, i + 1.0, dtype=np.float32), dtype=float, device=d) for i, d in enumerate(devices)]
+    wp.launch_multi(inc, dims=[n] * len(devices), inputs=[[g] for g in grads], devices=devices)
+    wp.utils.array_all_reduce(grads)
+
+    expected = sum(i + 2.0 for i in range(len(devices)))
+    for g in grads:
+        assert_np_equal(g.numpy(), np.full(n, expected, dtype=np.float32))
+
+    # gather the shards on the first device
+    gathered = wp.zeros(n * len(devices), dtype=int, device=devices[0])
+    wp.utils.array_gather(shards, gathered)
+    assert_np_equal(gathered.numpy(), np.concatenate([np.arange(i, i + n) for i in range(len(devices))]))
+
+
+@wp.kernel
+def clone_mesh_raycast(mesh: wp.uint64, ray_starts: wp.array(dtype=wp.vec3), ray_t: wp.array(dtype=float)):
+    tid = wp.tid()
+
+    t = float(0.0)
+    u = float(0.0)
+    v = float(0.0)
+    sign = float(0.0)
+    n = wp.vec3()
+    f = int(0)
+
+    ray_t[tid] = -1.0
+    if wp.mesh_query_ray(mesh, ray_starts[tid], wp.vec3(0.0, 0.0, -1.0), 1.0e6, t, u, v, sign, n, f):
+        ray_t[tid] = t
+
+
+@wp.kernel
+def clone_bvh_query(bvh: wp.uint64, lower: wp.vec3, upper: wp.vec3, hits: wp.array(dtype=int)):
+    query = wp.bvh_query_aabb(bvh, lower, upper)
+    bounds_nr = int(0)
+
+    while wp.bvh_query_next(query, bounds_nr):
+        hits[bounds_nr] = 1
+
+
+@wp.kernel
+def clone_volume_lookup(volume: wp.uint64, values: wp.array3d(dtype=float)):
+    i, j, k = wp.tid()
+    values[i, j, k] = wp.volume_lookup_f(volume, i, j, k)
+
+
+def test_multigpu_clone(test, device):
+    assert len(wp.get_cuda_devices()) > 1, "At least two CUDA devices are required"
+
+    src, dst = "cuda:0", "cuda:1"
+
+    # height field of two triangles per cell
+    res = 8
+    x, y = np.meshgrid(np.linspace(0.0, 1.0, res + 1), np.linspace(0.0, 1.0, res + 1), indexing="ij")
+    vertices = np.stack((x, y, 0.25 * x + 0.5 * y), axis=-1).reshape(-1, 3)
+    triangles = []
+    for i in range(res):
+        for j in range(res):
+            a = i * (res + 1) + j
+            b = a + res + 1
+            triangles.extend([a, b, a + 1, a + 1, b, b + 1])
+
+    points = wp.array(vertices, dtype=wp.vec3, device=src)
+    indices = wp.array(triangles, dtype=int, device=src)
+    mesh = wp.Mesh(points=points, indices=indices, wide_bvh=True, level_refit=True, reorder=True)
+    wp.synchronize_device(src)
+
+    mesh_clone = mesh.clone(dst)
+    test.assertEqual(mesh_clone.device, dst)
+    test.assertEqual(mesh_clone.points.device, dst)
+    test.assertEqual(mesh_clone.triangle_permutation.device, dst)
+    assert_np_equal(mesh_clone.triangle_permutation.numpy(), mesh.triangle_permutation.numpy())
+    test.assertIsNone(mesh_clone.point_permutation)
+
+    rng = np.random.default_rng(42)
+    starts = np.concatenate((rng.uniform(0.05, 0.95, size=(64, 2)), np.full((64, 1), 2.0)), axis=1)
+
+    results = []
+    for m in (mesh, mesh_clone):
+        ray_t = wp.empty(len(starts), dtype=float, device=m.device)
+        ray_starts = wp.array(starts, dtype=wp.vec3, device=m.device)
+        wp.launch(clone_mesh_raycast, dim=len(starts), inputs=[m.id, ray_starts, ray_t], device=m.device)
+        results.append(ray_t.numpy())
+
+    assert_np_equal(results[1], results[0])
+    assert_np_equal(results[1], 2.0 - 0.25 * starts[:, 0] - 0.5 * starts[:, 1], tol=1.0e-5)
+
+    # refits of the clone use its own copy of the points
+    mesh_clone.points.assign(mesh_clone.points.numpy() + np.array([0.0, 0.0, 1.0]))
+    mesh_clone.refit()
+    ray_t = wp.empty(len(starts), dtype=float, device=dst)
+    ray_starts = wp.array(starts, dtype=wp.vec3, device=dst)
+    wp.launch(clone_mesh_raycast, dim=len(starts), inputs=[mesh_clone.id, ray_starts, ray_t], device=dst)
+    assert_np_equal(ray_t.numpy(), results[0] - 1.0, tol=1.0e-5)
+
+    # bvh over the triangle bounds
+    tris = vertices[np.array(triangles).reshape(-1, 3)]
+    lowers = wp.array(tris.min(axis=1), dtype=wp.vec3, device=src)
+    uppers = wp.array(tris.max(axis=1), dtype=wp.vec3, device=src)
+    bvh = wp.Bvh(lowers, uppers, wide=True)
+    wp.synchronize_device(src)
+
+    bvh_clone = bvh.clone(dst)
+
+    hits = []
+    for b in (bvh, bvh_clone):
+        h = wp.zeros(len(tris), dtype=int, device=b.device)
+        wp.launch(
+            clone_bvh_query, dim=1, inputs=[b.id, wp.vec3(0.2, 0.2, -1.0), wp.vec3(0.4, 0.6, 1.0), h], device=b.device
+        )
+        hits.append(h.numpy())
+
+    test.assertGreater(hits[0].sum(), 0)
+    assert_np_equal(hits[1], hits[0])
+
+    # sparse volume
+    values = np.zeros((16, 16, 16), dtype=np.float32)
+    values[2:10, 3:7, 4:12] = np.arange(8 * 4 * 8, dtype=np.float32).reshape(8, 4, 8)
+    volume = wp.Volume.load_from_dense(wp.array(values, dtype=float, device=src))
+    wp.synchronize_device(src)
+
+    volume_clone = volume.clone(dst)
+    test.assertNotEqual(volume_clone.id, 0)
+
+    lookup = wp.empty(values.shape, dtype=float, device=dst)
+    wp.launch(clone_volume_lookup, dim=values.shape, inputs=[volume_clone.id, lookup], device=dst)
+    assert_np_equal(lookup.numpy(), values)
+
+
+def test_multigpu_visible_devices(test, device):
+    import os
+
+    saved_config = wp.config.cuda_visible_devices
+    saved_env = os.environ.pop("WARP_CUDA_DEVICES", None)
+
+    try:
+        test.assertEqual(wp.context.get_visible_cuda_ordinals(4), [0, 1, 2, 3])
+
+        os.environ["WARP_CUDA_DEVICES"] = "3, 1"
+        test.assertEqual(wp.context.get_visible_cuda_ordinals(4), [1, 3])
+
+        # the config takes precedence over the environment
+        wp.config.cuda_visible_devices = [2]
+        test.assertEqual(wp.context.get_visible_cuda_ordinals(4), [2])
+
+        wp.config.cuda_visible_devices = [4]
+        with test.assertRaises(RuntimeError):
+            wp.context.get_visible_cuda_ordinals(4)
+    finally:
+        wp.config.cuda_visible_devices = saved_config
+        if saved_env is None:
+            os.environ.pop("WARP_CUDA_DEVICES", None)
+        else:
+            os.environ["WARP_CUDA_DEVICES"] = saved_env
+
+
 def register(parent):
     class TestMultigpu(parent):
         pass
 
+    add_function_test(TestMultigpu, "test_multigpu_visible_devices", test_multigpu_visible_devices)
+
     if wp.get_cuda_device_count() > 1:
         add_function_test(TestMultigpu, "test_multigpu_set_device", test_multigpu_set_device)
         add_function_test(TestMultigpu, "test_multigpu_scoped_device", test_multigpu_scoped_device)
         add_function_test(TestMultigpu, "test_multigpu_nesting", test_multigpu_nesting)
         add_function_test(TestMultigpu, "test_multigpu_pingpong", test_multigpu_pingpong)
         add_function_test(TestMultigpu, "test_multigpu_pingpong_streams", test_multigpu_pingpong_streams)
+        add_function_test(TestMultigpu, "test_multigpu_capture", test_multigpu_capture)
+        add_function_test(TestMultigpu, "test_multigpu_launch_multi", test_multigpu_launch_multi)
+        add_function_test(TestMultigpu, "test_multigpu_clone", test_multigpu_clone)
 
     return TestMultigpu
 
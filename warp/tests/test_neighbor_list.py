@@ -0,0 +1,119 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+num_points = 2048
+scale = 40.0
+radius = 1.5
+skin = 0.4
+
+
+@wp.kernel
+def count_neighbors(
+    neighbors: wp.uint64, radius: float, points: wp.array(dtype=wp.vec3), counts: wp.array(dtype=int)
+):
+    tid = wp.tid()
+
+    p = points[tid]
+    count = int(0)
+
+    for index in wp.neighbor_list_query(neighbors, tid):
+        if wp.length(p - points[index]) <= radius:
+            count += 1
+
+    counts[tid] = count
+
+
+@wp.kernel
+def count_list_sizes(neighbors: wp.uint64, counts: wp.array(dtype=int)):
+    tid = wp.tid()
+    counts[tid] = wp.neighbor_list_count(neighbors, tid)
+
+
+def count_neighbors_reference(points, radius):
+    d = np.linalg.norm(points[:, None, :] - points[None, :, :], axis=-1)
+    return np.sum(d <= radius, axis=1).astype(np.int32)
+
+
+def test_neighbor_list_query(test, device):
+    rng = np.random.default_rng(123)
+    points = (rng.random((num_points, 3)) * scale).astype(np.float32)
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+    neighbors = wp.NeighborList(radius, skin, device=device)
+    neighbors.build(points_arr)
+
+    counts = wp.zeros(num_points, dtype=int, device=device)
+    wp.launch(count_neighbors, dim=num_points, inputs=[neighbors.id, radius, points_arr, counts], device=device)
+    assert_np_equal(counts.numpy(), count_neighbors_reference(points, radius))
+
+    # the lists hold all points within the radius plus the skin
+    offsets = neighbors.get_offsets().numpy()
+    test.assertEqual(offsets[-1], neighbors.num_neighbors)
+    assert_np_equal(np.diff(offsets).astype(np.int32), count_neighbors_reference(points, radius + skin))
+
+    sizes = wp.zeros(num_points, dtype=int, device=device)
+    wp.launch(count_list_sizes, dim=num_points, inputs=[neighbors.id, sizes], device=device)
+    assert_np_equal(sizes.numpy(), np.diff(offsets).astype(np.int32))
+
+    lists = neighbors.get_neighbors().numpy()
+    for i in range(0, num_points, 97):
+        d = np.linalg.norm(points[lists[offsets[i] : offsets[i + 1]]] - points[i], axis=-1)
+        test.assertTrue(np.all(d <= radius + skin + 1.0e-5))
+
+
+def test_neighbor_list_update(test, device):
+    rng = np.random.default_rng(456)
+    points = (rng.random((num_points, 3)) * scale).astype(np.float32)
+    points_arr = wp.array(points, dtype=wp.vec3, device=device)
+
+    neighbors = wp.NeighborList(radius, skin, device=device)
+    test.assertTrue(neighbors.update(points_arr))
+
+    # moving every point by less than half the skin keeps the lists valid
+    moved = points + (rng.random((num_points, 3)) - 0.5).astype(np.float32) * 0.2 * skin
+    moved_arr = wp.array(moved, dtype=wp.vec3, device=device)
+    test.assertFalse(neighbors.update(moved_arr))
+
+    counts = wp.zeros(num_points, dtype=int, device=device)
+    wp.launch(count_neighbors, dim=num_points, inputs=[neighbors.id, radius, moved_arr, counts], device=device)
+    assert_np_equal(counts.numpy(), count_neighbors_reference(moved, radius))
+
+    # a single point moving further triggers a rebuild
+    moved[7] += np.array([skin, 0.0, 0.0], dtype=np.float32)
+    moved_arr = wp.array(moved, dtype=wp.vec3, device=device)
+    test.assertTrue(neighbors.needs_rebuild(moved_arr))
+    test.assertTrue(neighbors.update(moved_arr))
+    test.assertFalse(neighbors.needs_rebuild(moved_arr))
+
+    # so does a change of the number of points
+    test.assertTrue(neighbors.needs_rebuild(wp.array(moved[:100], dtype=wp.vec3, device=device)))
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestNeighborList(parent):
+        pass
+
+    add_function_test(TestNeighborList, "test_neighbor_list_query", test_neighbor_list_query, devices=devices)
+    add_function_test(TestNeighborList, "test_neighbor_list_update", test_neighbor_list_update, devices=devices)
+
+    return TestNeighborList
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -229,6 +229,96 @@ def test_adj_noise(test, device):
     test.assertTrue(err < 1.0e-8)
 
 
+@wp.kernel
+def fbm_loss_kernel(
+    kernel_seed: int,
+    octaves: int,
+    query_positions: wp.array(dtype=wp.vec3),
+    noise_values: wp.array(dtype=float),
+    noise_loss: wp.array(dtype=float),
+):
+    tid = wp.tid()
+    state = wp.rand_init(kernel_seed)
+
+    p = query_positions[tid]
+
+    n = wp.fbm(state, p, octaves, 2.0, 0.5)
+    noise_values[tid] = n
+
+    wp.atomic_add(noise_loss, 0, n)
+
+
+@wp.kernel
+def fbm_cd(
+    kernel_seed: int, octaves: int, query_positions: wp.array(dtype=wp.vec3), gradients: wp.array(dtype=wp.vec3)
+):
+    tid = wp.tid()
+    state = wp.rand_init(kernel_seed)
+    p = query_positions[tid]
+
+    eps = 1.0e-3
+    g = wp.vec3()
+
+    for i in range(3):
+        d = wp.vec3()
+        d[i] = eps
+        g[i] = (wp.fbm(state, p + d, octaves, 2.0, 0.5) - wp.fbm(state, p - d, octaves, 2.0, 0.5)) / (2.0 * eps)
+
+    gradients[tid] = g
+
+
+@wp.kernel
+def tnoise_kernel(kernel_seed: int, query_positions: wp.array(dtype=wp.vec3), noise_values: wp.array(dtype=float)):
+    tid = wp.tid()
+    state = wp.rand_init(kernel_seed)
+    p = query_positions[tid]
+
+    # a single octave of fbm is exactly the table noise
+    noise_values[tid] = wp.tnoise(state, p) - wp.fbm(state, p, 1, 2.0, 0.5)
+
+
+def test_fbm(test, device):
+    N = 256
+    seed = 42
+    octaves = 4
+
+    rng = np.random.default_rng(123)
+    positions = rng.uniform(-8.0, 8.0, size=(N, 3))
+
+    tape = wp.Tape()
+
+    with tape:
+        query_positions = wp.array(positions, dtype=wp.vec3, device=device, requires_grad=True)
+        noise_values = wp.zeros(N, dtype=float, device=device)
+        noise_loss = wp.zeros(n=1, dtype=float, device=device, requires_grad=True)
+
+        wp.launch(
+            kernel=fbm_loss_kernel,
+            dim=N,
+            inputs=[seed, octaves, query_positions, noise_values, noise_loss],
+            device=device,
+        )
+
+    n = noise_values.numpy()
+    test.assertTrue(np.isfinite(n).all())
+    test.assertTrue((np.abs(n) < 2.0).all())
+    test.assertTrue(np.std(n) > 0.05)
+
+    # analytic
+    tape.backward(loss=noise_loss)
+    analytic = tape.gradients[query_positions].numpy()
+
+    # central difference
+    gradients = wp.zeros(N, dtype=wp.vec3, device=device)
+    wp.launch(kernel=fbm_cd, dim=N, inputs=[seed, octaves, query_positions, gradients], device=device)
+
+    assert_np_equal(analytic, gradients.numpy(), tol=5.0e-2)
+
+    diff = wp.zeros(N, dtype=float, device=device)
+    wp.launch(kernel=tnoise_kernel, dim=N, inputs=[seed, query_positions, diff], device=device)
+    assert_np_equal(diff.numpy(), np.zeros(N))
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -238,6 +328,7 @@ def register(parent):
     add_function_test(TestNoise, "test_pnoise", test_pnoise, devices=devices)
     add_function_test(TestNoise, "test_curlnoise", test_curlnoise, devices=devices)
     add_function_test(TestNoise, "test_adj_noise", test_adj_noise, devices=devices)
+    add_function_test(TestNoise, "test_fbm", test_fbm, devices=devices)
 
     return TestNoise
 
@@ -93,6 +93,35 @@ def test_options_4(test, device):
     assert_np_equal(tape.gradients[x].numpy(), np.array(0.0))
 
 
+@wp.kernel
+def count_and_sum(x: wp.array(dtype=float), count: wp.array(dtype=int), total: wp.array(dtype=float)):
+    i = wp.tid()
+    wp.atomic_add(count, 0, 1)
+    wp.atomic_add(total, 0, x[i])
+
+
+def test_options_cpu_parallel(test, device):
+    n = 100000
+
+    x = wp.full(n, 1.0, dtype=float, requires_grad=True, device=device)
+    count = wp.zeros(1, dtype=int, device=device)
+    total = wp.zeros(1, dtype=float, requires_grad=True, device=device)
+
+    wp.set_module_options({"enable_cpu_parallel": True})
+
+    tape = wp.Tape()
+    with tape:
+        wp.launch(count_and_sum, dim=n, inputs=[x, count, total], device=device)
+
+    tape.backward(total)
+
+    wp.set_module_options({"enable_cpu_parallel": False})
+
+    assert_np_equal(count.numpy(), np.array([n]))
+    assert_np_equal(total.numpy(), np.array([float(n)]))
+    assert_np_equal(tape.gradients[x].numpy(), np.ones(n))
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -103,6 +132,7 @@ def register(parent):
     add_function_test(TestOptions, "test_options_2", test_options_2, devices=devices)
     add_function_test(TestOptions, "test_options_3", test_options_3, devices=devices)
     add_function_test(TestOptions, "test_options_4", test_options_4, devices=devices)
+    add_function_test(TestOptions, "test_options_cpu_parallel", test_options_cpu_parallel, devices=devices)
     return TestOptions
 
 
@@ -0,0 +1,134 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+import warp.tests.test_launch
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+wp.set_module_options({"persistent": True})
+
+
+@wp.kernel
+def persistent_arange(out: wp.array(dtype=int)):
+    tid = wp.tid()
+    out[tid] = tid
+
+
+@wp.kernel
+def persistent_add(a: wp.array(dtype=int), value: int, out: wp.array(dtype=int)):
+    tid = wp.tid()
+    out[tid] = a[tid] + value
+
+
+@wp.kernel
+def persistent_reverse(a: wp.array(dtype=int), out: wp.array(dtype=int)):
+    tid = wp.tid()
+    out[tid] = a[a.shape[0] - 1 - tid]
+
+
+@wp.kernel
+def persistent_grid(out: wp.array2d(dtype=int)):
+    i, j = wp.tid()
+    out[i, j] = i * 100 + j
+
+
+@wp.func
+def persistent_thread_index():
+    return wp.tid()
+
+
+@wp.kernel
+def persistent_func_tid(out: wp.array(dtype=int)):
+    out[wp.tid()] = persistent_thread_index()
+
+
+def test_persistent_command_list(test, device):
+    n = 1000
+
+    a = wp.zeros(n, dtype=int, device=device)
+    b = wp.zeros(n, dtype=int, device=device)
+    c = wp.zeros(n, dtype=int, device=device)
+    g = wp.zeros((7, 13), dtype=int, device=device)
+
+    # each launch reads what the previous one wrote, which the barriers between tasks make visible
+    cmds = wp.CommandList(persistent=True)
+    cmds.append(wp.launch(persistent_arange, dim=n, inputs=[a], device=device, record_cmd=True))
+    add = wp.launch(persistent_add, dim=n, inputs=[a, 5], outputs=[b], device=device, record_cmd=True)
+    cmds.append(add)
+    cmds.append(wp.launch(persistent_reverse, dim=n, inputs=[b], outputs=[c], device=device, record_cmd=True))
+    cmds.append(wp.launch(persistent_grid, dim=g.shape, inputs=[g], device=device, record_cmd=True))
+
+    cmds.submit()
+    assert_np_equal(c.numpy(), np.arange(n)[::-1] + 5)
+    assert_np_equal(g.numpy(), np.arange(7)[:, None] * 100 + np.arange(13)[None, :])
+
+    # parameters are read at submission
+    add.set_param_by_name("value", 7)
+    cmds.submit()
+    assert_np_equal(c.numpy(), np.arange(n)[::-1] + 7)
+
+    # the submission can be captured, the graph keeps the parameters it was captured with
+    wp.capture_begin(device)
+    cmds.submit()
+    graph = wp.capture_end(device)
+
+    add.set_param_by_name("value", 9)
+    c.zero_()
+    wp.capture_launch(graph)
+    assert_np_equal(c.numpy(), np.arange(n)[::-1] + 7)
+
+    cmds.submit()
+    assert_np_equal(c.numpy(), np.arange(n)[::-1] + 9)
+
+
+def test_persistent_command_list_errors(test, device):
+    a = wp.zeros(10, dtype=int, device=device)
+
+    # kernels of modules without a persistent kernel can't run persistently
+    cmds = wp.CommandList(persistent=True)
+    cmds.append(wp.launch(wp.tests.test_launch.arange, dim=10, inputs=[a], device=device, record_cmd=True))
+    with test.assertRaises(RuntimeError):
+        cmds.submit()
+
+    # and the launches of a persistent list must all come from the same module
+    cmds = wp.CommandList(persistent=True)
+    cmds.append(wp.launch(persistent_arange, dim=10, inputs=[a], device=device, record_cmd=True))
+    with test.assertRaises(RuntimeError):
+        cmds.append(wp.launch(wp.tests.test_launch.arange, dim=10, inputs=[a], device=device, record_cmd=True))
+
+    # tasks don't run at their position in the grid, so only the tid() calls of their kernel are remapped
+    cmds = wp.CommandList(persistent=True)
+    with test.assertRaises(RuntimeError):
+        cmds.append(wp.launch(persistent_func_tid, dim=10, inputs=[a], device=device, record_cmd=True))
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestPersistent(parent):
+        pass
+
+    cuda_devices = wp.get_cuda_devices()
+    add_function_test(
+        TestPersistent, "test_persistent_command_list", test_persistent_command_list, devices=cuda_devices
+    )
+    add_function_test(
+        TestPersistent, "test_persistent_command_list_errors", test_persistent_command_list_errors, devices=cuda_devices
+    )
+
+    return TestPersistent
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
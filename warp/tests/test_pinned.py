@@ -62,6 +62,71 @@ def test_pinned(test, device):
     assert pinned_timer.elapsed < pageable_timer.elapsed, "Pinned transfers did not take less CPU time"
 
 
+@wp.kernel
+def fill_frame(a: wp.array(dtype=float), frame: float):
+    tid = wp.tid()
+    a[tid] = frame + float(tid)
+
+
+def test_pinned_pool(test, device):
+    n = 4096
+
+    # drop cached blocks so that the reserved size reflects this test only
+    wp.synchronize_device(device)
+    wp.release_pinned_pool()
+    base = wp.get_pinned_pool_stats()
+
+    a = wp.zeros(n, dtype=float, device="cpu", pinned=True)
+    stats = wp.get_pinned_pool_stats()
+    test.assertGreaterEqual(stats["used_current"], base["used_current"] + a.capacity)
+    test.assertGreaterEqual(stats["reserved_current"], base["reserved_current"] + a.capacity)
+
+    # freed blocks are kept and reused by allocations of the same size class
+    ptr = a.ptr
+    del a
+    test.assertEqual(wp.get_pinned_pool_stats()["used_current"], base["used_current"])
+    b = wp.empty(n, dtype=float, device="cpu", pinned=True)
+    test.assertEqual(b.ptr, ptr)
+    test.assertEqual(wp.get_pinned_pool_stats()["reserved_current"], stats["reserved_current"])
+
+    # a block with a pending transfer is not handed out again before the transfer completes
+    d = wp.array(np.arange(n, dtype=np.float32), dtype=float, device=device)
+    wp.copy(b, d)
+    del b
+    c = wp.zeros(n, dtype=float, device="cpu", pinned=True)
+    wp.synchronize_device(device)
+    assert_np_equal(c.numpy(), np.zeros(n, dtype=np.float32))
+
+    del c
+    wp.release_pinned_pool()
+    test.assertLessEqual(wp.get_pinned_pool_stats()["reserved_current"], base["reserved_current"])
+
+
+def test_numpy_async(test, device):
+    n = 1024
+    ring = wp.ReadbackRing(device, num_slots=2)
+    a = wp.zeros(n, dtype=float, device=device)
+
+    # more frames than slots, so pending readbacks are resolved when their slot is reused
+    futures = []
+    for frame in range(5):
+        wp.launch(fill_frame, dim=n, inputs=[a, float(frame)], device=device)
+        futures.append(a.numpy_async(ring))
+
+    for frame, future in enumerate(futures):
+        assert_np_equal(future.result(), frame + np.arange(n, dtype=np.float32))
+        test.assertTrue(future.done())
+
+    # non-contiguous views and the device's default ring
+    b = wp.array(np.arange(2 * n, dtype=np.float32).reshape((n, 2)), dtype=float, device=device)
+    assert_np_equal(b[:, 1].numpy_async().result(), b.numpy()[:, 1])
+
+    # CPU arrays complete immediately
+    c = wp.array(np.arange(n, dtype=np.float32), dtype=float, device="cpu")
+    test.assertTrue(c.numpy_async().done())
+    assert_np_equal(c.numpy_async().result(), np.arange(n, dtype=np.float32))
+
+
 def register(parent):
     cuda_devices = wp.get_cuda_devices()
 
@@ -70,6 +135,8 @@ def register(parent):
 
     if cuda_devices:
         add_function_test(TestPinned, "test_pinned", test_pinned, devices=cuda_devices)
+        add_function_test(TestPinned, "test_pinned_pool", test_pinned_pool, devices=cuda_devices)
+        add_function_test(TestPinned, "test_numpy_async", test_numpy_async, devices=cuda_devices)
 
     return TestPinned
 
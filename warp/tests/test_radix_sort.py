@@ -0,0 +1,91 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+wp.init()
+
+
+def run_radix_sort(test, device, dtype, keys_np, begin_bit=0, end_bit=None, sort_keys_np=None):
+    n = len(keys_np)
+
+    # sort requires scratch storage for 2*n elements
+    keys = wp.array(np.concatenate([keys_np, np.zeros_like(keys_np)]), dtype=dtype, device=device)
+    values = wp.array(np.concatenate([np.arange(n), np.zeros(n)]).astype(np.int32), dtype=wp.int32, device=device)
+
+    wp.utils.radix_sort_pairs(keys, values, n, begin_bit=begin_bit, end_bit=end_bit)
+
+    # sort is stable, so the values must match a stable argsort
+    order = np.argsort(keys_np if sort_keys_np is None else sort_keys_np, kind="stable")
+
+    assert_np_equal(keys.numpy()[:n], keys_np[order])
+    assert_np_equal(values.numpy()[:n], order.astype(np.int32))
+
+
+def test_radix_sort_int32(test, device):
+    rng = np.random.default_rng(123)
+
+    run_radix_sort(test, device, wp.int32, rng.integers(-(2**31), 2**31 - 1, size=100000, dtype=np.int32))
+
+    # many duplicates and passes where every key shares the same digit
+    run_radix_sort(test, device, wp.int32, rng.integers(0, 100, size=50000, dtype=np.int32))
+
+
+def test_radix_sort_int64(test, device):
+    rng = np.random.default_rng(123)
+
+    run_radix_sort(test, device, wp.int64, rng.integers(-(2**63), 2**63 - 1, size=100000, dtype=np.int64))
+
+
+def test_radix_sort_uint64(test, device):
+    rng = np.random.default_rng(123)
+
+    run_radix_sort(test, device, wp.uint64, rng.integers(0, 2**64 - 1, size=100000, dtype=np.uint64))
+
+
+def test_radix_sort_float32(test, device):
+    rng = np.random.default_rng(123)
+
+    run_radix_sort(test, device, wp.float32, rng.uniform(-1000.0, 1000.0, size=100000).astype(np.float32))
+
+
+def test_radix_sort_bit_range(test, device):
+    rng = np.random.default_rng(123)
+
+    keys = rng.integers(0, 2**20, size=100000, dtype=np.int32)
+    run_radix_sort(test, device, wp.int32, keys, end_bit=20)
+    run_radix_sort(test, device, wp.int32, keys, end_bit="auto")
+
+    # negative keys need all the bits
+    run_radix_sort(test, device, wp.int32, keys - 2**19, end_bit="auto")
+    run_radix_sort(test, device, wp.uint64, keys.astype(np.uint64) << np.uint64(40), end_bit="auto")
+
+    # the other bits are ignored, within a digit too
+    run_radix_sort(test, device, wp.int32, keys, begin_bit=4, end_bit=15, sort_keys_np=(keys >> 4) & 0x7FF)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestRadixSort(parent):
+        pass
+
+    add_function_test(TestRadixSort, "test_radix_sort_int32", test_radix_sort_int32, devices=devices)
+    add_function_test(TestRadixSort, "test_radix_sort_int64", test_radix_sort_int64, devices=devices)
+    add_function_test(TestRadixSort, "test_radix_sort_uint64", test_radix_sort_uint64, devices=devices)
+    add_function_test(TestRadixSort, "test_radix_sort_float32", test_radix_sort_float32, devices=devices)
+    add_function_test(TestRadixSort, "test_radix_sort_bit_range", test_radix_sort_bit_range, devices=devices)
+
+    return TestRadixSort
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -267,6 +267,88 @@ def test_poisson(test, device):
     test.assertTrue(np.abs(poisson_high_std - np_poisson_high_std) <= 2e-1)
 
 
+@wp.kernel
+def philox_kernel(keys: wp.array(dtype=wp.vec2ui), counters: wp.array(dtype=wp.vec4ui), out: wp.array(dtype=wp.vec4ui)):
+    tid = wp.tid()
+    out[tid] = wp.philox(keys[tid], counters[tid])
+
+
+@wp.kernel
+def philox_sample_kernel(
+    kernel_seed: int,
+    offset: int,
+    uniform: wp.array(dtype=wp.vec4),
+    normal: wp.array(dtype=wp.vec4),
+    pcg_normal: wp.array(dtype=wp.vec2),
+):
+    tid = wp.tid()
+
+    uniform[tid] = wp.philox_randf4(kernel_seed, tid, offset)
+    normal[tid] = wp.philox_randn4(kernel_seed, tid, offset)
+
+    state = wp.rand_init(kernel_seed, tid)
+    pcg_normal[tid] = wp.randn2(state)
+
+
+def test_philox(test, device):
+    # known answer vectors from the Random123 distribution
+    keys = wp.array([[0, 0], [0xFFFFFFFF, 0xFFFFFFFF], [0xA4093822, 0x299F31D0]], dtype=wp.vec2ui, device=device)
+    counters = wp.array(
+        [
+            [0, 0, 0, 0],
+            [0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF],
+            [0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344],
+        ],
+        dtype=wp.vec4ui,
+        device=device,
+    )
+    out = wp.zeros(3, dtype=wp.vec4ui, device=device)
+
+    wp.launch(philox_kernel, dim=3, inputs=[keys, counters, out], device=device)
+
+    expected = np.array(
+        [
+            [0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8],
+            [0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD],
+            [0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1],
+        ],
+        dtype=np.uint32,
+    )
+    assert_np_equal(out.numpy(), expected)
+
+    seed = 17
+    N = 10000
+
+    def sample(n, offset, device):
+        uniform = wp.zeros(n, dtype=wp.vec4, device=device)
+        normal = wp.zeros(n, dtype=wp.vec4, device=device)
+        pcg_normal = wp.zeros(n, dtype=wp.vec2, device=device)
+        wp.launch(philox_sample_kernel, dim=n, inputs=[seed, offset, uniform, normal, pcg_normal], device=device)
+        return uniform.numpy(), normal.numpy(), pcg_normal.numpy()
+
+    uniform, normal, pcg_normal = sample(N, 0, device)
+
+    test.assertTrue((uniform >= 0.0).all())
+    test.assertTrue((uniform < 1.0).all())
+    test.assertTrue(np.abs(np.mean(uniform) - 0.5) < 1e-2)
+    test.assertTrue(np.isfinite(normal).all())
+    test.assertTrue(np.abs(np.mean(normal)) < 5e-2)
+    test.assertTrue(np.abs(np.std(normal) - 1.0) < 5e-2)
+    test.assertTrue(np.isfinite(pcg_normal).all())
+    test.assertTrue(np.abs(np.mean(pcg_normal)) < 5e-2)
+    test.assertTrue(np.abs(np.std(pcg_normal) - 1.0) < 5e-2)
+
+    # streams are a function of the index only, not of the launch size or device
+    uniform_small, _, _ = sample(N // 4, 0, device)
+    uniform_cpu, _, _ = sample(N, 0, "cpu")
+    assert_np_equal(uniform_small, uniform[: N // 4])
+    assert_np_equal(uniform_cpu, uniform)
+
+    # skipping ahead selects a different block of the same stream
+    uniform_skip, _, _ = sample(N, 1, device)
+    test.assertFalse((uniform_skip == uniform).all())
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -277,6 +359,7 @@ def register(parent):
     add_function_test(TestNoise, "test_sample_cdf", test_sample_cdf, devices=devices)
     add_function_test(TestNoise, "test_sampling_methods", test_sampling_methods, devices=devices)
     add_function_test(TestNoise, "test_poisson", test_poisson, devices=devices)
+    add_function_test(TestNoise, "test_philox", test_philox, devices=devices)
 
     return TestNoise
 
@@ -0,0 +1,81 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import math
+
+import numpy as np
+
+import warp as wp
+import warp.sim
+from warp.render.render_raytrace import RayTracer
+from warp.tests.test_base import *
+
+wp.init()
+
+
+def test_ray_tracer(test, device):
+    builder = warp.sim.ModelBuilder()
+    body = builder.add_body(origin=wp.transform((0.0, 1.0, 0.0), wp.quat_identity()))
+    builder.add_shape_box(body, hx=0.5, hy=0.5, hz=0.5)
+    model = builder.finalize(device=device)
+
+    box_shape = 0
+    ground_shape = model.shape_count - 1
+
+    # the first camera is static, the second one is attached to the box body, both look down
+    tracer = RayTracer(model, camera_widths=[8, 4], camera_heights=[6, 4], camera_body=[-1, body], shadows=True)
+
+    down = wp.quat_from_axis_angle(wp.vec3(1.0, 0.0, 0.0), -0.5 * math.pi)
+    camera_transforms = wp.array(
+        [wp.transform((0.0, 5.0, 0.0), down), wp.transform((0.0, 3.0, 0.0), down)], dtype=wp.transform, device=device
+    )
+
+    state = model.state()
+    tracer.render(state, camera_transforms)
+
+    depth = tracer.get_image(tracer.depth, 0).numpy()
+    segmentation = tracer.get_image(tracer.segmentation, 0).numpy()
+    test.assertEqual(depth.shape, (6, 8))
+
+    # the box top is at y = 1.5, the ground at y = 0
+    assert_np_equal(depth[3, 4], 3.5, tol=1.0e-4)
+    test.assertEqual(segmentation[3, 4], box_shape)
+    assert_np_equal(depth[0, 0], 5.0, tol=1.0e-4)
+    test.assertEqual(segmentation[0, 0], ground_shape)
+
+    # the attached camera is 3 units above the body origin
+    assert_np_equal(tracer.get_image(tracer.depth, 1).numpy()[2, 2], 2.5, tol=1.0e-4)
+
+    # the box top faces the light and nothing occludes it
+    color = tracer.get_image(tracer.color, 0).numpy()
+    test.assertTrue(np.all(color[3, 4] > 0.0))
+    test.assertTrue(np.all(color >= 0.0) and np.all(color <= 1.0))
+
+    # move the body up, the attached camera follows it
+    body_q = wp.array([wp.transform((0.0, 2.0, 0.0), wp.quat_identity())], dtype=wp.transform, device=device)
+    wp.copy(state.body_q, body_q)
+    tracer.render(state, camera_transforms)
+
+    assert_np_equal(tracer.get_image(tracer.depth, 0).numpy()[3, 4], 2.5, tol=1.0e-4)
+    assert_np_equal(tracer.get_image(tracer.depth, 1).numpy()[2, 2], 2.5, tol=1.0e-4)
+    test.assertEqual(tracer.get_image(tracer.segmentation, 1).numpy()[2, 2], box_shape)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestRayTracer(parent):
+        pass
+
+    add_function_test(TestRayTracer, "test_ray_tracer", test_ray_tracer, devices=devices)
+
+    return TestRayTracer
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
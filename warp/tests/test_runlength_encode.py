@@ -26,6 +26,26 @@ def test_runlength_encode_int(test, device):
     assert (unique_counts.numpy()[:run_count] == unique_counts_np[:run_count]).all()
 
 
+def test_runlength_encode_large(test, device):
+    # spans several host blocks, with runs crossing block boundaries
+    n = 500000
+
+    values_np = np.repeat(np.random.randint(0, 4, n // 50 + 1), np.random.randint(1, 100, n // 50 + 1))[:n]
+
+    starts_np = np.concatenate(([0], np.flatnonzero(values_np[1:] != values_np[:-1]) + 1))
+    run_lengths_np = np.diff(np.append(starts_np, len(values_np)))
+
+    values = wp.array(values_np, device=device, dtype=int)
+    run_values = wp.empty_like(values)
+    run_lengths = wp.empty_like(values)
+
+    run_count = runlength_encode(values, run_values, run_lengths)
+
+    test.assertEqual(run_count, len(starts_np))
+    assert_np_equal(run_values.numpy()[:run_count], values_np[starts_np])
+    assert_np_equal(run_lengths.numpy()[:run_count], run_lengths_np)
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -33,6 +53,7 @@ def register(parent):
         pass
 
     add_function_test(TestRunlengthEncode, "test_runlength_encode_int", test_runlength_encode_int, devices=devices)
+    add_function_test(TestRunlengthEncode, "test_runlength_encode_large", test_runlength_encode_large, devices=devices)
 
     return TestRunlengthEncode
 
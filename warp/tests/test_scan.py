@@ -0,0 +1,119 @@
+import numpy as np
+import warp as wp
+
+from warp.utils import array_scan
+from warp.tests.test_base import *
+
+wp.init()
+
+
+@wp.struct
+class ScanStruct:
+    position: wp.vec3
+    weight: float
+
+
+def _reference_scan(values_np, inclusive, heads=None):
+    result = np.empty_like(values_np)
+    total = np.zeros_like(values_np[0])
+    for i in range(values_np.shape[0]):
+        if heads is not None and heads[i]:
+            total = np.zeros_like(total)
+        if inclusive:
+            total = total + values_np[i]
+            result[i] = total
+        else:
+            result[i] = total
+            total = total + values_np[i]
+    return result
+
+
+def make_test_scan_vec(dtype, n):
+    def test_scan_vec(test, device):
+        rng = np.random.default_rng(123)
+        type_length = wp.types.type_length(dtype)
+        scalar_type = wp.types.type_scalar_type(dtype)
+
+        if scalar_type == wp.int32:
+            values_np = rng.integers(-100, 100, (n, type_length)).astype(np.int32)
+        else:
+            values_np = rng.random((n, type_length))
+
+        values = wp.array(values_np, dtype=dtype, device=device)
+        result = wp.empty_like(values)
+
+        tol = {wp.int32: 0, wp.float32: 1.0e-4 * n, wp.float64: 1.0e-8 * n}[scalar_type]
+
+        for inclusive in (True, False):
+            array_scan(values, result, inclusive=inclusive)
+            ref = _reference_scan(values_np.astype(np.float64), inclusive)
+            assert_np_equal(result.numpy().reshape(n, type_length), ref, tol=tol)
+
+    return test_scan_vec
+
+
+def test_scan_segmented(test, device):
+    rng = np.random.default_rng(456)
+    n = 20000
+
+    values_np = rng.integers(-100, 100, (n, 2)).astype(np.int32)
+    segment_offsets_np = np.concatenate(([0], np.sort(rng.choice(np.arange(1, n), 40, replace=False)), [n]))
+
+    heads = np.zeros(n, dtype=bool)
+    heads[segment_offsets_np[:-1]] = True
+
+    values = wp.array(values_np, dtype=wp.vec2i, device=device)
+    segment_offsets = wp.array(segment_offsets_np, dtype=int, device=device)
+    result = wp.empty_like(values)
+
+    for inclusive in (True, False):
+        array_scan(values, result, inclusive=inclusive, segment_offsets=segment_offsets)
+        assert_np_equal(result.numpy(), _reference_scan(values_np, inclusive, heads))
+
+    # scalar types also go through the segmented path, in place
+    scalars_np = values_np[:, 0].copy()
+    scalars = wp.array(scalars_np, dtype=int, device=device)
+    array_scan(scalars, scalars, inclusive=True, segment_offsets=segment_offsets)
+    assert_np_equal(scalars.numpy(), _reference_scan(scalars_np, True, heads))
+
+
+def test_scan_struct(test, device):
+    n = 1000
+
+    positions_np = np.random.rand(n, 3)
+    weights_np = np.random.rand(n)
+
+    values_np = np.zeros(n, dtype=ScanStruct.numpy_dtype())
+    values_np["position"] = positions_np
+    values_np["weight"] = weights_np
+
+    values = wp.array(values_np, dtype=ScanStruct, device=device)
+    result = wp.empty_like(values)
+    array_scan(values, result)
+
+    result_np = result.numpy()
+    assert_np_equal(result_np["position"], np.cumsum(positions_np, axis=0), tol=1.0e-3)
+    assert_np_equal(result_np["weight"], np.cumsum(weights_np), tol=1.0e-3)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestScan(parent):
+        pass
+
+    add_function_test(TestScan, "test_scan_vec3", make_test_scan_vec(wp.vec3, 100000), devices=devices)
+    add_function_test(TestScan, "test_scan_vec2d", make_test_scan_vec(wp.vec2d, 70000), devices=devices)
+    add_function_test(
+        TestScan, "test_scan_mat22i", make_test_scan_vec(wp.types.matrix((2, 2), wp.int32), 5000), devices=devices
+    )
+    add_function_test(TestScan, "test_scan_double", make_test_scan_vec(wp.float64, 200000), devices=devices)
+    add_function_test(TestScan, "test_scan_segmented", test_scan_segmented, devices=devices)
+    add_function_test(TestScan, "test_scan_struct", test_scan_struct, devices=devices)
+
+    return TestScan
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -0,0 +1,89 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+wp.init()
+
+
+def random_segments(rng, n, num_segments):
+    # sorted cut points with repeats, so some segments are empty
+    cuts = np.sort(rng.integers(0, n + 1, size=num_segments - 1))
+    return np.concatenate([[0], cuts, [n]]).astype(np.int32)
+
+
+def test_segmented_sort_pairs(test, device):
+    rng = np.random.default_rng(123)
+
+    n = 10000
+    offsets_np = random_segments(rng, n, 100)
+
+    for dtype, keys_np in (
+        (wp.int32, rng.integers(-1000, 1000, size=n, dtype=np.int32)),
+        (wp.float32, rng.uniform(-1.0, 1.0, size=n).astype(np.float32)),
+    ):
+        keys = wp.array(np.concatenate([keys_np, np.zeros_like(keys_np)]), dtype=dtype, device=device)
+        values = wp.array(np.concatenate([np.arange(n), np.zeros(n)]).astype(np.int32), dtype=wp.int32, device=device)
+        offsets = wp.array(offsets_np, dtype=wp.int32, device=device)
+
+        wp.utils.segmented_sort_pairs(keys, values, n, offsets)
+
+        # stable sort within each segment
+        expected = np.arange(n, dtype=np.int32)
+        for begin, end in zip(offsets_np[:-1], offsets_np[1:]):
+            expected[begin:end] = begin + np.argsort(keys_np[begin:end], kind="stable")
+
+        assert_np_equal(keys.numpy()[:n], keys_np[expected])
+        assert_np_equal(values.numpy()[:n], expected)
+
+
+def test_segmented_reduce(test, device):
+    rng = np.random.default_rng(123)
+
+    n = 10000
+    offsets_np = random_segments(rng, n, 100)
+    num_segments = len(offsets_np) - 1
+
+    for dtype, np_type, values_np in (
+        (wp.int32, np.int32, rng.integers(-1000, 1000, size=n, dtype=np.int32)),
+        (wp.float32, np.float32, rng.uniform(-1.0, 1.0, size=n).astype(np.float32)),
+    ):
+        values = wp.array(values_np, dtype=dtype, device=device)
+        offsets = wp.array(offsets_np, dtype=wp.int32, device=device)
+        out = wp.zeros(num_segments, dtype=dtype, device=device)
+
+        info = np.iinfo(np_type) if np_type == np.int32 else np.finfo(np_type)
+
+        for op, func, identity in (("sum", np.sum, 0), ("min", np.min, info.max), ("max", np.max, info.min)):
+            wp.utils.segmented_reduce(values, offsets, out, op)
+
+            expected = np.array(
+                [func(values_np[b:e]) if e > b else identity for b, e in zip(offsets_np[:-1], offsets_np[1:])],
+                dtype=np_type,
+            )
+
+            assert_np_equal(out.numpy(), expected, tol=1.0e-4)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestSegmented(parent):
+        pass
+
+    add_function_test(TestSegmented, "test_segmented_sort_pairs", test_segmented_sort_pairs, devices=devices)
+    add_function_test(TestSegmented, "test_segmented_reduce", test_segmented_reduce, devices=devices)
+
+    return TestSegmented
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
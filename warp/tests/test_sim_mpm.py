@@ -0,0 +1,99 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+import warp.sim
+from warp.tests.test_base import *
+
+wp.init()
+
+
+def build_block(device, pos, dim, spacing, density):
+    builder = wp.sim.ModelBuilder()
+    builder.add_particle_grid(
+        pos=wp.vec3(pos),
+        rot=wp.quat_identity(),
+        vel=wp.vec3(0.0, 0.0, 0.0),
+        dim_x=dim,
+        dim_y=dim,
+        dim_z=dim,
+        cell_x=spacing,
+        cell_y=spacing,
+        cell_z=spacing,
+        mass=density * spacing**3,
+        jitter=0.0,
+    )
+    return builder.finalize(device=device)
+
+
+def simulate(model, integrator, steps, dt):
+    state_in = model.state()
+    state_out = model.state()
+    for _ in range(steps):
+        integrator.simulate(model, state_in, state_out, dt)
+        state_in, state_out = state_out, state_in
+    return state_in
+
+
+def test_mpm_free_fall(test, device):
+    dx = 0.05
+    dt = 1.0e-3
+    steps = 20
+
+    # a block crossing the origin spans blocks of negative coordinates too
+    model = build_block(device, (-0.2, 1.0, -0.2), 16, 0.5 * dx, 1000.0)
+    model.ground = False
+
+    for material in ["elastic", "snow", "sand"]:
+        integrator = wp.sim.MPMIntegrator(dx=dx, material=material, youngs_modulus=1.0e4)
+        state = simulate(model, integrator, steps, dt)
+
+        # a body in free fall keeps its shape and falls with gravity
+        v = state.particle_qd.numpy()
+        assert_np_equal(v, np.tile(np.array([0.0, -9.81 * dt * steps, 0.0]), (model.particle_count, 1)), tol=1.0e-3)
+
+        F = state.mpm_F.numpy()
+        assert_np_equal(F, np.tile(np.eye(3), (model.particle_count, 1, 1)), tol=1.0e-3)
+
+        q0 = model.particle_q.numpy()
+        q = state.particle_q.numpy()
+        test.assertAlmostEqual(np.mean(q[:, 1] - q0[:, 1]), -0.5 * 9.81 * (dt * steps) ** 2, delta=2.0e-3)
+
+
+def test_mpm_ground(test, device):
+    dx = 0.05
+    dt = 1.0e-3
+
+    # a sand block dropped on the ground plane settles on it
+    model = build_block(device, (0.0, 0.1, 0.0), 12, 0.5 * dx, 1000.0)
+    integrator = wp.sim.MPMIntegrator(dx=dx, material="sand", youngs_modulus=1.0e4)
+    state = simulate(model, integrator, 500, dt)
+
+    q = state.particle_q.numpy()
+    v = state.particle_qd.numpy()
+    test.assertTrue(np.all(np.isfinite(q)))
+    test.assertGreater(np.min(q[:, 1]), -dx)
+    test.assertLess(np.mean(np.abs(v[:, 1])), 0.1)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestSimMPM(parent):
+        pass
+
+    add_function_test(TestSimMPM, "test_mpm_free_fall", test_mpm_free_fall, devices=devices)
+    add_function_test(TestSimMPM, "test_mpm_ground", test_mpm_ground, devices=devices)
+
+    return TestSimMPM
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
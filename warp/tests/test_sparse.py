@@ -1,7 +1,8 @@
 import numpy as np
 import warp as wp
 
-from warp.sparse import bsr_zeros, bsr_set_from_triplets, bsr_get_diag, bsr_diag, bsr_set_transpose, bsr_axpy, bsr_mm
+from warp.sparse import bsr_zeros, bsr_set_from_triplets, bsr_get_diag, bsr_diag, bsr_set_transpose, bsr_axpy, bsr_mm, bsr_mv
+from warp.sparse import BsrTripletsTopology, bsr_to_sell, sell_mv, bsr_block_diag_inverse, bsr_set_from_host_triplets
 from warp.tests.test_base import *
 
 wp.init()
@@ -84,6 +85,70 @@ def test_bsr_from_triplets(test, device):
     assert_np_equal(ref, res, 0.0001)
 
 
+def test_bsr_from_triplets_topology(test, device):
+    block_shape = (3, 2)
+    nrow = 4
+    ncol = 9
+    shape = (block_shape[0] * nrow, block_shape[1] * ncol)
+    n = 50
+
+    rows = wp.array(np.random.randint(0, nrow, n, dtype=int), dtype=int, device=device)
+    cols = wp.array(np.random.randint(0, ncol, n, dtype=int), dtype=int, device=device)
+
+    bsr = bsr_zeros(nrow, ncol, wp.types.matrix(shape=block_shape, dtype=float), device=device)
+    topology = BsrTripletsTopology()
+
+    for _ in range(3):
+        vals_np = np.random.rand(n, block_shape[0], block_shape[1])
+        # zero blocks must not change the cached pattern
+        vals_np[::5] = 0.0
+        vals = wp.array(vals_np, dtype=float, device=device)
+
+        ref = _triplets_to_dense(shape, rows, cols, vals)
+
+        bsr_set_from_triplets(bsr, rows, cols, vals, topology=topology)
+        test.assertEqual(bsr.nnz, topology.nnz)
+
+        res = _bsr_to_dense(bsr)
+        assert_np_equal(ref, res, 0.0001)
+
+    unique_blocks = np.unique(rows.numpy() * ncol + cols.numpy())
+    test.assertEqual(topology.nnz, len(unique_blocks))
+
+
+def test_bsr_from_host_triplets(test, device):
+    block_shape = (3, 2)
+    nrow = 4
+    ncol = 9
+    shape = (block_shape[0] * nrow, block_shape[1] * ncol)
+    n = 50
+
+    # int64 indices and double values are converted while staged
+    rows_np = np.random.randint(0, nrow, n, dtype=np.int64)
+    cols_np = np.random.randint(0, ncol, n, dtype=np.int64)
+    vals_np = np.random.rand(n, block_shape[0], block_shape[1])
+
+    ref = _triplets_to_dense(shape, wp.array(rows_np, dtype=int), wp.array(cols_np, dtype=int), wp.array(vals_np))
+
+    bsr = bsr_zeros(nrow, ncol, wp.types.matrix(shape=block_shape, dtype=float), device=device)
+    bsr_set_from_host_triplets(bsr, rows_np, cols_np, vals_np, chunk_size=7)
+    assert_np_equal(ref, _bsr_to_dense(bsr), 0.0001)
+
+    # pinned arrays are uploaded directly, and reusing the topology keeps the block count cached
+    rows = wp.array(rows_np, dtype=int, device="cpu", pinned=device.is_cuda)
+    cols = wp.array(cols_np, dtype=int, device="cpu", pinned=device.is_cuda)
+    topology = BsrTripletsTopology()
+    for _ in range(2):
+        vals_np = np.random.rand(n, block_shape[0], block_shape[1])
+        vals = wp.array(vals_np, dtype=float, device="cpu", pinned=device.is_cuda)
+
+        bsr_set_from_host_triplets(bsr, rows, cols, vals, topology=topology)
+        test.assertEqual(bsr.nnz, topology.nnz)
+
+        ref = _triplets_to_dense(shape, rows, cols, vals)
+        assert_np_equal(ref, _bsr_to_dense(bsr), 0.0001)
+
+
 def test_bsr_get_diag(test, device):
     block_shape = (3, 3)
     nrow = 4
@@ -112,6 +177,51 @@ def test_bsr_get_diag(test, device):
     assert_np_equal(diag_np, diag.numpy())
 
 
+def make_test_bsr_block_diag_inverse(block_size, scalar_type):
+    def test_bsr_block_diag_inverse(test, device):
+        nrow = 5
+        block_shape = (block_size, block_size)
+
+        # row 3 has no diagonal block, row 4 a singular one
+        rows = np.array([0, 1, 2, 4, 0, 3], dtype=np.int32)
+        cols = np.array([0, 1, 2, 4, 2, 1], dtype=np.int32)
+        vals_np = np.random.rand(len(rows), block_size, block_size) + 2.0 * np.eye(block_size)
+        vals_np[3] = 1.0
+
+        bsr = bsr_zeros(nrow, nrow, wp.types.matrix(shape=block_shape, dtype=scalar_type), device=device)
+        bsr_set_from_triplets(
+            bsr,
+            wp.array(rows, dtype=int, device=device),
+            wp.array(cols, dtype=int, device=device),
+            wp.array(vals_np, dtype=scalar_type, device=device),
+        )
+
+        inv_np = bsr_block_diag_inverse(bsr).numpy()
+
+        tol = 1.0e-4 if scalar_type == wp.float32 else 1.0e-10
+        for row in range(3):
+            assert_np_equal(inv_np[row], np.linalg.inv(vals_np[row]), tol=tol)
+        assert_np_equal(inv_np[3], np.eye(block_size))
+        assert_np_equal(inv_np[4], np.eye(block_size))
+
+    return test_bsr_block_diag_inverse
+
+
+def test_bsr_block_diag_inverse_empty(test, device):
+    # no rows
+    bsr = bsr_zeros(0, 0, wp.mat33, device=device)
+    test.assertEqual(bsr_block_diag_inverse(bsr).shape, (0,))
+
+    # all diagonal blocks are missing
+    bsr = bsr_zeros(4, 4, wp.mat33, device=device)
+    assert_np_equal(bsr_block_diag_inverse(bsr).numpy(), np.tile(np.eye(3), (4, 1, 1)))
+
+    bsr = bsr_zeros(4, 4, wp.float64, device=device)
+    out = wp.zeros(6, dtype=wp.float64, device=device)
+    bsr_block_diag_inverse(bsr, out=out)
+    assert_np_equal(out.numpy(), np.array([1.0, 1.0, 1.0, 1.0, 0.0, 0.0]))
+
+
 def make_test_bsr_transpose(block_shape, scalar_type):
     def test_bsr_transpose(test, device):
         nrow = 4
@@ -228,6 +338,235 @@ def make_test_bsr_mm(block_shape, scalar_type):
     return test_bsr_mm
 
 
+def test_bsr_mm_empty(test, device):
+    block_type = wp.mat33d
+    nrow = 6
+    nnz = 10
+
+    rows = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+    cols = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+    vals = wp.array(np.random.rand(nnz, 3, 3), dtype=wp.float64, device=device)
+
+    x = bsr_zeros(nrow, nrow, block_type, device=device)
+    bsr_set_from_triplets(x, rows, cols, vals)
+    empty = bsr_zeros(nrow, nrow, block_type, device=device)
+
+    # products with an operand without blocks have none either
+    test.assertEqual(bsr_mm(empty, x).nnz, 0)
+    test.assertEqual(bsr_mm(x, empty).nnz, 0)
+
+    # and only scale z by beta
+    z = bsr_mm(x, x)
+    ref = 0.5 * _bsr_to_dense(z)
+    bsr_mm(empty, x, z, alpha=1.0, beta=0.5)
+    assert_np_equal(_bsr_to_dense(z), ref, 1.0e-10)
+
+    bsr_mm(x, empty, z, alpha=1.0, beta=0.5, reuse_topology=True)
+    assert_np_equal(_bsr_to_dense(z), 0.5 * ref, 1.0e-10)
+
+    bsr_mm(x, empty, z, alpha=1.0, beta=0.0)
+    test.assertEqual(z.nnz, 0)
+    assert_np_equal(_bsr_to_dense(z), np.zeros((3 * nrow, 3 * nrow)))
+
+
+def make_test_bsr_mm_reuse_topology(block_shape, scalar_type):
+    def test_bsr_mm_reuse_topology(test, device):
+        nrow = 8
+        nnz = 20
+
+        rows = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+        cols = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+        vals = wp.array(np.random.rand(nnz, block_shape[0], block_shape[1]), dtype=scalar_type, device=device)
+
+        block_type = wp.types.matrix(shape=block_shape, dtype=scalar_type)
+        x = bsr_zeros(nrow, nrow, block_type, device=device)
+        bsr_set_from_triplets(x, rows, cols, vals)
+
+        z = bsr_mm(x, x)
+        offsets = z.offsets.numpy()
+        columns = z.columns.numpy()
+
+        # same sparsity, new values
+        vals = wp.array(np.random.rand(nnz, block_shape[0], block_shape[1]), dtype=scalar_type, device=device)
+        bsr_set_from_triplets(x, rows, cols, vals)
+
+        ref = -1.0 * (_bsr_to_dense(x) @ _bsr_to_dense(x)) + 0.5 * _bsr_to_dense(z)
+
+        bsr_mm(x, x, z, alpha=-1.0, beta=0.5, reuse_topology=True)
+
+        assert_np_equal(z.offsets.numpy(), offsets)
+        assert_np_equal(z.columns.numpy()[: z.nnz], columns[: z.nnz])
+        assert_np_equal(_bsr_to_dense(z), ref, 0.0001)
+
+    return test_bsr_mm_reuse_topology
+
+
+def make_test_bsr_mv(block_shape, scalar_type, nnz):
+    def test_bsr_mv(test, device):
+        nrow = 40
+        ncol = 30
+
+        alpha = -1.0
+        beta = 2.0
+
+        rows = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+        cols = wp.array(np.random.randint(0, ncol, nnz, dtype=int), dtype=int, device=device)
+        vals = wp.array(np.random.rand(nnz, block_shape[0], block_shape[1]), dtype=scalar_type, device=device)
+
+        A = bsr_zeros(nrow, ncol, wp.types.matrix(shape=block_shape, dtype=scalar_type), device=device)
+        bsr_set_from_triplets(A, rows, cols, vals)
+
+        if block_shape == (1, 1):
+            x = wp.array(np.random.rand(ncol), dtype=scalar_type, device=device)
+            y = wp.array(np.random.rand(nrow), dtype=scalar_type, device=device)
+        else:
+            x_dtype = wp.vec(length=block_shape[1], dtype=scalar_type)
+            y_dtype = wp.vec(length=block_shape[0], dtype=scalar_type)
+            x = wp.array(np.random.rand(ncol, block_shape[1]), dtype=x_dtype, device=device)
+            y = wp.array(np.random.rand(nrow, block_shape[0]), dtype=y_dtype, device=device)
+
+        ref = alpha * (_bsr_to_dense(A) @ x.numpy().flatten()) + beta * y.numpy().flatten()
+
+        bsr_mv(A, x, y, alpha, beta)
+
+        res = y.numpy().flatten()
+        assert_np_equal(ref, res, 0.0001)
+
+    return test_bsr_mv
+
+
+def test_bsr_mv_empty(test, device):
+    block_type = wp.mat33d
+    vec_type = wp.vec3d
+
+    # a matrix without blocks only scales y
+    A = bsr_zeros(5, 4, block_type, device=device)
+    x = wp.array(np.random.rand(4, 3), dtype=vec_type, device=device)
+    y_np = np.random.rand(5, 3)
+    y = wp.array(y_np, dtype=vec_type, device=device)
+
+    bsr_mv(A, x, y, alpha=1.0, beta=2.0)
+    assert_np_equal(y.numpy(), 2.0 * y_np)
+
+    bsr_mv(A, x, y, alpha=1.0, beta=0.0)
+    assert_np_equal(y.numpy(), np.zeros((5, 3)))
+
+    # and zero-length vectors are left untouched
+    A = bsr_zeros(0, 0, block_type, device=device)
+    x = wp.empty(0, dtype=vec_type, device=device)
+    y = wp.empty(0, dtype=vec_type, device=device)
+    bsr_mv(A, x, y, alpha=1.0, beta=2.0)
+
+
+def make_test_sell_mv(block_shape, scalar_type, slice_size, sigma):
+    def test_sell_mv(test, device):
+        nrow = 70
+        ncol = 50
+        nnz = 300
+
+        alpha = -1.0
+        beta = 2.0
+
+        # skewed row distribution, so that rows have very different lengths
+        rows = wp.array((np.random.rand(nnz) ** 3 * nrow).astype(int), dtype=int, device=device)
+        cols = wp.array(np.random.randint(0, ncol, nnz, dtype=int), dtype=int, device=device)
+        vals = wp.array(np.random.rand(nnz, block_shape[0], block_shape[1]), dtype=scalar_type, device=device)
+
+        A = bsr_zeros(nrow, ncol, wp.types.matrix(shape=block_shape, dtype=scalar_type), device=device)
+        bsr_set_from_triplets(A, rows, cols, vals)
+
+        S = bsr_to_sell(A, slice_size=slice_size, sigma=sigma)
+        test.assertEqual(S.shape, A.shape)
+
+        lengths = S.row_lengths.numpy()
+        for w in range(0, nrow, sigma):
+            window = lengths[w : w + sigma]
+            test.assertTrue(np.all(window[:-1] >= window[1:]))
+
+        x_dtype = wp.vec(length=block_shape[1], dtype=scalar_type)
+        y_dtype = wp.vec(length=block_shape[0], dtype=scalar_type)
+        x = wp.array(np.random.rand(ncol, block_shape[1]), dtype=x_dtype, device=device)
+        y = wp.array(np.random.rand(nrow, block_shape[0]), dtype=y_dtype, device=device)
+
+        ref = alpha * (_bsr_to_dense(A) @ x.numpy().flatten()) + beta * y.numpy().flatten()
+
+        sell_mv(S, x, y, alpha, beta)
+
+        res = y.numpy().flatten()
+        assert_np_equal(ref, res, 0.0001)
+
+    return test_sell_mv
+
+
+def test_sell_mv_empty(test, device):
+    block_type = wp.mat33d
+
+    # no rows
+    A = bsr_zeros(0, 5, block_type, device=device)
+    S = bsr_to_sell(A)
+    test.assertEqual(S.shape, A.shape)
+
+    x = wp.array(np.random.rand(5, 3), dtype=wp.vec3d, device=device)
+    y = wp.empty(0, dtype=wp.vec3d, device=device)
+    sell_mv(S, x, y, 1.0, 2.0)
+
+    # rows without blocks
+    A = bsr_zeros(10, 5, block_type, device=device)
+    S = bsr_to_sell(A, slice_size=4, sigma=8)
+    test.assertEqual(S.shape, A.shape)
+
+    y_np = np.random.rand(10, 3)
+    y = wp.array(y_np, dtype=wp.vec3d, device=device)
+    sell_mv(S, x, y, 1.0, 2.0)
+    assert_np_equal(y.numpy(), 2.0 * y_np, 0.0001)
+
+
+def make_test_bsr_half(block_shape):
+    def test_bsr_half(test, device):
+        nrow = 40
+        ncol = 30
+        nnz = 200
+
+        rows = wp.array(np.random.randint(0, nrow, nnz, dtype=int), dtype=int, device=device)
+        cols = wp.array(np.random.randint(0, ncol, nnz, dtype=int), dtype=int, device=device)
+
+        if block_shape == (1, 1):
+            block_type = wp.float16
+            vals = wp.array(np.random.rand(nnz), dtype=wp.float16, device=device)
+            x = wp.array(np.random.rand(ncol), dtype=float, device=device)
+            y = wp.array(np.random.rand(nrow), dtype=float, device=device)
+        else:
+            block_type = wp.types.matrix(shape=block_shape, dtype=wp.float16)
+            vals = wp.array(np.random.rand(nnz, block_shape[0], block_shape[1]), dtype=wp.float16, device=device)
+            x = wp.array(np.random.rand(ncol, block_shape[1]), dtype=wp.vec(length=block_shape[1]), device=device)
+            y = wp.array(np.random.rand(nrow, block_shape[0]), dtype=wp.vec(length=block_shape[0]), device=device)
+
+        shape = (nrow * block_shape[0], ncol * block_shape[1])
+        ref = _triplets_to_dense(shape, rows, cols, vals)
+
+        A = bsr_zeros(nrow, ncol, block_type, device=device)
+        bsr_set_from_triplets(A, rows, cols, vals)
+        assert_np_equal(_bsr_to_dense(A), ref, 0.01)
+
+        # single-precision vectors and accumulation
+        mv_ref = -1.0 * (ref @ x.numpy().flatten()) + 2.0 * y.numpy().flatten()
+        bsr_mv(A, x, y, -1.0, 2.0)
+        assert_np_equal(y.numpy().flatten(), mv_ref, 0.05)
+
+        bsr_axpy(A, A, 0.5, -1.0)
+        assert_np_equal(_bsr_to_dense(A), -0.5 * ref, 0.01)
+
+        if block_shape == (1, 1):
+            transposed_block_type = block_type
+        else:
+            transposed_block_type = wp.types.matrix(shape=block_shape[::-1], dtype=wp.float16)
+        At = bsr_zeros(ncol, nrow, transposed_block_type, device=device)
+        bsr_set_transpose(At, A)
+        assert_np_equal(_bsr_to_dense(At), -0.5 * ref.T, 0.01)
+
+    return test_bsr_half
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -236,7 +575,26 @@ def register(parent):
 
     add_function_test(TestSparse, "test_csr_from_triplets", test_csr_from_triplets, devices=devices)
     add_function_test(TestSparse, "test_bsr_from_triplets", test_bsr_from_triplets, devices=devices)
+    add_function_test(
+        TestSparse, "test_bsr_from_triplets_topology", test_bsr_from_triplets_topology, devices=devices
+    )
+    add_function_test(TestSparse, "test_bsr_from_host_triplets", test_bsr_from_host_triplets, devices=devices)
     add_function_test(TestSparse, "test_bsr_get_diag", test_bsr_get_diag, devices=devices)
+    add_function_test(
+        TestSparse,
+        "test_bsr_block_diag_inverse_3",
+        make_test_bsr_block_diag_inverse(3, wp.float32),
+        devices=devices,
+    )
+    add_function_test(
+        TestSparse,
+        "test_bsr_block_diag_inverse_6",
+        make_test_bsr_block_diag_inverse(6, wp.float64),
+        devices=devices,
+    )
+    add_function_test(
+        TestSparse, "test_bsr_block_diag_inverse_empty", test_bsr_block_diag_inverse_empty, devices=devices
+    )
 
     add_function_test(TestSparse, "test_csr_transpose", make_test_bsr_transpose((1, 1), wp.float32), devices=devices)
     add_function_test(
@@ -249,10 +607,36 @@ def register(parent):
     add_function_test(TestSparse, "test_csr_axpy", make_test_bsr_axpy((1, 1), wp.float32), devices=devices)
     add_function_test(TestSparse, "test_bsr_axpy_1_3", make_test_bsr_axpy((1, 3), wp.float32), devices=devices)
     add_function_test(TestSparse, "test_bsr_axpy_3_3", make_test_bsr_axpy((3, 3), wp.float64), devices=devices)
+    add_function_test(TestSparse, "test_bsr_axpy_4_4", make_test_bsr_axpy((4, 4), wp.float32), devices=devices)
 
     add_function_test(TestSparse, "test_csr_mm", make_test_bsr_mm((1, 1), wp.float32), devices=devices)
     add_function_test(TestSparse, "test_bsr_mm_1_3", make_test_bsr_mm((1, 3), wp.float32), devices=devices)
     add_function_test(TestSparse, "test_bsr_mm_3_3", make_test_bsr_mm((3, 3), wp.float64), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mm_2_2", make_test_bsr_mm((2, 2), wp.float32), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mm_6_6", make_test_bsr_mm((6, 6), wp.float64), devices=devices)
+    add_function_test(
+        TestSparse,
+        "test_bsr_mm_reuse_topology",
+        make_test_bsr_mm_reuse_topology((3, 3), wp.float64),
+        devices=devices,
+    )
+    add_function_test(TestSparse, "test_bsr_mm_empty", test_bsr_mm_empty, devices=devices)
+
+    add_function_test(TestSparse, "test_csr_mv", make_test_bsr_mv((1, 1), wp.float32, 100), devices=devices)
+    add_function_test(TestSparse, "test_csr_mv_long_rows", make_test_bsr_mv((1, 1), wp.float64, 1000), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mv_1_3", make_test_bsr_mv((1, 3), wp.float32, 100), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mv_3_3", make_test_bsr_mv((3, 3), wp.float64, 100), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mv_6_6", make_test_bsr_mv((6, 6), wp.float32, 100), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mv_2_2", make_test_bsr_mv((2, 2), wp.float32, 100), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mv_4_4", make_test_bsr_mv((4, 4), wp.float64, 100), devices=devices)
+    add_function_test(TestSparse, "test_bsr_mv_empty", test_bsr_mv_empty, devices=devices)
+
+    add_function_test(TestSparse, "test_sell_mv_3_3", make_test_sell_mv((3, 3), wp.float64, 32, 64), devices=devices)
+    add_function_test(TestSparse, "test_sell_mv_2_1", make_test_sell_mv((2, 1), wp.float32, 8, 20), devices=devices)
+    add_function_test(TestSparse, "test_sell_mv_empty", test_sell_mv_empty, devices=devices)
+
+    add_function_test(TestSparse, "test_csr_half", make_test_bsr_half((1, 1)), devices=devices)
+    add_function_test(TestSparse, "test_bsr_half_3_2", make_test_bsr_half((3, 2)), devices=devices)
 
     return TestSparse
 
@@ -0,0 +1,179 @@
+import numpy as np
+import warp as wp
+
+from warp.sparse import bsr_zeros, bsr_set_from_triplets, bsr_mv
+from warp.sparse_distributed import (
+    bsr_distribute,
+    distribute_array,
+    distributed_cg,
+    distributed_dot,
+    distributed_mv,
+    gather_array,
+)
+from warp.tests.test_base import *
+
+wp.init()
+
+
+def _make_spd_matrix(block_shape, nrow, device, seed=42):
+    rng = np.random.default_rng(seed)
+
+    nnz = 6 * nrow
+    rows = rng.integers(0, nrow, nnz)
+    cols = np.clip(rows + rng.integers(-8, 9, nnz), 0, nrow - 1)
+    vals = rng.random((nnz, block_shape[0], block_shape[1]))
+
+    # symmetrize and make diagonally dominant
+    diag = np.arange(nrow)
+    diag_vals = np.tile(np.eye(block_shape[0]) * 20.0 * block_shape[0], (nrow, 1, 1))
+    rows, cols = np.concatenate((rows, cols, diag)), np.concatenate((cols, rows, diag))
+    vals = np.concatenate((vals, vals.transpose(0, 2, 1), diag_vals))
+
+    if block_shape == (1, 1):
+        block_type = wp.float64
+        vals = vals.reshape(-1)
+    else:
+        block_type = wp.types.matrix(shape=block_shape, dtype=wp.float64)
+
+    A = bsr_zeros(nrow, nrow, block_type, device=device)
+    bsr_set_from_triplets(
+        A,
+        wp.array(rows, dtype=int, device=device),
+        wp.array(cols, dtype=int, device=device),
+        wp.array(vals, dtype=block_type, device=device),
+    )
+    return A
+
+
+def _partition_devices(device):
+    # partitions may share a device, which exercises the exchange logic on single-GPU machines
+    return [device] * 3
+
+
+def make_test_distributed_mv(block_shape):
+    def test_distributed_mv(test, device):
+        A = _make_spd_matrix(block_shape, 100, device)
+        D = bsr_distribute(A, _partition_devices(device))
+
+        test.assertEqual(D.nrow, A.nrow)
+        test.assertEqual(sum(local.nnz + halo.nnz for local, halo in zip(D.local, D.halo)), A.nnz)
+
+        x = wp.array(np.random.rand(A.nrow, block_shape[1]), dtype=wp.float64, device=device)
+        y = wp.array(np.random.rand(A.nrow, block_shape[0]), dtype=wp.float64, device=device)
+        if block_shape[0] == 1:
+            x = x.reshape((-1,))
+            y = y.reshape((-1,))
+        else:
+            x = wp.array(x.numpy(), dtype=D.vector_dtype, device=device)
+            y = wp.array(y.numpy(), dtype=D.vector_dtype, device=device)
+        x_np = x.numpy()
+
+        x_parts = distribute_array(D, x)
+        y_parts = distribute_array(D, y)
+
+        bsr_mv(A, x, y, 2.0, -1.0)
+        distributed_mv(D, x_parts, y_parts, 2.0, -1.0)
+
+        assert_np_equal(gather_array(y_parts), y.numpy(), tol=1.0e-10)
+
+        test.assertAlmostEqual(distributed_dot(D, x_parts, y_parts), np.dot(x_np.flatten(), y.numpy().flatten()))
+
+    return test_distributed_mv
+
+
+def test_distributed_cg(test, device):
+    A = _make_spd_matrix((3, 3), 100, device)
+    D = bsr_distribute(A, _partition_devices(device), row_offsets=[0, 20, 70, 100])
+
+    b = wp.array(np.random.rand(A.nrow, 3), dtype=D.vector_dtype, device=device)
+    b_parts = distribute_array(D, b)
+    x_parts = distribute_array(D, wp.zeros_like(b))
+
+    iterations, resid, tol = distributed_cg(D, b_parts, x_parts, tol=1.0e-8, maxiter=300)
+    test.assertLessEqual(resid, tol)
+
+    # check residual with the undistributed matrix
+    x = wp.array(gather_array(x_parts), dtype=D.vector_dtype, device=device)
+    r = wp.clone(b)
+    bsr_mv(A, x, r, -1.0, 1.0)
+    test.assertLess(np.linalg.norm(r.numpy()), 1.0e-6 * np.linalg.norm(b.numpy()))
+
+
+def test_distributed_mv_empty_partitions(test, device):
+    # anti-diagonal matrix, the rows of the first partition only couple to the last one and the second has no rows
+    nrow = 20
+    rows = np.arange(nrow)
+    A = bsr_zeros(nrow, nrow, wp.float64, device=device)
+    bsr_set_from_triplets(
+        A,
+        wp.array(rows, dtype=int, device=device),
+        wp.array(nrow - 1 - rows, dtype=int, device=device),
+        wp.array(np.random.rand(nrow), dtype=wp.float64, device=device),
+    )
+    D = bsr_distribute(A, _partition_devices(device), row_offsets=[0, 10, 10, nrow])
+    test.assertEqual(D.local[0].nnz, 0)
+    test.assertEqual(D.local[1].nrow, 0)
+
+    x = wp.array(np.random.rand(nrow), dtype=wp.float64, device=device)
+    y = wp.array(np.random.rand(nrow), dtype=wp.float64, device=device)
+    x_parts = distribute_array(D, x)
+    y_parts = distribute_array(D, y)
+
+    bsr_mv(A, x, y, 2.0, -1.0)
+    distributed_mv(D, x_parts, y_parts, 2.0, -1.0)
+
+    assert_np_equal(gather_array(y_parts), y.numpy(), tol=1.0e-10)
+
+
+def test_distributed_multigpu(test, device):
+    devices = wp.get_cuda_devices()
+
+    A = _make_spd_matrix((1, 1), 200, devices[0])
+    D = bsr_distribute(A, devices)
+
+    x = wp.array(np.random.rand(A.nrow), dtype=wp.float64, device=devices[0])
+    y = wp.zeros_like(x)
+    x_parts = distribute_array(D, x)
+    y_parts = distribute_array(D, y)
+
+    bsr_mv(A, x, y)
+    distributed_mv(D, x_parts, y_parts)
+    wp.synchronize()
+
+    assert_np_equal(gather_array(y_parts), y.numpy(), tol=1.0e-6)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestSparseDistributed(parent):
+        pass
+
+    add_function_test(
+        TestSparseDistributed, "test_distributed_csr_mv", make_test_distributed_mv((1, 1)), devices=devices
+    )
+    add_function_test(
+        TestSparseDistributed, "test_distributed_bsr_mv_3_3", make_test_distributed_mv((3, 3)), devices=devices
+    )
+    add_function_test(
+        TestSparseDistributed, "test_distributed_bsr_mv_2_2", make_test_distributed_mv((2, 2)), devices=devices
+    )
+    add_function_test(TestSparseDistributed, "test_distributed_cg", test_distributed_cg, devices=devices)
+    add_function_test(
+        TestSparseDistributed,
+        "test_distributed_mv_empty_partitions",
+        test_distributed_mv_empty_partitions,
+        devices=devices,
+    )
+
+    if wp.get_cuda_device_count() > 1:
+        add_function_test(
+            TestSparseDistributed, "test_distributed_multigpu", test_distributed_multigpu, devices=["cuda:0"]
+        )
+
+    return TestSparseDistributed
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
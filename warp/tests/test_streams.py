@@ -32,6 +32,17 @@ def sum(a: wp.array(dtype=float), b: wp.array(dtype=float), c: wp.array(dtype=fl
     c[tid] = a[tid] + b[tid]
 
 
+@wp.func
+def scale_into(dst: wp.array(dtype=float), tid: int, value: float):
+    dst[tid] = 2.0 * value
+
+
+@wp.kernel
+def scale(src: wp.array(dtype=float), dst: wp.array(dtype=float)):
+    tid = wp.tid()
+    scale_into(dst, tid, src[tid])
+
+
 # number of elements to use for testing
 N = 10 * 1024 * 1024
 
@@ -368,6 +379,76 @@ def test_stream_scope_graph_mgpu(test, device):
     assert_np_equal(c0.numpy(), np.full(N, fill_value=2 * num_iters))
 
 
+def test_stream_auto_written_args(test, device):
+    for kernel in (inc, inc_new, sum, scale):
+        kernel.module.load(device)
+
+    test.assertEqual(inc.adj.written_args, {0})
+    test.assertEqual(inc_new.adj.written_args, {1})
+    test.assertEqual(sum.adj.written_args, {2})
+    test.assertEqual(scale.adj.written_args, {1})
+
+
+def test_stream_auto_scope(test, device):
+    a = wp.zeros(N, dtype=float, device=device)
+    b = wp.zeros(N, dtype=float, device=device)
+    a2 = wp.zeros(N, dtype=float, device=device)
+    b2 = wp.zeros(N, dtype=float, device=device)
+
+    with wp.ScopedAutoStreams(device, num_streams=2) as auto:
+        # independent chains interleaved, joined by the last launches
+        for _ in range(3):
+            wp.launch(inc, dim=N, inputs=[a], device=device)
+            wp.launch(inc, dim=N, inputs=[b], device=device)
+        wp.launch(scale, dim=N, inputs=[a, a2], device=device)
+        wp.launch(inc_new, dim=N, inputs=[b, b2], device=device)
+
+        # arrays allocated in the scope are ordered before the launches using them
+        c = wp.zeros(N, dtype=float, device=device)
+        wp.launch(sum, dim=N, inputs=[a2, b2, c], device=device)
+
+        # overwriting an array waits for the launches reading it
+        wp.launch(inc, dim=N, inputs=[a], device=device)
+
+        test.assertEqual(auto.launch_count, 10)
+
+    test.assertIsNone(device.auto_streams)
+    assert_np_equal(a.numpy(), np.full(N, fill_value=4.0))
+    assert_np_equal(c.numpy(), np.full(N, fill_value=10.0))
+
+
+def test_event_elapsed_time(test, device):
+    a = wp.zeros(N, dtype=float, device=device)
+
+    with wp.ScopedDevice(device):
+        start = wp.Event(device, enable_timing=True)
+        end = wp.Event(device, enable_timing=True)
+
+        wp.record_event(start)
+        for _ in range(10):
+            wp.launch(inc, dim=N, inputs=[a])
+        wp.record_event(end)
+
+        test.assertGreater(wp.get_event_elapsed_time(start, end), 0.0)
+
+        # events must be created with timing enabled
+        untimed = wp.record_event()
+        with test.assertRaises(RuntimeError):
+            wp.get_event_elapsed_time(start, untimed)
+
+        # timers measured with events don't synchronize, their times are added once available
+        times = {}
+        with wp.ScopedTimer("inc", print=False, dict=times, use_events=True) as timer:
+            wp.launch(inc, dim=N, inputs=[a])
+        wp.ScopedTimer.flush()
+
+        test.assertEqual(len(times["inc"]), 1)
+        test.assertGreater(times["inc"][0], 0.0)
+        test.assertEqual(timer.elapsed, times["inc"][0])
+
+    assert_np_equal(a.numpy(), np.full(N, fill_value=11.0))
+
+
 def register(parent):
     devices = wp.get_cuda_devices()
 
@@ -384,6 +465,12 @@ def register(parent):
     add_function_test(TestStreams, "test_stream_scope_wait_event", test_stream_scope_wait_event, devices=devices)
     add_function_test(TestStreams, "test_stream_scope_wait_stream", test_stream_scope_wait_stream, devices=devices)
 
+    add_function_test(
+        TestStreams, "test_stream_auto_written_args", test_stream_auto_written_args, devices=get_test_devices()
+    )
+    add_function_test(TestStreams, "test_stream_auto_scope", test_stream_auto_scope, devices=devices)
+    add_function_test(TestStreams, "test_event_elapsed_time", test_event_elapsed_time, devices=devices)
+
     if len(devices) > 1:
         add_function_test(TestStreams, "test_stream_arg_graph_mgpu", test_stream_arg_graph_mgpu)
         add_function_test(TestStreams, "test_stream_scope_graph_mgpu", test_stream_scope_graph_mgpu)
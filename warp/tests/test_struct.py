@@ -402,6 +402,44 @@ def test_nested_array_struct(test, device):
     wp.launch(struct2_reader, dim=2, inputs=[struct])
 
 
+mat32x32 = wp.types.matrix(shape=(32, 32), dtype=wp.float32)
+
+
+@wp.struct
+class LargeStruct:
+    weights: mat32x32
+    scale: float
+
+
+@wp.kernel
+def large_struct_kernel(s: LargeStruct, out: wp.array(dtype=float)):
+    tid = wp.tid()
+    out[tid] = s.weights[tid, tid] * s.scale
+
+
+def test_large_struct(test, device):
+    s = LargeStruct()
+    s.weights = mat32x32(*np.diag(np.arange(32, dtype=np.float32)).flatten())
+    s.scale = 2.0
+
+    out = wp.zeros(32, dtype=float, device=device)
+    wp.launch(large_struct_kernel, dim=32, inputs=[s, out], device=device)
+
+    # the struct is larger than the kernel parameters allow and goes through device memory
+    test.assertEqual(large_struct_kernel.adj.param_buffer_args, ["s"])
+    assert_np_equal(out.numpy(), 2.0 * np.arange(32))
+
+    # changes are uploaded by the next launch, also of recorded launches
+    cmd = wp.launch(large_struct_kernel, dim=32, inputs=[s, out], device=device, record_cmd=True)
+    s.scale = 3.0
+    cmd.launch()
+    assert_np_equal(out.numpy(), 3.0 * np.arange(32))
+
+    s.scale = 4.0
+    wp.launch(large_struct_kernel, dim=32, inputs=[s, out], device=device)
+    assert_np_equal(out.numpy(), 4.0 * np.arange(32))
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -422,6 +460,7 @@ def register(parent):
     add_kernel_test(TestStruct, kernel=test_return, name="test_return", dim=1, inputs=[], devices=devices)
     add_function_test(TestStruct, "test_nested_struct", test_nested_struct, devices=devices)
     add_function_test(TestStruct, "test_nested_array_struct", test_nested_array_struct, devices=devices)
+    add_function_test(TestStruct, "test_large_struct", test_large_struct, devices=devices)
     add_function_test(TestStruct, "test_struct_math_conversions", test_struct_math_conversions, devices=devices)
     add_function_test(
         TestStruct, "test_struct_default_attributes_python", test_struct_default_attributes_python, devices=devices
@@ -112,6 +112,172 @@ def test_tape_dot_product(test, device):
     assert_np_equal(tape.gradients[y].numpy(), x.numpy())
 
 
+@wp.kernel
+def decay_step(x: wp.array(dtype=float), force: wp.array(dtype=float), y: wp.array(dtype=float)):
+    tid = wp.tid()
+
+    y[tid] = x[tid] * 0.9 + force[tid] * x[tid] * x[tid]
+
+
+class RolloutState:
+    def __init__(self, dim, device):
+        self.x = wp.zeros(dim, dtype=float, device=device, requires_grad=True)
+        self.count = dim
+
+
+def test_tape_checkpoint(test, device):
+    dim = 4
+    num_steps = 10
+
+    force = wp.array(np.linspace(0.0, 0.05, dim), dtype=float, device=device, requires_grad=True)
+    x0 = np.linspace(0.5, 1.0, dim)
+
+    def step(state_in, state_out):
+        wp.launch(decay_step, dim=dim, inputs=[state_in.x, force], outputs=[state_out.x], device=device)
+
+    # reference gradients from a tape storing all states
+    states = [RolloutState(dim, device) for _ in range(num_steps + 1)]
+    states[0].x.assign(x0)
+    tape = wp.Tape()
+    with tape:
+        for i in range(num_steps):
+            step(states[i], states[i + 1])
+    tape.backward(grads={states[-1].x: wp.full(dim, 1.0, dtype=float, device=device)})
+
+    expected_x = states[-1].x.numpy()
+    expected_grad = states[0].x.grad.numpy()
+    expected_force_grad = force.grad.numpy()
+    force.grad.zero_()
+
+    for checkpoint_every in (1, 3, num_steps):
+        rollout = wp.CheckpointTape(
+            step, lambda: RolloutState(dim, device), num_steps=num_steps, checkpoint_every=checkpoint_every
+        )
+
+        state_0 = RolloutState(dim, device)
+        state_0.x.assign(x0)
+        state_n = rollout.forward(state_0)
+        assert_np_equal(state_n.x.numpy(), expected_x, tol=1e-6)
+
+        state_n.x.grad.fill_(1.0)
+        rollout.backward()
+        assert_np_equal(state_0.x.grad.numpy(), expected_grad, tol=1e-5)
+        assert_np_equal(force.grad.numpy(), expected_force_grad, tol=1e-5)
+        force.grad.zero_()
+
+    # 2 checkpoints, 4 + 1 segment states and 2 forward buffers
+    rollout = wp.CheckpointTape(step, lambda: RolloutState(dim, device), num_steps=num_steps)
+    test.assertEqual(rollout.checkpoint_every, 4)
+    test.assertEqual(rollout.num_states(), 9)
+
+    with test.assertRaises(RuntimeError):
+        wp.CheckpointTape(step, lambda: RolloutState(dim, device), num_steps=num_steps, memory_budget=64)
+
+
+def test_tape_capture_backward(test, device):
+    dim = 8
+
+    x = wp.array(np.linspace(0.0, 1.0, dim), dtype=wp.float32, device=device, requires_grad=True)
+    y = wp.zeros(dim, dtype=wp.float32, device=device, requires_grad=True)
+    z = wp.zeros(1, dtype=wp.float32, device=device, requires_grad=True)
+
+    tape = wp.Tape()
+    with tape:
+        wp.launch(kernel=mul_constant, dim=dim, inputs=[x], outputs=[y], device=device)
+        wp.launch(kernel=dot_product, dim=dim, inputs=[x, y], outputs=[z], device=device)
+
+    graph = tape.capture_backward(loss=z)
+
+    # replaying the graph zeroes the gradients, so they do not accumulate between launches
+    for _ in range(3):
+        wp.capture_launch(graph)
+        assert_np_equal(x.grad.numpy(), 4.0 * x.numpy())
+        assert_np_equal(y.grad.numpy(), x.numpy())
+
+    # the graph reads the current values of the arrays
+    x.assign(np.ones(dim))
+    wp.launch(kernel=mul_constant, dim=dim, inputs=[x], outputs=[y], device=device)
+    wp.capture_launch(graph)
+    assert_np_equal(x.grad.numpy(), 4.0 * np.ones(dim))
+
+
+def test_tape_lazy_grad(test, device):
+    dim = 8
+
+    lazy_grad = wp.config.lazy_grad
+    wp.config.lazy_grad = True
+    try:
+        x = wp.array(np.linspace(0.0, 1.0, dim), dtype=wp.float32, device=device, requires_grad=True)
+        y = wp.zeros(dim, dtype=wp.float32, device=device, requires_grad=True)
+        a = wp.array(np.ones(dim), dtype=wp.float32, device=device, requires_grad=True)
+        b = wp.zeros(dim, dtype=wp.float32, device=device, requires_grad=True)
+        z = wp.zeros(1, dtype=wp.float32, device=device, requires_grad=True)
+    finally:
+        wp.config.lazy_grad = lazy_grad
+
+    tape = wp.Tape()
+    with tape:
+        wp.launch(kernel=mul_constant, dim=dim, inputs=[x], outputs=[y], device=device)
+        wp.launch(kernel=mul_constant, dim=dim, inputs=[a], outputs=[b], device=device)
+        wp.launch(kernel=dot_product, dim=dim, inputs=[x, y], outputs=[z], device=device)
+
+    # forward launches don't allocate gradients
+    for arr in (x, y, a, b, z):
+        test.assertFalse(arr.grad_allocated)
+
+    tape.backward(loss=z)
+    assert_np_equal(x.grad.numpy(), 4.0 * x.numpy())
+    assert_np_equal(y.grad.numpy(), x.numpy())
+
+    # the launch on a and b doesn't contribute to the loss, so it is skipped and their gradients never allocated
+    test.assertFalse(a.grad_allocated)
+    test.assertFalse(b.grad_allocated)
+    test.assertEqual(tape.dirty_gradients, {x, y, z})
+
+    tape.zero()
+    test.assertEqual(len(tape.dirty_gradients), 0)
+    assert_np_equal(x.grad.numpy(), np.zeros(dim))
+    assert_np_equal(y.grad.numpy(), np.zeros(dim))
+
+    # accessing a lazy gradient allocates it, zero-filled
+    assert_np_equal(b.grad.numpy(), np.zeros(dim))
+    test.assertTrue(b.grad_allocated)
+
+
+@wp.kernel
+def matrix_sum(a: wp.array2d(dtype=float), out: wp.array(dtype=float)):
+    i, j = wp.tid()
+
+    wp.atomic_add(out, 0, a[i, j])
+
+
+def test_tape_zero_record_func(test, device):
+    m, n, k = 4, 5, 6
+
+    rng = np.random.default_rng(123)
+    A = wp.array2d(rng.integers(-3, 3, size=(m, k)), dtype=float, device=device, requires_grad=True)
+    B = wp.array2d(rng.integers(-3, 3, size=(k, n)), dtype=float, device=device, requires_grad=True)
+    C = wp.zeros((m, n), dtype=float, device=device, requires_grad=True)
+    D = wp.zeros((m, n), dtype=float, device=device, requires_grad=True)
+    loss = wp.zeros(1, dtype=float, device=device, requires_grad=True)
+
+    tape = wp.Tape()
+    with tape:
+        wp.matmul(A, B, C, D, device=device)
+        wp.launch(matrix_sum, dim=(m, n), inputs=[D, loss], device=device)
+
+    # the gradients of the matmul inputs are only written by the function recorded on the tape,
+    # they must still be cleared by every zero() following a backward pass
+    for _ in range(2):
+        tape.backward(loss=loss)
+        assert_np_equal(A.grad.numpy(), np.ones((m, n)) @ B.numpy().T)
+        assert_np_equal(B.grad.numpy(), A.numpy().T @ np.ones((m, n)))
+        tape.zero()
+
+    assert_np_equal(A.grad.numpy(), np.zeros((m, k)))
+    assert_np_equal(B.grad.numpy(), np.zeros((k, n)))
+
+
 def register(parent):
     devices = get_test_devices()
 
@@ -121,6 +287,10 @@ def register(parent):
     add_function_test(TestTape, "test_tape_mul_constant", test_tape_mul_constant, devices=devices)
     add_function_test(TestTape, "test_tape_mul_variable", test_tape_mul_variable, devices=devices)
     add_function_test(TestTape, "test_tape_dot_product", test_tape_dot_product, devices=devices)
+    add_function_test(TestTape, "test_tape_checkpoint", test_tape_checkpoint, devices=devices)
+    add_function_test(TestTape, "test_tape_capture_backward", test_tape_capture_backward, devices=wp.get_cuda_devices())
+    add_function_test(TestTape, "test_tape_lazy_grad", test_tape_lazy_grad, devices=devices)
+    add_function_test(TestTape, "test_tape_zero_record_func", test_tape_zero_record_func, devices=devices)
 
     return TestTape
 
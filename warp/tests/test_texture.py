@@ -0,0 +1,132 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+@wp.kernel
+def sample_texture(texture: wp.uint64, points: wp.array(dtype=wp.vec3), values: wp.array(dtype=float)):
+    tid = wp.tid()
+    values[tid] = wp.texture_sample_f(texture, points[tid])
+
+
+def address(i, n, mode):
+    if mode == wp.Texture3D.WRAP:
+        return i % n
+    if mode == wp.Texture3D.MIRROR:
+        m = i % (2 * n)
+        return np.where(m < n, m, 2 * n - 1 - m)
+    return np.clip(i, 0, n - 1)
+
+
+def texel(data, i, j, k, mode):
+    nx, ny, nz = data.shape
+    value = data[address(i, nx, mode), address(j, ny, mode), address(k, nz, mode)]
+    if mode == wp.Texture3D.BORDER:
+        inside = (i >= 0) & (i < nx) & (j >= 0) & (j < ny) & (k >= 0) & (k < nz)
+        value = np.where(inside, value, 0.0)
+    return value
+
+
+# trilinear filtering and its gradient with respect to the normalized coordinates
+def sample_linear(data, points, mode):
+    x = points * np.array(data.shape) - 0.5
+    x0 = np.floor(x).astype(int)
+    f = x - x0
+
+    value = np.zeros(len(points))
+    grad = np.zeros((len(points), 3))
+    for d in np.ndindex(2, 2, 2):
+        w = np.where(d, f, 1.0 - f)
+        v = texel(data, *(x0 + d).T, mode)
+        value += np.prod(w, axis=1) * v
+        for c in range(3):
+            dw = np.prod(np.delete(w, c, axis=1), axis=1) * (1.0 if d[c] else -1.0)
+            grad[:, c] += dw * v * data.shape[c]
+
+    return value, grad
+
+
+def test_texture_sample(test, device):
+    rng = np.random.default_rng(123)
+
+    data = rng.uniform(0.0, 1.0, size=(6, 7, 8)).astype(np.float32)
+    texels = np.stack(np.meshgrid(*(np.arange(n) for n in data.shape), indexing="ij"), axis=-1).reshape(-1, 3)
+    centers = (texels + 0.5) / data.shape
+    points_np = rng.uniform(-1.0, 2.0, size=(256, 3))
+
+    # the hardware filter of CUDA textures has an 8-bit weight precision
+    atol = 1e-5 if device.is_cpu else 1e-2
+
+    for mode in (wp.Texture3D.CLAMP, wp.Texture3D.WRAP, wp.Texture3D.MIRROR, wp.Texture3D.BORDER):
+        texture = wp.Texture3D(wp.array(data, dtype=float, device=device), address_mode=mode)
+        closest = wp.Texture3D(wp.array(data, dtype=float, device=device), wp.Texture3D.CLOSEST, mode)
+
+        points = wp.array(centers, dtype=wp.vec3, device=device)
+        values = wp.zeros(len(centers), dtype=float, device=device)
+        wp.launch(sample_texture, dim=len(centers), inputs=[texture.id, points, values], device=device)
+        assert_np_equal(values.numpy(), data.flatten(), tol=1e-5)
+
+        points = wp.array(points_np, dtype=wp.vec3, device=device, requires_grad=True)
+        values = wp.zeros(len(points_np), dtype=float, device=device, requires_grad=True)
+
+        tape = wp.Tape()
+        with tape:
+            wp.launch(sample_texture, dim=len(points_np), inputs=[texture.id, points, values], device=device)
+        tape.backward(grads={values: wp.full(len(points_np), 1.0, dtype=float, device=device)})
+
+        expected, expected_grad = sample_linear(data, points_np, mode)
+        assert_np_equal(values.numpy(), expected, tol=atol)
+        assert_np_equal(points.grad.numpy(), expected_grad, tol=1e-3)
+
+        wp.launch(sample_texture, dim=len(points_np), inputs=[closest.id, points, values], device=device)
+        expected = texel(data, *np.floor(points_np * data.shape).astype(int).T, mode)
+        assert_np_equal(values.numpy(), expected, tol=1e-5)
+
+
+def test_texture_half(test, device):
+    rng = np.random.default_rng(123)
+
+    data = rng.uniform(-1.0, 1.0, size=(5, 4, 3)).astype(np.float16)
+    points_np = rng.uniform(0.0, 1.0, size=(64, 3))
+
+    texture = wp.Texture3D(wp.array(data, dtype=wp.float16, device=device))
+    test.assertEqual(texture.dtype, wp.float16)
+
+    points = wp.array(points_np, dtype=wp.vec3, device=device)
+    values = wp.zeros(len(points_np), dtype=float, device=device)
+    wp.launch(sample_texture, dim=len(points_np), inputs=[texture.id, points, values], device=device)
+
+    expected, _ = sample_linear(data.astype(np.float32), points_np, wp.Texture3D.CLAMP)
+    assert_np_equal(values.numpy(), expected, tol=1e-2)
+
+    with test.assertRaises(RuntimeError):
+        wp.Texture3D(wp.zeros((4, 4), dtype=float, device=device))
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestTexture(parent):
+        pass
+
+    add_function_test(TestTexture, "test_texture_sample", test_texture_sample, devices=devices)
+    add_function_test(TestTexture, "test_texture_half", test_texture_half, devices=devices)
+
+    return TestTexture
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -0,0 +1,91 @@
+# Copyright (c) 2023 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+
+import unittest
+
+wp.init()
+
+
+@wp.kernel
+def tile_laplacian(a: wp.array(dtype=float), b: wp.array(dtype=float), out: wp.array(dtype=float)):
+    tid = wp.tid()
+
+    ta = wp.tile_load(a, 1)
+    tb = wp.tile_load(b, 2)
+
+    out[tid] = wp.tile_read(ta, -1) - 2.0 * wp.tile_read(ta, 0) + wp.tile_read(ta, 1) + wp.tile_read(tb, 2)
+
+
+@wp.kernel
+def tile_reload(a: wp.array(dtype=float), steps: int, out: wp.array(dtype=float)):
+    tid = wp.tid()
+
+    total = float(0.0)
+    for i in range(steps):
+        t = wp.tile_load(a, 4)
+        total += wp.tile_read(t, i)
+        wp.tile_sync()
+
+    out[tid] = total
+
+
+def clamped(a, offset):
+    return a[np.clip(np.arange(len(a)) + offset, 0, len(a) - 1)]
+
+
+def test_tile_stencil(test, device):
+    n = 1024
+    rng = np.random.default_rng(123)
+    a_np = rng.uniform(-1.0, 1.0, size=n).astype(np.float32)
+    b_np = rng.uniform(-1.0, 1.0, size=n).astype(np.float32)
+
+    a = wp.array(a_np, dtype=float, device=device)
+    b = wp.array(b_np, dtype=float, device=device)
+    out = wp.zeros(n, dtype=float, device=device)
+
+    wp.launch(tile_laplacian, dim=n, inputs=[a, b, out], device=device)
+
+    expected = clamped(a_np, -1) - 2.0 * a_np + clamped(a_np, 1) + clamped(b_np, 2)
+    assert_np_equal(out.numpy(), expected, tol=1e-5)
+
+    # offsets past the halo are clamped to it
+    wp.launch(tile_reload, dim=n, inputs=[a, 6, out], device=device)
+
+    expected = sum(clamped(a_np, min(i, 4)) for i in range(6))
+    assert_np_equal(out.numpy(), expected, tol=1e-5)
+
+
+def test_tile_launch_size(test, device):
+    a = wp.zeros(100, dtype=float, device=device)
+    out = wp.zeros(100, dtype=float, device=device)
+
+    with test.assertRaises(RuntimeError):
+        wp.launch(tile_laplacian, dim=100, inputs=[a, a, out], device=device)
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestTile(parent):
+        pass
+
+    add_function_test(TestTile, "test_tile_stencil", test_tile_stencil, devices=devices)
+    add_function_test(
+        TestTile, "test_tile_launch_size", test_tile_launch_size, devices=[d for d in devices if d.is_cuda]
+    )
+
+    return TestTile
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -0,0 +1,221 @@
+# Copyright (c) 2022 NVIDIA CORPORATION.  All rights reserved.
+# NVIDIA CORPORATION and its licensors retain all intellectual property
+# and proprietary rights in and to this software, related documentation
+# and any modifications thereto.  Any use, reproduction, disclosure or
+# distribution of this software and related documentation without an express
+# license agreement from NVIDIA CORPORATION is strictly prohibited.
+
+import numpy as np
+
+import warp as wp
+from warp.tests.test_base import *
+from warp.tests.test_mesh_query_ray import sphere_mesh_data
+
+wp.init()
+
+
+@wp.kernel
+def tlas_raycast(
+    tlas: wp.uint64,
+    ray_starts: wp.array(dtype=wp.vec3),
+    ray_dirs: wp.array(dtype=wp.vec3),
+    out_t: wp.array(dtype=float),
+    out_face: wp.array(dtype=int),
+    out_instance: wp.array(dtype=int),
+):
+    tid = wp.tid()
+
+    t = float(0.0)
+    u = float(0.0)
+    v = float(0.0)
+    sign = float(0.0)
+    n = wp.vec3()
+    f = int(0)
+    inst = int(0)
+
+    if wp.tlas_query_ray(tlas, ray_starts[tid], ray_dirs[tid], 1.0e6, t, u, v, sign, n, f, inst):
+        out_t[tid] = t
+        out_face[tid] = f
+        out_instance[tid] = inst
+    else:
+        out_t[tid] = -1.0
+        out_face[tid] = -1
+        out_instance[tid] = -1
+
+
+@wp.kernel
+def instance_raycast(
+    meshes: wp.array(dtype=wp.uint64),
+    transforms: wp.array(dtype=wp.transform),
+    ray_starts: wp.array(dtype=wp.vec3),
+    ray_dirs: wp.array(dtype=wp.vec3),
+    out_t: wp.array(dtype=float),
+    out_face: wp.array(dtype=int),
+    out_instance: wp.array(dtype=int),
+):
+    tid = wp.tid()
+
+    t = float(0.0)
+    u = float(0.0)
+    v = float(0.0)
+    sign = float(0.0)
+    n = wp.vec3()
+    f = int(0)
+
+    min_t = float(1.0e6)
+    min_face = int(-1)
+    min_instance = int(-1)
+
+    for i in range(meshes.shape[0]):
+        inv = wp.transform_inverse(transforms[i])
+        start = wp.transform_point(inv, ray_starts[tid])
+        dir = wp.transform_vector(inv, ray_dirs[tid])
+
+        if wp.mesh_query_ray(meshes[i], start, dir, min_t, t, u, v, sign, n, f):
+            min_t = t
+            min_face = f
+            min_instance = i
+
+    if min_instance >= 0:
+        out_t[tid] = min_t
+    else:
+        out_t[tid] = -1.0
+
+    out_face[tid] = min_face
+    out_instance[tid] = min_instance
+
+
+@wp.kernel
+def tlas_overlaps(
+    tlas: wp.uint64, lowers: wp.array(dtype=wp.vec3), uppers: wp.array(dtype=wp.vec3), counts: wp.array(dtype=int)
+):
+    tid = wp.tid()
+
+    query = wp.tlas_query_aabb(tlas, lowers[tid], uppers[tid])
+    index = int(0)
+    count = int(0)
+
+    while wp.bvh_query_next(query, index):
+        count += 1
+
+    counts[tid] = count
+
+
+def random_transforms(rng, n):
+    positions = rng.uniform(-5.0, 5.0, (n, 3))
+    rotations = rng.normal(size=(n, 4))
+    rotations /= np.linalg.norm(rotations, axis=1, keepdims=True)
+
+    return np.concatenate((positions, rotations), axis=1)
+
+
+def test_tlas_query_ray(test, device):
+    rng = np.random.default_rng(123)
+
+    # two different meshes instanced several times each
+    meshes = []
+    for res, scale in ((8, 1.0), (16, 0.5)):
+        vertices, triangles = sphere_mesh_data(res)
+        vertices = vertices * np.array([scale, 1.0, 2.0 * scale])
+        meshes.append(
+            wp.Mesh(
+                points=wp.array(vertices, dtype=wp.vec3, device=device),
+                indices=wp.array(triangles.flatten(), dtype=int, device=device),
+            )
+        )
+
+    num_instances = 40
+    instance_meshes = [meshes[i % 2] for i in range(num_instances)]
+    transforms = wp.array(random_transforms(rng, num_instances), dtype=wp.transform, device=device)
+
+    tlas = wp.Tlas(instance_meshes, transforms)
+
+    n = 1024
+    ray_starts = wp.array(rng.uniform(-6.0, 6.0, (n, 3)), dtype=wp.vec3, device=device)
+    ray_dirs = rng.normal(size=(n, 3))
+    ray_dirs = wp.array(ray_dirs / np.linalg.norm(ray_dirs, axis=1, keepdims=True), dtype=wp.vec3, device=device)
+
+    for it in range(2):
+        if it == 1:
+            # moving instances only requires a refit of the instance bounds
+            transforms.assign(random_transforms(rng, num_instances))
+            tlas.refit()
+
+        results = []
+        for i in range(2):
+            t = wp.zeros(n, dtype=float, device=device)
+            face = wp.zeros(n, dtype=int, device=device)
+            instance = wp.zeros(n, dtype=int, device=device)
+
+            if i == 0:
+                wp.launch(tlas_raycast, dim=n, inputs=[tlas.id, ray_starts, ray_dirs, t, face, instance], device=device)
+            else:
+                wp.launch(
+                    instance_raycast,
+                    dim=n,
+                    inputs=[tlas.meshes, transforms, ray_starts, ray_dirs, t, face, instance],
+                    device=device,
+                )
+
+            results.append((t.numpy(), face.numpy(), instance.numpy()))
+
+        test.assertTrue(np.sum(results[1][2] >= 0) > 0)
+
+        assert_np_equal(results[0][0], results[1][0], tol=1.0e-4)
+        assert_np_equal(results[0][1], results[1][1])
+        assert_np_equal(results[0][2], results[1][2])
+
+
+def test_tlas_query_aabb(test, device):
+    rng = np.random.default_rng(42)
+
+    vertices, triangles = sphere_mesh_data(8)
+    mesh = wp.Mesh(
+        points=wp.array(vertices, dtype=wp.vec3, device=device),
+        indices=wp.array(triangles.flatten(), dtype=int, device=device),
+    )
+
+    num_instances = 64
+    mesh_ids = wp.array(np.full(num_instances, mesh.id, dtype=np.uint64), dtype=wp.uint64, device=device)
+    positions = rng.uniform(-5.0, 5.0, (num_instances, 3))
+    identity = np.tile(np.array([0.0, 0.0, 0.0, 1.0]), (num_instances, 1))
+    transforms = wp.array(np.concatenate((positions, identity), axis=1), dtype=wp.transform, device=device)
+
+    tlas = wp.Tlas(mesh_ids, transforms)
+
+    n = 256
+    centers = rng.uniform(-6.0, 6.0, (n, 3))
+    lowers = wp.array(centers - 1.0, dtype=wp.vec3, device=device)
+    uppers = wp.array(centers + 1.0, dtype=wp.vec3, device=device)
+    counts = wp.zeros(n, dtype=int, device=device)
+
+    wp.launch(tlas_overlaps, dim=n, inputs=[tlas.id, lowers, uppers, counts], device=device)
+
+    # unrotated unit spheres, so the instance bounds are the translated mesh bounds
+    instance_lower = positions + vertices.min(axis=0)
+    instance_upper = positions + vertices.max(axis=0)
+
+    overlaps = np.all(
+        (instance_lower[None, :, :] <= (centers + 1.0)[:, None, :])
+        & (instance_upper[None, :, :] >= (centers - 1.0)[:, None, :]),
+        axis=2,
+    )
+
+    assert_np_equal(counts.numpy(), np.sum(overlaps, axis=1))
+
+
+def register(parent):
+    devices = get_test_devices()
+
+    class TestTlas(parent):
+        pass
+
+    add_function_test(TestTlas, "test_tlas_query_ray", test_tlas_query_ray, devices=devices)
+    add_function_test(TestTlas, "test_tlas_query_aabb", test_tlas_query_aabb, devices=devices)
+
+    return TestTlas
+
+
+if __name__ == "__main__":
+    c = register(unittest.TestCase)
+    unittest.main(verbosity=2)
@@ -467,6 +467,92 @@ def test_torch_autograd(test, device):
         assert passed.item()
 
 
+@wp.kernel
+def scale_vec3(x: wp.array(dtype=wp.vec3), s: float, y: wp.array(dtype=wp.vec3)):
+    tid = wp.tid()
+    y[tid] = x[tid] * s
+
+
+def test_torch_kernel_function(test, device):
+    import torch
+
+    torch_device = wp.device_to_torch(device)
+
+    op_fn = wp.torch.kernel_function(op_kernel, outputs={"y": "x"})
+    scale_fn = wp.torch.kernel_function(scale_vec3, outputs={"y": "x"})
+
+    # repeated calls reuse the recorded launches
+    for n in (16, 32):
+        x = torch.ones(n, dtype=torch.float32, device=torch_device, requires_grad=True)
+        y = op_fn(x)
+        assert_np_equal(y.detach().cpu().numpy(), np.full(n, -1.5))
+
+        y.sum().backward()
+        assert_np_equal(x.grad.cpu().numpy(), np.full(n, -2.0))
+
+    x = torch.arange(24, dtype=torch.float32, device=torch_device).reshape((8, 3)).requires_grad_()
+    y = scale_fn(x, 3.0)
+    test.assertEqual(y.shape, (8, 3))
+    assert_np_equal(y.detach().cpu().numpy(), 3.0 * np.arange(24).reshape((8, 3)))
+
+    # gradients compose with torch ops
+    (y * y).sum().backward()
+    assert_np_equal(x.grad.cpu().numpy(), 18.0 * np.arange(24).reshape((8, 3)))
+
+    test.assertEqual(len(op_fn.launches), 2)
+
+    with test.assertRaises(RuntimeError):
+        scale_fn(torch.ones(8, dtype=torch.float64, device=torch_device), 1.0)
+
+
+def test_torch_allocator(test, device):
+    import torch
+
+    torch_device = wp.device_to_torch(device)
+
+    # count the calls that reach the caching allocator
+    class CountingAllocator(wp.torch.TorchAllocator):
+        def __init__(self, device):
+            super().__init__(device)
+            self.allocs = {}
+
+        def alloc(self, size_in_bytes, stream):
+            ptr = super().alloc(size_in_bytes, stream)
+            self.allocs[ptr] = size_in_bytes
+            return ptr
+
+        def free(self, ptr, stream):
+            del self.allocs[ptr]
+            super().free(ptr, stream)
+
+    # memory allocated before the allocator changed is freed by its own allocator
+    b = wp.zeros(256, dtype=float, device=device)
+
+    allocator = CountingAllocator(device)
+    wp.set_allocator(device, allocator)
+    try:
+        test.assertIs(wp.get_allocator(device), allocator)
+
+        torch.cuda.synchronize(torch_device)
+        used = torch.cuda.memory_allocated(torch_device)
+
+        a = wp.zeros(1024, dtype=float, device=device)
+        wp.launch(inc, dim=a.size, inputs=[a], device=device)
+        assert_np_equal(a.numpy(), np.ones(1024))
+
+        test.assertEqual(list(allocator.allocs.values()), [a.capacity])
+        test.assertGreaterEqual(torch.cuda.memory_allocated(torch_device), used + a.capacity)
+
+        # arrays can be freed after the default allocator is restored
+        wp.set_allocator(device, None)
+        test.assertIsNone(wp.get_allocator(device))
+        del a
+        test.assertEqual(len(allocator.allocs), 0)
+        del b
+    finally:
+        wp.set_allocator(device, None)
+
+
 def test_torch_graph_torch_stream(test, device):
     """Capture Torch graph on Torch stream"""
 
@@ -640,8 +726,14 @@ def register(parent):
             add_function_test(TestTorch, "test_to_torch", test_to_torch, devices=torch_compatible_devices)
             add_function_test(TestTorch, "test_torch_zerocopy", test_torch_zerocopy, devices=torch_compatible_devices)
             add_function_test(TestTorch, "test_torch_autograd", test_torch_autograd, devices=torch_compatible_devices)
+            add_function_test(
+                TestTorch, "test_torch_kernel_function", test_torch_kernel_function, devices=torch_compatible_devices
+            )
 
         if torch_compatible_cuda_devices:
+            add_function_test(
+                TestTorch, "test_torch_allocator", test_torch_allocator, devices=torch_compatible_cuda_devices
+            )
             add_function_test(
                 TestTorch,
                 "test_torch_graph_torch_stream",
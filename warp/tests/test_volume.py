@@ -83,6 +83,67 @@ def test_volume_sample_grad_linear_f(volume: wp.uint64, points: wp.array(dtype=w
     expect_near(grad[1], expected_gy, 2.0e-4)
     expect_near(grad[2], expected_gz, 2.0e-4)
 
+@wp.kernel
+def test_volume_accessor_f(volume: wp.uint64, points: wp.array(dtype=wp.vec3)):
+    tid = wp.tid()
+
+    p = points[tid]
+    acc = wp.volume_accessor(volume)
+
+    expect_eq(wp.volume_sample_f(acc, p, wp.Volume.CLOSEST), wp.volume_sample_f(volume, p, wp.Volume.CLOSEST))
+    expect_eq(wp.volume_sample_f(acc, p, wp.Volume.LINEAR), wp.volume_sample_f(volume, p, wp.Volume.LINEAR))
+
+    grad = wp.vec3(0.0, 0.0, 0.0)
+    grad_ref = wp.vec3(0.0, 0.0, 0.0)
+    val = wp.volume_sample_grad_f(acc, p, wp.Volume.LINEAR, grad)
+    val_ref = wp.volume_sample_grad_f(volume, p, wp.Volume.LINEAR, grad_ref)
+    expect_eq(val, val_ref)
+    expect_eq(grad, grad_ref)
+
+    i = int(wp.floor(p[0]))
+    j = int(wp.floor(p[1]))
+    k = int(wp.floor(p[2]))
+
+    s2 = wp.volume_lookup_stencil2_f(acc, i, j, k)
+    for di in range(2):
+        for dj in range(2):
+            for dk in range(2):
+                expect_eq(s2[(di * 2 + dj) * 2 + dk], wp.volume_lookup_f(volume, i + di, j + dj, k + dk))
+
+    s3 = wp.volume_lookup_stencil3_f(acc, i, j, k)
+    for di in range(3):
+        for dj in range(3):
+            for dk in range(3):
+                expect_eq(s3[(di * 3 + dj) * 3 + dk], wp.volume_lookup_f(acc, i + di - 1, j + dj - 1, k + dk - 1))
+
+
+@wp.kernel
+def test_volume_atlas_f(atlas: wp.uint64, volumes: wp.array(dtype=wp.uint64), points: wp.array(dtype=wp.vec3)):
+    tid = wp.tid()
+
+    p = points[tid]
+    i = int(wp.floor(p[0]))
+    j = int(wp.floor(p[1]))
+    k = int(wp.floor(p[2]))
+
+    for index in range(volumes.shape[0]):
+        volume = volumes[index]
+
+        expect_eq(wp.volume_sample_f(atlas, index, p, wp.Volume.LINEAR), wp.volume_sample_f(volume, p, wp.Volume.LINEAR))
+        expect_eq(wp.volume_lookup_f(atlas, index, i, j, k), wp.volume_lookup_f(volume, i, j, k))
+
+        grad = wp.vec3(0.0, 0.0, 0.0)
+        grad_ref = wp.vec3(0.0, 0.0, 0.0)
+        val = wp.volume_sample_grad_f(atlas, index, p, wp.Volume.LINEAR, grad)
+        val_ref = wp.volume_sample_grad_f(volume, p, wp.Volume.LINEAR, grad_ref)
+        expect_eq(val, val_ref)
+        expect_eq(grad, grad_ref)
+
+        # the volumes of the atlas keep their transforms
+        q = wp.volume_index_to_world(wp.volume_atlas_get(atlas, index), p)
+        expect_eq(q, wp.volume_index_to_world(volume, p))
+
+
 @wp.kernel
 def test_volume_sample_local_f_linear_values(
     volume: wp.uint64, points: wp.array(dtype=wp.vec3), values: wp.array(dtype=wp.float32)
@@ -322,6 +383,43 @@ def test_volume_store_i(volume: wp.uint64, points: wp.array(dtype=wp.vec3), valu
     values[tid] = wp.volume_lookup_i(volume, i, j, k)
 
 
+@wp.kernel
+def test_volume_lookup_dense_f(volume: wp.uint64, values: wp.array3d(dtype=wp.float32)):
+    i, j, k = wp.tid()
+    values[i, j, k] = wp.volume_lookup_f(volume, i, j, k)
+
+
+@wp.kernel
+def test_volume_lookup_world_f(volume: wp.uint64, points: wp.array(dtype=wp.vec3), values: wp.array(dtype=wp.float32)):
+    tid = wp.tid()
+    q = wp.volume_world_to_index(volume, points[tid])
+    values[tid] = wp.volume_lookup_f(volume, int(wp.round(q[0])), int(wp.round(q[1])), int(wp.round(q[2])))
+
+
+@wp.kernel
+def test_volume_query_ray(
+    volume: wp.uint64,
+    origins: wp.array(dtype=wp.vec3),
+    hits: wp.array(dtype=wp.vec3),
+    spans: wp.array(dtype=wp.vec3),
+):
+    tid = wp.tid()
+    dir = wp.vec3(1.0, 0.0, 0.0)
+
+    t = float(0.0)
+    value = float(0.0)
+    hit = wp.volume_query_ray(volume, origins[tid], dir, 0.0, 1.0e6, t, value)
+
+    t0 = float(0.0)
+    t1 = float(0.0)
+    span = wp.volume_query_ray_span(volume, origins[tid], dir, 0.0, 1.0e6, t0, t1)
+
+    if hit:
+        hits[tid] = wp.vec3(1.0, t, value)
+    if span:
+        spans[tid] = wp.vec3(1.0, t0, t1)
+
+
 def register(parent):
     devices = get_test_devices()
     rng = np.random.default_rng(101215)
@@ -360,6 +458,8 @@ def register(parent):
     volumes = {}
     points = {}
     points_jittered = {}
+    atlases = {}
+    atlas_volume_ids = {}
     for value_type, path in volume_paths.items():
         volumes[value_type] = {}
         volume_data = open(path, "rb").read()
@@ -614,11 +714,215 @@ def register(parent):
                     np.testing.assert_equal(test_volume_tiles, tiles_sorted)
                     np.testing.assert_equal([0.25] * 3, voxel_size)
 
+        def test_volume_from_dense(self):
+            for device in devices:
+                if device.is_cpu:
+                    continue
+
+                # two blobs in opposite corners of a 20^3 array, with values below tolerance elsewhere
+                dense = np.full((20, 20, 20), 0.01, dtype=np.float32)
+                dense[1:4, 2:5, 3:6] = 1.0
+                dense[17:19, 18:20, 16:19] = -2.0
+
+                values = wp.array(dense, dtype=wp.float32, device=device)
+                volume = wp.Volume.load_from_dense(values, voxel_size=0.5, bg_value=0.0, tolerance=0.1)
+
+                tiles = volume.get_tiles().numpy()
+                tiles_sorted = tiles[np.lexsort(tiles.T[::-1])]
+                np.testing.assert_equal(tiles_sorted, [[0, 0, 0], [16, 16, 16]])
+                np.testing.assert_equal([0.5] * 3, np.array(volume.get_voxel_size()))
+
+                # allocated tiles hold the dense values, the rest is background
+                lookup = wp.zeros((24, 24, 24), dtype=wp.float32, device=device)
+                wp.launch(test_volume_lookup_dense_f, dim=lookup.shape, inputs=[volume.id, lookup], device=device)
+
+                expected = np.zeros((24, 24, 24), dtype=np.float32)
+                expected[0:8, 0:8, 0:8] = dense[0:8, 0:8, 0:8]
+                expected[16:20, 16:20, 16:20] = dense[16:20, 16:20, 16:20]
+                np.testing.assert_equal(lookup.numpy(), expected)
+
+        def test_volume_query_ray(self):
+            for device in devices:
+                if device.is_cpu:
+                    continue
+
+                # sphere of radius 3 centered at (19.75, 12, 12) with distances clamped to one voxel, the only
+                # allocated tile is [16, 24) x [8, 16) x [8, 16) and the rest of the ray crosses background
+                ijk = np.indices((32, 32, 32), dtype=np.float32).transpose(1, 2, 3, 0)
+                sdf = np.linalg.norm(ijk - np.array([19.75, 12.0, 12.0]), axis=3) - 3.0
+                dense = np.clip(sdf, -1.0, 1.0).astype(np.float32)
+
+                values = wp.array(dense, dtype=wp.float32, device=device)
+                volume = wp.Volume.load_from_dense(values, voxel_size=1.0, bg_value=1.0, tolerance=0.05)
+
+                origins = wp.array([[-20.0, 12.0, 12.0], [-20.0, 0.0, 0.0]], dtype=wp.vec3, device=device)
+                hits = wp.zeros(2, dtype=wp.vec3, device=device)
+                spans = wp.zeros(2, dtype=wp.vec3, device=device)
+                wp.launch(test_volume_query_ray, dim=2, inputs=[volume.id, origins, hits, spans], device=device)
+
+                hits = hits.numpy()
+                spans = spans.numpy()
+
+                # the surface is at x = 16.75, found between the voxels at x = 16 and x = 17
+                self.assertEqual(hits[0][0], 1.0)
+                self.assertLess(abs(-20.0 + hits[0][1] - 16.75), 0.1)
+                self.assertLess(hits[0][2], 0.0)
+
+                # the active span covers the voxels of the tile, each voxel spanning half a unit on either side
+                self.assertEqual(spans[0][0], 1.0)
+                np.testing.assert_allclose(spans[0][1:] - 20.0, [15.5, 23.5], atol=1e-4)
+
+                # the second ray only crosses empty space
+                self.assertEqual(hits[1][0], 0.0)
+                self.assertEqual(spans[1][0], 0.0)
+
+        def test_volume_quantize(self):
+            for device in devices:
+                if device.is_cpu:
+                    continue
+
+                x, y, z = np.meshgrid(*(np.arange(16),) * 3, indexing="ij")
+                dense = (np.sin(0.3 * x) + np.cos(0.2 * y) * z).astype(np.float32)
+                volume = wp.Volume.load_from_dense(wp.array(dense, dtype=wp.float32, device=device), bg_value=-5.0)
+
+                for bits in (4, 8, 16):
+                    quantized = volume.quantize(bits)
+                    np.testing.assert_equal(quantized.get_tiles().numpy(), volume.get_tiles().numpy())
+
+                    lookup = wp.zeros((20, 20, 20), dtype=wp.float32, device=device)
+                    wp.launch(test_volume_lookup_dense_f, dim=lookup.shape, inputs=[quantized.id, lookup], device=device)
+
+                    # codes span the range of each tile, outside of the allocated tiles lies the background value
+                    expected = np.full((20, 20, 20), -5.0, dtype=np.float32)
+                    expected[0:16, 0:16, 0:16] = dense
+                    atol = 0.5 * (dense.max() - dense.min()) / (2**bits - 1) + 1e-5
+                    np.testing.assert_allclose(lookup.numpy(), expected, atol=atol)
+
+                with self.assertRaises(RuntimeError):
+                    volume.quantize(3)
+
+        def test_volume_topology_edits(self):
+            for device in devices:
+                if device.is_cpu:
+                    continue
+
+                dense = rng.uniform(1.0, 2.0, size=(8, 8, 8)).astype(np.float32)
+                volume = wp.Volume.load_from_dense(wp.array(dense, dtype=wp.float32, device=device), bg_value=0.0)
+
+                def tiles(volume):
+                    return sorted(map(tuple, volume.get_tiles().numpy()))
+
+                def lookup(volume):
+                    values = wp.zeros((24, 24, 24), dtype=wp.float32, device=device)
+                    wp.launch(test_volume_lookup_dense_f, dim=values.shape, inputs=[volume.id, values], device=device)
+                    return values.numpy()
+
+                # dilating by a voxel allocates the 26 neighbors of the tile
+                volume.dilate(1)
+                self.assertEqual(tiles(volume), [(i, j, k) for i in (-8, 0, 8) for j in (-8, 0, 8) for k in (-8, 0, 8)])
+                np.testing.assert_equal(lookup(volume)[0:8, 0:8, 0:8], dense)
+                self.assertEqual(np.count_nonzero(lookup(volume)), dense.size)
+
+                # pruning releases the background tiles and keeps the grown buffer, and with it the id
+                volume_id = volume.id
+                volume.prune()
+                self.assertEqual(volume.id, volume_id)
+                self.assertEqual(tiles(volume), [(0, 0, 0)])
+
+                points = wp.array([[16, 17, 18]], dtype=wp.int32, device=device)
+                volume.activate_tiles(points)
+                self.assertEqual(volume.id, volume_id)
+                self.assertEqual(tiles(volume), [(0, 0, 0), (16, 16, 16)])
+
+                expected = np.zeros((24, 24, 24), dtype=np.float32)
+                expected[0:8, 0:8, 0:8] = dense
+                np.testing.assert_equal(lookup(volume), expected)
+
+        def test_volume_load_nvdb_file(self):
+            import struct
+            import tempfile
+            import zlib
+
+            grid = volumes["float"][devices[0].alias].array().numpy().tobytes()
+
+            def write_nvdb(path, codec):
+                data = grid if codec == 0 else struct.pack("<Q", len(grid)) + zlib.compress(grid)
+                name = b"density\0"
+                meta = bytearray(176)
+                struct.pack_into("<QQ", meta, 0, len(grid), len(data))
+                struct.pack_into("<I", meta, 136, len(name))
+                with open(path, "wb") as file:
+                    file.write(struct.pack("<QIHH", 0x304244566F6E614E, 32 << 21, 1, codec))
+                    file.write(meta + name + data)
+
+            with tempfile.TemporaryDirectory() as tmp:
+                paths = [os.path.join(tmp, "raw.nvdb"), os.path.join(tmp, "zip.nvdb")]
+                write_nvdb(paths[0], 0)
+                write_nvdb(paths[1], 1)
+
+                for device in devices:
+                    for path in paths:
+                        pending = wp.Volume.prefetch_from_nvdb(path, device=device)
+
+                        expected = wp.zeros((16, 16, 16), dtype=wp.float32, device=device)
+                        reference = volumes["float"][device.alias]
+                        wp.launch(test_volume_lookup_dense_f, dim=expected.shape, inputs=[reference.id, expected], device=device)
+
+                        for volume in (wp.Volume.load_from_nvdb(path, device=device), pending.wait()):
+                            self.assertEqual(volume.array().numpy().tobytes(), grid)
+
+                            lookup = wp.zeros((16, 16, 16), dtype=wp.float32, device=device)
+                            wp.launch(test_volume_lookup_dense_f, dim=lookup.shape, inputs=[volume.id, lookup], device=device)
+                            np.testing.assert_equal(lookup.numpy(), expected.numpy())
+
+                        with self.assertRaises(RuntimeError):
+                            pending.wait()
+
+        def test_volume_sdf_from_mesh(self):
+            for device in devices:
+                if device.is_cpu:
+                    continue
+
+                # unit cube centered at the origin
+                corners = np.array([[x, y, z] for x in (-0.5, 0.5) for y in (-0.5, 0.5) for z in (-0.5, 0.5)])
+                # fmt: off
+                faces = np.array([
+                    [0, 1, 3], [0, 3, 2], [4, 6, 7], [4, 7, 5], [0, 4, 5], [0, 5, 1],
+                    [2, 3, 7], [2, 7, 6], [0, 2, 6], [0, 6, 4], [1, 5, 7], [1, 7, 3],
+                ])
+                # fmt: on
+                mesh = wp.Mesh(
+                    points=wp.array(corners, dtype=wp.vec3, device=device),
+                    indices=wp.array(faces.flatten(), dtype=int, device=device),
+                    support_winding_number=True,
+                )
+
+                voxel_size = 0.05
+                narrow_band = 0.2
+                volume = wp.Volume.load_sdf_from_mesh(mesh, voxel_size=voxel_size, narrow_band=narrow_band)
+
+                points_np = rng.uniform(-0.8, 0.8, size=(1000, 3))
+                points = wp.array(points_np, dtype=wp.vec3, device=device)
+                values = wp.zeros(len(points_np), dtype=wp.float32, device=device)
+                wp.launch(test_volume_lookup_world_f, dim=len(points_np), inputs=[volume.id, points, values], device=device)
+
+                # analytic distance to the cube at the voxel centers, clamped to the narrow band
+                voxels = np.round(points_np / voxel_size) * voxel_size
+                q = np.abs(voxels) - 0.5
+                sdf = np.linalg.norm(np.maximum(q, 0.0), axis=1) + np.minimum(np.max(q, axis=1), 0.0)
+                expected = np.clip(sdf, -narrow_band, narrow_band)
+
+                np.testing.assert_allclose(values.numpy(), expected, atol=1e-4)
+
     for device in devices:
         points_jittered_np = point_grid + rng.uniform(-0.5, 0.5, size=point_grid.shape)
         points[device.alias] = wp.array(point_grid, dtype=wp.vec3, device=device)
         points_jittered[device.alias] = wp.array(points_jittered_np, dtype=wp.vec3, device=device)
 
+        atlas_volumes = [volumes["float"][device.alias], volumes["torus"][device.alias]]
+        atlases[device.alias] = wp.VolumeAtlas(atlas_volumes)
+        atlas_volume_ids[device.alias] = wp.array([volume.id for volume in atlas_volumes], dtype=wp.uint64, device=device)
+
         add_kernel_test(
             TestVolumes,
             test_volume_lookup_f,
@@ -647,6 +951,20 @@ def register(parent):
             inputs=[volumes["float"][device.alias].id, points_jittered[device.alias]],
             devices=[device.alias],
         )
+        add_kernel_test(
+            TestVolumes,
+            test_volume_accessor_f,
+            dim=len(point_grid),
+            inputs=[volumes["float"][device.alias].id, points_jittered[device.alias]],
+            devices=[device.alias],
+        )
+        add_kernel_test(
+            TestVolumes,
+            test_volume_atlas_f,
+            dim=len(point_grid),
+            inputs=[atlases[device.alias].id, atlas_volume_ids[device.alias], points_jittered[device.alias]],
+            devices=[device.alias],
+        )
 
         add_kernel_test(
             TestVolumes,
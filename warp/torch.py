@@ -62,6 +62,39 @@ def dtype_from_torch(torch_dtype):
 dtype_from_torch.type_map = None
 
 
+def dtype_to_torch(warp_dtype):
+    """Return the torch dtype corresponding to a Warp dtype, vector and matrix types map to their scalar type."""
+    # initialize lookup table on first call to defer torch import
+    if dtype_to_torch.type_map is None:
+        import torch
+
+        dtype_to_torch.type_map = {
+            warp.float64: torch.float64,
+            warp.float32: torch.float32,
+            warp.float16: torch.float16,
+            warp.int64: torch.int64,
+            warp.int32: torch.int32,
+            warp.int16: torch.int16,
+            warp.int8: torch.int8,
+            warp.uint8: torch.uint8,
+            warp.bool: torch.bool,
+            # torch doesn't support unsigned integers beyond uint8, alias them as signed
+            warp.uint64: torch.int64,
+            warp.uint32: torch.int32,
+            warp.uint16: torch.int16,
+        }
+
+    torch_dtype = dtype_to_torch.type_map.get(getattr(warp_dtype, "_wp_scalar_type_", warp_dtype))
+
+    if torch_dtype is not None:
+        return torch_dtype
+    else:
+        raise TypeError(f"Invalid or unsupported data type: {warp_dtype}")
+
+
+dtype_to_torch.type_map = None
+
+
 def dtype_is_compatible(torch_dtype, warp_dtype):
     """Evaluates whether the given torch dtype is compatible with the given warp dtype."""
     # initialize lookup table on first call to defer torch import
@@ -263,3 +296,272 @@ def stream_to_torch(stream_or_device=None):
     torch_stream._warp_stream = stream
 
     return torch_stream
+
+
+class TorchAllocator:
+    """Allocator that serves Warp device memory from the PyTorch CUDA caching allocator.
+
+    Install it with :func:`warp.set_allocator` so that Warp and PyTorch draw from the same memory pool::
+
+        wp.set_allocator("cuda:0", wp.torch.TorchAllocator("cuda:0"))
+
+    Blocks are allocated on the Warp stream that is current at allocation time and are returned to
+    the cache for that stream when freed, following the stream semantics of the caching allocator.
+    """
+
+    def __init__(self, device=None):
+        self.device = device_to_torch(device)
+
+    def alloc(self, size_in_bytes, stream):
+        import torch
+
+        return torch.cuda.caching_allocator_alloc(size_in_bytes, self.device, stream)
+
+    def free(self, ptr, stream):
+        import torch
+
+        torch.cuda.caching_allocator_delete(ptr)
+
+
+# describe a torch tensor as a warp array of the given type, without wrapping it in a warp.array
+def _array_ctype(t, array_type, grad=None):
+    dtype = array_type.dtype
+    if not dtype_is_compatible(t.dtype, dtype):
+        raise RuntimeError(f"Incompatible data types: {t.dtype} and {dtype}")
+
+    ctype_size = ctypes.sizeof(dtype._type_)
+
+    # the inner dimensions of vector and matrix types are part of the element
+    ndim = array_type.ndim
+    if t.dim() != ndim + len(getattr(dtype, "_shape_", ())):
+        raise RuntimeError(f"Tensor with shape {tuple(t.shape)} cannot be used as an array of {ndim}D {dtype}")
+
+    strides = tuple(s * ctype_size for s in t.stride()[:ndim])
+
+    return warp.types.array_t(
+        data=t.data_ptr(), grad=0 if grad is None else grad.data_ptr(), ndim=ndim, shape=t.shape, strides=strides
+    )
+
+
+class KernelFunction:
+    """A Warp kernel wrapped as a differentiable PyTorch function, see :func:`kernel_function`."""
+
+    def __init__(self, kernel, outputs, dim=None):
+        import torch
+
+        if kernel.is_generic:
+            raise RuntimeError(f"Generic kernel '{kernel.key}' must be specialized with wp.overload() before wrapping")
+
+        self.kernel = kernel
+        self.outputs = dict(outputs)
+        self.dim = dim
+
+        arg_names = [arg.label for arg in kernel.adj.args]
+        for arg in kernel.adj.args:
+            if warp.types.is_array(arg.type) and type(arg.type) is not warp.array:
+                raise RuntimeError(f"Argument '{arg.label}' of kernel '{kernel.key}' must be a regular array")
+
+        for name in self.outputs:
+            if name not in arg_names:
+                raise ValueError(f"Kernel '{kernel.key}' has no argument named '{name}'")
+            if not warp.types.is_array(kernel.adj.args[arg_names.index(name)].type):
+                raise ValueError(f"Output argument '{name}' of kernel '{kernel.key}' is not an array")
+
+        self.input_names = [name for name in arg_names if name not in self.outputs]
+
+        # cached launches per device and direction, their parameters are updated in place for every call
+        self.launches = {}
+
+        # Warp streams wrapping the torch streams used so far
+        self.streams = {}
+
+        func = self
+
+        class Function(torch.autograd.Function):
+            @staticmethod
+            def forward(ctx, *inputs):
+                return func._forward(ctx, *inputs)
+
+            @staticmethod
+            def backward(ctx, *grad_outputs):
+                return func._backward(ctx, *grad_outputs)
+
+        self.function = Function
+
+    def __call__(self, *inputs):
+        if len(inputs) != len(self.input_names):
+            raise RuntimeError(
+                f"Kernel function '{self.kernel.key}' takes {len(self.input_names)} inputs but {len(inputs)} were given"
+            )
+
+        outputs = self.function.apply(*inputs)
+        return outputs[0] if len(outputs) == 1 else outputs
+
+    def _get_launch(self, device, adjoint):
+        launch = self.launches.get((device, adjoint))
+        if launch is None:
+            launch = warp.context.Launch(self.kernel, device, adjoint=adjoint)
+            self.launches[(device, adjoint)] = launch
+        return launch
+
+    def _get_stream(self, torch_device):
+        import torch
+
+        torch_stream = torch.cuda.current_stream(torch_device)
+        stream = self.streams.get(torch_stream.cuda_stream)
+        if stream is None:
+            stream = stream_from_torch(torch_stream)
+            self.streams[torch_stream.cuda_stream] = stream
+        return stream
+
+    def _output_shape(self, name, values):
+        spec = self.outputs[name]
+        if isinstance(spec, str):
+            # same leading shape as another argument
+            arg_type = self._arg_type(spec)
+            return tuple(values[spec].shape[: arg_type.ndim]) if warp.types.is_array(arg_type) else (values[spec],)
+        elif callable(spec):
+            return tuple(spec(*[values[n] for n in self.input_names]))
+        elif isinstance(spec, int):
+            return (spec,)
+        else:
+            return tuple(spec)
+
+    def _arg_type(self, name):
+        for arg in self.kernel.adj.args:
+            if arg.label == name:
+                return arg.type
+
+    def _launch_dim(self, values):
+        if self.dim is None:
+            # default to the shape of the first output
+            name = next(iter(self.outputs))
+            return tuple(values[name].shape[: self._arg_type(name).ndim])
+        elif isinstance(self.dim, str):
+            return tuple(values[self.dim].shape[: self._arg_type(self.dim).ndim])
+        elif callable(self.dim):
+            return self.dim(*[values[n] for n in self.input_names])
+        else:
+            return self.dim
+
+    def _run(self, launch, device, torch_device):
+        if device.is_cuda:
+            with warp.ScopedStream(self._get_stream(torch_device)):
+                launch.launch()
+        else:
+            launch.launch()
+
+    def _forward(self, ctx, *inputs):
+        import torch
+
+        values = dict(zip(self.input_names, inputs))
+
+        tensors = [t for t in inputs if isinstance(t, torch.Tensor)]
+        if not tensors:
+            raise RuntimeError(f"Kernel function '{self.kernel.key}' needs at least one tensor input")
+        torch_device = tensors[0].device
+        device = device_from_torch(torch_device)
+
+        # outputs come from the torch caching allocator, zeroed since kernels may accumulate into them
+        outputs = []
+        for name in self.outputs:
+            dtype = self._arg_type(name).dtype
+            shape = self._output_shape(name, values) + tuple(getattr(dtype, "_shape_", ()))
+            outputs.append(torch.zeros(shape, dtype=dtype_to_torch(dtype), device=torch_device))
+        values.update(zip(self.outputs, outputs))
+
+        dim = self._launch_dim(values)
+
+        launch = self._get_launch(device, adjoint=False)
+        launch.set_dim(dim)
+        for i, arg in enumerate(self.kernel.adj.args):
+            value = values[arg.label]
+            if warp.types.is_array(arg.type):
+                launch.set_param_at_index_from_ctype(i, _array_ctype(value, arg.type))
+            else:
+                launch.set_param_at_index(i, value)
+
+        self._run(launch, device, torch_device)
+
+        ctx.dim = dim
+        ctx.device = device
+        ctx.torch_device = torch_device
+        ctx.scalars = {name: v for name, v in values.items() if not isinstance(v, torch.Tensor)}
+        ctx.tensor_names = [name for name, v in values.items() if isinstance(v, torch.Tensor)]
+        ctx.save_for_backward(*[values[name] for name in ctx.tensor_names])
+
+        for t in outputs:
+            if not t.is_floating_point():
+                ctx.mark_non_differentiable(t)
+
+        return tuple(outputs)
+
+    def _backward(self, ctx, *grad_outputs):
+        import torch
+
+        values = dict(ctx.scalars)
+        values.update(zip(ctx.tensor_names, ctx.saved_tensors))
+
+        grads = {}
+        for i, name in enumerate(self.input_names):
+            t = values[name]
+            if ctx.needs_input_grad[i] and isinstance(t, torch.Tensor) and t.is_floating_point():
+                grads[name] = torch.zeros_like(t)
+
+        for name, grad in zip(self.outputs, grad_outputs):
+            if not values[name].is_floating_point():
+                continue
+            grads[name] = torch.zeros_like(values[name]) if grad is None else grad.contiguous()
+
+        launch = self._get_launch(ctx.device, adjoint=True)
+        if launch.hooks.backward is None:
+            raise RuntimeError(f"Kernel '{self.kernel.key}' was built without a backward pass")
+        launch.set_dim(ctx.dim)
+        num_args = len(self.kernel.adj.args)
+        for i, arg in enumerate(self.kernel.adj.args):
+            value = values[arg.label]
+            if warp.types.is_array(arg.type):
+                grad = grads.get(arg.label)
+                launch.set_param_at_index_from_ctype(i, _array_ctype(value, arg.type, grad))
+                if grad is not None:
+                    launch.set_param_at_index_from_ctype(num_args + i, _array_ctype(grad, arg.type))
+                else:
+                    launch.set_param_at_index_from_ctype(num_args + i, warp.types.array_t())
+            else:
+                launch.set_param_at_index(i, value)
+
+        self._run(launch, ctx.device, ctx.torch_device)
+
+        return tuple(grads.get(name) for name in self.input_names)
+
+
+def kernel_function(kernel, outputs, dim=None):
+    """Wrap a Warp kernel as a differentiable PyTorch function.
+
+    The returned function takes the kernel arguments that are not outputs, in the kernel's argument order, as torch
+    tensors or Python scalars, and returns the output tensors. The outputs are allocated with the torch caching
+    allocator and zero-initialized, the kernel runs on the current torch stream of the tensors' device, and the
+    backward pass runs the kernel's adjoint directly without a :class:`warp.Tape`. The launches are recorded once
+    per device and only their parameters are updated on later calls.
+
+    Args:
+        kernel: The ``@wp.kernel`` to wrap, generic kernels must be specialized with :func:`warp.overload` first.
+        outputs (dict): Maps the name of each output array argument to its shape, given as a tuple, an int, the name
+            of an input argument whose leading shape it takes, or a callable that receives the inputs.
+        dim: The launch dimensions, given in the same forms as the output shapes, defaults to the shape of the first
+            output.
+
+    Returns:
+        KernelFunction: A callable that runs the kernel through ``torch.autograd``.
+
+    Example::
+
+        @wp.kernel
+        def scale(x: wp.array(dtype=float), s: float, y: wp.array(dtype=float)):
+            i = wp.tid()
+            y[i] = x[i] * s
+
+        scale_fn = wp.torch.kernel_function(scale, outputs={"y": "x"})
+        y = scale_fn(torch.ones(16, device="cuda", requires_grad=True), 2.0)
+    """
+    return KernelFunction(kernel, outputs, dim)
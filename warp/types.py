@@ -8,7 +8,9 @@
 import builtins
 import ctypes
 import hashlib
+import os
 import struct
+import weakref
 import zlib
 from typing import Any, Callable, Generic, List, Tuple, TypeVar, Union
 
@@ -867,6 +869,34 @@ class hash_grid_query_t:
         pass
 
 
+# definition just for kernel type (cannot be a parameter), see neighbor_list.h
+class neighbor_list_query_t:
+    def __init__(self):
+        pass
+
+
+# definition just for kernel type (cannot be a parameter), see topk.h, k is the compile-time capacity of the heap
+def topk_heap_t(k):
+    class topk_heap_t:
+        _wp_generic_type_str_ = "topk_heap_t"
+        _wp_type_params_ = [k]
+        _length_ = k
+
+    return topk_heap_t
+
+
+# definition just for kernel type (cannot be a parameter), see volume.h
+class volume_accessor_t:
+    def __init__(self):
+        pass
+
+
+# definition just for kernel type (cannot be a parameter), see tile.h
+class tile_t:
+    def __init__(self):
+        pass
+
+
 # maximum number of dimensions, must match array.h
 ARRAY_MAX_DIMS = 4
 LAUNCH_MAX_DIMS = 4
@@ -878,13 +908,37 @@ ARRAY_TYPE_FABRIC = 2
 ARRAY_TYPE_FABRIC_INDEXED = 3
 
 
+# largest extent of a single launch or array dimension, the native shapes and strides are 32-bit
+# while the total launch size and the element offsets are 64-bit, so more elements than this are
+# addressed through multi-dimensional launches and arrays
+MAX_DIM_SIZE = 2**31 - 1
+
+
+def check_dim_size(value, what):
+    if value > MAX_DIM_SIZE:
+        raise RuntimeError(
+            f"The {what} {value} exceeds the 32-bit limit of {MAX_DIM_SIZE}, use a multi-dimensional layout instead"
+        )
+
+
 # represents bounds for kernel launch (number of threads across multiple dimensions)
 class launch_bounds_t(ctypes.Structure):
-    _fields_ = [("shape", ctypes.c_int32 * LAUNCH_MAX_DIMS), ("ndim", ctypes.c_int32), ("size", ctypes.c_size_t)]
+    _fields_ = [
+        ("shape", ctypes.c_int32 * LAUNCH_MAX_DIMS),
+        ("ndim", ctypes.c_int32),
+        ("size", ctypes.c_size_t),
+        ("size_ptr", ctypes.c_uint64),
+        ("check", ctypes.c_uint64),  # out-of-bounds access record of kernels compiled in "checked" mode
+        ("launch", ctypes.c_uint64),
+    ]
+
+    def __init__(self, shape, size_ptr=0):
+        # indirect launches read their thread count from an int32 in device memory, capped at size
+        self.size_ptr = size_ptr
 
-    def __init__(self, shape):
         if isinstance(shape, int):
             # 1d launch
+            check_dim_size(shape, "launch dimension")
             self.ndim = 1
             self.size = shape
             self.shape[0] = shape
@@ -895,6 +949,7 @@ class launch_bounds_t(ctypes.Structure):
             self.size = 1
 
             for i in range(self.ndim):
+                check_dim_size(shape[i], "launch dimension")
                 self.shape[i] = shape[i]
                 self.size = self.size * shape[i]
 
@@ -924,6 +979,8 @@ class array_t(ctypes.Structure):
         self.grad = grad
         self.ndim = ndim
         for i in range(ndim):
+            check_dim_size(shape[i], "array dimension")
+            check_dim_size(strides[i], "array stride")
             self.shape[i] = shape[i]
             self.strides[i] = strides[i]
 
@@ -975,6 +1032,22 @@ class indexedarray_t(ctypes.Structure):
                 self.shape[i] = shape[i]
 
 
+class soaarray_t(ctypes.Structure):
+    _fields_ = [
+        ("planes", array_t),
+        ("shape", ctypes.c_int32 * ARRAY_MAX_DIMS),
+    ]
+
+    def __init__(self, planes, shape):
+        if planes is None:
+            self.planes = array().__ctype__()
+            for i in range(ARRAY_MAX_DIMS):
+                self.shape[i] = 0
+        else:
+            self.planes = planes.__ctype__()
+            self.shape[0] = shape[0]
+
+
 def type_ctype(dtype):
     if dtype == float:
         return ctypes.c_float
@@ -1198,6 +1271,15 @@ class array(Array):
     # (initialized when needed)
     _vars = None
 
+    def __new__(cls, *args, layout="aos", **kwargs):
+        # arrays of vectors stored as one plane per component are a separate array type, see soaarray
+        if layout == "soa":
+            return soaarray(**dict(zip(("data", "dtype", "shape"), args)), **kwargs)
+        elif layout != "aos":
+            raise ValueError(f"Invalid array layout '{layout}', expected 'aos' or 'soa'")
+
+        return super().__new__(cls)
+
     def __init__(
         self,
         data=None,
@@ -1209,11 +1291,13 @@ class array(Array):
         capacity=None,
         device=None,
         pinned=False,
+        managed=False,
         copy=True,
         owner=True,  # TODO: replace with deleter=None
         ndim=None,
         grad=None,
         requires_grad=False,
+        layout="aos",
     ):
         """Constructs a new Warp array object
 
@@ -1248,6 +1332,8 @@ class array(Array):
             requires_grad (bool): Whether or not gradients will be tracked for this array, see :class:`warp.Tape` for details
             grad (array): The gradient array to use
             pinned (bool): Whether to allocate pinned host memory, which allows asynchronous host-device transfers (only applicable with device="cpu")
+            managed (bool): Whether to allocate unified memory with ``cudaMallocManaged()``, which is accessible from the host and from kernels on any device and may exceed the device memory (only applicable with CUDA devices)
+            layout (str): Memory layout of arrays of vectors, "aos" to store the components of each element together or "soa" to store each component in its own plane, see :class:`warp.types.soaarray`
 
         """
 
@@ -1283,11 +1369,11 @@ class array(Array):
             # data or ptr, not both
             if ptr is not None:
                 raise RuntimeError("Can only construct arrays with either `data` or `ptr` arguments, not both")
-            self._init_from_data(data, dtype, shape, device, copy, pinned)
+            self._init_from_data(data, dtype, shape, device, copy, pinned, managed)
         elif ptr is not None:
-            self._init_from_ptr(ptr, dtype, shape, strides, capacity, device, owner, pinned)
+            self._init_from_ptr(ptr, dtype, shape, strides, capacity, device, owner, pinned, managed)
         elif shape is not None:
-            self._init_new(dtype, shape, strides, device, pinned)
+            self._init_new(dtype, shape, strides, device, pinned, managed)
         else:
             self._init_annotation(dtype, ndim or 1)
 
@@ -1297,13 +1383,13 @@ class array(Array):
                 # this will also check whether the gradient array is compatible
                 self.grad = grad
             else:
-                # allocate gradient if needed
+                # allocate gradient if needed, lazily allocated gradients are created on first access of grad
                 self._requires_grad = requires_grad
-                if requires_grad:
+                if requires_grad and not warp.config.lazy_grad:
                     with warp.ScopedStream(self.device.null_stream):
                         self._alloc_grad()
 
-    def _init_from_data(self, data, dtype, shape, device, copy, pinned):
+    def _init_from_data(self, data, dtype, shape, device, copy, pinned, managed):
         if not hasattr(data, "__len__"):
             raise RuntimeError(f"Data must be a sequence or array, got scalar {data}")
 
@@ -1416,12 +1502,12 @@ class array(Array):
 
         if device.is_cpu and not copy and not pinned:
             # reference numpy memory directly
-            self._init_from_ptr(arr.ctypes.data, dtype, shape, strides, None, device, False, False)
+            self._init_from_ptr(arr.ctypes.data, dtype, shape, strides, None, device, False, False, False)
             # keep a ref to the source array to keep allocation alive
             self._ref = arr
         else:
             # copy data into a new array
-            self._init_new(dtype, shape, None, device, pinned)
+            self._init_new(dtype, shape, None, device, pinned, managed)
             src = array(
                 ptr=arr.ctypes.data,
                 dtype=dtype,
@@ -1433,7 +1519,7 @@ class array(Array):
             )
             warp.copy(self, src)
 
-    def _init_from_ptr(self, ptr, dtype, shape, strides, capacity, device, owner, pinned):
+    def _init_from_ptr(self, ptr, dtype, shape, strides, capacity, device, owner, pinned, managed):
         if dtype == Any:
             raise RuntimeError("A concrete data type is required to create the array")
 
@@ -1465,14 +1551,18 @@ class array(Array):
         self.device = device
         self.owner = owner
         self.pinned = pinned if device.is_cpu else False
+        self.managed = managed if device.is_cuda else False
         self.is_contiguous = is_contiguous
 
-    def _init_new(self, dtype, shape, strides, device, pinned):
+    def _init_new(self, dtype, shape, strides, device, pinned, managed):
         if dtype == Any:
             raise RuntimeError("A concrete data type is required to create the array")
 
         device = warp.get_device(device)
 
+        if managed and not device.is_cuda:
+            raise RuntimeError(f"Managed arrays must be created on a CUDA device, got {device}")
+
         size = 1
         for d in shape:
             size *= d
@@ -1488,7 +1578,7 @@ class array(Array):
             capacity = shape[0] * strides[0]
 
         if capacity > 0:
-            ptr = device.allocator.alloc(capacity, pinned=pinned)
+            ptr = device.allocator.alloc(capacity, pinned=pinned, managed=managed)
             if ptr is None:
                 raise RuntimeError(f"Array allocation failed on device: {device} for {capacity} bytes")
         else:
@@ -1504,6 +1594,7 @@ class array(Array):
         self.device = device
         self.owner = True
         self.pinned = pinned if device.is_cpu else False
+        self.managed = managed
         self.is_contiguous = is_contiguous
 
     def _init_annotation(self, dtype, ndim):
@@ -1517,6 +1608,7 @@ class array(Array):
         self.device = None
         self.owner = False
         self.pinned = False
+        self.managed = False
         self.is_contiguous = False
 
     @property
@@ -1587,7 +1679,7 @@ class array(Array):
         if self.owner:
             # use CUDA context guard to avoid side effects during garbage collection
             with self.device.context_guard:
-                self.device.allocator.free(self.ptr, self.capacity, self.pinned)
+                self.device.allocator.free(self.ptr, self.capacity, self.pinned, self.managed)
 
     def __len__(self):
         return self.shape[0]
@@ -1687,6 +1779,7 @@ class array(Array):
                 strides=tuple(new_strides),
                 device=self.grad.device,
                 pinned=self.grad.pinned,
+                managed=self.grad.managed,
                 owner=False,
             )
             # store back-ref to stop data being destroyed
@@ -1701,6 +1794,7 @@ class array(Array):
             strides=tuple(new_strides),
             device=self.device,
             pinned=self.pinned,
+            managed=self.managed,
             owner=False,
             grad=new_grad,
         )
@@ -1720,11 +1814,52 @@ class array(Array):
     def __ctype__(self):
         if self.ctype is None:
             data = 0 if self.ptr is None else ctypes.c_uint64(self.ptr)
-            grad = 0 if self.grad is None or self.grad.ptr is None else ctypes.c_uint64(self.grad.ptr)
+            # launches don't allocate lazy gradients, whose C-representation is re-created once they are
+            grad = 0 if self._grad is None or self._grad.ptr is None else ctypes.c_uint64(self._grad.ptr)
             self.ctype = array_t(data=data, grad=grad, ndim=self.ndim, shape=self.shape, strides=self.strides)
 
         return self.ctype
 
+    # elementwise arithmetic builds lazy expressions evaluated by a single fused kernel, see warp.ArrayExpression
+    def __add__(self, y):
+        return warp.expression.ArrayExpression.binary("add", self, y)
+
+    def __radd__(self, x):
+        return warp.expression.ArrayExpression.binary("add", x, self)
+
+    def __sub__(self, y):
+        return warp.expression.ArrayExpression.binary("sub", self, y)
+
+    def __rsub__(self, x):
+        return warp.expression.ArrayExpression.binary("sub", x, self)
+
+    def __mul__(self, y):
+        return warp.expression.ArrayExpression.binary("mul", self, y)
+
+    def __rmul__(self, x):
+        return warp.expression.ArrayExpression.binary("mul", x, self)
+
+    def __truediv__(self, y):
+        return warp.expression.ArrayExpression.binary("div", self, y)
+
+    def __rtruediv__(self, x):
+        return warp.expression.ArrayExpression.binary("div", x, self)
+
+    def __neg__(self):
+        return -warp.expression.ArrayExpression.wrap(self)
+
+    def __lt__(self, y):
+        return warp.expression.ArrayExpression.binary("lt", self, y)
+
+    def __le__(self, y):
+        return warp.expression.ArrayExpression.binary("le", self, y)
+
+    def __gt__(self, y):
+        return warp.expression.ArrayExpression.binary("gt", self, y)
+
+    def __ge__(self, y):
+        return warp.expression.ArrayExpression.binary("ge", self, y)
+
     def __matmul__(self, other):
         """
         Enables A @ B syntax for matrix multiplication
@@ -1745,8 +1880,16 @@ class array(Array):
 
     @property
     def grad(self):
+        if self._grad is None and self._requires_grad:
+            self._alloc_grad()
         return self._grad
 
+    @property
+    def grad_allocated(self) -> builtins.bool:
+        """Whether the gradient is allocated, gradients of arrays requiring them are allocated on first access of
+        :attr:`grad` when ``warp.config.lazy_grad`` is enabled, until then they hold zeros."""
+        return self._grad is not None
+
     @grad.setter
     def grad(self, grad):
         if grad is None:
@@ -1773,7 +1916,7 @@ class array(Array):
 
     @requires_grad.setter
     def requires_grad(self, value: builtins.bool):
-        if value and self._grad is None:
+        if value and self._grad is None and not warp.config.lazy_grad:
             self._alloc_grad()
         elif not value:
             self._grad = None
@@ -1785,7 +1928,12 @@ class array(Array):
 
     def _alloc_grad(self):
         self._grad = array(
-            dtype=self.dtype, shape=self.shape, strides=self.strides, device=self.device, pinned=self.pinned
+            dtype=self.dtype,
+            shape=self.shape,
+            strides=self.strides,
+            device=self.device,
+            pinned=self.pinned,
+            managed=self.managed,
         )
         self._grad.zero_()
 
@@ -1854,9 +2002,11 @@ class array(Array):
             else:
                 warp.context.runtime.core.array_fill_host(carr_ptr, ARRAY_TYPE_REGULAR, cvalue_ptr, cvalue_size)
 
-    # equivalent to wrapping src data in an array and copying to self
+    # equivalent to wrapping src data in an array and copying to self, expressions are evaluated in place
     def assign(self, src):
-        if is_array(src):
+        if isinstance(src, warp.expression.ArrayExpression):
+            src.eval(out=self)
+        elif is_array(src):
             warp.copy(self, src)
         else:
             warp.copy(self, array(data=src, dtype=self.dtype, copy=False, device="cpu"))
@@ -1883,6 +2033,84 @@ class array(Array):
                 npshape = self.shape
             return np.empty(npshape, dtype=npdtype)
 
+    def numpy_async(self, ring=None):
+        """Start copying the array to the host without waiting for the device.
+
+        The copy is enqueued on the current stream of the array's device through a pinned staging buffer,
+        so the work enqueued afterwards overlaps with the transfer.  The data is available from the returned
+        :class:`warp.ReadbackFuture` once the stream reaches the copy.
+
+        Args:
+            ring: The :class:`warp.ReadbackRing` providing the staging buffer.  If None, the device's default ring is used.
+        """
+        if not self.device.is_cuda or not self.ptr:
+            return warp.context.ReadbackFuture(result=self.numpy())
+
+        if self.device.is_capturing:
+            raise RuntimeError(f"Cannot read back array on device {self.device} while graph capture is active")
+
+        if ring is None:
+            ring = self.device.readback_ring
+        elif ring.device != self.device:
+            raise RuntimeError(f"Readback ring from device {ring.device} cannot be used for arrays on {self.device}")
+
+        src = self if self.is_contiguous else self.contiguous()
+
+        slot = ring.acquire(self.size * type_size_in_bytes(self.dtype))
+        view = array(
+            ptr=slot.buffer.ptr, dtype=self.dtype, shape=self.shape, device="cpu", pinned=True, copy=False, owner=False
+        )
+        view._ref = slot.buffer
+
+        warp.copy(view, src)
+        warp.get_stream(self.device).record_event(slot.event)
+
+        slot.future = warp.context.ReadbackFuture(slot, view)
+        return slot.future
+
+    # cudaMemoryAdvise values of the hints accepted by advise(), the unset variants follow each value
+    _managed_advice = {"read_mostly": 1, "preferred_location": 3, "accessed_by": 5}
+
+    def prefetch(self, device=None):
+        """Migrate the pages of a managed array to a device ahead of their use.
+
+        The migration is enqueued on the current stream of the array's device.
+
+        Args:
+            device: The device to migrate to, ``"cpu"`` for the host.  If None, the array's device is used.
+        """
+        if not self.managed:
+            raise RuntimeError("Only managed arrays can be prefetched")
+
+        device = self.device if device is None else warp.get_device(device)
+        if self.ptr and not warp.context.runtime.core.memprefetch_managed(
+            self.device.context, self.ptr, self.capacity, device.ordinal
+        ):
+            raise RuntimeError(f"Failed to prefetch managed array to device {device}")
+
+    def advise(self, advice: str, device=None, unset=False):
+        """Give the driver a usage hint for the pages of a managed array.
+
+        Args:
+            advice: ``"read_mostly"`` to replicate read-only pages on the devices that access them,
+                ``"preferred_location"`` to keep the pages resident on ``device``, or
+                ``"accessed_by"`` to keep the pages mapped for ``device`` wherever they reside.
+            device: The device the hint refers to, ``"cpu"`` for the host.  If None, the array's device is used.
+            unset: Whether to remove the hint instead of setting it.
+        """
+        if not self.managed:
+            raise RuntimeError("Hints can only be given for managed arrays")
+
+        if advice not in array._managed_advice:
+            raise ValueError(f"Unknown managed memory advice '{advice}'")
+
+        value = array._managed_advice[advice] + int(unset)
+        device = self.device if device is None else warp.get_device(device)
+        if self.ptr and not warp.context.runtime.core.memadvise_managed(
+            self.device.context, self.ptr, self.capacity, value, device.ordinal
+        ):
+            raise RuntimeError(f"Failed to set '{advice}' advice on managed array")
+
     # return a ctypes cast of the array address
     # note #1: only CPU arrays support this method
     # note #2: the array must be contiguous
@@ -1927,6 +2155,55 @@ class array(Array):
             # scalar
             return list(a.flatten())
 
+    @staticmethod
+    def from_file(path, dtype, shape=None, offset=0, mmap=True, mode="r", device="cpu", requires_grad=False):
+        """Creates an array from the raw binary contents of a file, e.g.: written by ``ndarray.tofile()``
+
+        With ``mmap=True`` the file is mapped into memory and arrays on the CPU refer to the mapping without copying
+        it, so that kernels can process files larger than the memory, the OS reads and evicts their pages as they
+        are accessed. The mapping stays open as long as the array or views of it are alive. Arrays on CUDA devices
+        are copied from the mapping. Without ``mmap`` the file is read into memory, which CPU arrays also use
+        without making another copy.
+
+        Args:
+            path (str): Path of the file
+            dtype: Type of the elements, stored contiguously in the file
+            shape (tuple): Dimensions of the array, by default a 1D array of all the elements after ``offset``
+            offset (int): Position of the first element in the file, in bytes
+            mmap (bool): Whether to map the file into memory rather than reading it
+            mode (str): Access mode of the mapping as in ``numpy.memmap``: ``"r"`` for reading only, kernels must not
+                write to the array, ``"r+"`` to write changes back to the file, or ``"c"`` for copy-on-write pages
+            device (Devicelike): Device the array lives on
+            requires_grad (bool): Whether or not gradients will be tracked for this array
+        """
+        if dtype == int:
+            dtype = int32
+        elif dtype == float:
+            dtype = float32
+
+        if isinstance(dtype, warp.codegen.Struct):
+            npdtype = dtype.numpy_dtype()
+            dtype_shape = ()
+        else:
+            npdtype = warp_type_to_np_dtype.get(getattr(dtype, "_wp_scalar_type_", dtype))
+            dtype_shape = getattr(dtype, "_shape_", ())
+            if npdtype is None:
+                raise RuntimeError(f"Can't read arrays of type {warp.context.type_str(dtype)} from files")
+
+        if shape is None:
+            shape = ((os.path.getsize(path) - offset) // type_size_in_bytes(dtype),)
+        elif isinstance(shape, int):
+            shape = (shape,)
+        npshape = (*shape, *dtype_shape)
+
+        if mmap:
+            data = np.memmap(path, dtype=npdtype, mode=mode, offset=offset, shape=npshape)
+        else:
+            data = np.fromfile(path, dtype=npdtype, count=int(np.prod(npshape)), offset=offset).reshape(npshape)
+
+        # CPU arrays keep a reference to the mapping or the data read, see _init_from_data()
+        return array(data=data, dtype=dtype, shape=shape, device=device, copy=False, requires_grad=requires_grad)
+
     # convert data from one device to another, nop if already on device
     def to(self, device):
         device = warp.get_device(device)
@@ -1948,6 +2225,7 @@ class array(Array):
             shape=(self.size,),
             device=self.device,
             pinned=self.pinned,
+            managed=self.managed,
             copy=False,
             owner=False,
             grad=None if self.grad is None else self.grad.flatten(),
@@ -2005,6 +2283,7 @@ class array(Array):
             strides=None,
             device=self.device,
             pinned=self.pinned,
+            managed=self.managed,
             copy=False,
             owner=False,
             grad=None if self.grad is None else self.grad.reshape(shape),
@@ -2026,6 +2305,7 @@ class array(Array):
             strides=self.strides,
             device=self.device,
             pinned=self.pinned,
+            managed=self.managed,
             copy=False,
             owner=False,
             grad=None if self.grad is None else self.grad.view(dtype),
@@ -2071,6 +2351,7 @@ class array(Array):
             strides=tuple(strides),
             device=self.device,
             pinned=self.pinned,
+            managed=self.managed,
             copy=False,
             owner=False,
             grad=None if self.grad is None else self.grad.transpose(axes=axes),
@@ -2145,6 +2426,10 @@ class noncontiguous_array_base(Generic[T]):
         with warp.ScopedStream(self.device.null_stream):
             return self.contiguous().numpy()
 
+    # start an asynchronous host copy, see array.numpy_async()
+    def numpy_async(self, ring=None):
+        return self.contiguous().numpy_async(ring)
+
     # returns a flattened list of items in the array as a Python list
     def list(self):
         # use the CUDA default stream for synchronous behaviour with other streams
@@ -2249,6 +2534,7 @@ class indexedarray(noncontiguous_array_base[T]):
             self.ndim = data.ndim
             self.device = data.device
             self.pinned = data.pinned
+            self.managed = data.managed
 
             # determine shape from original data shape and index counts
             shape = list(data.shape)
@@ -2283,6 +2569,7 @@ class indexedarray(noncontiguous_array_base[T]):
             self.ndim = ndim or 1
             self.device = None
             self.pinned = False
+            self.managed = False
             self.shape = (0,) * self.ndim
 
         # update size (num elements)
@@ -2337,9 +2624,165 @@ def indexedarray4d(*args, **kwargs):
     return indexedarray(*args, **kwargs)
 
 
+class soaarray(noncontiguous_array_base[T]):
+    """One-dimensional array of vectors stored as one contiguous plane per component (structure of arrays)
+
+    Kernels access the elements as for regular arrays, e.g.: ``p = a[i]`` or ``a[i] = p``, loading and storing the
+    components of neighboring elements at consecutive addresses, which coalesces the accesses of neighboring threads on
+    GPU and lets CPU kernels load them with vector instructions. Kernel arguments are annotated with
+    ``wp.array(dtype=..., layout="soa")``, which is also how these arrays are usually constructed.
+
+    Args:
+        data (Union[list, tuple, ndarray]): Elements to construct the array from, converted as for :class:`warp.array`
+        dtype: Vector type of the elements, e.g.: :class:`warp.vec3`
+        shape (int): Number of elements of a new uninitialized array
+        device (Devicelike): Device the array lives on
+        requires_grad (bool): Whether gradients are tracked for this array, they are stored in the same layout
+        planes (array): Existing two-dimensional array of shape ``(dtype length, count)`` holding the components
+    """
+
+    # member attributes available during code-gen (e.g.: d = arr.shape[0])
+    # (initialized when needed)
+    _vars = None
+
+    def __init__(self, data=None, dtype=Any, shape=None, device=None, requires_grad=False, ndim=None, planes=None):
+        # only accessed in kernels and through strided views of the planes, never passed to the native array functions
+        super().__init__(None)
+
+        if dtype is not Any and not type_is_vector(dtype):
+            raise TypeError(f"Structure of arrays layout requires a vector data type, got {dtype}")
+        if ndim not in (None, 1):
+            raise ValueError("Structure of arrays layout only supports one-dimensional arrays")
+
+        if planes is None and data is not None:
+            if dtype is Any:
+                raise TypeError("Structure of arrays construction from data requires a vector data type")
+            aos = array(data, dtype=dtype, device="cpu")
+            if aos.ndim != 1:
+                raise ValueError("Structure of arrays layout only supports one-dimensional arrays")
+            planes = array(
+                np.ascontiguousarray(aos.numpy().T),
+                dtype=dtype._wp_scalar_type_,
+                device=device,
+                requires_grad=requires_grad,
+            )
+        elif planes is None and shape is not None:
+            shape = (shape,) if isinstance(shape, int) else tuple(shape)
+            if len(shape) != 1:
+                raise ValueError("Structure of arrays layout only supports one-dimensional arrays")
+            planes = array(
+                shape=(dtype._length_, shape[0]),
+                dtype=dtype._wp_scalar_type_,
+                device=device,
+                requires_grad=requires_grad,
+            )
+
+        self.planes = planes
+        self.ndim = 1
+
+        if planes is not None:
+            if planes.ndim != 2 or (dtype is not Any and planes.shape[0] != dtype._length_):
+                raise ValueError(f"Planes of a structure of arrays must have shape (length, count), got {planes.shape}")
+            if dtype is Any:
+                dtype = vector(planes.shape[0], planes.dtype)
+
+            self.dtype = dtype
+            self.device = planes.device
+            self.pinned = planes.pinned
+            self.managed = planes.managed
+            self.shape = (planes.shape[1],)
+        else:
+            # type annotation
+            self.dtype = dtype
+            self.device = None
+            self.pinned = False
+            self.managed = False
+            self.shape = (0,)
+
+        self.size = self.shape[0]
+
+    def __len__(self):
+        return self.shape[0]
+
+    def __str__(self):
+        if self.device is None:
+            # type annotation
+            return f"soaarray{self.dtype}"
+        else:
+            return str(self.numpy())
+
+    @property
+    def requires_grad(self):
+        return self.planes is not None and self.planes.requires_grad
+
+    @requires_grad.setter
+    def requires_grad(self, value: builtins.bool):
+        self.planes.requires_grad = value
+
+    @property
+    def grad(self):
+        if self.planes is None or self.planes.grad is None:
+            return None
+        return soaarray(dtype=self.dtype, planes=self.planes.grad)
+
+    # construct a C-representation of the array for passing to kernels
+    def __ctype__(self):
+        return soaarray_t(self.planes, self.shape)
+
+    @property
+    def vars(self):
+        # member attributes available during code-gen (e.g.: d = arr.shape[0])
+        # Note: we use a shared dict for all soaarray instances
+        if soaarray._vars is None:
+            soaarray._vars = {"shape": warp.codegen.Var("shape", shape_t)}
+        return soaarray._vars
+
+    # return a copy with the elements stored contiguously
+    def contiguous(self):
+        a = warp.empty(self.shape, dtype=self.dtype, device=self.device)
+        warp.copy(a, self)
+        return a
+
+    def to(self, device):
+        device = warp.get_device(device)
+        if self.device == device:
+            return self
+        else:
+            return soaarray(dtype=self.dtype, planes=warp.clone(self.planes, device=device))
+
+    def numpy(self):
+        return np.ascontiguousarray(self.planes.numpy().T)
+
+    def fill_(self, value):
+        value = self.dtype(value)
+        for c in range(self.dtype._length_):
+            self.planes[c].fill_(value[c])
+
+
+def array_components(a):
+    # strided view of the components of an array of vectors, where the innermost dimension indexes the components
+    if isinstance(a, soaarray):
+        return a.planes.transpose()
+
+    if not isinstance(a, array) or not type_is_vector(a.dtype):
+        raise RuntimeError(f"Expected an array of vectors, got {type(a)} of {a.dtype}")
+
+    scalar_type = a.dtype._wp_scalar_type_
+    return array(
+        ptr=a.ptr,
+        dtype=scalar_type,
+        shape=(*a.shape, a.dtype._length_),
+        strides=(*a.strides, type_size_in_bytes(scalar_type)),
+        device=a.device,
+        pinned=a.pinned,
+        managed=a.managed,
+        owner=False,
+    )
+
+
 from warp.fabric import fabricarray, indexedfabricarray  # noqa: E402
 
-array_types = (array, indexedarray, fabricarray, indexedfabricarray)
+array_types = (array, indexedarray, soaarray, fabricarray, indexedfabricarray)
 
 
 def array_type_id(a):
@@ -2355,8 +2798,55 @@ def array_type_id(a):
         raise ValueError("Invalid array type")
 
 
+def _clone_device(name, src_device, device):
+    from warp.context import runtime
+
+    device = runtime.get_device(device)
+
+    if not src_device.is_cuda or not device.is_cuda:
+        raise RuntimeError(f"{name} clones are only supported between CUDA devices")
+
+    # copies read the source directly instead of staging through the host when the devices are peers
+    if device.can_access(src_device):
+        device.enable_peer_access(src_device)
+
+    return device
+
+
+# self overlap queries of a pass b=None, their native functions take no second object and no transform
+def _query_overlap(name, a, b, pairs, count, margin, xform, query_host, query_device):
+    if b is not None and b.device != a.device:
+        raise RuntimeError(f"{name} overlap queries require both objects and all outputs to live on the same device")
+
+    if pairs.device != a.device or count.device != a.device:
+        raise RuntimeError(f"{name} overlap queries require both objects and all outputs to live on the same device")
+
+    if pairs.dtype != vec2i or not pairs.is_contiguous:
+        raise RuntimeError(f"{name} overlap pairs should be a contiguous array of type wp.vec2i")
+
+    if count.dtype != int32 or len(count) < 1:
+        raise RuntimeError(f"{name} overlap count should be an array of type wp.int32 with at least one element")
+
+    outputs = (ctypes.c_void_p(pairs.ptr), len(pairs), ctypes.c_void_p(count.ptr))
+
+    if b is None:
+        args = (a.id, margin, *outputs)
+    else:
+        xform = transformf() if xform is None else transformf(xform.p, xform.q)
+        args = (a.id, b.id, xform, margin, *outputs)
+
+    if a.device.is_cpu:
+        query_host(*args)
+    else:
+        query_device(*args)
+
+        from warp.context import runtime
+
+        runtime.verify_cuda_device(a.device)
+
+
 class Bvh:
-    def __init__(self, lowers, uppers):
+    def __init__(self, lowers, uppers, wide=False, level_refit=False):
         """Class representing a bounding volume hierarchy.
 
         Attributes:
@@ -2366,6 +2856,10 @@ class Bvh:
         Args:
             lowers (:class:`warp.array`): Array of lower bounds :class:`warp.vec3`
             uppers (:class:`warp.array`): Array of upper bounds :class:`warp.vec3`
+            wide (bool): If true an additional 4-wide node layout with quantized child bounds is built, which
+                `wp.bvh_query_aabb()` and `wp.bvh_query_ray()` traverse with fewer memory loads
+            level_refit (bool): If true CUDA refits process the tree one level at a time instead of walking up
+                from the leaves with atomic counters, which is faster for trees that are refit frequently
         """
 
         if len(lowers) != len(uppers):
@@ -2399,6 +2893,15 @@ class Bvh:
                 self.device.context, get_data(lowers), get_data(uppers), int(len(lowers))
             )
 
+        if wide:
+            if self.device.is_cpu:
+                runtime.core.bvh_build_wide_host(self.id)
+            else:
+                runtime.core.bvh_build_wide_device(self.id)
+
+        if level_refit and self.device.is_cuda:
+            runtime.core.bvh_build_refit_levels_device(self.id)
+
     def __del__(self):
         try:
             from warp.context import runtime
@@ -2413,6 +2916,32 @@ class Bvh:
         except Exception:
             pass
 
+    def clone(self, device):
+        """Returns a copy of this BVH on another CUDA device without rebuilding the tree.
+
+        The nodes, the wide layout and the level refit schedule are copied device to device, directly when
+        peer access between the devices is available, and ``lowers`` and ``uppers`` are cloned to ``device``.
+        The copies are issued on the current stream of ``device``, so work on this BVH's device that writes
+        its bounds must be synchronized beforehand.
+
+        Args:
+            device (Devicelike): CUDA device to copy the BVH to
+        """
+
+        from warp.context import runtime
+
+        device = _clone_device("Bvh", self.device, device)
+
+        bvh = Bvh.__new__(Bvh)
+        bvh.device = device
+        bvh.lowers = warp.context.clone(self.lowers, device)
+        bvh.uppers = warp.context.clone(self.uppers, device)
+        bvh.id = runtime.core.bvh_clone_to_device(
+            device.context, self.id, ctypes.c_void_p(bvh.lowers.ptr), ctypes.c_void_p(bvh.uppers.ptr)
+        )
+
+        return bvh
+
     def refit(self):
         """Refit the BVH. This should be called after users modify the `lowers` and `uppers` arrays."""
 
@@ -2424,6 +2953,64 @@ class Bvh:
             runtime.core.bvh_refit_device(self.id)
             runtime.verify_cuda_device(self.device)
 
+    def query_overlap(self, other, pairs, count, margin=0.0, xform=None):
+        """Find all pairs of overlapping bounds between this BVH and another one by traversing both trees at once.
+
+        The pairs ``(i, j)`` of bounds ``i`` of this BVH and ``j`` of ``other`` that overlap are written to
+        ``pairs`` in no particular order. The total number of pairs is written to ``count[0]`` and may exceed
+        the length of ``pairs``, in which case only the first ``len(pairs)`` pairs are stored and the query
+        should be repeated with a larger array. On CUDA devices the outputs stay on the device.
+
+        Args:
+            other (:class:`warp.Bvh`): BVH to test against, must live on the same device
+            pairs (:class:`warp.array`): Output array of type :class:`warp.vec2i`
+            count (:class:`warp.array`): Output array of type :class:`warp.int32` receiving the number of pairs
+            margin (float): Distance by which the bounds of this BVH are grown before testing them
+            xform (:class:`warp.transform`): Transform from the frame of ``other`` into the frame of this BVH, identity if None
+        """
+
+        from warp.context import runtime
+
+        _query_overlap(
+            "Bvh",
+            self,
+            other,
+            pairs,
+            count,
+            margin,
+            xform,
+            runtime.core.bvh_query_bvh_overlap_host,
+            runtime.core.bvh_query_bvh_overlap_device,
+        )
+
+    def query_self_overlap(self, pairs, count, margin=0.0):
+        """Find all pairs of distinct overlapping bounds of this BVH by traversing the tree against itself.
+
+        Each pair ``(i, j)`` of overlapping bounds is written once with ``i < j``, in no particular order. The
+        output counters are reserved once per CUDA warp, so dense overlaps don't contend on them. The total number
+        of pairs is written to ``count[0]`` and may exceed the length of ``pairs``, in which case only the first
+        ``len(pairs)`` pairs are stored. On CUDA devices the outputs stay on the device.
+
+        Args:
+            pairs (:class:`warp.array`): Output array of type :class:`warp.vec2i`
+            count (:class:`warp.array`): Output array of type :class:`warp.int32` receiving the number of pairs
+            margin (float): Distance by which one side of each pair of bounds is grown before testing them
+        """
+
+        from warp.context import runtime
+
+        _query_overlap(
+            "Bvh",
+            self,
+            None,
+            pairs,
+            count,
+            margin,
+            None,
+            runtime.core.bvh_query_self_overlap_host,
+            runtime.core.bvh_query_self_overlap_device,
+        )
+
 
 class Mesh:
     from warp.codegen import Var
@@ -2434,18 +3021,51 @@ class Mesh:
         "indices": Var("indices", array(dtype=int32)),
     }
 
-    def __init__(self, points=None, indices=None, velocities=None, support_winding_number=False):
+    # meshes supporting winding numbers whose solid angle data is out of date, by id
+    _stale_winding_number = weakref.WeakValueDictionary()
+
+    def __init__(
+        self,
+        points=None,
+        indices=None,
+        velocities=None,
+        support_winding_number=False,
+        wide_bvh=False,
+        level_refit=False,
+        quantize_points=False,
+        reorder=False,
+        reorder_points=False,
+    ):
         """Class representing a triangle mesh.
 
         Attributes:
             id: Unique identifier for this mesh object, can be passed to kernels.
             device: Device this object lives on, all buffers must live on the same device.
+            triangle_permutation: Array of the original index of each triangle if the mesh was built with ``reorder``,
+                maps the faces returned by the queries back to the input order, None otherwise
+            point_permutation: Array of the original index of each point if the mesh was built with
+                ``reorder_points``, None otherwise
 
         Args:
             points (:class:`warp.array`): Array of vertex positions of type :class:`warp.vec3`
             indices (:class:`warp.array`): Array of triangle indices of type :class:`warp.int32`, should be a 1d array with shape (num_tris, 3)
             velocities (:class:`warp.array`): Array of vertex velocities of type :class:`warp.vec3` (optional)
-            support_winding_number (bool): If true the mesh will build additional datastructures to support `wp.mesh_query_point_sign_winding_number()` queries
+            support_winding_number (bool): If true the mesh will build additional datastructures to support `wp.mesh_query_point_sign_winding_number()` queries.
+                The solid angle data is computed lazily, before the first launch of a kernel that queries
+                winding numbers after a `refit()`, see :meth:`update_winding_number`
+            wide_bvh (bool): If true an additional 4-wide BVH layout with quantized child bounds is built, which speeds up
+                `wp.mesh_query_ray()` on large meshes
+            level_refit (bool): If true CUDA refits process the BVH one level at a time instead of walking up
+                from the leaves with atomic counters, which is faster for meshes that are refit every step
+            quantize_points (bool): If true the queries read 16-bit vertex positions relative to the mesh bounds instead of
+                `points`, which halves the vertex bandwidth of large static meshes. Query results are exact for the
+                quantized triangles, which differ from the input by up to 1/65535 of the mesh extent per axis.
+                :meth:`refit_partial` falls back to a full refit for quantized meshes
+            reorder (bool): If true the triangles of ``indices`` are permuted in place to the order of the BVH leaves,
+                so that the queries load the triangles of neighboring leaves from the same cache lines. The
+                original index of each triangle is kept in :attr:`triangle_permutation`
+            reorder_points (bool): If true the triangles are reordered and ``points`` and ``velocities`` are also
+                permuted in place, by the first triangle that uses them, see :attr:`point_permutation`
         """
 
         if points.device != indices.device:
@@ -2467,6 +3087,7 @@ class Mesh:
         self.points = points
         self.velocities = velocities
         self.indices = indices
+        self.support_winding_number = support_winding_number
 
         from warp.context import runtime
 
@@ -2490,6 +3111,39 @@ class Mesh:
                 int(support_winding_number),
             )
 
+        self.triangle_permutation = None
+        self.point_permutation = None
+
+        # the reordering must precede the other layouts, which are built from the leaves
+        if reorder or reorder_points:
+            self.triangle_permutation = warp.empty(indices.size // 3, dtype=int32, device=self.device)
+            if reorder_points:
+                self.point_permutation = warp.empty(len(points), dtype=int32, device=self.device)
+
+            point_permutation_ptr = self.point_permutation.ptr if reorder_points else None
+            if self.device.is_cpu:
+                runtime.core.mesh_reorder_host(self.id, self.triangle_permutation.ptr, point_permutation_ptr)
+            else:
+                runtime.core.mesh_reorder_device(self.id, self.triangle_permutation.ptr, point_permutation_ptr)
+
+        if wide_bvh:
+            if self.device.is_cpu:
+                runtime.core.mesh_build_wide_host(self.id)
+            else:
+                runtime.core.mesh_build_wide_device(self.id)
+
+        if level_refit and self.device.is_cuda:
+            runtime.core.mesh_build_refit_levels_device(self.id)
+
+        if quantize_points:
+            if self.device.is_cpu:
+                runtime.core.mesh_quantize_host(self.id)
+            else:
+                runtime.core.mesh_quantize_device(self.id)
+
+        if support_winding_number:
+            Mesh._stale_winding_number[self.id] = self
+
     def __del__(self):
         try:
             from warp.context import runtime
@@ -2503,17 +3157,599 @@ class Mesh:
         except Exception:
             pass
 
-    def refit(self):
-        """Refit the BVH to points. This should be called after users modify the `points` data."""
+    def clone(self, device):
+        """Returns a copy of this mesh on another CUDA device without rebuilding its BVH.
+
+        The BVH, triangle bounds, solid angle data and quantized points are copied device to device, directly
+        when peer access between the devices is available, and ``points``, ``velocities`` and ``indices`` are
+        cloned to ``device``. The copies are issued on the current stream of ``device``, so work on this mesh's
+        device that writes its points must be synchronized beforehand.
+
+        Args:
+            device (Devicelike): CUDA device to copy the mesh to
+        """
 
         from warp.context import runtime
 
-        if self.device.is_cpu:
+        device = _clone_device("Mesh", self.device, device)
+
+        mesh = Mesh.__new__(Mesh)
+        mesh.device = device
+        mesh.points = warp.context.clone(self.points, device)
+        mesh.velocities = warp.context.clone(self.velocities, device) if self.velocities else None
+        mesh.indices = warp.context.clone(self.indices, device)
+        mesh.support_winding_number = self.support_winding_number
+        mesh.triangle_permutation = None
+        mesh.point_permutation = None
+        if self.triangle_permutation is not None:
+            mesh.triangle_permutation = warp.context.clone(self.triangle_permutation, device)
+        if self.point_permutation is not None:
+            mesh.point_permutation = warp.context.clone(self.point_permutation, device)
+        mesh.id = runtime.core.mesh_clone_to_device(
+            device.context,
+            self.id,
+            mesh.points.__ctype__(),
+            mesh.velocities.__ctype__() if mesh.velocities else array().__ctype__(),
+            mesh.indices.__ctype__(),
+        )
+
+        if self.id in Mesh._stale_winding_number:
+            Mesh._stale_winding_number[mesh.id] = mesh
+
+        return mesh
+
+    @staticmethod
+    def create_batch(points, indices, point_offsets, tri_offsets, velocities=None, support_winding_number=False):
+        """Creates several meshes from concatenated points and triangles in one batched build.
+
+        On CUDA devices the BVHs of all meshes are built together as a single segmented LBVH, with one Morton code
+        sort and one launch per build stage for the whole batch instead of one sequence of launches per mesh, which
+        is much faster for many small meshes, e.g.: the shapes of a scene. The descriptors, triangle bounds, BVH nodes
+        and solid angle data of the meshes share pooled allocations, which are released with the last of them.
+        On the CPU the meshes are built one by one.
+
+        The meshes view slices of ``points``, ``velocities`` and ``indices``, mesh ``i`` uses the points
+        ``point_offsets[i]:point_offsets[i+1]`` and the triangles ``tri_offsets[i]:tri_offsets[i+1]``, whose indices
+        refer to the points of the mesh. Each mesh needs at least one triangle.
+
+        Args:
+            points (:class:`warp.array`): Concatenated vertex positions of type :class:`warp.vec3`
+            indices (:class:`warp.array`): Concatenated triangle indices of type :class:`warp.int32`, flattened
+            point_offsets: Sequence of ``num_meshes + 1`` offsets of the points of each mesh
+            tri_offsets: Sequence of ``num_meshes + 1`` offsets of the triangles of each mesh
+            velocities (:class:`warp.array`): Concatenated vertex velocities of type :class:`warp.vec3` (optional)
+            support_winding_number (bool): If true the meshes support `wp.mesh_query_point_sign_winding_number()`
+
+        Returns:
+            A list of :class:`Mesh`
+        """
+
+        from warp.context import runtime
+
+        if points.device != indices.device:
+            raise RuntimeError("Mesh points and indices must live on the same device")
+
+        if points.dtype != vec3 or not points.is_contiguous:
+            raise RuntimeError("Mesh points should be a contiguous array of type wp.vec3")
+
+        if velocities and (velocities.dtype != vec3 or not velocities.is_contiguous):
+            raise RuntimeError("Mesh velocities should be a contiguous array of type wp.vec3")
+
+        if indices.dtype != int32 or not indices.is_contiguous or indices.ndim > 1:
+            raise RuntimeError("Mesh indices should be a contiguous flattened 1d array of type wp.int32")
+
+        point_offsets = [int(o) for o in point_offsets]
+        tri_offsets = [int(o) for o in tri_offsets]
+        num_meshes = len(tri_offsets) - 1
+
+        if len(point_offsets) != num_meshes + 1:
+            raise RuntimeError("Mesh batches require as many point offsets as triangle offsets")
+
+        if point_offsets[0] != 0 or point_offsets[-1] != len(points):
+            raise RuntimeError("Mesh batch point offsets should span the points array")
+
+        if tri_offsets[0] != 0 or 3 * tri_offsets[-1] != indices.size:
+            raise RuntimeError("Mesh batch triangle offsets should span the indices array")
+
+        if any(tri_offsets[i + 1] <= tri_offsets[i] for i in range(num_meshes)):
+            raise RuntimeError("Each mesh of a batch requires at least one triangle")
+
+        if any(point_offsets[i + 1] < point_offsets[i] for i in range(num_meshes)):
+            raise RuntimeError("Mesh batch point offsets should be increasing")
+
+        def mesh_arrays(i):
+            p = slice(point_offsets[i], point_offsets[i + 1])
+            t = slice(3 * tri_offsets[i], 3 * tri_offsets[i + 1])
+            return points[p], indices[t], velocities[p] if velocities else None
+
+        if points.device.is_cpu:
+            meshes = []
+            for i in range(num_meshes):
+                mesh_points, mesh_indices, mesh_velocities = mesh_arrays(i)
+                meshes.append(
+                    Mesh(mesh_points, mesh_indices, mesh_velocities, support_winding_number=support_winding_number)
+                )
+            return meshes
+
+        ids = (ctypes.c_uint64 * num_meshes)()
+        runtime.core.mesh_create_batch_device(
+            points.device.context,
+            ctypes.c_void_p(points.ptr),
+            ctypes.c_void_p(velocities.ptr) if velocities else None,
+            ctypes.c_void_p(indices.ptr),
+            (ctypes.c_int * (num_meshes + 1))(*point_offsets),
+            (ctypes.c_int * (num_meshes + 1))(*tri_offsets),
+            num_meshes,
+            int(support_winding_number),
+            ids,
+        )
+        runtime.verify_cuda_device(points.device)
+
+        meshes = []
+        for i in range(num_meshes):
+            mesh = Mesh.__new__(Mesh)
+            mesh.device = points.device
+            mesh.points, mesh.indices, mesh.velocities = mesh_arrays(i)
+            mesh.support_winding_number = support_winding_number
+            mesh.triangle_permutation = None
+            mesh.point_permutation = None
+            mesh.id = ids[i]
+
+            if support_winding_number:
+                Mesh._stale_winding_number[mesh.id] = mesh
+
+            meshes.append(mesh)
+
+        return meshes
+
+    def refit(self):
+        """Refit the BVH to points. This should be called after users modify the `points` data.
+
+        The solid angle data of meshes supporting winding numbers is only recomputed once it is needed.
+        """
+
+        from warp.context import runtime
+
+        if self.device.is_cpu:
             runtime.core.mesh_refit_host(self.id)
         else:
             runtime.core.mesh_refit_device(self.id)
             runtime.verify_cuda_device(self.device)
 
+        if self.support_winding_number:
+            Mesh._stale_winding_number[self.id] = self
+
+    def skin(self, rest_points, bones=None, bone_indices=None, bone_weights=None, xform=None):
+        """Deform the points of this mesh by linear-blend skinning of rest positions, then refit its BVH.
+
+        Each point ``i`` is moved to ``xform * sum_j(bone_weights[i, j] * bones[bone_indices[i, j]] * rest_points[i])``,
+        and the triangle bounds and the BVH are updated in the same chain of launches, so that the mesh can be queried
+        right after. This replaces a user deformation kernel followed by :meth:`refit`. Without ``bones`` the rest
+        positions are only moved by ``xform``, e.g.: to place an instance of a shared rest mesh. ``rest_points`` may be
+        the ``points`` array of the mesh itself, and the weights of each point are expected to sum up to one.
+
+        The average edge length used as a welding tolerance by :func:`warp.mesh_query_point_sign_normal` is kept from
+        the last :meth:`refit`.
+
+        Args:
+            rest_points (:class:`warp.array`): Rest positions of type :class:`warp.vec3`, one per point of the mesh
+            bones (:class:`warp.array`): Bone transforms of type :class:`warp.transform`
+            bone_indices (:class:`warp.array`): Bones influencing each point, 2D array of type :class:`warp.int32` and
+                shape ``(len(points), bones_per_point)``
+            bone_weights (:class:`warp.array`): Weights of the bones influencing each point, 2D array of type
+                :class:`warp.float32` with the shape of ``bone_indices``
+            xform (:class:`warp.transform`): Instance transform applied after skinning, identity if None
+        """
+
+        from warp.context import runtime
+
+        num_points = len(self.points)
+        if rest_points.device != self.device or rest_points.dtype != vec3 or rest_points.shape != (num_points,):
+            raise RuntimeError("Mesh rest points should be an array of type wp.vec3 with one point per mesh point")
+        if not rest_points.is_contiguous:
+            raise RuntimeError("Mesh rest points should be contiguous")
+
+        bones_ptr = None
+        indices_ptr = None
+        weights_ptr = None
+        bones_per_point = 0
+
+        if bones is not None:
+            if bone_indices is None or bone_weights is None:
+                raise RuntimeError("Mesh skinning requires bone indices and weights along with the bone transforms")
+
+            if bones.device != self.device or bones.dtype != transformf or not bones.is_contiguous:
+                raise RuntimeError("Mesh bones should be a contiguous array of type wp.transform on the mesh device")
+
+            if (
+                bone_indices.device != self.device
+                or bone_indices.dtype != int32
+                or bone_indices.ndim != 2
+                or bone_indices.shape[0] != num_points
+            ):
+                raise RuntimeError("Mesh bone indices should be a 2D wp.int32 array with one row per mesh point")
+
+            if (
+                bone_weights.device != self.device
+                or bone_weights.dtype != float32
+                or bone_weights.shape != bone_indices.shape
+            ):
+                raise RuntimeError("Mesh bone weights should be a wp.float32 array shaped like the bone indices")
+
+            if not bone_indices.is_contiguous or not bone_weights.is_contiguous:
+                raise RuntimeError("Mesh bone indices and weights should be contiguous")
+
+            bones_ptr = ctypes.c_void_p(bones.ptr)
+            indices_ptr = ctypes.c_void_p(bone_indices.ptr)
+            weights_ptr = ctypes.c_void_p(bone_weights.ptr)
+            bones_per_point = bone_indices.shape[1]
+
+        xform = transformf() if xform is None else transformf(xform.p, xform.q)
+        args = (self.id, ctypes.c_void_p(rest_points.ptr), bones_ptr, indices_ptr, weights_ptr, bones_per_point, xform)
+
+        if self.device.is_cpu:
+            runtime.core.mesh_skin_host(*args)
+        else:
+            runtime.core.mesh_skin_device(*args)
+            runtime.verify_cuda_device(self.device)
+
+        if self.support_winding_number:
+            Mesh._stale_winding_number[self.id] = self
+
+    def update_winding_number(self):
+        """Computes the solid angle data used by `wp.mesh_query_point_sign_winding_number()` if it is out of date.
+
+        This is called automatically before launching kernels that query winding numbers, so it is only needed when
+        such kernels are replayed from a :class:`CommandList` or a CUDA graph after a `refit()`.  Partial refits
+        update valid solid angle data incrementally and do not require another update.
+        """
+
+        from warp.context import runtime
+
+        if not self.support_winding_number:
+            return
+
+        if self.device.is_cpu:
+            runtime.core.mesh_refit_solid_angle_host(self.id)
+        else:
+            runtime.core.mesh_refit_solid_angle_device(self.id)
+
+        Mesh._stale_winding_number.pop(self.id, None)
+
+    @staticmethod
+    def _update_winding_numbers(device):
+        # called before launching kernels that query winding numbers, the mesh ids they use are not known
+        for mesh in list(Mesh._stale_winding_number.values()):
+            if mesh.device == device:
+                mesh.update_winding_number()
+
+    def query_overlap(self, other, pairs, count, margin=0.0, xform=None):
+        """Find candidate contact pairs of triangles between this mesh and another one by traversing both BVHs at once.
+
+        The pairs ``(i, j)`` of triangle ``i`` of this mesh and triangle ``j`` of ``other`` whose bounds are within
+        ``margin`` of each other are written to ``pairs`` in no particular order, this is much faster than querying
+        the triangles of one mesh individually since the upper levels of both trees are culled once for all pairs.
+        ``other`` may also be a :class:`warp.Bvh`, e.g.: built from the bounds of particles, in which case ``j`` is
+        the index of its bounds.
+        The total number of pairs is written to ``count[0]`` and may exceed the length of ``pairs``, in which case
+        only the first ``len(pairs)`` pairs are stored. On CUDA devices the outputs stay on the device.
+
+        Both meshes should have been refit after their points were modified.
+
+        Args:
+            other (:class:`warp.Mesh` or :class:`warp.Bvh`): Mesh or BVH to test against, must live on the same device
+            pairs (:class:`warp.array`): Output array of type :class:`warp.vec2i`
+            count (:class:`warp.array`): Output array of type :class:`warp.int32` receiving the number of pairs
+            margin (float): Contact margin, the triangle bounds of this mesh are grown by it before testing them
+            xform (:class:`warp.transform`): Transform from the frame of ``other`` into the frame of this mesh, identity if None
+        """
+
+        from warp.context import runtime
+
+        if isinstance(other, Bvh):
+            query_host = runtime.core.mesh_query_bvh_overlap_host
+            query_device = runtime.core.mesh_query_bvh_overlap_device
+        else:
+            query_host = runtime.core.mesh_query_mesh_overlap_host
+            query_device = runtime.core.mesh_query_mesh_overlap_device
+
+        _query_overlap("Mesh", self, other, pairs, count, margin, xform, query_host, query_device)
+
+    def query_intersections(self, other, pairs, count, segments=None, xform=None):
+        """Find the pairs of intersecting triangles between this mesh and another one.
+
+        Candidate pairs of overlapping triangle bounds are found by the dual BVH traversal of :meth:`query_overlap`
+        and tested with the same triangle-triangle test as :func:`warp.intersect_tri_tri`. The pairs ``(i, j)`` of
+        triangle ``i`` of this mesh intersecting triangle ``j`` of ``other`` are written to ``pairs`` in no particular
+        order, and the end points of the segment along which they intersect, in the frame of this mesh, to the
+        matching row of ``segments``. Coplanar triangles overlap over an area instead, their segment is reduced to the
+        centroid of triangle ``i``.
+        The total number of pairs is written to ``count[0]`` and may exceed the length of ``pairs``, in which case
+        only the first ``len(pairs)`` pairs are stored. On CUDA devices the outputs stay on the device.
+
+        Both meshes should have been refit after their points were modified.
+
+        Args:
+            other (:class:`warp.Mesh`): Mesh to test against, must live on the same device
+            pairs (:class:`warp.array`): Output array of type :class:`warp.vec2i`
+            count (:class:`warp.array`): Output array of type :class:`warp.int32` receiving the number of pairs
+            segments (:class:`warp.array`): Optional output array of type :class:`warp.vec3` and shape ``(len(pairs), 2)``
+            xform (:class:`warp.transform`): Transform from the frame of ``other`` into the frame of this mesh, identity if None
+        """
+
+        from warp.context import runtime
+
+        if other.device != self.device or pairs.device != self.device or count.device != self.device:
+            raise RuntimeError("Mesh intersection queries require both meshes and all outputs to live on the same device")
+
+        if pairs.dtype != vec2i or not pairs.is_contiguous:
+            raise RuntimeError("Mesh intersection pairs should be a contiguous array of type wp.vec2i")
+
+        if count.dtype != int32 or len(count) < 1:
+            raise RuntimeError("Mesh intersection count should be an array of type wp.int32 with at least one element")
+
+        segments_ptr = None
+        if segments is not None:
+            if segments.device != self.device or segments.dtype != vec3 or segments.shape != (len(pairs), 2):
+                raise RuntimeError(
+                    "Mesh intersection segments should be an array of type wp.vec3 and shape (len(pairs), 2) on the mesh device"
+                )
+            if not segments.is_contiguous:
+                raise RuntimeError("Mesh intersection segments should be contiguous")
+            segments_ptr = ctypes.c_void_p(segments.ptr)
+
+        xform = transformf() if xform is None else transformf(xform.p, xform.q)
+        args = (self.id, other.id, xform, ctypes.c_void_p(pairs.ptr), segments_ptr, len(pairs), ctypes.c_void_p(count.ptr))
+
+        if self.device.is_cpu:
+            runtime.core.mesh_query_mesh_intersections_host(*args)
+        else:
+            runtime.core.mesh_query_mesh_intersections_device(*args)
+            runtime.verify_cuda_device(self.device)
+
+    def query_self_overlap(self, pairs, count, margin=0.0):
+        """Find candidate self-contact pairs of triangles of this mesh by traversing its BVH against itself.
+
+        Each pair ``(i, j)`` of distinct triangles whose bounds are within ``margin`` of each other is written once
+        with ``i < j``, in no particular order. Triangles sharing vertices are reported as well, and should be
+        filtered out by the narrow phase if needed. The total number of pairs is written to ``count[0]`` and may
+        exceed the length of ``pairs``, in which case only the first ``len(pairs)`` pairs are stored. On CUDA
+        devices the outputs stay on the device.
+
+        Args:
+            pairs (:class:`warp.array`): Output array of type :class:`warp.vec2i`
+            count (:class:`warp.array`): Output array of type :class:`warp.int32` receiving the number of pairs
+            margin (float): Contact margin, the bounds of one triangle of each pair are grown by it before testing them
+        """
+
+        from warp.context import runtime
+
+        _query_overlap(
+            "Mesh",
+            self,
+            None,
+            pairs,
+            count,
+            margin,
+            None,
+            runtime.core.mesh_query_self_overlap_host,
+            runtime.core.mesh_query_self_overlap_device,
+        )
+
+    def refit_partial(self, dirty_tris):
+        """Refit the BVH after only the vertices of some triangles were modified.
+
+        Only the bounds of the listed triangles and the BVH nodes above them are recomputed, which is much cheaper
+        than `refit()` for local deformations. The listed triangles must cover every triangle that references a
+        moved vertex. The average edge length used by `wp.mesh_query_point_sign_normal()` is not updated.
+
+        Args:
+            dirty_tris (:class:`warp.array`): Array of triangle indices of type :class:`warp.int32`, duplicates are allowed
+        """
+
+        from warp.context import runtime
+
+        if dirty_tris.dtype != int32 or not dirty_tris.is_contiguous:
+            raise RuntimeError("Mesh dirty triangles should be a contiguous array of type wp.int32")
+
+        if dirty_tris.device != self.device:
+            raise RuntimeError("Mesh dirty triangles must live on the same device as the mesh")
+
+        if self.device.is_cpu:
+            runtime.core.mesh_refit_partial_host(self.id, ctypes.c_void_p(dirty_tris.ptr), len(dirty_tris))
+        else:
+            runtime.core.mesh_refit_partial_device(self.id, ctypes.c_void_p(dirty_tris.ptr), len(dirty_tris))
+            runtime.verify_cuda_device(self.device)
+
+    def raycast(self, origins, directions, max_t=1.0e6, t=None, face=None, uv=None, normal=None, sort_rays=True):
+        """Trace a batch of rays against the mesh and write the closest hits to the given output arrays.
+
+        This is faster than calling `wp.mesh_query_ray()` from a kernel for large batches, on CUDA devices rays
+        are traced by persistent threads after being sorted into coherent groups. Missed rays report
+        ``t = -1`` and ``face = -1``.
+
+        Args:
+            origins (:class:`warp.array`): Array of ray origins of type :class:`warp.vec3`
+            directions (:class:`warp.array`): Array of ray directions of type :class:`warp.vec3`
+            max_t (float): Maximum distance along the rays to search for hits
+            t (:class:`warp.array`): Output hit distances of type :class:`warp.float32` (optional)
+            face (:class:`warp.array`): Output hit face indices of type :class:`warp.int32` (optional)
+            uv (:class:`warp.array`): Output hit barycentric coordinates of type :class:`warp.vec2` (optional)
+            normal (:class:`warp.array`): Output hit face normals of type :class:`warp.vec3` (optional)
+            sort_rays (bool): Group rays by direction octant and origin before tracing on CUDA devices
+        """
+
+        from warp.context import runtime
+
+        num_rays = len(origins)
+
+        if len(directions) != num_rays:
+            raise RuntimeError("Mesh raycast requires the same number of ray origins and directions")
+
+        def get_data(array, dtype, name):
+            if array is None:
+                return ctypes.c_void_p(0)
+
+            if array.dtype != dtype or not array.is_contiguous or len(array) != num_rays:
+                raise RuntimeError(f"Mesh raycast {name} should be a contiguous array of {num_rays} {dtype.__name__}")
+
+            if array.device != self.device:
+                raise RuntimeError(f"Mesh raycast {name} must live on the same device as the mesh")
+
+            return ctypes.c_void_p(array.ptr)
+
+        args = (
+            self.id,
+            get_data(origins, vec3, "origins"),
+            get_data(directions, vec3, "directions"),
+            num_rays,
+            max_t,
+            get_data(t, float32, "t"),
+            get_data(face, int32, "face"),
+            get_data(uv, vec2, "uv"),
+            get_data(normal, vec3, "normal"),
+            int(sort_rays),
+        )
+
+        if self.device.is_cpu:
+            runtime.core.mesh_raycast_batch_host(*args)
+        else:
+            runtime.core.mesh_raycast_batch_device(*args)
+            runtime.verify_cuda_device(self.device)
+
+    def query_points(self, points, max_dist=1.0e6, face=None, uv=None, dist=None, sort_points=True):
+        """Find the closest points on the mesh to a batch of points and write them to the given output arrays.
+
+        The results match `wp.mesh_query_point_no_sign()`, but on CUDA devices the points are sorted by their Morton
+        code and the 32 points of a warp traverse the BVH together, so coherent batches such as particles colliding
+        with a cloth share their node fetches.  Points without a face within ``max_dist`` report ``face = -1`` and
+        ``dist = -1``.
+
+        Args:
+            points (:class:`warp.array`): Array of query points of type :class:`warp.vec3`
+            max_dist (float): Maximum distance of the closest points
+            face (:class:`warp.array`): Output closest face indices of type :class:`warp.int32` (optional)
+            uv (:class:`warp.array`): Output barycentric coordinates of type :class:`warp.vec2` (optional)
+            dist (:class:`warp.array`): Output distances of type :class:`warp.float32` (optional)
+            sort_points (bool): Sort the points before querying on CUDA devices, can be disabled for batches
+                                that are already in a spatially coherent order
+        """
+
+        from warp.context import runtime
+
+        num_points = len(points)
+
+        def get_data(array, dtype, name):
+            if array is None:
+                return ctypes.c_void_p(0)
+
+            if array.dtype != dtype or not array.is_contiguous or len(array) != num_points:
+                raise RuntimeError(
+                    f"Mesh point query {name} should be a contiguous array of {num_points} {dtype.__name__}"
+                )
+
+            if array.device != self.device:
+                raise RuntimeError(f"Mesh point query {name} must live on the same device as the mesh")
+
+            return ctypes.c_void_p(array.ptr)
+
+        args = (
+            self.id,
+            get_data(points, vec3, "points"),
+            num_points,
+            max_dist,
+            get_data(face, int32, "face"),
+            get_data(uv, vec2, "uv"),
+            get_data(dist, float32, "dist"),
+            int(sort_points),
+        )
+
+        if self.device.is_cpu:
+            runtime.core.mesh_query_point_batch_host(*args)
+        else:
+            runtime.core.mesh_query_point_batch_device(*args)
+            runtime.verify_cuda_device(self.device)
+
+
+class Tlas:
+    def __init__(self, meshes, transforms):
+        """Class representing a top-level acceleration structure over rigidly transformed mesh instances.
+
+        Instances reference existing meshes, so the same mesh can be placed many times without duplicating its
+        triangles or BVH. Rays and boxes are tested against the instance bounds first and only descend into
+        the meshes that overlap the query.
+
+        Attributes:
+            id: Unique identifier for this TLAS object, can be passed to kernels.
+            device: Device this object lives on, all buffers must live on the same device.
+
+        Args:
+            meshes: List of :class:`warp.Mesh` objects or an array of mesh ids of type :class:`warp.uint64`, one per instance
+            transforms (:class:`warp.array`): Array of world from mesh transforms of type :class:`warp.transform`, one per instance
+        """
+
+        if isinstance(meshes, array):
+            if meshes.dtype != uint64 or not meshes.is_contiguous:
+                raise RuntimeError("Tlas meshes should be a contiguous array of type wp.uint64")
+
+            self.mesh_refs = None
+            self.meshes = meshes
+        else:
+            # keep the meshes alive for as long as the instances reference them
+            self.mesh_refs = list(meshes)
+            self.meshes = array([m.id for m in self.mesh_refs], dtype=uint64, device=transforms.device)
+
+        if self.meshes.device != transforms.device:
+            raise RuntimeError("Tlas meshes and transforms must live on the same device")
+
+        if transforms.dtype != transform or not transforms.is_contiguous:
+            raise RuntimeError("Tlas transforms should be a contiguous array of type wp.transform")
+
+        if len(self.meshes) != len(transforms):
+            raise RuntimeError("Tlas requires one transform per mesh instance")
+
+        self.device = transforms.device
+        self.transforms = transforms
+
+        from warp.context import runtime
+
+        if self.device.is_cpu:
+            self.id = runtime.core.tlas_create_host(
+                ctypes.c_void_p(self.meshes.ptr), ctypes.c_void_p(transforms.ptr), int(len(transforms))
+            )
+        else:
+            self.id = runtime.core.tlas_create_device(
+                self.device.context,
+                ctypes.c_void_p(self.meshes.ptr),
+                ctypes.c_void_p(transforms.ptr),
+                int(len(transforms)),
+            )
+
+    def __del__(self):
+        try:
+            from warp.context import runtime
+
+            if self.device.is_cpu:
+                runtime.core.tlas_destroy_host(self.id)
+            else:
+                # use CUDA context guard to avoid side effects during garbage collection
+                with self.device.context_guard:
+                    runtime.core.tlas_destroy_device(self.id)
+        except Exception:
+            pass
+
+    def refit(self):
+        """Refit the instance BVH to the transforms. This should be called after users modify the `transforms` data
+        or refit any of the instanced meshes."""
+
+        from warp.context import runtime
+
+        if self.device.is_cpu:
+            runtime.core.tlas_refit_host(self.id)
+        else:
+            runtime.core.tlas_refit_device(self.id)
+            runtime.verify_cuda_device(self.device)
+
 
 class Volume:
     CLOSEST = constant(0)
@@ -2604,10 +3840,31 @@ class Volume:
     def load_from_nvdb(cls, file_or_buffer, device=None):
         """Creates a Volume object from a NanoVDB file or in-memory buffer.
 
+        When given the path of an uncompressed single-grid file, the file is memory-mapped by the native runtime and
+        copied straight into the volume's buffer, through pinned staging buffers for CUDA devices, instead of being
+        read into Python first. Other inputs, such as zip-compressed files, are loaded through an in-memory copy.
+
         Returns:
 
             A ``warp.Volume`` object.
         """
+        if isinstance(file_or_buffer, (str, os.PathLike)):
+            device = warp.get_device(device)
+            path = os.fsencode(file_or_buffer)
+
+            volume = cls(data=None)
+            volume.device = device
+            if device.is_cpu:
+                volume.id = volume.context.core.volume_load_nvdb_host(path)
+            else:
+                volume.id = volume.context.core.volume_load_nvdb_device(device.context, path)
+
+            if volume.id != 0:
+                return volume
+
+            with open(file_or_buffer, "rb") as file:
+                return cls.load_from_nvdb(file, device)
+
         try:
             data = file_or_buffer.read()
         except AttributeError:
@@ -2636,6 +3893,21 @@ class Volume:
         data_array = array(np.frombuffer(grid_data, dtype=np.byte), device=device)
         return cls(data_array)
 
+    @classmethod
+    def prefetch_from_nvdb(cls, path, device=None):
+        """Starts loading a NanoVDB file in the background and returns a :class:`VolumePrefetch` handle.
+
+        The file is copied into the volume's buffer by a native worker thread, on a private stream for CUDA devices,
+        so that e.g. the next frame of a volume sequence streams in while the current one is being sampled.
+        Call :meth:`VolumePrefetch.wait` to obtain the volume.
+
+        Args:
+            path: Path of the NanoVDB file
+            device: The device to create the volume on, e.g.: "cpu", or "cuda:0"
+        """
+
+        return VolumePrefetch(path, device)
+
     @classmethod
     def load_from_numpy(cls, ndarray: np.array, min_world=(0.0, 0.0, 0.0), voxel_size=1.0, bg_value=0.0, device=None):
         """Creates a Volume object from a dense 3D NumPy array.
@@ -2852,6 +4124,445 @@ class Volume:
 
         return volume
 
+    @classmethod
+    def load_from_dense(
+        cls, values: array, voxel_size: float = 1.0, bg_value=0.0, tolerance: float = 0.0, translation=(0.0, 0.0, 0.0)
+    ):
+        """Creates a sparse Volume from a dense 3D warp array, entirely on its CUDA device.
+
+        The value at ``values[i, j, k]`` is stored in voxel ``(i, j, k)`` of the volume. Only the 8x8x8 tiles holding
+        a value that differs from ``bg_value`` by more than ``tolerance`` are allocated, unlike :meth:`load_from_numpy`
+        which allocates the full extent of the array.
+
+        Args:
+            values (:class:`warp.array`): Contiguous 3D array of :class:`warp.float32`, :class:`warp.vec3` or
+                :class:`warp.int32` values, which also defines the volume's type
+            voxel_size (float): Voxel size of the new volume
+            bg_value (float, array-like or int): Value of unallocated voxels of the volume
+            tolerance (float): Largest difference to ``bg_value``, or distance for vec3 volumes, for a value to be
+                considered background
+            translation (array-like): translation between the index and world spaces
+        """
+
+        device = values.device
+
+        if voxel_size <= 0.0:
+            raise RuntimeError(f"Voxel size must be positive! Got {voxel_size}")
+        if not device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for load_from_dense")
+        if values.ndim != 3 or not values.is_contiguous:
+            raise RuntimeError("Expected a contiguous 3D warp array of values!")
+
+        volume = cls(data=None)
+        volume.device = device
+        nx, ny, nz = values.shape
+        if values.dtype == vec3:
+            if not hasattr(bg_value, "__len__"):
+                bg_value = (bg_value, bg_value, bg_value)
+            volume.id = volume.context.core.volume_v_from_dense_device(
+                volume.device.context,
+                ctypes.c_void_p(values.ptr),
+                nx,
+                ny,
+                nz,
+                voxel_size,
+                bg_value[0],
+                bg_value[1],
+                bg_value[2],
+                tolerance,
+                translation[0],
+                translation[1],
+                translation[2],
+            )
+        elif values.dtype == int32:
+            volume.id = volume.context.core.volume_i_from_dense_device(
+                volume.device.context,
+                ctypes.c_void_p(values.ptr),
+                nx,
+                ny,
+                nz,
+                voxel_size,
+                int(bg_value),
+                tolerance,
+                translation[0],
+                translation[1],
+                translation[2],
+            )
+        elif values.dtype == float32:
+            volume.id = volume.context.core.volume_f_from_dense_device(
+                volume.device.context,
+                ctypes.c_void_p(values.ptr),
+                nx,
+                ny,
+                nz,
+                voxel_size,
+                float(bg_value),
+                tolerance,
+                translation[0],
+                translation[1],
+                translation[2],
+            )
+        else:
+            raise RuntimeError(f"Unsupported volume dtype {values.dtype}")
+
+        if volume.id == 0:
+            raise RuntimeError("Failed to create volume")
+
+        return volume
+
+    @classmethod
+    def load_sdf_from_mesh(cls, mesh, voxel_size: float, narrow_band: float, translation=(0.0, 0.0, 0.0)):
+        """Creates a narrow band signed distance field Volume of a :class:`warp.Mesh`, entirely on its CUDA device.
+
+        The tiles overlapping the bounds of the triangles grown by ``narrow_band`` are allocated, and each voxel
+        stores its distance to the mesh clamped to ``[-narrow_band, narrow_band]``, negative inside. The sign is given
+        by :func:`warp.mesh_query_point_sign_winding_number`, so the mesh does not need to be watertight. Voxels
+        outside of the allocated tiles return ``narrow_band``. The resulting volume can be used as the volume of a
+        :class:`warp.sim.SDF` collision shape.
+
+        Args:
+            mesh (:class:`warp.Mesh`): Mesh on a CUDA device, which must have been created with
+                ``support_winding_number=True``
+            voxel_size (float): Voxel size of the new volume
+            narrow_band (float): Width of the band around the surface in world units, also the background value
+            translation (array-like): translation between the index and world spaces
+        """
+
+        device = mesh.device
+
+        if voxel_size <= 0.0:
+            raise RuntimeError(f"Voxel size must be positive! Got {voxel_size}")
+        if narrow_band <= 0.0:
+            raise RuntimeError(f"Narrow band must be positive! Got {narrow_band}")
+        if not device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for load_sdf_from_mesh")
+
+        mesh.update_winding_number()
+
+        volume = cls(data=None)
+        volume.device = device
+        volume.id = volume.context.core.volume_sdf_from_mesh_device(
+            volume.device.context,
+            mesh.id,
+            voxel_size,
+            narrow_band,
+            translation[0],
+            translation[1],
+            translation[2],
+        )
+
+        if volume.id == 0:
+            raise RuntimeError("Failed to create volume")
+
+        return volume
+
+    def quantize(self, bits: int = 16):
+        """Creates a copy of this float Volume with its voxel values quantized, entirely on its CUDA device.
+
+        The voxels of each 8x8x8 tile are stored as ``bits``-wide codes spanning the range of the tile's values,
+        corresponding to the NanoVDB ``Fp4``, ``Fp8`` and ``Fp16`` grid types, which reduces the memory footprint of the
+        tiles by a factor of 8, 4 or 2. The copy can be sampled with the ``volume_sample_f()``, ``volume_sample_grad_f()``
+        and ``volume_lookup_f()`` builtins like the original, but cannot be written to with ``volume_store_f()``.
+        Quantized grids loaded with :meth:`load_from_nvdb`, including variable-width ``FpN`` ones, are sampled the same way.
+
+        Args:
+            bits (int): Bit width of the codes, either 4, 8 or 16
+        """
+
+        if bits not in (4, 8, 16):
+            raise RuntimeError(f"Quantization bit width must be 4, 8 or 16! Got {bits}")
+        if not self.device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for quantize")
+
+        volume = Volume(data=None)
+        volume.device = self.device
+        volume.id = volume.context.core.volume_quantize_device(volume.device.context, self.id, bits)
+
+        if volume.id == 0:
+            raise RuntimeError("Failed to quantize volume, only float volumes can be quantized")
+
+        return volume
+
+    def clone(self, device):
+        """Returns a copy of this Volume on another CUDA device.
+
+        The NanoVDB buffer is copied device to device, directly when peer access between the devices is available,
+        which is cheaper than reloading or rebuilding the grid on every device. The copy is issued on the current
+        stream of ``device``, so work on this volume's device that writes its voxels must be synchronized beforehand.
+
+        Args:
+            device (Devicelike): CUDA device to copy the volume to
+        """
+
+        device = _clone_device("Volume", self.device, device)
+
+        volume = Volume(data=None)
+        volume.device = device
+        volume.id = volume.context.core.volume_clone_to_device(device.context, self.id)
+
+        if volume.id == 0:
+            raise RuntimeError("Failed to clone volume")
+
+        return volume
+
+    def _update_topology(self, new_id):
+        if new_id == 0:
+            raise RuntimeError("Failed to update the topology of the volume")
+
+        self.id = new_id
+
+    def activate_tiles(self, tile_points: array):
+        """Allocates the tiles containing ``tile_points`` in place, entirely on the volume's CUDA device.
+
+        Voxels of the existing tiles keep their values, the voxels of the new tiles are set to the background value.
+        The volume is rebuilt into its current buffer when the new grid fits into it and keeps its id, otherwise the
+        volume moves to a larger buffer and ``id`` changes, kernels must therefore be launched with the updated ``id``.
+        This applies to :meth:`dilate` and :meth:`prune` as well. Float, vec3 and int32 volumes are supported.
+
+        Args:
+            tile_points (:class:`warp.array`): Points in the tiles to allocate, see :meth:`allocate_by_tiles`
+        """
+
+        if not self.device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for activate_tiles")
+        if tile_points.device != self.device:
+            raise RuntimeError("Tile points must be on the same device as the volume")
+
+        if tile_points.dtype == vec3:
+            in_world_space = True
+        elif tile_points.dtype == int32 and tile_points.ndim == 2 and tile_points.shape[1] == 3:
+            in_world_space = False
+        else:
+            raise RuntimeError("Expected an N-by-3 array of int32 index space points or an array of vec3 world space points")
+
+        self._update_topology(
+            self.context.core.volume_activate_tiles_device(
+                self.device.context,
+                self.id,
+                ctypes.c_void_p(tile_points.ptr),
+                tile_points.shape[0],
+                in_world_space,
+            )
+        )
+
+    def dilate(self, voxels: int = 1):
+        """Allocates the tiles within ``voxels`` voxels of the allocated tiles in place, see :meth:`activate_tiles`.
+
+        Args:
+            voxels (int): Dilation distance in voxels, tiles are allocated in 8x8x8 units
+        """
+
+        if not self.device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for dilate")
+        if voxels < 0:
+            raise RuntimeError(f"Dilation must be non-negative! Got {voxels}")
+
+        self._update_topology(self.context.core.volume_dilate_device(self.device.context, self.id, voxels))
+
+    def prune(self, tolerance: float = 0.0):
+        """Releases the tiles whose voxels all lie within ``tolerance`` of the background value in place,
+        see :meth:`activate_tiles`.
+
+        Args:
+            tolerance (float): Largest difference to the background value, or distance for vec3 volumes, for a voxel
+                to be considered background
+        """
+
+        if not self.device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for prune")
+        if tolerance < 0.0:
+            raise RuntimeError(f"Tolerance must be non-negative! Got {tolerance}")
+
+        self._update_topology(self.context.core.volume_prune_device(self.device.context, self.id, tolerance))
+
+
+class Texture3D:
+    CLOSEST = constant(0)
+    LINEAR = constant(1)
+
+    CLAMP = constant(0)
+    WRAP = constant(1)
+    MIRROR = constant(2)
+    BORDER = constant(3)
+
+    def __init__(self, data: array, filter_mode: int = LINEAR, address_mode: int = CLAMP):
+        """Class representing a dense 3D texture of scalars, sampled with ``wp.texture_sample_f()`` inside kernels.
+
+        On CUDA devices the texels are stored in a CUDA array and filtered by the texture hardware, which makes
+        sampling dense static fields faster than with a :class:`Volume`. CPU textures are filtered in software.
+
+        Attributes:
+            CLOSEST (int): Enum value to specify nearest-neighbor filtering
+            LINEAR (int): Enum value to specify trilinear filtering
+            CLAMP (int): Enum value to clamp coordinates to the texture
+            WRAP (int): Enum value to repeat the texture
+            MIRROR (int): Enum value to repeat the texture mirrored every other time
+            BORDER (int): Enum value to return 0 outside of the texture
+
+        Args:
+            data (:class:`warp.array`): Contiguous 3D array of :class:`warp.float32` or :class:`warp.float16` texels
+                ``data[i, j, k]``, copied into the texture. Float16 texels halve the memory of the texture.
+            filter_mode (int): ``Texture3D.CLOSEST`` or ``Texture3D.LINEAR``
+            address_mode (int): ``Texture3D.CLAMP``, ``Texture3D.WRAP``, ``Texture3D.MIRROR`` or ``Texture3D.BORDER``
+        """
+
+        self.id = 0
+
+        from warp.context import runtime
+
+        self.context = runtime
+
+        if data.ndim != 3 or not data.is_contiguous:
+            raise RuntimeError("Expected a contiguous 3D warp array of texels")
+        if data.dtype not in (float32, float16):
+            raise RuntimeError(f"Texels must be float32 or float16 values, got {type_repr(data.dtype)}")
+        if int(filter_mode) not in (0, 1):
+            raise RuntimeError(f"Invalid filter mode {filter_mode}")
+        if int(address_mode) not in (0, 1, 2, 3):
+            raise RuntimeError(f"Invalid address mode {address_mode}")
+
+        self.device = data.device
+        self.shape = data.shape
+        self.dtype = data.dtype
+
+        args = (ctypes.c_void_p(data.ptr), *data.shape, data.dtype == float16, int(filter_mode), int(address_mode))
+        if self.device.is_cpu:
+            self.id = self.context.core.texture3d_create_host(*args)
+        else:
+            self.id = self.context.core.texture3d_create_device(self.device.context, *args)
+
+        if self.id == 0:
+            raise RuntimeError("Failed to create texture")
+
+    def __del__(self):
+        if self.id == 0:
+            return
+
+        try:
+            from warp.context import runtime
+
+            if self.device.is_cpu:
+                runtime.core.texture3d_destroy_host(self.id)
+            else:
+                # use CUDA context guard to avoid side effects during garbage collection
+                with self.device.context_guard:
+                    runtime.core.texture3d_destroy_device(self.id)
+
+        except Exception:
+            pass
+
+
+class VolumeAtlas:
+    def __init__(self, volumes: List[Volume]):
+        """Packs copies of several volumes of the same device into a single buffer behind a shared lookup table.
+
+        Kernels take the atlas by ``id`` and sample its volumes by index, e.g. with ``wp.volume_sample_f(atlas, index, uvw,
+        sampling_mode)``, or obtain the id of a volume with ``wp.volume_atlas_get(atlas, index)`` for any other volume
+        function. Scenes with many small volumes then sample them from one contiguous buffer. The atlas does not
+        refer to the original volumes, which may be released.
+
+        Args:
+            volumes (List[Volume]): Volumes to pack, in the order of their indices
+        """
+
+        self.id = 0
+
+        from warp.context import runtime
+
+        self.context = runtime
+
+        if len(volumes) == 0:
+            raise RuntimeError("Expected at least one volume")
+
+        self.device = volumes[0].device
+        if any(volume.device != self.device for volume in volumes):
+            raise RuntimeError("All volumes of an atlas must be on the same device")
+
+        self.volume_count = len(volumes)
+
+        ids = (ctypes.c_uint64 * len(volumes))(*(volume.id for volume in volumes))
+        if self.device.is_cpu:
+            self.id = self.context.core.volume_atlas_create_host(ids, len(volumes))
+        else:
+            self.id = self.context.core.volume_atlas_create_device(self.device.context, ids, len(volumes))
+
+        if self.id == 0:
+            raise RuntimeError("Failed to create volume atlas")
+
+    def __len__(self):
+        return self.volume_count
+
+    def __del__(self):
+        if self.id == 0:
+            return
+
+        try:
+            from warp.context import runtime
+
+            if self.device.is_cpu:
+                runtime.core.volume_atlas_destroy_host(self.id)
+            else:
+                # use CUDA context guard to avoid side effects during garbage collection
+                with self.device.context_guard:
+                    runtime.core.volume_atlas_destroy_device(self.id)
+
+        except Exception:
+            pass
+
+
+class VolumePrefetch:
+    def __init__(self, path, device=None):
+        """Handle of a NanoVDB file being loaded in the background, see :meth:`Volume.prefetch_from_nvdb`.
+
+        Files that cannot be memory-mapped by the native loader, such as zip-compressed ones, are loaded synchronously
+        by :meth:`wait` instead.
+        """
+
+        from warp.context import runtime
+
+        self.context = runtime
+        self.path = path
+        self.device = warp.get_device(device)
+
+        encoded_path = os.fsencode(path)
+        if self.device.is_cpu:
+            self.handle = self.context.core.volume_prefetch_nvdb_host(encoded_path)
+        else:
+            self.handle = self.context.core.volume_prefetch_nvdb_device(self.device.context, encoded_path)
+
+    def wait(self) -> Volume:
+        """Waits for the load to complete and returns the volume, can only be called once."""
+
+        if self.path is None:
+            raise RuntimeError("Volume prefetch was already waited on")
+
+        path, self.path = self.path, None
+        handle, self.handle = self.handle, None
+
+        if not handle:
+            return Volume.load_from_nvdb(path, self.device)
+
+        volume = Volume(data=None)
+        volume.device = self.device
+        volume.id = self.context.core.volume_prefetch_wait(handle)
+
+        if volume.id == 0:
+            raise RuntimeError(f"Failed to load volume from {path}")
+
+        return volume
+
+    def __del__(self):
+        if not self.handle:
+            return
+
+        try:
+            # join the worker and release the volume that was never waited on
+            volume = Volume(data=None)
+            volume.device = self.device
+            volume.id = self.context.core.volume_prefetch_wait(self.handle)
+        except Exception:
+            pass
+
 
 def matmul(
     a: array2d,
@@ -2865,6 +4576,8 @@ def matmul(
 ):
     """Computes a generic matrix-matrix multiplication (GEMM) of the form: `d = alpha * (a @ b) + beta * c`.
 
+    float16 A and B matrices with float32 C and D matrices are multiplied on Tensor Cores with float32 accumulation (SM70 or newer).
+
     Args:
         a (array2d): two-dimensional array containing matrix A
         b (array2d): two-dimensional array containing matrix B
@@ -2884,11 +4597,21 @@ def matmul(
     if a.device != device or b.device != device or c.device != device or d.device != device:
         raise RuntimeError("Matrices A, B, C, and D must all be on the same device as the runtime device.")
 
-    if a.dtype != b.dtype or a.dtype != c.dtype or a.dtype != d.dtype:
+    if a.dtype != b.dtype or c.dtype != d.dtype:
         raise RuntimeError(
-            "wp.matmul currently only supports operation between {A, B, C, D} matrices of the same type."
+            "wp.matmul currently only supports operation between {A, B} and {C, D} matrices of the same type."
         )
 
+    # float16 inputs can be accumulated into a float32 output on Tensor Cores
+    mixed_precision = a.dtype == float16 and d.dtype == float32
+    if a.dtype != d.dtype and not mixed_precision:
+        raise RuntimeError(
+            "wp.matmul currently only supports {A, B, C, D} matrices of the same type, or float16 {A, B} with float32 {C, D}."
+        )
+
+    if mixed_precision and runtime.tape:
+        raise RuntimeError("wp.matmul does not support differentiation of mixed precision products.")
+
     m = a.shape[0]
     n = b.shape[1]
     k = a.shape[1]
@@ -2907,7 +4630,8 @@ def matmul(
 
     # cpu fallback if no cuda devices found
     if device == "cpu":
-        d.assign(alpha * (a.numpy() @ b.numpy()) + beta * c.numpy())
+        np_dtype = warp_type_to_np_dtype[d.dtype]
+        d.assign(alpha * (a.numpy().astype(np_dtype) @ b.numpy().astype(np_dtype)) + beta * c.numpy())
         return
 
     cc = device.arch
@@ -2917,6 +4641,7 @@ def matmul(
         n,
         k,
         type_typestr(a.dtype).encode(),
+        type_typestr(d.dtype).encode(),
         ctypes.c_void_p(a.ptr),
         ctypes.c_void_p(b.ptr),
         ctypes.c_void_p(c.ptr),
@@ -3027,6 +4752,7 @@ def adj_matmul(
         k,
         n,
         type_typestr(a.dtype).encode(),
+        type_typestr(a.dtype).encode(),
         ctypes.c_void_p(adj_d.ptr),
         ctypes.c_void_p(b.ptr),
         ctypes.c_void_p(a.ptr),
@@ -3048,6 +4774,7 @@ def adj_matmul(
         n,
         m,
         type_typestr(a.dtype).encode(),
+        type_typestr(a.dtype).encode(),
         ctypes.c_void_p(a.ptr),
         ctypes.c_void_p(adj_d.ptr),
         ctypes.c_void_p(b.ptr),
@@ -3069,6 +4796,7 @@ def adj_matmul(
         n,
         k,
         type_typestr(a.dtype).encode(),
+        type_typestr(a.dtype).encode(),
         ctypes.c_void_p(a.ptr),
         ctypes.c_void_p(b.ptr),
         ctypes.c_void_p(adj_d.ptr),
@@ -3096,6 +4824,8 @@ def batched_matmul(
 ):
     """Computes a batched generic matrix-matrix multiplication (GEMM) of the form: `d = alpha * (a @ b) + beta * c`.
 
+    float16 A and B matrices with float32 C and D matrices are multiplied on Tensor Cores with float32 accumulation (SM70 or newer).
+
     Args:
         a (array3d): three-dimensional array containing A matrices. Overall array dimension is {batch_count, M, K}
         b (array3d): three-dimensional array containing B matrices. Overall array dimension is {batch_count, K, N}
@@ -3115,11 +4845,21 @@ def batched_matmul(
     if a.device != device or b.device != device or c.device != device or d.device != device:
         raise RuntimeError("Matrices A, B, C, and D must all be on the same device as the runtime device.")
 
-    if a.dtype != b.dtype or a.dtype != c.dtype or a.dtype != d.dtype:
+    if a.dtype != b.dtype or c.dtype != d.dtype:
+        raise RuntimeError(
+            "wp.batched_matmul currently only supports operation between {A, B} and {C, D} matrices of the same type."
+        )
+
+    # float16 inputs can be accumulated into a float32 output on Tensor Cores
+    mixed_precision = a.dtype == float16 and d.dtype == float32
+    if a.dtype != d.dtype and not mixed_precision:
         raise RuntimeError(
-            "wp.batched_matmul currently only supports operation between {A, B, C, D} matrices of the same type."
+            "wp.batched_matmul currently only supports {A, B, C, D} matrices of the same type, or float16 {A, B} with float32 {C, D}."
         )
 
+    if mixed_precision and runtime.tape:
+        raise RuntimeError("wp.batched_matmul does not support differentiation of mixed precision products.")
+
     m = a.shape[1]
     n = b.shape[2]
     k = a.shape[2]
@@ -3139,7 +4879,8 @@ def batched_matmul(
 
     # cpu fallback if no cuda devices found
     if device == "cpu":
-        d.assign(alpha * np.matmul(a.numpy(), b.numpy()) + beta * c.numpy())
+        np_dtype = warp_type_to_np_dtype[d.dtype]
+        d.assign(alpha * np.matmul(a.numpy().astype(np_dtype), b.numpy().astype(np_dtype)) + beta * c.numpy())
         return
 
     cc = device.arch
@@ -3149,6 +4890,7 @@ def batched_matmul(
         n,
         k,
         type_typestr(a.dtype).encode(),
+        type_typestr(d.dtype).encode(),
         ctypes.c_void_p(a.ptr),
         ctypes.c_void_p(b.ptr),
         ctypes.c_void_p(c.ptr),
@@ -3257,6 +4999,7 @@ def adj_batched_matmul(
         k,
         n,
         type_typestr(a.dtype).encode(),
+        type_typestr(a.dtype).encode(),
         ctypes.c_void_p(adj_d.ptr),
         ctypes.c_void_p(b.ptr),
         ctypes.c_void_p(a.ptr),
@@ -3278,6 +5021,7 @@ def adj_batched_matmul(
         n,
         m,
         type_typestr(a.dtype).encode(),
+        type_typestr(a.dtype).encode(),
         ctypes.c_void_p(a.ptr),
         ctypes.c_void_p(adj_d.ptr),
         ctypes.c_void_p(b.ptr),
@@ -3299,6 +5043,7 @@ def adj_batched_matmul(
         n,
         k,
         type_typestr(a.dtype).encode(),
+        type_typestr(a.dtype).encode(),
         ctypes.c_void_p(a.ptr),
         ctypes.c_void_p(b.ptr),
         ctypes.c_void_p(adj_d.ptr),
@@ -3314,7 +5059,7 @@ def adj_batched_matmul(
         raise RuntimeError("adj_matmul failed.")
     
 class HashGrid:
-    def __init__(self, dim_x, dim_y, dim_z, device=None):
+    def __init__(self, dim_x, dim_y, dim_z, device=None, max_points=0, morton=False):
         """Class representing a hash grid object for accelerated point queries.
 
         Attributes:
@@ -3325,6 +5070,12 @@ class HashGrid:
             dim_x (int): Number of cells in x-axis
             dim_y (int): Number of cells in y-axis
             dim_z (int): Number of cells in z-axis
+            max_points (int): Number of points to reserve memory for up front.  Builds within this capacity
+                              never allocate, which allows them to be captured in CUDA graphs.
+            morton (bool): Store the cells in Morton (Z-curve) order instead of row-major order, so that the cells
+                           visited by a query are close in memory along all axes.  Combined with :meth:`reorder`
+                           this keeps the points of neighboring cells close as well.  The dimensions are rounded
+                           up to a cube with power of two edges of at most 1024 cells.
         """
 
         from warp.context import runtime
@@ -3332,13 +5083,22 @@ class HashGrid:
         self.device = runtime.get_device(device)
 
         if self.device.is_cpu:
-            self.id = runtime.core.hash_grid_create_host(dim_x, dim_y, dim_z)
+            self.id = runtime.core.hash_grid_create_host(dim_x, dim_y, dim_z, int(morton))
         else:
-            self.id = runtime.core.hash_grid_create_device(self.device.context, dim_x, dim_y, dim_z)
+            self.id = runtime.core.hash_grid_create_device(self.device.context, dim_x, dim_y, dim_z, int(morton))
+
+        if max_points > 0:
+            if self.device.is_cpu:
+                runtime.core.hash_grid_reserve_host(self.id, max_points)
+            else:
+                runtime.core.hash_grid_reserve_device(self.id, max_points)
 
         # indicates whether the grid data has been reserved for use by a kernel
         self.reserved = False
 
+        # number of points in the last build
+        self.num_points = 0
+
     def build(self, points, radius):
         """Updates the hash grid data structure.
 
@@ -3359,8 +5119,76 @@ class HashGrid:
         else:
             runtime.core.hash_grid_update_device(self.id, radius, ctypes.cast(points.ptr, ctypes.c_void_p), len(points))
         self.reserved = True
+        self.num_points = len(points)
+
+    def get_point_ids(self):
+        """Returns the permutation that sorts the points of the last :meth:`build` into cell order.
+
+        Entry ``i`` holds the original index of the ``i``-th point in cell order, which is the index
+        returned by ``hash_grid_query_next()``.  The returned array aliases the grid's internal buffer,
+        so it is only valid until the next call to :meth:`build` or :meth:`reorder`.
+        """
+
+        from warp.context import runtime
+
+        if self.device.is_cpu:
+            ptr = runtime.core.hash_grid_get_point_ids_host(self.id)
+        else:
+            ptr = runtime.core.hash_grid_get_point_ids_device(self.id)
+
+        return array(ptr=ptr, dtype=int32, shape=(self.num_points,), device=self.device, owner=False)
+
+    def reorder(self, arrays):
+        """Permutes per-point arrays into the cell order of the last :meth:`build` in place.
+
+        Afterwards the grid is switched to identity order, so ``hash_grid_query_next()`` returns indices
+        into the reordered arrays and neighbor loops read adjacent memory.  All arrays that are indexed by
+        query results (including the points used for the build) must be passed here together.
+
+        Args:
+            arrays: List of contiguous arrays of any type whose first dimension equals the number of points
+        """
+
+        from warp.context import runtime
+
+        for a in arrays:
+            if a.device != self.device:
+                raise RuntimeError(
+                    f"Array on device {a.device} cannot be reordered by a hash grid on device {self.device}"
+                )
+            if not a.is_contiguous:
+                raise RuntimeError("Hash grid reordering requires contiguous arrays")
+            if a.shape[0] != self.num_points:
+                raise RuntimeError(
+                    f"Array with leading dimension {a.shape[0]} does not match the hash grid point count {self.num_points}"
+                )
+
+        for a in arrays:
+            if a.size == 0:
+                continue
+
+            element_size = a.size // a.shape[0] * type_size_in_bytes(a.dtype)
+            permuted = warp.context.empty_like(a)
+
+            if self.device.is_cpu:
+                runtime.core.hash_grid_permute_host(self.id, permuted.ptr, a.ptr, element_size)
+            else:
+                runtime.core.hash_grid_permute_device(self.id, permuted.ptr, a.ptr, element_size)
+
+            warp.context.copy(a, permuted)
+
+        if self.device.is_cpu:
+            runtime.core.hash_grid_reset_order_host(self.id)
+        else:
+            runtime.core.hash_grid_reset_order_device(self.id)
 
     def reserve(self, num_points):
+        """Ensures that the grid can be built for up to ``num_points`` points without allocating.
+
+        Capacity grows geometrically, using stream-ordered allocations where the device supports memory pools.
+        Growth is not permitted during graph capture, so reserve the maximum capacity before capturing.
+        """
+
         from warp.context import runtime
 
         if self.device.is_cpu:
@@ -3384,15 +5212,366 @@ class HashGrid:
             pass
 
 
+class SparseHashGrid(HashGrid):
+    def __init__(self, device=None, max_points=0):
+        """Class representing a hash grid that stores only its occupied cells, for point sets spread over large domains.
+
+        The cells of a :class:`HashGrid` are mapped into a fixed table by their coordinates modulo the grid
+        dimensions, so distant cells share buckets and queries return false neighbors when the points cover much more
+        than ``dim_x*dim_y*dim_z`` cells.  A sparse grid sorts the points by their 64-bit cell coordinates and stores
+        the occupied cells in an open addressing hash table, so that each bucket holds the points of a single cell.
+        Queries cost a table probe per visited cell.  Cell coordinates are limited to +/-2^19 cells from the origin.
+
+        The grid is queried with the same ``hash_grid_query()`` and ``hash_grid_query_next()`` functions, and
+        supports the :meth:`build`, :meth:`get_point_ids`, :meth:`reorder` and :meth:`reserve` methods of
+        :class:`HashGrid`.
+
+        Attributes:
+            id: Unique identifier for this grid object, can be passed to kernels.
+            device: Device this object lives on, all buffers must live on the same device.
+
+        Args:
+            max_points (int): Number of points to reserve memory for up front.  Builds within this capacity
+                              never allocate, which allows them to be captured in CUDA graphs.
+        """
+
+        from warp.context import runtime
+
+        self.device = runtime.get_device(device)
+
+        if self.device.is_cpu:
+            self.id = runtime.core.hash_grid_create_sparse_host()
+        else:
+            self.id = runtime.core.hash_grid_create_sparse_device(self.device.context)
+
+        if max_points > 0:
+            if self.device.is_cpu:
+                runtime.core.hash_grid_reserve_host(self.id, max_points)
+            else:
+                runtime.core.hash_grid_reserve_device(self.id, max_points)
+
+        self.reserved = False
+        self.num_points = 0
+
+
+class MultiLevelHashGrid(HashGrid):
+    def __init__(self, min_radius, max_radius, device=None, max_points=0):
+        """Class representing a hierarchical hash grid for points of different radii.
+
+        A single grid must be sized by the largest point, so queries around small points visit many cells worth of
+        points that are too far away to interact.  A multi-level grid is a :class:`SparseHashGrid` with up to 8 levels
+        whose cell widths double from one level to the next, the top level being sized by ``max_radius``.  Each point
+        is binned at the lowest level whose radius bound covers its radius, and a query visits every occupied level
+        with the query radius extended by the radius bound of that level.  A query for a point of radius ``r``
+        therefore returns every point ``j`` with ``|p - p_j| <= r + r_j``, visiting a bounded number of cells
+        per level regardless of the size ratio of the points.
+
+        The grid is queried with the same ``hash_grid_query()`` and ``hash_grid_query_next()`` functions, and
+        supports the :meth:`get_point_ids`, :meth:`reorder` and :meth:`reserve` methods of :class:`HashGrid`.
+
+        Attributes:
+            id: Unique identifier for this grid object, can be passed to kernels.
+            device: Device this object lives on, all buffers must live on the same device.
+
+        Args:
+            min_radius (float): Radius of the smallest points, the bound of the lowest level is at most twice this
+            max_radius (float): Radius of the largest points, points with larger radii are binned at the top level
+                                and may be missed by queries
+            max_points (int): Number of points to reserve memory for up front.  Builds within this capacity
+                              never allocate, which allows them to be captured in CUDA graphs.
+        """
+
+        from warp.context import runtime
+
+        self.device = runtime.get_device(device)
+
+        # the radius bound of level l is max_radius/2^(num_levels-1-l)
+        num_levels = 1
+        while num_levels < 8 and min_radius * 2.0 ** (num_levels - 1) < max_radius:
+            num_levels += 1
+
+        self.num_levels = num_levels
+        self.base_radius = max_radius / 2.0 ** (num_levels - 1)
+
+        if self.device.is_cpu:
+            self.id = runtime.core.hash_grid_create_levels_host(self.base_radius, num_levels)
+        else:
+            self.id = runtime.core.hash_grid_create_levels_device(self.device.context, self.base_radius, num_levels)
+
+        if max_points > 0:
+            if self.device.is_cpu:
+                runtime.core.hash_grid_reserve_host(self.id, max_points)
+            else:
+                runtime.core.hash_grid_reserve_device(self.id, max_points)
+
+        self.reserved = False
+        self.num_points = 0
+
+    def build(self, points, radii):
+        """Updates the hash grid data structure, binning each point at the level of its radius.
+
+        Args:
+            points (:class:`warp.array`): Array of points of type :class:`warp.vec3`
+            radii (:class:`warp.array`): Array of the radius of each point of type ``float``
+        """
+
+        from warp.context import runtime
+
+        if len(radii) != len(points):
+            raise RuntimeError(f"Number of radii ({len(radii)}) does not match the number of points ({len(points)})")
+
+        points_ptr = ctypes.cast(points.ptr, ctypes.c_void_p)
+        radii_ptr = ctypes.cast(radii.ptr, ctypes.c_void_p)
+
+        if self.device.is_cpu:
+            runtime.core.hash_grid_update_levels_host(self.id, points_ptr, radii_ptr, len(points))
+        else:
+            runtime.core.hash_grid_update_levels_device(self.id, points_ptr, radii_ptr, len(points))
+        self.reserved = True
+        self.num_points = len(points)
+
+
+class NeighborList:
+    def __init__(self, radius, skin=0.0, grid=None, device=None):
+        """Class representing precomputed lists of the neighbors of each point within a radius.
+
+        The lists are stored in compressed sparse row format and are found with the queries of a hash grid, using the
+        radius plus a ``skin`` distance.  As long as no point has moved by more than half of the skin since the last
+        build, every pair of points within ``radius`` of each other is still in the lists, so they can be reused
+        over many steps instead of querying the grid again.  Kernels iterate the neighbors of a point with
+        ``neighbor_list_query()`` and ``neighbor_list_query_next()``, which, like grid queries, may return points
+        up to ``radius + skin`` away and include the point itself.
+
+        Builds read the size of the lists back to the host, so they cannot be captured in CUDA graphs.
+
+        Attributes:
+            id: Unique identifier for this neighbor list object, can be passed to kernels.
+            device: Device this object lives on, all buffers must live on the same device.
+            num_neighbors: Total number of neighbors in the lists of the last build.
+
+        Args:
+            radius (float): Interaction radius of the points
+            skin (float): Distance added to the radius so that the lists stay valid while the points move
+            grid: The :class:`HashGrid` or :class:`SparseHashGrid` used to build the lists, a 128^3 hash grid is
+                  created if not given.  The grid is rebuilt with a cell width of ``radius + skin`` by every build.
+        """
+
+        from warp.context import runtime
+
+        self.device = runtime.get_device(device)
+        self.radius = radius
+        self.skin = skin
+
+        if grid is None:
+            grid = HashGrid(128, 128, 128, device=self.device, morton=True)
+        elif grid.device != self.device:
+            raise RuntimeError(f"Hash grid on device {grid.device} cannot build a neighbor list on device {self.device}")
+        self.grid = grid
+
+        if self.device.is_cpu:
+            self.id = runtime.core.neighbor_list_create_host()
+        else:
+            self.id = runtime.core.neighbor_list_create_device(self.device.context)
+
+        # number of points and neighbors of the last build
+        self.num_points = 0
+        self.num_neighbors = 0
+        self.built = False
+
+    def build(self, points):
+        """Rebuilds the hash grid and the neighbor lists of the points.
+
+        Args:
+            points (:class:`warp.array`): Array of points of type :class:`warp.vec3`
+        """
+
+        from warp.context import runtime
+
+        cutoff = self.radius + self.skin
+        self.grid.build(points, cutoff)
+
+        if self.device.is_cpu:
+            self.num_neighbors = runtime.core.neighbor_list_build_host(
+                self.id, self.grid.id, ctypes.cast(points.ptr, ctypes.c_void_p), len(points), cutoff
+            )
+        else:
+            self.num_neighbors = runtime.core.neighbor_list_build_device(
+                self.id, self.grid.id, ctypes.cast(points.ptr, ctypes.c_void_p), len(points), cutoff
+            )
+
+        self.num_points = len(points)
+        self.built = True
+
+    def needs_rebuild(self, points):
+        """Returns whether a point moved by more than half the skin since the last build, or the number of points
+        changed, which reads one value back from the device"""
+
+        from warp.context import runtime
+
+        if not self.built:
+            return True
+
+        if self.device.is_cpu:
+            result = runtime.core.neighbor_list_check_host(
+                self.id, ctypes.cast(points.ptr, ctypes.c_void_p), len(points), 0.5 * self.skin
+            )
+        else:
+            result = runtime.core.neighbor_list_check_device(
+                self.id, ctypes.cast(points.ptr, ctypes.c_void_p), len(points), 0.5 * self.skin
+            )
+
+        return bool(result)
+
+    def update(self, points):
+        """Rebuilds the lists if :meth:`needs_rebuild`, returns whether they were rebuilt"""
+
+        if self.needs_rebuild(points):
+            self.build(points)
+            return True
+
+        return False
+
+    def get_offsets(self):
+        """Returns the start of the neighbors of each point in :meth:`get_neighbors`, ``num_points + 1`` in length.
+        The returned array aliases the internal buffer of the lists and is only valid until the next build."""
+
+        from warp.context import runtime
+
+        if self.device.is_cpu:
+            ptr = runtime.core.neighbor_list_get_offsets_host(self.id)
+        else:
+            ptr = runtime.core.neighbor_list_get_offsets_device(self.id)
+
+        shape = (self.num_points + 1,) if self.built else (0,)
+        return array(ptr=ptr, dtype=int32, shape=shape, device=self.device, owner=False)
+
+    def get_neighbors(self):
+        """Returns the concatenated neighbor lists of the last build.  The returned array aliases the internal buffer
+        of the lists and is only valid until the next build."""
+
+        from warp.context import runtime
+
+        if self.device.is_cpu:
+            ptr = runtime.core.neighbor_list_get_neighbors_host(self.id)
+        else:
+            ptr = runtime.core.neighbor_list_get_neighbors_device(self.id)
+
+        return array(ptr=ptr, dtype=int32, shape=(self.num_neighbors,), device=self.device, owner=False)
+
+    def __del__(self):
+        try:
+            from warp.context import runtime
+
+            if self.device.is_cpu:
+                runtime.core.neighbor_list_destroy_host(self.id)
+            else:
+                # use CUDA context guard to avoid side effects during garbage collection
+                with self.device.context_guard:
+                    runtime.core.neighbor_list_destroy_device(self.id)
+
+        except Exception:
+            pass
+
+
+def knn_graph(points, k, radius=None, grid=None, offsets=None, indices=None, distances=None):
+    """Computes the k nearest neighbors of each point of a point cloud, as a graph in compressed sparse row format.
+
+    The neighbors are found with the queries of a hash grid, which is built with a cell width of ``radius``.  The
+    search radius of each point starts at ``radius`` and doubles until k neighbors are found, so the initial radius
+    only affects performance.  Points with less than k other points in the cloud get all of them.
+
+    The neighbors of point ``i`` are ``indices[offsets[i]:offsets[i+1]]`` by increasing distance and exclude the point
+    itself, which can be passed to :func:`warp.sparse.bsr_set_from_csr` to build a matrix from the graph.  The number
+    of edges is read back to the host, so the graph cannot be built during CUDA graph capture.
+
+    Args:
+        points (:class:`warp.array`): Array of points of type :class:`warp.vec3`
+        k (int): Number of neighbors of each point
+        radius (float): Initial search radius, estimated from the bounds and the number of points if not given
+        grid: The :class:`HashGrid` or :class:`SparseHashGrid` used for the queries, a sparse grid is created if not
+              given.  The grid is rebuilt with the points.
+        offsets (:class:`warp.array`): Optional output array of ``len(points) + 1`` int32 row offsets
+        indices (:class:`warp.array`): Optional output array of at least ``len(points) * k`` int32 neighbor indices
+        distances (:class:`warp.array`): Optional output array of at least ``len(points) * k`` float32 distances
+
+    Returns:
+        A tuple of the ``offsets`` array and of the ``indices`` and ``distances`` arrays sliced to the number of edges
+    """
+
+    from warp.context import empty, runtime
+
+    device = points.device
+    num_points = len(points)
+
+    if k < 1:
+        raise RuntimeError(f"The number of neighbors must be positive, got k={k}")
+    if num_points * k >= 2**31:
+        raise RuntimeError(f"kNN graph of {num_points} points with k={k} has more edges than int32 offsets can hold")
+    if isinstance(grid, MultiLevelHashGrid):
+        raise RuntimeError("kNN graphs cannot be built with multi-level hash grids")
+
+    if offsets is None:
+        offsets = empty(num_points + 1, dtype=int32, device=device)
+    if indices is None:
+        indices = empty(num_points * k, dtype=int32, device=device)
+    if distances is None:
+        distances = empty(num_points * k, dtype=float32, device=device)
+
+    if len(offsets) < num_points + 1 or len(indices) < num_points * k or len(distances) < num_points * k:
+        raise RuntimeError("kNN graph output arrays are too small")
+
+    if num_points == 0:
+        offsets.zero_()
+        return offsets, indices[:0], distances[:0]
+
+    # the search radius grows up to the diagonal of the bounds, which reaches every point
+    import warp.utils
+
+    lower = empty(1, dtype=vec3, device=device)
+    upper = empty(1, dtype=vec3, device=device)
+    warp.utils.array_stats(points, min=lower, max=upper)
+    extents = upper.numpy()[0] - lower.numpy()[0]
+    max_radius = max(float(np.linalg.norm(extents)), 1.0e-6)
+
+    if radius is None:
+        # radius of a ball holding k points at the mean density of the bounds, flat axes are clamped to a
+        # small fraction of the diagonal
+        volume = float(np.prod(np.maximum(extents, 1.0e-3 * max_radius)))
+        radius = (3.0 * volume * k / (4.0 * np.pi * num_points)) ** (1.0 / 3.0)
+    radius = min(max(radius, 1.0e-6), max_radius)
+
+    if grid is None:
+        grid = SparseHashGrid(device=device)
+    elif grid.device != device:
+        raise RuntimeError(f"Hash grid on device {grid.device} cannot build a kNN graph on device {device}")
+    grid.build(points, radius)
+
+    args = (
+        grid.id,
+        ctypes.cast(points.ptr, ctypes.c_void_p),
+        num_points,
+        k,
+        radius,
+        max_radius,
+        ctypes.cast(offsets.ptr, ctypes.c_void_p),
+        ctypes.cast(indices.ptr, ctypes.c_void_p),
+        ctypes.cast(distances.ptr, ctypes.c_void_p),
+    )
+
+    if device.is_cpu:
+        num_edges = runtime.core.knn_graph_host(*args)
+    else:
+        num_edges = runtime.core.knn_graph_device(device.context, *args)
+
+    return offsets, indices[:num_edges], distances[:num_edges]
+
+
 class MarchingCubes:
     def __init__(self, nx: int, ny: int, nz: int, max_verts: int, max_tris: int, device=None):
         from warp.context import runtime
 
         self.device = runtime.get_device(device)
 
-        if not self.device.is_cuda:
-            raise RuntimeError("Only CUDA devices are supported for marching cubes")
-
         self.nx = nx
         self.ny = ny
         self.nz = nz
@@ -3401,18 +5580,37 @@ class MarchingCubes:
         self.max_tris = max_tris
 
         # bindings to warp.so
-        self.alloc = runtime.core.marching_cubes_create_device
-        self.alloc.argtypes = [ctypes.c_void_p]
+        if self.device.is_cuda:
+            self.alloc = runtime.core.marching_cubes_create_device
+            self.alloc.argtypes = [ctypes.c_void_p]
+            self.free = runtime.core.marching_cubes_destroy_device
+            self.surface_func = runtime.core.marching_cubes_surface_device
+            self.surface_batch_func = runtime.core.marching_cubes_surface_batch_device
+        else:
+            self.alloc = runtime.core.marching_cubes_create_host
+            self.alloc.argtypes = []
+            self.free = runtime.core.marching_cubes_destroy_host
+            self.surface_func = runtime.core.marching_cubes_surface_host
+            self.surface_batch_func = runtime.core.marching_cubes_surface_batch_host
+
         self.alloc.restype = ctypes.c_uint64
-        self.free = runtime.core.marching_cubes_destroy_device
+        self.surface_func.restype = ctypes.c_int
+        self.surface_batch_func.restype = ctypes.c_int
 
         from warp.context import zeros
 
         self.verts = zeros(max_verts, dtype=vec3, device=self.device)
         self.indices = zeros(max_tris * 3, dtype=int, device=self.device)
 
+        # per-field offsets written by surface_batch()
+        self.vert_offsets = None
+        self.tri_offsets = None
+
         # alloc surfacer
-        self.id = ctypes.c_uint64(self.alloc(self.device.context))
+        if self.device.is_cuda:
+            self.id = ctypes.c_uint64(self.alloc(self.device.context))
+        else:
+            self.id = ctypes.c_uint64(self.alloc())
 
     def __del__(self):
         # use CUDA context guard to avoid side effects during garbage collection
@@ -3429,15 +5627,11 @@ class MarchingCubes:
         self.max_tris = max_tris
 
     def surface(self, field: array(dtype=float), threshold: float):
-        from warp.context import runtime
-
         # WP_API int marching_cubes_surface_host(const float* field, int nx, int ny, int nz, float threshold, wp::vec3* verts, int* triangles, int max_verts, int max_tris, int* out_num_verts, int* out_num_tris);
         num_verts = ctypes.c_int(0)
         num_tris = ctypes.c_int(0)
 
-        runtime.core.marching_cubes_surface_device.restype = ctypes.c_int
-
-        error = runtime.core.marching_cubes_surface_device(
+        error = self.surface_func(
             self.id,
             ctypes.cast(field.ptr, ctypes.c_void_p),
             self.nx,
@@ -3464,6 +5658,111 @@ class MarchingCubes:
         self.verts.size = num_verts.value
         self.indices.size = num_tris.value * 3
 
+    def surface_batch(self, fields: array4d(dtype=float), threshold: float):
+        """Extracts the ``threshold`` isosurface of a batch of ``nx*ny*nz`` fields in a single launch sequence.
+
+        The fields are stored along the first dimension of ``fields``, which must be contiguous. Unlike :meth:`surface`,
+        the vertex and triangle counts never leave the device, so the batch runs asynchronously on the current stream
+        and may be captured in a graph. Use one surfacer per stream when batches are issued on several streams.
+
+        The surfaces are written one after the other to :attr:`verts` and :attr:`indices`, with the vertices of field
+        ``i`` in ``verts[vert_offsets[i]:vert_offsets[i + 1]]`` and its triangles in
+        ``indices[3 * tri_offsets[i]:3 * tri_offsets[i + 1]]``, where :attr:`vert_offsets` and :attr:`tri_offsets`
+        are arrays of ``fields.shape[0] + 1`` integers on the surfacer's device. Triangles index the vertices of their
+        own field. The arrays keep their full capacity, and vertices and triangles past the end of the arrays
+        are dropped, so the last offsets should be compared against the array capacities once the counts are read back.
+        """
+
+        from warp.context import empty
+
+        if fields.device != self.device:
+            raise RuntimeError("Fields must be on the same device as the marching cubes surfacer")
+
+        if not fields.is_contiguous:
+            raise RuntimeError("Fields must be contiguous")
+
+        num_fields, nx, ny, nz = fields.shape
+
+        if self.vert_offsets is None or self.vert_offsets.shape[0] != num_fields + 1:
+            self.vert_offsets = empty(num_fields + 1, dtype=int, device=self.device)
+            self.tri_offsets = empty(num_fields + 1, dtype=int, device=self.device)
+
+        # restore full capacity in case surface() shrunk the geometry arrays
+        max_verts = self.verts.capacity // type_size_in_bytes(vec3)
+        max_tris = self.indices.capacity // type_size_in_bytes(int32) // 3
+
+        self.verts.shape = (max_verts,)
+        self.indices.shape = (max_tris * 3,)
+
+        self.verts.size = max_verts
+        self.indices.size = max_tris * 3
+
+        error = self.surface_batch_func(
+            self.id,
+            ctypes.cast(fields.ptr, ctypes.c_void_p),
+            num_fields,
+            nx,
+            ny,
+            nz,
+            ctypes.c_float(threshold),
+            ctypes.cast(self.verts.ptr, ctypes.c_void_p),
+            ctypes.cast(self.indices.ptr, ctypes.c_void_p),
+            max_verts,
+            max_tris,
+            ctypes.cast(self.vert_offsets.ptr, ctypes.c_void_p),
+            ctypes.cast(self.tri_offsets.ptr, ctypes.c_void_p),
+        )
+
+        if error:
+            raise RuntimeError("Marching cubes batch requires at least one field")
+
+    def surface_volume(self, volume: Volume, threshold: float):
+        """Extracts the ``threshold`` isosurface of a sparse float :class:`Volume` without densifying it.
+
+        Only the active leaf nodes of the volume are visited, so temporary memory is proportional to the number of
+        active voxels. Vertices are shared between adjacent cells, including across leaf nodes, and are returned in
+        world space. Cells whose triangles would reference cells outside of the active leaf nodes are skipped. The
+        ``nx``, ``ny`` and ``nz`` dimensions of the surfacer are ignored.
+        """
+
+        from warp.context import runtime
+
+        if not self.device.is_cuda:
+            raise RuntimeError("Only CUDA devices are supported for sparse volume marching cubes")
+
+        if volume.device != self.device:
+            raise RuntimeError("Volume must be on the same device as the marching cubes surfacer")
+
+        num_verts = ctypes.c_int(0)
+        num_tris = ctypes.c_int(0)
+
+        runtime.core.marching_cubes_surface_volume_device.restype = ctypes.c_int
+
+        error = runtime.core.marching_cubes_surface_volume_device(
+            self.id,
+            ctypes.c_uint64(volume.id),
+            ctypes.c_float(threshold),
+            ctypes.cast(self.verts.ptr, ctypes.c_void_p),
+            ctypes.cast(self.indices.ptr, ctypes.c_void_p),
+            self.max_verts,
+            self.max_tris,
+            ctypes.c_void_p(ctypes.addressof(num_verts)),
+            ctypes.c_void_p(ctypes.addressof(num_tris)),
+        )
+
+        if error:
+            raise RuntimeError(
+                f"Buffers may not be large enough, marching cubes required at least {num_verts.value} vertices, "
+                f"and {num_tris.value} triangles, or the volume is not a float volume."
+            )
+
+        # resize the geometry arrays
+        self.verts.shape = (num_verts.value,)
+        self.indices.shape = (num_tris.value * 3,)
+
+        self.verts.size = num_verts.value
+        self.indices.size = num_tris.value * 3
+
 
 def type_is_generic(t):
     if t in (Any, Scalar, Float, Int):
@@ -3603,8 +5902,11 @@ simple_type_codes = {
     range_t: "rg",
     launch_bounds_t: "lb",
     hash_grid_query_t: "hgq",
+    neighbor_list_query_t: "nlq",
     mesh_query_aabb_t: "mqa",
     bvh_query_t: "bvhq",
+    volume_accessor_t: "vacc",
+    tile_t: "tile",
 }
 
 
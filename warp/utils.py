@@ -401,7 +401,43 @@ def get_body_twist(w_m, v_m, p_m):
     return (*w_m, *lin)
 
 
-def array_scan(in_array, out_array, inclusive=True):
+def _scan_element_layout(dtype):
+    """Returns the scalar type and number of scalars of elements that can be scanned component-wise"""
+
+    if wp.types.type_is_struct(dtype):
+        fields = [_scan_element_layout(var.type) for var in dtype.vars.values()]
+        scalar_types = set(scalar_type for scalar_type, _ in fields)
+        type_length = sum(length for _, length in fields)
+        if len(scalar_types) != 1:
+            raise RuntimeError(f"Struct {dtype.key} fields must all have the same scalar type to be scanned")
+        scalar_type = scalar_types.pop()
+        if type_length * wp.types.type_size_in_bytes(scalar_type) != wp.types.type_size_in_bytes(dtype):
+            raise RuntimeError(f"Struct {dtype.key} must not contain padding to be scanned")
+        return scalar_type, type_length
+
+    if dtype == int:
+        return wp.int32, 1
+    if dtype == float:
+        return wp.float32, 1
+
+    scalar_type = wp.types.type_scalar_type(dtype)
+    if scalar_type not in (wp.int32, wp.float32, wp.float64):
+        raise RuntimeError(f"Unsupported data type {wp.types.type_repr(dtype)} for scan")
+
+    return scalar_type, wp.types.type_length(dtype)
+
+
+def array_scan(in_array, out_array, inclusive=True, segment_offsets=None):
+    """Computes the inclusive or exclusive prefix sum of ``in_array`` into ``out_array``.
+
+    Elements may be int32, float32 or float64 scalars, vectors and matrices, or structs whose fields all share
+    one of these scalar types; they are summed component-wise. If ``segment_offsets`` is provided, the scan
+    restarts at the first element of each non-empty segment ``[segment_offsets[i], segment_offsets[i+1])``.
+
+    Device scans use a single pass with a scratch buffer that persists between calls, so they can be captured
+    in a CUDA graph once a scan of at least the same size has run outside of capture.
+    """
+
     if in_array.device != out_array.device:
         raise RuntimeError("Array storage devices do not match")
 
@@ -413,6 +449,31 @@ def array_scan(in_array, out_array, inclusive=True):
 
     from warp.context import runtime
 
+    if segment_offsets is not None or in_array.dtype not in (wp.int32, wp.float32):
+        if not in_array.is_contiguous or not out_array.is_contiguous:
+            raise RuntimeError("Arrays must be contiguous")
+
+        scalar_type, type_length = _scan_element_layout(in_array.dtype)
+
+        if segment_offsets is None:
+            segment_offsets_ptr = 0
+            num_segments = 0
+        else:
+            if segment_offsets.device != in_array.device:
+                raise RuntimeError("segment_offsets storage device does not match")
+            if segment_offsets.dtype != wp.int32:
+                raise RuntimeError("segment_offsets array must be of type int32")
+            segment_offsets_ptr = segment_offsets.ptr
+            num_segments = segment_offsets.size - 1
+
+        scalar_names = {wp.int32: "int", wp.float32: "float", wp.float64: "double"}
+        suffix = "host" if in_array.device.is_cpu else "device"
+        native_func = getattr(runtime.core, f"array_scan_vec_{scalar_names[scalar_type]}_{suffix}")
+        native_func(
+            in_array.ptr, out_array.ptr, in_array.size, type_length, inclusive, segment_offsets_ptr, num_segments
+        )
+        return
+
     if in_array.device.is_cpu:
         if in_array.dtype == wp.int32:
             runtime.core.array_scan_int_host(in_array.ptr, out_array.ptr, in_array.size, inclusive)
@@ -429,7 +490,21 @@ def array_scan(in_array, out_array, inclusive=True):
             raise RuntimeError("Unsupported data type")
 
 
-def radix_sort_pairs(keys, values, count: int):
+def radix_sort_pairs(keys, values, count: int, begin_bit: int = 0, end_bit=None):
+    """Sorts the first ``count`` pairs of ``keys`` and ``values`` by key, the sort is stable
+
+    Sorting only the bits that vary between the keys saves passes, e.g.: keys in ``[0, 2**k)`` only need
+    ``end_bit=k``. The bits of signed keys are taken after flipping their sign bit, as when comparing them.
+
+    Args:
+        keys: Keys of type ``wp.int32``, ``wp.int64``, ``wp.uint64`` or ``wp.float32``, with room for ``2*count``
+            elements
+        values: Values of type ``wp.int32``, with room for ``2*count`` elements
+        count: Number of pairs to sort
+        begin_bit: First key bit to sort on
+        end_bit: One past the last key bit to sort on, all bits if None. With ``"auto"`` CUDA sorts find the bits of
+            the largest key with a reduction first, which synchronizes the stream, when all the keys are non-negative
+    """
     if keys.device != values.device:
         raise RuntimeError("Array storage devices do not match")
 
@@ -438,16 +513,272 @@ def radix_sort_pairs(keys, values, count: int):
 
     from warp.context import runtime
 
+    if values.dtype != wp.int32:
+        raise RuntimeError("Unsupported data type")
+
+    key_types = {wp.int32: "int", wp.int64: "int64", wp.uint64: "uint64", wp.float32: "float"}
+    if keys.dtype not in key_types:
+        raise RuntimeError("Unsupported data type")
+
     if keys.device.is_cpu:
-        if keys.dtype == wp.int32 and values.dtype == wp.int32:
-            runtime.core.radix_sort_pairs_int_host(keys.ptr, values.ptr, count)
-        else:
-            raise RuntimeError("Unsupported data type")
+        func = getattr(runtime.core, f"radix_sort_pairs_{key_types[keys.dtype]}_host")
     elif keys.device.is_cuda:
-        if keys.dtype == wp.int32 and values.dtype == wp.int32:
-            runtime.core.radix_sort_pairs_int_device(keys.ptr, values.ptr, count)
-        else:
-            raise RuntimeError("Unsupported data type")
+        func = getattr(runtime.core, f"radix_sort_pairs_{key_types[keys.dtype]}_device")
+
+    # see RADIX_SORT_ALL_BITS and RADIX_SORT_AUTO_BITS in sort.h
+    if end_bit is None:
+        end_bit = -1
+    elif end_bit == "auto":
+        end_bit = -2
+    elif not 0 <= begin_bit < end_bit <= wp.types.type_size_in_bytes(keys.dtype) * 8:
+        raise RuntimeError(f"Invalid radix sort bit range [{begin_bit}, {end_bit})")
+
+    func(keys.ptr, values.ptr, count, begin_bit, end_bit)
+
+
+def segmented_sort_pairs(keys, values, count: int, segment_offsets):
+    """Sorts (key, value) pairs independently within each segment, where segment ``i`` covers elements
+    ``segment_offsets[i]`` to ``segment_offsets[i+1]``. As with :func:`radix_sort_pairs`, ``keys`` and ``values``
+    must have storage for ``2*count`` elements."""
+
+    if keys.device != values.device or segment_offsets.device != keys.device:
+        raise RuntimeError("Array storage devices do not match")
+
+    if keys.size < 2 * count or values.size < 2 * count:
+        raise RuntimeError("Array storage must be large enough to contain 2*count elements")
+
+    if segment_offsets.dtype != wp.int32:
+        raise RuntimeError("segment_offsets array must be of type int32")
+
+    from warp.context import runtime
+
+    num_segments = segment_offsets.size - 1
+
+    if values.dtype != wp.int32:
+        raise RuntimeError("Unsupported data type")
+
+    key_types = {wp.int32: "int", wp.float32: "float"}
+    if keys.dtype not in key_types:
+        raise RuntimeError("Unsupported data type")
+
+    if keys.device.is_cpu:
+        func = getattr(runtime.core, f"segmented_sort_pairs_{key_types[keys.dtype]}_host")
+    elif keys.device.is_cuda:
+        func = getattr(runtime.core, f"segmented_sort_pairs_{key_types[keys.dtype]}_device")
+
+    func(keys.ptr, values.ptr, count, segment_offsets.ptr, num_segments)
+
+
+def segmented_reduce(values, segment_offsets, out, op: str = "sum"):
+    """Reduces ``values`` over each segment with ``op`` ("sum", "min" or "max"), writing one result per segment
+    to ``out``. Segment ``i`` covers elements ``segment_offsets[i]`` to ``segment_offsets[i+1]``, empty segments
+    produce the identity of the operation."""
+
+    if values.device != out.device or segment_offsets.device != values.device:
+        raise RuntimeError("Array storage devices do not match")
+
+    if values.dtype != out.dtype:
+        raise RuntimeError("values and out data types do not match")
+
+    if segment_offsets.dtype != wp.int32:
+        raise RuntimeError("segment_offsets array must be of type int32")
+
+    num_segments = segment_offsets.size - 1
+
+    if out.size < num_segments:
+        raise RuntimeError("Output array storage size must be at least the number of segments")
+
+    # must match WP_SEGMENTED_REDUCE_* in native/warp.h
+    ops = {"sum": 0, "min": 1, "max": 2}
+    if op not in ops:
+        raise RuntimeError(f"Unsupported reduction operation '{op}'")
+
+    from warp.context import runtime
+
+    value_types = {wp.int32: "int", wp.float32: "float"}
+    if values.dtype not in value_types:
+        raise RuntimeError("Unsupported data type")
+
+    if values.device.is_cpu:
+        func = getattr(runtime.core, f"segmented_reduce_{value_types[values.dtype]}_host")
+    elif values.device.is_cuda:
+        func = getattr(runtime.core, f"segmented_reduce_{value_types[values.dtype]}_device")
+
+    func(values.ptr, out.ptr, segment_offsets.ptr, num_segments, ops[op])
+
+
+@wp.kernel
+def _scatter_iota_kernel(order: wp.array(dtype=int)):
+    i = wp.tid()
+    order[i] = i
+
+
+@wp.kernel
+def _scatter_offsets_kernel(sorted_keys: wp.array(dtype=int), count: int, offsets: wp.array(dtype=int)):
+    k = wp.tid()
+    offsets[k] = wp.lower_bound(sorted_keys, 0, count, k)
+
+
+@wp.kernel
+def _scatter_add_kernel(
+    offsets: wp.array(dtype=int), order: wp.array(dtype=int), values: wp.array(dtype=Any), out: wp.array(dtype=Any)
+):
+    k = wp.tid()
+    # a single thread adds the values of each key in slot order, which makes the sum reproducible
+    for i in range(offsets[k], offsets[k + 1]):
+        wp.atomic_add(out, k, values[order[i]])
+
+
+class DeterministicScatter:
+    """Fixed-order replacement of ``wp.atomic_add(out, keys[i], values[i])`` over all slots ``i``.
+
+    The slots are sorted by key once with a stable radix sort, and :meth:`add` sums the values of each output element
+    in increasing slot order with one thread per element, so that floating point results do not depend on the
+    scheduling of the threads. Slots with a negative key are dropped. This costs a sort whenever the keys change
+    and one more pass over the values than atomics, and is used by the deterministic mode of ``warp.sim``.
+
+    Args:
+        keys: Output element of each slot, a 1D array of ``int``
+        size: Number of output elements
+    """
+
+    def __init__(self, keys, size: int):
+        self.device = keys.device
+        self.count = keys.size
+        self.size = size
+
+        # radix sort storage must hold 2*count elements
+        self.sorted_keys = wp.empty(2 * self.count, dtype=int, device=self.device)
+        self.order = wp.empty(2 * self.count, dtype=int, device=self.device)
+        self.offsets = wp.zeros(size + 1, dtype=int, device=self.device)
+
+        self.update(keys)
+
+    def update(self, keys):
+        """Sorts the slots by new keys, ``keys`` must have the same size as the keys the scatter was created with"""
+        if keys.size != self.count:
+            raise RuntimeError(f"Expected {self.count} keys, got {keys.size}")
+        if self.count == 0:
+            return
+
+        wp.copy(self.sorted_keys, keys, count=self.count)
+        wp.launch(_scatter_iota_kernel, dim=self.count, inputs=[self.order], device=self.device, record_tape=False)
+        radix_sort_pairs(self.sorted_keys, self.order, self.count)
+        wp.launch(
+            _scatter_offsets_kernel,
+            dim=self.size + 1,
+            inputs=[self.sorted_keys, self.count],
+            outputs=[self.offsets],
+            device=self.device,
+            record_tape=False,
+        )
+
+    def add(self, values, out):
+        """Adds the value of each slot to the element of ``out`` it is keyed by"""
+        if self.count == 0 or self.size == 0:
+            return
+
+        wp.launch(
+            _scatter_add_kernel,
+            dim=self.size,
+            inputs=[self.offsets, self.order, values],
+            outputs=[out],
+            device=self.device,
+        )
+
+
+_array_add_kernel = None
+
+
+def _get_array_add_kernel():
+    global _array_add_kernel
+
+    if _array_add_kernel is None:
+
+        def array_add_kernel(dest: Any, src: Any):
+            i = wp.tid()
+            dest[i] = dest[i] + src[i]
+
+        module = wp.get_module(array_add_kernel.__module__)
+        _array_add_kernel = wp.Kernel(func=array_add_kernel, key="array_add_kernel", module=module)
+
+    return _array_add_kernel
+
+
+def _check_collective_arrays(arrays):
+    if not arrays:
+        raise RuntimeError("At least one array is required")
+
+    for a in arrays:
+        if not a.device.is_cuda:
+            raise RuntimeError(f"Collective operations require CUDA arrays, got an array on {a.device}")
+        if not a.is_contiguous:
+            raise RuntimeError("Collective operations require contiguous arrays")
+
+
+def array_all_reduce(arrays):
+    """Sums arrays of the same shape and type on different CUDA devices, writing the sum to every array.
+
+    The arrays are reduced on the device of ``arrays[0]`` and the result is broadcast back with peer copies,
+    ordered after the work already enqueued on each device's current stream and before the work enqueued afterwards.
+    Enabling peer access between the devices with ``Device.enable_peer_access()`` lets the copies use P2P or NVLink.
+    """
+
+    _check_collective_arrays(arrays)
+
+    root = arrays[0]
+    for a in arrays[1:]:
+        if a.shape != root.shape or a.dtype != root.dtype:
+            raise RuntimeError("All-reduce arrays must have the same shape and data type")
+        if a.device == root.device:
+            raise RuntimeError("All-reduce arrays must be on different devices")
+
+    if len(arrays) == 1 or root.size == 0:
+        return
+
+    root_stream = root.device.stream
+    root_flat = root.flatten()
+
+    # peers are accumulated one at a time through a single staging buffer, which the root stream keeps ordered
+    staging = wp.empty_like(root_flat)
+    kernel = _get_array_add_kernel()
+
+    for a in arrays[1:]:
+        root_stream.wait_stream(a.device.stream)
+        wp.copy(staging, a.flatten(), stream=root_stream)
+        wp.launch(kernel, dim=root.size, inputs=[root_flat, staging], stream=root_stream)
+
+    for a in arrays[1:]:
+        wp.copy(a, root, stream=root_stream)
+
+    for a in arrays[1:]:
+        a.device.stream.wait_stream(root_stream)
+
+
+def array_gather(arrays, out):
+    """Concatenates contiguous arrays from different devices into ``out`` on a CUDA device.
+
+    The arrays are copied in order with peer copies on the current stream of ``out``'s device,
+    after the work already enqueued on the current stream of each array's device.
+    """
+
+    _check_collective_arrays(arrays + [out])
+
+    total = sum(a.size for a in arrays)
+    if out.size < total:
+        raise RuntimeError(f"Output array has {out.size} elements but the gathered arrays have {total}")
+
+    stream = out.device.stream
+    offset = 0
+    for a in arrays:
+        if a.dtype != out.dtype:
+            raise RuntimeError("Gathered arrays must have the same data type as the output array")
+
+        if a.device != out.device:
+            stream.wait_stream(a.device.stream)
+
+        wp.copy(out, a, dest_offset=offset, count=a.size, stream=stream)
+        offset += a.size
 
 
 def runlength_encode(values, run_values, run_lengths, run_count=None, value_count=None):
@@ -499,6 +830,192 @@ def runlength_encode(values, run_values, run_lengths, run_count=None, value_coun
         return int(run_count.numpy()[0])
 
 
+@wp.kernel
+def _compact_flags_kernel(
+    mask: wp.array(dtype=int), value_count: wp.array(dtype=int), max_count: int, flags: wp.array(dtype=int)
+):
+    i = wp.tid()
+
+    # a device-side count limits the values on top of the launch size
+    flag = 0
+    if mask[i] != 0 and i < max_count and (value_count.shape[0] == 0 or i < value_count[0]):
+        flag = 1
+
+    flags[i] = flag
+
+
+@wp.kernel
+def _compact_scatter_kernel(
+    values: wp.array(dtype=Any),
+    flags: wp.array(dtype=int),
+    offsets: wp.array(dtype=int),
+    count: wp.array(dtype=int),
+    out: wp.array(dtype=Any),
+):
+    i = wp.tid()
+
+    # offsets hold the inclusive prefix sum of the flags
+    if flags[i] != 0:
+        out[offsets[i] - 1] = values[i]
+
+    if i == offsets.shape[0] - 1:
+        count[0] = offsets[i]
+
+
+def compact(values, mask, out, count=None, value_count=None):
+    """Copies the elements of ``values`` whose ``mask`` is non-zero to the front of ``out``, preserving their order.
+
+    The number of elements kept is written to the device-side ``count`` array, so that subsequent kernels can be
+    launched over the capacity of ``out`` and read the count instead of synchronizing with the host. If ``count`` is
+    None a new array is allocated. ``value_count`` limits the input to its first elements, either as an int or as a
+    device-side array of one int, such as the count of a previous compaction or the cursor of an
+    :class:`AppendBuffer`. ``out`` must not alias ``values``, ``count`` may alias ``value_count``.
+
+    Args:
+        values: 1D array of elements of any type
+        mask: 1D array of ``int`` of at least the size of ``values``
+        out: 1D array of the type of ``values``, of at least the size of ``values``
+        count: Device array of one ``int`` receiving the number of elements kept
+        value_count: Number of input elements, an int or a device array of one ``int``
+
+    Returns:
+        The ``count`` array
+    """
+
+    device = values.device
+    if mask.device != device or out.device != device:
+        raise RuntimeError("Array storage devices do not match")
+
+    if values.ndim != 1 or mask.ndim != 1 or out.ndim != 1:
+        raise RuntimeError("compact() expects 1D arrays")
+
+    if not wp.types.types_equal(values.dtype, out.dtype):
+        raise RuntimeError("values and out data types do not match")
+
+    if mask.dtype != wp.int32:
+        raise RuntimeError("mask array must be of type int32")
+
+    n = values.size
+    device_count = None
+    if isinstance(value_count, wp.array):
+        if value_count.device != device or value_count.dtype != wp.int32:
+            raise RuntimeError("value_count must be an int32 array on the device of the values")
+        device_count = value_count
+    elif value_count is not None:
+        n = min(int(value_count), n)
+
+    if mask.size < n or out.size < n:
+        raise RuntimeError("mask and out array sizes must be at least equal to the number of values")
+
+    if count is None:
+        count = wp.empty(shape=(1,), dtype=int, device=device)
+    elif count.device != device or count.dtype != wp.int32:
+        raise RuntimeError("count must be an int32 array on the device of the values")
+
+    if n == 0:
+        count.zero_()
+        return count
+
+    flags = wp.empty(n, dtype=int, device=device)
+    offsets = wp.empty(n, dtype=int, device=device)
+
+    wp.launch(
+        _compact_flags_kernel,
+        dim=n,
+        inputs=[mask, device_count, n],
+        outputs=[flags],
+        device=device,
+        record_tape=False,
+    )
+    array_scan(flags, offsets, inclusive=True)
+    wp.launch(
+        _compact_scatter_kernel,
+        dim=n,
+        inputs=[values, flags, offsets],
+        outputs=[count, out],
+        device=device,
+        record_tape=False,
+    )
+
+    return count
+
+
+@wp.kernel
+def _append_buffer_keep_kernel(mask: wp.array(dtype=int), keep: wp.array(dtype=int)):
+    i = wp.tid()
+
+    value = 1
+    if i < mask.shape[0] and mask[i] != 0:
+        value = 0
+
+    keep[i] = value
+
+
+class AppendBuffer:
+    """Fixed capacity array that kernels append to through a device-side cursor.
+
+    Kernels reserve a slot with ``i = wp.atomic_add(buffer.count, 0, 1)`` and write ``buffer.data[i]`` if
+    ``i < buffer.capacity``. Appends past the capacity are dropped but still counted, so that :meth:`reserve` can
+    grow the storage when the host checks the count at a convenient time. Kernels processing the elements are
+    launched over the capacity and skip the threads at or beyond ``min(buffer.count[0], buffer.capacity)``, none of
+    which requires reading the count back on the host.
+
+    Args:
+        dtype: Type of the elements
+        capacity: Number of elements the buffer can hold
+        device: Device the buffer lives on
+    """
+
+    def __init__(self, dtype, capacity: int, device=None):
+        self.device = wp.get_device(device)
+        self.dtype = dtype
+        self.capacity = 0
+        self.data = wp.empty(0, dtype=dtype, device=self.device)
+        self._spare = None
+
+        self.count = wp.zeros(1, dtype=int, device=self.device)
+        self.reserve(capacity)
+
+    def clear(self):
+        """Removes all elements."""
+        self.count.zero_()
+
+    def size(self) -> int:
+        """Number of elements stored, which synchronizes with the device."""
+        return min(int(self.count.numpy()[0]), self.capacity)
+
+    def overflowed(self) -> bool:
+        """Whether appends were dropped since the last :meth:`clear`, which synchronizes with the device."""
+        return int(self.count.numpy()[0]) > self.capacity
+
+    def reserve(self, capacity: int):
+        """Grows the buffer to hold at least ``capacity`` elements, keeping the stored ones."""
+        if capacity <= self.capacity:
+            return
+
+        data = wp.empty(capacity, dtype=self.dtype, device=self.device)
+        if self.capacity > 0:
+            wp.copy(data, self.data, count=self.capacity)
+
+        self.data = data
+        self._spare = None
+        self.capacity = capacity
+
+    def remove(self, mask):
+        """Removes the elements whose ``mask`` is non-zero, keeping the order of the others.
+
+        The remaining elements are compacted into a second buffer that is swapped with :attr:`data`.
+        """
+        if self._spare is None:
+            self._spare = wp.empty(self.capacity, dtype=self.dtype, device=self.device)
+
+        keep = wp.empty(self.capacity, dtype=int, device=self.device)
+        wp.launch(_append_buffer_keep_kernel, dim=self.capacity, inputs=[mask], outputs=[keep], device=self.device)
+
+        compact(self.data, keep, self._spare, count=self.count, value_count=self.count)
+        self.data, self._spare = self._spare, self.data
+
+
 def array_sum(values, out=None, value_count=None, axis=None):
     if value_count is None:
         if axis is None:
@@ -662,6 +1179,117 @@ def array_inner(a, b, out=None, count=None, axis=None):
             return out
 
 
+def array_stats(values, sum=None, min=None, max=None, argmin=None, argmax=None, value_count=None):
+    """Computes several statistics of ``values`` in a single pass over memory.
+
+    Each statistic is computed per scalar component and written to the corresponding output array, statistics
+    whose output is ``None`` are skipped. ``sum``, ``min`` and ``max`` must have the same data type as ``values``
+    and a single element, ``argmin`` and ``argmax`` must hold one int32 index per component (e.g. an ``int32``
+    array of shape ``(3,)`` for ``vec3`` values). Ties resolve to the first index, and empty arrays produce an index
+    of -1. Results are written to device memory without synchronizing with the host.
+
+    Args:
+        values: One-dimensional array, possibly strided, or contiguous multi-dimensional array of float32 or
+          float64 scalars, vectors or matrices
+        value_count: Number of leading elements to reduce, defaults to ``values.size``
+    """
+
+    if value_count is None:
+        value_count = values.size
+
+    if values.ndim == 1:
+        stride = values.strides[0]
+    elif values.is_contiguous:
+        stride = wp.types.type_size_in_bytes(values.dtype)
+    else:
+        raise RuntimeError("Multi-dimensional values array must be contiguous")
+
+    type_length = wp.types.type_length(values.dtype)
+    scalar_type = wp.types.type_scalar_type(values.dtype)
+
+    def output_ptr(out, dtype, name):
+        if out is None:
+            return 0
+        if out.device != values.device:
+            raise RuntimeError(f"{name} storage device should match values array")
+        if dtype is None:
+            index_count = out.size * wp.types.type_length(out.dtype)
+            if wp.types.type_scalar_type(out.dtype) != wp.int32 or index_count != type_length:
+                raise RuntimeError(f"{name} array should hold {type_length} int32 indices")
+        elif out.dtype != dtype or out.size != 1:
+            raise RuntimeError(f"{name} array should have type {dtype.__name__} and a single element")
+        if not out.is_contiguous:
+            raise RuntimeError(f"{name} array must be contiguous")
+        return out.ptr
+
+    out_ptrs = (
+        output_ptr(sum, values.dtype, "sum"),
+        output_ptr(min, values.dtype, "min"),
+        output_ptr(max, values.dtype, "max"),
+        output_ptr(argmin, None, "argmin"),
+        output_ptr(argmax, None, "argmax"),
+    )
+
+    from warp.context import runtime
+
+    scalar_names = {wp.float32: "float", wp.float64: "double"}
+    if scalar_type not in scalar_names:
+        raise RuntimeError("Unsupported data type")
+
+    if value_count == 0:
+        # empty arrays may have no storage, write the identities without calling the native routines
+        limits = np.finfo(wp.types.warp_type_to_np_dtype[scalar_type])
+        for out, value in ((sum, 0.0), (min, float(limits.max)), (max, float(limits.min)), (argmin, -1), (argmax, -1)):
+            if out is not None:
+                out.fill_(value)
+        return
+
+    if values.device.is_cpu:
+        native_func = getattr(runtime.core, f"array_stats_{scalar_names[scalar_type]}_host")
+    elif values.device.is_cuda:
+        native_func = getattr(runtime.core, f"array_stats_{scalar_names[scalar_type]}_device")
+
+    native_func(values.ptr, value_count, stride, type_length, *out_ptrs)
+
+
+def _array_single_stat(stat, values, out, value_count):
+    if stat in ("argmin", "argmax"):
+        type_length = wp.types.type_length(values.dtype)
+        dtype = wp.int32 if type_length == 1 else wp.types.vector(length=type_length, dtype=wp.int32)
+    else:
+        dtype = values.dtype
+
+    # For convenience, if no output array is provided, the result is returned on host
+    host_return = out is None
+    if host_return:
+        out = wp.empty(shape=(1,), dtype=dtype, device=values.device)
+
+    array_stats(values, value_count=value_count, **{stat: out})
+
+    if host_return:
+        return out.numpy()[0]
+
+
+def array_min(values, out=None, value_count=None):
+    """Minimum per component of ``values``, see :func:`array_stats`"""
+    return _array_single_stat("min", values, out, value_count)
+
+
+def array_max(values, out=None, value_count=None):
+    """Maximum per component of ``values``, see :func:`array_stats`"""
+    return _array_single_stat("max", values, out, value_count)
+
+
+def array_argmin(values, out=None, value_count=None):
+    """Index of the minimum per component of ``values``, see :func:`array_stats`"""
+    return _array_single_stat("argmin", values, out, value_count)
+
+
+def array_argmax(values, out=None, value_count=None):
+    """Index of the maximum per component of ``values``, see :func:`array_stats`"""
+    return _array_single_stat("argmax", values, out, value_count)
+
+
 _copy_kernel_cache = dict()
 
 
@@ -743,6 +1371,58 @@ def array_cast(in_array, out_array, count=None):
         wp.launch(kernel=copy_kernel, dim=dim, inputs=[out_array, in_array], device=out_array.device)
 
 
+# helper kernels interleaving the values and tangents of the float32 arrays of forward-mode launches, see wp.jvp(),
+# the dual array holds each value followed by the `width` tangents of the directions starting at `first`
+@wp.kernel
+def _jvp_pack_kernel(
+    values: wp.array(dtype=float),
+    tangents: wp.array(dtype=float),
+    first: int,
+    count: int,
+    width: int,
+    dual: wp.array(dtype=float),
+):
+    i = wp.tid()
+    n = values.shape[0]
+
+    dual[i * (width + 1)] = values[i]
+    for k in range(width):
+        t = float(0.0)
+        if k < count and tangents.shape[0] > 0:
+            t = tangents[(first + k) * n + i]
+        dual[i * (width + 1) + 1 + k] = t
+
+
+@wp.kernel
+def _jvp_unpack_kernel(
+    dual: wp.array(dtype=float),
+    first: int,
+    count: int,
+    width: int,
+    values: wp.array(dtype=float),
+    tangents: wp.array(dtype=float),
+):
+    i = wp.tid()
+    n = values.shape[0]
+
+    if first == 0:
+        values[i] = dual[i * (width + 1)]
+    for k in range(count):
+        tangents[(first + k) * n + i] = dual[i * (width + 1) + 1 + k]
+
+
+def _jvp_float_view(a):
+    # flat float32 alias of the scalars of a contiguous array
+    return wp.array(
+        ptr=a.ptr,
+        dtype=wp.float32,
+        shape=a.size * warp.types.type_length(a.dtype),
+        capacity=a.capacity,
+        device=a.device,
+        owner=False,
+    )
+
+
 # code snippet for invoking cProfile
 # cp = cProfile.Profile()
 # cp.enable()
@@ -855,13 +1535,52 @@ def mem_report():
             #     mem) )
         print("Type: %s Total Tensors: %d \tUsed Memory Space: %.2f MBytes" % (mem_type, total_numel, total_mem))
 
+    def _mempool_report():
+        """Print the stream-ordered memory pool usage of each CUDA device"""
+        for device in wp.get_cuda_devices():
+            if not device.is_mempool_supported:
+                continue
+            stats = wp.get_mempool_stats(device)
+            mb = 1024 * 1024
+            print(
+                "Device: %s Memory Pool: %s \tUsed: %.2f MBytes (peak %.2f) \tReserved: %.2f MBytes (peak %.2f)"
+                % (
+                    device,
+                    "enabled" if device.is_mempool_enabled else "disabled",
+                    stats["used_current"] / mb,
+                    stats["used_high"] / mb,
+                    stats["reserved_current"] / mb,
+                    stats["reserved_high"] / mb,
+                )
+            )
+
+        stats = wp.get_pinned_pool_stats()
+        mb = 1024 * 1024
+        print(
+            "Pinned Host Pool: \tUsed: %.2f MBytes (peak %.2f) \tReserved: %.2f MBytes (peak %.2f)"
+            % (
+                stats["used_current"] / mb,
+                stats["used_high"] / mb,
+                stats["reserved_current"] / mb,
+                stats["reserved_high"] / mb,
+            )
+        )
+
     import gc
 
-    import torch
+    LEN = 65
+
+    _mempool_report()
+    memory_tag_report()
+
+    try:
+        import torch
+    except ImportError:
+        print("=" * LEN)
+        return
 
     gc.collect()
 
-    LEN = 65
     objects = gc.get_objects()
     # print('%s\t%s\t\t\t%s' %('Element type', 'Size', 'Used MEM(MBytes)') )
     tensors = [obj for obj in objects if torch.is_tensor(obj)]
@@ -924,12 +1643,196 @@ class ScopedStream:
             self.device_scope.__exit__(exc_type, exc_value, traceback)
 
 
+# streams of ScopedAutoStreams by device, reused by successive scopes
+_auto_stream_pools = {}
+
+
+def _array_extents(a, write, extents):
+    # byte intervals [begin, end) of the memory a kernel argument refers to, None stands for unknown memory
+    if isinstance(a, wp.types.array):
+        if a.ptr and a.size:
+            end = a.ptr + sum((n - 1) * s for n, s in zip(a.shape, a.strides)) + wp.types.type_size_in_bytes(a.dtype)
+            extents.append((a.ptr, end, write))
+    elif isinstance(a, wp.types.indexedarray):
+        _array_extents(a.data, write, extents)
+        for indices in a.indices:
+            if indices is not None:
+                _array_extents(indices, False, extents)
+    elif isinstance(a, wp.types.noncontiguous_array_base):
+        # fabric arrays gather buckets that are not known on the host
+        extents.append(None)
+    elif isinstance(a, wp.codegen.StructInstance):
+        # struct members are not analyzed by code generation, their arrays count as written
+        for name in a._cls.vars:
+            _array_extents(getattr(a, name), True, extents)
+
+
+class ScopedAutoStreams:
+    def __init__(self, device=None, num_streams=4):
+        """Context manager running the kernels launched on a CUDA device concurrently when they don't depend on
+        each other
+
+        Each launch in the scope that doesn't specify a stream goes to one of ``num_streams`` streams, after the
+        launches that wrote the arrays it uses and, if it writes them, after the launches that read them. Code
+        generation determines which array arguments kernels may write to, the other ones are only read. The
+        current stream of the device waits for each launch, so the other work issued on it in the scope, like
+        copies to the host, sees the results of the preceding launches. Launches wait for the memory allocated
+        in the scope, but not for the other work of the current stream, which should be issued before entering
+        the scope. Capturing a scope records a graph whose independent kernels branch out.
+
+        Args:
+            device: The CUDA device to launch on (optional)
+            num_streams: The number of streams that independent launches are spread over
+        """
+        self.device = wp.get_device(device)
+        if not self.device.is_cuda:
+            raise RuntimeError(f"Automatic streams require a CUDA device, got {self.device}")
+        self.num_streams = max(int(num_streams), 1)
+
+    def __enter__(self):
+        if self.device.auto_streams is not None:
+            raise RuntimeError(f"Automatic streams are already enabled on device {self.device}")
+
+        pool = _auto_stream_pools.setdefault(self.device.alias, [])
+        while len(pool) < self.num_streams:
+            pool.append(wp.Stream(self.device))
+        self.streams = pool[: self.num_streams]
+
+        # the pool streams start after the work issued before the scope, and after the allocations in the scope
+        self.main = self.device.stream
+        self.main_event = self.main.record_event()
+        self.main_epoch = 0
+        self.stream_epochs = [-1] * self.num_streams
+        self.memory_allocated = False
+
+        # last writer and readers since then of each extent, as (stream index, event) pairs
+        self.writers = {}
+        self.readers = {}
+        self.last_used = [0] * self.num_streams
+        self.launch_count = 0
+        self.pending = None
+
+        self.device.auto_streams = self
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        # the current stream has waited for every launch already, which joins the streams of captured graphs
+        self.device.auto_streams = None
+
+    def begin_launch(self, kernel, fwd_args, adj_args, adjoint, bounds, intermediates):
+        """Selects the stream of a kernel launch and makes it wait for the launches it depends on"""
+        written = getattr(kernel.adj, "written_args", None)
+
+        extents = []
+        for i, a in enumerate(fwd_args):
+            # backward kernels accumulate into the gradients of every array
+            _array_extents(a, adjoint or written is None or i in written, extents)
+        for a in adj_args:
+            _array_extents(a, True, extents)
+        if intermediates is not None:
+            _array_extents(intermediates, True, extents)
+        if bounds.size_ptr:
+            extents.append((bounds.size_ptr, bounds.size_ptr + 4, False))
+
+        deps = []
+        for extent in extents:
+            for key in self.writers.keys() | self.readers.keys():
+                if extent is None or (key[0] < extent[1] and extent[0] < key[1]):
+                    if key in self.writers:
+                        deps.append(self.writers[key])
+                    if extent is None or extent[2]:
+                        deps.extend(self.readers.get(key, ()))
+        self.pending = [e for e in extents if e is not None]
+
+        # continue the stream of the latest dependency, or start on the least recently used stream
+        if deps:
+            index = max(deps, key=lambda d: d[2])[0]
+        else:
+            index = min(range(self.num_streams), key=lambda i: self.last_used[i])
+        stream = self.streams[index]
+
+        if self.memory_allocated:
+            self.main_event = self.main.record_event()
+            self.main_epoch += 1
+            self.memory_allocated = False
+        if self.stream_epochs[index] != self.main_epoch:
+            stream.wait_event(self.main_event)
+            self.stream_epochs[index] = self.main_epoch
+
+        for dep_index, event, _ in {id(d[1]): d for d in deps}.values():
+            if dep_index != index:
+                stream.wait_event(event)
+
+        self.launch_count += 1
+        self.last_used[index] = self.launch_count
+        return stream
+
+    def end_launch(self, stream):
+        """Records the launch issued on ``stream``, the current stream of the device waits for it"""
+        index = self.streams.index(stream)
+        event = stream.record_event()
+        self.main.wait_event(event)
+
+        node = (index, event, self.launch_count)
+        for begin, end, write in self.pending:
+            if write:
+                self.writers[(begin, end)] = node
+                self.readers.pop((begin, end), None)
+            else:
+                self.readers.setdefault((begin, end), []).append(node)
+        self.pending = None
+
+
+class ScopedMemoryTag:
+    def __init__(self, name: str):
+        """Context manager that attributes the memory allocated by the calling thread in its scope to ``name`` in
+        :func:`warp.get_memory_stats`, including the temporaries allocated by native code. Tags nest, allocations
+        are attributed to the innermost tag only."""
+        self.name = name
+        self.tag = wp.context.runtime.core.memory_tag_register(name.encode("utf-8"))
+
+    def __enter__(self):
+        self.saved_tag = wp.context.runtime.core.memory_tag_set(self.tag)
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        wp.context.runtime.core.memory_tag_set(self.saved_tag)
+
+
+def memory_tag_report(devices=None, pinned=True):
+    """Prints the memory currently in use and its peak for each memory tag, on the given devices (all devices by
+    default) and in pinned host memory, with the tags of largest peak first"""
+    if devices is None:
+        devices = wp.get_devices()
+
+    spaces = [(str(wp.get_device(d)), wp.get_memory_stats(d)) for d in devices]
+    if pinned:
+        spaces.append(("pinned", wp.get_memory_stats(pinned=True)))
+
+    mb = 1024 * 1024
+    print(f"{'memory':<10} {'tag':<24} {'current MB':>12} {'peak MB':>12} {'live':>8} {'allocs':>10}")
+    for space, stats in spaces:
+        print(
+            f"{space:<10} {'(total)':<24} {stats['current'] / mb:>12.2f} {stats['peak'] / mb:>12.2f} "
+            f"{stats['live']:>8} {stats['count']:>10}"
+        )
+        tags = sorted(stats["tags"].items(), key=lambda t: t[1]["peak"], reverse=True)
+        for name, tag in tags:
+            print(
+                f"{'':<10} {name or '(untagged)':<24} {tag['current'] / mb:>12.2f} {tag['peak'] / mb:>12.2f} "
+                f"{tag['live']:>8} {tag['count']:>10}"
+            )
+
+
 # timer utils
 class ScopedTimer:
     indent = -1
 
     enabled = True
 
+    # timers measured with events whose elapsed time has not been added to their dictionary yet
+    pending = []
+
     def __init__(
         self,
         name,
@@ -940,6 +1843,7 @@ class ScopedTimer:
         use_nvtx=False,
         color="rapids",
         synchronize=False,
+        use_events=False,
     ):
         """Context manager object for a timer
 
@@ -952,6 +1856,11 @@ class ScopedTimer:
             use_nvtx (bool): If true, timing functionality is replaced by an NVTX range
             color (int or str): ARGB value (e.g. 0x00FFFF) or color name (e.g. 'cyan') associated with the NVTX range
             synchronize (bool): Synchronize the CPU thread with any outstanding CUDA work to return accurate GPU timings
+            use_events (bool): Measure the GPU time of the work enqueued on the current stream of the current CUDA
+                device with timing events, without synchronizing. The time is available once the work has completed:
+                reading ``elapsed`` or printing it waits for the end of the block on the GPU, and the times of timers
+                with ``print=False`` are appended to ``dict`` by the timers exiting after the work has completed, or by
+                :meth:`flush`
 
         Attributes:
             elapsed (float): The duration of the ``with`` block used with this object
@@ -964,6 +1873,9 @@ class ScopedTimer:
         self.use_nvtx = use_nvtx
         self.color = color
         self.synchronize = synchronize
+        self.use_events = use_events
+        self.start_event = None
+        self.end_event = None
         self.elapsed = 0.0
 
         if self.dict is not None:
@@ -981,6 +1893,13 @@ class ScopedTimer:
                 self.nvtx_range_id = nvtx.start_range(self.name, color=self.color)
                 return
 
+            # host timing is used on the CPU
+            device = wp.get_device()
+            if self.use_events and device.is_cuda:
+                self.start_event = wp.Event(device, enable_timing=True)
+                self.end_event = wp.Event(device, enable_timing=True)
+                wp.get_stream(device).record_event(self.start_event)
+
             self.start = timeit.default_timer()
             ScopedTimer.indent += 1
 
@@ -1006,10 +1925,16 @@ class ScopedTimer:
                 self.cp.disable()
                 self.cp.print_stats(sort="tottime")
 
-            self.elapsed = (timeit.default_timer() - self.start) * 1000.0
-
-            if self.dict is not None:
-                self.dict[self.name].append(self.elapsed)
+            if self.start_event is not None:
+                wp.get_stream(self.start_event.device).record_event(self.end_event)
+                self._elapsed = None
+                if self.dict is not None:
+                    ScopedTimer.pending.append(self)
+                ScopedTimer.flush(wait=False)
+            else:
+                self.elapsed = (timeit.default_timer() - self.start) * 1000.0
+                if self.dict is not None:
+                    self.dict[self.name].append(self.elapsed)
 
             indent = ""
             for i in range(ScopedTimer.indent):
@@ -1019,3 +1944,171 @@ class ScopedTimer:
                 print("{}{} took {:.2f} ms".format(indent, self.name, self.elapsed))
 
             ScopedTimer.indent -= 1
+
+    @property
+    def elapsed(self):
+        if self._elapsed is None:
+            self._elapsed = wp.get_event_elapsed_time(self.start_event, self.end_event)
+        return self._elapsed
+
+    @elapsed.setter
+    def elapsed(self, value):
+        self._elapsed = value
+
+    @staticmethod
+    def flush(wait=True):
+        """Appends the times measured with events to the dictionaries of their timers, waiting for the GPU work
+        measured if ``wait`` is True, otherwise only the timers whose work has completed are added, in order"""
+        while ScopedTimer.pending:
+            timer = ScopedTimer.pending[0]
+            if not wait and not timer.end_event.query():
+                break
+            timer.dict[timer.name].append(timer.elapsed)
+            ScopedTimer.pending.pop(0)
+
+
+class KernelStats:
+    """GPU time statistics of the launches of one kernel collected by :class:`ScopedKernelProfiler`
+
+    Attributes:
+        name (str): Kernel key, suffixed with ``(backward)`` for adjoint launches
+        times (list): GPU time of each launch in milliseconds
+        dims (list): Launch dimensions of each launch
+        bytes (int): Total size of the arrays passed to the launches, an upper bound on the memory traffic
+    """
+
+    def __init__(self, name):
+        self.name = name
+        self.times = []
+        self.dims = []
+        self.bytes = 0
+
+    @property
+    def count(self):
+        return len(self.times)
+
+    @property
+    def total(self):
+        return sum(self.times)
+
+    @property
+    def mean(self):
+        return self.total / self.count if self.times else 0.0
+
+    @property
+    def p99(self):
+        return float(np.percentile(self.times, 99)) if self.times else 0.0
+
+    @property
+    def bandwidth(self):
+        """Effective bandwidth in GB/s, assuming every argument array is read or written once per launch"""
+        return self.bytes / (self.total * 1.0e6) if self.total > 0.0 else 0.0
+
+
+class ScopedKernelProfiler:
+    def __init__(self, active=True, print=True, use_nvtx=False, dict=None):
+        """Context manager that measures the GPU time of every CUDA kernel launched with ``wp.launch()`` in its scope
+
+        CUDA events are recorded around each launch on the launch stream and resolved at exit, which synchronizes
+        the devices used. Launches recorded into CUDA graphs or with ``record_cmd=True`` are not timed.
+
+        Parameters:
+            active (bool): Enables this profiler, an inactive profiler adds no cost to launches
+            print (bool): At context manager exit, print a table of the kernel statistics to sys.stdout
+            use_nvtx (bool): Also wrap each launch in an NVTX range named after the kernel, shown by Nsight Systems
+            dict (dict): A dictionary to which the :class:`KernelStats` of each kernel are added using its name as a key
+
+        Attributes:
+            results (dict): A dictionary of :class:`KernelStats` by kernel name, sorted by decreasing total time
+        """
+        self.active = active
+        self.print = print
+        self.use_nvtx = use_nvtx
+        self.dict = dict
+        self.results = {}
+
+        self.records = []
+        self.free_events = {}
+
+    def __enter__(self):
+        if self.active:
+            if wp.context.runtime.kernel_profiler is not None:
+                raise RuntimeError("Warp: Error, entering a kernel profiler while one is already active")
+
+            wp.context.runtime.kernel_profiler = self
+
+        return self
+
+    def _get_event(self, device):
+        events = self.free_events.setdefault(device, [])
+        if events:
+            return events.pop()
+        return wp.context.runtime.core.cuda_event_create(device.context, wp.Event.Flags.DEFAULT)
+
+    def begin(self, kernel, device, dim, args, adjoint):
+        if device.is_capturing:
+            return None
+
+        name = kernel.key + (" (backward)" if adjoint else "")
+        if self.use_nvtx:
+            wp.context.runtime.core.cuda_nvtx_range_push(name.encode("utf-8"))
+
+        size = sum(getattr(a, "capacity", 0) for a in args if wp.types.is_array(a))
+
+        start = self._get_event(device)
+        stream = device.stream.cuda_stream
+        wp.context.runtime.core.cuda_event_record(device.context, start, stream)
+
+        return (name, device, dim, size, start)
+
+    def end(self, record):
+        if record is None:
+            return
+
+        device = record[1]
+        end = self._get_event(device)
+        wp.context.runtime.core.cuda_event_record(device.context, end, device.stream.cuda_stream)
+
+        if self.use_nvtx:
+            wp.context.runtime.core.cuda_nvtx_range_pop()
+
+        self.records.append((*record, end))
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        if not self.active:
+            return
+
+        wp.context.runtime.kernel_profiler = None
+
+        for device in set(r[1] for r in self.records):
+            wp.synchronize_device(device)
+
+        for name, device, dim, size, start, end in self.records:
+            stats = self.results.get(name)
+            if stats is None:
+                stats = self.results[name] = KernelStats(name)
+
+            stats.times.append(wp.context.runtime.core.cuda_event_elapsed_time(start, end))
+            stats.dims.append(dim)
+            stats.bytes += size
+
+            self.free_events[device].extend((start, end))
+
+        self.records = []
+
+        for device, events in self.free_events.items():
+            for event in events:
+                wp.context.runtime.core.cuda_event_destroy(device.context, event)
+        self.free_events = {}
+
+        self.results = {s.name: s for s in sorted(self.results.values(), key=lambda s: s.total, reverse=True)}
+
+        if self.dict is not None:
+            self.dict.update(self.results)
+
+        if self.print:
+            print(f"{'Kernel':<40} {'Count':>8} {'Total (ms)':>12} {'Mean (ms)':>12} {'P99 (ms)':>12} {'GB/s':>10}")
+            for s in self.results.values():
+                print(
+                    f"{s.name:<40} {s.count:>8} {s.total:>12.3f} {s.mean:>12.4f} {s.p99:>12.4f} {s.bandwidth:>10.1f}"
+                )